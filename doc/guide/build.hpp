@@ -133,6 +133,13 @@ The full list of options mlpack allows:
  - ARMA_EXTRA_DEBUG=(ON/OFF): compile with extra Armadillo debugging symbols
        (default OFF)
  - BUILD_TESTS=(ON/OFF): compile the \c mlpack_test program (default ON)
+ - BUILD_BENCHMARKS=(ON/OFF): compile the \c mlpack_benchmarks program, and
+       add the \c run_benchmarks target, which writes the results of all
+       benchmarks to \c benchmarks.json (default OFF)
+ - MEMORY_TRACKING=(ON/OFF): count the memory allocated by Armadillo matrices
+       and by trees, so that the \c --memory_report option of the
+       command-line programs reports the peak memory of each timer (default
+       OFF)
  - BUILD_CLI_EXECUTABLES=(ON/OFF): compile the mlpack command-line executables
        (i.e. \c mlpack_knn, \c mlpack_kfn, \c mlpack_logistic_regression, etc.)
        (default ON)
@@ -157,6 +164,16 @@ The full list of options mlpack allows:
        of CXXFLAGS (default OFF)
  - USE_OPENMP=(ON/OFF): if ON, then use OpenMP if the compiler supports it; if
        OFF, OpenMP support is manually disabled (default ON)
+ - USE_MPI=(ON/OFF): if ON and MPI is found, build
+       mlpack::kmeans::DistributedKMeans and the \c --distributed option of
+       \c mlpack_kmeans, which cluster a dataset split across the processes of
+       an MPI program (default OFF)
+ - USE_NVBLAS=(ON/OFF): if ON and NVBLAS (from the CUDA toolkit) is found, link
+       it ahead of the CPU BLAS, so that large matrix products (such as those of
+       \c BLOCKED_NAIVE_MODE neighbor search and of the \c Linear and
+       \c Convolution layers) run on the GPU; an \c nvblas.conf file naming the
+       CPU BLAS is needed at runtime, and the \c NVBLASTest test checks with
+       the NVBLAS log that these products run on the GPU (default OFF)
 
 Each option can be specified to CMake with the '-D' flag.  Other tools can also
 be used to configure CMake, but those are not documented here.
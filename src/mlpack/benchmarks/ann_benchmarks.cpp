@@ -0,0 +1,178 @@
+/**
+ * @file ann_benchmarks.cpp
+ *
+ * Benchmarks of the forward and backward passes of a feedforward network, for
+ * each of a number of layer types.  Each network maps 64 inputs (an 8x8
+ * image) to 256 units, through the benchmarked layer, then to 10 outputs.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/methods/ann/ffn.hpp>
+#include <mlpack/methods/ann/layer/layer.hpp>
+#include <mlpack/methods/ann/loss_functions/mean_squared_error.hpp>
+#include <mlpack/methods/ann/init_rules/random_init.hpp>
+#include "benchmark.hpp"
+
+using namespace mlpack;
+using namespace mlpack::ann;
+using namespace mlpack::benchmark;
+
+namespace {
+
+typedef FFN<MeanSquaredError<>, RandomInitialization> Network;
+
+//! The batch sizes.
+const std::vector<std::vector<size_t>> batchSizes = { { 1 }, { 32 },
+    { 256 } };
+
+//! The number of points passed through the network by each iteration.
+const size_t points = 1024;
+
+//! Add the layers that map the 64 inputs to 256 units, with the given layer
+//! type.
+typedef void (*AddLayersFunction)(Network& network);
+
+void AddLinear(Network& network)
+{
+  network.Add<Linear<>>(64, 256);
+  network.Add<Linear<>>(256, 256);
+}
+
+void AddSigmoid(Network& network)
+{
+  network.Add<Linear<>>(64, 256);
+  network.Add<SigmoidLayer<>>();
+}
+
+void AddTanH(Network& network)
+{
+  network.Add<Linear<>>(64, 256);
+  network.Add<TanHLayer<>>();
+}
+
+void AddReLU(Network& network)
+{
+  network.Add<Linear<>>(64, 256);
+  network.Add<ReLULayer<>>();
+}
+
+void AddLeakyReLU(Network& network)
+{
+  network.Add<Linear<>>(64, 256);
+  network.Add<LeakyReLU<>>();
+}
+
+void AddDropout(Network& network)
+{
+  network.Add<Linear<>>(64, 256);
+  network.Add<Dropout<>>(0.2);
+}
+
+void AddBatchNorm(Network& network)
+{
+  network.Add<Linear<>>(64, 256);
+  network.Add<BatchNorm<>>(256);
+}
+
+void AddLayerNorm(Network& network)
+{
+  network.Add<Linear<>>(64, 256);
+  network.Add<LayerNorm<>>(256);
+}
+
+void AddConvolution(Network& network)
+{
+  // Four 3x3 filters, with padding, give 4 x 8 x 8 = 256 units.
+  network.Add<Convolution<>>(1, 4, 3, 3, 1, 1, 1, 1, 8, 8);
+}
+
+void AddMaxPooling(Network& network)
+{
+  // Sixteen 3x3 filters give 16 x 8 x 8 units, and pooling keeps 16 x 4 x 4.
+  network.Add<Convolution<>>(1, 16, 3, 3, 1, 1, 1, 1, 8, 8);
+  network.Add<MaxPooling<>>(2, 2, 2, 2);
+}
+
+//! Build the network with the given layers.
+void BuildNetwork(Network& network, AddLayersFunction addLayers)
+{
+  addLayers(network);
+  network.Add<Linear<>>(256, 10);
+  network.ResetParameters();
+}
+
+/**
+ * Pass the points through the network (without computing the loss), in
+ * batches of Arg(0) points.
+ */
+void FFNForward(BenchmarkState& state, AddLayersFunction addLayers)
+{
+  Network network;
+  BuildNetwork(network, addLayers);
+
+  const arma::mat predictors(64, points, arma::fill::randu);
+  arma::mat results;
+  while (state.KeepRunning())
+    network.Predict(predictors, results, state.Arg(0));
+
+  state.SetItemsProcessed(state.Iterations() * points);
+}
+
+/**
+ * Compute the loss and the gradient of the network for all the points, in
+ * batches of Arg(0) points.
+ */
+void FFNForwardBackward(BenchmarkState& state, AddLayersFunction addLayers)
+{
+  Network network;
+  BuildNetwork(network, addLayers);
+
+  network.Predictors() = arma::randu<arma::mat>(64, points);
+  network.Responses() = arma::randu<arma::mat>(10, points);
+
+  arma::mat gradient;
+  while (state.KeepRunning())
+  {
+    for (size_t begin = 0; begin + state.Arg(0) <= points;
+        begin += state.Arg(0))
+    {
+      network.EvaluateWithGradient(network.Parameters(), begin, gradient,
+          state.Arg(0));
+    }
+  }
+
+  state.SetItemsProcessed(state.Iterations() * (points / state.Arg(0)) *
+      state.Arg(0));
+}
+
+//! Register the forward and backward benchmarks of the given layer type.
+struct LayerBenchmarks
+{
+  LayerBenchmarks(const std::string& name, AddLayersFunction addLayers) :
+      forward("FFN/Forward/" + name, [addLayers](BenchmarkState& state)
+          { FFNForward(state, addLayers); }, batchSizes),
+      forwardBackward("FFN/ForwardBackward/" + name,
+          [addLayers](BenchmarkState& state)
+          { FFNForwardBackward(state, addLayers); }, batchSizes)
+  { }
+
+  BenchmarkRegistration forward;
+  BenchmarkRegistration forwardBackward;
+};
+
+LayerBenchmarks linearBenchmarks("Linear", AddLinear);
+LayerBenchmarks sigmoidBenchmarks("Sigmoid", AddSigmoid);
+LayerBenchmarks tanhBenchmarks("TanH", AddTanH);
+LayerBenchmarks reluBenchmarks("ReLU", AddReLU);
+LayerBenchmarks leakyReLUBenchmarks("LeakyReLU", AddLeakyReLU);
+LayerBenchmarks dropoutBenchmarks("Dropout", AddDropout);
+LayerBenchmarks batchNormBenchmarks("BatchNorm", AddBatchNorm);
+LayerBenchmarks layerNormBenchmarks("LayerNorm", AddLayerNorm);
+LayerBenchmarks convolutionBenchmarks("Convolution", AddConvolution);
+LayerBenchmarks maxPoolingBenchmarks("MaxPooling", AddMaxPooling);
+
+} // anonymous namespace
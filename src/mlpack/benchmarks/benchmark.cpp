@@ -0,0 +1,436 @@
+/**
+ * @file benchmark.cpp
+ *
+ * Implementation of the benchmark framework: registration, the runner, and the
+ * table and JSON output.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "benchmark.hpp"
+
+#include <mlpack/core/util/version.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <thread>
+
+#ifndef _WIN32
+  #include <unistd.h>
+#endif
+
+using namespace mlpack;
+using namespace mlpack::benchmark;
+using namespace std;
+
+namespace {
+
+//! A registered benchmark run: a benchmark function with its arguments.
+struct RegisteredRun
+{
+  string name;
+  BenchmarkFunction function;
+  vector<size_t> args;
+};
+
+//! The result of a run (or an aggregate of repetitions of a run).
+struct RunResult
+{
+  string name;
+  string runName;
+  string aggregateName;
+  size_t iterations;
+  // Times per iteration, in nanoseconds.
+  double realTime;
+  double cpuTime;
+  double itemsPerSecond;
+  double bytesPerSecond;
+};
+
+//! Get all registered runs.
+vector<RegisteredRun>& Runs()
+{
+  static vector<RegisteredRun> runs;
+  return runs;
+}
+
+//! Escape the given string for JSON.
+string Escape(const string& s)
+{
+  ostringstream oss;
+  for (size_t i = 0; i < s.size(); ++i)
+  {
+    if (s[i] == '"' || s[i] == '\\')
+      oss << '\\' << s[i];
+    else if ((unsigned char) s[i] < 0x20)
+      oss << "\\u" << hex << setw(4) << setfill('0') << (int) s[i] << dec;
+    else
+      oss << s[i];
+  }
+  return oss.str();
+}
+
+//! Run the given benchmark for at least the given time.
+RunResult Run(const RegisteredRun& run, const double minTime)
+{
+  size_t iterations = 1;
+  while (true)
+  {
+    BenchmarkState state(run.args, iterations);
+    run.function(state);
+
+    // Stop when enough time was spent, or when the iteration count gets silly.
+    if (state.RealTime() >= minTime || iterations >= 1000000000)
+    {
+      RunResult result;
+      result.name = run.name;
+      result.runName = run.name;
+      result.iterations = iterations;
+      result.realTime = 1e9 * state.RealTime() / iterations;
+      result.cpuTime = 1e9 * state.CPUTime() / iterations;
+      result.itemsPerSecond = (state.RealTime() > 0) ?
+          state.ItemsProcessed() / state.RealTime() : 0.0;
+      result.bytesPerSecond = (state.RealTime() > 0) ?
+          state.BytesProcessed() / state.RealTime() : 0.0;
+      return result;
+    }
+
+    // Predict how many iterations are needed, aiming a little high, but don't
+    // grow more than tenfold at once, since the first runs are noisy.
+    double multiplier = 10.0;
+    if (state.RealTime() > 0.1 * minTime)
+      multiplier = std::min(10.0, 1.4 * minTime / state.RealTime());
+    iterations = std::max(iterations + 1, (size_t) (iterations * multiplier));
+  }
+}
+
+//! Compute the mean, median and standard deviation of the given repetitions.
+vector<RunResult> Aggregate(const vector<RunResult>& repetitions)
+{
+  vector<RunResult> aggregates;
+  const char* names[3] = { "mean", "median", "stddev" };
+  for (size_t a = 0; a < 3; ++a)
+  {
+    RunResult result = repetitions[0];
+    result.name = repetitions[0].runName + "_" + names[a];
+    result.aggregateName = names[a];
+
+    double RunResult::*fields[4] = { &RunResult::realTime, &RunResult::cpuTime,
+        &RunResult::itemsPerSecond, &RunResult::bytesPerSecond };
+    for (size_t f = 0; f < 4; ++f)
+    {
+      vector<double> values;
+      for (size_t i = 0; i < repetitions.size(); ++i)
+        values.push_back(repetitions[i].*fields[f]);
+
+      double mean = 0.0;
+      for (size_t i = 0; i < values.size(); ++i)
+        mean += values[i];
+      mean /= values.size();
+
+      if (a == 0)
+      {
+        result.*fields[f] = mean;
+      }
+      else if (a == 1)
+      {
+        std::sort(values.begin(), values.end());
+        const size_t n = values.size();
+        result.*fields[f] = (n % 2 == 1) ? values[n / 2] :
+            (values[n / 2 - 1] + values[n / 2]) / 2;
+      }
+      else
+      {
+        double variance = 0.0;
+        for (size_t i = 0; i < values.size(); ++i)
+          variance += (values[i] - mean) * (values[i] - mean);
+        result.*fields[f] = (values.size() > 1) ?
+            std::sqrt(variance / (values.size() - 1)) : 0.0;
+      }
+    }
+
+    aggregates.push_back(result);
+  }
+
+  return aggregates;
+}
+
+//! Print the given result as a row of the table.
+void PrintRow(ostream& stream, const RunResult& result)
+{
+  stream << left << setw(50) << result.name << right << setw(15) << fixed
+      << setprecision(0) << result.realTime << " ns" << setw(15)
+      << result.cpuTime << " ns" << setw(12) << result.iterations;
+  if (result.itemsPerSecond > 0)
+    stream << "  " << setprecision(4) << scientific << result.itemsPerSecond
+        << " items/s";
+  if (result.bytesPerSecond > 0)
+    stream << "  " << setprecision(4) << scientific << result.bytesPerSecond
+        << " B/s";
+  stream << defaultfloat << endl;
+}
+
+//! Write all the results as JSON, in the format of Google Benchmark.
+void WriteJSON(ostream& stream, const vector<RunResult>& results)
+{
+  const time_t now = time(NULL);
+  char date[64];
+  strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", localtime(&now));
+
+  string hostName = "unknown";
+  #ifndef _WIN32
+  char buffer[256];
+  if (gethostname(buffer, sizeof(buffer)) == 0)
+  {
+    buffer[sizeof(buffer) - 1] = '\0';
+    hostName = buffer;
+  }
+  #endif
+
+  stream << "{" << endl;
+  stream << "  \"context\": {" << endl;
+  stream << "    \"date\": \"" << date << "\"," << endl;
+  stream << "    \"host_name\": \"" << Escape(hostName) << "\"," << endl;
+  stream << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ","
+      << endl;
+  stream << "    \"mlpack_version\": \"" << Escape(util::GetVersion()) << "\","
+      << endl;
+  #ifdef DEBUG
+  stream << "    \"library_build_type\": \"debug\"" << endl;
+  #else
+  stream << "    \"library_build_type\": \"release\"" << endl;
+  #endif
+  stream << "  }," << endl;
+  stream << "  \"benchmarks\": [" << endl;
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    const RunResult& r = results[i];
+    stream << "    {" << endl;
+    stream << "      \"name\": \"" << Escape(r.name) << "\"," << endl;
+    stream << "      \"run_name\": \"" << Escape(r.runName) << "\"," << endl;
+    if (r.aggregateName.empty())
+    {
+      stream << "      \"run_type\": \"iteration\"," << endl;
+    }
+    else
+    {
+      stream << "      \"run_type\": \"aggregate\"," << endl;
+      stream << "      \"aggregate_name\": \"" << r.aggregateName << "\","
+          << endl;
+    }
+    stream << setprecision(17);
+    stream << "      \"iterations\": " << r.iterations << "," << endl;
+    stream << "      \"real_time\": " << r.realTime << "," << endl;
+    stream << "      \"cpu_time\": " << r.cpuTime << "," << endl;
+    stream << "      \"time_unit\": \"ns\"";
+    if (r.itemsPerSecond > 0)
+    {
+      stream << "," << endl << "      \"items_per_second\": "
+          << r.itemsPerSecond;
+    }
+    if (r.bytesPerSecond > 0)
+    {
+      stream << "," << endl << "      \"bytes_per_second\": "
+          << r.bytesPerSecond;
+    }
+    stream << endl << "    }" << ((i + 1 < results.size()) ? "," : "") << endl;
+  }
+  stream << "  ]" << endl;
+  stream << "}" << endl;
+}
+
+void PrintHelp(const char* program)
+{
+  cout << "Usage: " << program << " [options]" << endl << endl
+      << "Run the mlpack microbenchmarks.  Options:" << endl << endl
+      << "  --filter <regex>     Only run the benchmarks whose name matches."
+      << endl
+      << "  --list               List the benchmarks, and don't run them."
+      << endl
+      << "  --min_time <s>       Minimum time to run each benchmark for "
+      << "(default 0.5)." << endl
+      << "  --repetitions <n>    Number of times to run each benchmark; the "
+      << "mean, median" << endl
+      << "                       and standard deviation are also reported "
+      << "(default 1)." << endl
+      << "  --json <file>        Write the results as JSON to the given file "
+      << "('-' for" << endl
+      << "                       standard output)." << endl;
+}
+
+} // anonymous namespace
+
+BenchmarkState::BenchmarkState(const vector<size_t>& args,
+                               const size_t iterations) :
+    args(args),
+    iterations(iterations),
+    iteration(0),
+    running(false),
+    cpuStart(0),
+    realTime(0.0),
+    cpuTime(0.0),
+    itemsProcessed(0),
+    bytesProcessed(0)
+{
+  // Nothing to do.
+}
+
+void BenchmarkState::PauseTiming()
+{
+  if (!running)
+    return;
+
+  const chrono::steady_clock::time_point realEnd = chrono::steady_clock::now();
+  const clock_t cpuEnd = clock();
+  realTime += chrono::duration<double>(realEnd - realStart).count();
+  cpuTime += double(cpuEnd - cpuStart) / CLOCKS_PER_SEC;
+  running = false;
+}
+
+void BenchmarkState::ResumeTiming()
+{
+  if (running)
+    return;
+
+  running = true;
+  cpuStart = clock();
+  realStart = chrono::steady_clock::now();
+}
+
+BenchmarkRegistration::BenchmarkRegistration(
+    const string& name,
+    BenchmarkFunction function,
+    const vector<vector<size_t>>& args)
+{
+  for (size_t i = 0; i < args.size(); ++i)
+  {
+    RegisteredRun run;
+    run.name = name;
+    for (size_t j = 0; j < args[i].size(); ++j)
+      run.name += "/" + to_string(args[i][j]);
+    run.function = function;
+    run.args = args[i];
+    Runs().push_back(run);
+  }
+}
+
+int mlpack::benchmark::RunBenchmarks(int argc, char** argv)
+{
+  string filter = ".*";
+  string jsonFile = "";
+  double minTime = 0.5;
+  size_t repetitions = 1;
+  bool list = false;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    const string arg = argv[i];
+    const bool hasValue = (i + 1 < argc);
+    if (arg == "--help" || arg == "-h")
+    {
+      PrintHelp(argv[0]);
+      return 0;
+    }
+    else if (arg == "--list")
+    {
+      list = true;
+    }
+    else if (arg == "--filter" && hasValue)
+    {
+      filter = argv[++i];
+    }
+    else if (arg == "--json" && hasValue)
+    {
+      jsonFile = argv[++i];
+    }
+    else if (arg == "--min_time" && hasValue)
+    {
+      minTime = atof(argv[++i]);
+    }
+    else if (arg == "--repetitions" && hasValue)
+    {
+      repetitions = std::max(1, atoi(argv[++i]));
+    }
+    else
+    {
+      cerr << "Unknown option '" << arg << "'; see --help." << endl;
+      return 1;
+    }
+  }
+
+  regex filterRegex;
+  try
+  {
+    filterRegex = regex(filter);
+  }
+  catch (regex_error& e)
+  {
+    cerr << "Invalid filter '" << filter << "': " << e.what() << endl;
+    return 1;
+  }
+
+  vector<RegisteredRun> runs;
+  for (size_t i = 0; i < Runs().size(); ++i)
+    if (regex_search(Runs()[i].name, filterRegex))
+      runs.push_back(Runs()[i]);
+
+  if (list)
+  {
+    for (size_t i = 0; i < runs.size(); ++i)
+      cout << runs[i].name << endl;
+    return 0;
+  }
+
+  // Open the JSON output first, so that we don't run everything for nothing.
+  ofstream jsonStream;
+  if (!jsonFile.empty() && jsonFile != "-")
+  {
+    jsonStream.open(jsonFile);
+    if (!jsonStream.is_open())
+    {
+      cerr << "Unable to open '" << jsonFile << "' for writing." << endl;
+      return 1;
+    }
+  }
+
+  // If the JSON goes to standard output, the table goes to standard error.
+  ostream& table = (jsonFile == "-") ? cerr : cout;
+  table << left << setw(50) << "Benchmark" << right << setw(18) << "Time"
+      << setw(18) << "CPU" << setw(12) << "Iterations" << endl;
+  table << string(98, '-') << endl;
+
+  vector<RunResult> results;
+  for (size_t i = 0; i < runs.size(); ++i)
+  {
+    vector<RunResult> runResults;
+    for (size_t r = 0; r < repetitions; ++r)
+    {
+      runResults.push_back(Run(runs[i], minTime));
+      PrintRow(table, runResults.back());
+    }
+
+    results.insert(results.end(), runResults.begin(), runResults.end());
+    if (repetitions > 1)
+    {
+      const vector<RunResult> aggregates = Aggregate(runResults);
+      for (size_t a = 0; a < aggregates.size(); ++a)
+        PrintRow(table, aggregates[a]);
+      results.insert(results.end(), aggregates.begin(), aggregates.end());
+    }
+  }
+
+  if (jsonFile == "-")
+    WriteJSON(cout, results);
+  else if (!jsonFile.empty())
+    WriteJSON(jsonStream, results);
+
+  return 0;
+}
@@ -0,0 +1,164 @@
+/**
+ * @file benchmark.hpp
+ *
+ * A small framework for the microbenchmarks of mlpack_benchmarks: benchmarks
+ * are functions that time a loop with a BenchmarkState, and are registered
+ * (with a list of arguments) by creating a static BenchmarkRegistration.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_BENCHMARKS_BENCHMARK_HPP
+#define MLPACK_BENCHMARKS_BENCHMARK_HPP
+
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace mlpack {
+namespace benchmark {
+
+/**
+ * The state of one run of a benchmark.  A benchmark does its setup, then times
+ * its work in a loop:
+ *
+ * @code
+ * void KNNSearch(BenchmarkState& state)
+ * {
+ *   arma::mat dataset(3, state.Arg(0), arma::fill::randu);
+ *   KNN knn(dataset);
+ *
+ *   arma::Mat<size_t> neighbors;
+ *   arma::mat distances;
+ *   while (state.KeepRunning())
+ *     knn.Search(5, neighbors, distances);
+ *
+ *   state.SetItemsProcessed(state.Iterations() * dataset.n_cols);
+ * }
+ * @endcode
+ *
+ * Only the time spent inside of the loop is measured; parts of the loop can be
+ * left out with PauseTiming() and ResumeTiming().
+ */
+class BenchmarkState
+{
+ public:
+  /**
+   * Create the state of a run.
+   *
+   * @param args Arguments of the benchmark.
+   * @param iterations Number of iterations to run.
+   */
+  BenchmarkState(const std::vector<size_t>& args, const size_t iterations);
+
+  /**
+   * Return whether another iteration should be run.  The first call starts
+   * timing, and the call that returns false stops it.
+   */
+  bool KeepRunning()
+  {
+    if (iteration == 0)
+      ResumeTiming();
+
+    if (iteration++ < iterations)
+      return true;
+
+    PauseTiming();
+    return false;
+  }
+
+  //! Stop timing (for instance, to reset the input of the next iteration).
+  void PauseTiming();
+  //! Start timing again.
+  void ResumeTiming();
+
+  //! Get the given argument of the benchmark.
+  size_t Arg(const size_t i) const { return args[i]; }
+  //! Get the number of iterations that are run.
+  size_t Iterations() const { return iterations; }
+
+  //! Set the number of items processed by all iterations (to report
+  //! throughput).
+  void SetItemsProcessed(const size_t items) { itemsProcessed = items; }
+  //! Get the number of items processed by all iterations.
+  size_t ItemsProcessed() const { return itemsProcessed; }
+
+  //! Set the number of bytes processed by all iterations (to report
+  //! throughput).
+  void SetBytesProcessed(const size_t bytes) { bytesProcessed = bytes; }
+  //! Get the number of bytes processed by all iterations.
+  size_t BytesProcessed() const { return bytesProcessed; }
+
+  //! Get the (wall clock) time spent timing, in seconds.
+  double RealTime() const { return realTime; }
+  //! Get the CPU time (of all threads) spent timing, in seconds.
+  double CPUTime() const { return cpuTime; }
+
+ private:
+  //! The arguments of the benchmark.
+  std::vector<size_t> args;
+  //! The number of iterations to run.
+  size_t iterations;
+  //! The number of times KeepRunning() was called.
+  size_t iteration;
+  //! Whether timing is running.
+  bool running;
+  //! The time at which timing was started.
+  std::chrono::steady_clock::time_point realStart;
+  //! The CPU time at which timing was started.
+  std::clock_t cpuStart;
+  //! The wall clock time spent timing.
+  double realTime;
+  //! The CPU time spent timing.
+  double cpuTime;
+  //! The number of items processed.
+  size_t itemsProcessed;
+  //! The number of bytes processed.
+  size_t bytesProcessed;
+};
+
+//! The type of a benchmark function.
+typedef std::function<void(BenchmarkState&)> BenchmarkFunction;
+
+/**
+ * Register a benchmark with each of the given lists of arguments.  The name of
+ * each run is the name of the benchmark followed by its arguments, like
+ * "KNN/KDTree/10000".  Registrations are meant to be static objects:
+ *
+ * @code
+ * static BenchmarkRegistration knnSearch("KNN/KDTree", KNNSearch,
+ *     { { 1000 }, { 10000 } });
+ * @endcode
+ */
+class BenchmarkRegistration
+{
+ public:
+  /**
+   * Register the given benchmark.
+   *
+   * @param name Name of the benchmark.
+   * @param function Benchmark function.
+   * @param args Lists of arguments to run the benchmark with.
+   */
+  BenchmarkRegistration(const std::string& name,
+                        BenchmarkFunction function,
+                        const std::vector<std::vector<size_t>>& args =
+                            std::vector<std::vector<size_t>>(1));
+};
+
+/**
+ * Run the registered benchmarks, given the command line of mlpack_benchmarks;
+ * see the --help output for the options.  Results are printed as a table, and
+ * can be written as JSON (in the format of Google Benchmark, so that its tools
+ * can be used to compare runs).  Returns the exit status of the program.
+ */
+int RunBenchmarks(int argc, char** argv);
+
+} // namespace benchmark
+} // namespace mlpack
+
+#endif
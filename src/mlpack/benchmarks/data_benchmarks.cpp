@@ -0,0 +1,108 @@
+/**
+ * @file data_benchmarks.cpp
+ *
+ * Benchmarks of data loading and of model serialization.  Files are written to
+ * the working directory, and removed afterwards.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+#include "benchmark.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+using namespace mlpack;
+using namespace mlpack::benchmark;
+
+namespace {
+
+//! Get the size of the given file, in bytes.
+size_t FileSize(const std::string& filename)
+{
+  std::ifstream stream(filename, std::ios::binary | std::ios::ate);
+  return stream.is_open() ? (size_t) stream.tellg() : 0;
+}
+
+/**
+ * Load a CSV file of Arg(0) points in ten dimensions.
+ */
+void CSVLoad(BenchmarkState& state)
+{
+  const std::string filename = "mlpack_benchmark.csv";
+  const arma::mat dataset(10, state.Arg(0), arma::fill::randu);
+  data::Save(filename, dataset, true);
+
+  arma::mat loaded;
+  while (state.KeepRunning())
+    data::Load(filename, loaded, true);
+
+  state.SetItemsProcessed(state.Iterations() * dataset.n_cols);
+  state.SetBytesProcessed(state.Iterations() * FileSize(filename));
+  std::remove(filename.c_str());
+}
+
+/**
+ * Save a k-nearest-neighbor model (a kd-tree on Arg(0) points in three
+ * dimensions) in the format given by the extension.
+ */
+void ModelSave(BenchmarkState& state, const std::string& extension)
+{
+  const std::string filename = "mlpack_benchmark_model." + extension;
+  neighbor::KNN knn(arma::mat(3, state.Arg(0), arma::fill::randu));
+
+  while (state.KeepRunning())
+    data::Save(filename, "model", knn, true);
+
+  state.SetBytesProcessed(state.Iterations() * FileSize(filename));
+  std::remove(filename.c_str());
+}
+
+/**
+ * Load a k-nearest-neighbor model (a kd-tree on Arg(0) points in three
+ * dimensions) in the format given by the extension.
+ */
+void ModelLoad(BenchmarkState& state, const std::string& extension)
+{
+  const std::string filename = "mlpack_benchmark_model." + extension;
+  neighbor::KNN knn(arma::mat(3, state.Arg(0), arma::fill::randu));
+  data::Save(filename, "model", knn, true);
+
+  while (state.KeepRunning())
+  {
+    neighbor::KNN loaded;
+    data::Load(filename, "model", loaded, true);
+  }
+
+  state.SetBytesProcessed(state.Iterations() * FileSize(filename));
+  std::remove(filename.c_str());
+}
+
+//! Register the save and load benchmarks of the given model format.
+struct ModelBenchmarks
+{
+  ModelBenchmarks(const std::string& extension) :
+      save("ModelSave/KNN/" + extension, [extension](BenchmarkState& state)
+          { ModelSave(state, extension); }, { { 1000 }, { 100000 } }),
+      load("ModelLoad/KNN/" + extension, [extension](BenchmarkState& state)
+          { ModelLoad(state, extension); }, { { 1000 }, { 100000 } })
+  { }
+
+  BenchmarkRegistration save;
+  BenchmarkRegistration load;
+};
+
+BenchmarkRegistration csvLoad("CSVLoad", CSVLoad, { { 10000 }, { 100000 } });
+
+ModelBenchmarks xmlBenchmarks("xml");
+ModelBenchmarks binaryBenchmarks("bin");
+ModelBenchmarks portableBinaryBenchmarks("pbin");
+#ifdef HAS_ZLIB
+ModelBenchmarks compressedBenchmarks("pbz");
+#endif
+
+} // anonymous namespace
@@ -0,0 +1,72 @@
+/**
+ * @file kmeans_benchmarks.cpp
+ *
+ * Benchmarks of k-means clustering with each Lloyd step type.  All step types
+ * compute the same clustering, so they are run from the same initial centroids
+ * for the same number of iterations.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/methods/kmeans/kmeans.hpp>
+#include <mlpack/methods/kmeans/elkan_kmeans.hpp>
+#include <mlpack/methods/kmeans/hamerly_kmeans.hpp>
+#include <mlpack/methods/kmeans/pelleg_moore_kmeans.hpp>
+#include <mlpack/methods/kmeans/dual_tree_kmeans.hpp>
+#include "benchmark.hpp"
+
+using namespace mlpack;
+using namespace mlpack::benchmark;
+using namespace mlpack::kmeans;
+
+namespace {
+
+//! The number of points and the number of clusters.
+const std::vector<std::vector<size_t>> sizes = { { 10000, 10 },
+    { 100000, 10 }, { 100000, 100 } };
+
+/**
+ * Run 10 iterations of k-means with Arg(1) clusters on Arg(0) points in five
+ * dimensions.
+ */
+template<template<typename, typename> class LloydStepType>
+void KMeansCluster(BenchmarkState& state)
+{
+  typedef KMeans<metric::EuclideanDistance, SampleInitialization,
+      MaxVarianceNewCluster, LloydStepType> KMeansType;
+
+  const size_t iterations = 10;
+  const arma::mat dataset(5, state.Arg(0), arma::fill::randu);
+  const arma::mat initialCentroids = dataset.cols(0, state.Arg(1) - 1);
+
+  KMeansType kmeans(iterations);
+  arma::mat centroids;
+  while (state.KeepRunning())
+  {
+    state.PauseTiming();
+    centroids = initialCentroids;
+    state.ResumeTiming();
+
+    kmeans.Cluster(dataset, state.Arg(1), centroids, true);
+  }
+
+  state.SetItemsProcessed(state.Iterations() * iterations * dataset.n_cols);
+}
+
+BenchmarkRegistration naive("KMeans/Naive", KMeansCluster<NaiveKMeans>,
+    sizes);
+BenchmarkRegistration elkan("KMeans/Elkan", KMeansCluster<ElkanKMeans>,
+    sizes);
+BenchmarkRegistration hamerly("KMeans/Hamerly",
+    KMeansCluster<HamerlyKMeans>, sizes);
+BenchmarkRegistration pellegMoore("KMeans/PellegMoore",
+    KMeansCluster<PellegMooreKMeans>, sizes);
+BenchmarkRegistration dualTree("KMeans/DualTree",
+    KMeansCluster<DefaultDualTreeKMeans>, sizes);
+BenchmarkRegistration dualTreeCover("KMeans/DualTreeCoverTree",
+    KMeansCluster<CoverTreeDualTreeKMeans>, sizes);
+
+} // anonymous namespace
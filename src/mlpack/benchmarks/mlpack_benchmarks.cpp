@@ -0,0 +1,21 @@
+/**
+ * @file mlpack_benchmarks.cpp
+ *
+ * Entry point of mlpack_benchmarks, which runs the microbenchmarks of core
+ * parts of mlpack.  The benchmarks register themselves; see benchmark.hpp.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include "benchmark.hpp"
+
+int main(int argc, char** argv)
+{
+  // Make the datasets of the benchmarks the same for every run.
+  mlpack::math::RandomSeed(42);
+
+  return mlpack::benchmark::RunBenchmarks(argc, argv);
+}
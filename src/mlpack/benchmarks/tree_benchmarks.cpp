@@ -0,0 +1,166 @@
+/**
+ * @file tree_benchmarks.cpp
+ *
+ * Benchmarks of tree construction and of k-nearest-neighbor search, range
+ * search and kernel density estimation with each tree type.  Datasets are
+ * uniformly distributed in the unit cube.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+#include <mlpack/methods/range_search/range_search.hpp>
+#include <mlpack/methods/kde/kde.hpp>
+#include "benchmark.hpp"
+
+using namespace mlpack;
+using namespace mlpack::benchmark;
+
+namespace {
+
+//! The dimensionality of the datasets.
+const size_t dimensions = 3;
+
+//! The sizes of the datasets.
+const std::vector<std::vector<size_t>> sizes = { { 1000 }, { 10000 },
+    { 100000 } };
+
+/**
+ * Build a tree on Arg(0) points.
+ */
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void TreeBuild(BenchmarkState& state)
+{
+  typedef TreeType<metric::EuclideanDistance, tree::EmptyStatistic, arma::mat>
+      Tree;
+
+  const arma::mat dataset(dimensions, state.Arg(0), arma::fill::randu);
+  while (state.KeepRunning())
+  {
+    Tree tree(dataset);
+  }
+
+  state.SetItemsProcessed(state.Iterations() * dataset.n_cols);
+}
+
+/**
+ * Find the 5 nearest neighbors of Arg(0) query points among Arg(0) reference
+ * points (with dual-tree search; the query tree is built by each search).
+ */
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void KNNSearch(BenchmarkState& state)
+{
+  typedef neighbor::NeighborSearch<neighbor::NearestNeighborSort,
+      metric::EuclideanDistance, arma::mat, TreeType> KNNType;
+
+  arma::mat reference(dimensions, state.Arg(0), arma::fill::randu);
+  const arma::mat query(dimensions, state.Arg(0), arma::fill::randu);
+  KNNType knn(std::move(reference));
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  while (state.KeepRunning())
+    knn.Search(query, 5, neighbors, distances);
+
+  state.SetItemsProcessed(state.Iterations() * query.n_cols);
+}
+
+/**
+ * Find the reference points within a radius of each of Arg(0) query points,
+ * among Arg(0) reference points.  The radius is chosen so that each query
+ * point has about 10 neighbors.
+ */
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch(BenchmarkState& state)
+{
+  typedef range::RangeSearch<metric::EuclideanDistance, arma::mat, TreeType>
+      RangeSearchType;
+
+  arma::mat reference(dimensions, state.Arg(0), arma::fill::randu);
+  const arma::mat query(dimensions, state.Arg(0), arma::fill::randu);
+  RangeSearchType rangeSearch(std::move(reference));
+
+  const double radius = std::cbrt(10.0 * 3.0 / (4.0 * M_PI * state.Arg(0)));
+  std::vector<std::vector<size_t>> neighbors;
+  std::vector<std::vector<double>> distances;
+  while (state.KeepRunning())
+  {
+    rangeSearch.Search(query, math::Range(0.0, radius), neighbors,
+        distances);
+  }
+
+  state.SetItemsProcessed(state.Iterations() * query.n_cols);
+}
+
+/**
+ * Estimate the density of Arg(0) query points with a Gaussian kernel, given
+ * Arg(0) reference points.
+ */
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void KDEEvaluate(BenchmarkState& state)
+{
+  typedef kde::KDE<kernel::GaussianKernel, metric::EuclideanDistance,
+      arma::mat, TreeType> KDEType;
+
+  arma::mat reference(dimensions, state.Arg(0), arma::fill::randu);
+  const arma::mat query(dimensions, state.Arg(0), arma::fill::randu);
+  KDEType kde(0.05, 0.0, kernel::GaussianKernel(0.1));
+  kde.Train(std::move(reference));
+
+  arma::vec estimations;
+  while (state.KeepRunning())
+    kde.Evaluate(query, estimations);
+
+  state.SetItemsProcessed(state.Iterations() * query.n_cols);
+}
+
+BenchmarkRegistration treeBuildKD("TreeBuild/KDTree",
+    TreeBuild<tree::KDTree>, sizes);
+BenchmarkRegistration treeBuildBall("TreeBuild/BallTree",
+    TreeBuild<tree::BallTree>, sizes);
+BenchmarkRegistration treeBuildCover("TreeBuild/CoverTree",
+    TreeBuild<tree::StandardCoverTree>, sizes);
+BenchmarkRegistration treeBuildR("TreeBuild/RTree",
+    TreeBuild<tree::RTree>, sizes);
+BenchmarkRegistration treeBuildOctree("TreeBuild/Octree",
+    TreeBuild<tree::Octree>, sizes);
+
+BenchmarkRegistration knnKD("KNN/KDTree", KNNSearch<tree::KDTree>, sizes);
+BenchmarkRegistration knnBall("KNN/BallTree", KNNSearch<tree::BallTree>,
+    sizes);
+BenchmarkRegistration knnCover("KNN/CoverTree",
+    KNNSearch<tree::StandardCoverTree>, sizes);
+BenchmarkRegistration knnR("KNN/RTree", KNNSearch<tree::RTree>, sizes);
+BenchmarkRegistration knnOctree("KNN/Octree", KNNSearch<tree::Octree>, sizes);
+
+BenchmarkRegistration rangeKD("RangeSearch/KDTree",
+    RangeSearch<tree::KDTree>, sizes);
+BenchmarkRegistration rangeBall("RangeSearch/BallTree",
+    RangeSearch<tree::BallTree>, sizes);
+BenchmarkRegistration rangeCover("RangeSearch/CoverTree",
+    RangeSearch<tree::StandardCoverTree>, sizes);
+BenchmarkRegistration rangeR("RangeSearch/RTree",
+    RangeSearch<tree::RTree>, sizes);
+BenchmarkRegistration rangeOctree("RangeSearch/Octree",
+    RangeSearch<tree::Octree>, sizes);
+
+BenchmarkRegistration kdeKD("KDE/KDTree", KDEEvaluate<tree::KDTree>, sizes);
+BenchmarkRegistration kdeBall("KDE/BallTree", KDEEvaluate<tree::BallTree>,
+    sizes);
+BenchmarkRegistration kdeCover("KDE/CoverTree",
+    KDEEvaluate<tree::StandardCoverTree>, sizes);
+BenchmarkRegistration kdeOctree("KDE/Octree", KDEEvaluate<tree::Octree>,
+    sizes);
+
+} // anonymous namespace
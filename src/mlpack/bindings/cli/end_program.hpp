@@ -14,21 +14,17 @@
 #define MLPACK_BINDINGS_CLI_END_PROGRAM_HPP
 
 #include <mlpack/core/util/cli.hpp>
+#include <mlpack/core/util/scoped_timer.hpp>
 
 namespace mlpack {
 namespace bindings {
 namespace cli {
 
 /**
- * Handle command-line program termination.  If --help or --info was passed, we
- * won't make it here, so we don't have to write any contingencies for that.
+ * Save every output parameter that was given a filename.
  */
-inline void EndProgram()
+inline void OutputParameters()
 {
-  // Stop the CLI timers.
-  CLI::GetSingleton().timer.StopAllTimers();
-
-  // Print any output.
   const std::map<std::string, util::ParamData>& parameters = CLI::Parameters();
   std::map<std::string, util::ParamData>::const_iterator it =
       parameters.begin();
@@ -40,6 +36,38 @@ inline void EndProgram()
 
     ++it;
   }
+}
+
+/**
+ * Handle command-line program termination.  If --help or --info was passed, we
+ * won't make it here, so we don't have to write any contingencies for that.
+ */
+inline void EndProgram()
+{
+  // Stop the CLI timers.
+  CLI::GetSingleton().timer.StopAllTimers();
+
+  // Write the results of the scoped timers, if requested.
+  const std::string timingOutput = CLI::GetParam<std::string>("timing_output");
+  if (timingOutput != "")
+  {
+    std::ofstream ofs(timingOutput);
+    if (!ofs.is_open())
+    {
+      Log::Warn << "Unable to open file '" << timingOutput << "' to write "
+          << "timing results to." << std::endl;
+    }
+    else
+    {
+      ScopedTimers::WriteJSON(ofs);
+    }
+  }
+
+  // Print any output.
+  OutputParameters();
+
+  const std::map<std::string, util::ParamData>& parameters = CLI::Parameters();
+  std::map<std::string, util::ParamData>::const_iterator it;
 
   if (CLI::HasParam("verbose"))
   {
@@ -73,6 +101,58 @@ inline void EndProgram()
     }
   }
 
+  if (CLI::HasParam("perf_counters"))
+  {
+    // The counters are printed even without --verbose.
+    const bool ignoreInput = Log::Info.ignoreInput;
+    Log::Info.ignoreInput = false;
+
+    if (!PerfCounters::Available())
+    {
+      Log::Info << "Hardware performance counters are not available on this "
+          << "system." << std::endl;
+    }
+    else
+    {
+      Log::Info << "Performance counters:" << std::endl;
+      for (auto it2 : CLI::GetSingleton().timer.GetAllTimers())
+      {
+        Log::Info << "  " << it2.first << ": ";
+        CLI::GetSingleton().timer.PrintPerfCounters(it2.first);
+      }
+    }
+
+    Log::Info.ignoreInput = ignoreInput;
+  }
+
+  if (CLI::HasParam("memory_report"))
+  {
+    // The report is printed even without --verbose.
+    const bool ignoreInput = Log::Info.ignoreInput;
+    Log::Info.ignoreInput = false;
+
+    if (!MemoryTracker::Available())
+    {
+      Log::Info << "Memory tracking is not enabled in this build of mlpack "
+          << "(configure it with -DMEMORY_TRACKING=ON); only the peak "
+          << "resident memory is available." << std::endl;
+    }
+    else
+    {
+      Log::Info << "Peak memory allocated by matrices and trees:" << std::endl;
+      for (auto it2 : CLI::GetSingleton().timer.GetAllTimers())
+      {
+        Log::Info << "  " << it2.first << ": ";
+        CLI::GetSingleton().timer.PrintPeakMemory(it2.first);
+      }
+    }
+
+    Log::Info << "Peak resident memory: " << MemoryTracker::PeakResident()
+        << " bytes." << std::endl;
+
+    Log::Info.ignoreInput = ignoreInput;
+  }
+
   // Lastly clean up any memory.  If we are holding any pointers, then we "own"
   // them.  But we may hold the same pointer twice, so we have to be careful to
   // not delete it multiple times.
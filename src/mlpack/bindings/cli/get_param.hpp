@@ -57,11 +57,12 @@ T& GetParam(
   T& matrix = std::get<0>(tuple);
   if (d.input && !d.loaded)
   {
-    // Call correct data::Load() function.
+    // Call correct data::Load() function.  Matrices in .npy files are mapped
+    // into memory instead of being read, if possible.
     if (arma::is_Row<T>::value || arma::is_Col<T>::value)
       data::Load(value, matrix, true);
     else
-      data::Load(value, matrix, true, !d.noTranspose);
+      data::Load(value, matrix, d.mappedFile, true, !d.noTranspose);
     d.loaded = true;
   }
 
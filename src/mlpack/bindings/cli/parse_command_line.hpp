@@ -27,22 +27,40 @@ PARAM_STRING_IN("info", "Print help on a specific option.", "", "");
 PARAM_FLAG("verbose", "Display informational messages and the full list of "
     "parameters and timers at the end of execution.", "v");
 PARAM_FLAG("version", "Display the version of mlpack.", "V");
+PARAM_INT_IN("threads", "Maximum number of threads to use (0 means all the "
+    "threads that OpenMP would use).", "", 0);
+PARAM_STRING_IN("timing_output", "If specified, write the results of the "
+    "scoped timers of the program (call counts, total times and percentiles "
+    "of each timed section) to this file as JSON.", "", "");
+PARAM_FLAG("perf_counters", "Count hardware performance events (cycles, "
+    "instructions, cache misses and branch misses) for each timer, and print "
+    "them at the end of execution (Linux only).", "");
+PARAM_FLAG("memory_report", "Print the peak memory allocated by matrices and "
+    "trees during each timer, and the peak resident memory of the program, at "
+    "the end of execution (the allocations are only counted if mlpack was "
+    "configured with -DMEMORY_TRACKING=ON).", "");
+PARAM_FLAG("serve", "Keep running as a server: after loading the inputs "
+    "given on the command line, read requests (each a line of further options, "
+    "such as '--query_file q.csv --output_file o.csv') from standard input, run "
+    "the program on each, and answer each with a line '<request number> OK' or "
+    "'<request number> ERROR <message>' on standard output.", "");
+PARAM_STRING_IN("server_socket", "If specified, serve requests from "
+    "connections to a Unix domain socket created at this path, instead of from "
+    "standard input (implies --serve).", "", "");
+PARAM_INT_IN("server_workers", "Number of requests that a server answers at "
+    "once; each worker holds its own copy of the inputs.", "", 1);
 
 /**
- * Parse the command line, setting all of the options inside of the CLI object
- * to their appropriate given values.
+ * Add every parameter of the program to the given options description, and
+ * map the names that the user passes on the command line to the names of the
+ * parameters.
  */
-void ParseCommandLine(int argc, char** argv)
+inline void AddOptions(boost::program_options::options_description& desc,
+                       std::map<std::string, std::string>& boostNameMap)
 {
-  // First, we need to build the boost::program_options variables for parsing.
-  using namespace boost::program_options;
-  options_description desc;
-  variables_map vmap;
-
   // Go through list of options in order to add them.
   std::map<std::string, util::ParamData>& parameters = CLI::Parameters();
   typedef std::map<std::string, util::ParamData>::const_iterator IteratorType;
-  std::map<std::string, std::string> boostNameMap;
   for (IteratorType it = parameters.begin(); it != parameters.end(); ++it)
   {
     // Add the parameter to desc.
@@ -56,58 +74,66 @@ void ParseCommandLine(int argc, char** argv)
         (void*) &boostName);
     boostNameMap[boostName] = d.name;
   }
+}
 
-  // Mark that we did parsing.
-  CLI::GetSingleton().didParse = true;
-
-  // Parse the command line, then place the values in the right place.
-  try
+/**
+ * Store the parsed options in the given variables map, removing duplicate
+ * flags; an option given twice with a value is an error.
+ */
+inline void StoreOptions(
+    boost::program_options::basic_parsed_options<char>& bpo,
+    const boost::program_options::options_description& desc,
+    boost::program_options::variables_map& vmap)
+{
+  // Iterate over all the options, looking for duplicate parameters.  If we
+  // find any, remove the duplicates.  Note that vector options can have
+  // duplicates, so we check for those with max_tokens().
+  for (size_t i = 0; i < bpo.options.size(); ++i)
   {
-    basic_parsed_options<char> bpo(parse_command_line(argc, argv, desc));
-
-    // Iterate over all the options, looking for duplicate parameters.  If we
-    // find any, remove the duplicates.  Note that vector options can have
-    // duplicates, so we check for those with max_tokens().
-    for (size_t i = 0; i < bpo.options.size(); ++i)
+    for (size_t j = i + 1; j < bpo.options.size(); ++j)
     {
-      for (size_t j = i + 1; j < bpo.options.size(); ++j)
+      if ((bpo.options[i].string_key == bpo.options[j].string_key) &&
+          (desc.find(bpo.options[i].string_key,
+                     false).semantic()->max_tokens() <= 1))
       {
-        if ((bpo.options[i].string_key == bpo.options[j].string_key) &&
-            (desc.find(bpo.options[i].string_key,
-                       false).semantic()->max_tokens() <= 1))
+        // If a duplicate is found, check to see if either one has a value.
+        if (bpo.options[i].value.size() == 0 &&
+            bpo.options[j].value.size() == 0)
         {
-          // If a duplicate is found, check to see if either one has a value.
-          if (bpo.options[i].value.size() == 0 &&
-              bpo.options[j].value.size() == 0)
-          {
-            // If neither has a value, we'll consider it a duplicate flag and
-            // remove the duplicate.  It's important to not break out of this
-            // loop because there might be another duplicate later on in the
-            // vector.
-            bpo.options.erase(bpo.options.begin() + j);
-            --j; // Fix the index.
-          }
-          else
-          {
-            // If one or both has a value, produce an error and politely
-            // terminate.  We pull the name from the original_tokens, rather
-            // than from the string_key, because the string_key is the parameter
-            // after aliases have been expanded.
-            Log::Fatal << "\"" << bpo.options[j].original_tokens[0] << "\" is "
-                << "defined multiple times." << std::endl;
-          }
+          // If neither has a value, we'll consider it a duplicate flag and
+          // remove the duplicate.  It's important to not break out of this
+          // loop because there might be another duplicate later on in the
+          // vector.
+          bpo.options.erase(bpo.options.begin() + j);
+          --j; // Fix the index.
+        }
+        else
+        {
+          // If one or both has a value, produce an error and politely
+          // terminate.  We pull the name from the original_tokens, rather
+          // than from the string_key, because the string_key is the parameter
+          // after aliases have been expanded.
+          Log::Fatal << "\"" << bpo.options[j].original_tokens[0] << "\" is "
+              << "defined multiple times." << std::endl;
         }
       }
     }
-
-    store(bpo, vmap);
-  }
-  catch (std::exception& ex)
-  {
-    Log::Fatal << "Caught exception from parsing command line: " << ex.what()
-        << std::endl;
   }
 
+  store(bpo, vmap);
+}
+
+/**
+ * Overwrite the values of the parameters with the options that were given.
+ * Input matrices and models that were given are loaded again the next time
+ * they are used.
+ */
+inline void SetOptions(boost::program_options::variables_map& vmap,
+                       std::map<std::string, std::string>& boostNameMap)
+{
+  using namespace boost::program_options;
+  std::map<std::string, util::ParamData>& parameters = CLI::Parameters();
+
   // Now iterate through the filled vmap, and overwrite default values with
   // anything that's found on the command line.
   for (variables_map::iterator i = vmap.begin(); i != vmap.end(); ++i)
@@ -121,7 +147,40 @@ void ParseCommandLine(int argc, char** argv)
     param.wasPassed = true;
     CLI::GetSingleton().functionMap[param.tname]["SetParam"](param,
         (void*) &vmap[i->first].value(), NULL);
+    param.loaded = false;
   }
+}
+
+/**
+ * Parse the command line, setting all of the options inside of the CLI object
+ * to their appropriate given values.
+ */
+void ParseCommandLine(int argc, char** argv)
+{
+  // First, we need to build the boost::program_options variables for parsing.
+  using namespace boost::program_options;
+  options_description desc;
+  variables_map vmap;
+  std::map<std::string, util::ParamData>& parameters = CLI::Parameters();
+  std::map<std::string, std::string> boostNameMap;
+  AddOptions(desc, boostNameMap);
+
+  // Mark that we did parsing.
+  CLI::GetSingleton().didParse = true;
+
+  // Parse the command line, then place the values in the right place.
+  try
+  {
+    basic_parsed_options<char> bpo(parse_command_line(argc, argv, desc));
+    StoreOptions(bpo, desc, vmap);
+  }
+  catch (std::exception& ex)
+  {
+    Log::Fatal << "Caught exception from parsing command line: " << ex.what()
+        << std::endl;
+  }
+
+  SetOptions(vmap, boostNameMap);
 
   // Flush the buffer, make sure changes are propagated to vmap.
   notify(vmap);
@@ -174,6 +233,18 @@ void ParseCommandLine(int argc, char** argv)
     Log::Info.ignoreInput = false;
   }
 
+  if (CLI::HasParam("threads"))
+  {
+    if (CLI::GetParam<int>("threads") < 0)
+    {
+      Log::Fatal << "Invalid value for --threads: "
+          << CLI::GetParam<int>("threads") << "; must be 0 or greater."
+          << std::endl;
+    }
+
+    Threads::Set((size_t) CLI::GetParam<int>("threads"));
+  }
+
   // Now, issue an error if we forgot any required options.
   for (std::map<std::string, util::ParamData>::const_iterator iter =
        parameters.begin(); iter != parameters.end(); ++iter)
@@ -194,6 +265,38 @@ void ParseCommandLine(int argc, char** argv)
   }
 }
 
+/**
+ * Parse the options of one request to a program that is serving (see Serve()),
+ * setting the given options inside of the CLI object; the other options keep
+ * their values.  Unlike ParseCommandLine(), --help, --info and --version are
+ * not handled, and errors are thrown as exceptions instead of terminating the
+ * program.
+ *
+ * @param args Options of the request, such as {"--query_file", "q.csv"}.
+ */
+inline void ParseRequest(const std::vector<std::string>& args)
+{
+  using namespace boost::program_options;
+  options_description desc;
+  variables_map vmap;
+  std::map<std::string, std::string> boostNameMap;
+  AddOptions(desc, boostNameMap);
+
+  try
+  {
+    basic_parsed_options<char> bpo(
+        command_line_parser(args).options(desc).run());
+    StoreOptions(bpo, desc, vmap);
+  }
+  catch (boost::program_options::error& ex)
+  {
+    throw std::invalid_argument(ex.what());
+  }
+
+  SetOptions(vmap, boostNameMap);
+  notify(vmap);
+}
+
 } // namespace cli
 } // namespace bindings
 } // namespace mlpack
@@ -0,0 +1,468 @@
+/**
+ * @file serve.hpp
+ *
+ * Run a command-line program as a server, which keeps its inputs (such as a
+ * model) loaded and runs the program on each request it receives.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_BINDINGS_CLI_SERVE_HPP
+#define MLPACK_BINDINGS_CLI_SERVE_HPP
+
+#include <mlpack/core.hpp>
+#include "parse_command_line.hpp"
+#include "end_program.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+#ifndef _WIN32
+  #include <cerrno>
+  #include <csignal>
+  #include <sys/socket.h>
+  #include <sys/un.h>
+  #include <unistd.h>
+#endif
+
+namespace mlpack {
+namespace bindings {
+namespace cli {
+
+/**
+ * Split a request into its options.  Options are separated by whitespace; an
+ * option containing whitespace can be given between double quotes, in which
+ * \" and \\ stand for a double quote and a backslash.
+ *
+ * @param request Line of the request, such as "--query_file q.csv".
+ */
+inline std::vector<std::string> SplitRequest(const std::string& request)
+{
+  std::vector<std::string> args;
+  std::string arg;
+  bool inArg = false, quoted = false;
+  for (size_t i = 0; i < request.size(); ++i)
+  {
+    const char c = request[i];
+    if (quoted)
+    {
+      if (c == '"')
+        quoted = false;
+      else if (c == '\\' && i + 1 < request.size() &&
+          (request[i + 1] == '"' || request[i + 1] == '\\'))
+        arg += request[++i];
+      else
+        arg += c;
+    }
+    else if (std::isspace((unsigned char) c))
+    {
+      if (inArg)
+        args.push_back(arg);
+      arg.clear();
+      inArg = false;
+    }
+    else
+    {
+      if (c == '"')
+        quoted = true;
+      else
+        arg += c;
+      inArg = true;
+    }
+  }
+
+  if (quoted)
+    throw std::invalid_argument("unterminated quote in request");
+  if (inArg)
+    args.push_back(arg);
+
+  return args;
+}
+
+/**
+ * A worker of a server, which holds its own copy of the parameters of the
+ * program, with the inputs given on the command line loaded, and runs the
+ * program on requests.  A ServerWorker must be created and used on the thread
+ * that it serves.
+ */
+class ServerWorker
+{
+ public:
+  /**
+   * Restore the parameters stored by Serve(), and load the inputs.  If an
+   * input can't be loaded, an exception is thrown.
+   *
+   * @param mlpackMain Program to run.
+   * @param outputMutex Mutex held while the outputs of a request are saved and
+   *     the response is sent, shared by all workers.
+   */
+  ServerWorker(void (*mlpackMain)(), std::mutex& outputMutex) :
+      mlpackMain(mlpackMain),
+      outputMutex(outputMutex)
+  {
+    CLI::RestoreSettings("mlpack_server");
+
+    // New threads don't inherit the setting of --threads.
+    Threads::Apply();
+
+    std::map<std::string, util::ParamData>& parameters = CLI::Parameters();
+    std::map<std::string, util::ParamData>::iterator it = parameters.begin();
+    for ( ; it != parameters.end(); ++it)
+    {
+      util::ParamData& d = it->second;
+      if (d.input && d.wasPassed)
+      {
+        void* value;
+        CLI::GetSingleton().functionMap[d.tname]["GetParam"](d, NULL,
+            (void*) &value);
+      }
+    }
+
+    base = parameters;
+    baseMemory = AllocatedMemory();
+  }
+
+  //! Free the inputs.
+  ~ServerWorker()
+  {
+    CLI::Parameters() = base;
+    FreeMemory(std::unordered_set<void*>());
+  }
+
+  /**
+   * Run the program on the given request, then save its outputs and send the
+   * response ("OK" or "ERROR <message>") with the given function, while the
+   * output mutex is held.  Options that the request does not give keep the
+   * values given on the command line.
+   *
+   * @param request Line of the request.
+   * @param respond Function that sends the response.
+   */
+  void Run(const std::string& request,
+           const std::function<void(const std::string&)>& respond)
+  {
+    std::string error;
+    try
+    {
+      ParseRequest(SplitRequest(request));
+
+      // Workers that set the random seed share the random number generator,
+      // so they don't run at the same time.
+      CLI::RandomScope randomScope;
+      mlpackMain();
+    }
+    catch (std::exception& e)
+    {
+      error = e.what();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(outputMutex);
+      if (error.empty())
+      {
+        try
+        {
+          OutputParameters();
+        }
+        catch (std::exception& e)
+        {
+          error = e.what();
+        }
+      }
+
+      if (error.empty())
+      {
+        respond("OK");
+      }
+      else
+      {
+        // A response is a single line.
+        std::replace(error.begin(), error.end(), '\n', ' ');
+        respond("ERROR " + error);
+      }
+    }
+
+    // Models loaded or created by the request are freed; the inputs given on
+    // the command line are kept for the next request.
+    FreeMemory(baseMemory);
+    CLI::Parameters() = base;
+  }
+
+ private:
+  //! Get the memory held by the parameters.
+  std::unordered_set<void*> AllocatedMemory() const
+  {
+    std::unordered_set<void*> memory;
+    const std::map<std::string, util::ParamData>& parameters =
+        CLI::Parameters();
+    std::map<std::string, util::ParamData>::const_iterator it =
+        parameters.begin();
+    for ( ; it != parameters.end(); ++it)
+    {
+      void* result;
+      CLI::GetSingleton().functionMap[it->second.tname]["GetAllocatedMemory"](
+          it->second, NULL, (void*) &result);
+      if (result != NULL)
+        memory.insert(result);
+    }
+
+    return memory;
+  }
+
+  //! Free the memory held by the parameters, except the given memory.  The
+  //! same memory may be held by several parameters, but it is freed once.
+  void FreeMemory(const std::unordered_set<void*>& keep) const
+  {
+    std::unordered_set<void*> freed(keep);
+    const std::map<std::string, util::ParamData>& parameters =
+        CLI::Parameters();
+    std::map<std::string, util::ParamData>::const_iterator it =
+        parameters.begin();
+    for ( ; it != parameters.end(); ++it)
+    {
+      const util::ParamData& d = it->second;
+      void* result;
+      CLI::GetSingleton().functionMap[d.tname]["GetAllocatedMemory"](d, NULL,
+          (void*) &result);
+      if (result != NULL && freed.insert(result).second)
+      {
+        CLI::GetSingleton().functionMap[d.tname]["DeleteAllocatedMemory"](d,
+            NULL, NULL);
+      }
+    }
+  }
+
+  //! The parameters of this worker (held by the context).
+  CLI::Context context;
+  //! The program.
+  void (*mlpackMain)();
+  //! The mutex held while outputs are saved.
+  std::mutex& outputMutex;
+  //! The parameters with the inputs given on the command line loaded.
+  std::map<std::string, util::ParamData> base;
+  //! The memory held by the base parameters.
+  std::unordered_set<void*> baseMemory;
+};
+
+#ifndef _WIN32
+/**
+ * Serve the requests of one connection to the server socket, until it is
+ * closed.
+ */
+inline void ServeConnection(ServerWorker& worker, const int connection)
+{
+  std::string buffer;
+  size_t requests = 0;
+  char data[4096];
+  while (true)
+  {
+    const ssize_t received = recv(connection, data, sizeof(data), 0);
+    if (received < 0 && errno == EINTR)
+      continue;
+    if (received <= 0)
+      break;
+    buffer.append(data, (size_t) received);
+
+    size_t end;
+    while ((end = buffer.find('\n')) != std::string::npos)
+    {
+      const std::string request = buffer.substr(0, end);
+      buffer.erase(0, end + 1);
+
+      const size_t number = ++requests;
+      worker.Run(request, [connection, number](const std::string& status)
+      {
+        const std::string response = std::to_string(number) + " " + status +
+            "\n";
+        size_t sent = 0;
+        while (sent < response.size())
+        {
+          const ssize_t n = send(connection, response.data() + sent,
+              response.size() - sent, 0);
+          if (n < 0 && errno == EINTR)
+            continue;
+          if (n <= 0)
+            break;
+          sent += (size_t) n;
+        }
+      });
+    }
+  }
+
+  close(connection);
+}
+#endif
+
+/**
+ * Run the program as a server (for --serve or --server_socket): the inputs
+ * given on the command line (such as a model) are loaded once by each of the
+ * --server_workers workers, and each request (a line of options, which replace
+ * the options given on the command line) runs the program once and saves its
+ * outputs.  Each request is answered with a line "<request number> OK" or
+ * "<request number> ERROR <message>"; the details of errors are printed like
+ * they are when the program runs once.
+ *
+ * Requests are read from standard input, and the server stops at its end; or,
+ * with --server_socket, from the connections to a Unix domain socket, and the
+ * server runs until it is stopped.  Requests are numbered from 1 on each
+ * connection.  When requests are read from standard input, standard output
+ * only carries the responses: everything else the program prints (the log
+ * streams, and output options that are printed instead of saved) goes to
+ * standard error while serving, since the workers print at the same time.
+ *
+ * @param mlpackMain Program to run.
+ * @return Exit code of the program.
+ */
+inline int Serve(void (*mlpackMain)())
+{
+  const int workers = CLI::GetParam<int>("server_workers");
+  if (workers < 1)
+  {
+    Log::Fatal << "Invalid value for --server_workers: " << workers
+        << "; must be 1 or greater." << std::endl;
+  }
+
+  const std::string socketPath = CLI::GetParam<std::string>("server_socket");
+
+  // Each worker starts from these settings.
+  CLI::StoreSettings("mlpack_server");
+
+  std::mutex inputMutex, outputMutex;
+  std::vector<std::thread> threads;
+  std::vector<int> failed(workers, 0);
+  #ifndef _WIN32
+  int listener = -1;
+  #endif
+
+  // Standard output is kept for the responses when requests come from
+  // standard input; std::cout (and so Log::Info and Log::Warn) writes to
+  // standard error meanwhile.
+  std::ostream responses(std::cout.rdbuf());
+  std::streambuf* coutBuffer = NULL;
+
+  if (socketPath == "")
+  {
+    coutBuffer = std::cout.rdbuf(std::cerr.rdbuf());
+    size_t requests = 0;
+    for (int i = 0; i < workers; ++i)
+    {
+      threads.push_back(std::thread([&, i]()
+      {
+        try
+        {
+          ServerWorker worker(mlpackMain, outputMutex);
+          std::string request;
+          while (true)
+          {
+            size_t number;
+            {
+              std::lock_guard<std::mutex> lock(inputMutex);
+              if (!std::getline(std::cin, request))
+                break;
+              number = ++requests;
+            }
+
+            worker.Run(request, [&responses, number](
+                const std::string& status)
+            {
+              responses << number << " " << status << std::endl;
+            });
+          }
+        }
+        catch (std::exception&)
+        {
+          failed[i] = 1;
+        }
+      }));
+    }
+  }
+  else
+  {
+    #ifdef _WIN32
+    Log::Fatal << "--server_socket is not supported on Windows; use --serve "
+        << "instead." << std::endl;
+    #else
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path))
+    {
+      Log::Fatal << "Socket path '" << socketPath << "' is too long."
+          << std::endl;
+    }
+    strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) -
+        1);
+
+    // A socket left by a previous server is replaced.
+    unlink(socketPath.c_str());
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0 ||
+        bind(listener, (sockaddr*) &address, sizeof(address)) != 0 ||
+        listen(listener, SOMAXCONN) != 0)
+    {
+      Log::Fatal << "Unable to listen on socket '" << socketPath << "': "
+          << strerror(errno) << "." << std::endl;
+    }
+
+    // A client that disconnects before its response is sent must not stop
+    // the server.
+    signal(SIGPIPE, SIG_IGN);
+
+    Log::Info << "Serving requests on '" << socketPath << "'." << std::endl;
+    for (int i = 0; i < workers; ++i)
+    {
+      threads.push_back(std::thread([&, i]()
+      {
+        try
+        {
+          ServerWorker worker(mlpackMain, outputMutex);
+          while (true)
+          {
+            const int connection = accept(listener, NULL, NULL);
+            if (connection < 0 && errno == EINTR)
+              continue;
+            if (connection < 0)
+              break;
+
+            ServeConnection(worker, connection);
+          }
+        }
+        catch (std::exception&)
+        {
+          failed[i] = 1;
+        }
+      }));
+    }
+    #endif
+  }
+
+  for (size_t i = 0; i < threads.size(); ++i)
+    threads[i].join();
+
+  if (coutBuffer != NULL)
+    std::cout.rdbuf(coutBuffer);
+
+  #ifndef _WIN32
+  if (listener >= 0)
+  {
+    close(listener);
+    unlink(socketPath.c_str());
+  }
+  #endif
+
+  // A worker only fails if the inputs can't be loaded; the reason was printed.
+  return (std::find(failed.begin(), failed.end(), 1) != failed.end()) ? 1 : 0;
+}
+
+} // namespace cli
+} // namespace bindings
+} // namespace mlpack
+
+#endif
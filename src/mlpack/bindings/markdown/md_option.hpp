@@ -62,7 +62,12 @@ class MDOption
     data.loaded = false;
     // Several options from Python and CLI bindings are persistent.
     if (identifier == "verbose" || identifier == "copy_all_inputs" ||
-        identifier == "help" || identifier == "info" || identifier == "version")
+        identifier == "threads" || identifier == "help" ||
+        identifier == "info" || identifier == "version" ||
+        identifier == "timing_output" ||
+        identifier == "perf_counters" || identifier == "memory_report" ||
+        identifier == "serve" || identifier == "server_socket" ||
+        identifier == "server_workers")
       data.persistent = true;
     else
       data.persistent = false;
@@ -72,7 +77,8 @@ class MDOption
     data.value = boost::any(defaultValue);
 
     // Restore the parameters for this program.
-    if (identifier != "verbose" && identifier != "copy_all_inputs")
+    if (identifier != "verbose" && identifier != "copy_all_inputs" &&
+        identifier != "threads")
       CLI::RestoreSettings(bindingName, false);
 
     // Set the function pointers that we'll need.  Most of these simply delegate
@@ -96,7 +102,12 @@ class MDOption
     // Add the option.
     CLI::Add(std::move(data));
     if (identifier != "verbose" && identifier != "copy_all_inputs" &&
-        identifier != "help" && identifier != "info" && identifier != "version")
+        identifier != "threads" && identifier != "help" &&
+        identifier != "info" && identifier != "version" &&
+        identifier != "timing_output" &&
+        identifier != "perf_counters" && identifier != "memory_report" &&
+        identifier != "serve" && identifier != "server_socket" &&
+        identifier != "server_workers")
       CLI::StoreSettings(bindingName);
     CLI::ClearSettings();
   }
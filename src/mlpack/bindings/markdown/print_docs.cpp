@@ -119,7 +119,13 @@ void PrintDocs(const std::string& bindingName,
         continue;
       if (languages[i] != "cli" &&
           (it->second.name == "help" || it->second.name == "info" ||
-           it->second.name == "version"))
+           it->second.name == "version" ||
+           it->second.name == "timing_output" ||
+           it->second.name == "perf_counters" ||
+           it->second.name == "memory_report" ||
+           it->second.name == "serve" ||
+           it->second.name == "server_socket" ||
+           it->second.name == "server_workers"))
         continue;
 
       // Print name, type, description, default.
@@ -129,7 +135,13 @@ void PrintDocs(const std::string& bindingName,
       cout << it->second.desc; // just a string
       // Print whether or not it's a "special" language-only parameter.
       if (it->second.name == "copy_all_inputs" || it->second.name == "help" ||
-          it->second.name == "info" || it->second.name == "version")
+          it->second.name == "info" || it->second.name == "version" ||
+          it->second.name == "timing_output" ||
+          it->second.name == "perf_counters" ||
+          it->second.name == "memory_report" ||
+          it->second.name == "serve" ||
+          it->second.name == "server_socket" ||
+          it->second.name == "server_workers")
       {
         cout << "  <span class=\"special\">Only exists in "
             << PrintLanguage(languages[i]) << " binding.</span>";
@@ -166,7 +178,13 @@ void PrintDocs(const std::string& bindingName,
       cout << it->second.desc;
       // Print whether or not it's a "special" language-only parameter.
       if (it->second.name == "copy_all_inputs" || it->second.name == "help" ||
-          it->second.name == "info" || it->second.name == "version")
+          it->second.name == "info" || it->second.name == "version" ||
+          it->second.name == "timing_output" ||
+          it->second.name == "perf_counters" ||
+          it->second.name == "memory_report" ||
+          it->second.name == "serve" ||
+          it->second.name == "server_socket" ||
+          it->second.name == "server_workers")
       {
         cout << "  <span class=\"special\">Only exists in "
             << PrintLanguage(languages[i]) << " binding.</span>";
@@ -12,6 +12,12 @@ object, then the numpy object will "own" the matrix.
 Thus, know that if you convert a matrix type, remember that the resulting type
 is what "owns" the allocated memory.
 
+If a numpy matrix is converted without taking ownership, the Armadillo object
+borrows its memory.  If that memory ends up in an output Armadillo object (for
+instance, when a binding modifies its input in place), the output numpy object
+refers to the input numpy object as its base, so no copy is made in either
+direction.
+
 mlpack is free software; you may redistribute it and/or modify it under the
 terms of the 3-clause BSD license.  You should have received a copy of the
 3-clause BSD license along with mlpack.  If not, see
@@ -20,6 +26,8 @@ http://www.opensource.org/licenses/BSD-3-Clause for more information.
 cimport cython
 cimport numpy
 import numpy
+import functools
+import weakref
 
 numpy.import_array()
 
@@ -40,12 +48,50 @@ cdef extern from "<mlpack/bindings/python/mlpack/arma_util.hpp>":
   size_t* GetMemory(arma.Col[size_t]& m)
   size_t* GetMemory(arma.Row[size_t]& m)
 
+# The numpy objects whose memory is borrowed by Armadillo objects, as weak
+# references indexed by the address of the memory.
+cdef dict borrowed = {}
+
+def forget_borrowed(key, ref):
+  """
+  Forget a borrowed numpy object that was destroyed, unless its memory has been
+  borrowed by another one since.
+  """
+  if borrowed.get(key) is ref:
+    del borrowed[key]
+
+cdef borrow(numpy.ndarray X):
+  """
+  Remember that the memory of the given numpy object is borrowed.
+  """
+  key = <size_t> X.data
+  borrowed[key] = weakref.ref(X, functools.partial(forget_borrowed, key))
+
+cdef numpy.ndarray set_owner(numpy.ndarray output, size_t memState):
+  """
+  Make the given numpy object (which refers to the memory of an Armadillo
+  object) safe to return.  If the Armadillo object owned its memory, the numpy
+  object now owns it.  If the memory was borrowed from an input numpy object,
+  that object becomes the base of the output.  Otherwise, the memory is copied.
+  """
+  if memState == 0:
+    PyArray_ENABLEFLAGS(output, numpy.NPY_OWNDATA)
+    return output
+
+  ref = borrowed.get(<size_t> output.data)
+  owner = None if ref is None else ref()
+  if owner is None:
+    return output.copy()
+
+  numpy.set_array_base(output, owner)
+  return output
+
 cdef arma.Mat[double]* numpy_to_mat_d(numpy.ndarray[numpy.double_t, ndim=2] X, \
                                       bool takeOwnership) except +:
   """
   Convert a numpy ndarray to a matrix.  The memory will still be owned by numpy.
   """
-  if not (X.flags.c_contiguous or X.flags.owndata):
+  if not X.flags.c_contiguous:
     # If needed, make a copy where we own the memory.
     X = X.copy(order="C")
     takeOwnership = True
@@ -57,6 +103,8 @@ cdef arma.Mat[double]* numpy_to_mat_d(numpy.ndarray[numpy.double_t, ndim=2] X, \
   if takeOwnership:
     PyArray_CLEARFLAGS(X, numpy.NPY_OWNDATA)
     SetMemState[arma.Mat[double]](m[0], 0)
+  else:
+    borrow(X)
 
   return m
 
@@ -65,7 +113,7 @@ cdef arma.Mat[size_t]* numpy_to_mat_s(numpy.ndarray[numpy.npy_intp, ndim=2] X, \
   """
   Convert a numpy ndarray to a matrix.  The memory will still be owned by numpy.
   """
-  if not (X.flags.c_contiguous or X.flags.owndata):
+  if not X.flags.c_contiguous:
     # If needed, make a copy where we own the memory.
     X = X.copy(order="C")
     takeOwnership = True
@@ -77,6 +125,8 @@ cdef arma.Mat[size_t]* numpy_to_mat_s(numpy.ndarray[numpy.npy_intp, ndim=2] X, \
   if takeOwnership:
     PyArray_CLEARFLAGS(X, numpy.NPY_OWNDATA)
     SetMemState[arma.Mat[size_t]](m[0], 0)
+  else:
+    borrow(X)
 
   return m
 
@@ -92,12 +142,12 @@ cdef numpy.ndarray[numpy.double_t, ndim=2] mat_to_numpy_d(arma.Mat[double]& X) \
   cdef numpy.ndarray[numpy.double_t, ndim=2] output = \
       numpy.PyArray_SimpleNewFromData(2, &dims[0], numpy.NPY_DOUBLE, GetMemory(X))
 
-  # Transfer memory ownership, if needed.
-  if GetMemState[arma.Mat[double]](X) == 0:
+  # Transfer memory ownership, or keep the owner of the memory alive.
+  cdef size_t memState = GetMemState[arma.Mat[double]](X)
+  if memState == 0:
     SetMemState[arma.Mat[double]](X, 1)
-    PyArray_ENABLEFLAGS(output, numpy.NPY_OWNDATA)
 
-  return output
+  return set_owner(output, memState)
 
 cdef numpy.ndarray[numpy.npy_intp, ndim=2] mat_to_numpy_s(arma.Mat[size_t]& X) \
     except +:
@@ -111,12 +161,12 @@ cdef numpy.ndarray[numpy.npy_intp, ndim=2] mat_to_numpy_s(arma.Mat[size_t]& X) \
   cdef numpy.ndarray[numpy.npy_intp, ndim=2] output = \
       numpy.PyArray_SimpleNewFromData(2, &dims[0], numpy.NPY_INTP, GetMemory(X))
 
-  # Transfer memory ownership, if needed.
-  if GetMemState[arma.Mat[size_t]](X) == 0:
+  # Transfer memory ownership, or keep the owner of the memory alive.
+  cdef size_t memState = GetMemState[arma.Mat[size_t]](X)
+  if memState == 0:
     SetMemState[arma.Mat[size_t]](X, 1)
-    PyArray_ENABLEFLAGS(output, numpy.NPY_OWNDATA)
 
-  return output
+  return set_owner(output, memState)
 
 cdef arma.Row[double]* numpy_to_row_d(numpy.ndarray[numpy.double_t, ndim=1] X, \
                                       bool takeOwnership) except +:
@@ -124,7 +174,7 @@ cdef arma.Row[double]* numpy_to_row_d(numpy.ndarray[numpy.double_t, ndim=1] X, \
   Convert a numpy one-dimensional ndarray to a row.  The memory will still be
   owned by numpy.
   """
-  if not (X.flags.c_contiguous or X.flags.owndata):
+  if not X.flags.c_contiguous:
     # If needed, make a copy where we own the memory.
     X = X.copy(order="C")
     takeOwnership = True
@@ -136,6 +186,8 @@ cdef arma.Row[double]* numpy_to_row_d(numpy.ndarray[numpy.double_t, ndim=1] X, \
   if takeOwnership:
     PyArray_CLEARFLAGS(X, numpy.NPY_OWNDATA)
     SetMemState[arma.Row[double]](m[0], 0)
+  else:
+    borrow(X)
 
   return m
 
@@ -145,7 +197,7 @@ cdef arma.Row[size_t]* numpy_to_row_s(numpy.ndarray[numpy.npy_intp, ndim=1] X, \
   Convert a numpy one-dimensional ndarray to a row.  The memory will still be
   owned by numpy.
   """
-  if not (X.flags.c_contiguous or X.flags.owndata):
+  if not X.flags.c_contiguous:
     # If needed, make a copy where we own the memory.
     X = X.copy(order="C")
     takeOwnership = True
@@ -157,6 +209,8 @@ cdef arma.Row[size_t]* numpy_to_row_s(numpy.ndarray[numpy.npy_intp, ndim=1] X, \
   if takeOwnership:
     PyArray_CLEARFLAGS(X, numpy.NPY_OWNDATA)
     SetMemState[arma.Row[size_t]](m[0], 0)
+  else:
+    borrow(X)
 
   return m
 
@@ -170,12 +224,12 @@ cdef numpy.ndarray[numpy.double_t, ndim=1] row_to_numpy_d(arma.Row[double]& X) \
   cdef numpy.ndarray[numpy.double_t, ndim=1] output = \
       numpy.PyArray_SimpleNewFromData(1, &dim, numpy.NPY_DOUBLE, GetMemory(X))
 
-  # Transfer memory ownership, if needed.
-  if GetMemState[arma.Row[double]](X) == 0:
+  # Transfer memory ownership, or keep the owner of the memory alive.
+  cdef size_t memState = GetMemState[arma.Row[double]](X)
+  if memState == 0:
     SetMemState[arma.Row[double]](X, 1)
-    PyArray_ENABLEFLAGS(output, numpy.NPY_OWNDATA)
 
-  return output
+  return set_owner(output, memState)
 
 cdef numpy.ndarray[numpy.npy_intp, ndim=1] row_to_numpy_s(arma.Row[size_t]& X) \
     except +:
@@ -187,12 +241,12 @@ cdef numpy.ndarray[numpy.npy_intp, ndim=1] row_to_numpy_s(arma.Row[size_t]& X) \
   cdef numpy.ndarray[numpy.npy_intp, ndim=1] output = \
       numpy.PyArray_SimpleNewFromData(1, &dim, numpy.NPY_INTP, GetMemory(X))
 
-  # Transfer memory ownership, if needed.
-  if GetMemState[arma.Row[size_t]](X) == 0:
+  # Transfer memory ownership, or keep the owner of the memory alive.
+  cdef size_t memState = GetMemState[arma.Row[size_t]](X)
+  if memState == 0:
     SetMemState[arma.Row[size_t]](X, 1)
-    PyArray_ENABLEFLAGS(output, numpy.NPY_OWNDATA)
 
-  return output
+  return set_owner(output, memState)
 
 cdef arma.Col[double]* numpy_to_col_d(numpy.ndarray[numpy.double_t, ndim=1] X, \
                                       bool takeOwnership) except +:
@@ -200,7 +254,7 @@ cdef arma.Col[double]* numpy_to_col_d(numpy.ndarray[numpy.double_t, ndim=1] X, \
   Convert a numpy one-dimensional ndarray to a column vector.  The memory will
   still be owned by numpy.
   """
-  if not (X.flags.c_contiguous or X.flags.owndata):
+  if not X.flags.c_contiguous:
     # If needed, make a copy where we own the memory.
     X = X.copy(order="C")
     takeOwnership = True
@@ -212,6 +266,8 @@ cdef arma.Col[double]* numpy_to_col_d(numpy.ndarray[numpy.double_t, ndim=1] X, \
   if takeOwnership:
     PyArray_CLEARFLAGS(X, numpy.NPY_OWNDATA)
     SetMemState[arma.Col[double]](m[0], 0)
+  else:
+    borrow(X)
 
   return m
 
@@ -221,9 +277,10 @@ cdef arma.Col[size_t]* numpy_to_col_s(numpy.ndarray[numpy.npy_intp, ndim=1] X, \
   Convert a numpy one-dimensional ndarray to a column vector.  The memory will
   still be owned by numpy.
   """
-  if not (X.flags.c_contiguous or X.flags.owndata):
+  if not X.flags.c_contiguous:
     # If needed, make a copy where we own the memory.
     X = X.copy(order="C")
+    takeOwnership = True
 
   cdef arma.Col[size_t]* m = new arma.Col[size_t](<size_t*> X.data, X.shape[0],
       False, False)
@@ -232,6 +289,8 @@ cdef arma.Col[size_t]* numpy_to_col_s(numpy.ndarray[numpy.npy_intp, ndim=1] X, \
   if takeOwnership:
     PyArray_CLEARFLAGS(X, numpy.NPY_OWNDATA)
     SetMemState[arma.Col[size_t]](m[0], 0)
+  else:
+    borrow(X)
 
   return m
 
@@ -245,12 +304,12 @@ cdef numpy.ndarray[numpy.double_t, ndim=1] col_to_numpy_d(arma.Col[double]& X) \
   cdef numpy.ndarray[numpy.double_t, ndim=1] output = \
       numpy.PyArray_SimpleNewFromData(1, &dim, numpy.NPY_DOUBLE, GetMemory(X))
 
-  # Transfer memory ownership, if needed.
-  if GetMemState[arma.Col[double]](X) == 0:
+  # Transfer memory ownership, or keep the owner of the memory alive.
+  cdef size_t memState = GetMemState[arma.Col[double]](X)
+  if memState == 0:
     SetMemState[arma.Col[double]](X, 1)
-    PyArray_ENABLEFLAGS(output, numpy.NPY_OWNDATA)
 
-  return output
+  return set_owner(output, memState)
 
 cdef numpy.ndarray[numpy.npy_intp, ndim=1] col_to_numpy_s(arma.Col[size_t]& X) \
     except +:
@@ -262,9 +321,9 @@ cdef numpy.ndarray[numpy.npy_intp, ndim=1] col_to_numpy_s(arma.Col[size_t]& X) \
   cdef numpy.ndarray[numpy.npy_intp, ndim=1] output = \
       numpy.PyArray_SimpleNewFromData(1, &dim, numpy.NPY_INTP, GetMemory(X))
 
-  # Transfer memory ownership, if needed.
-  if GetMemState[arma.Col[size_t]](X) == 0:
+  # Transfer memory ownership, or keep the owner of the memory alive.
+  cdef size_t memState = GetMemState[arma.Col[size_t]](X)
+  if memState == 0:
     SetMemState[arma.Col[size_t]](X, 1)
-    PyArray_ENABLEFLAGS(output, numpy.NPY_OWNDATA)
 
-  return output
+  return set_owner(output, memState)
@@ -38,6 +38,19 @@ cdef extern from "<mlpack/core/util/cli.hpp>" namespace "mlpack" nogil:
     @staticmethod
     void ClearSettings() nogil except +
 
+  # The parameters and timers of one call of a binding.
+  cdef cppclass CLIContext "mlpack::CLI::Context":
+    CLIContext() nogil except +
+
+  # Keeps the bindings that set the random seed from running at once.
+  cdef cppclass CLIRandomScope "mlpack::CLI::RandomScope":
+    CLIRandomScope() nogil except +
+
+cdef extern from "<mlpack/core/util/threads.hpp>" namespace "mlpack" nogil:
+  # The number of threads used by one call of a binding.
+  cdef cppclass ThreadsScope "mlpack::Threads::Scope":
+    pass
+
 cdef extern from "<mlpack/bindings/python/mlpack/cli_util.hpp>" \
     namespace "mlpack::util" nogil:
   void SetParam[T](string, T&) nogil except +
@@ -50,3 +63,4 @@ cdef extern from "<mlpack/bindings/python/mlpack/cli_util.hpp>" \
   void DisableBacktrace() nogil except +
   void ResetTimers() nogil except +
   void EnableTimers() nogil except +
+  (ThreadsScope*) NewThreadsScope() nogil except +
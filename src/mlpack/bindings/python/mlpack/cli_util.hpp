@@ -14,7 +14,9 @@
 #define MLPACK_BINDINGS_PYTHON_CYTHON_CLI_UTIL_HPP
 
 #include <mlpack/core/util/cli.hpp>
+#include <mlpack/core/util/threads.hpp>
 #include <mlpack/core/data/dataset_mapper.hpp>
+#include <stdexcept>
 
 namespace mlpack {
 namespace util {
@@ -163,6 +165,22 @@ inline void EnableTimers()
   Timer::EnableTiming();
 }
 
+/**
+ * Use the number of threads given by the "threads" parameter on the calling
+ * thread, until the returned scope is deleted.
+ */
+inline Threads::Scope* NewThreadsScope()
+{
+  const int threads = CLI::GetParam<int>("threads");
+  if (threads < 0)
+  {
+    throw std::invalid_argument("invalid value for 'threads': " +
+        std::to_string(threads) + "; must be 0 or greater");
+  }
+
+  return new Threads::Scope((size_t) threads);
+}
+
 } // namespace util
 } // namespace mlpack
 
@@ -463,7 +463,6 @@ void PrintInputProcessing(
    *       dereference(param_name_mat), &param_name_tuple[1][0])
    *   CLI.SetPassed(<const string> 'param_name')
    */
-  std::cout << prefix << "cdef np.ndarray " << d.name << "_dims" << std::endl;
   std::cout << prefix << "# Detect if the parameter was passed; set if so."
       << std::endl;
   if (!d.required)
@@ -482,7 +481,8 @@ void PrintInputProcessing(
         << "_tuple[2]" << std::endl;
     std::cout << prefix << "  SetParamWithInfo[arma.Mat[double]](<const "
         << "string> '" << d.name << "', dereference(" << d.name << "_mat), "
-        << "<const cbool*> " << d.name << "_dims.data)" << std::endl;
+        << "<const cbool*> (<np.ndarray> " << d.name << "_dims).data)"
+        << std::endl;
     std::cout << prefix << "  CLI.SetPassed(<const string> '" << d.name
         << "')" << std::endl;
     std::cout << prefix << "  del " << d.name << "_mat" << std::endl;
@@ -502,7 +502,8 @@ void PrintInputProcessing(
         << std::endl;
     std::cout << prefix << "SetParamWithInfo[arma.Mat[double]](<const "
         << "string> '" << d.name << "', dereference(" << d.name << "_mat), "
-        << "<const cbool*> " << d.name << "_dims.data)" << std::endl;
+        << "<const cbool*> (<np.ndarray> " << d.name << "_dims).data)"
+        << std::endl;
     std::cout << prefix << "CLI.SetPassed(<const string> '" << d.name << "')"
         << std::endl;
     std::cout << prefix << "del " << d.name << "_mat" << std::endl;
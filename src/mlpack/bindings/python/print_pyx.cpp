@@ -75,11 +75,12 @@ void PrintPYX(const ProgramDoc& programInfo,
   // Now import all the necessary packages.
   cout << "cimport arma" << endl;
   cout << "cimport arma_numpy" << endl;
-  cout << "from cli cimport CLI" << endl;
+  cout << "from cli cimport CLI, CLIContext, CLIRandomScope, ThreadsScope"
+      << endl;
   cout << "from cli cimport SetParam, SetParamPtr, SetParamWithInfo, "
       << "GetParamPtr" << endl;
   cout << "from cli cimport EnableVerbose, DisableVerbose, DisableBacktrace, "
-      << "ResetTimers, EnableTimers" << endl;
+      << "ResetTimers, EnableTimers, NewThreadsScope" << endl;
   cout << "from matrix_utils import to_matrix, to_matrix_with_info" << endl;
   cout << "from serialization cimport SerializeIn, SerializeOut" << endl;
   cout << endl;
@@ -177,24 +178,31 @@ void PrintPYX(const ProgramDoc& programInfo,
       << "returned." << endl;
   cout << "  \"\"\"" << endl;
 
+  // Each call gets its own parameters and timers, so that bindings can be
+  // called from several threads at once.
+  cout << "  cdef CLIContext* context = new CLIContext()" << endl;
+  cout << "  cdef ThreadsScope* threadsScope = NULL" << endl;
+  cout << "  cdef CLIRandomScope* randomScope = NULL" << endl;
+  cout << "  try:" << endl;
+
   // Reset any timers and disable backtraces.
-  cout << "  ResetTimers()" << endl;
-  cout << "  EnableTimers()" << endl;
-  cout << "  DisableBacktrace()" << endl;
-  cout << "  DisableVerbose()" << endl;
+  cout << "    ResetTimers()" << endl;
+  cout << "    EnableTimers()" << endl;
+  cout << "    DisableBacktrace()" << endl;
+  cout << "    DisableVerbose()" << endl;
 
   // Restore the parameters.
-  cout << "  CLI.RestoreSettings(\"" << programInfo.programName << "\")"
+  cout << "    CLI.RestoreSettings(\"" << programInfo.programName << "\")"
       << endl;
 
   // Determine whether or not we need to copy parameters.
-  cout << "  if isinstance(copy_all_inputs, bool):" << endl;
-  cout << "    if copy_all_inputs:" << endl;
-  cout << "      SetParam[cbool](<const string> 'copy_all_inputs', "
+  cout << "    if isinstance(copy_all_inputs, bool):" << endl;
+  cout << "      if copy_all_inputs:" << endl;
+  cout << "        SetParam[cbool](<const string> 'copy_all_inputs', "
       << "copy_all_inputs)" << endl;
-  cout << "      CLI.SetPassed(<const string> 'copy_all_inputs')" << endl;
-  cout << "  else:" << endl;
-  cout << "    raise TypeError(" <<"\"'copy_all_inputs\' must have type "
+  cout << "        CLI.SetPassed(<const string> 'copy_all_inputs')" << endl;
+  cout << "    else:" << endl;
+  cout << "      raise TypeError(" <<"\"'copy_all_inputs\' must have type "
       << "\'bool'!\")" << endl;
   cout << endl;
 
@@ -203,43 +211,52 @@ void PrintPYX(const ProgramDoc& programInfo,
   {
     const util::ParamData& d = parameters.at(inputOptions[i]);
 
-    size_t indent = 2;
+    size_t indent = 4;
     CLI::GetSingleton().functionMap[d.tname]["PrintInputProcessing"](d,
         (void*) &indent, NULL);
   }
 
   // Set all output options as passed.
-  cout << "  # Mark all output options as passed." << endl;
+  cout << "    # Mark all output options as passed." << endl;
   for (size_t i = 0; i < outputOptions.size(); ++i)
   {
     const util::ParamData& d = parameters.at(outputOptions[i]);
-    cout << "  CLI.SetPassed(<const string> '" << d.name << "')" << endl;
+    cout << "    CLI.SetPassed(<const string> '" << d.name << "')" << endl;
   }
 
-  // Call the method.
-  cout << "  # Call the mlpack program." << endl;
-  cout << "  mlpackMain()" << endl;
+  // Call the method with the requested number of threads, without the GIL,
+  // so that other Python threads can run.  Bindings that set the random seed
+  // share the random number generator, so they wait for each other.
+  cout << "    threadsScope = NewThreadsScope()" << endl;
+  cout << "    # Call the mlpack program." << endl;
+  cout << "    with nogil:" << endl;
+  cout << "      randomScope = new CLIRandomScope()" << endl;
+  cout << "      mlpackMain()" << endl;
 
   // Do any output processing and return.
-  cout << "  # Initialize result dictionary." << endl;
-  cout << "  result = {}" << endl;
+  cout << "    # Initialize result dictionary." << endl;
+  cout << "    result = {}" << endl;
   cout << endl;
 
   for (size_t i = 0; i < outputOptions.size(); ++i)
   {
     const util::ParamData& d = parameters.at(outputOptions[i]);
 
-    std::tuple<size_t, bool> t = std::make_tuple(2, false);
+    std::tuple<size_t, bool> t = std::make_tuple(4, false);
     CLI::GetSingleton().functionMap[d.tname]["PrintOutputProcessing"](d,
         (void*) &t, NULL);
   }
 
   // Clear the parameters.
   cout << endl;
-  cout << "  CLI.ClearSettings()" << endl;
+  cout << "    CLI.ClearSettings()" << endl;
   cout << endl;
 
-  cout << "  return result" << endl;
+  cout << "    return result" << endl;
+  cout << "  finally:" << endl;
+  cout << "    del randomScope" << endl;
+  cout << "    del threadsScope" << endl;
+  cout << "    del context" << endl;
 }
 
 } // namespace python
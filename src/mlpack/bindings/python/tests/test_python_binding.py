@@ -13,6 +13,7 @@ import unittest
 import pandas as pd
 import numpy as np
 import copy
+import threading
 
 from mlpack.test_python_binding import test_python_binding
 
@@ -207,6 +208,28 @@ class TestPythonBinding(unittest.TestCase):
     for j in range(100):
       self.assertEqual(2 * x[j, 2], output['matrix_out'][j, 2])
 
+  def testNumpyMatrixNoCopy(self):
+    """
+    A matrix that is modified in place should be returned without any copies,
+    and the output should stay valid after the input is gone.
+    """
+    x = np.random.rand(100, 5)
+    z = copy.deepcopy(x)
+
+    output = test_python_binding(string_in='hello',
+                                 int_in=12,
+                                 double_in=4.0,
+                                 mat_req_in=[[1.0]],
+                                 col_req_in=[1.0],
+                                 smatrix_in=z)
+
+    self.assertTrue(np.shares_memory(output['smatrix_out'], z))
+
+    del z
+    for i in range(5):
+      for j in range(100):
+        self.assertEqual(output['smatrix_out'][j, i], 2 * x[j, i])
+
   def testPandasSeriesMatrix(self):
     """
     Test that we can pass pandas.Series as input parameter.
@@ -1336,5 +1359,39 @@ class TestPythonBinding(unittest.TestCase):
     self.assertEqual(output2['model_bw_out'], 20.0)
     self.assertEqual(output3['model_bw_out'], 20.0)
 
+  def testConcurrentCalls(self):
+    """
+    Each call of a binding has its own parameters, so the binding can be called
+    from several threads at once.
+    """
+    results = [None] * 8
+    inputs = [np.random.rand(100, 5) for i in range(8)]
+    def run(i):
+      results[i] = test_python_binding(string_in='hello',
+                                       int_in=12,
+                                       double_in=4.0,
+                                       mat_req_in=[[1.0]],
+                                       col_req_in=[1.0],
+                                       matrix_in=inputs[i],
+                                       flag1=True)
+
+    threads = [threading.Thread(target=run, args=(i,)) for i in range(8)]
+    for t in threads:
+      t.start()
+    for t in threads:
+      t.join()
+
+    for i in range(8):
+      self.assertEqual(results[i]['string_out'], 'hello2')
+      self.assertEqual(results[i]['int_out'], 13)
+      self.assertEqual(results[i]['double_out'], 5.0)
+      self.assertEqual(results[i]['matrix_out'].shape[0], 100)
+      self.assertEqual(results[i]['matrix_out'].shape[1], 4)
+      for j in [0, 1, 3]:
+        for k in range(100):
+          self.assertEqual(results[i]['matrix_out'][k, j], inputs[i][k, j])
+      for k in range(100):
+        self.assertEqual(results[i]['matrix_out'][k, 2], 2 * inputs[i][k, 2])
+
 if __name__ == '__main__':
   unittest.main()
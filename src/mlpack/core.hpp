@@ -70,6 +70,9 @@
 #include <mlpack/core/util/arma_traits.hpp>
 #include <mlpack/core/util/log.hpp>
 #include <mlpack/core/util/cli.hpp>
+#include <mlpack/core/util/scoped_timer.hpp>
+#include <mlpack/core/util/threads.hpp>
+#include <mlpack/core/util/memory_tracker.hpp>
 #include <mlpack/core/util/deprecated.hpp>
 #include <mlpack/core/data/load.hpp>
 #include <mlpack/core/data/save.hpp>
@@ -82,6 +85,7 @@
 #include <mlpack/core/math/round.hpp>
 #include <mlpack/core/math/shuffle_data.hpp>
 #include <mlpack/core/math/ccov.hpp>
+#include <mlpack/core/math/running_moments.hpp>
 #include <mlpack/core/math/make_alias.hpp>
 #include <mlpack/core/dists/discrete_distribution.hpp>
 #include <mlpack/core/dists/gaussian_distribution.hpp>
@@ -21,6 +21,13 @@
 #define ARMA_EXTRA_CUBE_PROTO mlpack/core/arma_extend/Cube_extra_bones.hpp
 #define ARMA_EXTRA_CUBE_MEAT mlpack/core/arma_extend/Cube_extra_meat.hpp
 
+// Count the memory of matrices, if mlpack is compiled with memory tracking.
+#if defined(MLPACK_MEMORY_TRACKING) && !defined(ARMA_ALIEN_MEM_ALLOC_FUNCTION)
+  #include <mlpack/core/util/memory_tracker.hpp>
+  #define ARMA_ALIEN_MEM_ALLOC_FUNCTION ::mlpack::MemoryTracker::Allocate
+  #define ARMA_ALIEN_MEM_FREE_FUNCTION ::mlpack::MemoryTracker::Free
+#endif
+
 // Manually set ARMA_{64,32}BIT_WORD for _WIN64 or win32
 #if defined(_MSC_VER)
     #ifdef _WIN64
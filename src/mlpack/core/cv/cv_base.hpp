@@ -13,6 +13,7 @@
 #define MLPACK_CORE_CV_CV_BASE_HPP
 
 #include <mlpack/core/cv/meta_info_extractor.hpp>
+#include <mlpack/core/cv/warm_start.hpp>
 
 namespace mlpack {
 namespace cv {
@@ -98,6 +99,18 @@ class CVBase
                     const WeightsType& weights,
                     const MLAlgorithmArgs&... args);
 
+  /**
+   * Train MLAlgorithm with given data points, predictions, and hyperparameters
+   * depending on what CVBase constructor has been called, starting from the
+   * solution of the given trained model if WarmStart<MLAlgorithm> supports it
+   * (and from scratch otherwise).
+   */
+  template<typename... MLAlgorithmArgs>
+  MLAlgorithm WarmStartTrain(const MLAlgorithm& previous,
+                             const MatType& xs,
+                             const PredictionsType& ys,
+                             const MLAlgorithmArgs&... args);
+
  private:
   static_assert(MIE::IsSupported,
       "The given MLAlgorithm is not supported by MetaInfoExtractor");
@@ -121,6 +134,28 @@ class CVBase
   static void AssertWeightsSize(const MatType& xs,
                                 const WeightsType& weights);
 
+  /**
+   * Train a new MLAlgorithm model, since models of this type can't be
+   * warm-started.
+   */
+  template<typename... MLAlgorithmArgs>
+  MLAlgorithm WarmStartTrain(std::false_type /* supported */,
+                             const MLAlgorithm& previous,
+                             const MatType& xs,
+                             const PredictionsType& ys,
+                             const MLAlgorithmArgs&... args);
+
+  /**
+   * Train a copy of the given model from its solution, if the hyperparameters
+   * allow it, or a new MLAlgorithm model otherwise.
+   */
+  template<typename... MLAlgorithmArgs>
+  MLAlgorithm WarmStartTrain(std::true_type /* supported */,
+                             const MLAlgorithm& previous,
+                             const MatType& xs,
+                             const PredictionsType& ys,
+                             const MLAlgorithmArgs&... args);
+
   /**
    * Construct a trained MLAlgorithm model if MLAlgorithm doesn't take the
    * numClasses parameter.
@@ -94,6 +94,71 @@ MLAlgorithm CVBase<MLAlgorithm,
   return TrainModel(xs, ys, weights, args...);
 }
 
+template<typename MLAlgorithm,
+         typename MatType,
+         typename PredictionsType,
+         typename WeightsType>
+template<typename... MLAlgorithmArgs>
+MLAlgorithm CVBase<MLAlgorithm,
+                   MatType,
+                   PredictionsType,
+                   WeightsType>::WarmStartTrain(const MLAlgorithm& previous,
+                                                const MatType& xs,
+                                                const PredictionsType& ys,
+                                                const MLAlgorithmArgs&... args)
+{
+  return WarmStartTrain(std::integral_constant<bool,
+      WarmStart<MLAlgorithm>::IsSupported>(), previous, xs, ys, args...);
+}
+
+template<typename MLAlgorithm,
+         typename MatType,
+         typename PredictionsType,
+         typename WeightsType>
+template<typename... MLAlgorithmArgs>
+MLAlgorithm CVBase<MLAlgorithm,
+                   MatType,
+                   PredictionsType,
+                   WeightsType>::WarmStartTrain(
+    std::false_type /* supported */,
+    const MLAlgorithm& /* previous */,
+    const MatType& xs,
+    const PredictionsType& ys,
+    const MLAlgorithmArgs&... args)
+{
+  return TrainModel(xs, ys, args...);
+}
+
+template<typename MLAlgorithm,
+         typename MatType,
+         typename PredictionsType,
+         typename WeightsType>
+template<typename... MLAlgorithmArgs>
+MLAlgorithm CVBase<MLAlgorithm,
+                   MatType,
+                   PredictionsType,
+                   WeightsType>::WarmStartTrain(
+    std::true_type /* supported */,
+    const MLAlgorithm& previous,
+    const MatType& xs,
+    const PredictionsType& ys,
+    const MLAlgorithmArgs&... args)
+{
+  // Models that take a data::DatasetInfo parameter are always trained from
+  // scratch.
+  if (!isDatasetInfoPassed)
+  {
+    MLAlgorithm model(previous);
+    const bool warmStarted = MIE::TakesNumClasses ?
+        detail::TryWarmStart(model, xs, ys, 0, numClasses, args...) :
+        detail::TryWarmStart(model, xs, ys, 0, args...);
+    if (warmStarted)
+      return model;
+  }
+
+  return TrainModel(xs, ys, args...);
+}
+
 template<typename MLAlgorithm,
          typename MatType,
          typename PredictionsType,
@@ -14,6 +14,7 @@
 
 #include <mlpack/core/cv/meta_info_extractor.hpp>
 #include <mlpack/core/cv/cv_base.hpp>
+#include <exception>
 
 namespace mlpack {
 namespace cv {
@@ -44,6 +45,18 @@ namespace cv {
  * the @c Shuffle() function.  Shuffling is performed at construction time if
  * the parameter @c shuffle is set to @c true in the constructor.
  *
+ * The data is stored so that the training set of every fold is a contiguous
+ * block of columns, so the folds are trained on aliases, without copies.  The
+ * folds can be trained and evaluated in parallel (if OpenMP is available) by
+ * setting @c MaxParallelFolds(); this is only safe if MLAlgorithm can be
+ * trained on several threads at once.
+ *
+ * @code
+ * KFoldCV<RandomForest<>, Accuracy> cv(10, data, labels, numClasses);
+ * cv.MaxParallelFolds() = 4; // Evaluate up to 4 folds at once.
+ * double accuracy = cv.Evaluate(20);
+ * @endcode
+ *
  * @tparam MLAlgorithm A machine learning algorithm.
  * @tparam Metric A metric to assess the quality of a trained model.
  * @tparam MatType The type of data.
@@ -177,9 +190,38 @@ class KFoldCV
   template<typename... MLAlgorithmArgs>
   double Evaluate(const MLAlgorithmArgs& ...args);
 
+  /**
+   * Copy the data and settings of the given object (but not its last trained
+   * model).  A copy shares nothing with the original, so the two can be
+   * evaluated on different threads at once.
+   *
+   * @param other Object to copy.
+   */
+  KFoldCV(const KFoldCV& other);
+
   //! Access and modify a model from the last run of k-fold cross-validation.
   MLAlgorithm& Model();
 
+  //! Get the maximum number of folds that are trained and evaluated at once.
+  size_t MaxParallelFolds() const { return maxParallelFolds; }
+  //! Modify the maximum number of folds that are trained and evaluated at once
+  //! (0 means as many as there are OpenMP threads).  Each fold being evaluated
+  //! holds its own model, so this bounds the memory used.  The default is 1,
+  //! because folds can only be evaluated in parallel if training MLAlgorithm
+  //! on several threads at once is safe.
+  size_t& MaxParallelFolds() { return maxParallelFolds; }
+
+  //! Get whether each fold starts training from the model of the previous
+  //! fold.
+  bool WarmStart() const { return warmStart; }
+  //! Modify whether each fold starts training from the model of the previous
+  //! fold (and the first fold from the last model of the previous call to
+  //! Evaluate()).  This is only done for models that cv::WarmStart supports,
+  //! without weights, and when the folds are evaluated one at a time.  It
+  //! speeds up sweeps over hyper-parameters, like a regularization path, since
+  //! each model starts near its solution.
+  bool& WarmStart() { return warmStart; }
+
  private:
   //! A short alias for CVBase.
   using Base = CVBase<MLAlgorithm, MatType, PredictionsType, WeightsType>;
@@ -225,6 +267,12 @@ class KFoldCV
   //! A pointer to a model from the last run of k-fold cross-validation.
   std::unique_ptr<MLAlgorithm> modelPtr;
 
+  //! The maximum number of folds that are trained and evaluated at once.
+  size_t maxParallelFolds;
+
+  //! Whether each fold starts training from the model of the previous fold.
+  bool warmStart;
+
   /**
    * Assert the k parameter and data consistency and initialize fields required
    * for running k-fold cross-validation.
@@ -270,6 +318,9 @@ class KFoldCV
            typename = void>
   double TrainAndEvaluate(const MLAlgorithmArgs& ...mlAlgorithmArgs);
 
+  //! Get the number of threads to evaluate the folds on.
+  int FoldThreads() const;
+
   /**
    * Calculate the index of the first column of the ith validation subset.
    *
@@ -135,7 +135,9 @@ KFoldCV<MLAlgorithm,
                               const PredictionsType& ys,
                               const bool shuffle) :
     base(std::move(base)),
-    k(k)
+    k(k),
+    maxParallelFolds(1),
+    warmStart(false)
 {
   if (k < 2)
     throw std::invalid_argument("KFoldCV: k should not be less than 2");
@@ -166,7 +168,9 @@ KFoldCV<MLAlgorithm,
                               const WeightsType& weights,
                               const bool shuffle) :
     base(std::move(base)),
-    k(k)
+    k(k),
+    maxParallelFolds(1),
+    warmStart(false)
 {
   Base::AssertWeightsConsistency(xs, weights);
 
@@ -179,6 +183,27 @@ KFoldCV<MLAlgorithm,
     Shuffle();
 }
 
+template<typename MLAlgorithm,
+         typename Metric,
+         typename MatType,
+         typename PredictionsType,
+         typename WeightsType>
+KFoldCV<MLAlgorithm,
+        Metric,
+        MatType,
+        PredictionsType,
+        WeightsType>::KFoldCV(const KFoldCV& other) :
+    base(other.base),
+    k(other.k),
+    xs(other.xs),
+    ys(other.ys),
+    weights(other.weights),
+    lastBinSize(other.lastBinSize),
+    binSize(other.binSize),
+    maxParallelFolds(other.maxParallelFolds),
+    warmStart(other.warmStart)
+{ /* Nothing left to do. */ }
+
 template<typename MLAlgorithm,
          typename Metric,
          typename MatType,
@@ -246,16 +271,42 @@ double KFoldCV<MLAlgorithm,
 {
   arma::vec evaluations(k);
 
-  for (size_t i = 0; i < k; ++i)
+  // Exceptions can't leave the parallel region, so keep the one of the first
+  // fold that failed.
+  size_t firstError = k;
+  std::exception_ptr error;
+
+  // Warm starts chain the folds, so they need the folds in order.
+  const bool warm = warmStart && (FoldThreads() == 1);
+  #pragma omp parallel for num_threads(FoldThreads()) schedule(dynamic)
+  for (omp_size_t i = 0; i < (omp_size_t) k; ++i)
   {
-    MLAlgorithm&& model  = base.Train(GetTrainingSubset(xs, i),
-        GetTrainingSubset(ys, i), args...);
-    evaluations(i) = Metric::Evaluate(model, GetValidationSubset(xs, i),
-        GetValidationSubset(ys, i));
-    if (i == k - 1)
-      modelPtr.reset(new MLAlgorithm(std::move(model)));
+    try
+    {
+      MLAlgorithm&& model = (warm && modelPtr) ?
+          base.WarmStartTrain(*modelPtr, GetTrainingSubset(xs, i),
+              GetTrainingSubset(ys, i), args...) :
+          base.Train(GetTrainingSubset(xs, i), GetTrainingSubset(ys, i),
+              args...);
+      evaluations(i) = Metric::Evaluate(model, GetValidationSubset(xs, i),
+          GetValidationSubset(ys, i));
+      if ((size_t) i == k - 1 || warm)
+        modelPtr.reset(new MLAlgorithm(std::move(model)));
+    }
+    catch (...)
+    {
+      #pragma omp critical
+      if ((size_t) i < firstError)
+      {
+        firstError = i;
+        error = std::current_exception();
+      }
+    }
   }
 
+  if (error)
+    std::rethrow_exception(error);
+
   return arma::mean(evaluations);
 }
 
@@ -273,19 +324,46 @@ double KFoldCV<MLAlgorithm,
 {
   arma::vec evaluations(k);
 
-  for (size_t i = 0; i < k; ++i)
+  // Exceptions can't leave the parallel region, so keep the one of the first
+  // fold that failed.
+  size_t firstError = k;
+  std::exception_ptr error;
+
+  // Warm starts chain the folds, so they need the folds in order.
+  const bool warm = warmStart && (weights.n_elem == 0) &&
+      (FoldThreads() == 1);
+  #pragma omp parallel for num_threads(FoldThreads()) schedule(dynamic)
+  for (omp_size_t i = 0; i < (omp_size_t) k; ++i)
   {
-    MLAlgorithm&& model = (weights.n_elem > 0) ?
-        base.Train(GetTrainingSubset(xs, i), GetTrainingSubset(ys, i),
-            GetTrainingSubset(weights, i), args...) :
-        base.Train(GetTrainingSubset(xs, i), GetTrainingSubset(ys, i),
-            args...);
-    evaluations(i) = Metric::Evaluate(model, GetValidationSubset(xs, i),
-        GetValidationSubset(ys, i));
-    if (i == k - 1)
-      modelPtr.reset(new MLAlgorithm(std::move(model)));
+    try
+    {
+      MLAlgorithm&& model = (weights.n_elem > 0) ?
+          base.Train(GetTrainingSubset(xs, i), GetTrainingSubset(ys, i),
+              GetTrainingSubset(weights, i), args...) :
+          (warm && modelPtr) ?
+          base.WarmStartTrain(*modelPtr, GetTrainingSubset(xs, i),
+              GetTrainingSubset(ys, i), args...) :
+          base.Train(GetTrainingSubset(xs, i), GetTrainingSubset(ys, i),
+              args...);
+      evaluations(i) = Metric::Evaluate(model, GetValidationSubset(xs, i),
+          GetValidationSubset(ys, i));
+      if ((size_t) i == k - 1 || warm)
+        modelPtr.reset(new MLAlgorithm(std::move(model)));
+    }
+    catch (...)
+    {
+      #pragma omp critical
+      if ((size_t) i < firstError)
+      {
+        firstError = i;
+        error = std::current_exception();
+      }
+    }
   }
 
+  if (error)
+    std::rethrow_exception(error);
+
   return arma::mean(evaluations);
 }
 
@@ -341,6 +419,24 @@ void KFoldCV<MLAlgorithm,
     InitKFoldCVMat(weightsOrig, weights);
 }
 
+template<typename MLAlgorithm,
+         typename Metric,
+         typename MatType,
+         typename PredictionsType,
+         typename WeightsType>
+int KFoldCV<MLAlgorithm,
+            Metric,
+            MatType,
+            PredictionsType,
+            WeightsType>::FoldThreads() const
+{
+  size_t threads = (maxParallelFolds == 0) ? k : std::min(maxParallelFolds, k);
+  #ifdef HAS_OPENMP
+  threads = std::min(threads, (size_t) omp_get_max_threads());
+  #endif
+  return (int) threads;
+}
+
 template<typename MLAlgorithm,
          typename Metric,
          typename MatType,
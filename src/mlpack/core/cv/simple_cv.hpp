@@ -208,9 +208,26 @@ class SimpleCV
   template<typename... MLAlgorithmArgs>
   double Evaluate(const MLAlgorithmArgs&... args);
 
+  /**
+   * Copy the data of the given object (but not its last trained model).  A
+   * copy shares nothing with the original, so the two can be evaluated on
+   * different threads at once.
+   *
+   * @param other Object to copy.
+   */
+  SimpleCV(const SimpleCV& other);
+
   //! Access and modify the last trained model.
   MLAlgorithm& Model();
 
+  //! Get whether each evaluation starts training from the last trained model.
+  bool WarmStart() const { return warmStart; }
+  //! Modify whether each evaluation starts training from the last trained
+  //! model (only for models that cv::WarmStart supports, and not with
+  //! weights).  This speeds up sweeps over hyper-parameters, like a
+  //! regularization path, since each model starts near its solution.
+  bool& WarmStart() { return warmStart; }
+
  private:
   //! A short alias for CVBase.
   using Base = CVBase<MLAlgorithm, MatType, PredictionsType, WeightsType>;
@@ -240,6 +257,9 @@ class SimpleCV
   //! The pointer to the last trained model.
   std::unique_ptr<MLAlgorithm> modelPtr;
 
+  //! Whether each evaluation starts training from the last trained model.
+  bool warmStart;
+
   /**
    * Assert data consistency and initialize fields required for running
    * cross-validation.
@@ -143,7 +143,8 @@ SimpleCV<MLAlgorithm,
                                 PIT&& ys) :
     base(std::move(base)),
     xs(std::forward<MIT>(xs)),
-    ys(std::forward<PIT>(ys))
+    ys(std::forward<PIT>(ys)),
+    warmStart(false)
 {
   Base::AssertDataConsistency(this->xs, this->ys);
 
@@ -182,6 +183,34 @@ SimpleCV<MLAlgorithm,
   trainingWeights = GetSubset(this->weights, 0, trainingXs.n_cols - 1);
 }
 
+template<typename MLAlgorithm,
+         typename Metric,
+         typename MatType,
+         typename PredictionsType,
+         typename WeightsType>
+SimpleCV<MLAlgorithm,
+         Metric,
+         MatType,
+         PredictionsType,
+         WeightsType>::SimpleCV(const SimpleCV& other) :
+    base(other.base),
+    xs(other.xs),
+    ys(other.ys),
+    weights(other.weights),
+    warmStart(other.warmStart)
+{
+  // The subsets of the other object alias its data, so make new aliases.
+  const size_t numberOfTrainingPoints = other.trainingXs.n_cols;
+
+  trainingXs = GetSubset(xs, 0, numberOfTrainingPoints - 1);
+  trainingYs = GetSubset(ys, 0, numberOfTrainingPoints - 1);
+  if (weights.n_elem > 0)
+    trainingWeights = GetSubset(weights, 0, numberOfTrainingPoints - 1);
+
+  validationXs = GetSubset(xs, numberOfTrainingPoints, xs.n_cols - 1);
+  validationYs = GetSubset(ys, numberOfTrainingPoints, xs.n_cols - 1);
+}
+
 template<typename MLAlgorithm,
          typename Metric,
          typename MatType,
@@ -293,7 +322,16 @@ double SimpleCV<MLAlgorithm,
                 PredictionsType,
                 WeightsType>::TrainAndEvaluate(const MLAlgorithmArgs&... args)
 {
-  modelPtr.reset(new MLAlgorithm(base.Train(trainingXs, trainingYs, args...)));
+  if (warmStart && modelPtr)
+  {
+    modelPtr.reset(new MLAlgorithm(base.WarmStartTrain(*modelPtr, trainingXs,
+        trainingYs, args...)));
+  }
+  else
+  {
+    modelPtr.reset(new MLAlgorithm(base.Train(trainingXs, trainingYs,
+        args...)));
+  }
 
   return Metric::Evaluate(*modelPtr, validationXs, validationYs);
 }
@@ -313,6 +351,9 @@ double SimpleCV<MLAlgorithm,
   if (trainingWeights.n_elem > 0)
     modelPtr.reset(new MLAlgorithm(
         base.Train(trainingXs, trainingYs, trainingWeights, args...)));
+  else if (warmStart && modelPtr)
+    modelPtr.reset(new MLAlgorithm(
+        base.WarmStartTrain(*modelPtr, trainingXs, trainingYs, args...)));
   else
     modelPtr.reset(new MLAlgorithm(
         base.Train(trainingXs, trainingYs, args...)));
@@ -0,0 +1,99 @@
+/**
+ * @file warm_start.hpp
+ *
+ * This provides the WarmStart class, a template class that tells the
+ * cross-validation classes whether and how a trained model can be trained
+ * again from its current solution.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_CV_WARM_START_HPP
+#define MLPACK_CORE_CV_WARM_START_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace cv {
+
+/**
+ * This is a template class that tells SimpleCV and KFoldCV whether a model of
+ * type MLAlgorithm can be warm-started: trained on new data (and possibly with
+ * new hyper-parameters) starting from the solution of a model that is already
+ * trained, instead of from scratch.  By default, models are not warm-started;
+ * a model type that supports it should specialize this class with
+ *
+ * @code
+ * static const bool IsSupported = true;
+ *
+ * // Train the given model in place, starting from its current solution.  The
+ * // arguments after the data are the same as for the constructor of the model
+ * // that trains it (including numClasses, if the model takes it).  Return
+ * // false if the current solution can't be used (for instance, because the
+ * // dimensionality differs); the model is then trained from scratch.
+ * static bool Train(MLAlgorithm& model,
+ *                   const MatType& xs,
+ *                   const PredictionsType& ys,
+ *                   ...);
+ * @endcode
+ *
+ * Only models whose training converges to the same solution from any starting
+ * point (up to the tolerance of the optimizer), such as models with convex
+ * objectives, should be warm-started: the previous model was trained on other
+ * data, which for k-fold cross-validation includes the next validation set.
+ * Incremental models, such as NaiveBayesClassifier or HoeffdingTree, would keep
+ * what they learned from that data, so they are not warm-started.
+ */
+template<typename MLAlgorithm>
+class WarmStart
+{
+ public:
+  //! If true, then models of type MLAlgorithm can be warm-started.
+  static const bool IsSupported = false;
+};
+
+namespace detail {
+
+/**
+ * Warm-start the given model with the given hyper-parameters, if
+ * WarmStart<MLAlgorithm>::Train() can take them.
+ */
+template<typename MLAlgorithm,
+         typename MatType,
+         typename PredictionsType,
+         typename... Args>
+auto TryWarmStart(MLAlgorithm& model,
+                  const MatType& xs,
+                  const PredictionsType& ys,
+                  int /* preferred */,
+                  const Args&... args)
+    -> decltype(WarmStart<MLAlgorithm>::Train(model, xs, ys, args...), bool())
+{
+  return WarmStart<MLAlgorithm>::Train(model, xs, ys, args...);
+}
+
+/**
+ * The given hyper-parameters can't be passed to WarmStart<MLAlgorithm>::Train()
+ * (or it does not exist), so the model can't be warm-started.
+ */
+template<typename MLAlgorithm,
+         typename MatType,
+         typename PredictionsType,
+         typename... Args>
+bool TryWarmStart(MLAlgorithm& /* model */,
+                  const MatType& /* xs */,
+                  const PredictionsType& /* ys */,
+                  long /* fallback */,
+                  const Args&... /* args */)
+{
+  return false;
+}
+
+} // namespace detail
+
+} // namespace cv
+} // namespace mlpack
+
+#endif
@@ -18,6 +18,8 @@
 #include <mlpack/prereqs.hpp>
 #include <unordered_map>
 
+#include <mlpack/core/util/sfinae_utility.hpp>
+
 #include "map_policies/increment_policy.hpp"
 
 namespace mlpack {
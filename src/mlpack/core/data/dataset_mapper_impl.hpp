@@ -217,11 +217,49 @@ inline Datatype& DatasetMapper<PolicyType, InputType>::Type(
   return types[dimension];
 }
 
+// Policies that do not store their mappings (like HashPolicy) know the number
+// of mappings themselves.
+HAS_MEM_FUNC(NumMappings, HasNumMappingsCheck);
+
+template<typename PolicyType>
+struct HasNumMappings
+{
+  typedef size_t (PolicyType::*Signature)(const Datatype) const;
+  static const bool value = HasNumMappingsCheck<PolicyType, Signature>::value;
+};
+
+// Utility helper function to ask the policy for the number of mappings.
+template<typename PolicyType, typename MapType>
+size_t CallNumMappings(
+    const PolicyType& policy,
+    const MapType& /* maps */,
+    const size_t /* dimension */,
+    const Datatype type,
+    const typename std::enable_if<HasNumMappings<PolicyType>::value>::type* = 0)
+{
+  return policy.NumMappings(type);
+}
+
+// Utility helper function to count the stored mappings.
+template<typename PolicyType, typename MapType>
+size_t CallNumMappings(
+    const PolicyType& /* policy */,
+    const MapType& maps,
+    const size_t dimension,
+    const Datatype /* type */,
+    const typename std::enable_if<!HasNumMappings<PolicyType>::value>::type* =
+        0)
+{
+  return (maps.count(dimension) == 0) ? 0 : maps.at(dimension).first.size();
+}
+
 template<typename PolicyType, typename InputType>
 inline size_t
 DatasetMapper<PolicyType, InputType>::NumMappings(const size_t dimension) const
 {
-  return (maps.count(dimension) == 0) ? 0 : maps.at(dimension).first.size();
+  const Datatype type = (dimension < types.size()) ? types[dimension] :
+      Datatype::numeric;
+  return CallNumMappings(policy, maps, dimension, type);
 }
 
 template<typename PolicyType, typename InputType>
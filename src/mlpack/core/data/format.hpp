@@ -22,7 +22,11 @@ enum format
   autodetect,
   text,
   xml,
-  binary
+  binary,
+  //! PortableBinaryOArchive: readable on any platform, and checksummed.
+  portable_binary,
+  //! PortableBinaryOArchive compressed with zlib.
+  portable_binary_compressed
 };
 
 } // namespace data
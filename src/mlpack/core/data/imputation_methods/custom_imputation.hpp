@@ -71,6 +71,25 @@ class CustomImputation
     }
   }
 
+  /**
+   * Impute the given dimensions at once, in parallel.  mappedValues[i] is the
+   * value to replace in dimension dimensions[i].
+   *
+   * @param input Matrix that contains the mapped values.
+   * @param mappedValues Values that the user wants to get rid of.
+   * @param dimensions Indices of the dimensions of the mapped values.
+   * @param columnMajor State of whether the input matrix is columnMajor or not.
+   */
+  void Impute(arma::Mat<T>& input,
+              const std::vector<T>& mappedValues,
+              const std::vector<size_t>& dimensions,
+              const bool columnMajor = true)
+  {
+    #pragma omp parallel for schedule(dynamic)
+    for (omp_size_t i = 0; i < (omp_size_t) dimensions.size(); ++i)
+      Impute(input, mappedValues[i], dimensions[i], columnMajor);
+  }
+
  private:
   //! A user-defined value that the user wants to replace missing values with.
   T customValue;
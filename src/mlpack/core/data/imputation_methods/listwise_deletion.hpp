@@ -39,32 +39,66 @@ class ListwiseDeletion
               const size_t dimension,
               const bool columnMajor = true)
   {
-    std::vector<arma::uword> colsToKeep;
+    Impute(input, std::vector<T>(1, mappedValue),
+        std::vector<size_t>(1, dimension), columnMajor);
+  }
 
-    if (columnMajor)
+  /**
+   * Remove every row or column that holds mappedValues[i] (or NaN) in
+   * dimension dimensions[i], for any i.  All the dimensions are handled in one
+   * pass over the input: the points that are kept are moved to the front of
+   * the matrix in place, and the matrix is then shrunk once.
+   *
+   * @param input Matrix that contains the mapped values.
+   * @param mappedValues Values that the user wants to get rid of.
+   * @param dimensions Indices of the dimensions of the mapped values.
+   * @param columnMajor State of whether the input matrix is columnMajor or not.
+   */
+  void Impute(arma::Mat<T>& input,
+              const std::vector<T>& mappedValues,
+              const std::vector<size_t>& dimensions,
+              const bool columnMajor = true)
+  {
+    const size_t n = columnMajor ? input.n_cols : input.n_rows;
+    size_t kept = 0;
+    for (size_t i = 0; i < n; ++i)
     {
-      for (size_t i = 0; i < input.n_cols; ++i)
+      bool missing = false;
+      for (size_t j = 0; j < dimensions.size() && !missing; ++j)
       {
-         if (!(input(dimension, i) == mappedValue ||
-             std::isnan(input(dimension, i))))
-         {
-           colsToKeep.push_back(i);
-         }
+        const T value = columnMajor ? input(dimensions[j], i) :
+            input(i, dimensions[j]);
+        missing = (value == mappedValues[j] || std::isnan(value));
       }
-      input = input.cols(arma::uvec(colsToKeep));
-    }
-    else
-    {
-      for (size_t i = 0; i < input.n_rows; ++i)
+
+      if (missing)
+        continue;
+
+      if (kept != i)
       {
-        if (!(input(i, dimension) == mappedValue ||
-             std::isnan(input(i, dimension))))
+        if (columnMajor)
+        {
+          std::copy(input.colptr(i), input.colptr(i) + input.n_rows,
+              input.colptr(kept));
+        }
+        else
         {
-           colsToKeep.push_back(i);
+          // Move the row up in every column.
+          for (size_t c = 0; c < input.n_cols; ++c)
+            input(kept, c) = input(i, c);
         }
       }
-      input = input.rows(arma::uvec(colsToKeep));
+      ++kept;
     }
+
+    if (kept == n)
+      return;
+
+    // The kept points are at the front, so this just drops the others.
+    if (columnMajor)
+      input.resize(input.n_rows, kept);
+    else
+      input.resize(kept, input.n_cols);
   }
 }; // class ListwiseDeletion
 
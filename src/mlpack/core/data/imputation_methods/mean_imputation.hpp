@@ -39,61 +39,98 @@ class MeanImputation
               const size_t dimension,
               const bool columnMajor = true)
   {
-    double sum = 0;
-    size_t elems = 0; // excluding nan or missing target
-
-    using PairType = std::pair<size_t, size_t>;
-    // dimensions and indexes are saved as pairs inside this vector.
-    std::vector<PairType> targets;
+    double mean;
+    if (!Mean(input, mappedValue, dimension, columnMajor, mean))
+      Log::Fatal << "it is impossible to calculate mean; no valid elements in "
+          << "the dimension" << std::endl;
 
+    Replace(input, mappedValue, dimension, columnMajor, mean);
+  }
 
-    // calculate number of elements and sum of them excluding mapped value or
-    // nan. while doing that, remember where mappedValue or NaN exists.
-    if (columnMajor)
+  /**
+   * Impute the given dimensions at once, in parallel: each dimension has its
+   * own mean, so the dimensions are independent.  mappedValues[i] is the value
+   * to replace in dimension dimensions[i].
+   *
+   * @param input Matrix that contains the mapped values.
+   * @param mappedValues Values that the user wants to get rid of.
+   * @param dimensions Indices of the dimensions of the mapped values.
+   * @param columnMajor State of whether the input matrix is columnMajor or not.
+   */
+  void Impute(arma::Mat<T>& input,
+              const std::vector<T>& mappedValues,
+              const std::vector<size_t>& dimensions,
+              const bool columnMajor = true)
+  {
+    // Log::Fatal can't throw out of the parallel region, so remember the first
+    // dimension without valid elements.
+    size_t firstError = dimensions.size();
+    #pragma omp parallel for schedule(dynamic)
+    for (omp_size_t i = 0; i < (omp_size_t) dimensions.size(); ++i)
     {
-      for (size_t i = 0; i < input.n_cols; ++i)
+      double mean;
+      if (!Mean(input, mappedValues[i], dimensions[i], columnMajor, mean))
       {
-        if (input(dimension, i) == mappedValue ||
-            std::isnan(input(dimension, i)))
-        {
-          targets.emplace_back(dimension, i);
-        }
-        else
-        {
-          elems++;
-          sum += input(dimension, i);
-        }
+        #pragma omp critical
+        firstError = std::min(firstError, (size_t) i);
+        continue;
       }
+
+      Replace(input, mappedValues[i], dimensions[i], columnMajor, mean);
     }
-    else
+
+    if (firstError < dimensions.size())
+      Log::Fatal << "it is impossible to calculate mean; no valid elements in "
+          << "dimension " << dimensions[firstError] << std::endl;
+  }
+
+ private:
+  /**
+   * Compute the mean of the elements of the dimension that are neither
+   * mappedValue nor NaN, in one pass.  Returns false if there are no such
+   * elements.
+   */
+  static bool Mean(const arma::Mat<T>& input,
+                   const T& mappedValue,
+                   const size_t dimension,
+                   const bool columnMajor,
+                   double& mean)
+  {
+    const size_t n = columnMajor ? input.n_cols : input.n_rows;
+    double sum = 0;
+    size_t elems = 0; // excluding nan or missing target
+    #pragma omp parallel for reduction(+:sum,elems)
+    for (omp_size_t i = 0; i < (omp_size_t) n; ++i)
     {
-      for (size_t i = 0; i < input.n_rows; ++i)
+      const T value = columnMajor ? input(dimension, i) : input(i, dimension);
+      if (!(value == mappedValue || std::isnan(value)))
       {
-        if (input(i, dimension) == mappedValue ||
-            std::isnan(input(i, dimension)))
-        {
-          targets.emplace_back(i, dimension);
-        }
-        else
-        {
-          elems++;
-          sum += input(i, dimension);
-        }
+        elems++;
+        sum += value;
       }
     }
 
     if (elems == 0)
-      Log::Fatal << "it is impossible to calculate mean; no valid elements in "
-          << "the dimension" << std::endl;
+      return false;
 
-    // calculate mean;
-    const double mean = sum / elems;
+    mean = sum / elems;
+    return true;
+  }
 
-    // Now replace the calculated mean to the missing variables
-    // It only needs to loop through targets vector, not the whole matrix.
-    for (const PairType& target : targets)
+  //! Replace mappedValue and NaN in the dimension with the given value.
+  static void Replace(arma::Mat<T>& input,
+                      const T& mappedValue,
+                      const size_t dimension,
+                      const bool columnMajor,
+                      const double value)
+  {
+    const size_t n = columnMajor ? input.n_cols : input.n_rows;
+    #pragma omp parallel for
+    for (omp_size_t i = 0; i < (omp_size_t) n; ++i)
     {
-      input(target.first, target.second) = mean;
+      T& element = columnMajor ? input(dimension, i) : input(i, dimension);
+      if (element == mappedValue || std::isnan(element))
+        element = value;
     }
   }
 }; // class MeanImputation
@@ -40,49 +40,105 @@ class MedianImputation
               const size_t dimension,
               const bool columnMajor = true)
   {
-    using PairType = std::pair<size_t, size_t>;
-    // dimensions and indexes are saved as pairs inside this vector.
-    std::vector<PairType> targets;
-    // good elements are kept inside this vector.
-    std::vector<double> elemsToKeep;
+    double median;
+    if (!Median(input, mappedValue, dimension, columnMajor, median))
+      Log::Fatal << "it is impossible to calculate median; no valid elements "
+          << "in the dimension" << std::endl;
+
+    Replace(input, mappedValue, dimension, columnMajor, median);
+  }
 
-    if (columnMajor)
+  /**
+   * Impute the given dimensions at once, in parallel: each dimension has its
+   * own median, so the dimensions are independent.  mappedValues[i] is the
+   * value to replace in dimension dimensions[i].
+   *
+   * @param input Matrix that contains the mapped values.
+   * @param mappedValues Values that the user wants to get rid of.
+   * @param dimensions Indices of the dimensions of the mapped values.
+   * @param columnMajor State of whether the input matrix is columnMajor or not.
+   */
+  void Impute(arma::Mat<T>& input,
+              const std::vector<T>& mappedValues,
+              const std::vector<size_t>& dimensions,
+              const bool columnMajor = true)
+  {
+    // Log::Fatal can't throw out of the parallel region, so remember the first
+    // dimension without valid elements.
+    size_t firstError = dimensions.size();
+    #pragma omp parallel for schedule(dynamic)
+    for (omp_size_t i = 0; i < (omp_size_t) dimensions.size(); ++i)
     {
-      for (size_t i = 0; i < input.n_cols; ++i)
+      double median;
+      if (!Median(input, mappedValues[i], dimensions[i], columnMajor, median))
       {
-        if (input(dimension, i) == mappedValue ||
-            std::isnan(input(dimension, i)))
-        {
-          targets.emplace_back(dimension, i);
-        }
-        else
-        {
-          elemsToKeep.push_back(input(dimension, i));
-        }
+        #pragma omp critical
+        firstError = std::min(firstError, (size_t) i);
+        continue;
       }
+
+      Replace(input, mappedValues[i], dimensions[i], columnMajor, median);
     }
-    else
+
+    if (firstError < dimensions.size())
+      Log::Fatal << "it is impossible to calculate median; no valid elements "
+          << "in dimension " << dimensions[firstError] << std::endl;
+  }
+
+ private:
+  /**
+   * Compute the median of the elements of the dimension that are neither
+   * mappedValue nor NaN (the mean of the two middle elements, if there is an
+   * even number of them).  The middle elements are found by selection, in
+   * linear time, instead of sorting.  Returns false if there are no such
+   * elements.
+   */
+  static bool Median(const arma::Mat<T>& input,
+                     const T& mappedValue,
+                     const size_t dimension,
+                     const bool columnMajor,
+                     double& median)
+  {
+    const size_t n = columnMajor ? input.n_cols : input.n_rows;
+    // good elements are kept inside this vector.
+    std::vector<double> elemsToKeep;
+    elemsToKeep.reserve(n);
+    for (size_t i = 0; i < n; ++i)
     {
-      for (size_t i = 0; i < input.n_rows; ++i)
-      {
-        if (input(i, dimension) == mappedValue ||
-            std::isnan(input(i, dimension)))
-        {
-          targets.emplace_back(i, dimension);
-        }
-        else
-        {
-           elemsToKeep.push_back(input(i, dimension));
-        }
-      }
+      const T value = columnMajor ? input(dimension, i) : input(i, dimension);
+      if (!(value == mappedValue || std::isnan(value)))
+        elemsToKeep.push_back(value);
     }
 
-    // calculate median
-    const double median = arma::median(arma::vec(elemsToKeep));
+    if (elemsToKeep.empty())
+      return false;
+
+    const std::vector<double>::iterator middle = elemsToKeep.begin() +
+        elemsToKeep.size() / 2;
+    std::nth_element(elemsToKeep.begin(), middle, elemsToKeep.end());
+    median = *middle;
+
+    // After the selection, the other middle element is the largest element
+    // before the middle.
+    if (elemsToKeep.size() % 2 == 0)
+      median = (median + *std::max_element(elemsToKeep.begin(), middle)) / 2;
 
-    for (const PairType& target : targets)
+    return true;
+  }
+
+  //! Replace mappedValue and NaN in the dimension with the given value.
+  static void Replace(arma::Mat<T>& input,
+                      const T& mappedValue,
+                      const size_t dimension,
+                      const bool columnMajor,
+                      const double value)
+  {
+    const size_t n = columnMajor ? input.n_cols : input.n_rows;
+    for (size_t i = 0; i < n; ++i)
     {
-       input(target.first, target.second) = median;
+      T& element = columnMajor ? input(dimension, i) : input(i, dimension);
+      if (element == mappedValue || std::isnan(element))
+        element = value;
     }
   }
 }; // class MedianImputation
@@ -16,6 +16,8 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/util/log.hpp>
+#include <mlpack/core/util/mapped_file.hpp>
+#include <memory>
 #include <string>
 
 #include "format.hpp"
@@ -40,6 +42,8 @@ namespace data /** Functions to load and save matrices and models. */ {
  *  - Raw binary (raw_binary), denoted by .bin
  *  - Armadillo binary (arma_binary), denoted by .bin
  *  - HDF5, denoted by .hdf, .hdf5, .h5, or .he5
+ *  - NumPy, denoted by .npy (see also the overload below, which can map the
+ *    file into memory instead of reading it)
  *
  * If the file extension is not one of those types, an error will be given.
  * This is preferable to Armadillo's default behavior of loading an unknown
@@ -64,6 +68,34 @@ bool Load(const std::string& filename,
           const bool fatal = false,
           const bool transpose = true);
 
+/**
+ * Load a matrix from file, like Load(filename, matrix, fatal, transpose), but
+ * without copying .npy files: if the file holds elements of type eT in the
+ * memory order that the matrix needs (C order if transpose is true, Fortran
+ * order if it is false, which is what Save() writes), the file is mapped into
+ * memory, the matrix is made an alias of the mapping, and the mapping is
+ * stored in mappedFile.  Pages of the file are then only read when they are
+ * used, so even very large datasets load instantly.
+ *
+ * The mapping must be kept until the matrix is destroyed or given new memory.
+ * It is private: the matrix may be modified, but the file is never changed.
+ * For every other file (or if the .npy file has to be converted), the matrix
+ * is loaded as usual and mappedFile is reset.
+ *
+ * @param filename Name of file to load.
+ * @param matrix Matrix to load contents of file into.
+ * @param mappedFile Pointer to store the mapping of the file in.
+ * @param fatal If an error should be reported as fatal (default false).
+ * @param transpose If true, transpose the matrix after loading.
+ * @return Boolean value indicating success or failure of load.
+ */
+template<typename eT>
+bool Load(const std::string& filename,
+          arma::Mat<eT>& matrix,
+          std::shared_ptr<util::MappedFile>& mappedFile,
+          const bool fatal = false,
+          const bool transpose = true);
+
 /**
  * Don't document these with doxygen; these declarations aren't helpful to
  * users.
@@ -120,6 +152,7 @@ extern template bool Load<double>(const std::string&,
  *  - Raw binary (raw_binary), denoted by .bin
  *  - Armadillo binary (arma_binary), denoted by .bin
  *  - HDF5, denoted by .hdf, .hdf5, .h5, or .he5
+ *  - NumPy, denoted by .npy
  *
  * If the file extension is not one of those types, an error will be given.
  * This is preferable to Armadillo's default behavior of loading an unknown
@@ -152,6 +185,7 @@ bool Load(const std::string& filename,
  *  - Raw binary (raw_binary), denoted by .bin
  *  - Armadillo binary (arma_binary), denoted by .bin
  *  - HDF5, denoted by .hdf, .hdf5, .h5, or .he5
+ *  - NumPy, denoted by .npy
  *
  * If the file extension is not one of those types, an error will be given.
  * This is preferable to Armadillo's default behavior of loading an unknown
@@ -267,8 +301,15 @@ extern template bool Load<double, IncrementPolicy>(
  *  - xml, denoted by .xml
  *  - binary, denoted by .bin
  *
+ * and mlpack's portable binary format (see PortableBinaryOArchive), which can
+ * be read on any platform, is checksummed, and can be compressed:
+ *
+ *  - portable binary, denoted by .pbin
+ *  - compressed portable binary, denoted by .pbz (needs zlib)
+ *
  * The format parameter can take any of the values in the 'format' enum:
- * 'format::autodetect', 'format::text', 'format::xml', and 'format::binary'.
+ * 'format::autodetect', 'format::text', 'format::xml', 'format::binary',
+ * 'format::portable_binary', and 'format::portable_binary_compressed'.
  * The autodetect functionality operates on the file extension (so, "file.txt"
  * would be autodetected as text).
  *
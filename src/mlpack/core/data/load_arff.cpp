@@ -0,0 +1,284 @@
+/**
+ * @file load_arff.cpp
+ *
+ * Implementation of ARFFReader, which reads ARFF files for LoadARFF().
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "load_arff.hpp"
+
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/tokenizer.hpp>
+#include <cstring>
+
+namespace mlpack {
+namespace data {
+namespace detail {
+
+//! Whitespace, as removed by boost::trim() in the classic locale.
+static inline bool IsSpace(const char c)
+{
+  return (c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' ||
+      c == '\r');
+}
+
+/**
+ * Read one value starting at pos and store it in token: either a quoted value
+ * (whose quotes are removed, and where a backslash escapes the next
+ * character), or everything up to the next unquoted comma, closing brace or
+ * comment (without surrounding whitespace).  pos is left at the next character
+ * after the value that is not whitespace.  Returns false if the closing quote
+ * is missing.
+ */
+static bool ReadValue(const char*& pos, const char* end, std::string& token)
+{
+  token.clear();
+  while (pos != end && IsSpace(*pos))
+    ++pos;
+
+  if (pos != end && (*pos == '"' || *pos == '\''))
+  {
+    const char quote = *pos;
+    for (++pos; pos != end && *pos != quote; ++pos)
+    {
+      if (*pos == '\\' && pos + 1 != end)
+        ++pos;
+      token.push_back(*pos);
+    }
+    if (pos == end)
+      return false;
+    ++pos;
+  }
+  else
+  {
+    const char* first = pos;
+    while (pos != end && *pos != ',' && *pos != '}' && *pos != '%')
+      ++pos;
+    const char* last = pos;
+    while (last != first && IsSpace(*(last - 1)))
+      --last;
+    token.assign(first, last);
+  }
+
+  while (pos != end && IsSpace(*pos))
+    ++pos;
+
+  return true;
+}
+
+ARFFReader::ARFFReader(const std::string& filename) : filename(filename)
+{
+  // Read the whole file with one bulk read.
+  std::ifstream stream(filename, std::ios::in | std::ios::binary);
+  if (!stream.is_open())
+    throw std::runtime_error("Cannot open file '" + filename + "'. ");
+
+  stream.seekg(0, std::ios::end);
+  const std::streamoff size = stream.tellg();
+  stream.seekg(0, std::ios::beg);
+  if (size > 0)
+  {
+    buffer.resize((size_t) size);
+    stream.read(&buffer[0], size);
+    buffer.resize((size_t) stream.gcount());
+  }
+
+  // Find the data lines, without surrounding whitespace, and skip empty lines
+  // and comments.
+  size_t start = ParseHeader();
+  size_t lineNumber = std::count(buffer.begin(), buffer.begin() +
+      std::min(start, buffer.size()), '\n');
+  const char* data = buffer.data();
+  while (start < buffer.size())
+  {
+    const char* newline = (const char*) std::memchr(data + start, '\n',
+        buffer.size() - start);
+    const size_t end = (newline == NULL) ? buffer.size() : (newline - data);
+    ++lineNumber;
+
+    size_t first = start, last = end;
+    while (first < last && IsSpace(data[first]))
+      ++first;
+    while (last > first && IsSpace(data[last - 1]))
+      --last;
+    if (first < last && data[first] != '%')
+    {
+      lines.push_back(std::make_pair(first, last));
+      lineNumbers.push_back(lineNumber);
+    }
+
+    start = end + 1;
+  }
+}
+
+size_t ARFFReader::ParseHeader()
+{
+  types.clear();
+  size_t start = 0;
+  while (start < buffer.size())
+  {
+    // Get the next line, then strip whitespace from either side.
+    size_t end = buffer.find('\n', start);
+    if (end == std::string::npos)
+      end = buffer.size();
+    std::string line = buffer.substr(start, end - start);
+    boost::trim(line);
+    start = end + 1;
+
+    // Is the first character a comment, or is the line empty?
+    if (line.empty() || line[0] == '%')
+      continue; // Ignore this line.
+
+    // If the first character is @, we are looking at @relation, @attribute, or
+    // @data.
+    if (line[0] == '@')
+    {
+      typedef boost::tokenizer<boost::escaped_list_separator<char>> Tokenizer;
+      std::string separators = " \t%"; // Split on comments too.
+      boost::escaped_list_separator<char> sep("\\", separators, "{\"");
+      Tokenizer tok(line, sep);
+      Tokenizer::iterator it = tok.begin();
+
+      // Get the annotation we are looking at.
+      std::string annotation(*it);
+      std::transform(annotation.begin(), annotation.end(), annotation.begin(),
+            ::tolower);
+
+      if (annotation == "@relation")
+      {
+        // We don't actually have anything to do with the name of the dataset.
+        continue;
+      }
+      else if (annotation == "@attribute")
+      {
+        // We need to mark this dimension with its according type.
+        ++it; // Ignore the dimension name.
+        std::string dimType = *(++it);
+        std::transform(dimType.begin(), dimType.end(), dimType.begin(),
+            ::tolower);
+
+        if (dimType == "numeric" || dimType == "integer" || dimType == "real")
+        {
+          types.push_back(false); // The feature is numeric.
+        }
+        else if (dimType == "string")
+        {
+          types.push_back(true); // The feature is categorical.
+        }
+        else if (dimType[0] == '{')
+        {
+          throw std::logic_error("list of ARFF values not yet supported");
+        }
+      }
+      else if (annotation == "@data")
+      {
+        // We are in the data section.
+        return start;
+      }
+      else
+      {
+        throw std::runtime_error("unknown ARFF annotation '" + (*tok.begin()) +
+            "'");
+      }
+    }
+  }
+
+  throw std::runtime_error("no @data section found");
+}
+
+size_t ARFFReader::SplitLine(const size_t line,
+                             std::vector<size_t>& dims,
+                             std::vector<std::string>& tokens) const
+{
+  const char* pos = buffer.data() + lines[line].first;
+  const char* end = buffer.data() + lines[line].second;
+
+  const bool sparse = (*pos == '{');
+  if (sparse)
+    ++pos;
+
+  size_t numTokens = 0;
+  while (true)
+  {
+    while (pos != end && IsSpace(*pos))
+      ++pos;
+
+    // A sparse row may be empty, and ends with a closing brace.
+    if (sparse && pos != end && *pos == '}' && numTokens == 0)
+      break;
+
+    if (numTokens == tokens.size())
+    {
+      tokens.push_back(std::string());
+      dims.push_back(0);
+    }
+
+    if (sparse)
+    {
+      // Read the index, which must be followed by whitespace.
+      const char* first = pos;
+      size_t index = 0;
+      for (; pos != end && *pos >= '0' && *pos <= '9'; ++pos)
+        index = 10 * index + (*pos - '0');
+      if (pos == first || pos == end || !IsSpace(*pos))
+        ThrowError(line, numTokens, "invalid sparse index");
+      if (index >= types.size())
+        ThrowError(line, index, "sparse index out of range");
+      if (numTokens > 0 && index <= dims[numTokens - 1])
+        ThrowError(line, index, "sparse indices must be increasing");
+      dims[numTokens] = index;
+    }
+    else
+    {
+      if (numTokens >= types.size())
+        ThrowError(line, numTokens, "too many columns");
+      dims[numTokens] = numTokens;
+    }
+
+    if (!ReadValue(pos, end, tokens[numTokens]))
+      ThrowError(line, dims[numTokens], "missing closing quote");
+    ++numTokens;
+
+    if (pos != end && *pos == ',')
+    {
+      ++pos;
+      continue;
+    }
+
+    break;
+  }
+
+  // Now the row must end (possibly with a comment).
+  if (sparse)
+  {
+    if (pos == end || *pos != '}')
+      ThrowError(line, numTokens, "missing closing brace of sparse row");
+    ++pos;
+    while (pos != end && IsSpace(*pos))
+      ++pos;
+  }
+  if (pos != end && *pos != '%')
+    ThrowError(line, numTokens, "unexpected characters");
+
+  if (!sparse && numTokens != types.size())
+    ThrowError(line, numTokens, "too few columns");
+
+  return numTokens;
+}
+
+void ARFFReader::ThrowError(const size_t line,
+                            const size_t dim,
+                            const std::string& message) const
+{
+  std::ostringstream oss;
+  oss << "line " << lineNumbers[line] << " of '" << filename << "', "
+      << "dimension " << dim << ": " << message << ".";
+  throw std::runtime_error(oss.str());
+}
+
+} // namespace detail
+} // namespace data
+} // namespace mlpack
@@ -14,11 +14,91 @@
 
 #include <mlpack/prereqs.hpp>
 #include "dataset_mapper.hpp"
-#include <boost/tokenizer.hpp>
 
 namespace mlpack {
 namespace data {
 
+namespace detail {
+
+/**
+ * ARFFReader reads an ARFF file with a single bulk read, parses its header,
+ * and finds the lines of its @data section, which can then be split into
+ * tokens from several threads at once.  Comment lines and empty lines are
+ * skipped.
+ *
+ * Both dense rows (values separated by commas) and sparse rows (such as
+ * "{0 1.5, 3 blue}", where every value that is not given is 0) are supported.
+ * Values may be quoted with single or double quotes, in which case they can
+ * contain commas and spaces; the quotes are removed, and a backslash escapes
+ * the next character.  Anything after a % that is not quoted is a comment.
+ */
+class ARFFReader
+{
+ public:
+  /**
+   * Read the given file and parse its header.  std::runtime_error is thrown if
+   * the file cannot be opened or its header is invalid.
+   *
+   * @param filename Name of the ARFF file to read.
+   */
+  ARFFReader(const std::string& filename);
+
+  //! Get the dimensionality of the data (the number of attributes).
+  size_t Dimensionality() const { return types.size(); }
+  //! Get whether each dimension is categorical.
+  const std::vector<bool>& Types() const { return types; }
+  //! Get the number of data lines (points) in the file.
+  size_t NumLines() const { return lines.size(); }
+
+  /**
+   * Split the given data line into its values.  For a dense row, the
+   * dimension of the i'th value is i, and every dimension has a value; for a
+   * sparse row, the dimensions are those given in the row, in increasing
+   * order.  The vectors are reused between calls, so this does not allocate
+   * memory once they are large enough.  This may be called from several
+   * threads at once (with different vectors).  std::runtime_error is thrown if
+   * the line is malformed.
+   *
+   * @param line Index of the data line to split.
+   * @param dims Vector to store the dimension of each value in.
+   * @param tokens Vector to store the values in.
+   * @return Number of values in the line.
+   */
+  size_t SplitLine(const size_t line,
+                   std::vector<size_t>& dims,
+                   std::vector<std::string>& tokens) const;
+
+  /**
+   * Throw a std::runtime_error about the given data line and dimension.
+   *
+   * @param line Index of the data line.
+   * @param dim Dimension of the value.
+   * @param message Description of the error.
+   */
+  [[noreturn]] void ThrowError(const size_t line,
+                               const size_t dim,
+                               const std::string& message) const;
+
+ private:
+  //! Parse the header of the file, up to the @data annotation, and return the
+  //! offset of the data section in the buffer.
+  size_t ParseHeader();
+
+  //! The name of the file.
+  std::string filename;
+  //! The contents of the file.
+  std::string buffer;
+  //! Whether each dimension is categorical.
+  std::vector<bool> types;
+  //! The start and end of each data line in the buffer (without surrounding
+  //! whitespace).
+  std::vector<std::pair<size_t, size_t>> lines;
+  //! The line number in the file of each data line.
+  std::vector<size_t> lineNumbers;
+};
+
+} // namespace detail
+
 /**
  * A utility function to load an ARFF dataset as numeric features (that is, as
  * an Armadillo matrix without any modification).  An exception will be thrown
@@ -44,6 +124,11 @@ void LoadARFF(const std::string& filename, arma::Mat<eT>& matrix);
  * loading the training set is not used, then the test set may be loaded with
  * different mappings---which can cause horrible problems!
  *
+ * Rows of the file may be dense or sparse ("{index value, ...}", where values
+ * that are not given are 0).  The rows are parsed in parallel (if OpenMP is
+ * available); categorical values are mapped afterwards in the order of the
+ * file, so the mappings do not depend on the number of threads.
+ *
  * @param filename Name of ARFF file to load.
  * @param matrix Matrix to load data into.
  * @param info DatasetInfo object; can be default-constructed or pre-existing
@@ -54,6 +139,25 @@ void LoadARFF(const std::string& filename,
               arma::Mat<eT>& matrix,
               DatasetMapper<PolicyType>& info);
 
+/**
+ * Load an ARFF dataset directly into a sparse matrix, with one point per
+ * column, mapping categorical features with the given DatasetInfo object just
+ * like LoadARFF(filename, matrix, info) does for dense matrices.  This is most
+ * useful for files with sparse rows ("{index value, ...}"), which would take
+ * much more memory as a dense matrix, but files with dense rows can be loaded
+ * too (only their nonzero values are kept).  An exception will be thrown upon
+ * failure.
+ *
+ * @param filename Name of ARFF file to load.
+ * @param matrix Sparse matrix to load data into.
+ * @param info DatasetInfo object; can be default-constructed or pre-existing
+ *     from another call to LoadARFF().
+ */
+template<typename eT, typename PolicyType>
+void LoadARFF(const std::string& filename,
+              arma::SpMat<eT>& matrix,
+              DatasetMapper<PolicyType>& info);
+
 } // namespace data
 } // namespace mlpack
 
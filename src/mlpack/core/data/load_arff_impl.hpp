@@ -15,101 +15,26 @@
 // In case it hasn't been included yet.
 #include "load_arff.hpp"
 
-#include <boost/algorithm/string/trim.hpp>
 #include "is_naninf.hpp"
+#include "parse_number.hpp"
+
+#include <exception>
 
 namespace mlpack {
 namespace data {
 
-template<typename eT, typename PolicyType>
-void LoadARFF(const std::string& filename,
-              arma::Mat<eT>& matrix,
-              DatasetMapper<PolicyType>& info)
-{
-  // First, open the file.
-  std::ifstream ifs;
-  ifs.open(filename, std::ios::in | std::ios::binary);
-
-  // if file is not open throw an error (file not found).
-  if (!ifs.is_open())
-  {
-    Log::Fatal << "Cannot open file '" << filename << "'. " << std::endl;
-  }
-
-  std::string line;
-  size_t dimensionality = 0;
-  std::vector<bool> types;
-  size_t headerLines = 0;
-  while (ifs.good())
-  {
-    // Read the next line, then strip whitespace from either side.
-    std::getline(ifs, line, '\n');
-    boost::trim(line);
-    ++headerLines;
-
-    // Is the first character a comment, or is the line empty?
-    if (line[0] == '%' || line.empty())
-      continue; // Ignore this line.
-
-    // If the first character is @, we are looking at @relation, @attribute, or
-    // @data.
-    if (line[0] == '@')
-    {
-      typedef boost::tokenizer<boost::escaped_list_separator<char>> Tokenizer;
-      std::string separators = " \t%"; // Split on comments too.
-      boost::escaped_list_separator<char> sep("\\", separators, "{\"");
-      Tokenizer tok(line, sep);
-      Tokenizer::iterator it = tok.begin();
-
-      // Get the annotation we are looking at.
-      std::string annotation(*it);
-      std::transform(annotation.begin(), annotation.end(), annotation.begin(),
-            ::tolower);
-
-      if (annotation == "@relation")
-      {
-        // We don't actually have anything to do with the name of the dataset.
-        continue;
-      }
-      else if (annotation == "@attribute")
-      {
-        ++dimensionality;
-        // We need to mark this dimension with its according type.
-        ++it; // Ignore the dimension name.
-        std::string dimType = *(++it);
-        std::transform(dimType.begin(), dimType.end(), dimType.begin(),
-            ::tolower);
-
-        if (dimType == "numeric" || dimType == "integer" || dimType == "real")
-        {
-          types.push_back(false); // The feature is numeric.
-        }
-        else if (dimType == "string")
-        {
-          types.push_back(true); // The feature is categorical.
-        }
-        else if (dimType[0] == '{')
-        {
-          throw std::logic_error("list of ARFF values not yet supported");
-        }
-      }
-      else if (annotation == "@data")
-      {
-        // We are in the data section.  So we can move out of this loop.
-        break;
-      }
-      else
-      {
-        throw std::runtime_error("unknown ARFF annotation '" + (*tok.begin()) +
-            "'");
-      }
-    }
-  }
-
-  if (ifs.eof())
-    throw std::runtime_error("no @data section found");
+namespace detail {
 
+/**
+ * Set up the given DatasetMapper for the data of the given ARFF file: reset it
+ * to the dimensionality of the data if it is empty, or check that it has the
+ * right dimensionality otherwise, and set the type of each dimension.
+ */
+template<typename PolicyType>
+void SetARFFInfo(const ARFFReader& reader, DatasetMapper<PolicyType>& info)
+{
   // Reset the DatasetInfo object, if needed.
+  const size_t dimensionality = reader.Dimensionality();
   if (info.Dimensionality() == 0)
   {
     info = DatasetMapper<PolicyType>(dimensionality);
@@ -123,112 +48,216 @@ void LoadARFF(const std::string& filename,
     throw std::invalid_argument(oss.str());
   }
 
-  for (size_t i = 0; i < types.size(); ++i)
+  for (size_t i = 0; i < dimensionality; ++i)
   {
-    if (types[i])
+    if (reader.Types()[i])
       info.Type(i) = Datatype::categorical;
     else
       info.Type(i) = Datatype::numeric;
   }
+}
 
-  // We need to find out how many lines of data are in the file.
-  std::streampos pos = ifs.tellg();
-  size_t row = 0;
-  while (ifs.good())
+/**
+ * Read a value of a numeric dimension.  The '?' representing a missing value is
+ * not allowed, so if that occurs we throw an exception.
+ */
+template<typename eT>
+eT ParseARFFNumber(const ARFFReader& reader,
+                   const size_t line,
+                   const size_t dim,
+                   const std::string& token)
+{
+  eT val = eT(0);
+  if (!ParseNumber(token, val) && !IsNaNInf(val, token))
   {
-    std::getline(ifs, line, '\n');
-    ++row;
+    // Okay, it's not NaN or inf.  If it's '?', we issue a specific error,
+    // otherwise we issue a general error.
+    if (token == "?")
+      reader.ThrowError(line, dim, "missing values ('?') not supported");
+    reader.ThrowError(line, dim, "parse error: \"" + token + "\"");
   }
-  // Uncount the EOF row.
-  --row;
 
-  // Since we've hit the EOF, we have to call clear() so we can seek again.
-  ifs.clear();
-  ifs.seekg(pos);
+  return val;
+}
 
-  // Now, set the size of the matrix.
-  matrix.set_size(dimensionality, row);
+//! A categorical value that must be mapped after the parallel pass.
+struct PendingARFFToken
+{
+  //! Data line of the value.
+  size_t line;
+  //! Index of the value in its line.
+  size_t i;
+  //! Dimension of the value.
+  size_t dim;
+  //! The value.
+  std::string token;
+};
 
-  // Now we are looking at the @data section.
-  row = 0;
-  while (ifs.good())
+/**
+ * Parse every data line of the given ARFF file in parallel, and call
+ * store(line, i, dim, value) for the i'th value of each line.  Numeric values
+ * are given as they are parsed; categorical values are mapped afterwards, in
+ * the order of the file, so that the mappings are exactly those of a serial
+ * load.  If parsing fails, the exception of the first line that failed is
+ * rethrown.
+ *
+ * @param reader The ARFF file.
+ * @param info DatasetMapper to map categorical values with.
+ * @param store Function to store each value with.
+ */
+template<typename eT, typename PolicyType, typename StoreType>
+void ParseARFFLines(const ARFFReader& reader,
+                    DatasetMapper<PolicyType>& info,
+                    const StoreType& store)
+{
+  #ifdef HAS_OPENMP
+  const size_t maxThreads = omp_get_max_threads();
+  #else
+  const size_t maxThreads = 1;
+  #endif
+  std::vector<std::vector<PendingARFFToken>> pending(maxThreads);
+  const size_t numLines = reader.NumLines();
+  size_t errorLine = numLines;
+  std::exception_ptr error;
+
+  #pragma omp parallel
   {
-    std::getline(ifs, line, '\n');
-    boost::trim(line);
-    // Each line of the @data section must be a CSV (except sparse data, which
-    // we will handle later).  So now we can tokenize the
-    // CSV and parse it.  The '?' representing a missing value is not allowed,
-    // so if that occurs we throw an exception.  We also throw an exception if
-    // any piece of data does not match its type (categorical or numeric).
-
-    // If the first character is {, it is sparse data, and we can just say this
-    // is not handled for now...
-    if (line[0] == '{')
-      throw std::runtime_error("cannot yet parse sparse ARFF data");
-
-    // Tokenize the line.
-    typedef boost::tokenizer<boost::escaped_list_separator<char>> Tokenizer;
-    boost::escaped_list_separator<char> sep("\\", ",", "\"");
-    Tokenizer tok(line, sep);
-
-    size_t col = 0;
-    std::stringstream token;
-    for (Tokenizer::iterator it = tok.begin(); it != tok.end(); ++it)
+    #ifdef HAS_OPENMP
+    const size_t thread = omp_get_thread_num();
+    #else
+    const size_t thread = 0;
+    #endif
+    std::vector<size_t> dims;
+    std::vector<std::string> tokens;
+
+    // With a static schedule, the blocks are given to the threads in order,
+    // so the pending tokens of thread 0, 1, ... are in the order of the file.
+    #pragma omp for schedule(static)
+    for (omp_size_t line = 0; line < (omp_size_t) numLines; ++line)
     {
-      // Check that we are not too many columns in.
-      if (col >= matrix.n_rows)
+      try
       {
-        std::stringstream error;
-        error << "Too many columns in line " << (headerLines + row) << ".";
-        throw std::runtime_error(error.str());
+        const size_t numTokens = reader.SplitLine(line, dims, tokens);
+        for (size_t i = 0; i < numTokens; ++i)
+        {
+          if (info.Type(dims[i]) == Datatype::categorical)
+          {
+            PendingARFFToken token = { (size_t) line, i, dims[i], tokens[i] };
+            pending[thread].push_back(std::move(token));
+          }
+          else
+          {
+            store(line, i, dims[i],
+                ParseARFFNumber<eT>(reader, line, dims[i], tokens[i]));
+          }
+        }
       }
-
-      // What should this token be?
-      if (info.Type(col) == Datatype::categorical)
+      catch (...)
       {
-        // Strip spaces before mapping.
-        std::string token = *it;
-        boost::trim(token);
-        // We load transposed.
-        matrix(col, row) = info.template MapString<eT>(token, col);
+        #pragma omp critical
+        {
+          if ((size_t) line < errorLine)
+          {
+            errorLine = line;
+            error = std::current_exception();
+          }
+        }
       }
-      else if (info.Type(col) == Datatype::numeric)
-      {
-        // Attempt to read as numeric.
-        token.clear();
-        token.str(*it);
+    }
+  }
 
-        eT val = eT(0);
-        token >> val;
+  if (error)
+    std::rethrow_exception(error);
 
-        if (token.fail())
+  for (size_t t = 0; t < pending.size(); ++t)
+  {
+    for (size_t j = 0; j < pending[t].size(); ++j)
+    {
+      const PendingARFFToken& token = pending[t][j];
+      store(token.line, token.i, token.dim,
+          info.template MapString<eT>(token.token, token.dim));
+    }
+  }
+}
+
+} // namespace detail
+
+template<typename eT, typename PolicyType>
+void LoadARFF(const std::string& filename,
+              arma::Mat<eT>& matrix,
+              DatasetMapper<PolicyType>& info)
+{
+  const detail::ARFFReader reader(filename);
+  detail::SetARFFInfo(reader, info);
+
+  // Values that sparse rows leave out are 0.  We load transposed.
+  matrix.zeros(reader.Dimensionality(), reader.NumLines());
+  detail::ParseARFFLines<eT>(reader, info,
+      [&matrix](const size_t line, const size_t /* i */, const size_t dim,
+                const eT value) { matrix(dim, line) = value; });
+}
+
+template<typename eT, typename PolicyType>
+void LoadARFF(const std::string& filename,
+              arma::SpMat<eT>& matrix,
+              DatasetMapper<PolicyType>& info)
+{
+  const detail::ARFFReader reader(filename);
+  detail::SetARFFInfo(reader, info);
+
+  // First count the values of each line, to find where the values of each
+  // column start in the compressed sparse column format.
+  const size_t numLines = reader.NumLines();
+  arma::uvec colPointers(numLines + 1);
+  colPointers[0] = 0;
+  size_t errorLine = numLines;
+  std::exception_ptr error;
+  #pragma omp parallel
+  {
+    std::vector<size_t> dims;
+    std::vector<std::string> tokens;
+
+    #pragma omp for schedule(static)
+    for (omp_size_t line = 0; line < (omp_size_t) numLines; ++line)
+    {
+      try
+      {
+        colPointers[line + 1] = reader.SplitLine(line, dims, tokens);
+      }
+      catch (...)
+      {
+        #pragma omp critical
         {
-          // Check for NaN or inf.
-          if (!IsNaNInf(val, token.str()))
+          if ((size_t) line < errorLine)
           {
-            // Okay, it's not NaN or inf.  If it's '?', we issue a specific
-            // error, otherwise we issue a general error.
-            std::stringstream error;
-            std::string tokenStr = token.str();
-            boost::trim(tokenStr);
-            if (tokenStr == "?")
-              error << "Missing values ('?') not supported, ";
-            else
-              error << "Parse error ";
-            error << "at line " << (headerLines + row) << " token " << col
-                << ": \"" << tokenStr << "\".";
-            throw std::runtime_error(error.str());
+            errorLine = line;
+            error = std::current_exception();
           }
         }
-
-        // If we made it to here, we have a value.
-        matrix(col, row) = val; // We load transposed.
       }
-
-      ++col;
     }
-    ++row;
   }
+
+  if (error)
+    std::rethrow_exception(error);
+
+  for (size_t line = 0; line < numLines; ++line)
+    colPointers[line + 1] += colPointers[line];
+
+  // The dimensions of each line are increasing, so the values can be stored
+  // directly.  Values that are 0 (including categorical values mapped to 0)
+  // are removed by the constructor of the sparse matrix.
+  arma::uvec rowIndices(colPointers[numLines]);
+  arma::Col<eT> values(colPointers[numLines]);
+  detail::ParseARFFLines<eT>(reader, info,
+      [&](const size_t line, const size_t i, const size_t dim, const eT value)
+      {
+        rowIndices[colPointers[line] + i] = dim;
+        values[colPointers[line] + i] = value;
+      });
+
+  matrix = arma::SpMat<eT>(rowIndices, colPointers, values,
+      reader.Dimensionality(), numLines);
 }
 
 } // namespace data
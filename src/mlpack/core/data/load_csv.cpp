@@ -3,7 +3,7 @@
  * @author Tham Ngap Wei
  * @author Mehul Kumar Nirala
  *
- * A CSV reader that uses boost::spirit.
+ * A hand-written CSV reader.
  *
  * mlpack is free software; you may redistribute it and/or modify it under the
  * terms of the 3-clause BSD license.  You should have received a copy of the
@@ -12,63 +12,106 @@
  */
 #include "load_csv.hpp"
 
-using namespace boost::spirit;
+#include <cstring>
 
 namespace mlpack {
 namespace data {
 
+//! Whitespace, as removed by boost::trim() in the classic locale.
+static inline bool IsSpace(const char c)
+{
+  return (c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' ||
+      c == '\r');
+}
+
 LoadCSV::LoadCSV(const std::string& file) :
   extension(Extension(file)),
   filename(file),
-  inFile(file)
+  inFile(file, std::ios::binary)
 {
   // Attempt to open stream.
   CheckOpen();
 
-  //! Spirit rule for parsing quoted string.
-  boost::spirit::qi::rule<std::string::iterator, iter_type()> quotedRule;
-  // Match quoted strings as: "string" or 'string'
-  quotedRule = qi::raw[(qi::char_("'") >> *((qi::char_ - "'") |
-                               "'" >> qi::char_("'")) >> "'") |
-                       (qi::char_('"') >> *((qi::char_ - '"') |
-                               '"' >> qi::char_('"')) >> '"') ];
-
-  // Set rules.
+  // Unquoted tokens end at a delimiter or at the end of the line.  Text files
+  // are separated by spaces, but a comma also ends a token.
+  std::fill(endsToken, endsToken + 256, false);
+  endsToken[(unsigned char) '\r'] = true;
+  endsToken[(unsigned char) '\n'] = true;
   if (extension == "csv")
   {
-    // Match all characters that are not ',', '\r', or '\n'.
-    stringRule = quotedRule.copy() | qi::raw[*~qi::char_(",\r\n")];
+    delimiter = ',';
+    endsToken[(unsigned char) ','] = true;
   }
   else if (extension == "txt")
   {
-    // Match all characters that are not ' ', ',', '\r', or '\n'.
-    stringRule = quotedRule.copy() | qi::raw[*~qi::char_(" ,\r\n")];
+    delimiter = ' ';
+    endsToken[(unsigned char) ' '] = true;
+    endsToken[(unsigned char) ','] = true;
   }
   else // TSV.
   {
-    // Match all characters that are not '\t', '\r', or '\n'.
-    stringRule = quotedRule.copy() | qi::raw[*~qi::char_("\t\r\n")];
+    delimiter = '\t';
+    endsToken[(unsigned char) '\t'] = true;
   }
 
-  if (extension == "csv")
+  // Read the whole file with one bulk read.
+  inFile.seekg(0, std::ios::end);
+  const std::streamoff size = inFile.tellg();
+  inFile.seekg(0, std::ios::beg);
+  if (size > 0)
   {
-    // Extract a single comma as the delimiter, catching whitespace on either
-    // side.
-    delimiterRule = qi::raw[(*qi::char_(" ") >> qi::char_(",") >>
-        *qi::char_(" "))];
+    buffer.resize((size_t) size);
+    inFile.read(&buffer[0], size);
+    buffer.resize((size_t) inFile.gcount());
   }
-  else if (extension == "txt")
+
+  // Find the lines, as std::getline() would: a newline at the end of the file
+  // does not start another line.  Whitespace on either side of each line is
+  // removed.  Large files are split into blocks that start at the beginning
+  // of a line, and the lines of each block are found in parallel.
+  #ifdef HAS_OPENMP
+  const size_t numBlocks = (buffer.size() > (1 << 24)) ?
+      omp_get_max_threads() : 1;
+  #else
+  const size_t numBlocks = 1;
+  #endif
+
+  const char* data = buffer.data();
+  std::vector<size_t> blockStarts(numBlocks + 1, buffer.size());
+  blockStarts[0] = 0;
+  for (size_t b = 1; b < numBlocks; ++b)
   {
-    // This one is a little more difficult, we need to catch any number of
-    // spaces more than one.
-    delimiterRule = qi::raw[+qi::char_(" ")];
+    const size_t nominal = std::max(b * (buffer.size() / numBlocks),
+        blockStarts[b - 1]);
+    const char* newline = (const char*) std::memchr(data + nominal, '\n',
+        buffer.size() - nominal);
+    blockStarts[b] = (newline == NULL) ? buffer.size() : (newline - data + 1);
   }
-  else // TSV.
+
+  std::vector<std::vector<std::pair<size_t, size_t>>> blockLines(numBlocks);
+  #pragma omp parallel for schedule(static, 1)
+  for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
   {
-    // Catch a tab character, possibly with whitespace on either side.
-    delimiterRule = qi::raw[(*qi::char_(" ") >> qi::char_("\t") >>
-        *qi::char_(" "))];
+    size_t start = blockStarts[b];
+    while (start < blockStarts[b + 1])
+    {
+      const char* newline = (const char*) std::memchr(data + start, '\n',
+          buffer.size() - start);
+      const size_t end = (newline == NULL) ? buffer.size() : (newline - data);
+
+      size_t first = start, last = end;
+      while (first < last && IsSpace(data[first]))
+        ++first;
+      while (last > first && IsSpace(data[last - 1]))
+        --last;
+      blockLines[b].push_back(std::make_pair(first, last));
+
+      start = end + 1;
+    }
   }
+
+  for (size_t b = 0; b < numBlocks; ++b)
+    lines.insert(lines.end(), blockLines[b].begin(), blockLines[b].end());
 }
 
 void LoadCSV::CheckOpen()
@@ -83,5 +126,91 @@ void LoadCSV::CheckOpen()
   inFile.unsetf(std::ios::skipws);
 }
 
+size_t LoadCSV::SplitLine(const size_t line,
+                          std::vector<std::string>& tokens) const
+{
+  const char* pos = buffer.data() + lines[line].first;
+  const char* lineEnd = buffer.data() + lines[line].second;
+
+  size_t numTokens = 0;
+  while (true)
+  {
+    // Find the end of the token.  A quoted token ("string" or 'string', where
+    // a doubled quote stands for a quote) may contain delimiters; if the
+    // closing quote is missing, it is read as an unquoted token.
+    const char* tokenEnd = NULL;
+    if (pos != lineEnd && (*pos == '"' || *pos == '\''))
+    {
+      const char quote = *pos;
+      const char* p = pos + 1;
+      while (p != lineEnd)
+      {
+        if (*p != quote)
+          ++p;
+        else if (p + 1 != lineEnd && *(p + 1) == quote)
+          p += 2;
+        else
+        {
+          tokenEnd = p + 1;
+          break;
+        }
+      }
+    }
+
+    if (tokenEnd == NULL)
+    {
+      tokenEnd = pos;
+      while (tokenEnd != lineEnd && !endsToken[(unsigned char) *tokenEnd])
+        ++tokenEnd;
+    }
+
+    // Store the token, without surrounding whitespace.
+    const char* first = pos;
+    const char* last = tokenEnd;
+    while (first != last && IsSpace(*first))
+      ++first;
+    while (last != first && IsSpace(*(last - 1)))
+      --last;
+
+    if (numTokens == tokens.size())
+      tokens.push_back(std::string());
+    tokens[numTokens++].assign(first, last);
+
+    // Now find the delimiter; if there is none, the line is done.  Commas and
+    // tabs may have spaces on either side.
+    pos = tokenEnd;
+    if (delimiter == ' ')
+    {
+      if (pos == lineEnd || *pos != ' ')
+        break;
+    }
+    else
+    {
+      while (pos != lineEnd && *pos == ' ')
+        ++pos;
+      if (pos == lineEnd || *pos != delimiter)
+        break;
+      ++pos;
+    }
+
+    while (pos != lineEnd && *pos == ' ')
+      ++pos;
+  }
+
+  return numTokens;
+}
+
+void LoadCSV::ThrowWrongDimensions(const bool transpose,
+                                   const size_t line,
+                                   const size_t numTokens,
+                                   const size_t expected) const
+{
+  std::ostringstream oss;
+  oss << "LoadCSV::" << (transpose ? "TransposeParse" : "NonTransposeParse")
+      << "(): wrong number of dimensions (" << numTokens << ") on line "
+      << line << "; should be " << expected << " dimensions.";
+  throw std::runtime_error(oss.str());
+}
+
 } // namespace data
 } // namespace mlpack
@@ -12,11 +12,9 @@
 #ifndef MLPACK_CORE_DATA_LOAD_CSV_HPP
 #define MLPACK_CORE_DATA_LOAD_CSV_HPP
 
-#include <boost/spirit/include/qi.hpp>
-#include <boost/algorithm/string/trim.hpp>
-
 #include <mlpack/core.hpp>
 #include <mlpack/core/util/log.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
 
 #include <set>
 #include <string>
@@ -29,16 +27,24 @@ namespace mlpack {
 namespace data {
 
 /**
- *Load the csv file.This class use boost::spirit
- *to implement the parser, please refer to following link
- *http://theboostcpplibraries.com/boost.spirit for quick review.
+ * Load a CSV, TSV or whitespace-separated text file.  The whole file is read
+ * with a single bulk read and the start and end of each line are found once;
+ * the lines are then split into tokens by a hand-written scanner and every
+ * token is given to the DatasetMapper (which converts numbers without a
+ * stream; see ParseNumber()).
+ *
+ * Tokens are separated by a comma (CSV), a tab (TSV) or one or more spaces
+ * (text), with optional spaces around commas and tabs.  Tokens may be quoted
+ * with single or double quotes (a doubled quote inside is kept), in which case
+ * they can contain delimiters; the quotes are part of the token.  Whitespace
+ * at either end of lines and tokens is ignored.
  */
 class LoadCSV
 {
  public:
   /**
-   * Construct the LoadCSV object on the given file.  This will construct the
-   * rules necessary for loading and attempt to open the file.
+   * Construct the LoadCSV object on the given file.  This will attempt to open
+   * the file and read it into memory.
    */
   LoadCSV(const std::string& file);
 
@@ -77,62 +83,25 @@ class LoadCSV
   template<typename T, typename MapPolicy>
   void GetMatrixSize(size_t& rows, size_t& cols, DatasetMapper<MapPolicy>& info)
   {
-    using namespace boost::spirit;
-
     // Take a pass through the file.  If the DatasetMapper policy requires it,
     // we will pass everything string through MapString().  This might be useful
     // if, e.g., the MapPolicy needs to find which dimensions are numeric or
     // categorical.
 
-    // Reset to the start of the file.
-    inFile.clear();
-    inFile.seekg(0, std::ios::beg);
-    rows = 0;
-    cols = 0;
-
-    // First, count the number of rows in the file (this is the dimensionality).
-    std::string line;
-    while (std::getline(inFile, line))
-    {
-      ++rows;
-    }
-    info = DatasetMapper<MapPolicy>(rows);
-
-    // Now, jump back to the beginning of the file.
-    inFile.clear();
-    inFile.seekg(0, std::ios::beg);
-    rows = 0;
+    // The number of lines in the file is the dimensionality.
+    std::vector<std::string> tokens;
+    rows = NumLines();
+    cols = (rows > 0) ? SplitLine(0, tokens) : 0;
+    info.SetDimensionality(rows);
 
-    while (std::getline(inFile, line))
+    if (MapPolicy::NeedsFirstPass)
     {
-      ++rows;
-      // Remove whitespace from either side.
-      boost::trim(line);
-
-      if (rows == 1)
-      {
-        // Extract the number of columns.
-        auto findColSize = [&cols](iter_type) { ++cols; };
-        qi::parse(line.begin(), line.end(),
-            stringRule[findColSize] % delimiterRule);
-      }
-
-      // I guess this is technically a second pass, but that's ok... still the
-      // same idea...
-      if (MapPolicy::NeedsFirstPass)
+      // In this case we must pass everything we parse to the MapPolicy.
+      for (size_t row = 0; row < rows; ++row)
       {
-        // In this case we must pass everything we parse to the MapPolicy.
-        auto firstPassMap = [&](const iter_type& iter)
-        {
-          std::string str(iter.begin(), iter.end());
-          boost::trim(str);
-
-          info.template MapFirstPass<T>(std::move(str), rows - 1);
-        };
-
-        // Now parse the line.
-        qi::parse(line.begin(), line.end(),
-            stringRule[firstPassMap] % delimiterRule);
+        const size_t numTokens = SplitLine(row, tokens);
+        for (size_t i = 0; i < numTokens; ++i)
+          info.template MapFirstPass<T>(tokens[i], row);
       }
     }
   }
@@ -152,60 +121,55 @@ class LoadCSV
                               size_t& cols,
                               DatasetMapper<MapPolicy>& info)
   {
-    using namespace boost::spirit;
-
     // Take a pass through the file.  If the DatasetMapper policy requires it,
     // we will pass everything string through MapString().  This might be useful
     // if, e.g., the MapPolicy needs to find which dimensions are numeric or
     // categorical.
 
-    // Reset to the start of the file.
-    inFile.clear();
-    inFile.seekg(0, std::ios::beg);
-    rows = 0;
-    cols = 0;
+    // Each line is a point, and the number of tokens in the first line is the
+    // dimensionality.
+    std::vector<std::string> tokens;
+    cols = NumLines();
+    rows = (cols > 0) ? SplitLine(0, tokens) : 0;
+    if (cols > 0)
+      info.SetDimensionality(rows);
 
-    std::string line;
-    while (std::getline(inFile, line))
+    if (MapPolicy::NeedsFirstPass)
     {
-      ++cols;
-      // Remove whitespace from either side.
-      boost::trim(line);
-
-      if (cols == 1)
-      {
-        // Extract the number of dimensions.
-        auto findRowSize = [&rows](iter_type) { ++rows; };
-        qi::parse(line.begin(), line.end(),
-            stringRule[findRowSize] % delimiterRule);
-
-        // Now that we know the dimensionality, initialize the DatasetMapper.
-        info.SetDimensionality(rows);
-      }
-
-      // If we need to do a first pass for the DatasetMapper, do it.
-      if (MapPolicy::NeedsFirstPass)
+      // In this case we must pass everything we parse to the MapPolicy.
+      for (size_t col = 0; col < cols; ++col)
       {
-        size_t dim = 0;
-
-        // In this case we must pass everything we parse to the MapPolicy.
-        auto firstPassMap = [&](const iter_type& iter)
-        {
-          std::string str(iter.begin(), iter.end());
-          boost::trim(str);
-
-          info.template MapFirstPass<T>(std::move(str), dim++);
-        };
-
-        // Now parse the line.
-        qi::parse(line.begin(), line.end(),
-            stringRule[firstPassMap] % delimiterRule);
+        const size_t numTokens = SplitLine(col, tokens);
+        for (size_t dim = 0; dim < numTokens; ++dim)
+          info.template MapFirstPass<T>(tokens[dim], dim);
       }
     }
   }
 
  private:
-  using iter_type = boost::iterator_range<std::string::iterator>;
+  //! Check whether a map policy has a ParseNumeric() function that the
+  //! parallel parser can use.
+  HAS_MEM_FUNC(ParseNumeric, HasParseNumericCheck);
+
+  template<typename PolicyType, typename T>
+  struct HasParseNumeric
+  {
+    typedef bool (PolicyType::*Signature)(const std::string&, const Datatype,
+        T&) const;
+    static const bool value =
+        HasParseNumericCheck<PolicyType, Signature>::value;
+  };
+
+  //! A token that must be mapped by the DatasetMapper after the parallel pass.
+  struct PendingToken
+  {
+    //! Row of the token in the matrix.
+    size_t row;
+    //! Column of the token in the matrix.
+    size_t col;
+    //! The token.
+    std::string token;
+  };
 
   /**
    * Check whether or not the file has successfully opened; throw an exception
@@ -213,6 +177,35 @@ class LoadCSV
    */
   void CheckOpen();
 
+  //! Get the number of lines in the file.
+  size_t NumLines() const { return lines.size(); }
+
+  /**
+   * Split the given line of the file into tokens, which are stored in the
+   * first elements of 'tokens'.  The strings of 'tokens' are reused between
+   * calls, so this does not allocate memory once they are large enough.  This
+   * may be called from several threads at once (with different token
+   * vectors).
+   *
+   * @param line Index of the line to split.
+   * @param tokens Vector to store tokens in.
+   * @return Number of tokens in the line.
+   */
+  size_t SplitLine(const size_t line, std::vector<std::string>& tokens) const;
+
+  /**
+   * Throw an exception for a line with the wrong number of tokens.
+   *
+   * @param transpose Whether the matrix is being loaded transposed.
+   * @param line Index of the line.
+   * @param numTokens Number of tokens in the line.
+   * @param expected Expected number of tokens.
+   */
+  void ThrowWrongDimensions(const bool transpose,
+                            const size_t line,
+                            const size_t numTokens,
+                            const size_t expected) const;
+
   /**
    * Parse a non-transposed matrix.
    *
@@ -220,66 +213,29 @@ class LoadCSV
    * @param infoSet DatasetMapper object to load with.
    */
   template<typename T, typename PolicyType>
-  void NonTransposeParse(arma::Mat<T>& inout,
-                         DatasetMapper<PolicyType>& infoSet)
+  void NonTransposeParse(
+      arma::Mat<T>& inout,
+      DatasetMapper<PolicyType>& infoSet,
+      const typename std::enable_if<
+          !HasParseNumeric<PolicyType, T>::value>::type* = 0)
   {
-    using namespace boost::spirit;
-
     // Get the size of the matrix.
     size_t rows, cols;
     GetMatrixSize<T>(rows, cols, infoSet);
 
     // Set up output matrix.
     inout.set_size(rows, cols);
-    size_t row = 0;
-    size_t col = 0;
-
-    // Reset file position.
-    std::string line;
-    inFile.clear();
-    inFile.seekg(0, std::ios::beg);
-
-    auto setCharClass = [&](iter_type const &iter)
-    {
-      std::string str(iter.begin(), iter.end());
-      if (str == "\t")
-      {
-        str.clear();
-      }
-      boost::trim(str);
 
-      inout(row, col++) = infoSet.template MapString<T>(std::move(str), row);
-    };
-
-    while (std::getline(inFile, line))
+    std::vector<std::string> tokens;
+    for (size_t row = 0; row < rows; ++row)
     {
-      // Remove whitespace from either side.
-      boost::trim(line);
-
-      // Parse the numbers from a line (ex: 1,2,3,4); if the parser finds a
-      // number it will execute the setNum function.
-      const bool canParse = qi::parse(line.begin(), line.end(),
-          stringRule[setCharClass] % delimiterRule);
-
       // Make sure we got the right number of rows.
+      const size_t col = SplitLine(row, tokens);
       if (col != cols)
-      {
-        std::ostringstream oss;
-        oss << "LoadCSV::NonTransposeParse(): wrong number of dimensions ("
-            << col << ") on line " << row << "; should be " << cols
-            << " dimensions.";
-        throw std::runtime_error(oss.str());
-      }
-
-      if (!canParse)
-      {
-        std::ostringstream oss;
-        oss << "LoadCSV::NonTransposeParse(): parsing error on line " << col
-            << "!";
-        throw std::runtime_error(oss.str());
-      }
+        ThrowWrongDimensions(false, row, col, cols);
 
-      ++row; col = 0;
+      for (size_t i = 0; i < col; ++i)
+        inout(row, i) = infoSet.template MapString<T>(tokens[i], row);
     }
   }
 
@@ -290,10 +246,12 @@ class LoadCSV
    * @param infoSet DatasetMapper to load with.
    */
   template<typename T, typename PolicyType>
-  void TransposeParse(arma::Mat<T>& inout, DatasetMapper<PolicyType>& infoSet)
+  void TransposeParse(
+      arma::Mat<T>& inout,
+      DatasetMapper<PolicyType>& infoSet,
+      const typename std::enable_if<
+          !HasParseNumeric<PolicyType, T>::value>::type* = 0)
   {
-    using namespace boost::spirit;
-
     // Get matrix size.  This also initializes infoSet correctly.
     size_t rows, cols;
     GetTransposeMatrixSize<T>(rows, cols, infoSet);
@@ -301,66 +259,172 @@ class LoadCSV
     // Set the matrix size.
     inout.set_size(rows, cols);
 
-    // Initialize auxiliary variables.
-    size_t row = 0;
-    size_t col = 0;
-    std::string line;
-    inFile.clear();
-    inFile.seekg(0, std::ios::beg);
-
-    /**
-     * This is the parse rule for strings.  When we get a string we have to pass
-     * it to the DatasetMapper.
-     */
-    auto parseString = [&](iter_type const &iter)
+    std::vector<std::string> tokens;
+    for (size_t col = 0; col < cols; ++col)
     {
+      // Make sure we got the right number of rows.
+      const size_t row = SplitLine(col, tokens);
+      if (row != rows)
+        ThrowWrongDimensions(true, col, row, rows);
+
       // All parsed values must be mapped.
-      std::string str(iter.begin(), iter.end());
-      boost::trim(str);
+      for (size_t i = 0; i < row; ++i)
+        inout(i, col) = infoSet.template MapString<T>(tokens[i], i);
+    }
+  }
 
-      inout(row, col) = infoSet.template MapString<T>(std::move(str), row);
-      ++row;
-    };
+  //! Parse a non-transposed matrix in parallel.
+  template<typename T, typename PolicyType>
+  void NonTransposeParse(
+      arma::Mat<T>& inout,
+      DatasetMapper<PolicyType>& infoSet,
+      const typename std::enable_if<
+          HasParseNumeric<PolicyType, T>::value>::type* = 0)
+  {
+    ParallelParse(inout, infoSet, false);
+  }
 
-    while (std::getline(inFile, line))
-    {
-      // Remove whitespace from either side.
-      boost::trim(line);
+  //! Parse a transposed matrix in parallel.
+  template<typename T, typename PolicyType>
+  void TransposeParse(
+      arma::Mat<T>& inout,
+      DatasetMapper<PolicyType>& infoSet,
+      const typename std::enable_if<
+          HasParseNumeric<PolicyType, T>::value>::type* = 0)
+  {
+    ParallelParse(inout, infoSet, true);
+  }
+
+  /**
+   * Parse the matrix with several threads, for map policies that have a
+   * ParseNumeric() function.  The lines are split into one contiguous block
+   * for each thread.  If the policy needs a first pass, each thread runs
+   * MapFirstPass() on its own copy of the dimension types, and a dimension is
+   * categorical if any block found it to be.  Then each thread converts the
+   * numbers of its block with ParseNumeric() and keeps the other tokens, which
+   * are given to MapString() afterwards in the order of the file, so that the
+   * mappings are exactly those of a serial load.
+   *
+   * @param inout Matrix to load into.
+   * @param infoSet DatasetMapper to load with.
+   * @param transpose Whether each line of the file is a column of the matrix.
+   */
+  template<typename T, typename PolicyType>
+  void ParallelParse(arma::Mat<T>& inout,
+                     DatasetMapper<PolicyType>& infoSet,
+                     const bool transpose)
+  {
+    // The number of tokens on the first line gives the size of the matrix.
+    std::vector<std::string> tokens;
+    const size_t numLines = NumLines();
+    const size_t numTokens = (numLines > 0) ? SplitLine(0, tokens) : 0;
+    if (!transpose)
+      infoSet.SetDimensionality(numLines);
+    else if (numLines > 0)
+      infoSet.SetDimensionality(numTokens);
 
-      // Reset the row we are looking at.  (Remember this is transposed.)
-      row = 0;
+    if (transpose)
+      inout.set_size(numTokens, numLines);
+    else
+      inout.set_size(numLines, numTokens);
 
-      // Now use boost::spirit to parse the characters of the line;
-      // parseString() will be called when a token is detected.
-      const bool canParse = qi::parse(line.begin(), line.end(),
-          stringRule[parseString] % delimiterRule);
+    if (PolicyType::NeedsFirstPass)
+    {
+      const size_t dimensionality = transpose ? numTokens : numLines;
+      std::vector<Datatype> types(dimensionality, Datatype::numeric);
 
-      // Make sure we got the right number of rows.
-      if (row != rows)
+      #pragma omp parallel
       {
-        std::ostringstream oss;
-        oss << "LoadCSV::TransposeParse(): wrong number of dimensions (" << row
-            << ") on line " << col << "; should be " << rows << " dimensions.";
-        throw std::runtime_error(oss.str());
+        std::vector<std::string> threadTokens;
+        std::vector<Datatype> threadTypes(dimensionality, Datatype::numeric);
+
+        #pragma omp for schedule(static)
+        for (omp_size_t line = 0; line < (omp_size_t) numLines; ++line)
+        {
+          // Lines with the wrong number of tokens are reported below.
+          const size_t lineTokens = std::min(SplitLine(line, threadTokens),
+              numTokens);
+          for (size_t i = 0; i < lineTokens; ++i)
+          {
+            infoSet.Policy().template MapFirstPass<T>(threadTokens[i],
+                transpose ? i : line, threadTypes);
+          }
+        }
+
+        #pragma omp critical
+        {
+          for (size_t d = 0; d < dimensionality; ++d)
+            if (threadTypes[d] == Datatype::categorical)
+              types[d] = Datatype::categorical;
+        }
       }
 
-      if (!canParse)
+      for (size_t d = 0; d < dimensionality; ++d)
+        infoSet.Type(d) = types[d];
+    }
+
+    #ifdef HAS_OPENMP
+    const size_t maxThreads = omp_get_max_threads();
+    #else
+    const size_t maxThreads = 1;
+    #endif
+    std::vector<std::vector<PendingToken>> pending(maxThreads);
+    size_t wrongLine = numLines;
+
+    #pragma omp parallel
+    {
+      #ifdef HAS_OPENMP
+      const size_t thread = omp_get_thread_num();
+      #else
+      const size_t thread = 0;
+      #endif
+      std::vector<std::string> threadTokens;
+      const PolicyType& policy = infoSet.Policy();
+
+      // With a static schedule, the blocks are given to the threads in order,
+      // so the pending tokens of thread 0, 1, ... are in the order of the file.
+      #pragma omp for schedule(static)
+      for (omp_size_t line = 0; line < (omp_size_t) numLines; ++line)
       {
-        std::ostringstream oss;
-        oss << "LoadCSV::TransposeParse(): parsing error on line " << col
-            << "!";
-        throw std::runtime_error(oss.str());
+        if (SplitLine(line, threadTokens) != numTokens)
+        {
+          #pragma omp critical
+          wrongLine = std::min(wrongLine, (size_t) line);
+          continue;
+        }
+
+        for (size_t i = 0; i < numTokens; ++i)
+        {
+          // The row is also the dimension of the token.
+          const size_t row = transpose ? i : line;
+          const size_t col = transpose ? line : i;
+          if (!policy.ParseNumeric(threadTokens[i], infoSet.Type(row),
+              inout(row, col)))
+          {
+            pending[thread].push_back(PendingToken());
+            pending[thread].back().row = row;
+            pending[thread].back().col = col;
+            pending[thread].back().token.swap(threadTokens[i]);
+          }
+        }
       }
+    }
 
-      // Increment the column index.
-      ++col;
+    if (wrongLine < numLines)
+    {
+      ThrowWrongDimensions(transpose, wrongLine, SplitLine(wrongLine, tokens),
+          numTokens);
     }
-  }
 
-  //! Spirit rule for parsing.
-  boost::spirit::qi::rule<std::string::iterator, iter_type()> stringRule;
-  //! Spirit rule for delimiters (i.e. ',' for CSVs).
-  boost::spirit::qi::rule<std::string::iterator, iter_type()> delimiterRule;
+    for (size_t t = 0; t < pending.size(); ++t)
+    {
+      for (size_t i = 0; i < pending[t].size(); ++i)
+      {
+        const PendingToken& p = pending[t][i];
+        inout(p.row, p.col) = infoSet.template MapString<T>(p.token, p.row);
+      }
+    }
+  }
 
   //! Extension (type) of file.
   std::string extension;
@@ -368,6 +432,16 @@ class LoadCSV
   std::string filename;
   //! Opened stream for reading.
   std::ifstream inFile;
+
+  //! Delimiter between tokens (',', '\t' or ' ').
+  char delimiter;
+  //! Whether each character ends an unquoted token.
+  bool endsToken[256];
+
+  //! Contents of the file.
+  std::string buffer;
+  //! Start and end of each line in the buffer, without surrounding whitespace.
+  std::vector<std::pair<size_t, size_t>> lines;
 };
 
 } // namespace data
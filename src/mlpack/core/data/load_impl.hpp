@@ -21,6 +21,7 @@
 #include "load_csv.hpp"
 #include "load.hpp"
 #include "extension.hpp"
+#include "npy_format.hpp"
 
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/tokenizer.hpp>
@@ -77,6 +78,73 @@ bool inline inplace_transpose(arma::Mat<eT>& X)
   }
 }
 
+namespace details {
+
+/**
+ * Load a .npy file, aliasing the mapped file if mappedFile is not NULL and the
+ * elements can be used as they are.  The loading_data timer must be running.
+ */
+template<typename eT>
+bool LoadNPYFile(const std::string& filename,
+                 arma::Mat<eT>& matrix,
+                 std::shared_ptr<util::MappedFile>* mappedFile,
+                 const bool fatal,
+                 const bool transpose)
+{
+  Log::Info << "Loading '" << filename << "' as NumPy data.  " << std::flush;
+  try
+  {
+    std::shared_ptr<util::MappedFile> file(new util::MappedFile(filename));
+    const bool aliased = LoadNPY(*file, matrix, transpose, mappedFile != NULL);
+
+    // Only keep the mapping if the matrix uses it.
+    if (mappedFile && aliased)
+      *mappedFile = std::move(file);
+    else if (mappedFile)
+      mappedFile->reset();
+  }
+  catch (std::exception& e)
+  {
+    Log::Info << std::endl;
+    Timer::Stop("loading_data");
+    if (fatal)
+      Log::Fatal << "Loading from '" << filename << "' failed: " << e.what()
+          << std::endl;
+    else
+      Log::Warn << "Loading from '" << filename << "' failed: " << e.what()
+          << std::endl;
+
+    return false;
+  }
+
+  Log::Info << "Size is " << matrix.n_rows << " x " << matrix.n_cols << ".\n";
+  Timer::Stop("loading_data");
+
+  return true;
+}
+
+} // namespace details
+
+template<typename eT>
+bool Load(const std::string& filename,
+          arma::Mat<eT>& matrix,
+          std::shared_ptr<util::MappedFile>& mappedFile,
+          const bool fatal,
+          const bool transpose)
+{
+  // Other formats are always read into memory owned by the matrix.
+  if (Extension(filename) != "npy")
+  {
+    const bool success = Load(filename, matrix, fatal, transpose);
+    if (success)
+      mappedFile.reset();
+    return success;
+  }
+
+  Timer::Start("loading_data");
+  return details::LoadNPYFile(filename, matrix, &mappedFile, fatal, transpose);
+}
+
 template<typename eT>
 bool Load(const std::string& filename,
           arma::Mat<eT>& matrix,
@@ -107,6 +175,9 @@ bool Load(const std::string& filename,
     return false;
   }
 
+  if (extension == "npy")
+    return details::LoadNPYFile(filename, matrix, NULL, fatal, transpose);
+
   bool unknownType = false;
   arma::file_type loadType;
   std::string stringType;
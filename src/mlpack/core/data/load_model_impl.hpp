@@ -25,6 +25,7 @@
 #include <boost/archive/xml_iarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/binary_iarchive.hpp>
+#include "portable_binary_archive.hpp"
 #include <boost/tokenizer.hpp>
 #include <boost/algorithm/string.hpp>
 
@@ -49,6 +50,10 @@ bool Load(const std::string& filename,
       f = format::binary;
     else if (extension == "txt")
       f = format::text;
+    else if (extension == "pbin")
+      f = format::portable_binary;
+    else if (extension == "pbz")
+      f = format::portable_binary_compressed;
     else
     {
       if (fatal)
@@ -64,14 +69,14 @@ bool Load(const std::string& filename,
 
   // Now load the given format.
   std::ifstream ifs;
+  if (f == format::portable_binary || f == format::portable_binary_compressed)
+    ifs.open(filename, std::ifstream::in | std::ifstream::binary);
 #ifdef _WIN32 // Open non-text in binary mode on Windows.
-  if (f == format::binary)
+  else if (f == format::binary)
     ifs.open(filename, std::ifstream::in | std::ifstream::binary);
+#endif
   else
     ifs.open(filename, std::ifstream::in);
-#else
-  ifs.open(filename, std::ifstream::in);
-#endif
 
   if (!ifs.is_open())
   {
@@ -102,6 +107,14 @@ bool Load(const std::string& filename,
       boost::archive::binary_iarchive ar(ifs);
       ar >> boost::serialization::make_nvp(name.c_str(), t);
     }
+    else if (f == format::portable_binary ||
+             f == format::portable_binary_compressed)
+    {
+      // Compression is detected from the header of the file.
+      PortableBinaryIArchive ar(ifs);
+      ar >> boost::serialization::make_nvp(name.c_str(), t);
+      ar.Finish();
+    }
 
     return true;
   }
@@ -114,6 +127,17 @@ bool Load(const std::string& filename,
 
     return false;
   }
+  catch (std::runtime_error& e)
+  {
+    // Thrown by the portable binary archives (for instance, if the checksum
+    // does not match).
+    if (fatal)
+      Log::Fatal << "'" << filename << "': " << e.what() << std::endl;
+    else
+      Log::Warn << "'" << filename << "': " << e.what() << std::endl;
+
+    return false;
+  }
 }
 
 } // namespace data
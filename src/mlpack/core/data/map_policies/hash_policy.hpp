@@ -0,0 +1,178 @@
+/**
+ * @file hash_policy.hpp
+ *
+ * Hashing map policy for dataset info: categorical inputs are mapped to a hash
+ * of their contents (the hashing trick), and no mappings are stored.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_MAP_POLICIES_HASH_POLICY_HPP
+#define MLPACK_CORE_DATA_MAP_POLICIES_HASH_POLICY_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/data/map_policies/datatype.hpp>
+#include <mlpack/core/data/parse_number.hpp>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * HashPolicy is used as a helper class for DatasetMapper.  Like
+ * IncrementPolicy, it decides in a first pass over the data which dimensions
+ * are categorical (a dimension is categorical if any of its inputs cannot be
+ * read as a number).  But instead of numbering the inputs of a categorical
+ * dimension in the order in which they appear, it maps each input to a hash of
+ * its contents modulo the number of buckets: the hashing trick.
+ *
+ * No mappings are stored at all, so the memory used does not grow with the
+ * number of distinct inputs, and every input can be mapped independently (so
+ * LoadCSV maps categorical inputs in parallel too).  The price is that
+ * different inputs may map to the same value, and mapped values cannot be
+ * unmapped: UnmapString() and UnmapValue() throw.  NumMappings() of a
+ * categorical dimension is the number of buckets.
+ *
+ * The hash is 64-bit FNV-1a, so mapped values are the same on every platform.
+ *
+ * @code
+ * HashPolicy policy(1 << 20);
+ * DatasetMapper<HashPolicy> info(policy);
+ * arma::mat dataset;
+ * data::Load("clicks.csv", dataset, info);
+ * @endcode
+ */
+class HashPolicy
+{
+ public:
+  // typedef of MappedType
+  using MappedType = size_t;
+
+  /**
+   * Create the policy with the given number of buckets.
+   *
+   * @param numBuckets Number of distinct values that inputs are mapped to.
+   */
+  HashPolicy(const size_t numBuckets = (size_t(1) << 24)) :
+      numBuckets(numBuckets)
+  {
+    if (numBuckets == 0)
+      throw std::invalid_argument("HashPolicy: number of buckets must be "
+          "positive");
+  }
+
+  //! We do need a first pass over the data to set the dimension types right.
+  static const bool NeedsFirstPass = true;
+
+  /**
+   * Determine if the dimension is numeric or categorical.
+   */
+  template<typename T, typename InputType>
+  void MapFirstPass(const InputType& input,
+                    const size_t dim,
+                    std::vector<Datatype>& types)
+  {
+    if (types[dim] == Datatype::categorical)
+      return;
+
+    T val;
+    if (!ParseNumber(input, val))
+      types[dim] = Datatype::categorical;
+  }
+
+  /**
+   * Read the given input into value: numeric dimensions are read as numbers,
+   * and the inputs of categorical dimensions are hashed.  This does not modify
+   * the policy, so it can be called from several threads at once.
+   *
+   * @param input Input to read.
+   * @param type Type of the dimension of the input.
+   * @param value Variable to store the number in.
+   * @return true if the input was read into value.
+   */
+  template<typename T>
+  bool ParseNumeric(const std::string& input,
+                    const Datatype type,
+                    T& value) const
+  {
+    if (type == Datatype::numeric)
+      return ParseNumber(input, value);
+
+    value = T(Hash(input));
+    return true;
+  }
+
+  /**
+   * Map the given input: if the dimension is numeric and the input can be
+   * read as a number, the number is returned; otherwise the dimension becomes
+   * categorical and the hash of the input is returned.  No mapping is stored.
+   *
+   * @tparam MapType Type of unordered_map that contains mapped value pairs
+   * @param input Input to map.
+   * @param dimension Index of the dimension of the input.
+   * @param maps Unordered map given by the DatasetMapper (unused).
+   * @param types Vector containing the type information about each dimensions.
+   */
+  template<typename MapType, typename T, typename InputType>
+  T MapString(const InputType& input,
+              const size_t dimension,
+              MapType& /* maps */,
+              std::vector<Datatype>& types)
+  {
+    if (types[dimension] == Datatype::numeric)
+    {
+      T val;
+      if (ParseNumber(input, val))
+        return val;
+
+      types[dimension] = Datatype::categorical;
+    }
+
+    return T(Hash(input));
+  }
+
+  //! Get the number of mappings of a dimension of the given type (the number
+  //! of buckets if it is categorical).
+  size_t NumMappings(const Datatype type) const
+  {
+    return (type == Datatype::categorical) ? numBuckets : 0;
+  }
+
+  //! Get the number of buckets.
+  size_t NumBuckets() const { return numBuckets; }
+
+  /**
+   * Hash the given input to a bucket.
+   *
+   * @param input Input to hash.
+   */
+  template<typename InputType>
+  size_t Hash(const InputType& input) const
+  {
+    std::ostringstream oss;
+    oss << input;
+    return Hash(oss.str());
+  }
+
+  size_t Hash(const std::string& input) const
+  {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < input.size(); ++i)
+    {
+      hash ^= (unsigned char) input[i];
+      hash *= 1099511628211ULL;
+    }
+
+    return size_t(hash % numBuckets);
+  }
+
+ private:
+  //! The number of buckets.
+  size_t numBuckets;
+}; // class HashPolicy
+
+} // namespace data
+} // namespace mlpack
+
+#endif
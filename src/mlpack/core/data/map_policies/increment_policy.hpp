@@ -15,6 +15,7 @@
 #include <mlpack/prereqs.hpp>
 #include <unordered_map>
 #include <mlpack/core/data/map_policies/datatype.hpp>
+#include <mlpack/core/data/parse_number.hpp>
 
 namespace mlpack {
 namespace data {
@@ -62,17 +63,33 @@ class IncrementPolicy
     }
     else
     {
-      // Attempt to convert the input to an output type via a stringstream.
-      std::stringstream token;
-      token << input;
+      // Attempt to convert the input to an output type.
       T val;
-      token >> val;
-
-      if (token.fail() || !token.eof())
+      if (!ParseNumber(input, val))
         types[dim] = Datatype::categorical;
     }
   }
 
+  /**
+   * If MapString() would return the given input as a number without creating a
+   * mapping, read it into value.  This does not modify the policy, so it can be
+   * called from several threads at once; LoadCSV uses it to convert numbers in
+   * parallel and only calls MapString() for the other inputs.
+   *
+   * @param input Input to read.
+   * @param type Type of the dimension of the input.
+   * @param value Variable to store the number in.
+   * @return true if the input was read into value.
+   */
+  template<typename T>
+  bool ParseNumeric(const std::string& input,
+                    const Datatype type,
+                    T& value) const
+  {
+    return (type == Datatype::numeric && !forceAllMappings &&
+        ParseNumber(input, value));
+  }
+
   /**
    * Given the input and the dimension to which the it belongs, and the maps
    * and types given by the DatasetMapper class, returns its numeric mapping.
@@ -98,48 +115,36 @@ class IncrementPolicy
       // Check if this input needs to be mapped or if it can be read
       // directly as a number.  This will be true if nothing else in this
       // dimension has yet been mapped, but this can't be read as a number.
-      std::stringstream token;
-      token << input;
       T val;
-      token >> val;
-
-      if (!token.fail() && token.eof())
+      if (ParseNumber(input, val))
         return val;
 
       // Otherwise, we must map.
     }
 
-    // If this condition is true, either we have no mapping for the given input
-    // or we have no mappings for the given dimension at all.  In either case,
-    // we create a mapping.
-    if (maps.count(dimension) == 0 ||
-        maps[dimension].first.count(input) == 0)
+    // Look the dimension and the input up only once each, since this is
+    // called for every categorical input and the maps of high-cardinality
+    // dimensions are large.
+    typename MapType::mapped_type& dimensionMaps = maps[dimension];
+    typename MapType::mapped_type::first_type::const_iterator it =
+        dimensionMaps.first.find(input);
+    if (it != dimensionMaps.first.end())
     {
-      // This input does not exist yet.
-      size_t numMappings = maps[dimension].first.size();
+      // This input already exists in the mapping.
+      return T(it->second);
+    }
 
-      // Change type of the feature to categorical.
-      if (numMappings == 0)
-        types[dimension] = Datatype::categorical;
+    // This input does not exist yet, so we create a mapping.
+    const size_t numMappings = dimensionMaps.first.size();
 
-      typedef typename std::pair<InputType, MappedType> PairType;
-      maps[dimension].first.insert(PairType(input, numMappings));
+    // Change type of the feature to categorical.
+    if (numMappings == 0)
+      types[dimension] = Datatype::categorical;
 
-      // Do we need to create the second map?
-      if (maps[dimension].second.count(numMappings) == 0)
-      {
-        maps[dimension].second.insert(std::make_pair(numMappings,
-            std::vector<InputType>()));
-      }
-      maps[dimension].second[numMappings].push_back(input);
+    dimensionMaps.first.insert(std::make_pair(input, MappedType(numMappings)));
+    dimensionMaps.second[numMappings].push_back(input);
 
-      return T(numMappings);
-    }
-    else
-    {
-      // This input already exists in the mapping.
-      return maps[dimension].first.at(input);
-    }
+    return T(numMappings);
   }
 
  private:
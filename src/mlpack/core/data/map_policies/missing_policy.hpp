@@ -15,6 +15,7 @@
 #include <mlpack/prereqs.hpp>
 #include <unordered_map>
 #include <mlpack/core/data/map_policies/datatype.hpp>
+#include <mlpack/core/data/parse_number.hpp>
 #include <limits>
 
 namespace mlpack {
@@ -64,6 +65,26 @@ class MissingPolicy
     // Nothing to do.
   }
 
+  /**
+   * If MapString() would return the given input as a number without creating a
+   * mapping, read it into value.  This does not modify the policy, so it can be
+   * called from several threads at once; LoadCSV uses it to convert numbers in
+   * parallel and only calls MapString() for the other inputs.
+   *
+   * @param input Input to read.
+   * @param type Type of the dimension of the input (unused).
+   * @param value Variable to store the number in.
+   * @return true if the input was read into value.
+   */
+  template<typename T>
+  bool ParseNumeric(const std::string& input,
+                    const Datatype /* type */,
+                    T& value) const
+  {
+    return ParseNumber(input, value) &&
+        (missingSet.find(input) == std::end(missingSet));
+  }
+
   /**
    * Given the string and the dimension to which it belongs by the user, and
    * the maps and types given by the DatasetMapper class, returns its numeric
@@ -88,10 +109,8 @@ class MissingPolicy
         "Cannot use MissingPolicy with types where has_quiet_NaN() is false!");
 
     // If we can load the string then there is no need for mapping.
-    std::stringstream token;
-    token.str(string);
     T t;
-    token >> t; // Could be sped up by only doing this if we need to.
+    const bool isNumber = ParseNumber(string, t);
 
     MappedType value = std::numeric_limits<MappedType>::quiet_NaN();
     // But we can't use that for the map, so we need some other thing that will
@@ -101,8 +120,7 @@ class MissingPolicy
 
     // If extraction of the value fails, or if it is a value that is supposed to
     // be mapped, then do mapping.
-    if (token.fail() || !token.eof() ||
-        missingSet.find(string) != std::end(missingSet))
+    if (!isNumber || missingSet.find(string) != std::end(missingSet))
     {
       // Everything is mapped to NaN.  However we must still keep track of
       // everything that we have mapped, so we add it to the maps if needed.
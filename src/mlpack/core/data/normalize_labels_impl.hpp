@@ -19,6 +19,71 @@
 namespace mlpack {
 namespace data {
 
+namespace detail {
+
+/**
+ * Normalize integer labels that lie in a small range with a lookup table
+ * instead of a hash map.  Returns false (and does nothing) if the range of the
+ * labels is too large compared to the number of labels.
+ */
+template<typename eT, typename RowType>
+bool NormalizeDenseLabels(const RowType& labelsIn,
+                          arma::Row<size_t>& labels,
+                          arma::Col<eT>& mapping,
+                          std::true_type /* integral */)
+{
+  if (labelsIn.n_elem == 0)
+    return false;
+
+  eT minLabel = eT(labelsIn[0]);
+  eT maxLabel = minLabel;
+  for (size_t i = 1; i < labelsIn.n_elem; ++i)
+  {
+    const eT label = eT(labelsIn[i]);
+    minLabel = std::min(minLabel, label);
+    maxLabel = std::max(maxLabel, label);
+  }
+
+  // Compute the range in floating point, since it may not fit in eT.
+  const double range = double(maxLabel) - double(minLabel) + 1.0;
+  if (range > std::max(2.0 * labelsIn.n_elem, 4096.0))
+    return false;
+
+  // The table holds the new label of each label in the range (or SIZE_MAX if
+  // the label has not been seen yet).  Labels are numbered in the order in
+  // which they first appear, just like with the hash map.
+  std::vector<size_t> table((size_t) range, SIZE_MAX);
+  mapping.set_size((size_t) range);
+  labels.set_size(labelsIn.n_elem);
+  size_t curLabel = 0;
+  for (size_t i = 0; i < labelsIn.n_elem; ++i)
+  {
+    const eT label = eT(labelsIn[i]);
+    size_t& newLabel = table[size_t(label - minLabel)];
+    if (newLabel == SIZE_MAX)
+    {
+      newLabel = curLabel;
+      mapping[curLabel++] = label;
+    }
+    labels[i] = newLabel;
+  }
+
+  mapping.resize(curLabel);
+  return true;
+}
+
+//! Labels that aren't integers can't be normalized with a lookup table.
+template<typename eT, typename RowType>
+bool NormalizeDenseLabels(const RowType& /* labelsIn */,
+                          arma::Row<size_t>& /* labels */,
+                          arma::Col<eT>& /* mapping */,
+                          std::false_type /* integral */)
+{
+  return false;
+}
+
+} // namespace detail
+
 /**
  * Given a set of labels of a particular datatype, convert them to unsigned
  * labels in the range [0, n) where n is the number of different labels.  Also,
@@ -34,6 +99,12 @@ void NormalizeLabels(const RowType& labelsIn,
                      arma::Row<size_t>& labels,
                      arma::Col<eT>& mapping)
 {
+  // Integer labels that are already in a small range (like 0 to k - 1) don't
+  // need a hash map.
+  if (detail::NormalizeDenseLabels(labelsIn, labels, mapping,
+      std::is_integral<eT>()))
+    return;
+
   // Loop over the input labels, and develop the mapping.  We'll first naively
   // resize the mapping to the maximum possible size, and then when we fill it,
   // we'll resize it back down to its actual size.
@@ -44,26 +115,16 @@ void NormalizeLabels(const RowType& labelsIn,
   size_t curLabel = 0;
   for (size_t i = 0; i < labelsIn.n_elem; ++i)
   {
-    // If labelsIn[i] is already in the map, use the existing label.
-    if (labelMap.count(labelsIn[i]) > 0)
-    {
-      labels[i] = labelMap[labelsIn[i]];
-    }
-    else
-    {
-      // If labelsIn[i] not there then add it to map.
-      labelMap[labelsIn[i]] = curLabel;
-      labels[i] = curLabel;
-      ++curLabel;
-    }
+    // If labelsIn[i] is not in the map yet, give it the next label; only one
+    // lookup is needed either way.
+    const eT label = eT(labelsIn[i]);
+    const auto result = labelMap.emplace(label, curLabel);
+    if (result.second)
+      mapping[curLabel++] = label;
+    labels[i] = result.first->second;
   }
   // Resize mapping back down to necessary size.
   mapping.resize(curLabel);
-  // Mapping array created with encoded labels.
-  for (auto it = labelMap.begin(); it != labelMap.end(); ++it)
-  {
-    mapping[it->second] = it->first;
-  }
 }
 
 /**
@@ -82,7 +143,8 @@ void RevertLabels(const arma::Row<size_t>& labels,
   // We already have the mapping, so we just need to loop over each element.
   labelsOut.set_size(labels.n_elem);
 
-  for (size_t i = 0; i < labels.n_elem; ++i)
+  #pragma omp parallel for schedule(static)
+  for (omp_size_t i = 0; i < (omp_size_t) labels.n_elem; ++i)
     labelsOut[i] = mapping[labels[i]];
 }
 
@@ -0,0 +1,181 @@
+/**
+ * @file npy_format.cpp
+ *
+ * Reading and writing of .npy headers.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "npy_format.hpp"
+
+#include <cstring>
+
+namespace mlpack {
+namespace data {
+
+//! Find the value of the given key in the header dictionary, and return the
+//! position of its first character.
+static size_t FindNPYValue(const std::string& dict,
+                           const std::string& key,
+                           const std::string& error)
+{
+  size_t pos = dict.find("'" + key + "'");
+  if (pos == std::string::npos)
+    pos = dict.find("\"" + key + "\"");
+  if (pos == std::string::npos)
+    throw std::runtime_error(error + "has no '" + key + "' in its header");
+
+  pos = dict.find(':', pos + key.size() + 2);
+  if (pos == std::string::npos)
+    throw std::runtime_error(error + "has an invalid header");
+
+  // Skip the colon and any spaces after it.
+  for (++pos; pos < dict.size() && dict[pos] == ' '; ++pos) { }
+  return pos;
+}
+
+NPYHeader ReadNPYHeader(const char* data,
+                        const size_t size,
+                        const std::string& filename)
+{
+  const std::string error = "'" + filename + "' ";
+  if (size < 10 || std::memcmp(data, "\x93NUMPY", 6) != 0)
+    throw std::runtime_error(error + "is not a .npy file");
+
+  // Version 1.0 has a 2-byte header length; versions 2.0 and 3.0 have a 4-byte
+  // header length.  Both are little-endian.
+  const unsigned char* bytes = (const unsigned char*) data;
+  size_t headerStart, headerLength;
+  if (bytes[6] == 1)
+  {
+    headerStart = 10;
+    headerLength = size_t(bytes[8]) | (size_t(bytes[9]) << 8);
+  }
+  else if ((bytes[6] == 2 || bytes[6] == 3) && size >= 12)
+  {
+    headerStart = 12;
+    headerLength = size_t(bytes[8]) | (size_t(bytes[9]) << 8) |
+        (size_t(bytes[10]) << 16) | (size_t(bytes[11]) << 24);
+  }
+  else
+  {
+    throw std::runtime_error(error + "has an unsupported .npy format version");
+  }
+
+  if (headerLength > size - headerStart)
+    throw std::runtime_error(error + "is truncated or corrupt");
+
+  const std::string dict(data + headerStart, headerLength);
+  NPYHeader header;
+  header.dataOffset = headerStart + headerLength;
+
+  // The element type, for instance '<f8'.
+  size_t pos = FindNPYValue(dict, "descr", error);
+  if (pos == dict.size() || (dict[pos] != '\'' && dict[pos] != '"'))
+    throw std::runtime_error(error + "has an unsupported element type");
+  const size_t end = dict.find(dict[pos], pos + 1);
+  if (end == std::string::npos || end - pos < 4)
+    throw std::runtime_error(error + "has an unsupported element type");
+
+  const char byteOrder = dict[pos + 1];
+  header.kind = dict[pos + 2];
+  header.elemSize = 0;
+  for (size_t i = pos + 3; i < end; ++i)
+  {
+    if (dict[i] < '0' || dict[i] > '9' || header.elemSize > 16)
+      throw std::runtime_error(error + "has an unsupported element type");
+    header.elemSize = 10 * header.elemSize + (dict[i] - '0');
+  }
+
+  const bool validSize = (header.kind == 'f') ?
+      (header.elemSize == 4 || header.elemSize == 8) :
+      (header.elemSize == 1 || header.elemSize == 2 || header.elemSize == 4 ||
+       header.elemSize == 8);
+  if ((header.kind != 'f' && header.kind != 'i' && header.kind != 'u') ||
+      !validSize ||
+      (byteOrder != '<' && byteOrder != '=' && byteOrder != '|' &&
+       byteOrder != '>'))
+  {
+    throw std::runtime_error(error + "has an unsupported element type '" +
+        dict.substr(pos + 1, end - pos - 1) + "'");
+  }
+  if (byteOrder == '>' && header.elemSize > 1)
+    throw std::runtime_error(error + "holds big-endian data, which is not "
+        "supported");
+
+  // The memory order.
+  pos = FindNPYValue(dict, "fortran_order", error);
+  if (dict.compare(pos, 4, "True") == 0)
+    header.fortranOrder = true;
+  else if (dict.compare(pos, 5, "False") == 0)
+    header.fortranOrder = false;
+  else
+    throw std::runtime_error(error + "has an invalid header");
+
+  // The shape, for instance (100, 3) or (100,).
+  pos = FindNPYValue(dict, "shape", error);
+  if (pos == dict.size() || dict[pos] != '(')
+    throw std::runtime_error(error + "has an invalid header");
+
+  std::vector<size_t> shape;
+  for (++pos; pos < dict.size() && dict[pos] != ')'; ++pos)
+  {
+    if (dict[pos] == ' ' || dict[pos] == ',')
+      continue;
+    if (dict[pos] < '0' || dict[pos] > '9')
+      throw std::runtime_error(error + "has an invalid header");
+
+    size_t dimension = 0;
+    for (; pos < dict.size() && dict[pos] >= '0' && dict[pos] <= '9'; ++pos)
+    {
+      if (dimension > (std::numeric_limits<size_t>::max() - 9) / 10)
+        throw std::runtime_error(error + "has an invalid header");
+      dimension = 10 * dimension + (dict[pos] - '0');
+    }
+    shape.push_back(dimension);
+    --pos;
+  }
+  if (pos == dict.size())
+    throw std::runtime_error(error + "has an invalid header");
+
+  if (shape.size() > 2)
+    throw std::runtime_error(error + "holds an array with more than two "
+        "dimensions");
+  header.rows = (shape.size() > 0) ? shape[0] : 1;
+  header.cols = (shape.size() > 1) ? shape[1] : 1;
+
+  // Make sure that all the elements are in the file.
+  const size_t available = (size - header.dataOffset) / header.elemSize;
+  if (header.rows != 0 && header.cols > available / header.rows)
+    throw std::runtime_error(error + "is truncated or corrupt");
+
+  return header;
+}
+
+void WriteNPYHeader(std::ostream& stream, const NPYHeader& header)
+{
+  std::ostringstream dict;
+  dict << "{'descr': '" << ((header.elemSize == 1) ? '|' : '<') << header.kind
+      << header.elemSize << "', 'fortran_order': "
+      << (header.fortranOrder ? "True" : "False") << ", 'shape': ("
+      << header.rows << ", " << header.cols << "), }";
+
+  // Pad the dictionary with spaces (and the newline that ends it), so that the
+  // elements start on a page boundary.
+  std::string padded = dict.str();
+  const size_t unpadded = 10 + padded.size() + 1;
+  const size_t dataOffset = ((unpadded + 4095) / 4096) * 4096;
+  padded.append(dataOffset - unpadded, ' ');
+  padded.push_back('\n');
+
+  const size_t headerLength = padded.size();
+  const char preamble[10] = { '\x93', 'N', 'U', 'M', 'P', 'Y', 1, 0,
+      char(headerLength & 0xFF), char((headerLength >> 8) & 0xFF) };
+  stream.write(preamble, 10);
+  stream.write(padded.data(), padded.size());
+}
+
+} // namespace data
+} // namespace mlpack
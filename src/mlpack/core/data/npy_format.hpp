@@ -0,0 +1,118 @@
+/**
+ * @file npy_format.hpp
+ *
+ * Reading and writing matrices in the NumPy .npy format, so that binary
+ * datasets can be mapped into memory and used without being read or parsed.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_NPY_FORMAT_HPP
+#define MLPACK_CORE_DATA_NPY_FORMAT_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/mapped_file.hpp>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * The header of a .npy file: the element type, the memory order, and the shape
+ * of the array, and where the elements start in the file.  Only arrays with
+ * at most two dimensions can be loaded; a one-dimensional array of n elements
+ * is treated as an n x 1 array, just like a file with one value per line.
+ */
+struct NPYHeader
+{
+  //! Kind of the elements: 'f' (floating point), 'i' (signed integer) or 'u'
+  //! (unsigned integer).
+  char kind;
+  //! Size of each element in bytes.
+  size_t elemSize;
+  //! Whether the elements are stored in column-major (Fortran) order.
+  bool fortranOrder;
+  //! Number of rows of the array.
+  size_t rows;
+  //! Number of columns of the array.
+  size_t cols;
+  //! Offset of the first element from the beginning of the file.
+  size_t dataOffset;
+};
+
+/**
+ * Read the header of a .npy file held in memory.  std::runtime_error is thrown
+ * if the header is invalid or describes an array that cannot be loaded (more
+ * than two dimensions, or an unsupported or big-endian element type), or if
+ * the file is too short to hold the array.
+ *
+ * @param data Contents of the file.
+ * @param size Size of the file in bytes.
+ * @param filename Name of the file (for error messages).
+ */
+NPYHeader ReadNPYHeader(const char* data,
+                        const size_t size,
+                        const std::string& filename);
+
+/**
+ * Write a version 1.0 .npy header for a two-dimensional array.  The header is
+ * padded so that the elements start at a multiple of 4096 bytes, so that a
+ * mapping of the file gives page-aligned element memory.
+ *
+ * @param stream Stream to write to.
+ * @param header Description of the array; dataOffset is ignored.
+ */
+void WriteNPYHeader(std::ostream& stream, const NPYHeader& header);
+
+/**
+ * Fill a matrix with the contents of a mapped .npy file.  If transpose is
+ * true, each row of the array becomes a column of the matrix (as for every
+ * other format).
+ *
+ * If alias is true and the file holds elements of type eT in the memory order
+ * that the matrix needs (C order if transpose is true, Fortran order if it is
+ * false), the matrix is made an alias of the mapped memory and nothing is
+ * copied; in that case the mapping must outlive the matrix, and the function
+ * returns true.  Otherwise the elements are copied (and converted, if the file
+ * holds elements of another type) and false is returned.
+ *
+ * std::runtime_error is thrown if the file cannot be loaded.
+ *
+ * @param file Mapped .npy file.
+ * @param matrix Matrix to load into.
+ * @param transpose Whether to transpose the array.
+ * @param alias Whether to alias the mapped memory if possible.
+ * @return Whether the matrix is an alias of the mapped memory.
+ */
+template<typename eT>
+bool LoadNPY(const util::MappedFile& file,
+             arma::Mat<eT>& matrix,
+             const bool transpose,
+             const bool alias);
+
+/**
+ * Save a matrix in the .npy format.  If transpose is true, each column of the
+ * matrix becomes a row of the array, which is stored in C order; otherwise the
+ * array is the matrix, stored in Fortran order.  Either way the elements are
+ * written straight from the memory of the matrix, and loading the file again
+ * with the same transpose setting can alias the mapped file.
+ *
+ * std::runtime_error is thrown if the file cannot be written.
+ *
+ * @param filename Name of file to save to.
+ * @param matrix Matrix to save.
+ * @param transpose Whether to transpose the matrix.
+ */
+template<typename eT>
+void SaveNPY(const std::string& filename,
+             const arma::Mat<eT>& matrix,
+             const bool transpose);
+
+} // namespace data
+} // namespace mlpack
+
+// Include implementation.
+#include "npy_format_impl.hpp"
+
+#endif
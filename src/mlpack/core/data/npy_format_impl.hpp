@@ -0,0 +1,151 @@
+/**
+ * @file npy_format_impl.hpp
+ *
+ * Implementation of LoadNPY() and SaveNPY().
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_NPY_FORMAT_IMPL_HPP
+#define MLPACK_CORE_DATA_NPY_FORMAT_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "npy_format.hpp"
+
+#include <cstring>
+
+namespace mlpack {
+namespace data {
+
+namespace detail {
+
+//! The .npy kind of the element type eT.
+template<typename eT>
+inline char NPYKind()
+{
+  return std::is_floating_point<eT>::value ? 'f' :
+      (std::is_signed<eT>::value ? 'i' : 'u');
+}
+
+//! Convert n elements of type SourceType, which may not be aligned, to eT.
+template<typename SourceType, typename eT>
+inline void ConvertNPYElements(const char* source, eT* dest, const size_t n)
+{
+  for (size_t i = 0; i < n; ++i)
+  {
+    SourceType value;
+    std::memcpy(&value, source + i * sizeof(SourceType), sizeof(SourceType));
+    dest[i] = eT(value);
+  }
+}
+
+//! Convert n elements of the type given by the header to eT.
+template<typename eT>
+inline void ConvertNPYElements(const NPYHeader& header,
+                               const char* source,
+                               eT* dest,
+                               const size_t n)
+{
+  if (header.kind == 'f' && header.elemSize == 4)
+    ConvertNPYElements<float>(source, dest, n);
+  else if (header.kind == 'f')
+    ConvertNPYElements<double>(source, dest, n);
+  else if (header.kind == 'i' && header.elemSize == 1)
+    ConvertNPYElements<int8_t>(source, dest, n);
+  else if (header.kind == 'i' && header.elemSize == 2)
+    ConvertNPYElements<int16_t>(source, dest, n);
+  else if (header.kind == 'i' && header.elemSize == 4)
+    ConvertNPYElements<int32_t>(source, dest, n);
+  else if (header.kind == 'i')
+    ConvertNPYElements<int64_t>(source, dest, n);
+  else if (header.elemSize == 1)
+    ConvertNPYElements<uint8_t>(source, dest, n);
+  else if (header.elemSize == 2)
+    ConvertNPYElements<uint16_t>(source, dest, n);
+  else if (header.elemSize == 4)
+    ConvertNPYElements<uint32_t>(source, dest, n);
+  else
+    ConvertNPYElements<uint64_t>(source, dest, n);
+}
+
+} // namespace detail
+
+template<typename eT>
+bool LoadNPY(const util::MappedFile& file,
+             arma::Mat<eT>& matrix,
+             const bool transpose,
+             const bool alias)
+{
+  const NPYHeader header = ReadNPYHeader(file.Data(), file.Size(),
+      file.Filename());
+  const char* elements = file.Data() + header.dataOffset;
+
+  // An n x d array in C order has the memory of a d x n column-major matrix,
+  // so it is already transposed.  Vectors have the same memory either way.
+  const size_t rows = transpose ? header.cols : header.rows;
+  const size_t cols = transpose ? header.rows : header.cols;
+  const bool needsTranspose = (header.fortranOrder == transpose) &&
+      (header.rows > 1) && (header.cols > 1);
+
+  if (alias && !needsTranspose && header.kind == detail::NPYKind<eT>() &&
+      header.elemSize == sizeof(eT) &&
+      (size_t) elements % std::alignment_of<eT>::value == 0)
+  {
+    // The alias is not strict, so that the matrix can still be moved, swapped
+    // and resized.
+    matrix = arma::Mat<eT>((eT*) elements, rows, cols, false, false);
+    return true;
+  }
+
+  arma::Mat<eT> result;
+  if (needsTranspose)
+    result.set_size(cols, rows);
+  else
+    result.set_size(rows, cols);
+
+  if (header.kind == detail::NPYKind<eT>() && header.elemSize == sizeof(eT))
+    std::memcpy(result.memptr(), elements, result.n_elem * sizeof(eT));
+  else
+    detail::ConvertNPYElements(header, elements, result.memptr(),
+        result.n_elem);
+
+  if (needsTranspose)
+    matrix = arma::trans(result);
+  else
+    matrix = std::move(result);
+
+  return false;
+}
+
+template<typename eT>
+void SaveNPY(const std::string& filename,
+             const arma::Mat<eT>& matrix,
+             const bool transpose)
+{
+  std::ofstream stream(filename.c_str(), std::ios::binary);
+  if (!stream.is_open())
+    throw std::runtime_error("cannot open file '" + filename + "' for "
+        "writing");
+
+  // A d x n column-major matrix has the memory of an n x d array in C order,
+  // so neither case needs a copy.
+  NPYHeader header;
+  header.kind = detail::NPYKind<eT>();
+  header.elemSize = sizeof(eT);
+  header.fortranOrder = !transpose;
+  header.rows = transpose ? matrix.n_cols : matrix.n_rows;
+  header.cols = transpose ? matrix.n_rows : matrix.n_cols;
+
+  WriteNPYHeader(stream, header);
+  stream.write((const char*) matrix.memptr(), matrix.n_elem * sizeof(eT));
+
+  if (!stream.good())
+    throw std::runtime_error("error writing to file '" + filename + "'");
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
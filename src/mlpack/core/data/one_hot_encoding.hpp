@@ -14,6 +14,7 @@
 #define MLPACK_CORE_DATA_ONE_HOT_ENCODING_HPP
 
 #include <mlpack/prereqs.hpp>
+#include "dataset_mapper.hpp"
 
 namespace mlpack {
 namespace data {
@@ -32,6 +33,41 @@ template<typename eT, typename RowType>
 void OneHotEncoding(const RowType& labelsIn,
                     arma::Mat<eT>& output);
 
+/**
+ * Given a set of labels of a particular datatype, convert them to a sparse
+ * one-hot matrix.  The labels are numbered in the order in which they first
+ * appear, as for the dense overload, but unlike the dense overload the output
+ * has one column per label (numClasses x numPoints, the layout every mlpack
+ * method expects), so that each column holds exactly one nonzero and the
+ * matrix is built directly in compressed sparse column form, in one pass.
+ *
+ * @param labelsIn Input labels of arbitrary datatype.
+ * @param output Sparse binary matrix.
+ */
+template<typename eT, typename RowType>
+void OneHotEncoding(const RowType& labelsIn,
+                    arma::SpMat<eT>& output);
+
+/**
+ * One-hot encode every categorical dimension of the given dataset into one
+ * sparse design matrix.  Each numeric dimension of the input becomes one row
+ * of the output, holding the same values; each categorical dimension with k
+ * mappings (as given by info.NumMappings()) becomes k rows, with a 1 in the
+ * row of the mapped value of each point.  The dimensions keep their order.
+ * The output is built column by column in compressed sparse column form.
+ *
+ * If a categorical value is not an integer in [0, k), std::invalid_argument
+ * is thrown.
+ *
+ * @param input Dataset to encode, with one point per column.
+ * @param info Types and mappings of the dimensions of the dataset.
+ * @param output Sparse matrix to store the encoded dataset in.
+ */
+template<typename eT, typename PolicyType>
+void OneHotEncoding(const arma::Mat<eT>& input,
+                    const DatasetMapper<PolicyType>& info,
+                    arma::SpMat<eT>& output);
+
 } // namespace data
 } // namespace mlpack
 
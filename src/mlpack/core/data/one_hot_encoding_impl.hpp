@@ -64,6 +64,105 @@ void OneHotEncoding(const RowType& labelsIn,
   }
   labelMap.clear();
 }
+
+template<typename eT, typename RowType>
+void OneHotEncoding(const RowType& labelsIn,
+                    arma::SpMat<eT>& output)
+{
+  // Row indices are the labels of the points, and every column holds one
+  // entry.
+  arma::uvec rowIndices(labelsIn.n_elem);
+  arma::uvec colPointers(labelsIn.n_elem + 1);
+  colPointers[0] = 0;
+
+  std::unordered_map<typename RowType::elem_type, size_t> labelMap;
+  for (size_t i = 0; i < labelsIn.n_elem; ++i)
+  {
+    // The label of the point is the number of distinct labels seen before its
+    // first appearance.
+    const size_t numLabels = labelMap.size();
+    rowIndices[i] = labelMap.insert(std::make_pair(labelsIn[i],
+        numLabels)).first->second;
+    colPointers[i + 1] = i + 1;
+  }
+
+  // All entries are '1'.
+  arma::Col<eT> values(labelsIn.n_elem);
+  values.ones();
+
+  output = arma::SpMat<eT>(rowIndices, colPointers, values, labelMap.size(),
+      labelsIn.n_elem);
+}
+
+template<typename eT, typename PolicyType>
+void OneHotEncoding(const arma::Mat<eT>& input,
+                    const DatasetMapper<PolicyType>& info,
+                    arma::SpMat<eT>& output)
+{
+  if (info.Dimensionality() != input.n_rows)
+  {
+    std::ostringstream oss;
+    oss << "OneHotEncoding(): dataset has " << input.n_rows << " dimensions, "
+        << "but the DatasetMapper has " << info.Dimensionality();
+    throw std::invalid_argument(oss.str());
+  }
+
+  // The first output row of each dimension, and the number of rows of each
+  // categorical dimension (0 for numeric dimensions).
+  std::vector<size_t> firstRow(input.n_rows);
+  std::vector<size_t> numRows(input.n_rows, 0);
+  size_t outputRows = 0;
+  for (size_t d = 0; d < input.n_rows; ++d)
+  {
+    firstRow[d] = outputRows;
+    if (info.Type(d) == Datatype::categorical)
+      numRows[d] = info.NumMappings(d);
+    outputRows += (info.Type(d) == Datatype::categorical) ? numRows[d] : 1;
+  }
+
+  // Every point has at most one entry per input dimension, and the entries of
+  // each column are added in increasing row order.
+  std::vector<arma::uword> rowIndices;
+  std::vector<eT> values;
+  rowIndices.reserve(input.n_elem);
+  values.reserve(input.n_elem);
+  arma::uvec colPointers(input.n_cols + 1);
+  colPointers[0] = 0;
+  for (size_t i = 0; i < input.n_cols; ++i)
+  {
+    for (size_t d = 0; d < input.n_rows; ++d)
+    {
+      const eT value = input(d, i);
+      if (info.Type(d) == Datatype::categorical)
+      {
+        const double category = (double) value;
+        if (!(category >= 0.0) || category >= (double) numRows[d] ||
+            std::floor(category) != category)
+        {
+          std::ostringstream oss;
+          oss << "OneHotEncoding(): value " << value << " of point " << i
+              << " is not a valid category of dimension " << d << " (which "
+              << "has " << numRows[d] << " categories)";
+          throw std::invalid_argument(oss.str());
+        }
+
+        rowIndices.push_back(firstRow[d] + (size_t) category);
+        values.push_back(eT(1));
+      }
+      else if (value != eT(0))
+      {
+        rowIndices.push_back(firstRow[d]);
+        values.push_back(value);
+      }
+    }
+
+    colPointers[i + 1] = rowIndices.size();
+  }
+
+  output = arma::SpMat<eT>(arma::uvec(rowIndices), colPointers,
+      arma::Col<eT>(values), outputRows, input.n_cols);
+}
+
 } // namespace data
 } // namespace mlpack
 
@@ -0,0 +1,298 @@
+/**
+ * @file parse_number.hpp
+ *
+ * Conversion of strings to numbers that gives the same results as reading the
+ * number with a std::stringstream, but without the cost of a stream for the
+ * common cases.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_PARSE_NUMBER_HPP
+#define MLPACK_CORE_DATA_PARSE_NUMBER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * Read a number of type T from the given input with a std::stringstream.
+ *
+ * @param input Input to read.
+ * @param value Variable to store the number in.
+ * @return true if the whole input was read as a number.
+ */
+template<typename T, typename InputType>
+inline bool ParseNumberStream(const InputType& input, T& value)
+{
+  std::stringstream token;
+  token << input;
+  token >> value;
+
+  return !token.fail() && token.eof();
+}
+
+namespace detail {
+
+//! Whether ParseNumber() has a fast path for the type T.  The fast path for
+//! floating-point types needs exactly representable powers of ten, and
+//! character and boolean types are read differently by streams.
+template<typename T>
+struct HasFastParse
+{
+  static const bool value = std::is_same<T, float>::value ||
+      std::is_same<T, double>::value ||
+      (std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+      sizeof(T) > 1);
+};
+
+//! Limits of the exact fast path for floating-point types: the mantissa and
+//! the power of ten must both be exactly representable.
+template<typename T> struct FloatLimits;
+
+template<>
+struct FloatLimits<double>
+{
+  static const uint64_t maxMantissa = (uint64_t(1) << 53);
+  static const int maxExponent = 22;
+};
+
+template<>
+struct FloatLimits<float>
+{
+  static const uint64_t maxMantissa = (uint64_t(1) << 24);
+  static const int maxExponent = 10;
+};
+
+//! Exact powers of ten.
+template<typename T>
+inline T PowerOfTen(const int exponent)
+{
+  static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+      1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19,
+      1e20, 1e21, 1e22 };
+  return T(powers[exponent]);
+}
+
+/**
+ * Fast path for floating-point types.  Decimal numbers with at most 19
+ * significant digits whose mantissa and power of ten are exactly
+ * representable are converted with one correctly rounded multiplication or
+ * division, which is what strtod() (and so a stream) gives.  Everything else
+ * that could be a number is read with a stream.
+ */
+template<typename T>
+inline bool ParseNumberFast(
+    const char* begin,
+    const char* end,
+    T& value,
+    const typename std::enable_if<std::is_floating_point<T>::value>::type* = 0)
+{
+  const char* p = begin;
+  bool negative = false;
+  if (p != end && (*p == '+' || *p == '-'))
+  {
+    negative = (*p == '-');
+    ++p;
+  }
+
+  uint64_t mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  bool anyDigits = false;
+  for (; p != end && *p >= '0' && *p <= '9'; ++p)
+  {
+    anyDigits = true;
+    if (mantissa == 0 && *p == '0')
+      continue;
+    if (digits == 19)
+      return ParseNumberStream(std::string(begin, end), value);
+    mantissa = 10 * mantissa + (*p - '0');
+    ++digits;
+  }
+
+  if (p != end && *p == '.')
+  {
+    for (++p; p != end && *p >= '0' && *p <= '9'; ++p)
+    {
+      anyDigits = true;
+      --exponent;
+      if (mantissa == 0 && *p == '0')
+        continue;
+      if (digits == 19)
+        return ParseNumberStream(std::string(begin, end), value);
+      mantissa = 10 * mantissa + (*p - '0');
+      ++digits;
+    }
+  }
+
+  // A stream needs at least one digit in the mantissa.
+  if (!anyDigits)
+    return false;
+
+  if (p != end && (*p == 'e' || *p == 'E'))
+  {
+    ++p;
+    bool negativeExponent = false;
+    if (p != end && (*p == '+' || *p == '-'))
+    {
+      negativeExponent = (*p == '-');
+      ++p;
+    }
+
+    if (p == end || *p < '0' || *p > '9')
+      return false;
+
+    int e = 0;
+    for (; p != end && *p >= '0' && *p <= '9'; ++p)
+    {
+      if (e > 100000)
+        return ParseNumberStream(std::string(begin, end), value);
+      e = 10 * e + (*p - '0');
+    }
+    exponent += negativeExponent ? -e : e;
+  }
+
+  // Anything left means that this is not a number.
+  if (p != end)
+    return false;
+
+  if (mantissa == 0)
+  {
+    value = negative ? -T(0) : T(0);
+    return true;
+  }
+
+  if (mantissa > FloatLimits<T>::maxMantissa ||
+      exponent > FloatLimits<T>::maxExponent ||
+      exponent < -FloatLimits<T>::maxExponent)
+    return ParseNumberStream(std::string(begin, end), value);
+
+  value = T(mantissa);
+  if (exponent < 0)
+    value /= PowerOfTen<T>(-exponent);
+  else
+    value *= PowerOfTen<T>(exponent);
+  if (negative)
+    value = -value;
+
+  return true;
+}
+
+/**
+ * Fast path for integral types.  Decimal numbers in the range of T are
+ * converted directly; everything else that could be a number (negative numbers
+ * for unsigned types, which streams wrap around, and numbers out of range) is
+ * read with a stream.
+ */
+template<typename T>
+inline bool ParseNumberFast(
+    const char* begin,
+    const char* end,
+    T& value,
+    const typename std::enable_if<std::is_integral<T>::value>::type* = 0)
+{
+  const char* p = begin;
+  bool negative = false;
+  if (p != end && (*p == '+' || *p == '-'))
+  {
+    negative = (*p == '-');
+    ++p;
+  }
+
+  if (p == end)
+    return false;
+
+  uint64_t magnitude = 0;
+  int digits = 0;
+  for (; p != end; ++p)
+  {
+    if (*p < '0' || *p > '9')
+      return false;
+    if (magnitude != 0 || *p != '0')
+      ++digits;
+    magnitude = 10 * magnitude + (*p - '0');
+    if (digits == 19)
+      return ParseNumberStream(std::string(begin, end), value);
+  }
+
+  if (negative && magnitude != 0)
+  {
+    if (!std::is_signed<T>::value || magnitude >
+        uint64_t(-(std::numeric_limits<T>::min() + 1)) + 1)
+      return ParseNumberStream(std::string(begin, end), value);
+
+    value = T(-int64_t(magnitude));
+  }
+  else
+  {
+    if (magnitude > uint64_t(std::numeric_limits<T>::max()))
+      return ParseNumberStream(std::string(begin, end), value);
+
+    value = T(magnitude);
+  }
+
+  return true;
+}
+
+} // namespace detail
+
+/**
+ * Read a number of type T from the characters in [begin, end).  The result is
+ * the same as reading the number with a std::stringstream (see
+ * ParseNumberStream()): the whole input must be a number, and no whitespace is
+ * allowed after it.  Plain decimal numbers (by far the most common case in
+ * datasets) are converted without a stream.
+ *
+ * @param begin Pointer to the first character of the input.
+ * @param end Pointer past the last character of the input.
+ * @param value Variable to store the number in.
+ * @return true if the whole input was read as a number.
+ */
+template<typename T>
+inline bool ParseNumber(
+    const char* begin,
+    const char* end,
+    T& value,
+    const typename std::enable_if<detail::HasFastParse<T>::value>::type* = 0)
+{
+  // Streams skip leading whitespace.
+  if (begin != end && std::isspace((unsigned char) *begin))
+    return ParseNumberStream(std::string(begin, end), value);
+
+  return detail::ParseNumberFast(begin, end, value);
+}
+
+template<typename T>
+inline bool ParseNumber(
+    const char* begin,
+    const char* end,
+    T& value,
+    const typename std::enable_if<!detail::HasFastParse<T>::value>::type* = 0)
+{
+  return ParseNumberStream(std::string(begin, end), value);
+}
+
+/**
+ * Read a number of type T from the given input; see ParseNumber(begin, end,
+ * value).  Inputs that are not strings are read with a stream.
+ */
+template<typename T, typename InputType>
+inline bool ParseNumber(const InputType& input, T& value)
+{
+  return ParseNumberStream(input, value);
+}
+
+template<typename T>
+inline bool ParseNumber(const std::string& input, T& value)
+{
+  return ParseNumber(input.data(), input.data() + input.size(), value);
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,546 @@
+/**
+ * @file portable_binary_archive.cpp
+ *
+ * Implementation of the portable binary archives and of the stream buffers
+ * they use.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "portable_binary_archive.hpp"
+
+#include <boost/archive/archive_exception.hpp>
+#include <boost/archive/basic_archive.hpp>
+
+#ifdef HAS_ZLIB
+  #include <zlib.h>
+#endif
+
+namespace mlpack {
+namespace data {
+namespace detail {
+
+//! The first bytes of every portable binary file.
+static const char magic[8] = { 'M', 'L', 'P', 'A', 'C', 'K', 'P', 'B' };
+//! The version of the portable binary file layout.
+static const unsigned char fileVersion = 1;
+//! The flag of the header for compressed archives.
+static const unsigned char compressedFlag = 1;
+//! The size of the buffers of the stream buffers.
+static const size_t bufferSize = (1 << 16);
+
+//! Compute the table of the CRC-32 checksum (the one of zlib and PNG).
+static std::vector<uint32_t> MakeCRCTable()
+{
+  std::vector<uint32_t> table(256);
+  for (uint32_t i = 0; i < 256; ++i)
+  {
+    uint32_t c = i;
+    for (size_t k = 0; k < 8; ++k)
+      c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+    table[i] = c;
+  }
+
+  return table;
+}
+
+//! Update the given CRC-32 checksum with the given bytes.
+static uint32_t UpdateCRC(uint32_t crc, const char* s, const size_t n)
+{
+  static const std::vector<uint32_t> table = MakeCRCTable();
+  crc = ~crc;
+  for (size_t i = 0; i < n; ++i)
+    crc = table[(crc ^ (unsigned char) s[i]) & 0xFF] ^ (crc >> 8);
+
+  return ~crc;
+}
+
+//! Write the given integer in little-endian order.
+static void PutLittleEndian(uint64_t value, char* bytes, const size_t n)
+{
+  for (size_t b = 0; b < n; ++b, value >>= 8)
+    bytes[b] = (char) (value & 0xFF);
+}
+
+//! Read a little-endian integer.
+static uint64_t GetLittleEndian(const char* bytes, const size_t n)
+{
+  uint64_t value = 0;
+  for (size_t b = n; b > 0; --b)
+    value = (value << 8) | (unsigned char) bytes[b - 1];
+
+  return value;
+}
+
+PortableBinaryOutBuf::PortableBinaryOutBuf(std::streambuf& sink,
+                                           const bool compress) :
+    sink(sink),
+    buffer(bufferSize),
+    zstream(NULL),
+    crc(0),
+    size(0),
+    finished(false)
+{
+  if (compress)
+  {
+    #ifdef HAS_ZLIB
+    zstream = new z_stream();
+    if (deflateInit(zstream, Z_DEFAULT_COMPRESSION) != Z_OK)
+    {
+      delete zstream;
+      zstream = NULL;
+      throw std::runtime_error("cannot initialize zlib");
+    }
+    compressed.resize(bufferSize);
+    #else
+    throw std::runtime_error("cannot compress the archive: mlpack was not "
+        "compiled with zlib");
+    #endif
+  }
+
+  char header[12];
+  std::memcpy(header, magic, 8);
+  header[8] = (char) fileVersion;
+  header[9] = (char) (compress ? compressedFlag : 0);
+  header[10] = header[11] = 0;
+  WriteRaw(header, 12);
+
+  setp(buffer.data(), buffer.data() + buffer.size());
+}
+
+PortableBinaryOutBuf::~PortableBinaryOutBuf()
+{
+  // Errors can't be reported here; Finish() should be called to see them.
+  if (!finished)
+  {
+    try
+    {
+      Finish();
+    }
+    catch (std::exception& /* e */) { }
+  }
+
+  #ifdef HAS_ZLIB
+  if (zstream)
+  {
+    deflateEnd(zstream);
+    delete zstream;
+  }
+  #endif
+}
+
+void PortableBinaryOutBuf::Finish()
+{
+  if (finished)
+    return;
+  finished = true;
+
+  Write(pbase(), pptr() - pbase());
+  setp(NULL, NULL);
+  if (zstream)
+    Deflate(NULL, 0, true);
+
+  char trailer[12];
+  PutLittleEndian(size, trailer, 8);
+  PutLittleEndian(crc, trailer + 8, 4);
+  WriteRaw(trailer, 12);
+  if (sink.pubsync() != 0)
+    throw std::runtime_error("error writing archive");
+}
+
+PortableBinaryOutBuf::int_type PortableBinaryOutBuf::overflow(int_type c)
+{
+  if (finished)
+    return traits_type::eof();
+
+  Write(pbase(), pptr() - pbase());
+  setp(buffer.data(), buffer.data() + buffer.size());
+  if (!traits_type::eq_int_type(c, traits_type::eof()))
+  {
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
+  }
+
+  return traits_type::not_eof(c);
+}
+
+std::streamsize PortableBinaryOutBuf::xsputn(const char* s, std::streamsize n)
+{
+  if (finished)
+    return 0;
+
+  // Small writes are buffered; large ones are written directly.
+  if (n <= epptr() - pptr())
+  {
+    std::memcpy(pptr(), s, n);
+    pbump((int) n);
+    return n;
+  }
+
+  Write(pbase(), pptr() - pbase());
+  setp(buffer.data(), buffer.data() + buffer.size());
+  Write(s, n);
+  return n;
+}
+
+int PortableBinaryOutBuf::sync()
+{
+  // The archive is only flushed by Finish(), so that compression isn't
+  // interrupted.
+  return 0;
+}
+
+void PortableBinaryOutBuf::Write(const char* s, const size_t n)
+{
+  if (n == 0)
+    return;
+
+  crc = UpdateCRC(crc, s, n);
+  size += n;
+  if (zstream)
+    Deflate(s, n, false);
+  else
+    WriteRaw(s, n);
+}
+
+void PortableBinaryOutBuf::WriteRaw(const char* s, const size_t n)
+{
+  if (sink.sputn(s, n) != (std::streamsize) n)
+    throw std::runtime_error("error writing archive");
+}
+
+void PortableBinaryOutBuf::Deflate(const char* s,
+                                   const size_t n,
+                                   const bool finish)
+{
+  #ifdef HAS_ZLIB
+  // zlib takes at most 4GB at once.
+  size_t done = 0;
+  do
+  {
+    const size_t chunk = std::min(n - done, (size_t) (1u << 30));
+    zstream->next_in = (Bytef*) (s + done);
+    zstream->avail_in = (uInt) chunk;
+    done += chunk;
+    const int flush = (finish && done == n) ? Z_FINISH : Z_NO_FLUSH;
+
+    int result;
+    do
+    {
+      zstream->next_out = (Bytef*) compressed.data();
+      zstream->avail_out = (uInt) compressed.size();
+      result = deflate(zstream, flush);
+      if (result == Z_STREAM_ERROR)
+        throw std::runtime_error("error compressing archive");
+      WriteRaw(compressed.data(), compressed.size() - zstream->avail_out);
+    } while (zstream->avail_out == 0 ||
+        (flush == Z_FINISH && result != Z_STREAM_END));
+  } while (done < n);
+  #else
+  // This can't happen: the constructor throws.
+  (void) s;
+  (void) n;
+  (void) finish;
+  #endif
+}
+
+PortableBinaryInBuf::PortableBinaryInBuf(std::streambuf& source) :
+    source(source),
+    buffer(bufferSize),
+    zstream(NULL),
+    streamEnd(false),
+    crc(0),
+    size(0)
+{
+  char header[12];
+  if (source.sgetn(header, 12) != 12 || std::memcmp(header, magic, 8) != 0)
+    throw std::runtime_error("not a portable binary archive");
+  if ((unsigned char) header[8] > fileVersion)
+    throw std::runtime_error("portable binary archive was written by a newer "
+        "version of mlpack");
+
+  if ((unsigned char) header[9] & compressedFlag)
+  {
+    #ifdef HAS_ZLIB
+    zstream = new z_stream();
+    if (inflateInit(zstream) != Z_OK)
+    {
+      delete zstream;
+      zstream = NULL;
+      throw std::runtime_error("cannot initialize zlib");
+    }
+    compressed.resize(bufferSize);
+    #else
+    throw std::runtime_error("cannot load compressed archive: mlpack was not "
+        "compiled with zlib");
+    #endif
+  }
+
+  setg(buffer.data(), buffer.data(), buffer.data());
+}
+
+PortableBinaryInBuf::~PortableBinaryInBuf()
+{
+  #ifdef HAS_ZLIB
+  if (zstream)
+  {
+    inflateEnd(zstream);
+    delete zstream;
+  }
+  #endif
+}
+
+void PortableBinaryInBuf::Finish()
+{
+  Consume();
+
+  // Anything left in the buffer of an uncompressed archive was read past the
+  // end of the archive, so it is the start of the trailer.  A compressed
+  // archive must have been decompressed completely, and what is left of the
+  // compressed data is the start of the trailer.
+  std::string rest(gptr(), egptr());
+  setg(buffer.data(), buffer.data(), buffer.data());
+  #ifdef HAS_ZLIB
+  if (zstream)
+  {
+    char extra;
+    if (!rest.empty() || Read(&extra, 1) != 0)
+      throw std::runtime_error("portable binary archive has unexpected data");
+    rest.assign((const char*) zstream->next_in, zstream->avail_in);
+  }
+  #endif
+
+  // Read one byte more than the trailer, to detect extra data.
+  char trailer[13];
+  size_t trailerSize = std::min(rest.size(), (size_t) 13);
+  std::memcpy(trailer, rest.data(), trailerSize);
+  if (trailerSize < 13)
+  {
+    const std::streamsize read = source.sgetn(trailer + trailerSize,
+        13 - trailerSize);
+    trailerSize += (read > 0) ? (size_t) read : 0;
+  }
+
+  if (trailerSize < 12)
+    throw std::runtime_error("portable binary archive is truncated");
+  if (trailerSize > 12)
+    throw std::runtime_error("portable binary archive has unexpected data");
+  if (GetLittleEndian(trailer, 8) != size ||
+      GetLittleEndian(trailer + 8, 4) != crc)
+    throw std::runtime_error("portable binary archive is corrupt (checksum "
+        "mismatch)");
+}
+
+PortableBinaryInBuf::int_type PortableBinaryInBuf::underflow()
+{
+  Consume();
+  const size_t n = Read(buffer.data(), buffer.size());
+  setg(buffer.data(), buffer.data(), buffer.data() + n);
+  if (n == 0)
+    return traits_type::eof();
+
+  return traits_type::to_int_type(*gptr());
+}
+
+std::streamsize PortableBinaryInBuf::xsgetn(char* s, std::streamsize n)
+{
+  // Use what is buffered first; large reads then go directly into s.
+  std::streamsize done = std::min(n, (std::streamsize) (egptr() - gptr()));
+  std::memcpy(s, gptr(), done);
+  gbump((int) done);
+  if (done == n)
+    return n;
+
+  Consume();
+  setg(buffer.data(), buffer.data(), buffer.data());
+  if (n - done >= (std::streamsize) buffer.size())
+  {
+    while (done < n)
+    {
+      const size_t read = Read(s + done, n - done);
+      if (read == 0)
+        break;
+      crc = UpdateCRC(crc, s + done, read);
+      size += read;
+      done += read;
+    }
+
+    return done;
+  }
+
+  while (done < n && !traits_type::eq_int_type(underflow(), traits_type::eof()))
+  {
+    const std::streamsize chunk = std::min(n - done,
+        (std::streamsize) (egptr() - gptr()));
+    std::memcpy(s + done, gptr(), chunk);
+    gbump((int) chunk);
+    done += chunk;
+  }
+
+  return done;
+}
+
+size_t PortableBinaryInBuf::Read(char* s, const size_t n)
+{
+  if (!zstream)
+  {
+    const std::streamsize read = source.sgetn(s, n);
+    return (read > 0) ? (size_t) read : 0;
+  }
+
+  #ifdef HAS_ZLIB
+  if (streamEnd)
+    return 0;
+
+  zstream->next_out = (Bytef*) s;
+  zstream->avail_out = (uInt) std::min(n, (size_t) (1u << 30));
+  const uInt requested = zstream->avail_out;
+  while (zstream->avail_out == requested)
+  {
+    if (zstream->avail_in == 0)
+    {
+      const std::streamsize read = source.sgetn(compressed.data(),
+          compressed.size());
+      if (read <= 0)
+        throw std::runtime_error("portable binary archive is truncated");
+      zstream->next_in = (Bytef*) compressed.data();
+      zstream->avail_in = (uInt) read;
+    }
+
+    const int result = inflate(zstream, Z_NO_FLUSH);
+    if (result == Z_STREAM_END)
+    {
+      streamEnd = true;
+      break;
+    }
+    else if (result != Z_OK)
+    {
+      throw std::runtime_error("portable binary archive is corrupt (cannot "
+          "decompress)");
+    }
+  }
+
+  return requested - zstream->avail_out;
+  #else
+  return 0;
+  #endif
+}
+
+void PortableBinaryInBuf::Consume()
+{
+  crc = UpdateCRC(crc, eback(), gptr() - eback());
+  size += gptr() - eback();
+  setg(gptr(), gptr(), egptr());
+}
+
+} // namespace detail
+
+PortableBinaryOArchive::PortableBinaryOArchive(std::ostream& os,
+                                               const bool compress) :
+    BufHolderType(*os.rdbuf(), compress),
+    PrimitiveBaseType(buf, true),
+    ArchiveBaseType(0)
+{
+  // Like boost's binary archives, start with the signature and the version of
+  // the serialization library.
+  const std::string signature(boost::archive::BOOST_ARCHIVE_SIGNATURE());
+  *this << signature;
+  const boost::archive::library_version_type version(
+      boost::archive::BOOST_ARCHIVE_VERSION());
+  *this << version;
+}
+
+void PortableBinaryOArchive::SaveMagnitude(const bool negative,
+                                           uintmax_t magnitude)
+{
+  char bytes[sizeof(uintmax_t) + 1];
+  signed char n = 0;
+  for (; magnitude != 0; magnitude >>= 8)
+    bytes[++n] = (char) (magnitude & 0xFF);
+  bytes[0] = (char) (negative ? -n : n);
+  this->save_binary(bytes, n + 1);
+}
+
+PortableBinaryIArchive::PortableBinaryIArchive(std::istream& is) :
+    BufHolderType(*is.rdbuf()),
+    PrimitiveBaseType(buf, true),
+    ArchiveBaseType(0)
+{
+  std::string signature;
+  *this >> signature;
+  if (signature != boost::archive::BOOST_ARCHIVE_SIGNATURE())
+  {
+    boost::serialization::throw_exception(boost::archive::archive_exception(
+        boost::archive::archive_exception::invalid_signature));
+  }
+
+  boost::archive::library_version_type version;
+  *this >> version;
+  if (boost::archive::BOOST_ARCHIVE_VERSION() < version)
+  {
+    boost::serialization::throw_exception(boost::archive::archive_exception(
+        boost::archive::archive_exception::unsupported_version));
+  }
+  this->set_library_version(version);
+}
+
+void PortableBinaryIArchive::load_override(
+    boost::archive::class_name_type& t)
+{
+  std::string name;
+  name.reserve(BOOST_SERIALIZATION_MAX_KEY_SIZE);
+  load_override(name);
+  if (name.size() > (BOOST_SERIALIZATION_MAX_KEY_SIZE - 1))
+  {
+    boost::serialization::throw_exception(boost::archive::archive_exception(
+        boost::archive::archive_exception::invalid_class_name));
+  }
+  std::memcpy(t, name.data(), name.size());
+  t.t[name.size()] = '\0';
+}
+
+uintmax_t PortableBinaryIArchive::LoadMagnitude(bool& negative)
+{
+  signed char n;
+  this->load_binary(&n, 1);
+  negative = (n < 0);
+  if (negative)
+    n = -n;
+  if (n > (signed char) sizeof(uintmax_t))
+  {
+    boost::serialization::throw_exception(boost::archive::archive_exception(
+        boost::archive::archive_exception::incompatible_native_format));
+  }
+
+  char bytes[sizeof(uintmax_t)];
+  this->load_binary(bytes, n);
+  return detail::GetLittleEndian(bytes, n);
+}
+
+} // namespace data
+} // namespace mlpack
+
+// The archives are not header-only, so the parts of boost::serialization that
+// they use are instantiated here, once.
+#include <boost/archive/impl/archive_serializer_map.ipp>
+#include <boost/archive/impl/basic_binary_iprimitive.ipp>
+#include <boost/archive/impl/basic_binary_oprimitive.ipp>
+
+namespace boost {
+namespace archive {
+namespace detail {
+
+template class archive_serializer_map<mlpack::data::PortableBinaryOArchive>;
+template class archive_serializer_map<mlpack::data::PortableBinaryIArchive>;
+
+} // namespace detail
+
+template class basic_binary_oprimitive<mlpack::data::PortableBinaryOArchive,
+    std::ostream::char_type, std::ostream::traits_type>;
+template class basic_binary_iprimitive<mlpack::data::PortableBinaryIArchive,
+    std::istream::char_type, std::istream::traits_type>;
+
+} // namespace archive
+} // namespace boost
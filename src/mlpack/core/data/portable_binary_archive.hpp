@@ -0,0 +1,522 @@
+/**
+ * @file portable_binary_archive.hpp
+ *
+ * A portable binary archive for boost::serialization, which is what
+ * data::Save() and data::Load() use for models saved with
+ * format::portable_binary.  The archive is checksummed, and may be compressed.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_PORTABLE_BINARY_ARCHIVE_HPP
+#define MLPACK_CORE_DATA_PORTABLE_BINARY_ARCHIVE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <boost/archive/basic_binary_iprimitive.hpp>
+#include <boost/archive/basic_binary_oprimitive.hpp>
+#include <boost/archive/detail/common_iarchive.hpp>
+#include <boost/archive/detail/common_oarchive.hpp>
+#include <boost/archive/detail/register_archive.hpp>
+#include <boost/serialization/array_wrapper.hpp>
+#include <boost/serialization/item_version_type.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/type_traits/is_arithmetic.hpp>
+
+#include <cstring>
+
+// Defined by zlib, if it is available.
+struct z_stream_s;
+
+namespace mlpack {
+namespace data {
+
+namespace detail {
+
+//! Whether the bytes of numbers on this machine are in little-endian order,
+//! which is the order of the portable binary format.
+inline bool IsLittleEndian()
+{
+  const uint16_t one = 1;
+  unsigned char first;
+  std::memcpy(&first, &one, 1);
+  return (first == 1);
+}
+
+/**
+ * The stream buffer that the portable binary output archive writes through.
+ * It writes the header of the file, computes a CRC-32 checksum of everything
+ * written, optionally compresses it with zlib, and writes the size and the
+ * checksum at the end of the file when Finish() is called.  Large writes (like
+ * the memory of a matrix) go straight to the file (or to zlib) without being
+ * copied.
+ */
+class PortableBinaryOutBuf : public std::streambuf
+{
+ public:
+  /**
+   * Write the header of the file to the given stream buffer.
+   * std::runtime_error is thrown if compression is requested but mlpack was
+   * compiled without zlib.
+   *
+   * @param sink Stream buffer of the file.
+   * @param compress Whether to compress the archive with zlib.
+   */
+  PortableBinaryOutBuf(std::streambuf& sink, const bool compress);
+
+  //! Finish the file, if Finish() has not been called (errors are ignored).
+  ~PortableBinaryOutBuf();
+
+  /**
+   * Flush everything, then write the size and the checksum of the archive.
+   * Nothing can be written after this.  std::runtime_error is thrown if
+   * writing fails.
+   */
+  void Finish();
+
+ protected:
+  int_type overflow(int_type c) override;
+  std::streamsize xsputn(const char* s, std::streamsize n) override;
+  int sync() override;
+
+ private:
+  //! Checksum, count and write (or compress) the given bytes.
+  void Write(const char* s, const size_t n);
+  //! Write the given bytes to the file, or throw.
+  void WriteRaw(const char* s, const size_t n);
+  //! Give the given bytes to zlib (flush at the end of the file).
+  void Deflate(const char* s, const size_t n, const bool finish);
+
+  //! The stream buffer of the file.
+  std::streambuf& sink;
+  //! The buffer for small writes.
+  std::vector<char> buffer;
+  //! The buffer for compressed data.
+  std::vector<char> compressed;
+  //! The state of zlib, if the archive is compressed (otherwise NULL).
+  z_stream_s* zstream;
+  //! The CRC-32 checksum of the archive so far.
+  uint32_t crc;
+  //! The number of bytes of the archive so far.
+  uint64_t size;
+  //! Whether Finish() has been called.
+  bool finished;
+};
+
+/**
+ * The stream buffer that the portable binary input archive reads through.  It
+ * checks the header of the file, decompresses the archive if it is compressed,
+ * and computes the checksum of everything read, which is checked against the
+ * checksum at the end of the file by Finish().
+ */
+class PortableBinaryInBuf : public std::streambuf
+{
+ public:
+  /**
+   * Read and check the header of the file.  std::runtime_error is thrown if
+   * the file is not a portable binary archive, or if it is compressed but
+   * mlpack was compiled without zlib.
+   *
+   * @param source Stream buffer of the file.
+   */
+  PortableBinaryInBuf(std::streambuf& source);
+
+  //! Release the state of zlib.
+  ~PortableBinaryInBuf();
+
+  /**
+   * Check that the archive has been read completely and that its checksum
+   * is right; std::runtime_error is thrown otherwise.
+   */
+  void Finish();
+
+ protected:
+  int_type underflow() override;
+  std::streamsize xsgetn(char* s, std::streamsize n) override;
+
+ private:
+  //! Read (and decompress) up to n bytes of the archive; returns the number
+  //! of bytes read, which is 0 only at the end of the archive.
+  size_t Read(char* s, const size_t n);
+  //! Checksum and count the bytes of the buffer that have been consumed.
+  void Consume();
+
+  //! The stream buffer of the file.
+  std::streambuf& source;
+  //! The buffer for small reads.
+  std::vector<char> buffer;
+  //! The buffer for compressed data.
+  std::vector<char> compressed;
+  //! The state of zlib, if the archive is compressed (otherwise NULL).
+  z_stream_s* zstream;
+  //! Whether the end of the compressed data has been reached.
+  bool streamEnd;
+  //! The CRC-32 checksum of the archive so far.
+  uint32_t crc;
+  //! The number of bytes of the archive so far.
+  uint64_t size;
+};
+
+//! Hold the stream buffer of an archive, so that it is constructed before the
+//! archive (which needs it) and destroyed after it.
+template<typename BufferType>
+struct PortableBinaryBufHolder
+{
+  template<typename... Args>
+  PortableBinaryBufHolder(Args&&... args) :
+      buf(std::forward<Args>(args)...) { }
+
+  BufferType buf;
+};
+
+} // namespace detail
+
+/**
+ * An output archive for boost::serialization whose files can be read on any
+ * platform, no matter its byte order or the sizes of its integer types.
+ * Integers are written in a variable-length little-endian format, and
+ * floating-point numbers as little-endian IEEE 754 values.  Arrays of numbers
+ * (such as the memory of Armadillo matrices, which serialize themselves with
+ * boost::serialization::make_array()) are written with a single copy on
+ * little-endian machines, so saving large models is bound by I/O.
+ *
+ * The file starts with a header, optionally holds the archive compressed
+ * with zlib (if mlpack was compiled with zlib), and ends with the size and the
+ * CRC-32 checksum of the archive, so that PortableBinaryIArchive detects
+ * truncated and corrupted files.
+ *
+ * @code
+ * std::ofstream ofs("model.pbin", std::ios::binary);
+ * data::PortableBinaryOArchive ar(ofs);
+ * ar << BOOST_SERIALIZATION_NVP(model);
+ * ar.Finish();
+ * @endcode
+ */
+class PortableBinaryOArchive :
+    private detail::PortableBinaryBufHolder<detail::PortableBinaryOutBuf>,
+    public boost::archive::basic_binary_oprimitive<PortableBinaryOArchive,
+        std::ostream::char_type, std::ostream::traits_type>,
+    public boost::archive::detail::common_oarchive<PortableBinaryOArchive>
+{
+  typedef detail::PortableBinaryBufHolder<detail::PortableBinaryOutBuf>
+      BufHolderType;
+  typedef boost::archive::basic_binary_oprimitive<PortableBinaryOArchive,
+      std::ostream::char_type, std::ostream::traits_type> PrimitiveBaseType;
+  typedef boost::archive::detail::common_oarchive<PortableBinaryOArchive>
+      ArchiveBaseType;
+
+  friend ArchiveBaseType;
+  friend PrimitiveBaseType;
+  friend class boost::archive::detail::interface_oarchive<
+      PortableBinaryOArchive>;
+  friend class boost::archive::save_access;
+
+ public:
+  /**
+   * Create the archive on the given stream, which should be opened in binary
+   * mode.  The header of the file is written right away.
+   *
+   * @param os Stream to write the archive to.
+   * @param compress Whether to compress the archive with zlib.
+   */
+  PortableBinaryOArchive(std::ostream& os, const bool compress = false);
+
+  //! Write the end of the file.  Nothing can be saved after this.
+  void Finish() { buf.Finish(); }
+
+  // Only arrays of numbers are written with a single copy.
+  struct use_array_optimization
+  {
+    template<typename T>
+    struct apply : public boost::is_arithmetic<T> { };
+  };
+
+  //! Save an array of numbers; the size of the elements comes first.
+  template<typename ValueType>
+  void save_array(const boost::serialization::array_wrapper<ValueType>& a,
+                  unsigned int /* version */)
+  {
+    const unsigned char elemSize = sizeof(ValueType);
+    PrimitiveBaseType::save(elemSize);
+    if (detail::IsLittleEndian() || sizeof(ValueType) == 1)
+    {
+      this->save_binary(a.address(), a.count() * sizeof(ValueType));
+    }
+    else
+    {
+      for (size_t i = 0; i < a.count(); ++i)
+      {
+        char bytes[sizeof(ValueType)];
+        std::memcpy(bytes, a.address() + i, sizeof(ValueType));
+        std::reverse(bytes, bytes + sizeof(ValueType));
+        this->save_binary(bytes, sizeof(ValueType));
+      }
+    }
+  }
+
+ protected:
+  //! Integers, and the integer types of boost::serialization.
+  template<typename T>
+  void save(const T& t)
+  {
+    SaveInteger(t);
+  }
+
+  void save(const std::string& t) { PrimitiveBaseType::save(t); }
+  #ifndef BOOST_NO_STD_WSTRING
+  void save(const std::wstring& t) { PrimitiveBaseType::save(t); }
+  #endif
+  void save(const float& t) { SaveFloat(t); }
+  void save(const double& t) { SaveFloat(t); }
+  void save(const char& t) { PrimitiveBaseType::save(t); }
+  void save(const unsigned char& t) { PrimitiveBaseType::save(t); }
+  void save(const signed char& t) { PrimitiveBaseType::save(t); }
+
+  // Everything else is handled by boost::serialization.
+  template<typename T>
+  void save_override(T& t)
+  {
+    ArchiveBaseType::save_override(t);
+  }
+
+  // Class names are saved as strings.
+  void save_override(const boost::archive::class_name_type& t)
+  {
+    const std::string s(t);
+    *this << s;
+  }
+
+  // Binary files don't include the optional information.
+  void save_override(const boost::archive::class_id_optional_type& /* t */) { }
+
+ private:
+  //! Save an integer: a signed byte with the number of bytes of its magnitude
+  //! (negative for negative integers), then the bytes, least significant
+  //! first.
+  template<typename T>
+  void SaveInteger(const T& t,
+                   const typename std::enable_if<
+                       std::is_unsigned<T>::value>::type* = 0)
+  {
+    SaveMagnitude(false, (uintmax_t) t);
+  }
+
+  template<typename T>
+  void SaveInteger(const T& t,
+                   const typename std::enable_if<
+                       !std::is_unsigned<T>::value>::type* = 0)
+  {
+    // Types of boost::serialization (like class_id_type) convert to integers.
+    const intmax_t value = t;
+    if (value < 0)
+      SaveMagnitude(true, uintmax_t(0) - (uintmax_t) value);
+    else
+      SaveMagnitude(false, (uintmax_t) value);
+  }
+
+  void SaveMagnitude(const bool negative, uintmax_t magnitude);
+
+  //! Save a floating-point number as little-endian IEEE 754.
+  template<typename T>
+  void SaveFloat(const T& t)
+  {
+    static_assert(std::numeric_limits<T>::is_iec559,
+        "floating-point numbers must be IEEE 754");
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &t, sizeof(T));
+    if (!detail::IsLittleEndian())
+      std::reverse(bytes, bytes + sizeof(T));
+    this->save_binary(bytes, sizeof(T));
+  }
+};
+
+/**
+ * An input archive for boost::serialization that reads files written by
+ * PortableBinaryOArchive, on any platform.  Compressed files are detected
+ * from their header.  Call Finish() after loading to check that the whole
+ * archive was read and that its checksum is right.
+ *
+ * @code
+ * std::ifstream ifs("model.pbin", std::ios::binary);
+ * data::PortableBinaryIArchive ar(ifs);
+ * ar >> BOOST_SERIALIZATION_NVP(model);
+ * ar.Finish();
+ * @endcode
+ */
+class PortableBinaryIArchive :
+    private detail::PortableBinaryBufHolder<detail::PortableBinaryInBuf>,
+    public boost::archive::basic_binary_iprimitive<PortableBinaryIArchive,
+        std::istream::char_type, std::istream::traits_type>,
+    public boost::archive::detail::common_iarchive<PortableBinaryIArchive>
+{
+  typedef detail::PortableBinaryBufHolder<detail::PortableBinaryInBuf>
+      BufHolderType;
+  typedef boost::archive::basic_binary_iprimitive<PortableBinaryIArchive,
+      std::istream::char_type, std::istream::traits_type> PrimitiveBaseType;
+  typedef boost::archive::detail::common_iarchive<PortableBinaryIArchive>
+      ArchiveBaseType;
+
+  friend ArchiveBaseType;
+  friend PrimitiveBaseType;
+  friend class boost::archive::detail::interface_iarchive<
+      PortableBinaryIArchive>;
+  friend class boost::archive::load_access;
+
+ public:
+  /**
+   * Create the archive on the given stream, which should be opened in binary
+   * mode.  The header of the file is read and checked right away.
+   *
+   * @param is Stream to read the archive from.
+   */
+  PortableBinaryIArchive(std::istream& is);
+
+  //! Check that the whole archive was read and that its checksum is right;
+  //! std::runtime_error is thrown otherwise.
+  void Finish() { buf.Finish(); }
+
+  // Only arrays of numbers are read with a single copy.
+  struct use_array_optimization
+  {
+    template<typename T>
+    struct apply : public boost::is_arithmetic<T> { };
+  };
+
+  //! Load an array of numbers.  Integers saved with another size are
+  //! converted.
+  template<typename ValueType>
+  void load_array(boost::serialization::array_wrapper<ValueType>& a,
+                  unsigned int /* version */)
+  {
+    unsigned char elemSize;
+    PrimitiveBaseType::load(elemSize);
+    if (elemSize == sizeof(ValueType))
+    {
+      this->load_binary(a.address(), a.count() * sizeof(ValueType));
+      if (!detail::IsLittleEndian() && sizeof(ValueType) > 1)
+      {
+        char* bytes = (char*) a.address();
+        for (size_t i = 0; i < a.count(); ++i)
+        {
+          std::reverse(bytes + i * sizeof(ValueType),
+              bytes + (i + 1) * sizeof(ValueType));
+        }
+      }
+    }
+    else if (std::is_integral<ValueType>::value &&
+        (elemSize == 1 || elemSize == 2 || elemSize == 4 || elemSize == 8))
+    {
+      for (size_t i = 0; i < a.count(); ++i)
+        a.address()[i] = (ValueType) LoadFixedInteger<ValueType>(elemSize);
+    }
+    else
+    {
+      boost::serialization::throw_exception(boost::archive::archive_exception(
+          boost::archive::archive_exception::incompatible_native_format));
+    }
+  }
+
+ protected:
+  //! Integers, and the integer types of boost::serialization.
+  template<typename T>
+  void load(T& t)
+  {
+    bool negative;
+    const uintmax_t magnitude = LoadMagnitude(negative);
+    if (negative)
+      t = T(-intmax_t(magnitude));
+    else
+      t = T(magnitude);
+  }
+
+  void load(boost::archive::class_id_type& t)
+  {
+    bool negative;
+    const uintmax_t magnitude = LoadMagnitude(negative);
+    t = boost::archive::class_id_type(negative ? -int(magnitude) :
+        int(magnitude));
+  }
+
+  void load(boost::archive::version_type& t)
+  {
+    bool negative;
+    t = boost::archive::version_type((unsigned int) LoadMagnitude(negative));
+  }
+
+  void load(boost::serialization::item_version_type& t)
+  {
+    bool negative;
+    t = boost::serialization::item_version_type(
+        (unsigned int) LoadMagnitude(negative));
+  }
+
+  void load(std::string& t) { PrimitiveBaseType::load(t); }
+  #ifndef BOOST_NO_STD_WSTRING
+  void load(std::wstring& t) { PrimitiveBaseType::load(t); }
+  #endif
+  void load(float& t) { LoadFloat(t); }
+  void load(double& t) { LoadFloat(t); }
+  void load(char& t) { PrimitiveBaseType::load(t); }
+  void load(unsigned char& t) { PrimitiveBaseType::load(t); }
+  void load(signed char& t) { PrimitiveBaseType::load(t); }
+
+  // Everything else is handled by boost::serialization.
+  template<typename T>
+  void load_override(T& t)
+  {
+    ArchiveBaseType::load_override(t);
+  }
+
+  // Class names are loaded as strings.
+  void load_override(boost::archive::class_name_type& t);
+
+  // Binary files don't include the optional information.
+  void load_override(boost::archive::class_id_optional_type& /* t */) { }
+
+ private:
+  //! Load an integer saved by PortableBinaryOArchive::SaveInteger().
+  uintmax_t LoadMagnitude(bool& negative);
+
+  //! Load a little-endian integer of the given size, saved as part of an
+  //! array of integers of type T.
+  template<typename T>
+  T LoadFixedInteger(const size_t elemSize)
+  {
+    unsigned char bytes[8];
+    this->load_binary(bytes, elemSize);
+    uint64_t value = 0;
+    for (size_t b = elemSize; b > 0; --b)
+      value = (value << 8) | bytes[b - 1];
+    // Extend the sign of signed integers.
+    if (std::is_signed<T>::value && elemSize < 8 &&
+        (bytes[elemSize - 1] & 0x80))
+      value |= ~uint64_t(0) << (8 * elemSize);
+    return (T) value;
+  }
+
+  //! Load a floating-point number saved as little-endian IEEE 754.
+  template<typename T>
+  void LoadFloat(T& t)
+  {
+    char bytes[sizeof(T)];
+    this->load_binary(bytes, sizeof(T));
+    if (!detail::IsLittleEndian())
+      std::reverse(bytes, bytes + sizeof(T));
+    std::memcpy(&t, bytes, sizeof(T));
+  }
+};
+
+} // namespace data
+} // namespace mlpack
+
+// Required for exported (polymorphic) classes, and for arrays.
+BOOST_SERIALIZATION_REGISTER_ARCHIVE(mlpack::data::PortableBinaryOArchive)
+BOOST_SERIALIZATION_REGISTER_ARCHIVE(mlpack::data::PortableBinaryIArchive)
+BOOST_SERIALIZATION_USE_ARRAY_OPTIMIZATION(
+    mlpack::data::PortableBinaryOArchive)
+BOOST_SERIALIZATION_USE_ARRAY_OPTIMIZATION(
+    mlpack::data::PortableBinaryIArchive)
+
+#endif
@@ -38,6 +38,9 @@ namespace data /** Functions to load and save matrices. */ {
  *  - Raw binary (raw_binary), denoted by .bin
  *  - Armadillo binary (arma_binary), denoted by .bin
  *  - HDF5 (hdf5_binary), denoted by .hdf5, .hdf, .h5, or .he5
+ *  - NumPy, denoted by .npy; the matrix is written without a copy in either
+ *    orientation, with its elements aligned to a page, so that Load() can map
+ *    the file back without copying (see SaveNPY())
  *
  * If the file extension is not one of those types, an error will be given.  If
  * the 'fatal' parameter is set to true, a std::runtime_error exception will be
@@ -70,8 +73,15 @@ bool Save(const std::string& filename,
  *  - xml, denoted by .xml
  *  - binary, denoted by .bin
  *
+ * and mlpack's portable binary format (see PortableBinaryOArchive), which can
+ * be read on any platform, is checksummed, and can be compressed:
+ *
+ *  - portable binary, denoted by .pbin
+ *  - compressed portable binary, denoted by .pbz (needs zlib)
+ *
  * The format parameter can take any of the values in the 'format' enum:
- * 'format::autodetect', 'format::text', 'format::xml', and 'format::binary'.
+ * 'format::autodetect', 'format::text', 'format::xml', 'format::binary',
+ * 'format::portable_binary', and 'format::portable_binary_compressed'.
  * The autodetect functionality operates on the file extension (so, "file.txt"
  * would be autodetected as text).
  *
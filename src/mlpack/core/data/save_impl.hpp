@@ -15,11 +15,13 @@
 // In case it hasn't already been included.
 #include "save.hpp"
 #include "extension.hpp"
+#include "npy_format.hpp"
 
 #include <boost/serialization/serialization.hpp>
 #include <boost/archive/xml_oarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/archive/binary_oarchive.hpp>
+#include "portable_binary_archive.hpp"
 
 namespace mlpack {
 namespace data {
@@ -64,6 +66,31 @@ bool Save(const std::string& filename,
     return false;
   }
 
+  // .npy files are written directly from the memory of the matrix.
+  if (extension == "npy")
+  {
+    Log::Info << "Saving NumPy data to '" << filename << "'." << std::endl;
+    try
+    {
+      SaveNPY(filename, matrix, transpose);
+    }
+    catch (std::exception& e)
+    {
+      Timer::Stop("saving_data");
+      if (fatal)
+        Log::Fatal << "Save to '" << filename << "' failed: " << e.what()
+            << std::endl;
+      else
+        Log::Warn << "Save to '" << filename << "' failed: " << e.what()
+            << std::endl;
+
+      return false;
+    }
+
+    Timer::Stop("saving_data");
+    return true;
+  }
+
   // Catch errors opening the file.
   std::fstream stream;
 #ifdef  _WIN32 // Always open in binary mode on Windows.
@@ -215,14 +242,18 @@ bool Save(const std::string& filename,
       f = format::binary;
     else if (extension == "txt")
       f = format::text;
+    else if (extension == "pbin")
+      f = format::portable_binary;
+    else if (extension == "pbz")
+      f = format::portable_binary_compressed;
     else
     {
       if (fatal)
         Log::Fatal << "Unable to detect type of '" << filename << "'; incorrect"
-            << " extension? (allowed: xml/bin/txt)" << std::endl;
+            << " extension? (allowed: xml/bin/txt/pbin/pbz)" << std::endl;
       else
         Log::Warn << "Unable to detect type of '" << filename << "'; save "
-            << "failed.  Incorrect extension? (allowed: xml/bin/txt)"
+            << "failed.  Incorrect extension? (allowed: xml/bin/txt/pbin/pbz)"
             << std::endl;
 
       return false;
@@ -231,14 +262,14 @@ bool Save(const std::string& filename,
 
   // Open the file to save to.
   std::ofstream ofs;
+  if (f == format::portable_binary || f == format::portable_binary_compressed)
+    ofs.open(filename, std::ofstream::out | std::ofstream::binary);
 #ifdef _WIN32
-  if (f == format::binary) // Open non-text types in binary mode on Windows.
+  else if (f == format::binary) // Open non-text types in binary mode on Windows.
     ofs.open(filename, std::ofstream::out | std::ofstream::binary);
+#endif
   else
     ofs.open(filename, std::ofstream::out);
-#else
-  ofs.open(filename, std::ofstream::out);
-#endif
 
   if (!ofs.is_open())
   {
@@ -269,6 +300,13 @@ bool Save(const std::string& filename,
       boost::archive::binary_oarchive ar(ofs);
       ar << boost::serialization::make_nvp(name.c_str(), t);
     }
+    else if (f == format::portable_binary ||
+             f == format::portable_binary_compressed)
+    {
+      PortableBinaryOArchive ar(ofs, f == format::portable_binary_compressed);
+      ar << boost::serialization::make_nvp(name.c_str(), t);
+      ar.Finish();
+    }
 
     return true;
   }
@@ -281,6 +319,17 @@ bool Save(const std::string& filename,
 
     return false;
   }
+  catch (std::runtime_error& e)
+  {
+    // Thrown by the portable binary archives (for instance, if the checksum
+    // does not match).
+    if (fatal)
+      Log::Fatal << "'" << filename << "': " << e.what() << std::endl;
+    else
+      Log::Warn << "'" << filename << "': " << e.what() << std::endl;
+
+    return false;
+  }
 }
 
 } // namespace data
@@ -17,6 +17,195 @@
 
 namespace mlpack {
 namespace data {
+
+/**
+ * Randomly split the indices of a dataset of the given size into the indices
+ * of a training set and the indices of a test set, without touching the
+ * dataset itself.  Both sets of indices are in random order.  Split() uses
+ * exactly these indices, so with the same random seed the two give the same
+ * split; with the indices, any number of datasets (or labels, or weights) can
+ * be split consistently, or the split sets can be used through
+ * arma::Mat::cols() without copying anything until needed.
+ *
+ * @code
+ * arma::uvec trainIndices, testIndices;
+ * data::SplitIndices(dataset.n_cols, 0.3, trainIndices, testIndices);
+ * @endcode
+ *
+ * @param numPoints Number of points in the dataset.
+ * @param testRatio Percentage of dataset to use for test set (between 0 and 1).
+ * @param trainIndices Vector to store the indices of the training points into.
+ * @param testIndices Vector to store the indices of the test points into.
+ */
+inline void SplitIndices(const size_t numPoints,
+                         const double testRatio,
+                         arma::uvec& trainIndices,
+                         arma::uvec& testIndices)
+{
+  const size_t testSize = static_cast<size_t>(numPoints * testRatio);
+  const size_t trainSize = numPoints - testSize;
+
+  const arma::uvec order = arma::shuffle(arma::linspace<arma::uvec>(0,
+      numPoints - 1, numPoints));
+  if (trainSize > 0)
+    trainIndices = order.subvec(0, trainSize - 1);
+  else
+    trainIndices.reset();
+  if (testSize > 0)
+    testIndices = order.subvec(trainSize, numPoints - 1);
+  else
+    testIndices.reset();
+}
+
+/**
+ * Copy the given columns of the input into the output, in parallel (if OpenMP
+ * is available).  This is input.cols(indices), but large gathers are much
+ * faster when every thread copies its own columns.
+ *
+ * @param input Matrix to copy columns of.
+ * @param indices Indices of the columns to copy, in the order of the output.
+ * @param output Matrix to store the copied columns into.
+ */
+template<typename T>
+void GatherColumns(const arma::Mat<T>& input,
+                   const arma::uvec& indices,
+                   arma::Mat<T>& output)
+{
+  output.set_size(input.n_rows, indices.n_elem);
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) indices.n_elem; ++i)
+  {
+    std::copy(input.colptr(indices[i]), input.colptr(indices[i]) +
+        input.n_rows, output.colptr(i));
+  }
+}
+
+namespace detail {
+
+/**
+ * Randomly choose the test points of a dataset of the given size, and compute
+ * the pairs of columns to swap so that the training points come first and the
+ * test points last.  The pairs are disjoint, so they can be swapped in
+ * parallel.
+ */
+inline size_t SplitInPlaceSwaps(const size_t numPoints,
+                                const double testRatio,
+                                arma::uvec& trainSwaps,
+                                arma::uvec& testSwaps)
+{
+  arma::uvec trainIndices, testIndices;
+  SplitIndices(numPoints, testRatio, trainIndices, testIndices);
+  const size_t trainSize = trainIndices.n_elem;
+
+  // Test points among the first trainSize columns are swapped with training
+  // points among the last columns; there are equally many of both.
+  std::vector<arma::uword> misplacedTest, misplacedTrain;
+  for (size_t i = 0; i < testIndices.n_elem; ++i)
+    if (testIndices[i] < trainSize)
+      misplacedTest.push_back(testIndices[i]);
+  for (size_t i = 0; i < trainIndices.n_elem; ++i)
+    if (trainIndices[i] >= trainSize)
+      misplacedTrain.push_back(trainIndices[i]);
+
+  trainSwaps = arma::uvec(misplacedTrain);
+  testSwaps = arma::uvec(misplacedTest);
+  return trainSize;
+}
+
+} // namespace detail
+
+/**
+ * Given an input dataset and labels, split them into a training set and a test
+ * set without copying: the columns of the input are rearranged in place so
+ * that the training points come first and the test points last, and the
+ * outputs are set to non-owning aliases of the two parts of the input.  The
+ * rearrangement swaps each misplaced test point with a misplaced training
+ * point, in parallel, so it takes no extra memory.  Which points are held out
+ * is random (as for Split()), but the points in each part keep their relative
+ * order, except for the swapped points.
+ *
+ * The outputs alias the input, so the input must outlive them and must not be
+ * resized while they are used.  (The aliases are not strict, so resizing an
+ * output just detaches it from the input.)
+ *
+ * @code
+ * arma::mat dataset = loadData();
+ * arma::Row<size_t> labels = loadLabels();
+ * arma::mat trainData, testData;
+ * arma::Row<size_t> trainLabels, testLabels;
+ * data::SplitInPlace(dataset, labels, trainData, testData, trainLabels,
+ *     testLabels, 0.3);
+ * @endcode
+ *
+ * @param input Input dataset to split (it is rearranged).
+ * @param inputLabel Input labels to split (they are rearranged).
+ * @param trainData Matrix to make an alias of the training data.
+ * @param testData Matrix to make an alias of the test data.
+ * @param trainLabel Vector to make an alias of the training labels.
+ * @param testLabel Vector to make an alias of the test labels.
+ * @param testRatio Percentage of dataset to use for test set (between 0 and 1).
+ */
+template<typename T, typename U>
+void SplitInPlace(arma::Mat<T>& input,
+                  arma::Row<U>& inputLabel,
+                  arma::Mat<T>& trainData,
+                  arma::Mat<T>& testData,
+                  arma::Row<U>& trainLabel,
+                  arma::Row<U>& testLabel,
+                  const double testRatio)
+{
+  arma::uvec trainSwaps, testSwaps;
+  const size_t trainSize = detail::SplitInPlaceSwaps(input.n_cols, testRatio,
+      trainSwaps, testSwaps);
+
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) trainSwaps.n_elem; ++i)
+  {
+    input.swap_cols(trainSwaps[i], testSwaps[i]);
+    std::swap(inputLabel[trainSwaps[i]], inputLabel[testSwaps[i]]);
+  }
+
+  trainData = arma::Mat<T>(input.memptr(), input.n_rows, trainSize, false,
+      false);
+  testData = arma::Mat<T>(input.memptr() + trainSize * input.n_rows,
+      input.n_rows, input.n_cols - trainSize, false, false);
+  trainLabel = arma::Row<U>(inputLabel.memptr(), trainSize, false, false);
+  testLabel = arma::Row<U>(inputLabel.memptr() + trainSize,
+      inputLabel.n_elem - trainSize, false, false);
+}
+
+/**
+ * Given an input dataset, split it into a training set and a test set without
+ * copying: the columns of the input are rearranged in place so that the
+ * training points come first and the test points last, and the outputs are set
+ * to non-owning aliases of the two parts of the input.  See the overload with
+ * labels for details.
+ *
+ * @param input Input dataset to split (it is rearranged).
+ * @param trainData Matrix to make an alias of the training data.
+ * @param testData Matrix to make an alias of the test data.
+ * @param testRatio Percentage of dataset to use for test set (between 0 and 1).
+ */
+template<typename T>
+void SplitInPlace(arma::Mat<T>& input,
+                  arma::Mat<T>& trainData,
+                  arma::Mat<T>& testData,
+                  const double testRatio)
+{
+  arma::uvec trainSwaps, testSwaps;
+  const size_t trainSize = detail::SplitInPlaceSwaps(input.n_cols, testRatio,
+      trainSwaps, testSwaps);
+
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) trainSwaps.n_elem; ++i)
+    input.swap_cols(trainSwaps[i], testSwaps[i]);
+
+  trainData = arma::Mat<T>(input.memptr(), input.n_rows, trainSize, false,
+      false);
+  testData = arma::Mat<T>(input.memptr() + trainSize * input.n_rows,
+      input.n_rows, input.n_cols - trainSize, false, false);
+}
+
 /**
  * Given an input dataset and labels, split into a training set and test set.
  * Example usage below.  This overload places the split dataset into the four
@@ -54,28 +243,13 @@ void Split(const arma::Mat<T>& input,
            arma::Row<U>& testLabel,
            const double testRatio)
 {
-  const size_t testSize = static_cast<size_t>(input.n_cols * testRatio);
-  const size_t trainSize = input.n_cols - testSize;
-  trainData.set_size(input.n_rows, trainSize);
-  testData.set_size(input.n_rows, testSize);
-  trainLabel.set_size(trainSize);
-  testLabel.set_size(testSize);
-
-  const arma::Col<size_t> order =
-      arma::shuffle(arma::linspace<arma::Col<size_t>>(0, input.n_cols - 1,
-                                                      input.n_cols));
-
-  for (size_t i = 0; i != trainSize; ++i)
-  {
-    trainData.col(i) = input.col(order[i]);
-    trainLabel(i) = inputLabel(order[i]);
-  }
+  arma::uvec trainIndices, testIndices;
+  SplitIndices(input.n_cols, testRatio, trainIndices, testIndices);
 
-  for (size_t i = 0; i != testSize; ++i)
-  {
-    testData.col(i) = input.col(order[i + trainSize]);
-    testLabel(i) = inputLabel(order[i + trainSize]);
-  }
+  GatherColumns(input, trainIndices, trainData);
+  GatherColumns(input, testIndices, testData);
+  trainLabel = inputLabel.cols(trainIndices);
+  testLabel = inputLabel.cols(testIndices);
 }
 
 /**
@@ -105,23 +279,11 @@ void Split(const arma::Mat<T>& input,
            arma::Mat<T>& testData,
            const double testRatio)
 {
-  const size_t testSize = static_cast<size_t>(input.n_cols * testRatio);
-  const size_t trainSize = input.n_cols - testSize;
-  trainData.set_size(input.n_rows, trainSize);
-  testData.set_size(input.n_rows, testSize);
-
-  const arma::Col<size_t> order =
-      arma::shuffle(arma::linspace<arma::Col<size_t>>(0, input.n_cols -1,
-                                                      input.n_cols));
+  arma::uvec trainIndices, testIndices;
+  SplitIndices(input.n_cols, testRatio, trainIndices, testIndices);
 
-  for (size_t i = 0; i != trainSize; ++i)
-  {
-    trainData.col(i) = input.col(order[i]);
-  }
-  for (size_t i = 0; i != testSize; ++i)
-  {
-    testData.col(i) = input.col(order[i + trainSize]);
-  }
+  GatherColumns(input, trainIndices, trainData);
+  GatherColumns(input, testIndices, testData);
 }
 
 /**
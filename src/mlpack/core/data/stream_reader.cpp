@@ -0,0 +1,343 @@
+/**
+ * @file stream_reader.cpp
+ *
+ * Implementation of StreamReader.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "stream_reader.hpp"
+#include "extension.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace mlpack {
+namespace data {
+
+//! Number of bytes of a text file to read at once.
+static const size_t textBlockSize = (1 << 22);
+
+/**
+ * Parse one number of a line, and skip the separator after it.  Returns false
+ * if there is no number at p.
+ */
+static bool ParseField(const char*& p, const char* end, double& value)
+{
+  char* next;
+  value = std::strtod(p, &next);
+  if (next == p || next > end)
+    return false;
+
+  p = next;
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+    ++p;
+  if (p < end && *p == ',')
+    ++p;
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+    ++p;
+
+  return true;
+}
+
+/**
+ * Parse the line from begin to end into the given column, and return whether
+ * it holds exactly size values.  If column is NULL, the values are only
+ * counted, and the count is returned through numFields.
+ */
+static bool ParseLine(const char* begin,
+                      const char* end,
+                      double* column,
+                      const size_t size,
+                      size_t& numFields)
+{
+  const char* p = begin;
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+    ++p;
+
+  numFields = 0;
+  double value;
+  while (p < end)
+  {
+    if (!ParseField(p, end, value))
+      return false;
+    if (column && numFields >= size)
+      return false;
+    if (column)
+      column[numFields] = value;
+    ++numFields;
+  }
+
+  return (column == NULL || numFields == size);
+}
+
+/**
+ * Read the header of an Armadillo binary file, which is a column-major array
+ * (that is, a .npy file in Fortran order).
+ */
+static NPYHeader ReadArmaHeader(const char* data,
+                                const size_t size,
+                                const std::string& filename)
+{
+  const std::string error = "StreamReader: '" + filename + "' ";
+  const size_t headerEnd = std::min(size, (size_t) 256);
+  const std::string text(data, headerEnd);
+  if (text.compare(0, 13, "ARMA_MAT_BIN_") != 0 || text.size() < 18)
+    throw std::runtime_error(error + "is not an Armadillo binary file");
+
+  NPYHeader header;
+  const std::string type = text.substr(13, 5);
+  if (type[0] == 'F' && type[1] == 'N')
+    header.kind = 'f';
+  else if (type[0] == 'I' && type[1] == 'S')
+    header.kind = 'i';
+  else if (type[0] == 'I' && type[1] == 'U')
+    header.kind = 'u';
+  else
+    throw std::runtime_error(error + "has an unsupported element type");
+  header.elemSize = std::strtoul(type.c_str() + 2, NULL, 10);
+  if (header.elemSize != 1 && header.elemSize != 2 && header.elemSize != 4 &&
+      header.elemSize != 8)
+    throw std::runtime_error(error + "has an unsupported element type");
+  if (header.kind == 'f' && header.elemSize < 4)
+    throw std::runtime_error(error + "has an unsupported element type");
+
+  // The type is followed by a newline, the size, and another newline.
+  std::istringstream sizes(text.substr(18));
+  sizes >> header.rows >> header.cols;
+  const size_t sizeEnd = text.find('\n', 19);
+  if (sizes.fail() || sizeEnd == std::string::npos)
+    throw std::runtime_error(error + "has an invalid header");
+
+  header.fortranOrder = true;
+  header.dataOffset = sizeEnd + 1;
+  const size_t available = (size - header.dataOffset) / header.elemSize;
+  if (header.rows != 0 && header.cols > available / header.rows)
+    throw std::runtime_error(error + "is truncated or corrupt");
+
+  return header;
+}
+
+StreamReader::StreamReader(const std::string& filename,
+                           const size_t chunkSize,
+                           const bool prefetch) :
+    filename(filename),
+    chunkSize(chunkSize),
+    prefetch(prefetch),
+    dimensionality(0),
+    pointsRead(0),
+    text(false),
+    lineNumber(0),
+    position(0)
+{
+  if (chunkSize == 0)
+    throw std::invalid_argument("StreamReader: chunk size must be positive");
+
+  const std::string extension = Extension(filename);
+  if (extension == "csv" || extension == "tsv" || extension == "txt")
+  {
+    text = true;
+    stream.open(filename, std::ios::binary);
+    if (!stream.is_open())
+      throw std::runtime_error("StreamReader: cannot open file '" + filename +
+          "'");
+  }
+  else if (extension == "npy" || extension == "bin")
+  {
+    file.reset(new util::MappedFile(filename));
+    if (extension == "npy")
+      header = ReadNPYHeader(file->Data(), file->Size(), filename);
+    else
+      header = ReadArmaHeader(file->Data(), file->Size(), filename);
+    dimensionality = header.cols;
+  }
+  else
+  {
+    throw std::runtime_error("StreamReader: cannot stream '" + filename +
+        "'; only .csv, .tsv, .txt, .npy and .bin files are supported");
+  }
+}
+
+StreamReader::~StreamReader()
+{
+  if (pending.valid())
+    pending.wait();
+}
+
+bool StreamReader::Next(arma::mat& chunk)
+{
+  if (!prefetch)
+  {
+    if (!ReadChunk(chunk))
+      return false;
+    pointsRead += chunk.n_cols;
+    return true;
+  }
+
+  if (!pending.valid())
+    StartPrefetch();
+
+  // get() rethrows any exception thrown while reading.
+  if (!pending.get())
+    return false;
+
+  chunk = std::move(nextChunk);
+  pointsRead += chunk.n_cols;
+  StartPrefetch();
+  return true;
+}
+
+void StreamReader::Reset()
+{
+  if (pending.valid())
+    pending.wait();
+  pending = std::future<bool>();
+
+  if (text)
+  {
+    stream.clear();
+    stream.seekg(0);
+    buffer.clear();
+    lineNumber = 0;
+  }
+
+  position = 0;
+  pointsRead = 0;
+}
+
+void StreamReader::StartPrefetch()
+{
+  pending = std::async(std::launch::async,
+      [this]() { return ReadChunk(nextChunk); });
+}
+
+bool StreamReader::ReadChunk(arma::mat& chunk)
+{
+  return text ? ReadTextChunk(chunk) : ReadBinaryChunk(chunk);
+}
+
+bool StreamReader::ReadTextChunk(arma::mat& chunk)
+{
+  // Find the next chunkSize non-empty lines, reading more of the file as
+  // needed.  The buffer always starts at the beginning of a line.
+  std::vector<std::pair<size_t, size_t>> lines;
+  std::vector<size_t> lineNumbers;
+  size_t begin = 0;
+  while (lines.size() < chunkSize)
+  {
+    size_t end = buffer.find('\n', begin);
+    if (end == std::string::npos)
+    {
+      if (stream)
+      {
+        const size_t oldSize = buffer.size();
+        buffer.resize(oldSize + textBlockSize);
+        stream.read(&buffer[oldSize], textBlockSize);
+        buffer.resize(oldSize + (size_t) stream.gcount());
+        if (stream.bad())
+          throw std::runtime_error("StreamReader: error reading file '" +
+              filename + "'");
+        continue;
+      }
+
+      // The last line may not end with a newline.
+      if (begin == buffer.size())
+        break;
+      end = buffer.size();
+    }
+
+    ++lineNumber;
+    if (buffer.find_first_not_of(" \t\r", begin) < end)
+    {
+      lines.push_back(std::make_pair(begin, end));
+      lineNumbers.push_back(lineNumber);
+    }
+    begin = std::min(end + 1, buffer.size());
+  }
+
+  if (lines.empty())
+  {
+    buffer.clear();
+    return false;
+  }
+
+  // The first line sets the dimensionality, if that's not known yet.
+  if (dimensionality == 0)
+  {
+    size_t numFields = 0;
+    if (!ParseLine(buffer.data() + lines[0].first,
+        buffer.data() + lines[0].second, NULL, 0, numFields) || numFields == 0)
+    {
+      throw std::runtime_error("StreamReader: cannot parse data in '" +
+          filename + "'");
+    }
+    dimensionality = numFields;
+  }
+
+  // Parse the lines in parallel.  Exceptions can't leave the parallel region,
+  // so just remember which line failed.
+  chunk.set_size(dimensionality, lines.size());
+  size_t firstError = lines.size();
+  #pragma omp parallel for schedule(static)
+  for (omp_size_t i = 0; i < (omp_size_t) lines.size(); ++i)
+  {
+    size_t fields;
+    if (!ParseLine(buffer.data() + lines[i].first,
+        buffer.data() + lines[i].second, chunk.colptr(i), dimensionality,
+        fields))
+    {
+      #pragma omp critical
+      firstError = std::min(firstError, (size_t) i);
+    }
+  }
+
+  if (firstError < lines.size())
+  {
+    std::ostringstream oss;
+    oss << "StreamReader: cannot parse line " << lineNumbers[firstError]
+        << " of '" << filename << "' as " << dimensionality << " dimensions";
+    throw std::runtime_error(oss.str());
+  }
+
+  buffer.erase(0, begin);
+  return true;
+}
+
+bool StreamReader::ReadBinaryChunk(arma::mat& chunk)
+{
+  if (position >= header.rows)
+    return false;
+
+  const size_t numPoints = std::min(chunkSize, header.rows - position);
+  const char* elements = file->Data() + header.dataOffset;
+
+  if (!header.fortranOrder)
+  {
+    // In C order, the points are contiguous.
+    chunk.set_size(header.cols, numPoints);
+    const char* source = elements + position * header.cols * header.elemSize;
+    if (header.kind == 'f' && header.elemSize == sizeof(double))
+      std::memcpy(chunk.memptr(), source, chunk.n_elem * sizeof(double));
+    else
+      detail::ConvertNPYElements(header, source, chunk.memptr(), chunk.n_elem);
+  }
+  else
+  {
+    // In Fortran order, each dimension of the points is contiguous.
+    arma::mat points(numPoints, header.cols);
+    for (size_t d = 0; d < header.cols; ++d)
+    {
+      detail::ConvertNPYElements(header, elements + (d * header.rows +
+          position) * header.elemSize, points.colptr(d), numPoints);
+    }
+    chunk = points.t();
+  }
+
+  position += numPoints;
+  return true;
+}
+
+} // namespace data
+} // namespace mlpack
@@ -0,0 +1,150 @@
+/**
+ * @file stream_reader.hpp
+ *
+ * Definition of StreamReader, which reads a dataset from a file in chunks of
+ * points, so that datasets that do not fit in memory can be processed.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_STREAM_READER_HPP
+#define MLPACK_CORE_DATA_STREAM_READER_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/mapped_file.hpp>
+#include <fstream>
+#include <future>
+#include <memory>
+
+#include "npy_format.hpp"
+
+namespace mlpack {
+namespace data {
+
+/**
+ * StreamReader reads the points of a dataset file in chunks of a fixed number
+ * of points, with one point per column of each chunk (as data::Load() gives
+ * with transpose = true).  Only the current chunk (and the next one, if it is
+ * prefetched) is ever in memory, so a dataset can be processed in any number
+ * of passes without loading it.
+ *
+ * The supported types of files are:
+ *
+ *  - text files (.csv, .tsv, .txt) with one point per line, whose values are
+ *    separated by commas, tabs or spaces; empty lines are skipped.  The lines
+ *    of each chunk are parsed in parallel (if OpenMP is available).
+ *  - NumPy files (.npy) with one point per row, in either memory order.
+ *  - Armadillo binary files (.bin) with one point per row, which is what
+ *    data::Save() writes.
+ *
+ * Binary files are mapped into memory, so only the pages of the current chunk
+ * are read from disk.
+ *
+ * If prefetching is enabled, the next chunk is read on another thread while
+ * the current chunk is being used.  Reading errors (for instance a line that
+ * cannot be parsed) are reported with std::runtime_error from Next().
+ *
+ * @code
+ * data::StreamReader reader("huge_dataset.csv", 10000);
+ * arma::mat chunk;
+ * while (reader.Next(chunk))
+ * {
+ *   // Use the (up to) 10000 points in chunk.
+ * }
+ * @endcode
+ */
+class StreamReader
+{
+ public:
+  /**
+   * Open the given file for reading.  std::runtime_error is thrown if the file
+   * cannot be opened or has an unsupported type.
+   *
+   * @param filename Name of file to read.
+   * @param chunkSize Number of points in each chunk.
+   * @param prefetch Whether to read the next chunk in the background.
+   */
+  StreamReader(const std::string& filename,
+               const size_t chunkSize = 10000,
+               const bool prefetch = true);
+
+  //! Wait for the prefetched chunk, if any, and close the file.
+  ~StreamReader();
+
+  //! A reader cannot be copied.
+  StreamReader(const StreamReader& other) = delete;
+  //! A reader cannot be copied.
+  StreamReader& operator=(const StreamReader& other) = delete;
+
+  /**
+   * Get the next chunk of points.  Every chunk holds ChunkSize() points,
+   * except for the last one, which may hold fewer.
+   *
+   * @param chunk Matrix to store the points in, one per column.
+   * @return false if there are no more points (chunk is then untouched).
+   */
+  bool Next(arma::mat& chunk);
+
+  //! Go back to the beginning of the file, so that the next call to Next()
+  //! gives the first chunk again.
+  void Reset();
+
+  //! Get the name of the file.
+  const std::string& Filename() const { return filename; }
+  //! Get the number of points in each chunk.
+  size_t ChunkSize() const { return chunkSize; }
+  //! Get the dimensionality of the points (for text files, this is 0 until
+  //! the first chunk has been read).
+  size_t Dimensionality() const { return dimensionality; }
+  //! Get the number of points returned by Next() so far.
+  size_t PointsRead() const { return pointsRead; }
+
+ private:
+  //! Read the next chunk of a text file into the given matrix.
+  bool ReadTextChunk(arma::mat& chunk);
+  //! Read the next chunk of a binary file into the given matrix.
+  bool ReadBinaryChunk(arma::mat& chunk);
+  //! Read the next chunk of the file into the given matrix.
+  bool ReadChunk(arma::mat& chunk);
+  //! Start reading the next chunk in the background.
+  void StartPrefetch();
+
+  //! The name of the file.
+  std::string filename;
+  //! The number of points in each chunk.
+  size_t chunkSize;
+  //! Whether the next chunk is read in the background.
+  bool prefetch;
+  //! The dimensionality of the points.
+  size_t dimensionality;
+  //! The number of points returned by Next() so far.
+  size_t pointsRead;
+
+  //! Whether the file is a text file.
+  bool text;
+  //! The text file.
+  std::ifstream stream;
+  //! Text read from the file that has not been parsed yet.
+  std::string buffer;
+  //! The number of lines of the text file before the buffer.
+  size_t lineNumber;
+
+  //! The mapped binary file.
+  std::unique_ptr<util::MappedFile> file;
+  //! The layout of the binary file (one point per row).
+  NPYHeader header;
+  //! The index of the next point of the binary file to read.
+  size_t position;
+
+  //! The next chunk, if it is being read in the background.
+  arma::mat nextChunk;
+  //! Whether a next chunk was found, if it is being read in the background.
+  std::future<bool> pending;
+};
+
+} // namespace data
+} // namespace mlpack
+
+#endif
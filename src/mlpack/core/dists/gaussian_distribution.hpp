@@ -90,11 +90,8 @@ class GaussianDistribution
    */
   void Probability(const arma::mat& x, arma::vec& probabilities) const
   {
-    probabilities.set_size(x.n_cols);
-    for (size_t i = 0; i < x.n_cols; i++)
-    {
-      probabilities(i) = Probability(x.unsafe_col(i));
-    }
+    LogProbability(x, probabilities);
+    probabilities = arma::exp(probabilities);
   }
 
   /**
@@ -110,14 +107,12 @@ class GaussianDistribution
     // Column i of 'diffs' is the difference between x.col(i) and the mean.
     arma::mat diffs = x;
     diffs.each_col() -= mean;
-    // Now, we only want to calculate the diagonal elements of (diffs' * cov^-1
-    // * diffs).  We just don't need any of the other elements.  We can
-    // calculate the right hand part of the equation (instead of the left side)
-    // so that later we are referencing columns, not rows -- that is faster.
-    const arma::mat rhs = -0.5 * invCov * diffs;
-    arma::vec logExponents(diffs.n_cols); // We will now fill this.
-    for (size_t i = 0; i < diffs.n_cols; i++)
-      logExponents(i) = accu(diffs.unsafe_col(i) % rhs.unsafe_col(i));
+    // We only want the diagonal elements of (diffs' * cov^-1 * diffs).  Since
+    // cov = L * L', these are the squared norms of the columns of L^-1 * diffs,
+    // which a single (blocked) triangular solve gives for all columns at once.
+    const arma::mat whitened = arma::solve(arma::trimatl(covLower), diffs);
+    const arma::vec logExponents = -0.5 *
+        trans(arma::sum(arma::square(whitened), 0));
 
     logProbabilities = -0.5 * x.n_rows * log2pi - 0.5 * logDetCov +
       logExponents;
@@ -13,6 +13,7 @@
 #define MLPACK_CORE_HPT_CV_FUNCTION_HPP
 
 #include <mlpack/core.hpp>
+#include <map>
 
 namespace mlpack {
 namespace hpt {
@@ -66,7 +67,10 @@ class CVFunction
              const BoundArgs&... args);
 
   /**
-   * Run cross-validation with the bound and passed parameters.
+   * Run cross-validation with the bound and passed parameters.  The result for
+   * each set of parameters is cached, so cross-validation is run only once for
+   * parameters that are evaluated several times (as gradient-based optimizers
+   * do).
    *
    * @param parameters Arguments (rather than the bound arguments) that should
    *     be passed into the Evaluate method of the CVType object.
@@ -86,6 +90,9 @@ class CVFunction
   //! Access and modify the best model so far.
   MLAlgorithm& BestModel() { return bestModel; }
 
+  //! Get the objective of the best model so far.
+  double BestObjective() const { return bestObjective; }
+
  private:
   //! The type of tuples of BoundArgs.
   using BoundArgsTupleType = std::tuple<BoundArgs...>;
@@ -125,6 +132,9 @@ class CVFunction
   //! Minimum absolute increase of arguments for calculation of gradient.
   double minDelta;
 
+  //! The objectives of the parameters that have been evaluated.
+  std::map<std::vector<double>, double> evaluations;
+
   /**
    * Collect all arguments and run cross-validation.
    */
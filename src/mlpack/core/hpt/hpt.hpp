@@ -14,7 +14,12 @@
 
 #include <mlpack/core/cv/meta_info_extractor.hpp>
 #include <mlpack/core/hpt/deduce_hp_types.hpp>
+#include <mlpack/core/hpt/cv_function.hpp>
+#include <mlpack/core/hpt/subset_args.hpp>
 #include <ensmallen.hpp>
+#include <exception>
+#include <functional>
+#include <memory>
 
 namespace mlpack {
 namespace hpt {
@@ -67,6 +72,36 @@ namespace hpt {
  *     Fixed(useCholesky), lambda1Set, lambda2Set);
  * @endcode
  *
+ * With GridSearch, the grid points can be cross-validated in parallel (if
+ * OpenMP is available) by setting NumThreads().  Every thread cross-validates
+ * with its own copy of the CV object, so memory use grows with the number of
+ * threads, and MLAlgorithm must be safe to train on several threads at once.
+ *
+ * @code
+ * hpt2.NumThreads() = 8;
+ * std::tie(bestLambda1, bestLambda2) = hpt2.Optimize(Fixed(transposeData),
+ *     Fixed(useCholesky), lambda1Set, lambda2Set);
+ * @endcode
+ *
+ * With GridSearch, successive halving can be used instead of cross-validating
+ * every grid point on all of the data, by setting HalvingFactor().  The grid
+ * points are first cross-validated on a random subset of the data, then only
+ * the best 1 / HalvingFactor() of them are kept and cross-validated on a
+ * subset HalvingFactor() times larger, and so on, until at most
+ * HalvingFactor() points are left, which are cross-validated on all of the
+ * data.  The subsets are built from the arguments given to the constructor,
+ * so the tuner keeps a copy of them, and the CV strategy must accept the
+ * smallest subset (for example, KFoldCV needs at least k points).
+ *
+ * @code
+ * hpt2.HalvingFactor() = 3;
+ * std::tie(bestLambda1, bestLambda2) = hpt2.Optimize(Fixed(transposeData),
+ *     Fixed(useCholesky), lambda1Set, lambda2Set);
+ * @endcode
+ *
+ * With any optimizer, each set of hyper-parameters is cross-validated only
+ * once; later evaluations of the same set reuse the result.
+ *
  * @tparam MLAlgorithm A machine learning algorithm.
  * @tparam Metric A metric to assess the quality of a trained model.
  * @tparam CV A cross-validation strategy used to assess a set of
@@ -151,6 +186,43 @@ class HyperParameterTuner
    */
   double& MinDelta() { return minDelta; }
 
+  /**
+   * Get the number of threads to cross-validate grid points on, when the
+   * optimizer is GridSearch (0 means as many as there are OpenMP threads).
+   *
+   * The default value is 1.
+   */
+  size_t NumThreads() const { return numThreads; }
+
+  /**
+   * Modify the number of threads to cross-validate grid points on, when the
+   * optimizer is GridSearch (0 means as many as there are OpenMP threads).
+   * Each thread holds a copy of the CV object and a model.
+   *
+   * The default value is 1.
+   */
+  size_t& NumThreads() { return numThreads; }
+
+  /**
+   * Get the factor by which successive halving reduces the number of grid
+   * points (and increases the size of the data subset) after each round, when
+   * the optimizer is GridSearch.  Values below 2 disable successive halving,
+   * so that every grid point is cross-validated on all of the data.
+   *
+   * The default value is 0.
+   */
+  size_t HalvingFactor() const { return halvingFactor; }
+
+  /**
+   * Modify the factor by which successive halving reduces the number of grid
+   * points (and increases the size of the data subset) after each round, when
+   * the optimizer is GridSearch.  Values below 2 disable successive halving,
+   * so that every grid point is cross-validated on all of the data.
+   *
+   * The default value is 0.
+   */
+  size_t& HalvingFactor() { return halvingFactor; }
+
   /**
    * Find the best hyper-parameters by using the given Optimizer. For each
    * hyper-parameter one of the following should be passed as an argument.
@@ -230,6 +302,50 @@ class HyperParameterTuner
    */
   double minDelta;
 
+  //! The number of threads to cross-validate grid points on.
+  size_t numThreads;
+
+  //! The factor of successive halving (below 2 to disable it).
+  size_t halvingFactor;
+
+  //! The number of data points given to the constructor.
+  size_t numDataPoints;
+
+  //! Create a CV object like cv, but on the given data points only.
+  std::function<std::unique_ptr<CVType>(const arma::uvec&)> subsetCV;
+
+  /**
+   * Cross-validate the points of the grid given by numCategories in parallel
+   * (with successive halving, if HalvingFactor() is 2 or more), and return the
+   * best objective (as CVFunctionType gives it).  The grid points are visited
+   * in the same order as GridSearch visits them, and ties are broken the same
+   * way, so without successive halving the result is the same as with
+   * GridSearch.
+   */
+  template<typename CVFunctionType, typename... FixedArgs>
+  double ParallelGridSearch(
+      arma::mat& bestParams,
+      data::DatasetMapper<data::IncrementPolicy, double>& datasetInfo,
+      const arma::Row<size_t>& numCategories,
+      FixedArgs... fixedArgs);
+
+  /**
+   * Cross-validate the given grid points (indices in the order of GridSearch,
+   * in increasing order) in parallel with the given CV object, and store the
+   * objective of each in objectives.  If keepBestModel is true, the model of
+   * the best point (the first one among equally good ones) is kept in
+   * bestModel.
+   */
+  template<typename CVFunctionType, typename... FixedArgs>
+  void EvaluateGridPoints(
+      CVType& pointsCV,
+      const std::vector<size_t>& points,
+      data::DatasetMapper<data::IncrementPolicy, double>& datasetInfo,
+      const arma::Row<size_t>& numCategories,
+      const bool keepBestModel,
+      arma::vec& objectives,
+      FixedArgs... fixedArgs);
+
   /**
    * A type function to check whether the element I of the tuple type is a
    * PreFixedArg.
@@ -32,7 +32,19 @@ HyperParameterTuner<MLAlgorithm,
                     MatType,
                     PredictionsType,
                     WeightsType>::HyperParameterTuner(const CVArgs&... args) :
-    cv(args...), relativeDelta(0.01), minDelta(1e-10) {}
+    cv(args...),
+    relativeDelta(0.01),
+    minDelta(1e-10),
+    numThreads(1),
+    halvingFactor(0),
+    numDataPoints(NumPointsOfArgs(args...)),
+    subsetCV([args...](const arma::uvec& points)
+    {
+      const size_t numPoints = NumPointsOfArgs(args...);
+      return std::unique_ptr<CVType>(new CVType(SubsetArg(args, points,
+          numPoints)...));
+    })
+{ }
 
 template<typename MLAlgorithm,
          typename Metric,
@@ -102,8 +114,19 @@ void HyperParameterTuner<MLAlgorithm,
         mlpack::data::Datatype::categorical;
   }
 
-  CVFunction<CVType, MLAlgorithm, totalArgs, FixedArgs...>
-      cvFunction(cv, datasetInfo, relativeDelta, minDelta, fixedArgs...);
+  using CVFunctionType =
+      CVFunction<CVType, MLAlgorithm, totalArgs, FixedArgs...>;
+  if (std::is_same<Optimizer, ens::GridSearch>::value &&
+      (numThreads != 1 || halvingFactor >= 2))
+  {
+    const double objective = ParallelGridSearch<CVFunctionType>(bestParams,
+        datasetInfo, numCategories, fixedArgs...);
+    bestObjective = Metric::NeedsMinimization ? objective : -objective;
+    return;
+  }
+
+  CVFunctionType cvFunction(cv, datasetInfo, relativeDelta, minDelta,
+      fixedArgs...);
   bestObjective = Metric::NeedsMinimization ? optimizer.Optimize(cvFunction,
       bestParams, categoricalDimensions, numCategories) :
       -optimizer.Optimize(cvFunction, bestParams, categoricalDimensions,
@@ -111,6 +134,202 @@ void HyperParameterTuner<MLAlgorithm,
       bestModel = std::move(cvFunction.BestModel());
 }
 
+template<typename MLAlgorithm,
+         typename Metric,
+         template<typename, typename, typename, typename, typename> class CV,
+         typename Optimizer,
+         typename MatType,
+         typename PredictionsType,
+         typename WeightsType>
+template<typename CVFunctionType, typename... FixedArgs>
+double HyperParameterTuner<MLAlgorithm,
+                           Metric,
+                           CV,
+                           Optimizer,
+                           MatType,
+                           PredictionsType,
+                           WeightsType>::ParallelGridSearch(
+    arma::mat& bestParams,
+    data::DatasetMapper<data::IncrementPolicy, double>& datasetInfo,
+    const arma::Row<size_t>& numCategories,
+    FixedArgs... fixedArgs)
+{
+  size_t numPoints = 1;
+  for (size_t d = 0; d < numCategories.n_elem; ++d)
+    numPoints *= numCategories[d];
+
+  std::vector<size_t> points(numPoints);
+  for (size_t i = 0; i < numPoints; ++i)
+    points[i] = i;
+
+  if (halvingFactor >= 2 && numPoints > halvingFactor)
+  {
+    if (numDataPoints == 0)
+    {
+      throw std::invalid_argument("HyperParameterTuner::Optimize(): "
+          "successive halving needs the data to be given as a dense matrix!");
+    }
+
+    // The grid points are reduced until at most halvingFactor are left; each
+    // reduction is a round on a subset of the data.
+    size_t subsetRounds = 0;
+    for (size_t left = numPoints; left > halvingFactor;
+        left = (left + halvingFactor - 1) / halvingFactor)
+      ++subsetRounds;
+
+    // The subsets of all rounds are the first points of the same random order,
+    // so each subset contains the previous one.
+    const arma::uvec order = arma::randperm<arma::uvec>(numDataPoints);
+    for (size_t round = 0; round < subsetRounds; ++round)
+    {
+      size_t divisor = 1;
+      for (size_t r = round; r < subsetRounds; ++r)
+        divisor *= halvingFactor;
+      const arma::uvec subset = order.head(std::max(numDataPoints / divisor,
+          (size_t) 1));
+
+      std::unique_ptr<CVType> roundCV = subsetCV(subset);
+      arma::vec objectives;
+      EvaluateGridPoints<CVFunctionType>(*roundCV, points, datasetInfo,
+          numCategories, false, objectives, fixedArgs...);
+
+      // Keep the best points, with the first ones among equally good ones.
+      std::vector<size_t> ranking(points.size());
+      for (size_t i = 0; i < ranking.size(); ++i)
+        ranking[i] = i;
+      std::stable_sort(ranking.begin(), ranking.end(),
+          [&objectives](const size_t a, const size_t b)
+          { return objectives[a] < objectives[b]; });
+
+      std::vector<size_t> kept((points.size() + halvingFactor - 1) /
+          halvingFactor);
+      for (size_t i = 0; i < kept.size(); ++i)
+        kept[i] = points[ranking[i]];
+      std::sort(kept.begin(), kept.end());
+      points.swap(kept);
+    }
+  }
+
+  // The remaining points are cross-validated on all of the data.
+  arma::vec objectives;
+  EvaluateGridPoints<CVFunctionType>(cv, points, datasetInfo, numCategories,
+      true, objectives, fixedArgs...);
+
+  size_t best = 0;
+  for (size_t i = 1; i < points.size(); ++i)
+    if (objectives[i] < objectives[best])
+      best = i;
+
+  size_t bestIndex = points[best];
+  bestParams.set_size(numCategories.n_elem, 1);
+  for (size_t d = numCategories.n_elem; d > 0; --d)
+  {
+    bestParams(d - 1) = bestIndex % numCategories[d - 1];
+    bestIndex /= numCategories[d - 1];
+  }
+
+  return objectives[best];
+}
+
+template<typename MLAlgorithm,
+         typename Metric,
+         template<typename, typename, typename, typename, typename> class CV,
+         typename Optimizer,
+         typename MatType,
+         typename PredictionsType,
+         typename WeightsType>
+template<typename CVFunctionType, typename... FixedArgs>
+void HyperParameterTuner<MLAlgorithm,
+                         Metric,
+                         CV,
+                         Optimizer,
+                         MatType,
+                         PredictionsType,
+                         WeightsType>::EvaluateGridPoints(
+    CVType& pointsCV,
+    const std::vector<size_t>& points,
+    data::DatasetMapper<data::IncrementPolicy, double>& datasetInfo,
+    const arma::Row<size_t>& numCategories,
+    const bool keepBestModel,
+    arma::vec& objectives,
+    FixedArgs... fixedArgs)
+{
+  const size_t numPoints = points.size();
+  objectives.set_size(numPoints);
+
+  size_t threads = (numThreads == 0) ? numPoints :
+      std::min(numThreads, numPoints);
+  #ifdef HAS_OPENMP
+  threads = std::min(threads, (size_t) omp_get_max_threads());
+  #endif
+
+  // The best grid point so far, with the lowest position among equally good
+  // ones.
+  double objective = std::numeric_limits<double>::max();
+  size_t bestPosition = numPoints;
+
+  // Exceptions can't leave the parallel region, so keep the one of the first
+  // grid point that failed.
+  size_t firstError = numPoints;
+  std::exception_ptr error;
+
+  #pragma omp parallel num_threads((int) threads)
+  {
+    // Every thread needs its own CV object, since evaluating one keeps the
+    // last model in it.
+    CVType threadCV(pointsCV);
+    CVFunctionType cvFunction(threadCV, datasetInfo, relativeDelta, minDelta,
+        fixedArgs...);
+    size_t threadBestPosition = numPoints;
+    arma::mat parameters(numCategories.n_elem, 1);
+
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t i = 0; i < (omp_size_t) numPoints; ++i)
+    {
+      // As in GridSearch, the last dimension changes fastest.
+      size_t rest = points[i];
+      for (size_t d = numCategories.n_elem; d > 0; --d)
+      {
+        parameters(d - 1) = rest % numCategories[d - 1];
+        rest /= numCategories[d - 1];
+      }
+
+      try
+      {
+        // CVFunction keeps the model of the first best point it sees, and the
+        // points of each thread are visited in increasing order.
+        const double previousBest = cvFunction.BestObjective();
+        objectives[i] = cvFunction.Evaluate(parameters);
+        if (objectives[i] < previousBest || threadBestPosition == numPoints)
+          threadBestPosition = i;
+      }
+      catch (...)
+      {
+        #pragma omp critical
+        if ((size_t) i < firstError)
+        {
+          firstError = i;
+          error = std::current_exception();
+        }
+      }
+    }
+
+    #pragma omp critical
+    if (keepBestModel && threadBestPosition < numPoints &&
+        (cvFunction.BestObjective() < objective ||
+        (cvFunction.BestObjective() == objective &&
+         threadBestPosition < bestPosition)))
+    {
+      objective = cvFunction.BestObjective();
+      bestPosition = threadBestPosition;
+      bestModel = std::move(cvFunction.BestModel());
+    }
+  }
+
+  if (error)
+    std::rethrow_exception(error);
+}
+
 template<typename MLAlgorithm,
          typename Metric,
          template<typename, typename, typename, typename, typename> class CV,
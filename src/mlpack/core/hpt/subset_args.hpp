@@ -0,0 +1,84 @@
+/**
+ * @file subset_args.hpp
+ *
+ * Utilities to restrict the constructor arguments of a cross-validation
+ * strategy to a subset of the data points, for successive halving in
+ * HyperParameterTuner.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_HPT_SUBSET_ARGS_HPP
+#define MLPACK_CORE_HPT_SUBSET_ARGS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace hpt {
+
+/**
+ * Get the number of data points of the constructor arguments of a
+ * cross-validation strategy: the number of columns of the first matrix (that is
+ * not a row or a column vector), or 0 if there is none.
+ */
+inline size_t NumPointsOfArgs() { return 0; }
+
+template<typename eT, typename... Rest>
+size_t NumPointsOfArgs(const arma::Mat<eT>& data, const Rest&... rest);
+
+template<typename T, typename... Rest>
+size_t NumPointsOfArgs(const T& /* arg */, const Rest&... rest)
+{
+  return NumPointsOfArgs(rest...);
+}
+
+template<typename eT, typename... Rest>
+size_t NumPointsOfArgs(const arma::Mat<eT>& data, const Rest&... /* rest */)
+{
+  return data.n_cols;
+}
+
+/**
+ * Restrict a constructor argument of a cross-validation strategy to the given
+ * points.  Arguments that hold one column (or element) for each of the
+ * numPoints data points (the data, the responses or labels, and the weights)
+ * are restricted; every other argument is returned as it is.
+ */
+template<typename T>
+const T& SubsetArg(const T& arg,
+                   const arma::uvec& /* points */,
+                   const size_t /* numPoints */)
+{
+  return arg;
+}
+
+template<typename eT>
+arma::Mat<eT> SubsetArg(const arma::Mat<eT>& arg,
+                        const arma::uvec& points,
+                        const size_t numPoints)
+{
+  return (arg.n_cols == numPoints) ? arma::Mat<eT>(arg.cols(points)) : arg;
+}
+
+template<typename eT>
+arma::Row<eT> SubsetArg(const arma::Row<eT>& arg,
+                        const arma::uvec& points,
+                        const size_t numPoints)
+{
+  return (arg.n_elem == numPoints) ? arma::Row<eT>(arg.cols(points)) : arg;
+}
+
+template<typename eT>
+arma::Col<eT> SubsetArg(const arma::Col<eT>& arg,
+                        const arma::uvec& points,
+                        const size_t numPoints)
+{
+  return (arg.n_elem == numPoints) ? arma::Col<eT>(arg.rows(points)) : arg;
+}
+
+} // namespace hpt
+} // namespace mlpack
+
+#endif
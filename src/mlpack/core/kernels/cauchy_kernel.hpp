@@ -62,12 +62,40 @@ class CauchyKernel
    * @return K(a, b).
    */
   template<typename VecTypeA, typename VecTypeB>
-  double Evaluate(const VecTypeA& a, const VecTypeB& b)
+  double Evaluate(const VecTypeA& a, const VecTypeB& b) const
   {
     return 1 / (1 + (
         std::pow(metric::EuclideanDistance::Evaluate(a, b) / bandwidth, 2)));
   }
 
+  /**
+   * Evaluation of the Cauchy kernel given the distance between two points.
+   *
+   * @param distance The distance between the two points.
+   * @return K(distance).
+   */
+  double Evaluate(const double distance) const
+  {
+    return 1 / (1 + std::pow(distance / bandwidth, 2));
+  }
+
+  /**
+   * Evaluation of the Cauchy kernel for a whole vector of distances at once.
+   * distances and values may be the same vector.
+   *
+   * @param distances The distances to evaluate the kernel on.
+   * @param values Vector to store K(distance) for each distance in.
+   */
+  void BatchEvaluate(const arma::vec& distances, arma::vec& values) const
+  {
+    values = 1.0 / (1.0 + arma::square(distances / bandwidth));
+  }
+
+  //! Get the bandwidth.
+  double Bandwidth() const { return bandwidth; }
+  //! Modify the bandwidth.
+  double& Bandwidth() { return bandwidth; }
+
   /**
    * Serialize the kernel.
    */
@@ -89,6 +117,10 @@ class KernelTraits<CauchyKernel>
  public:
   //! The Cauchy kernel is normalized: K(x, x) = 1 for all x.
   static const bool IsNormalized = true;
+  //! The Cauchy kernel includes a squared distance.
+  static const bool UsesSquaredDistance = true;
+  //! The Cauchy kernel can be evaluated on many distances at once.
+  static const bool HasBatchEvaluate = true;
 };
 
 } // namespace kernel
@@ -56,6 +56,9 @@ class KernelTraits<CosineDistance>
 
   //! The cosine kernel doesn't include a squared distance.
   static const bool UsesSquaredDistance = false;
+
+  //! The cosine kernel doesn't depend only on the distance.
+  static const bool HasBatchEvaluate = false;
 };
 
 } // namespace kernel
@@ -34,6 +34,16 @@ double EpanechnikovKernel::Evaluate(const double distance) const
   return std::max(0.0, 1 - std::pow(distance, 2.0) * inverseBandwidthSquared);
 }
 
+/**
+ * Evaluate the kernel for a whole vector of distances.
+ */
+void EpanechnikovKernel::BatchEvaluate(const arma::vec& distances,
+                                       arma::vec& values) const
+{
+  values = arma::clamp(1.0 - arma::square(distances) * inverseBandwidthSquared,
+      0.0, arma::datum::inf);
+}
+
 /**
  * Evaluate gradient of the kernel not for two points
  * but for a numerical value.
@@ -57,6 +57,15 @@ class EpanechnikovKernel
    */
   double Evaluate(const double distance) const;
 
+  /**
+   * Evaluate the Epanechnikov kernel for a whole vector of distances at once.
+   * distances and values may be the same vector.
+   *
+   * @param distances The distances to evaluate the kernel on.
+   * @param values Vector to store the kernel value for each distance in.
+   */
+  void BatchEvaluate(const arma::vec& distances, arma::vec& values) const;
+
   /**
    * Evaluate the Gradient of Epanechnikov kernel
    * given that the distance between the two
@@ -111,6 +120,8 @@ class KernelTraits<EpanechnikovKernel>
   static const bool IsNormalized = true;
   //! The Epanechnikov kernel includes a squared distance.
   static const bool UsesSquaredDistance = true;
+  //! The Epanechnikov kernel can be evaluated on many distances at once.
+  static const bool HasBatchEvaluate = true;
 };
 
 } // namespace kernel
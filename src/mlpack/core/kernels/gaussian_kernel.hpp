@@ -81,6 +81,18 @@ class GaussianKernel
     return exp(gamma * std::pow(t, 2.0));
   }
 
+  /**
+   * Evaluation of the Gaussian kernel for a whole vector of distances at once.
+   * distances and values may be the same vector.
+   *
+   * @param distances The distances to evaluate the kernel on.
+   * @param values Vector to store K(t) for each distance t in.
+   */
+  void BatchEvaluate(const arma::vec& distances, arma::vec& values) const
+  {
+    values = arma::exp(gamma * arma::square(distances));
+  }
+
   /**
    * Evaluation of the gradient of Gaussian kernel
    * given the distance between two points.
@@ -171,6 +183,8 @@ class KernelTraits<GaussianKernel>
   static const bool IsNormalized = true;
   //! The Gaussian kernel includes a squared distance.
   static const bool UsesSquaredDistance = true;
+  //! The Gaussian kernel can be evaluated on many distances at once.
+  static const bool HasBatchEvaluate = true;
 };
 
 } // namespace kernel
@@ -0,0 +1,193 @@
+/**
+ * @file kernel_matrix.hpp
+ *
+ * Functions to build the matrix of kernel evaluations between two sets of
+ * points, in blocks and in parallel.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_KERNELS_KERNEL_MATRIX_HPP
+#define MLPACK_CORE_KERNELS_KERNEL_MATRIX_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/kernels/kernel_traits.hpp>
+#include <mlpack/core/kernels/linear_kernel.hpp>
+#include <mlpack/core/kernels/polynomial_kernel.hpp>
+#include <mlpack/core/kernels/gaussian_kernel.hpp>
+#include <mlpack/core/kernels/laplacian_kernel.hpp>
+
+namespace mlpack {
+namespace kernel {
+
+/**
+ * KernelMatrixBuilder fills kernel matrices for a given kernel type.  For any
+ * kernel, the matrix is filled in square blocks of kernel evaluations, and the
+ * blocks are split between threads (if OpenMP is available), so the kernel's
+ * Evaluate() must be safe to call from several threads at once.
+ *
+ * If KernelTraits<KernelType>::HasBatchEvaluate is true, the kernel only
+ * depends on the distance between the points, so instead the distances are
+ * computed from one matrix product (see below), and the kernel's
+ * BatchEvaluate() is called on each column of distances, in parallel.
+ *
+ * The builder is specialized for kernels that only depend on inner products or
+ * distances (LinearKernel, PolynomialKernel, GaussianKernel and
+ * LaplacianKernel): those compute every inner product at once with one matrix
+ * product, which BLAS runs in parallel, and then apply the kernel function to
+ * each element in a parallel loop over the columns.  Other kernels can be given
+ * the same treatment by specializing this class.
+ */
+template<typename KernelType>
+class KernelMatrixBuilder
+{
+ public:
+  //! Set output(i, j) = K(a.col(i), b.col(j)).
+  template<typename KernelRefType>
+  static void Build(const arma::mat& a,
+                    const arma::mat& b,
+                    arma::mat& output,
+                    KernelRefType& kernel);
+
+  //! Set output(i, j) = K(data.col(i), data.col(j)), evaluating each pair of
+  //! points once.
+  template<typename KernelRefType>
+  static void Build(const arma::mat& data,
+                    arma::mat& output,
+                    KernelRefType& kernel);
+
+ private:
+  //! Fill the kernel matrix between a and b (or between data and itself if b
+  //! is NULL) in blocks of calls to Evaluate().
+  template<typename KernelRefType>
+  static void Build(const arma::mat& a,
+                    const arma::mat* b,
+                    arma::mat& output,
+                    KernelRefType& kernel,
+                    const std::false_type& /* hasBatchEvaluate */);
+
+  //! Fill the kernel matrix between a and b (or between data and itself if b
+  //! is NULL) from the matrix of distances, with BatchEvaluate().
+  template<typename KernelRefType>
+  static void Build(const arma::mat& a,
+                    const arma::mat* b,
+                    arma::mat& output,
+                    KernelRefType& kernel,
+                    const std::true_type& /* hasBatchEvaluate */);
+
+  //! Whether the kernel has BatchEvaluate().
+  typedef std::integral_constant<bool,
+      KernelTraits<KernelType>::HasBatchEvaluate> HasBatchEvaluate;
+
+  //! The number of points in each side of a block of kernel evaluations.
+  static const size_t blockSize = 64;
+};
+
+//! Kernel matrices of the linear kernel are a single matrix product.
+template<>
+class KernelMatrixBuilder<LinearKernel>
+{
+ public:
+  static void Build(const arma::mat& a,
+                    const arma::mat& b,
+                    arma::mat& output,
+                    const LinearKernel& kernel);
+
+  static void Build(const arma::mat& data,
+                    arma::mat& output,
+                    const LinearKernel& kernel);
+};
+
+//! Kernel matrices of the polynomial kernel are computed from the matrix of
+//! inner products.
+template<>
+class KernelMatrixBuilder<PolynomialKernel>
+{
+ public:
+  static void Build(const arma::mat& a,
+                    const arma::mat& b,
+                    arma::mat& output,
+                    const PolynomialKernel& kernel);
+
+  static void Build(const arma::mat& data,
+                    arma::mat& output,
+                    const PolynomialKernel& kernel);
+};
+
+//! Kernel matrices of the Gaussian kernel are computed from the squared
+//! distances, which are found with the matrix of inner products.
+template<>
+class KernelMatrixBuilder<GaussianKernel>
+{
+ public:
+  static void Build(const arma::mat& a,
+                    const arma::mat& b,
+                    arma::mat& output,
+                    const GaussianKernel& kernel);
+
+  static void Build(const arma::mat& data,
+                    arma::mat& output,
+                    const GaussianKernel& kernel);
+};
+
+//! Kernel matrices of the Laplacian kernel are computed from the distances,
+//! which are found with the matrix of inner products.
+template<>
+class KernelMatrixBuilder<LaplacianKernel>
+{
+ public:
+  static void Build(const arma::mat& a,
+                    const arma::mat& b,
+                    arma::mat& output,
+                    const LaplacianKernel& kernel);
+
+  static void Build(const arma::mat& data,
+                    arma::mat& output,
+                    const LaplacianKernel& kernel);
+};
+
+/**
+ * Build the kernel matrix between two sets of points (one per column), so that
+ * output(i, j) = K(a.col(i), b.col(j)), with KernelMatrixBuilder.
+ *
+ * @param a First set of points.
+ * @param b Second set of points.
+ * @param output Matrix to store the kernel matrix in.
+ * @param kernel Kernel to evaluate.
+ */
+template<typename KernelType>
+void KernelMatrix(const arma::mat& a,
+                  const arma::mat& b,
+                  arma::mat& output,
+                  KernelType& kernel)
+{
+  KernelMatrixBuilder<typename std::remove_const<KernelType>::type>::Build(a,
+      b, output, kernel);
+}
+
+/**
+ * Build the (symmetric) kernel matrix of a set of points (one per column), so
+ * that output(i, j) = K(data.col(i), data.col(j)), with KernelMatrixBuilder.
+ *
+ * @param data Set of points.
+ * @param output Matrix to store the kernel matrix in.
+ * @param kernel Kernel to evaluate.
+ */
+template<typename KernelType>
+void KernelMatrix(const arma::mat& data,
+                  arma::mat& output,
+                  KernelType& kernel)
+{
+  KernelMatrixBuilder<typename std::remove_const<KernelType>::type>::Build(
+      data, output, kernel);
+}
+
+} // namespace kernel
+} // namespace mlpack
+
+// Include implementation.
+#include "kernel_matrix_impl.hpp"
+
+#endif
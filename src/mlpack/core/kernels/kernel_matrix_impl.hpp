@@ -0,0 +1,290 @@
+/**
+ * @file kernel_matrix_impl.hpp
+ *
+ * Implementation of the blocked and parallel kernel matrix builders.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_KERNELS_KERNEL_MATRIX_IMPL_HPP
+#define MLPACK_CORE_KERNELS_KERNEL_MATRIX_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "kernel_matrix.hpp"
+
+namespace mlpack {
+namespace kernel {
+
+/**
+ * Compute the inner products between the columns of a and b (the columns of a
+ * with themselves if b is NULL) with one matrix product, and then replace each
+ * one with f(inner product, squared norm of a.col(i), squared norm of
+ * b.col(j)), in parallel over the columns.  The norms are only computed if
+ * useNorms is true (otherwise they are passed as 0).
+ */
+template<typename FunctionType>
+void TransformInnerProducts(const arma::mat& a,
+                            const arma::mat* b,
+                            arma::mat& output,
+                            const bool useNorms,
+                            FunctionType f)
+{
+  // The product of a matrix with its own transpose only computes half of the
+  // matrix (with syrk()).
+  if (b)
+    output = a.t() * (*b);
+  else
+    output = a.t() * a;
+
+  arma::vec aNorms, bNorms;
+  if (useNorms)
+  {
+    aNorms = arma::trans(arma::sum(arma::square(a), 0));
+    bNorms = (b == NULL) ? aNorms : arma::vec(arma::trans(arma::sum(
+        arma::square(*b), 0)));
+  }
+
+  // Each column is one simple loop, which the compiler can vectorize.
+  #pragma omp parallel for schedule(static)
+  for (omp_size_t j = 0; j < (omp_size_t) output.n_cols; ++j)
+  {
+    double* column = output.colptr(j);
+    const double bNorm = useNorms ? bNorms[j] : 0.0;
+    const double* aNorm = useNorms ? aNorms.memptr() : NULL;
+    for (size_t i = 0; i < output.n_rows; ++i)
+      column[i] = f(column[i], useNorms ? aNorm[i] : 0.0, bNorm);
+
+    // The distance of a point to itself is exactly zero; the identity
+    // ||x||^2 + ||x||^2 - 2 x^T x may round to something else.
+    if (b == NULL && useNorms)
+      column[j] = f(bNorm, bNorm, bNorm);
+  }
+}
+
+//! The squared distance between two points, from their inner product and
+//! squared norms.  Roundoff can make it slightly negative, so clamp it.
+inline double SquaredDistanceFromProduct(const double product,
+                                         const double aNorm,
+                                         const double bNorm)
+{
+  return std::max(aNorm + bNorm - 2.0 * product, 0.0);
+}
+
+template<typename KernelType>
+template<typename KernelRefType>
+void KernelMatrixBuilder<KernelType>::Build(const arma::mat& a,
+                                            const arma::mat& b,
+                                            arma::mat& output,
+                                            KernelRefType& kernel)
+{
+  Build(a, &b, output, kernel, HasBatchEvaluate());
+}
+
+template<typename KernelType>
+template<typename KernelRefType>
+void KernelMatrixBuilder<KernelType>::Build(const arma::mat& data,
+                                            arma::mat& output,
+                                            KernelRefType& kernel)
+{
+  Build(data, NULL, output, kernel, HasBatchEvaluate());
+}
+
+template<typename KernelType>
+template<typename KernelRefType>
+void KernelMatrixBuilder<KernelType>::Build(
+    const arma::mat& a,
+    const arma::mat* b,
+    arma::mat& output,
+    KernelRefType& kernel,
+    const std::false_type& /* hasBatchEvaluate */)
+{
+  if (b == NULL)
+  {
+    const arma::mat& data = a;
+    output.set_size(data.n_cols, data.n_cols);
+
+    // Only the blocks on and above the diagonal are evaluated, since the
+    // matrix is symmetric.  Block (r, c) with r <= c is number
+    // c * (c + 1) / 2 + r.
+    const size_t numBlocks = (data.n_cols + blockSize - 1) / blockSize;
+    #pragma omp parallel for schedule(dynamic)
+    for (omp_size_t block = 0; block < (omp_size_t) (numBlocks *
+        (numBlocks + 1) / 2); ++block)
+    {
+      size_t colBlock = 0;
+      while ((colBlock + 1) * (colBlock + 2) / 2 <= (size_t) block)
+        ++colBlock;
+      const size_t rowBlock = block - colBlock * (colBlock + 1) / 2;
+
+      const size_t firstRow = rowBlock * blockSize;
+      const size_t firstCol = colBlock * blockSize;
+      const size_t lastCol = std::min(firstCol + blockSize,
+          (size_t) data.n_cols);
+
+      for (size_t j = firstCol; j < lastCol; ++j)
+      {
+        const size_t lastRow = std::min(firstRow + blockSize, j + 1);
+        for (size_t i = firstRow; i < lastRow; ++i)
+          output(i, j) = kernel.Evaluate(data.unsafe_col(i),
+              data.unsafe_col(j));
+      }
+    }
+
+    // Copy to the lower triangular part of the matrix.
+    output = arma::symmatu(output);
+    return;
+  }
+
+  output.set_size(a.n_cols, b->n_cols);
+
+  // Each thread fills whole blocks, so that the points of a block stay in
+  // cache while they are used.
+  const size_t rowBlocks = (a.n_cols + blockSize - 1) / blockSize;
+  const size_t colBlocks = (b->n_cols + blockSize - 1) / blockSize;
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t block = 0; block < (omp_size_t) (rowBlocks * colBlocks);
+      ++block)
+  {
+    const size_t firstRow = (block % rowBlocks) * blockSize;
+    const size_t firstCol = (block / rowBlocks) * blockSize;
+    const size_t lastRow = std::min(firstRow + blockSize, (size_t) a.n_cols);
+    const size_t lastCol = std::min(firstCol + blockSize, (size_t) b->n_cols);
+
+    for (size_t j = firstCol; j < lastCol; ++j)
+      for (size_t i = firstRow; i < lastRow; ++i)
+        output(i, j) = kernel.Evaluate(a.unsafe_col(i), b->unsafe_col(j));
+  }
+}
+
+template<typename KernelType>
+template<typename KernelRefType>
+void KernelMatrixBuilder<KernelType>::Build(
+    const arma::mat& a,
+    const arma::mat* b,
+    arma::mat& output,
+    KernelRefType& kernel,
+    const std::true_type& /* hasBatchEvaluate */)
+{
+  TransformInnerProducts(a, b, output, true,
+      [](const double product, const double aNorm, const double bNorm)
+      {
+        return std::sqrt(SquaredDistanceFromProduct(product, aNorm, bNorm));
+      });
+
+  // Now replace each column of distances with the kernel values, in place.
+  #pragma omp parallel for schedule(static)
+  for (omp_size_t j = 0; j < (omp_size_t) output.n_cols; ++j)
+  {
+    arma::vec column(output.colptr(j), output.n_rows, false, true);
+    kernel.BatchEvaluate(column, column);
+  }
+}
+
+inline void KernelMatrixBuilder<LinearKernel>::Build(
+    const arma::mat& a,
+    const arma::mat& b,
+    arma::mat& output,
+    const LinearKernel& /* kernel */)
+{
+  output = a.t() * b;
+}
+
+inline void KernelMatrixBuilder<LinearKernel>::Build(
+    const arma::mat& data,
+    arma::mat& output,
+    const LinearKernel& /* kernel */)
+{
+  output = data.t() * data;
+}
+
+inline void KernelMatrixBuilder<PolynomialKernel>::Build(
+    const arma::mat& a,
+    const arma::mat& b,
+    arma::mat& output,
+    const PolynomialKernel& kernel)
+{
+  const double offset = kernel.Offset(), degree = kernel.Degree();
+  TransformInnerProducts(a, &b, output, false,
+      [offset, degree](const double product, const double, const double)
+      {
+        return std::pow(product + offset, degree);
+      });
+}
+
+inline void KernelMatrixBuilder<PolynomialKernel>::Build(
+    const arma::mat& data,
+    arma::mat& output,
+    const PolynomialKernel& kernel)
+{
+  const double offset = kernel.Offset(), degree = kernel.Degree();
+  TransformInnerProducts(data, NULL, output, false,
+      [offset, degree](const double product, const double, const double)
+      {
+        return std::pow(product + offset, degree);
+      });
+}
+
+inline void KernelMatrixBuilder<GaussianKernel>::Build(
+    const arma::mat& a,
+    const arma::mat& b,
+    arma::mat& output,
+    const GaussianKernel& kernel)
+{
+  const double gamma = kernel.Gamma();
+  TransformInnerProducts(a, &b, output, true,
+      [gamma](const double product, const double aNorm, const double bNorm)
+      {
+        return std::exp(gamma * SquaredDistanceFromProduct(product, aNorm,
+            bNorm));
+      });
+}
+
+inline void KernelMatrixBuilder<GaussianKernel>::Build(
+    const arma::mat& data,
+    arma::mat& output,
+    const GaussianKernel& kernel)
+{
+  const double gamma = kernel.Gamma();
+  TransformInnerProducts(data, NULL, output, true,
+      [gamma](const double product, const double aNorm, const double bNorm)
+      {
+        return std::exp(gamma * SquaredDistanceFromProduct(product, aNorm,
+            bNorm));
+      });
+}
+
+inline void KernelMatrixBuilder<LaplacianKernel>::Build(
+    const arma::mat& a,
+    const arma::mat& b,
+    arma::mat& output,
+    const LaplacianKernel& kernel)
+{
+  const double bandwidth = kernel.Bandwidth();
+  TransformInnerProducts(a, &b, output, true,
+      [bandwidth](const double product, const double aNorm, const double bNorm)
+      {
+        return std::exp(-std::sqrt(SquaredDistanceFromProduct(product, aNorm,
+            bNorm)) / bandwidth);
+      });
+}
+
+inline void KernelMatrixBuilder<LaplacianKernel>::Build(
+    const arma::mat& data,
+    arma::mat& output,
+    const LaplacianKernel& kernel)
+{
+  const double bandwidth = kernel.Bandwidth();
+  TransformInnerProducts(data, NULL, output, true,
+      [bandwidth](const double product, const double aNorm, const double bNorm)
+      {
+        return std::exp(-std::sqrt(SquaredDistanceFromProduct(product, aNorm,
+            bNorm)) / bandwidth);
+      });
+}
+
+} // namespace kernel
+} // namespace mlpack
+
+#endif
@@ -36,6 +36,13 @@ class KernelTraits
    * If true, then the kernel include a squared distance, ||x - y||^2 .
    */
   static const bool UsesSquaredDistance = false;
+
+  /**
+   * If true, then the kernel depends only on the distance between the points,
+   * and it has a BatchEvaluate(distances, values) method that evaluates the
+   * kernel for a whole vector of distances at once.
+   */
+  static const bool HasBatchEvaluate = false;
 };
 
 } // namespace kernel
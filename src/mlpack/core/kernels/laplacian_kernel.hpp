@@ -78,6 +78,18 @@ class LaplacianKernel
     return exp(-t / bandwidth);
   }
 
+  /**
+   * Evaluation of the Laplacian kernel for a whole vector of distances at
+   * once.  distances and values may be the same vector.
+   *
+   * @param distances The distances to evaluate the kernel on.
+   * @param values Vector to store K(t) for each distance t in.
+   */
+  void BatchEvaluate(const arma::vec& distances, arma::vec& values) const
+  {
+    values = arma::exp(distances * (-1.0 / bandwidth));
+  }
+
   /**
    * Evaluation of the gradient of the Laplacian kernel
    * given the distance between two points.
@@ -117,6 +129,8 @@ class KernelTraits<LaplacianKernel>
   static const bool IsNormalized = true;
   //! The Laplacian kernel doesn't include a squared distance.
   static const bool UsesSquaredDistance = false;
+  //! The Laplacian kernel can be evaluated on many distances at once.
+  static const bool HasBatchEvaluate = true;
 };
 
 } // namespace kernel
@@ -100,6 +100,20 @@ class SphericalKernel
   {
     return (t <= bandwidth) ? 1.0 : 0.0;
   }
+
+  /**
+   * Evaluate the kernel for a whole vector of distances at once.  distances
+   * and values may be the same vector.
+   *
+   * @param distances Arguments to kernel.
+   * @param values Vector to store the kernel value for each distance in.
+   */
+  void BatchEvaluate(const arma::vec& distances, arma::vec& values) const
+  {
+    values.set_size(distances.n_elem);
+    for (size_t i = 0; i < distances.n_elem; ++i)
+      values[i] = (distances[i] <= bandwidth) ? 1.0 : 0.0;
+  }
   double Gradient(double t)
   {
     return t == bandwidth ? arma::datum::nan : 0.0;
@@ -127,6 +141,8 @@ class KernelTraits<SphericalKernel>
   static const bool IsNormalized = true;
   //! The spherical kernel doesn't include a squared distance.
   static const bool UsesSquaredDistance = false;
+  //! The spherical kernel can be evaluated on many distances at once.
+  static const bool HasBatchEvaluate = true;
 };
 
 } // namespace kernel
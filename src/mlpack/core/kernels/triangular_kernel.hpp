@@ -60,7 +60,19 @@ class TriangularKernel
    */
   double Evaluate(const double distance) const
   {
-    return std::max(0.0, (1 - distance) / bandwidth);
+    return std::max(0.0, 1 - distance / bandwidth);
+  }
+
+  /**
+   * Evaluate the triangular kernel for a whole vector of distances at once.
+   * distances and values may be the same vector.
+   *
+   * @param distances The distances to evaluate the kernel on.
+   * @param values Vector to store the kernel value for each distance in.
+   */
+  void BatchEvaluate(const arma::vec& distances, arma::vec& values) const
+  {
+    values = arma::clamp(1.0 - distances / bandwidth, 0.0, arma::datum::inf);
   }
 
   /**
@@ -112,6 +124,8 @@ class KernelTraits<TriangularKernel>
   static const bool IsNormalized = true;
   //! The triangular kernel doesn't include a squared distance.
   static const bool UsesSquaredDistance = false;
+  //! The triangular kernel can be evaluated on many distances at once.
+  static const bool HasBatchEvaluate = true;
 };
 
 } // namespace kernel
@@ -303,3 +303,79 @@ void mlpack::math::SymKronId(const arma::mat& A, arma::mat& op)
     }
   }
 }
+
+/**
+ * Compute x^T * y for a sparse matrix x, in parallel over the columns of x.
+ */
+void mlpack::math::SparseTransposeMultiply(const arma::sp_mat& x,
+                                           const arma::mat& y,
+                                           arma::mat& output)
+{
+  if (y.n_rows != x.n_rows)
+  {
+    std::ostringstream oss;
+    oss << "SparseTransposeMultiply(): y has " << y.n_rows << " rows, but x "
+        << "has " << x.n_rows << " rows";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // Each column of x gives a column of (x^T y)^T, so compute the transposed
+  // product, which threads can write a column at a time.
+  const arma::mat yt = y.t();
+  arma::mat outputT(y.n_cols, x.n_cols, arma::fill::zeros);
+
+  #pragma omp parallel for schedule(dynamic, 256)
+  for (omp_size_t j = 0; j < (omp_size_t) x.n_cols; ++j)
+  {
+    double* column = outputT.colptr(j);
+    arma::sp_mat::const_iterator it = x.begin_col(j);
+    for (; it != x.end_col(j); ++it)
+    {
+      const double value = *it;
+      const double* row = yt.colptr(it.row());
+      for (size_t k = 0; k < yt.n_rows; ++k)
+        column[k] += value * row[k];
+    }
+  }
+
+  output = outputT.t();
+}
+
+/**
+ * Orthonormalize the columns of x in-place with Cholesky QR.
+ */
+void mlpack::math::OrthonormalizeColumns(arma::mat& x)
+{
+  if (x.n_cols == 0)
+    return;
+
+  // One pass of Cholesky QR loses orthogonality in proportion to the square of
+  // the condition number of x; the second pass, on the nearly orthonormal
+  // result of the first, restores it.
+  for (size_t pass = 0; pass < 2; ++pass)
+  {
+    // Cholesky QR is stable if the condition number of x is below about 1e8,
+    // which the diagonal of R estimates.
+    arma::mat r;
+    if (!arma::chol(r, x.t() * x) || arma::min(arma::abs(r.diag())) <
+        1e-7 * arma::max(arma::abs(r.diag())))
+    {
+      // Keep the shape of x: if it has more columns than rows, the extra
+      // columns are zero.
+      arma::mat q;
+      arma::qr_econ(q, r, x);
+      if (q.n_cols == x.n_cols)
+      {
+        x = std::move(q);
+      }
+      else
+      {
+        x.zeros();
+        x.cols(0, q.n_cols - 1) = q;
+      }
+      return;
+    }
+
+    x = x * arma::inv(arma::trimatu(r));
+  }
+}
@@ -124,6 +124,32 @@ inline size_t SvecIndex(size_t i, size_t j, size_t n);
  */
 void SymKronId(const arma::mat& A, arma::mat& op);
 
+/**
+ * Compute x^T * y for a sparse matrix x and a dense matrix y, in parallel over
+ * the columns of x (if OpenMP is available); Armadillo computes sparse-dense
+ * products with a single thread.  To compute x * y, pass a transposed copy of
+ * x.
+ *
+ * @param x Sparse matrix.
+ * @param y Dense matrix with x.n_rows rows.
+ * @param output Matrix to store x^T * y in.
+ */
+void SparseTransposeMultiply(const arma::sp_mat& x,
+                             const arma::mat& y,
+                             arma::mat& output);
+
+/**
+ * Replace the columns of x with an orthonormal basis of their span, using two
+ * passes of Cholesky QR: each pass computes the Cholesky factor R of x^T x and
+ * sets x = x R^{-1}, so a tall x is only touched by matrix products (which
+ * BLAS runs in parallel).  If x is too ill-conditioned for the Cholesky
+ * factorization, the Householder QR decomposition is used instead (and if x
+ * has more columns than rows, its extra columns are set to zero).
+ *
+ * @param x Matrix to orthonormalize in-place.
+ */
+void OrthonormalizeColumns(arma::mat& x);
+
 /**
  * Signum function.
  * Return 1 if x>0; return 0 if x=0; return -1 if x<0.
@@ -0,0 +1,159 @@
+/**
+ * @file philox.hpp
+ *
+ * The Philox4x32-10 counter-based random number generator, which gives any
+ * number of independent, reproducible streams of random numbers.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_MATH_PHILOX_HPP
+#define MLPACK_CORE_MATH_PHILOX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace mlpack {
+namespace math {
+
+/**
+ * Evaluate the Philox4x32-10 function: ten rounds of multiplications and key
+ * additions on the given counter, which is replaced by the result.  Every
+ * different counter and key gives four independent 32-bit random numbers.
+ *
+ * For more information, see the following.
+ *
+ * @code
+ * @inproceedings{Salmon2011,
+ *   author    = {Salmon, John K. and Moraes, Mark A. and Dror, Ron O. and
+ *                Shaw, David E.},
+ *   title     = {Parallel Random Numbers: As Easy As 1, 2, 3},
+ *   booktitle = {Proceedings of the International Conference for High
+ *                Performance Computing, Networking, Storage and Analysis},
+ *   year      = {2011}
+ * }
+ * @endcode
+ *
+ * @param counter Counter to evaluate; replaced by the random numbers.
+ * @param key Key of the function.
+ */
+inline void Philox4x32(uint32_t counter[4], const uint32_t key[2])
+{
+  uint32_t k0 = key[0], k1 = key[1];
+  for (size_t round = 0; round < 10; ++round)
+  {
+    const uint64_t p0 = (uint64_t) 0xD2511F53 * counter[0];
+    const uint64_t p1 = (uint64_t) 0xCD9E8D57 * counter[2];
+
+    const uint32_t c0 = (uint32_t) (p1 >> 32) ^ counter[1] ^ k0;
+    const uint32_t c1 = (uint32_t) p1;
+    const uint32_t c2 = (uint32_t) (p0 >> 32) ^ counter[3] ^ k1;
+    const uint32_t c3 = (uint32_t) p0;
+    counter[0] = c0;
+    counter[1] = c1;
+    counter[2] = c2;
+    counter[3] = c3;
+
+    k0 += 0x9E3779B9;
+    k1 += 0xBB67AE85;
+  }
+}
+
+/**
+ * A random number generator (satisfying the UniformRandomBitGenerator
+ * requirements of the standard library, so it can be used with the
+ * distributions of <random> and std::shuffle()) that draws the stream of
+ * Philox4x32-10 numbers for a given seed and stream index.  There is no
+ * sequential state besides the position in the stream, so seeding is free,
+ * and each of the 2^64 streams of a seed is independent of the others: giving
+ * each thread (or each task, like each query point) its own stream makes
+ * parallel code reproducible.
+ */
+class PhiloxEngine
+{
+ public:
+  //! The type of the generated numbers.
+  typedef uint32_t result_type;
+
+  /**
+   * Create the generator for the given seed and stream.
+   *
+   * @param seed Seed of the generator.
+   * @param stream Index of the stream to draw.
+   */
+  PhiloxEngine(const uint64_t seed = 0, const uint64_t stream = 0)
+  {
+    Seed(seed, stream);
+  }
+
+  /**
+   * Restart the generator at the beginning of the given stream of the given
+   * seed.
+   *
+   * @param seed Seed of the generator.
+   * @param stream Index of the stream to draw.
+   */
+  void Seed(const uint64_t seed, const uint64_t stream = 0)
+  {
+    key[0] = (uint32_t) seed;
+    key[1] = (uint32_t) (seed >> 32);
+    this->stream[0] = (uint32_t) stream;
+    this->stream[1] = (uint32_t) (stream >> 32);
+    position = 0;
+  }
+
+  //! Draw the next random number.
+  result_type operator()()
+  {
+    const size_t index = position & 3;
+    if (index == 0)
+      Fill(position >> 2);
+
+    ++position;
+    return buffer[index];
+  }
+
+  //! Skip the given number of random numbers.
+  void discard(const uint64_t count)
+  {
+    position += count;
+    if ((position & 3) != 0)
+      Fill(position >> 2);
+  }
+
+  //! Get the smallest number that can be generated.
+  static constexpr result_type min() { return 0; }
+  //! Get the largest number that can be generated.
+  static constexpr result_type max()
+  {
+    return std::numeric_limits<result_type>::max();
+  }
+
+ private:
+  //! The key, which is the seed.
+  uint32_t key[2];
+  //! The stream index, which is the upper half of each counter.
+  uint32_t stream[2];
+  //! The index of the next number in the stream.
+  uint64_t position;
+  //! The numbers of the current block.
+  uint32_t buffer[4];
+
+  //! Compute the numbers of the given block of the stream.
+  void Fill(const uint64_t block)
+  {
+    buffer[0] = (uint32_t) block;
+    buffer[1] = (uint32_t) (block >> 32);
+    buffer[2] = stream[0];
+    buffer[3] = stream[1];
+    Philox4x32(buffer, key);
+  }
+};
+
+} // namespace math
+} // namespace mlpack
+
+#endif
@@ -8,6 +8,8 @@
  * 3-clause BSD license along with mlpack.  If not, see
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
+#include <cstddef>
+#include <cstdint>
 #include <random>
 #include <mlpack/mlpack_export.hpp>
 
@@ -20,6 +22,10 @@ MLPACK_EXPORT std::mt19937 randGen;
 MLPACK_EXPORT std::uniform_real_distribution<> randUniformDist(0.0, 1.0);
 // Global normal distribution.
 MLPACK_EXPORT std::normal_distribution<> randNormalDist(0.0, 1.0);
+// Seed of the random streams of the threads of parallel regions.
+MLPACK_EXPORT uint64_t randStreamSeed = 0;
+// Number of times the seed has been set.
+MLPACK_EXPORT size_t randStreamGeneration = 0;
 
 } // namespace math
 } // namespace mlpack
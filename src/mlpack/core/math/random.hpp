@@ -14,6 +14,11 @@
 #include <mlpack/prereqs.hpp>
 #include <mlpack/mlpack_export.hpp>
 #include <random>
+#include "philox.hpp"
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
 
 namespace mlpack {
 namespace math /** Miscellaneous math routines. */ {
@@ -29,11 +34,83 @@ extern MLPACK_EXPORT std::mt19937 randGen;
 extern MLPACK_EXPORT std::uniform_real_distribution<> randUniformDist;
 // Global normal distribution.
 extern MLPACK_EXPORT std::normal_distribution<> randNormalDist;
+// Seed of the random streams of the threads of parallel regions.
+extern MLPACK_EXPORT uint64_t randStreamSeed;
+// Number of times the seed has been set, so threads know to restart streams.
+extern MLPACK_EXPORT size_t randStreamGeneration;
+
+/**
+ * The random number generator of a thread in an OpenMP parallel region, with
+ * the normal distribution that draws from it.
+ */
+struct ThreadRandState
+{
+  //! The stream of the thread.
+  PhiloxEngine generator;
+  //! The normal distribution of the thread.
+  std::normal_distribution<> normalDist;
+  //! The value of randStreamGeneration the stream was started for.
+  size_t generation = size_t(-1);
+};
+
+/**
+ * Get the random number generator state of the calling thread.  The first time
+ * a thread uses it after the seed is set, the stream is started at the
+ * beginning of the stream for the seed and the index of the thread in its
+ * OpenMP team, so the random numbers drawn in parallel regions are
+ * reproducible for a given seed and number of threads (with static
+ * scheduling, since otherwise the work a thread gets can change between runs).
+ */
+inline ThreadRandState& ThreadRand()
+{
+  static thread_local ThreadRandState state;
+  if (state.generation != randStreamGeneration)
+  {
+    #ifdef HAS_OPENMP
+    const size_t thread = omp_get_thread_num();
+    #else
+    const size_t thread = 0;
+    #endif
+
+    state.generator.Seed(randStreamSeed, thread);
+    state.normalDist.reset();
+    state.generation = randStreamGeneration;
+  }
+
+  return state;
+}
+
+/**
+ * Get the random number generator of the calling thread, to use with the
+ * distributions of <random> (or std::shuffle()) in parallel code.  See
+ * ThreadRand().
+ */
+inline PhiloxEngine& ThreadRandGen() { return ThreadRand().generator; }
+
+/**
+ * Return whether the random functions below (Random(), RandInt(), and so on)
+ * should draw from the stream of the calling thread instead of the global
+ * random number generator, which is the case in OpenMP parallel regions.
+ * Outside of parallel regions, the global generator is used, so serial code
+ * gives the same results as before.
+ */
+inline bool UseThreadRand()
+{
+  #ifdef HAS_OPENMP
+  return omp_in_parallel();
+  #else
+  return false;
+  #endif
+}
 
 /**
  * Set the random seed used by the random functions (Random() and RandInt()).
  * The seed is casted to a 32-bit integer before being given to the random
  * number generator, but a size_t is taken as a parameter for API consistency.
+ * The random streams of the threads of parallel regions are restarted with
+ * the seed too.  The generators are shared by all threads, so bindings that run
+ * programs on several threads at once hold a CLI::RandomScope while a program
+ * that seeds runs.
  *
  * @param seed Seed for the random number generator.
  */
@@ -43,6 +120,8 @@ inline void RandomSeed(const size_t seed)
     randGen.seed((uint32_t) seed);
     srand((unsigned int) seed);
     arma::arma_rng::set_seed(seed);
+    randStreamSeed = seed;
+    ++randStreamGeneration;
   #else
     (void) seed;
   #endif
@@ -62,6 +141,8 @@ inline void FixedRandomSeed()
   randGen.seed((uint32_t) seed);
   srand((unsigned int) seed);
   arma::arma_rng::set_seed(seed);
+  randStreamSeed = seed;
+  ++randStreamGeneration;
 }
 #endif
 
@@ -70,6 +151,9 @@ inline void FixedRandomSeed()
  */
 inline double Random()
 {
+  if (UseThreadRand())
+    return std::uniform_real_distribution<>()(ThreadRandGen());
+
   return randUniformDist(randGen);
 }
 
@@ -78,7 +162,7 @@ inline double Random()
  */
 inline double Random(const double lo, const double hi)
 {
-  return lo + (hi - lo) * randUniformDist(randGen);
+  return lo + (hi - lo) * Random();
 }
 
 /**
@@ -97,7 +181,7 @@ inline double RandBernoulli(const double input)
  */
 inline int RandInt(const int hiExclusive)
 {
-  return (int) std::floor((double) hiExclusive * randUniformDist(randGen));
+  return (int) std::floor((double) hiExclusive * Random());
 }
 
 /**
@@ -105,8 +189,7 @@ inline int RandInt(const int hiExclusive)
  */
 inline int RandInt(const int lo, const int hiExclusive)
 {
-  return lo + (int) std::floor((double) (hiExclusive - lo)
-                               * randUniformDist(randGen));
+  return lo + (int) std::floor((double) (hiExclusive - lo) * Random());
 }
 
 /**
@@ -114,6 +197,12 @@ inline int RandInt(const int lo, const int hiExclusive)
  */
 inline double RandNormal()
 {
+  if (UseThreadRand())
+  {
+    ThreadRandState& state = ThreadRand();
+    return state.normalDist(state.generator);
+  }
+
   return randNormalDist(randGen);
 }
 
@@ -126,7 +215,7 @@ inline double RandNormal()
  */
 inline double RandNormal(const double mean, const double variance)
 {
-  return variance * randNormalDist(randGen) + mean;
+  return variance * RandNormal() + mean;
 }
 
 /**
@@ -167,6 +256,49 @@ inline void ObtainDistinctSamples(const size_t loInclusive,
   }
 }
 
+/**
+ * Obtains no more than maxNumSamples distinct samples, like the other overload,
+ * but draws them from the given random number generator instead of the global
+ * one.  This allows each thread to use its own random number generator.
+ *
+ * @param loInclusive The lower bound (inclusive).
+ * @param hiExclusive The high bound (exclusive).
+ * @param maxNumSamples The maximum number of samples to obtain.
+ * @param distinctSamples The samples that will be obtained.
+ * @param generator The random number generator to use.
+ */
+template<typename GeneratorType>
+inline void ObtainDistinctSamples(const size_t loInclusive,
+                                  const size_t hiExclusive,
+                                  const size_t maxNumSamples,
+                                  arma::uvec& distinctSamples,
+                                  GeneratorType& generator)
+{
+  const size_t samplesRangeSize = hiExclusive - loInclusive;
+
+  if (samplesRangeSize > maxNumSamples)
+  {
+    std::uniform_int_distribution<size_t> dist(0, samplesRangeSize - 1);
+    arma::Col<size_t> samples;
+
+    samples.zeros(samplesRangeSize);
+
+    for (size_t i = 0; i < maxNumSamples; i++)
+      samples[dist(generator)]++;
+
+    distinctSamples = arma::find(samples > 0);
+
+    if (loInclusive > 0)
+      distinctSamples += loInclusive;
+  }
+  else
+  {
+    distinctSamples.set_size(samplesRangeSize);
+    for (size_t i = 0; i < samplesRangeSize; i++)
+      distinctSamples[i] = loInclusive + i;
+  }
+}
+
 } // namespace math
 } // namespace mlpack
 
@@ -0,0 +1,199 @@
+/**
+ * @file running_moments.hpp
+ *
+ * RunningMoments accumulates the mean, the minimum and maximum, and the sums
+ * of the second to fourth powers of the deviations from the mean of each
+ * dimension of a stream of points, in one pass.  Accumulators of disjoint sets
+ * of points can be merged, so the points can be split between threads or
+ * read in chunks.
+ *
+ * The merge formulas are those of
+ *
+ * @techreport{pebay2008formulas,
+ *   title={Formulas for Robust, One-Pass Parallel Computation of Covariances
+ *       and Arbitrary-Order Statistical Moments},
+ *   author={P{\'e}bay, Philippe},
+ *   institution={Sandia National Laboratories},
+ *   number={SAND2008-6212},
+ *   year={2008}
+ * }
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_MATH_RUNNING_MOMENTS_HPP
+#define MLPACK_CORE_MATH_RUNNING_MOMENTS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <sstream>
+
+namespace mlpack {
+namespace math {
+
+/**
+ * RunningMoments holds the number of points, and the mean, minimum, maximum,
+ * and sums of the second, third and fourth powers of the deviations from the
+ * mean (M2, M3 and M4) of each dimension of the points added so far.  Points
+ * are added in blocks: the moments of each block are computed around the mean
+ * of the block (which is accurate, since the block is in memory), and then
+ * merged into the running moments.  The blocks of the points given to Add()
+ * are handled in parallel.
+ *
+ * @code
+ * data::StreamReader reader("huge_dataset.csv");
+ * math::RunningMoments moments;
+ * arma::mat chunk;
+ * while (reader.Next(chunk))
+ *   moments.Add(chunk);
+ * arma::vec variance = moments.Variance();
+ * @endcode
+ */
+class RunningMoments
+{
+ public:
+  //! The number of points in each block that Add() handles on one thread.
+  static constexpr size_t BlockSize = 4096;
+
+  /**
+   * Create an accumulator with no points.  The dimensionality is set by the
+   * first points that are added.
+   */
+  RunningMoments() : count(0) { }
+
+  /**
+   * Add the given points (one per column).  They must have the dimensionality
+   * of the points added before.
+   *
+   * @param points Points to add.
+   */
+  void Add(const arma::mat& points)
+  {
+    if (points.n_cols == 0)
+      return;
+
+    const size_t numBlocks = (points.n_cols + BlockSize - 1) / BlockSize;
+    std::vector<RunningMoments> blocks(numBlocks);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+    {
+      const size_t begin = b * BlockSize;
+      const size_t end = std::min(begin + BlockSize, (size_t) points.n_cols);
+      blocks[b].SetBlock(points.cols(begin, end - 1));
+    }
+
+    // The blocks are merged in order, so the results don't depend on the
+    // number of threads.
+    for (size_t b = 0; b < numBlocks; ++b)
+      Merge(blocks[b]);
+  }
+
+  /**
+   * Merge the moments of another (disjoint) set of points into these.
+   *
+   * @param other Moments of the other points.
+   */
+  void Merge(const RunningMoments& other)
+  {
+    if (other.count == 0)
+      return;
+    if (count == 0)
+    {
+      *this = other;
+      return;
+    }
+
+    if (other.mean.n_elem != mean.n_elem)
+    {
+      std::ostringstream oss;
+      oss << "RunningMoments::Merge(): dimensionality of the points ("
+          << other.mean.n_elem << ") is not the dimensionality of the points "
+          << "added before (" << mean.n_elem << ")!";
+      throw std::invalid_argument(oss.str());
+    }
+
+    const double nA = count;
+    const double nB = other.count;
+    const double n = nA + nB;
+    const arma::vec delta = other.mean - mean;
+    const arma::vec delta2 = arma::square(delta);
+
+    // M4 and M3 depend on the lower moments before the merge.
+    m4 += other.m4 + arma::square(delta2) * (nA * nB * (nA * nA - nA * nB +
+        nB * nB) / (n * n * n)) + 6.0 * delta2 % (nA * nA * other.m2 +
+        nB * nB * m2) / (n * n) + 4.0 * delta % (nA * other.m3 - nB * m3) / n;
+    m3 += other.m3 + delta2 % delta * (nA * nB * (nA - nB) / (n * n)) +
+        3.0 * delta % (nA * other.m2 - nB * m2) / n;
+    m2 += other.m2 + delta2 * (nA * nB / n);
+    mean += delta * (nB / n);
+    minimum = arma::min(minimum, other.minimum);
+    maximum = arma::max(maximum, other.maximum);
+    count += other.count;
+  }
+
+  /**
+   * Get the variance of each dimension.
+   *
+   * @param population If true, the points are the whole population;
+   *     otherwise they are a sample.
+   */
+  arma::vec Variance(const bool population = false) const
+  {
+    return m2 / (population ? (double) count : (double) count - 1);
+  }
+
+  //! Get the number of points.
+  size_t Count() const { return count; }
+  //! Get the mean of each dimension.
+  const arma::vec& Mean() const { return mean; }
+  //! Get the minimum of each dimension.
+  const arma::vec& Min() const { return minimum; }
+  //! Get the maximum of each dimension.
+  const arma::vec& Max() const { return maximum; }
+  //! Get the sum of the squared deviations from the mean of each dimension.
+  const arma::vec& M2() const { return m2; }
+  //! Get the sum of the cubed deviations from the mean of each dimension.
+  const arma::vec& M3() const { return m3; }
+  //! Get the sum of the fourth powers of the deviations from the mean of each
+  //! dimension.
+  const arma::vec& M4() const { return m4; }
+
+ private:
+  //! Set the moments to those of the given block of points.
+  void SetBlock(const arma::mat& block)
+  {
+    count = block.n_cols;
+    mean = arma::mean(block, 1);
+    minimum = arma::min(block, 1);
+    maximum = arma::max(block, 1);
+
+    const arma::mat deviations = block.each_col() - mean;
+    const arma::mat squares = arma::square(deviations);
+    m2 = arma::sum(squares, 1);
+    m3 = arma::sum(squares % deviations, 1);
+    m4 = arma::sum(arma::square(squares), 1);
+  }
+
+  //! The number of points.
+  size_t count;
+  //! The mean of each dimension.
+  arma::vec mean;
+  //! The minimum of each dimension.
+  arma::vec minimum;
+  //! The maximum of each dimension.
+  arma::vec maximum;
+  //! The sum of the squared deviations of each dimension.
+  arma::vec m2;
+  //! The sum of the cubed deviations of each dimension.
+  arma::vec m3;
+  //! The sum of the fourth powers of the deviations of each dimension.
+  arma::vec m4;
+};
+
+} // namespace math
+} // namespace mlpack
+
+#endif
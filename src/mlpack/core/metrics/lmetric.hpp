@@ -83,6 +83,29 @@ class LMetric
   static typename VecTypeA::elem_type Evaluate(const VecTypeA& a,
                                                const VecTypeB& b);
 
+  /**
+   * Computes the distances between every column of a and every column of b at
+   * once, so that distances(i, j) is the distance between a.col(i) and
+   * b.col(j).  Both matrices must be dense.  For the L2 metric (with or without
+   * the root), the identity ||x - y||^2 = ||x||^2 + ||y||^2 - 2 x^T y is used,
+   * so that nearly all of the work is a single matrix multiplication, which
+   * the BLAS performs with SIMD instructions.  This is much faster than
+   * calling Evaluate() for each pair, but the result may differ from
+   * Evaluate() by rounding error.  For other powers, Evaluate() is called for
+   * each pair.
+   *
+   * @param a First set of points.
+   * @param b Second set of points.
+   * @param distances Matrix to store the distances in.
+   * @return A bound on the absolute difference between any of the computed
+   *     distances and the result of Evaluate() for the same pair.
+   */
+  template<typename MatTypeA, typename MatTypeB>
+  static typename MatTypeA::elem_type EvaluateBlock(
+      const MatTypeA& a,
+      const MatTypeB& b,
+      arma::Mat<typename MatTypeA::elem_type>& distances);
+
   //! Serialize the metric (nothing to do).
   template<typename Archive>
   void serialize(Archive& /* ar */, const unsigned int /* version */) { }
@@ -116,6 +139,38 @@ typedef LMetric<2, true> EuclideanDistance;
  */
 typedef LMetric<INT_MAX, false> ChebyshevDistance;
 
+/**
+ * An L_p metric for points whose dimensionality is fixed at compile time.  It
+ * gives the same distances as LMetric<TPower, TTakeRoot>, but Evaluate() is a
+ * loop over exactly Dim elements, which the compiler unrolls and vectorizes,
+ * instead of a general Armadillo expression.  This is meant for
+ * low-dimensional dense data, together with FixedHRectBound; see
+ * tree::FixedDimension, which selects these types from the dimensionality of a
+ * dataset.
+ *
+ * The points given to Evaluate() must have Dim elements.
+ *
+ * @tparam Dim Dimensionality of the points.
+ * @tparam TPower Power of metric.
+ * @tparam TTakeRoot If true, the Power'th root of the result is taken before
+ *    it is returned.
+ */
+template<size_t Dim, int TPower, bool TTakeRoot = true>
+class FixedLMetric : public LMetric<TPower, TTakeRoot>
+{
+ public:
+  /**
+   * Computes the distance between two points of dimensionality Dim.
+   *
+   * @param a First vector.
+   * @param b Second vector.
+   * @return Distance between vectors a and b.
+   */
+  template<typename VecTypeA, typename VecTypeB>
+  static typename VecTypeA::elem_type Evaluate(const VecTypeA& a,
+                                               const VecTypeB& b);
+};
+
 
 } // namespace metric
 } // namespace mlpack
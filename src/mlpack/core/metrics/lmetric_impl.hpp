@@ -106,6 +106,102 @@ typename VecTypeA::elem_type LMetric<INT_MAX, false>::Evaluate(
   return arma::as_scalar(arma::max(arma::abs(a - b)));
 }
 
+// Unspecialized block implementation: evaluate each pair separately.
+template<int Power, bool TakeRoot>
+template<typename MatTypeA, typename MatTypeB>
+typename MatTypeA::elem_type LMetric<Power, TakeRoot>::EvaluateBlock(
+    const MatTypeA& a,
+    const MatTypeB& b,
+    arma::Mat<typename MatTypeA::elem_type>& distances)
+{
+  distances.set_size(a.n_cols, b.n_cols);
+  for (size_t j = 0; j < b.n_cols; ++j)
+    for (size_t i = 0; i < a.n_cols; ++i)
+      distances(i, j) = Evaluate(a.col(i), b.col(j));
+
+  return 0;
+}
+
+// Squared L2 block specialization, using one matrix multiplication.
+template<>
+template<typename MatTypeA, typename MatTypeB>
+typename MatTypeA::elem_type LMetric<2, false>::EvaluateBlock(
+    const MatTypeA& a,
+    const MatTypeB& b,
+    arma::Mat<typename MatTypeA::elem_type>& distances)
+{
+  typedef typename MatTypeA::elem_type ElemType;
+
+  const arma::Col<ElemType> aNorms = arma::sum(arma::square(a), 0).t();
+  const arma::Row<ElemType> bNorms = arma::sum(arma::square(b), 0);
+
+  distances = -2 * (a.t() * b);
+  distances.each_col() += aNorms;
+  distances.each_row() += bNorms;
+
+  // Cancellation may give (slightly) negative results for very close points.
+  distances.transform([](const ElemType d) { return (d < 0) ? 0 : d; });
+
+  // Each dot product and norm has an absolute error of at most
+  // (n + 2) u ||x|| ||y||, where n is the dimensionality and u is the unit
+  // roundoff, and Evaluate() is at least as accurate; so this bound holds with
+  // some margin.
+  if (a.n_cols == 0 || b.n_cols == 0)
+    return 0;
+
+  return 4 * (a.n_rows + 4) * std::numeric_limits<ElemType>::epsilon() *
+      (aNorms.max() + bNorms.max());
+}
+
+// L2 block specialization: the root of the squared L2 block.
+template<>
+template<typename MatTypeA, typename MatTypeB>
+typename MatTypeA::elem_type LMetric<2, true>::EvaluateBlock(
+    const MatTypeA& a,
+    const MatTypeB& b,
+    arma::Mat<typename MatTypeA::elem_type>& distances)
+{
+  // Since |sqrt(x) - sqrt(y)| <= sqrt(|x - y|), the error bound is the root of
+  // the error bound of the squared distances.
+  const typename MatTypeA::elem_type squaredError =
+      LMetric<2, false>::EvaluateBlock(a, b, distances);
+  distances = arma::sqrt(distances);
+
+  return std::sqrt(squaredError);
+}
+
+// Fixed-dimensionality implementation.  The branches on the power are resolved
+// at compile time.
+template<size_t Dim, int TPower, bool TTakeRoot>
+template<typename VecTypeA, typename VecTypeB>
+inline typename VecTypeA::elem_type FixedLMetric<Dim, TPower, TTakeRoot>::
+Evaluate(const VecTypeA& a, const VecTypeB& b)
+{
+  typedef typename VecTypeA::elem_type ElemType;
+  Log::Assert(a.n_elem == Dim && b.n_elem == Dim);
+
+  ElemType result = 0;
+  for (size_t d = 0; d < Dim; ++d)
+  {
+    const ElemType distance = std::abs(a[d] - b[d]);
+    if (TPower == INT_MAX)
+      result = std::max(result, distance);
+    else if (TPower == 1)
+      result += distance;
+    else if (TPower == 2)
+      result += distance * distance;
+    else
+      result += std::pow(distance, (ElemType) TPower);
+  }
+
+  if (!TTakeRoot || TPower == 1 || TPower == INT_MAX)
+    return result;
+  else if (TPower == 2)
+    return std::sqrt(result);
+  else
+    return std::pow(result, (ElemType) (1.0 / TPower));
+}
+
 } // namespace metric
 } // namespace mlpack
 
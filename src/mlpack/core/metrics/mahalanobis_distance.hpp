@@ -37,10 +37,21 @@ namespace metric {
  *
  * If you wish to use the KNN class or other tree-based algorithms with this
  * distance, it is recommended to instead stretch the dataset first, by
- * decomposing Q = L^T L (perhaps via a Cholesky decomposition), and then
- * multiply the data by L.  If you still wish to use the KNN class with a custom
- * distance anyway, you will need to use a different tree type than the default
- * KDTree, which only works with the LMetric class.
+ * decomposing Q = L^T L and then multiplying the data by L; Whiten() does
+ * this, and the search can then use the Euclidean distance with the default
+ * KDTree:
+ *
+ * @code
+ * MahalanobisDistance<> d(q);
+ * arma::mat whitening = d.Whitening();
+ * KNN knn(whitening * referenceSet);
+ * knn.Search(whitening * querySet, k, neighbors, distances);
+ * @endcode
+ *
+ * The distances found are then exactly the Mahalanobis distances.  If you still
+ * wish to use the KNN class with this distance anyway, you will need to use a
+ * different tree type than the default KDTree, which only works with the
+ * LMetric class.
  *
  * Similar to the LMetric class, this offers a template parameter TakeRoot
  * which, when set to false, will instead evaluate the distance
@@ -96,6 +107,32 @@ class MahalanobisDistance
   template<typename VecTypeA, typename VecTypeB>
   double Evaluate(const VecTypeA& a, const VecTypeB& b);
 
+  /**
+   * Compute the whitening transform L of the covariance matrix, with
+   * Q = L^T L, so that the Euclidean distance between L x and L y is the
+   * Mahalanobis distance between x and y.  This is the Cholesky factor of Q if
+   * Q is positive definite; otherwise (for instance, if Q is a low-rank
+   * distance learned by LMNN or NCA), L is computed from the eigendecomposition
+   * of Q and has one row for each positive eigenvalue.  Only the symmetric part
+   * of Q affects the distance, so that is what is factorized.
+   *
+   * The factorization takes O(d^3) time, so when transforming several datasets,
+   * compute this once and multiply each dataset by it.
+   *
+   * @return The whitening transform.
+   */
+  arma::mat Whitening() const;
+
+  /**
+   * Transform the given points (one per column) by the whitening transform
+   * Whitening(), so that the Euclidean distances between them are the
+   * Mahalanobis distances between the original points.
+   *
+   * @param points Points to transform.
+   */
+  template<typename MatType>
+  void Whiten(MatType& points) const { points = Whitening() * points; }
+
   /**
    * Access the covariance matrix.
    *
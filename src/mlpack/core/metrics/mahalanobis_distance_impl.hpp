@@ -26,8 +26,7 @@ double MahalanobisDistance<false>::Evaluate(const VecTypeA& a,
                                             const VecTypeB& b)
 {
   arma::vec m = (a - b);
-  arma::mat out = trans(m) * covariance * m; // 1x1
-  return out[0];
+  return arma::dot(m, covariance * m);
 }
 /**
  * Specialization for rooted case.  This requires one extra evaluation of
@@ -43,8 +42,37 @@ double MahalanobisDistance<true>::Evaluate(const VecTypeA& a,
     covariance = arma::eye<arma::mat>(a.n_elem, a.n_elem);
 
   arma::vec m = (a - b);
-  arma::mat out = trans(m) * covariance * m; // 1x1;
-  return sqrt(out[0]);
+  return sqrt(arma::dot(m, covariance * m));
+}
+
+template<bool TakeRoot>
+arma::mat MahalanobisDistance<TakeRoot>::Whitening() const
+{
+  const arma::mat q = 0.5 * (covariance + trans(covariance));
+
+  // For a positive definite matrix, the Cholesky factor is upper triangular
+  // and cheap to compute.
+  arma::mat whitening;
+  if (arma::chol(whitening, q))
+    return whitening;
+
+  // Otherwise, Q = V diag(lambda) V^T, so L = diag(sqrt(lambda)) V^T, where
+  // negative and zero eigenvalues (which can only come from roundoff, for a
+  // valid distance) are dropped.
+  arma::vec eigenvalues;
+  arma::mat eigenvectors;
+  if (!arma::eig_sym(eigenvalues, eigenvectors, q))
+  {
+    Log::Fatal << "MahalanobisDistance::Whitening(): eigendecomposition of "
+        << "the covariance matrix failed!" << std::endl;
+  }
+
+  const double tolerance = q.n_rows * arma::datum::eps *
+      std::max(arma::max(arma::abs(eigenvalues)), 1.0);
+  const arma::uvec positive = arma::find(eigenvalues > tolerance);
+  whitening = arma::diagmat(arma::sqrt(eigenvalues.elem(positive))) *
+      trans(eigenvectors.cols(positive));
+  return whitening;
 }
 
 // Serialize the Mahalanobis distance.
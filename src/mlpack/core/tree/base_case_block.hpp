@@ -0,0 +1,83 @@
+/**
+ * @file base_case_block.hpp
+ *
+ * Detection of rules that can compute the base cases of a whole block of points
+ * at once, and a helper that lets traversers use them when available.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BASE_CASE_BLOCK_HPP
+#define MLPACK_CORE_TREE_BASE_CASE_BLOCK_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+
+namespace mlpack {
+namespace tree {
+
+HAS_MEM_FUNC(BaseCaseBlock, HasBaseCaseBlockCheck);
+
+/**
+ * HasBaseCaseBlock<RuleType>::value is true if the given RuleType has a method
+ *
+ * @code
+ * void BaseCaseBlock(const arma::uvec& queryIndices,
+ *                    const size_t referenceBegin,
+ *                    const size_t referenceCount);
+ * @endcode
+ *
+ * that computes the base cases between each of the given query points and each
+ * of the reference points in [referenceBegin, referenceBegin + referenceCount)
+ * at once.  Traversers of trees whose leaves hold contiguous points (such as
+ * the BinarySpaceTree) use this method instead of BaseCase() when both nodes
+ * are leaves.  The result must be the same as calling BaseCase() for every
+ * pair.
+ */
+template<typename RuleType>
+struct HasBaseCaseBlock
+{
+  static const bool value = HasBaseCaseBlockCheck<RuleType,
+      void(RuleType::*)(const arma::uvec&, const size_t, const size_t)>::value;
+};
+
+/**
+ * Compute the base cases between the given query points and the given
+ * contiguous range of reference points with the rules' BaseCaseBlock() method.
+ */
+template<typename RuleType>
+inline void BaseCaseBlock(
+    RuleType& rule,
+    const arma::uvec& queryIndices,
+    const size_t referenceBegin,
+    const size_t referenceCount,
+    const typename std::enable_if_t<HasBaseCaseBlock<RuleType>::value>* = 0)
+{
+  rule.BaseCaseBlock(queryIndices, referenceBegin, referenceCount);
+}
+
+/**
+ * Compute the base cases between the given query points and the given
+ * contiguous range of reference points one pair at a time, for rules that do
+ * not have a BaseCaseBlock() method.
+ */
+template<typename RuleType>
+inline void BaseCaseBlock(
+    RuleType& rule,
+    const arma::uvec& queryIndices,
+    const size_t referenceBegin,
+    const size_t referenceCount,
+    const typename std::enable_if_t<!HasBaseCaseBlock<RuleType>::value>* = 0)
+{
+  const size_t referenceEnd = referenceBegin + referenceCount;
+  for (size_t i = 0; i < queryIndices.n_elem; ++i)
+    for (size_t ref = referenceBegin; ref < referenceEnd; ++ref)
+      rule.BaseCase(queryIndices[i], ref);
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
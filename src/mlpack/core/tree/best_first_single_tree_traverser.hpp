@@ -0,0 +1,119 @@
+/**
+ * @file best_first_single_tree_traverser.hpp
+ *
+ * A single-tree traverser that visits the nodes of the tree in order of their
+ * score, and can be stopped after a budget of base cases or of time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BEST_FIRST_SINGLE_TREE_TRAVERSER_HPP
+#define MLPACK_CORE_TREE_BEST_FIRST_SINGLE_TREE_TRAVERSER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * A single-tree traverser that always visits the node with the best (lowest)
+ * score among all the nodes found so far, instead of descending depth-first.
+ * The nodes are rescored when they are visited, so nodes that can no longer
+ * improve the results are pruned; without a budget, the results are the same
+ * as with a depth-first traverser.
+ *
+ * Because the most promising nodes are visited first, the traversal of each
+ * query point can be stopped after a given number of base cases or a given
+ * time, and the rules then hold the best results found so far (an "anytime"
+ * search).  The traversal is never stopped before MinBaseCases() base cases
+ * (for instance, k for k-nearest-neighbor search), so that the results are
+ * complete.  This works with any tree type and any RuleType that implements
+ * Score(), Rescore() and BaseCase() for single-tree traversals.
+ */
+template<typename TreeType, typename RuleType>
+class BestFirstSingleTreeTraverser
+{
+ public:
+  /**
+   * Instantiate the best-first single tree traverser with the given rule set.
+   */
+  BestFirstSingleTreeTraverser(RuleType& rule);
+
+  /**
+   * Traverse the tree with the given point, until all the nodes are visited or
+   * pruned, or until the budget is used.
+   *
+   * @param queryIndex The index of the point in the query set which is being
+   *     used as the query point.
+   * @param referenceNode The tree node to be traversed.
+   */
+  void Traverse(const size_t queryIndex, TreeType& referenceNode);
+
+  //! Get the number of prunes.
+  size_t NumPrunes() const { return numPrunes; }
+
+  //! Get the number of traversals that were stopped by the budget.
+  size_t NumStopped() const { return numStopped; }
+
+  //! Get the minimum number of base cases before a traversal can be stopped.
+  size_t MinBaseCases() const { return minBaseCases; }
+  //! Modify the minimum number of base cases before a traversal can be stopped.
+  size_t& MinBaseCases() { return minBaseCases; }
+
+  //! Get the maximum number of base cases of each traversal (0 for no limit).
+  size_t MaxBaseCases() const { return maxBaseCases; }
+  //! Modify the maximum number of base cases of each traversal (0 for no
+  //! limit).
+  size_t& MaxBaseCases() { return maxBaseCases; }
+
+  //! Get the maximum time of each traversal, in seconds (0 for no limit).
+  double MaxTime() const { return maxTime; }
+  //! Modify the maximum time of each traversal, in seconds (0 for no limit).
+  double& MaxTime() { return maxTime; }
+
+ private:
+  //! A node that remains to be visited, with its score.
+  typedef std::pair<double, TreeType*> Candidate;
+
+  //! Order candidates so that the one with the lowest score is on top of the
+  //! heap.
+  struct CandidateCompare
+  {
+    bool operator()(const Candidate& a, const Candidate& b) const
+    {
+      return a.first > b.first;
+    }
+  };
+
+  //! Reference to the rules with which the tree will be traversed.
+  RuleType& rule;
+
+  //! The nodes that remain to be visited, as a heap.  It is kept between
+  //! traversals to avoid reallocating it.
+  std::vector<Candidate> candidates;
+
+  //! The number of nodes which have been pruned during traversal.
+  size_t numPrunes;
+
+  //! The number of traversals that were stopped by the budget.
+  size_t numStopped;
+
+  //! The minimum number of base cases before a traversal can be stopped.
+  size_t minBaseCases;
+
+  //! The maximum number of base cases of each traversal.
+  size_t maxBaseCases;
+
+  //! The maximum time of each traversal, in seconds.
+  double maxTime;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "best_first_single_tree_traverser_impl.hpp"
+
+#endif
@@ -0,0 +1,116 @@
+/**
+ * @file best_first_single_tree_traverser_impl.hpp
+ *
+ * Implementation of the best-first single-tree traverser.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BEST_FIRST_SINGLE_TREE_TRAVERSER_IMPL_HPP
+#define MLPACK_CORE_TREE_BEST_FIRST_SINGLE_TREE_TRAVERSER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "best_first_single_tree_traverser.hpp"
+
+#include <chrono>
+
+namespace mlpack {
+namespace tree {
+
+template<typename TreeType, typename RuleType>
+BestFirstSingleTreeTraverser<TreeType, RuleType>::BestFirstSingleTreeTraverser(
+    RuleType& rule) :
+    rule(rule),
+    numPrunes(0),
+    numStopped(0),
+    minBaseCases(0),
+    maxBaseCases(0),
+    maxTime(0.0)
+{ /* Nothing to do. */ }
+
+template<typename TreeType, typename RuleType>
+void BestFirstSingleTreeTraverser<TreeType, RuleType>::Traverse(
+    const size_t queryIndex,
+    TreeType& referenceNode)
+{
+  typedef std::chrono::steady_clock Clock;
+
+  // The clock is only read if there is a time limit.
+  const bool timed = (maxTime > 0.0);
+  Clock::time_point deadline;
+  if (timed)
+  {
+    deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(maxTime));
+  }
+
+  // The budget of base cases, if there is one, is at least minBaseCases.
+  const size_t baseCaseLimit = (maxBaseCases == 0) ? 0 :
+      std::max(maxBaseCases, minBaseCases);
+
+  const double rootScore = rule.Score(queryIndex, referenceNode);
+  if (rootScore == DBL_MAX)
+  {
+    ++numPrunes;
+    return;
+  }
+
+  candidates.clear();
+  candidates.push_back(Candidate(rootScore, &referenceNode));
+
+  size_t baseCases = 0;
+  while (!candidates.empty())
+  {
+    std::pop_heap(candidates.begin(), candidates.end(), CandidateCompare());
+    TreeType& node = *candidates.back().second;
+    const double oldScore = candidates.back().first;
+    candidates.pop_back();
+
+    // The results may have improved since the node was scored.
+    if (rule.Rescore(queryIndex, node, oldScore) == DBL_MAX)
+    {
+      ++numPrunes;
+      continue;
+    }
+
+    // Run the base cases of the points held in this node (for most trees,
+    // only leaves hold points).
+    for (size_t i = 0; i < node.NumPoints(); ++i)
+    {
+      if (baseCaseLimit > 0 && baseCases == baseCaseLimit)
+        break;
+
+      rule.BaseCase(queryIndex, node.Point(i));
+      ++baseCases;
+    }
+
+    // Stop if the budget is used; the rules hold the best results so far.
+    if ((baseCaseLimit > 0 && baseCases == baseCaseLimit) ||
+        (timed && baseCases >= minBaseCases && Clock::now() >= deadline))
+    {
+      ++numStopped;
+      break;
+    }
+
+    // Score the children, and add the ones that can't be pruned.
+    for (size_t i = 0; i < node.NumChildren(); ++i)
+    {
+      const double score = rule.Score(queryIndex, node.Child(i));
+      if (score == DBL_MAX)
+      {
+        ++numPrunes;
+        continue;
+      }
+
+      candidates.push_back(Candidate(score, &node.Child(i)));
+      std::push_heap(candidates.begin(), candidates.end(), CandidateCompare());
+    }
+  }
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
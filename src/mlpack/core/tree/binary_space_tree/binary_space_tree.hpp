@@ -13,12 +13,17 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include "../node_arena.hpp"
 #include "../statistic.hpp"
 #include "midpoint_split.hpp"
+#include "split_traits.hpp"
 
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
 
+// Forward declaration, so that flat tree files can be read and written.
+class FlatTreeIO;
+
 /**
  * A binary space partitioning tree, such as a KD-tree or a ball tree.  Once the
  * bound and type of dataset is defined, the tree will construct itself.  Call
@@ -32,6 +37,10 @@ namespace tree /** Trees and tree-building procedures. */ {
  * This tree does take one runtime parameter in the constructor, which is the
  * max leaf size to be used.
  *
+ * The nodes below the root are allocated from a NodeArena owned by the root,
+ * so building the tree allocates a few large slabs instead of one block per
+ * node, and destroying it frees them at once.
+ *
  * @tparam MetricType The metric used for tree-building.  The BoundType may
  *     place restrictions on the metrics that can be used.
  * @tparam StatisticType Extra data contained in the node.  See statistic.hpp
@@ -88,6 +97,18 @@ class BinarySpaceTree
   //! The dataset.  If we are the root of the tree, we own the dataset and must
   //! delete it.
   MatType* dataset;
+  //! If this is the root of a packed tree (see PackNodes()), the block of
+  //! memory holding all of the nodes of the tree; otherwise NULL.
+  char* packedNodes;
+  //! For the root, the arena holding the other nodes of the tree, which the
+  //! root owns (see NodeArena).  For any other node, the arena it was
+  //! allocated from (NULL if it was allocated with new), which its children
+  //! are allocated from too.
+  NodeArena* arena;
+  #ifdef MLPACK_MEMORY_TRACKING
+  //! Counts this node in the MemoryTracker.
+  TrackedObject<BinarySpaceTree> tracked;
+  #endif
 
  public:
   //! A single-tree traverser for binary space trees; see
@@ -300,6 +321,65 @@ class BinarySpaceTree
    */
   ~BinarySpaceTree();
 
+  /**
+   * Move all of the descendants of this node into a single contiguous block of
+   * memory, in breadth-first order, so that nodes that are visited together
+   * during a traversal are close together in memory.  If the bound type is
+   * HRectBound, the ranges of each bound are stored inline, directly after the
+   * node that they belong to, instead of in a separate allocation.  The
+   * structure of the tree does not change, and it can be traversed exactly as
+   * before.
+   *
+   * This must be called on the root of the tree, and it invalidates any
+   * pointers or references to the descendants of the root (the root itself
+   * does not move).  Calling this on a tree that is already packed does
+   * nothing.
+   */
+  void PackNodes();
+
+  //! Return whether or not the nodes of this tree are packed (see PackNodes()).
+  bool IsPacked() const { return packedNodes != NULL; }
+
+  //! Get the arena holding the nodes of the tree below the root (NULL if the
+  //! nodes are not in an arena); see NodeArena.
+  const NodeArena* Arena() const { return arena; }
+
+  /**
+   * Insert the given points into the tree without rebuilding it.  Each point
+   * is sent down the tree to the child whose bound is closest to it (expanding
+   * the bounds on the way), and is added to the leaf it reaches; leaves that
+   * then hold more than maxLeafSize points are split with SplitType, like they
+   * are when the tree is built.  The dataset is rearranged so that the points
+   * of each node stay contiguous, and the mapping oldFromNew (from the new
+   * point indices to the original point indices) is updated accordingly: the
+   * original index of the i'th inserted point is the number of points before
+   * the insertion plus i.  If oldFromNew is empty, the points that are already
+   * in the tree are taken to be in their original order.
+   *
+   * The tree is not rebalanced, so if many points are inserted, the tree may
+   * become much slower to search than a rebuilt tree.  This must be called on
+   * the root of the tree, and it invalidates all of the statistics of the tree
+   * (they are recomputed), as well as any references to the dataset.
+   *
+   * @param points Points to insert.
+   * @param oldFromNew Mapping from new point indices to original indices.
+   * @param maxLeafSize Maximum number of points held in a leaf.
+   */
+  void Insert(const MatType& points,
+              std::vector<size_t>& oldFromNew,
+              const size_t maxLeafSize = 20);
+
+  /**
+   * Recompute the bounds, the cached distances and the statistics of every
+   * node from the current contents of the dataset, without changing the
+   * structure of the tree.  This is meant to be used after the points in
+   * Dataset() are moved (for instance, by a linear transformation): the tree
+   * stays valid, although it may be slower to search than a rebuilt tree if
+   * the points moved far relative to each other.  This must be called on the
+   * root of the tree.
+   */
+  void Refit();
+
   //! Return the bound object for this node.
   const BoundType<MetricType>& Bound() const { return bound; }
   //! Return the bound object for this node.
@@ -514,6 +594,23 @@ class BinarySpaceTree
                  const size_t maxLeafSize,
                  SplitType<BoundType<MetricType>, MatType>& splitter);
 
+  /**
+   * Build the children of this node, which hold the points in
+   * [begin, splitCol) and [splitCol, begin + count).  If OpenMP is available
+   * and the split type allows it (see SplitTraits), the children of large
+   * nodes are built in parallel.
+   *
+   * @param splitCol The first point of the right child.
+   * @param oldFromNew Vector holding permuted indices, or NULL if the indices
+   *     are not needed.
+   * @param maxLeafSize Maximum number of points held in a leaf.
+   * @param splitter Instantiated SplitType object.
+   */
+  void BuildChildren(const size_t splitCol,
+                     std::vector<size_t>* oldFromNew,
+                     const size_t maxLeafSize,
+                     SplitType<BoundType<MetricType>, MatType>& splitter);
+
   /**
    * Update the bound of the current node. This method does not take into
    * account bound-specific properties.
@@ -531,6 +628,82 @@ class BinarySpaceTree
    */
   void UpdateBound(bound::HollowBallBound<MetricType>& boundToUpdate);
 
+  //! Reset the given bound to an empty bound, before it is refit.
+  template<typename BoundType2>
+  void ResetBound(BoundType2& boundToReset)
+  {
+    boundToReset = BoundType2(dataset->n_rows);
+  }
+
+  //! Reset an HRectBound in place, since its ranges may be stored inline when
+  //! the tree is packed.
+  template<typename BoundMetricType, typename BoundElemType>
+  void ResetBound(
+      bound::HRectBound<BoundMetricType, BoundElemType>& boundToReset)
+  {
+    boundToReset.Clear();
+  }
+
+  /**
+   * Refit the bounds of the given nodes (all the nodes of the tree, in
+   * breadth-first order) to the points they hold, one node at a time from the
+   * root down.  This is used for bounds that can't be built from the bounds of
+   * the children.
+   */
+  template<typename BoundType2>
+  void RefitBounds(const std::vector<BinarySpaceTree*>& nodes,
+                   BoundType2& /* rootBound */);
+
+  /**
+   * Refit the bounds of the given nodes (all the nodes of the tree, in
+   * breadth-first order) from the bottom up: the leaves are refit to their
+   * points, and every other node gets the union of the bounds of its children,
+   * so each point is only visited once.
+   */
+  template<typename BoundMetricType, typename BoundElemType>
+  void RefitBounds(
+      const std::vector<BinarySpaceTree*>& nodes,
+      bound::HRectBound<BoundMetricType, BoundElemType>& /* rootBound */);
+
+  /**
+   * Recompute the furthest descendant distances, the parent distances and the
+   * statistics of this node and all of its descendants, after their bounds
+   * changed.
+   */
+  void UpdateCachedDistances();
+
+  /**
+   * Delete the children of this node, whether or not they are packed.
+   */
+  void DeleteChildren();
+
+  //! Return the number of bytes of inline storage needed by the given bound
+  //! when the tree is packed.  Only HRectBound is stored inline.
+  template<typename BoundType2>
+  static size_t PackedBoundSize(const BoundType2& /* bound */) { return 0; }
+
+  //! Return the number of bytes of inline storage needed by an HRectBound.
+  template<typename BoundMetricType, typename BoundElemType>
+  static size_t PackedBoundSize(
+      const bound::HRectBound<BoundMetricType, BoundElemType>& boundToPack)
+  {
+    return boundToPack.Dim() * sizeof(math::RangeType<BoundElemType>);
+  }
+
+  //! Move the given bound into inline storage (nothing is done for bounds
+  //! other than HRectBound).
+  template<typename BoundType2>
+  static void PackBound(BoundType2& /* bound */, char* /* memory */) { }
+
+  //! Move the ranges of an HRectBound into the given inline storage.
+  template<typename BoundMetricType, typename BoundElemType>
+  static void PackBound(
+      bound::HRectBound<BoundMetricType, BoundElemType>& boundToPack,
+      char* memory)
+  {
+    boundToPack.UseExternalMemory((math::RangeType<BoundElemType>*) memory);
+  }
+
  protected:
   /**
    * A default constructor.  This is meant to only be used with
@@ -543,6 +716,9 @@ class BinarySpaceTree
   //! Friend access is given for the default constructor.
   friend class boost::serialization::access;
 
+  //! Friend access is given so that flat tree files can be loaded.
+  friend class FlatTreeIO;
+
  public:
   /**
    * Serialize the tree.
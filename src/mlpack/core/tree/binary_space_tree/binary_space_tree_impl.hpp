@@ -17,6 +17,8 @@
 #include <mlpack/core/util/cli.hpp>
 #include <mlpack/core/util/log.hpp>
 #include <queue>
+#include <stack>
+#include <unordered_map>
 
 namespace mlpack {
 namespace tree {
@@ -40,7 +42,9 @@ BinarySpaceTree(
     count(data.n_cols), /* and spans all of the dataset. */
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(data)) // Copies the dataset.
+    dataset(new MatType(data)), // Copies the dataset.
+    packedNodes(NULL),
+    arena(NULL)
 {
   // Do the actual splitting of this node.
   SplitType<BoundType<MetricType>, MatType> splitter;
@@ -68,7 +72,9 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(data)) // Copies the dataset.
+    dataset(new MatType(data)), // Copies the dataset.
+    packedNodes(NULL),
+    arena(NULL)
 {
   // Initialize oldFromNew correctly.
   oldFromNew.resize(data.n_cols);
@@ -102,7 +108,9 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(data)) // Copies the dataset.
+    dataset(new MatType(data)), // Copies the dataset.
+    packedNodes(NULL),
+    arena(NULL)
 {
   // Initialize the oldFromNew vector correctly.
   oldFromNew.resize(data.n_cols);
@@ -137,7 +145,9 @@ BinarySpaceTree(MatType&& data, const size_t maxLeafSize) :
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(std::move(data)))
+    dataset(new MatType(std::move(data))),
+    packedNodes(NULL),
+    arena(NULL)
 {
   // Do the actual splitting of this node.
   SplitType<BoundType<MetricType>, MatType> splitter;
@@ -165,7 +175,9 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(std::move(data)))
+    dataset(new MatType(std::move(data))),
+    packedNodes(NULL),
+    arena(NULL)
 {
   // Initialize oldFromNew correctly.
   oldFromNew.resize(dataset->n_cols);
@@ -199,7 +211,9 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(std::move(data)))
+    dataset(new MatType(std::move(data))),
+    packedNodes(NULL),
+    arena(NULL)
 {
   // Initialize the oldFromNew vector correctly.
   oldFromNew.resize(dataset->n_cols);
@@ -238,7 +252,9 @@ BinarySpaceTree(
     begin(begin),
     count(count),
     bound(parent->Dataset().n_rows),
-    dataset(&parent->Dataset()) // Point to the parent's dataset.
+    dataset(&parent->Dataset()), // Point to the parent's dataset.
+    packedNodes(NULL),
+    arena(parent->arena)
 {
   // Perform the actual splitting.
   SplitNode(maxLeafSize, splitter);
@@ -267,7 +283,9 @@ BinarySpaceTree(
     begin(begin),
     count(count),
     bound(parent->Dataset().n_rows),
-    dataset(&parent->Dataset())
+    dataset(&parent->Dataset()),
+    packedNodes(NULL),
+    arena(parent->arena)
 {
   // Hopefully the vector is initialized correctly!  We can't check that
   // entirely but we can do a minor sanity check.
@@ -301,7 +319,9 @@ BinarySpaceTree(
     begin(begin),
     count(count),
     bound(parent->Dataset()->n_rows),
-    dataset(&parent->Dataset())
+    dataset(&parent->Dataset()),
+    packedNodes(NULL),
+    arena(parent->arena)
 {
   // Hopefully the vector is initialized correctly!  We can't check that
   // entirely but we can do a minor sanity check.
@@ -342,7 +362,9 @@ BinarySpaceTree(
     parentDistance(other.parentDistance),
     furthestDescendantDistance(other.furthestDescendantDistance),
     // Copy matrix, but only if we are the root.
-    dataset((other.parent == NULL) ? new MatType(*other.dataset) : NULL)
+    dataset((other.parent == NULL) ? new MatType(*other.dataset) : NULL),
+    packedNodes(NULL),
+    arena(NULL)
 {
   // Create left and right children (if any).
   if (other.Left())
@@ -400,7 +422,9 @@ BinarySpaceTree(BinarySpaceTree&& other) :
     parentDistance(other.parentDistance),
     furthestDescendantDistance(other.furthestDescendantDistance),
     minimumBoundDistance(other.minimumBoundDistance),
-    dataset(other.dataset)
+    dataset(other.dataset),
+    packedNodes(other.packedNodes),
+    arena(other.arena)
 {
   // Now we are a clone of the other tree.  But we must also clear the other
   // tree's contents, so it doesn't delete anything when it is destructed.
@@ -412,6 +436,8 @@ BinarySpaceTree(BinarySpaceTree&& other) :
   other.furthestDescendantDistance = 0.0;
   other.minimumBoundDistance = 0.0;
   other.dataset = NULL;
+  other.packedNodes = NULL;
+  other.arena = NULL;
 
   // Set new parent.
   if (left)
@@ -455,12 +481,416 @@ template<typename MetricType,
 BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
     ~BinarySpaceTree()
 {
-  delete left;
-  delete right;
+  DeleteChildren();
 
-  // If we're the root, delete the matrix.
+  // If we're the root, delete the matrix, and the arena of the nodes (which
+  // have all been destructed now).
   if (!parent)
+  {
     delete dataset;
+    delete arena;
+  }
+}
+
+/**
+ * Move the descendants of the root into one contiguous block, in breadth-first
+ * order.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    PackNodes()
+{
+  if (parent != NULL)
+    throw std::invalid_argument("BinarySpaceTree::PackNodes(): must be called "
+        "on the root of the tree");
+
+  if (packedNodes)
+    return;
+
+  // Collect the nodes in breadth-first order.
+  std::vector<BinarySpaceTree*> nodes;
+  nodes.push_back(this);
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    if (nodes[i]->left)
+      nodes.push_back(nodes[i]->left);
+    if (nodes[i]->right)
+      nodes.push_back(nodes[i]->right);
+  }
+
+  // Each slot of the block holds a node followed by the inline storage for its
+  // bound.  The root does not move, so the node part of the first slot is
+  // unused; it holds the number of slots and the size of each slot instead, so
+  // that the block can be destroyed later.
+  const size_t nodeSize = sizeof(BinarySpaceTree);
+  const size_t alignment = alignof(BinarySpaceTree);
+  const size_t boundSize = ((PackedBoundSize(bound) + alignment - 1) /
+      alignment) * alignment;
+  const size_t slotSize = nodeSize + boundSize;
+
+  packedNodes = new char[nodes.size() * slotSize];
+  size_t* header = (size_t*) packedNodes;
+  header[0] = nodes.size();
+  header[1] = slotSize;
+
+  PackBound(bound, packedNodes + nodeSize);
+  for (size_t i = 1; i < nodes.size(); ++i)
+  {
+    char* slot = packedNodes + i * slotSize;
+    BinarySpaceTree* oldNode = nodes[i];
+    NodeArena* oldArena = oldNode->arena;
+
+    // The move constructor takes the children of the old node and points them
+    // to the new node.  The parent has already been moved, so it only needs to
+    // point to the new node too.
+    BinarySpaceTree* node = new (slot) BinarySpaceTree(std::move(*oldNode));
+    node->arena = NULL;
+    PackBound(node->bound, slot + nodeSize);
+    if (node->parent->left == oldNode)
+      node->parent->left = node;
+    else
+      node->parent->right = node;
+
+    // The old node has no children anymore, so this only frees the node.
+    DeleteNode(oldNode, oldArena);
+  }
+
+  // No node is left in the arena.
+  delete arena;
+  arena = NULL;
+}
+
+/**
+ * Insert points into the tree, splitting leaves that become too large.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    Insert(const MatType& points,
+           std::vector<size_t>& oldFromNew,
+           const size_t maxLeafSize)
+{
+  if (parent != NULL)
+    throw std::invalid_argument("BinarySpaceTree::Insert(): must be called on "
+        "the root of the tree");
+  if (points.n_rows != dataset->n_rows)
+    throw std::invalid_argument("BinarySpaceTree::Insert(): dimensionality of "
+        "points does not match dimensionality of tree");
+  if (points.n_cols == 0)
+    return;
+
+  const size_t oldSize = dataset->n_cols;
+  if (oldFromNew.size() != oldSize)
+  {
+    oldFromNew.resize(oldSize);
+    for (size_t i = 0; i < oldSize; ++i)
+      oldFromNew[i] = i;
+  }
+
+  // Collect the leaves in order; they cover the dataset from left to right.
+  std::vector<BinarySpaceTree*> leaves;
+  std::unordered_map<const BinarySpaceTree*, size_t> leafIndices;
+  std::stack<BinarySpaceTree*> stack;
+  stack.push(this);
+  while (!stack.empty())
+  {
+    BinarySpaceTree* node = stack.top();
+    stack.pop();
+
+    if (node->IsLeaf())
+    {
+      leafIndices[node] = leaves.size();
+      leaves.push_back(node);
+    }
+    else
+    {
+      stack.push(node->right);
+      stack.push(node->left);
+    }
+  }
+
+  // Send each point down to a leaf, expanding the bounds on the way.  We go to
+  // the closest child; if the point is in both children (or equally far from
+  // them), we go to the child with fewer points, to keep the tree balanced.
+  std::vector<std::vector<size_t>> leafPoints(leaves.size());
+  for (size_t i = 0; i < points.n_cols; ++i)
+  {
+    BinarySpaceTree* node = this;
+    node->bound |= points.col(i);
+    while (!node->IsLeaf())
+    {
+      const ElemType leftDistance = node->left->MinDistance(points.col(i));
+      const ElemType rightDistance = node->right->MinDistance(points.col(i));
+      if (leftDistance < rightDistance || (leftDistance == rightDistance &&
+          node->left->count <= node->right->count))
+        node = node->left;
+      else
+        node = node->right;
+
+      node->bound |= points.col(i);
+    }
+
+    leafPoints[leafIndices[node]].push_back(i);
+  }
+
+  // Build the new dataset, where the new points of each leaf come right after
+  // the points that the leaf already held.
+  MatType* newDataset = new MatType(dataset->n_rows, oldSize + points.n_cols);
+  std::vector<size_t> newOldFromNew(oldSize + points.n_cols);
+  size_t position = 0;
+  for (size_t l = 0; l < leaves.size(); ++l)
+  {
+    BinarySpaceTree* leaf = leaves[l];
+    for (size_t i = 0; i < leaf->count; ++i)
+    {
+      newDataset->col(position + i) = dataset->col(leaf->begin + i);
+      newOldFromNew[position + i] = oldFromNew[leaf->begin + i];
+    }
+    for (size_t i = 0; i < leafPoints[l].size(); ++i)
+    {
+      const size_t index = position + leaf->count + i;
+      newDataset->col(index) = points.col(leafPoints[l][i]);
+      newOldFromNew[index] = oldSize + leafPoints[l][i];
+    }
+
+    leaf->begin = position;
+    leaf->count += leafPoints[l].size();
+    position += leaf->count;
+  }
+
+  delete dataset;
+  dataset = newDataset;
+  oldFromNew.swap(newOldFromNew);
+
+  // Fix the ranges of all the other nodes.  In breadth-first order, children
+  // come after their parents, so we go backwards.
+  std::vector<BinarySpaceTree*> nodes;
+  nodes.push_back(this);
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    nodes[i]->dataset = dataset;
+    if (!nodes[i]->IsLeaf())
+    {
+      nodes.push_back(nodes[i]->left);
+      nodes.push_back(nodes[i]->right);
+    }
+  }
+
+  for (size_t i = nodes.size(); i > 0; --i)
+  {
+    BinarySpaceTree* node = nodes[i - 1];
+    if (!node->IsLeaf())
+    {
+      node->begin = node->left->begin;
+      node->count = node->left->count + node->right->count;
+    }
+  }
+
+  // Split any leaves that became too large.
+  SplitType<BoundType<MetricType>, MatType> splitter;
+  for (size_t l = 0; l < leaves.size(); ++l)
+  {
+    if (leaves[l]->count > maxLeafSize)
+      leaves[l]->SplitNode(oldFromNew, maxLeafSize, splitter);
+  }
+
+  // Now recompute the cached distances and the statistics of all the nodes,
+  // since the bounds have changed.
+  UpdateCachedDistances();
+}
+
+/**
+ * Refit the bounds of the tree to the current contents of the dataset.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    Refit()
+{
+  if (parent != NULL)
+    throw std::invalid_argument("BinarySpaceTree::Refit(): must be called on "
+        "the root of the tree");
+
+  std::vector<BinarySpaceTree*> nodes;
+  nodes.push_back(this);
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    if (!nodes[i]->IsLeaf())
+    {
+      nodes.push_back(nodes[i]->left);
+      nodes.push_back(nodes[i]->right);
+    }
+  }
+
+  RefitBounds(nodes, bound);
+  UpdateCachedDistances();
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+template<typename BoundType2>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    RefitBounds(const std::vector<BinarySpaceTree*>& nodes,
+                BoundType2& /* rootBound */)
+{
+  // Refit the bounds in breadth-first order, since the bound of a node may
+  // depend on the bound of its left sibling (see the HollowBallBound overload
+  // of UpdateBound()).
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    nodes[i]->ResetBound(nodes[i]->bound);
+    nodes[i]->UpdateBound(nodes[i]->bound);
+  }
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+template<typename BoundMetricType, typename BoundElemType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    RefitBounds(
+        const std::vector<BinarySpaceTree*>& nodes,
+        bound::HRectBound<BoundMetricType, BoundElemType>& /* rootBound */)
+{
+  // Children come after their parents, so we go backwards to visit the
+  // children first.  The children partition the points of their parent, so
+  // the union of their bounds is the same as the bound of the points.
+  for (size_t i = nodes.size(); i > 0; --i)
+  {
+    BinarySpaceTree* node = nodes[i - 1];
+    node->ResetBound(node->bound);
+    if (node->IsLeaf())
+    {
+      node->UpdateBound(node->bound);
+    }
+    else
+    {
+      node->bound |= node->left->bound;
+      node->bound |= node->right->bound;
+    }
+  }
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    UpdateCachedDistances()
+{
+  std::vector<BinarySpaceTree*> nodes;
+  nodes.push_back(this);
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    if (!nodes[i]->IsLeaf())
+    {
+      nodes.push_back(nodes[i]->left);
+      nodes.push_back(nodes[i]->right);
+    }
+  }
+
+  // Children come after their parents, so we go backwards to visit the
+  // children first.
+  for (size_t i = nodes.size(); i > 0; --i)
+  {
+    BinarySpaceTree* node = nodes[i - 1];
+    node->furthestDescendantDistance = 0.5 * node->bound.Diameter();
+
+    if (!node->IsLeaf())
+    {
+      arma::vec center, leftCenter, rightCenter;
+      node->Center(center);
+      node->left->Center(leftCenter);
+      node->right->Center(rightCenter);
+      node->left->parentDistance = node->bound.Metric().Evaluate(center,
+          leftCenter);
+      node->right->parentDistance = node->bound.Metric().Evaluate(center,
+          rightCenter);
+    }
+
+    node->stat = StatisticType(*node);
+  }
+}
+
+/**
+ * Delete the children of the node, taking care of packed nodes.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    DeleteChildren()
+{
+  if (packedNodes)
+  {
+    const size_t* header = (const size_t*) packedNodes;
+    const size_t numSlots = header[0];
+    const size_t slotSize = header[1];
+
+    // Nodes may have been added after the tree was packed (see Insert()); only
+    // the nodes inside the block are not deleted by their parents.
+    const char* blockEnd = packedNodes + numSlots * slotSize;
+    std::less<const char*> less;
+    auto isPacked = [&](const BinarySpaceTree* node)
+    {
+      return !less((const char*) node, packedNodes) &&
+          less((const char*) node, blockEnd);
+    };
+
+    if (isPacked(left))
+      left = NULL;
+    if (isPacked(right))
+      right = NULL;
+
+    // Packed nodes were constructed in place, so they must be destructed in
+    // place too; their packed children are destructed here, not by their
+    // parents.
+    for (size_t i = 1; i < numSlots; ++i)
+    {
+      BinarySpaceTree* node = (BinarySpaceTree*) (packedNodes + i * slotSize);
+      if (isPacked(node->left))
+        node->left = NULL;
+      if (isPacked(node->right))
+        node->right = NULL;
+      node->~BinarySpaceTree();
+    }
+
+    delete[] packedNodes;
+    packedNodes = NULL;
+  }
+
+  if (left)
+    DeleteNode(left, left->arena);
+  if (right)
+    DeleteNode(right, right->arena);
+
+  left = NULL;
+  right = NULL;
 }
 
 template<typename MetricType,
@@ -783,10 +1213,7 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
 
   // Now that we know the split column, we will recursively split the children
   // by calling their constructors (which perform this splitting process).
-  left = new BinarySpaceTree(this, begin, splitCol - begin, splitter,
-      maxLeafSize);
-  right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
-      splitter, maxLeafSize);
+  BuildChildren(splitCol, NULL, maxLeafSize, splitter);
 
   // Calculate parent distances for those two nodes.
   arma::vec center, leftCenter, rightCenter;
@@ -851,10 +1278,7 @@ SplitNode(std::vector<size_t>& oldFromNew,
 
   // Now that we know the split column, we will recursively split the children
   // by calling their constructors (which perform this splitting process).
-  left = new BinarySpaceTree(this, begin, splitCol - begin, oldFromNew,
-      splitter, maxLeafSize);
-  right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
-      oldFromNew, splitter, maxLeafSize);
+  BuildChildren(splitCol, &oldFromNew, maxLeafSize, splitter);
 
   // Calculate parent distances for those two nodes.
   arma::vec center, leftCenter, rightCenter;
@@ -871,6 +1295,81 @@ SplitNode(std::vector<size_t>& oldFromNew,
   right->ParentDistance() = rightParentDistance;
 }
 
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+BuildChildren(const size_t splitCol,
+              std::vector<size_t>* oldFromNew,
+              const size_t maxLeafSize,
+              SplitType<BoundType<MetricType>, MatType>& splitter)
+{
+  // The nodes of the tree are allocated from the arena of the root, which
+  // creates it for its first children.  The children of a node that is not in
+  // an arena (in a copied or loaded tree) are not in an arena either.
+  if (parent == NULL && arena == NULL)
+    arena = new NodeArena();
+
+  auto buildLeft = [&]()
+  {
+    left = oldFromNew ? NewNode<BinarySpaceTree>(arena, this, begin,
+        splitCol - begin, *oldFromNew, splitter, maxLeafSize) :
+        NewNode<BinarySpaceTree>(arena, this, begin, splitCol - begin,
+        splitter, maxLeafSize);
+  };
+  auto buildRight = [&]()
+  {
+    right = oldFromNew ? NewNode<BinarySpaceTree>(arena, this, splitCol,
+        begin + count - splitCol, *oldFromNew, splitter, maxLeafSize) :
+        NewNode<BinarySpaceTree>(arena, this, splitCol,
+        begin + count - splitCol, splitter, maxLeafSize);
+  };
+
+  #ifdef HAS_OPENMP
+  // Building a small subtree is not worth a task.
+  const size_t minTaskSize = 1024;
+  if (SplitTraits<Split>::ParallelSplitNode && count >= minTaskSize &&
+      omp_get_max_threads() > 1)
+  {
+    // The children hold disjoint ranges of the dataset (and of oldFromNew), so
+    // they can be built at the same time.
+    if (omp_in_parallel())
+    {
+      #pragma omp task
+      buildLeft();
+      buildRight();
+      #pragma omp taskwait
+      return;
+    }
+
+    // As long as the node is a large part of the dataset, its children are
+    // built one after another, so that each of them is partitioned by all
+    // threads (see split::PerformSplit()).  Below that, we start a parallel
+    // region in which the rest of the subtree is built with tasks.
+    if (count * omp_get_max_threads() <= 2 * dataset->n_cols)
+    {
+      #pragma omp parallel
+      {
+        #pragma omp single
+        {
+          #pragma omp task
+          buildLeft();
+          buildRight();
+          #pragma omp taskwait
+        }
+      }
+      return;
+    }
+  }
+  #endif
+
+  buildLeft();
+  buildRight();
+}
+
 template<typename MetricType,
          typename StatisticType,
          typename MatType,
@@ -928,7 +1427,9 @@ BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
     stat(*this),
     parentDistance(0),
     furthestDescendantDistance(0),
-    dataset(NULL)
+    dataset(NULL),
+    packedNodes(NULL),
+    arena(NULL)
 {
   // Nothing to do.
 }
@@ -949,10 +1450,7 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
   // If we're loading, and we have children, they need to be deleted.
   if (Archive::is_loading::value)
   {
-    if (left)
-      delete left;
-    if (right)
-      delete right;
+    DeleteChildren();
     if (!parent)
       delete dataset;
 
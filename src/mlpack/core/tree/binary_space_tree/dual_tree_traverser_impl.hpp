@@ -17,6 +17,8 @@
 // In case it hasn't been included yet.
 #include "dual_tree_traverser.hpp"
 
+#include "../base_case_block.hpp"
+
 namespace mlpack {
 namespace tree {
 
@@ -57,7 +59,30 @@ DualTreeTraverser<RuleType>::Traverse(
   traversalInfo = rule.TraversalInfo();
 
   // If both are leaves, we must evaluate the base case.
-  if (queryNode.IsLeaf() && referenceNode.IsLeaf())
+  if (queryNode.IsLeaf() && referenceNode.IsLeaf() &&
+      HasBaseCaseBlock<RuleType>::value)
+  {
+    // The rules can compute all the base cases of the leaves at once, so we
+    // only collect the query points that need to be investigated.
+    const size_t queryEnd = queryNode.Begin() + queryNode.Count();
+    arma::uvec queries(queryNode.Count());
+    size_t numQueries = 0;
+    for (size_t query = queryNode.Begin(); query < queryEnd; ++query)
+    {
+      rule.TraversalInfo() = traversalInfo;
+      if (rule.Score(query, referenceNode) != DBL_MAX)
+        queries[numQueries++] = query;
+    }
+
+    if (numQueries > 0)
+    {
+      queries.resize(numQueries);
+      BaseCaseBlock(rule, queries, referenceNode.Begin(),
+          referenceNode.Count());
+      numBaseCases += numQueries * referenceNode.Count();
+    }
+  }
+  else if (queryNode.IsLeaf() && referenceNode.IsLeaf())
   {
     // Loop through each of the points in each node.
     const size_t queryEnd = queryNode.Begin() + queryNode.Count();
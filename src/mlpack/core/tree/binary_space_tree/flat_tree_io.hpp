@@ -0,0 +1,140 @@
+/**
+ * @file flat_tree_io.hpp
+ *
+ * Definition of FlatTreeIO, which saves binary space trees in a flat binary
+ * file that can be mapped into memory and used without deserialization.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BINARY_SPACE_TREE_FLAT_TREE_IO_HPP
+#define MLPACK_CORE_TREE_BINARY_SPACE_TREE_FLAT_TREE_IO_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/mapped_file.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * FlatTreeIO reads and writes BinarySpaceTrees that use HRectBound (such as
+ * the KDTree) in a flat binary format.  A flat tree file holds the following,
+ * in order:
+ *
+ *  - a fixed-size header (containing the magic string "MLPKTREE", the format
+ *    version, the element size, and the sizes and offsets of each section);
+ *  - the (rearranged) dataset, in column-major order, aligned to 64 bytes;
+ *  - an array of nodes in breadth-first order (the root is node 0), each
+ *    holding the point range, the indices of the children, and the cached
+ *    distances of the node;
+ *  - the hyperrectangle bound of each node, as (lo, hi) pairs for every
+ *    dimension;
+ *  - the mapping from the new point indices to the original point indices.
+ *
+ * When a tree is loaded, the dataset is not copied: the tree's dataset is an
+ * alias of the memory of the mapped file, so the file must stay mapped for as
+ * long as the tree exists.  The nodes are rebuilt with a single linear pass
+ * over the node array, without any parsing, splitting, or bound computation.
+ * Statistics are default-constructed for each node, as they are when a tree
+ * is built.
+ *
+ * The file format depends on the endianness of the machine it was written on.
+ */
+class FlatTreeIO
+{
+ public:
+  /**
+   * Save the given tree in flat format to the given file.  The tree must be the
+   * root of a BinarySpaceTree that uses HRectBound and a dense matrix.  If the
+   * tree does not rearrange points, or the mapping is not known, an empty
+   * oldFromNew vector may be given, and the identity mapping is stored.
+   *
+   * @param filename File to save to.
+   * @param tree Tree to save.
+   * @param oldFromNew Mapping from new point indices to original indices.
+   */
+  template<typename TreeType>
+  static void Save(const std::string& filename,
+                   const TreeType& tree,
+                   const std::vector<size_t>& oldFromNew);
+
+  /**
+   * Load a tree in flat format from the given mapped file.  The returned tree
+   * references the memory of the mapped file, so the file must outlive it.
+   * The returned tree must be deleted by the caller.  If the file is not a
+   * valid flat tree file for this tree type, std::runtime_error is thrown.
+   *
+   * @param file Mapped flat tree file.
+   * @param oldFromNew Vector to store the mapping from new point indices to
+   *     original point indices in.
+   */
+  template<typename TreeType>
+  static TreeType* Load(const util::MappedFile& file,
+                        std::vector<size_t>& oldFromNew);
+
+ private:
+  //! The header of a flat tree file.
+  struct Header
+  {
+    //! Magic string identifying the file type: "MLPKTREE".
+    char magic[8];
+    //! The version of the format.
+    uint64_t version;
+    //! The size of each element of the dataset, in bytes.
+    uint64_t elemSize;
+    //! The dimensionality of the dataset.
+    uint64_t dimensionality;
+    //! The number of points in the dataset.
+    uint64_t numPoints;
+    //! The number of nodes in the tree.
+    uint64_t numNodes;
+    //! The offset of the dataset in the file.
+    uint64_t dataOffset;
+    //! The offset of the node array in the file.
+    uint64_t nodeOffset;
+    //! The offset of the bound array in the file.
+    uint64_t boundOffset;
+    //! The offset of the point mapping in the file.
+    uint64_t mappingOffset;
+  };
+
+  //! The representation of a single node of a flat tree file.
+  struct Node
+  {
+    //! The index of the first point held by the node.
+    uint64_t begin;
+    //! The number of points held by the node.
+    uint64_t count;
+    //! The index of the left child, or the number of nodes for a leaf.
+    uint64_t left;
+    //! The index of the right child, or the number of nodes for a leaf.
+    uint64_t right;
+    //! The distance from the center of this node to the center of the parent.
+    double parentDistance;
+    //! The distance to the furthest descendant.
+    double furthestDescendantDistance;
+    //! The minimum distance from the center to any edge of the bound.
+    double minimumBoundDistance;
+    //! The minimum width of the bound.
+    double minWidth;
+  };
+
+  //! The current version of the format.
+  static const uint64_t Version = 1;
+
+  //! Round the given offset up to a multiple of 64 bytes.
+  static uint64_t Align(const uint64_t offset)
+  {
+    return (offset + 63) & ~((uint64_t) 63);
+  }
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "flat_tree_io_impl.hpp"
+
+#endif
@@ -0,0 +1,240 @@
+/**
+ * @file flat_tree_io_impl.hpp
+ *
+ * Implementation of FlatTreeIO, which saves binary space trees in a flat binary
+ * file that can be mapped into memory and used without deserialization.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BINARY_SPACE_TREE_FLAT_TREE_IO_IMPL_HPP
+#define MLPACK_CORE_TREE_BINARY_SPACE_TREE_FLAT_TREE_IO_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "flat_tree_io.hpp"
+
+#include <fstream>
+#include <cstring>
+
+namespace mlpack {
+namespace tree {
+
+template<typename TreeType>
+void FlatTreeIO::Save(const std::string& filename,
+                      const TreeType& tree,
+                      const std::vector<size_t>& oldFromNew)
+{
+  typedef typename TreeType::ElemType ElemType;
+
+  if (tree.Parent() != NULL)
+    throw std::invalid_argument("FlatTreeIO::Save(): tree must be the root!");
+
+  const typename TreeType::Mat& dataset = tree.Dataset();
+  if (!oldFromNew.empty() && oldFromNew.size() != dataset.n_cols)
+    throw std::invalid_argument("FlatTreeIO::Save(): size of mapping does not "
+        "match the number of points in the tree!");
+
+  // Collect the nodes in breadth-first order.
+  std::vector<const TreeType*> nodes;
+  nodes.push_back(&tree);
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    if (!nodes[i]->IsLeaf())
+    {
+      nodes.push_back(nodes[i]->Left());
+      nodes.push_back(nodes[i]->Right());
+    }
+  }
+
+  Header header;
+  std::memcpy(header.magic, "MLPKTREE", 8);
+  header.version = Version;
+  header.elemSize = sizeof(ElemType);
+  header.dimensionality = dataset.n_rows;
+  header.numPoints = dataset.n_cols;
+  header.numNodes = nodes.size();
+  header.dataOffset = Align(sizeof(Header));
+  header.nodeOffset = Align(header.dataOffset +
+      dataset.n_elem * sizeof(ElemType));
+  header.boundOffset = Align(header.nodeOffset + nodes.size() * sizeof(Node));
+  header.mappingOffset = Align(header.boundOffset +
+      2 * nodes.size() * dataset.n_rows * sizeof(double));
+
+  std::ofstream stream(filename, std::ios::binary);
+  if (!stream.is_open())
+    throw std::runtime_error("FlatTreeIO::Save(): cannot open file '" +
+        filename + "' for writing");
+
+  // Pad the stream with zeros up to the given offset.
+  auto pad = [&stream](const uint64_t offset)
+  {
+    while ((uint64_t) stream.tellp() < offset)
+      stream.put(0);
+  };
+
+  stream.write((const char*) &header, sizeof(Header));
+
+  pad(header.dataOffset);
+  stream.write((const char*) dataset.memptr(),
+      dataset.n_elem * sizeof(ElemType));
+
+  // The children of node i in breadth-first order are the next two unassigned
+  // indices, so we can compute them as we go.
+  pad(header.nodeOffset);
+  size_t nextChild = 1;
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    Node node;
+    node.begin = nodes[i]->Begin();
+    node.count = nodes[i]->Count();
+    if (nodes[i]->IsLeaf())
+    {
+      node.left = nodes.size();
+      node.right = nodes.size();
+    }
+    else
+    {
+      node.left = nextChild++;
+      node.right = nextChild++;
+    }
+    node.parentDistance = nodes[i]->ParentDistance();
+    node.furthestDescendantDistance = nodes[i]->FurthestDescendantDistance();
+    node.minimumBoundDistance = nodes[i]->MinimumBoundDistance();
+    node.minWidth = nodes[i]->Bound().MinWidth();
+
+    stream.write((const char*) &node, sizeof(Node));
+  }
+
+  pad(header.boundOffset);
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    for (size_t d = 0; d < dataset.n_rows; ++d)
+    {
+      const double range[2] = { (double) nodes[i]->Bound()[d].Lo(),
+                                (double) nodes[i]->Bound()[d].Hi() };
+      stream.write((const char*) range, 2 * sizeof(double));
+    }
+  }
+
+  pad(header.mappingOffset);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    const uint64_t index = oldFromNew.empty() ? i : oldFromNew[i];
+    stream.write((const char*) &index, sizeof(uint64_t));
+  }
+
+  if (!stream.good())
+    throw std::runtime_error("FlatTreeIO::Save(): error writing to file '" +
+        filename + "'");
+}
+
+template<typename TreeType>
+TreeType* FlatTreeIO::Load(const util::MappedFile& file,
+                           std::vector<size_t>& oldFromNew)
+{
+  typedef typename TreeType::ElemType ElemType;
+  typedef typename TreeType::Mat MatType;
+
+  const std::string error = "FlatTreeIO::Load(): '" + file.Filename() + "' ";
+  if (file.Size() < sizeof(Header))
+    throw std::runtime_error(error + "is not a flat tree file");
+
+  Header header;
+  std::memcpy(&header, file.Data(), sizeof(Header));
+  if (std::memcmp(header.magic, "MLPKTREE", 8) != 0)
+    throw std::runtime_error(error + "is not a flat tree file");
+  if (header.version != Version)
+    throw std::runtime_error(error + "has an unsupported format version");
+  if (header.elemSize != sizeof(ElemType))
+    throw std::runtime_error(error + "holds a dataset of a different element "
+        "type");
+  if (header.numNodes == 0 ||
+      header.nodeOffset < header.dataOffset + header.dimensionality *
+          header.numPoints * sizeof(ElemType) ||
+      header.boundOffset < header.nodeOffset + header.numNodes * sizeof(Node) ||
+      header.mappingOffset < header.boundOffset + 2 * header.numNodes *
+          header.dimensionality * sizeof(double) ||
+      header.mappingOffset + header.numPoints * sizeof(uint64_t) > file.Size())
+    throw std::runtime_error(error + "is truncated or corrupt");
+
+  const size_t dim = header.dimensionality;
+  const Node* flatNodes = (const Node*) (file.Data() + header.nodeOffset);
+  const double* flatBounds = (const double*) (file.Data() +
+      header.boundOffset);
+  const uint64_t* flatMapping = (const uint64_t*) (file.Data() +
+      header.mappingOffset);
+
+  // Check the structure before allocating anything.  In a breadth-first
+  // ordering, children always come after their parent.
+  for (size_t i = 0; i < header.numNodes; ++i)
+  {
+    const Node& flatNode = flatNodes[i];
+    const bool isLeaf = (flatNode.left == header.numNodes &&
+        flatNode.right == header.numNodes);
+    if (!isLeaf && (flatNode.left <= i || flatNode.right <= i ||
+        flatNode.left >= header.numNodes || flatNode.right >= header.numNodes))
+      throw std::runtime_error(error + "is truncated or corrupt");
+    if (flatNode.begin + flatNode.count > header.numPoints)
+      throw std::runtime_error(error + "is truncated or corrupt");
+  }
+
+  typedef typename std::remove_reference<decltype(
+      std::declval<TreeType&>().Bound())>::type BoundType;
+  typedef typename std::remove_reference<decltype(
+      std::declval<TreeType&>().Stat())>::type StatisticType;
+
+  // Alias the dataset directly from the mapped memory.
+  MatType* dataset = new MatType((ElemType*) (file.Data() + header.dataOffset),
+      dim, header.numPoints, false, true);
+
+  std::vector<TreeType*> nodes(header.numNodes);
+  for (size_t i = 0; i < nodes.size(); ++i)
+    nodes[i] = new TreeType();
+
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    TreeType* node = nodes[i];
+    const Node& flatNode = flatNodes[i];
+
+    node->begin = flatNode.begin;
+    node->count = flatNode.count;
+    node->parentDistance = flatNode.parentDistance;
+    node->furthestDescendantDistance = flatNode.furthestDescendantDistance;
+    node->minimumBoundDistance = flatNode.minimumBoundDistance;
+    node->dataset = dataset;
+
+    node->bound = BoundType(dim);
+    for (size_t d = 0; d < dim; ++d)
+    {
+      node->bound[d] = math::RangeType<ElemType>(
+          (ElemType) flatBounds[2 * (i * dim + d)],
+          (ElemType) flatBounds[2 * (i * dim + d) + 1]);
+    }
+    node->bound.MinWidth() = (ElemType) flatNode.minWidth;
+
+    if (flatNode.left != header.numNodes)
+    {
+      node->left = nodes[flatNode.left];
+      node->right = nodes[flatNode.right];
+      node->left->parent = node;
+      node->right->parent = node;
+    }
+  }
+
+  // Statistics may depend on the children, so build them bottom-up.
+  for (size_t i = nodes.size(); i > 0; --i)
+    nodes[i - 1]->stat = StatisticType(*nodes[i - 1]);
+
+  oldFromNew.resize(header.numPoints);
+  for (size_t i = 0; i < header.numPoints; ++i)
+    oldFromNew[i] = flatMapping[i];
+
+  return nodes[0];
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
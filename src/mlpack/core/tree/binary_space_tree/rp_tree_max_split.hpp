@@ -14,6 +14,7 @@
 #define MLPACK_CORE_TREE_BINARY_SPACE_TREE_RP_TREE_MAX_SPLIT_HPP
 
 #include <mlpack/prereqs.hpp>
+#include "split_traits.hpp"
 #include <mlpack/core/tree/perform_split.hpp>
 
 namespace mlpack {
@@ -139,6 +140,17 @@ class RPTreeMaxSplit
                           ElemType& splitVal);
 };
 
+/**
+ * The RPTreeMaxSplit draws random directions and split values from the global
+ * random number generator, so nodes cannot be split concurrently.
+ */
+template<typename BoundType, typename MatType>
+class SplitTraits<RPTreeMaxSplit<BoundType, MatType>>
+{
+ public:
+  static const bool ParallelSplitNode = false;
+};
+
 } // namespace tree
 } // namespace mlpack
 
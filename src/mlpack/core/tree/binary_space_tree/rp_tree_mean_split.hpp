@@ -14,6 +14,7 @@
 #define MLPACK_CORE_TREE_BINARY_SPACE_TREE_RP_TREE_MEAN_SPLIT_HPP
 
 #include <mlpack/prereqs.hpp>
+#include "split_traits.hpp"
 #include "rp_tree_max_split.hpp"
 #include <mlpack/core/tree/perform_split.hpp>
 #include <mlpack/core/math/lin_alg.hpp>
@@ -170,6 +171,17 @@ class RPTreeMeanSplit
                             ElemType& splitVal);
 };
 
+/**
+ * The RPTreeMeanSplit draws random directions and samples from the global
+ * random number generator, so nodes cannot be split concurrently.
+ */
+template<typename BoundType, typename MatType>
+class SplitTraits<RPTreeMeanSplit<BoundType, MatType>>
+{
+ public:
+  static const bool ParallelSplitNode = false;
+};
+
 } // namespace tree
 } // namespace mlpack
 
@@ -17,6 +17,8 @@
 // In case it hasn't been included yet.
 #include "single_tree_traverser.hpp"
 
+#include "../base_case_block.hpp"
+
 #include <stack>
 
 namespace mlpack {
@@ -48,8 +50,15 @@ SingleTreeTraverser<RuleType>::Traverse(
     BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>&
         referenceNode)
 {
-  // If we are a leaf, run the base case as necessary.
-  if (referenceNode.IsLeaf())
+  // If we are a leaf, run the base case as necessary.  If the rules can
+  // compute all the base cases at once, let them.
+  if (referenceNode.IsLeaf() && HasBaseCaseBlock<RuleType>::value)
+  {
+    arma::uvec queries(1);
+    queries[0] = queryIndex;
+    BaseCaseBlock(rule, queries, referenceNode.Begin(), referenceNode.Count());
+  }
+  else if (referenceNode.IsLeaf())
   {
     const size_t refEnd = referenceNode.Begin() + referenceNode.Count();
     for (size_t i = referenceNode.Begin(); i < refEnd; ++i)
@@ -0,0 +1,42 @@
+/**
+ * @file split_traits.hpp
+ *
+ * Definition of the SplitTraits class, which describes properties of the split
+ * types used by the BinarySpaceTree.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BINARY_SPACE_TREE_SPLIT_TRAITS_HPP
+#define MLPACK_CORE_TREE_BINARY_SPACE_TREE_SPLIT_TRAITS_HPP
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The SplitTraits class describes properties of a split type for the
+ * BinarySpaceTree.  The default values are correct for split types that only
+ * use static methods and do not draw random numbers; split types that do not
+ * fit this description should specialize this class.
+ */
+template<typename SplitType>
+class SplitTraits
+{
+ public:
+  /**
+   * This is true if SplitNode() may be called for disjoint nodes from several
+   * threads at once, giving the same splits as a serial build.  This is not
+   * the case for split types that keep state in the splitter object, or that
+   * draw from the global random number generator (whose draws would then
+   * depend on the scheduling of the threads).  When this is true, the
+   * BinarySpaceTree builds the children of large nodes in parallel.
+   */
+  static const bool ParallelSplitNode = true;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -14,6 +14,7 @@
 #define MLPACK_CORE_TREE_BINARY_SPACE_TREE_UB_TREE_SPLIT_HPP
 
 #include <mlpack/prereqs.hpp>
+#include "split_traits.hpp"
 #include "../address.hpp"
 
 namespace mlpack {
@@ -111,6 +112,17 @@ class UBTreeSplit
   }
 };
 
+/**
+ * The UBTreeSplit keeps the addresses of all points in the splitter object, and
+ * modifies them as nodes are split, so nodes cannot be split concurrently.
+ */
+template<typename BoundType, typename MatType>
+class SplitTraits<UBTreeSplit<BoundType, MatType>>
+{
+ public:
+  static const bool ParallelSplitNode = false;
+};
+
 } // namespace tree
 } // namespace mlpack
 
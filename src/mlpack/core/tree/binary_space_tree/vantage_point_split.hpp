@@ -14,6 +14,7 @@
 #define MLPACK_CORE_TREE_BINARY_SPACE_TREE_VANTAGE_POINT_SPLIT_HPP
 
 #include <mlpack/prereqs.hpp>
+#include "split_traits.hpp"
 #include <mlpack/core/tree/perform_split.hpp>
 #include <mlpack/core/math/random.hpp>
 
@@ -168,6 +169,17 @@ class VantagePointSplit
                                  ElemType& mu);
 };
 
+/**
+ * The VantagePointSplit draws random samples from the global random number
+ * generator, so nodes cannot be split concurrently.
+ */
+template<typename BoundType, typename MatType, size_t MaxNumSamples>
+class SplitTraits<VantagePointSplit<BoundType, MatType, MaxNumSamples>>
+{
+ public:
+  static const bool ParallelSplitNode = false;
+};
+
 } // namespace tree
 } // namespace mlpack
 
@@ -17,23 +17,31 @@
 namespace mlpack {
 namespace tree {
 
+// Loops over the columns of a node only run in parallel if they touch at least
+// this many elements; below that the threads cost more than they save.
+static const size_t minParallelElements = 65536;
+
 CosineTree::CosineTree(const arma::mat& dataset) :
     dataset(dataset),
+    delta(0.0),
     parent(NULL),
     left(NULL),
     right(NULL),
-    numColumns(dataset.n_cols)
+    numColumns(dataset.n_cols),
+    basisColumn(0),
+    numBasisVectors(0)
 {
   // Initialize sizes of column indices and l2 norms.
   indices.resize(numColumns);
   l2NormsSquared.zeros(numColumns);
 
   // Set indices and calculate squared norms of the columns.
-  for (size_t i = 0; i < numColumns; i++)
+  #pragma omp parallel for schedule(static) \
+      if (numColumns * dataset.n_rows >= minParallelElements)
+  for (omp_size_t i = 0; i < (omp_size_t) numColumns; i++)
   {
     indices[i] = i;
-    double l2Norm = arma::norm(dataset.col(i), 2);
-    l2NormsSquared(i) = l2Norm * l2Norm;
+    l2NormsSquared(i) = arma::dot(dataset.col(i), dataset.col(i));
   }
 
   // Frobenius norm of columns in the node.
@@ -42,6 +50,7 @@ CosineTree::CosineTree(const arma::mat& dataset) :
   // Calculate centroid of columns in the node.
   CalculateCentroid();
 
+  CalculateDistribution();
   splitPointIndex = ColumnSampleLS();
 }
 
@@ -51,7 +60,9 @@ CosineTree::CosineTree(CosineTree& parentNode,
     parent(&parentNode),
     left(NULL),
     right(NULL),
-    numColumns(subIndices.size())
+    numColumns(subIndices.size()),
+    basisColumn(0),
+    numBasisVectors(0)
 {
   // Initialize sizes of column indices and l2 norms.
   indices.resize(numColumns);
@@ -70,6 +81,7 @@ CosineTree::CosineTree(CosineTree& parentNode,
   // Calculate centroid of columns in the node.
   CalculateCentroid();
 
+  CalculateDistribution();
   splitPointIndex = ColumnSampleLS();
 }
 
@@ -78,17 +90,22 @@ CosineTree::CosineTree(const arma::mat& dataset,
                        const double delta) :
     dataset(dataset),
     delta(delta),
+    parent(NULL),
     left(NULL),
-    right(NULL)
+    right(NULL),
+    basisColumn(0),
+    numBasisVectors(0)
 {
   // Declare the cosine tree priority queue.
   CosineNodeQueue treeQueue;
 
-  // Define root node of the tree and add it to the queue.
+  // Define root node of the tree and add it to the queue.  Its basis vector is
+  // zero.
   CosineTree root(dataset);
-  arma::vec tempVector = arma::zeros(dataset.n_rows);
   root.L2Error(-1.0); // We don't know what the error is.
-  root.BasisVector(tempVector);
+  basis.zeros(dataset.n_rows, 16);
+  basisNodes.assign(1, &root);
+  numBasisVectors = 1;
   treeQueue.push(&root);
 
   // Initialize Monte Carlo error estimate for comparison.
@@ -97,10 +114,9 @@ CosineTree::CosineTree(const arma::mat& dataset,
   while (treeQueue.size() > 0 &&
          (monteCarloError > epsilon * root.FrobNormSquared()))
   {
-    // Pop node from queue with highest projection error.
+    // Take the node from the queue with the highest projection error.
     CosineTree* currentNode;
     currentNode = treeQueue.top();
-    treeQueue.pop();
 
     // If the priority is 0, we can't improve anything, and we can assume that
     // we've done the best we can.
@@ -113,9 +129,19 @@ CosineTree::CosineTree(const arma::mat& dataset,
       break;
     }
 
-    // Split the node into left and right children.  We assume that this cannot
-    // fail; it might fail if L2Error() is 0, but we have already avoided that
-    // case.
+    treeQueue.pop();
+
+    // A node with a single column can't be split; it can't be improved either.
+    if (currentNode->NumColumns() < 2)
+    {
+      currentNode->L2Error(0.0);
+      treeQueue.push(currentNode);
+      continue;
+    }
+
+    // Split the node into left and right children, and replace its basis
+    // vector with the basis vectors of the children.
+    RemoveFromBasis(currentNode);
     currentNode->CosineNodeSplit();
 
     // Obtain pointers to the left and right children of the current node.
@@ -123,31 +149,24 @@ CosineTree::CosineTree(const arma::mat& dataset,
     currentLeft = currentNode->Left();
     currentRight = currentNode->Right();
 
-    // Calculate basis vectors of left and right children.
-    arma::vec lBasisVector, rBasisVector;
-
-    ModifiedGramSchmidt(treeQueue, currentLeft->Centroid(), lBasisVector);
-    ModifiedGramSchmidt(treeQueue, currentRight->Centroid(), rBasisVector,
-                        &lBasisVector);
-
-    // Add basis vectors to their respective nodes.
-    currentLeft->BasisVector(lBasisVector);
-    currentRight->BasisVector(rBasisVector);
+    AddToBasis(currentLeft);
+    AddToBasis(currentRight);
 
     // Calculate Monte Carlo error estimates for child nodes.
-    MonteCarloError(currentLeft, treeQueue, &lBasisVector, &rBasisVector);
-    MonteCarloError(currentRight, treeQueue, &lBasisVector, &rBasisVector);
+    MonteCarloError(currentLeft);
+    MonteCarloError(currentRight);
 
     // Push child nodes into the priority queue.
     treeQueue.push(currentLeft);
     treeQueue.push(currentRight);
 
     // Calculate Monte Carlo error estimate for the root node.
-    monteCarloError = MonteCarloError(&root, treeQueue);
+    monteCarloError = MonteCarloError(&root);
   }
 
-  // Construct the subspace basis from the current priority queue.
-  ConstructBasis(treeQueue);
+  // The subspace basis is the used part of the basis matrix.
+  basis.resize(dataset.n_rows, numBasisVectors);
+  basisNodes.clear();
 }
 
 CosineTree::~CosineTree()
@@ -196,6 +215,38 @@ double CosineTree::MonteCarloError(CosineTree* node,
                                    CosineNodeQueue& treeQueue,
                                    arma::vec* addBasisVector1,
                                    arma::vec* addBasisVector2)
+{
+  // Collect the basis vectors of the queue, and the two additional basis
+  // vectors if they are passed.
+  const bool addVectors = (addBasisVector1 && addBasisVector2);
+  arma::mat currentBasis(node->GetDataset().n_rows,
+      treeQueue.size() + (addVectors ? 2 : 0));
+
+  size_t k = 0;
+  CosineNodeQueue::const_iterator j = treeQueue.begin();
+  for ( ; j != treeQueue.end(); j++, k++)
+    currentBasis.col(k) = (*j)->BasisVector();
+
+  if (addVectors)
+  {
+    currentBasis.col(k++) = *addBasisVector1;
+    currentBasis.col(k) = *addBasisVector2;
+  }
+
+  return MonteCarloError(node, currentBasis);
+}
+
+double CosineTree::MonteCarloError(CosineTree* node)
+{
+  // Alias the used part of the basis matrix.
+  const arma::mat currentBasis(basis.memptr(), basis.n_rows, numBasisVectors,
+      false, true);
+
+  return MonteCarloError(node, currentBasis);
+}
+
+double CosineTree::MonteCarloError(CosineTree* node,
+                                   const arma::mat& currentBasis)
 {
   std::vector<size_t> sampledIndices;
   arma::vec probabilities;
@@ -205,55 +256,22 @@ double CosineTree::MonteCarloError(CosineTree* node,
   size_t numSamples = log(node->NumColumns()) + 1;
   node->ColumnSamplesLS(sampledIndices, probabilities, numSamples);
 
-  // Get pointer to the original dataset.
-  arma::mat dataset = node->GetDataset();
-
   // Initialize weighted projection magnitudes as zeros.
   arma::vec weightedMagnitudes;
   weightedMagnitudes.zeros(numSamples);
 
-  // Set size of projection vector, depending on whether additional basis
-  // vectors are passed.
-  size_t projectionSize;
-  if (addBasisVector1 && addBasisVector2)
-    projectionSize = treeQueue.size() + 2;
-  else
-    projectionSize = treeQueue.size();
-
-  // For each sample, calculate the weighted projection onto the current basis.
-  for (size_t i = 0; i < numSamples; i++)
+  // Project all of the sampled columns onto the current basis at once, and
+  // weight the squared norms of the projections.
+  if (currentBasis.n_cols > 0)
   {
-    // Initialize projection as a vector of zeros.
-    arma::vec projection;
-    projection.zeros(projectionSize);
-
-    CosineTree *currentNode;
-    CosineNodeQueue::const_iterator j = treeQueue.begin();
-
-    size_t k = 0;
-    // Compute the projection of the sampled vector onto the existing subspace.
-    for ( ; j != treeQueue.end(); j++, k++)
-    {
-      currentNode = *j;
-
-      projection(k) = arma::dot(dataset.col(sampledIndices[i]),
-                                currentNode->BasisVector());
-    }
-    // If two additional vectors are passed, take their projections.
-    if (addBasisVector1 && addBasisVector2)
-    {
-      projection(k++) = arma::dot(dataset.col(sampledIndices[i]),
-                                  *addBasisVector1);
-      projection(k) = arma::dot(dataset.col(sampledIndices[i]),
-                                *addBasisVector2);
-    }
-
-    // Calculate the Frobenius norm squared of the projected vector.
-    double frobProjection = arma::norm(projection, "frob");
-    double frobProjectionSquared = frobProjection * frobProjection;
-
-    // Calculate the weighted projection magnitude.
-    weightedMagnitudes(i) = frobProjectionSquared / probabilities(i);
+    arma::uvec sampledColumns(numSamples);
+    for (size_t i = 0; i < numSamples; i++)
+      sampledColumns[i] = sampledIndices[i];
+
+    const arma::mat projections = currentBasis.t() *
+        node->GetDataset().cols(sampledColumns);
+    weightedMagnitudes = arma::sum(arma::square(projections), 0).t() /
+        probabilities;
   }
 
   // Compute mean and standard deviation of the weighted samples.
@@ -277,6 +295,49 @@ double CosineTree::MonteCarloError(CosineTree* node,
   return (node->FrobNormSquared() - lowerBound);
 }
 
+void CosineTree::AddToBasis(CosineTree* node)
+{
+  if (numBasisVectors == basis.n_cols)
+    basis.resize(basis.n_rows, 2 * basis.n_cols);
+
+  arma::vec newBasisVector = node->Centroid();
+  if (numBasisVectors > 0)
+  {
+    // Alias the used part of the basis matrix, and remove the projection of the
+    // centroid onto it.  The second pass restores the orthogonality that the
+    // first one loses to rounding errors.
+    const arma::mat currentBasis(basis.memptr(), basis.n_rows,
+        numBasisVectors, false, true);
+    for (size_t pass = 0; pass < 2; pass++)
+      newBasisVector -= currentBasis * (currentBasis.t() * newBasisVector);
+  }
+
+  // Normalize the modified centroid vector.
+  const double norm = arma::norm(newBasisVector, 2);
+  if (norm)
+    newBasisVector /= norm;
+
+  basis.col(numBasisVectors) = newBasisVector;
+  node->basisColumn = numBasisVectors;
+  basisNodes.push_back(node);
+  ++numBasisVectors;
+}
+
+void CosineTree::RemoveFromBasis(CosineTree* node)
+{
+  const size_t column = node->basisColumn;
+  const size_t last = numBasisVectors - 1;
+  if (column != last)
+  {
+    basis.col(column) = basis.col(last);
+    basisNodes[column] = basisNodes[last];
+    basisNodes[column]->basisColumn = column;
+  }
+
+  basisNodes.pop_back();
+  --numBasisVectors;
+}
+
 void CosineTree::ConstructBasis(CosineNodeQueue& treeQueue)
 {
   // Initialize basis as matrix of zeros.
@@ -336,29 +397,20 @@ void CosineTree::ColumnSamplesLS(std::vector<size_t>& sampledIndices,
                                  arma::vec& probabilities,
                                  size_t numSamples)
 {
-  // Initialize the cumulative distribution vector size.
-  arma::vec cDistribution;
-  cDistribution.zeros(numColumns + 1);
-
-  // Calculate cumulative length-squared distribution for the node.
-  for (size_t i = 0; i < numColumns; i++)
-  {
-    cDistribution(i + 1) = cDistribution(i) +
-        (l2NormsSquared(i) / frobNormSquared);
-  }
-
   // Initialize sizes of the 'sampledIndices' and 'probabilities' vectors.
   sampledIndices.resize(numSamples);
   probabilities.zeros(numSamples);
 
-  for (size_t i = 0; i < numSamples; i++)
-  {
-    // Generate a random value for sampling.
-    double randValue = arma::randu();
-    size_t start = 0, end = numColumns, searchIndex;
+  // Generate the random values for sampling first, so that the result does not
+  // depend on the number of threads.
+  const arma::vec randValues = arma::randu<arma::vec>(numSamples);
 
+  #pragma omp parallel for schedule(static) if (numSamples >= 1024)
+  for (omp_size_t i = 0; i < (omp_size_t) numSamples; i++)
+  {
     // Sample from the distribution and store corresponding probability.
-    searchIndex = BinarySearch(cDistribution, randValue, start, end);
+    const size_t searchIndex = BinarySearch(cDistribution, randValues[i], 0,
+        numColumns);
     sampledIndices[i] = indices[searchIndex];
     probabilities(i) = l2NormsSquared(searchIndex) / frobNormSquared;
   }
@@ -372,17 +424,6 @@ size_t CosineTree::ColumnSampleLS()
     return 0;
   }
 
-  // Initialize the cumulative distribution vector size.
-  arma::vec cDistribution;
-  cDistribution.zeros(numColumns + 1);
-
-  // Calculate cumulative length-squared distribution for the node.
-  for (size_t i = 0; i < numColumns; i++)
-  {
-    cDistribution(i + 1) = cDistribution(i) +
-        (l2NormsSquared(i) / frobNormSquared);
-  }
-
   // Generate a random value for sampling.
   double randValue = arma::randu();
   size_t start = 0, end = numColumns;
@@ -391,7 +432,18 @@ size_t CosineTree::ColumnSampleLS()
   return BinarySearch(cDistribution, randValue, start, end);
 }
 
-size_t CosineTree::BinarySearch(arma::vec& cDistribution,
+void CosineTree::CalculateDistribution()
+{
+  // Calculate cumulative length-squared distribution for the node.
+  cDistribution.zeros(numColumns + 1);
+  if (numColumns > 0)
+  {
+    cDistribution.subvec(1, numColumns) = arma::cumsum(l2NormsSquared) /
+        frobNormSquared;
+  }
+}
+
+size_t CosineTree::BinarySearch(const arma::vec& cDistribution,
                                 double value,
                                 size_t start,
                                 size_t end)
@@ -424,7 +476,9 @@ void CosineTree::CalculateCosines(arma::vec& cosines)
   // Initialize cosine vector as a vector of zeros.
   cosines.zeros(numColumns);
 
-  for (size_t i = 0; i < numColumns; i++)
+  #pragma omp parallel for schedule(static) \
+      if (numColumns * dataset.n_rows >= minParallelElements)
+  for (omp_size_t i = 0; i < (omp_size_t) numColumns; i++)
   {
     // If norm is zero, store cosine value as zero. Else, calculate cosine value
     // between two vectors.
@@ -446,10 +500,18 @@ void CosineTree::CalculateCentroid()
   // Initialize centroid as vector of zeros.
   centroid.zeros(dataset.n_rows);
 
-  // Calculate centroid of columns in the node.
-  for (size_t i = 0; i < numColumns; i++)
+  // Calculate centroid of columns in the node.  Each thread sums a part of the
+  // columns.
+  #pragma omp parallel if (numColumns * dataset.n_rows >= minParallelElements)
   {
-    centroid += dataset.col(indices[i]);
+    arma::vec threadCentroid(dataset.n_rows, arma::fill::zeros);
+
+    #pragma omp for schedule(static)
+    for (omp_size_t i = 0; i < (omp_size_t) numColumns; i++)
+      threadCentroid += dataset.col(indices[i]);
+
+    #pragma omp critical
+    centroid += threadCentroid;
   }
   centroid /= numColumns;
 }
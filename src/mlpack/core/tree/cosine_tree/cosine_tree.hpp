@@ -60,6 +60,13 @@ class CosineTree
    * input matrix's projection on the obtained subspace is less than a fraction
    * of the norm of the input matrix.
    *
+   * The basis vectors are kept as the columns of a single preallocated matrix
+   * while the tree is built: the centroids of new nodes are orthonormalized
+   * against it with two passes of classical Gram-Schmidt, and the Monte Carlo
+   * error estimates project all of the sampled columns at once.  The norms,
+   * cosines and centroids needed to split a node are computed in parallel (if
+   * OpenMP is available).
+   *
    * @param dataset Matrix for which the CosineTree is constructed.
    * @param epsilon Error tolerance fraction for calculated subspace.
    * @param delta Cumulative probability for Monte Carlo error lower bound.
@@ -120,17 +127,18 @@ class CosineTree
 
   /**
    * Sample 'numSamples' points from the Length-Squared distribution of the
-   * cosine node. The function uses 'l2NormsSquared' to calculate the cumulative
-   * probability distribution of the column vectors. The sampling is based on a
-   * randomly generated values in the range [0, 1].
+   * cosine node. The function uses the cumulative probability distribution of
+   * the column vectors, which is computed once when the node is built. The
+   * sampling is based on randomly generated values in the range [0, 1]; the
+   * values are drawn first and the searches are done in parallel.
    */
   void ColumnSamplesLS(std::vector<size_t>& sampledIndices,
                        arma::vec& probabilities, size_t numSamples);
 
   /**
    * Sample a point from the Length-Squared distribution of the cosine node. The
-   * function uses 'l2NormsSquared' to calculate the cumulative probability
-   * distribution of the column vectors. The sampling is based on a randomly
+   * function uses the cumulative probability distribution of the column
+   * vectors. The sampling is based on a randomly
    * generated value in the range [0, 1].
    */
   size_t ColumnSampleLS();
@@ -147,7 +155,9 @@ class CosineTree
    * @param start Starting index of the distribution interval to search in.
    * @param end Ending index of the distribution interval to search in.
    */
-  size_t BinarySearch(arma::vec& cDistribution, double value, size_t start,
+  size_t BinarySearch(const arma::vec& cDistribution,
+                      double value,
+                      size_t start,
                       size_t end);
 
   /**
@@ -213,6 +223,43 @@ class CosineTree
   size_t SplitPointIndex() const { return indices[splitPointIndex]; }
 
  private:
+  /**
+   * Orthonormalize the centroid of the given node against the first
+   * 'numBasisVectors' columns of the basis, and append it to the basis.  The
+   * basis matrix grows geometrically if it is full.
+   *
+   * @param node Node whose centroid is added to the basis.
+   */
+  void AddToBasis(CosineTree* node);
+
+  /**
+   * Remove the basis vector of the given node from the basis, by moving the
+   * last basis vector into its column.
+   *
+   * @param node Node whose basis vector is removed.
+   */
+  void RemoveFromBasis(CosineTree* node);
+
+  /**
+   * Estimate the squared error of the projection of the node's matrix onto the
+   * first 'numBasisVectors' columns of the basis, and store it in the node.
+   *
+   * @param node Node for which Monte Carlo estimate is calculated.
+   */
+  double MonteCarloError(CosineTree* node);
+
+  /**
+   * Estimate the squared error of the projection of the node's matrix onto the
+   * span of the given orthonormal basis, and store it in the node.
+   *
+   * @param node Node for which Monte Carlo estimate is calculated.
+   * @param currentBasis Orthonormal basis to project onto.
+   */
+  double MonteCarloError(CosineTree* node, const arma::mat& currentBasis);
+
+  //! Compute the cumulative Length-Squared distribution of the node.
+  void CalculateDistribution();
+
   //! Matrix for which cosine tree is constructed.
   const arma::mat& dataset;
   //! Cumulative probability for Monte Carlo error lower bound.
@@ -241,6 +288,14 @@ class CosineTree
   double l2Error;
   //! Frobenius norm squared of columns in the node.
   double frobNormSquared;
+  //! Cumulative Length-Squared distribution of columns in the node.
+  arma::vec cDistribution;
+  //! Column of the basis that holds the basis vector of the node.
+  size_t basisColumn;
+  //! Number of basis vectors in the basis during construction.
+  size_t numBasisVectors;
+  //! Node owning each column of the basis during construction.
+  std::vector<CosineTree*> basisNodes;
 };
 
 class CompareCosineNode
@@ -15,6 +15,7 @@
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/math/range.hpp>
 
+#include "../node_arena.hpp"
 #include "../statistic.hpp"
 #include "first_point_is_root.hpp"
 
@@ -50,6 +51,10 @@ namespace tree {
  * -- non-leaf nodes with more than one child.  A leaf node has no children, and
  * its scale level is INT_MIN.
  *
+ * The nodes below the root that are created when the tree is built are
+ * allocated from a NodeArena owned by the root, and are freed all at once with
+ * it; nodes created by hand are allocated with new.
+ *
  * For more information on cover trees, see
  *
  * @code
@@ -251,6 +256,56 @@ class CoverTree
    */
   ~CoverTree();
 
+  /**
+   * Insert the given point of the dataset into the tree.  The point must be a
+   * column of the dataset that is not held in the tree yet (for instance, a
+   * column that was appended to the dataset after the tree was built, or a
+   * point that was removed with Remove()).  The point is added as a leaf below
+   * the deepest node that covers it, so the covering invariant holds; if the
+   * point is too close to a child of that node to be separated from it at the
+   * scale of the child, the scale of the child is raised so that it covers the
+   * point, and the point is added below it instead.  The number of
+   * descendants, the furthest descendant distance, and the statistic of each
+   * node on the way down are updated.
+   *
+   * This may only be called on the root of the tree.
+   *
+   * @param pointIndex Index of the point in the dataset.
+   */
+  void Insert(const size_t pointIndex);
+
+  /**
+   * Append the given points to the dataset and insert them into the tree.  The
+   * tree must own its dataset (that is, it must have been built with one of
+   * the constructors that take the dataset with std::move()).  The points are
+   * inserted in order of decreasing distance to the root, so the scale of the
+   * root is raised at most once, and the points that end up in the upper
+   * levels of the tree are placed before the points below them.
+   *
+   * This may only be called on the root of the tree.
+   *
+   * @param points Points to insert.
+   */
+  void Insert(const MatType& points);
+
+  /**
+   * Remove the given point from the tree.  The point stays in the dataset, so
+   * the indices of the other points do not change.  The subtree of the
+   * highest node holding the point is detached, and the other points of that
+   * subtree are inserted again; so, the cost of removing a point depends on
+   * its level in the tree (most points are only held by nodes near the
+   * leaves, but removing the point of the root rebuilds the whole tree).  The
+   * furthest descendant distances of the ancestors of the subtree are left as
+   * they are, since they are still valid bounds.
+   *
+   * This may only be called on the root of the tree, and the last point of
+   * the tree can't be removed.
+   *
+   * @param pointIndex Index of the point in the dataset.
+   * @return Whether the point was found in the tree.
+   */
+  bool Remove(const size_t pointIndex);
+
   //! A single-tree cover tree traverser; see single_tree_traverser.hpp for
   //! implementation.
   template<typename RuleType>
@@ -310,6 +365,10 @@ class CoverTree
   //! Modify the statistic for this node.
   StatisticType& Stat() { return stat; }
 
+  //! Get the arena holding the nodes of the tree below the root (NULL if the
+  //! nodes are not in an arena); see NodeArena.
+  const NodeArena* Arena() const { return arena; }
+
   /**
    * Return the index of the nearest child node to the given query point.  If
    * this is a leaf node, it will return NumChildren() (invalid index).
@@ -411,7 +470,8 @@ class CoverTree
   //! Get the center of the node and store it in the given vector.
   void Center(arma::vec& center) const
   {
-    center = arma::vec(dataset->col(point));
+    center = arma::conv_to<arma::vec>::from(
+        arma::Col<ElemType>(dataset->col(point)));
   }
 
   //! Get the instantiated metric.
@@ -444,6 +504,10 @@ class CoverTree
   bool localDataset;
   //! The metric used for this tree.
   MetricType* metric;
+  #ifdef MLPACK_MEMORY_TRACKING
+  //! Counts this node in the MemoryTracker.
+  TrackedObject<CoverTree> tracked;
+  #endif
 
   /**
    * Create the children for this node.
@@ -533,6 +597,44 @@ class CoverTree
    */
   void RemoveNewImplicitNodes();
 
+  /**
+   * Insert the given points of the dataset in order of decreasing distance to
+   * the root (this is the batch path of Insert() and Remove()).
+   *
+   * @param pointIndices Indices of the points to insert.
+   */
+  void InsertPoints(const std::vector<size_t>& pointIndices);
+
+  /**
+   * Return the smallest scale at which a node covers a point at the given
+   * (nonzero) distance.
+   */
+  int CoveringScale(const ElemType distance) const;
+
+  /**
+   * Create a leaf holding the given point below the given node.  The leaf is
+   * not added to the children of the node.
+   *
+   * @param pointIndex Index of the point of the leaf.
+   * @param leafParent Parent of the leaf.
+   * @param leafParentDistance Distance between the leaf and its parent.
+   */
+  CoverTree* CreateLeaf(const size_t pointIndex,
+                        CoverTree* leafParent,
+                        const ElemType leafParentDistance);
+
+  /**
+   * Return the highest node below this one that holds the given point, or
+   * NULL if the point is not in the tree.
+   */
+  CoverTree* FindNode(const size_t pointIndex);
+
+  /**
+   * While this node only has its self-child, take the children and the scale
+   * of the self-child instead (this can happen after a subtree is removed).
+   */
+  void RemoveImplicitSelfChild();
+
  protected:
   /**
    * A default constructor.  This is meant to only be used with
@@ -557,6 +659,11 @@ class CoverTree
 
  private:
   size_t distanceComps;
+  //! For the root, the arena holding the other nodes of the tree, which the
+  //! root owns (see NodeArena).  For any other node, the arena it was
+  //! allocated from (NULL if it was allocated with new), which its children
+  //! are allocated from too.
+  NodeArena* arena;
 };
 
 } // namespace tree
@@ -15,7 +15,11 @@
 // In case it hasn't already been included.
 #include "cover_tree.hpp"
 
+#include <algorithm>
+#include <functional>
 #include <queue>
+#include <sstream>
+#include <stack>
 #include <string>
 
 namespace mlpack {
@@ -43,7 +47,8 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
     localMetric(metric == NULL),
     localDataset(false),
     metric(metric),
-    distanceComps(0)
+    distanceComps(0),
+    arena(NULL)
 {
   // If we need to create a metric, do that.  We'll just do it on the heap.
   if (localMetric)
@@ -54,6 +59,7 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
   if (dataset.n_cols <= 1)
   {
     scale = INT_MIN;
+    numDescendants = dataset.n_cols;
     return;
   }
 
@@ -100,7 +106,7 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
     scale = old->Scale();
 
     // Now delete it.
-    delete old;
+    DeleteNode(old, old->arena);
   }
 
   // Use the furthest descendant distance to determine the scale of the root
@@ -138,13 +144,15 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
     localMetric(false),
     localDataset(false),
     metric(&metric),
-    distanceComps(0)
+    distanceComps(0),
+    arena(NULL)
 {
   // If there is only one point or zero points in the dataset... uh, we're done.
   // Technically, if the dataset has zero points, our node is not correct...
   if (dataset.n_cols <= 1)
   {
     scale = INT_MIN;
+    numDescendants = dataset.n_cols;
     return;
   }
 
@@ -192,7 +200,7 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
     scale = old->Scale();
 
     // Now delete it.
-    delete old;
+    DeleteNode(old, old->arena);
   }
 
   // Use the furthest descendant distance to determine the scale of the root
@@ -228,7 +236,8 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
     furthestDescendantDistance(0),
     localMetric(true),
     localDataset(true),
-    distanceComps(0)
+    distanceComps(0),
+    arena(NULL)
 {
   // We need to create a metric.  We'll just do it on the heap.
   this->metric = new MetricType();
@@ -238,6 +247,7 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
   if (dataset->n_cols <= 1)
   {
     scale = INT_MIN;
+    numDescendants = dataset->n_cols;
     return;
   }
 
@@ -284,7 +294,7 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
     scale = old->Scale();
 
     // Now delete it.
-    delete old;
+    DeleteNode(old, old->arena);
   }
 
   // Use the furthest descendant distance to determine the scale of the root
@@ -322,13 +332,15 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
     localMetric(false),
     localDataset(true),
     metric(&metric),
-    distanceComps(0)
+    distanceComps(0),
+    arena(NULL)
 {
   // If there is only one point or zero points in the dataset... uh, we're done.
   // Technically, if the dataset has zero points, our node is not correct...
   if (dataset->n_cols <= 1)
   {
     scale = INT_MIN;
+    numDescendants = dataset->n_cols;
     return;
   }
 
@@ -375,7 +387,7 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
     scale = old->Scale();
 
     // Now delete it.
-    delete old;
+    DeleteNode(old, old->arena);
   }
 
   // Use the furthest descendant distance to determine the scale of the root
@@ -422,7 +434,8 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
     localMetric(false),
     localDataset(false),
     metric(&metric),
-    distanceComps(0)
+    distanceComps(0),
+    arena(parent->arena)
 {
   // If the size of the near set is 0, this is a leaf.
   if (nearSetSize == 0)
@@ -467,7 +480,8 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
     localMetric(metric == NULL),
     localDataset(false),
     metric(metric),
-    distanceComps(0)
+    distanceComps(0),
+    arena(NULL)
 {
   // If necessary, create a local metric.
   if (localMetric)
@@ -498,7 +512,8 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
     localMetric(false),
     localDataset(other.parent == NULL && other.localDataset),
     metric(other.metric),
-    distanceComps(0)
+    distanceComps(0),
+    arena(NULL)
 {
   // Copy each child by hand.
   for (size_t i = 0; i < other.NumChildren(); ++i)
@@ -548,7 +563,8 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
     localMetric(other.localMetric),
     localDataset(other.localDataset),
     metric(other.metric),
-    distanceComps(other.distanceComps)
+    distanceComps(other.distanceComps),
+    arena(other.arena)
 {
   // Set proper parent pointer.
   for (size_t i = 0; i < children.size(); ++i)
@@ -565,6 +581,7 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
   other.localMetric = false;
   other.localDataset = false;
   other.metric = NULL;
+  other.arena = NULL;
 }
 
 // Construct from a boost::serialization archive.
@@ -595,7 +612,7 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::~CoverTree()
 {
   // Delete each child.
   for (size_t i = 0; i < children.size(); ++i)
-    delete children[i];
+    DeleteNode(children[i], children[i]->arena);
 
   // Delete the local metric, if necessary.
   if (localMetric)
@@ -604,6 +621,254 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::~CoverTree()
   // Delete the local dataset, if necessary.
   if (localDataset)
     delete dataset;
+
+  // If we're the root, delete the arena of the nodes (which have all been
+  // destructed now).
+  if (!parent)
+    delete arena;
+}
+
+// Insert a point of the dataset into the tree.
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::Insert(
+    const size_t pointIndex)
+{
+  if (parent != NULL)
+    throw std::invalid_argument("CoverTree::Insert(): points can only be "
+        "inserted at the root of the tree!");
+
+  if (pointIndex >= dataset->n_cols)
+  {
+    std::ostringstream oss;
+    oss << "CoverTree::Insert(): point " << pointIndex << " is not in the "
+        << "dataset (which has " << dataset->n_cols << " points)!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // If the tree is empty, the point becomes the root.
+  if (numDescendants == 0)
+  {
+    point = pointIndex;
+    scale = INT_MIN;
+    numDescendants = 1;
+    stat = StatisticType(*this);
+    return;
+  }
+
+  ElemType distance = metric->Evaluate(dataset->col(point),
+      dataset->col(pointIndex));
+  ++distanceComps;
+
+  if (children.empty())
+  {
+    // The root is the only point, so it needs a self-child.
+    scale = (distance == 0) ? INT_MIN : CoveringScale(distance);
+    children.push_back(CreateLeaf(point, this, 0));
+  }
+  else if (distance > pow(base, scale))
+  {
+    // Raise the scale of the root so that it covers the point.  Its children
+    // are at smaller scales, so they are still covered too.
+    scale = CoveringScale(distance);
+  }
+
+  // The nodes that the point is inserted below, with their distances to it.
+  std::vector<std::pair<CoverTree*, ElemType>> path;
+  path.push_back(std::make_pair(this, distance));
+
+  CoverTree* node = this;
+  while (true)
+  {
+    // Find the closest child that covers the point, and the closest child.
+    CoverTree* covering = NULL;
+    ElemType coveringDistance = 0;
+    CoverTree* closest = NULL;
+    ElemType closestDistance = 0;
+    for (size_t i = 0; i < node->children.size(); ++i)
+    {
+      CoverTree* child = node->children[i];
+
+      ElemType childDistance = distance;
+      if (child->point != node->point)
+      {
+        childDistance = metric->Evaluate(dataset->col(child->point),
+            dataset->col(pointIndex));
+        ++distanceComps;
+      }
+
+      if (!child->children.empty() &&
+          childDistance <= pow(base, child->scale) &&
+          (covering == NULL || childDistance < coveringDistance))
+      {
+        covering = child;
+        coveringDistance = childDistance;
+      }
+
+      if (closest == NULL || childDistance < closestDistance)
+      {
+        closest = child;
+        closestDistance = childDistance;
+      }
+    }
+
+    if (covering != NULL)
+    {
+      node = covering;
+      distance = coveringDistance;
+      path.push_back(std::make_pair(node, distance));
+      continue;
+    }
+
+    // If the point is too close to the closest child to be separated from it
+    // below the scale of this node, raise the scale of the child so that it
+    // covers the point, and insert the point below it.  (Duplicate points
+    // stay leaves next to each other, as when the tree is built.)
+    if (closestDistance > 0 && node->scale != INT_MIN &&
+        closestDistance <= pow(base, node->scale - 1))
+    {
+      closest->scale = std::max(std::min(CoveringScale(closestDistance),
+          node->scale - 1), closest->scale + 1);
+
+      // A leaf needs a self-child to hold its point.
+      if (closest->children.empty())
+        closest->children.push_back(CreateLeaf(closest->point, closest, 0));
+
+      node = closest;
+      distance = closestDistance;
+      path.push_back(std::make_pair(node, distance));
+      continue;
+    }
+
+    // Otherwise, the point is a new leaf of this node.
+    node->children.push_back(CreateLeaf(pointIndex, node, distance));
+    break;
+  }
+
+  // Update the nodes above the new leaf, from the bottom up.
+  for (size_t i = path.size(); i > 0; --i)
+  {
+    CoverTree* pathNode = path[i - 1].first;
+    ++pathNode->numDescendants;
+    if (path[i - 1].second > pathNode->furthestDescendantDistance)
+      pathNode->furthestDescendantDistance = path[i - 1].second;
+    pathNode->stat = StatisticType(*pathNode);
+  }
+}
+
+// Append points to the dataset and insert them into the tree.
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::Insert(
+    const MatType& points)
+{
+  if (parent != NULL)
+    throw std::invalid_argument("CoverTree::Insert(): points can only be "
+        "inserted at the root of the tree!");
+  if (!localDataset)
+    throw std::invalid_argument("CoverTree::Insert(): points can only be "
+        "appended to a dataset that is owned by the tree!");
+  if (dataset->n_cols > 0 && points.n_rows != dataset->n_rows)
+  {
+    std::ostringstream oss;
+    oss << "CoverTree::Insert(): dimensionality of the points ("
+        << points.n_rows << ") is not the dimensionality of the dataset ("
+        << dataset->n_rows << ")!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // We own the dataset, so we can modify it.
+  const size_t oldSize = dataset->n_cols;
+  const_cast<MatType*>(dataset)->insert_cols(oldSize, points);
+
+  std::vector<size_t> pointIndices(points.n_cols);
+  for (size_t i = 0; i < points.n_cols; ++i)
+    pointIndices[i] = oldSize + i;
+
+  InsertPoints(pointIndices);
+}
+
+// Remove a point from the tree.
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+bool CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::Remove(
+    const size_t pointIndex)
+{
+  if (parent != NULL)
+    throw std::invalid_argument("CoverTree::Remove(): points can only be "
+        "removed at the root of the tree!");
+
+  CoverTree* node = (numDescendants == 0) ? NULL : FindNode(pointIndex);
+  if (node == NULL)
+    return false;
+
+  if (numDescendants == 1)
+    throw std::invalid_argument("CoverTree::Remove(): the last point of the "
+        "tree can't be removed!");
+
+  // Collect the other points of the subtree of the node (each point is held by
+  // exactly one leaf); they will be inserted again.
+  std::vector<size_t> orphans;
+  orphans.reserve(node->numDescendants - 1);
+  std::stack<const CoverTree*> stack;
+  stack.push(node);
+  while (!stack.empty())
+  {
+    const CoverTree* n = stack.top();
+    stack.pop();
+
+    if (n->children.empty() && n->point != pointIndex)
+      orphans.push_back(n->point);
+    for (size_t i = 0; i < n->children.size(); ++i)
+      stack.push(n->children[i]);
+  }
+
+  if (node == this)
+  {
+    // The point of the root is removed, so the tree is rebuilt around one of
+    // the other points.
+    for (size_t i = 0; i < children.size(); ++i)
+      DeleteNode(children[i], children[i]->arena);
+    children.clear();
+
+    point = orphans[0];
+    scale = INT_MIN;
+    numDescendants = 1;
+    furthestDescendantDistance = 0;
+    stat = StatisticType(*this);
+    orphans.erase(orphans.begin());
+  }
+  else
+  {
+    // Detach the subtree, and update the nodes above it.
+    CoverTree* nodeParent = node->parent;
+    nodeParent->children.erase(std::find(nodeParent->children.begin(),
+        nodeParent->children.end(), node));
+    const size_t removed = node->numDescendants;
+    DeleteNode(node, node->arena);
+
+    nodeParent->RemoveImplicitSelfChild();
+    for (CoverTree* n = nodeParent; n != NULL; n = n->parent)
+    {
+      n->numDescendants -= removed;
+      n->stat = StatisticType(*n);
+    }
+  }
+
+  InsertPoints(orphans);
+  return true;
 }
 
 //! Return the number of descendant points.
@@ -989,6 +1254,11 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CreateChildren(
     size_t& farSetSize,
     size_t& usedSetSize)
 {
+  // The nodes of the tree are allocated from the arena of the root, which
+  // creates it for its first children.
+  if (parent == NULL && arena == NULL)
+    arena = new NodeArena();
+
   // Determine the next scale level.  This should be the first level where there
   // are any points in the far set.  So, if we know the maximum distance in the
   // distances array, this will be the largest i such that
@@ -1004,15 +1274,16 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CreateChildren(
     // Make the self child at the lowest possible level.
     // This should not modify farSetSize or usedSetSize.
     size_t tempSize = 0;
-    children.push_back(new CoverTree(*dataset, base, point, INT_MIN, this, 0,
-        indices, distances, 0, tempSize, usedSetSize, *metric));
+    children.push_back(NewNode<CoverTree>(arena, *dataset, base, point,
+        INT_MIN, this, 0, indices, distances, 0, tempSize, usedSetSize,
+        *metric));
     distanceComps += children.back()->DistanceComps();
 
     // Every point in the near set should be a leaf.
     for (size_t i = 0; i < nearSetSize; ++i)
     {
       // farSetSize and usedSetSize will not be modified.
-      children.push_back(new CoverTree(*dataset, base, indices[i],
+      children.push_back(NewNode<CoverTree>(arena, *dataset, base, indices[i],
           INT_MIN, this, distances[i], indices, distances, 0, tempSize,
           usedSetSize, *metric));
       distanceComps += children.back()->DistanceComps();
@@ -1044,9 +1315,9 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CreateChildren(
   // Build the self child (recursively).
   size_t childFarSetSize = nearSetSize - childNearSetSize;
   size_t childUsedSetSize = 0;
-  children.push_back(new CoverTree(*dataset, base, point, nextScale, this, 0,
-      indices, distances, childNearSetSize, childFarSetSize, childUsedSetSize,
-      *metric));
+  children.push_back(NewNode<CoverTree>(arena, *dataset, base, point,
+      nextScale, this, 0, indices, distances, childNearSetSize,
+      childFarSetSize, childUsedSetSize, *metric));
   // Don't double-count the self-child (so, subtract one).
   numDescendants += children[0]->NumDescendants();
 
@@ -1102,9 +1373,9 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CreateChildren(
     if ((nearSetSize == 1) && (farSetSize == 0))
     {
       size_t childNearSetSize = 0;
-      children.push_back(new CoverTree(*dataset, base, indices[0], nextScale,
-          this, distances[0], indices, distances, childNearSetSize, farSetSize,
-          usedSetSize, *metric));
+      children.push_back(NewNode<CoverTree>(arena, *dataset, base,
+          indices[0], nextScale, this, distances[0], indices, distances,
+          childNearSetSize, farSetSize, usedSetSize, *metric));
       distanceComps += children.back()->DistanceComps();
       numDescendants += children.back()->NumDescendants();
 
@@ -1144,9 +1415,9 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CreateChildren(
 
     // Build this child (recursively).
     childUsedSetSize = 1; // Mark self point as used.
-    children.push_back(new CoverTree(*dataset, base, indices[0], nextScale,
-        this, distances[0], childIndices, childDistances, childNearSetSize,
-        childFarSetSize, childUsedSetSize, *metric));
+    children.push_back(NewNode<CoverTree>(arena, *dataset, base, indices[0],
+        nextScale, this, distances[0], childIndices, childDistances,
+        childNearSetSize, childFarSetSize, childUsedSetSize, *metric));
     numDescendants += children.back()->NumDescendants();
 
     // Remove any implicit nodes.
@@ -1243,7 +1514,20 @@ void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
   // For each point, rebuild the distances.  The indices do not need to be
   // modified.
   distanceComps += pointSetSize;
-  for (size_t i = 0; i < pointSetSize; ++i)
+
+  // The distances are independent, so large point sets (which occur near the
+  // top of the tree, where most of the construction time is spent) are handled
+  // in parallel.  Which points go into which child only depends on the
+  // distances, so the tree is the same as for a serial build.  Small sets are
+  // not worth a parallel region, and we do not nest parallel regions.
+  #ifdef HAS_OPENMP
+  const size_t minParallelSize = 4096;
+  const bool parallel = (pointSetSize >= minParallelSize) &&
+      !omp_in_parallel() && (omp_get_max_threads() > 1);
+  #endif
+
+  #pragma omp parallel for schedule(static) if (parallel)
+  for (omp_size_t i = 0; i < (omp_size_t) pointSetSize; ++i)
   {
     distances[i] = metric->Evaluate(dataset->col(pointIndex),
         dataset->col(indices[i]));
@@ -1536,7 +1820,187 @@ inline void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
     old->Children().erase(old->Children().begin() + old->Children().size() - 1);
 
     // Now delete it.
-    delete old;
+    DeleteNode(old, old->arena);
+  }
+}
+
+/**
+ * Insert the given points in order of decreasing distance to the root.
+ */
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
+    InsertPoints(const std::vector<size_t>& pointIndices)
+{
+  if (pointIndices.empty())
+    return;
+
+  // If the tree is empty, the first point becomes the root.
+  size_t first = 0;
+  if (numDescendants == 0)
+    Insert(pointIndices[first++]);
+
+  std::vector<std::pair<ElemType, size_t>> order;
+  order.reserve(pointIndices.size() - first);
+  for (size_t i = first; i < pointIndices.size(); ++i)
+  {
+    order.push_back(std::make_pair(metric->Evaluate(dataset->col(point),
+        dataset->col(pointIndices[i])), pointIndices[i]));
+  }
+  distanceComps += order.size();
+
+  std::sort(order.begin(), order.end(),
+      std::greater<std::pair<ElemType, size_t>>());
+  for (size_t i = 0; i < order.size(); ++i)
+    Insert(order[i].second);
+}
+
+/**
+ * Return the smallest scale at which a node covers a point at the given
+ * distance.
+ */
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+int CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
+    CoveringScale(const ElemType distance) const
+{
+  int coveringScale = (int) ceil(log(distance) / log(base));
+
+  // Correct for any rounding error in the logarithms.
+  while (pow(base, coveringScale) < distance)
+    ++coveringScale;
+  while (pow(base, coveringScale - 1) >= distance)
+    --coveringScale;
+
+  return coveringScale;
+}
+
+/**
+ * Create a leaf holding the given point.
+ */
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>*
+CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CreateLeaf(
+    const size_t pointIndex,
+    CoverTree* leafParent,
+    const ElemType leafParentDistance)
+{
+  // Nodes that are inserted later are not allocated from the arena, since the
+  // tree may have been built without one (or loaded from an archive).
+  CoverTree* leaf = new CoverTree(*dataset, base, pointIndex, INT_MIN,
+      leafParent, leafParentDistance, 0, metric);
+  leaf->numDescendants = 1;
+  leaf->stat = StatisticType(*leaf);
+  return leaf;
+}
+
+/**
+ * Find the highest node holding the given point.
+ */
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>*
+CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::FindNode(
+    const size_t pointIndex)
+{
+  if (point == pointIndex)
+    return this;
+  if (pointIndex >= dataset->n_cols)
+    return NULL;
+
+  // Only the subtrees whose furthest descendant distance reaches the point can
+  // hold it.
+  std::stack<std::pair<CoverTree*, ElemType>> stack;
+  stack.push(std::make_pair(this, metric->Evaluate(dataset->col(point),
+      dataset->col(pointIndex))));
+  ++distanceComps;
+  while (!stack.empty())
+  {
+    CoverTree* node = stack.top().first;
+    const ElemType distance = stack.top().second;
+    stack.pop();
+
+    for (size_t i = 0; i < node->children.size(); ++i)
+    {
+      CoverTree* child = node->children[i];
+      // No node above the child holds the point, so this is the highest one.
+      if (child->point == pointIndex)
+        return child;
+      if (child->children.empty())
+        continue;
+
+      ElemType childDistance = distance;
+      if (child->point != node->point)
+      {
+        childDistance = metric->Evaluate(dataset->col(child->point),
+            dataset->col(pointIndex));
+        ++distanceComps;
+      }
+
+      if (childDistance <= child->furthestDescendantDistance)
+        stack.push(std::make_pair(child, childDistance));
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * Replace the self-child of this node by its children, while it is the only
+ * child.
+ */
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
+    RemoveImplicitSelfChild()
+{
+  while (children.size() == 1)
+  {
+    CoverTree* old = children[0];
+    children.clear();
+
+    if (old->children.empty())
+    {
+      // This node is a leaf now.
+      scale = INT_MIN;
+      furthestDescendantDistance = 0;
+    }
+    else
+    {
+      // Take the children of the self-child; their distances to this node are
+      // the same.
+      for (size_t i = 0; i < old->children.size(); ++i)
+      {
+        children.push_back(old->children[i]);
+        old->children[i]->parent = this;
+        old->children[i]->stat = StatisticType(*old->children[i]);
+      }
+      old->children.clear();
+      scale = old->scale;
+    }
+
+    DeleteNode(old, old->arena);
   }
 }
 
@@ -1561,7 +2025,8 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree() :
     localMetric(false),
     localDataset(false),
     metric(NULL),
-    distanceComps(0)
+    distanceComps(0),
+    arena(NULL)
 {
   // Nothing to do.
 }
@@ -1585,7 +2050,7 @@ void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::serialize(
   if (Archive::is_loading::value)
   {
     for (size_t i = 0; i < children.size(); ++i)
-      delete children[i];
+      DeleteNode(children[i], children[i]->arena);
 
     if (localMetric && metric)
       delete metric;
@@ -0,0 +1,144 @@
+/**
+ * @file fixed_dimension.hpp
+ *
+ * Selection of the types specialized for a dimensionality that is fixed at
+ * compile time (FixedLMetric, FixedHRectBound) from the dimensionality of a
+ * dataset, which is only known at runtime.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_FIXED_DIMENSION_HPP
+#define MLPACK_CORE_TREE_FIXED_DIMENSION_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+#include "fixed_hrectbound.hpp"
+#include "binary_space_tree.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The metric, bound and kd-tree types for data of dimensionality Dim, whose
+ * distance calculations are loops over exactly Dim elements.  FixedDimension<0>
+ * gives the usual types, for any dimensionality.
+ *
+ * @code
+ * // A kd-tree for 3-D data, with the Euclidean distance.
+ * typedef FixedDimension<3> Fixed;
+ * Fixed::KDTree<Fixed::EuclideanDistance, EmptyStatistic, arma::mat>
+ *     tree(dataset);
+ * @endcode
+ *
+ * @tparam Dim Dimensionality of the data (0 if it is not fixed).
+ */
+template<size_t Dim>
+struct FixedDimension
+{
+  //! The dimensionality.
+  static const size_t Value = Dim;
+
+  //! The L-metric with the given power.
+  template<int Power, bool TakeRoot = true>
+  using LMetric = metric::FixedLMetric<Dim, Power, TakeRoot>;
+
+  //! The Euclidean (L2) distance.
+  typedef metric::FixedLMetric<Dim, 2, true> EuclideanDistance;
+
+  //! The hyper-rectangle bound; MetricType must be an LMetric or a
+  //! FixedLMetric.
+  template<typename MetricType, typename ElemType = double>
+  using HRectBound = bound::FixedHRectBound<Dim, MetricType, ElemType>;
+
+  //! The midpoint-split kd-tree; this satisfies the TreeType policy API.
+  template<typename MetricType, typename StatisticType, typename MatType>
+  using KDTree = BinarySpaceTree<MetricType,
+                                 StatisticType,
+                                 MatType,
+                                 HRectBound,
+                                 MidpointSplit>;
+};
+
+/**
+ * The usual types, for data whose dimensionality is not fixed.
+ */
+template<>
+struct FixedDimension<0>
+{
+  //! The dimensionality (not fixed).
+  static const size_t Value = 0;
+
+  //! The L-metric with the given power.
+  template<int Power, bool TakeRoot = true>
+  using LMetric = metric::LMetric<Power, TakeRoot>;
+
+  //! The Euclidean (L2) distance.
+  typedef metric::EuclideanDistance EuclideanDistance;
+
+  //! The hyper-rectangle bound.
+  template<typename MetricType, typename ElemType = double>
+  using HRectBound = bound::HRectBound<MetricType, ElemType>;
+
+  //! The midpoint-split kd-tree; this satisfies the TreeType policy API.
+  template<typename MetricType, typename StatisticType, typename MatType>
+  using KDTree = tree::KDTree<MetricType, StatisticType, MatType>;
+};
+
+/**
+ * Call the given function object with the dimensionality of the data as a
+ * compile-time constant, so that it can use the types of FixedDimension.  The
+ * function is given std::integral_constant<size_t, Dim>, where Dim is the
+ * given dimensionality if it is 2, 3, 4, 8 or 16, and 0 otherwise, so its
+ * operator() must be a template.  Each of these dimensionalities is compiled
+ * separately, so this should only wrap code whose cost depends on the distance
+ * calculations, like a dual-tree algorithm.
+ *
+ * @code
+ * struct Run
+ * {
+ *   template<size_t Dim>
+ *   void operator()(std::integral_constant<size_t, Dim>) const
+ *   {
+ *     typedef FixedDimension<Dim> Fixed;
+ *     // Use Fixed::KDTree and Fixed::EuclideanDistance...
+ *   }
+ * };
+ *
+ * DispatchFixedDimension(dataset.n_rows, Run());
+ * @endcode
+ *
+ * @param dimension Dimensionality of the data.
+ * @param function Function to call.
+ */
+template<typename FunctionType>
+void DispatchFixedDimension(const size_t dimension, FunctionType&& function)
+{
+  switch (dimension)
+  {
+    case 2:
+      function(std::integral_constant<size_t, 2>());
+      break;
+    case 3:
+      function(std::integral_constant<size_t, 3>());
+      break;
+    case 4:
+      function(std::integral_constant<size_t, 4>());
+      break;
+    case 8:
+      function(std::integral_constant<size_t, 8>());
+      break;
+    case 16:
+      function(std::integral_constant<size_t, 16>());
+      break;
+    default:
+      function(std::integral_constant<size_t, 0>());
+  }
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,162 @@
+/**
+ * @file fixed_hrectbound.hpp
+ *
+ * Hyper-rectangle bound whose dimensionality is fixed at compile time, so that
+ * the ranges are stored inline and the distance loops can be unrolled.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_FIXED_HRECTBOUND_HPP
+#define MLPACK_CORE_TREE_FIXED_HRECTBOUND_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "hrectbound.hpp"
+
+namespace mlpack {
+namespace bound {
+
+/**
+ * A hyper-rectangle bound for an L-metric whose dimensionality is fixed at
+ * compile time.  It behaves like HRectBound, but the ranges are stored inside
+ * the bound object instead of on the heap, so the bound of a tree node is in
+ * the same cache line as the rest of the node, and the distance calculations
+ * are written without branches over a fixed number of dimensions, which allows
+ * the compiler to unroll and vectorize them.  This is meant for
+ * low-dimensional data like 3-D point clouds; use HRectBound when the
+ * dimensionality is only known at runtime.
+ *
+ * Constructing a FixedHRectBound with a dimensionality other than Dim throws
+ * std::invalid_argument.
+ *
+ * @tparam Dim Dimensionality of the bound.
+ * @tparam MetricType Type of metric to use; must be of type LMetric.
+ * @tparam ElemType Element type (double/float/int/etc.).
+ */
+template<size_t Dim,
+         typename MetricType = metric::LMetric<2, true>,
+         typename ElemType = double>
+class FixedHRectBound : public HRectBound<MetricType, ElemType>
+{
+ public:
+  //! The type of the generic bound.
+  typedef HRectBound<MetricType, ElemType> Base;
+
+  /**
+   * Create a bound of dimensionality Dim with each dimension the empty set.
+   */
+  FixedHRectBound();
+
+  /**
+   * Create a bound of the given dimensionality with each dimension the empty
+   * set.  The dimensionality must be Dim; this constructor exists so that
+   * trees can construct the bound from the dimensionality of their dataset.
+   *
+   * @param dimension Dimensionality of bound.
+   */
+  FixedHRectBound(const size_t dimension);
+
+  //! Copy constructor.
+  FixedHRectBound(const FixedHRectBound& other);
+  //! Copy assignment operator.
+  FixedHRectBound& operator=(const FixedHRectBound& other);
+
+  //! Move constructor; the ranges are stored inline, so they are copied.
+  FixedHRectBound(FixedHRectBound&& other);
+  //! Move assignment operator; the ranges are stored inline, so they are
+  //! copied.
+  FixedHRectBound& operator=(FixedHRectBound&& other);
+
+  /**
+   * Calculates minimum bound-to-point distance.
+   *
+   * @param point Point to which the minimum distance is requested.
+   */
+  template<typename VecType>
+  ElemType MinDistance(const VecType& point,
+                       typename std::enable_if_t<IsVector<VecType>::value>* = 0)
+      const;
+
+  /**
+   * Calculates minimum bound-to-bound distance.
+   *
+   * @param other Bound to which the minimum distance is requested.
+   */
+  ElemType MinDistance(const FixedHRectBound& other) const;
+
+  /**
+   * Calculates maximum bound-to-point distance.
+   *
+   * @param point Point to which the maximum distance is requested.
+   */
+  template<typename VecType>
+  ElemType MaxDistance(const VecType& point,
+                       typename std::enable_if_t<IsVector<VecType>::value>* = 0)
+      const;
+
+  /**
+   * Calculates maximum bound-to-bound distance.
+   *
+   * @param other Bound to which the maximum distance is requested.
+   */
+  ElemType MaxDistance(const FixedHRectBound& other) const;
+
+  /**
+   * Calculates minimum and maximum bound-to-bound distance.
+   *
+   * @param other Bound to which the minimum and maximum distances are
+   *     requested.
+   */
+  math::RangeType<ElemType> RangeDistance(const FixedHRectBound& other) const;
+
+  /**
+   * Calculates minimum and maximum bound-to-point distance.
+   *
+   * @param point Point to which the minimum and maximum distances are
+   *     requested.
+   */
+  template<typename VecType>
+  math::RangeType<ElemType> RangeDistance(
+      const VecType& point,
+      typename std::enable_if_t<IsVector<VecType>::value>* = 0) const;
+
+  /**
+   * Serialize the bound object.
+   */
+  template<typename Archive>
+  void serialize(Archive& ar, const unsigned int version);
+
+ private:
+  //! The ranges of each dimension.
+  math::RangeType<ElemType> ranges[Dim];
+
+  //! Raise the given sum of powered distances to 1 / Power, if needed.
+  static ElemType Root(const ElemType sum);
+
+  //! Raise the given non-negative distance to the Power of the metric.
+  static ElemType Pow(const ElemType distance);
+};
+
+/**
+ * A three-dimensional hyper-rectangle bound, for use as the BoundType of trees.
+ */
+template<typename MetricType = metric::LMetric<2, true>,
+         typename ElemType = double>
+using HRectBound3D = FixedHRectBound<3, MetricType, ElemType>;
+
+// A specialization of BoundTraits for this class.
+template<size_t Dim, typename MetricType, typename ElemType>
+struct BoundTraits<FixedHRectBound<Dim, MetricType, ElemType>>
+{
+  //! These bounds are always tight for each dimension.
+  const static bool HasTightBounds = true;
+};
+
+} // namespace bound
+} // namespace mlpack
+
+#include "fixed_hrectbound_impl.hpp"
+
+#endif // MLPACK_CORE_TREE_FIXED_HRECTBOUND_HPP
@@ -0,0 +1,259 @@
+/**
+ * @file fixed_hrectbound_impl.hpp
+ *
+ * Implementation of the fixed-dimensionality hyper-rectangle bound.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_FIXED_HRECTBOUND_IMPL_HPP
+#define MLPACK_CORE_TREE_FIXED_HRECTBOUND_IMPL_HPP
+
+// In case it has not been included yet.
+#include "fixed_hrectbound.hpp"
+
+namespace mlpack {
+namespace bound {
+
+template<size_t Dim, typename MetricType, typename ElemType>
+inline FixedHRectBound<Dim, MetricType, ElemType>::FixedHRectBound() :
+    Base(Dim, ranges)
+{ /* Nothing to do. */ }
+
+template<size_t Dim, typename MetricType, typename ElemType>
+inline FixedHRectBound<Dim, MetricType, ElemType>::FixedHRectBound(
+    const size_t dimension) :
+    Base(Dim, ranges)
+{
+  if (dimension != Dim)
+  {
+    std::ostringstream oss;
+    oss << "FixedHRectBound::FixedHRectBound(): dimensionality of data ("
+        << dimension << ") does not match the dimensionality of the bound ("
+        << Dim << ")!";
+    throw std::invalid_argument(oss.str());
+  }
+}
+
+template<size_t Dim, typename MetricType, typename ElemType>
+inline FixedHRectBound<Dim, MetricType, ElemType>::FixedHRectBound(
+    const FixedHRectBound& other) :
+    Base(Dim, ranges)
+{
+  *this = other;
+}
+
+template<size_t Dim, typename MetricType, typename ElemType>
+inline FixedHRectBound<Dim, MetricType, ElemType>&
+FixedHRectBound<Dim, MetricType, ElemType>::operator=(
+    const FixedHRectBound& other)
+{
+  // The base class still points at our own ranges, so only the values have to
+  // be copied.
+  for (size_t d = 0; d < Dim; ++d)
+    ranges[d] = other.ranges[d];
+  this->MinWidth() = other.MinWidth();
+
+  return *this;
+}
+
+template<size_t Dim, typename MetricType, typename ElemType>
+inline FixedHRectBound<Dim, MetricType, ElemType>::FixedHRectBound(
+    FixedHRectBound&& other) :
+    Base(Dim, ranges)
+{
+  *this = other;
+}
+
+template<size_t Dim, typename MetricType, typename ElemType>
+inline FixedHRectBound<Dim, MetricType, ElemType>&
+FixedHRectBound<Dim, MetricType, ElemType>::operator=(FixedHRectBound&& other)
+{
+  return *this = other;
+}
+
+/**
+ * Calculates minimum bound-to-point distance.
+ */
+template<size_t Dim, typename MetricType, typename ElemType>
+template<typename VecType>
+inline ElemType FixedHRectBound<Dim, MetricType, ElemType>::MinDistance(
+    const VecType& point,
+    typename std::enable_if_t<IsVector<VecType>::value>* /* junk */) const
+{
+  Log::Assert(point.n_elem == Dim);
+
+  ElemType sum = 0;
+  for (size_t d = 0; d < Dim; ++d)
+  {
+    // At most one of these is positive.
+    const ElemType lower = ranges[d].Lo() - point[d];
+    const ElemType higher = point[d] - ranges[d].Hi();
+    sum += Pow(std::max(std::max(lower, higher), ElemType(0)));
+  }
+
+  return Root(sum);
+}
+
+/**
+ * Calculates minimum bound-to-bound distance.
+ */
+template<size_t Dim, typename MetricType, typename ElemType>
+inline ElemType FixedHRectBound<Dim, MetricType, ElemType>::MinDistance(
+    const FixedHRectBound& other) const
+{
+  ElemType sum = 0;
+  for (size_t d = 0; d < Dim; ++d)
+  {
+    // At most one of these is positive.
+    const ElemType lower = other.ranges[d].Lo() - ranges[d].Hi();
+    const ElemType higher = ranges[d].Lo() - other.ranges[d].Hi();
+    sum += Pow(std::max(std::max(lower, higher), ElemType(0)));
+  }
+
+  return Root(sum);
+}
+
+/**
+ * Calculates maximum bound-to-point distance.
+ */
+template<size_t Dim, typename MetricType, typename ElemType>
+template<typename VecType>
+inline ElemType FixedHRectBound<Dim, MetricType, ElemType>::MaxDistance(
+    const VecType& point,
+    typename std::enable_if_t<IsVector<VecType>::value>* /* junk */) const
+{
+  Log::Assert(point.n_elem == Dim);
+
+  ElemType sum = 0;
+  for (size_t d = 0; d < Dim; ++d)
+  {
+    // The two differences sum to the width of the range, so the larger one is
+    // non-negative and is the larger absolute value.
+    sum += Pow(std::max(point[d] - ranges[d].Lo(), ranges[d].Hi() - point[d]));
+  }
+
+  return Root(sum);
+}
+
+/**
+ * Calculates maximum bound-to-bound distance.
+ */
+template<size_t Dim, typename MetricType, typename ElemType>
+inline ElemType FixedHRectBound<Dim, MetricType, ElemType>::MaxDistance(
+    const FixedHRectBound& other) const
+{
+  ElemType sum = 0;
+  for (size_t d = 0; d < Dim; ++d)
+  {
+    // As above, the larger difference is non-negative.
+    sum += Pow(std::max(other.ranges[d].Hi() - ranges[d].Lo(),
+                        ranges[d].Hi() - other.ranges[d].Lo()));
+  }
+
+  return Root(sum);
+}
+
+/**
+ * Calculates minimum and maximum bound-to-bound distance.
+ */
+template<size_t Dim, typename MetricType, typename ElemType>
+inline math::RangeType<ElemType>
+FixedHRectBound<Dim, MetricType, ElemType>::RangeDistance(
+    const FixedHRectBound& other) const
+{
+  ElemType loSum = 0;
+  ElemType hiSum = 0;
+  for (size_t d = 0; d < Dim; ++d)
+  {
+    const ElemType v1 = other.ranges[d].Lo() - ranges[d].Hi();
+    const ElemType v2 = ranges[d].Lo() - other.ranges[d].Hi();
+    loSum += Pow(std::max(std::max(v1, v2), ElemType(0)));
+    hiSum += Pow(std::max(-v1, -v2));
+  }
+
+  return math::RangeType<ElemType>(Root(loSum), Root(hiSum));
+}
+
+/**
+ * Calculates minimum and maximum bound-to-point distance.
+ */
+template<size_t Dim, typename MetricType, typename ElemType>
+template<typename VecType>
+inline math::RangeType<ElemType>
+FixedHRectBound<Dim, MetricType, ElemType>::RangeDistance(
+    const VecType& point,
+    typename std::enable_if_t<IsVector<VecType>::value>* /* junk */) const
+{
+  Log::Assert(point.n_elem == Dim);
+
+  ElemType loSum = 0;
+  ElemType hiSum = 0;
+  for (size_t d = 0; d < Dim; ++d)
+  {
+    const ElemType v1 = ranges[d].Lo() - point[d];
+    const ElemType v2 = point[d] - ranges[d].Hi();
+    loSum += Pow(std::max(std::max(v1, v2), ElemType(0)));
+    hiSum += Pow(std::max(-v1, -v2));
+  }
+
+  return math::RangeType<ElemType>(Root(loSum), Root(hiSum));
+}
+
+template<size_t Dim, typename MetricType, typename ElemType>
+template<typename Archive>
+void FixedHRectBound<Dim, MetricType, ElemType>::serialize(
+    Archive& ar,
+    const unsigned int version)
+{
+  Base::serialize(ar, version);
+
+  // The base class allocates its own memory when loading, so move the ranges
+  // back into this object.
+  if (Archive::is_loading::value)
+  {
+    if (this->Dim() != Dim)
+    {
+      std::ostringstream oss;
+      oss << "FixedHRectBound::serialize(): dimensionality of loaded bound ("
+          << this->Dim() << ") does not match the dimensionality of the bound ("
+          << Dim << ")!";
+      throw std::invalid_argument(oss.str());
+    }
+
+    this->UseExternalMemory(ranges);
+  }
+}
+
+template<size_t Dim, typename MetricType, typename ElemType>
+inline ElemType FixedHRectBound<Dim, MetricType, ElemType>::Root(
+    const ElemType sum)
+{
+  // The compiler should optimize out these if statements entirely.
+  if (!MetricType::TakeRoot || MetricType::Power == 1)
+    return sum;
+  else if (MetricType::Power == 2)
+    return (ElemType) std::sqrt(sum);
+  else
+    return (ElemType) pow((double) sum, 1.0 / (double) MetricType::Power);
+}
+
+template<size_t Dim, typename MetricType, typename ElemType>
+inline ElemType FixedHRectBound<Dim, MetricType, ElemType>::Pow(
+    const ElemType distance)
+{
+  // The compiler should optimize out these if statements entirely.
+  if (MetricType::Power == 1)
+    return distance;
+  else if (MetricType::Power == 2)
+    return distance * distance;
+  else
+    return std::pow(distance, (ElemType) MetricType::Power);
+}
+
+} // namespace bound
+} // namespace mlpack
+
+#endif // MLPACK_CORE_TREE_FIXED_HRECTBOUND_IMPL_HPP
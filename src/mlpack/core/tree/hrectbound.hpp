@@ -39,6 +39,13 @@ struct IsLMetric<metric::LMetric<Power, TakeRoot>>
   static const bool Value = true;
 };
 
+//! Specialization for IsLMetric when the argument is of type FixedLMetric.
+template<size_t Dim, int Power, bool TakeRoot>
+struct IsLMetric<metric::FixedLMetric<Dim, Power, TakeRoot>>
+{
+  static const bool Value = true;
+};
+
 } // namespace meta
 
 /**
@@ -88,6 +95,17 @@ class HRectBound
    */
   void Clear();
 
+  /**
+   * Copy the ranges of the bound into the given memory, and use that memory to
+   * store the ranges from now on.  The memory must hold at least Dim() ranges,
+   * it must outlive the bound (or the next reallocation of the bound), and it
+   * is not freed by the bound.  This allows the bounds of many objects to be
+   * stored contiguously.
+   *
+   * @param memory Memory to store the ranges in.
+   */
+  void UseExternalMemory(math::RangeType<ElemType>* memory);
+
   //! Gets the dimensionality.
   size_t Dim() const { return dim; }
 
@@ -231,11 +249,25 @@ class HRectBound
   template<typename Archive>
   void serialize(Archive& ar, const unsigned int version);
 
+ protected:
+  /**
+   * Initializes to the specified dimensionality, storing the ranges in the
+   * given memory, which is not freed by the bound.  The memory must hold
+   * dimension empty ranges by the time the bound is used; it is not accessed
+   * by this constructor, so it may be a member of a derived class.
+   *
+   * @param dimension Dimensionality of bound.
+   * @param memory Memory to store the ranges in.
+   */
+  HRectBound(const size_t dimension, math::RangeType<ElemType>* memory);
+
  private:
   //! The dimensionality of the bound.
   size_t dim;
   //! The bounds for each dimension.
   math::RangeType<ElemType>* bounds;
+  //! If true, the bounds array was allocated by this object and is freed by it.
+  bool ownsBounds;
   //! Cached minimum width of bound.
   ElemType minWidth;
   //! Instantiated metric (likely has size 0).
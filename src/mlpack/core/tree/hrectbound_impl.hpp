@@ -27,6 +27,7 @@ template<typename MetricType, typename ElemType>
 inline HRectBound<MetricType, ElemType>::HRectBound() :
     dim(0),
     bounds(NULL),
+    ownsBounds(true),
     minWidth(0)
 { /* Nothing to do. */ }
 
@@ -38,6 +39,21 @@ template<typename MetricType, typename ElemType>
 inline HRectBound<MetricType, ElemType>::HRectBound(const size_t dimension) :
     dim(dimension),
     bounds(new math::RangeType<ElemType>[dim]),
+    ownsBounds(true),
+    minWidth(0)
+{ /* Nothing to do. */ }
+
+/**
+ * Initializes to specified dimensionality, using the given memory for the
+ * ranges.
+ */
+template<typename MetricType, typename ElemType>
+inline HRectBound<MetricType, ElemType>::HRectBound(
+    const size_t dimension,
+    math::RangeType<ElemType>* memory) :
+    dim(dimension),
+    bounds(memory),
+    ownsBounds(false),
     minWidth(0)
 { /* Nothing to do. */ }
 
@@ -49,6 +65,7 @@ inline HRectBound<MetricType, ElemType>::HRectBound(
     const HRectBound<MetricType, ElemType>& other) :
     dim(other.Dim()),
     bounds(new math::RangeType<ElemType>[dim]),
+    ownsBounds(true),
     minWidth(other.MinWidth())
 {
   // Copy other bounds over.
@@ -68,11 +85,12 @@ inline HRectBound<
   if (dim != other.Dim())
   {
     // Reallocation is necessary.
-    if (bounds)
+    if (bounds && ownsBounds)
       delete[] bounds;
 
     dim = other.Dim();
     bounds = new math::RangeType<ElemType>[dim];
+    ownsBounds = true;
   }
 
   // Now copy each of the bound values.
@@ -92,11 +110,13 @@ inline HRectBound<MetricType, ElemType>::HRectBound(
     HRectBound<MetricType, ElemType>&& other) :
     dim(other.dim),
     bounds(other.bounds),
+    ownsBounds(other.ownsBounds),
     minWidth(other.minWidth)
 {
   // Fix the other bound.
   other.dim = 0;
   other.bounds = NULL;
+  other.ownsBounds = true;
   other.minWidth = 0.0;
 }
 
@@ -106,7 +126,7 @@ inline HRectBound<MetricType, ElemType>::HRectBound(
 template<typename MetricType, typename ElemType>
 inline HRectBound<MetricType, ElemType>::~HRectBound()
 {
-  if (bounds)
+  if (bounds && ownsBounds)
     delete[] bounds;
 }
 
@@ -121,6 +141,23 @@ inline void HRectBound<MetricType, ElemType>::Clear()
   minWidth = 0;
 }
 
+/**
+ * Move the ranges into the given memory, which is not owned by the bound.
+ */
+template<typename MetricType, typename ElemType>
+inline void HRectBound<MetricType, ElemType>::UseExternalMemory(
+    math::RangeType<ElemType>* memory)
+{
+  for (size_t i = 0; i < dim; i++)
+    memory[i] = bounds[i];
+
+  if (bounds && ownsBounds)
+    delete[] bounds;
+
+  bounds = memory;
+  ownsBounds = false;
+}
+
 /***
  * Calculates the centroid of the range, placing it into the given vector.
  *
@@ -668,9 +705,10 @@ void HRectBound<MetricType, ElemType>::serialize(
   // Allocate memory for the bounds, if necessary.
   if (Archive::is_loading::value)
   {
-    if (bounds)
+    if (bounds && ownsBounds)
       delete[] bounds;
     bounds = new math::RangeType<ElemType>[dim];
+    ownsBounds = true;
   }
 
   // We can't serialize a raw array directly, so wrap it.
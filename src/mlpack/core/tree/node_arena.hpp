@@ -0,0 +1,145 @@
+/**
+ * @file node_arena.hpp
+ *
+ * An arena from which the nodes of a tree are allocated in large slabs, which
+ * are all freed at once when the tree is destroyed.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_NODE_ARENA_HPP
+#define MLPACK_CORE_TREE_NODE_ARENA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * A bump allocator for the nodes of a tree.  Memory is handed out from slabs,
+ * whose size doubles (up to MaxSlabSize) each time a slab is full, so building
+ * a tree of n nodes takes O(log n) calls to the system allocator instead of n,
+ * and the nodes that are created one after another (for instance, the nodes
+ * of a subtree) are next to each other in memory.
+ *
+ * Memory is never given back to the arena; the nodes allocated from it must be
+ * destructed (see DeleteNode()), but the memory itself is only freed, all at
+ * once, when the arena is destroyed.  The root of a tree owns the arena of its
+ * nodes.  Allocate() may be called from several threads.
+ */
+class NodeArena
+{
+ public:
+  //! The size of the first slab.
+  static constexpr size_t InitialSlabSize = 4096;
+  //! The largest size of a slab (unless a single object is larger).
+  static constexpr size_t MaxSlabSize = 16 * 1024 * 1024;
+
+  //! Create an empty arena; no memory is allocated until it is needed.
+  NodeArena() : current(NULL), used(0), capacity(0), allocated(0) { }
+
+  //! Free all of the slabs.  The objects in them must already be destructed.
+  ~NodeArena()
+  {
+    for (size_t i = 0; i < slabs.size(); ++i)
+      ::operator delete(slabs[i]);
+  }
+
+  //! An arena can't be copied, since the nodes point into it.
+  NodeArena(const NodeArena& other) = delete;
+  //! An arena can't be copied, since the nodes point into it.
+  NodeArena& operator=(const NodeArena& other) = delete;
+
+  /**
+   * Allocate memory for an object of the given size and alignment (which must
+   * be a power of two, no larger than the alignment of the system allocator).
+   *
+   * @param bytes Size of the object.
+   * @param alignment Alignment of the object.
+   */
+  void* Allocate(const size_t bytes, const size_t alignment)
+  {
+    // Subtrees may be built in parallel.
+    std::lock_guard<std::mutex> lock(mutex);
+
+    size_t start = (used + alignment - 1) & ~(alignment - 1);
+    if (current == NULL || start + bytes > capacity)
+    {
+      capacity = (slabs.empty()) ? InitialSlabSize :
+          std::min(2 * capacity, MaxSlabSize);
+      if (capacity < bytes)
+        capacity = bytes;
+
+      current = (char*) ::operator new(capacity);
+      slabs.push_back(current);
+      allocated += capacity;
+      start = 0;
+    }
+
+    used = start + bytes;
+    return current + start;
+  }
+
+  //! Get the number of slabs.
+  size_t Slabs() const { return slabs.size(); }
+  //! Get the number of bytes held by the slabs.
+  size_t Bytes() const { return allocated; }
+
+ private:
+  //! The slabs.
+  std::vector<char*> slabs;
+  //! The slab that memory is currently allocated from.
+  char* current;
+  //! The number of bytes used in the current slab.
+  size_t used;
+  //! The size of the current slab.
+  size_t capacity;
+  //! The number of bytes held by all the slabs.
+  size_t allocated;
+  //! The mutex held while memory is allocated.
+  std::mutex mutex;
+};
+
+/**
+ * Create a node in the given arena, or with new if there is no arena.
+ *
+ * @param arena Arena to allocate the node from (or NULL).
+ * @param args Arguments of the constructor of the node.
+ */
+template<typename NodeType, typename... Args>
+NodeType* NewNode(NodeArena* arena, Args&&... args)
+{
+  if (arena == NULL)
+    return new NodeType(std::forward<Args>(args)...);
+
+  void* memory = arena->Allocate(sizeof(NodeType), alignof(NodeType));
+  return new (memory) NodeType(std::forward<Args>(args)...);
+}
+
+/**
+ * Destroy a node created with NewNode().  A node in an arena is only
+ * destructed; its memory is freed with the arena.
+ *
+ * @param node Node to destroy (may be NULL).
+ * @param arena Arena that the node was allocated from (or NULL).
+ */
+template<typename NodeType>
+void DeleteNode(NodeType* node, const NodeArena* arena)
+{
+  if (arena == NULL)
+    delete node;
+  else if (node != NULL)
+    node->~NodeType();
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -20,9 +20,11 @@ namespace tree {
 
 template<typename MetricType,
          typename StatisticType,
-         typename MatType>
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
 template<typename RuleType>
-class Octree<MetricType, StatisticType, MatType>::DualTreeTraverser
+class GenericOctree<MetricType, StatisticType, MatType, BoundType>::
+    DualTreeTraverser
 {
  public:
   /**
@@ -34,7 +36,7 @@ class Octree<MetricType, StatisticType, MatType>::DualTreeTraverser
    * Traverse the two trees.  This does not reset the statistics of the
    * traversals (it just adds to them).
    */
-  void Traverse(Octree& queryNode, Octree& referenceNode);
+  void Traverse(GenericOctree& queryNode, GenericOctree& referenceNode);
 
   //! Get the number of pruned nodes.
   size_t NumPrunes() const { return numPrunes; }
@@ -18,9 +18,13 @@
 namespace mlpack {
 namespace tree {
 
-template<typename MetricType, typename StatisticType, typename MatType>
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
 template<typename RuleType>
-Octree<MetricType, StatisticType, MatType>::DualTreeTraverser<RuleType>::
+GenericOctree<MetricType, StatisticType, MatType, BoundType>::
+    DualTreeTraverser<RuleType>::
     DualTreeTraverser(RuleType& rule) :
     rule(rule),
     numPrunes(0),
@@ -31,10 +35,14 @@ Octree<MetricType, StatisticType, MatType>::DualTreeTraverser<RuleType>::
   // Nothing to do.
 }
 
-template<typename MetricType, typename StatisticType, typename MatType>
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
 template<typename RuleType>
-void Octree<MetricType, StatisticType, MatType>::DualTreeTraverser<RuleType>::
-    Traverse(Octree& queryNode, Octree& referenceNode)
+void GenericOctree<MetricType, StatisticType, MatType, BoundType>::
+    DualTreeTraverser<RuleType>::
+    Traverse(GenericOctree& queryNode, GenericOctree& referenceNode)
 {
   // Increment the visit counter.
   ++numVisited;
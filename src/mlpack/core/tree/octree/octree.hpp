@@ -14,15 +14,37 @@
 
 #include <mlpack/prereqs.hpp>
 #include "../hrectbound.hpp"
+#include "../fixed_hrectbound.hpp"
+#include "../node_arena.hpp"
 #include "../statistic.hpp"
 
 namespace mlpack {
 namespace tree {
 
-template<typename MetricType = metric::EuclideanDistance,
-         typename StatisticType = EmptyStatistic,
-         typename MatType = arma::mat>
-class Octree
+/**
+ * The GenericOctree class is a generalized octree: each node has up to 2^d
+ * children, one for each orthant around the center of the node.  The bound of
+ * each node is given by the BoundType template parameter; see the Octree and
+ * Octree3D typedefs in typedef.hpp for the usual choices.
+ *
+ * Because the children of a node are ordered by the bits of their orthant
+ * index, the reordered dataset held by the tree is in Morton (Z-order) order at
+ * node granularity, so nodes that are near each other in space are also near
+ * each other in memory.  The nodes below the root are allocated from a
+ * NodeArena owned by the root, and are freed all at once with it.
+ *
+ * @tparam MetricType The metric to use.
+ * @tparam StatisticType Extra data contained in the node.  See statistic.hpp
+ *     for the necessary skeleton interface.
+ * @tparam MatType The dataset type.
+ * @tparam BoundType The bound used for each node.  HRectBound works for any
+ *     dimensionality; HRectBound3D stores the ranges inline for 3-D data.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+class GenericOctree
 {
  public:
   //! So other classes can use TreeType::Mat.
@@ -40,7 +62,7 @@ class Octree
 
  private:
   //! The children held by this node.
-  std::vector<Octree*> children;
+  std::vector<GenericOctree*> children;
 
   //! The index of the first point in the dataset contained in this node (and
   //! its children).
@@ -50,11 +72,11 @@ class Octree
   size_t count;
   //! The minimum bounding rectangle of the points held in the node (and its
   //! children).
-  bound::HRectBound<MetricType> bound;
+  BoundType<MetricType> bound;
   //! The dataset.
   MatType* dataset;
   //! The parent (NULL if this node is the root).
-  Octree* parent;
+  GenericOctree* parent;
   //! The statistic.
   StatisticType stat;
   //! The distance from the center of this node to the center of the parent.
@@ -63,6 +85,15 @@ class Octree
   ElemType furthestDescendantDistance;
   //! An instantiated metric.
   MetricType metric;
+  //! For the root, the arena holding the other nodes of the tree, which the
+  //! root owns (see NodeArena).  For any other node, the arena it was
+  //! allocated from (NULL if it was allocated with new), which its children
+  //! are allocated from too.
+  NodeArena* arena;
+  #ifdef MLPACK_MEMORY_TRACKING
+  //! Counts this node in the MemoryTracker.
+  TrackedObject<GenericOctree> tracked;
+  #endif
 
  public:
   /**
@@ -73,7 +104,7 @@ class Octree
    * @param data Dataset to create tree from.  This will be copied!
    * @param maxLeafSize Maximum number of points in a leaf node.
    */
-  Octree(const MatType& data, const size_t maxLeafSize = 20);
+  GenericOctree(const MatType& data, const size_t maxLeafSize = 20);
 
   /**
    * Construct this as the root node of an octree on the given dataset.  This
@@ -87,7 +118,7 @@ class Octree
    *      each new point.
    * @param maxLeafSize Maximum number of points in a leaf node.
    */
-  Octree(const MatType& data,
+  GenericOctree(const MatType& data,
          std::vector<size_t>& oldFromNew,
          const size_t maxLeafSize = 20);
 
@@ -106,7 +137,7 @@ class Octree
    *      each old point.
    * @param maxLeafSize Maximum number of points in a leaf node.
    */
-  Octree(const MatType& data,
+  GenericOctree(const MatType& data,
          std::vector<size_t>& oldFromNew,
          std::vector<size_t>& newFromOld,
          const size_t maxLeafSize = 20);
@@ -119,7 +150,7 @@ class Octree
    * @param data Dataset to create tree from.  This will be copied!
    * @param maxLeafSize Maximum number of points in a leaf node.
    */
-  Octree(MatType&& data, const size_t maxLeafSize = 20);
+  GenericOctree(MatType&& data, const size_t maxLeafSize = 20);
 
   /**
    * Construct this as the root node of an octree on the given dataset. This
@@ -133,7 +164,7 @@ class Octree
    *      each new point.
    * @param maxLeafSize Maximum number of points in a leaf node.
    */
-  Octree(MatType&& data,
+  GenericOctree(MatType&& data,
          std::vector<size_t>& oldFromNew,
          const size_t maxLeafSize = 20);
 
@@ -152,7 +183,7 @@ class Octree
    *      each old point.
    * @param maxLeafSize Maximum number of points in a leaf node.
    */
-  Octree(MatType&& data,
+  GenericOctree(MatType&& data,
          std::vector<size_t>& oldFromNew,
          std::vector<size_t>& newFromOld,
          const size_t maxLeafSize = 20);
@@ -170,7 +201,7 @@ class Octree
    * @param width Width of the node in each dimension.
    * @param maxLeafSize Maximum number of points in a leaf node.
    */
-  Octree(Octree* parent,
+  GenericOctree(GenericOctree* parent,
          const size_t begin,
          const size_t count,
          const arma::vec& center,
@@ -197,7 +228,7 @@ class Octree
    * @param width Width of the node in each dimension.
    * @param maxLeafSize Maximum number of points in a leaf node.
    */
-  Octree(Octree* parent,
+  GenericOctree(GenericOctree* parent,
          const size_t begin,
          const size_t count,
          std::vector<size_t>& oldFromNew,
@@ -210,7 +241,7 @@ class Octree
    *
    * @param other Tree to copy from.
    */
-  Octree(const Octree& other);
+  GenericOctree(const GenericOctree& other);
 
   /**
    * Move the given tree.  The tree passed as a parameter will be emptied and
@@ -218,7 +249,7 @@ class Octree
    *
    * @param other Tree to move.
    */
-  Octree(Octree&& other);
+  GenericOctree(GenericOctree&& other);
 
   /**
    * Initialize the tree from a boost::serialization archive.
@@ -226,33 +257,37 @@ class Octree
    * @param ar Archive to load tree from.  Must be an iarchive, not an oarchive.
    */
   template<typename Archive>
-  Octree(
+  GenericOctree(
       Archive& ar,
       const typename std::enable_if_t<Archive::is_loading::value>* = 0);
 
   /**
    * Destroy the tree.
    */
-  ~Octree();
+  ~GenericOctree();
 
   //! Return the dataset used by this node.
   const MatType& Dataset() const { return *dataset; }
 
   //! Get the pointer to the parent.
-  Octree* Parent() const { return parent; }
+  GenericOctree* Parent() const { return parent; }
   //! Modify the pointer to the parent (be careful!).
-  Octree*& Parent() { return parent; }
+  GenericOctree*& Parent() { return parent; }
 
   //! Return the bound object for this node.
-  const bound::HRectBound<MetricType>& Bound() const { return bound; }
+  const BoundType<MetricType>& Bound() const { return bound; }
   //! Modify the bound object for this node.
-  bound::HRectBound<MetricType>& Bound() { return bound; }
+  BoundType<MetricType>& Bound() { return bound; }
 
   //! Return the statistic object for this node.
   const StatisticType& Stat() const { return stat; }
   //! Modify the statistic object for this node.
   StatisticType& Stat() { return stat; }
 
+  //! Get the arena holding the nodes of the tree below the root (NULL if the
+  //! nodes are not in an arena); see NodeArena.
+  const NodeArena* Arena() const { return arena; }
+
   //! Return the number of children in this node.
   size_t NumChildren() const;
 
@@ -286,13 +321,13 @@ class Octree
    * Return the index of the nearest child node to the given query node.  If it
    * can't decide, it will return NumChildren() (invalid index).
    */
-  size_t GetNearestChild(const Octree& queryNode) const;
+  size_t GetNearestChild(const GenericOctree& queryNode) const;
 
   /**
    * Return the index of the furthest child node to the given query node.  If it
    * can't decide, it will return NumChildren() (invalid index).
    */
-  size_t GetFurthestChild(const Octree& queryNode) const;
+  size_t GetFurthestChild(const GenericOctree& queryNode) const;
 
   /**
    * Return the furthest distance to a point held in this node.  If this is not
@@ -323,19 +358,20 @@ class Octree
    * Return the specified child.  If the index is out of bounds, unspecified
    * behavior will occur.
    */
-  const Octree& Child(const size_t child) const { return *children[child]; }
+  const GenericOctree& Child(const size_t child) const
+  { return *children[child]; }
 
   /**
    * Return the specified child.  If the index is out of bounds, unspecified
    * behavior will occur.
    */
-  Octree& Child(const size_t child) { return *children[child]; }
+  GenericOctree& Child(const size_t child) { return *children[child]; }
 
   /**
    * Return the pointer to the given child.  This allows the child itself to be
    * modified.
    */
-  Octree*& ChildPtr(const size_t child) { return children[child]; }
+  GenericOctree*& ChildPtr(const size_t child) { return children[child]; }
 
   //! Return the number of points in this node (0 if not a leaf).
   size_t NumPoints() const;
@@ -357,11 +393,11 @@ class Octree
   size_t Point(const size_t index) const;
 
   //! Return the minimum distance to another node.
-  ElemType MinDistance(const Octree& other) const;
+  ElemType MinDistance(const GenericOctree& other) const;
   //! Return the maximum distance to another node.
-  ElemType MaxDistance(const Octree& other) const;
+  ElemType MaxDistance(const GenericOctree& other) const;
   //! Return the minimum and maximum distance to another node.
-  math::RangeType<ElemType> RangeDistance(const Octree& other) const;
+  math::RangeType<ElemType> RangeDistance(const GenericOctree& other) const;
 
   //! Return the minimum distance to the given point.
   template<typename VecType>
@@ -393,7 +429,7 @@ class Octree
    * This does not return a valid treee!  The method must be protected, so that
    * the serialization shim can work with the default constructor.
    */
-  Octree();
+  GenericOctree();
 
   //! Friend access is given for the default constructor.
   friend class boost::serialization::access;
@@ -20,15 +20,19 @@ namespace mlpack {
 namespace tree {
 
 //! Construct the tree.
-template<typename MetricType, typename StatisticType, typename MatType>
-Octree<MetricType, StatisticType, MatType>::Octree(const MatType& dataset,
-                                                   const size_t maxLeafSize) :
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+GenericOctree<MetricType, StatisticType, MatType, BoundType>::
+GenericOctree(const MatType& dataset, const size_t maxLeafSize) :
     begin(0),
     count(dataset.n_cols),
     bound(dataset.n_rows),
     dataset(new MatType(dataset)),
     parent(NULL),
-    parentDistance(0.0)
+    parentDistance(0.0),
+    arena(NULL)
 {
   if (count > 0)
   {
@@ -56,8 +60,11 @@ Octree<MetricType, StatisticType, MatType>::Octree(const MatType& dataset,
 }
 
 //! Construct the tree.
-template<typename MetricType, typename StatisticType, typename MatType>
-Octree<MetricType, StatisticType, MatType>::Octree(
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+GenericOctree<MetricType, StatisticType, MatType, BoundType>::GenericOctree(
     const MatType& dataset,
     std::vector<size_t>& oldFromNew,
     const size_t maxLeafSize) :
@@ -66,7 +73,8 @@ Octree<MetricType, StatisticType, MatType>::Octree(
     bound(dataset.n_rows),
     dataset(new MatType(dataset)),
     parent(NULL),
-    parentDistance(0.0)
+    parentDistance(0.0),
+    arena(NULL)
 {
   oldFromNew.resize(this->dataset->n_cols);
   for (size_t i = 0; i < this->dataset->n_cols; ++i)
@@ -98,8 +106,11 @@ Octree<MetricType, StatisticType, MatType>::Octree(
 }
 
 //! Construct the tree.
-template<typename MetricType, typename StatisticType, typename MatType>
-Octree<MetricType, StatisticType, MatType>::Octree(
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+GenericOctree<MetricType, StatisticType, MatType, BoundType>::GenericOctree(
     const MatType& dataset,
     std::vector<size_t>& oldFromNew,
     std::vector<size_t>& newFromOld,
@@ -109,7 +120,8 @@ Octree<MetricType, StatisticType, MatType>::Octree(
     bound(dataset.n_rows),
     dataset(new MatType(dataset)),
     parent(NULL),
-    parentDistance(0.0)
+    parentDistance(0.0),
+    arena(NULL)
 {
   oldFromNew.resize(this->dataset->n_cols);
   for (size_t i = 0; i < this->dataset->n_cols; ++i)
@@ -146,15 +158,19 @@ Octree<MetricType, StatisticType, MatType>::Octree(
 }
 
 //! Construct the tree.
-template<typename MetricType, typename StatisticType, typename MatType>
-Octree<MetricType, StatisticType, MatType>::Octree(MatType&& dataset,
-                                                   const size_t maxLeafSize) :
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+GenericOctree<MetricType, StatisticType, MatType, BoundType>::
+GenericOctree(MatType&& dataset, const size_t maxLeafSize) :
     begin(0),
     count(dataset.n_cols),
     bound(dataset.n_rows),
     dataset(new MatType(std::move(dataset))),
     parent(NULL),
-    parentDistance(0.0)
+    parentDistance(0.0),
+    arena(NULL)
 {
   if (count > 0)
   {
@@ -182,8 +198,11 @@ Octree<MetricType, StatisticType, MatType>::Octree(MatType&& dataset,
 }
 
 //! Construct the tree.
-template<typename MetricType, typename StatisticType, typename MatType>
-Octree<MetricType, StatisticType, MatType>::Octree(
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+GenericOctree<MetricType, StatisticType, MatType, BoundType>::GenericOctree(
     MatType&& dataset,
     std::vector<size_t>& oldFromNew,
     const size_t maxLeafSize) :
@@ -192,7 +211,8 @@ Octree<MetricType, StatisticType, MatType>::Octree(
     bound(dataset.n_rows),
     dataset(new MatType(std::move(dataset))),
     parent(NULL),
-    parentDistance(0.0)
+    parentDistance(0.0),
+    arena(NULL)
 {
   oldFromNew.resize(this->dataset->n_cols);
   for (size_t i = 0; i < this->dataset->n_cols; ++i)
@@ -224,8 +244,11 @@ Octree<MetricType, StatisticType, MatType>::Octree(
 }
 
 //! Construct the tree.
-template<typename MetricType, typename StatisticType, typename MatType>
-Octree<MetricType, StatisticType, MatType>::Octree(
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+GenericOctree<MetricType, StatisticType, MatType, BoundType>::GenericOctree(
     MatType&& dataset,
     std::vector<size_t>& oldFromNew,
     std::vector<size_t>& newFromOld,
@@ -235,7 +258,8 @@ Octree<MetricType, StatisticType, MatType>::Octree(
     bound(dataset.n_rows),
     dataset(new MatType(std::move(dataset))),
     parent(NULL),
-    parentDistance(0.0)
+    parentDistance(0.0),
+    arena(NULL)
 {
   oldFromNew.resize(this->dataset->n_cols);
   for (size_t i = 0; i < this->dataset->n_cols; ++i)
@@ -272,9 +296,12 @@ Octree<MetricType, StatisticType, MatType>::Octree(
 }
 
 //! Construct a child node.
-template<typename MetricType, typename StatisticType, typename MatType>
-Octree<MetricType, StatisticType, MatType>::Octree(
-    Octree* parent,
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+GenericOctree<MetricType, StatisticType, MatType, BoundType>::GenericOctree(
+    GenericOctree* parent,
     const size_t begin,
     const size_t count,
     const arma::vec& center,
@@ -284,7 +311,8 @@ Octree<MetricType, StatisticType, MatType>::Octree(
     count(count),
     bound(parent->dataset->n_rows),
     dataset(parent->dataset),
-    parent(parent)
+    parent(parent),
+    arena(parent->arena)
 {
   // Calculate empirical center of data.
   bound |= dataset->cols(begin, begin + count - 1);
@@ -306,9 +334,12 @@ Octree<MetricType, StatisticType, MatType>::Octree(
 }
 
 //! Construct a child node.
-template<typename MetricType, typename StatisticType, typename MatType>
-Octree<MetricType, StatisticType, MatType>::Octree(
-    Octree* parent,
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+GenericOctree<MetricType, StatisticType, MatType, BoundType>::GenericOctree(
+    GenericOctree* parent,
     const size_t begin,
     const size_t count,
     std::vector<size_t>& oldFromNew,
@@ -319,7 +350,8 @@ Octree<MetricType, StatisticType, MatType>::Octree(
     count(count),
     bound(parent->dataset->n_rows),
     dataset(parent->dataset),
-    parent(parent)
+    parent(parent),
+    arena(parent->arena)
 {
   // Calculate empirical center of data.
   bound |= dataset->cols(begin, begin + count - 1);
@@ -341,8 +373,12 @@ Octree<MetricType, StatisticType, MatType>::Octree(
 }
 
 //! Copy the given tree.
-template<typename MetricType, typename StatisticType, typename MatType>
-Octree<MetricType, StatisticType, MatType>::Octree(const Octree& other) :
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+GenericOctree<MetricType, StatisticType, MatType, BoundType>::
+GenericOctree(const GenericOctree& other) :
     begin(other.begin),
     count(other.count),
     bound(other.bound),
@@ -351,21 +387,26 @@ Octree<MetricType, StatisticType, MatType>::Octree(const Octree& other) :
     stat(other.stat),
     parentDistance(other.parentDistance),
     furthestDescendantDistance(other.furthestDescendantDistance),
-    metric(other.metric)
+    metric(other.metric),
+    arena(NULL)
 {
   // If we have any children, we need to create them, and then ensure that their
   // parent links are set right.
   for (size_t i = 0; i < other.NumChildren(); ++i)
   {
-    children.push_back(new Octree(other.Child(i)));
+    children.push_back(new GenericOctree(other.Child(i)));
     children[i]->parent = this;
     children[i]->dataset = this->dataset;
   }
 }
 
 //! Move the given tree.
-template<typename MetricType, typename StatisticType, typename MatType>
-Octree<MetricType, StatisticType, MatType>::Octree(Octree&& other) :
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+GenericOctree<MetricType, StatisticType, MatType, BoundType>::
+GenericOctree(GenericOctree&& other) :
     children(std::move(other.children)),
     begin(other.begin),
     count(other.count),
@@ -375,7 +416,8 @@ Octree<MetricType, StatisticType, MatType>::Octree(Octree&& other) :
     stat(std::move(other.stat)),
     parentDistance(other.parentDistance),
     furthestDescendantDistance(other.furthestDescendantDistance),
-    metric(std::move(other.metric))
+    metric(std::move(other.metric)),
+    arena(other.arena)
 {
   // Update the parent pointers of the direct children.
   for (size_t i = 0; i < children.size(); ++i)
@@ -387,34 +429,45 @@ Octree<MetricType, StatisticType, MatType>::Octree(Octree&& other) :
   other.parentDistance = 0.0;
   other.furthestDescendantDistance = 0.0;
   other.parent = NULL;
+  other.arena = NULL;
 }
 
-template<typename MetricType, typename StatisticType, typename MatType>
-Octree<MetricType, StatisticType, MatType>::Octree() :
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+GenericOctree<MetricType, StatisticType, MatType, BoundType>::GenericOctree() :
     begin(0),
     count(0),
-    bound(0),
+    bound(),
     dataset(new MatType()),
     parent(NULL),
     parentDistance(0.0),
-    furthestDescendantDistance(0.0)
+    furthestDescendantDistance(0.0),
+    arena(NULL)
 {
   // Nothing to do.
 }
 
-template<typename MetricType, typename StatisticType, typename MatType>
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
 template<typename Archive>
-Octree<MetricType, StatisticType, MatType>::Octree(
+GenericOctree<MetricType, StatisticType, MatType, BoundType>::GenericOctree(
     Archive& ar,
     const typename std::enable_if_t<Archive::is_loading::value>*) :
-    Octree() // Create an empty tree.
+    GenericOctree() // Create an empty tree.
 {
   // De-serialize the tree into this object.
   ar >> BOOST_SERIALIZATION_NVP(*this);
 }
 
-template<typename MetricType, typename StatisticType, typename MatType>
-Octree<MetricType, StatisticType, MatType>::~Octree()
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+GenericOctree<MetricType, StatisticType, MatType, BoundType>::~GenericOctree()
 {
   // Delete the dataset if we aren't the parent.
   if (!parent)
@@ -422,21 +475,33 @@ Octree<MetricType, StatisticType, MatType>::~Octree()
 
   // Now delete each of the children.
   for (size_t i = 0; i < children.size(); ++i)
-    delete children[i];
+    DeleteNode(children[i], children[i]->arena);
   children.clear();
+
+  // If we're the root, delete the arena of the nodes (which have all been
+  // destructed now).
+  if (!parent)
+    delete arena;
 }
 
-template<typename MetricType, typename StatisticType, typename MatType>
-size_t Octree<MetricType, StatisticType, MatType>::NumChildren() const
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+size_t GenericOctree<MetricType, StatisticType, MatType, BoundType>::
+    NumChildren() const
 {
   return children.size();
 }
 
-template<typename MetricType, typename StatisticType, typename MatType>
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
 template<typename VecType>
-size_t Octree<MetricType, StatisticType, MatType>::GetNearestChild(
-    const VecType& point,
-    typename std::enable_if_t<IsVector<VecType>::value>*) const
+size_t GenericOctree<MetricType, StatisticType, MatType, BoundType>::
+    GetNearestChild(const VecType& point,
+                    typename std::enable_if_t<IsVector<VecType>::value>*) const
 {
   // It's possible that this could be improved by caching which children we have
   // and which we don't, but for now this is just a brute force search.
@@ -455,11 +520,14 @@ size_t Octree<MetricType, StatisticType, MatType>::GetNearestChild(
   return bestIndex;
 }
 
-template<typename MetricType, typename StatisticType, typename MatType>
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
 template<typename VecType>
-size_t Octree<MetricType, StatisticType, MatType>::GetFurthestChild(
-    const VecType& point,
-    typename std::enable_if_t<IsVector<VecType>::value>*) const
+size_t GenericOctree<MetricType, StatisticType, MatType, BoundType>::
+    GetFurthestChild(const VecType& point,
+                     typename std::enable_if_t<IsVector<VecType>::value>*) const
 {
   // It's possible that this could be improved by caching which children we have
   // and which we don't, but for now this is just a brute force search.
@@ -478,9 +546,12 @@ size_t Octree<MetricType, StatisticType, MatType>::GetFurthestChild(
   return bestIndex;
 }
 
-template<typename MetricType, typename StatisticType, typename MatType>
-size_t Octree<MetricType, StatisticType, MatType>::GetNearestChild(
-    const Octree& queryNode) const
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+size_t GenericOctree<MetricType, StatisticType, MatType, BoundType>::
+    GetNearestChild(const GenericOctree& queryNode) const
 {
   // It's possible that this could be improved by caching which children we have
   // and which we don't, but for now this is just a brute force search.
@@ -499,9 +570,12 @@ size_t Octree<MetricType, StatisticType, MatType>::GetNearestChild(
   return bestIndex;
 }
 
-template<typename MetricType, typename StatisticType, typename MatType>
-size_t Octree<MetricType, StatisticType, MatType>::GetFurthestChild(
-    const Octree& queryNode) const
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+size_t GenericOctree<MetricType, StatisticType, MatType, BoundType>::
+    GetFurthestChild(const GenericOctree& queryNode) const
 {
   // It's possible that this could be improved by caching which children we have
   // and which we don't, but for now this is just a brute force search.
@@ -520,9 +594,13 @@ size_t Octree<MetricType, StatisticType, MatType>::GetFurthestChild(
   return bestIndex;
 }
 
-template<typename MetricType, typename StatisticType, typename MatType>
-typename Octree<MetricType, StatisticType, MatType>::ElemType
-Octree<MetricType, StatisticType, MatType>::FurthestPointDistance()
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+typename GenericOctree<MetricType, StatisticType, MatType, BoundType>::ElemType
+GenericOctree<MetricType, StatisticType, MatType, BoundType>::
+    FurthestPointDistance()
     const
 {
   // If we are not a leaf, then this distance is 0.  Otherwise, return the
@@ -530,85 +608,126 @@ Octree<MetricType, StatisticType, MatType>::FurthestPointDistance()
   return (children.size() > 0) ? 0.0 : furthestDescendantDistance;
 }
 
-template<typename MetricType, typename StatisticType, typename MatType>
-typename Octree<MetricType, StatisticType, MatType>::ElemType
-Octree<MetricType, StatisticType, MatType>::FurthestDescendantDistance() const
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+typename GenericOctree<MetricType, StatisticType, MatType, BoundType>::ElemType
+GenericOctree<MetricType, StatisticType, MatType, BoundType>::
+    FurthestDescendantDistance() const
 {
   return furthestDescendantDistance;
 }
 
-template<typename MetricType, typename StatisticType, typename MatType>
-typename Octree<MetricType, StatisticType, MatType>::ElemType
-Octree<MetricType, StatisticType, MatType>::MinimumBoundDistance() const
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+typename GenericOctree<MetricType, StatisticType, MatType, BoundType>::ElemType
+GenericOctree<MetricType, StatisticType, MatType, BoundType>::
+    MinimumBoundDistance() const
 {
   return bound.MinWidth() / 2.0;
 }
 
-template<typename MetricType, typename StatisticType, typename MatType>
-size_t Octree<MetricType, StatisticType, MatType>::NumPoints() const
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+size_t GenericOctree<MetricType, StatisticType, MatType, BoundType>::
+    NumPoints() const
 {
   // We have no points unless we are a leaf;
   return (children.size() > 0) ? 0 : count;
 }
 
-template<typename MetricType, typename StatisticType, typename MatType>
-size_t Octree<MetricType, StatisticType, MatType>::NumDescendants() const
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+size_t GenericOctree<MetricType, StatisticType, MatType, BoundType>::
+    NumDescendants() const
 {
   return count;
 }
 
-template<typename MetricType, typename StatisticType, typename MatType>
-size_t Octree<MetricType, StatisticType, MatType>::Descendant(
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+size_t GenericOctree<MetricType, StatisticType, MatType, BoundType>::Descendant(
     const size_t index) const
 {
   return begin + index;
 }
 
-template<typename MetricType, typename StatisticType, typename MatType>
-size_t Octree<MetricType, StatisticType, MatType>::Point(const size_t index)
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+size_t GenericOctree<MetricType, StatisticType, MatType, BoundType>::
+    Point(const size_t index)
     const
 {
   return begin + index;
 }
 
-template<typename MetricType, typename StatisticType, typename MatType>
-typename Octree<MetricType, StatisticType, MatType>::ElemType
-Octree<MetricType, StatisticType, MatType>::MinDistance(const Octree& other)
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+typename GenericOctree<MetricType, StatisticType, MatType, BoundType>::ElemType
+GenericOctree<MetricType, StatisticType, MatType, BoundType>::
+    MinDistance(const GenericOctree& other)
     const
 {
   return bound.MinDistance(other.Bound());
 }
 
-template<typename MetricType, typename StatisticType, typename MatType>
-typename Octree<MetricType, StatisticType, MatType>::ElemType
-Octree<MetricType, StatisticType, MatType>::MaxDistance(const Octree& other)
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+typename GenericOctree<MetricType, StatisticType, MatType, BoundType>::ElemType
+GenericOctree<MetricType, StatisticType, MatType, BoundType>::
+    MaxDistance(const GenericOctree& other)
     const
 {
   return bound.MaxDistance(other.Bound());
 }
 
-template<typename MetricType, typename StatisticType, typename MatType>
-math::RangeType<typename Octree<MetricType, StatisticType, MatType>::ElemType>
-Octree<MetricType, StatisticType, MatType>::RangeDistance(const Octree& other)
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+math::RangeType<typename MatType::elem_type>
+GenericOctree<MetricType, StatisticType, MatType, BoundType>::
+    RangeDistance(const GenericOctree& other)
     const
 {
   return bound.RangeDistance(other.Bound());
 }
 
-template<typename MetricType, typename StatisticType, typename MatType>
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
 template<typename VecType>
-typename Octree<MetricType, StatisticType, MatType>::ElemType
-Octree<MetricType, StatisticType, MatType>::MinDistance(
+typename GenericOctree<MetricType, StatisticType, MatType, BoundType>::ElemType
+GenericOctree<MetricType, StatisticType, MatType, BoundType>::MinDistance(
     const VecType& point,
     typename std::enable_if_t<IsVector<VecType>::value>*) const
 {
   return bound.MinDistance(point);
 }
 
-template<typename MetricType, typename StatisticType, typename MatType>
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
 template<typename VecType>
-typename Octree<MetricType, StatisticType, MatType>::ElemType
-Octree<MetricType, StatisticType, MatType>::MaxDistance(
+typename GenericOctree<MetricType, StatisticType, MatType, BoundType>::ElemType
+GenericOctree<MetricType, StatisticType, MatType, BoundType>::MaxDistance(
     const VecType& point,
     typename std::enable_if_t<IsVector<VecType>::value>*) const
 {
@@ -616,10 +735,13 @@ Octree<MetricType, StatisticType, MatType>::MaxDistance(
 }
 
 
-template<typename MetricType, typename StatisticType, typename MatType>
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
 template<typename VecType>
-math::RangeType<typename Octree<MetricType, StatisticType, MatType>::ElemType>
-Octree<MetricType, StatisticType, MatType>::RangeDistance(
+math::RangeType<typename MatType::elem_type>
+GenericOctree<MetricType, StatisticType, MatType, BoundType>::RangeDistance(
     const VecType& point,
     typename std::enable_if_t<IsVector<VecType>::value>*) const
 {
@@ -627,9 +749,12 @@ Octree<MetricType, StatisticType, MatType>::RangeDistance(
 }
 
 //! Serialize the tree.
-template<typename MetricType, typename StatisticType, typename MatType>
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
 template<typename Archive>
-void Octree<MetricType, StatisticType, MatType>::serialize(
+void GenericOctree<MetricType, StatisticType, MatType, BoundType>::serialize(
     Archive& ar,
     const unsigned int /* version */)
 {
@@ -637,7 +762,7 @@ void Octree<MetricType, StatisticType, MatType>::serialize(
   if (Archive::is_loading::value)
   {
     for (size_t i = 0; i < children.size(); ++i)
-      delete children[i];
+      DeleteNode(children[i], children[i]->arena);
     children.clear();
 
     if (!parent)
@@ -665,8 +790,11 @@ void Octree<MetricType, StatisticType, MatType>::serialize(
 }
 
 //! Split the node.
-template<typename MetricType, typename StatisticType, typename MatType>
-void Octree<MetricType, StatisticType, MatType>::SplitNode(
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+void GenericOctree<MetricType, StatisticType, MatType, BoundType>::SplitNode(
     const arma::vec& center,
     const double width,
     const size_t maxLeafSize)
@@ -676,6 +804,11 @@ void Octree<MetricType, StatisticType, MatType>::SplitNode(
   if (count <= maxLeafSize)
     return;
 
+  // The nodes of the tree are allocated from the arena of the root, which
+  // creates it for its first children.
+  if (parent == NULL && arena == NULL)
+    arena = new NodeArena();
+
   // This will hold the index of the first point in each child.
   arma::Col<size_t> childBegins(((size_t) 1 << dataset->n_rows) + 1);
   childBegins[0] = begin;
@@ -759,15 +892,18 @@ void Octree<MetricType, StatisticType, MatType>::SplitNode(
         childCenter[d] = center[d] + childWidth;
     }
 
-    children.push_back(new Octree(this, childBegins[i],
+    children.push_back(NewNode<GenericOctree>(arena, this, childBegins[i],
         childBegins[i + 1] - childBegins[i], childCenter, childWidth,
         maxLeafSize));
   }
 }
 
 //! Split the node, and store mappings.
-template<typename MetricType, typename StatisticType, typename MatType>
-void Octree<MetricType, StatisticType, MatType>::SplitNode(
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+void GenericOctree<MetricType, StatisticType, MatType, BoundType>::SplitNode(
     const arma::vec& center,
     const double width,
     std::vector<size_t>& oldFromNew,
@@ -778,6 +914,11 @@ void Octree<MetricType, StatisticType, MatType>::SplitNode(
   if (count <= maxLeafSize)
     return;
 
+  // The nodes of the tree are allocated from the arena of the root, which
+  // creates it for its first children.
+  if (parent == NULL && arena == NULL)
+    arena = new NodeArena();
+
   // This will hold the index of the first point in each child.
   arma::Col<size_t> childBegins(((size_t) 1 << dataset->n_rows) + 1);
   childBegins[0] = begin;
@@ -861,7 +1002,7 @@ void Octree<MetricType, StatisticType, MatType>::SplitNode(
         childCenter[d] = center[d] + childWidth;
     }
 
-    children.push_back(new Octree(this, childBegins[i],
+    children.push_back(NewNode<GenericOctree>(arena, this, childBegins[i],
         childBegins[i + 1] - childBegins[i], oldFromNew, childCenter,
         childWidth, maxLeafSize));
   }
@@ -18,9 +18,13 @@
 namespace mlpack {
 namespace tree {
 
-template<typename MetricType, typename StatisticType, typename MatType>
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
 template<typename RuleType>
-class Octree<MetricType, StatisticType, MatType>::SingleTreeTraverser
+class GenericOctree<MetricType, StatisticType, MatType, BoundType>::
+    SingleTreeTraverser
 {
  public:
   /**
@@ -35,7 +39,7 @@ class Octree<MetricType, StatisticType, MatType>::SingleTreeTraverser
    * @param queryIndex Index of query point.
    * @param referenceNode Node in reference tree.
    */
-  void Traverse(const size_t queryIndex, Octree& referenceNode);
+  void Traverse(const size_t queryIndex, GenericOctree& referenceNode);
 
   //! Get the number of pruned nodes.
   size_t NumPrunes() const { return numPrunes; }
@@ -18,19 +18,27 @@
 namespace mlpack {
 namespace tree {
 
-template<typename MetricType, typename StatisticType, typename MatType>
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
 template<typename RuleType>
-Octree<MetricType, StatisticType, MatType>::SingleTreeTraverser<RuleType>::
+GenericOctree<MetricType, StatisticType, MatType, BoundType>::
+    SingleTreeTraverser<RuleType>::
     SingleTreeTraverser(RuleType& rule) :
     rule(rule)
 {
   // Nothing to do.
 }
 
-template<typename MetricType, typename StatisticType, typename MatType>
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
 template<typename RuleType>
-void Octree<MetricType, StatisticType, MatType>::SingleTreeTraverser<RuleType>::
-    Traverse(const size_t queryIndex, Octree& referenceNode)
+void GenericOctree<MetricType, StatisticType, MatType, BoundType>::
+    SingleTreeTraverser<RuleType>::
+    Traverse(const size_t queryIndex, GenericOctree& referenceNode)
 {
   // If we are a leaf, run the base cases.
   if (referenceNode.NumChildren() == 0)
@@ -25,8 +25,9 @@ namespace tree {
  */
 template<typename MetricType,
          typename StatisticType,
-         typename MatType>
-class TreeTraits<Octree<MetricType, StatisticType, MatType>>
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType>
+class TreeTraits<GenericOctree<MetricType, StatisticType, MatType, BoundType>>
 {
  public:
   /**
@@ -0,0 +1,59 @@
+/**
+ * @file typedef.hpp
+ *
+ * Template typedefs for the GenericOctree class that satisfy the requirements
+ * of the TreeType policy class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_OCTREE_TYPEDEF_HPP
+#define MLPACK_CORE_TREE_OCTREE_TYPEDEF_HPP
+
+// In case it hasn't been included yet.
+#include "octree.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The standard octree, which works on data of any dimensionality.  Each node
+ * holds an HRectBound whose ranges are allocated on the heap.
+ *
+ * This template typedef satisfies the TreeType policy API.
+ *
+ * @see @ref trees, GenericOctree, Octree3D
+ */
+template<typename MetricType = metric::EuclideanDistance,
+         typename StatisticType = EmptyStatistic,
+         typename MatType = arma::mat>
+using Octree = GenericOctree<MetricType,
+                             StatisticType,
+                             MatType,
+                             bound::HRectBound>;
+
+/**
+ * An octree for three-dimensional data, like point clouds.  Each node holds an
+ * HRectBound3D, which stores its ranges inside the node and computes distances
+ * with fixed-size loops, so traversals touch less memory and the distance
+ * calculations are cheaper than with the Octree.  Building an Octree3D on data
+ * that is not three-dimensional throws std::invalid_argument.
+ *
+ * This template typedef satisfies the TreeType policy API.
+ *
+ * @see @ref trees, GenericOctree, Octree
+ */
+template<typename MetricType = metric::EuclideanDistance,
+         typename StatisticType = EmptyStatistic,
+         typename MatType = arma::mat>
+using Octree3D = GenericOctree<MetricType,
+                               StatisticType,
+                               MatType,
+                               bound::HRectBound3D>;
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
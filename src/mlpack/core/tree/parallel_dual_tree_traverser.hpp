@@ -0,0 +1,141 @@
+/**
+ * @file parallel_dual_tree_traverser.hpp
+ *
+ * A dual-tree traverser that splits the top levels of the query tree into
+ * independent tasks and runs each task with its own copy of the rules, using
+ * OpenMP.  Each task is traversed by an ordinary (serial) dual-tree traverser.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_HPP
+#define MLPACK_CORE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The ParallelDualTreeTraverser performs a dual-tree traversal by first
+ * descending the query tree until there are enough disjoint query subtrees to
+ * keep every thread busy, and then traversing each (query subtree, reference
+ * node) combination as an independent task.  Each thread owns a private copy
+ * of the rules, so traversal information, the base case cache, and any
+ * per-query results held by the rules are never shared between threads.
+ *
+ * When all tasks are done, the results of every thread are merged back into
+ * the original rules object with the rule's Merge() method, which must have
+ * the following signature:
+ *
+ * @code
+ * void Merge(const RuleType& other, const std::vector<TreeType*>& queryNodes);
+ * @endcode
+ *
+ * Merge() should move the results for all descendants of each node in
+ * 'queryNodes' (the query subtrees that 'other' handled) into the object it is
+ * called on, and also accumulate any statistics such as the number of base
+ * cases.  The RuleType must also be copy-constructible.
+ *
+ * Because query subtrees are disjoint, this traverser can only be used with
+ * rules that modify nothing but the statistics of query nodes and the results
+ * of query points, and with trees where no point is held in more than one
+ * node (TreeTraits<TreeType>::HasDuplicatedPoints is false).  If mlpack is
+ * compiled without OpenMP, or only one thread is available, this traverser is
+ * equivalent to the serial TraverserType.
+ *
+ * @tparam TreeType Type of tree to traverse.
+ * @tparam RuleType Type of rules to use for traversal.
+ * @tparam TraverserType Serial dual-tree traverser to use for each task.
+ */
+template<typename TreeType,
+         typename RuleType,
+         typename TraverserType =
+             typename TreeType::template DualTreeTraverser<RuleType>>
+class ParallelDualTreeTraverser
+{
+ public:
+  /**
+   * Instantiate the parallel dual-tree traverser with the given rule set.  The
+   * query tree will be split into at least tasksPerThread tasks for each
+   * available thread (if the query tree is large enough).
+   *
+   * @param rule Rules to use for traversal.
+   * @param tasksPerThread Minimum number of query subtrees per thread.
+   */
+  ParallelDualTreeTraverser(RuleType& rule, const size_t tasksPerThread = 4);
+
+  /**
+   * Traverse the two trees.  This does not reset the traversal statistics.
+   *
+   * @param queryNode The query node to be traversed.
+   * @param referenceNode The reference node to be traversed.
+   */
+  void Traverse(TreeType& queryNode, TreeType& referenceNode);
+
+  //! Get the minimum number of tasks per thread.
+  size_t TasksPerThread() const { return tasksPerThread; }
+  //! Modify the minimum number of tasks per thread.
+  size_t& TasksPerThread() { return tasksPerThread; }
+
+  //! Get the number of prunes.
+  size_t NumPrunes() const { return numPrunes; }
+  //! Modify the number of prunes.
+  size_t& NumPrunes() { return numPrunes; }
+
+  //! Get the number of visited combinations.
+  size_t NumVisited() const { return numVisited; }
+  //! Modify the number of visited combinations.
+  size_t& NumVisited() { return numVisited; }
+
+  //! Get the number of times a node combination was scored.
+  size_t NumScores() const { return numScores; }
+  //! Modify the number of times a node combination was scored.
+  size_t& NumScores() { return numScores; }
+
+  //! Get the number of times a base case was calculated.
+  size_t NumBaseCases() const { return numBaseCases; }
+  //! Modify the number of times a base case was calculated.
+  size_t& NumBaseCases() { return numBaseCases; }
+
+ private:
+  /**
+   * Collect disjoint query subtrees that together hold every descendant of
+   * the given query node.  Nodes are split in breadth-first order until there
+   * are at least minTasks subtrees, or only leaves remain.
+   */
+  void SplitQueryTree(TreeType& queryNode,
+                      const size_t minTasks,
+                      std::vector<TreeType*>& tasks) const;
+
+  //! Add the statistics of the given serial traverser to ours.
+  void AddStatistics(const TraverserType& traverser);
+
+  //! Reference to the rules with which the trees will be traversed.
+  RuleType& rule;
+
+  //! The minimum number of tasks per thread.
+  size_t tasksPerThread;
+
+  //! The number of prunes.
+  size_t numPrunes;
+
+  //! The number of node combinations that have been visited during traversal.
+  size_t numVisited;
+
+  //! The number of times a node combination was scored.
+  size_t numScores;
+
+  //! The number of times a base case was calculated.
+  size_t numBaseCases;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "parallel_dual_tree_traverser_impl.hpp"
+
+#endif // MLPACK_CORE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_HPP
@@ -0,0 +1,127 @@
+/**
+ * @file parallel_dual_tree_traverser_impl.hpp
+ *
+ * Implementation of the ParallelDualTreeTraverser, which splits the query tree
+ * into disjoint subtrees and traverses each of them in parallel with a private
+ * copy of the rules.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_IMPL_HPP
+#define MLPACK_CORE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "parallel_dual_tree_traverser.hpp"
+
+#include <queue>
+
+namespace mlpack {
+namespace tree {
+
+template<typename TreeType, typename RuleType, typename TraverserType>
+ParallelDualTreeTraverser<TreeType, RuleType, TraverserType>::
+ParallelDualTreeTraverser(RuleType& rule, const size_t tasksPerThread) :
+    rule(rule),
+    tasksPerThread(tasksPerThread),
+    numPrunes(0),
+    numVisited(0),
+    numScores(0),
+    numBaseCases(0)
+{ /* Nothing to do. */ }
+
+template<typename TreeType, typename RuleType, typename TraverserType>
+void ParallelDualTreeTraverser<TreeType, RuleType, TraverserType>::Traverse(
+    TreeType& queryNode,
+    TreeType& referenceNode)
+{
+  size_t numThreads = 1;
+  #ifdef HAS_OPENMP
+  numThreads = omp_get_max_threads();
+  #endif
+
+  // Split the query tree into tasks.  If there is only one thread, or the query
+  // tree cannot be split, there is nothing to gain by copying the rules.
+  std::vector<TreeType*> tasks;
+  if (numThreads > 1)
+    SplitQueryTree(queryNode, numThreads * tasksPerThread, tasks);
+
+  if (tasks.size() <= 1)
+  {
+    TraverserType traverser(rule);
+    traverser.Traverse(queryNode, referenceNode);
+    AddStatistics(traverser);
+    return;
+  }
+
+  #pragma omp parallel
+  {
+    // Each thread gets its own copy of the rules and a serial traverser.
+    RuleType threadRule(rule);
+    TraverserType traverser(threadRule);
+    std::vector<TreeType*> threadTasks;
+
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t i = 0; i < (omp_size_t) tasks.size(); ++i)
+    {
+      traverser.Traverse(*tasks[i], referenceNode);
+      threadTasks.push_back(tasks[i]);
+    }
+
+    // Combine the results of each thread.
+    #pragma omp critical
+    {
+      rule.Merge(threadRule, threadTasks);
+      AddStatistics(traverser);
+    }
+  }
+}
+
+template<typename TreeType, typename RuleType, typename TraverserType>
+void ParallelDualTreeTraverser<TreeType, RuleType, TraverserType>::
+SplitQueryTree(TreeType& queryNode,
+               const size_t minTasks,
+               std::vector<TreeType*>& tasks) const
+{
+  // Split nodes in breadth-first order, so that tasks are of similar size.
+  // Leaves cannot be split any further, so they become tasks immediately.
+  std::queue<TreeType*> nodes;
+  nodes.push(&queryNode);
+  while (!nodes.empty() && (nodes.size() + tasks.size() < minTasks))
+  {
+    TreeType* node = nodes.front();
+    nodes.pop();
+
+    if (node->IsLeaf())
+    {
+      tasks.push_back(node);
+      continue;
+    }
+
+    for (size_t i = 0; i < node->NumChildren(); ++i)
+      nodes.push(&node->Child(i));
+  }
+
+  while (!nodes.empty())
+  {
+    tasks.push_back(nodes.front());
+    nodes.pop();
+  }
+}
+
+template<typename TreeType, typename RuleType, typename TraverserType>
+void ParallelDualTreeTraverser<TreeType, RuleType, TraverserType>::
+AddStatistics(const TraverserType& traverser)
+{
+  numPrunes += traverser.NumPrunes();
+  numVisited += traverser.NumVisited();
+  numScores += traverser.NumScores();
+  numBaseCases += traverser.NumBaseCases();
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif // MLPACK_CORE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_IMPL_HPP
@@ -20,6 +20,67 @@ namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
 namespace split {
 
+/**
+ * Nodes with at least this many points are partitioned with all threads, when
+ * OpenMP is available and the tree is not being built inside a parallel
+ * region.
+ */
+const size_t ParallelSplitThreshold = 16384;
+
+/**
+ * Rearrange the points of the node like PerformSplit(), but decide which child
+ * each point belongs to in parallel first, since for many split types (such as
+ * random projection splits) that is the expensive part.  The points are then
+ * swapped in the same order as PerformSplit() would, so the result is the same.
+ *
+ * @param data The dataset used by the binary space tree.
+ * @param begin Index of the starting point in the dataset that belongs to
+ *    this node.
+ * @param count Number of points in this node.
+ * @param splitInfo The information about the split.
+ * @param oldFromNew Vector which will be filled with the old positions for
+ *    each new point, or NULL if the indices are not needed.
+ */
+template<typename MatType, typename SplitType>
+size_t ParallelPerformSplit(MatType& data,
+                            const size_t begin,
+                            const size_t count,
+                            const typename SplitType::SplitInfo& splitInfo,
+                            std::vector<size_t>* oldFromNew)
+{
+  std::vector<char> assignToLeft(count);
+  #pragma omp parallel for schedule(static)
+  for (omp_size_t i = 0; i < (omp_size_t) count; ++i)
+  {
+    assignToLeft[i] = SplitType::AssignToLeftNode(data.col(begin + i),
+        splitInfo);
+  }
+
+  // The points in [begin, begin + left) belong to the left child, and the
+  // points in [begin + right, begin + count) belong to the right child.
+  size_t left = 0;
+  size_t right = count;
+  while (true)
+  {
+    while (left < right && assignToLeft[left])
+      left++;
+    while (left < right && !assignToLeft[right - 1])
+      right--;
+
+    if (left >= right)
+      break;
+
+    data.swap_cols(begin + left, begin + right - 1);
+    if (oldFromNew)
+      std::swap((*oldFromNew)[begin + left], (*oldFromNew)[begin + right - 1]);
+
+    left++;
+    right--;
+  }
+
+  return begin + left;
+}
+
 /**
  * This function implements the default split behavior i.e. it rearranges
  * points according to the split information. The SplitType::AssignToLeftNode()
@@ -38,6 +99,15 @@ size_t PerformSplit(MatType& data,
                     const size_t count,
                     const typename SplitType::SplitInfo& splitInfo)
 {
+  #ifdef HAS_OPENMP
+  if (count >= ParallelSplitThreshold && !omp_in_parallel() &&
+      omp_get_max_threads() > 1)
+  {
+    return ParallelPerformSplit<MatType, SplitType>(data, begin, count,
+        splitInfo, NULL);
+  }
+  #endif
+
   // This method modifies the input dataset.  We loop both from the left and
   // right sides of the points contained in this node.
   size_t left = begin;
@@ -104,6 +174,15 @@ size_t PerformSplit(MatType& data,
                     const typename SplitType::SplitInfo& splitInfo,
                     std::vector<size_t>& oldFromNew)
 {
+  #ifdef HAS_OPENMP
+  if (count >= ParallelSplitThreshold && !omp_in_parallel() &&
+      omp_get_max_threads() > 1)
+  {
+    return ParallelPerformSplit<MatType, SplitType>(data, begin, count,
+        splitInfo, &oldFromNew);
+  }
+  #endif
+
   // This method modifies the input dataset.  We loop both from the left and
   // right sides of the points contained in this node.
   size_t left = begin;
@@ -0,0 +1,88 @@
+/**
+ * @file query_tree_handle.hpp
+ *
+ * A handle to a query tree of any type, so that a query tree can be built once
+ * by a model that hides its tree type (like NSModel or RSModel) and then be
+ * used for many searches.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_QUERY_TREE_HANDLE_HPP
+#define MLPACK_CORE_TREE_QUERY_TREE_HANDLE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <typeinfo>
+#include <vector>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * QueryTreeHandle holds a query tree, along with the mapping from the indices
+ * of the points in the tree to the indices of the original query points (if
+ * the tree rearranged them).  The type of the tree is not part of the type of
+ * the handle; Get<TreeType>() returns the tree only if it has the given type.
+ *
+ * Copies of a handle share the same tree, which is freed when the last copy is
+ * destroyed.  Because a search modifies the statistics of the query tree, the
+ * same tree must not be used by two searches at the same time.
+ */
+class QueryTreeHandle
+{
+ public:
+  //! Create an empty handle.
+  QueryTreeHandle() : type(nullptr), numPoints(0) { }
+
+  /**
+   * Take ownership of the given tree.
+   *
+   * @param tree Query tree, allocated with new.
+   * @param oldFromNew Mapping from the indices of the points in the tree to the
+   *     indices of the original points (empty if the points were not moved).
+   */
+  template<typename TreeType>
+  QueryTreeHandle(TreeType* tree, std::vector<size_t> oldFromNew) :
+      tree(tree),
+      type(&typeid(TreeType)),
+      numPoints(tree->Dataset().n_cols),
+      oldFromNew(std::move(oldFromNew))
+  { }
+
+  //! Get the tree if it has the given type, or nullptr otherwise.
+  template<typename TreeType>
+  TreeType* Get() const
+  {
+    if (!type || *type != typeid(TreeType))
+      return nullptr;
+    return static_cast<TreeType*>(tree.get());
+  }
+
+  //! Return whether or not the handle holds a tree.
+  bool Empty() const { return !tree; }
+
+  //! Get the number of query points in the tree.
+  size_t NumPoints() const { return numPoints; }
+
+  //! Get the mapping from the indices of the points in the tree to the
+  //! indices of the original points (empty if the points were not moved).
+  const std::vector<size_t>& OldFromNew() const { return oldFromNew; }
+
+ private:
+  //! The tree; the deleter knows its real type.
+  std::shared_ptr<void> tree;
+  //! The type of the tree.
+  const std::type_info* type;
+  //! The number of query points.
+  size_t numPoints;
+  //! The mapping from new point indices to old point indices.
+  std::vector<size_t> oldFromNew;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,156 @@
+/**
+ * @file concurrent_rectangle_tree.hpp
+ *
+ * Definition of ConcurrentRectangleTree, a wrapper around a rectangle type tree
+ * that lets query threads search the tree while another thread inserts and
+ * deletes points.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_RECTANGLE_TREE_CONCURRENT_RECTANGLE_TREE_HPP
+#define MLPACK_CORE_TREE_RECTANGLE_TREE_CONCURRENT_RECTANGLE_TREE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <memory>
+#include <mutex>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The ConcurrentRectangleTree class holds a rectangle type tree (RTree,
+ * RStarTree, XTree, HilbertRTree, RPlusTree or RPlusPlusTree) that is updated
+ * online, and allows queries to run without waiting for updates.
+ *
+ * Updates are applied to a private working tree, and the tree that queries see
+ * is an immutable snapshot of the working tree, which is replaced with a new
+ * copy of the working tree by Publish().  Snapshot() returns a shared pointer
+ * to the current snapshot; a query thread that holds it can search it with
+ * single-tree traversals as long as it likes, since the snapshot is never
+ * modified and stays alive until the last query that uses it is done.  Taking
+ * a snapshot never blocks, so queries are not delayed by updates at all.
+ *
+ * Snapshots are copied as a whole: the nodes of a rectangle tree know their
+ * parents, so the path to a modified node can't be copied without also copying
+ * its siblings and all of their descendants.  Because publishing takes time
+ * linear in the size of the tree, updates are batched: a new snapshot is only
+ * published after every publishInterval updates, or when Publish() is called.
+ *
+ * Any number of threads may call Snapshot() concurrently with each other and
+ * with the update methods; the update methods are serialized with a mutex.
+ *
+ * @code
+ * typedef RStarTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+ * ConcurrentRectangleTree<TreeType> index(std::move(tree), 1000);
+ *
+ * // In the writer thread:
+ * index.Insert(newPoints);
+ *
+ * // In a query thread:
+ * std::shared_ptr<const TreeType> snapshot = index.Snapshot();
+ * TreeType::SingleTreeTraverser<RuleType> traverser(rules);
+ * traverser.Traverse(queryIndex, *snapshot);
+ * @endcode
+ *
+ * @tparam TreeType Type of the rectangle tree to hold.
+ */
+template<typename TreeType>
+class ConcurrentRectangleTree
+{
+ public:
+  //! The type of dataset held by the tree.
+  typedef typename TreeType::Mat MatType;
+
+  /**
+   * Take ownership of the given tree, and publish a first snapshot of it.
+   *
+   * @param tree Tree to hold.
+   * @param publishInterval Number of updates after which a new snapshot is
+   *     published automatically (0 means that snapshots are only published by
+   *     Publish()).
+   */
+  ConcurrentRectangleTree(TreeType&& tree, const size_t publishInterval = 1);
+
+  /**
+   * Build a tree on the given dataset and publish a first snapshot of it.
+   *
+   * @param data Dataset to build the tree on.
+   * @param publishInterval Number of updates after which a new snapshot is
+   *     published automatically (0 means that snapshots are only published by
+   *     Publish()).
+   */
+  ConcurrentRectangleTree(const MatType& data,
+                          const size_t publishInterval = 1);
+
+  /**
+   * Get the current snapshot of the tree.  The snapshot will not change;
+   * updates made later are only visible in snapshots obtained after the next
+   * publication.  This never blocks.
+   */
+  std::shared_ptr<const TreeType> Snapshot() const;
+
+  /**
+   * Append the given points to the dataset and insert them into the working
+   * tree.  The points get the indices n to (n + points.n_cols - 1), where n is
+   * the number of columns of the dataset before the call.
+   *
+   * @param points Points to insert.
+   * @return Index of the first inserted point.
+   */
+  size_t Insert(const MatType& points);
+
+  /**
+   * Delete the point with the given index from the working tree.  The point
+   * stays in the dataset, so the indices of the other points don't change.
+   *
+   * @param point Index of the point to delete.
+   * @return true if the point was found and deleted.
+   */
+  bool DeletePoint(const size_t point);
+
+  /**
+   * Publish a snapshot of the working tree, so that the updates made so far
+   * are visible to queries.
+   */
+  void Publish();
+
+  //! Get the number of updates that have not been published yet.
+  size_t PendingUpdates() const;
+
+  //! Get the number of updates after which a snapshot is published.
+  size_t PublishInterval() const { return publishInterval; }
+  //! Modify the number of updates after which a snapshot is published.
+  size_t& PublishInterval() { return publishInterval; }
+
+ private:
+  //! Count the given number of updates, and publish if needed.  The write
+  //! mutex must be held.
+  void Updated(const size_t numUpdates);
+
+  //! Copy the working tree into a new snapshot.  The write mutex must be held.
+  void PublishLocked();
+
+  //! The tree that updates are applied to.
+  std::unique_ptr<TreeType> workingTree;
+  //! The current snapshot; only accessed with std::atomic_load() and
+  //! std::atomic_store().
+  std::shared_ptr<const TreeType> snapshot;
+  //! Number of updates after which a snapshot is published.
+  size_t publishInterval;
+  //! Number of updates that have not been published.
+  size_t pendingUpdates;
+  //! Mutex that serializes updates.
+  mutable std::mutex writeMutex;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "concurrent_rectangle_tree_impl.hpp"
+
+#endif
@@ -0,0 +1,121 @@
+/**
+ * @file concurrent_rectangle_tree_impl.hpp
+ *
+ * Implementation of ConcurrentRectangleTree.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_RECTANGLE_TREE_CONCURRENT_RECTANGLE_TREE_IMPL_HPP
+#define MLPACK_CORE_TREE_RECTANGLE_TREE_CONCURRENT_RECTANGLE_TREE_IMPL_HPP
+
+// In case it wasn't included already for some reason.
+#include "concurrent_rectangle_tree.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename TreeType>
+ConcurrentRectangleTree<TreeType>::ConcurrentRectangleTree(
+    TreeType&& tree,
+    const size_t publishInterval) :
+    workingTree(new TreeType(std::move(tree))),
+    publishInterval(publishInterval),
+    pendingUpdates(0)
+{
+  PublishLocked();
+}
+
+template<typename TreeType>
+ConcurrentRectangleTree<TreeType>::ConcurrentRectangleTree(
+    const MatType& data,
+    const size_t publishInterval) :
+    workingTree(new TreeType(data)),
+    publishInterval(publishInterval),
+    pendingUpdates(0)
+{
+  PublishLocked();
+}
+
+template<typename TreeType>
+std::shared_ptr<const TreeType>
+ConcurrentRectangleTree<TreeType>::Snapshot() const
+{
+  return std::atomic_load(&snapshot);
+}
+
+template<typename TreeType>
+size_t ConcurrentRectangleTree<TreeType>::Insert(const MatType& points)
+{
+  std::lock_guard<std::mutex> lock(writeMutex);
+
+  if (points.n_rows != workingTree->Dataset().n_rows)
+  {
+    std::ostringstream oss;
+    oss << "ConcurrentRectangleTree::Insert(): dimensionality of points ("
+        << points.n_rows << ") does not match the dimensionality of the tree ("
+        << workingTree->Dataset().n_rows << ")!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // The working tree is not visible to queries, so its dataset may be resized.
+  const size_t first = workingTree->Dataset().n_cols;
+  workingTree->Dataset().insert_cols(first, points);
+  for (size_t i = 0; i < points.n_cols; ++i)
+    workingTree->InsertPoint(first + i);
+
+  Updated(points.n_cols);
+  return first;
+}
+
+template<typename TreeType>
+bool ConcurrentRectangleTree<TreeType>::DeletePoint(const size_t point)
+{
+  std::lock_guard<std::mutex> lock(writeMutex);
+
+  const bool deleted = workingTree->DeletePoint(point);
+  if (deleted)
+    Updated(1);
+
+  return deleted;
+}
+
+template<typename TreeType>
+void ConcurrentRectangleTree<TreeType>::Publish()
+{
+  std::lock_guard<std::mutex> lock(writeMutex);
+  PublishLocked();
+}
+
+template<typename TreeType>
+size_t ConcurrentRectangleTree<TreeType>::PendingUpdates() const
+{
+  std::lock_guard<std::mutex> lock(writeMutex);
+  return pendingUpdates;
+}
+
+template<typename TreeType>
+void ConcurrentRectangleTree<TreeType>::Updated(const size_t numUpdates)
+{
+  pendingUpdates += numUpdates;
+  if (publishInterval > 0 && pendingUpdates >= publishInterval)
+    PublishLocked();
+}
+
+template<typename TreeType>
+void ConcurrentRectangleTree<TreeType>::PublishLocked()
+{
+  // The copy is made before the snapshot is replaced, so queries keep using
+  // the old snapshot until the new one is complete.  The old snapshot is freed
+  // when the last query that holds it releases it.
+  std::shared_ptr<const TreeType> newSnapshot(new TreeType(*workingTree));
+  std::atomic_store(&snapshot, newSnapshot);
+  pendingUpdates = 0;
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
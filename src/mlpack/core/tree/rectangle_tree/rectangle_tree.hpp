@@ -24,6 +24,20 @@
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
 
+/**
+ * The orderings that can be used by the bulk-loading constructors of
+ * RectangleTree to pack points into leaves.
+ */
+enum BulkLoadOrdering
+{
+  //! Sort-Tile-Recursive: the points are sorted along the first dimension and
+  //! cut into slabs, each slab is sorted and cut along the next dimension, and
+  //! so on.
+  STR_BULK_LOAD,
+  //! The points are sorted by their discrete Hilbert values.
+  HILBERT_BULK_LOAD
+};
+
 /**
  * A rectangle type tree tree, such as an R-tree or X-tree.  Once the
  * bound and type of dataset is defined, the tree will construct itself.  Call
@@ -104,6 +118,10 @@ class RectangleTree
   std::vector<size_t> points;
   //! A tree-specific information
   AuxiliaryInformationType<RectangleTree> auxiliaryInfo;
+  #ifdef MLPACK_MEMORY_TRACKING
+  //! Counts this node in the MemoryTracker.
+  TrackedObject<RectangleTree> tracked;
+  #endif
 
  public:
   //! A single traverser for rectangle type trees.  See
@@ -156,6 +174,57 @@ class RectangleTree
                 const size_t minNumChildren = 2,
                 const size_t firstDataIndex = 0);
 
+  /**
+   * Construct this as the root node of a rectangle type tree by bulk loading
+   * the given dataset: instead of inserting the points one at a time, the
+   * points are sorted with the given ordering and packed into full leaves, and
+   * the levels above the leaves are packed in the same way from the bottom up.
+   * This is much faster than inserting the points, and the packed nodes
+   * usually overlap less.  For STR_BULK_LOAD, the centers of the nodes of each
+   * level are tiled again to build the next level; for HILBERT_BULK_LOAD, the
+   * nodes of each level are grouped in the Hilbert order of their points.
+   *
+   * Trees whose insertion relies on auxiliary information or non-overlapping
+   * children (Hilbert R trees, R+ trees and R++ trees) cannot be packed; for
+   * those, the points are inserted one at a time in the given ordering.
+   *
+   * @param data Dataset from which to create the tree.
+   * @param ordering Ordering to pack the points with.
+   * @param maxLeafSize Maximum size of each leaf in the tree.
+   * @param minLeafSize Minimum size of each leaf in the tree.
+   * @param maxNumChildren The maximum number of child nodes a non-leaf node may
+   *      have.
+   * @param minNumChildren The minimum number of child nodes a non-leaf node may
+   *      have.
+   */
+  RectangleTree(const MatType& data,
+                const BulkLoadOrdering ordering,
+                const size_t maxLeafSize = 20,
+                const size_t minLeafSize = 8,
+                const size_t maxNumChildren = 5,
+                const size_t minNumChildren = 2);
+
+  /**
+   * Construct this as the root node of a rectangle type tree by bulk loading
+   * the given dataset, and taking ownership of the given dataset.  See the
+   * constructor above for details on bulk loading.
+   *
+   * @param data Dataset from which to create the tree.
+   * @param ordering Ordering to pack the points with.
+   * @param maxLeafSize Maximum size of each leaf in the tree.
+   * @param minLeafSize Minimum size of each leaf in the tree.
+   * @param maxNumChildren The maximum number of child nodes a non-leaf node may
+   *      have.
+   * @param minNumChildren The minimum number of child nodes a non-leaf node may
+   *      have.
+   */
+  RectangleTree(MatType&& data,
+                const BulkLoadOrdering ordering,
+                const size_t maxLeafSize = 20,
+                const size_t minLeafSize = 8,
+                const size_t maxNumChildren = 5,
+                const size_t minNumChildren = 2);
+
   /**
    * Construct this as an empty node with the specified parent.  Copying the
    * parameters (maxLeafSize, minLeafSize, maxNumChildren, minNumChildren,
@@ -542,6 +611,26 @@ class RectangleTree
    */
   void SplitNode(std::vector<bool>& relevels);
 
+  /**
+   * Build the tree below this (empty) root node by bulk loading all of the
+   * points of the dataset with the given ordering.
+   */
+  void BulkLoad(const BulkLoadOrdering ordering);
+
+  /**
+   * Sort the items in groups [firstGroup, lastGroup) with Sort-Tile-Recursive,
+   * starting with the given dimension.  The items of group i are
+   * order[offsets[i]] to order[offsets[i + 1] - 1], and the coordinates of item
+   * j are centers.col(j).
+   */
+  template<typename CentersType>
+  static void TileGroups(const CentersType& centers,
+                         const std::vector<size_t>& offsets,
+                         const size_t firstGroup,
+                         const size_t lastGroup,
+                         const size_t dim,
+                         std::vector<size_t>& order);
+
  protected:
   /**
    * A default constructor.  This is meant to only be used with
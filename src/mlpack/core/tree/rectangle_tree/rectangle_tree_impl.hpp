@@ -17,6 +17,9 @@
 
 #include <mlpack/core/util/cli.hpp>
 #include <mlpack/core/util/log.hpp>
+#include <mlpack/core/tree/tree_traits.hpp>
+#include "discrete_hilbert_value.hpp"
+#include "x_tree_auxiliary_information.hpp"
 
 namespace mlpack {
 namespace tree {
@@ -101,6 +104,78 @@ RectangleTree(MatType&& data,
     root->InsertPoint(i);
 }
 
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+              AuxiliaryInformationType>::
+RectangleTree(const MatType& data,
+              const BulkLoadOrdering ordering,
+              const size_t maxLeafSize,
+              const size_t minLeafSize,
+              const size_t maxNumChildren,
+              const size_t minNumChildren) :
+    maxNumChildren(maxNumChildren),
+    minNumChildren(minNumChildren),
+    numChildren(0),
+    children(maxNumChildren + 1), // Add one to make splitting the node simpler.
+    parent(NULL),
+    begin(0),
+    count(0),
+    numDescendants(0),
+    maxLeafSize(maxLeafSize),
+    minLeafSize(minLeafSize),
+    bound(data.n_rows),
+    parentDistance(0),
+    dataset(new MatType(data)),
+    ownsDataset(true),
+    points(maxLeafSize + 1), // Add one to make splitting the node simpler.
+    auxiliaryInfo(this)
+{
+  stat = StatisticType(*this);
+
+  BulkLoad(ordering);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+              AuxiliaryInformationType>::
+RectangleTree(MatType&& data,
+              const BulkLoadOrdering ordering,
+              const size_t maxLeafSize,
+              const size_t minLeafSize,
+              const size_t maxNumChildren,
+              const size_t minNumChildren) :
+    maxNumChildren(maxNumChildren),
+    minNumChildren(minNumChildren),
+    numChildren(0),
+    children(maxNumChildren + 1), // Add one to make splitting the node simpler.
+    parent(NULL),
+    begin(0),
+    count(0),
+    numDescendants(0),
+    maxLeafSize(maxLeafSize),
+    minLeafSize(minLeafSize),
+    bound(data.n_rows),
+    parentDistance(0),
+    dataset(new MatType(std::move(data))),
+    ownsDataset(true),
+    points(maxLeafSize + 1), // Add one to make splitting the node simpler.
+    auxiliaryInfo(this)
+{
+  stat = StatisticType(*this);
+
+  BulkLoad(ordering);
+}
+
 template<typename MetricType,
          typename StatisticType,
          typename MatType,
@@ -893,6 +968,199 @@ void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
   }
 }
 
+/**
+ * Pack the points into leaves, and then pack each level into the level above
+ * it, until few enough nodes are left to be the children of this root node.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+                   AuxiliaryInformationType>::
+    BulkLoad(const BulkLoadOrdering ordering)
+{
+  const size_t numPoints = dataset->n_cols;
+  if (numPoints == 0)
+    return;
+
+  // Divide the points into as few leaves as possible, and balance the number
+  // of points between them.
+  std::vector<size_t> offsets(1 + (numPoints + maxLeafSize - 1) / maxLeafSize);
+  for (size_t i = 0; i < offsets.size(); ++i)
+    offsets[i] = (numPoints * i) / (offsets.size() - 1);
+
+  std::vector<size_t> order(numPoints);
+  for (size_t i = 0; i < numPoints; ++i)
+    order[i] = i;
+
+  typedef DiscreteHilbertValue<ElemType> HilbertValue;
+  if (ordering == HILBERT_BULK_LOAD)
+  {
+    arma::Mat<typename HilbertValue::HilbertElemType> values(dataset->n_rows,
+        numPoints);
+    for (size_t i = 0; i < numPoints; ++i)
+      values.col(i) = HilbertValue::CalculateValue(dataset->col(i));
+
+    // Compare the values in the same way as HilbertValue::CompareValues().
+    std::sort(order.begin(), order.end(),
+        [&values](const size_t a, const size_t b)
+        {
+          return std::lexicographical_compare(values.colptr(a),
+              values.colptr(a) + values.n_rows, values.colptr(b),
+              values.colptr(b) + values.n_rows);
+        });
+  }
+  else
+  {
+    TileGroups(*dataset, offsets, 0, offsets.size() - 1, 0, order);
+  }
+
+  // Hilbert R trees keep the Hilbert values of the points in the auxiliary
+  // information, and R+ and R++ trees must not have overlapping children, so
+  // the packed nodes can't be used for them.
+  const bool packable = TreeTraits<RectangleTree>::HasOverlappingChildren &&
+      (std::is_same<AuxiliaryInformation,
+                    NoAuxiliaryInformation<RectangleTree>>::value ||
+       std::is_same<AuxiliaryInformation,
+                    XTreeAuxiliaryInformation<RectangleTree>>::value);
+  if (!packable || numPoints <= maxLeafSize)
+  {
+    for (size_t i = 0; i < numPoints; ++i)
+      InsertPoint(order[i]);
+    return;
+  }
+
+  // Build the leaves.  The nodes are created as children of this node so that
+  // they take their parameters from it; their parents are set later.
+  std::vector<RectangleTree*> nodes(offsets.size() - 1);
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    RectangleTree* leaf = new RectangleTree(this);
+    for (size_t j = offsets[i]; j < offsets[i + 1]; ++j)
+    {
+      leaf->bound |= dataset->col(order[j]);
+      if (!leaf->auxiliaryInfo.HandlePointInsertion(leaf, order[j]))
+        leaf->points[leaf->count++] = order[j];
+    }
+    leaf->numDescendants = offsets[i + 1] - offsets[i];
+    nodes[i] = leaf;
+  }
+
+  // Build the levels above the leaves.
+  while (nodes.size() > maxNumChildren)
+  {
+    offsets.resize(1 + (nodes.size() + maxNumChildren - 1) / maxNumChildren);
+    for (size_t i = 0; i < offsets.size(); ++i)
+      offsets[i] = (nodes.size() * i) / (offsets.size() - 1);
+
+    // The nodes are already in Hilbert order, but STR must tile the centers of
+    // the nodes again.
+    order.resize(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i)
+      order[i] = i;
+
+    if (ordering == STR_BULK_LOAD)
+    {
+      arma::Mat<ElemType> centers(dataset->n_rows, nodes.size());
+      arma::Col<ElemType> center;
+      for (size_t i = 0; i < nodes.size(); ++i)
+      {
+        nodes[i]->bound.Center(center);
+        centers.col(i) = center;
+      }
+
+      TileGroups(centers, offsets, 0, offsets.size() - 1, 0, order);
+    }
+
+    std::vector<RectangleTree*> parents(offsets.size() - 1);
+    for (size_t i = 0; i < parents.size(); ++i)
+    {
+      RectangleTree* node = new RectangleTree(this);
+      for (size_t j = offsets[i]; j < offsets[i + 1]; ++j)
+      {
+        RectangleTree* child = nodes[order[j]];
+        node->bound |= child->bound;
+        node->numDescendants += child->numDescendants;
+        if (!node->auxiliaryInfo.HandleNodeInsertion(node, child, true))
+        {
+          node->children[node->numChildren++] = child;
+          child->parent = node;
+        }
+
+        // Now that the child is in its place, its statistic can be built.
+        child->stat = StatisticType(*child);
+      }
+      parents[i] = node;
+    }
+
+    nodes.swap(parents);
+  }
+
+  // The remaining nodes are the children of this node.
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    bound |= nodes[i]->bound;
+    numDescendants += nodes[i]->numDescendants;
+    if (!auxiliaryInfo.HandleNodeInsertion(this, nodes[i], true))
+    {
+      children[numChildren++] = nodes[i];
+      nodes[i]->parent = this;
+    }
+
+    nodes[i]->stat = StatisticType(*nodes[i]);
+  }
+
+  stat = StatisticType(*this);
+}
+
+/**
+ * Sort along the given dimension, cut the groups into slabs of (nearly) equal
+ * numbers of groups, and tile each slab along the next dimension.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+template<typename CentersType>
+void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+                   AuxiliaryInformationType>::
+    TileGroups(const CentersType& centers,
+               const std::vector<size_t>& offsets,
+               const size_t firstGroup,
+               const size_t lastGroup,
+               const size_t dim,
+               std::vector<size_t>& order)
+{
+  const size_t numGroups = lastGroup - firstGroup;
+  if (numGroups <= 1)
+    return;
+
+  std::sort(order.begin() + offsets[firstGroup],
+      order.begin() + offsets[lastGroup],
+      [&centers, dim](const size_t a, const size_t b)
+      {
+        return centers(dim, a) < centers(dim, b);
+      });
+
+  if (dim + 1 == centers.n_rows)
+    return;
+
+  // Each of the remaining dimensions should be cut into the same number of
+  // slabs.
+  const size_t numSlabs = (size_t) std::ceil(std::pow((double) numGroups,
+      1.0 / (double) (centers.n_rows - dim)));
+  for (size_t i = 0; i < numSlabs; ++i)
+  {
+    TileGroups(centers, offsets, firstGroup + (numGroups * i) / numSlabs,
+        firstGroup + (numGroups * (i + 1)) / numSlabs, dim + 1, order);
+  }
+}
+
 //! Default constructor for boost::serialization.
 template<typename MetricType,
          typename StatisticType,
@@ -0,0 +1,98 @@
+/**
+ * @file space_filling_curve.hpp
+ *
+ * Ordering of a set of points along a space-filling curve (the Z-order curve
+ * of the addresses of the UB tree, or the Hilbert curve of the Hilbert R tree),
+ * so that points that are close in the order are usually close in space.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_SPACE_FILLING_CURVE_HPP
+#define MLPACK_CORE_TREE_SPACE_FILLING_CURVE_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "address.hpp"
+#include "rectangle_tree/discrete_hilbert_value.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The space-filling curves that points may be ordered along.  NO_CURVE keeps
+ * the points in their own order.
+ */
+enum SpaceFillingCurve
+{
+  NO_CURVE,
+  MORTON_CURVE,
+  HILBERT_CURVE
+};
+
+/**
+ * Compute the order of the given points along the given space-filling curve:
+ * order[i] is the index of the i'th point along the curve.  Single-tree
+ * searches that visit the query points in this order touch the same parts of
+ * the reference tree for consecutive query points, which makes much better use
+ * of the cache than an arbitrary order.  If the curve is NO_CURVE, order is
+ * left empty (which stands for the order of the points).
+ *
+ * The Morton (Z-order) code of a point is its address (see
+ * bound::addr::PointToAddress()), and the Hilbert code is its
+ * DiscreteHilbertValue; both are exact for the floating-point values, so the
+ * points do not need to be normalized.
+ *
+ * @param points Points to order (one per column).
+ * @param curve Space-filling curve to order the points along.
+ * @param order The index of each point, in the order of the curve.
+ */
+template<typename MatType>
+void SpaceFillingCurveOrder(const MatType& points,
+                            const SpaceFillingCurve curve,
+                            std::vector<size_t>& order)
+{
+  typedef typename MatType::elem_type ElemType;
+  typedef typename DiscreteHilbertValue<ElemType>::HilbertElemType
+      CodeElemType;
+
+  order.clear();
+  if (curve == NO_CURVE || points.n_rows == 0)
+    return;
+
+  // Both kinds of codes are compared lexicographically.  The points are copied
+  // element by element, so that MatType may be sparse.
+  std::vector<arma::Col<CodeElemType>> codes(points.n_cols);
+  arma::Col<ElemType> point(points.n_rows);
+  for (size_t i = 0; i < points.n_cols; ++i)
+  {
+    for (size_t d = 0; d < points.n_rows; ++d)
+      point[d] = points(d, i);
+
+    if (curve == MORTON_CURVE)
+    {
+      codes[i].set_size(point.n_elem);
+      bound::addr::PointToAddress(codes[i], point);
+    }
+    else
+    {
+      codes[i] = DiscreteHilbertValue<ElemType>::CalculateValue(point);
+    }
+  }
+
+  order.resize(points.n_cols);
+  for (size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+
+  std::stable_sort(order.begin(), order.end(),
+      [&codes](const size_t a, const size_t b)
+      {
+        return bound::addr::CompareAddresses(codes[a], codes[b]) < 0;
+      });
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -13,6 +13,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include "../space_split/midpoint_space_split.hpp"
+#include "../node_arena.hpp"
 #include "../statistic.hpp"
 
 namespace mlpack {
@@ -36,6 +37,9 @@ namespace tree /** Trees and tree-building procedures. */ {
  * from it.  If you need to add or delete a node, the better procedure is to
  * rebuild the tree entirely.
  *
+ * The nodes below the root are allocated from a NodeArena owned by the root,
+ * and are freed all at once with it.
+ *
  * Three runtime parameters are required in the constructor:
  *  - maxLeafSize: Max leaf size to be used.
  *  - tau: Overlapping size.
@@ -113,6 +117,15 @@ class SpillTree
   const MatType* dataset;
   //! If true, we own the dataset and need to destroy it in the destructor.
   bool localDataset;
+  //! For the root, the arena holding the other nodes of the tree, which the
+  //! root owns (see NodeArena).  For any other node, the arena it was
+  //! allocated from (NULL if it was allocated with new), which its children
+  //! are allocated from too.
+  NodeArena* arena;
+  #ifdef MLPACK_MEMORY_TRACKING
+  //! Counts this node in the MemoryTracker.
+  TrackedObject<SpillTree> tracked;
+  #endif
 
   //! A generic single-tree traverser for hybrid spill trees; see
   //! spill_single_tree_traverser.hpp for implementation.  The Defeatist
@@ -236,6 +249,10 @@ class SpillTree
   //! Return the statistic object for this node.
   StatisticType& Stat() { return stat; }
 
+  //! Get the arena holding the nodes of the tree below the root (NULL if the
+  //! nodes are not in an arena); see NodeArena.
+  const NodeArena* Arena() const { return arena; }
+
   //! Return whether or not this node is a leaf (true if it has no children).
   bool IsLeaf() const;
 
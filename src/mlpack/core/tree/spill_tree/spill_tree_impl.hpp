@@ -41,7 +41,8 @@ SpillTree(
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
     dataset(&data),
-    localDataset(false)
+    localDataset(false),
+    arena(NULL)
 {
   arma::Col<size_t> points;
   if (dataset->n_cols > 0)
@@ -78,7 +79,8 @@ SpillTree(
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
     dataset(new MatType(std::move(data))),
-    localDataset(true)
+    localDataset(true),
+    arena(NULL)
 {
   arma::Col<size_t> points;
   if (dataset->n_cols > 0)
@@ -115,7 +117,8 @@ SpillTree(
     hyperplane(),
     bound(parent->Dataset().n_rows),
     dataset(&parent->Dataset()), // Point to the parent's dataset.
-    localDataset(false)
+    localDataset(false),
+    arena(parent->arena)
 {
   // Perform the actual splitting.
   SplitNode(points, maxLeafSize, tau, rho);
@@ -151,7 +154,8 @@ SpillTree(const SpillTree& other) :
     // copy of the dataset.
     dataset((other.parent == NULL && other.localDataset) ?
         new MatType(*other.dataset) : other.dataset),
-    localDataset(other.parent == NULL && other.localDataset)
+    localDataset(other.parent == NULL && other.localDataset),
+    arena(NULL)
 {
   // Create left and right children (if any).
   if (other.Left())
@@ -216,7 +220,8 @@ SpillTree(SpillTree&& other) :
     furthestDescendantDistance(other.furthestDescendantDistance),
     minimumBoundDistance(other.minimumBoundDistance),
     dataset(other.dataset),
-    localDataset(other.localDataset)
+    localDataset(other.localDataset),
+    arena(other.arena)
 {
   // Now we are a clone of the other tree.  But we must also clear the other
   // tree's contents, so it doesn't delete anything when it is destructed.
@@ -229,6 +234,7 @@ SpillTree(SpillTree&& other) :
   other.minimumBoundDistance = 0.0;
   other.dataset = NULL;
   other.localDataset = false;
+  other.arena = NULL;
 
   // Set new parent.
   if (left)
@@ -272,13 +278,20 @@ template<typename MetricType,
 SpillTree<MetricType, StatisticType, MatType, HyperplaneType, SplitType>::
     ~SpillTree()
 {
-  delete left;
-  delete right;
+  if (left)
+    DeleteNode(left, left->arena);
+  if (right)
+    DeleteNode(right, right->arena);
   delete pointsIndex;
 
   // If we're the root and we own the dataset, delete it.
   if (!parent && localDataset)
     delete dataset;
+
+  // If we're the root, delete the arena of the nodes (which have all been
+  // destructed now).
+  if (!parent)
+    delete arena;
 }
 
 template<typename MetricType,
@@ -614,10 +627,15 @@ void SpillTree<MetricType, StatisticType, MatType, HyperplaneType, SplitType>::
   // We don't need the information in points, so lets clean it.
   arma::Col<size_t>().swap(points);
 
+  // The nodes of the tree are allocated from the arena of the root, which
+  // creates it for its first children.
+  if (parent == NULL && arena == NULL)
+    arena = new NodeArena();
+
   // Now we will recursively split the children by calling their constructors
   // (which perform this splitting process).
-  left = new SpillTree(this, leftPoints, tau, maxLeafSize, rho);
-  right = new SpillTree(this, rightPoints, tau, maxLeafSize, rho);
+  left = NewNode<SpillTree>(arena, this, leftPoints, tau, maxLeafSize, rho);
+  right = NewNode<SpillTree>(arena, this, rightPoints, tau, maxLeafSize, rho);
 
   // Update count number, to represent the number of descendant points.
   count = left->NumDescendants() + right->NumDescendants();
@@ -729,7 +747,8 @@ SpillTree<MetricType, StatisticType, MatType, HyperplaneType, SplitType>::
     parentDistance(0),
     furthestDescendantDistance(0),
     dataset(NULL),
-    localDataset(false)
+    localDataset(false),
+    arena(NULL)
 {
   // Nothing to do.
 }
@@ -751,9 +770,9 @@ void SpillTree<MetricType, StatisticType, MatType, HyperplaneType, SplitType>::
   if (Archive::is_loading::value)
   {
     if (left)
-      delete left;
+      DeleteNode(left, left->arena);
     if (right)
-      delete right;
+      DeleteNode(right, right->arena);
     if (!parent && localDataset)
       delete dataset;
 
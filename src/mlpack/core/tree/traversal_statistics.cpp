@@ -0,0 +1,93 @@
+/**
+ * @file traversal_statistics.cpp
+ *
+ * Implementation of the non-template methods of TraversalStatistics.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "traversal_statistics.hpp"
+
+#include <mlpack/core/util/log.hpp>
+
+using namespace mlpack;
+using namespace mlpack::tree;
+
+void TraversalStatistics::Merge(const TraversalStatistics& other)
+{
+  if (other.visitsPerLevel.size() > visitsPerLevel.size())
+  {
+    visitsPerLevel.resize(other.visitsPerLevel.size(), 0);
+    prunesPerLevel.resize(other.prunesPerLevel.size(), 0);
+  }
+
+  for (size_t i = 0; i < other.visitsPerLevel.size(); ++i)
+  {
+    visitsPerLevel[i] += other.visitsPerLevel[i];
+    prunesPerLevel[i] += other.prunesPerLevel[i];
+  }
+
+  for (size_t i = 0; i < NumPruneReasons; ++i)
+    prunes[i] += other.prunes[i];
+
+  for (std::map<size_t, size_t>::const_iterator it = other.leafSizes.begin();
+       it != other.leafSizes.end(); ++it)
+    leafSizes[it->first] += it->second;
+
+  baseCases += other.baseCases;
+  scores += other.scores;
+  treeBuildingTime += other.treeBuildingTime;
+  traversalTime += other.traversalTime;
+}
+
+void TraversalStatistics::Reset()
+{
+  visitsPerLevel.clear();
+  prunesPerLevel.clear();
+  for (size_t i = 0; i < NumPruneReasons; ++i)
+    prunes[i] = 0;
+  leafSizes.clear();
+  baseCases = 0;
+  scores = 0;
+  treeBuildingTime = 0.0;
+  traversalTime = 0.0;
+}
+
+void TraversalStatistics::Report() const
+{
+  Log::Info << "Traversal statistics:" << std::endl;
+  Log::Info << "  " << scores << " node combinations were scored and "
+      << baseCases << " base cases were calculated." << std::endl;
+  Log::Info << "  Prunes: " << prunes[BOUND_PRUNE] << " by bound, "
+      << prunes[RESCORE_PRUNE] << " by rescore, " << prunes[INCLUSION_PRUNE]
+      << " by inclusion, " << prunes[APPROXIMATION_PRUNE]
+      << " by approximation." << std::endl;
+
+  for (size_t i = 0; i < visitsPerLevel.size(); ++i)
+  {
+    Log::Info << "  Level " << i << ": " << visitsPerLevel[i] << " visited, "
+        << prunesPerLevel[i] << " pruned." << std::endl;
+  }
+
+  size_t leaves = 0;
+  size_t points = 0;
+  for (std::map<size_t, size_t>::const_iterator it = leafSizes.begin();
+       it != leafSizes.end(); ++it)
+  {
+    leaves += it->second;
+    points += it->first * it->second;
+  }
+  Log::Info << "  " << leaves << " reference leaves were reached";
+  if (leaves > 0)
+  {
+    Log::Info << " (sizes " << leafSizes.begin()->first << " to "
+        << leafSizes.rbegin()->first << ", average "
+        << ((double) points / (double) leaves) << ")";
+  }
+  Log::Info << "." << std::endl;
+
+  Log::Info << "  " << treeBuildingTime << "s building query trees, "
+      << traversalTime << "s traversing." << std::endl;
+}
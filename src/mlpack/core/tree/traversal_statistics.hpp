@@ -0,0 +1,187 @@
+/**
+ * @file traversal_statistics.hpp
+ *
+ * Definition of TraversalStatistics, which collects detailed statistics about
+ * tree traversals: the nodes visited and pruned at each level of the
+ * reference tree, the reasons for pruning, the sizes of the leaves that were
+ * reached, and the time taken by each phase of a search.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_TRAVERSAL_STATISTICS_HPP
+#define MLPACK_CORE_TREE_TRAVERSAL_STATISTICS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <map>
+#include <vector>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The TraversalStatistics class holds detailed statistics about a tree
+ * traversal.  It is meant to be held as a member of a RuleType class, which
+ * passes the result of each Score() and Rescore() call through Score() and
+ * Rescore() of this class; since every traverser calls the rules, this works
+ * with every tree type and traverser.  Collection is disabled by default, in
+ * which case Score() and Rescore() only return the given score.
+ *
+ * When traversals are run in parallel, each thread should use its own copy of
+ * the rules, and the statistics of each copy should be combined with Merge().
+ *
+ * The levels of the reference tree are counted from the root (level 0).  For
+ * dual-tree traversals, visits are counted at the level of the reference node.
+ */
+class TraversalStatistics
+{
+ public:
+  //! The reasons a node combination may be pruned for.
+  enum PruneReason
+  {
+    //! Score() found that the bounds exclude all of the points in the node.
+    BOUND_PRUNE,
+    //! Rescore() pruned a combination that was not pruned by Score().
+    RESCORE_PRUNE,
+    //! All of the points in the node were added to the results at once.
+    INCLUSION_PRUNE,
+    //! The contribution of the node was approximated.
+    APPROXIMATION_PRUNE
+  };
+
+  //! The number of different prune reasons.
+  static const size_t NumPruneReasons = 4;
+
+  /**
+   * Create the statistics object.  Collection is disabled unless enabled is
+   * true.
+   */
+  TraversalStatistics(const bool enabled = false) : enabled(enabled)
+  {
+    Reset();
+  }
+
+  /**
+   * Record the result of a call to Score() for the given reference node, and
+   * return the score.  If the score is DBL_MAX, the node is counted as pruned
+   * for the given reason; otherwise, if it is a leaf, its size is recorded.
+   */
+  template<typename TreeType>
+  double Score(const TreeType& referenceNode,
+               const double score,
+               const PruneReason reason = BOUND_PRUNE)
+  {
+    if (enabled)
+      RecordVisit(referenceNode, score == DBL_MAX, reason);
+    return score;
+  }
+
+  /**
+   * Record the result of a call to Rescore(), and return the new score.  A
+   * combination is counted as pruned if it was not pruned before.
+   */
+  double Rescore(const double oldScore, const double score)
+  {
+    if (enabled && score == DBL_MAX && oldScore != DBL_MAX)
+      ++prunes[RESCORE_PRUNE];
+    return score;
+  }
+
+  //! Combine the statistics of another traversal (or thread) into these.
+  void Merge(const TraversalStatistics& other);
+
+  //! Clear all statistics; whether collection is enabled is unchanged.
+  void Reset();
+
+  //! Print the statistics to Log::Info.
+  void Report() const;
+
+  //! Get whether statistics are collected.
+  bool Enabled() const { return enabled; }
+  //! Modify whether statistics are collected.
+  bool& Enabled() { return enabled; }
+
+  //! Get the number of node combinations visited at each level.
+  const std::vector<size_t>& VisitsPerLevel() const { return visitsPerLevel; }
+  //! Get the number of node combinations pruned at each level.
+  const std::vector<size_t>& PrunesPerLevel() const { return prunesPerLevel; }
+  //! Get the number of prunes made for the given reason.
+  size_t Prunes(const PruneReason reason) const { return prunes[reason]; }
+  //! Get the number of times a reference leaf of each size was reached.
+  const std::map<size_t, size_t>& LeafSizes() const { return leafSizes; }
+
+  //! Get the number of base cases.
+  size_t BaseCases() const { return baseCases; }
+  //! Modify the number of base cases.
+  size_t& BaseCases() { return baseCases; }
+  //! Get the number of scores.
+  size_t Scores() const { return scores; }
+  //! Modify the number of scores.
+  size_t& Scores() { return scores; }
+
+  //! Get the time spent building query trees, in seconds.
+  double TreeBuildingTime() const { return treeBuildingTime; }
+  //! Modify the time spent building query trees, in seconds.
+  double& TreeBuildingTime() { return treeBuildingTime; }
+  //! Get the time spent traversing, in seconds.
+  double TraversalTime() const { return traversalTime; }
+  //! Modify the time spent traversing, in seconds.
+  double& TraversalTime() { return traversalTime; }
+
+ private:
+  //! Record a visit of the given reference node.
+  template<typename TreeType>
+  void RecordVisit(const TreeType& referenceNode,
+                   const bool pruned,
+                   const PruneReason reason)
+  {
+    size_t level = 0;
+    for (const TreeType* node = referenceNode.Parent(); node != NULL;
+         node = node->Parent())
+      ++level;
+
+    if (level >= visitsPerLevel.size())
+    {
+      visitsPerLevel.resize(level + 1, 0);
+      prunesPerLevel.resize(level + 1, 0);
+    }
+
+    ++visitsPerLevel[level];
+    if (pruned)
+    {
+      ++prunesPerLevel[level];
+      ++prunes[reason];
+    }
+    else if (referenceNode.IsLeaf())
+    {
+      ++leafSizes[referenceNode.NumPoints()];
+    }
+  }
+
+  //! Whether statistics are collected.
+  bool enabled;
+  //! The number of node combinations visited at each level.
+  std::vector<size_t> visitsPerLevel;
+  //! The number of node combinations pruned at each level.
+  std::vector<size_t> prunesPerLevel;
+  //! The number of prunes for each reason.
+  size_t prunes[NumPruneReasons];
+  //! The number of times a reference leaf of each size was reached.
+  std::map<size_t, size_t> leafSizes;
+  //! The number of base cases.
+  size_t baseCases;
+  //! The number of scores.
+  size_t scores;
+  //! The time spent building query trees, in seconds.
+  double treeBuildingTime;
+  //! The time spent traversing, in seconds.
+  double traversalTime;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -10,6 +10,7 @@
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
 #include <list>
+#include <mutex>
 #include <boost/program_options.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <iostream>
@@ -30,6 +31,23 @@ using namespace mlpack::util;
 static ProgramDoc emptyProgramDoc = ProgramDoc("", "", []() { return ""; },
     {});
 
+// The CLI::Context of each thread, if any.
+static thread_local CLI* currentContext = NULL;
+
+// Settings may be restored by several threads at once.
+static std::mutex& StorageMutex()
+{
+  static std::mutex storageMutex;
+  return storageMutex;
+}
+
+// Held while a program that sets the random seed runs.
+static std::mutex& RandomMutex()
+{
+  static std::mutex randomMutex;
+  return randomMutex;
+}
+
 /* Constructors, Destructors, Copy */
 /* Make the constructor private, to preclude unauthorized instances */
 CLI::CLI() : didParse(false), doc(&emptyProgramDoc)
@@ -119,13 +137,60 @@ bool CLI::HasParam(const std::string& key)
   return (parameters.at(checkKey).wasPassed > 0);
 }
 
-// Returns the sole instance of this class.
+// Returns the instance of the context of this thread, or the sole global
+// instance of this class.
 CLI& CLI::GetSingleton()
+{
+  if (currentContext != NULL)
+    return *currentContext;
+
+  return GetGlobal();
+}
+
+// Returns the sole global instance of this class.
+CLI& CLI::GetGlobal()
 {
   static CLI singleton;
   return singleton;
 }
 
+CLI::Context::Context() : instance(new CLI()), previous(currentContext)
+{
+  // Start with the persistent parameters (and the documentation) of the
+  // global singleton, just like after ClearSettings().
+  CLI& global = GetGlobal();
+  {
+    std::lock_guard<std::mutex> lock(StorageMutex());
+    instance->parameters = global.parameters;
+    instance->aliases = global.aliases;
+    instance->functionMap = global.functionMap;
+  }
+  instance->doc = global.doc;
+  instance->programName = global.programName;
+
+  currentContext = instance;
+  ClearSettings();
+}
+
+CLI::Context::~Context()
+{
+  currentContext = previous;
+  delete instance;
+}
+
+CLI::RandomScope::RandomScope() :
+    locked(Parameters().count("seed") > 0)
+{
+  if (locked)
+    RandomMutex().lock();
+}
+
+CLI::RandomScope::~RandomScope()
+{
+  if (locked)
+    RandomMutex().unlock();
+}
+
 /**
  * Registers a ProgramDoc object, which contains documentation about the
  * program.
@@ -171,14 +236,18 @@ void CLI::SetPassed(const std::string& name)
   GetSingleton().parameters[name].wasPassed = true;
 }
 
-// Store settings.
+// Store settings.  The settings are always stored in the global singleton,
+// so that every context can restore them.
 void CLI::StoreSettings(const std::string& name)
 {
   // Take all of the parameters and put them in the map.  Clear anything old
   // first.
-  std::get<0>(GetSingleton().storageMap[name]) = GetSingleton().parameters;
-  std::get<1>(GetSingleton().storageMap[name]) = GetSingleton().aliases;
-  std::get<2>(GetSingleton().storageMap[name]) = GetSingleton().functionMap;
+  {
+    std::lock_guard<std::mutex> lock(StorageMutex());
+    std::get<0>(GetGlobal().storageMap[name]) = GetSingleton().parameters;
+    std::get<1>(GetGlobal().storageMap[name]) = GetSingleton().aliases;
+    std::get<2>(GetGlobal().storageMap[name]) = GetSingleton().functionMap;
+  }
 
   ClearSettings();
 }
@@ -186,21 +255,26 @@ void CLI::StoreSettings(const std::string& name)
 // Restore settings.
 void CLI::RestoreSettings(const std::string& name, const bool fatal)
 {
-  if (GetSingleton().storageMap.count(name) == 0 && fatal)
+  std::unique_lock<std::mutex> lock(StorageMutex());
+  const std::map<std::string, std::tuple<std::map<std::string,
+      util::ParamData>, std::map<char, std::string>, FunctionMapType>>&
+      storageMap = GetGlobal().storageMap;
+  if (storageMap.count(name) == 0 && fatal)
   {
     throw std::invalid_argument("no settings stored under the name '" + name
         + "'");
   }
-  else if (GetSingleton().storageMap.count(name) == 0 && !fatal)
+  else if (storageMap.count(name) == 0 && !fatal)
   {
     // Nothing to do, just clear what's there.
+    lock.unlock();
     ClearSettings();
   }
   else
   {
-    GetSingleton().parameters = std::get<0>(GetSingleton().storageMap[name]);
-    GetSingleton().aliases = std::get<1>(GetSingleton().storageMap[name]);
-    GetSingleton().functionMap = std::get<2>(GetSingleton().storageMap[name]);
+    GetSingleton().parameters = std::get<0>(storageMap.at(name));
+    GetSingleton().aliases = std::get<1>(storageMap.at(name));
+    GetSingleton().functionMap = std::get<2>(storageMap.at(name));
   }
 }
 
@@ -220,12 +220,98 @@ class CLI
    *
    * In this case, the singleton is used to store data for the static methods,
    * as there is no point in defining static methods only to have users call
-   * private instance methods.
+   * private instance methods.  If a CLI::Context is active on the calling
+   * thread, the instance of that context is returned instead.
    *
    * @return The singleton instance for use in the static methods.
    */
   static CLI& GetSingleton();
 
+  /**
+   * A separate set of parameters, function mappings and timers for one run of
+   * a binding, so that several bindings can be run at once in different
+   * threads of the same process.  While a Context exists, every static method
+   * of CLI (and Timer) called from the thread that created it uses the
+   * context instead of the global singleton.  Settings stored with
+   * StoreSettings() are shared by all contexts, so a binding starts by
+   * restoring its settings:
+   *
+   * @code
+   * {
+   *   CLI::Context context;
+   *   CLI::RestoreSettings("K-Nearest-Neighbors Search");
+   *   CLI::GetParam<arma::mat>("reference") = std::move(reference);
+   *   CLI::SetPassed("reference");
+   *   mlpackMain();
+   *   ...
+   * }
+   * @endcode
+   *
+   * A Context must be destroyed on the thread that created it; contexts on the
+   * same thread nest.  Log streams and the random number generator are still
+   * shared by all threads; see RandomScope for running programs that set the
+   * random seed.
+   */
+  class Context
+  {
+   public:
+    //! Create a new context (with the persistent parameters of the global
+    //! singleton) and make it the context of the calling thread.
+    Context();
+
+    //! Destroy the context and restore the previous context of the thread.
+    ~Context();
+
+   private:
+    //! The instance of this context.
+    CLI* instance;
+    //! The context that was active before this one.
+    CLI* previous;
+
+    // Contexts can't be copied.
+    Context(const Context&);
+    Context& operator=(const Context&);
+  };
+
+  /**
+   * Keep programs that set the random seed from running at the same time.
+   * The random number generators of mlpack (and of Armadillo) are shared by
+   * all threads, so two programs that call math::RandomSeed() and then draw
+   * random numbers on different threads would race on them.  While a
+   * RandomScope exists for a program with a "seed" option (which is how a
+   * program that seeds is recognized), other such programs wait to create
+   * theirs; programs without a "seed" option don't wait.  Create it after the
+   * settings of the program are restored, and hold it while mlpackMain() runs:
+   *
+   * @code
+   * {
+   *   CLI::Context context;
+   *   CLI::RestoreSettings("K-Nearest-Neighbors Search");
+   *   ...
+   *   CLI::RandomScope randomScope;
+   *   mlpackMain();
+   * }
+   * @endcode
+   */
+  class RandomScope
+  {
+   public:
+    //! Wait until no other program that seeds runs, if the current program
+    //! has a "seed" option.
+    RandomScope();
+
+    //! Let the other programs that seed run.
+    ~RandomScope();
+
+   private:
+    //! Whether the scope holds the lock.
+    bool locked;
+
+    // Scopes can't be copied.
+    RandomScope(const RandomScope&);
+    RandomScope& operator=(const RandomScope&);
+  };
+
   /**
    * Registers a ProgramDoc object, which contains documentation about the
    * program.  If this method has been called before (that is, if two
@@ -312,6 +398,9 @@ class CLI
   util::ProgramDoc* doc;
 
  private:
+  //! Get the global singleton, which holds the stored settings.
+  static CLI& GetGlobal();
+
   /**
    * Make the constructor private, to preclude unauthorized instances.
    */
@@ -0,0 +1,109 @@
+/**
+ * @file mapped_file.cpp
+ *
+ * Implementation of the MappedFile class, using mmap() on POSIX systems and
+ * file mappings on Windows.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "mapped_file.hpp"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+using namespace mlpack;
+using namespace mlpack::util;
+
+MappedFile::MappedFile(const std::string& filename) :
+    filename(filename),
+    data(NULL),
+    size(0)
+{
+#ifdef _WIN32
+  fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+      NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (fileHandle == INVALID_HANDLE_VALUE)
+    throw std::runtime_error("cannot open file '" + filename + "'");
+
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(fileHandle, &fileSize))
+  {
+    CloseHandle(fileHandle);
+    throw std::runtime_error("cannot get size of file '" + filename + "'");
+  }
+  size = (size_t) fileSize.QuadPart;
+
+  mappingHandle = NULL;
+  if (size > 0)
+  {
+    mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_WRITECOPY, 0, 0,
+        NULL);
+    if (mappingHandle != NULL)
+      data = (char*) MapViewOfFile(mappingHandle, FILE_MAP_COPY, 0, 0, 0);
+
+    if (data == NULL)
+    {
+      if (mappingHandle != NULL)
+        CloseHandle(mappingHandle);
+      CloseHandle(fileHandle);
+      throw std::runtime_error("cannot map file '" + filename + "'");
+    }
+  }
+#else
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("cannot open file '" + filename + "'");
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0)
+  {
+    close(fd);
+    throw std::runtime_error("cannot get size of file '" + filename + "'");
+  }
+  size = (size_t) fileStat.st_size;
+
+  if (size > 0)
+  {
+    void* mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd,
+        0);
+    if (mapping == MAP_FAILED)
+    {
+      close(fd);
+      throw std::runtime_error("cannot map file '" + filename + "'");
+    }
+
+    data = (char*) mapping;
+  }
+
+  // The mapping stays valid after the file descriptor is closed.
+  close(fd);
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef _WIN32
+  if (data)
+    UnmapViewOfFile(data);
+  if (mappingHandle)
+    CloseHandle(mappingHandle);
+  CloseHandle(fileHandle);
+#else
+  if (data)
+    munmap(data, size);
+#endif
+}
@@ -0,0 +1,77 @@
+/**
+ * @file mapped_file.hpp
+ *
+ * A simple read-only view of a file that is mapped into memory.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_UTIL_MAPPED_FILE_HPP
+#define MLPACK_CORE_UTIL_MAPPED_FILE_HPP
+
+#include <string>
+#include <cstddef>
+
+namespace mlpack {
+namespace util {
+
+/**
+ * MappedFile maps an entire file into memory, so that its contents can be used
+ * directly (for instance as the memory of an Armadillo matrix) without reading
+ * or parsing the file.  Pages are only loaded from disk when they are first
+ * touched.
+ *
+ * The mapping is private and copy-on-write: the memory may be modified, but
+ * modifications are never written back to the file.  The mapping is released
+ * when the object is destroyed, so any objects that use the memory must be
+ * destroyed first.
+ *
+ * If the file cannot be opened or mapped, std::runtime_error is thrown.
+ */
+class MappedFile
+{
+ public:
+  /**
+   * Map the given file into memory.
+   *
+   * @param filename Name of file to map.
+   */
+  MappedFile(const std::string& filename);
+
+  //! Unmap the file.
+  ~MappedFile();
+
+  //! A mapping cannot be copied.
+  MappedFile(const MappedFile& other) = delete;
+  //! A mapping cannot be copied.
+  MappedFile& operator=(const MappedFile& other) = delete;
+
+  //! Get a pointer to the beginning of the mapped memory.
+  char* Data() const { return data; }
+  //! Get the size of the mapped memory (the size of the file) in bytes.
+  size_t Size() const { return size; }
+  //! Get the name of the mapped file.
+  const std::string& Filename() const { return filename; }
+
+ private:
+  //! The name of the mapped file.
+  std::string filename;
+  //! The mapped memory.
+  char* data;
+  //! The size of the mapped memory.
+  size_t size;
+
+#ifdef _WIN32
+  //! Handle of the file.
+  void* fileHandle;
+  //! Handle of the file mapping.
+  void* mappingHandle;
+#endif
+};
+
+} // namespace util
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,185 @@
+/**
+ * @file memory_tracker.cpp
+ *
+ * Implementation of the tracking of the memory allocated by mlpack.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "memory_tracker.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+
+#if defined(__GLIBC__)
+  #include <malloc.h>
+  #define MLPACK_ALLOCATED_SIZE(memory) malloc_usable_size(memory)
+#elif defined(__APPLE__)
+  #include <malloc/malloc.h>
+  #define MLPACK_ALLOCATED_SIZE(memory) malloc_size(memory)
+#elif defined(_WIN32)
+  #include <malloc.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+  #include <sys/resource.h>
+#endif
+
+using namespace mlpack;
+
+namespace {
+
+//! The number of bytes currently allocated.  It is signed because the memory
+//! of objects created before tracking started may be released.
+std::atomic<int64_t> current(0);
+
+//! The peak since the last start of a region.
+std::atomic<int64_t> peak(0);
+
+//! A mutex for starting and stopping regions.
+std::mutex regionsMutex;
+
+//! The peak of each running region, up to the last start of a region.
+std::map<size_t, int64_t> regionPeaks;
+
+//! The peak of the whole program, up to the last start of a region.
+int64_t totalPeak = 0;
+
+//! The id of the next region.
+size_t nextRegion = 0;
+
+//! Raise the peak to the given number of bytes, if it is larger.
+void RaisePeak(const int64_t bytes)
+{
+  int64_t previous = peak.load();
+  while (bytes > previous && !peak.compare_exchange_weak(previous, bytes)) { }
+}
+
+//! Add the peak since the last start of a region to the peaks of all the
+//! running regions, and restart it from the given number of bytes.  The
+//! regions mutex must be held.
+void FoldPeak(const int64_t bytes)
+{
+  const int64_t previous = peak.exchange(bytes);
+  totalPeak = std::max(totalPeak, previous);
+  for (std::map<size_t, int64_t>::iterator it = regionPeaks.begin();
+      it != regionPeaks.end(); ++it)
+    it->second = std::max(it->second, previous);
+}
+
+} // anonymous namespace
+
+bool MemoryTracker::Available()
+{
+  #ifdef MLPACK_MEMORY_TRACKING
+  return true;
+  #else
+  return false;
+  #endif
+}
+
+void* MemoryTracker::Allocate(const size_t bytes)
+{
+  #if defined(_WIN32)
+  // The size of aligned allocations can't be found on Windows, so they are not
+  // counted.
+  return _aligned_malloc(bytes, (bytes >= 1024) ? 32 : 16);
+  #else
+  // This is the alignment that Armadillo uses.
+  void* memory = NULL;
+  if (posix_memalign(&memory, (bytes >= 1024) ? 32 : 16, bytes) != 0)
+    return NULL;
+
+  #ifdef MLPACK_ALLOCATED_SIZE
+  Add(MLPACK_ALLOCATED_SIZE(memory));
+  #endif
+  return memory;
+  #endif
+}
+
+void MemoryTracker::Free(void* memory)
+{
+  #if defined(_WIN32)
+  _aligned_free(memory);
+  #else
+  if (memory == NULL)
+    return;
+
+  // The same size is counted as in Allocate(), so that the counts match.
+  #ifdef MLPACK_ALLOCATED_SIZE
+  Remove(MLPACK_ALLOCATED_SIZE(memory));
+  #endif
+  free(memory);
+  #endif
+}
+
+void MemoryTracker::Add(const size_t bytes)
+{
+  RaisePeak(current.fetch_add((int64_t) bytes) + (int64_t) bytes);
+}
+
+void MemoryTracker::Remove(const size_t bytes)
+{
+  current.fetch_sub((int64_t) bytes);
+}
+
+size_t MemoryTracker::Current()
+{
+  return (size_t) std::max(current.load(), (int64_t) 0);
+}
+
+size_t MemoryTracker::Peak()
+{
+  std::lock_guard<std::mutex> lock(regionsMutex);
+  return (size_t) std::max(totalPeak, peak.load());
+}
+
+size_t MemoryTracker::PeakResident()
+{
+  #if defined(__unix__) || defined(__APPLE__)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+
+  #if defined(__APPLE__)
+  // macOS reports bytes.
+  return (size_t) usage.ru_maxrss;
+  #else
+  // Linux reports kilobytes.
+  return (size_t) usage.ru_maxrss * 1024;
+  #endif
+  #else
+  return 0;
+  #endif
+}
+
+size_t MemoryTracker::StartRegion()
+{
+  std::lock_guard<std::mutex> lock(regionsMutex);
+
+  // The peak of the new region starts from the memory allocated now, so the
+  // peak of the other regions has to be recorded first.
+  const int64_t bytes = current.load();
+  FoldPeak(bytes);
+  regionPeaks[nextRegion] = bytes;
+  return nextRegion++;
+}
+
+size_t MemoryTracker::StopRegion(const size_t region)
+{
+  std::lock_guard<std::mutex> lock(regionsMutex);
+
+  std::map<size_t, int64_t>::iterator it = regionPeaks.find(region);
+  if (it == regionPeaks.end())
+    return 0;
+
+  const int64_t regionPeak = std::max(it->second, peak.load());
+  regionPeaks.erase(it);
+  return (size_t) std::max(regionPeak, (int64_t) 0);
+}
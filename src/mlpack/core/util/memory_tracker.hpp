@@ -0,0 +1,104 @@
+/**
+ * @file memory_tracker.hpp
+ *
+ * Tracking of the memory allocated by mlpack (Armadillo objects and tree
+ * nodes), which Timer can record for each timer.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_UTILITIES_MEMORY_TRACKER_HPP
+#define MLPACK_CORE_UTILITIES_MEMORY_TRACKER_HPP
+
+#include <cstddef>
+
+namespace mlpack {
+
+/**
+ * Counters of the memory allocated by mlpack.  When mlpack is configured with
+ * -DMEMORY_TRACKING=ON (which defines MLPACK_MEMORY_TRACKING), the memory of
+ * Armadillo matrices is allocated through Allocate() and Free() (with
+ * ARMA_ALIEN_MEM_ALLOC_FUNCTION; versions of Armadillo without that hook
+ * ignore it), and the trees count their nodes with TrackedObject.  Otherwise,
+ * nothing is counted, and only the peak resident memory of the process is
+ * available.
+ *
+ * The peak of a region of the program (for instance, of a timer) is found by
+ * starting the region with StartRegion(), and getting its peak with
+ * StopRegion(); regions may overlap, and may be started by any thread.
+ */
+class MemoryTracker
+{
+ public:
+  //! Return whether mlpack was compiled with memory tracking.
+  static bool Available();
+
+  /**
+   * Allocate memory for Armadillo, aligned like Armadillo aligns it, and count
+   * it.
+   *
+   * @param bytes Number of bytes to allocate.
+   */
+  static void* Allocate(const size_t bytes);
+
+  /**
+   * Free memory allocated with Allocate().
+   *
+   * @param memory Memory to free.
+   */
+  static void Free(void* memory);
+
+  //! Count the allocation of the given number of bytes.
+  static void Add(const size_t bytes);
+
+  //! Count the release of the given number of bytes.
+  static void Remove(const size_t bytes);
+
+  //! Get the number of bytes that are currently allocated.
+  static size_t Current();
+
+  //! Get the largest number of bytes allocated at once since the start of the
+  //! program.
+  static size_t Peak();
+
+  //! Get the peak resident memory of the process, in bytes (or 0 if the
+  //! platform does not report it).
+  static size_t PeakResident();
+
+  //! Start a region, and return its id.
+  static size_t StartRegion();
+
+  /**
+   * Stop the given region, and return the largest number of bytes allocated at
+   * once while it was running.
+   *
+   * @param region Id returned by StartRegion().
+   */
+  static size_t StopRegion(const size_t region);
+};
+
+/**
+ * Count the objects of type T in the MemoryTracker: a TrackedObject member of
+ * an object of type T adds sizeof(T) bytes when the object is constructed, and
+ * removes them when it is destroyed.
+ */
+template<typename T>
+class TrackedObject
+{
+ public:
+  TrackedObject() { MemoryTracker::Add(sizeof(T)); }
+  TrackedObject(const TrackedObject& /* other */)
+  {
+    MemoryTracker::Add(sizeof(T));
+  }
+  ~TrackedObject() { MemoryTracker::Remove(sizeof(T)); }
+
+  //! The object was counted when it was constructed.
+  TrackedObject& operator=(const TrackedObject& /* other */) { return *this; }
+};
+
+} // namespace mlpack
+
+#endif
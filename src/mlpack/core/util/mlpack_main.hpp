@@ -56,6 +56,7 @@ static const std::string testName = "";
 #include <mlpack/core/util/param.hpp>
 #include <mlpack/bindings/cli/parse_command_line.hpp>
 #include <mlpack/bindings/cli/end_program.hpp>
+#include <mlpack/bindings/cli/serve.hpp>
 
 static void mlpackMain(); // This is typically defined after this include.
 
@@ -63,8 +64,17 @@ int main(int argc, char** argv)
 {
   // Parse the command-line options; put them into CLI.
   mlpack::bindings::cli::ParseCommandLine(argc, argv);
+
+  // With --serve, the program runs on each request instead of once.
+  if (mlpack::CLI::HasParam("serve") || mlpack::CLI::HasParam("server_socket"))
+    return mlpack::bindings::cli::Serve(mlpackMain);
+
   // Enable timing.
   mlpack::Timer::EnableTiming();
+  if (mlpack::CLI::HasParam("perf_counters"))
+    mlpack::Timer::EnablePerfCounters();
+  if (mlpack::CLI::HasParam("memory_report"))
+    mlpack::Timer::EnableMemoryTracking();
 
   // A "total_time" timer is run by default for each mlpack program.
   mlpack::Timer::Start("total_time");
@@ -153,6 +163,8 @@ static const std::string testName = "";
 
 PARAM_FLAG("verbose", "Display informational messages and the full list of "
     "parameters and timers at the end of execution.", "v");
+PARAM_INT_IN("threads", "Maximum number of threads to use (0 means all the "
+    "threads that OpenMP would use).", "", 0);
 PARAM_FLAG("copy_all_inputs", "If specified, all input parameters will be deep"
     " copied before the method is run.  This is useful for debugging problems "
     "where the input parameters are being modified by the algorithm, but can "
@@ -201,11 +213,36 @@ using Option = mlpack::bindings::markdown::MDOption<T>;
 
 PARAM_FLAG("verbose", "Display informational messages and the full list of "
     "parameters and timers at the end of execution.", "v");
+PARAM_INT_IN("threads", "Maximum number of threads to use (0 means all the "
+    "threads that OpenMP would use).", "", 0);
 
 // CLI-specific parameters.
 PARAM_FLAG("help", "Default help info.", "h");
 PARAM_STRING_IN("info", "Print help on a specific option.", "", "");
 PARAM_FLAG("version", "Display the version of mlpack.", "V");
+PARAM_STRING_IN("timing_output", "If specified, write the results of the "
+    "scoped timers of the program (call counts, total times and percentiles "
+    "of each timed section) to this file as JSON.", "", "");
+PARAM_FLAG("perf_counters", "Count hardware performance events (cycles, "
+    "instructions, cache misses and branch misses) for each timer, and print "
+    "them at the end of execution (Linux only).", "");
+PARAM_FLAG("memory_report", "Print the peak memory allocated by matrices and "
+    "trees during each timer, and the peak resident memory of the program, at "
+    "the end of execution (the allocations are only counted if mlpack was "
+    "configured with -DMEMORY_TRACKING=ON).", "");
+PARAM_FLAG("serve", "Keep running as a server: after loading the inputs "
+    "given on the command line, read requests (each a line of further options, "
+    "such as '--query_file q.csv --output_file o.csv') from standard input, run "
+    "the program on each, and answer each with a line '<request number> OK' or "
+    "'<request number> ERROR <message>' on standard output.  Everything else "
+    "the program prints goes to standard error while serving.", "");
+PARAM_STRING_IN("server_socket", "If specified, serve requests from "
+    "connections to a Unix domain socket created at this path, instead of from "
+    "standard input (implies --serve).", "", "");
+PARAM_INT_IN("server_workers", "Number of requests that a server answers at "
+    "once; each worker holds its own copy of the inputs.  Programs with a "
+    "--seed option share the random number generator, so they run one request "
+    "at a time.", "", 1);
 
 // Python-specific parameters.
 PARAM_FLAG("copy_all_inputs", "If specified, all input parameters will be deep"
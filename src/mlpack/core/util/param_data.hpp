@@ -15,6 +15,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <boost/any.hpp>
+#include <mlpack/core/util/mapped_file.hpp>
 
 /**
  * The TYPENAME macro is used internally to convert a type into a string.
@@ -80,6 +81,9 @@ struct ParamData
   //! The actual value that is held.  If the user has passed a different type,
   //! this may be a tuple containing multiple values.
   boost::any value;
+  //! If this is an input matrix that was loaded as an alias of a mapped file,
+  //! this holds the mapping (which must outlive the matrix).
+  std::shared_ptr<MappedFile> mappedFile;
   //! The true name of the type, as it would be written in C++.
   std::string cppType;
 };
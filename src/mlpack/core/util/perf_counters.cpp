@@ -0,0 +1,138 @@
+/**
+ * @file perf_counters.cpp
+ *
+ * Implementation of the hardware performance counters.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "perf_counters.hpp"
+
+#ifdef __linux__
+  #include <linux/perf_event.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+  #include <cstring>
+#endif
+
+using namespace mlpack;
+
+#ifdef __linux__
+
+namespace {
+
+//! The events that are counted, in the order of PerfCounterValues.
+const uint64_t events[4] = {
+  PERF_COUNT_HW_CPU_CYCLES,
+  PERF_COUNT_HW_INSTRUCTIONS,
+  PERF_COUNT_HW_CACHE_MISSES,
+  PERF_COUNT_HW_BRANCH_MISSES
+};
+
+/**
+ * The counters of one thread, as one perf_event group (so that they are all
+ * read at once, with one system call).
+ */
+class ThreadCounters
+{
+ public:
+  ThreadCounters() : available(false)
+  {
+    for (size_t i = 0; i < 4; ++i)
+      fds[i] = -1;
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = events[i];
+      attr.read_format = PERF_FORMAT_GROUP;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      // Only the leader starts disabled; the group is enabled at once.
+      attr.disabled = (i == 0) ? 1 : 0;
+
+      // Count the calling thread, on any CPU.
+      fds[i] = (int) syscall(__NR_perf_event_open, &attr, 0, -1,
+          (i == 0) ? -1 : fds[0], 0);
+      if (fds[i] == -1)
+        return;
+    }
+
+    ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    available = (ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) ==
+        0);
+  }
+
+  ~ThreadCounters()
+  {
+    for (size_t i = 0; i < 4; ++i)
+      if (fds[i] != -1)
+        close(fds[i]);
+  }
+
+  bool Read(PerfCounterValues& values) const
+  {
+    values = PerfCounterValues();
+    if (!available)
+      return false;
+
+    // The group is read as the number of counters, then their values.
+    uint64_t buffer[5];
+    if (read(fds[0], buffer, sizeof(buffer)) != (ssize_t) sizeof(buffer) ||
+        buffer[0] != 4)
+      return false;
+
+    values.cycles = buffer[1];
+    values.instructions = buffer[2];
+    values.cacheMisses = buffer[3];
+    values.branchMisses = buffer[4];
+    return true;
+  }
+
+  bool Available() const { return available; }
+
+ private:
+  //! The file descriptors of the counters; the first is the group leader.
+  int fds[4];
+  //! Whether all the counters could be opened.
+  bool available;
+};
+
+ThreadCounters& GetThreadCounters()
+{
+  static thread_local ThreadCounters counters;
+  return counters;
+}
+
+} // anonymous namespace
+
+bool PerfCounters::Read(PerfCounterValues& values)
+{
+  return GetThreadCounters().Read(values);
+}
+
+bool PerfCounters::Available()
+{
+  return GetThreadCounters().Available();
+}
+
+#else
+
+bool PerfCounters::Read(PerfCounterValues& values)
+{
+  values = PerfCounterValues();
+  return false;
+}
+
+bool PerfCounters::Available()
+{
+  return false;
+}
+
+#endif
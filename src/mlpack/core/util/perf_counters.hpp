@@ -0,0 +1,80 @@
+/**
+ * @file perf_counters.hpp
+ *
+ * Hardware performance counters (on Linux, through perf_event), which Timer
+ * can record for each timer.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_UTILITIES_PERF_COUNTERS_HPP
+#define MLPACK_CORE_UTILITIES_PERF_COUNTERS_HPP
+
+#include <cstdint>
+
+namespace mlpack {
+
+/**
+ * The values of the hardware performance counters: the numbers of CPU cycles,
+ * instructions, cache misses (last-level cache) and branch misses.
+ */
+struct PerfCounterValues
+{
+  PerfCounterValues() :
+      cycles(0), instructions(0), cacheMisses(0), branchMisses(0) { }
+
+  uint64_t cycles;
+  uint64_t instructions;
+  uint64_t cacheMisses;
+  uint64_t branchMisses;
+
+  PerfCounterValues& operator+=(const PerfCounterValues& other)
+  {
+    cycles += other.cycles;
+    instructions += other.instructions;
+    cacheMisses += other.cacheMisses;
+    branchMisses += other.branchMisses;
+    return *this;
+  }
+
+  PerfCounterValues operator-(const PerfCounterValues& other) const
+  {
+    PerfCounterValues result;
+    result.cycles = cycles - other.cycles;
+    result.instructions = instructions - other.instructions;
+    result.cacheMisses = cacheMisses - other.cacheMisses;
+    result.branchMisses = branchMisses - other.branchMisses;
+    return result;
+  }
+};
+
+/**
+ * Hardware performance counters of the calling thread.  On Linux, they are
+ * opened with perf_event_open() the first time a thread reads them, and count
+ * events in user space only.  They are not available on other platforms, or
+ * if the kernel does not allow them (see /proc/sys/kernel/perf_event_paranoid);
+ * then Read() returns zeros.
+ *
+ * Only the events of the calling thread are counted, so the events of other
+ * threads (for instance, of OpenMP loops) are not included.
+ */
+class PerfCounters
+{
+ public:
+  /**
+   * Read the counters of the calling thread.  Returns false (and zeros) if
+   * they are not available.
+   *
+   * @param values Values of the counters.
+   */
+  static bool Read(PerfCounterValues& values);
+
+  //! Return whether the counters are available (for the calling thread).
+  static bool Available();
+};
+
+} // namespace mlpack
+
+#endif
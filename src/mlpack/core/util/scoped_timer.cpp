@@ -0,0 +1,445 @@
+/**
+ * @file scoped_timer.cpp
+ *
+ * Implementation of the hierarchical scoped timers.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "scoped_timer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+using namespace mlpack;
+using namespace std;
+using namespace chrono;
+
+namespace {
+
+//! The section of the root of call trees.
+const size_t rootSection = size_t(-1);
+//! Each power of two of nanoseconds is split into four histogram buckets.
+const size_t numBuckets = 4 * 64;
+
+//! Get the histogram bucket of the given number of nanoseconds.
+inline size_t Bucket(const uint64_t ns)
+{
+  if (ns < 4)
+    return (size_t) ns;
+
+  #ifdef __GNUC__
+  const size_t e = 63 - __builtin_clzll(ns);
+  #else
+  size_t e = 2;
+  while ((ns >> (e + 1)) != 0)
+    ++e;
+  #endif
+  return 4 * e + ((ns >> (e - 2)) & 3);
+}
+
+//! Get the middle of the given histogram bucket, in nanoseconds.
+inline double BucketMiddle(const size_t bucket)
+{
+  if (bucket < 4)
+    return bucket + 0.5;
+
+  const size_t e = bucket / 4;
+  return (4 + (bucket % 4) + 0.5) * std::ldexp(1.0, (int) e - 2);
+}
+
+//! A node of a call tree: a section timed inside of the section of its
+//! parent.
+struct Node
+{
+  Node(const size_t section, const size_t parent) :
+      section(section),
+      parent(parent),
+      count(0),
+      totalNs(0),
+      minNs(uint64_t(-1)),
+      maxNs(0),
+      histogram(numBuckets, 0)
+  { }
+
+  //! Record one call of the given duration.
+  void Add(const uint64_t ns)
+  {
+    ++count;
+    totalNs += ns;
+    minNs = std::min(minNs, ns);
+    maxNs = std::max(maxNs, ns);
+    ++histogram[Bucket(ns)];
+  }
+
+  //! Estimate the given quantile of the times, in nanoseconds.
+  double Quantile(const double q) const
+  {
+    const uint64_t target = std::max(uint64_t(1),
+        (uint64_t) std::ceil(q * count));
+    uint64_t seen = 0;
+    for (size_t b = 0; b < numBuckets; ++b)
+    {
+      seen += histogram[b];
+      if (seen >= target)
+        return std::min(std::max(BucketMiddle(b), (double) minNs),
+            (double) maxNs);
+    }
+
+    return (double) maxNs;
+  }
+
+  size_t section;
+  size_t parent;
+  //! The children of the node: (section, node).
+  std::vector<std::pair<size_t, size_t>> children;
+  uint64_t count;
+  uint64_t totalNs;
+  uint64_t minNs;
+  uint64_t maxNs;
+  std::vector<uint64_t> histogram;
+};
+
+//! A call tree: node 0 is the root, which isn't a section.
+struct CallTree
+{
+  CallTree() : current(0) { nodes.push_back(Node(rootSection, 0)); }
+
+  //! Get the child of the given node for the given section, creating it if
+  //! needed.
+  size_t Child(const size_t node, const size_t section)
+  {
+    const std::vector<std::pair<size_t, size_t>>& children =
+        nodes[node].children;
+    for (size_t i = 0; i < children.size(); ++i)
+      if (children[i].first == section)
+        return children[i].second;
+
+    const size_t child = nodes.size();
+    nodes[node].children.push_back(std::make_pair(section, child));
+    nodes.push_back(Node(section, node));
+    return child;
+  }
+
+  //! Add the given node of the given tree (and its children) to the given
+  //! node of this tree.
+  void Merge(const CallTree& other, const size_t otherNode, const size_t node)
+  {
+    const Node& o = other.nodes[otherNode];
+    if (o.section != rootSection)
+    {
+      Node& n = nodes[node];
+      n.count += o.count;
+      n.totalNs += o.totalNs;
+      n.minNs = std::min(n.minNs, o.minNs);
+      n.maxNs = std::max(n.maxNs, o.maxNs);
+      for (size_t b = 0; b < numBuckets; ++b)
+        n.histogram[b] += o.histogram[b];
+    }
+
+    for (size_t i = 0; i < o.children.size(); ++i)
+    {
+      const size_t child = Child(node, o.children[i].first);
+      Merge(other, o.children[i].second, child);
+    }
+  }
+
+  void Clear()
+  {
+    nodes.clear();
+    nodes.push_back(Node(rootSection, 0));
+    current = 0;
+  }
+
+  std::vector<Node> nodes;
+  //! The node being timed.
+  size_t current;
+};
+
+//! Everything that is shared between threads.
+struct Registry
+{
+  Registry() : enabled(false) { }
+
+  std::mutex mutex;
+  //! The names of the sections, by id.
+  std::vector<std::string> names;
+  //! The ids of the sections, by name.
+  std::unordered_map<std::string, size_t> ids;
+  //! The call trees of the running threads.
+  std::vector<CallTree*> trees;
+  //! The merged call trees of the threads that have exited.
+  CallTree retired;
+  std::atomic<bool> enabled;
+};
+
+//! Get the registry.  It is never destroyed, so that threads can still exit
+//! during static destruction.
+Registry& GetRegistry()
+{
+  static Registry* registry = new Registry();
+  return *registry;
+}
+
+//! The call tree of a thread, which is registered while the thread runs.
+struct ThreadCallTree : public CallTree
+{
+  ThreadCallTree()
+  {
+    Registry& registry = GetRegistry();
+    lock_guard<mutex> lock(registry.mutex);
+    registry.trees.push_back(this);
+  }
+
+  ~ThreadCallTree()
+  {
+    Registry& registry = GetRegistry();
+    lock_guard<mutex> lock(registry.mutex);
+    registry.retired.Merge(*this, 0, 0);
+    registry.trees.erase(std::find(registry.trees.begin(),
+        registry.trees.end(), this));
+  }
+};
+
+thread_local ThreadCallTree threadTree;
+
+//! Merge the call trees of all threads.  The registry must be locked.
+CallTree MergeAll(const Registry& registry)
+{
+  CallTree merged;
+  merged.Merge(registry.retired, 0, 0);
+  for (size_t i = 0; i < registry.trees.size(); ++i)
+    merged.Merge(*registry.trees[i], 0, 0);
+
+  return merged;
+}
+
+//! Write a string as JSON.
+void WriteString(std::ostream& stream, const std::string& s)
+{
+  stream << '"';
+  for (size_t i = 0; i < s.size(); ++i)
+  {
+    const unsigned char c = s[i];
+    if (c == '"' || c == '\\')
+      stream << '\\' << c;
+    else if (c < 0x20)
+      stream << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+          << (unsigned int) c << std::dec << std::setfill(' ');
+    else
+      stream << c;
+  }
+  stream << '"';
+}
+
+//! Write the given node (and its children) as JSON.
+void WriteNode(std::ostream& stream,
+               const CallTree& tree,
+               const std::vector<std::string>& names,
+               const size_t node,
+               const std::string& indent)
+{
+  const Node& n = tree.nodes[node];
+  stream << indent << "{ \"name\": ";
+  WriteString(stream, names[n.section]);
+  // A section that is still running may not have been recorded yet.
+  const bool empty = (n.count == 0);
+  stream << ", \"count\": " << n.count
+      << ", \"total_us\": " << n.totalNs / 1e3
+      << ", \"min_us\": " << (empty ? 0.0 : n.minNs / 1e3)
+      << ", \"max_us\": " << n.maxNs / 1e3
+      << ", \"mean_us\": " << (empty ? 0.0 : (n.totalNs / 1e3) / n.count)
+      << ", \"p50_us\": " << (empty ? 0.0 : n.Quantile(0.5) / 1e3)
+      << ", \"p90_us\": " << (empty ? 0.0 : n.Quantile(0.9) / 1e3)
+      << ", \"p99_us\": " << (empty ? 0.0 : n.Quantile(0.99) / 1e3)
+      << ", \"children\": [";
+
+  if (!n.children.empty())
+  {
+    stream << std::endl;
+    for (size_t i = 0; i < n.children.size(); ++i)
+    {
+      WriteNode(stream, tree, names, n.children[i].second, indent + "    ");
+      stream << ((i + 1 < n.children.size()) ? "," : "") << std::endl;
+    }
+    stream << indent;
+  }
+  stream << "] }";
+}
+
+//! Sum the total times and counts of the given section in the subtree of the
+//! given node, skipping the section inside of itself for the total time.
+void Sum(const CallTree& tree,
+         const size_t node,
+         const size_t section,
+         const bool inside,
+         uint64_t& totalNs,
+         uint64_t& count)
+{
+  const Node& n = tree.nodes[node];
+  const bool match = (n.section == section);
+  if (match)
+  {
+    count += n.count;
+    if (!inside)
+      totalNs += n.totalNs;
+  }
+
+  for (size_t i = 0; i < n.children.size(); ++i)
+    Sum(tree, n.children[i].second, section, inside || match, totalNs, count);
+}
+
+//! Sum the total time and count of the section with the given name.
+void SumSection(const std::string& name, uint64_t& totalNs, uint64_t& count)
+{
+  totalNs = 0;
+  count = 0;
+
+  Registry& registry = GetRegistry();
+  lock_guard<mutex> lock(registry.mutex);
+  std::unordered_map<std::string, size_t>::const_iterator it =
+      registry.ids.find(name);
+  if (it == registry.ids.end())
+    return;
+
+  const CallTree merged = MergeAll(registry);
+  Sum(merged, 0, it->second, false, totalNs, count);
+}
+
+} // anonymous namespace
+
+TimerSection::TimerSection(const std::string& name)
+{
+  Registry& registry = GetRegistry();
+  lock_guard<mutex> lock(registry.mutex);
+  std::unordered_map<std::string, size_t>::const_iterator it =
+      registry.ids.find(name);
+  if (it != registry.ids.end())
+  {
+    id = it->second;
+  }
+  else
+  {
+    id = registry.names.size();
+    registry.names.push_back(name);
+    registry.ids[name] = id;
+  }
+}
+
+std::string TimerSection::Name() const
+{
+  Registry& registry = GetRegistry();
+  lock_guard<mutex> lock(registry.mutex);
+  return registry.names[id];
+}
+
+ScopedTimer::ScopedTimer(const TimerSection& section) : node(0)
+{
+  if (!GetRegistry().enabled.load(std::memory_order_relaxed))
+    return;
+
+  CallTree& tree = threadTree;
+  node = tree.Child(tree.current, section.ID());
+  tree.current = node;
+  start = steady_clock::now();
+}
+
+void ScopedTimer::Stop()
+{
+  const size_t stopped = node;
+  if (!Record())
+  {
+    CallTree& tree = threadTree;
+    Registry& registry = GetRegistry();
+    lock_guard<mutex> lock(registry.mutex);
+    std::ostringstream error;
+    error << "ScopedTimer::Stop(): section '"
+        << registry.names[tree.nodes[stopped].section] << "' can't be stopped "
+        << "while section '" << registry.names[tree.nodes[tree.current].section]
+        << "' is running";
+    throw std::runtime_error(error.str());
+  }
+}
+
+bool ScopedTimer::Record()
+{
+  if (node == 0)
+    return true;
+
+  const steady_clock::time_point end = steady_clock::now();
+  CallTree& tree = threadTree;
+  if (node >= tree.nodes.size())
+  {
+    // The timers were reset while the section was being timed.
+    node = 0;
+    return true;
+  }
+  else if (tree.current != node)
+  {
+    return false;
+  }
+
+  tree.nodes[node].Add((uint64_t) duration_cast<nanoseconds>(end -
+      start).count());
+  tree.current = tree.nodes[node].parent;
+  node = 0;
+  return true;
+}
+
+void ScopedTimers::WriteJSON(std::ostream& stream)
+{
+  Registry& registry = GetRegistry();
+  lock_guard<mutex> lock(registry.mutex);
+  const CallTree merged = MergeAll(registry);
+
+  stream << "{" << std::endl << "  \"sections\": [";
+  const Node& root = merged.nodes[0];
+  if (!root.children.empty())
+  {
+    stream << std::endl;
+    for (size_t i = 0; i < root.children.size(); ++i)
+    {
+      WriteNode(stream, merged, registry.names, root.children[i].second,
+          "    ");
+      stream << ((i + 1 < root.children.size()) ? "," : "") << std::endl;
+    }
+    stream << "  ";
+  }
+  stream << "]" << std::endl << "}" << std::endl;
+}
+
+microseconds ScopedTimers::Get(const std::string& name)
+{
+  uint64_t totalNs, count;
+  SumSection(name, totalNs, count);
+  return duration_cast<microseconds>(nanoseconds(totalNs));
+}
+
+size_t ScopedTimers::Count(const std::string& name)
+{
+  uint64_t totalNs, count;
+  SumSection(name, totalNs, count);
+  return (size_t) count;
+}
+
+void ScopedTimers::Reset()
+{
+  Registry& registry = GetRegistry();
+  lock_guard<mutex> lock(registry.mutex);
+  registry.retired.Clear();
+  for (size_t i = 0; i < registry.trees.size(); ++i)
+    registry.trees[i]->Clear();
+}
+
+std::atomic<bool>& ScopedTimers::Enabled()
+{
+  return GetRegistry().enabled;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file scoped_timer.hpp
+ *
+ * Hierarchical scoped timers, cheap enough to be used inside of hot loops.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_UTILITIES_SCOPED_TIMER_HPP
+#define MLPACK_CORE_UTILITIES_SCOPED_TIMER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <string>
+
+namespace mlpack {
+
+/**
+ * A named section of code that can be timed with ScopedTimer.  Each section
+ * gets an id when it is created, so that timing it later does not involve any
+ * string lookups; sections are meant to be created once, as function-local
+ * statics:
+ *
+ * @code
+ * void KMeans<...>::Cluster(...)
+ * {
+ *   static const TimerSection iterationSection("kmeans_iteration");
+ *   do
+ *   {
+ *     ScopedTimer t(iterationSection);
+ *     ...
+ *   } while (...);
+ * }
+ * @endcode
+ *
+ * Several sections may have the same name; they are then the same section.
+ */
+class TimerSection
+{
+ public:
+  /**
+   * Create (or find) the section with the given name.
+   *
+   * @param name Name of the section.
+   */
+  explicit TimerSection(const std::string& name);
+
+  //! Get the id of the section.
+  size_t ID() const { return id; }
+  //! Get the name of the section.
+  std::string Name() const;
+
+ private:
+  //! The id of the section.
+  size_t id;
+};
+
+/**
+ * Time the given TimerSection from construction until destruction (or until
+ * Stop() is called).  Scoped timers nest: a section timed while another
+ * section is being timed on the same thread is recorded as a child of that
+ * section, so the same section may show up in several places of the call tree.
+ *
+ * Unlike Timer, scoped timers don't take any lock: each thread records the
+ * number of calls, the total time and a histogram of the times of every node
+ * of its own call tree, and the trees of all threads are only merged when they
+ * are exported with ScopedTimers::WriteJSON().  If timing is disabled (see
+ * Timer::EnableTiming()), a scoped timer does nothing but check a flag.
+ */
+class ScopedTimer
+{
+ public:
+  /**
+   * Start timing the given section.
+   *
+   * @param section Section to time.
+   */
+  explicit ScopedTimer(const TimerSection& section);
+
+  //! Stop timing the section, if Stop() has not been called.
+  ~ScopedTimer() { Record(); }
+
+  // Scoped timers can't be copied.
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+  /**
+   * Stop timing the section before the end of the scope.  A
+   * std::runtime_error exception is thrown if a section started after this
+   * one (on the same thread) is still being timed.
+   */
+  void Stop();
+
+ private:
+  //! Record the time of the section, if it is still being timed; returns
+  //! false if another section started after it is still being timed.
+  bool Record();
+
+  //! The node of the call tree of this thread being timed (0 if nothing is
+  //! being timed).
+  size_t node;
+  //! The time at which the section was started.
+  std::chrono::steady_clock::time_point start;
+};
+
+/**
+ * Access to the results of all scoped timers.  None of these functions should
+ * be called while scoped timers are running on other threads.
+ */
+class ScopedTimers
+{
+ public:
+  /**
+   * Write the merged call tree of all threads to the given stream as JSON.
+   * For each node of the tree, the name of its section, the number of calls,
+   * and the total, minimum, maximum, mean and median times and the 90th and
+   * 99th percentiles of the times of the calls (in microseconds) are given,
+   * followed by its children.  Percentiles are estimated from histograms
+   * whose buckets are at most 25% wide.
+   *
+   * @param stream Stream to write the results to.
+   */
+  static void WriteJSON(std::ostream& stream);
+
+  /**
+   * Get the total time spent in the given section, over all threads and
+   * everywhere in the call tree (time spent in the section inside of itself
+   * is counted once).
+   *
+   * @param name Name of the section.
+   */
+  static std::chrono::microseconds Get(const std::string& name);
+
+  /**
+   * Get the number of times the given section was timed, over all threads
+   * and everywhere in the call tree.
+   *
+   * @param name Name of the section.
+   */
+  static size_t Count(const std::string& name);
+
+  //! Forget the results of all scoped timers.  Sections are kept.
+  static void Reset();
+
+  //! Whether or not scoped timers are enabled; this is controlled by
+  //! Timer::EnableTiming() and Timer::DisableTiming().
+  static std::atomic<bool>& Enabled();
+};
+
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,102 @@
+/**
+ * @file threads.cpp
+ *
+ * Implementation of the control of the number of threads.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "threads.hpp"
+
+#include <atomic>
+#include <climits>
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
+using namespace mlpack;
+
+namespace {
+
+//! Get the number of threads that OpenMP uses by default.
+size_t DefaultThreads()
+{
+  #ifdef HAS_OPENMP
+  return (size_t) omp_get_max_threads();
+  #else
+  return 1;
+  #endif
+}
+
+//! The default number of threads, taken when mlpack is loaded (before any
+//! setting is applied).
+const size_t availableThreads = DefaultThreads();
+
+//! The process-wide setting (0 for the default).
+std::atomic<size_t> globalThreads(0);
+
+//! The setting of each thread (0 for the process-wide setting).
+thread_local size_t localThreads = 0;
+
+} // anonymous namespace
+
+void Threads::Set(const size_t threads)
+{
+  globalThreads = threads;
+  Apply();
+}
+
+size_t Threads::Get()
+{
+  const size_t threads = (localThreads != 0) ? localThreads :
+      globalThreads.load();
+  return (threads == 0) ? Available() : threads;
+}
+
+size_t Threads::Available()
+{
+  return availableThreads;
+}
+
+void Threads::SetNested(const bool nested)
+{
+  #ifdef HAS_OPENMP
+  // The number of active levels is a setting of the whole process.
+  omp_set_max_active_levels(nested ? INT_MAX : 1);
+  #else
+  (void) nested;
+  #endif
+}
+
+bool Threads::Nested()
+{
+  #ifdef HAS_OPENMP
+  return (omp_get_max_active_levels() > 1);
+  #else
+  return false;
+  #endif
+}
+
+void Threads::Apply()
+{
+  #ifdef HAS_OPENMP
+  // Parallel regions started by this thread (and the regions nested in them)
+  // get this many threads.
+  omp_set_num_threads((int) Get());
+  #endif
+}
+
+Threads::Scope::Scope(const size_t threads) : previous(localThreads)
+{
+  localThreads = threads;
+  Apply();
+}
+
+Threads::Scope::~Scope()
+{
+  localThreads = previous;
+  Apply();
+}
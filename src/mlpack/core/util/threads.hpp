@@ -0,0 +1,108 @@
+/**
+ * @file threads.hpp
+ *
+ * Control of the number of threads used by the parallel parts of mlpack.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_UTILITIES_THREADS_HPP
+#define MLPACK_CORE_UTILITIES_THREADS_HPP
+
+#include <cstddef>
+
+namespace mlpack {
+
+/**
+ * The number of threads that mlpack uses.  The parallel parts of mlpack are
+ * OpenMP parallel regions, so OpenMP is the thread pool; this class controls
+ * how many threads each parallel region gets, with one process-wide setting
+ * and, for each thread that calls mlpack, an optional setting of its own:
+ *
+ * @code
+ * // Use at most 4 threads, everywhere.
+ * Threads::Set(4);
+ *
+ * {
+ *   // This thread (for instance, one of several serving different models)
+ *   // uses 2 threads until the end of the scope.
+ *   Threads::Scope scope(2);
+ *   kmeans.Cluster(dataset, clusters, assignments);
+ * }
+ * @endcode
+ *
+ * Nested parallel regions (for instance, the parallel training of a model
+ * inside of parallel cross-validation folds) run on one thread unless nesting
+ * is enabled with SetNested(), so that the total number of threads stays
+ * bounded by the setting.
+ *
+ * If mlpack is compiled without OpenMP, everything runs on one thread.
+ */
+class Threads
+{
+ public:
+  /**
+   * Set the number of threads that all threads of the process use (unless
+   * they have a Scope of their own).  Threads that were already running apply
+   * the new setting the next time they call Apply() or create a Scope, which
+   * bindings do at the start of each call.
+   *
+   * @param threads Number of threads; 0 means all the threads that OpenMP
+   *     would use by default (see OMP_NUM_THREADS).
+   */
+  static void Set(const size_t threads);
+
+  //! Get the number of threads that parallel regions of the calling thread
+  //! use.
+  static size_t Get();
+
+  //! Get the number of threads that OpenMP uses by default.
+  static size_t Available();
+
+  /**
+   * Enable or disable nested parallel regions.  When nesting is disabled (the
+   * default), a parallel region inside of another one runs on one thread.
+   *
+   * @param nested Whether nested parallel regions get their own threads.
+   */
+  static void SetNested(const bool nested);
+
+  //! Get whether nested parallel regions get their own threads.
+  static bool Nested();
+
+  //! Make the parallel regions of the calling thread follow the current
+  //! settings.
+  static void Apply();
+
+  /**
+   * Use the given number of threads on the calling thread, until the Scope is
+   * destroyed; Scopes on the same thread nest.
+   */
+  class Scope
+  {
+   public:
+    /**
+     * Use the given number of threads on the calling thread.
+     *
+     * @param threads Number of threads; 0 means the process-wide setting.
+     */
+    explicit Scope(const size_t threads);
+
+    //! Restore the previous setting of the calling thread.
+    ~Scope();
+
+   private:
+    //! The previous setting of the thread.
+    size_t previous;
+
+    // Scopes can't be copied.
+    Scope(const Scope&);
+    Scope& operator=(const Scope&);
+  };
+};
+
+} // namespace mlpack
+
+#endif
@@ -12,6 +12,7 @@
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
 #include "timers.hpp"
+#include "scoped_timer.hpp"
 #include "cli.hpp"
 #include "log.hpp"
 
@@ -50,18 +51,61 @@ microseconds Timer::Get(const string& name)
 void Timer::EnableTiming()
 {
   CLI::GetSingleton().timer.Enabled() = true;
+  ScopedTimers::Enabled() = true;
 }
 
 // Disable timing.
 void Timer::DisableTiming()
 {
   CLI::GetSingleton().timer.Enabled() = false;
+  ScopedTimers::Enabled() = false;
+}
+
+// Enable counting hardware performance events.
+void Timer::EnablePerfCounters()
+{
+  CLI::GetSingleton().timer.PerfCountersEnabled() = true;
+}
+
+// Disable counting hardware performance events.
+void Timer::DisablePerfCounters()
+{
+  CLI::GetSingleton().timer.PerfCountersEnabled() = false;
+}
+
+/**
+ * Get the performance counters of the given timer, summing over all threads.
+ */
+PerfCounterValues Timer::GetPerfCounters(const string& name)
+{
+  return CLI::GetSingleton().timer.GetPerfCounters(name);
+}
+
+// Enable recording the peak memory of timers.
+void Timer::EnableMemoryTracking()
+{
+  CLI::GetSingleton().timer.MemoryTrackingEnabled() = true;
+}
+
+// Disable recording the peak memory of timers.
+void Timer::DisableMemoryTracking()
+{
+  CLI::GetSingleton().timer.MemoryTrackingEnabled() = false;
+}
+
+/**
+ * Get the peak memory of the given timer, over all threads.
+ */
+size_t Timer::GetPeakMemory(const string& name)
+{
+  return CLI::GetSingleton().timer.GetPeakMemory(name);
 }
 
 // Reset all timers.  Save state of enabled.
 void Timer::ResetAll()
 {
   CLI::GetSingleton().timer.Reset();
+  ScopedTimers::Reset();
 }
 
 // Reset a Timers object.
@@ -70,6 +114,10 @@ void Timers::Reset()
   lock_guard<mutex> lock(timersMutex);
   timers.clear();
   timerStartTime.clear();
+  timerCounters.clear();
+  timerStartCounters.clear();
+  StopRegions();
+  timerMemory.clear();
 }
 
 map<string, microseconds> Timers::GetAllTimers()
@@ -88,6 +136,61 @@ microseconds Timers::GetTimer(const string& timerName)
   return timers[timerName];
 }
 
+PerfCounterValues Timers::GetPerfCounters(const string& timerName)
+{
+  lock_guard<mutex> lock(timersMutex);
+  map<string, PerfCounterValues>::const_iterator it =
+      timerCounters.find(timerName);
+  return (it == timerCounters.end()) ? PerfCounterValues() : it->second;
+}
+
+void Timers::PrintPerfCounters(const string& timerName)
+{
+  const PerfCounterValues values = GetPerfCounters(timerName);
+  Log::Info << values.cycles << " cycles, " << values.instructions
+      << " instructions";
+  if (values.cycles > 0)
+  {
+    // Print the number of instructions per cycle with two decimals.
+    const uint64_t ipc = (100 * values.instructions + values.cycles / 2) /
+        values.cycles;
+    Log::Info << " (" << ipc / 100 << "." << setw(2) << setfill('0')
+        << ipc % 100 << " per cycle)";
+  }
+  Log::Info << ", " << values.cacheMisses << " cache misses, "
+      << values.branchMisses << " branch misses" << endl;
+}
+
+size_t Timers::GetPeakMemory(const string& timerName)
+{
+  lock_guard<mutex> lock(timersMutex);
+  map<string, size_t>::const_iterator it = timerMemory.find(timerName);
+  return (it == timerMemory.end()) ? 0 : it->second;
+}
+
+void Timers::PrintPeakMemory(const string& timerName)
+{
+  const size_t bytes = GetPeakMemory(timerName);
+  Log::Info << bytes << " bytes";
+  if (bytes >= 1024)
+  {
+    // Print the size in the largest unit with one decimal.
+    const char* units[] = { "KiB", "MiB", "GiB", "TiB" };
+    size_t unit = 0;
+    uint64_t unitBytes = 1024;
+    while (unit < 3 && bytes >= 1024 * unitBytes)
+    {
+      unitBytes *= 1024;
+      ++unit;
+    }
+    const uint64_t tenths = (10 * (uint64_t) bytes + unitBytes / 2) /
+        unitBytes;
+    Log::Info << " (" << tenths / 10 << "." << tenths % 10 << " "
+        << units[unit] << ")";
+  }
+  Log::Info << endl;
+}
+
 bool Timers::GetState(const string& timerName,
                       const thread::id& threadId)
 {
@@ -168,8 +271,33 @@ void Timers::StopAllTimers()
     for (auto it2 : it.second)
       timers[it2.first] += duration_cast<microseconds>(currTime - it2.second);
 
+  // Only the performance counters of this thread can be read.
+  if (timerStartCounters.count(this_thread::get_id()) > 0)
+  {
+    PerfCounterValues currCounters;
+    PerfCounters::Read(currCounters);
+    for (auto it : timerStartCounters[this_thread::get_id()])
+      timerCounters[it.first] += currCounters - it.second;
+  }
+
   // If all timers are stopped, we can clear the maps.
   timerStartTime.clear();
+  timerStartCounters.clear();
+  StopRegions();
+}
+
+void Timers::StopRegions()
+{
+  for (auto it : timerStartRegions)
+  {
+    for (auto it2 : it.second)
+    {
+      timerMemory[it2.first] = max(timerMemory[it2.first],
+          MemoryTracker::StopRegion(it2.second));
+    }
+  }
+
+  timerStartRegions.clear();
 }
 
 void Timers::StartTimer(const string& timerName,
@@ -199,6 +327,14 @@ void Timers::StartTimer(const string& timerName,
   }
 
   timerStartTime[threadId][timerName] = currTime;
+
+  if (memoryTracking)
+    timerStartRegions[threadId][timerName] = MemoryTracker::StartRegion();
+
+  // The counters are read last, so that the rest of this function isn't
+  // counted.
+  if (perfCounters)
+    PerfCounters::Read(timerStartCounters[threadId][timerName]);
 }
 
 void Timers::StopTimer(const string& timerName,
@@ -208,6 +344,12 @@ void Timers::StopTimer(const string& timerName,
   if (!enabled)
     return;
 
+  // The counters are read first, so that the rest of this function isn't
+  // counted.
+  PerfCounterValues currCounters;
+  if (perfCounters)
+    PerfCounters::Read(currCounters);
+
   lock_guard<mutex> lock(timersMutex);
 
   if ((timerStartTime.count(threadId) == 0) ||
@@ -229,4 +371,27 @@ void Timers::StopTimer(const string& timerName,
   timerStartTime[threadId].erase(timerName);
   if (timerStartTime[threadId].empty())
     timerStartTime.erase(threadId);
+
+  // Add the events counted while the timer was running, if the counters were
+  // read when it was started.
+  if ((timerStartCounters.count(threadId) > 0) &&
+      (timerStartCounters[threadId].count(timerName) > 0))
+  {
+    timerCounters[timerName] += currCounters -
+        timerStartCounters[threadId][timerName];
+    timerStartCounters[threadId].erase(timerName);
+    if (timerStartCounters[threadId].empty())
+      timerStartCounters.erase(threadId);
+  }
+
+  // Record the peak memory of this run, if its region was started.
+  if ((timerStartRegions.count(threadId) > 0) &&
+      (timerStartRegions[threadId].count(timerName) > 0))
+  {
+    timerMemory[timerName] = max(timerMemory[timerName],
+        MemoryTracker::StopRegion(timerStartRegions[threadId][timerName]));
+    timerStartRegions[threadId].erase(timerName);
+    if (timerStartRegions[threadId].empty())
+      timerStartRegions.erase(threadId);
+  }
 }
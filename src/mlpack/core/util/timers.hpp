@@ -22,6 +22,9 @@
 #include <list>
 #include <atomic>
 
+#include "perf_counters.hpp"
+#include "memory_tracker.hpp"
+
 #if defined(_WIN32)
   // uint64_t isn't defined on every windows.
   #if !defined(HAVE_UINT64_T)
@@ -41,6 +44,10 @@ namespace mlpack {
  * stopped, and its value to be obtained.  A named timer is specific to the
  * thread it is running on, so if you start a timer in one thread, it cannot be
  * stopped from a different thread.
+ *
+ * Each call takes a lock and looks the timer up by name, so to time code
+ * inside of hot loops (or nested phases of an algorithm), use ScopedTimer
+ * instead.
  */
 class Timer
 {
@@ -76,8 +83,8 @@ class Timer
   static std::chrono::microseconds Get(const std::string& name);
 
   /**
-   * Enable timing of mlpack programs.  Do not run this while timers are
-   * running!
+   * Enable timing of mlpack programs (both Timer and ScopedTimer).  Do not run
+   * this while timers are running!
    */
   static void EnableTiming();
 
@@ -87,9 +94,52 @@ class Timer
    */
   static void DisableTiming();
 
+  /**
+   * Enable counting hardware performance events (see PerfCounters) for each
+   * timer: the events of the thread that started the timer, between
+   * Start() and Stop(), are added to the timer.  Timing must be enabled too.
+   * Do not run this while timers are running!
+   */
+  static void EnablePerfCounters();
+
+  /**
+   * Disable counting hardware performance events.  Do not run this while
+   * timers are running!
+   */
+  static void DisablePerfCounters();
+
+  /**
+   * Get the hardware performance events counted for the given timer.
+   *
+   * @param name Name of timer to return the counters of.
+   */
+  static PerfCounterValues GetPerfCounters(const std::string& name);
+
+  /**
+   * Enable recording the peak memory of each timer: the largest number of
+   * bytes counted by the MemoryTracker at once while the timer was running
+   * (on any thread).  Timing must be enabled too.  Do not run this while
+   * timers are running!
+   */
+  static void EnableMemoryTracking();
+
+  /**
+   * Disable recording the peak memory of each timer.  Do not run this while
+   * timers are running!
+   */
+  static void DisableMemoryTracking();
+
+  /**
+   * Get the peak memory recorded for the given timer, in bytes; if the timer
+   * was run several times, this is the largest peak of all runs.
+   *
+   * @param name Name of timer to return the peak memory of.
+   */
+  static size_t GetPeakMemory(const std::string& name);
+
   /**
    * Stop and reset all running timers.  This removes all knowledge of any
-   * existing timers.
+   * existing timers, including the results of scoped timers.
    */
   static void ResetAll();
 };
@@ -98,7 +148,7 @@ class Timers
 {
  public:
   //! Default to disabled.
-  Timers() : enabled(false) { }
+  Timers() : enabled(false), perfCounters(false), memoryTracking(false) { }
 
   /**
    * Returns a copy of all the timers used via this interface.
@@ -127,6 +177,35 @@ class Timers
    */
   void PrintTimer(const std::string& timerName);
 
+  /**
+   * Returns a copy of the hardware performance events counted for the
+   * specified timer.
+   *
+   * @param timerName The name of the timer in question.
+   */
+  PerfCounterValues GetPerfCounters(const std::string& timerName);
+
+  /**
+   * Prints the hardware performance events counted for the specified timer.
+   *
+   * @param timerName The name of the timer in question.
+   */
+  void PrintPerfCounters(const std::string& timerName);
+
+  /**
+   * Returns the peak memory recorded for the specified timer, in bytes.
+   *
+   * @param timerName The name of the timer in question.
+   */
+  size_t GetPeakMemory(const std::string& timerName);
+
+  /**
+   * Prints the peak memory recorded for the specified timer.
+   *
+   * @param timerName The name of the timer in question.
+   */
+  void PrintPeakMemory(const std::string& timerName);
+
   /**
    * Initializes a timer, available like a normal value specified on
    * the command line.  Timers are of type timeval.  If a timer is started, then
@@ -167,7 +246,21 @@ class Timers
   //! Get whether or not timing is enabled.
   bool Enabled() const { return enabled; }
 
+  //! Modify whether or not hardware performance events are counted.
+  std::atomic<bool>& PerfCountersEnabled() { return perfCounters; }
+  //! Get whether or not hardware performance events are counted.
+  bool PerfCountersEnabled() const { return perfCounters; }
+
+  //! Modify whether or not the peak memory of timers is recorded.
+  std::atomic<bool>& MemoryTrackingEnabled() { return memoryTracking; }
+  //! Get whether or not the peak memory of timers is recorded.
+  bool MemoryTrackingEnabled() const { return memoryTracking; }
+
  private:
+  //! Stop the MemoryTracker regions of all running timers, and record their
+  //! peaks.  The timers mutex must be held.
+  void StopRegions();
+
   //! A map of all the timers that are being tracked.
   std::map<std::string, std::chrono::microseconds> timers;
   //! A mutex for modifying the timers.
@@ -176,8 +269,23 @@ class Timers
   std::map<std::thread::id, std::map<std::string,
       std::chrono::high_resolution_clock::time_point>> timerStartTime;
 
+  //! The hardware performance events counted for each timer.
+  std::map<std::string, PerfCounterValues> timerCounters;
+  //! The values of the performance counters when the timers were started.
+  std::map<std::thread::id, std::map<std::string, PerfCounterValues>>
+      timerStartCounters;
+
+  //! The peak memory of each timer.
+  std::map<std::string, size_t> timerMemory;
+  //! The MemoryTracker regions of the running timers.
+  std::map<std::thread::id, std::map<std::string, size_t>> timerStartRegions;
+
   //! Whether or not timing is enabled.
   std::atomic<bool> enabled;
+  //! Whether or not hardware performance events are counted.
+  std::atomic<bool> perfCounters;
+  //! Whether or not the peak memory of timers is recorded.
+  std::atomic<bool> memoryTracking;
 };
 
 } // namespace mlpack
@@ -31,6 +31,7 @@
 #include <mlpack/prereqs.hpp>
 #include <mlpack/methods/perceptron/perceptron.hpp>
 #include <mlpack/methods/decision_stump/decision_stump.hpp>
+#include "weak_learner_trainer.hpp"
 
 namespace mlpack {
 namespace adaboost {
@@ -147,7 +148,11 @@ class AdaBoost
                const double tolerance = 1e-6);
 
   /**
-   * Classify the given test points.
+   * Classify the given test points.  The points are classified by all the weak
+   * learners in blocks of ClassifyBlockSize points, and the blocks are
+   * classified in parallel when OpenMP is available, so the Classify() method
+   * of the weak learner must be safe to call from several threads at once (as
+   * it is for the Perceptron and the DecisionStump).
    *
    * @param test Testing data.
    * @param predictedLabels Vector in which to the predicted labels of the test
@@ -171,6 +176,9 @@ class AdaBoost
   std::vector<WeakLearnerType> wl;
   //! The weights corresponding to each weak learner.
   std::vector<double> alpha;
+
+  //! The number of points classified together by every weak learner.
+  static const size_t ClassifyBlockSize = 1024;
 }; // class AdaBoost
 
 } // namespace adaboost
@@ -102,6 +102,10 @@ double AdaBoost<WeakLearnerType, MatType>::Train(
   // Weights are stored in this row vector.
   arma::rowvec weights(predictedLabels.n_cols);
 
+  // This trains the weak learner of each round, reusing whatever it can from
+  // round to round.
+  const WeakLearnerTrainer<WeakLearnerType, MatType> trainer(tempData);
+
   // This is the final hypothesis.
   arma::Row<size_t> finalH(predictedLabels.n_cols);
 
@@ -120,14 +124,16 @@ double AdaBoost<WeakLearnerType, MatType>::Train(
     weights = arma::sum(D);
 
     // Use the existing weak learner to train a new one with new weights.
-    WeakLearnerType w(other, tempData, labels, numClasses, weights);
+    WeakLearnerType w = trainer.Train(other, tempData, labels, numClasses,
+        weights);
     w.Classify(tempData, predictedLabels);
 
     // Now from predictedLabels, build ht, the weak hypothesis
     // buildClassificationMatrix(ht, predictedLabels);
 
     // Now, calculate alpha(t) using ht.
-    for (size_t j = 0; j < D.n_cols; j++) // instead of D, ht
+    #pragma omp parallel for reduction(+:rt)
+    for (omp_size_t j = 0; j < (omp_size_t) D.n_cols; j++) // instead of D, ht
     {
       if (predictedLabels(j) == labels(j))
         rt += arma::accu(D.col(j));
@@ -156,10 +162,12 @@ double AdaBoost<WeakLearnerType, MatType>::Train(
     alpha.push_back(alphat);
     wl.push_back(w);
 
-    // Now start modifying the weights.
-    for (size_t j = 0; j < D.n_cols; j++)
+    // Now start modifying the weights.  Each point's weights are independent
+    // of the others, so only zt needs to be combined across threads.
+    const double expo = exp(alphat);
+    #pragma omp parallel for reduction(+:zt)
+    for (omp_size_t j = 0; j < (omp_size_t) D.n_cols; j++)
     {
-      const double expo = exp(alphat);
       if (predictedLabels(j) == labels(j))
       {
         for (size_t k = 0; k < D.n_rows; k++)
@@ -210,28 +218,38 @@ void AdaBoost<WeakLearnerType, MatType>::Classify(
     const MatType& test,
     arma::Row<size_t>& predictedLabels)
 {
-  arma::Row<size_t> tempPredictedLabels(test.n_cols);
-  arma::mat cMatrix(numClasses, test.n_cols);
-
-  cMatrix.zeros();
   predictedLabels.set_size(test.n_cols);
 
-  for (size_t i = 0; i < wl.size(); i++)
+  // Classify the points in blocks, with every weak learner in turn, so that
+  // the votes of only one block are held at a time and the block stays in
+  // cache.  The blocks are classified in parallel.
+  const size_t numBlocks = (test.n_cols + ClassifyBlockSize - 1) /
+      ClassifyBlockSize;
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
   {
-    wl[i].Classify(test, tempPredictedLabels);
+    const size_t begin = b * ClassifyBlockSize;
+    const size_t end = std::min(begin + ClassifyBlockSize,
+        (size_t) test.n_cols);
 
-    for (size_t j = 0; j < tempPredictedLabels.n_cols; j++)
-      cMatrix(tempPredictedLabels(j), j) += alpha[i];
-  }
+    const MatType block = test.cols(begin, end - 1);
+    arma::Row<size_t> tempPredictedLabels(block.n_cols);
+    arma::mat cMatrix(numClasses, block.n_cols, arma::fill::zeros);
 
-  arma::colvec cMRow;
-  arma::uword maxIndex = 0;
+    for (size_t i = 0; i < wl.size(); i++)
+    {
+      wl[i].Classify(block, tempPredictedLabels);
 
-  for (size_t i = 0; i < predictedLabels.n_cols; i++)
-  {
-    cMRow = cMatrix.unsafe_col(i);
-    cMRow.max(maxIndex);
-    predictedLabels(i) = maxIndex;
+      for (size_t j = 0; j < tempPredictedLabels.n_cols; j++)
+        cMatrix(tempPredictedLabels(j), j) += alpha[i];
+    }
+
+    arma::uword maxIndex = 0;
+    for (size_t j = 0; j < block.n_cols; j++)
+    {
+      cMatrix.unsafe_col(j).max(maxIndex);
+      predictedLabels(begin + j) = maxIndex;
+    }
   }
 }
 
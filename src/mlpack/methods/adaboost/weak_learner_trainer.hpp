@@ -0,0 +1,91 @@
+/**
+ * @file weak_learner_trainer.hpp
+ *
+ * The WeakLearnerTrainer class, which trains the weak learner of each round of
+ * AdaBoost.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ADABOOST_WEAK_LEARNER_TRAINER_HPP
+#define MLPACK_METHODS_ADABOOST_WEAK_LEARNER_TRAINER_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/methods/decision_stump/decision_stump.hpp>
+
+namespace mlpack {
+namespace adaboost {
+
+/**
+ * The WeakLearnerTrainer is created once for the data AdaBoost trains on, and
+ * then trains the weak learner of each round with that round's weights.  Only
+ * the weights change from round to round, so weak learners that can reuse
+ * work across rounds may specialize this class.  By default, the boosting
+ * constructor of the weak learner is used.
+ *
+ * @tparam WeakLearnerType Type of weak learner to train.
+ * @tparam MatType Data matrix type.
+ */
+template<typename WeakLearnerType, typename MatType>
+class WeakLearnerTrainer
+{
+ public:
+  //! Prepare to train weak learners on the given data.
+  WeakLearnerTrainer(const MatType& /* data */) { }
+
+  /**
+   * Train a weak learner with the parameters of the given other learner and
+   * the given weights.
+   */
+  WeakLearnerType Train(const WeakLearnerType& other,
+                        const MatType& data,
+                        const arma::Row<size_t>& labels,
+                        const size_t numClasses,
+                        const arma::rowvec& weights) const
+  {
+    return WeakLearnerType(other, data, labels, numClasses, weights);
+  }
+};
+
+/**
+ * Decision stumps sort the points in every dimension before they are trained.
+ * The order does not depend on the weights, so it is computed once and used
+ * for every round.
+ */
+template<typename MatType>
+class WeakLearnerTrainer<decision_stump::DecisionStump<MatType>, MatType>
+{
+ public:
+  //! Sort the points of the given data in each dimension.
+  WeakLearnerTrainer(const MatType& data)
+  {
+    decision_stump::DecisionStump<MatType>::SortDimensions(data,
+        sortedIndices);
+  }
+
+  /**
+   * Train a decision stump with the bucket size of the given other stump and
+   * the given weights.
+   */
+  decision_stump::DecisionStump<MatType> Train(
+      const decision_stump::DecisionStump<MatType>& other,
+      const MatType& data,
+      const arma::Row<size_t>& labels,
+      const size_t numClasses,
+      const arma::rowvec& weights) const
+  {
+    return decision_stump::DecisionStump<MatType>(other, data, labels,
+        numClasses, weights, sortedIndices);
+  }
+
+ private:
+  //! The order of the points in each dimension.
+  arma::umat sortedIndices;
+};
+
+} // namespace adaboost
+} // namespace mlpack
+
+#endif
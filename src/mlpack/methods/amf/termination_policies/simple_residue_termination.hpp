@@ -68,10 +68,17 @@ class SimpleResidueTermination
   bool IsConverged(arma::mat& W, arma::mat& H)
   {
     // Calculate the norm and compute the residue, but do it by hand, so as to
-    // avoid calculating (W*H), which may be very large.
+    // avoid calculating (W*H), which may be very large.  The norm of column j
+    // of W*H is sqrt(H_j^T (W^T W) H_j), so only the small (r x r) matrix
+    // W^T W is needed.
+    const arma::mat gram = W.t() * W;
     double norm = 0.0;
-    for (size_t j = 0; j < H.n_cols; ++j)
-      norm += arma::norm(W * H.col(j), "fro");
+    #pragma omp parallel for reduction(+:norm)
+    for (omp_size_t j = 0; j < (omp_size_t) H.n_cols; ++j)
+    {
+      const double squaredNorm = arma::dot(H.col(j), gram * H.col(j));
+      norm += std::sqrt(std::max(squaredNorm, 0.0));
+    }
     residue = fabs(normOld - norm) / normOld;
 
     // Store the norm.
@@ -68,30 +68,11 @@ class SimpleToleranceTermination
    */
   bool IsConverged(arma::mat& W, arma::mat& H)
   {
-    arma::mat WH;
-
-    WH = W * H;
-
     // compute residue
     residueOld = residue;
-    size_t n = V->n_rows;
-    size_t m = V->n_cols;
     double sum = 0;
     size_t count = 0;
-    for (size_t i = 0; i < n; i++)
-    {
-        for (size_t j = 0; j < m; j++)
-        {
-            double temp = 0;
-            if ((temp = (*V)(i, j)) != 0)
-            {
-                temp = (temp - WH(i, j));
-                temp = temp * temp;
-                sum += temp;
-                count++;
-            }
-        }
-    }
+    SquaredError(*V, W, H, sum, count);
     residue = sum / count;
     residue = sqrt(residue);
 
@@ -160,6 +141,59 @@ class SimpleToleranceTermination
   double& Tolerance() { return tolerance; }
 
  private:
+  /**
+   * Compute the sum of squared errors of W * H at the nonzero elements of V,
+   * and the number of those elements, one column at a time so that W * H is
+   * never formed.
+   */
+  template<typename DenseMatType>
+  static void SquaredError(const DenseMatType& V,
+                           const arma::mat& W,
+                           const arma::mat& H,
+                           double& sum,
+                           size_t& count)
+  {
+    #pragma omp parallel for reduction(+:sum, count)
+    for (omp_size_t j = 0; j < (omp_size_t) V.n_cols; ++j)
+    {
+      const arma::vec wh = W * H.col(j);
+      for (size_t i = 0; i < V.n_rows; ++i)
+      {
+        if (V(i, j) != 0)
+        {
+          sum += std::pow(V(i, j) - wh[i], 2.0);
+          ++count;
+        }
+      }
+    }
+  }
+
+  /**
+   * Compute the sum of squared errors of W * H at the nonzero elements of V,
+   * and the number of those elements, when V is sparse.  Only the nonzero
+   * elements of W * H are computed.
+   */
+  static void SquaredError(const arma::sp_mat& V,
+                           const arma::mat& W,
+                           const arma::mat& H,
+                           double& sum,
+                           size_t& count)
+  {
+    #pragma omp parallel for reduction(+:sum, count)
+    for (omp_size_t j = 0; j < (omp_size_t) V.n_cols; ++j)
+    {
+      arma::sp_mat::const_iterator it = V.begin_col(j);
+      for (; it != V.end_col(j); ++it)
+      {
+        if (*it != 0)
+        {
+          sum += std::pow(*it - arma::dot(W.row(it.row()), H.col(j)), 2.0);
+          ++count;
+        }
+      }
+    }
+  }
+
   //! tolerance
   double tolerance;
   //! iteration threshold
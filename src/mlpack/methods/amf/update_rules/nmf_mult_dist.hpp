@@ -71,7 +71,10 @@ class NMFMultiplicativeDistanceUpdate
                              arma::mat& W,
                              const arma::mat& H)
   {
-    W = (W % (V * H.t())) / (W * H * H.t());
+    // Multiply by the small (r x r) matrix H H^T so that W H, which has the
+    // size of V, is never formed.  V H^T only touches the nonzero elements of
+    // V when V is sparse.
+    W = (W % (V * H.t())) / (W * (H * H.t()));
   }
 
   /**
@@ -93,7 +96,8 @@ class NMFMultiplicativeDistanceUpdate
                              const arma::mat& W,
                              arma::mat& H)
   {
-    H = (H % (W.t() * V)) / (W.t() * W * H);
+    // As in WUpdate(), W^T W is r x r, so W H is never formed.
+    H = (H % (W.t() * V)) / ((W.t() * W) * H);
   }
 
   //! Serialize the object (in this case, there is nothing to serialize).
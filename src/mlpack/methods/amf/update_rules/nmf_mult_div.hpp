@@ -41,9 +41,12 @@ namespace amf {
  * is non-increasing between subsequent iterations. Both of the update rules
  * for W and H are defined in this file.
  *
- * This set of update rules is not meant to work with sparse matrices.  Using
- * sparse matrices often causes NaNs in the output, so other choices of update
- * rules are better in that situation.
+ * The elements of V that are zero do not contribute to the numerators of the
+ * update rules, so when V is an arma::sp_mat, the ratios \f$ V_{ij} / (W
+ * H)_{ij} \f$ are only computed where V is nonzero, in parallel over the
+ * columns of V, and W H is never formed.  This takes O(r nnz(V)) time instead
+ * of O(r n m).  Note that if W H is zero where V is nonzero, the output will
+ * still contain NaNs.
  */
 class NMFMultiplicativeDivergenceUpdate
 {
@@ -81,28 +84,24 @@ class NMFMultiplicativeDivergenceUpdate
                              arma::mat& W,
                              const arma::mat& H)
   {
-    // Simple implementation left in the header file.
-    arma::mat t1;
-    arma::rowvec t2;
-
-    t1 = W * H;
-    for (size_t i = 0; i < W.n_rows; ++i)
-    {
-      for (size_t j = 0; j < W.n_cols; ++j)
-      {
-        // Writing this as a single expression does not work as of Armadillo
-        // 3.920.  This should be fixed in a future release, and then the code
-        // below can be fixed.
-        // t2 = H.row(j) % V.row(i) / t1.row(i);
-        t2.set_size(H.n_cols);
-        for (size_t k = 0; k < t2.n_elem; ++k)
-        {
-          t2(k) = H(j, k) * V(i, k) / t1(i, k);
-        }
+    const arma::mat ratios = V / (W * H);
+    W %= arma::mat(ratios * H.t()).each_row() / arma::sum(H, 1).t();
+  }
 
-        W(i, j) = W(i, j) * sum(t2) / sum(H.row(j));
-      }
-    }
+  /**
+   * The update rule for the basis matrix W, when V is sparse.  The ratios are
+   * only computed at the nonzero elements of V.
+   *
+   * @param V Input matrix to be factorized.
+   * @param W Basis matrix to be updated.
+   * @param H Encoding matrix.
+   */
+  inline static void WUpdate(const arma::sp_mat& V,
+                             arma::mat& W,
+                             const arma::mat& H)
+  {
+    const arma::sp_mat ratios = SparseRatios(V, W, H);
+    W %= arma::mat(ratios * H.t()).each_row() / arma::sum(H, 1).t();
   }
 
   /**
@@ -122,36 +121,58 @@ class NMFMultiplicativeDivergenceUpdate
    */
   template<typename MatType>
   inline static void HUpdate(const MatType& V,
-                            const arma::mat& W,
-                            arma::mat& H)
+                             const arma::mat& W,
+                             arma::mat& H)
   {
-    // Simple implementation left in the header file.
-    arma::mat t1;
-    arma::colvec t2;
-
-    t1 = W * H;
-    for (size_t i = 0; i < H.n_rows; i++)
-    {
-      for (size_t j = 0; j < H.n_cols; j++)
-      {
-        // Writing this as a single expression does not work as of Armadillo
-        // 3.920.  This should be fixed in a future release, and then the code
-        // below can be fixed.
-        // t2 = W.col(i) % V.col(j) / t1.col(j);
-        t2.set_size(W.n_rows);
-        for (size_t k = 0; k < t2.n_elem; ++k)
-        {
-          t2(k) = W(k, i) * V(k, j) / t1(k, j);
-        }
+    const arma::mat ratios = V / (W * H);
+    H %= arma::mat(W.t() * ratios).each_col() / arma::sum(W, 0).t();
+  }
 
-        H(i, j) = H(i, j) * sum(t2) / sum(W.col(i));
-      }
-    }
+  /**
+   * The update rule for the encoding matrix H, when V is sparse.  The ratios
+   * are only computed at the nonzero elements of V.
+   *
+   * @param V Input matrix to be factorized.
+   * @param W Basis matrix.
+   * @param H Encoding matrix to updated.
+   */
+  inline static void HUpdate(const arma::sp_mat& V,
+                             const arma::mat& W,
+                             arma::mat& H)
+  {
+    const arma::sp_mat ratios = SparseRatios(V, W, H);
+    H %= arma::mat(W.t() * ratios).each_col() / arma::sum(W, 0).t();
   }
 
   //! Serialize the object (in this case, there is nothing to serialize).
   template<typename Archive>
   void serialize(Archive& /* ar */, const unsigned int /* version */) { }
+
+ private:
+  /**
+   * Compute V_ij / (W H)_ij at the nonzero elements of V, and return them as
+   * a sparse matrix with the same nonzero locations as V.
+   */
+  inline static arma::sp_mat SparseRatios(const arma::sp_mat& V,
+                                          const arma::mat& W,
+                                          const arma::mat& H)
+  {
+    const arma::uvec rowIndices(V.row_indices, V.n_nonzero);
+    const arma::uvec colPtrs(V.col_ptrs, V.n_cols + 1);
+    arma::vec values(V.n_nonzero);
+
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (omp_size_t j = 0; j < (omp_size_t) V.n_cols; ++j)
+    {
+      for (size_t k = colPtrs[j]; k < colPtrs[j + 1]; ++k)
+      {
+        values[k] = V.values[k] / arma::dot(W.row(rowIndices[k]),
+            H.col(j));
+      }
+    }
+
+    return arma::sp_mat(rowIndices, colPtrs, values, V.n_rows, V.n_cols);
+  }
 };
 
 } // namespace amf
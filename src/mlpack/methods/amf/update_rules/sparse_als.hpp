@@ -0,0 +1,234 @@
+/**
+ * @file sparse_als.hpp
+ *
+ * Alternating least squares update rule that only uses the observed elements
+ * of the matrix, for explicit or implicit feedback.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_AMF_UPDATE_RULES_SPARSE_ALS_HPP
+#define MLPACK_METHODS_AMF_UPDATE_RULES_SPARSE_ALS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace amf {
+
+/**
+ * This class implements regularized alternating least squares on the nonzero
+ * (observed) elements of the matrix V only.  Each row of W and each column of
+ * H is the solution of its own small (rank x rank) system of normal
+ * equations, so the rows (and columns) are solved in parallel with OpenMP,
+ * each with a Cholesky factorization.
+ *
+ * For explicit feedback, column j of H minimizes
+ *
+ * \f[
+ * \sum_{i : V_{ij} \ne 0} (V_{ij} - W_i H_j)^2 + \lambda \| H_j \|^2,
+ * \f]
+ *
+ * and the rows of W are found likewise.  For implicit feedback, every element
+ * of V is an observation: the preference is one for nonzero elements and zero
+ * otherwise, with confidence \f$ 1 + \alpha V_{ij} \f$, as described in the
+ * following paper:
+ *
+ * @code
+ * @inproceedings{hu2008collaborative,
+ *   title={Collaborative Filtering for Implicit Feedback Datasets},
+ *   author={Hu, Y. and Koren, Y. and Volinsky, C.},
+ *   booktitle={Proceedings of the 8th IEEE International Conference on Data
+ *       Mining (ICDM '08)},
+ *   pages={263--272},
+ *   year={2008}
+ * }
+ * @endcode
+ *
+ * The Gram matrix of the fixed factor is then computed once per update and
+ * shared by all rows (or columns), so each solve still only touches the
+ * nonzero elements.
+ *
+ * The nonzero elements of the matrix are copied by column and by row in
+ * Initialize(), and the update rules use these copies instead of the matrix
+ * they are given.
+ */
+class SparseALSUpdate
+{
+ public:
+  /**
+   * Create the update rule with the given parameters.
+   *
+   * @param lambda Regularization parameter.
+   * @param implicit If true, V holds implicit feedback.
+   * @param alpha Confidence scale of implicit feedback.
+   */
+  SparseALSUpdate(const double lambda = 0.01,
+                  const bool implicit = false,
+                  const double alpha = 1.0) :
+      lambda(lambda),
+      implicit(implicit),
+      alpha(alpha)
+  {
+    // Nothing to do.
+  }
+
+  /**
+   * Copy the nonzero elements of the given matrix, by column and by row.
+   *
+   * @param dataset Input matrix to be factorized.
+   * @param rank Rank of the factorization.
+   */
+  template<typename MatType>
+  void Initialize(const MatType& dataset, const size_t /* rank */)
+  {
+    byColumn = arma::sp_mat(dataset);
+    byRow = byColumn.t();
+  }
+
+  /**
+   * The update rule for the basis matrix W.  Each row of W is solved for
+   * independently, holding H constant.
+   *
+   * @param V Input matrix to be factorized (unused; see Initialize()).
+   * @param W Basis matrix to be updated.
+   * @param H Encoding matrix.
+   */
+  template<typename MatType>
+  void WUpdate(const MatType& /* V */,
+               arma::mat& W,
+               const arma::mat& H)
+  {
+    arma::mat wt(W.n_cols, W.n_rows);
+    Solve(byRow, H.t(), wt);
+    W = wt.t();
+  }
+
+  /**
+   * The update rule for the encoding matrix H.  Each column of H is solved for
+   * independently, holding W constant.
+   *
+   * @param V Input matrix to be factorized (unused; see Initialize()).
+   * @param W Basis matrix.
+   * @param H Encoding matrix to be updated.
+   */
+  template<typename MatType>
+  void HUpdate(const MatType& /* V */,
+               const arma::mat& W,
+               arma::mat& H)
+  {
+    H.set_size(W.n_cols, byColumn.n_cols);
+    Solve(byColumn, W.t(), H);
+  }
+
+  //! Get the regularization parameter.
+  double Lambda() const { return lambda; }
+  //! Modify the regularization parameter.
+  double& Lambda() { return lambda; }
+
+  //! Get whether the matrix holds implicit feedback.
+  bool Implicit() const { return implicit; }
+  //! Modify whether the matrix holds implicit feedback.
+  bool& Implicit() { return implicit; }
+
+  //! Get the confidence scale of implicit feedback.
+  double Alpha() const { return alpha; }
+  //! Modify the confidence scale of implicit feedback.
+  double& Alpha() { return alpha; }
+
+  //! Serialize the object.
+  template<typename Archive>
+  void serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & BOOST_SERIALIZATION_NVP(lambda);
+    ar & BOOST_SERIALIZATION_NVP(implicit);
+    ar & BOOST_SERIALIZATION_NVP(alpha);
+  }
+
+ private:
+  /**
+   * Solve for each column of x, given the fixed factors y (one column for
+   * each row of data): column j of x is fit to the nonzero elements of column
+   * j of data.
+   *
+   * @param data Nonzero elements of the matrix, one column per column of x.
+   * @param y Fixed factors.
+   * @param x Factors to solve for; it must have the right size.
+   */
+  void Solve(const arma::sp_mat& data,
+             const arma::mat& y,
+             arma::mat& x) const
+  {
+    const size_t rank = y.n_rows;
+
+    // For implicit feedback, every element contributes y * y^T with unit
+    // confidence, so that part is the same for every column.
+    arma::mat gram;
+    if (implicit)
+      gram = y * y.t();
+
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (omp_size_t j = 0; j < (omp_size_t) data.n_cols; ++j)
+    {
+      // Collect the factors and values of the nonzero elements of the column.
+      const size_t count = data.col_ptrs[j + 1] - data.col_ptrs[j];
+      arma::mat factors(rank, count);
+      arma::vec values(count);
+      size_t k = 0;
+      arma::sp_mat::const_iterator it = data.begin_col(j);
+      for (; it != data.end_col(j); ++it, ++k)
+      {
+        factors.col(k) = y.col(it.row());
+        values[k] = *it;
+      }
+
+      arma::mat a;
+      arma::vec b;
+      if (implicit)
+      {
+        // The confidence of the nonzero elements is 1 + alpha * value, and
+        // their preference is one.
+        const arma::vec extra = alpha * values;
+        a = gram + (factors.each_row() % extra.t()) * factors.t();
+        b = factors * (1.0 + extra);
+      }
+      else
+      {
+        a = factors * factors.t();
+        b = factors * values;
+      }
+      a.diag() += lambda;
+
+      // The system is symmetric positive definite unless lambda is zero and
+      // there are too few elements.
+      arma::mat r;
+      if (arma::chol(r, a))
+      {
+        x.col(j) = arma::solve(arma::trimatu(r),
+            arma::solve(arma::trimatl(r.t()), b));
+      }
+      else
+      {
+        x.col(j) = arma::pinv(a) * b;
+      }
+    }
+  }
+
+  //! Regularization parameter.
+  double lambda;
+  //! Whether the matrix holds implicit feedback.
+  bool implicit;
+  //! Confidence scale of implicit feedback.
+  double alpha;
+
+  //! The nonzero elements of the matrix, by column.
+  arma::sp_mat byColumn;
+  //! The nonzero elements of the matrix, by row (the transposed matrix).
+  arma::sp_mat byRow;
+}; // class SparseALSUpdate
+
+} // namespace amf
+} // namespace mlpack
+
+#endif
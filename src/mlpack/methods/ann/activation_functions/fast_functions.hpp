@@ -0,0 +1,179 @@
+/**
+ * @file fast_functions.hpp
+ *
+ * Accuracy-bounded approximations of exp(), the logistic function and tanh(),
+ * with array versions that also compute the derivative in the same pass.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_ACTIVATION_FUNCTIONS_FAST_FUNCTIONS_HPP
+#define MLPACK_METHODS_ANN_ACTIVATION_FUNCTIONS_FAST_FUNCTIONS_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <cstring>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * Whether the given input and output types (and derivative type, if given)
+ * are all dense double matrices (or vectors), whose elements are contiguous,
+ * so that the array functions below can be used on them.
+ */
+template<typename InputVecType,
+         typename OutputVecType,
+         typename DerivVecType = OutputVecType>
+struct UseFastFunctions
+{
+  static const bool value =
+      std::is_base_of<arma::Mat<double>, InputVecType>::value &&
+      std::is_base_of<arma::Mat<double>, OutputVecType>::value &&
+      std::is_base_of<arma::Mat<double>, DerivVecType>::value;
+};
+
+/**
+ * Compute exp(x) with a relative error below 1e-14.  The argument is clamped
+ * to [-708, 709] (so the result is never zero or infinite), written as
+ * x = n log(2) + r with |r| <= log(2) / 2, and exp(r) is evaluated with a
+ * polynomial and scaled by 2^n, which is built directly from the bits of n.
+ * There are no calls into libm and no branches other than the clamp, so loops
+ * over this function are vectorized by the compiler for whatever instruction
+ * set it targets (for instance AVX-512 with -march=native; with only AVX2, GCC
+ * also needs -fno-trapping-math to vectorize the clamp), and are still correct
+ * scalar code otherwise.
+ *
+ * @param x Input value.
+ * @return exp(x).
+ */
+inline double FastExp(const double x)
+{
+  // Adding and subtracting 1.5 * 2^52 rounds x / log(2) to the nearest
+  // integer n, and leaves n in the low bits of the mantissa of t.
+  const double shifter = 6755399441055744.0;
+  const double clamped = std::min(std::max(x, -708.0), 709.0);
+  const double t = clamped * 1.4426950408889634 + shifter;
+  const double n = t - shifter;
+
+  // log(2) is split into two parts so that n * log(2) is exact.
+  const double r = (clamped - n * 6.93147180369123816490e-01) -
+      n * 1.90821492927058770002e-10;
+
+  // Degree 11 Taylor polynomial of exp(r), whose truncation error is below
+  // 1e-14 for |r| <= log(2) / 2.
+  double p = 2.505210838544172e-08;
+  p = p * r + 2.755731922398589e-07;
+  p = p * r + 2.755731922398589e-06;
+  p = p * r + 2.480158730158730e-05;
+  p = p * r + 1.984126984126984e-04;
+  p = p * r + 1.388888888888889e-03;
+  p = p * r + 8.333333333333333e-03;
+  p = p * r + 4.166666666666666e-02;
+  p = p * r + 1.666666666666667e-01;
+  p = p * r + 0.5;
+  p = p * r + 1.0;
+  p = p * r + 1.0;
+
+  // The low 12 bits of t are n (modulo 2^12), so shifting them into the
+  // exponent field after adding the bias gives 2^n.
+  uint64_t bits;
+  std::memcpy(&bits, &t, sizeof(double));
+  bits = (bits + 1023) << 52;
+  double scale;
+  std::memcpy(&scale, &bits, sizeof(double));
+
+  return p * scale;
+}
+
+/**
+ * Compute the logistic function 1 / (1 + exp(-x)) with FastExp(), with an
+ * absolute error below 1e-14.
+ *
+ * @param x Input value.
+ * @return The logistic function of x.
+ */
+inline double FastLogistic(const double x)
+{
+  return 1.0 / (1.0 + FastExp(-x));
+}
+
+/**
+ * Compute tanh(x) = 1 - 2 / (exp(2x) + 1) with FastExp(), with an absolute
+ * error below 1e-14 (the relative error is larger for very small |x|, where
+ * the result is close to zero).
+ *
+ * @param x Input value.
+ * @return tanh(x).
+ */
+inline double FastTanh(const double x)
+{
+  return 1.0 - 2.0 / (FastExp(2.0 * x) + 1.0);
+}
+
+/**
+ * Compute exp() for each of the n elements of x, storing the results in y
+ * (which may be x).
+ */
+inline void FastExp(const double* x, double* y, const size_t n)
+{
+  for (size_t i = 0; i < n; ++i)
+    y[i] = FastExp(x[i]);
+}
+
+/**
+ * Compute the logistic function for each of the n elements of x, storing the
+ * results in y (which may be x).
+ */
+inline void FastLogistic(const double* x, double* y, const size_t n)
+{
+  for (size_t i = 0; i < n; ++i)
+    y[i] = FastLogistic(x[i]);
+}
+
+/**
+ * Compute the logistic function for each of the n elements of x, storing the
+ * results in y and the derivatives y (1 - y) in d, in one pass.
+ */
+inline void FastLogistic(const double* x,
+                         double* y,
+                         double* d,
+                         const size_t n)
+{
+  for (size_t i = 0; i < n; ++i)
+  {
+    const double s = FastLogistic(x[i]);
+    y[i] = s;
+    d[i] = s * (1.0 - s);
+  }
+}
+
+/**
+ * Compute tanh() for each of the n elements of x, storing the results in y
+ * (which may be x).
+ */
+inline void FastTanh(const double* x, double* y, const size_t n)
+{
+  for (size_t i = 0; i < n; ++i)
+    y[i] = FastTanh(x[i]);
+}
+
+/**
+ * Compute tanh() for each of the n elements of x, storing the results in y
+ * and the derivatives 1 - y^2 in d, in one pass.
+ */
+inline void FastTanh(const double* x, double* y, double* d, const size_t n)
+{
+  for (size_t i = 0; i < n; ++i)
+  {
+    const double t = FastTanh(x[i]);
+    y[i] = t;
+    d[i] = 1.0 - t * t;
+  }
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
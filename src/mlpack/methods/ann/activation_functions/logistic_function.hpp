@@ -13,6 +13,7 @@
 #define MLPACK_METHODS_ANN_ACTIVATION_FUNCTIONS_LOGISTIC_FUNCTION_HPP
 
 #include <mlpack/prereqs.hpp>
+#include "fast_functions.hpp"
 
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
@@ -56,11 +57,71 @@ class LogisticFunction
    * @param y The resulting output activation.
    */
   template<typename InputVecType, typename OutputVecType>
-  static void Fn(const InputVecType& x, OutputVecType& y)
+  static void Fn(const InputVecType& x,
+                 OutputVecType& y,
+                 const typename std::enable_if_t<!UseFastFunctions<
+                     InputVecType, OutputVecType>::value>* = 0)
   {
     y = (1.0 / (1 + arma::exp(-x)));
   }
 
+  /**
+   * Computes the logistic function of a dense double matrix with
+   * FastLogistic().
+   *
+   * @param x Input data.
+   * @param y The resulting output activation.
+   */
+  template<typename InputVecType, typename OutputVecType>
+  static void Fn(const InputVecType& x,
+                 OutputVecType& y,
+                 const typename std::enable_if_t<
+                     UseFastFunctions<InputVecType, OutputVecType>::value>* = 0)
+  {
+    y.set_size(arma::size(x));
+    FastLogistic(x.memptr(), y.memptr(), x.n_elem);
+  }
+
+  /**
+   * Computes the logistic function and its first derivatives in one pass.
+   *
+   * @param x Input data.
+   * @param y The resulting output activation.
+   * @param d The resulting derivatives.
+   */
+  template<typename InputVecType, typename OutputVecType, typename DerivVecType>
+  static void FnDeriv(const InputVecType& x,
+                      OutputVecType& y,
+                      DerivVecType& d,
+                      const typename std::enable_if_t<!UseFastFunctions<
+                          InputVecType, OutputVecType, DerivVecType>::value>* =
+                          0)
+  {
+    Fn(x, y);
+    Deriv(y, d);
+  }
+
+  /**
+   * Computes the logistic function of a dense double matrix and its first
+   * derivatives in one pass with FastLogistic().
+   *
+   * @param x Input data.
+   * @param y The resulting output activation.
+   * @param d The resulting derivatives.
+   */
+  template<typename InputVecType, typename OutputVecType, typename DerivVecType>
+  static void FnDeriv(const InputVecType& x,
+                      OutputVecType& y,
+                      DerivVecType& d,
+                      const typename std::enable_if_t<UseFastFunctions<
+                          InputVecType, OutputVecType, DerivVecType>::value>* =
+                          0)
+  {
+    y.set_size(arma::size(x));
+    d.set_size(arma::size(x));
+    FastLogistic(x.memptr(), y.memptr(), d.memptr(), x.n_elem);
+  }
+
   /**
    * Computes the first derivative of the logistic function.
    *
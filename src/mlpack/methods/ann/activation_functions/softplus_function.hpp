@@ -27,6 +27,7 @@
 #define MLPACK_METHODS_ANN_ACTIVATION_FUNCTIONS_SOFTPLUS_FUNCTION_HPP
 
 #include <mlpack/prereqs.hpp>
+#include "fast_functions.hpp"
 
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
@@ -89,11 +90,31 @@ class SoftplusFunction
    * @param x The resulting derivatives.
    */
   template<typename InputType, typename OutputType>
-  static void Deriv(const InputType& y, OutputType& x)
+  static void Deriv(const InputType& y,
+                    OutputType& x,
+                    const typename std::enable_if_t<
+                        !UseFastFunctions<InputType, OutputType>::value>* = 0)
   {
     x = 1.0 / (1 + arma::exp(-y));
   }
 
+  /**
+   * Computes the first derivatives of the softplus function for a dense double
+   * matrix with FastLogistic().
+   *
+   * @param y Input activations.
+   * @param x The resulting derivatives.
+   */
+  template<typename InputType, typename OutputType>
+  static void Deriv(const InputType& y,
+                    OutputType& x,
+                    const typename std::enable_if_t<
+                        UseFastFunctions<InputType, OutputType>::value>* = 0)
+  {
+    x.set_size(arma::size(y));
+    FastLogistic(y.memptr(), x.memptr(), y.n_elem);
+  }
+
   /**
    * Computes the inverse of the softplus function.
    *
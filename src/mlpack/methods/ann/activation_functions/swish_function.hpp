@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_ANN_ACTIVATION_FUNCTIONS_SWISH_FUNCTION_HPP
 
 #include <mlpack/prereqs.hpp>
+#include "fast_functions.hpp"
 
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
@@ -48,7 +49,10 @@ class SwishFunction
    * @param y The resulting output activation.
    */
   template<typename eT>
-  static void Fn(const arma::Mat<eT>& x, arma::Mat<eT>& y)
+  static void Fn(const arma::Mat<eT>& x,
+                 arma::Mat<eT>& y,
+                 const typename std::enable_if_t<
+                     !std::is_same<eT, double>::value>* = 0)
   {
     y = x / (1.0 + arma::exp(-x));
   }
@@ -60,7 +64,10 @@ class SwishFunction
    * @param y The resulting output activation.
    */
   template<typename InputVecType, typename OutputVecType>
-  static void Fn(const InputVecType& x, OutputVecType& y)
+  static void Fn(const InputVecType& x,
+                 OutputVecType& y,
+                 const typename std::enable_if_t<!UseFastFunctions<
+                     InputVecType, OutputVecType>::value>* = 0)
   {
     y.set_size(arma::size(x));
 
@@ -68,6 +75,79 @@ class SwishFunction
       y(i) = Fn(x(i));
   }
 
+  /**
+   * Computes the swish function of a dense double matrix with FastExp().
+   *
+   * @param x Input data.
+   * @param y The resulting output activation.
+   */
+  template<typename InputVecType, typename OutputVecType>
+  static void Fn(const InputVecType& x,
+                 OutputVecType& y,
+                 const typename std::enable_if_t<
+                     UseFastFunctions<InputVecType, OutputVecType>::value>* = 0)
+  {
+    y.set_size(arma::size(x));
+
+    const double* in = x.memptr();
+    double* out = y.memptr();
+    for (size_t i = 0; i < x.n_elem; i++)
+      out[i] = in[i] * FastLogistic(in[i]);
+  }
+
+  /**
+   * Computes the swish function and its first derivatives (with respect to the
+   * input) in one pass.
+   *
+   * @param x Input data.
+   * @param y The resulting output activation.
+   * @param d The resulting derivatives.
+   */
+  template<typename InputVecType, typename OutputVecType, typename DerivVecType>
+  static void FnDeriv(const InputVecType& x,
+                      OutputVecType& y,
+                      DerivVecType& d,
+                      const typename std::enable_if_t<!UseFastFunctions<
+                          InputVecType, OutputVecType, DerivVecType>::value>* =
+                          0)
+  {
+    const arma::Mat<typename InputVecType::elem_type> sigmoid =
+        1.0 / (1.0 + arma::exp(-x));
+    y = x % sigmoid;
+    d = y + sigmoid % (1.0 - y);
+  }
+
+  /**
+   * Computes the swish function of a dense double matrix and its first
+   * derivatives (with respect to the input) in one pass with FastExp().
+   *
+   * @param x Input data.
+   * @param y The resulting output activation.
+   * @param d The resulting derivatives.
+   */
+  template<typename InputVecType, typename OutputVecType, typename DerivVecType>
+  static void FnDeriv(const InputVecType& x,
+                      OutputVecType& y,
+                      DerivVecType& d,
+                      const typename std::enable_if_t<UseFastFunctions<
+                          InputVecType, OutputVecType, DerivVecType>::value>* =
+                          0)
+  {
+    y.set_size(arma::size(x));
+    d.set_size(arma::size(x));
+
+    const double* in = x.memptr();
+    double* out = y.memptr();
+    double* derivs = d.memptr();
+    for (size_t i = 0; i < x.n_elem; i++)
+    {
+      const double sigmoid = FastLogistic(in[i]);
+      const double value = in[i] * sigmoid;
+      out[i] = value;
+      derivs[i] = value + sigmoid * (1.0 - value);
+    }
+  }
+
   /**
    * Computes the first derivative of the swish function.
    *
@@ -0,0 +1,148 @@
+/**
+ * @file batch_prefetcher.hpp
+ *
+ * Definition of BatchPrefetcher, which gathers the batches of a shuffled
+ * training set, and gathers the next batch in the background while the
+ * current one is used.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_BATCH_PREFETCHER_HPP
+#define MLPACK_METHODS_ANN_BATCH_PREFETCHER_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <future>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * Copy the given columns of a dense matrix into another matrix, whose memory
+ * is reused if it already has the right size.
+ */
+inline void GatherColumns(const arma::mat& input,
+                          const arma::uvec& indices,
+                          arma::mat& output);
+
+/**
+ * Copy the given columns of a sparse matrix into another sparse matrix.  Only
+ * the nonzero elements of the columns are visited.
+ */
+inline void GatherColumns(const arma::sp_mat& input,
+                          const arma::uvec& indices,
+                          arma::sp_mat& output);
+
+/**
+ * Copy the given columns of every slice of a cube into another cube, whose
+ * memory is reused if it already has the right size.
+ */
+inline void GatherColumns(const arma::cube& input,
+                          const arma::uvec& indices,
+                          arma::cube& output);
+
+/**
+ * BatchPrefetcher gathers the batches of a training set whose points are
+ * visited in the order of an index vector, so that shuffling the training set
+ * only shuffles the indices instead of moving every point.  The points of
+ * each batch are copied into a contiguous buffer that the network can use
+ * like a batch of the unshuffled data.
+ *
+ * With prefetching, the points of the next batch (the one that begins where
+ * the requested batch ends, which is what the optimizers ask for next) are
+ * gathered into a second buffer on another thread while the current batch is
+ * used.  If a different batch is requested, the prefetched one is dropped.
+ * The data and the order must not be modified while a batch is being
+ * prefetched; call Reset() first.
+ *
+ * @code
+ * BatchPrefetcher<arma::mat, arma::mat> prefetcher;
+ * prefetcher.Next(predictors, responses, order, begin, batchSize, true);
+ * // Use prefetcher.Predictors() and prefetcher.Responses()...
+ * @endcode
+ *
+ * @tparam PredictorsType Type of the predictors (arma::mat, arma::sp_mat or
+ *     arma::cube).
+ * @tparam ResponsesType Type of the responses (arma::mat or arma::cube).
+ */
+template<typename PredictorsType, typename ResponsesType>
+class BatchPrefetcher
+{
+ public:
+  //! Create the BatchPrefetcher object, with nothing gathered.
+  BatchPrefetcher();
+
+  //! A copy has nothing gathered.
+  BatchPrefetcher(const BatchPrefetcher& other);
+
+  //! A copy has nothing gathered.
+  BatchPrefetcher& operator=(const BatchPrefetcher& other);
+
+  //! Wait for the prefetched batch, if any.
+  ~BatchPrefetcher();
+
+  /**
+   * Gather the points order[begin, begin + batchSize) of the given data into
+   * Predictors() and Responses(), using the prefetched batch if it is the
+   * one requested.  If prefetch is true, start gathering the following batch
+   * of the same size (or the rest of the points, if fewer) in the background.
+   *
+   * @param predictors Predictors of the training set.
+   * @param responses Responses of the training set.
+   * @param order The order in which to visit the points.
+   * @param begin Position in the order of the first point of the batch.
+   * @param batchSize Number of points of the batch.
+   * @param prefetch Whether to gather the next batch in the background.
+   */
+  void Next(const PredictorsType& predictors,
+            const ResponsesType& responses,
+            const arma::uvec& order,
+            const size_t begin,
+            const size_t batchSize,
+            const bool prefetch);
+
+  //! Wait for the prefetched batch, if any, and drop it.
+  void Reset();
+
+  //! Get the predictors of the current batch.
+  const PredictorsType& Predictors() const { return batchPredictors; }
+  //! Modify the predictors of the current batch.
+  PredictorsType& Predictors() { return batchPredictors; }
+  //! Get the responses of the current batch.
+  const ResponsesType& Responses() const { return batchResponses; }
+  //! Modify the responses of the current batch.
+  ResponsesType& Responses() { return batchResponses; }
+
+  //! Get the number of batches that were prefetched before they were needed.
+  size_t Prefetched() const { return prefetched; }
+
+ private:
+  //! The predictors of the current batch.
+  PredictorsType batchPredictors;
+  //! The responses of the current batch.
+  ResponsesType batchResponses;
+
+  //! The predictors of the prefetched batch.
+  PredictorsType nextPredictors;
+  //! The responses of the prefetched batch.
+  ResponsesType nextResponses;
+  //! The position in the order of the first point of the prefetched batch.
+  size_t nextBegin;
+  //! The number of points of the prefetched batch.
+  size_t nextBatchSize;
+  //! The pending gather of the prefetched batch.
+  std::future<void> pending;
+
+  //! The number of batches that were prefetched before they were needed.
+  size_t prefetched;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "batch_prefetcher_impl.hpp"
+
+#endif
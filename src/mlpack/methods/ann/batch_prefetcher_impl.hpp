@@ -0,0 +1,172 @@
+/**
+ * @file batch_prefetcher_impl.hpp
+ *
+ * Implementation of BatchPrefetcher.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_BATCH_PREFETCHER_IMPL_HPP
+#define MLPACK_METHODS_ANN_BATCH_PREFETCHER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "batch_prefetcher.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+inline void GatherColumns(const arma::mat& input,
+                          const arma::uvec& indices,
+                          arma::mat& output)
+{
+  output.set_size(input.n_rows, indices.n_elem);
+  for (size_t i = 0; i < indices.n_elem; ++i)
+  {
+    std::copy(input.colptr(indices[i]), input.colptr(indices[i]) +
+        input.n_rows, output.colptr(i));
+  }
+}
+
+inline void GatherColumns(const arma::sp_mat& input,
+                          const arma::uvec& indices,
+                          arma::sp_mat& output)
+{
+  size_t nonzeros = 0;
+  for (size_t i = 0; i < indices.n_elem; ++i)
+  {
+    nonzeros += input.col_ptrs[indices[i] + 1] - input.col_ptrs[indices[i]];
+  }
+
+  // The columns are visited in order, and the elements of each column are
+  // sorted by row, so the locations are already sorted.
+  arma::umat locations(2, nonzeros);
+  arma::vec values(nonzeros);
+  size_t index = 0;
+  for (size_t i = 0; i < indices.n_elem; ++i)
+  {
+    arma::sp_mat::const_iterator it = input.begin_col(indices[i]);
+    arma::sp_mat::const_iterator end = input.end_col(indices[i]);
+    for (; it != end; ++it, ++index)
+    {
+      locations(0, index) = it.row();
+      locations(1, index) = i;
+      values[index] = (*it);
+    }
+  }
+
+  output = arma::sp_mat(locations, values, input.n_rows, indices.n_elem,
+      false);
+}
+
+inline void GatherColumns(const arma::cube& input,
+                          const arma::uvec& indices,
+                          arma::cube& output)
+{
+  output.set_size(input.n_rows, indices.n_elem, input.n_slices);
+  for (size_t s = 0; s < input.n_slices; ++s)
+  {
+    for (size_t i = 0; i < indices.n_elem; ++i)
+    {
+      std::copy(input.slice(s).colptr(indices[i]), input.slice(s).colptr(
+          indices[i]) + input.n_rows, output.slice(s).colptr(i));
+    }
+  }
+}
+
+template<typename PredictorsType, typename ResponsesType>
+BatchPrefetcher<PredictorsType, ResponsesType>::BatchPrefetcher() :
+    nextBegin(0),
+    nextBatchSize(0),
+    prefetched(0)
+{
+  // Nothing to do here.
+}
+
+template<typename PredictorsType, typename ResponsesType>
+BatchPrefetcher<PredictorsType, ResponsesType>::BatchPrefetcher(
+    const BatchPrefetcher& /* other */) :
+    nextBegin(0),
+    nextBatchSize(0),
+    prefetched(0)
+{
+  // Nothing to do here.
+}
+
+template<typename PredictorsType, typename ResponsesType>
+BatchPrefetcher<PredictorsType, ResponsesType>&
+BatchPrefetcher<PredictorsType, ResponsesType>::operator=(
+    const BatchPrefetcher& /* other */)
+{
+  Reset();
+  return *this;
+}
+
+template<typename PredictorsType, typename ResponsesType>
+BatchPrefetcher<PredictorsType, ResponsesType>::~BatchPrefetcher()
+{
+  if (pending.valid())
+    pending.wait();
+}
+
+template<typename PredictorsType, typename ResponsesType>
+void BatchPrefetcher<PredictorsType, ResponsesType>::Next(
+    const PredictorsType& predictors,
+    const ResponsesType& responses,
+    const arma::uvec& order,
+    const size_t begin,
+    const size_t batchSize,
+    const bool prefetch)
+{
+  bool gathered = false;
+  if (pending.valid())
+  {
+    // get() rethrows any exception thrown while gathering.
+    pending.get();
+    if (nextBegin == begin && nextBatchSize == batchSize)
+    {
+      std::swap(batchPredictors, nextPredictors);
+      std::swap(batchResponses, nextResponses);
+      ++prefetched;
+      gathered = true;
+    }
+  }
+
+  if (!gathered)
+  {
+    const arma::uvec indices = order.subvec(begin, begin + batchSize - 1);
+    GatherColumns(predictors, indices, batchPredictors);
+    GatherColumns(responses, indices, batchResponses);
+  }
+
+  if (!prefetch || begin + batchSize >= order.n_elem)
+    return;
+
+  nextBegin = begin + batchSize;
+  nextBatchSize = std::min(batchSize, size_t(order.n_elem - nextBegin));
+  const arma::uvec* orderPtr = &order;
+  const PredictorsType* predictorsPtr = &predictors;
+  const ResponsesType* responsesPtr = &responses;
+  pending = std::async(std::launch::async,
+      [this, orderPtr, predictorsPtr, responsesPtr]()
+      {
+        const arma::uvec indices = orderPtr->subvec(nextBegin,
+            nextBegin + nextBatchSize - 1);
+        GatherColumns(*predictorsPtr, indices, nextPredictors);
+        GatherColumns(*responsesPtr, indices, nextResponses);
+      });
+}
+
+template<typename PredictorsType, typename ResponsesType>
+void BatchPrefetcher<PredictorsType, ResponsesType>::Reset()
+{
+  if (pending.valid())
+    pending.wait();
+  pending = std::future<void>();
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
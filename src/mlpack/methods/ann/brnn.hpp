@@ -153,6 +153,23 @@ class BRNN
                arma::cube& results,
                const size_t batchSize = 256);
 
+  /**
+   * Predict the responses to a given set of sequences of different lengths,
+   * padded at the end to the number of time steps of the predictors.  The
+   * backward RNN reads each sequence from its own last time step, each batch
+   * is only run for the time steps of its longest sequence, and the responses
+   * past the end of each sequence are zero.
+   *
+   * @param predictors Input predictors.
+   * @param sequenceLengths Number of time steps of each sequence (column).
+   * @param results Matrix to put output predictions of responses into.
+   * @param batchSize Number of points to predict at once.
+   */
+  void Predict(arma::cube predictors,
+               const arma::urowvec& sequenceLengths,
+               arma::cube& results,
+               const size_t batchSize = 256);
+
   /**
    * Evaluate the bidirectional recurrent neural network with the given
    * parameters. This function is usually called by the optimizer to train
@@ -258,6 +275,29 @@ class BRNN
   //! Modify the maximum length of backpropagation through time.
   size_t& Rho() { return rho; }
 
+  /**
+   * Get the number of time steps of each sequence (data point) of the
+   * training data.  If set, the sequences are padded at the end to the number
+   * of time steps of the predictors; the backward RNN reads each sequence
+   * from its own last time step, each batch is only run for the time steps
+   * of its longest sequence, and the time steps past the end of a sequence
+   * add neither to the objective nor to the gradient.  Train() and Shuffle()
+   * sort the data points by decreasing length.  If empty (the default), every
+   * sequence has rho time steps.
+   */
+  const arma::urowvec& SequenceLengths() const { return sequenceLengths; }
+  //! Modify the number of time steps of each sequence of the training data.
+  arma::urowvec& SequenceLengths() { return sequenceLengths; }
+
+  /**
+   * Get whether the forward and the backward RNN run concurrently, on two
+   * threads (if OpenMP is available).  They only wait for each other at the
+   * merge layer.  This is the default.
+   */
+  bool Concurrent() const { return concurrent; }
+  //! Modify whether the forward and the backward RNN run concurrently.
+  bool& Concurrent() { return concurrent; }
+
   //! Get the matrix of responses to the input data points.
   const arma::cube& Responses() const { return responses; }
   //! Modify the matrix of responses to the input data points.
@@ -285,6 +325,10 @@ class BRNN
   void serialize(Archive& ar, const unsigned int /* version */);
 
  private:
+  //! Convenience typedef for the forward and the backward RNN.
+  typedef RNN<OutputLayerType, InitializationRuleType, CustomLayers...>
+      RNNType;
+
   // Helper functions.
   /**
    * Reset the module status by setting the current deterministic parameter
@@ -292,6 +336,79 @@ class BRNN
    */
   void ResetDeterministic();
 
+  /**
+   * Run the forward (direction 0) or the backward RNN (direction 1) over the
+   * given number of time steps of the batch [begin, begin + batchSize), and
+   * store the output of its last layer at each step.  The backward RNN reads
+   * reversedPredictors.  This only touches the given RNN, so both directions
+   * can run at the same time.
+   *
+   * @param direction 0 for the forward RNN, 1 for the backward RNN.
+   * @param predictors Input predictors of the forward RNN.
+   * @param begin Index of the first point of the batch.
+   * @param batchSize Number of points of the batch.
+   * @param steps Number of time steps to run.
+   * @param saveOutputs Whether to store the output of every layer for BPTT.
+   * @param results The outputs of the last layer, one matrix per step.
+   */
+  void ForwardDirection(const size_t direction,
+                        arma::cube& predictors,
+                        const size_t begin,
+                        const size_t batchSize,
+                        const size_t steps,
+                        const bool saveOutputs,
+                        std::vector<arma::mat>& results);
+
+  /**
+   * Run BPTT for the forward (direction 0) or the backward RNN (direction 1)
+   * after ForwardDirection() stored its outputs, and add its gradient to its
+   * half of the given gradient.  Like ForwardDirection(), both directions
+   * can run at the same time.
+   *
+   * @param direction 0 for the forward RNN, 1 for the backward RNN.
+   * @param begin Index of the first point of the batch.
+   * @param batchSize Number of points of the batch.
+   * @param steps Number of time steps the RNN ran.
+   * @param deltas The deltas of the merge layer in the order the RNN ran.
+   * @param gradient Gradient of all parameters of the network.
+   */
+  template<typename GradType>
+  void BackwardDirection(const size_t direction,
+                         const size_t begin,
+                         const size_t batchSize,
+                         const size_t steps,
+                         std::vector<arma::mat>& deltas,
+                         GradType& gradient);
+
+  /**
+   * Reverse each sequence of the given time steps from its own last time
+   * step: time step t of point j of the result is time step
+   * (length - 1 - t) of point j of the given steps, and zero past the end of
+   * the sequence.  Without sequence lengths, this only reverses the order of
+   * the time steps.
+   *
+   * @param steps The time steps of a batch, one matrix per time step.
+   * @param lengths The sequence lengths of all points, or empty.
+   * @param begin Index of the first point of the batch.
+   * @param reversed The reversed time steps.
+   */
+  static void ReverseSequences(const std::vector<arma::mat>& steps,
+                               const arma::urowvec& lengths,
+                               const size_t begin,
+                               std::vector<arma::mat>& reversed);
+
+  /**
+   * Reverse each sequence of the batch [begin, begin + batchSize) of the
+   * given predictors from its own last time step, like the other overload,
+   * for the first given number of time steps.
+   */
+  static void ReverseSequences(const arma::cube& predictors,
+                               const arma::urowvec& lengths,
+                               const size_t begin,
+                               const size_t batchSize,
+                               const size_t steps,
+                               arma::cube& reversed);
+
   //! Number of steps to backpropagate through time (BPTT).
   size_t rho;
 
@@ -329,6 +446,12 @@ class BRNN
   //! The matrix of responses to the input data points.
   arma::cube responses;
 
+  //! The number of time steps of each sequence of the training data.
+  arma::urowvec sequenceLengths;
+
+  //! The predictors of the current batch for the backward RNN.
+  arma::cube reversedPredictors;
+
   //! Matrix of (trained) parameters.
   arma::mat parameter;
 
@@ -365,20 +488,20 @@ class BRNN
   //! The current evaluation mode (training or testing).
   bool deterministic;
 
+  //! Whether the forward and the backward RNN run concurrently.
+  bool concurrent;
+
   //! The current gradient for the gradient pass for forward RNN.
   arma::mat forwardGradient;
 
   //! The current gradient for the gradient pass for backward RNN.
   arma::mat backwardGradient;
 
-  //! The total gradient from each gradient pass.
-  arma::mat totalGradient;
-
   //! Forward RNN
-  RNN<OutputLayerType, InitializationRuleType, CustomLayers...> forwardRNN;
+  RNNType forwardRNN;
 
   //! Backward RNN
-  RNN<OutputLayerType, InitializationRuleType, CustomLayers...> backwardRNN;
+  RNNType backwardRNN;
 }; // class BRNN
 
 } // namespace ann
@@ -54,6 +54,7 @@ BRNN<OutputLayerType, MergeLayerType, MergeOutputType,
     single(single),
     numFunctions(0),
     deterministic(true),
+    concurrent(true),
     forwardRNN(rho, single, outputLayer, initializeRule),
     backwardRNN(rho, single, outputLayer, initializeRule)
 {
@@ -70,11 +71,19 @@ double BRNN<OutputLayerType, MergeLayerType, MergeOutputType,
     arma::cube responses,
     OptimizerType& optimizer)
 {
+  forwardRNN.CheckSequenceLengths(sequenceLengths, predictors.n_cols,
+      predictors.n_slices);
   numFunctions = responses.n_cols;
 
   this->predictors = std::move(predictors);
   this->responses = std::move(responses);
 
+  if (!sequenceLengths.is_empty())
+  {
+    forwardRNN.SortSequences(this->predictors, this->responses,
+        sequenceLengths);
+  }
+
   this->deterministic = true;
   ResetDeterministic();
 
@@ -102,11 +111,19 @@ double BRNN<OutputLayerType, MergeLayerType, MergeOutputType,
     arma::cube predictors,
     arma::cube responses)
 {
+  forwardRNN.CheckSequenceLengths(sequenceLengths, predictors.n_cols,
+      predictors.n_slices);
   numFunctions = responses.n_cols;
 
   this->predictors = std::move(predictors);
   this->responses = std::move(responses);
 
+  if (!sequenceLengths.is_empty())
+  {
+    forwardRNN.SortSequences(this->predictors, this->responses,
+        sequenceLengths);
+  }
+
   this->deterministic = true;
   ResetDeterministic();
 
@@ -132,10 +149,22 @@ void BRNN<OutputLayerType, MergeLayerType, MergeOutputType,
     InitializationRuleType, CustomLayers...>::Predict(
     arma::cube predictors, arma::cube& results, const size_t batchSize)
 {
-  forwardRNN.rho = backwardRNN.rho = rho;
+  Predict(std::move(predictors), arma::urowvec(), results, batchSize);
+}
 
-  forwardRNN.ResetCells();
-  backwardRNN.ResetCells();
+template<typename OutputLayerType, typename MergeLayerType,
+         typename MergeOutputType, typename InitializationRuleType,
+         typename... CustomLayers>
+void BRNN<OutputLayerType, MergeLayerType, MergeOutputType,
+    InitializationRuleType, CustomLayers...>::Predict(
+    arma::cube predictors,
+    const arma::urowvec& sequenceLengths,
+    arma::cube& results,
+    const size_t batchSize)
+{
+  forwardRNN.CheckSequenceLengths(sequenceLengths, predictors.n_cols,
+      predictors.n_slices);
+  forwardRNN.rho = backwardRNN.rho = rho;
 
   if (!deterministic)
   {
@@ -156,7 +185,7 @@ void BRNN<OutputLayerType, MergeLayerType, MergeOutputType,
     results = arma::zeros<arma::cube>(outputSize, predictors.n_cols, rho);
   }
 
-  std::vector<arma::mat> results1, results2;
+  std::vector<arma::mat> results1, results2, reversedResults;
   arma::mat input;
 
   // Forward both RNN's from opposite directions.
@@ -164,29 +193,40 @@ void BRNN<OutputLayerType, MergeLayerType, MergeOutputType,
   {
     const size_t effectiveBatchSize = std::min(batchSize,
         size_t(predictors.n_cols - begin));
-    for (size_t seqNum = 0; seqNum < rho; ++seqNum)
+    const size_t steps = forwardRNN.BatchSteps(sequenceLengths, begin,
+        effectiveBatchSize, rho);
+    // With sequence lengths every batch starts a new sequence.
+    if (begin == 0 || !sequenceLengths.is_empty())
     {
-      forwardRNN.Forward(std::move(arma::mat(
-          predictors.slice(seqNum).colptr(begin),
-          predictors.n_rows, effectiveBatchSize, false, true)));
-      backwardRNN.Forward(std::move(arma::mat(
-          predictors.slice(rho - seqNum - 1).colptr(begin),
-          predictors.n_rows, effectiveBatchSize, false, true)));
-
-      boost::apply_visitor(SaveOutputParameterVisitor(
-          std::move(results1)), forwardRNN.network.back());
-      boost::apply_visitor(SaveOutputParameterVisitor(
-          std::move(results2)), backwardRNN.network.back());
+      forwardRNN.ResetCells(steps);
+      backwardRNN.ResetCells(steps);
+    }
+
+    ReverseSequences(predictors, sequenceLengths, begin, effectiveBatchSize,
+        steps, reversedPredictors);
+    // The two directions are independent until the merge layer, so they run
+    // on two threads.
+    #pragma omp parallel for num_threads(concurrent ? 2 : 1)
+    for (omp_size_t direction = 0; direction < 2; ++direction)
+    {
+      ForwardDirection(direction, predictors, begin, effectiveBatchSize,
+          steps, false, (direction == 0) ? results1 : results2);
     }
     reverse(results1.begin(), results1.end());
 
+    // Line the outputs of the backward RNN up with the time steps of the
+    // sequences; they are loaded from the back.
+    ReverseSequences(results2, sequenceLengths, begin, reversedResults);
+    reverse(reversedResults.begin(), reversedResults.end());
+    results2.clear();
+
     // Forward outputs from both RNN's through merge layer for each time step.
-    for (size_t seqNum = 0; seqNum < rho; ++seqNum)
+    for (size_t seqNum = 0; seqNum < steps; ++seqNum)
     {
       boost::apply_visitor(LoadOutputParameterVisitor(
           std::move(results1)), forwardRNN.network.back());
       boost::apply_visitor(LoadOutputParameterVisitor(
-          std::move(results2)), backwardRNN.network.back());
+          std::move(reversedResults)), backwardRNN.network.back());
 
       boost::apply_visitor(ForwardVisitor(std::move(input),
           std::move(boost::apply_visitor(outputParameterVisitor, mergeLayer))),
@@ -199,6 +239,14 @@ void BRNN<OutputLayerType, MergeLayerType, MergeOutputType,
           effectiveBatchSize - 1) =
           boost::apply_visitor(outputParameterVisitor, mergeOutput);
     }
+
+    // The responses past the end of each sequence are zero.
+    for (size_t i = begin; i < begin + effectiveBatchSize &&
+        !sequenceLengths.is_empty(); ++i)
+    {
+      for (size_t seqNum = sequenceLengths[i]; seqNum < steps; ++seqNum)
+        results.slice(seqNum).col(i).zeros();
+    }
   }
 }
 
@@ -234,26 +282,24 @@ double BRNN<OutputLayerType, MergeLayerType, MergeOutputType,
     targetSize = responses.n_rows;
   }
 
-  forwardRNN.ResetCells();
-  backwardRNN.ResetCells();
+  const size_t steps = forwardRNN.BatchSteps(sequenceLengths, begin,
+      batchSize, rho);
+  forwardRNN.ResetCells(steps);
+  backwardRNN.ResetCells(steps);
+  ReverseSequences(predictors, sequenceLengths, begin, batchSize, steps,
+      reversedPredictors);
 
   double performance = 0;
   size_t responseSeq = 0;
 
-  std::vector<arma::mat> results1, results2;
-  for (size_t seqNum = 0; seqNum < rho; ++seqNum)
+  std::vector<arma::mat> results1, results2, reversedResults;
+  // The two directions are independent until the merge layer, so they run
+  // on two threads.
+  #pragma omp parallel for num_threads(concurrent ? 2 : 1)
+  for (omp_size_t direction = 0; direction < 2; ++direction)
   {
-    forwardRNN.Forward(std::move(arma::mat(
-        predictors.slice(seqNum).colptr(begin),
-        predictors.n_rows, batchSize, false, true)));
-    backwardRNN.Forward(std::move(arma::mat(
-        predictors.slice(rho - seqNum - 1).colptr(begin),
-        predictors.n_rows, batchSize, false, true)));
-
-    boost::apply_visitor(SaveOutputParameterVisitor(
-        std::move(results1)), forwardRNN.network.back());
-    boost::apply_visitor(SaveOutputParameterVisitor(
-        std::move(results2)), backwardRNN.network.back());
+    ForwardDirection(direction, predictors, begin, batchSize, steps, false,
+        (direction == 0) ? results1 : results2);
   }
   if (outputSize == 0)
   {
@@ -262,10 +308,12 @@ double BRNN<OutputLayerType, MergeLayerType, MergeOutputType,
     forwardRNN.outputSize = backwardRNN.outputSize = outputSize;
   }
   reverse(results1.begin(), results1.end());
+  ReverseSequences(results2, sequenceLengths, begin, reversedResults);
+  reverse(reversedResults.begin(), reversedResults.end());
 
   // Performance calculation after forwarding through merge layer.
   arma::mat input;
-  for (size_t seqNum = 0; seqNum < rho; ++seqNum)
+  for (size_t seqNum = 0; seqNum < steps; ++seqNum)
   {
     if (!single)
     {
@@ -274,7 +322,7 @@ double BRNN<OutputLayerType, MergeLayerType, MergeOutputType,
     boost::apply_visitor(LoadOutputParameterVisitor(
         std::move(results1)), forwardRNN.network.back());
     boost::apply_visitor(LoadOutputParameterVisitor(
-        std::move(results2)), backwardRNN.network.back());
+        std::move(reversedResults)), backwardRNN.network.back());
 
     boost::apply_visitor(ForwardVisitor(std::move(input),
         std::move(boost::apply_visitor(outputParameterVisitor, mergeLayer))),
@@ -283,10 +331,16 @@ double BRNN<OutputLayerType, MergeLayerType, MergeOutputType,
         std::move(boost::apply_visitor(outputParameterVisitor, mergeLayer)),
         std::move(boost::apply_visitor(outputParameterVisitor, mergeOutput))),
         mergeOutput);
-    performance += outputLayer.Forward(std::move(
-        boost::apply_visitor(outputParameterVisitor, mergeOutput)),
+
+    // Only the sequences still running add to the objective.
+    const size_t active = forwardRNN.ActivePoints(sequenceLengths, begin,
+        batchSize, steps, seqNum);
+    arma::mat& output = boost::apply_visitor(outputParameterVisitor,
+        mergeOutput);
+    performance += outputLayer.Forward(std::move(arma::mat(output.memptr(),
+        output.n_rows, active, false, true)),
         std::move(arma::mat(responses.slice(responseSeq).colptr(begin),
-        responses.n_rows, batchSize, false, true)));
+        responses.n_rows, active, false, true)));
   }
   return performance;
 }
@@ -353,32 +407,22 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
     targetSize = responses.n_rows;
   }
 
-  forwardRNN.ResetCells();
-  backwardRNN.ResetCells();
-  size_t networkSize = backwardRNN.network.size();
+  const size_t steps = forwardRNN.BatchSteps(sequenceLengths, begin,
+      batchSize, rho);
+  forwardRNN.ResetCells(steps);
+  backwardRNN.ResetCells(steps);
+  ReverseSequences(predictors, sequenceLengths, begin, batchSize, steps,
+      reversedPredictors);
 
   // Forward propogation from both directions.
-  std::vector<arma::mat> results1, results2;
-  for (size_t seqNum = 0; seqNum < rho; ++seqNum)
+  std::vector<arma::mat> results1, results2, reversedResults;
+  // The two directions are independent until the merge layer, so they run
+  // on two threads.
+  #pragma omp parallel for num_threads(concurrent ? 2 : 1)
+  for (omp_size_t direction = 0; direction < 2; ++direction)
   {
-    forwardRNN.Forward(std::move(arma::mat(
-        predictors.slice(seqNum).colptr(begin),
-        predictors.n_rows, batchSize, false, true)));
-    backwardRNN.Forward(std::move(arma::mat(
-        predictors.slice(rho - seqNum - 1).colptr(begin),
-        predictors.n_rows, batchSize, false, true)));
-
-    for (size_t l = 0; l < networkSize; ++l)
-    {
-      boost::apply_visitor(SaveOutputParameterVisitor(
-          std::move(forwardRNNOutputParameter)), forwardRNN.network[l]);
-      boost::apply_visitor(SaveOutputParameterVisitor(
-          std::move(backwardRNNOutputParameter)), backwardRNN.network[l]);
-    }
-    boost::apply_visitor(SaveOutputParameterVisitor(
-        std::move(results1)), forwardRNN.network.back());
-    boost::apply_visitor(SaveOutputParameterVisitor(
-        std::move(results2)), backwardRNN.network.back());
+    ForwardDirection(direction, predictors, begin, batchSize, steps, true,
+        (direction == 0) ? results1 : results2);
   }
   if (outputSize == 0)
   {
@@ -390,11 +434,11 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
   arma::cube results;
   if (std::is_same<MergeLayerType, Concat<>>::value)
   {
-    results = arma::zeros<arma::cube>(outputSize * 2, batchSize, rho);
+    results = arma::zeros<arma::cube>(outputSize * 2, batchSize, steps);
   }
   else
   {
-    results = arma::zeros<arma::cube>(outputSize, batchSize, rho);
+    results = arma::zeros<arma::cube>(outputSize, batchSize, steps);
   }
 
   double performance = 0;
@@ -402,8 +446,10 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
   arma::mat input;
 
   reverse(results1.begin(), results1.end());
+  ReverseSequences(results2, sequenceLengths, begin, reversedResults);
+  reverse(reversedResults.begin(), reversedResults.end());
   // Performance calculation here.
-  for (size_t seqNum = 0; seqNum < rho; ++seqNum)
+  for (size_t seqNum = 0; seqNum < steps; ++seqNum)
   {
     if (!single)
     {
@@ -412,24 +458,31 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
     boost::apply_visitor(LoadOutputParameterVisitor(
           std::move(results1)), forwardRNN.network.back());
     boost::apply_visitor(LoadOutputParameterVisitor(
-          std::move(results2)), backwardRNN.network.back());
+          std::move(reversedResults)), backwardRNN.network.back());
     boost::apply_visitor(ForwardVisitor(std::move(input),
         std::move(boost::apply_visitor(outputParameterVisitor, mergeLayer))),
         mergeLayer);
     boost::apply_visitor(ForwardVisitor(
         std::move(boost::apply_visitor(outputParameterVisitor, mergeLayer)),
         std::move(results.slice(seqNum))), mergeOutput);
-    performance += outputLayer.Forward(std::move(results.slice(seqNum)),
+
+    // Only the sequences still running add to the objective.
+    const size_t active = forwardRNN.ActivePoints(sequenceLengths, begin,
+        batchSize, steps, seqNum);
+    performance += outputLayer.Forward(std::move(arma::mat(
+        results.slice(seqNum).memptr(), results.n_rows, active, false, true)),
         std::move(arma::mat(responses.slice(responseSeq).colptr(begin),
-        responses.n_rows, batchSize, false, true)));
+        responses.n_rows, active, false, true)));
   }
 
   // Calculate and storing delta parameters from output for t = 1 to T.
-  arma::mat delta;
+  arma::mat delta, activeError;
   std::vector<arma::mat> allDelta;
 
-  for (size_t seqNum = 0; seqNum < rho; ++seqNum)
+  for (size_t seqNum = 0; seqNum < steps; ++seqNum)
   {
+    const size_t active = forwardRNN.ActivePoints(sequenceLengths, begin,
+        batchSize, steps, seqNum);
     if (single && seqNum > 0)
     {
       error.zeros();
@@ -440,99 +493,41 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
           std::move(arma::mat(responses.slice(0).colptr(begin),
           responses.n_rows, batchSize, false, true)), std::move(error));
     }
-    else
+    else if (active == batchSize)
     {
       outputLayer.Backward(std::move(results.slice(seqNum)),
           std::move(arma::mat(responses.slice(seqNum).colptr(begin),
           responses.n_rows, batchSize, false, true)), std::move(error));
     }
+    else
+    {
+      // The sequences that already ended get no error.
+      outputLayer.Backward(std::move(arma::mat(results.slice(seqNum).memptr(),
+          results.n_rows, active, false, true)),
+          std::move(arma::mat(responses.slice(seqNum).colptr(begin),
+          responses.n_rows, active, false, true)), std::move(activeError));
+      error.zeros(activeError.n_rows, batchSize);
+      error.cols(0, active - 1) = activeError;
+    }
 
     boost::apply_visitor(BackwardVisitor(std::move(results.slice(seqNum)),
         std::move(error), std::move(delta)), mergeOutput);
     allDelta.push_back(arma::mat(delta));
   }
 
-  // BPTT ForwardRNN from t = T to 1.
-  totalGradient = arma::mat(gradient.memptr(),
-      parameter.n_elem/2, 1, false, false);
-
-  forwardGradient.zeros();
-  forwardRNN.ResetGradients(forwardGradient);
-  backwardGradient.zeros();
-  backwardRNN.ResetGradients(backwardGradient);
+  // The backward RNN gets the deltas of each sequence from its own last time
+  // step on.
+  std::vector<arma::mat> backwardDelta;
+  ReverseSequences(allDelta, sequenceLengths, begin, backwardDelta);
 
-  for (size_t seqNum = 0; seqNum < rho; ++seqNum)
+  // BPTT of both directions, again on two threads.
+  #pragma omp parallel for num_threads(concurrent ? 2 : 1)
+  for (omp_size_t direction = 0; direction < 2; ++direction)
   {
-    forwardGradient.zeros();
-    for (size_t l = 0; l < networkSize; ++l)
-    {
-      boost::apply_visitor(LoadOutputParameterVisitor(
-          std::move(forwardRNNOutputParameter)),
-          forwardRNN.network[networkSize - 1 - l]);
-    }
-    boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-        outputParameterVisitor, forwardRNN.network.back())),
-        std::move(allDelta[rho - seqNum - 1]), std::move(delta), 0),
-        mergeLayer);
-
-    for (size_t i = 2; i < networkSize; ++i)
-    {
-      boost::apply_visitor(BackwardVisitor(
-          std::move(boost::apply_visitor(outputParameterVisitor,
-          forwardRNN.network[networkSize - i])),
-          std::move(boost::apply_visitor(deltaVisitor,
-          forwardRNN.network[networkSize - i + 1])), std::move(
-          boost::apply_visitor(deltaVisitor,
-          forwardRNN.network[networkSize - i]))),
-          forwardRNN.network[networkSize - i]);
-    }
-    forwardRNN.Gradient(std::move(
-        arma::mat(predictors.slice(rho - seqNum - 1).colptr(begin),
-        predictors.n_rows, batchSize, false, true)));
-    boost::apply_visitor(GradientVisitor(
-        std::move(boost::apply_visitor(outputParameterVisitor,
-        forwardRNN.network[networkSize - 2])),
-        std::move(allDelta[rho - seqNum - 1]), 0), mergeLayer);
-    totalGradient += forwardGradient;
+    BackwardDirection(direction, begin, batchSize, steps,
+        (direction == 0) ? allDelta : backwardDelta, gradient);
   }
 
-  // BPTT BackwardRNN from t = 1 to T.
-  totalGradient = arma::mat(gradient.memptr() + parameter.n_elem/2,
-      parameter.n_elem/2, 1, false, false);
-
-  for (size_t seqNum = 0; seqNum < rho; ++seqNum)
-  {
-    backwardGradient.zeros();
-    for (size_t l = 0; l < networkSize; ++l)
-    {
-      boost::apply_visitor(LoadOutputParameterVisitor(
-          std::move(backwardRNNOutputParameter)),
-          backwardRNN.network[networkSize - 1 - l]);
-    }
-    boost::apply_visitor(BackwardVisitor(std::move(
-        boost::apply_visitor(outputParameterVisitor,
-        backwardRNN.network.back())),
-        std::move(allDelta[seqNum]), std::move(delta), 1), mergeLayer);
-    for (size_t i = 2; i < networkSize; ++i)
-    {
-      boost::apply_visitor(BackwardVisitor(
-        std::move(boost::apply_visitor(outputParameterVisitor,
-        backwardRNN.network[networkSize - i])), std::move(boost::apply_visitor(
-        deltaVisitor, backwardRNN.network[networkSize - i + 1])), std::move(
-        boost::apply_visitor(deltaVisitor,
-        backwardRNN.network[networkSize - i]))),
-        backwardRNN.network[networkSize - i]);
-    }
-
-    backwardRNN.Gradient(std::move(
-        arma::mat(predictors.slice(seqNum).colptr(begin),
-        predictors.n_rows, batchSize, false, true)));
-    boost::apply_visitor(GradientVisitor(
-        std::move(boost::apply_visitor(outputParameterVisitor,
-        backwardRNN.network[networkSize - 2])),
-        std::move(allDelta[seqNum]), 1), mergeLayer);
-    totalGradient += backwardGradient;
-  }
   return performance;
 }
 
@@ -555,6 +550,17 @@ template<typename OutputLayerType, typename MergeLayerType,
 void BRNN<OutputLayerType, MergeLayerType, MergeOutputType,
     InitializationRuleType, CustomLayers...>::Shuffle()
 {
+  if (!sequenceLengths.is_empty())
+  {
+    // Sort the shuffled points by length again, so only points of the same
+    // length change their order.
+    forwardRNN.PermutePoints(predictors, responses, sequenceLengths,
+        arma::shuffle(arma::linspace<arma::uvec>(0, predictors.n_cols - 1,
+        predictors.n_cols)));
+    forwardRNN.SortSequences(predictors, responses, sequenceLengths);
+    return;
+  }
+
   arma::cube newPredictors, newResponses;
   math::ShuffleData(predictors, responses, newPredictors, newResponses);
 
@@ -634,8 +640,8 @@ void BRNN<OutputLayerType, MergeLayerType, MergeOutputType,
     InitializationRuleType, CustomLayers...>::Reset()
 {
   ResetParameters();
-  forwardRNN.ResetCells();
-  backwardRNN.ResetCells();
+  forwardRNN.ResetCells(rho);
+  backwardRNN.ResetCells(rho);
   forwardGradient.zeros();
   forwardRNN.ResetGradients(forwardGradient);
   backwardGradient.zeros();
@@ -654,6 +660,163 @@ void BRNN<OutputLayerType, MergeLayerType, MergeOutputType,
   backwardRNN.ResetDeterministic();
 }
 
+template<typename OutputLayerType, typename MergeLayerType,
+         typename MergeOutputType, typename InitializationRuleType,
+         typename... CustomLayers>
+void BRNN<OutputLayerType, MergeLayerType, MergeOutputType,
+    InitializationRuleType, CustomLayers...>::ForwardDirection(
+    const size_t direction,
+    arma::cube& predictors,
+    const size_t begin,
+    const size_t batchSize,
+    const size_t steps,
+    const bool saveOutputs,
+    std::vector<arma::mat>& results)
+{
+  RNNType& rnn = (direction == 0) ? forwardRNN : backwardRNN;
+  std::vector<arma::mat>& outputParameter = (direction == 0) ?
+      forwardRNNOutputParameter : backwardRNNOutputParameter;
+
+  for (size_t seqNum = 0; seqNum < steps; ++seqNum)
+  {
+    // The backward RNN reads the reversed sequences of the batch.
+    rnn.Forward(std::move(arma::mat((direction == 0) ?
+        predictors.slice(seqNum).colptr(begin) :
+        reversedPredictors.slice(seqNum).memptr(),
+        predictors.n_rows, batchSize, false, true)));
+
+    if (saveOutputs)
+    {
+      for (size_t l = 0; l < rnn.network.size(); ++l)
+      {
+        boost::apply_visitor(SaveOutputParameterVisitor(
+            std::move(outputParameter)), rnn.network[l]);
+      }
+    }
+
+    boost::apply_visitor(SaveOutputParameterVisitor(std::move(results)),
+        rnn.network.back());
+  }
+}
+
+template<typename OutputLayerType, typename MergeLayerType,
+         typename MergeOutputType, typename InitializationRuleType,
+         typename... CustomLayers>
+template<typename GradType>
+void BRNN<OutputLayerType, MergeLayerType, MergeOutputType,
+    InitializationRuleType, CustomLayers...>::BackwardDirection(
+    const size_t direction,
+    const size_t begin,
+    const size_t batchSize,
+    const size_t steps,
+    std::vector<arma::mat>& deltas,
+    GradType& gradient)
+{
+  RNNType& rnn = (direction == 0) ? forwardRNN : backwardRNN;
+  std::vector<arma::mat>& outputParameter = (direction == 0) ?
+      forwardRNNOutputParameter : backwardRNNOutputParameter;
+  arma::mat& rnnGradient = (direction == 0) ? forwardGradient :
+      backwardGradient;
+  const size_t networkSize = rnn.network.size();
+
+  // Each direction has its own half of the parameters.
+  arma::mat totalGradient(gradient.memptr() + direction * parameter.n_elem / 2,
+      parameter.n_elem / 2, 1, false, false);
+  arma::mat delta;
+
+  rnnGradient.zeros();
+  rnn.ResetGradients(rnnGradient);
+
+  // The steps are taken in the reverse order the RNN ran them.
+  for (size_t seqNum = 0; seqNum < steps; ++seqNum)
+  {
+    const size_t step = steps - seqNum - 1;
+    rnnGradient.zeros();
+    for (size_t l = 0; l < networkSize; ++l)
+    {
+      boost::apply_visitor(LoadOutputParameterVisitor(
+          std::move(outputParameter)), rnn.network[networkSize - 1 - l]);
+    }
+
+    // The merge layer only passes the part of the delta that belongs to this
+    // direction on to its last layer.
+    boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
+        outputParameterVisitor, rnn.network.back())), std::move(deltas[step]),
+        std::move(delta), direction), mergeLayer);
+
+    for (size_t i = 2; i < networkSize; ++i)
+    {
+      boost::apply_visitor(BackwardVisitor(
+          std::move(boost::apply_visitor(outputParameterVisitor,
+          rnn.network[networkSize - i])),
+          std::move(boost::apply_visitor(deltaVisitor,
+          rnn.network[networkSize - i + 1])), std::move(
+          boost::apply_visitor(deltaVisitor,
+          rnn.network[networkSize - i]))),
+          rnn.network[networkSize - i]);
+    }
+
+    rnn.Gradient(std::move(arma::mat((direction == 0) ?
+        predictors.slice(step).colptr(begin) :
+        reversedPredictors.slice(step).memptr(),
+        predictors.n_rows, batchSize, false, true)));
+    boost::apply_visitor(GradientVisitor(
+        std::move(boost::apply_visitor(outputParameterVisitor,
+        rnn.network[networkSize - 2])),
+        std::move(deltas[step]), direction), mergeLayer);
+    totalGradient += rnnGradient;
+  }
+}
+
+template<typename OutputLayerType, typename MergeLayerType,
+         typename MergeOutputType, typename InitializationRuleType,
+         typename... CustomLayers>
+void BRNN<OutputLayerType, MergeLayerType, MergeOutputType,
+    InitializationRuleType, CustomLayers...>::ReverseSequences(
+    const std::vector<arma::mat>& steps,
+    const arma::urowvec& lengths,
+    const size_t begin,
+    std::vector<arma::mat>& reversed)
+{
+  reversed.resize(steps.size());
+  for (size_t t = 0; t < steps.size(); ++t)
+  {
+    reversed[t].zeros(steps[t].n_rows, steps[t].n_cols);
+    for (size_t j = 0; j < steps[t].n_cols; ++j)
+    {
+      const size_t length = lengths.is_empty() ? steps.size() :
+          std::min(size_t(lengths[begin + j]), steps.size());
+      if (t < length)
+        reversed[t].col(j) = steps[length - 1 - t].col(j);
+    }
+  }
+}
+
+template<typename OutputLayerType, typename MergeLayerType,
+         typename MergeOutputType, typename InitializationRuleType,
+         typename... CustomLayers>
+void BRNN<OutputLayerType, MergeLayerType, MergeOutputType,
+    InitializationRuleType, CustomLayers...>::ReverseSequences(
+    const arma::cube& predictors,
+    const arma::urowvec& lengths,
+    const size_t begin,
+    const size_t batchSize,
+    const size_t steps,
+    arma::cube& reversed)
+{
+  reversed.zeros(predictors.n_rows, batchSize, steps);
+  for (size_t j = 0; j < batchSize; ++j)
+  {
+    const size_t length = lengths.is_empty() ? steps :
+        std::min(size_t(lengths[begin + j]), steps);
+    for (size_t t = 0; t < length; ++t)
+    {
+      reversed.slice(t).col(j) = predictors.slice(length - 1 - t).col(
+          begin + j);
+    }
+  }
+}
+
 template<typename OutputLayerType, typename MergeLayerType,
          typename MergeOutputType, typename InitializationRuleType,
          typename... CustomLayers>
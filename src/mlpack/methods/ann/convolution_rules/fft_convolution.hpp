@@ -19,6 +19,26 @@
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
+/**
+ * The spectra of a set of filters, zero-padded to a working size, together
+ * with a copy of the filters they were computed from.  BatchForward() of
+ * FFTConvolution keeps the spectra as long as neither the filters nor the
+ * working size change, so that they are only transformed again after the
+ * weights were updated.
+ *
+ * @tparam eT Type of the filter elements.
+ */
+template<typename eT>
+class FFTFilterSpectra
+{
+ public:
+  //! The filters the spectra were computed from.
+  arma::Cube<eT> filter;
+
+  //! The spectrum of each padded filter.
+  arma::Cube<std::complex<eT> > spectra;
+};
+
 /**
  * Computes the two-dimensional convolution through fft. This class allows
  * specification of the type of the border type. The convolution can be
@@ -28,6 +48,10 @@ namespace ann /** Artificial Neural Network. */ {
  * ValidConvolution: returns only those parts of the convolution that are
  * computed without the zero-padded edges.
  *
+ * The Convolution layer recognizes this rule as its forward rule, and then
+ * uses BatchForward() instead, which transforms every input map once per
+ * point and caches the spectra of the filters between calls.
+ *
  * @tparam BorderMode Type of the border mode (FullConvolution or
  * ValidConvolution).
  * @tparam padLastDim Pad the last dimension of the input to to turn it from
@@ -47,13 +71,17 @@ class FFTConvolution
    * @param input Input used to perform the convolution.
    * @param filter Filter used to perform the convolution.
    * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
    */
   template<typename eT, typename Border = BorderMode>
   static typename std::enable_if<
       std::is_same<Border, ValidConvolution>::value, void>::type
   Convolution(const arma::Mat<eT>& input,
               const arma::Mat<eT>& filter,
-              arma::Mat<eT>& output)
+              arma::Mat<eT>& output,
+              const size_t dW = 1,
+              const size_t dH = 1)
   {
     arma::Mat<eT> inputPadded = input;
     arma::Mat<eT> filterPadded = filter;
@@ -69,8 +97,9 @@ class FFTConvolution
 
     // Extract the region of interest. We don't need to handle the padLastDim in
     // a special way we just cut it out from the output matrix.
-    output = temp.submat(filter.n_rows - 1, filter.n_cols - 1,
-        input.n_rows - 1, input.n_cols - 1);
+    Extract(temp, filter.n_rows - 1, filter.n_cols - 1,
+        input.n_rows - filter.n_rows + 1, input.n_cols - filter.n_cols + 1,
+        dW, dH, output);
   }
 
   /*
@@ -82,13 +111,17 @@ class FFTConvolution
    * @param input Input used to perform the convolution.
    * @param filter Filter used to perform the convolution.
    * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
    */
   template<typename eT, typename Border = BorderMode>
   static typename std::enable_if<
       std::is_same<Border, FullConvolution>::value, void>::type
   Convolution(const arma::Mat<eT>& input,
               const arma::Mat<eT>& filter,
-              arma::Mat<eT>& output)
+              arma::Mat<eT>& output,
+              const size_t dW = 1,
+              const size_t dH = 1)
   {
     // In case of the full convolution outputRows and outputCols doesn't
     // represent the true output size when the padLastDim parameter is set,
@@ -115,9 +148,9 @@ class FFTConvolution
 
     // Extract the region of interest. We don't need to handle the padLastDim
     // parameter in a special way we just cut it out from the output matrix.
-    output = temp.submat(filter.n_rows - 1, filter.n_cols - 1,
-        2 * (filter.n_rows - 1) + input.n_rows - 1,
-        2 * (filter.n_cols - 1) + input.n_cols - 1);
+    Extract(temp, filter.n_rows - 1, filter.n_cols - 1,
+        input.n_rows + filter.n_rows - 1, input.n_cols + filter.n_cols - 1,
+        dW, dH, output);
   }
 
   /*
@@ -209,8 +242,149 @@ class FFTConvolution
           output.slice(i));
     }
   }
+
+  /**
+   * Perform the forward pass of a convolution layer (valid mode) for all
+   * points of a batch.  Unlike Convolution(), this computes the correlation
+   * with the filters, like NaiveConvolution, so that it can be combined with
+   * the backward and gradient rules of the layer.
+   *
+   * The input maps of each point are transformed once and reused for every
+   * output map, the products are summed over the input maps in the frequency
+   * domain, and only one inverse transform is done per output map.  The
+   * spectra of the filters are taken from the given cache, and only computed
+   * again when the filters or the input size changed.
+   *
+   * @param input The input maps; inSize slices per point.
+   * @param weight The filters, with slice (outMap * inSize + inMap).
+   * @param bias The bias of each output map.
+   * @param batchSize The number of points in the batch.
+   * @param output The output maps, outSize slices per point; has to be
+   *     allocated with the output size already.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   * @param cache The cached filter spectra.
+   */
+  template<typename eT>
+  static void BatchForward(const arma::Cube<eT>& input,
+                           const arma::Cube<eT>& weight,
+                           const arma::Mat<eT>& bias,
+                           const size_t batchSize,
+                           arma::Cube<eT>& output,
+                           const size_t dW,
+                           const size_t dH,
+                           FFTFilterSpectra<eT>& cache)
+  {
+    const size_t inSize = input.n_slices / batchSize;
+    const size_t outSize = output.n_slices / batchSize;
+
+    if (cache.spectra.n_rows != input.n_rows ||
+        cache.spectra.n_cols != input.n_cols ||
+        cache.filter.n_rows != weight.n_rows ||
+        cache.filter.n_cols != weight.n_cols ||
+        cache.filter.n_slices != weight.n_slices ||
+        !std::equal(weight.begin(), weight.end(), cache.filter.begin()))
+    {
+      // Rotate the filters by 180 degrees, so that the convolution through
+      // the fft computes the correlation.
+      cache.filter = weight;
+      cache.spectra.set_size(input.n_rows, input.n_cols, weight.n_slices);
+      arma::Mat<eT> filterPadded(input.n_rows, input.n_cols);
+      for (size_t i = 0; i < weight.n_slices; ++i)
+      {
+        filterPadded.zeros();
+        filterPadded.submat(0, 0, weight.n_rows - 1, weight.n_cols - 1) =
+            arma::flipud(arma::fliplr(weight.slice(i)));
+        cache.spectra.slice(i) = arma::fft2(filterPadded);
+      }
+    }
+
+    arma::Cube<std::complex<eT> > inputSpectra(input.n_rows, input.n_cols,
+        inSize);
+    arma::Mat<std::complex<eT> > sum;
+    arma::Mat<eT> temp;
+    for (size_t p = 0; p < batchSize; ++p)
+    {
+      for (size_t inMap = 0; inMap < inSize; ++inMap)
+        inputSpectra.slice(inMap) = arma::fft2(input.slice(p * inSize + inMap));
+
+      for (size_t outMap = 0; outMap < outSize; ++outMap)
+      {
+        sum = inputSpectra.slice(0) % cache.spectra.slice(outMap * inSize);
+        for (size_t inMap = 1; inMap < inSize; ++inMap)
+        {
+          sum += inputSpectra.slice(inMap) %
+              cache.spectra.slice(outMap * inSize + inMap);
+        }
+
+        temp = arma::real(arma::ifft2(sum));
+
+        arma::Mat<eT>& outputMap = output.slice(p * outSize + outMap);
+        for (size_t j = 0; j < outputMap.n_cols; ++j)
+        {
+          for (size_t i = 0; i < outputMap.n_rows; ++i)
+          {
+            outputMap(i, j) = temp(weight.n_rows - 1 + i * dW,
+                weight.n_cols - 1 + j * dH) + bias(outMap);
+          }
+        }
+      }
+    }
+  }
+
+ private:
+  /*
+   * Extract the given region from the result of the inverse transform, and
+   * keep only every dW-th row and every dH-th column of it.
+   *
+   * @param temp The result of the inverse transform.
+   * @param row The first row of the region.
+   * @param col The first column of the region.
+   * @param rows The number of rows of the region.
+   * @param cols The number of columns of the region.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   * @param output The extracted region.
+   */
+  template<typename eT>
+  static void Extract(const arma::Mat<eT>& temp,
+                      const size_t row,
+                      const size_t col,
+                      const size_t rows,
+                      const size_t cols,
+                      const size_t dW,
+                      const size_t dH,
+                      arma::Mat<eT>& output)
+  {
+    if (dW == 1 && dH == 1)
+    {
+      output = temp.submat(row, col, row + rows - 1, col + cols - 1);
+      return;
+    }
+
+    output.set_size((rows - 1) / dW + 1, (cols - 1) / dH + 1);
+    for (size_t j = 0; j < output.n_cols; ++j)
+      for (size_t i = 0; i < output.n_rows; ++i)
+        output(i, j) = temp(row + i * dW, col + j * dH);
+  }
 };  // class FFTConvolution
 
+/**
+ * Whether the given convolution rule is FFTConvolution, whose batched
+ * forward pass the Convolution layer uses.
+ */
+template<typename ConvolutionRule>
+struct IsFFTConvolution
+{
+  static const bool value = false;
+};
+
+template<typename BorderMode, bool padLastDim>
+struct IsFFTConvolution<FFTConvolution<BorderMode, padLastDim>>
+{
+  static const bool value = true;
+};
+
 } // namespace ann
 } // namespace mlpack
 
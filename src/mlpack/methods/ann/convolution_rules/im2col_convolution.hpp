@@ -0,0 +1,423 @@
+/**
+ * @file im2col_convolution.hpp
+ *
+ * Implementation of the convolution through im2col and matrix
+ * multiplication.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_CONVOLUTION_RULES_IM2COL_CONVOLUTION_HPP
+#define MLPACK_METHODS_ANN_CONVOLUTION_RULES_IM2COL_CONVOLUTION_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "border_modes.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * Computes the two-dimensional convolution by unfolding the patches of the
+ * input into the columns of a matrix (im2col), so that the convolution becomes
+ * a matrix product.  This class allows specification of the type of the
+ * border type. The convolution can be computed with the valid border type or
+ * the full border type (default).
+ *
+ * Used as a rule of a single convolution, this computes the same result as
+ * NaiveConvolution when the strides are equal in both directions, and so are
+ * the dilations.  The Convolution and AtrousConvolution layers recognize
+ * this rule, and then use BatchForward(), BatchBackward(), and BatchGradient()
+ * instead, which handle all maps of a point with one matrix multiplication.
+ *
+ * FullConvolution: returns the full two-dimensional convolution.
+ * ValidConvolution: returns only those parts of the convolution that are
+ * computed without the zero-padded edges.
+ *
+ * @tparam BorderMode Type of the border mode (FullConvolution or
+ * ValidConvolution).
+ */
+template<typename BorderMode = FullConvolution>
+class Im2ColConvolution
+{
+ public:
+  /*
+   * Perform a convolution (valid mode).
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the convolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   * @param dilationW The dilation factor in x direction.
+   * @param dilationH The dilation factor in y direction.
+   */
+  template<typename eT, typename Border = BorderMode>
+  static typename std::enable_if<
+      std::is_same<Border, ValidConvolution>::value, void>::type
+  Convolution(const arma::Mat<eT>& input,
+              const arma::Mat<eT>& filter,
+              arma::Mat<eT>& output,
+              const size_t dW = 1,
+              const size_t dH = 1,
+              const size_t dilationW = 1,
+              const size_t dilationH = 1)
+  {
+    const size_t outputRows = (input.n_rows - (filter.n_rows - 1) * dilationW -
+        1) / dW + 1;
+    const size_t outputCols = (input.n_cols - (filter.n_cols - 1) * dilationH -
+        1) / dH + 1;
+
+    arma::Mat<eT> columns;
+    Im2Col(input.memptr(), 1, input.n_rows, input.n_cols, filter.n_rows,
+        filter.n_cols, outputRows, outputCols, dW, dH, dilationW, dilationH,
+        columns);
+
+    output = arma::reshape(trans(columns) * arma::vectorise(filter),
+        outputRows, outputCols);
+  }
+
+  /*
+   * Perform a convolution (full mode).
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the convolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   * @param dilationW The dilation factor in x direction.
+   * @param dilationH The dilation factor in y direction.
+   */
+  template<typename eT, typename Border = BorderMode>
+  static typename std::enable_if<
+      std::is_same<Border, FullConvolution>::value, void>::type
+  Convolution(const arma::Mat<eT>& input,
+              const arma::Mat<eT>& filter,
+              arma::Mat<eT>& output,
+              const size_t dW = 1,
+              const size_t dH = 1,
+              const size_t dilationW = 1,
+              const size_t dilationH = 1)
+  {
+    // The padding is the same as for NaiveConvolution, so the results match.
+    size_t outputRows = (input.n_rows - 1) * dW + 2 * (filter.n_rows - 1)
+        * dilationW + 1;
+    size_t outputCols = (input.n_cols - 1) * dH + 2 * (filter.n_cols - 1)
+        * dilationH + 1;
+
+    for (size_t i = 0; i < dW; i++)
+    {
+      if (((((i + outputRows - 2 * (filter.n_rows - 1) * dilationW - 1) % dW)
+          + dW) % dW) == i)
+      {
+        outputRows += i;
+        break;
+      }
+    }
+    for (size_t i = 0; i < dH; i++)
+    {
+      if (((((i + outputCols - 2 * (filter.n_cols - 1) * dilationH - 1) % dH)
+          + dH) % dH) == i)
+      {
+        outputCols += i;
+        break;
+      }
+    }
+
+    // Pad filter and input to the working output shape.
+    arma::Mat<eT> inputPadded = arma::zeros<arma::Mat<eT> >(outputRows,
+        outputCols);
+    inputPadded.submat((filter.n_rows - 1) * dilationW, (filter.n_cols - 1)
+        * dilationH, (filter.n_rows - 1) * dilationW + input.n_rows - 1,
+        (filter.n_cols - 1) * dilationH + input.n_cols - 1) = input;
+
+    Im2ColConvolution<ValidConvolution>::Convolution(inputPadded, filter,
+        output, 1, 1, dilationW, dilationH);
+  }
+
+  /*
+   * Perform a convolution using 3rd order tensors.
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the convolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   * @param dilationW The dilation factor in x direction.
+   * @param dilationH The dilation factor in y direction.
+   */
+  template<typename eT>
+  static void Convolution(const arma::Cube<eT>& input,
+                          const arma::Cube<eT>& filter,
+                          arma::Cube<eT>& output,
+                          const size_t dW = 1,
+                          const size_t dH = 1,
+                          const size_t dilationW = 1,
+                          const size_t dilationH = 1)
+  {
+    arma::Mat<eT> convOutput;
+    Im2ColConvolution<BorderMode>::Convolution(input.slice(0),
+        filter.slice(0), convOutput, dW, dH, dilationW, dilationH);
+
+    output = arma::Cube<eT>(convOutput.n_rows, convOutput.n_cols,
+        input.n_slices);
+    output.slice(0) = convOutput;
+
+    for (size_t i = 1; i < input.n_slices; i++)
+    {
+      Im2ColConvolution<BorderMode>::Convolution(input.slice(i),
+          filter.slice(i), output.slice(i), dW, dH, dilationW, dilationH);
+    }
+  }
+
+  /*
+   * Compute the output maps of a convolution layer for a batch of points.
+   * The maps of each point are unfolded once, and one matrix product with the
+   * weights of all output maps gives all output maps of the point.
+   *
+   * @param input Input maps, inSize consecutive slices for each point (already
+   *     padded).
+   * @param weight Filters, ordered like the weights of the Convolution layer:
+   *     slice outMap * inSize + inMap connects inMap with outMap.
+   * @param bias Bias of each output map.
+   * @param batchSize Number of points.
+   * @param output Output maps, outSize consecutive slices for each point; must
+   *     already have the right size.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   * @param dilationW The dilation factor in x direction.
+   * @param dilationH The dilation factor in y direction.
+   */
+  template<typename eT>
+  static void BatchForward(const arma::Cube<eT>& input,
+                           const arma::Cube<eT>& weight,
+                           const arma::Mat<eT>& bias,
+                           const size_t batchSize,
+                           arma::Cube<eT>& output,
+                           const size_t dW = 1,
+                           const size_t dH = 1,
+                           const size_t dilationW = 1,
+                           const size_t dilationH = 1)
+  {
+    const size_t inSize = input.n_slices / batchSize;
+    const size_t outSize = output.n_slices / batchSize;
+
+    // The filters of output map outMap are contiguous, so they are column
+    // outMap of this matrix.
+    const arma::Mat<eT> weightMat(const_cast<eT*>(weight.memptr()),
+        weight.n_rows * weight.n_cols * inSize, outSize, false, true);
+
+    arma::Mat<eT> columns;
+    for (size_t i = 0; i < batchSize; ++i)
+    {
+      Im2Col(input.slice_memptr(i * inSize), inSize, input.n_rows,
+          input.n_cols, weight.n_rows, weight.n_cols, output.n_rows,
+          output.n_cols, dW, dH, dilationW, dilationH, columns);
+
+      // The output maps of the point are contiguous too.
+      arma::Mat<eT> outputMat(output.slice_memptr(i * outSize),
+          output.n_rows * output.n_cols, outSize, false, true);
+      outputMat = trans(columns) * weightMat;
+      outputMat.each_row() += trans(bias.col(0));
+    }
+  }
+
+  /*
+   * Compute the gradient of a convolution layer with respect to its input for
+   * a batch of points, as the transposed operation of BatchForward().
+   *
+   * @param error Error of the output maps, outSize slices for each point.
+   * @param weight Filters, ordered like for BatchForward().
+   * @param batchSize Number of points.
+   * @param g Gradient of the (padded) input maps, inSize slices for each
+   *     point; must already have the right size, and is added to.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   * @param dilationW The dilation factor in x direction.
+   * @param dilationH The dilation factor in y direction.
+   */
+  template<typename eT>
+  static void BatchBackward(const arma::Cube<eT>& error,
+                            const arma::Cube<eT>& weight,
+                            const size_t batchSize,
+                            arma::Cube<eT>& g,
+                            const size_t dW = 1,
+                            const size_t dH = 1,
+                            const size_t dilationW = 1,
+                            const size_t dilationH = 1)
+  {
+    const size_t inSize = g.n_slices / batchSize;
+    const size_t outSize = error.n_slices / batchSize;
+
+    const arma::Mat<eT> weightMat(const_cast<eT*>(weight.memptr()),
+        weight.n_rows * weight.n_cols * inSize, outSize, false, true);
+
+    arma::Mat<eT> columns;
+    for (size_t i = 0; i < batchSize; ++i)
+    {
+      const arma::Mat<eT> errorMat(const_cast<eT*>(error.slice_memptr(i *
+          outSize)), error.n_rows * error.n_cols, outSize, false, true);
+      columns = weightMat * trans(errorMat);
+
+      Col2Im(columns, g.slice_memptr(i * inSize), inSize, g.n_rows, g.n_cols,
+          weight.n_rows, weight.n_cols, error.n_rows, error.n_cols, dW, dH,
+          dilationW, dilationH);
+    }
+  }
+
+  /*
+   * Compute the gradient of a convolution layer with respect to its filters
+   * and biases for a batch of points.
+   *
+   * @param input Input maps (already padded), like for BatchForward().
+   * @param error Error of the output maps, outSize slices for each point.
+   * @param batchSize Number of points.
+   * @param weightGradient Gradient of the filters, ordered like the weights
+   *     for BatchForward(); must already have the right size, and is added
+   *     to.
+   * @param biasGradient Gradient of the biases, summed over the batch.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   * @param dilationW The dilation factor in x direction.
+   * @param dilationH The dilation factor in y direction.
+   */
+  template<typename eT>
+  static void BatchGradient(const arma::Cube<eT>& input,
+                            const arma::Cube<eT>& error,
+                            const size_t batchSize,
+                            arma::Cube<eT>& weightGradient,
+                            arma::Col<eT>& biasGradient,
+                            const size_t dW = 1,
+                            const size_t dH = 1,
+                            const size_t dilationW = 1,
+                            const size_t dilationH = 1)
+  {
+    const size_t inSize = input.n_slices / batchSize;
+    const size_t outSize = error.n_slices / batchSize;
+
+    arma::Mat<eT> gradientMat(weightGradient.memptr(), weightGradient.n_rows *
+        weightGradient.n_cols * inSize, outSize, false, true);
+    biasGradient.zeros(outSize);
+
+    arma::Mat<eT> columns;
+    for (size_t i = 0; i < batchSize; ++i)
+    {
+      Im2Col(input.slice_memptr(i * inSize), inSize, input.n_rows,
+          input.n_cols, weightGradient.n_rows, weightGradient.n_cols,
+          error.n_rows, error.n_cols, dW, dH, dilationW, dilationH, columns);
+
+      const arma::Mat<eT> errorMat(const_cast<eT*>(error.slice_memptr(i *
+          outSize)), error.n_rows * error.n_cols, outSize, false, true);
+      gradientMat += columns * errorMat;
+      biasGradient += trans(arma::sum(errorMat));
+    }
+  }
+
+  /*
+   * Unfold the patches of the given maps into the columns of a matrix.  Column
+   * i + j * outputRows holds the patch of output position (i, j): the entries
+   * of the first map under the filter, in column-major order, then those of
+   * the second map, and so on.  The maps can have any element type, so that
+   * quantized maps can be unfolded too.
+   */
+  template<typename eT>
+  static void Im2Col(const eT* maps,
+                     const size_t numMaps,
+                     const size_t mapRows,
+                     const size_t mapCols,
+                     const size_t filterRows,
+                     const size_t filterCols,
+                     const size_t outputRows,
+                     const size_t outputCols,
+                     const size_t dW,
+                     const size_t dH,
+                     const size_t dilationW,
+                     const size_t dilationH,
+                     arma::Mat<eT>& columns)
+  {
+    columns.set_size(filterRows * filterCols * numMaps,
+        outputRows * outputCols);
+
+    eT* columnPtr = columns.memptr();
+    for (size_t j = 0; j < outputCols; ++j)
+    {
+      for (size_t i = 0; i < outputRows; ++i)
+      {
+        for (size_t m = 0; m < numMaps; ++m)
+        {
+          const eT* mapPtr = maps + m * mapRows * mapCols;
+          for (size_t kj = 0; kj < filterCols; ++kj)
+          {
+            const eT* inputPtr = mapPtr + (j * dH + kj * dilationH) * mapRows +
+                i * dW;
+            for (size_t ki = 0; ki < filterRows; ++ki, inputPtr += dilationW)
+              *columnPtr++ = *inputPtr;
+          }
+        }
+      }
+    }
+  }
+
+ private:
+  /*
+   * Add the columns of a matrix back to the patches of the maps they were
+   * unfolded from by Im2Col().
+   */
+  template<typename eT>
+  static void Col2Im(const arma::Mat<eT>& columns,
+                     eT* maps,
+                     const size_t numMaps,
+                     const size_t mapRows,
+                     const size_t mapCols,
+                     const size_t filterRows,
+                     const size_t filterCols,
+                     const size_t outputRows,
+                     const size_t outputCols,
+                     const size_t dW,
+                     const size_t dH,
+                     const size_t dilationW,
+                     const size_t dilationH)
+  {
+    const eT* columnPtr = columns.memptr();
+    for (size_t j = 0; j < outputCols; ++j)
+    {
+      for (size_t i = 0; i < outputRows; ++i)
+      {
+        for (size_t m = 0; m < numMaps; ++m)
+        {
+          eT* mapPtr = maps + m * mapRows * mapCols;
+          for (size_t kj = 0; kj < filterCols; ++kj)
+          {
+            eT* outputPtr = mapPtr + (j * dH + kj * dilationH) * mapRows +
+                i * dW;
+            for (size_t ki = 0; ki < filterRows; ++ki,
+                outputPtr += dilationW)
+              *outputPtr += *columnPtr++;
+          }
+        }
+      }
+    }
+  }
+};  // class Im2ColConvolution
+
+/**
+ * Whether the given convolution rule is Im2ColConvolution, so that layers can
+ * use its batched operations.
+ */
+template<typename ConvolutionRule>
+struct IsIm2ColConvolution
+{
+  static const bool value = false;
+};
+
+template<typename BorderMode>
+struct IsIm2ColConvolution<Im2ColConvolution<BorderMode>>
+{
+  static const bool value = true;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -24,8 +24,13 @@
 #include "visitor/weight_size_visitor.hpp"
 #include "visitor/copy_visitor.hpp"
 #include "visitor/loss_visitor.hpp"
+#include "visitor/sparse_forward_visitor.hpp"
+#include "visitor/sparse_gradient_visitor.hpp"
 
 #include "init_rules/network_init.hpp"
+#include "batch_prefetcher.hpp"
+#include "layer_profiler.hpp"
+#include "weight_file_io.hpp"
 
 #include <mlpack/methods/ann/layer/layer_types.hpp>
 #include <mlpack/methods/ann/layer/layer.hpp>
@@ -124,6 +129,37 @@ class FFN
   template<typename OptimizerType = ens::RMSProp>
   double Train(arma::mat predictors, arma::mat responses);
 
+  /**
+   * Train the feedforward network on the given sparse input data (like
+   * bag-of-words or hashed features) using the given optimizer.  The
+   * predictors are never densified: the first layer of the network, which
+   * must be a Linear or LinearNoBias layer, computes its output and the
+   * gradient of its weights from the nonzero elements of each batch only.
+   *
+   * @tparam OptimizerType Type of optimizer to use to train the model.
+   * @param predictors Sparse input training variables.
+   * @param responses Outputs results from input training variables.
+   * @param optimizer Instantiated optimizer used to train the model.
+   * @return The final objective of the trained model (NaN or Inf on error).
+   */
+  template<typename OptimizerType>
+  double Train(arma::sp_mat predictors,
+               arma::mat responses,
+               OptimizerType& optimizer);
+
+  /**
+   * Train the feedforward network on the given sparse input data with a
+   * default-constructed optimizer (RMSProp by default).  The first layer of
+   * the network must be a Linear or LinearNoBias layer.
+   *
+   * @tparam OptimizerType Type of optimizer to use to train the model.
+   * @param predictors Sparse input training variables.
+   * @param responses Outputs results from input training variables.
+   * @return The final objective of the trained model (NaN or Inf on error).
+   */
+  template<typename OptimizerType = ens::RMSProp>
+  double Train(arma::sp_mat predictors, arma::mat responses);
+
   /**
    * Predict the responses to a given set of predictors. The responses will
    * reflect the output of the given output layer as returned by the
@@ -132,10 +168,30 @@ class FFN
    * If you want to pass in a parameter and discard the original parameter
    * object, be sure to use std::move to avoid unnecessary copy.
    *
+   * The predictors are passed through the network batchSize columns at a
+   * time, so that the layers work on matrices instead of single points.  If
+   * results already has the right size, its memory is reused.
+   *
    * @param predictors Input predictors.
    * @param results Matrix to put output predictions of responses into.
+   * @param batchSize Number of points to predict at once.
    */
-  void Predict(arma::mat predictors, arma::mat& results);
+  void Predict(arma::mat predictors,
+               arma::mat& results,
+               const size_t batchSize = 256);
+
+  /**
+   * Predict the responses to a given set of sparse predictors, batchSize
+   * columns at a time.  The first layer of the network must be a Linear or
+   * LinearNoBias layer.
+   *
+   * @param predictors Sparse input predictors.
+   * @param results Matrix to put output predictions of responses into.
+   * @param batchSize Number of points to predict at once.
+   */
+  void Predict(const arma::sp_mat& predictors,
+               arma::mat& results,
+               const size_t batchSize = 256);
 
   /**
    * Evaluate the feedforward network with the given predictors and responses.
@@ -206,6 +262,13 @@ class FFN
    * a number of data points. This is useful for optimizers such as SGD, which
    * require a separable objective function.
    *
+   * If NumThreads() is larger than one, the batch is split into that many
+   * parts, which are passed through copies of the network at the same time.
+   * The copies share the parameters of the network, and their gradients are
+   * summed pairwise.  Layers that keep statistics of what they have seen,
+   * like BatchNorm, only update them with the first part of the batch, and
+   * compute their output from the statistics of each part.
+   *
    * @param parameters Matrix model parameters.
    * @param begin Index of the starting point to use for objective function
    *        evaluation.
@@ -219,6 +282,28 @@ class FFN
                               GradType& gradient,
                               const size_t batchSize);
 
+  /**
+   * Evaluate the feedforward network with the given parameters, but using only
+   * a number of data points, and return the gradient as a sparse matrix.  Only
+   * the nonzero entries are stored, so for a network with a Lookup layer the
+   * gradient of the embedding table only has the columns of the tokens in the
+   * batch, and optimizers that take a sparse gradient type (like SGD) only
+   * update those.  The Lookup layers only compute the columns of the tokens in
+   * the batch, so the cost of their gradient does not depend on the size of the
+   * table.
+   *
+   * @param parameters Matrix model parameters.
+   * @param begin Index of the starting point to use for objective function
+   *        evaluation.
+   * @param gradient Sparse matrix to output gradient into.
+   * @param batchSize Number of points to be passed at a time to use for
+   *        objective function evaluation.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              const size_t begin,
+                              arma::sp_mat& gradient,
+                              const size_t batchSize);
+
   /**
    * Evaluate the gradient of the feedforward network with the given parameters,
    * and with respect to only a number of points in the dataset. This is useful
@@ -238,7 +323,10 @@ class FFN
 
   /**
    * Shuffle the order of function visitation. This may be called by the
-   * optimizer.
+   * optimizer.  Only the order of the points is shuffled; the points of each
+   * batch are then gathered from the predictors and responses.  During
+   * Train(), the points of the next batch are gathered on another thread
+   * while the current batch is computed.
    */
   void Shuffle();
 
@@ -257,6 +345,12 @@ class FFN
    */
   void Add(LayerTypes<CustomLayers...> layer) { network.push_back(layer); }
 
+  //! Get the layers of the network.
+  const std::vector<LayerTypes<CustomLayers...> >& Model() const
+  {
+    return network;
+  }
+
   //! Return the number of separable functions (the number of predictor points).
   size_t NumFunctions() const { return numFunctions; }
 
@@ -265,6 +359,17 @@ class FFN
   //! Modify the initial point for the optimization.
   arma::mat& Parameters() { return parameter; }
 
+  //! Get the number of threads the gradient of a batch is computed with.
+  size_t NumThreads() const { return numThreads; }
+  //! Modify the number of threads the gradient of a batch is computed with.
+  size_t& NumThreads() { return numThreads; }
+
+  //! Get the profiler of the layers of the network.
+  const LayerProfiler& Profiler() const { return profiler; }
+  //! Modify the profiler of the layers of the network; enable it to record
+  //! the time and the work of each layer.
+  LayerProfiler& Profiler() { return profiler; }
+
   //! Get the matrix of responses to the input data points.
   const arma::mat& Responses() const { return responses; }
   //! Modify the matrix of responses to the input data points.
@@ -275,6 +380,10 @@ class FFN
   //! Modify the matrix of data points (predictors).
   arma::mat& Predictors() { return predictors; }
 
+  //! Get the sparse matrix of data points, if the network is trained on
+  //! sparse predictors (otherwise it is empty).
+  const arma::sp_mat& SparsePredictors() const { return sparsePredictors; }
+
   /**
    * Reset the module infomration (weights/parameters).
    */
@@ -284,6 +393,29 @@ class FFN
   template<typename Archive>
   void serialize(Archive& ar, const unsigned int /* version */);
 
+  /**
+   * Save the layers and the parameters of the network to the given file in
+   * the binary weight file format (see WeightFileIO), so that it can later be
+   * loaded with LoadFlat().  The parameters must have been initialized.
+   *
+   * @param filename File to save the network to.
+   */
+  void SaveFlat(const std::string& filename) const;
+
+  /**
+   * Load the layers and the parameters of the network from the given weight
+   * file (see WeightFileIO and SaveFlat()).  The file is mapped into memory
+   * and the parameters are used directly from the mapped memory, so they are
+   * neither parsed nor copied, and every process that loads the same file
+   * shares their memory.  Changes to the parameters (for instance by further
+   * training) are private to this network and never written to the file.  The
+   * file stays mapped until another file is loaded or this object is
+   * destroyed.
+   *
+   * @param filename Weight file to load the network from.
+   */
+  void LoadFlat(const std::string& filename);
+
   /**
    * Perform the forward pass of the data in real batch mode.
    *
@@ -335,6 +467,18 @@ class FFN
    */
   void Forward(arma::mat&& input);
 
+  /**
+   * The forward pass for sparse input, which is passed to the first layer.
+   *
+   * @param input Sparse data to compute the output for.
+   */
+  void Forward(const arma::sp_mat& input);
+
+  /**
+   * Pass the output of the first layer through the rest of the network.
+   */
+  void ForwardLayers();
+
   /**
    * Prepare the network for the given data.
    * This function won't actually trigger training process.
@@ -344,6 +488,14 @@ class FFN
    */
   void ResetData(arma::mat predictors, arma::mat responses);
 
+  /**
+   * Prepare the network for the given sparse data.
+   *
+   * @param predictors Sparse input data variables.
+   * @param responses Outputs results from input data variables.
+   */
+  void ResetData(arma::sp_mat predictors, arma::mat responses);
+
   /**
    * The Backward algorithm (part of the Forward-Backward algorithm). Computes
    * backward pass for module.
@@ -356,6 +508,102 @@ class FFN
    */
   void Gradient(arma::mat&& input);
 
+  /**
+   * Update the gradient of all layers, for sparse input to the first layer.
+   */
+  void Gradient(const arma::sp_mat& input);
+
+  /**
+   * Update the gradient of all layers but the first one.
+   */
+  void GradientLayers();
+
+  /**
+   * Compute the objective and the gradient of the given points of the given
+   * data set with the current parameters.
+   *
+   * @param predictors Input variables.
+   * @param responses Target outputs for input variables.
+   * @param begin Index of the first point to use.
+   * @param batchSize Number of points to use.
+   * @param gradient Matrix to output gradient into.
+   */
+  template<typename GradType>
+  double BatchGradient(const arma::mat& predictors,
+                       const arma::mat& responses,
+                       const size_t begin,
+                       const size_t batchSize,
+                       GradType& gradient);
+
+  /**
+   * Compute the objective and the gradient of the given points of the given
+   * sparse data set with the current parameters.
+   *
+   * @param predictors Sparse input variables.
+   * @param responses Target outputs for input variables.
+   * @param begin Index of the first point to use.
+   * @param batchSize Number of points to use.
+   * @param gradient Matrix to output gradient into.
+   */
+  template<typename GradType>
+  double BatchGradient(const arma::sp_mat& predictors,
+                       const arma::mat& responses,
+                       const size_t begin,
+                       const size_t batchSize,
+                       GradType& gradient);
+
+  /**
+   * Compute the objective and the gradient of the given points with one copy
+   * of the network per thread, and sum the gradients pairwise.
+   *
+   * @param predictors Input variables (dense or sparse).
+   * @param responses Target outputs for input variables.
+   * @param begin Index of the first point to use.
+   * @param gradient Matrix to output gradient into.
+   * @param batchSize Number of points to use.
+   */
+  template<typename PredictorsType>
+  double ParallelGradient(const PredictorsType& predictors,
+                          const arma::mat& responses,
+                          const size_t begin,
+                          arma::mat& gradient,
+                          const size_t batchSize);
+
+  /**
+   * Compute the objective and the gradient of the points of the training set
+   * at the given positions of the current order.  If the order is shuffled,
+   * the points are gathered with the given prefetcher.
+   *
+   * @param predictors Input variables (dense or sparse).
+   * @param prefetcher Prefetcher to gather shuffled batches with.
+   * @param begin Position of the first point to use.
+   * @param gradient Matrix to output gradient into.
+   * @param batchSize Number of points to use.
+   */
+  template<typename PredictorsType, typename GradType>
+  double DataGradient(const PredictorsType& predictors,
+                      BatchPrefetcher<PredictorsType, arma::mat>& prefetcher,
+                      const size_t begin,
+                      GradType& gradient,
+                      const size_t batchSize);
+
+  /**
+   * Wait for the batches being prefetched and stop prefetching.
+   */
+  void StopPrefetch();
+
+  /**
+   * Drop the shuffled order of the points if the data has been replaced by
+   * data with a different number of points.
+   */
+  void CheckOrdering();
+
+  /**
+   * Create the copies of the network used by ParallelGradient() if needed,
+   * and let their weights point into the parameter matrix.
+   */
+  void ResetReplicas();
+
   /**
    * Reset the module status by setting the current deterministic parameter
    * for all modules that implement the Deterministic function.
@@ -367,6 +615,20 @@ class FFN
    */
   void ResetGradients(arma::mat& gradient);
 
+  /**
+   * Set whether the Lookup layers of the network, and of its copies for the
+   * other threads, only keep the nonzero columns of their gradient, and clear
+   * the columns they kept.
+   */
+  void SetSparseLookupGradients(const bool sparse);
+
+  /**
+   * Build the sparse gradient from denseGradient, except for the weights of
+   * the Lookup layers, which are built from their touched columns (summed over
+   * the copies of the network); their part of denseGradient is not used.
+   */
+  void BuildSparseGradient(arma::sp_mat& gradient) const;
+
   /**
    * Swap the content of this network with given network.
    *
@@ -396,12 +658,33 @@ class FFN
   //! The matrix of data points (predictors).
   arma::mat predictors;
 
+  //! The sparse matrix of data points, if the network is trained on sparse
+  //! predictors; then predictors is empty.
+  arma::sp_mat sparsePredictors;
+
   //! The matrix of responses to the input data points.
   arma::mat responses;
 
+  //! The order in which the points are visited, once they are shuffled (if
+  //! empty, the points are visited in the order they are stored).
+  arma::uvec ordering;
+
+  //! Whether to gather the next shuffled batch in the background.
+  bool prefetch;
+
+  //! The prefetcher of shuffled batches of dense predictors.
+  BatchPrefetcher<arma::mat, arma::mat> densePrefetcher;
+
+  //! The prefetcher of shuffled batches of sparse predictors.
+  BatchPrefetcher<arma::sp_mat, arma::mat> sparsePrefetcher;
+
   //! Matrix of (trained) parameters.
   arma::mat parameter;
 
+  //! If the network was loaded with LoadFlat(), this holds the mapped file
+  //! that the parameters are an alias of.
+  std::shared_ptr<util::MappedFile> mappedFile;
+
   //! The number of separable functions (the number of predictor points).
   size_t numFunctions;
 
@@ -453,6 +736,22 @@ class FFN
   //! Locally-stored copy visitor
   CopyVisitor<CustomLayers...> copyVisitor;
 
+  //! The number of threads the gradient of a batch is computed with.
+  size_t numThreads;
+
+  //! The copies of the network used by the other threads; their parameters
+  //! point into the parameter matrix of this network.
+  std::vector<FFN*> replicas;
+
+  //! The gradients computed by the copies of the network.
+  std::vector<arma::mat> replicaGradients;
+
+  //! The dense gradient that sparse gradients are built from.
+  arma::mat denseGradient;
+
+  //! Records the calls of the layers when it is enabled.
+  LayerProfiler profiler;
+
   // The GAN class should have access to internal members.
   template<
     typename Model,
@@ -23,6 +23,8 @@
 #include "visitor/set_input_height_visitor.hpp"
 #include "visitor/set_input_width_visitor.hpp"
 
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 #include <boost/serialization/variant.hpp>
 
 namespace mlpack {
@@ -38,8 +40,10 @@ FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::FFN(
     width(0),
     height(0),
     reset(false),
+    prefetch(false),
     numFunctions(0),
-    deterministic(true)
+    deterministic(true),
+    numThreads(1)
 {
   /* Nothing to do here */
 }
@@ -50,6 +54,9 @@ FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::~FFN()
 {
   std::for_each(network.begin(), network.end(),
       boost::apply_visitor(deleteVisitor));
+
+  for (size_t i = 0; i < replicas.size(); ++i)
+    delete replicas[i];
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
@@ -57,8 +64,29 @@ template<typename OutputLayerType, typename InitializationRuleType,
 void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::ResetData(
     arma::mat predictors, arma::mat responses)
 {
+  StopPrefetch();
+  ordering.reset();
   numFunctions = responses.n_cols;
   this->predictors = std::move(predictors);
+  this->sparsePredictors.reset();
+  this->responses = std::move(responses);
+  this->deterministic = true;
+  ResetDeterministic();
+
+  if (!reset)
+    ResetParameters();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::ResetData(
+    arma::sp_mat predictors, arma::mat responses)
+{
+  StopPrefetch();
+  ordering.reset();
+  numFunctions = responses.n_cols;
+  this->predictors.reset();
+  this->sparsePredictors = std::move(predictors);
   this->responses = std::move(responses);
   this->deterministic = true;
   ResetDeterministic();
@@ -77,9 +105,11 @@ double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Train(
 {
   ResetData(std::move(predictors), std::move(responses));
 
-  // Train the model.
+  // Train the model, gathering shuffled batches in the background.
   Timer::Start("ffn_optimization");
+  prefetch = true;
   const double out = optimizer.Optimize(*this, parameter);
+  StopPrefetch();
   Timer::Stop("ffn_optimization");
 
   Log::Info << "FFN::FFN(): final objective of trained model is " << out
@@ -97,9 +127,55 @@ double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Train(
 
   OptimizerType optimizer;
 
-  // Train the model.
+  // Train the model, gathering shuffled batches in the background.
   Timer::Start("ffn_optimization");
+  prefetch = true;
   const double out = optimizer.Optimize(*this, parameter);
+  StopPrefetch();
+  Timer::Stop("ffn_optimization");
+
+  Log::Info << "FFN::FFN(): final objective of trained model is " << out
+      << "." << std::endl;
+  return out;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+template<typename OptimizerType>
+double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Train(
+      arma::sp_mat predictors,
+      arma::mat responses,
+      OptimizerType& optimizer)
+{
+  ResetData(std::move(predictors), std::move(responses));
+
+  // Train the model, gathering shuffled batches in the background.
+  Timer::Start("ffn_optimization");
+  prefetch = true;
+  const double out = optimizer.Optimize(*this, parameter);
+  StopPrefetch();
+  Timer::Stop("ffn_optimization");
+
+  Log::Info << "FFN::FFN(): final objective of trained model is " << out
+      << "." << std::endl;
+  return out;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+template<typename OptimizerType>
+double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Train(
+    arma::sp_mat predictors, arma::mat responses)
+{
+  ResetData(std::move(predictors), std::move(responses));
+
+  OptimizerType optimizer;
+
+  // Train the model, gathering shuffled batches in the background.
+  Timer::Start("ffn_optimization");
+  prefetch = true;
+  const double out = optimizer.Optimize(*this, parameter);
+  StopPrefetch();
   Timer::Stop("ffn_optimization");
 
   Log::Info << "FFN::FFN(): final objective of trained model is " << out
@@ -131,16 +207,16 @@ template<typename OutputLayerType, typename InitializationRuleType,
 void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Forward(
     arma::mat inputs, arma::mat& results, const size_t begin, const size_t end)
 {
-  boost::apply_visitor(ForwardVisitor(std::move(inputs), std::move(
-      boost::apply_visitor(outputParameterVisitor, network[begin]))),
-      network[begin]);
+  profiler.Apply(LayerProfiler::FORWARD_PASS, begin, ForwardVisitor(
+      std::move(inputs), std::move(boost::apply_visitor(
+      outputParameterVisitor, network[begin]))), network[begin]);
 
   for (size_t i = 1; i < end - begin + 1; ++i)
   {
-    boost::apply_visitor(ForwardVisitor(std::move(boost::apply_visitor(
-        outputParameterVisitor, network[begin + i - 1])), std::move(
-        boost::apply_visitor(outputParameterVisitor, network[begin + i]))),
-        network[begin + i]);
+    profiler.Apply(LayerProfiler::FORWARD_PASS, begin + i, ForwardVisitor(
+        std::move(boost::apply_visitor(outputParameterVisitor,
+        network[begin + i - 1])), std::move(boost::apply_visitor(
+        outputParameterVisitor, network[begin + i]))), network[begin + i]);
   }
 
   results = boost::apply_visitor(outputParameterVisitor, network[end]);
@@ -164,8 +240,8 @@ double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Backward(
 
   gradients = arma::zeros<arma::mat>(parameter.n_rows, parameter.n_cols);
 
-  Backward();
   ResetGradients(gradients);
+  Backward();
   Gradient(std::move(currentInput));
 
   return res;
@@ -174,7 +250,7 @@ double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Backward(
 template<typename OutputLayerType, typename InitializationRuleType,
          typename... CustomLayers>
 void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Predict(
-    arma::mat predictors, arma::mat& results)
+    arma::mat predictors, arma::mat& results, const size_t batchSize)
 {
   if (parameter.is_empty())
     ResetParameters();
@@ -185,23 +261,59 @@ void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Predict(
     ResetDeterministic();
   }
 
-  arma::mat resultsTemp;
-  Forward(std::move(arma::mat(predictors.colptr(0),
-      predictors.n_rows, 1, false, true)));
-  resultsTemp = boost::apply_visitor(outputParameterVisitor,
-      network.back()).col(0);
+  const size_t effectiveBatchSize = std::min(batchSize,
+      size_t(predictors.n_cols));
+
+  // The first batch gives the size of the output.
+  Forward(std::move(arma::mat(predictors.colptr(0), predictors.n_rows,
+      effectiveBatchSize, false, true)));
+  const arma::mat& resultsTemp = boost::apply_visitor(outputParameterVisitor,
+      network.back());
+
+  results.set_size(resultsTemp.n_rows, predictors.n_cols);
+  results.cols(0, effectiveBatchSize - 1) = resultsTemp;
+
+  // Process in accordance with the given batch size.
+  for (size_t begin = effectiveBatchSize; begin < predictors.n_cols;
+      begin += batchSize)
+  {
+    const size_t effectiveBatchSize = std::min(batchSize,
+        size_t(predictors.n_cols - begin));
+    Forward(std::move(arma::mat(predictors.colptr(begin), predictors.n_rows,
+        effectiveBatchSize, false, true)));
+
+    results.cols(begin, begin + effectiveBatchSize - 1) =
+        boost::apply_visitor(outputParameterVisitor, network.back());
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Predict(
+    const arma::sp_mat& predictors, arma::mat& results, const size_t batchSize)
+{
+  if (parameter.is_empty())
+    ResetParameters();
 
-  results = arma::mat(resultsTemp.n_elem, predictors.n_cols);
-  results.col(0) = resultsTemp.col(0);
+  if (!deterministic)
+  {
+    deterministic = true;
+    ResetDeterministic();
+  }
 
-  for (size_t i = 1; i < predictors.n_cols; i++)
+  for (size_t begin = 0; begin < predictors.n_cols; begin += batchSize)
   {
-    Forward(std::move(arma::mat(predictors.colptr(i),
-        predictors.n_rows, 1, false, true)));
+    const size_t effectiveBatchSize = std::min(batchSize,
+        size_t(predictors.n_cols - begin));
+    Forward(arma::sp_mat(predictors.cols(begin,
+        begin + effectiveBatchSize - 1)));
 
-    resultsTemp = boost::apply_visitor(outputParameterVisitor,
-        network.back());
-    results.col(i) = resultsTemp.col(0);
+    const arma::mat& resultsTemp = boost::apply_visitor(
+        outputParameterVisitor, network.back());
+    if (begin == 0)
+      results.set_size(resultsTemp.n_rows, predictors.n_cols);
+
+    results.cols(begin, begin + effectiveBatchSize - 1) = resultsTemp;
   }
 }
 
@@ -238,7 +350,7 @@ double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Evaluate(
     const arma::mat& parameters)
 {
   double res = 0;
-  for (size_t i = 0; i < predictors.n_cols; ++i)
+  for (size_t i = 0; i < numFunctions; ++i)
     res += Evaluate(parameters, i, 1, true);
 
   return res;
@@ -261,10 +373,45 @@ double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Evaluate(
     ResetDeterministic();
   }
 
-  Forward(std::move(predictors.cols(begin, begin + batchSize - 1)));
+  // If the points are shuffled, gather the points of the batch; otherwise
+  // wrap matrices around the batch to avoid a copy.
+  CheckOrdering();
+
+  arma::uvec indices;
+  arma::mat gatheredResponses;
+  if (!ordering.is_empty())
+  {
+    indices = ordering.subvec(begin, begin + batchSize - 1);
+    GatherColumns(responses, indices, gatheredResponses);
+  }
+
+  arma::mat batchResponses(ordering.is_empty() ? responses.colptr(begin) :
+      gatheredResponses.memptr(), responses.n_rows, batchSize, false, true);
+  if (sparsePredictors.n_cols > 0)
+  {
+    arma::sp_mat batchPredictors;
+    if (ordering.is_empty())
+      batchPredictors = sparsePredictors.cols(begin, begin + batchSize - 1);
+    else
+      GatherColumns(sparsePredictors, indices, batchPredictors);
+
+    Forward(batchPredictors);
+  }
+  else if (ordering.is_empty())
+  {
+    Forward(std::move(arma::mat(predictors.colptr(begin), predictors.n_rows,
+        batchSize, false, true)));
+  }
+  else
+  {
+    arma::mat batchPredictors;
+    GatherColumns(predictors, indices, batchPredictors);
+    Forward(std::move(batchPredictors));
+  }
+
   double res = outputLayer.Forward(
       std::move(boost::apply_visitor(outputParameterVisitor, network.back())),
-      std::move(responses.cols(begin, begin + batchSize - 1)));
+      std::move(batchResponses));
 
   for (size_t i = 0; i < network.size(); ++i)
   {
@@ -289,7 +436,7 @@ double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::
 EvaluateWithGradient(const arma::mat& parameters, GradType& gradient)
 {
   double res = 0;
-  for (size_t i = 0; i < predictors.n_cols; ++i)
+  for (size_t i = 0; i < numFunctions; ++i)
     res += EvaluateWithGradient(parameters, i, gradient, 1);
 
   return res;
@@ -322,10 +469,166 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
     ResetDeterministic();
   }
 
-  Forward(std::move(predictors.cols(begin, begin + batchSize - 1)));
+  if (sparsePredictors.n_cols > 0)
+  {
+    return DataGradient(sparsePredictors, sparsePrefetcher, begin, gradient,
+        batchSize);
+  }
+
+  return DataGradient(predictors, densePrefetcher, begin, gradient, batchSize);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+template<typename PredictorsType, typename GradType>
+double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::
+DataGradient(const PredictorsType& predictors,
+             BatchPrefetcher<PredictorsType, arma::mat>& prefetcher,
+             const size_t begin,
+             GradType& gradient,
+             const size_t batchSize)
+{
+  CheckOrdering();
+
+  // Without a shuffled order, the batch is a contiguous part of the data.
+  if (ordering.is_empty())
+  {
+    if (numThreads > 1 && batchSize >= numThreads)
+    {
+      return ParallelGradient(predictors, responses, begin, gradient,
+          batchSize);
+    }
+
+    return BatchGradient(predictors, responses, begin, batchSize, gradient);
+  }
+
+  prefetcher.Next(predictors, responses, ordering, begin, batchSize,
+      prefetch);
+  if (numThreads > 1 && batchSize >= numThreads)
+  {
+    return ParallelGradient(prefetcher.Predictors(), prefetcher.Responses(),
+        0, gradient, batchSize);
+  }
+
+  return BatchGradient(prefetcher.Predictors(), prefetcher.Responses(), 0,
+      batchSize, gradient);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::
+EvaluateWithGradient(const arma::mat& parameters,
+                     const size_t begin,
+                     arma::sp_mat& gradient,
+                     const size_t batchSize)
+{
+  // The Lookup layers keep their gradient as the columns of the tokens in the
+  // batch only, and leave their part of the dense gradient alone.
+  SetSparseLookupGradients(true);
+  const double res = EvaluateWithGradient(parameters, begin, denseGradient,
+      batchSize);
+  BuildSparseGradient(gradient);
+  SetSparseLookupGradients(false);
+  return res;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void FFN<OutputLayerType, InitializationRuleType,
+         CustomLayers...>::SetSparseLookupGradients(const bool sparse)
+{
+  for (size_t r = 0; r <= replicas.size(); ++r)
+  {
+    std::vector<LayerTypes<CustomLayers...> >& layers = (r == 0) ? network :
+        replicas[r - 1]->network;
+    for (size_t i = 0; i < layers.size(); ++i)
+    {
+      Lookup<>** lookup = boost::get<Lookup<>*>(&layers[i]);
+      if (lookup)
+      {
+        (*lookup)->SparseGradient() = sparse;
+        (*lookup)->ClearTouched();
+      }
+    }
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void FFN<OutputLayerType, InitializationRuleType,
+         CustomLayers...>::BuildSparseGradient(arma::sp_mat& gradient) const
+{
+  std::vector<arma::uword> rows;
+  std::vector<double> values;
+  size_t offset = 0;
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    const size_t weights = boost::apply_visitor(weightSizeVisitor,
+        network[i]);
+    if (!boost::get<Lookup<>*>(&network[i]))
+    {
+      for (size_t j = offset; j < offset + weights; ++j)
+      {
+        if (denseGradient[j] != 0)
+        {
+          rows.push_back(j);
+          values.push_back(denseGradient[j]);
+        }
+      }
+    }
+    else
+    {
+      // With several threads, each copy of the layer has the columns of its
+      // part of the batch; repeated entries are summed below.
+      for (size_t r = 0; r <= replicas.size(); ++r)
+      {
+        const Lookup<>* lookup = boost::get<Lookup<>*>((r == 0) ?
+            network[i] : replicas[r - 1]->network[i]);
+        const arma::uvec& columns = lookup->TouchedColumns();
+        const arma::mat& columnGradient = lookup->TouchedGradient();
+        for (size_t c = 0; c < columns.n_elem; ++c)
+        {
+          for (size_t k = 0; k < columnGradient.n_rows; ++k)
+          {
+            rows.push_back(offset + columns[c] * columnGradient.n_rows + k);
+            values.push_back(columnGradient(k, c));
+          }
+        }
+      }
+    }
+
+    offset += weights;
+  }
+
+  arma::umat locations(2, rows.size(), arma::fill::zeros);
+  for (size_t j = 0; j < rows.size(); ++j)
+    locations(0, j) = rows[j];
+
+  gradient = arma::sp_mat(true, locations, arma::vec(values),
+      denseGradient.n_rows, denseGradient.n_cols);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+template<typename GradType>
+double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::
+BatchGradient(const arma::mat& predictors,
+              const arma::mat& responses,
+              const size_t begin,
+              const size_t batchSize,
+              GradType& gradient)
+{
+  // Wrap matrices around the batch to avoid a copy; the network does not
+  // modify them.
+  arma::mat batchPredictors(const_cast<double*>(predictors.colptr(begin)),
+      predictors.n_rows, batchSize, false, true);
+  arma::mat batchResponses(const_cast<double*>(responses.colptr(begin)),
+      responses.n_rows, batchSize, false, true);
+
+  Forward(std::move(batchPredictors));
   double res = outputLayer.Forward(
       std::move(boost::apply_visitor(outputParameterVisitor, network.back())),
-      std::move(responses.cols(begin, begin + batchSize - 1)));
+      std::move(batchResponses));
 
   for (size_t i = 0; i < network.size(); ++i)
   {
@@ -334,16 +637,179 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
 
   outputLayer.Backward(
       std::move(boost::apply_visitor(outputParameterVisitor, network.back())),
-      std::move(responses.cols(begin, begin + batchSize - 1)),
-      std::move(error));
+      std::move(batchResponses), std::move(error));
 
+  // The gradients are set up before the backward pass, since checkpointed
+  // Sequential layers compute their gradient in Backward().
+  ResetGradients(gradient);
   Backward();
+  Gradient(std::move(batchPredictors));
+
+  return res;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+template<typename GradType>
+double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::
+BatchGradient(const arma::sp_mat& predictors,
+              const arma::mat& responses,
+              const size_t begin,
+              const size_t batchSize,
+              GradType& gradient)
+{
+  // Extracting the columns of a sparse matrix only copies their nonzero
+  // elements; a gathered batch is used as it is.
+  arma::sp_mat batchColumns;
+  if (begin > 0 || batchSize < predictors.n_cols)
+    batchColumns = predictors.cols(begin, begin + batchSize - 1);
+  const arma::sp_mat& batchPredictors = (begin > 0 ||
+      batchSize < predictors.n_cols) ? batchColumns : predictors;
+  arma::mat batchResponses(const_cast<double*>(responses.colptr(begin)),
+      responses.n_rows, batchSize, false, true);
+
+  Forward(batchPredictors);
+  double res = outputLayer.Forward(
+      std::move(boost::apply_visitor(outputParameterVisitor, network.back())),
+      std::move(batchResponses));
+
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    res += boost::apply_visitor(lossVisitor, network[i]);
+  }
+
+  outputLayer.Backward(
+      std::move(boost::apply_visitor(outputParameterVisitor, network.back())),
+      std::move(batchResponses), std::move(error));
+
   ResetGradients(gradient);
-  Gradient(std::move(predictors.cols(begin, begin + batchSize - 1)));
+  Backward();
+  Gradient(batchPredictors);
 
   return res;
 }
 
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+template<typename PredictorsType>
+double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::
+ParallelGradient(const PredictorsType& predictors,
+                 const arma::mat& responses,
+                 const size_t begin,
+                 arma::mat& gradient,
+                 const size_t batchSize)
+{
+  ResetReplicas();
+
+  // Every thread gets a contiguous part of the batch and its own copy of the
+  // network; the first part is computed by this network.
+  double res = 0;
+  #pragma omp parallel for reduction(+:res) num_threads(numThreads)
+  for (omp_size_t t = 0; t < (omp_size_t) numThreads; ++t)
+  {
+    const size_t first = begin + t * batchSize / numThreads;
+    const size_t last = begin + (t + 1) * batchSize / numThreads;
+
+    FFN& model = (t == 0) ? *this : *replicas[t - 1];
+    arma::mat& modelGradient = (t == 0) ? gradient : replicaGradients[t - 1];
+    if (t > 0)
+      modelGradient.zeros(parameter.n_rows, parameter.n_cols);
+
+    res += model.BatchGradient(predictors, responses, first, last - first,
+        modelGradient);
+  }
+
+  // Sum the gradients pairwise: with a stride of s, the gradient of thread t
+  // gets the gradient of thread t + s added for every t that is a multiple
+  // of 2s, until the sum is in the gradient of the first thread.
+  for (size_t stride = 1; stride < numThreads; stride *= 2)
+  {
+    const size_t pairs = (numThreads - stride + 2 * stride - 1) / (2 * stride);
+
+    #pragma omp parallel for num_threads(pairs)
+    for (omp_size_t k = 0; k < (omp_size_t) pairs; ++k)
+    {
+      const size_t t = 2 * stride * k;
+      arma::mat& target = (t == 0) ? gradient : replicaGradients[t - 1];
+      target += replicaGradients[t + stride - 1];
+    }
+  }
+
+  // The calls of the copies are recorded as calls of this network.
+  if (profiler.Enabled())
+  {
+    for (size_t i = 0; i < replicas.size(); ++i)
+    {
+      profiler.Merge(replicas[i]->profiler);
+      replicas[i]->profiler.Clear();
+    }
+  }
+
+  return res;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void FFN<OutputLayerType, InitializationRuleType,
+         CustomLayers...>::ResetReplicas()
+{
+  // Build new copies if the number of threads or the layers have changed.
+  if (replicas.size() != numThreads - 1 || (!replicas.empty() &&
+      replicas.front()->network.size() != network.size()))
+  {
+    for (size_t i = 0; i < replicas.size(); ++i)
+      delete replicas[i];
+    replicas.clear();
+
+    for (size_t i = 1; i < numThreads; ++i)
+    {
+      FFN* replica = new FFN(outputLayer, initializeRule);
+      replica->width = width;
+      replica->height = height;
+      replica->reset = reset;
+      for (size_t j = 0; j < network.size(); ++j)
+      {
+        replica->network.push_back(boost::apply_visitor(copyVisitor,
+            network[j]));
+      }
+
+      replicas.push_back(replica);
+    }
+
+    replicaGradients.resize(replicas.size());
+  }
+
+  for (size_t i = 0; i < replicas.size(); ++i)
+  {
+    FFN& replica = *replicas[i];
+
+    // The optimizer may have given the network a new parameter matrix.
+    if (replica.parameter.memptr() != parameter.memptr() ||
+        replica.parameter.n_elem != parameter.n_elem)
+    {
+      replica.parameter = arma::mat(parameter.memptr(), parameter.n_rows,
+          parameter.n_cols, false, false);
+
+      size_t offset = 0;
+      for (size_t j = 0; j < replica.network.size(); ++j)
+      {
+        offset += boost::apply_visitor(WeightSetVisitor(
+            std::move(replica.parameter), offset), replica.network[j]);
+
+        boost::apply_visitor(resetVisitor, replica.network[j]);
+      }
+    }
+
+    if (replica.deterministic != deterministic)
+    {
+      replica.deterministic = deterministic;
+      replica.ResetDeterministic();
+    }
+
+    replica.profiler.Enabled() = profiler.Enabled();
+  }
+}
+
 template<typename OutputLayerType, typename InitializationRuleType,
          typename... CustomLayers>
 void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Gradient(
@@ -359,7 +825,34 @@ template<typename OutputLayerType, typename InitializationRuleType,
          typename... CustomLayers>
 void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Shuffle()
 {
-  math::ShuffleData(predictors, responses, predictors, responses);
+  // Only the order of the points is shuffled, so the data is never moved.
+  densePrefetcher.Reset();
+  sparsePrefetcher.Reset();
+  ordering = arma::shuffle(arma::linspace<arma::uvec>(0, responses.n_cols - 1,
+      responses.n_cols));
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void FFN<OutputLayerType, InitializationRuleType,
+         CustomLayers...>::StopPrefetch()
+{
+  prefetch = false;
+  densePrefetcher.Reset();
+  sparsePrefetcher.Reset();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void FFN<OutputLayerType, InitializationRuleType,
+         CustomLayers...>::CheckOrdering()
+{
+  if (!ordering.is_empty() && ordering.n_elem != responses.n_cols)
+  {
+    densePrefetcher.Reset();
+    sparsePrefetcher.Reset();
+    ordering.reset();
+  }
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
@@ -403,10 +896,30 @@ template<typename OutputLayerType, typename InitializationRuleType,
 void FFN<OutputLayerType, InitializationRuleType,
          CustomLayers...>::Forward(arma::mat&& input)
 {
-  boost::apply_visitor(ForwardVisitor(std::move(input), std::move(
-      boost::apply_visitor(outputParameterVisitor, network.front()))),
-      network.front());
+  profiler.Apply(LayerProfiler::FORWARD_PASS, 0, ForwardVisitor(
+      std::move(input), std::move(boost::apply_visitor(outputParameterVisitor,
+      network.front()))), network.front());
+
+  ForwardLayers();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void FFN<OutputLayerType, InitializationRuleType,
+         CustomLayers...>::Forward(const arma::sp_mat& input)
+{
+  profiler.Apply(LayerProfiler::FORWARD_PASS, 0, SparseForwardVisitor(input,
+      std::move(boost::apply_visitor(outputParameterVisitor,
+      network.front()))), network.front());
+
+  ForwardLayers();
+}
 
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void FFN<OutputLayerType, InitializationRuleType,
+         CustomLayers...>::ForwardLayers()
+{
   if (!reset)
   {
     if (boost::apply_visitor(outputWidthVisitor, network.front()) != 0)
@@ -431,9 +944,10 @@ void FFN<OutputLayerType, InitializationRuleType,
       boost::apply_visitor(SetInputHeightVisitor(height), network[i]);
     }
 
-    boost::apply_visitor(ForwardVisitor(std::move(boost::apply_visitor(
-        outputParameterVisitor, network[i - 1])), std::move(
-        boost::apply_visitor(outputParameterVisitor, network[i]))), network[i]);
+    profiler.Apply(LayerProfiler::FORWARD_PASS, i, ForwardVisitor(std::move(
+        boost::apply_visitor(outputParameterVisitor, network[i - 1])),
+        std::move(boost::apply_visitor(outputParameterVisitor, network[i]))),
+        network[i]);
 
     if (!reset)
     {
@@ -459,17 +973,19 @@ template<typename OutputLayerType, typename InitializationRuleType,
          typename... CustomLayers>
 void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Backward()
 {
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, network.back())), std::move(error), std::move(
-      boost::apply_visitor(deltaVisitor, network.back()))), network.back());
+  profiler.Apply(LayerProfiler::BACKWARD_PASS, network.size() - 1,
+      BackwardVisitor(std::move(boost::apply_visitor(outputParameterVisitor,
+      network.back())), std::move(error), std::move(boost::apply_visitor(
+      deltaVisitor, network.back()))), network.back());
 
   for (size_t i = 2; i < network.size(); ++i)
   {
-    boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-        outputParameterVisitor, network[network.size() - i])), std::move(
-        boost::apply_visitor(deltaVisitor, network[network.size() - i + 1])),
-        std::move(boost::apply_visitor(deltaVisitor,
-        network[network.size() - i]))), network[network.size() - i]);
+    profiler.Apply(LayerProfiler::BACKWARD_PASS, network.size() - i,
+        BackwardVisitor(std::move(boost::apply_visitor(outputParameterVisitor,
+        network[network.size() - i])), std::move(boost::apply_visitor(
+        deltaVisitor, network[network.size() - i + 1])), std::move(
+        boost::apply_visitor(deltaVisitor, network[network.size() - i]))),
+        network[network.size() - i]);
   }
 }
 
@@ -478,18 +994,41 @@ template<typename OutputLayerType, typename InitializationRuleType,
 void FFN<OutputLayerType, InitializationRuleType,
          CustomLayers...>::Gradient(arma::mat&& input)
 {
-  boost::apply_visitor(GradientVisitor(std::move(input), std::move(
-      boost::apply_visitor(deltaVisitor, network[1]))), network.front());
+  profiler.Apply(LayerProfiler::GRADIENT_PASS, 0, GradientVisitor(
+      std::move(input), std::move(boost::apply_visitor(deltaVisitor,
+      network[1]))), network.front());
 
+  GradientLayers();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void FFN<OutputLayerType, InitializationRuleType,
+         CustomLayers...>::Gradient(const arma::sp_mat& input)
+{
+  profiler.Apply(LayerProfiler::GRADIENT_PASS, 0, SparseGradientVisitor(input,
+      std::move(boost::apply_visitor(deltaVisitor, network[1]))),
+      network.front());
+
+  GradientLayers();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void FFN<OutputLayerType, InitializationRuleType,
+         CustomLayers...>::GradientLayers()
+{
   for (size_t i = 1; i < network.size() - 1; ++i)
   {
-    boost::apply_visitor(GradientVisitor(std::move(boost::apply_visitor(
-        outputParameterVisitor, network[i - 1])), std::move(
-        boost::apply_visitor(deltaVisitor, network[i + 1]))), network[i]);
+    profiler.Apply(LayerProfiler::GRADIENT_PASS, i, GradientVisitor(
+        std::move(boost::apply_visitor(outputParameterVisitor,
+        network[i - 1])), std::move(boost::apply_visitor(deltaVisitor,
+        network[i + 1]))), network[i]);
   }
 
-  boost::apply_visitor(GradientVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, network[network.size() - 2])), std::move(error)),
+  profiler.Apply(LayerProfiler::GRADIENT_PASS, network.size() - 1,
+      GradientVisitor(std::move(boost::apply_visitor(outputParameterVisitor,
+      network[network.size() - 2])), std::move(error)),
       network[network.size() - 1]);
 }
 
@@ -543,6 +1082,91 @@ void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::serialize(
   }
 }
 
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::SaveFlat(
+    const std::string& filename) const
+{
+  if (parameter.is_empty())
+    throw std::invalid_argument("FFN::SaveFlat(): the parameters of the "
+        "network have not been initialized");
+
+  // The layer graph holds everything serialize() does, except the parameters
+  // and the last input.
+  std::ostringstream graph;
+  {
+    boost::archive::binary_oarchive ar(graph);
+    ar << BOOST_SERIALIZATION_NVP(width);
+    ar << BOOST_SERIALIZATION_NVP(height);
+    ar << BOOST_SERIALIZATION_NVP(reset);
+    ar << BOOST_SERIALIZATION_NVP(network);
+  }
+
+  WeightFileIO::Save(filename, graph.str(), parameter);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::LoadFlat(
+    const std::string& filename)
+{
+  // Map the new file and build the layers before releasing the old ones, so
+  // that we are left unchanged if the file is invalid.
+  std::shared_ptr<util::MappedFile> newFile(new util::MappedFile(filename));
+  arma::mat newParameter;
+  std::istringstream graph(WeightFileIO::Load(*newFile, newParameter));
+
+  size_t newWidth, newHeight;
+  bool newReset;
+  std::vector<LayerTypes<CustomLayers...> > newNetwork;
+  {
+    boost::archive::binary_iarchive ar(graph);
+    ar >> BOOST_SERIALIZATION_NVP(newWidth);
+    ar >> BOOST_SERIALIZATION_NVP(newHeight);
+    ar >> BOOST_SERIALIZATION_NVP(newReset);
+    ar >> BOOST_SERIALIZATION_NVP(newNetwork);
+  }
+
+  size_t weights = 0;
+  for (size_t i = 0; i < newNetwork.size(); ++i)
+    weights += boost::apply_visitor(weightSizeVisitor, newNetwork[i]);
+
+  if (weights != newParameter.n_elem)
+  {
+    std::for_each(newNetwork.begin(), newNetwork.end(),
+        boost::apply_visitor(deleteVisitor));
+    throw std::runtime_error("FFN::LoadFlat(): the parameters in '" + filename +
+        "' do not match the layers of the network");
+  }
+
+  std::for_each(network.begin(), network.end(),
+      boost::apply_visitor(deleteVisitor));
+
+  // The replicas hold copies of the old layers.
+  for (size_t i = 0; i < replicas.size(); ++i)
+    delete replicas[i];
+  replicas.clear();
+
+  network = std::move(newNetwork);
+  width = newWidth;
+  height = newHeight;
+  reset = newReset;
+  parameter = std::move(newParameter);
+  mappedFile = std::move(newFile);
+
+  size_t offset = 0;
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    offset += boost::apply_visitor(WeightSetVisitor(std::move(parameter),
+        offset), network[i]);
+
+    boost::apply_visitor(resetVisitor, network[i]);
+  }
+
+  deterministic = true;
+  ResetDeterministic();
+}
+
 template<typename OutputLayerType, typename InitializationRuleType,
          typename... CustomLayers>
 void FFN<OutputLayerType, InitializationRuleType,
@@ -555,8 +1179,11 @@ void FFN<OutputLayerType, InitializationRuleType,
   std::swap(reset, network.reset);
   std::swap(this->network, network.network);
   std::swap(predictors, network.predictors);
+  std::swap(sparsePredictors, network.sparsePredictors);
   std::swap(responses, network.responses);
+  std::swap(ordering, network.ordering);
   std::swap(parameter, network.parameter);
+  std::swap(mappedFile, network.mappedFile);
   std::swap(numFunctions, network.numFunctions);
   std::swap(error, network.error);
   std::swap(currentInput, network.currentInput);
@@ -565,6 +1192,10 @@ void FFN<OutputLayerType, InitializationRuleType,
   std::swap(inputParameter, network.inputParameter);
   std::swap(outputParameter, network.outputParameter);
   std::swap(gradient, network.gradient);
+  std::swap(numThreads, network.numThreads);
+  std::swap(replicas, network.replicas);
+  std::swap(replicaGradients, network.replicaGradients);
+  std::swap(profiler, network.profiler);
 };
 
 template<typename OutputLayerType, typename InitializationRuleType,
@@ -577,7 +1208,10 @@ FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::FFN(
     height(network.height),
     reset(network.reset),
     predictors(network.predictors),
+    sparsePredictors(network.sparsePredictors),
     responses(network.responses),
+    ordering(network.ordering),
+    prefetch(false),
     parameter(network.parameter),
     numFunctions(network.numFunctions),
     error(network.error),
@@ -586,7 +1220,9 @@ FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::FFN(
     delta(network.delta),
     inputParameter(network.inputParameter),
     outputParameter(network.outputParameter),
-    gradient(network.gradient)
+    gradient(network.gradient),
+    numThreads(network.numThreads),
+    profiler(network.profiler)
 {
   // Build new layers according to source network
   for (size_t i = 0; i < network.network.size(); ++i)
@@ -606,8 +1242,12 @@ FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::FFN(
     height(network.height),
     reset(network.reset),
     predictors(std::move(network.predictors)),
+    sparsePredictors(std::move(network.sparsePredictors)),
     responses(std::move(network.responses)),
+    ordering(std::move(network.ordering)),
+    prefetch(false),
     parameter(std::move(network.parameter)),
+    mappedFile(std::move(network.mappedFile)),
     numFunctions(network.numFunctions),
     error(std::move(network.error)),
     currentInput(std::move(network.currentInput)),
@@ -615,9 +1255,14 @@ FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::FFN(
     delta(std::move(network.delta)),
     inputParameter(std::move(network.inputParameter)),
     outputParameter(std::move(network.outputParameter)),
-    gradient(std::move(network.gradient))
+    gradient(std::move(network.gradient)),
+    numThreads(network.numThreads),
+    replicas(std::move(network.replicas)),
+    replicaGradients(std::move(network.replicaGradients)),
+    profiler(std::move(network.profiler))
 {
   this->network = std::move(network.network);
+  network.replicas.clear();
 };
 
 template<typename OutputLayerType, typename InitializationRuleType,
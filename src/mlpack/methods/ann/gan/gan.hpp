@@ -313,6 +313,61 @@ class GAN
   void serialize(Archive& ar, const unsigned int /* version */);
 
  private:
+  /**
+   * Fill the noise matrix with samples of the noise function.
+   */
+  void SampleNoise() { SampleNoise(noiseFunction, noise, 0); }
+
+  /**
+   * Fill the given matrix at once, for a noise function that takes the matrix
+   * to fill.
+   */
+  template<typename NoiseType>
+  static auto SampleNoise(NoiseType& noiseFunction, arma::mat& noise, int)
+      -> decltype(noiseFunction(noise), void())
+  {
+    noiseFunction(noise);
+  }
+
+  /**
+   * Fill the given matrix one element at a time, for a noise function that
+   * returns a single sample.
+   */
+  template<typename NoiseType>
+  static void SampleNoise(NoiseType& noiseFunction, arma::mat& noise, long)
+  {
+    noise.imbue([&]() { return noiseFunction(); });
+  }
+
+  /**
+   * Put the real points starting at the given index and the generated points
+   * next to each other, so that the Discriminator handles both in one pass.
+   *
+   * @param i Index of the first real point.
+   * @param fakeResponse The response of the generated points.
+   */
+  void StackBatches(const size_t i, const double fakeResponse);
+
+  /**
+   * Compute the objective of the Discriminator on the stacked batch.
+   */
+  double DiscriminatorObjective();
+
+  /**
+   * Compute the objective and the gradient of the Discriminator on the
+   * stacked batch, and store the gradient in gradientDiscriminator.
+   */
+  double DiscriminatorGradient();
+
+  /**
+   * Pass the generated points through the Discriminator with the given
+   * response, and store the error at its input as the error of the
+   * Generator.  The gradient of the Discriminator is not computed.
+   *
+   * @param response The response of the generated points.
+   */
+  void GeneratorError(const double response);
+
   //! Locally stored parameter for training data + noise data.
   arma::mat predictors;
   //! Locally stored parameters of the network.
@@ -365,8 +420,10 @@ class GAN
   arma::mat gradient;
   //! Locally stored gradient for Discriminator.
   arma::mat gradientDiscriminator;
-  //! Locally stored gradient for noise data in the predictors.
-  arma::mat noiseGradientDiscriminator;
+  //! Locally stored real and generated points of the current batch.
+  arma::mat stackedPredictors;
+  //! Locally stored responses of the stacked batch.
+  arma::mat stackedResponses;
   //! Locally stored norm of the gradient of Discriminator.
   arma::mat normGradientDiscriminator;
   //! Locally stored noise using the noise function.
@@ -184,6 +184,86 @@ void GAN<Model, InitializationRuleType, Noise, PolicyType>::Reset()
   reset = true;
 }
 
+template<
+  typename Model,
+  typename InitializationRuleType,
+  typename Noise,
+  typename PolicyType
+>
+void GAN<Model, InitializationRuleType, Noise, PolicyType>::StackBatches(
+    const size_t i, const double fakeResponse)
+{
+  stackedPredictors.set_size(predictors.n_rows, 2 * batchSize);
+  stackedPredictors.cols(0, batchSize - 1) =
+      predictors.cols(i, i + batchSize - 1);
+  stackedPredictors.cols(batchSize, 2 * batchSize - 1) =
+      predictors.cols(numFunctions, numFunctions + batchSize - 1);
+
+  stackedResponses.set_size(1, 2 * batchSize);
+  stackedResponses.cols(0, batchSize - 1) =
+      responses.cols(i, i + batchSize - 1);
+  stackedResponses.cols(batchSize, 2 * batchSize - 1).fill(fakeResponse);
+}
+
+template<
+  typename Model,
+  typename InitializationRuleType,
+  typename Noise,
+  typename PolicyType
+>
+double GAN<Model, InitializationRuleType, Noise, PolicyType>::
+DiscriminatorObjective()
+{
+  discriminator.Forward(std::move(stackedPredictors));
+  return discriminator.outputLayer.Forward(std::move(boost::apply_visitor(
+      outputParameterVisitor, discriminator.network.back())),
+      std::move(stackedResponses));
+}
+
+template<
+  typename Model,
+  typename InitializationRuleType,
+  typename Noise,
+  typename PolicyType
+>
+double GAN<Model, InitializationRuleType, Noise, PolicyType>::
+DiscriminatorGradient()
+{
+  if (discriminator.deterministic)
+  {
+    discriminator.deterministic = false;
+    discriminator.ResetDeterministic();
+  }
+
+  return discriminator.BatchGradient(stackedPredictors, stackedResponses, 0,
+      2 * batchSize, gradientDiscriminator);
+}
+
+template<
+  typename Model,
+  typename InitializationRuleType,
+  typename Noise,
+  typename PolicyType
+>
+void GAN<Model, InitializationRuleType, Noise, PolicyType>::GeneratorError(
+    const double response)
+{
+  responses.cols(numFunctions, numFunctions + batchSize - 1).fill(response);
+  currentInput = arma::mat(predictors.colptr(numFunctions), predictors.n_rows,
+      batchSize, false, false);
+  currentTarget = arma::mat(responses.colptr(numFunctions), 1, batchSize,
+      false, false);
+
+  discriminator.Forward(std::move(currentInput));
+  discriminator.outputLayer.Backward(std::move(boost::apply_visitor(
+      outputParameterVisitor, discriminator.network.back())),
+      std::move(currentTarget), std::move(discriminator.error));
+  discriminator.Backward();
+
+  generator.error = boost::apply_visitor(deltaVisitor,
+      discriminator.network[1]);
+}
+
 template<
   typename Model,
   typename InitializationRuleType,
@@ -216,35 +296,13 @@ GAN<Model, InitializationRuleType, Noise, PolicyType>::Evaluate(
   if (!reset)
     Reset();
 
-  currentInput = arma::mat(predictors.memptr() + (i * predictors.n_rows),
-      predictors.n_rows, batchSize, false, false);
-  currentTarget = arma::mat(responses.memptr() + i, 1, batchSize, false,
-      false);
-
-  discriminator.Forward(std::move(currentInput));
-  double res = discriminator.outputLayer.Forward(
-      std::move(boost::apply_visitor(
-      outputParameterVisitor,
-      discriminator.network.back())), std::move(currentTarget));
-
-  noise.imbue( [&]() { return noiseFunction();} );
+  SampleNoise();
   generator.Forward(std::move(noise));
-
   predictors.cols(numFunctions, numFunctions + batchSize - 1) =
       boost::apply_visitor(outputParameterVisitor, generator.network.back());
-  discriminator.Forward(std::move(predictors.cols(numFunctions,
-      numFunctions + batchSize - 1)));
-  responses.cols(numFunctions, numFunctions + batchSize - 1) =
-      arma::zeros(1, batchSize);
-
-  currentTarget = arma::mat(responses.memptr() + numFunctions,
-      1, batchSize, false, false);
-  res += discriminator.outputLayer.Forward(
-      std::move(boost::apply_visitor(
-      outputParameterVisitor,
-      discriminator.network.back())), std::move(currentTarget));
 
-  return res;
+  StackBatches(i, 0);
+  return DiscriminatorObjective();
 }
 
 template<
@@ -274,16 +332,6 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
   else
     gradient.zeros();
 
-  if (noiseGradientDiscriminator.is_empty())
-  {
-    noiseGradientDiscriminator = arma::zeros<arma::mat>(
-        gradientDiscriminator.n_elem, 1);
-  }
-  else
-  {
-    noiseGradientDiscriminator.zeros();
-  }
-
   gradientGenerator = arma::mat(gradient.memptr(),
       generator.Parameters().n_elem, 1, false, false);
 
@@ -291,32 +339,21 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
       gradientGenerator.n_elem,
       discriminator.Parameters().n_elem, 1, false, false);
 
-  // Get the gradients of the Discriminator.
-  double res = discriminator.EvaluateWithGradient(discriminator.parameter,
-      i, gradientDiscriminator, batchSize);
-
-  noise.imbue( [&]() { return noiseFunction();} );
+  SampleNoise();
   generator.Forward(std::move(noise));
   predictors.cols(numFunctions, numFunctions + batchSize - 1) =
       boost::apply_visitor(outputParameterVisitor, generator.network.back());
-  responses.cols(numFunctions, numFunctions + batchSize - 1) =
-      arma::zeros(1, batchSize);
 
-  // Get the gradients of the Generator.
-  res += discriminator.EvaluateWithGradient(discriminator.parameter,
-      numFunctions, noiseGradientDiscriminator, batchSize);
-  gradientDiscriminator += noiseGradientDiscriminator;
+  // Get the gradients of the Discriminator on the real and the generated
+  // points at once.
+  StackBatches(i, 0);
+  double res = DiscriminatorGradient();
 
   if (currentBatch % generatorUpdateStep == 0 && preTrainSize == 0)
   {
     // Minimize -log(D(G(noise))).
     // Pass the error from Discriminator to Generator.
-    responses.cols(numFunctions, numFunctions + batchSize - 1) =
-        arma::ones(1, batchSize);
-    discriminator.Gradient(discriminator.parameter, numFunctions,
-        noiseGradientDiscriminator, batchSize);
-    generator.error = boost::apply_visitor(deltaVisitor,
-        discriminator.network[1]);
+    GeneratorError(1);
 
     generator.Predictors() = noise;
     generator.ResetGradients(gradientGenerator);
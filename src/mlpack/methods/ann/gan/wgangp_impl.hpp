@@ -40,33 +40,17 @@ GAN<Model, InitializationRuleType, Noise, PolicyType>::Evaluate(
 
   currentInput = arma::mat(predictors.memptr() + (i * predictors.n_rows),
       predictors.n_rows, batchSize, false, false);
-  currentTarget = arma::mat(responses.memptr() + i, 1, batchSize, false,
-      false);
 
-  discriminator.Forward(std::move(currentInput));
-  double res = discriminator.outputLayer.Forward(
-      std::move(boost::apply_visitor(
-      outputParameterVisitor,
-      discriminator.network.back())), std::move(currentTarget));
-
-  noise.imbue( [&]() { return noiseFunction();} );
+  SampleNoise();
   generator.Forward(std::move(noise));
 
   arma::mat generatedData = boost::apply_visitor(outputParameterVisitor,
       generator.network.back());
   predictors.cols(numFunctions, numFunctions + batchSize - 1) =
       generatedData;
-  discriminator.Forward(std::move(predictors.cols(numFunctions,
-      numFunctions + batchSize - 1)));
-  responses.cols(numFunctions, numFunctions + batchSize - 1) =
-      -arma::ones(1, batchSize);
 
-  currentTarget = arma::mat(responses.memptr() + numFunctions,
-      1, batchSize, false, false);
-  res += discriminator.outputLayer.Forward(
-      std::move(boost::apply_visitor(
-      outputParameterVisitor,
-      discriminator.network.back())), std::move(currentTarget));
+  StackBatches(i, -1);
+  double res = DiscriminatorObjective();
 
   // Gradient Penalty is calculated here.
   double epsilon = math::Random();
@@ -108,16 +92,6 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
   else
     gradient.zeros();
 
-  if (noiseGradientDiscriminator.is_empty())
-  {
-    noiseGradientDiscriminator = arma::zeros<arma::mat>(
-        gradientDiscriminator.n_elem, 1);
-  }
-  else
-  {
-    noiseGradientDiscriminator.zeros();
-  }
-
   gradientGenerator = arma::mat(gradient.memptr(),
       generator.Parameters().n_elem, 1, false, false);
 
@@ -128,11 +102,7 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
   currentInput = arma::mat(predictors.memptr() + (i * predictors.n_rows),
       predictors.n_rows, batchSize, false, false);
 
-  // Get the gradients of the Discriminator.
-  double res = discriminator.EvaluateWithGradient(discriminator.parameter,
-      i, gradientDiscriminator, batchSize);
-
-  noise.imbue( [&]() { return noiseFunction();} );
+  SampleNoise();
   generator.Forward(std::move(noise));
   arma::mat generatedData = boost::apply_visitor(outputParameterVisitor,
       generator.network.back());
@@ -145,24 +115,21 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
       -arma::ones(1, batchSize);
   discriminator.Gradient(discriminator.parameter, numFunctions,
       normGradientDiscriminator, batchSize);
-  res += lambda * std::pow(arma::norm(normGradientDiscriminator, 2) - 1, 2);
+  double res = lambda * std::pow(arma::norm(normGradientDiscriminator, 2) - 1,
+      2);
 
+  // Get the gradients of the Discriminator on the real and the generated
+  // points at once.
   predictors.cols(numFunctions, numFunctions + batchSize - 1) =
       generatedData;
-  res += discriminator.EvaluateWithGradient(discriminator.parameter,
-      numFunctions, noiseGradientDiscriminator, batchSize);
-  gradientDiscriminator += noiseGradientDiscriminator;
+  StackBatches(i, -1);
+  res += DiscriminatorGradient();
 
   if (currentBatch % generatorUpdateStep == 0 && preTrainSize == 0)
   {
     // Minimize -D(G(noise)).
     // Pass the error from Discriminator to Generator.
-    responses.cols(numFunctions, numFunctions + batchSize - 1) =
-        arma::ones(1, batchSize);
-    discriminator.Gradient(discriminator.parameter, numFunctions,
-        noiseGradientDiscriminator, batchSize);
-    generator.error = boost::apply_visitor(deltaVisitor,
-        discriminator.network[1]);
+    GeneratorError(1);
 
     generator.Predictors() = noise;
     generator.ResetGradients(gradientGenerator);
@@ -0,0 +1,425 @@
+/**
+ * @file inference_ffn.hpp
+ *
+ * Definition of the InferenceFFN class, a prediction-only version of a trained
+ * feed forward network with fused layers.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_INFERENCE_FFN_HPP
+#define MLPACK_METHODS_ANN_INFERENCE_FFN_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "ffn.hpp"
+#include "convolution_rules/im2col_convolution.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * A prediction-only version of a trained FFN.  When it is built, each Linear
+ * or LinearNoBias layer is fused with the layers that follow it:
+ *
+ *  - a BatchNorm layer directly after it is folded into its weights and bias,
+ *    using the mean and variance over the training data, as in deterministic
+ *    mode;
+ *  - a following ReLULayer, TanHLayer, SigmoidLayer or LeakyReLU layer is
+ *    applied in the same pass over the output that adds the bias.
+ *
+ * So a Linear, BatchNorm and ReLULayer sequence is computed with one matrix
+ * product and one pass over its output.  All other layers are copied and run
+ * in deterministic mode.  Only the weights needed for prediction are kept;
+ * the outputs, deltas and gradients of the layers are not, and the output of
+ * each stage is written into one of two shared buffers instead.
+ *
+ * @code
+ * FFN<> model;
+ * // Add layers and train the model...
+ *
+ * InferenceFFN<> predictor(model);
+ * arma::mat predictions;
+ * predictor.Predict(testData, predictions);
+ * @endcode
+ *
+ * The buffers and everything else a prediction writes can also be kept in a
+ * caller-owned Context.  Predict() with a context does not modify the
+ * predictor, so several threads can predict with the same predictor at once
+ * if each one uses its own context:
+ *
+ * @code
+ * #pragma omp parallel
+ * {
+ *   InferenceFFN<>::Context context;
+ *   arma::mat predictions;
+ *   // Get the data of the thread...
+ *   predictor.Predict(threadData, predictions, context);
+ * }
+ * @endcode
+ *
+ * The weights of the fused stages and of the layers that do not keep any
+ * state in their forward pass (the activation layers, BatchNorm, Dropout and
+ * LogSoftMax, for instance) are shared by all contexts.  Other layers, like
+ * Convolution or MaxPooling, write into their members when they compute
+ * their output, so each context gets its own copy of them.
+ *
+ * The predictor can also be quantized.  Then the weights of the fused Linear
+ * and LinearNoBias stages, and of the Convolution layers (with the same
+ * stride in both directions), are stored as 8-bit integers with one scale
+ * for each output (or output map).  The inputs of these stages are quantized
+ * to 8-bit integers too, with one scale for each point that is computed from
+ * the largest absolute value of the point, and the products are computed
+ * with integer arithmetic.  If calibration data is given, the input scales
+ * of the stages are instead fixed to what the data gives when it is passed
+ * through the network, and larger inputs are clipped.  A Convolution layer
+ * is quantized together with an activation layer that directly follows it.
+ *
+ * @code
+ * InferenceFFN<> quantized(model, true);
+ * InferenceFFN<> calibrated(model, calibrationData);
+ * @endcode
+ *
+ * @tparam CustomLayers Any set of custom layers that could be a part of the
+ *         feed forward network.
+ */
+template<typename... CustomLayers>
+class InferenceFFN
+{
+ public:
+  /**
+   * The state of a prediction: the buffers the stages write their outputs
+   * into, and copies of the layers that cannot be shared.  A context is set
+   * up on its first use, and can be reused for later calls of Predict() with
+   * the same predictor.  Copying a context gives an empty context.
+   */
+  class Context
+  {
+   public:
+    //! Create an empty context.
+    Context() : model(NULL) { }
+
+    //! Create an empty context; there is nothing to share.
+    Context(const Context& /* other */) : model(NULL) { }
+
+    //! Release the state of the context.
+    Context& operator=(const Context& /* other */)
+    {
+      Clear();
+      return *this;
+    }
+
+    //! Destructor to release allocated memory.
+    ~Context() { Clear(); }
+
+   private:
+    //! Delete the copied layers.
+    void Clear()
+    {
+      std::for_each(layers.begin(), layers.end(),
+          boost::apply_visitor(DeleteVisitor()));
+      layers.clear();
+      model = NULL;
+    }
+
+    //! The predictor the context was set up for.
+    const InferenceFFN* model;
+
+    //! The copies of the layers that cannot be shared.
+    std::vector<LayerTypes<CustomLayers...> > layers;
+
+    //! The two buffers the stage outputs are written into.
+    arma::mat buffers[2];
+
+    //! The quantized input of the current stage.
+    arma::Mat<int8_t> quantizedInput;
+
+    //! The scale of each point of the quantized input.
+    arma::vec inputScales;
+
+    //! The unfolded patches of a quantized convolution input.
+    arma::Mat<int8_t> columns;
+
+    // The predictor sets up and uses the context.
+    friend class InferenceFFN;
+  };
+
+  /**
+   * Build the predictor from the given trained network.  The network is not
+   * modified and can be destroyed afterwards.
+   *
+   * @param network Trained network to build the predictor from.
+   * @param quantize Whether to quantize the weights and inputs of the Linear,
+   *        LinearNoBias and Convolution stages.
+   */
+  template<typename OutputLayerType, typename InitializationRuleType>
+  InferenceFFN(const FFN<OutputLayerType, InitializationRuleType,
+                         CustomLayers...>& network,
+               const bool quantize = false);
+
+  /**
+   * Build a quantized predictor from the given trained network, with the
+   * input scales of the quantized stages fixed by the given calibration data.
+   * The data is passed through a copy of the network with FFN::Forward(), and
+   * the scale of each stage is chosen so that the largest absolute value of
+   * its input is represented.  The network is not modified.
+   *
+   * @param network Trained network to build the predictor from.
+   * @param calibrationData Points like the ones the predictor will be used
+   *        with.
+   */
+  template<typename OutputLayerType, typename InitializationRuleType>
+  InferenceFFN(const FFN<OutputLayerType, InitializationRuleType,
+                         CustomLayers...>& network,
+               const arma::mat& calibrationData);
+
+  //! Copy constructor.
+  InferenceFFN(const InferenceFFN& other);
+
+  //! Move constructor.
+  InferenceFFN(InferenceFFN&& other);
+
+  //! Copy/move assignment operator.
+  InferenceFFN& operator=(InferenceFFN other);
+
+  //! Destructor to release allocated memory.
+  ~InferenceFFN();
+
+  /**
+   * Predict the responses to a given set of predictors, batchSize columns at
+   * a time.  The results are the same as the results of FFN::Predict() up to
+   * floating point error, or up to quantization error if the predictor is
+   * quantized.
+   *
+   * @param predictors Input predictors.
+   * @param results Matrix to put output predictions of responses into.
+   * @param batchSize Number of points to predict at once.
+   */
+  void Predict(const arma::mat& predictors,
+               arma::mat& results,
+               const size_t batchSize = 256);
+
+  /**
+   * Predict the responses to a given set of predictors, batchSize columns at
+   * a time, and keep everything the prediction writes in the given context.
+   * The predictor is not modified, so this can be called from several threads
+   * at once, with a different context for each thread.
+   *
+   * @param predictors Input predictors.
+   * @param results Matrix to put output predictions of responses into.
+   * @param context The state of the prediction.
+   * @param batchSize Number of points to predict at once.
+   */
+  void Predict(const arma::mat& predictors,
+               arma::mat& results,
+               Context& context,
+               const size_t batchSize = 256) const;
+
+  //! Get the number of stages the predictor runs for each batch.
+  size_t NumStages() const { return stageTypes.size(); }
+
+  //! Get the number of fused Linear stages.
+  size_t NumFused() const { return fusedLayers.size(); }
+
+  //! Get the number of quantized Linear and Convolution stages.
+  size_t NumQuantized() const;
+
+ private:
+  //! The kinds of stages of the predictor.
+  enum StageType
+  {
+    LINEAR_STAGE,
+    CONVOLUTION_STAGE,
+    LAYER_STAGE
+  };
+
+  //! The activation functions that can be fused with a Linear layer.
+  enum FusedActivation
+  {
+    IDENTITY_ACTIVATION,
+    RECTIFIER_ACTIVATION,
+    TANH_ACTIVATION,
+    LOGISTIC_ACTIVATION,
+    LEAKY_RECTIFIER_ACTIVATION
+  };
+
+  /**
+   * A Linear layer with folded batch normalization and a fused activation
+   * function.
+   */
+  struct FusedLinear
+  {
+    //! The weight matrix; empty if the stage is quantized.
+    arma::mat weight;
+    //! The bias; empty if there is none.
+    arma::vec bias;
+    //! The activation function applied after adding the bias.
+    FusedActivation activation;
+    //! The slope of the LeakyReLU activation for negative inputs.
+    double alpha;
+    //! The quantized weights, one column for each output; empty if the stage
+    //! is not quantized.
+    arma::Mat<int8_t> quantizedWeight;
+    //! The scale of the quantized weights of each output.
+    arma::vec weightScales;
+    //! The fixed scale of the quantized input; 0 if it is computed for each
+    //! point.
+    double inputScale;
+  };
+
+  /**
+   * A quantized Convolution layer with a fused activation function.
+   */
+  struct QuantizedConvolution
+  {
+    //! The quantized filters, one column for each output map.
+    arma::Mat<int8_t> weight;
+    //! The scale of the quantized filters of each output map.
+    arma::vec weightScales;
+    //! The bias of each output map.
+    arma::vec bias;
+    //! The activation function applied after adding the bias.
+    FusedActivation activation;
+    //! The slope of the LeakyReLU activation for negative inputs.
+    double alpha;
+    //! The fixed scale of the quantized input; 0 if it is computed for each
+    //! point.
+    double inputScale;
+    //! The number of input maps.
+    size_t inSize;
+    //! The number of output maps.
+    size_t outSize;
+    //! The width of the filters.
+    size_t kernelWidth;
+    //! The height of the filters.
+    size_t kernelHeight;
+    //! The stride in both directions.
+    size_t stride;
+    //! The padding width.
+    size_t padWidth;
+    //! The padding height.
+    size_t padHeight;
+    //! The width of the input maps.
+    size_t inputWidth;
+    //! The height of the input maps.
+    size_t inputHeight;
+    //! The width of the output maps.
+    size_t outputWidth;
+    //! The height of the output maps.
+    size_t outputHeight;
+  };
+
+  /**
+   * Build the stages of the predictor from the given layers.  If
+   * calibrationData is not NULL, calibrationModel holds the layers of a
+   * network that has computed the forward pass of it.
+   */
+  void Build(const std::vector<LayerTypes<CustomLayers...> >& model,
+             const bool quantize,
+             const arma::mat* calibrationData,
+             const std::vector<LayerTypes<CustomLayers...> >*
+                 calibrationModel);
+
+  /**
+   * If the given layer is a Linear or LinearNoBias layer, store its weights in
+   * the given stage and return true.
+   */
+  static bool GetLinear(const LayerTypes<CustomLayers...>& layer,
+                        FusedLinear& stage);
+
+  /**
+   * If the given layer is a Convolution layer that can be quantized, store its
+   * weights in the given stage and return true.
+   */
+  static bool GetConvolution(const LayerTypes<CustomLayers...>& layer,
+                             QuantizedConvolution& stage);
+
+  //! If the given layer is a BatchNorm layer, fold it into the given stage and
+  //! return true.
+  static bool FoldBatchNorm(const LayerTypes<CustomLayers...>& layer,
+                            FusedLinear& stage);
+
+  //! Return whether the given layer keeps no state in its forward pass in
+  //! deterministic mode, so that it can be used by several threads at once.
+  static bool IsReentrant(const LayerTypes<CustomLayers...>& layer);
+
+  //! If the given layer is a supported activation layer, store its function
+  //! and slope and return true.
+  static bool FuseActivation(const LayerTypes<CustomLayers...>& layer,
+                             FusedActivation& activation,
+                             double& alpha);
+
+  //! Quantize each column of the given weights with its own scale.
+  static void QuantizeWeights(const arma::mat& weight,
+                              arma::Mat<int8_t>& quantizedWeight,
+                              arma::vec& weightScales);
+
+  //! Return the scale that represents the largest absolute value of the given
+  //! values with 8-bit integers.
+  static double InputScale(const double* values, const size_t n);
+
+  //! Quantize the given value with the given inverse scale, and clip it to the
+  //! range of 8-bit integers.
+  static int8_t Quantize(const double value, const double inverseScale);
+
+  //! Return the dot product of the given 8-bit vectors of length n.
+  static int32_t IntegerDot(const int8_t* a, const int8_t* b, const size_t n);
+
+  //! Compute the output of the given fused stage.
+  static void Forward(const FusedLinear& stage,
+                      const arma::mat& input,
+                      arma::mat& output,
+                      Context& context);
+
+  //! Compute the output of the given quantized convolution.
+  static void Forward(const QuantizedConvolution& stage,
+                      const arma::mat& input,
+                      arma::mat& output,
+                      Context& context);
+
+  //! Apply the given activation function, after adding the bias if it is not
+  //! empty.
+  static void Activate(const FusedActivation activation,
+                       const double alpha,
+                       const arma::vec& bias,
+                       arma::mat& output);
+
+  //! Add the bias and apply the activation function in one pass.
+  template<typename ActivationFunction>
+  static void BiasActivation(const arma::vec& bias, arma::mat& output);
+
+  //! The kind of each stage.  The stages of each kind are stored, in order,
+  //! in fusedLayers, convolutionLayers and layers.
+  std::vector<StageType> stageTypes;
+
+  //! The fused Linear stages.
+  std::vector<FusedLinear> fusedLayers;
+
+  //! The quantized Convolution stages.
+  std::vector<QuantizedConvolution> convolutionLayers;
+
+  //! The copied layers that are run as they are.
+  std::vector<LayerTypes<CustomLayers...> > layers;
+
+  //! For each copied layer, whether it can be shared by several contexts.
+  std::vector<bool> isReentrant;
+
+  //! The context used by Predict() without a context.
+  Context context;
+
+  //! Locally-stored copy visitor.
+  CopyVisitor<CustomLayers...> copyVisitor;
+
+  //! Locally-stored delete visitor.
+  DeleteVisitor deleteVisitor;
+}; // class InferenceFFN
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "inference_ffn_impl.hpp"
+
+#endif
@@ -0,0 +1,631 @@
+/**
+ * @file inference_ffn_impl.hpp
+ *
+ * Implementation of the InferenceFFN class, a prediction-only version of a
+ * trained feed forward network with fused layers.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_INFERENCE_FFN_IMPL_HPP
+#define MLPACK_METHODS_ANN_INFERENCE_FFN_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "inference_ffn.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+template<typename... CustomLayers>
+template<typename OutputLayerType, typename InitializationRuleType>
+InferenceFFN<CustomLayers...>::InferenceFFN(
+    const FFN<OutputLayerType, InitializationRuleType, CustomLayers...>&
+        network,
+    const bool quantize)
+{
+  Build(network.Model(), quantize, NULL, NULL);
+}
+
+template<typename... CustomLayers>
+template<typename OutputLayerType, typename InitializationRuleType>
+InferenceFFN<CustomLayers...>::InferenceFFN(
+    const FFN<OutputLayerType, InitializationRuleType, CustomLayers...>&
+        network,
+    const arma::mat& calibrationData)
+{
+  // Each layer of the copy keeps the output it computed for the data.
+  FFN<OutputLayerType, InitializationRuleType, CustomLayers...>
+      calibration(network);
+  arma::mat results;
+  calibration.Forward(calibrationData, results);
+
+  Build(network.Model(), true, &calibrationData, &calibration.Model());
+}
+
+template<typename... CustomLayers>
+InferenceFFN<CustomLayers...>::InferenceFFN(const InferenceFFN& other) :
+    stageTypes(other.stageTypes),
+    fusedLayers(other.fusedLayers),
+    convolutionLayers(other.convolutionLayers),
+    isReentrant(other.isReentrant)
+{
+  for (size_t i = 0; i < other.layers.size(); ++i)
+    layers.push_back(boost::apply_visitor(copyVisitor, other.layers[i]));
+}
+
+template<typename... CustomLayers>
+InferenceFFN<CustomLayers...>::InferenceFFN(InferenceFFN&& other) :
+    stageTypes(std::move(other.stageTypes)),
+    fusedLayers(std::move(other.fusedLayers)),
+    convolutionLayers(std::move(other.convolutionLayers)),
+    layers(std::move(other.layers)),
+    isReentrant(std::move(other.isReentrant))
+{
+  other.layers.clear();
+  other.stageTypes.clear();
+  other.isReentrant.clear();
+}
+
+template<typename... CustomLayers>
+InferenceFFN<CustomLayers...>&
+InferenceFFN<CustomLayers...>::operator=(InferenceFFN other)
+{
+  std::swap(stageTypes, other.stageTypes);
+  std::swap(fusedLayers, other.fusedLayers);
+  std::swap(convolutionLayers, other.convolutionLayers);
+  std::swap(layers, other.layers);
+  std::swap(isReentrant, other.isReentrant);
+
+  // The context refers to the copied layers of the old predictor.
+  context = Context();
+  return *this;
+}
+
+template<typename... CustomLayers>
+InferenceFFN<CustomLayers...>::~InferenceFFN()
+{
+  std::for_each(layers.begin(), layers.end(),
+      boost::apply_visitor(deleteVisitor));
+}
+
+template<typename... CustomLayers>
+void InferenceFFN<CustomLayers...>::Predict(const arma::mat& predictors,
+                                            arma::mat& results,
+                                            const size_t batchSize)
+{
+  Predict(predictors, results, context, batchSize);
+}
+
+template<typename... CustomLayers>
+void InferenceFFN<CustomLayers...>::Predict(const arma::mat& predictors,
+                                            arma::mat& results,
+                                            Context& context,
+                                            const size_t batchSize) const
+{
+  // Copy the layers that cannot be shared on the first use of the context.
+  if (context.model != this)
+  {
+    context.Clear();
+    for (size_t i = 0; i < layers.size(); ++i)
+    {
+      if (!isReentrant[i])
+      {
+        context.layers.push_back(boost::apply_visitor(copyVisitor,
+            layers[i]));
+        boost::apply_visitor(DeterministicSetVisitor(true),
+            context.layers.back());
+      }
+    }
+
+    context.model = this;
+  }
+
+  for (size_t begin = 0; begin < predictors.n_cols; begin += batchSize)
+  {
+    const size_t effectiveBatchSize = std::min(batchSize,
+        size_t(predictors.n_cols - begin));
+
+    // Wrap a matrix around the batch to avoid a copy; the layers do not
+    // modify their input.
+    arma::mat batch(const_cast<double*>(predictors.colptr(begin)),
+        predictors.n_rows, effectiveBatchSize, false, true);
+
+    // The output of each stage goes into the buffer that does not hold its
+    // input.
+    arma::mat* input = &batch;
+    size_t fused = 0, convolution = 0, layer = 0, copied = 0;
+    for (size_t s = 0; s < stageTypes.size(); ++s)
+    {
+      arma::mat& output = context.buffers[s % 2];
+      switch (stageTypes[s])
+      {
+        case LINEAR_STAGE:
+          Forward(fusedLayers[fused++], *input, output, context);
+          break;
+        case CONVOLUTION_STAGE:
+          Forward(convolutionLayers[convolution++], *input, output, context);
+          break;
+        case LAYER_STAGE:
+        {
+          const LayerTypes<CustomLayers...>& stage = isReentrant[layer] ?
+              layers[layer] : context.layers[copied++];
+          boost::apply_visitor(ForwardVisitor(std::move(*input),
+              std::move(output)), stage);
+          ++layer;
+          break;
+        }
+      }
+
+      input = &output;
+    }
+
+    // The first batch gives the size of the output.
+    if (begin == 0)
+      results.set_size(input->n_rows, predictors.n_cols);
+
+    results.cols(begin, begin + effectiveBatchSize - 1) = *input;
+  }
+}
+
+template<typename... CustomLayers>
+size_t InferenceFFN<CustomLayers...>::NumQuantized() const
+{
+  size_t quantized = convolutionLayers.size();
+  for (size_t i = 0; i < fusedLayers.size(); ++i)
+  {
+    if (!fusedLayers[i].quantizedWeight.is_empty())
+      ++quantized;
+  }
+
+  return quantized;
+}
+
+template<typename... CustomLayers>
+void InferenceFFN<CustomLayers...>::Build(
+    const std::vector<LayerTypes<CustomLayers...> >& model,
+    const bool quantize,
+    const arma::mat* calibrationData,
+    const std::vector<LayerTypes<CustomLayers...> >* calibrationModel)
+{
+  size_t i = 0;
+  while (i < model.size())
+  {
+    // With calibration, the input scale of a stage is fixed by the output of
+    // the layer before it.
+    double inputScale = 0.0;
+    if (calibrationData != NULL)
+    {
+      const arma::mat& stageInput = (i == 0) ? *calibrationData :
+          boost::apply_visitor(OutputParameterVisitor(),
+          (*calibrationModel)[i - 1]);
+      inputScale = InputScale(stageInput.memptr(), stageInput.n_elem);
+    }
+
+    FusedLinear stage;
+    QuantizedConvolution convolution;
+    if (GetLinear(model[i], stage))
+    {
+      ++i;
+      if (i < model.size() && FoldBatchNorm(model[i], stage))
+        ++i;
+      if (i < model.size() && FuseActivation(model[i], stage.activation,
+          stage.alpha))
+        ++i;
+
+      // The weights are quantized after the batch normalization is folded
+      // into them.
+      if (quantize)
+      {
+        QuantizeWeights(arma::trans(stage.weight), stage.quantizedWeight,
+            stage.weightScales);
+        stage.weight.clear();
+        stage.inputScale = inputScale;
+      }
+
+      fusedLayers.push_back(std::move(stage));
+      stageTypes.push_back(LINEAR_STAGE);
+    }
+    else if (quantize && GetConvolution(model[i], convolution))
+    {
+      ++i;
+      if (i < model.size() && FuseActivation(model[i],
+          convolution.activation, convolution.alpha))
+        ++i;
+
+      convolution.inputScale = inputScale;
+      convolutionLayers.push_back(std::move(convolution));
+      stageTypes.push_back(CONVOLUTION_STAGE);
+    }
+    else
+    {
+      // Run the layer as it is, in deterministic mode.
+      layers.push_back(boost::apply_visitor(copyVisitor, model[i]));
+      boost::apply_visitor(DeterministicSetVisitor(true), layers.back());
+      isReentrant.push_back(IsReentrant(model[i]));
+      stageTypes.push_back(LAYER_STAGE);
+      ++i;
+    }
+  }
+}
+
+template<typename... CustomLayers>
+bool InferenceFFN<CustomLayers...>::GetLinear(
+    const LayerTypes<CustomLayers...>& layer, FusedLinear& stage)
+{
+  stage.activation = IDENTITY_ACTIVATION;
+  stage.alpha = 0.0;
+  stage.inputScale = 0.0;
+
+  Linear<>* const* linear = boost::get<Linear<>*>(&layer);
+  if (linear != NULL)
+  {
+    const arma::mat& weights = (*linear)->Parameters();
+    const size_t inSize = (*linear)->InputSize();
+    const size_t outSize = (*linear)->OutputSize();
+
+    stage.weight = arma::reshape(weights.rows(0, inSize * outSize - 1),
+        outSize, inSize);
+    stage.bias = weights.rows(inSize * outSize, (inSize + 1) * outSize - 1);
+    return true;
+  }
+
+  LinearNoBias<>* const* linearNoBias = boost::get<LinearNoBias<>*>(&layer);
+  if (linearNoBias != NULL)
+  {
+    stage.weight = arma::reshape((*linearNoBias)->Parameters(),
+        (*linearNoBias)->OutputSize(), (*linearNoBias)->InputSize());
+    stage.bias.clear();
+    return true;
+  }
+
+  return false;
+}
+
+template<typename... CustomLayers>
+bool InferenceFFN<CustomLayers...>::GetConvolution(
+    const LayerTypes<CustomLayers...>& layer, QuantizedConvolution& stage)
+{
+  Convolution<>* const* convolution = boost::get<Convolution<>*>(&layer);
+  if (convolution == NULL)
+    return false;
+
+  // The size of the input is only known once the network has computed a
+  // forward pass, and the unfolded patches use the same stride in both
+  // directions.
+  const Convolution<>& layerRef = **convolution;
+  if (layerRef.InputWidth() == 0 || layerRef.InputHeight() == 0 ||
+      layerRef.StrideWidth() != layerRef.StrideHeight())
+    return false;
+
+  stage.activation = IDENTITY_ACTIVATION;
+  stage.alpha = 0.0;
+  stage.inputScale = 0.0;
+  stage.inSize = layerRef.InputSize();
+  stage.outSize = layerRef.OutputSize();
+  stage.kernelWidth = layerRef.KernelWidth();
+  stage.kernelHeight = layerRef.KernelHeight();
+  stage.stride = layerRef.StrideWidth();
+  stage.padWidth = layerRef.PadWidth();
+  stage.padHeight = layerRef.PadHeight();
+  stage.inputWidth = layerRef.InputWidth();
+  stage.inputHeight = layerRef.InputHeight();
+  stage.outputWidth = (stage.inputWidth + 2 * stage.padWidth -
+      stage.kernelWidth) / stage.stride + 1;
+  stage.outputHeight = (stage.inputHeight + 2 * stage.padHeight -
+      stage.kernelHeight) / stage.stride + 1;
+
+  // The filters of each output map are stored one after the other, followed
+  // by the biases.
+  const arma::mat& parameters = layerRef.Parameters();
+  const size_t filterSize = stage.kernelWidth * stage.kernelHeight *
+      stage.inSize;
+  const size_t weightSize = filterSize * stage.outSize;
+  QuantizeWeights(arma::reshape(parameters.rows(0, weightSize - 1),
+      filterSize, stage.outSize), stage.weight, stage.weightScales);
+  stage.bias = parameters.rows(weightSize, weightSize + stage.outSize - 1);
+  return true;
+}
+
+template<typename... CustomLayers>
+bool InferenceFFN<CustomLayers...>::FoldBatchNorm(
+    const LayerTypes<CustomLayers...>& layer, FusedLinear& stage)
+{
+  BatchNorm<>* const* batchNorm = boost::get<BatchNorm<>*>(&layer);
+  if (batchNorm == NULL)
+    return false;
+
+  // In deterministic mode, the layer computes
+  //   gamma % (x - mean) / sqrt(variance + eps) + beta,
+  // which is an affine map that can be applied to the weights and bias.
+  const size_t size = stage.weight.n_rows;
+  const arma::mat& parameters = (*batchNorm)->Parameters();
+  const arma::vec gamma = parameters.rows(0, size - 1);
+  const arma::vec beta = parameters.rows(size, 2 * size - 1);
+  const arma::vec scale = gamma / arma::sqrt((*batchNorm)->TrainingVariance() +
+      (*batchNorm)->Epsilon());
+
+  if (stage.bias.is_empty())
+    stage.bias = -(*batchNorm)->TrainingMean();
+  else
+    stage.bias -= (*batchNorm)->TrainingMean();
+
+  stage.weight.each_col() %= scale;
+  stage.bias = stage.bias % scale + beta;
+  return true;
+}
+
+template<typename... CustomLayers>
+bool InferenceFFN<CustomLayers...>::IsReentrant(
+    const LayerTypes<CustomLayers...>& layer)
+{
+  // These layers only read their members in the forward pass in
+  // deterministic mode.
+  return boost::get<SigmoidLayer<>*>(&layer) != NULL ||
+      boost::get<IdentityLayer<>*>(&layer) != NULL ||
+      boost::get<TanHLayer<>*>(&layer) != NULL ||
+      boost::get<ReLULayer<>*>(&layer) != NULL ||
+      boost::get<SoftPlusLayer<>*>(&layer) != NULL ||
+      boost::get<BatchNorm<>*>(&layer) != NULL ||
+      boost::get<Dropout<>*>(&layer) != NULL ||
+      boost::get<AlphaDropout<>*>(&layer) != NULL ||
+      boost::get<ELU<>*>(&layer) != NULL ||
+      boost::get<HardTanH<>*>(&layer) != NULL ||
+      boost::get<LeakyReLU<>*>(&layer) != NULL ||
+      boost::get<LogSoftMax<>*>(&layer) != NULL ||
+      boost::get<PReLU<>*>(&layer) != NULL;
+}
+
+template<typename... CustomLayers>
+bool InferenceFFN<CustomLayers...>::FuseActivation(
+    const LayerTypes<CustomLayers...>& layer,
+    FusedActivation& activation,
+    double& alpha)
+{
+  if (boost::get<ReLULayer<>*>(&layer) != NULL)
+  {
+    activation = RECTIFIER_ACTIVATION;
+  }
+  else if (boost::get<TanHLayer<>*>(&layer) != NULL)
+  {
+    activation = TANH_ACTIVATION;
+  }
+  else if (boost::get<SigmoidLayer<>*>(&layer) != NULL)
+  {
+    activation = LOGISTIC_ACTIVATION;
+  }
+  else if (boost::get<LeakyReLU<>*>(&layer) != NULL)
+  {
+    activation = LEAKY_RECTIFIER_ACTIVATION;
+    alpha = (*boost::get<LeakyReLU<>*>(&layer))->Alpha();
+  }
+  else
+  {
+    return false;
+  }
+
+  return true;
+}
+
+template<typename... CustomLayers>
+void InferenceFFN<CustomLayers...>::QuantizeWeights(
+    const arma::mat& weight,
+    arma::Mat<int8_t>& quantizedWeight,
+    arma::vec& weightScales)
+{
+  quantizedWeight.set_size(weight.n_rows, weight.n_cols);
+  weightScales.set_size(weight.n_cols);
+  for (size_t c = 0; c < weight.n_cols; ++c)
+  {
+    weightScales[c] = InputScale(weight.colptr(c), weight.n_rows);
+    const double inverseScale = 1.0 / weightScales[c];
+    for (size_t r = 0; r < weight.n_rows; ++r)
+      quantizedWeight(r, c) = Quantize(weight(r, c), inverseScale);
+  }
+}
+
+template<typename... CustomLayers>
+double InferenceFFN<CustomLayers...>::InputScale(const double* values,
+                                                 const size_t n)
+{
+  double maxValue = 0.0;
+  for (size_t i = 0; i < n; ++i)
+    maxValue = std::max(maxValue, std::abs(values[i]));
+
+  // Any scale represents an input of zeros.
+  return (maxValue == 0.0) ? 1.0 : maxValue / 127.0;
+}
+
+template<typename... CustomLayers>
+int8_t InferenceFFN<CustomLayers...>::Quantize(const double value,
+                                               const double inverseScale)
+{
+  const double quantized = std::round(value * inverseScale);
+  return (int8_t) std::max(-127.0, std::min(127.0, quantized));
+}
+
+template<typename... CustomLayers>
+int32_t InferenceFFN<CustomLayers...>::IntegerDot(const int8_t* a,
+                                                  const int8_t* b,
+                                                  const size_t n)
+{
+  // A plain loop, so that the compiler can vectorize the products.
+  int32_t sum = 0;
+  for (size_t i = 0; i < n; ++i)
+    sum += int32_t(a[i]) * int32_t(b[i]);
+
+  return sum;
+}
+
+template<typename... CustomLayers>
+void InferenceFFN<CustomLayers...>::Forward(const FusedLinear& stage,
+                                            const arma::mat& input,
+                                            arma::mat& output,
+                                            Context& context)
+{
+  if (stage.quantizedWeight.is_empty())
+  {
+    output = stage.weight * input;
+    Activate(stage.activation, stage.alpha, stage.bias, output);
+    return;
+  }
+
+  // Quantize each point with its own scale, unless the scale is fixed.
+  const size_t inSize = stage.quantizedWeight.n_rows;
+  const size_t outSize = stage.quantizedWeight.n_cols;
+  context.quantizedInput.set_size(inSize, input.n_cols);
+  context.inputScales.set_size(input.n_cols);
+  for (size_t c = 0; c < input.n_cols; ++c)
+  {
+    const double* in = input.colptr(c);
+    context.inputScales[c] = (stage.inputScale > 0.0) ? stage.inputScale :
+        InputScale(in, inSize);
+
+    const double inverseScale = 1.0 / context.inputScales[c];
+    int8_t* quantized = context.quantizedInput.colptr(c);
+    for (size_t r = 0; r < inSize; ++r)
+      quantized[r] = Quantize(in[r], inverseScale);
+  }
+
+  output.set_size(outSize, input.n_cols);
+  for (size_t c = 0; c < input.n_cols; ++c)
+  {
+    const int8_t* quantized = context.quantizedInput.colptr(c);
+    double* out = output.colptr(c);
+    for (size_t r = 0; r < outSize; ++r)
+    {
+      out[r] = IntegerDot(stage.quantizedWeight.colptr(r), quantized, inSize) *
+          (context.inputScales[c] * stage.weightScales[r]);
+    }
+  }
+
+  Activate(stage.activation, stage.alpha, stage.bias, output);
+}
+
+template<typename... CustomLayers>
+void InferenceFFN<CustomLayers...>::Forward(const QuantizedConvolution& stage,
+                                            const arma::mat& input,
+                                            arma::mat& output,
+                                            Context& context)
+{
+  const size_t inputElements = stage.inputWidth * stage.inputHeight;
+  const size_t paddedWidth = stage.inputWidth + 2 * stage.padWidth;
+  const size_t paddedHeight = stage.inputHeight + 2 * stage.padHeight;
+  const size_t paddedElements = paddedWidth * paddedHeight;
+  const size_t outputElements = stage.outputWidth * stage.outputHeight;
+  const size_t filterSize = stage.weight.n_rows;
+
+  output.set_size(outputElements * stage.outSize, input.n_cols);
+  for (size_t c = 0; c < input.n_cols; ++c)
+  {
+    const double* in = input.colptr(c);
+    const double scale = (stage.inputScale > 0.0) ? stage.inputScale :
+        InputScale(in, input.n_rows);
+    const double inverseScale = 1.0 / scale;
+
+    // Quantize the input maps into the middle of zero padded maps.
+    context.quantizedInput.zeros(paddedElements * stage.inSize, 1);
+    int8_t* quantized = context.quantizedInput.memptr();
+    for (size_t m = 0; m < stage.inSize; ++m)
+    {
+      for (size_t j = 0; j < stage.inputHeight; ++j)
+      {
+        const double* inColumn = in + m * inputElements + j * stage.inputWidth;
+        int8_t* paddedColumn = quantized + m * paddedElements +
+            (j + stage.padHeight) * paddedWidth + stage.padWidth;
+        for (size_t i = 0; i < stage.inputWidth; ++i)
+          paddedColumn[i] = Quantize(inColumn[i], inverseScale);
+      }
+    }
+
+    // Each column of the unfolded patches gives one position of all output
+    // maps.
+    Im2ColConvolution<>::Im2Col(quantized, stage.inSize, paddedWidth,
+        paddedHeight, stage.kernelWidth, stage.kernelHeight,
+        stage.outputWidth, stage.outputHeight, stage.stride, stage.stride, 1,
+        1, context.columns);
+
+    double* out = output.colptr(c);
+    for (size_t p = 0; p < outputElements; ++p)
+    {
+      const int8_t* patch = context.columns.colptr(p);
+      for (size_t m = 0; m < stage.outSize; ++m)
+      {
+        out[m * outputElements + p] = IntegerDot(patch,
+            stage.weight.colptr(m), filterSize) * (scale *
+            stage.weightScales[m]) + stage.bias[m];
+      }
+    }
+  }
+
+  Activate(stage.activation, stage.alpha, arma::vec(), output);
+}
+
+template<typename... CustomLayers>
+void InferenceFFN<CustomLayers...>::Activate(const FusedActivation activation,
+                                             const double alpha,
+                                             const arma::vec& bias,
+                                             arma::mat& output)
+{
+  switch (activation)
+  {
+    case IDENTITY_ACTIVATION:
+      BiasActivation<IdentityFunction>(bias, output);
+      break;
+    case RECTIFIER_ACTIVATION:
+      BiasActivation<RectifierFunction>(bias, output);
+      break;
+    case TANH_ACTIVATION:
+      BiasActivation<TanhFunction>(bias, output);
+      break;
+    case LOGISTIC_ACTIVATION:
+      BiasActivation<LogisticFunction>(bias, output);
+      break;
+    case LEAKY_RECTIFIER_ACTIVATION:
+    {
+      if (bias.is_empty())
+      {
+        output.transform([alpha](double x) { return std::max(x, alpha * x); });
+      }
+      else
+      {
+        for (size_t c = 0; c < output.n_cols; ++c)
+        {
+          double* out = output.colptr(c);
+          for (size_t r = 0; r < output.n_rows; ++r)
+          {
+            const double x = out[r] + bias[r];
+            out[r] = std::max(x, alpha * x);
+          }
+        }
+      }
+      break;
+    }
+  }
+}
+
+template<typename... CustomLayers>
+template<typename ActivationFunction>
+void InferenceFFN<CustomLayers...>::BiasActivation(const arma::vec& bias,
+                                                   arma::mat& output)
+{
+  if (bias.is_empty())
+  {
+    if (!std::is_same<ActivationFunction, IdentityFunction>::value)
+      output.transform([](double x) { return ActivationFunction::Fn(x); });
+    return;
+  }
+
+  for (size_t c = 0; c < output.n_cols; ++c)
+  {
+    double* out = output.colptr(c);
+    for (size_t r = 0; r < output.n_rows; ++r)
+      out[r] = ActivationFunction::Fn(out[r] + bias[r]);
+  }
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
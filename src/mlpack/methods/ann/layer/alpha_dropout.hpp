@@ -18,6 +18,8 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include "dropout_mask.hpp"
+
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
@@ -107,8 +109,8 @@ class AlphaDropout
   //! Value of alphaDash.
   double AlphaDash() const {return alphaDash; }
 
-  //! Get the mask.
-  OutputDataType const& Mask() const {return mask;}
+  //! Get the mask, with ones for the kept elements.
+  OutputDataType Mask() const { return mask.Unpack<OutputDataType>(); }
 
   //! Modify the probability of setting a value to alphaDash. As
   //! 'a' and 'b' depend on 'ratio', modify them as well.
@@ -132,8 +134,8 @@ class AlphaDropout
   //! Locally-stored output parameter object.
   OutputDataType outputParameter;
 
-  //! Locally-stored mast object.
-  OutputDataType mask;
+  //! Locally-stored packed mask object.
+  DropoutMask mask;
 
   //! The probability of setting a value to aplhaDash.
   double ratio;
@@ -133,6 +133,18 @@ void AtrousConvolution<
   output.set_size(wConv * hConv * outSize, batchSize);
   outputTemp = arma::Cube<eT>(output.memptr(), wConv, hConv,
       outSize * batchSize, false, false);
+
+  if (IsIm2ColConvolution<ForwardConvolutionRule>::value)
+  {
+    Im2ColConvolution<>::BatchForward((padW != 0 || padH != 0) ?
+        inputPaddedTemp : inputTemp, weight, bias, batchSize, outputTemp, dW,
+        dH, dilationW, dilationH);
+
+    outputWidth = outputTemp.n_rows;
+    outputHeight = outputTemp.n_cols;
+    return;
+  }
+
   outputTemp.zeros();
 
   for (size_t outMap = 0, outMapIdx = 0, batchCount = 0; outMap <
@@ -196,6 +208,31 @@ void AtrousConvolution<
       inputTemp.n_cols, inputTemp.n_slices, false, false);
   gTemp.zeros();
 
+  if (IsIm2ColConvolution<BackwardConvolutionRule>::value)
+  {
+    if (padW != 0 || padH != 0)
+    {
+      // Compute the gradient of the padded input, then drop the padding.
+      arma::Cube<eT> gPadded(inputTemp.n_rows + 2 * padW, inputTemp.n_cols +
+          2 * padH, inputTemp.n_slices, arma::fill::zeros);
+      Im2ColConvolution<>::BatchBackward(mappedError, weight, batchSize,
+          gPadded, dW, dH, dilationW, dilationH);
+
+      for (size_t i = 0; i < gTemp.n_slices; ++i)
+      {
+        gTemp.slice(i) = gPadded.slice(i).submat(padW, padH,
+            padW + gTemp.n_rows - 1, padH + gTemp.n_cols - 1);
+      }
+    }
+    else
+    {
+      Im2ColConvolution<>::BatchBackward(mappedError, weight, batchSize,
+          gTemp, dW, dH, dilationW, dilationH);
+    }
+
+    return;
+  }
+
   for (size_t outMap = 0, outMapIdx = 0, batchCount = 0; outMap <
       outSize * batchSize; outMap++)
   {
@@ -254,6 +291,19 @@ void AtrousConvolution<
       weight.n_cols, weight.n_slices, false, false);
   gradientTemp.zeros();
 
+  if (IsIm2ColConvolution<GradientConvolutionRule>::value)
+  {
+    // Unlike the loop below, the bias gradient is summed over the batch, like
+    // the filter gradient.
+    arma::Col<eT> biasGradient;
+    Im2ColConvolution<>::BatchGradient((padW != 0 || padH != 0) ?
+        inputPaddedTemp : inputTemp, mappedError, batchSize, gradientTemp,
+        biasGradient, dW, dH, dilationW, dilationH);
+    gradient.rows(weight.n_elem, weight.n_elem + outSize - 1) = biasGradient;
+
+    return;
+  }
+
   for (size_t outMap = 0, outMapIdx = 0, batchCount = 0; outMap <
       outSize * batchSize; outMap++)
   {
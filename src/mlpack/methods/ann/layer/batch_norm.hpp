@@ -138,6 +138,9 @@ class BatchNorm
   //! Get the variance over the training data.
   OutputDataType TrainingVariance() { return runningVariance / count; }
 
+  //! Get the epsilon value added to the variance.
+  double Epsilon() const { return eps; }
+
   /**
    * Serialize the layer
    */
@@ -195,6 +198,12 @@ class BatchNorm
 
   //! Locally-stored normalized input.
   OutputDataType normalized;
+
+  //! Locally-stored inverse standard deviation of the batch.
+  OutputDataType stdInv;
+
+  //! Number of features each thread handles at once.
+  static const size_t FeatureBlockSize = 64;
 }; // class BatchNorm
 
 } // namespace ann
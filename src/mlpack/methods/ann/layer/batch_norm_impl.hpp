@@ -46,8 +46,9 @@ BatchNorm<InputDataType, OutputDataType>::BatchNorm(
 template<typename InputDataType, typename OutputDataType>
 void BatchNorm<InputDataType, OutputDataType>::Reset()
 {
-  gamma = arma::mat(weights.memptr(), size, 1, false, false);
-  beta = arma::mat(weights.memptr() + gamma.n_elem, size, 1, false, false);
+  gamma = OutputDataType(weights.memptr(), size, 1, false, false);
+  beta = OutputDataType(weights.memptr() + gamma.n_elem, size, 1, false,
+      false);
 
   if (!loading)
   {
@@ -64,67 +65,141 @@ template<typename eT>
 void BatchNorm<InputDataType, OutputDataType>::Forward(
     const arma::Mat<eT>&& input, arma::Mat<eT>&& output)
 {
+  output.set_size(arma::size(input));
+  const size_t batchSize = input.n_cols;
+  const size_t numBlocks = (input.n_rows + FeatureBlockSize - 1) /
+      FeatureBlockSize;
+
   // Mean and variance over the entire training set will be used to compute
   // the forward pass when deterministic is set to true.
   if (deterministic)
   {
-    // Normalize the input and scale and shift the output.
-    output = input.each_col() - runningMean;
-    output.each_col() %= gamma / arma::sqrt(runningVariance / count + eps);
-    output.each_col() += beta;
+    // Fold the normalization, scale and shift into one multiply-add.
+    const OutputDataType scale = gamma /
+        arma::sqrt(runningVariance / count + eps);
+    const OutputDataType shift = beta - runningMean % scale;
+
+    #pragma omp parallel for
+    for (omp_size_t i = 0; i < (omp_size_t) batchSize; ++i)
+    {
+      const eT* x = input.colptr(i);
+      eT* y = output.colptr(i);
+      for (size_t r = 0; r < input.n_rows; ++r)
+        y[r] = x[r] * scale[r] + shift[r];
+    }
+
+    return;
   }
-  else
-  {
-    mean = arma::mean(input, 1);
-    variance = arma::var(input, 1, 1);
 
-    // Normalize the input.
-    output = input.each_col() - mean;
-    output.each_col() /= arma::sqrt(variance + eps);
+  mean.zeros(input.n_rows, 1);
+  variance.zeros(input.n_rows, 1);
+  stdInv.set_size(input.n_rows, 1);
+  normalized.set_size(arma::size(input));
 
-    // Use Welford method to compute the sample variance and mean.
-    for (size_t i = 0; i < input.n_cols; i++)
-    {
-      count += 1;
+  // Each thread takes a block of features and sweeps over the batch once to
+  // compute their mean and variance with Welford's method, then sweeps once
+  // more to write the normalized input and the scaled and shifted output.
+  #pragma omp parallel for
+  for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+  {
+    const size_t begin = b * FeatureBlockSize;
+    const size_t end = std::min(begin + (size_t) FeatureBlockSize,
+        (size_t) input.n_rows);
 
-      OutputDataType delta = input.col(i) - runningMean;
-      runningMean = runningMean + delta / count;
-      runningVariance += delta % (input.col(i) - runningMean);
+    // The variance holds the sum of squared differences until the end.
+    for (size_t i = 0; i < batchSize; ++i)
+    {
+      const eT* x = input.colptr(i);
+      const double weight = 1.0 / (i + 1);
+      for (size_t r = begin; r < end; ++r)
+      {
+        const double delta = x[r] - mean[r];
+        mean[r] += delta * weight;
+        variance[r] += delta * (x[r] - mean[r]);
+      }
     }
 
-    // Reused in the backward and gradient step.
-    normalized = output;
+    for (size_t r = begin; r < end; ++r)
+    {
+      // Merge the batch into the running mean and variance (the running
+      // variance also holds the sum of squared differences).
+      const double delta = mean[r] - runningMean[r];
+      const double total = count + batchSize;
+      runningMean[r] += delta * batchSize / total;
+      runningVariance[r] += variance[r] + delta * delta * count * batchSize /
+          total;
+
+      variance[r] /= batchSize;
+      stdInv[r] = 1.0 / std::sqrt(variance[r] + eps);
+    }
 
-    // Scale and shift the output.
-    output.each_col() %= gamma;
-    output.each_col() += beta;
+    for (size_t i = 0; i < batchSize; ++i)
+    {
+      const eT* x = input.colptr(i);
+      eT* xhat = normalized.colptr(i);
+      eT* y = output.colptr(i);
+      for (size_t r = begin; r < end; ++r)
+      {
+        xhat[r] = (x[r] - mean[r]) * stdInv[r];
+        y[r] = xhat[r] * gamma[r] + beta[r];
+      }
+    }
   }
+
+  count += batchSize;
 }
 
 template<typename InputDataType, typename OutputDataType>
 template<typename eT>
 void BatchNorm<InputDataType, OutputDataType>::Backward(
-    const arma::Mat<eT>&& input, arma::Mat<eT>&& gy, arma::Mat<eT>&& g)
+    const arma::Mat<eT>&& /* input */, arma::Mat<eT>&& gy, arma::Mat<eT>&& g)
 {
-  const arma::mat inputMean = input.each_col() - mean;
-  const arma::mat stdInv = 1.0 / arma::sqrt(variance + eps);
-
-  // Step 1: dl / dxhat
-  const arma::mat norm = gy.each_col() % gamma;
-
-  // Step 2: sum dl / dxhat * (x - mu) * -0.5 * stdInv^3.
-  const arma::mat var = arma::sum(norm % inputMean, 1) %
-      arma::pow(stdInv, 3.0) * -0.5;
+  g.set_size(arma::size(gy));
+  const size_t batchSize = gy.n_cols;
+  const size_t numBlocks = (gy.n_rows + FeatureBlockSize - 1) /
+      FeatureBlockSize;
+
+  // With dl / dxhat = dl / dy * gamma, the error is
+  //
+  //   stdInv * (dl / dxhat - (sum dl / dxhat + xhat * sum dl / dxhat * xhat)
+  //       / m),
+  //
+  // so each thread takes a block of features, sweeps over the batch once for
+  // the sums and once more to write the error, using the normalized input and
+  // inverse standard deviation cached by the forward pass.
+  #pragma omp parallel for
+  for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+  {
+    const size_t begin = b * FeatureBlockSize;
+    const size_t end = std::min(begin + (size_t) FeatureBlockSize,
+        (size_t) gy.n_rows);
 
-  // Step 4: dl / dxhat * 1 / stdInv + variance * 2 * (x - mu) / m +
-  // dl / dmu * 1 / m.
-  g = (norm.each_col() % stdInv) + (inputMean.each_col() %
-      var * 2 / input.n_cols);
+    double sums[FeatureBlockSize] = { 0 };
+    double normalizedSums[FeatureBlockSize] = { 0 };
+    for (size_t i = 0; i < batchSize; ++i)
+    {
+      const eT* error = gy.colptr(i);
+      const eT* xhat = normalized.colptr(i);
+      for (size_t r = begin; r < end; ++r)
+      {
+        const double norm = error[r] * gamma[r];
+        sums[r - begin] += norm;
+        normalizedSums[r - begin] += norm * xhat[r];
+      }
+    }
 
-  // Step 3: sum (dl / dxhat * -1 / stdInv) + variance *
-  // (sum -2 * (x - mu)) / m.
-  g.each_col() += (arma::sum(norm.each_col() % -stdInv, 1) + (var %
-      arma::mean(-2 * inputMean, 1))) / input.n_cols;
+    for (size_t i = 0; i < batchSize; ++i)
+    {
+      const eT* error = gy.colptr(i);
+      const eT* xhat = normalized.colptr(i);
+      eT* out = g.colptr(i);
+      for (size_t r = begin; r < end; ++r)
+      {
+        out[r] = stdInv[r] * (error[r] * gamma[r] - (sums[r - begin] +
+            xhat[r] * normalizedSums[r - begin]) / batchSize);
+      }
+    }
+  }
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -134,14 +209,21 @@ void BatchNorm<InputDataType, OutputDataType>::Gradient(
     arma::Mat<eT>&& error,
     arma::Mat<eT>&& gradient)
 {
-  gradient.set_size(size + size, 1);
-
-  // Step 5: dl / dy * xhat.
-  gradient.submat(0, 0, gamma.n_elem - 1, 0) = arma::sum(normalized % error, 1);
+  gradient.zeros(size + size, 1);
 
-  // Step 6: dl / dy.
-  gradient.submat(gamma.n_elem, 0, gradient.n_elem - 1, 0) =
-      arma::sum(error, 1);
+  // Step 5: dl / dy * xhat, and step 6: dl / dy, in one sweep.
+  eT* gammaGradient = gradient.memptr();
+  eT* betaGradient = gradient.memptr() + gamma.n_elem;
+  for (size_t i = 0; i < error.n_cols; ++i)
+  {
+    const eT* e = error.colptr(i);
+    const eT* xhat = normalized.colptr(i);
+    for (size_t r = 0; r < error.n_rows; ++r)
+    {
+      gammaGradient[r] += e[r] * xhat[r];
+      betaGradient[r] += e[r];
+    }
+  }
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -22,6 +22,7 @@
 #include <boost/ptr_container/ptr_vector.hpp>
 
 #include "layer_types.hpp"
+#include "matrix_views.hpp"
 
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
@@ -256,6 +257,21 @@ class Concat
 
   //! Locally-stored gradient object.
   arma::mat gradient;
+
+  /**
+   * Get the part of the given error (reshaped for the channels) that belongs
+   * to the layer whose output starts at the given row of the output.  This is
+   * a view of the error if those rows are contiguous (if the reshaped error
+   * has one column), and a copy otherwise.
+   *
+   * @param error Error of the output, reshaped for the channels.
+   * @param rowCount First row of the output of the layer.
+   * @param rows Number of rows of the output of the layer.
+   */
+  template<typename eT>
+  arma::Mat<eT> ErrorRows(arma::Mat<eT>& error,
+                          const size_t rowCount,
+                          const size_t rows);
 }; // class Concat
 
 } // namespace ann
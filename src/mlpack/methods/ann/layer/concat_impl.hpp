@@ -111,21 +111,44 @@ void Concat<InputDataType, OutputDataType, CustomLayers...>::Forward(
     }
   }
 
-  output = boost::apply_visitor(outputParameterVisitor, network.front());
+  // With a single layer and no channels, the output is a view of the output
+  // of the layer.
+  const arma::Mat<eT>& front = boost::apply_visitor(outputParameterVisitor,
+      network.front());
+  if (network.size() == 1 && channels == 1)
+  {
+    MakeView(output, front.memptr(), front.n_rows, front.n_cols);
+    return;
+  }
+
+  // Otherwise the output is allocated once, and the output of each layer
+  // (reshaped to incorporate the channels) is copied into its rows of each
+  // column.
+  size_t totalRows = 0;
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    totalRows += boost::apply_visitor(outputParameterVisitor,
+        network[i]).n_rows;
+  }
 
-  // Reshape output to incorporate the channels.
-  output.reshape(output.n_rows / channels, output.n_cols * channels);
+  DetachView(output);
+  output.set_size(totalRows / channels, front.n_cols * channels);
 
-  for (size_t i = 1; i < network.size(); ++i)
+  size_t rowCount = 0;
+  for (size_t i = 0; i < network.size(); ++i)
   {
-    arma::Mat<eT> out = boost::apply_visitor(outputParameterVisitor,
+    const arma::Mat<eT>& out = boost::apply_visitor(outputParameterVisitor,
         network[i]);
+    const size_t rows = out.n_rows / channels;
+    for (size_t c = 0; c < output.n_cols; ++c)
+    {
+      std::copy(out.memptr() + c * rows, out.memptr() + (c + 1) * rows,
+          output.colptr(c) + rowCount);
+    }
 
-    out.reshape(out.n_rows / channels, out.n_cols * channels);
-
-    // Vertically concatentate output from each layer.
-    output = arma::join_cols(output, out);
+    rowCount += rows;
   }
+
   // Reshape output to its original shape.
   output.reshape(output.n_rows * channels, output.n_cols / channels);
 }
@@ -148,8 +171,7 @@ void Concat<InputDataType, OutputDataType, CustomLayers...>::Backward(
           outputParameterVisitor, network[i]).n_rows;
 
       // Extract from gy the parameters for the i-th network.
-      delta = gy.rows(rowCount / channels, (rowCount + rows) / channels - 1);
-      delta.reshape(delta.n_rows * channels, delta.n_cols / channels);
+      delta = ErrorRows(gy, rowCount, rows);
 
       boost::apply_visitor(BackwardVisitor(std::move(
           boost::apply_visitor(outputParameterVisitor,
@@ -190,9 +212,7 @@ void Concat<InputDataType, OutputDataType, CustomLayers...>::Backward(
   // Reshape gy to extract the i-th layer gy.
   gy.reshape(gy.n_rows / channels, gy.n_cols * channels);
 
-  arma::Mat<eT> delta = gy.rows(rowCount / channels, (rowCount + rows) /
-      channels - 1);
-  delta.reshape(delta.n_rows * channels, delta.n_cols / channels);
+  arma::Mat<eT> delta = ErrorRows(gy, rowCount, rows);
 
   boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
       outputParameterVisitor, network[index])), std::move(delta), std::move(
@@ -223,9 +243,7 @@ void Concat<InputDataType, OutputDataType, CustomLayers...>::Gradient(
           outputParameterVisitor, network[i]).n_rows;
 
       // Extract from error the parameters for the i-th network.
-      arma::Mat<eT> err = error.rows(rowCount / channels, (rowCount + rows) /
-          channels - 1);
-      err.reshape(err.n_rows * channels, err.n_cols / channels);
+      arma::Mat<eT> err = ErrorRows(error, rowCount, rows);
 
       boost::apply_visitor(GradientVisitor(std::move(input),
           std::move(err)), network[i]);
@@ -256,9 +274,7 @@ void Concat<InputDataType, OutputDataType, CustomLayers...>::Gradient(
       outputParameterVisitor, network[index]).n_rows;
 
   error.reshape(error.n_rows / channels, error.n_cols * channels);
-  arma::Mat<eT> err = error.rows(rowCount / channels, (rowCount + rows) /
-      channels - 1);
-  err.reshape(err.n_rows * channels, err.n_cols / channels);
+  arma::Mat<eT> err = ErrorRows(error, rowCount, rows);
 
   boost::apply_visitor(GradientVisitor(std::move(input),
       std::move(err)), network[index]);
@@ -266,6 +282,24 @@ void Concat<InputDataType, OutputDataType, CustomLayers...>::Gradient(
   error.reshape(error.n_rows * channels, error.n_cols / channels);
 }
 
+template<typename InputDataType, typename OutputDataType,
+         typename... CustomLayers>
+template<typename eT>
+arma::Mat<eT> Concat<InputDataType, OutputDataType, CustomLayers...>::ErrorRows(
+    arma::Mat<eT>& error, const size_t rowCount, const size_t rows)
+{
+  if (error.n_cols == 1)
+  {
+    return arma::Mat<eT>(error.memptr() + rowCount / channels, rows / channels,
+        1, false, false);
+  }
+
+  arma::Mat<eT> errorRows = error.rows(rowCount / channels,
+      (rowCount + rows) / channels - 1);
+  errorRows.reshape(errorRows.n_rows * channels, errorRows.n_cols / channels);
+  return errorRows;
+}
+
 template<typename InputDataType, typename OutputDataType,
          typename... CustomLayers>
 template<typename Archive>
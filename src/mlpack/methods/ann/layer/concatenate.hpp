@@ -16,6 +16,8 @@
 #include <mlpack/prereqs.hpp>
 #include <mlpack/methods/ann/layer/layer_traits.hpp>
 
+#include "matrix_views.hpp"
+
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
@@ -50,7 +50,16 @@ void Concatenate<InputDataType, OutputDataType>::Backward(
     const arma::Mat<eT>&& gy,
     arma::Mat<eT>&& g)
 {
-  g = gy.submat(0, 0, inRows - 1, concat.n_cols - 1);
+  // For a single column, the rows of the input are contiguous in the error.
+  if (gy.n_cols == 1)
+  {
+    MakeView(g, gy.memptr(), inRows, 1);
+  }
+  else
+  {
+    DetachView(g);
+    g = gy.submat(0, 0, inRows - 1, concat.n_cols - 1);
+  }
 }
 
 } // namespace ann
@@ -18,6 +18,7 @@
 #include <mlpack/methods/ann/convolution_rules/naive_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/fft_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/svd_convolution.hpp>
+#include <mlpack/methods/ann/convolution_rules/im2col_convolution.hpp>
 
 #include "layer_types.hpp"
 
@@ -161,6 +162,30 @@ class Convolution
   //! Modify the output height.
   size_t& OutputHeight() { return outputHeight; }
 
+  //! Get the number of input maps.
+  size_t InputSize() const { return inSize; }
+
+  //! Get the number of output maps.
+  size_t OutputSize() const { return outSize; }
+
+  //! Get the width of the filter.
+  size_t KernelWidth() const { return kW; }
+
+  //! Get the height of the filter.
+  size_t KernelHeight() const { return kH; }
+
+  //! Get the stride in the x direction.
+  size_t StrideWidth() const { return dW; }
+
+  //! Get the stride in the y direction.
+  size_t StrideHeight() const { return dH; }
+
+  //! Get the padding width.
+  size_t PadWidth() const { return padW; }
+
+  //! Get the padding height.
+  size_t PadHeight() const { return padH; }
+
   /**
    * Serialize the layer
    */
@@ -324,6 +349,9 @@ class Convolution
   //! Locally-stored transformed gradient parameter.
   arma::cube gradientTemp;
 
+  //! Locally-stored filter spectra, used by the fft forward rule.
+  FFTFilterSpectra<double> weightSpectra;
+
   //! Locally-stored delta object.
   OutputDataType delta;
 
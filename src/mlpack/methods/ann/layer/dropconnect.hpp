@@ -20,6 +20,7 @@
 #include "add_merge.hpp"
 #include "linear.hpp"
 #include "sequential.hpp"
+#include "dropout_mask.hpp"
 
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
@@ -176,8 +177,11 @@ class DropConnect
   //! Locally-stored output parameter object.
   OutputDataType outputParameter;
 
-  //! Locally-stored mask object.
-  OutputDataType mask;
+  //! Locally-stored packed mask object.
+  DropoutMask mask;
+
+  //! Locally-stored masked weights.
+  OutputDataType noisyWeights;
 
   //! If true dropout and scaling is disabled, see notes above.
   bool deterministic;
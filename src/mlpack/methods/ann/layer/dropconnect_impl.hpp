@@ -74,10 +74,10 @@ void DropConnect<InputDataType, OutputDataType>::Forward(
 
     // Scale with input / (1 - ratio) and set values to zero with
     // probability ratio.
-    mask = arma::randu<arma::Mat<eT> >(denoise.n_rows, denoise.n_cols);
-    mask.transform([&](double val) { return (val > ratio); });
+    mask.Generate(denoise.n_rows, denoise.n_cols, ratio);
+    mask.Apply(denoise, noisyWeights, (eT) 1);
 
-    boost::apply_visitor(ParametersSetVisitor(std::move(denoise % mask)),
+    boost::apply_visitor(ParametersSetVisitor(std::move(noisyWeights)),
         baseLayer);
 
     boost::apply_visitor(ForwardVisitor(std::move(input), std::move(output)),
@@ -0,0 +1,145 @@
+/**
+ * @file dropout_mask.hpp
+ *
+ * Definition of the DropoutMask class, a packed bit mask used by the dropout
+ * layers, filled by a counter-based random number generator.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_LAYER_DROPOUT_MASK_HPP
+#define MLPACK_METHODS_ANN_LAYER_DROPOUT_MASK_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/philox.hpp>
+#include <cstdint>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * A dropout mask with one bit per element. The bits are drawn with the
+ * Philox4x32-10 counter-based generator, which produces four 32-bit random
+ * numbers per evaluation from a counter and a key, without any sequential
+ * state; the key is drawn from mlpack's random number generator for every
+ * new mask, so math::RandomSeed() makes the masks reproducible. Applying the
+ * mask and the scaling is done in a single pass, and the mask takes 64 times
+ * less memory than a matrix of doubles.
+ *
+ * For more information, see the following.
+ *
+ * @code
+ * @inproceedings{Salmon2011,
+ *   author    = {Salmon, John K. and Moraes, Mark A. and Dror, Ron O. and
+ *                Shaw, David E.},
+ *   title     = {Parallel Random Numbers: As Easy As 1, 2, 3},
+ *   booktitle = {Proceedings of the International Conference for High
+ *                Performance Computing, Networking, Storage and Analysis},
+ *   year      = {2011}
+ * }
+ * @endcode
+ */
+class DropoutMask
+{
+ public:
+  //! Create an empty mask.
+  DropoutMask() : nRows(0), nCols(0) { /* Nothing to do here. */ }
+
+  /**
+   * Draw a new mask of the given size, where each element is dropped with
+   * the given probability.
+   *
+   * @param rows Number of rows of the masked matrix.
+   * @param cols Number of columns of the masked matrix.
+   * @param ratio Probability of dropping an element.
+   */
+  void Generate(const size_t rows, const size_t cols, const double ratio)
+  {
+    nRows = rows;
+    nCols = cols;
+    const size_t n = rows * cols;
+    bits.assign((n + 63) / 64, 0);
+
+    // An element is kept if its 32-bit random number reaches the threshold.
+    const double scaled = std::ceil(ratio * 4294967296.0);
+    const uint64_t threshold = (uint64_t) std::max(0.0, std::min(scaled,
+        4294967296.0));
+
+    const uint32_t key[2] = { (uint32_t) math::randGen(),
+                              (uint32_t) math::randGen() };
+
+    for (size_t block = 0; 4 * block < n; ++block)
+    {
+      uint32_t counter[4] = { (uint32_t) block,
+                              (uint32_t) ((uint64_t) block >> 32), 0, 0 };
+      math::Philox4x32(counter, key);
+
+      const size_t count = std::min((size_t) 4, n - 4 * block);
+      for (size_t j = 0; j < count; ++j)
+      {
+        const size_t i = 4 * block + j;
+        bits[i >> 6] |= (uint64_t) (counter[j] >= threshold) << (i & 63);
+      }
+    }
+  }
+
+  /**
+   * Apply the mask to the given matrix: every kept element becomes
+   * input * scale + offset, and every dropped element becomes the given
+   * value. The input and the output may be the same matrix.
+   *
+   * @param input Matrix to be masked; it must have the size of the mask.
+   * @param output Matrix to store the result.
+   * @param scale Scale of the kept elements.
+   * @param offset Offset of the kept elements.
+   * @param dropped Value of the dropped elements.
+   */
+  template<typename eT>
+  void Apply(const arma::Mat<eT>& input,
+             arma::Mat<eT>& output,
+             const eT scale,
+             const eT offset = 0,
+             const eT dropped = 0) const
+  {
+    output.set_size(nRows, nCols);
+    const eT* in = input.memptr();
+    eT* out = output.memptr();
+    for (size_t i = 0; i < input.n_elem; ++i)
+      out[i] = Kept(i) ? in[i] * scale + offset : dropped;
+  }
+
+  //! Return whether the given element is kept.
+  bool Kept(const size_t i) const { return (bits[i >> 6] >> (i & 63)) & 1; }
+
+  //! Return the mask as a matrix of zeros (dropped) and ones (kept).
+  template<typename MatType = arma::mat>
+  MatType Unpack() const
+  {
+    MatType mask(nRows, nCols);
+    for (size_t i = 0; i < mask.n_elem; ++i)
+      mask[i] = Kept(i);
+    return mask;
+  }
+
+  //! Get the number of rows of the masked matrix.
+  size_t Rows() const { return nRows; }
+  //! Get the number of columns of the masked matrix.
+  size_t Cols() const { return nCols; }
+
+ private:
+  //! The packed bits of the mask; a set bit keeps the element.
+  std::vector<uint64_t> bits;
+
+  //! Number of rows of the masked matrix.
+  size_t nRows;
+
+  //! Number of columns of the masked matrix.
+  size_t nCols;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_ANN_LAYER_FAST_LSTM_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/methods/ann/activation_functions/fast_functions.hpp>
 #include <limits>
 
 namespace mlpack {
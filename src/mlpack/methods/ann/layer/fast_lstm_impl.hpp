@@ -126,45 +126,44 @@ void FastLSTM<InputDataType, OutputDataType>::Forward(
   gate.cols(forwardStep, forwardStep + batchStep) = input2GateWeight * input +
       output2GateWeight * outParameter.cols(
       forwardStep, forwardStep + batchStep);
-  gate.cols(forwardStep, forwardStep + batchStep).each_col() += input2GateBias;
 
-  FastSigmoid(std::move(
-      gate.submat(0, forwardStep, 3 * outSize - 1, forwardStep + batchStep)),
-      std::move(gateActivation.cols(forwardStep, forwardStep + batchStep)));
-
-  stateActivation.cols(forwardStep, forwardStep + batchStep) = arma::tanh(
-      gate.submat(3 * outSize, forwardStep, 4 * outSize - 1,
-      forwardStep + batchStep));
-
-  // Update the cell: cmul1 + cmul2
-  // where cmul1 is input gate * hidden state and
-  // cmul2 is forget gate * cell (prevCell).
-  if (forwardStep == 0)
-  {
-    cell.cols(forwardStep, forwardStep + batchStep) =
-        gateActivation.submat(0, forwardStep, outSize - 1,
-        forwardStep + batchStep) %
-        stateActivation.cols(forwardStep, forwardStep + batchStep);
-  }
-  else
+  // Add the bias, apply the gate functions, and update the cell and the
+  // output in one pass over each point, instead of one pass (and one
+  // temporary) for each operation.  The rows of the gates are the input gate,
+  // the output gate, the forget gate and the hidden state.
+  for (size_t c = 0; c < batchSize; ++c)
   {
-    cell.cols(forwardStep, forwardStep + batchStep) =
-        gateActivation.submat(0, forwardStep, outSize - 1,
-        forwardStep + batchStep) %
-        stateActivation.cols(forwardStep, forwardStep + batchStep) +
-        gateActivation.submat(2 * outSize, forwardStep, 3 * outSize - 1,
-        forwardStep + batchStep) %
-        cell.cols(forwardStep - batchSize, forwardStep - batchSize + batchStep);
+    const size_t col = forwardStep + c;
+    ElemType* gates = gate.colptr(col);
+    ElemType* gateActivations = gateActivation.colptr(col);
+    ElemType* states = stateActivation.colptr(col);
+    ElemType* cells = cell.colptr(col);
+    ElemType* cellActivations = cellActivation.colptr(col);
+    ElemType* outputs = outParameter.colptr(col + batchSize);
+    const ElemType* prevCells = (forwardStep == 0) ? NULL :
+        cell.colptr(col - batchSize);
+
+    for (size_t r = 0; r < 4 * outSize; ++r)
+      gates[r] += input2GateBias[r];
+
+    for (size_t r = 0; r < 3 * outSize; ++r)
+      gateActivations[r] = FastSigmoid(gates[r]);
+
+    for (size_t r = 0; r < outSize; ++r)
+    {
+      // Update the cell: cmul1 + cmul2
+      // where cmul1 is input gate * hidden state and
+      // cmul2 is forget gate * cell (prevCell).
+      states[r] = FastTanh(gates[3 * outSize + r]);
+      cells[r] = gateActivations[r] * states[r];
+      if (prevCells != NULL)
+        cells[r] += gateActivations[2 * outSize + r] * prevCells[r];
+
+      cellActivations[r] = FastTanh(cells[r]);
+      outputs[r] = cellActivations[r] * gateActivations[outSize + r];
+    }
   }
 
-  cellActivation.cols(forwardStep, forwardStep + batchStep) =
-      arma::tanh(cell.cols(forwardStep, forwardStep + batchStep));
-
-  outParameter.cols(forwardStep + batchSize,
-      forwardStep + batchSize + batchStep) = cellActivation.cols(
-      forwardStep, forwardStep + batchStep) % gateActivation.submat(
-      outSize, forwardStep, 2 * outSize - 1, forwardStep + batchStep);
-
   output = OutputType(outParameter.memptr() +
       (forwardStep + batchSize) * outSize, outSize, batchSize, false, false);
 
@@ -185,51 +184,48 @@ void FastLSTM<InputDataType, OutputDataType>::Backward(
     gy += output2GateWeight.t() * prevError;
   }
 
-  cellActivationError = gy % gateActivation.submat(outSize,
-      backwardStep - batchStep, 2 * outSize - 1, backwardStep) %
-      (1 - arma::pow(cellActivation.cols(backwardStep - batchStep,
-      backwardStep), 2));
-
-  if (gradientStepIdx > 0)
-    cellActivationError += forgetGateError;
-
-  forgetGateError = gateActivation.submat(2 * outSize,
-      backwardStep - batchStep, 3 * outSize - 1, backwardStep) %
-      cellActivationError;
-
-  if (backwardStep > batchStep)
+  // Compute the errors of the cell and the gates in one pass over each point.
+  // The first step of the window has no previous cell.
+  const bool hasPrevCell = (backwardStep > batchStep);
+  const bool hasNextCell = (gradientStepIdx > 0);
+  cellActivationError.set_size(outSize, batchSize);
+  forgetGateError.set_size(outSize, batchSize);
+  prevError.set_size(4 * outSize, batchSize);
+  for (size_t c = 0; c < batchSize; ++c)
   {
-    prevError.submat(2 * outSize, 0, 3 * outSize - 1, batchStep) =
-        cell.cols((backwardStep - batchSize) - batchStep,
-        (backwardStep - batchSize)) % cellActivationError %
-        gateActivation.submat(2 * outSize, backwardStep - batchStep,
-        3 * outSize - 1, backwardStep) % (1.0 - gateActivation.submat(
-        2 * outSize, backwardStep - batchStep, 3 * outSize - 1, backwardStep));
-  }
-  else
-  {
-    prevError.submat(2 * outSize, 0, 3 * outSize - 1, batchStep).zeros();
+    const size_t col = backwardStep - batchStep + c;
+    const ElemType* errors = gy.colptr(c);
+    const ElemType* inputGates = gateActivation.colptr(col);
+    const ElemType* outputGates = inputGates + outSize;
+    const ElemType* forgetGates = inputGates + 2 * outSize;
+    const ElemType* states = stateActivation.colptr(col);
+    const ElemType* cellActivations = cellActivation.colptr(col);
+    const ElemType* prevCells = hasPrevCell ? cell.colptr(col - batchSize) :
+        NULL;
+    ElemType* cellErrors = cellActivationError.colptr(c);
+    ElemType* forgetErrors = forgetGateError.colptr(c);
+    ElemType* gateErrors = prevError.colptr(c);
+
+    for (size_t r = 0; r < outSize; ++r)
+    {
+      cellErrors[r] = errors[r] * outputGates[r] * (1 - cellActivations[r] *
+          cellActivations[r]);
+      if (hasNextCell)
+        cellErrors[r] += forgetErrors[r];
+
+      forgetErrors[r] = forgetGates[r] * cellErrors[r];
+
+      gateErrors[r] = states[r] * cellErrors[r] * inputGates[r] *
+          (1.0 - inputGates[r]);
+      gateErrors[outSize + r] = cellActivations[r] * errors[r] *
+          outputGates[r] * (1.0 - outputGates[r]);
+      gateErrors[2 * outSize + r] = hasPrevCell ? prevCells[r] *
+          cellErrors[r] * forgetGates[r] * (1.0 - forgetGates[r]) : 0;
+      gateErrors[3 * outSize + r] = inputGates[r] * cellErrors[r] *
+          (1 - states[r] * states[r]);
+    }
   }
 
-  prevError.submat(0, 0, outSize - 1, batchStep) =
-      stateActivation.cols(backwardStep - batchStep,
-      backwardStep) % cellActivationError % gateActivation.submat(
-      0, backwardStep - batchStep, outSize - 1, backwardStep) %
-      (1.0 - gateActivation.submat(
-      0, backwardStep - batchStep, outSize - 1, backwardStep));
-
-  prevError.submat(3 * outSize, 0, 4 * outSize - 1, batchStep) =
-      gateActivation.submat(0, backwardStep - batchStep,
-      outSize - 1, backwardStep) % cellActivationError % (1 - arma::pow(
-      stateActivation.cols(backwardStep - batchStep, backwardStep), 2));
-
-  prevError.submat(outSize, 0, 2 * outSize - 1, batchStep) =
-      cellActivation.cols(backwardStep - batchStep,
-      backwardStep) % gy % gateActivation.submat(
-       outSize, backwardStep - batchStep, 2 * outSize - 1, backwardStep) %
-      (1.0 - gateActivation.submat(
-      outSize, backwardStep - batchStep, 2 * outSize - 1, backwardStep));
-
   g = input2GateWeight.t() * prevError;
 
   backwardStep -= batchSize;
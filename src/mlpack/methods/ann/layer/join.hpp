@@ -13,6 +13,7 @@
 #define MLPACK_METHODS_ANN_LAYER_JOIN_HPP
 
 #include <mlpack/prereqs.hpp>
+#include "matrix_views.hpp"
 
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
@@ -33,7 +33,9 @@ void Join<InputDataType, OutputDataType>::Forward(
 {
   inSizeRows = input.n_rows;
   inSizeCols = input.n_cols;
-  output = arma::vectorise(input);
+
+  // The elements of the input are already in the order of the output.
+  MakeView(output, input.memptr(), input.n_elem, 1);
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -43,7 +45,7 @@ void Join<InputDataType, OutputDataType>::Backward(
     arma::Mat<eT>&& gy,
     arma::Mat<eT>&& g)
 {
-  g = arma::mat(gy.memptr(), inSizeRows, inSizeCols, false, false);
+  MakeView(g, gy.memptr(), inSizeRows, inSizeCols);
 }
 
 template<typename InputDataType, typename OutputDataType>
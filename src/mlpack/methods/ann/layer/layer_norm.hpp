@@ -184,6 +184,9 @@ class LayerNorm
 
   //! Locally-stored normalized input.
   OutputDataType normalized;
+
+  //! Locally-stored inverse standard deviation of each point.
+  OutputDataType stdInv;
 }; // class LayerNorm
 
 } // namespace ann
@@ -41,8 +41,9 @@ LayerNorm<InputDataType, OutputDataType>::LayerNorm(
 template<typename InputDataType, typename OutputDataType>
 void LayerNorm<InputDataType, OutputDataType>::Reset()
 {
-  gamma = arma::mat(weights.memptr(), size, 1, false, false);
-  beta = arma::mat(weights.memptr() + gamma.n_elem, size, 1, false, false);
+  gamma = OutputDataType(weights.memptr(), size, 1, false, false);
+  beta = OutputDataType(weights.memptr() + gamma.n_elem, size, 1, false,
+      false);
 
   if (!loading)
   {
@@ -58,46 +59,77 @@ template<typename eT>
 void LayerNorm<InputDataType, OutputDataType>::Forward(
     const arma::Mat<eT>&& input, arma::Mat<eT>&& output)
 {
-  mean = arma::mean(input, 0);
-  variance = arma::var(input, 1, 0);
-
-  // Normalize the input.
-  output = input.each_row() - mean;
-
-  output.each_row() /= arma::sqrt(variance + eps);
-
-  // Reused in the backward and gradient step.
-  normalized = output;
-
-  // Scale and shift the output.
-  output.each_col() %= gamma;
-  output.each_col() += beta;
+  output.set_size(arma::size(input));
+  normalized.set_size(arma::size(input));
+  mean.set_size(1, input.n_cols);
+  variance.set_size(1, input.n_cols);
+  stdInv.set_size(1, input.n_cols);
+
+  // Each point is normalized on its own: one sweep computes the mean and
+  // variance with Welford's method, and one more writes the normalized input
+  // and the scaled and shifted output.
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) input.n_cols; ++i)
+  {
+    const eT* x = input.colptr(i);
+    double pointMean = 0.0;
+    double squares = 0.0;
+    for (size_t r = 0; r < input.n_rows; ++r)
+    {
+      const double delta = x[r] - pointMean;
+      pointMean += delta / (r + 1);
+      squares += delta * (x[r] - pointMean);
+    }
+
+    mean[i] = pointMean;
+    variance[i] = squares / input.n_rows;
+    stdInv[i] = 1.0 / std::sqrt(variance[i] + eps);
+
+    eT* xhat = normalized.colptr(i);
+    eT* y = output.colptr(i);
+    for (size_t r = 0; r < input.n_rows; ++r)
+    {
+      xhat[r] = (x[r] - pointMean) * stdInv[i];
+      y[r] = xhat[r] * gamma[r] + beta[r];
+    }
+  }
 }
 
 template<typename InputDataType, typename OutputDataType>
 template<typename eT>
 void LayerNorm<InputDataType, OutputDataType>::Backward(
-    const arma::Mat<eT>&& input, arma::Mat<eT>&& gy, arma::Mat<eT>&& g)
+    const arma::Mat<eT>&& /* input */, arma::Mat<eT>&& gy, arma::Mat<eT>&& g)
 {
-  const arma::mat inputMean = input.each_row() - mean;
-  const arma::mat stdInv = 1.0 / arma::sqrt(variance + eps);
-
-  // dl / dxhat
-  const arma::mat norm = gy.each_col() % gamma;
-
-  // sum dl / dxhat * (x - mu) * -0.5 * stdInv^3.
-  const arma::mat var = arma::sum(norm % inputMean, 0) %
-      arma::pow(stdInv, 3.0) * -0.5;
-
-  // dl / dxhat * 1 / stdInv + variance * 2 * (x - mu) / m +
-  // dl / dmu * 1 / m.
-  g = (norm.each_row() % stdInv) + (inputMean.each_row() %
-      var * 2 / input.n_rows);
-
-  // sum (dl / dxhat * -1 / stdInv) + variance *
-  // (sum -2 * (x - mu)) / m.
-  g.each_row() += (arma::sum(norm.each_row() % -stdInv, 0) + (var %
-      arma::mean(-2 * inputMean, 0))) / input.n_rows;
+  g.set_size(arma::size(gy));
+
+  // With dl / dxhat = dl / dy * gamma, the error of each point is
+  //
+  //   stdInv * (dl / dxhat - (sum dl / dxhat + xhat * sum dl / dxhat * xhat)
+  //       / m),
+  //
+  // computed from the normalized input and inverse standard deviation cached
+  // by the forward pass, with one sweep for the sums and one for the error.
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) gy.n_cols; ++i)
+  {
+    const eT* error = gy.colptr(i);
+    const eT* xhat = normalized.colptr(i);
+    double sum = 0.0;
+    double normalizedSum = 0.0;
+    for (size_t r = 0; r < gy.n_rows; ++r)
+    {
+      const double norm = error[r] * gamma[r];
+      sum += norm;
+      normalizedSum += norm * xhat[r];
+    }
+
+    eT* out = g.colptr(i);
+    for (size_t r = 0; r < gy.n_rows; ++r)
+    {
+      out[r] = stdInv[i] * (error[r] * gamma[r] - (sum + xhat[r] *
+          normalizedSum) / gy.n_rows);
+    }
+  }
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -107,14 +139,21 @@ void LayerNorm<InputDataType, OutputDataType>::Gradient(
     arma::Mat<eT>&& error,
     arma::Mat<eT>&& gradient)
 {
-  gradient.set_size(size + size, 1);
+  gradient.zeros(size + size, 1);
 
-  // Step 5: dl / dy * xhat.
-  gradient.submat(0, 0, gamma.n_elem - 1, 0) = arma::sum(normalized % error, 1);
-
-  // Step 6: dl / dy.
-  gradient.submat(gamma.n_elem, 0, gradient.n_elem - 1, 0) =
-      arma::sum(error, 1);
+  // Step 5: dl / dy * xhat, and step 6: dl / dy, in one sweep.
+  eT* gammaGradient = gradient.memptr();
+  eT* betaGradient = gradient.memptr() + gamma.n_elem;
+  for (size_t i = 0; i < error.n_cols; ++i)
+  {
+    const eT* e = error.colptr(i);
+    const eT* xhat = normalized.colptr(i);
+    for (size_t r = 0; r < error.n_rows; ++r)
+    {
+      gammaGradient[r] += e[r] * xhat[r];
+      betaGradient[r] += e[r];
+    }
+  }
 }
 
 template<typename InputDataType, typename OutputDataType>
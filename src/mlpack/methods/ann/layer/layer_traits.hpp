@@ -59,6 +59,10 @@ class LayerTraits
 // we can use with SFINAE to catch when a type has a Gradient(...) function.
 HAS_MEM_FUNC(Gradient, HasGradientCheck);
 
+// This gives us a HasForwardCheck<T, U> type (where U is a function pointer)
+// we can use with SFINAE to catch when a type has a Forward(...) function.
+HAS_MEM_FUNC(Forward, HasForwardCheck);
+
 // This gives us a HasDeterministicCheck<T, U> type (where U is a function
 // pointer) we can use with SFINAE to catch when a type has a Deterministic()
 // function.
@@ -88,6 +92,11 @@ HAS_MEM_FUNC(Reset, HasResetCheck);
 // we can use with SFINAE to catch when a type has a ResetCell() function.
 HAS_MEM_FUNC(ResetCell, HasResetCellCheck);
 
+// This gives us a HasCarryStateCheck<T, U> type (where U is a function
+// pointer) we can use with SFINAE to catch when a type has a CarryState()
+// function.
+HAS_MEM_FUNC(CarryState, HasCarryStateCheck);
+
 // This gives us a HasRewardCheck<T, U> type (where U is a function pointer) we
 // can use with SFINAE to catch when a type has a Reward() function.
 HAS_MEM_FUNC(Reward, HasRewardCheck);
@@ -38,8 +38,8 @@ Linear<InputDataType, OutputDataType>::Linear(
 template<typename InputDataType, typename OutputDataType>
 void Linear<InputDataType, OutputDataType>::Reset()
 {
-  weight = arma::mat(weights.memptr(), outSize, inSize, false, false);
-  bias = arma::mat(weights.memptr() + weight.n_elem,
+  weight = OutputDataType(weights.memptr(), outSize, inSize, false, false);
+  bias = OutputDataType(weights.memptr() + weight.n_elem,
       outSize, 1, false, false);
 }
 
@@ -52,6 +52,19 @@ void Linear<InputDataType, OutputDataType>::Forward(
   output.each_col() += bias;
 }
 
+template<typename InputDataType, typename OutputDataType>
+void Linear<InputDataType, OutputDataType>::Forward(
+    const arma::sp_mat& input, arma::mat&& output)
+{
+  // Each nonzero element adds its column of the weights to the output of its
+  // point.
+  output.zeros(outSize, input.n_cols);
+  arma::sp_mat::const_iterator it = input.begin();
+  for (; it != input.end(); ++it)
+    output.col(it.col()) += (*it) * weight.col(it.row());
+  output.each_col() += bias;
+}
+
 template<typename InputDataType, typename OutputDataType>
 template<typename eT>
 void Linear<InputDataType, OutputDataType>::Backward(
@@ -73,6 +86,23 @@ void Linear<InputDataType, OutputDataType>::Gradient(
       arma::sum(error, 1);
 }
 
+template<typename InputDataType, typename OutputDataType>
+void Linear<InputDataType, OutputDataType>::Gradient(
+    const arma::sp_mat& input,
+    arma::mat&& error,
+    arma::mat&& gradient)
+{
+  // The gradient of the weights is error * input^T; each nonzero element adds
+  // the error of its point to the gradient of the weights of its unit.
+  arma::mat weightGradient(gradient.memptr(), outSize, inSize, false, true);
+  weightGradient.zeros();
+  arma::sp_mat::const_iterator it = input.begin();
+  for (; it != input.end(); ++it)
+    weightGradient.col(it.row()) += (*it) * error.col(it.col());
+  gradient.submat(weight.n_elem, 0, gradient.n_elem - 1, 0) =
+      arma::sum(error, 1);
+}
+
 template<typename InputDataType, typename OutputDataType>
 template<typename Archive>
 void Linear<InputDataType, OutputDataType>::serialize(
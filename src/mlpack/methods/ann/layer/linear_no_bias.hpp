@@ -61,6 +61,16 @@ class LinearNoBias
   template<typename eT>
   void Forward(const arma::Mat<eT>&& input, arma::Mat<eT>&& output);
 
+  /**
+   * Feed forward pass for a batch of sparse input, such as the bag-of-words or
+   * hashed features of the first layer of a network.  Only the nonzero
+   * elements of the input are visited.
+   *
+   * @param input Sparse input data used for evaluating the specified function.
+   * @param output Resulting output activation.
+   */
+  void Forward(const arma::sp_mat& input, arma::mat&& output);
+
   /**
    * Ordinary feed backward pass of a neural network, calculating the function
    * f(x) by propagating x backwards trough f. Using the results from the feed
@@ -87,11 +97,31 @@ class LinearNoBias
                 arma::Mat<eT>&& error,
                 arma::Mat<eT>&& gradient);
 
+  /**
+   * Calculate the gradient for a batch of sparse input.  The gradient of the
+   * weights of each input unit only gets contributions from the points where
+   * that unit is nonzero, so the work is proportional to the number of
+   * nonzero elements of the input times the number of output units.
+   *
+   * @param input The sparse input parameter used for calculating the gradient.
+   * @param error The calculated error.
+   * @param gradient The calculated gradient.
+   */
+  void Gradient(const arma::sp_mat& input,
+                arma::mat&& error,
+                arma::mat&& gradient);
+
   //! Get the parameters.
   OutputDataType const& Parameters() const { return weights; }
   //! Modify the parameters.
   OutputDataType& Parameters() { return weights; }
 
+  //! Get the number of input units.
+  size_t InputSize() const { return inSize; }
+
+  //! Get the number of output units.
+  size_t OutputSize() const { return outSize; }
+
   //! Get the input parameter.
   InputDataType const& InputParameter() const { return inputParameter; }
   //! Modify the input parameter.
@@ -37,7 +37,7 @@ LinearNoBias<InputDataType, OutputDataType>::LinearNoBias(
 template <typename InputDataType, typename OutputDataType>
 void LinearNoBias<InputDataType, OutputDataType>::Reset()
 {
-  weight = arma::mat(weights.memptr(), outSize, inSize, false, false);
+  weight = OutputDataType(weights.memptr(), outSize, inSize, false, false);
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -48,6 +48,18 @@ void LinearNoBias<InputDataType, OutputDataType>::Forward(
   output = weight * input;
 }
 
+template<typename InputDataType, typename OutputDataType>
+void LinearNoBias<InputDataType, OutputDataType>::Forward(
+    const arma::sp_mat& input, arma::mat&& output)
+{
+  // Each nonzero element adds its column of the weights to the output of its
+  // point.
+  output.zeros(outSize, input.n_cols);
+  arma::sp_mat::const_iterator it = input.begin();
+  for (; it != input.end(); ++it)
+    output.col(it.col()) += (*it) * weight.col(it.row());
+}
+
 template<typename InputDataType, typename OutputDataType>
 template<typename eT>
 void LinearNoBias<InputDataType, OutputDataType>::Backward(
@@ -67,6 +79,21 @@ void LinearNoBias<InputDataType, OutputDataType>::Gradient(
       error * input.t());
 }
 
+template<typename InputDataType, typename OutputDataType>
+void LinearNoBias<InputDataType, OutputDataType>::Gradient(
+    const arma::sp_mat& input,
+    arma::mat&& error,
+    arma::mat&& gradient)
+{
+  // The gradient of the weights is error * input^T; each nonzero element adds
+  // the error of its point to the gradient of the weights of its unit.
+  arma::mat weightGradient(gradient.memptr(), outSize, inSize, false, true);
+  weightGradient.zeros();
+  arma::sp_mat::const_iterator it = input.begin();
+  for (; it != input.end(); ++it)
+    weightGradient.col(it.row()) += (*it) * error.col(it.col());
+}
+
 template<typename InputDataType, typename OutputDataType>
 template<typename Archive>
 void LinearNoBias<InputDataType, OutputDataType>::serialize(
@@ -100,6 +100,30 @@ class Lookup
   //! Modify the gradient.
   OutputDataType& Gradient() { return gradient; }
 
+  //! Get whether Gradient() only keeps the nonzero columns of the gradient.
+  bool SparseGradient() const { return sparseGradient; }
+  //! Modify whether Gradient() only keeps the nonzero columns of the gradient.
+  //! If true, Gradient() neither writes nor zeroes the given gradient of the
+  //! weights; it adds the columns of the batch to TouchedGradient() instead,
+  //! until ClearTouched() is called.
+  bool& SparseGradient() { return sparseGradient; }
+
+  //! Get the sorted columns of the weights with a nonzero gradient: the
+  //! columns the last call of Gradient() wrote to, or with SparseGradient(),
+  //! the columns of all calls since the last call of ClearTouched().
+  arma::uvec const& TouchedColumns() const { return touchedColumns; }
+
+  //! Get the gradient of the columns given by TouchedColumns(), if
+  //! SparseGradient() is true.
+  OutputDataType const& TouchedGradient() const { return touchedGradient; }
+
+  //! Forget the touched columns and their gradient.
+  void ClearTouched()
+  {
+    touchedColumns.reset();
+    touchedGradient.reset();
+  }
+
   /**
    * Serialize the layer
    */
@@ -122,6 +146,15 @@ class Lookup
   //! Locally-stored gradient object.
   OutputDataType gradient;
 
+  //! Whether Gradient() only keeps the nonzero columns of the gradient.
+  bool sparseGradient;
+
+  //! Locally-stored columns with a nonzero gradient.
+  arma::uvec touchedColumns;
+
+  //! Locally-stored gradient of the touched columns, with SparseGradient().
+  OutputDataType touchedGradient;
+
   //! Locally-stored output parameter object.
   OutputDataType outputParameter;
 }; // class Lookup
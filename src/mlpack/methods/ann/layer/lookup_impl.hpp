@@ -24,7 +24,8 @@ Lookup<InputDataType, OutputDataType>::Lookup(
     const size_t inSize,
     const size_t outSize) :
     inSize(inSize),
-    outSize(outSize)
+    outSize(outSize),
+    sparseGradient(false)
 {
   weights.set_size(outSize, inSize);
 }
@@ -54,8 +55,44 @@ void Lookup<InputDataType, OutputDataType>::Gradient(
     arma::Mat<eT>&& error,
     arma::Mat<eT>&& gradient)
 {
-  gradient = arma::zeros<arma::Mat<eT> >(weights.n_rows, weights.n_cols);
-  gradient.cols(arma::conv_to<arma::uvec>::from(input) - 1) = error;
+  // Only the columns of the tokens in the batch are nonzero; a token that
+  // appears more than once gets the sum of its errors.
+  const arma::uvec columns = arma::conv_to<arma::uvec>::from(input) - 1;
+  if (!sparseGradient)
+  {
+    gradient = arma::zeros<arma::Mat<eT> >(weights.n_rows, weights.n_cols);
+    for (size_t i = 0; i < columns.n_elem; ++i)
+      gradient.col(columns(i)) += error.col(i);
+
+    touchedColumns = arma::unique(columns);
+    return;
+  }
+
+  // Only keep the nonzero columns, so that the cost does not depend on the
+  // size of the table.  Add the new columns to those of the previous calls.
+  const arma::uvec merged = arma::unique(arma::join_cols(touchedColumns,
+      columns));
+  if (merged.n_elem != touchedColumns.n_elem)
+  {
+    arma::Mat<eT> mergedGradient(weights.n_rows, merged.n_elem,
+        arma::fill::zeros);
+    for (size_t j = 0, k = 0; j < touchedColumns.n_elem; ++j, ++k)
+    {
+      while (merged(k) != touchedColumns(j))
+        ++k;
+      mergedGradient.col(k) = touchedGradient.col(j);
+    }
+
+    touchedColumns = merged;
+    touchedGradient = std::move(mergedGradient);
+  }
+
+  for (size_t i = 0; i < columns.n_elem; ++i)
+  {
+    const size_t j = std::lower_bound(touchedColumns.begin(),
+        touchedColumns.end(), columns(i)) - touchedColumns.begin();
+    touchedGradient.col(j) += error.col(i);
+  }
 }
 
 template<typename InputDataType, typename OutputDataType>
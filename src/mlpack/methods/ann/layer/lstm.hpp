@@ -13,6 +13,8 @@
 #define MLPACK_METHODS_ANN_LAYER_LSTM_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/methods/ann/activation_functions/logistic_function.hpp>
+#include <mlpack/methods/ann/activation_functions/tanh_function.hpp>
 #include <limits>
 
 namespace mlpack {
@@ -124,6 +126,13 @@ class LSTM
    */
   void ResetCell(const size_t size);
 
+  /*
+   * Start the next window of truncated BPTT: the output and the cell state of
+   * the last step of the current window become the state the first step of
+   * the next window starts from.  The BPTT chain is not continued.
+   */
+  void CarryState();
+
   /*
    * Calculate the gradient using the output delta and the input activation.
    *
@@ -315,6 +324,15 @@ class LSTM
 
   //! Current backpropagate through time steps.
   size_t bpttSteps;
+
+  //! The cell state the first step starts from; empty if it starts from zero.
+  OutputDataType prevCell;
+
+  //! Apply the given activation function to the columns of the current
+  //! forward step of the input, storing the results in the same columns of
+  //! the output.
+  template<typename ActivationFunction>
+  void StepActivation(OutputDataType& input, OutputDataType& output);
 }; // class LSTM
 
 } // namespace ann
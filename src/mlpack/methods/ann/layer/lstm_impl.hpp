@@ -60,6 +60,11 @@ void LSTM<InputDataType, OutputDataType>::ResetCell(const size_t size)
   backwardStep = batchSize * size - 1;
   gradientStep = batchSize * size - 1;
 
+  // Start again from a zero state.
+  prevCell.reset();
+  if (outParameter.n_cols >= batchSize)
+    outParameter.cols(0, batchStep).zeros();
+
   const size_t rhoBatchSize = size * batchSize;
   if (inputGate.is_empty() || inputGate.n_cols < rhoBatchSize)
   {
@@ -93,6 +98,25 @@ void LSTM<InputDataType, OutputDataType>::ResetCell(const size_t size)
   }
 }
 
+template<typename InputDataType, typename OutputDataType>
+void LSTM<InputDataType, OutputDataType>::CarryState()
+{
+  if (batchSize == 0 || outParameter.n_cols < (bpttSteps + 1) * batchSize)
+    return;
+
+  // The output of the last step of the window is the first block of
+  // outParameter for the next window.
+  outParameter.cols(0, batchStep) = outParameter.cols(bpttSteps * batchSize,
+      bpttSteps * batchSize + batchStep);
+  prevCell = cell.cols((bpttSteps - 1) * batchSize,
+      (bpttSteps - 1) * batchSize + batchStep);
+
+  forwardStep = 0;
+  gradientStepIdx = 0;
+  backwardStep = batchSize * rhoSize - 1;
+  gradientStep = batchSize * rhoSize - 1;
+}
+
 template<typename InputDataType, typename OutputDataType>
 void LSTM<InputDataType, OutputDataType>::Reset()
 {
@@ -221,12 +245,16 @@ void LSTM<InputDataType, OutputDataType>::Forward(InputType&& input,
         arma::repmat(cell2GateForgetWeight, 1, batchSize) %
         cell.cols(forwardStep - batchSize, forwardStep - batchSize + batchStep);
   }
+  else if (!prevCell.is_empty())
+  {
+    inputGate.cols(0, batchStep) += arma::repmat(cell2GateInputWeight, 1,
+        batchSize) % prevCell;
+    forgetGate.cols(0, batchStep) += arma::repmat(cell2GateForgetWeight, 1,
+        batchSize) % prevCell;
+  }
 
-  inputGateActivation.cols(forwardStep, forwardStep + batchStep) = 1.0 /
-      (1 + arma::exp(-inputGate.cols(forwardStep, forwardStep + batchStep)));
-
-  forgetGateActivation.cols(forwardStep, forwardStep + batchStep) = 1.0 /
-      (1 + arma::exp(-forgetGate.cols(forwardStep, forwardStep + batchStep)));
+  StepActivation<LogisticFunction>(inputGate, inputGateActivation);
+  StepActivation<LogisticFunction>(forgetGate, forgetGateActivation);
 
   hiddenLayer.cols(forwardStep, forwardStep + batchStep) = input2HiddenWeight *
       input + output2HiddenWeight * outParameter.cols(
@@ -235,14 +263,19 @@ void LSTM<InputDataType, OutputDataType>::Forward(InputType&& input,
   hiddenLayer.cols(forwardStep, forwardStep + batchStep).each_col() +=
       input2HiddenBias;
 
-  hiddenLayerActivation.cols(forwardStep, forwardStep + batchStep) =
-      arma::tanh(hiddenLayer.cols(forwardStep, forwardStep + batchStep));
+  StepActivation<TanhFunction>(hiddenLayer, hiddenLayerActivation);
 
   if (forwardStep == 0)
   {
     cell.cols(forwardStep, forwardStep + batchStep) =
         inputGateActivation.cols(forwardStep, forwardStep + batchStep) %
         hiddenLayerActivation.cols(forwardStep, forwardStep + batchStep);
+
+    if (!prevCell.is_empty())
+    {
+      cell.cols(0, batchStep) += forgetGateActivation.cols(0, batchStep) %
+          prevCell;
+    }
   }
   else
   {
@@ -261,11 +294,8 @@ void LSTM<InputDataType, OutputDataType>::Forward(InputType&& input,
   outputGate.cols(forwardStep, forwardStep + batchStep).each_col() +=
       input2GateOutputBias;
 
-  outputGateActivation.cols(forwardStep, forwardStep + batchStep) = 1.0 /
-      (1 + arma::exp(-outputGate.cols(forwardStep, forwardStep + batchStep)));
-
-  cellActivation.cols(forwardStep, forwardStep + batchStep) =
-      arma::tanh(cell.cols(forwardStep, forwardStep + batchStep));
+  StepActivation<LogisticFunction>(outputGate, outputGateActivation);
+  StepActivation<TanhFunction>(cell, cellActivation);
 
   outParameter.cols(forwardStep + batchSize,
       forwardStep + batchSize + batchStep) =
@@ -285,6 +315,21 @@ void LSTM<InputDataType, OutputDataType>::Forward(InputType&& input,
   }
 }
 
+template<typename InputDataType, typename OutputDataType>
+template<typename ActivationFunction>
+void LSTM<InputDataType, OutputDataType>::StepActivation(
+    OutputDataType& input, OutputDataType& output)
+{
+  // The columns of the step are contiguous, so they are aliased instead of
+  // taken as a subview; that lets the activation function use its fast path
+  // for dense matrices.
+  OutputDataType inputStep(input.colptr(forwardStep), input.n_rows, batchSize,
+      false, true);
+  OutputDataType outputStep(output.colptr(forwardStep), output.n_rows,
+      batchSize, false, true);
+  ActivationFunction::Fn(inputStep, outputStep);
+}
+
 template<typename InputDataType, typename OutputDataType>
 template<typename InputType, typename ErrorType, typename GradientType>
 void LSTM<InputDataType, OutputDataType>::Backward(
@@ -319,6 +364,12 @@ void LSTM<InputDataType, OutputDataType>::Backward(
       backwardStep - batchStep, backwardStep) % (1.0 -
       forgetGateActivation.cols(backwardStep - batchStep, backwardStep)));
   }
+  else if (!prevCell.is_empty())
+  {
+    forgetGateError = prevCell % cellError % (forgetGateActivation.cols(
+        backwardStep - batchStep, backwardStep) % (1.0 -
+        forgetGateActivation.cols(backwardStep - batchStep, backwardStep)));
+  }
   else
   {
     forgetGateError.zeros();
@@ -436,6 +487,14 @@ void LSTM<InputDataType, OutputDataType>::Gradient(
                   cell.cols((gradientStep - batchSize) - batchStep,
                             (gradientStep - batchSize)), 1);
   }
+  else if (!prevCell.is_empty())
+  {
+    gradient.submat(offset, 0, offset + cell2GateForgetWeight.n_elem - 1, 0) =
+        arma::sum(forgetGateError % prevCell, 1);
+    gradient.submat(offset + cell2GateForgetWeight.n_elem, 0, offset +
+        cell2GateForgetWeight.n_elem + cell2GateInputWeight.n_elem - 1, 0) =
+        arma::sum(inputGateError % prevCell, 1);
+  }
   else
   {
     gradient.submat(offset, 0, offset +
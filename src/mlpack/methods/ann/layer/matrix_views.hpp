@@ -0,0 +1,61 @@
+/**
+ * @file matrix_views.hpp
+ *
+ * Helpers for layers whose output (or delta) can be a non-owning view of the
+ * memory of their input (or of the error they are given), instead of a copy.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_LAYER_MATRIX_VIEWS_HPP
+#define MLPACK_METHODS_ANN_LAYER_MATRIX_VIEWS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * Make the given matrix a non-owning view of the given number of rows and
+ * columns of memory, without copying it.  Move-assigning a matrix that uses
+ * auxiliary memory keeps it pointing to that memory, so this works on the
+ * output and delta members of a layer, which the network passes on to the
+ * next layer.  The memory must not be freed or resized while the view is in
+ * use, which holds for the outputs and deltas of the other layers of a
+ * network during a forward or backward pass.  The view must not be written
+ * to; use DetachView() before writing into a matrix that may be a view.
+ *
+ * @param view Matrix to make a view.
+ * @param memory Memory to view.
+ * @param rows Number of rows of the view.
+ * @param cols Number of columns of the view.
+ */
+template<typename eT>
+void MakeView(arma::Mat<eT>& view,
+              const eT* memory,
+              const size_t rows,
+              const size_t cols)
+{
+  view = arma::Mat<eT>(const_cast<eT*>(memory), rows, cols, false, false);
+}
+
+/**
+ * If the given matrix is a view of memory it does not own (as made by
+ * MakeView()), make it an empty matrix that owns its memory, so that resizing
+ * it or assigning to it does not write into the memory it was a view of.
+ *
+ * @param matrix Matrix to detach.
+ */
+template<typename eT>
+void DetachView(arma::Mat<eT>& matrix)
+{
+  if (matrix.mem_state == 1)
+    matrix.reset();
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
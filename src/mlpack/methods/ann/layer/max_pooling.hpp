@@ -188,6 +188,43 @@ class MaxPooling
     }
   }
 
+  /**
+   * Whether the windows are 2x2 or 3x3 with a stride of 2 and floor
+   * rounding, the common case that StridedPooling() handles.
+   */
+  bool Strided() const
+  {
+    return floor && kW == kH && (kW == 2 || kW == 3) && dW == 2 && dH == 2;
+  }
+
+  /**
+   * Apply pooling with KxK windows and a stride of 2 to all maps of the
+   * batch at once.  The inner loops work on raw memory with a fixed window
+   * size, so the compiler can unroll and vectorize them.
+   *
+   * @param input The maps to pool, one slice per map and point.
+   * @param output The pooled maps.
+   * @param offsets If not NULL, the column-major position of the maximum in
+   *     each window, one byte per output element.
+   */
+  template<size_t K, typename eT>
+  void StridedPooling(const arma::Cube<eT>& input,
+                      arma::Cube<eT>& output,
+                      unsigned char* offsets) const;
+
+  /**
+   * Pass the error of each window of StridedPooling() to the position of
+   * its maximum.
+   *
+   * @param error The backward error, one slice per map and point.
+   * @param output The error of the input maps; must be zero.
+   * @param offsets The positions of the maxima stored by StridedPooling().
+   */
+  template<size_t K, typename eT>
+  void StridedUnpooling(const arma::Cube<eT>& error,
+                        arma::Cube<eT>& output,
+                        const unsigned char* offsets) const;
+
   //! Locally-stored width of the pooling window.
   size_t kW;
 
@@ -262,6 +299,10 @@ class MaxPooling
 
   //! Locally-stored pooling indicies.
   std::vector<arma::cube> poolingIndices;
+
+  //! Locally-stored positions of the maxima within their windows, one byte
+  //! per output element, for the windows StridedPooling() handles.
+  std::vector<std::vector<unsigned char> > poolingOffsets;
 }; // class MaxPooling
 
 } // namespace ann
@@ -77,6 +77,26 @@ void MaxPooling<InputDataType, OutputDataType>::Forward(
   outputTemp = arma::zeros<arma::Cube<eT> >(outputWidth, outputHeight,
       batchSize * inSize);
 
+  if (Strided())
+  {
+    unsigned char* offsets = NULL;
+    if (!deterministic)
+    {
+      poolingOffsets.push_back(std::vector<unsigned char>(outputTemp.n_elem));
+      offsets = poolingOffsets.back().data();
+    }
+
+    if (kW == 2)
+      StridedPooling<2>(inputTemp, outputTemp, offsets);
+    else
+      StridedPooling<3>(inputTemp, outputTemp, offsets);
+
+    output = arma::Mat<eT>(outputTemp.memptr(), outputTemp.n_elem / batchSize,
+        batchSize);
+    outSize = batchSize * inSize;
+    return;
+  }
+
   if (!deterministic)
   {
     poolingIndices.push_back(outputTemp);
@@ -126,6 +146,18 @@ void MaxPooling<InputDataType, OutputDataType>::Backward(
   gTemp = arma::zeros<arma::cube>(inputTemp.n_rows,
       inputTemp.n_cols, inputTemp.n_slices);
 
+  if (Strided())
+  {
+    if (kW == 2)
+      StridedUnpooling<2>(mappedError, gTemp, poolingOffsets.back().data());
+    else
+      StridedUnpooling<3>(mappedError, gTemp, poolingOffsets.back().data());
+
+    poolingOffsets.pop_back();
+    g = arma::mat(gTemp.memptr(), gTemp.n_elem / batchSize, batchSize);
+    return;
+  }
+
   for (size_t s = 0; s < mappedError.n_slices; s++)
   {
     Unpooling(mappedError.slice(s), gTemp.slice(s),
@@ -137,6 +169,99 @@ void MaxPooling<InputDataType, OutputDataType>::Backward(
   g = arma::mat(gTemp.memptr(), gTemp.n_elem / batchSize, batchSize);
 }
 
+template<typename InputDataType, typename OutputDataType>
+template<size_t K, typename eT>
+void MaxPooling<InputDataType, OutputDataType>::StridedPooling(
+    const arma::Cube<eT>& input,
+    arma::Cube<eT>& output,
+    unsigned char* offsets) const
+{
+  const size_t inRows = input.n_rows;
+  const size_t outRows = output.n_rows;
+  const size_t outCols = output.n_cols;
+
+  for (size_t s = 0; s < input.n_slices; ++s)
+  {
+    const eT* in = input.slice_memptr(s);
+    eT* out = output.slice_memptr(s);
+
+    for (size_t j = 0; j < outCols; ++j)
+    {
+      const eT* inCol = in + 2 * j * inRows;
+      eT* outCol = out + j * outRows;
+
+      if (offsets == NULL)
+      {
+        for (size_t i = 0; i < outRows; ++i)
+        {
+          const eT* window = inCol + 2 * i;
+          eT value = window[0];
+          for (size_t c = 0; c < K; ++c)
+            for (size_t r = 0; r < K; ++r)
+              value = std::max(value, window[c * inRows + r]);
+
+          outCol[i] = value;
+        }
+      }
+      else
+      {
+        unsigned char* offsetCol = offsets + (s * outCols + j) * outRows;
+        for (size_t i = 0; i < outRows; ++i)
+        {
+          // Keep the first maximum in column-major order, like
+          // MaxPoolingRule.
+          const eT* window = inCol + 2 * i;
+          eT value = window[0];
+          unsigned char offset = 0;
+          for (size_t c = 0; c < K; ++c)
+          {
+            for (size_t r = 0; r < K; ++r)
+            {
+              if (window[c * inRows + r] > value)
+              {
+                value = window[c * inRows + r];
+                offset = (unsigned char) (c * K + r);
+              }
+            }
+          }
+
+          outCol[i] = value;
+          offsetCol[i] = offset;
+        }
+      }
+    }
+  }
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<size_t K, typename eT>
+void MaxPooling<InputDataType, OutputDataType>::StridedUnpooling(
+    const arma::Cube<eT>& error,
+    arma::Cube<eT>& output,
+    const unsigned char* offsets) const
+{
+  const size_t inRows = output.n_rows;
+  const size_t outRows = error.n_rows;
+  const size_t outCols = error.n_cols;
+
+  for (size_t s = 0; s < error.n_slices; ++s)
+  {
+    const eT* err = error.slice_memptr(s);
+    eT* out = output.slice_memptr(s);
+    const unsigned char* offsetSlice = offsets + s * outCols * outRows;
+
+    for (size_t j = 0; j < outCols; ++j)
+    {
+      for (size_t i = 0; i < outRows; ++i)
+      {
+        const size_t offset = offsetSlice[j * outRows + i];
+        out[(2 * j + offset / K) * inRows + 2 * i + offset % K] +=
+            err[j * outRows + i];
+      }
+    }
+  }
+}
+
 template<typename InputDataType, typename OutputDataType>
 template<typename Archive>
 void MaxPooling<InputDataType, OutputDataType>::serialize(
@@ -172,6 +172,38 @@ class MeanPooling
     }
   }
 
+  /**
+   * Whether the windows are 2x2 or 3x3 with a stride of 2 and floor
+   * rounding, the common case that StridedPooling() handles.
+   */
+  bool Strided() const
+  {
+    return floor && kW == kH && (kW == 2 || kW == 3) && dW == 2 && dH == 2;
+  }
+
+  /**
+   * Apply pooling with KxK windows and a stride of 2 to all maps of the
+   * batch at once.  The inner loops work on raw memory with a fixed window
+   * size, so the compiler can unroll and vectorize them.
+   *
+   * @param input The maps to pool, one slice per map and point.
+   * @param output The pooled maps.
+   */
+  template<size_t K, typename eT>
+  void StridedPooling(const arma::Cube<eT>& input,
+                      arma::Cube<eT>& output) const;
+
+  /**
+   * Spread the error of each window of StridedPooling() evenly over the
+   * window.
+   *
+   * @param error The backward error, one slice per map and point.
+   * @param output The error of the input maps; must be zero.
+   */
+  template<size_t K, typename eT>
+  void StridedUnpooling(const arma::Cube<eT>& error,
+                        arma::Cube<eT>& output) const;
+
   //! Locally-stored width of the pooling window.
   size_t kW;
 
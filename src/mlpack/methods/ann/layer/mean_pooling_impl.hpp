@@ -79,8 +79,19 @@ void MeanPooling<InputDataType, OutputDataType>::Forward(
   outputTemp = arma::zeros<arma::Cube<eT> >(outputWidth, outputHeight,
       batchSize * inSize);
 
-  for (size_t s = 0; s < inputTemp.n_slices; s++)
-    Pooling(inputTemp.slice(s), outputTemp.slice(s));
+  if (Strided() && kW == 2)
+  {
+    StridedPooling<2>(inputTemp, outputTemp);
+  }
+  else if (Strided())
+  {
+    StridedPooling<3>(inputTemp, outputTemp);
+  }
+  else
+  {
+    for (size_t s = 0; s < inputTemp.n_slices; s++)
+      Pooling(inputTemp.slice(s), outputTemp.slice(s));
+  }
 
   output = arma::Mat<eT>(outputTemp.memptr(), outputTemp.n_elem / batchSize,
       batchSize);
@@ -103,14 +114,90 @@ void MeanPooling<InputDataType, OutputDataType>::Backward(
   gTemp = arma::zeros<arma::cube>(inputTemp.n_rows,
       inputTemp.n_cols, inputTemp.n_slices);
 
-  for (size_t s = 0; s < mappedError.n_slices; s++)
+  if (Strided() && kW == 2)
   {
-    Unpooling(inputTemp.slice(s), mappedError.slice(s), gTemp.slice(s));
+    StridedUnpooling<2>(mappedError, gTemp);
+  }
+  else if (Strided())
+  {
+    StridedUnpooling<3>(mappedError, gTemp);
+  }
+  else
+  {
+    for (size_t s = 0; s < mappedError.n_slices; s++)
+    {
+      Unpooling(inputTemp.slice(s), mappedError.slice(s), gTemp.slice(s));
+    }
   }
 
   g = arma::mat(gTemp.memptr(), gTemp.n_elem / batchSize, batchSize);
 }
 
+template<typename InputDataType, typename OutputDataType>
+template<size_t K, typename eT>
+void MeanPooling<InputDataType, OutputDataType>::StridedPooling(
+    const arma::Cube<eT>& input,
+    arma::Cube<eT>& output) const
+{
+  const size_t inRows = input.n_rows;
+  const size_t outRows = output.n_rows;
+  const size_t outCols = output.n_cols;
+
+  for (size_t s = 0; s < input.n_slices; ++s)
+  {
+    const eT* in = input.slice_memptr(s);
+    eT* out = output.slice_memptr(s);
+
+    for (size_t j = 0; j < outCols; ++j)
+    {
+      const eT* inCol = in + 2 * j * inRows;
+      eT* outCol = out + j * outRows;
+
+      for (size_t i = 0; i < outRows; ++i)
+      {
+        const eT* window = inCol + 2 * i;
+        eT sum = 0;
+        for (size_t c = 0; c < K; ++c)
+          for (size_t r = 0; r < K; ++r)
+            sum += window[c * inRows + r];
+
+        outCol[i] = sum / (K * K);
+      }
+    }
+  }
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<size_t K, typename eT>
+void MeanPooling<InputDataType, OutputDataType>::StridedUnpooling(
+    const arma::Cube<eT>& error,
+    arma::Cube<eT>& output) const
+{
+  const size_t inRows = output.n_rows;
+  const size_t outRows = error.n_rows;
+  const size_t outCols = error.n_cols;
+
+  for (size_t s = 0; s < error.n_slices; ++s)
+  {
+    const eT* err = error.slice_memptr(s);
+    eT* out = output.slice_memptr(s);
+
+    for (size_t j = 0; j < outCols; ++j)
+    {
+      eT* outCol = out + 2 * j * inRows;
+
+      for (size_t i = 0; i < outRows; ++i)
+      {
+        const eT value = err[j * outRows + i] / (K * K);
+        eT* window = outCol + 2 * i;
+        for (size_t c = 0; c < K; ++c)
+          for (size_t r = 0; r < K; ++r)
+            window[c * inRows + r] += value;
+      }
+    }
+  }
+}
+
 template<typename InputDataType, typename OutputDataType>
 template<typename Archive>
 void MeanPooling<InputDataType, OutputDataType>::serialize(
@@ -111,6 +111,14 @@ class Recurrent
                 arma::Mat<eT>&& error,
                 arma::Mat<eT>&& /* gradient */);
 
+  /**
+   * Start a new input sequence of the given number of time steps (at most
+   * rho).
+   *
+   * @param size Number of time steps of the new input sequence.
+   */
+  void ResetCell(const size_t size);
+
   //! Get the model modules.
   std::vector<LayerTypes<CustomLayers...> >& Model() { return network; }
 
@@ -167,6 +175,9 @@ class Recurrent
   //! Number of steps to backpropagate through time (BPTT).
   size_t rho;
 
+  //! Number of time steps of the current input sequence.
+  size_t rhoSize;
+
   //! Locally-stored number of forward steps.
   size_t forwardStep;
 
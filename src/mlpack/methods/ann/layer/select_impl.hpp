@@ -33,14 +33,10 @@ template<typename eT>
 void Select<InputDataType, OutputDataType>::Forward(
     const arma::Mat<eT>&& input, arma::Mat<eT>&& output)
 {
-  if (elements == 0)
-  {
-    output = input.col(index);
-  }
-  else
-  {
-    output = input.submat(0, index, elements - 1, index);
-  }
+  // The selected elements of a column are contiguous, so the output is a view
+  // of them.
+  MakeView(output, input.colptr(index), elements == 0 ? input.n_rows :
+      elements, 1);
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -50,14 +46,8 @@ void Select<InputDataType, OutputDataType>::Backward(
     arma::Mat<eT>&& gy,
     arma::Mat<eT>&& g)
 {
-  if (elements == 0)
-  {
-    g = gy;
-  }
-  else
-  {
-    g = gy.submat(0, 0, elements - 1, 0);
-  }
+  MakeView(g, gy.memptr(), elements == 0 ? gy.n_rows : elements,
+      elements == 0 ? gy.n_cols : 1);
 }
 
 template<typename InputDataType, typename OutputDataType>
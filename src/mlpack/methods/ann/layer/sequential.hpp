@@ -56,6 +56,17 @@ namespace ann /** Artificial Neural Network. */ {
  * Note: This class should at least have two layers for a call to its Gradient()
  *       function.
  *
+ * If Checkpoint() is set, the outputs of the modules are discarded after the
+ * forward pass, and only the input of the container is kept.  Backward() then
+ * runs the forward pass of the modules again, and also computes their
+ * gradient so that the outputs and deltas can be discarded before the backward
+ * pass of the rest of the network; Gradient() does nothing in that case.  This
+ * trades a second forward pass for the memory of the intermediate outputs.
+ * Since the modules are run twice per batch, a checkpointed container should
+ * not hold modules whose forward pass is random or keeps state for the
+ * backward pass (like Dropout, BatchNorm or MaxPooling), and it can only be
+ * used in an FFN, which calls Backward() once per Forward().
+ *
  * @tparam InputDataType Type of the input data (arma::colvec, arma::mat,
  *         arma::sp_mat or arma::cube).
  * @tparam OutputDataType Type of the output data (arma::colvec, arma::mat,
@@ -173,6 +184,11 @@ class Sequential
   //! Modify the gradient.
   arma::mat& Gradient() { return gradient; }
 
+  //! Get whether the outputs of the modules are recomputed in Backward().
+  bool Checkpoint() const { return checkpoint; }
+  //! Modify whether the outputs of the modules are recomputed in Backward().
+  bool& Checkpoint() { return checkpoint; }
+
   /**
    * Serialize the layer
    */
@@ -180,9 +196,31 @@ class Sequential
   void serialize(Archive& /* ar */, const unsigned int /* version */);
 
  private:
+  /**
+   * Run the forward pass of the modules, leaving the result in the output
+   * parameter of the last module.
+   *
+   * @param input Input data used for evaluating the specified function.
+   */
+  template<typename eT>
+  void ForwardModules(arma::Mat<eT>&& input);
+
+  /**
+   * Calculate the gradient of the modules from the outputs and deltas of the
+   * last forward and backward pass.
+   *
+   * @param input The input parameter used for calculating the gradient.
+   * @param error The calculated error.
+   */
+  template<typename eT>
+  void GradientModules(arma::Mat<eT>&& input, arma::Mat<eT>&& error);
+
   //! Parameter which indicates if the modules should be exposed.
   bool model;
 
+  //! Whether the outputs of the modules are recomputed in Backward().
+  bool checkpoint;
+
   //! Indicator if we already initialized the model.
   bool reset;
 
@@ -216,6 +254,9 @@ class Sequential
   //! Locally-stored gradient object.
   arma::mat gradient;
 
+  //! The input of the last forward pass, kept if checkpoint is set.
+  arma::mat checkpointInput;
+
   //! Locally-stored output width visitor.
   OutputWidthVisitor outputWidthVisitor;
 
@@ -29,7 +29,8 @@ template <typename InputDataType, typename OutputDataType, bool Residual,
           typename... CustomLayers>
 Sequential<
     InputDataType, OutputDataType, Residual, CustomLayers...>::Sequential(
-        const bool model) : model(model), reset(false), width(0), height(0)
+        const bool model) :
+    model(model), checkpoint(false), reset(false), width(0), height(0)
 {
   // Nothing to do here.
 }
@@ -52,6 +53,37 @@ template<typename eT>
 void Sequential<
     InputDataType, OutputDataType, Residual, CustomLayers...>::Forward(
         arma::Mat<eT>&& input, arma::Mat<eT>&& output)
+{
+  ForwardModules(std::move(input));
+  output = boost::apply_visitor(outputParameterVisitor, network.back());
+
+  if (Residual)
+  {
+    if (arma::size(output) != arma::size(input))
+    {
+      Log::Fatal << "The sizes of the output and input matrices of the Residual"
+          << " block should be equal. Please examine the network architecture."
+          << std::endl;
+    }
+    output += input;
+  }
+
+  // Only keep the input; the outputs of the modules are computed again in
+  // Backward().
+  if (checkpoint)
+  {
+    checkpointInput = input;
+    for (size_t i = 0; i < network.size(); ++i)
+      boost::apply_visitor(outputParameterVisitor, network[i]).reset();
+  }
+}
+
+template<typename InputDataType, typename OutputDataType, bool Residual,
+         typename... CustomLayers>
+template<typename eT>
+void Sequential<
+    InputDataType, OutputDataType, Residual, CustomLayers...>::ForwardModules(
+        arma::Mat<eT>&& input)
 {
   boost::apply_visitor(ForwardVisitor(std::move(input), std::move(
       boost::apply_visitor(outputParameterVisitor, network.front()))),
@@ -106,19 +138,6 @@ void Sequential<
   {
     reset = true;
   }
-
-  output = boost::apply_visitor(outputParameterVisitor, network.back());
-
-  if (Residual)
-  {
-    if (arma::size(output) != arma::size(input))
-    {
-      Log::Fatal << "The sizes of the output and input matrices of the Residual"
-          << " block should be equal. Please examine the network architecture."
-          << std::endl;
-    }
-    output += input;
-  }
 }
 
 template<typename InputDataType, typename OutputDataType, bool Residual,
@@ -130,6 +149,9 @@ void Sequential<
         arma::Mat<eT>&& gy,
         arma::Mat<eT>&& g)
 {
+  if (checkpoint)
+    ForwardModules(std::move(checkpointInput));
+
   boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
       outputParameterVisitor, network.back())), std::move(gy),
       std::move(boost::apply_visitor(deltaVisitor, network.back()))),
@@ -150,6 +172,20 @@ void Sequential<
   {
     g += gy;
   }
+
+  // The gradient is computed right away, so that the recomputed outputs and
+  // the deltas of the modules can be discarded again before the backward pass
+  // of the next segment of the network.
+  if (checkpoint)
+  {
+    GradientModules(std::move(checkpointInput), std::move(gy));
+    for (size_t i = 0; i < network.size(); ++i)
+    {
+      boost::apply_visitor(outputParameterVisitor, network[i]).reset();
+      boost::apply_visitor(deltaVisitor, network[i]).reset();
+    }
+    checkpointInput.reset();
+  }
 }
 
 template<typename InputDataType, typename OutputDataType, bool Residual,
@@ -160,6 +196,18 @@ void Sequential<
         arma::Mat<eT>&& input,
         arma::Mat<eT>&& error,
         arma::Mat<eT>&& /* gradient */)
+{
+  // With checkpointing the gradient was already computed by Backward().
+  if (!checkpoint)
+    GradientModules(std::move(input), std::move(error));
+}
+
+template<typename InputDataType, typename OutputDataType, bool Residual,
+         typename... CustomLayers>
+template<typename eT>
+void Sequential<
+    InputDataType, OutputDataType, Residual, CustomLayers...>::GradientModules(
+        arma::Mat<eT>&& input, arma::Mat<eT>&& error)
 {
   boost::apply_visitor(GradientVisitor(std::move(boost::apply_visitor(
       outputParameterVisitor, network[network.size() - 2])), std::move(error)),
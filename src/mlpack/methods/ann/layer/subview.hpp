@@ -13,6 +13,7 @@
 #define MLPACK_METHODS_ANN_LAYER_SUBVIEW_HPP
 
 #include <mlpack/prereqs.hpp>
+#include "matrix_views.hpp"
 #include <mlpack/methods/ann/activation_functions/identity_function.hpp>
 
 namespace mlpack {
@@ -76,29 +77,36 @@ class Subview
     endCol = ((endCol < inSize) && (endCol >= beginCol)) ?
         endCol : (inSize - 1);
 
-    output.set_size(
-        (endRow - beginRow + 1) * (endCol - beginCol + 1), batchSize);
+    const size_t outputRows = (endRow - beginRow + 1) *
+        (endCol - beginCol + 1);
 
-    size_t batchBegin = beginCol;
-    size_t batchEnd = endCol;
-
-    // Check whether the input is already in desired form.
-    if ((input.n_rows != ((endRow - beginRow + 1) *
-        (endCol - beginCol + 1))) || (input.n_cols != batchSize))
+    // If the input is already in the desired form, or the subview of a single
+    // sample covers whole columns (so it is contiguous), the output is a view
+    // of the input.
+    if (input.n_rows == outputRows && input.n_cols == batchSize)
+    {
+      MakeView(output, input.memptr(), outputRows, batchSize);
+      return;
+    }
+    else if (batchSize == 1 && beginRow == 0 && endRow == input.n_rows - 1)
     {
-      for (size_t i = 0; i < batchSize; i++)
-      {
-        output.col(i) = arma::vectorise(
-            input.submat(beginRow, batchBegin, endRow, batchEnd));
-
-        // Move to next batch.
-        batchBegin += inSize;
-        batchEnd += inSize;
-      }
+      MakeView(output, input.colptr(beginCol), outputRows, 1);
+      return;
     }
-    else
+
+    DetachView(output);
+    output.set_size(outputRows, batchSize);
+
+    size_t batchBegin = beginCol;
+    size_t batchEnd = endCol;
+    for (size_t i = 0; i < batchSize; i++)
     {
-      output = input;
+      output.col(i) = arma::vectorise(
+          input.submat(beginRow, batchBegin, endRow, batchEnd));
+
+      // Move to next batch.
+      batchBegin += inSize;
+      batchEnd += inSize;
     }
   }
 
@@ -116,7 +124,7 @@ class Subview
                 arma::Mat<eT>&& gy,
                 arma::Mat<eT>&& g)
   {
-    g = gy;
+    MakeView(g, gy.memptr(), gy.n_rows, gy.n_cols);
   }
 
   //! Get the output parameter.
@@ -0,0 +1,152 @@
+/**
+ * @file layer_profiler.hpp
+ *
+ * Definition of the LayerProfiler class, which records the time and the work
+ * of each layer of a network in the forward, backward and gradient passes.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_LAYER_PROFILER_HPP
+#define MLPACK_METHODS_ANN_LAYER_PROFILER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "visitor/delta_visitor.hpp"
+#include "visitor/layer_name_visitor.hpp"
+#include "visitor/output_height_visitor.hpp"
+#include "visitor/output_parameter_visitor.hpp"
+#include "visitor/output_width_visitor.hpp"
+#include "visitor/weight_size_visitor.hpp"
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * The LayerProfiler records, for each layer of a network and each of the
+ * forward, backward and gradient passes, the number of calls, the wall time,
+ * an estimate of the floating point operations, the number of bytes of the
+ * matrix the pass writes, and the shape of that matrix in the last call.  The
+ * FFN and RNN classes run their layers through Apply(), which only calls the
+ * layer when the profiler is disabled, so profiling costs nothing unless it
+ * is enabled.
+ *
+ * @code
+ * FFN<> model;
+ * // Add layers...
+ * model.Profiler().Enabled() = true;
+ * model.Train(data, responses);
+ * model.Profiler().Report(std::cout);
+ * @endcode
+ *
+ * The operation count is 2 multiply-adds for each weight of the layer, each
+ * point of the batch and each position of the output maps (for convolutional
+ * layers); layers without weights count one operation for each element they
+ * write.  Mostly useful to compare layers with each other.
+ */
+class LayerProfiler
+{
+ public:
+  //! The passes of a layer that are profiled.
+  enum Pass
+  {
+    FORWARD_PASS,
+    BACKWARD_PASS,
+    GRADIENT_PASS
+  };
+
+  //! What was recorded for one pass of one layer.
+  struct PassProfile
+  {
+    PassProfile() :
+        calls(0), time(0.0), flops(0.0), bytes(0), rows(0), cols(0) { }
+
+    //! The number of calls.
+    size_t calls;
+    //! The total wall time of the calls, in seconds.
+    double time;
+    //! The estimated total number of floating point operations.
+    double flops;
+    //! The total number of bytes of the matrices written by the calls.
+    size_t bytes;
+    //! The number of rows of the matrix written by the last call.
+    size_t rows;
+    //! The number of columns of the matrix written by the last call.
+    size_t cols;
+  };
+
+  //! What was recorded for one layer.
+  struct LayerProfile
+  {
+    //! The name of the type of the layer.
+    std::string name;
+    //! The forward pass.
+    PassProfile forward;
+    //! The backward pass.
+    PassProfile backward;
+    //! The gradient pass.
+    PassProfile gradient;
+  };
+
+  //! Create a disabled profiler.
+  LayerProfiler() : enabled(false) { }
+
+  /**
+   * Apply the given visitor to the given layer, and record the call as the
+   * given pass of the layer with the given index if the profiler is enabled.
+   *
+   * @param pass The pass the visitor computes.
+   * @param index The index of the layer in the network.
+   * @param visitor The visitor to apply.
+   * @param layer The layer to apply the visitor to.
+   */
+  template<typename VisitorType, typename LayerType>
+  void Apply(const Pass pass,
+             const size_t index,
+             const VisitorType& visitor,
+             LayerType& layer);
+
+  //! Add the records of the given profiler to the records of this profiler.
+  void Merge(const LayerProfiler& other);
+
+  //! Forget everything that was recorded.
+  void Clear() { profiles.clear(); }
+
+  /**
+   * Print a table of the records, with one line for each pass of each layer
+   * that was called, to the given stream.
+   *
+   * @param stream Stream to print the table to.
+   */
+  void Report(std::ostream& stream) const;
+
+  //! Get whether the profiler records the calls.
+  bool Enabled() const { return enabled; }
+  //! Modify whether the profiler records the calls.
+  bool& Enabled() { return enabled; }
+
+  //! Get the records, one for each layer, in the order of the network.
+  const std::vector<LayerProfile>& Profiles() const { return profiles; }
+
+ private:
+  //! Add the given pass record to the other one.
+  static void Merge(const PassProfile& from, PassProfile& to);
+
+  //! Whether the calls are recorded.
+  bool enabled;
+
+  //! The records of each layer.
+  std::vector<LayerProfile> profiles;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "layer_profiler_impl.hpp"
+
+#endif
@@ -0,0 +1,153 @@
+/**
+ * @file layer_profiler_impl.hpp
+ *
+ * Implementation of the LayerProfiler class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_LAYER_PROFILER_IMPL_HPP
+#define MLPACK_METHODS_ANN_LAYER_PROFILER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "layer_profiler.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+template<typename VisitorType, typename LayerType>
+void LayerProfiler::Apply(const Pass pass,
+                          const size_t index,
+                          const VisitorType& visitor,
+                          LayerType& layer)
+{
+  if (!enabled)
+  {
+    boost::apply_visitor(visitor, layer);
+    return;
+  }
+
+  const std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  boost::apply_visitor(visitor, layer);
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  if (profiles.size() <= index)
+    profiles.resize(index + 1);
+
+  LayerProfile& profile = profiles[index];
+  if (profile.name.empty())
+    profile.name = boost::apply_visitor(LayerNameVisitor(), layer);
+
+  PassProfile* passProfile;
+  size_t rows, cols;
+  const size_t weights = boost::apply_visitor(WeightSizeVisitor(), layer);
+  if (pass == GRADIENT_PASS)
+  {
+    // The gradient pass writes the gradient of the weights, for the batch
+    // of the last forward pass.
+    passProfile = &profile.gradient;
+    rows = weights;
+    cols = 1;
+  }
+  else
+  {
+    passProfile = (pass == FORWARD_PASS) ? &profile.forward :
+        &profile.backward;
+    const arma::mat& output = (pass == FORWARD_PASS) ?
+        boost::apply_visitor(OutputParameterVisitor(), layer) :
+        boost::apply_visitor(DeltaVisitor(), layer);
+    rows = output.n_rows;
+    cols = output.n_cols;
+  }
+
+  const size_t batchSize = (pass == GRADIENT_PASS) ? profile.forward.cols :
+      cols;
+  const size_t positions = boost::apply_visitor(OutputWidthVisitor(), layer) *
+      boost::apply_visitor(OutputHeightVisitor(), layer);
+
+  passProfile->calls++;
+  passProfile->time += elapsed.count();
+  passProfile->flops += (weights == 0) ? double(rows * cols) :
+      2.0 * weights * batchSize * std::max(positions, size_t(1));
+  passProfile->bytes += rows * cols * sizeof(double);
+  passProfile->rows = rows;
+  passProfile->cols = cols;
+}
+
+inline void LayerProfiler::Merge(const LayerProfiler& other)
+{
+  if (profiles.size() < other.profiles.size())
+    profiles.resize(other.profiles.size());
+
+  for (size_t i = 0; i < other.profiles.size(); ++i)
+  {
+    if (profiles[i].name.empty())
+      profiles[i].name = other.profiles[i].name;
+
+    Merge(other.profiles[i].forward, profiles[i].forward);
+    Merge(other.profiles[i].backward, profiles[i].backward);
+    Merge(other.profiles[i].gradient, profiles[i].gradient);
+  }
+}
+
+inline void LayerProfiler::Merge(const PassProfile& from, PassProfile& to)
+{
+  if (from.calls == 0)
+    return;
+
+  to.calls += from.calls;
+  to.time += from.time;
+  to.flops += from.flops;
+  to.bytes += from.bytes;
+  to.rows = from.rows;
+  to.cols = from.cols;
+}
+
+inline void LayerProfiler::Report(std::ostream& stream) const
+{
+  const char* passNames[] = { "forward", "backward", "gradient" };
+
+  const std::ios::fmtflags flags = stream.flags();
+  const std::streamsize precision = stream.precision();
+  stream << std::left << std::setw(6) << "layer" << std::setw(20) << "name"
+      << std::setw(10) << "pass" << std::right << std::setw(10) << "calls"
+      << std::setw(12) << "time (s)" << std::setw(12) << "GFLOP"
+      << std::setw(12) << "MB" << std::setw(14) << "shape" << std::endl;
+
+  for (size_t i = 0; i < profiles.size(); ++i)
+  {
+    const PassProfile* passes[] = { &profiles[i].forward,
+        &profiles[i].backward, &profiles[i].gradient };
+    for (size_t p = 0; p < 3; ++p)
+    {
+      if (passes[p]->calls == 0)
+        continue;
+
+      std::ostringstream shape;
+      shape << passes[p]->rows << "x" << passes[p]->cols;
+      stream << std::left << std::setw(6) << i << std::setw(20)
+          << profiles[i].name << std::setw(10) << passNames[p] << std::right
+          << std::setw(10) << passes[p]->calls << std::fixed
+          << std::setprecision(6) << std::setw(12) << passes[p]->time
+          << std::setprecision(3) << std::setw(12) << passes[p]->flops / 1e9
+          << std::setw(12) << passes[p]->bytes / 1e6 << std::setw(14)
+          << shape.str() << std::endl;
+    }
+  }
+
+  stream.flags(flags);
+  stream.precision(precision);
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
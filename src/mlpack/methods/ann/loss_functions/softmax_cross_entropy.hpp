@@ -0,0 +1,166 @@
+/**
+ * @file softmax_cross_entropy.hpp
+ *
+ * Definition of the SoftmaxCrossEntropy class, a fused softmax and negative
+ * log likelihood output layer.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_LOSS_FUNCTIONS_SOFTMAX_CROSS_ENTROPY_HPP
+#define MLPACK_METHODS_ANN_LOSS_FUNCTIONS_SOFTMAX_CROSS_ENTROPY_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * Implementation of the softmax cross entropy output layer, which computes the
+ * same loss and error as a LogSoftMax layer followed by the
+ * NegativeLogLikelihood output layer, but directly from the raw scores of each
+ * class.  For each point, the loss
+ *
+ * \f$ \log \sum_j e^{x_j} - x_t \f$
+ *
+ * (where t is the target class) is computed with the maximum score subtracted
+ * first, so it is numerically stable, and the error of the backward pass is
+ * \f$ softmax(x) - e_t \f$, computed from the log-normalizers stored by the
+ * forward pass, so the probabilities are never materialized as a separate
+ * layer output and the scores are only visited once per pass.  The layer
+ * expects a class index, in the range between 1 and the number of classes, as
+ * target.
+ *
+ * For very large numbers of classes, a sampled softmax can be used instead:
+ * if the number of samples is nonzero (and smaller than the number of other
+ * classes), each call to Forward() draws that many classes uniformly without
+ * replacement, shared by the whole batch, and the loss and error of each point
+ * are computed only over the sampled classes and its target class.  The error
+ * for every other class is zero.  With a uniform proposal the usual log(Q)
+ * correction of the scores is the same for every class, so it cancels.  The
+ * sampled loss is a biased (but cheap) estimate of the full loss, and is only
+ * meant for training; use the full softmax to evaluate the network.
+ *
+ * @code
+ * @inproceedings{jean2015using,
+ *   title     = {On Using Very Large Target Vocabulary for Neural Machine
+ *                Translation},
+ *   author    = {Jean, S{\'e}bastien and Cho, Kyunghyun and Memisevic, Roland
+ *                and Bengio, Yoshua},
+ *   booktitle = {Proceedings of the 53rd Annual Meeting of the Association for
+ *                Computational Linguistics},
+ *   pages     = {1--10},
+ *   year      = {2015}
+ * }
+ * @endcode
+ *
+ * @tparam InputDataType Type of the input data (arma::colvec, arma::mat,
+ *         arma::sp_mat or arma::cube).
+ * @tparam OutputDataType Type of the output data (arma::colvec, arma::mat,
+ *         arma::sp_mat or arma::cube).
+ */
+template <
+    typename InputDataType = arma::mat,
+    typename OutputDataType = arma::mat
+>
+class SoftmaxCrossEntropy
+{
+ public:
+  /**
+   * Create the SoftmaxCrossEntropy object.
+   *
+   * @param samples Number of classes to sample for the sampled softmax (0
+   *        means the full softmax is used).
+   */
+  SoftmaxCrossEntropy(const size_t samples = 0);
+
+  /**
+   * Computes the softmax cross entropy of the given scores, and stores the
+   * log-normalizer of each point for the backward pass.
+   *
+   * @param input Input data used for evaluating the specified function.
+   * @param target The target vector, that contains the class index in the range
+   *        between 1 and the number of classes.
+   */
+  template<typename InputType, typename TargetType>
+  double Forward(const InputType&& input, TargetType&& target);
+
+  /**
+   * Ordinary feed backward pass of a neural network.  This uses the
+   * log-normalizers (and sampled classes) of the last call to Forward(), which
+   * must have been made with the same input.
+   *
+   * @param input The propagated input activation.
+   * @param target The target vector, that contains the class index in the range
+   *        between 1 and the number of classes.
+   * @param output The calculated error.
+   */
+  template<typename InputType, typename TargetType, typename OutputType>
+  void Backward(const InputType&& input,
+                const TargetType&& target,
+                OutputType&& output);
+
+  //! Get the input parameter.
+  InputDataType& InputParameter() const { return inputParameter; }
+  //! Modify the input parameter.
+  InputDataType& InputParameter() { return inputParameter; }
+
+  //! Get the output parameter.
+  OutputDataType& OutputParameter() const { return outputParameter; }
+  //! Modify the output parameter.
+  OutputDataType& OutputParameter() { return outputParameter; }
+
+  //! Get the delta.
+  OutputDataType& Delta() const { return delta; }
+  //! Modify the delta.
+  OutputDataType& Delta() { return delta; }
+
+  //! Get the number of sampled classes (0 for the full softmax).
+  size_t Samples() const { return samples; }
+  //! Modify the number of sampled classes (0 for the full softmax).
+  size_t& Samples() { return samples; }
+
+  //! Get the classes sampled by the last call to Forward() (empty if the full
+  //! softmax was used).
+  const arma::Col<size_t>& SampledClasses() const { return sampledClasses; }
+
+  /**
+   * Serialize the layer
+   */
+  template<typename Archive>
+  void serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! Draw the sampled classes out of the given number of classes, or clear
+  //! them if the full softmax should be used.
+  void SampleClasses(const size_t classes);
+
+  //! Number of classes to sample (0 for the full softmax).
+  size_t samples;
+
+  //! The classes sampled by the last call to Forward().
+  arma::Col<size_t> sampledClasses;
+
+  //! The log-normalizer of each point of the last call to Forward().
+  arma::rowvec logNormalizers;
+
+  //! Locally-stored delta object.
+  OutputDataType delta;
+
+  //! Locally-stored input parameter object.
+  InputDataType inputParameter;
+
+  //! Locally-stored output parameter object.
+  OutputDataType outputParameter;
+}; // class SoftmaxCrossEntropy
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "softmax_cross_entropy_impl.hpp"
+
+#endif
@@ -0,0 +1,159 @@
+/**
+ * @file softmax_cross_entropy_impl.hpp
+ *
+ * Implementation of the SoftmaxCrossEntropy class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_LOSS_FUNCTIONS_SOFTMAX_CROSS_ENTROPY_IMPL_HPP
+#define MLPACK_METHODS_ANN_LOSS_FUNCTIONS_SOFTMAX_CROSS_ENTROPY_IMPL_HPP
+
+// In case it hasn't yet been included.
+#include "softmax_cross_entropy.hpp"
+
+#include <unordered_set>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+template<typename InputDataType, typename OutputDataType>
+SoftmaxCrossEntropy<InputDataType, OutputDataType>::SoftmaxCrossEntropy(
+    const size_t samples) :
+    samples(samples)
+{
+  // Nothing to do here.
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename InputType, typename TargetType>
+double SoftmaxCrossEntropy<InputDataType, OutputDataType>::Forward(
+    const InputType&& input, TargetType&& target)
+{
+  SampleClasses(input.n_rows);
+  logNormalizers.set_size(input.n_cols);
+
+  double output = 0;
+  for (size_t i = 0; i < input.n_cols; ++i)
+  {
+    const size_t currentTarget = target(i) - 1;
+    Log::Assert(currentTarget >= 0 && currentTarget < input.n_rows,
+        "Target class out of range.");
+
+    const double* scores = input.colptr(i);
+    double maxScore = scores[currentTarget];
+    double sum = 0;
+    if (sampledClasses.is_empty())
+    {
+      for (size_t j = 0; j < input.n_rows; ++j)
+        maxScore = std::max(maxScore, scores[j]);
+      for (size_t j = 0; j < input.n_rows; ++j)
+        sum += std::exp(scores[j] - maxScore);
+    }
+    else
+    {
+      for (size_t j = 0; j < sampledClasses.n_elem; ++j)
+        maxScore = std::max(maxScore, scores[sampledClasses[j]]);
+
+      // The target class is included once, even if it was also sampled.
+      sum = std::exp(scores[currentTarget] - maxScore);
+      for (size_t j = 0; j < sampledClasses.n_elem; ++j)
+      {
+        if (sampledClasses[j] != currentTarget)
+          sum += std::exp(scores[sampledClasses[j]] - maxScore);
+      }
+    }
+
+    logNormalizers[i] = maxScore + std::log(sum);
+    output += logNormalizers[i] - scores[currentTarget];
+  }
+
+  return output;
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename InputType, typename TargetType, typename OutputType>
+void SoftmaxCrossEntropy<InputDataType, OutputDataType>::Backward(
+      const InputType&& input,
+      const TargetType&& target,
+      OutputType&& output)
+{
+  // Recompute the log-normalizers if Forward() was not called on this input.
+  if (logNormalizers.n_elem != input.n_cols)
+  {
+    arma::mat targetCopy(target);
+    Forward(std::move(input), std::move(targetCopy));
+  }
+
+  if (sampledClasses.is_empty())
+    output.set_size(input.n_rows, input.n_cols);
+  else
+    output.zeros(input.n_rows, input.n_cols);
+
+  for (size_t i = 0; i < input.n_cols; ++i)
+  {
+    const size_t currentTarget = target(i) - 1;
+    Log::Assert(currentTarget >= 0 && currentTarget < input.n_rows,
+        "Target class out of range.");
+
+    const double* scores = input.colptr(i);
+    double* error = output.colptr(i);
+    const double logNormalizer = logNormalizers[i];
+    if (sampledClasses.is_empty())
+    {
+      for (size_t j = 0; j < input.n_rows; ++j)
+        error[j] = std::exp(scores[j] - logNormalizer);
+    }
+    else
+    {
+      for (size_t j = 0; j < sampledClasses.n_elem; ++j)
+      {
+        const size_t c = sampledClasses[j];
+        error[c] = std::exp(scores[c] - logNormalizer);
+      }
+      error[currentTarget] = std::exp(scores[currentTarget] - logNormalizer);
+    }
+
+    error[currentTarget] -= 1;
+  }
+}
+
+template<typename InputDataType, typename OutputDataType>
+void SoftmaxCrossEntropy<InputDataType, OutputDataType>::SampleClasses(
+    const size_t classes)
+{
+  if (samples == 0 || samples >= classes - 1)
+  {
+    sampledClasses.reset();
+    return;
+  }
+
+  // Floyd's algorithm draws the classes without replacement in O(samples).
+  std::unordered_set<size_t> drawn;
+  sampledClasses.set_size(samples);
+  for (size_t j = classes - samples, k = 0; j < classes; ++j, ++k)
+  {
+    size_t c = (size_t) math::RandInt(j + 1);
+    if (drawn.count(c) > 0)
+      c = j;
+
+    drawn.insert(c);
+    sampledClasses[k] = c;
+  }
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename Archive>
+void SoftmaxCrossEntropy<InputDataType, OutputDataType>::serialize(
+    Archive& ar,
+    const unsigned int /* version */)
+{
+  ar & BOOST_SERIALIZATION_NVP(samples);
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -330,6 +330,17 @@ class RBM
   //! Return the number of steps of Gibbs Sampling.
   size_t NumSteps() const { return numSteps; }
 
+  /**
+   * Get the number of persistent chains used in the negative phase. If this is
+   * 0 (the default), one chain per point of the batch is kept. Otherwise, and
+   * if persistence is enabled, that many chains are stored contiguously and
+   * advanced together in every Gibbs step. Only BinaryRBM supports more than
+   * one chain; the SpikeSlabRBM conditionals pool the batch into one state.
+   */
+  size_t NumChains() const { return numChains; }
+  //! Modify the number of persistent chains used in the negative phase.
+  size_t& NumChains() { return numChains; }
+
   //! Return the parameters of the network.
   const arma::Mat<ElemType>& Parameters() const { return parameter; }
   //! Modify the parameters of the network.
@@ -375,6 +386,22 @@ class RBM
   void serialize(Archive& ar, const unsigned int /* version */);
 
  private:
+  /**
+   * Replace every probability in the given matrix with a sample of the
+   * Bernoulli distribution with that probability. All the uniform numbers are
+   * drawn at once into a reused buffer.
+   *
+   * @param probabilities Probabilities to be sampled in place.
+   */
+  void SampleBernoulli(arma::Mat<ElemType>& probabilities);
+
+  //! Return whether the negative phase uses the independent persistent chains.
+  bool PersistentChains() const
+  {
+    return persistence && numChains != 0 &&
+        std::is_same<PolicyType, BinaryRBM>::value;
+  }
+
   //! Locally stored parameters of the network.
   arma::Mat<ElemType> parameter;
   //! The matrix of data points (predictors).
@@ -399,6 +426,8 @@ class RBM
   size_t poolSize;
   //! Locally stored number of Sampling steps.
   size_t steps;
+  //! Locally-stored number of persistent chains (0 for one per point).
+  size_t numChains;
   //! Locally stored weight of the network.
   arma::Cube<ElemType> weight;
   //! Locally stored biases of the visible layer.
@@ -437,6 +466,10 @@ class RBM
   arma::Mat<ElemType> positiveGradient;
   //! Locally-stored temporary output of Gibbs chain.
   arma::Mat<ElemType> gibbsTemporary;
+  //! Locally-stored uniform numbers used for Bernoulli sampling.
+  arma::Mat<ElemType> uniformSamples;
+  //! Locally-stored standard normal numbers used for Gaussian sampling.
+  arma::Mat<ElemType> normalSamples;
   //! Locally-stored persistent CD-k boolean flag.
   bool persistence;
   //! Locally-stored reset variable.
@@ -45,6 +45,7 @@ RBM<InitializationRuleType, DataType, PolicyType>::RBM(
     negSteps(negSteps),
     poolSize(poolSize),
     steps(0),
+    numChains(0),
     slabPenalty(slabPenalty),
     radius(2 * radius),
     persistence(persistence),
@@ -131,13 +132,16 @@ RBM<InitializationRuleType, DataType, PolicyType>::Phase(
     DataType&& gradient)
 {
   arma::Cube<ElemType> weightGrad = arma::Cube<ElemType>(gradient.memptr(),
-      hiddenSize, visibleSize, 1, false, false);
+      hiddenSize, visibleSize, 1, false, true);
 
   DataType hiddenBiasGrad = DataType(gradient.memptr() + weightGrad.n_elem,
-      hiddenSize, 1, false, false);
+      hiddenSize, 1, false, true);
 
-  HiddenMean(std::move(input), std::move(hiddenBiasGrad));
-  weightGrad.slice(0) = hiddenBiasGrad * input.t();
+  // The hidden means of a batch are stored separately, so that the bias
+  // gradient is the sum over all the points instead of aliasing the gradient.
+  HiddenMean(std::move(input), std::move(hiddenReconstruction));
+  weightGrad.slice(0) = hiddenReconstruction * input.t();
+  hiddenBiasGrad = arma::sum(hiddenReconstruction, 1);
 }
 
 template<
@@ -150,10 +154,18 @@ double RBM<InitializationRuleType, DataType, PolicyType>::Evaluate(
     const size_t i,
     const size_t batchSize)
 {
-  Gibbs(std::move(predictors.cols(i, i + batchSize - 1)),
-      std::move(negativeSamples));
-  return std::fabs(FreeEnergy(std::move(predictors.cols(i,
-      i + batchSize - 1))) - FreeEnergy(std::move(negativeSamples)));
+  // Use the batch in place instead of copying the columns.
+  arma::Mat<ElemType> batch(predictors.colptr(i), visibleSize, batchSize,
+      false, true);
+
+  Gibbs(std::move(batch), std::move(negativeSamples));
+
+  // The persistent chains may hold a different number of samples than the
+  // batch, so compare the free energies per point in that case.
+  const ElemType negativeScale = PersistentChains() ?
+      (ElemType) batchSize / negativeSamples.n_cols : 1;
+  return std::fabs(FreeEnergy(std::move(batch)) -
+      negativeScale * FreeEnergy(std::move(negativeSamples)));
 }
 
 template<
@@ -168,11 +180,7 @@ RBM<InitializationRuleType, DataType, PolicyType>::SampleHidden(
     arma::Mat<ElemType>&& output)
 {
   HiddenMean(std::move(input), std::move(output));
-
-  for (size_t i = 0; i < output.n_elem; i++)
-  {
-    output(i) = math::RandBernoulli(output(i));
-  }
+  SampleBernoulli(output);
 }
 
 template<
@@ -187,11 +195,23 @@ RBM<InitializationRuleType, DataType, PolicyType>::SampleVisible(
     arma::Mat<ElemType>&& output)
 {
   VisibleMean(std::move(input), std::move(output));
+  SampleBernoulli(output);
+}
 
-  for (size_t i = 0; i < output.n_elem; i++)
-  {
-    output(i) = math::RandBernoulli(output(i));
-  }
+template<
+  typename InitializationRuleType,
+  typename DataType,
+  typename PolicyType
+>
+void RBM<InitializationRuleType, DataType, PolicyType>::SampleBernoulli(
+    arma::Mat<ElemType>& probabilities)
+{
+  uniformSamples.randu(probabilities.n_rows, probabilities.n_cols);
+
+  const ElemType* uniform = uniformSamples.memptr();
+  ElemType* p = probabilities.memptr();
+  for (size_t i = 0; i < probabilities.n_elem; i++)
+    p[i] = (uniform[i] < p[i]) ? 1 : 0;
 }
 
 template<
@@ -236,6 +256,14 @@ void RBM<InitializationRuleType, DataType, PolicyType>::Gibbs(
 {
   this->steps = (steps == SIZE_MAX) ? this->numSteps : steps;
 
+  // Start the persistent chains from randomly chosen data points; afterwards
+  // they are only advanced, and never restarted from the batch.
+  if (PersistentChains() && state.n_cols != numChains)
+  {
+    state = predictors.cols(arma::randi<arma::uvec>(numChains,
+        arma::distr_param(0, (int) predictors.n_cols - 1)));
+  }
+
   if (persistence && !state.is_empty())
   {
     SampleHidden(std::move(state), std::move(gibbsTemporary));
@@ -272,19 +300,26 @@ void RBM<InitializationRuleType, DataType, PolicyType>::Gradient(
   positiveGradient.zeros();
   negativeGradient.zeros();
 
-  Phase(std::move(predictors.cols(i, i + batchSize - 1)),
-      std::move(positiveGradient));
+  // Use the batch in place instead of copying the columns.
+  arma::Mat<ElemType> batch(predictors.colptr(i), visibleSize, batchSize,
+      false, true);
+
+  Phase(std::move(batch), std::move(positiveGradient));
 
-  for (size_t i = 0; i < negSteps; i++)
+  for (size_t step = 0; step < negSteps; step++)
   {
-    Gibbs(std::move(predictors.cols(i, i + batchSize - 1)),
-        std::move(negativeSamples));
+    Gibbs(std::move(batch), std::move(negativeSamples));
     Phase(std::move(negativeSamples), std::move(tempNegativeGradient));
 
     negativeGradient += tempNegativeGradient;
   }
 
-  gradient = ((negativeGradient / negSteps) - positiveGradient);
+  // The negative phase sums over the persistent chains; rescale it to the
+  // number of points summed in the positive phase.
+  const ElemType negativeScale = PersistentChains() ?
+      (ElemType) batchSize / negativeSamples.n_cols : 1;
+  gradient = ((negativeScale / negSteps) * negativeGradient) -
+      positiveGradient;
 }
 
 template<
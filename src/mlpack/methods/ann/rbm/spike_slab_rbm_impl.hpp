@@ -163,10 +163,8 @@ RBM<InitializationRuleType, DataType, PolicyType>::SampleVisible(
 
   for (k = 0; k < numMaxTrials; k++)
   {
-    for (size_t i = 0; i < visibleSize; i++)
-    {
-      output(i) = math::RandNormal(visibleMean(i), 1.0 / visiblePenalty(0));
-    }
+    normalSamples.randn(visibleSize, 1);
+    output = visibleMean + (1.0 / visiblePenalty(0)) * normalSamples;
     if (arma::norm(output, 2) < radius)
     {
       break;
@@ -259,10 +257,10 @@ RBM<InitializationRuleType, DataType, PolicyType>::SampleSpike(
     DataType&& spikeMean,
     DataType&& spike)
 {
-  for (size_t i = 0; i < hiddenSize; i++)
-  {
-    spike(i) = math::RandBernoulli(spikeMean(i));
-  }
+  if (&spike != &spikeMean)
+    spike = spikeMean;
+
+  SampleBernoulli(spike);
 }
 
 template<
@@ -295,13 +293,8 @@ RBM<InitializationRuleType, DataType, PolicyType>::SampleSlab(
     DataType&& slabMean,
     DataType&& slab)
 {
-  for (size_t i = 0; i < hiddenSize; i++)
-  {
-    for (size_t j = 0; j < poolSize; j++)
-    {
-      slab(j, i) = math::RandNormal(slabMean(j, i), 1.0 / slabPenalty);
-    }
-  }
+  normalSamples.randn(poolSize, hiddenSize);
+  slab = slabMean + (1.0 / slabPenalty) * normalSamples;
 }
 
 } // namespace ann
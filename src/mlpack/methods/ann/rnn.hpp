@@ -20,6 +20,9 @@
 #include "visitor/reset_visitor.hpp"
 
 #include "init_rules/network_init.hpp"
+#include "batch_prefetcher.hpp"
+#include "layer_profiler.hpp"
+#include "weight_file_io.hpp"
 
 #include <mlpack/methods/ann/layer/layer_types.hpp>
 #include <mlpack/methods/ann/layer/layer.hpp>
@@ -151,6 +154,23 @@ class RNN
                arma::cube& results,
                const size_t batchSize = 256);
 
+  /**
+   * Predict the responses to a given set of sequences of different lengths,
+   * padded at the end to the number of time steps of the predictors.  Each
+   * batch is only run for the time steps of its longest sequence, and the
+   * responses past the end of each sequence are zero.  The predictions are
+   * fastest if sequences of similar length are next to each other.
+   *
+   * @param predictors Input predictors.
+   * @param sequenceLengths Number of time steps of each sequence (column).
+   * @param results Matrix to put output predictions of responses into.
+   * @param batchSize Number of points to predict at once.
+   */
+  void Predict(arma::cube predictors,
+               const arma::urowvec& sequenceLengths,
+               arma::cube& results,
+               const size_t batchSize = 256);
+
   /**
    * Evaluate the recurrent neural network with the given parameters. This
    * function is usually called by the optimizer to train the model.
@@ -200,6 +220,27 @@ class RNN
                               GradType& gradient,
                               const size_t batchSize);
 
+  /**
+   * Evaluate the recurrent neural network with the given parameters, but
+   * using only a number of data points, and return the gradient as a sparse
+   * matrix.  Only the nonzero entries are stored, so for a network with a
+   * Lookup layer the gradient of the embedding table only has the columns of
+   * the tokens in the batch, and optimizers that take a sparse gradient type
+   * (like SGD) only update those.  The Lookup layers only compute the columns
+   * of the tokens in the batch.
+   *
+   * @param parameters Matrix model parameters.
+   * @param begin Index of the starting point to use for objective function
+   *        evaluation.
+   * @param gradient Sparse matrix to output gradient into.
+   * @param batchSize Number of points to be passed at a time to use for
+   *        objective function evaluation.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              const size_t begin,
+                              arma::sp_mat& gradient,
+                              const size_t batchSize);
+
   /**
    * Evaluate the gradient of the recurrent neural network with the given
    * parameters, and with respect to only one point in the dataset. This is
@@ -220,7 +261,11 @@ class RNN
 
   /**
    * Shuffle the order of function visitation. This may be called by the
-   * optimizer.
+   * optimizer.  Only the order of the points is shuffled (with sequence
+   * lengths, only points of the same length change their order); the points
+   * of each batch are then gathered from the predictors and responses.
+   * During Train(), the points of the next batch are gathered on another
+   * thread while the current batch is computed.
    */
   void Shuffle();
 
@@ -252,6 +297,35 @@ class RNN
   //! Modify the maximum length of backpropagation through time.
   size_t& Rho() { return rho; }
 
+  /**
+   * Get whether truncated BPTT is used.  Then all time steps (slices) of the
+   * data are used, not only the first rho, and the number of time steps must
+   * be a multiple of rho.  The sequences are processed in windows of rho time
+   * steps; the gradient of each window only goes back to the start of the
+   * window, and the LSTM layers start each window from the state the
+   * previous window ended with.  Only the outputs of one window are stored,
+   * so long sequences need no more memory than rho steps.
+   */
+  bool TruncatedBPTT() const { return truncatedBPTT; }
+  //! Modify whether truncated BPTT is used.
+  bool& TruncatedBPTT() { return truncatedBPTT; }
+
+  /**
+   * Get the number of time steps of each sequence (data point) of the
+   * training data.  If set, the sequences are padded at the end to the number
+   * of time steps of the predictors; each batch is only run for the time
+   * steps of its longest sequence, and the time steps past the end of a
+   * sequence add neither to the objective nor to the gradient.  Train() and
+   * Shuffle() sort the data points by decreasing length, so that the
+   * sequences of a batch have similar lengths and the sequences still running
+   * at any time step are the first points of the batch.  If empty (the
+   * default), every sequence has rho time steps.  This can not be combined
+   * with truncated BPTT.
+   */
+  const arma::urowvec& SequenceLengths() const { return sequenceLengths; }
+  //! Modify the number of time steps of each sequence of the training data.
+  arma::urowvec& SequenceLengths() { return sequenceLengths; }
+
   //! Get the matrix of responses to the input data points.
   const arma::cube& Responses() const { return responses; }
   //! Modify the matrix of responses to the input data points.
@@ -262,6 +336,12 @@ class RNN
   //! Modify the matrix of data points (predictors).
   arma::cube& Predictors() { return predictors; }
 
+  //! Get the profiler of the layers of the network.
+  const LayerProfiler& Profiler() const { return profiler; }
+  //! Modify the profiler of the layers of the network; enable it to record
+  //! the time and the work of each layer, summed over all time steps.
+  LayerProfiler& Profiler() { return profiler; }
+
   /**
    * Reset the state of the network.  This ensures that all internally-held
    * gradients are set to 0, all memory cells are reset, and the parameters
@@ -278,6 +358,29 @@ class RNN
   template<typename Archive>
   void serialize(Archive& ar, const unsigned int /* version */);
 
+  /**
+   * Save the layers and the parameters of the network to the given file in
+   * the binary weight file format (see WeightFileIO), so that it can later be
+   * loaded with LoadFlat().  The parameters must have been initialized.
+   *
+   * @param filename File to save the network to.
+   */
+  void SaveFlat(const std::string& filename) const;
+
+  /**
+   * Load the layers and the parameters of the network from the given weight
+   * file (see WeightFileIO and SaveFlat()).  The file is mapped into memory
+   * and the parameters are used directly from the mapped memory, so they are
+   * neither parsed nor copied, and every process that loads the same file
+   * shares their memory.  Changes to the parameters (for instance by further
+   * training) are private to this network and never written to the file.  The
+   * file stays mapped until another file is loaded or this object is
+   * destroyed.
+   *
+   * @param filename Weight file to load the network from.
+   */
+  void LoadFlat(const std::string& filename);
+
  private:
   // Helper functions.
   /**
@@ -290,8 +393,88 @@ class RNN
 
   /**
    * Reset the state of RNN cells in the network for new input sequence.
+   *
+   * @param steps Number of time steps of the new input sequence.
+   */
+  void ResetCells(const size_t steps);
+
+  /**
+   * Let the RNN cells in the network start the next window of truncated BPTT
+   * from the state the current window ended with.
    */
-  void ResetCells();
+  void CarryStates();
+
+  /**
+   * Throw std::invalid_argument if truncated BPTT is used and the given
+   * number of time steps is not a multiple of rho.
+   */
+  void CheckSequenceLength(const size_t steps) const;
+
+  /**
+   * Throw std::invalid_argument if the given sequence lengths are not empty
+   * and either truncated BPTT is used, there is not one length for each
+   * point, or a length is not between 1 and the given number of time steps.
+   */
+  void CheckSequenceLengths(const arma::urowvec& lengths,
+                            const size_t points,
+                            const size_t steps) const;
+
+  /**
+   * Return the number of time steps to run for the batch of points
+   * [begin, begin + batchSize): the given number of time steps, or the
+   * length of the longest sequence of the batch if it is shorter.
+   */
+  static size_t BatchSteps(const arma::urowvec& lengths,
+                           const size_t begin,
+                           const size_t batchSize,
+                           const size_t steps);
+
+  /**
+   * Return the number of points of the batch [begin, begin + batchSize)
+   * whose sequence is longer than the given time step; these are the first
+   * points of the batch, since the points are sorted by decreasing length.
+   * Without sequence lengths, this is the whole batch for the first steps
+   * time steps.
+   */
+  static size_t ActivePoints(const arma::urowvec& lengths,
+                             const size_t begin,
+                             const size_t batchSize,
+                             const size_t steps,
+                             const size_t step);
+
+  /**
+   * Reorder the points of the given predictors, responses and sequence
+   * lengths by decreasing length.  Points of the same length keep their
+   * order.
+   */
+  static void SortSequences(arma::cube& predictors,
+                            arma::cube& responses,
+                            arma::urowvec& lengths);
+
+  /**
+   * Reorder the points (columns) of the given predictors, responses and
+   * sequence lengths by the given order.
+   */
+  static void PermutePoints(arma::cube& predictors,
+                            arma::cube& responses,
+                            arma::urowvec& lengths,
+                            const arma::uvec& order);
+
+  /**
+   * If the points are shuffled, gather the points at the given positions of
+   * the current order (and their sequence lengths, into gatheredLengths), and
+   * return true.  Otherwise, return false; the batch is then a contiguous
+   * part of the data.
+   *
+   * @param begin Position of the first point of the batch.
+   * @param batchSize Number of points of the batch.
+   */
+  bool GatherBatch(const size_t begin, const size_t batchSize);
+
+  /**
+   * Wait for the batch being prefetched and stop prefetching.
+   */
+  void StopPrefetch();
 
   /**
    * The Backward algorithm (part of the Forward-Backward algorithm). Computes
@@ -317,6 +500,19 @@ class RNN
    */
   void ResetGradients(arma::mat& gradient);
 
+  /**
+   * Set whether the Lookup layers of the network only keep the nonzero columns
+   * of their gradient, and clear the columns they kept.
+   */
+  void SetSparseLookupGradients(const bool sparse);
+
+  /**
+   * Build the sparse gradient from denseGradient, except for the weights of
+   * the Lookup layers, which are built from their touched columns; their part
+   * of denseGradient is not used.
+   */
+  void BuildSparseGradient(arma::sp_mat& gradient) const;
+
   //! Number of steps to backpropagate through time (BPTT).
   size_t rho;
 
@@ -342,6 +538,9 @@ class RNN
     //! Only predict the last element of the input sequence.
   bool single;
 
+  //! Whether all time steps of the data are used, with truncated BPTT.
+  bool truncatedBPTT;
+
   //! Locally-stored model modules.
   std::vector<LayerTypes<CustomLayers...> > network;
 
@@ -351,9 +550,32 @@ class RNN
   //! The matrix of responses to the input data points.
   arma::cube responses;
 
+  //! The number of time steps of each sequence of the training data.
+  arma::urowvec sequenceLengths;
+
+  //! The order in which the points are visited, once they are shuffled (if
+  //! empty, the points are visited in the order they are stored).
+  arma::uvec ordering;
+
+  //! The sequence lengths of the points in the shuffled order.
+  arma::urowvec orderedLengths;
+
+  //! The sequence lengths of the points of the current gathered batch.
+  arma::urowvec gatheredLengths;
+
+  //! Whether to gather the next shuffled batch in the background.
+  bool prefetch;
+
+  //! The prefetcher of shuffled batches.
+  BatchPrefetcher<arma::cube, arma::cube> prefetcher;
+
   //! Matrix of (trained) parameters.
   arma::mat parameter;
 
+  //! If the network was loaded with LoadFlat(), this holds the mapped file
+  //! that the parameters are an alias of.
+  std::shared_ptr<util::MappedFile> mappedFile;
+
   //! The number of separable functions (the number of predictor points).
   size_t numFunctions;
 
@@ -384,6 +606,12 @@ class RNN
   //! The current gradient for the gradient pass.
   arma::mat currentGradient;
 
+  //! The dense gradient that sparse gradients are built from.
+  arma::mat denseGradient;
+
+  //! Records the calls of the layers when it is enabled.
+  LayerProfiler profiler;
+
   // The BRN class should have access to internal members.
   template<
     typename OutputLayerType1,
@@ -409,7 +637,7 @@ template<typename OutputLayerType,
 struct version<
     mlpack::ann::RNN<OutputLayerType, InitializationRuleType, CustomLayer...>>
 {
-  BOOST_STATIC_CONSTANT(int, value = 1);
+  BOOST_STATIC_CONSTANT(int, value = 2);
 };
 
 } // namespace serialization
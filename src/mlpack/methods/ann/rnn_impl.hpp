@@ -20,11 +20,14 @@
 #include "visitor/forward_visitor.hpp"
 #include "visitor/backward_visitor.hpp"
 #include "visitor/reset_cell_visitor.hpp"
+#include "visitor/carry_state_visitor.hpp"
 #include "visitor/deterministic_set_visitor.hpp"
 #include "visitor/gradient_set_visitor.hpp"
 #include "visitor/gradient_visitor.hpp"
 #include "visitor/weight_set_visitor.hpp"
 
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 #include <boost/serialization/variant.hpp>
 
 namespace mlpack {
@@ -45,6 +48,8 @@ RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::RNN(
     targetSize(0),
     reset(false),
     single(single),
+    truncatedBPTT(false),
+    prefetch(false),
     numFunctions(0),
     deterministic(true)
 {
@@ -69,11 +74,21 @@ double RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Train(
     arma::cube responses,
     OptimizerType& optimizer)
 {
+  CheckSequenceLength(predictors.n_slices);
+  CheckSequenceLengths(sequenceLengths, predictors.n_cols,
+      predictors.n_slices);
   numFunctions = responses.n_cols;
 
+  StopPrefetch();
+  ordering.reset();
   this->predictors = std::move(predictors);
   this->responses = std::move(responses);
 
+  if (!sequenceLengths.is_empty())
+  {
+    SortSequences(this->predictors, this->responses, sequenceLengths);
+  }
+
   this->deterministic = true;
   ResetDeterministic();
 
@@ -82,9 +97,11 @@ double RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Train(
     ResetParameters();
   }
 
-  // Train the model.
+  // Train the model, gathering shuffled batches in the background.
   Timer::Start("rnn_optimization");
+  prefetch = true;
   const double out = optimizer.Optimize(*this, parameter);
+  StopPrefetch();
   Timer::Stop("rnn_optimization");
 
   Log::Info << "RNN::RNN(): final objective of trained model is " << out
@@ -95,12 +112,135 @@ double RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Train(
 template<typename OutputLayerType, typename InitializationRuleType,
          typename... CustomLayers>
 void RNN<OutputLayerType, InitializationRuleType,
-         CustomLayers...>::ResetCells()
+         CustomLayers...>::ResetCells(const size_t steps)
+{
+  for (size_t i = 1; i < network.size(); ++i)
+  {
+    boost::apply_visitor(ResetCellVisitor(steps), network[i]);
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void RNN<OutputLayerType, InitializationRuleType,
+         CustomLayers...>::CarryStates()
 {
   for (size_t i = 1; i < network.size(); ++i)
   {
-    boost::apply_visitor(ResetCellVisitor(rho), network[i]);
+    boost::apply_visitor(CarryStateVisitor(), network[i]);
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::
+CheckSequenceLength(const size_t steps) const
+{
+  if (truncatedBPTT && (steps == 0 || steps % rho != 0))
+  {
+    std::ostringstream oss;
+    oss << "RNN: with truncated BPTT, the number of time steps (" << steps
+        << ") must be a positive multiple of rho (" << rho << ")";
+    throw std::invalid_argument(oss.str());
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::
+CheckSequenceLengths(const arma::urowvec& lengths,
+                     const size_t points,
+                     const size_t steps) const
+{
+  if (lengths.is_empty())
+    return;
+
+  std::ostringstream oss;
+  if (truncatedBPTT)
+  {
+    oss << "RNN: sequence lengths can not be used with truncated BPTT";
+  }
+  else if (lengths.n_elem != points)
+  {
+    oss << "RNN: the number of sequence lengths (" << lengths.n_elem
+        << ") must be the number of points (" << points << ")";
+  }
+  else if (lengths.min() == 0 || lengths.max() > steps)
+  {
+    oss << "RNN: the sequence lengths must be between 1 and the number of "
+        << "time steps (" << steps << ")";
+  }
+  else
+  {
+    return;
   }
+
+  throw std::invalid_argument(oss.str());
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+size_t RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::
+BatchSteps(const arma::urowvec& lengths,
+           const size_t begin,
+           const size_t batchSize,
+           const size_t steps)
+{
+  if (lengths.is_empty())
+    return steps;
+
+  return std::min(steps, size_t(arma::max(lengths.subvec(begin,
+      begin + batchSize - 1))));
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+size_t RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::
+ActivePoints(const arma::urowvec& lengths,
+             const size_t begin,
+             const size_t batchSize,
+             const size_t steps,
+             const size_t step)
+{
+  if (step >= steps)
+    return 0;
+
+  if (lengths.is_empty())
+    return batchSize;
+
+  size_t active = 0;
+  while (active < batchSize && lengths[begin + active] > step)
+    ++active;
+
+  return active;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::
+SortSequences(arma::cube& predictors,
+              arma::cube& responses,
+              arma::urowvec& lengths)
+{
+  const arma::uvec order = arma::stable_sort_index(lengths, "descend");
+  PermutePoints(predictors, responses, lengths, order);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::
+PermutePoints(arma::cube& predictors,
+              arma::cube& responses,
+              arma::urowvec& lengths,
+              const arma::uvec& order)
+{
+  for (size_t i = 0; i < predictors.n_slices; ++i)
+    predictors.slice(i) = arma::mat(predictors.slice(i).cols(order));
+
+  for (size_t i = 0; i < responses.n_slices; ++i)
+    responses.slice(i) = arma::mat(responses.slice(i).cols(order));
+
+  lengths = arma::urowvec(lengths.cols(order));
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
@@ -110,11 +250,21 @@ double RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Train(
     arma::cube predictors,
     arma::cube responses)
 {
+  CheckSequenceLength(predictors.n_slices);
+  CheckSequenceLengths(sequenceLengths, predictors.n_cols,
+      predictors.n_slices);
   numFunctions = responses.n_cols;
 
+  StopPrefetch();
+  ordering.reset();
   this->predictors = std::move(predictors);
   this->responses = std::move(responses);
 
+  if (!sequenceLengths.is_empty())
+  {
+    SortSequences(this->predictors, this->responses, sequenceLengths);
+  }
+
   this->deterministic = true;
   ResetDeterministic();
 
@@ -125,9 +275,11 @@ double RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Train(
 
   OptimizerType optimizer;
 
-  // Train the model.
+  // Train the model, gathering shuffled batches in the background.
   Timer::Start("rnn_optimization");
+  prefetch = true;
   const double out = optimizer.Optimize(*this, parameter);
+  StopPrefetch();
   Timer::Stop("rnn_optimization");
 
   Log::Info << "RNN::RNN(): final objective of trained model is " << out
@@ -140,7 +292,26 @@ template<typename OutputLayerType, typename InitializationRuleType,
 void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Predict(
     arma::cube predictors, arma::cube& results, const size_t batchSize)
 {
-  ResetCells();
+  Predict(std::move(predictors), arma::urowvec(), results, batchSize);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Predict(
+    arma::cube predictors,
+    const arma::urowvec& sequenceLengths,
+    arma::cube& results,
+    const size_t batchSize)
+{
+  CheckSequenceLength(predictors.n_slices);
+  CheckSequenceLengths(sequenceLengths, predictors.n_cols,
+      predictors.n_slices);
+
+  const size_t steps = truncatedBPTT ? predictors.n_slices : rho;
+  const size_t effectiveBatchSize = std::min(batchSize,
+      size_t(predictors.n_cols));
+  ResetCells(std::min(rho, BatchSteps(sequenceLengths, 0, effectiveBatchSize,
+      steps)));
 
   if (parameter.is_empty())
   {
@@ -153,16 +324,13 @@ void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Predict(
     ResetDeterministic();
   }
 
-  const size_t effectiveBatchSize = std::min(batchSize,
-      size_t(predictors.n_cols));
-
   Forward(std::move(arma::mat(predictors.slice(0).colptr(0),
       predictors.n_rows, effectiveBatchSize, false, true)));
   arma::mat resultsTemp = boost::apply_visitor(outputParameterVisitor,
       network.back());
 
   outputSize = resultsTemp.n_rows;
-  results = arma::zeros<arma::cube>(outputSize, predictors.n_cols, rho);
+  results = arma::zeros<arma::cube>(outputSize, predictors.n_cols, steps);
   results.slice(0).submat(0, 0, results.n_rows - 1,
       effectiveBatchSize - 1) = resultsTemp;
 
@@ -171,8 +339,17 @@ void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Predict(
   {
     const size_t effectiveBatchSize = std::min(batchSize,
         size_t(predictors.n_cols - begin));
-    for (size_t seqNum = !begin; seqNum < rho; ++seqNum)
+    const size_t batchSteps = BatchSteps(sequenceLengths, begin,
+        effectiveBatchSize, steps);
+    // Every batch starts a new sequence.
+    if (begin > 0 && (truncatedBPTT || !sequenceLengths.is_empty()))
+      ResetCells(std::min(rho, batchSteps));
+
+    for (size_t seqNum = !begin; seqNum < batchSteps; ++seqNum)
     {
+      if (seqNum % rho == 0 && seqNum > 0)
+        CarryStates();
+
       Forward(std::move(arma::mat(predictors.slice(seqNum).colptr(begin),
           predictors.n_rows, effectiveBatchSize, false, true)));
 
@@ -180,6 +357,14 @@ void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Predict(
           effectiveBatchSize - 1) = boost::apply_visitor(outputParameterVisitor,
           network.back());
     }
+
+    // The responses past the end of each sequence are zero.
+    for (size_t i = begin; i < begin + effectiveBatchSize &&
+        !sequenceLengths.is_empty(); ++i)
+    {
+      for (size_t seqNum = sequenceLengths[i]; seqNum < batchSteps; ++seqNum)
+        results.slice(seqNum).col(i).zeros();
+    }
   }
 }
 
@@ -212,26 +397,45 @@ double RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Evaluate(
     targetSize = responses.n_rows;
   }
 
-  ResetCells();
+  // If the points are shuffled, gather the points of the batch, which then
+  // begins at the first column of the gathered data.
+  const bool gathered = GatherBatch(begin, batchSize);
+  arma::cube& batchPredictors = gathered ? prefetcher.Predictors() :
+      predictors;
+  arma::cube& batchResponses = gathered ? prefetcher.Responses() : responses;
+  const arma::urowvec& batchLengths = gathered ? gatheredLengths :
+      sequenceLengths;
+  const size_t batchBegin = gathered ? 0 : begin;
 
   double performance = 0;
   size_t responseSeq = 0;
+  const size_t steps = BatchSteps(batchLengths, batchBegin, batchSize,
+      truncatedBPTT ? batchPredictors.n_slices : rho);
+  ResetCells(std::min(rho, steps));
 
-  for (size_t seqNum = 0; seqNum < rho; ++seqNum)
+  for (size_t seqNum = 0; seqNum < steps; ++seqNum)
   {
+    if (seqNum % rho == 0 && seqNum > 0)
+      CarryStates();
+
     // Wrap a matrix around our data to avoid a copy.
-    arma::mat stepData(predictors.slice(seqNum).colptr(begin),
-        predictors.n_rows, batchSize, false, true);
+    arma::mat stepData(batchPredictors.slice(seqNum).colptr(batchBegin),
+        batchPredictors.n_rows, batchSize, false, true);
     Forward(std::move(stepData));
     if (!single)
     {
       responseSeq = seqNum;
     }
 
-    performance += outputLayer.Forward(std::move(boost::apply_visitor(
-        outputParameterVisitor, network.back())),
-        std::move(arma::mat(responses.slice(responseSeq).colptr(begin),
-            responses.n_rows, batchSize, false, true)));
+    // Only the sequences still running add to the objective.
+    const size_t active = ActivePoints(batchLengths, batchBegin, batchSize,
+        steps, seqNum);
+    arma::mat& output = boost::apply_visitor(outputParameterVisitor,
+        network.back());
+    performance += outputLayer.Forward(std::move(arma::mat(output.memptr(),
+        output.n_rows, active, false, true)), std::move(arma::mat(
+        batchResponses.slice(responseSeq).colptr(batchBegin),
+        batchResponses.n_rows, active, false, true)));
   }
 
   if (outputSize == 0)
@@ -293,86 +497,215 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
     targetSize = responses.n_rows;
   }
 
-  ResetCells();
+  // If the points are shuffled, gather the points of the batch, which then
+  // begins at the first column of the gathered data.
+  const bool gathered = GatherBatch(begin, batchSize);
+  arma::cube& batchPredictors = gathered ? prefetcher.Predictors() :
+      predictors;
+  arma::cube& batchResponses = gathered ? prefetcher.Responses() : responses;
+  const arma::urowvec& batchLengths = gathered ? gatheredLengths :
+      sequenceLengths;
+  const size_t batchBegin = gathered ? 0 : begin;
 
   double performance = 0;
   size_t responseSeq = 0;
-
-  for (size_t seqNum = 0; seqNum < rho; ++seqNum)
+  const size_t steps = BatchSteps(batchLengths, batchBegin, batchSize,
+      truncatedBPTT ? batchPredictors.n_slices : rho);
+  const size_t window = std::min(rho, steps);
+  ResetCells(window);
+  arma::mat activeError;
+
+  // The sequence is processed in windows of rho steps; without truncated BPTT
+  // there is only one.  The gradient of each window is computed from its own
+  // steps, and the next window starts from the state it ended with.
+  for (size_t windowBegin = 0; windowBegin < steps; windowBegin += window)
   {
-    // Wrap a matrix around our data to avoid a copy.
-    arma::mat stepData(predictors.slice(seqNum).colptr(begin),
-        predictors.n_rows, batchSize, false, true);
-    Forward(std::move(stepData));
-    if (!single)
+    if (windowBegin > 0)
+      CarryStates();
+
+    // The output parameters of each step are stored in moduleOutputParameter,
+    // which is used as a stack; the stored matrices are kept between calls,
+    // so for a fixed batch size they are reused instead of reallocated.
+    size_t outputPosition = 0;
+
+    for (size_t seqNum = windowBegin; seqNum < windowBegin + window; ++seqNum)
     {
-      responseSeq = seqNum;
+      // Wrap a matrix around our data to avoid a copy.
+      arma::mat stepData(batchPredictors.slice(seqNum).colptr(batchBegin),
+          batchPredictors.n_rows, batchSize, false, true);
+      Forward(std::move(stepData));
+      if (!single)
+      {
+        responseSeq = seqNum;
+      }
+
+      for (size_t l = 0; l < network.size(); ++l)
+      {
+        boost::apply_visitor(SaveOutputParameterVisitor(
+            std::move(moduleOutputParameter), outputPosition), network[l]);
+      }
+
+      // Only the sequences still running add to the objective.
+      const size_t active = ActivePoints(batchLengths, batchBegin, batchSize,
+          steps, seqNum);
+      arma::mat& output = boost::apply_visitor(outputParameterVisitor,
+          network.back());
+      performance += outputLayer.Forward(std::move(arma::mat(output.memptr(),
+          output.n_rows, active, false, true)), std::move(arma::mat(
+          batchResponses.slice(responseSeq).colptr(batchBegin),
+          batchResponses.n_rows, active, false, true)));
     }
 
-    for (size_t l = 0; l < network.size(); ++l)
+    if (outputSize == 0)
     {
-      boost::apply_visitor(SaveOutputParameterVisitor(
-          std::move(moduleOutputParameter)), network[l]);
+      outputSize = boost::apply_visitor(outputParameterVisitor,
+          network.back()).n_elem / batchSize;
     }
 
-    performance += outputLayer.Forward(std::move(boost::apply_visitor(
-        outputParameterVisitor, network.back())),
-        std::move(arma::mat(responses.slice(responseSeq).colptr(begin),
-            responses.n_rows, batchSize, false, true)));
-  }
+    // Initialize current/working gradient.
+    if (currentGradient.is_empty())
+    {
+      currentGradient = arma::zeros<arma::mat>(parameter.n_rows,
+          parameter.n_cols);
+    }
 
-  if (outputSize == 0)
-  {
-    outputSize = boost::apply_visitor(outputParameterVisitor,
-        network.back()).n_elem / batchSize;
-  }
+    ResetGradients(currentGradient);
 
-  // Initialize current/working gradient.
-  if (currentGradient.is_empty())
-  {
-    currentGradient = arma::zeros<arma::mat>(parameter.n_rows,
-        parameter.n_cols);
+    for (size_t i = 0; i < window; ++i)
+    {
+      const size_t seqNum = windowBegin + window - i - 1;
+      currentGradient.zeros();
+
+      for (size_t l = 0; l < network.size(); ++l)
+      {
+        boost::apply_visitor(LoadOutputParameterVisitor(
+            std::move(moduleOutputParameter), outputPosition),
+            network[network.size() - 1 - l]);
+      }
+
+      // The points [first, last) get an error: the sequences still running,
+      // or with a single response only the sequences ending at this step.
+      arma::mat& output = boost::apply_visitor(outputParameterVisitor,
+          network.back());
+      const size_t last = ActivePoints(batchLengths, batchBegin, batchSize,
+          steps, seqNum);
+      const size_t first = single ? ActivePoints(batchLengths, batchBegin,
+          batchSize, steps, seqNum + 1) : 0;
+      if (first == 0 && last == batchSize)
+      {
+        outputLayer.Backward(std::move(output), std::move(arma::mat(
+            batchResponses.slice(single ? 0 : seqNum).colptr(batchBegin),
+            batchResponses.n_rows, batchSize, false, true)),
+            std::move(error));
+      }
+      else
+      {
+        error.zeros(output.n_rows, output.n_cols);
+        if (first < last)
+        {
+          outputLayer.Backward(std::move(arma::mat(output.colptr(first),
+              output.n_rows, last - first, false, true)), std::move(arma::mat(
+              batchResponses.slice(single ? 0 : seqNum).colptr(
+              batchBegin + first),
+              batchResponses.n_rows, last - first, false, true)),
+              std::move(activeError));
+          error.cols(first, last - 1) = activeError;
+        }
+      }
+
+      Backward();
+      Gradient(std::move(
+          arma::mat(batchPredictors.slice(seqNum).colptr(batchBegin),
+          batchPredictors.n_rows, batchSize, false, true)));
+      gradient += currentGradient;
+    }
   }
 
-  ResetGradients(currentGradient);
+  return performance;
+}
 
-  for (size_t seqNum = 0; seqNum < rho; ++seqNum)
-  {
-    currentGradient.zeros();
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+double RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::
+EvaluateWithGradient(const arma::mat& parameters,
+                     const size_t begin,
+                     arma::sp_mat& gradient,
+                     const size_t batchSize)
+{
+  // The Lookup layers keep their gradient as the columns of the tokens in the
+  // batch only, and leave their part of the dense gradient alone.
+  SetSparseLookupGradients(true);
+  const double res = EvaluateWithGradient(parameters, begin, denseGradient,
+      batchSize);
+  BuildSparseGradient(gradient);
+  SetSparseLookupGradients(false);
+  return res;
+}
 
-    for (size_t l = 0; l < network.size(); ++l)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void RNN<OutputLayerType, InitializationRuleType,
+         CustomLayers...>::SetSparseLookupGradients(const bool sparse)
+{
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    Lookup<>** lookup = boost::get<Lookup<>*>(&network[i]);
+    if (lookup)
     {
-      boost::apply_visitor(LoadOutputParameterVisitor(
-          std::move(moduleOutputParameter)), network[network.size() - 1 - l]);
+      (*lookup)->SparseGradient() = sparse;
+      (*lookup)->ClearTouched();
     }
+  }
+}
 
-    if (single && seqNum > 0)
-    {
-      error.zeros();
-    }
-    else if (single && seqNum == 0)
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void RNN<OutputLayerType, InitializationRuleType,
+         CustomLayers...>::BuildSparseGradient(arma::sp_mat& gradient) const
+{
+  std::vector<arma::uword> rows;
+  std::vector<double> values;
+  size_t offset = 0;
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    const size_t weights = boost::apply_visitor(weightSizeVisitor,
+        network[i]);
+    const Lookup<>* const* lookup = boost::get<Lookup<>*>(&network[i]);
+    if (!lookup)
     {
-      outputLayer.Backward(std::move(boost::apply_visitor(
-          outputParameterVisitor, network.back())),
-          std::move(arma::mat(responses.slice(0).colptr(begin),
-          responses.n_rows, batchSize, false, true)), std::move(error));
+      for (size_t j = offset; j < offset + weights; ++j)
+      {
+        if (denseGradient[j] != 0)
+        {
+          rows.push_back(j);
+          values.push_back(denseGradient[j]);
+        }
+      }
     }
     else
     {
-      outputLayer.Backward(std::move(boost::apply_visitor(
-          outputParameterVisitor, network.back())),
-          std::move(arma::mat(responses.slice(rho - seqNum - 1).colptr(begin),
-          responses.n_rows, batchSize, false, true)), std::move(error));
+      // The columns of all the time steps have been summed by the layer.
+      const arma::uvec& columns = (*lookup)->TouchedColumns();
+      const arma::mat& columnGradient = (*lookup)->TouchedGradient();
+      for (size_t c = 0; c < columns.n_elem; ++c)
+      {
+        for (size_t k = 0; k < columnGradient.n_rows; ++k)
+        {
+          rows.push_back(offset + columns[c] * columnGradient.n_rows + k);
+          values.push_back(columnGradient(k, c));
+        }
+      }
     }
 
-    Backward();
-    Gradient(std::move(
-        arma::mat(predictors.slice(rho - seqNum - 1).colptr(begin),
-        predictors.n_rows, batchSize, false, true)));
-    gradient += currentGradient;
+    offset += weights;
   }
 
-  return performance;
+  arma::umat locations(2, rows.size(), arma::fill::zeros);
+  for (size_t j = 0; j < rows.size(); ++j)
+    locations(0, j) = rows[j];
+
+  gradient = arma::sp_mat(locations, arma::vec(values), denseGradient.n_rows,
+      denseGradient.n_cols);
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
@@ -390,11 +723,56 @@ template<typename OutputLayerType, typename InitializationRuleType,
          typename... CustomLayers>
 void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Shuffle()
 {
-  arma::cube newPredictors, newResponses;
-  math::ShuffleData(predictors, responses, newPredictors, newResponses);
+  // Only the order of the points is shuffled, so the data is never moved.
+  prefetcher.Reset();
+  ordering = arma::shuffle(arma::linspace<arma::uvec>(0, responses.n_cols - 1,
+      responses.n_cols));
 
-  predictors = std::move(newPredictors);
-  responses = std::move(newResponses);
+  if (!sequenceLengths.is_empty())
+  {
+    // Sort the shuffled points by length again, so only points of the same
+    // length change their order.
+    const arma::urowvec shuffledLengths = sequenceLengths.cols(ordering);
+    ordering = arma::uvec(ordering.elem(arma::stable_sort_index(
+        shuffledLengths, "descend")));
+    orderedLengths = sequenceLengths.cols(ordering);
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+bool RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::
+GatherBatch(const size_t begin, const size_t batchSize)
+{
+  // The order is dropped if the data was replaced.
+  if (!ordering.is_empty() && (ordering.n_elem != responses.n_cols ||
+      ordering.n_elem != predictors.n_cols || (!sequenceLengths.is_empty() &&
+      orderedLengths.n_elem != ordering.n_elem)))
+  {
+    prefetcher.Reset();
+    ordering.reset();
+  }
+
+  if (ordering.is_empty())
+    return false;
+
+  prefetcher.Next(predictors, responses, ordering, begin, batchSize,
+      prefetch);
+  if (!sequenceLengths.is_empty())
+    gatheredLengths = orderedLengths.subvec(begin, begin + batchSize - 1);
+  else
+    gatheredLengths.reset();
+
+  return true;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void RNN<OutputLayerType, InitializationRuleType,
+         CustomLayers...>::StopPrefetch()
+{
+  prefetch = false;
+  prefetcher.Reset();
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
@@ -417,7 +795,7 @@ template<typename OutputLayerType, typename InitializationRuleType,
 void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Reset()
 {
   ResetParameters();
-  ResetCells();
+  ResetCells(rho);
   currentGradient.zeros();
   ResetGradients(currentGradient);
 }
@@ -451,13 +829,13 @@ template<typename OutputLayerType, typename InitializationRuleType,
 void RNN<OutputLayerType, InitializationRuleType,
          CustomLayers...>::Forward(arma::mat&& input)
 {
-  boost::apply_visitor(ForwardVisitor(std::move(input), std::move(
-      boost::apply_visitor(outputParameterVisitor, network.front()))),
-      network.front());
+  profiler.Apply(LayerProfiler::FORWARD_PASS, 0, ForwardVisitor(
+      std::move(input), std::move(boost::apply_visitor(outputParameterVisitor,
+      network.front()))), network.front());
 
   for (size_t i = 1; i < network.size(); ++i)
   {
-    boost::apply_visitor(ForwardVisitor(
+    profiler.Apply(LayerProfiler::FORWARD_PASS, i, ForwardVisitor(
         std::move(boost::apply_visitor(outputParameterVisitor, network[i - 1])),
         std::move(boost::apply_visitor(outputParameterVisitor, network[i]))),
         network[i]);
@@ -468,15 +846,15 @@ template<typename OutputLayerType, typename InitializationRuleType,
          typename... CustomLayers>
 void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Backward()
 {
-  boost::apply_visitor(BackwardVisitor(
-        std::move(boost::apply_visitor(outputParameterVisitor, network.back())),
-        std::move(error), std::move(boost::apply_visitor(deltaVisitor,
-        network.back()))), network.back());
+  profiler.Apply(LayerProfiler::BACKWARD_PASS, network.size() - 1,
+      BackwardVisitor(std::move(boost::apply_visitor(outputParameterVisitor,
+      network.back())), std::move(error), std::move(boost::apply_visitor(
+      deltaVisitor, network.back()))), network.back());
 
   for (size_t i = 2; i < network.size(); ++i)
   {
-    boost::apply_visitor(BackwardVisitor(
-        std::move(boost::apply_visitor(outputParameterVisitor,
+    profiler.Apply(LayerProfiler::BACKWARD_PASS, network.size() - i,
+        BackwardVisitor(std::move(boost::apply_visitor(outputParameterVisitor,
         network[network.size() - i])), std::move(boost::apply_visitor(
         deltaVisitor, network[network.size() - i + 1])), std::move(
         boost::apply_visitor(deltaVisitor, network[network.size() - i]))),
@@ -490,12 +868,13 @@ template<typename InputType>
 void RNN<OutputLayerType, InitializationRuleType,
          CustomLayers...>::Gradient(InputType&& input)
 {
-  boost::apply_visitor(GradientVisitor(std::move(input), std::move(
-      boost::apply_visitor(deltaVisitor, network[1]))), network.front());
+  profiler.Apply(LayerProfiler::GRADIENT_PASS, 0, GradientVisitor(
+      std::move(input), std::move(boost::apply_visitor(deltaVisitor,
+      network[1]))), network.front());
 
   for (size_t i = 1; i < network.size() - 1; ++i)
   {
-    boost::apply_visitor(GradientVisitor(
+    profiler.Apply(LayerProfiler::GRADIENT_PASS, i, GradientVisitor(
         std::move(boost::apply_visitor(outputParameterVisitor, network[i - 1])),
         std::move(boost::apply_visitor(deltaVisitor, network[i + 1]))),
         network[i]);
@@ -521,6 +900,16 @@ void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::serialize(
     ar & BOOST_SERIALIZATION_NVP(reset);
   }
 
+  // Truncated BPTT was added in version 2.
+  if (version > 1)
+  {
+    ar & BOOST_SERIALIZATION_NVP(truncatedBPTT);
+  }
+  else if (Archive::is_loading::value)
+  {
+    truncatedBPTT = false;
+  }
+
   if (Archive::is_loading::value)
   {
     std::for_each(network.begin(), network.end(),
@@ -552,6 +941,97 @@ void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::serialize(
   }
 }
 
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::SaveFlat(
+    const std::string& filename) const
+{
+  if (parameter.is_empty())
+    throw std::invalid_argument("RNN::SaveFlat(): the parameters of the "
+        "network have not been initialized");
+
+  // The layer graph holds everything serialize() does, except the parameters.
+  std::ostringstream graph;
+  {
+    boost::archive::binary_oarchive ar(graph);
+    ar << BOOST_SERIALIZATION_NVP(rho);
+    ar << BOOST_SERIALIZATION_NVP(single);
+    ar << BOOST_SERIALIZATION_NVP(inputSize);
+    ar << BOOST_SERIALIZATION_NVP(outputSize);
+    ar << BOOST_SERIALIZATION_NVP(targetSize);
+    ar << BOOST_SERIALIZATION_NVP(reset);
+    ar << BOOST_SERIALIZATION_NVP(truncatedBPTT);
+    ar << BOOST_SERIALIZATION_NVP(network);
+  }
+
+  WeightFileIO::Save(filename, graph.str(), parameter);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::LoadFlat(
+    const std::string& filename)
+{
+  // Map the new file and build the layers before releasing the old ones, so
+  // that we are left unchanged if the file is invalid.
+  std::shared_ptr<util::MappedFile> newFile(new util::MappedFile(filename));
+  arma::mat newParameter;
+  std::istringstream graph(WeightFileIO::Load(*newFile, newParameter));
+
+  size_t newRho, newInputSize, newOutputSize, newTargetSize;
+  bool newSingle, newReset, newTruncatedBPTT;
+  std::vector<LayerTypes<CustomLayers...> > newNetwork;
+  {
+    boost::archive::binary_iarchive ar(graph);
+    ar >> BOOST_SERIALIZATION_NVP(newRho);
+    ar >> BOOST_SERIALIZATION_NVP(newSingle);
+    ar >> BOOST_SERIALIZATION_NVP(newInputSize);
+    ar >> BOOST_SERIALIZATION_NVP(newOutputSize);
+    ar >> BOOST_SERIALIZATION_NVP(newTargetSize);
+    ar >> BOOST_SERIALIZATION_NVP(newReset);
+    ar >> BOOST_SERIALIZATION_NVP(newTruncatedBPTT);
+    ar >> BOOST_SERIALIZATION_NVP(newNetwork);
+  }
+
+  size_t weights = 0;
+  for (LayerTypes<CustomLayers...>& layer : newNetwork)
+    weights += boost::apply_visitor(weightSizeVisitor, layer);
+
+  if (weights != newParameter.n_elem)
+  {
+    std::for_each(newNetwork.begin(), newNetwork.end(),
+        boost::apply_visitor(deleteVisitor));
+    throw std::runtime_error("RNN::LoadFlat(): the parameters in '" + filename +
+        "' do not match the layers of the network");
+  }
+
+  std::for_each(network.begin(), network.end(),
+      boost::apply_visitor(deleteVisitor));
+
+  network = std::move(newNetwork);
+  rho = newRho;
+  single = newSingle;
+  inputSize = newInputSize;
+  outputSize = newOutputSize;
+  targetSize = newTargetSize;
+  reset = newReset;
+  truncatedBPTT = newTruncatedBPTT;
+  parameter = std::move(newParameter);
+  mappedFile = std::move(newFile);
+
+  size_t offset = 0;
+  for (LayerTypes<CustomLayers...>& layer : network)
+  {
+    offset += boost::apply_visitor(WeightSetVisitor(std::move(parameter),
+        offset), layer);
+
+    boost::apply_visitor(resetVisitor, layer);
+  }
+
+  deterministic = true;
+  ResetDeterministic();
+}
+
 } // namespace ann
 } // namespace mlpack
 
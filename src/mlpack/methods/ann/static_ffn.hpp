@@ -0,0 +1,541 @@
+/**
+ * @file static_ffn.hpp
+ *
+ * Definition of the StaticFFN class, which implements feed forward neural
+ * networks whose layers are fixed at compile time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_STATIC_FFN_HPP
+#define MLPACK_METHODS_ANN_STATIC_FFN_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "ffn.hpp"
+
+#include <tuple>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * Implementation of a feed forward network whose layers are given as template
+ * parameters, for example
+ *
+ * @code
+ * StaticFFN<NegativeLogLikelihood<>, RandomInitialization,
+ *     Linear<>, ReLULayer<>, Linear<>, LogSoftMax<> >
+ *     model(Linear<>(10, 20), ReLULayer<>(), Linear<>(20, 3), LogSoftMax<>());
+ * @endcode
+ *
+ * The layers are stored by value, and every layer call of the forward,
+ * backward and gradient passes is resolved at compile time instead of through
+ * boost::apply_visitor(), so that the calls can be inlined.  This matters for
+ * small networks, where the dispatch takes a large part of the time.  Apart
+ * from Add(), the class has the same interface as FFN, and it is serialized
+ * in the same format, so a StaticFFN can be loaded into an FFN with the same
+ * layers and vice versa.  Each layer type must therefore be one of the types
+ * in LayerTypes<> to serialize the network.
+ *
+ * The matrix type of the network is the output type of the first layer, so
+ * a network can be trained in single precision by using layers with
+ * arma::fmat as their data types:
+ *
+ * @code
+ * StaticFFN<NegativeLogLikelihood<arma::fmat, arma::fmat>,
+ *     RandomInitialization, Linear<arma::fmat, arma::fmat>,
+ *     LogSoftMax<arma::fmat, arma::fmat> >
+ *     model(Linear<arma::fmat, arma::fmat>(10, 3),
+ *     LogSoftMax<arma::fmat, arma::fmat>());
+ * @endcode
+ *
+ * All the layers must then use the same matrix type.  Layers that hold other
+ * layers (like Sequential) and serialization are only supported for arma::mat.
+ *
+ * @tparam OutputLayerType The output layer type used to evaluate the network.
+ * @tparam InitializationRuleType Rule used to initialize the weight matrix.
+ * @tparam Layers The types of the layers of the network, in order.
+ */
+template<
+  typename OutputLayerType,
+  typename InitializationRuleType,
+  typename... Layers
+>
+class StaticFFN
+{
+  static_assert(sizeof...(Layers) > 0,
+      "StaticFFN must have at least one layer.");
+
+ public:
+  //! The number of layers of the network.
+  static const size_t NumLayers = sizeof...(Layers);
+
+  //! The type of the layer with the given index.
+  template<size_t I>
+  using LayerType = typename std::tuple_element<I, std::tuple<Layers...> >
+      ::type;
+
+  //! The matrix type of the data, parameters and gradients of the network.
+  typedef typename std::remove_reference<decltype(
+      std::declval<LayerType<0>&>().OutputParameter())>::type MatType;
+
+  /**
+   * Create the StaticFFN object with default-constructed layers.
+   */
+  StaticFFN();
+
+  /**
+   * Create the StaticFFN object with the given layers.
+   *
+   * @param layers The layers of the network, in order.
+   */
+  StaticFFN(Layers... layers);
+
+  /**
+   * Create the StaticFFN object with the given layers, output layer and
+   * initialization rule.
+   *
+   * @param outputLayer Output layer used to evaluate the network.
+   * @param initializeRule Instantiated InitializationRule object for
+   *        initializing the network parameter.
+   * @param layers The layers of the network, in order.
+   */
+  StaticFFN(OutputLayerType outputLayer,
+            InitializationRuleType initializeRule,
+            Layers... layers);
+
+  //! Copy constructor.
+  StaticFFN(const StaticFFN& other);
+
+  //! Move constructor.
+  StaticFFN(StaticFFN&& other);
+
+  //! Copy/move assignment operator.
+  StaticFFN& operator=(StaticFFN other);
+
+  /**
+   * Train the network on the given input data using the given optimizer.
+   *
+   * This will use the existing model parameters as a starting point for the
+   * optimization. If this is not what you want, then you should access the
+   * parameters vector directly with Parameters() and modify it as desired.
+   *
+   * @tparam OptimizerType Type of optimizer to use to train the model.
+   * @param predictors Input training variables.
+   * @param responses Outputs results from input training variables.
+   * @param optimizer Instantiated optimizer used to train the model.
+   * @return The final objective of the trained model (NaN or Inf on error).
+   */
+  template<typename OptimizerType>
+  double Train(MatType predictors,
+               MatType responses,
+               OptimizerType& optimizer);
+
+  /**
+   * Train the network on the given input data. By default, the RMSProp
+   * optimization algorithm is used, but others can be specified (such as
+   * ens::SGD).
+   *
+   * @tparam OptimizerType Type of optimizer to use to train the model.
+   * @param predictors Input training variables.
+   * @param responses Outputs results from input training variables.
+   * @return The final objective of the trained model (NaN or Inf on error).
+   */
+  template<typename OptimizerType = ens::RMSProp>
+  double Train(MatType predictors, MatType responses);
+
+  /**
+   * Predict the responses to a given set of predictors, batchSize columns at
+   * a time.  If results already has the right size, its memory is reused.
+   *
+   * @param predictors Input predictors.
+   * @param results Matrix to put output predictions of responses into.
+   * @param batchSize Number of points to predict at once.
+   */
+  void Predict(MatType predictors,
+               MatType& results,
+               const size_t batchSize = 256);
+
+  /**
+   * Evaluate the network with the given predictors and responses.
+   *
+   * @param predictors Input variables.
+   * @param responses Target outputs for input variables.
+   */
+  double Evaluate(MatType predictors, MatType responses);
+
+  /**
+   * Evaluate the network with the given parameters, one point at a time.
+   *
+   * @param parameters Matrix model parameters.
+   */
+  double Evaluate(const MatType& parameters);
+
+  /**
+   * Evaluate the network with the given parameters, but using only a number
+   * of data points.
+   *
+   * @param parameters Matrix model parameters.
+   * @param begin Index of the starting point to use for objective function
+   *        evaluation.
+   * @param batchSize Number of points to be passed at a time to use for
+   *        objective function evaluation.
+   * @param deterministic Whether or not to train or test the model. Note some
+   *        layer act differently in training or testing mode.
+   */
+  double Evaluate(const MatType& parameters,
+                  const size_t begin,
+                  const size_t batchSize,
+                  const bool deterministic);
+
+  /**
+   * Evaluate the network with the given parameters, but using only a number
+   * of data points.  This just calls the overload of Evaluate() with
+   * deterministic = true.
+   *
+   * @param parameters Matrix model parameters.
+   * @param begin Index of the starting point to use for objective function
+   *        evaluation.
+   * @param batchSize Number of points to be passed at a time to use for
+   *        objective function evaluation.
+   */
+  double Evaluate(const MatType& parameters,
+                  const size_t begin,
+                  const size_t batchSize);
+
+  /**
+   * Evaluate the network and its gradient with the given parameters, one
+   * point at a time.
+   *
+   * @param parameters Matrix model parameters.
+   * @param gradient Matrix to output gradient into.
+   */
+  template<typename GradType>
+  double EvaluateWithGradient(const MatType& parameters, GradType& gradient);
+
+  /**
+   * Evaluate the network and its gradient with the given parameters, but
+   * using only a number of data points.
+   *
+   * @param parameters Matrix model parameters.
+   * @param begin Index of the starting point to use for objective function
+   *        evaluation.
+   * @param gradient Matrix to output gradient into.
+   * @param batchSize Number of points to be passed at a time to use for
+   *        objective function evaluation.
+   */
+  template<typename GradType>
+  double EvaluateWithGradient(const MatType& parameters,
+                              const size_t begin,
+                              GradType& gradient,
+                              const size_t batchSize);
+
+  /**
+   * Evaluate the gradient of the network with the given parameters, and with
+   * respect to only a number of points in the dataset.
+   *
+   * @param parameters Matrix of the model parameters to be optimized.
+   * @param begin Index of the starting point to use for objective function
+   *        gradient evaluation.
+   * @param gradient Matrix to output gradient into.
+   * @param batchSize Number of points to be processed as a batch for objective
+   *        function gradient evaluation.
+   */
+  void Gradient(const MatType& parameters,
+                const size_t begin,
+                MatType& gradient,
+                const size_t batchSize);
+
+  /**
+   * Shuffle the order of function visitation. This may be called by the
+   * optimizer.
+   */
+  void Shuffle();
+
+  //! Get the layer with the given index.
+  template<size_t I>
+  const LayerType<I>& Layer() const { return std::get<I>(network); }
+  //! Modify the layer with the given index.
+  template<size_t I>
+  LayerType<I>& Layer() { return std::get<I>(network); }
+
+  //! Return the number of separable functions (the number of predictor points).
+  size_t NumFunctions() const { return numFunctions; }
+
+  //! Return the initial point for the optimization.
+  const MatType& Parameters() const { return parameter; }
+  //! Modify the initial point for the optimization.
+  MatType& Parameters() { return parameter; }
+
+  //! Get the matrix of responses to the input data points.
+  const MatType& Responses() const { return responses; }
+  //! Modify the matrix of responses to the input data points.
+  MatType& Responses() { return responses; }
+
+  //! Get the matrix of data points (predictors).
+  const MatType& Predictors() const { return predictors; }
+  //! Modify the matrix of data points (predictors).
+  MatType& Predictors() { return predictors; }
+
+  /**
+   * Reset the module infomration (weights/parameters).
+   */
+  void ResetParameters();
+
+  //! Serialize the model in the same format as FFN.
+  template<typename Archive>
+  void serialize(Archive& ar, const unsigned int version);
+
+  /**
+   * Perform the forward pass of the data in real batch mode.
+   *
+   * @param inputs The input data.
+   * @param results The predicted results.
+   */
+  void Forward(MatType inputs, MatType& results);
+
+  /**
+   * Perform the backward pass of the data in real batch mode, after a call to
+   * Forward().
+   *
+   * @param targets The training target.
+   * @param gradients Computed gradients.
+   * @return Training error of the current pass.
+   */
+  double Backward(MatType targets, MatType& gradients);
+
+ private:
+  // Helper functions.
+  /**
+   * Prepare the network for the given data.
+   *
+   * @param predictors Input data variables.
+   * @param responses Outputs results from input data variables.
+   */
+  void ResetData(MatType predictors, MatType responses);
+
+  /**
+   * Let the weights of the layers point into the parameter matrix.
+   */
+  void ResetWeights();
+
+  /**
+   * Reset the module status by setting the current deterministic parameter
+   * for all modules that implement the Deterministic function.
+   */
+  void ResetDeterministic();
+
+  /**
+   * Let the gradients of the layers point into the given gradient matrix.
+   */
+  void ResetGradients(MatType& gradient);
+
+  //! Return the number of weights of the layers starting with layer I.
+  template<size_t I>
+  typename std::enable_if<(I < sizeof...(Layers)), size_t>::type WeightSize();
+  template<size_t I>
+  typename std::enable_if<(I == sizeof...(Layers)), size_t>::type WeightSize();
+
+  //! Initialize the weights of the layers starting with layer I.
+  template<size_t I>
+  typename std::enable_if<(I < sizeof...(Layers)), void>::type
+  InitializeWeights(const size_t offset);
+  template<size_t I>
+  typename std::enable_if<(I == sizeof...(Layers)), void>::type
+  InitializeWeights(const size_t offset);
+
+  //! Set the weights of the layers starting with layer I.
+  template<size_t I>
+  typename std::enable_if<(I < sizeof...(Layers)), void>::type
+  SetWeights(const size_t offset);
+  template<size_t I>
+  typename std::enable_if<(I == sizeof...(Layers)), void>::type
+  SetWeights(const size_t offset);
+
+  //! Set the gradients of the layers starting with layer I.
+  template<size_t I>
+  typename std::enable_if<(I < sizeof...(Layers)), void>::type
+  SetGradients(MatType& gradient, const size_t offset);
+  template<size_t I>
+  typename std::enable_if<(I == sizeof...(Layers)), void>::type
+  SetGradients(MatType& gradient, const size_t offset);
+
+  //! Set the deterministic parameter of the layers starting with layer I.
+  template<size_t I>
+  typename std::enable_if<(I < sizeof...(Layers)), void>::type
+  SetDeterministic();
+  template<size_t I>
+  typename std::enable_if<(I == sizeof...(Layers)), void>::type
+  SetDeterministic();
+
+  //! Return the sum of the losses of the layers starting with layer I.
+  template<size_t I>
+  typename std::enable_if<(I < sizeof...(Layers)), double>::type Loss();
+  template<size_t I>
+  typename std::enable_if<(I == sizeof...(Layers)), double>::type Loss();
+
+  //! Let the weights of the given layer point into the given parameter
+  //! matrix at the given offset, and return the number of weights of the
+  //! layer.
+  template<typename T, typename P>
+  typename std::enable_if<
+      HasParametersCheck<T, P&(T::*)()>::value &&
+      !HasModelCheck<T>::value, size_t>::type
+  LayerWeights(T& layer, P& weights, const size_t offset);
+  template<typename T, typename P>
+  typename std::enable_if<
+      !HasParametersCheck<T, P&(T::*)()>::value &&
+      !HasModelCheck<T>::value, size_t>::type
+  LayerWeights(T& layer, P& weights, const size_t offset);
+  template<typename T, typename P>
+  typename std::enable_if<HasModelCheck<T>::value, size_t>::type
+  LayerWeights(T& layer, P& weights, const size_t offset);
+
+  //! Let the gradient of the given layer point into the given gradient matrix
+  //! at the given offset, and return the number of weights of the layer.
+  template<typename T, typename P>
+  typename std::enable_if<
+      HasGradientCheck<T, P&(T::*)()>::value &&
+      !HasModelCheck<T>::value, size_t>::type
+  LayerGradients(T& layer, P& gradient, const size_t offset);
+  template<typename T, typename P>
+  typename std::enable_if<
+      !HasGradientCheck<T, P&(T::*)()>::value &&
+      !HasModelCheck<T>::value, size_t>::type
+  LayerGradients(T& layer, P& gradient, const size_t offset);
+  template<typename T, typename P>
+  typename std::enable_if<HasModelCheck<T>::value, size_t>::type
+  LayerGradients(T& layer, P& gradient, const size_t offset);
+
+  //! Compute the gradient of the given layer, if it has one.
+  template<typename T, typename P>
+  typename std::enable_if<
+      HasGradientCheck<T, P&(T::*)()>::value, void>::type
+  LayerGradient(T& layer, P& input, P& error);
+  template<typename T, typename P>
+  typename std::enable_if<
+      !HasGradientCheck<T, P&(T::*)()>::value, void>::type
+  LayerGradient(T& layer, P& input, P& error);
+
+  //! Return the input of layer I; the first layer gets the given input.
+  template<size_t I>
+  typename std::enable_if<(I == 0), MatType&>::type
+  LayerInput(MatType& input);
+  template<size_t I>
+  typename std::enable_if<(I > 0), MatType&>::type
+  LayerInput(MatType& input);
+
+  //! Return the error of layer I; the last layer gets the output layer error.
+  template<size_t I>
+  typename std::enable_if<(I + 1 == sizeof...(Layers)), MatType&>::type
+  LayerError();
+  template<size_t I>
+  typename std::enable_if<(I + 1 < sizeof...(Layers)), MatType&>::type
+  LayerError();
+
+  //! Perform the forward pass of the layers starting with layer I.
+  template<size_t I>
+  typename std::enable_if<(I < sizeof...(Layers)), void>::type
+  Forward(MatType& input);
+  template<size_t I>
+  typename std::enable_if<(I == sizeof...(Layers)), void>::type
+  Forward(MatType& input);
+
+  //! Perform the backward pass of layer I and the layers before it, except
+  //! for the first layer.
+  template<size_t I>
+  typename std::enable_if<(I > 0), void>::type Backward();
+  template<size_t I>
+  typename std::enable_if<(I == 0), void>::type Backward();
+
+  //! Compute the gradients of the layers starting with layer I.
+  template<size_t I>
+  typename std::enable_if<(I < sizeof...(Layers)), void>::type
+  Gradient(MatType& input);
+  template<size_t I>
+  typename std::enable_if<(I == sizeof...(Layers)), void>::type
+  Gradient(MatType& input);
+
+  //! Add pointers to the layers starting with layer I to the given network,
+  //! or take the layers over from it.
+  template<size_t I>
+  typename std::enable_if<(I < sizeof...(Layers)), void>::type
+  SaveLayers(std::vector<LayerTypes<> >& layers);
+  template<size_t I>
+  typename std::enable_if<(I == sizeof...(Layers)), void>::type
+  SaveLayers(std::vector<LayerTypes<> >& layers);
+  template<size_t I>
+  typename std::enable_if<(I < sizeof...(Layers)), void>::type
+  LoadLayers(std::vector<LayerTypes<> >& layers);
+  template<size_t I>
+  typename std::enable_if<(I == sizeof...(Layers)), void>::type
+  LoadLayers(std::vector<LayerTypes<> >& layers);
+
+  //! Instantiated outputlayer used to evaluate the network.
+  OutputLayerType outputLayer;
+
+  //! Instantiated InitializationRule object for initializing the network
+  //! parameter.
+  InitializationRuleType initializeRule;
+
+  //! The input width.
+  size_t width;
+
+  //! The input height.
+  size_t height;
+
+  //! Indicator if we already trained the model.
+  bool reset;
+
+  //! Locally-stored model modules.
+  std::tuple<Layers...> network;
+
+  //! The matrix of data points (predictors).
+  MatType predictors;
+
+  //! The matrix of responses to the input data points.
+  MatType responses;
+
+  //! Matrix of (trained) parameters.
+  MatType parameter;
+
+  //! The number of separable functions (the number of predictor points).
+  size_t numFunctions;
+
+  //! The current error for the backward pass.
+  MatType error;
+
+  //! THe current input of the forward/backward pass.
+  MatType currentInput;
+
+  //! The current evaluation mode (training or testing).
+  bool deterministic;
+}; // class StaticFFN
+
+} // namespace ann
+} // namespace mlpack
+
+//! Set the serialization version of the StaticFFN class to the version of the
+//! FFN class, so that both are stored in the same format.
+namespace boost {
+namespace serialization {
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+struct version<
+    mlpack::ann::StaticFFN<OutputLayerType, InitializationRuleType, Layers...>>
+{
+  BOOST_STATIC_CONSTANT(int, value = 1);
+};
+
+} // namespace serialization
+} // namespace boost
+
+// Include implementation.
+#include "static_ffn_impl.hpp"
+
+#endif
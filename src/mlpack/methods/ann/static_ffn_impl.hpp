@@ -0,0 +1,933 @@
+/**
+ * @file static_ffn_impl.hpp
+ *
+ * Implementation of the StaticFFN class, which implements feed forward neural
+ * networks whose layers are fixed at compile time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_STATIC_FFN_IMPL_HPP
+#define MLPACK_METHODS_ANN_STATIC_FFN_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "static_ffn.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+// The layers are called directly, and the layer visitors that do not depend
+// on the matrix type are not applied through boost::apply_visitor(); their
+// templated call operators are called with the concrete layer type.  Either
+// way, every call is resolved at compile time.
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::StaticFFN() :
+    width(0),
+    height(0),
+    reset(false),
+    numFunctions(0),
+    deterministic(true)
+{
+  /* Nothing to do here */
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::StaticFFN(
+    Layers... layers) :
+    width(0),
+    height(0),
+    reset(false),
+    network(std::move(layers)...),
+    numFunctions(0),
+    deterministic(true)
+{
+  /* Nothing to do here */
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::StaticFFN(
+    OutputLayerType outputLayer,
+    InitializationRuleType initializeRule,
+    Layers... layers) :
+    outputLayer(std::move(outputLayer)),
+    initializeRule(std::move(initializeRule)),
+    width(0),
+    height(0),
+    reset(false),
+    network(std::move(layers)...),
+    numFunctions(0),
+    deterministic(true)
+{
+  /* Nothing to do here */
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::StaticFFN(
+    const StaticFFN& other) :
+    outputLayer(other.outputLayer),
+    initializeRule(other.initializeRule),
+    width(other.width),
+    height(other.height),
+    reset(other.reset),
+    network(other.network),
+    predictors(other.predictors),
+    responses(other.responses),
+    parameter(other.parameter),
+    numFunctions(other.numFunctions),
+    error(other.error),
+    currentInput(other.currentInput),
+    deterministic(other.deterministic)
+{
+  // The copied layers still refer to the parameters of the other network.
+  if (!parameter.is_empty())
+    ResetWeights();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::StaticFFN(
+    StaticFFN&& other) :
+    outputLayer(std::move(other.outputLayer)),
+    initializeRule(std::move(other.initializeRule)),
+    width(other.width),
+    height(other.height),
+    reset(other.reset),
+    network(std::move(other.network)),
+    predictors(std::move(other.predictors)),
+    responses(std::move(other.responses)),
+    parameter(std::move(other.parameter)),
+    numFunctions(other.numFunctions),
+    error(std::move(other.error)),
+    currentInput(std::move(other.currentInput)),
+    deterministic(other.deterministic)
+{
+  if (!parameter.is_empty())
+    ResetWeights();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>&
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::operator=(
+    StaticFFN other)
+{
+  outputLayer = std::move(other.outputLayer);
+  initializeRule = std::move(other.initializeRule);
+  width = other.width;
+  height = other.height;
+  reset = other.reset;
+  network = std::move(other.network);
+  predictors = std::move(other.predictors);
+  responses = std::move(other.responses);
+  parameter = std::move(other.parameter);
+  numFunctions = other.numFunctions;
+  error = std::move(other.error);
+  currentInput = std::move(other.currentInput);
+  deterministic = other.deterministic;
+
+  if (!parameter.is_empty())
+    ResetWeights();
+
+  return *this;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::ResetData(
+    MatType predictors, MatType responses)
+{
+  numFunctions = responses.n_cols;
+  this->predictors = std::move(predictors);
+  this->responses = std::move(responses);
+  this->deterministic = true;
+  ResetDeterministic();
+
+  if (!reset)
+    ResetParameters();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<typename OptimizerType>
+double StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Train(
+      MatType predictors,
+      MatType responses,
+      OptimizerType& optimizer)
+{
+  ResetData(std::move(predictors), std::move(responses));
+
+  // Train the model.
+  Timer::Start("ffn_optimization");
+  const double out = optimizer.Optimize(*this, parameter);
+  Timer::Stop("ffn_optimization");
+
+  Log::Info << "StaticFFN::StaticFFN(): final objective of trained model is "
+      << out << "." << std::endl;
+  return out;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<typename OptimizerType>
+double StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Train(
+    MatType predictors, MatType responses)
+{
+  OptimizerType optimizer;
+  return Train(std::move(predictors), std::move(responses), optimizer);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Forward(
+    MatType inputs, MatType& results)
+{
+  if (parameter.is_empty())
+    ResetParameters();
+
+  if (!deterministic)
+  {
+    deterministic = true;
+    ResetDeterministic();
+  }
+
+  currentInput = std::move(inputs);
+  Forward<0>(currentInput);
+  reset = true;
+
+  results = std::get<NumLayers - 1>(network).OutputParameter();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+double StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Backward(
+    MatType targets, MatType& gradients)
+{
+  MatType& output = std::get<NumLayers - 1>(network).OutputParameter();
+  double res = outputLayer.Forward(std::move(output), std::move(targets));
+  res += Loss<0>();
+
+  outputLayer.Backward(std::move(output), std::move(targets),
+      std::move(error));
+
+  gradients = arma::zeros<MatType>(parameter.n_rows, parameter.n_cols);
+
+  Backward<NumLayers - 1>();
+  ResetGradients(gradients);
+  Gradient<0>(currentInput);
+
+  return res;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Predict(
+    MatType predictors, MatType& results, const size_t batchSize)
+{
+  if (parameter.is_empty())
+    ResetParameters();
+
+  if (!deterministic)
+  {
+    deterministic = true;
+    ResetDeterministic();
+  }
+
+  const MatType& output = std::get<NumLayers - 1>(network).OutputParameter();
+  for (size_t begin = 0; begin < predictors.n_cols; begin += batchSize)
+  {
+    const size_t effectiveBatchSize = std::min(batchSize,
+        size_t(predictors.n_cols - begin));
+    MatType batch(predictors.colptr(begin), predictors.n_rows,
+        effectiveBatchSize, false, true);
+    Forward<0>(batch);
+    reset = true;
+
+    // The first batch gives the size of the output.
+    if (begin == 0)
+      results.set_size(output.n_rows, predictors.n_cols);
+
+    results.cols(begin, begin + effectiveBatchSize - 1) = output;
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+double StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Evaluate(
+    MatType predictors, MatType responses)
+{
+  if (parameter.is_empty())
+    ResetParameters();
+
+  if (!deterministic)
+  {
+    deterministic = true;
+    ResetDeterministic();
+  }
+
+  Forward<0>(predictors);
+  reset = true;
+
+  double res = outputLayer.Forward(std::move(
+      std::get<NumLayers - 1>(network).OutputParameter()),
+      std::move(responses));
+
+  return res + Loss<0>();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+double StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Evaluate(
+    const MatType& parameters)
+{
+  double res = 0;
+  for (size_t i = 0; i < predictors.n_cols; ++i)
+    res += Evaluate(parameters, i, 1, true);
+
+  return res;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+double StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Evaluate(
+    const MatType& /* parameters */,
+    const size_t begin,
+    const size_t batchSize,
+    const bool deterministic)
+{
+  if (parameter.is_empty())
+    ResetParameters();
+
+  if (deterministic != this->deterministic)
+  {
+    this->deterministic = deterministic;
+    ResetDeterministic();
+  }
+
+  // Wrap matrices around the batch to avoid a copy.
+  MatType batchPredictors(predictors.colptr(begin), predictors.n_rows,
+      batchSize, false, true);
+  MatType batchResponses(responses.colptr(begin), responses.n_rows,
+      batchSize, false, true);
+
+  Forward<0>(batchPredictors);
+  reset = true;
+
+  double res = outputLayer.Forward(std::move(
+      std::get<NumLayers - 1>(network).OutputParameter()),
+      std::move(batchResponses));
+
+  return res + Loss<0>();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+double StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Evaluate(
+    const MatType& parameters, const size_t begin, const size_t batchSize)
+{
+  return Evaluate(parameters, begin, batchSize, true);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<typename GradType>
+double StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+EvaluateWithGradient(const MatType& parameters, GradType& gradient)
+{
+  double res = 0;
+  for (size_t i = 0; i < predictors.n_cols; ++i)
+    res += EvaluateWithGradient(parameters, i, gradient, 1);
+
+  return res;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<typename GradType>
+double StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+EvaluateWithGradient(const MatType& /* parameters */,
+                     const size_t begin,
+                     GradType& gradient,
+                     const size_t batchSize)
+{
+  if (gradient.is_empty())
+  {
+    if (parameter.is_empty())
+      ResetParameters();
+
+    gradient = arma::zeros<MatType>(parameter.n_rows, parameter.n_cols);
+  }
+  else
+  {
+    gradient.zeros();
+  }
+
+  if (this->deterministic)
+  {
+    this->deterministic = false;
+    ResetDeterministic();
+  }
+
+  // Wrap matrices around the batch to avoid a copy.
+  MatType batchPredictors(predictors.colptr(begin), predictors.n_rows,
+      batchSize, false, true);
+  MatType batchResponses(responses.colptr(begin), responses.n_rows,
+      batchSize, false, true);
+
+  Forward<0>(batchPredictors);
+  reset = true;
+
+  MatType& output = std::get<NumLayers - 1>(network).OutputParameter();
+  double res = outputLayer.Forward(std::move(output),
+      std::move(batchResponses));
+  res += Loss<0>();
+
+  outputLayer.Backward(std::move(output), std::move(batchResponses),
+      std::move(error));
+
+  Backward<NumLayers - 1>();
+  ResetGradients(gradient);
+  Gradient<0>(batchPredictors);
+
+  return res;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Gradient(
+    const MatType& parameters,
+    const size_t begin,
+    MatType& gradient,
+    const size_t batchSize)
+{
+  this->EvaluateWithGradient(parameters, begin, gradient, batchSize);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Shuffle()
+{
+  math::ShuffleData(predictors, responses, predictors, responses);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType,
+               Layers...>::ResetParameters()
+{
+  ResetDeterministic();
+
+  // Determine the number of parameter/weights of the network.
+  if (parameter.is_empty())
+    parameter.set_size(WeightSize<0>(), 1);
+
+  // Initialize the network layer by layer or the complete network.
+  if (ann::InitTraits<InitializationRuleType>::UseLayer)
+    InitializeWeights<0>(0);
+  else
+    initializeRule.Initialize(parameter, parameter.n_elem, 1);
+
+  ResetWeights();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType,
+               Layers...>::ResetWeights()
+{
+  SetWeights<0>(0);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType,
+               Layers...>::ResetDeterministic()
+{
+  SetDeterministic<0>();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType,
+               Layers...>::ResetGradients(MatType& gradient)
+{
+  SetGradients<0>(gradient, 0);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), size_t>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::WeightSize()
+{
+  return WeightSizeVisitor()(&std::get<I>(network)) + WeightSize<I + 1>();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I == sizeof...(Layers)), size_t>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::WeightSize()
+{
+  return 0;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+InitializeWeights(const size_t offset)
+{
+  // Initialize the layer with the specified parameter/weight initialization
+  // rule.
+  const size_t weight = WeightSizeVisitor()(&std::get<I>(network));
+  MatType tmp = MatType(parameter.memptr() + offset, weight, 1, false,
+      false);
+  initializeRule.Initialize(tmp, tmp.n_elem, 1);
+
+  InitializeWeights<I + 1>(offset + weight);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I == sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+InitializeWeights(const size_t /* offset */)
+{
+  /* Nothing to do here. */
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::SetWeights(
+    const size_t offset)
+{
+  const size_t weight = LayerWeights(std::get<I>(network), parameter,
+      offset);
+  ResetVisitor()(&std::get<I>(network));
+
+  SetWeights<I + 1>(offset + weight);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I == sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::SetWeights(
+    const size_t /* offset */)
+{
+  /* Nothing to do here. */
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::SetGradients(
+    MatType& gradient, const size_t offset)
+{
+  const size_t weight = LayerGradients(std::get<I>(network), gradient,
+      offset);
+
+  SetGradients<I + 1>(gradient, offset + weight);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I == sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::SetGradients(
+    MatType& /* gradient */, const size_t /* offset */)
+{
+  /* Nothing to do here. */
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+SetDeterministic()
+{
+  DeterministicSetVisitor(deterministic)(&std::get<I>(network));
+  SetDeterministic<I + 1>();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I == sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+SetDeterministic()
+{
+  /* Nothing to do here. */
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), double>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Loss()
+{
+  return LossVisitor()(&std::get<I>(network)) + Loss<I + 1>();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I == sizeof...(Layers)), double>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Loss()
+{
+  return 0;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<typename T, typename P>
+typename std::enable_if<
+    HasParametersCheck<T, P&(T::*)()>::value &&
+    !HasModelCheck<T>::value, size_t>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::LayerWeights(
+    T& layer, P& weights, const size_t offset)
+{
+  layer.Parameters() = P(weights.memptr() + offset, layer.Parameters().n_rows,
+      layer.Parameters().n_cols, false, false);
+
+  return layer.Parameters().n_elem;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<typename T, typename P>
+typename std::enable_if<
+    !HasParametersCheck<T, P&(T::*)()>::value &&
+    !HasModelCheck<T>::value, size_t>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::LayerWeights(
+    T& /* layer */, P& /* weights */, const size_t /* offset */)
+{
+  return 0;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<typename T, typename P>
+typename std::enable_if<HasModelCheck<T>::value, size_t>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::LayerWeights(
+    T& layer, P& weights, const size_t offset)
+{
+  // The layers held by the layer are arma::mat layers, so the visitor can be
+  // used.
+  return WeightSetVisitor(std::move(weights), offset)(&layer);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<typename T, typename P>
+typename std::enable_if<
+    HasGradientCheck<T, P&(T::*)()>::value &&
+    !HasModelCheck<T>::value, size_t>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::LayerGradients(
+    T& layer, P& gradient, const size_t offset)
+{
+  layer.Gradient() = P(gradient.memptr() + offset, layer.Parameters().n_rows,
+      layer.Parameters().n_cols, false, false);
+
+  return layer.Parameters().n_elem;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<typename T, typename P>
+typename std::enable_if<
+    !HasGradientCheck<T, P&(T::*)()>::value &&
+    !HasModelCheck<T>::value, size_t>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::LayerGradients(
+    T& /* layer */, P& /* gradient */, const size_t /* offset */)
+{
+  return 0;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<typename T, typename P>
+typename std::enable_if<HasModelCheck<T>::value, size_t>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::LayerGradients(
+    T& layer, P& gradient, const size_t offset)
+{
+  return GradientSetVisitor(std::move(gradient), offset)(&layer);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<typename T, typename P>
+typename std::enable_if<
+    HasGradientCheck<T, P&(T::*)()>::value, void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::LayerGradient(
+    T& layer, P& input, P& error)
+{
+  layer.Gradient(std::move(input), std::move(error),
+      std::move(layer.Gradient()));
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<typename T, typename P>
+typename std::enable_if<
+    !HasGradientCheck<T, P&(T::*)()>::value, void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::LayerGradient(
+    T& /* layer */, P& /* input */, P& /* error */)
+{
+  /* Nothing to do here. */
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+auto StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::LayerInput(
+    MatType& input) -> typename std::enable_if<(I == 0), MatType&>::type
+{
+  return input;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+auto StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::LayerInput(
+    MatType& /* input */) -> typename std::enable_if<(I > 0), MatType&>::type
+{
+  return std::get<I - 1>(network).OutputParameter();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+auto StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::LayerError()
+    -> typename std::enable_if<(I + 1 == sizeof...(Layers)), MatType&>::type
+{
+  return error;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+auto StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::LayerError()
+    -> typename std::enable_if<(I + 1 < sizeof...(Layers)), MatType&>::type
+{
+  return std::get<I + 1>(network).Delta();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Forward(
+    MatType& input)
+{
+  LayerType<I>& layer = std::get<I>(network);
+
+  // Until the first forward pass is done, pass the width and height of the
+  // output of the previous layer on.
+  if (!reset && I > 0)
+  {
+    SetInputWidthVisitor(width)(&layer);
+    SetInputHeightVisitor(height)(&layer);
+  }
+
+  layer.Forward(std::move(LayerInput<I>(input)),
+      std::move(layer.OutputParameter()));
+
+  if (!reset)
+  {
+    if (OutputWidthVisitor()(&layer) != 0)
+      width = OutputWidthVisitor()(&layer);
+
+    if (OutputHeightVisitor()(&layer) != 0)
+      height = OutputHeightVisitor()(&layer);
+  }
+
+  Forward<I + 1>(input);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I == sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Forward(
+    MatType& /* input */)
+{
+  /* Nothing to do here. */
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I > 0), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Backward()
+{
+  LayerType<I>& layer = std::get<I>(network);
+  layer.Backward(std::move(layer.OutputParameter()),
+      std::move(LayerError<I>()), std::move(layer.Delta()));
+
+  Backward<I - 1>();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I == 0), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Backward()
+{
+  // The delta of the first layer is not needed.
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Gradient(
+    MatType& input)
+{
+  LayerGradient(std::get<I>(network), LayerInput<I>(input), LayerError<I>());
+
+  Gradient<I + 1>(input);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I == sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Gradient(
+    MatType& /* input */)
+{
+  /* Nothing to do here. */
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::SaveLayers(
+    std::vector<LayerTypes<> >& layers)
+{
+  layers.push_back(&std::get<I>(network));
+  SaveLayers<I + 1>(layers);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I == sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::SaveLayers(
+    std::vector<LayerTypes<> >& /* layers */)
+{
+  /* Nothing to do here. */
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::LoadLayers(
+    std::vector<LayerTypes<> >& layers)
+{
+  LayerType<I>** layer = boost::get<LayerType<I>*>(&layers[I]);
+  if (layer == NULL)
+  {
+    // Release the layers that were not taken over yet.
+    std::for_each(layers.begin() + I, layers.end(),
+        boost::apply_visitor(DeleteVisitor()));
+
+    std::ostringstream oss;
+    oss << "StaticFFN::serialize(): the type of layer " << I << " of the "
+        << "loaded network does not match the type of the model!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  std::get<I>(network) = std::move(**layer);
+  delete *layer;
+
+  LoadLayers<I + 1>(layers);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I == sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::LoadLayers(
+    std::vector<LayerTypes<> >& /* layers */)
+{
+  /* Nothing to do here. */
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<typename Archive>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::serialize(
+    Archive& ar, const unsigned int version)
+{
+  static_assert(std::is_same<MatType, arma::mat>::value,
+      "StaticFFN can only be serialized if its layers use arma::mat.");
+
+  ar & BOOST_SERIALIZATION_NVP(parameter);
+  ar & BOOST_SERIALIZATION_NVP(width);
+  ar & BOOST_SERIALIZATION_NVP(height);
+  ar & BOOST_SERIALIZATION_NVP(currentInput);
+
+  // Earlier versions of the FFN code did not serialize whether or not the model
+  // was reset.
+  if (version > 0)
+  {
+    ar & BOOST_SERIALIZATION_NVP(reset);
+  }
+
+  // The layers are stored like the layers of an FFN, as a vector of layer
+  // pointers.
+  std::vector<LayerTypes<> > layers;
+  if (Archive::is_saving::value)
+    SaveLayers<0>(layers);
+
+  ar & boost::serialization::make_nvp("network", layers);
+
+  // If we are loading, we need to take the layers over and initialize the
+  // weights.
+  if (Archive::is_loading::value)
+  {
+    if (layers.size() != NumLayers)
+    {
+      std::for_each(layers.begin(), layers.end(),
+          boost::apply_visitor(DeleteVisitor()));
+
+      std::ostringstream oss;
+      oss << "StaticFFN::serialize(): the loaded network has " << layers.size()
+          << " layers, but the model has " << NumLayers << "!";
+      throw std::invalid_argument(oss.str());
+    }
+
+    LoadLayers<0>(layers);
+
+    // The behavior in earlier versions was to always assume the weights needed
+    // to be reset.
+    if (version == 0)
+      reset = false;
+
+    ResetWeights();
+
+    deterministic = true;
+    ResetDeterministic();
+  }
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,56 @@
+/**
+ * @file carry_state_visitor.hpp
+ *
+ * Boost static visitor abstraction for calling the CarryState() function on
+ * RNN cells.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_CARRY_STATE_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_CARRY_STATE_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer_traits.hpp>
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * CarryStateVisitor executes the CarryState() function, which starts the next
+ * window of truncated BPTT from the state the current window ended with.
+ */
+class CarryStateVisitor : public boost::static_visitor<void>
+{
+ public:
+  //! Execute the CarryState() function.
+  template<typename LayerType>
+  void operator()(LayerType* layer) const;
+
+ private:
+  //! Execute the CarryState() function for a module which implements the
+  //! CarryState() function.
+  template<typename T>
+  typename std::enable_if<
+      HasCarryStateCheck<T, void(T::*)()>::value, void>::type
+  CarryState(T* layer) const;
+
+  //! Do not execute the CarryState() function for a module which doesn't
+  //! implement the CarryState() function.
+  template<typename T>
+  typename std::enable_if<
+      !HasCarryStateCheck<T, void(T::*)()>::value, void>::type
+  CarryState(T* layer) const;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "carry_state_visitor_impl.hpp"
+
+#endif
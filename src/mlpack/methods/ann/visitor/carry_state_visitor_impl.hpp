@@ -0,0 +1,46 @@
+/**
+ * @file carry_state_visitor_impl.hpp
+ *
+ * Implementation of the CarryState() function layer abstraction.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_CARRY_STATE_VISITOR_IMPL_HPP
+#define MLPACK_METHODS_ANN_VISITOR_CARRY_STATE_VISITOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "carry_state_visitor.hpp"
+
+namespace mlpack {
+namespace ann {
+
+//! CarryStateVisitor visitor class.
+template<typename LayerType>
+inline void CarryStateVisitor::operator()(LayerType* layer) const
+{
+  CarryState(layer);
+}
+
+template<typename T>
+inline typename std::enable_if<
+    HasCarryStateCheck<T, void(T::*)()>::value, void>::type
+CarryStateVisitor::CarryState(T* layer) const
+{
+  layer->CarryState();
+}
+
+template<typename T>
+inline typename std::enable_if<
+    !HasCarryStateCheck<T, void(T::*)()>::value, void>::type
+CarryStateVisitor::CarryState(T* /* layer */) const
+{
+  /* Nothing to do here. */
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,42 @@
+/**
+ * @file layer_name_visitor.hpp
+ *
+ * This file provides an abstraction to get a readable name of the type of
+ * different layers.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_LAYER_NAME_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_LAYER_NAME_VISITOR_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * LayerNameVisitor returns the name of the class of the given module, without
+ * namespaces and template parameters (for instance, "Linear").  Layers that
+ * are typedefs of a class template give the name of the template, so
+ * ReLULayer gives "BaseLayer".
+ */
+class LayerNameVisitor : public boost::static_visitor<std::string>
+{
+ public:
+  //! Return the name of the layer type.
+  template<typename LayerType>
+  std::string operator()(LayerType* layer) const;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "layer_name_visitor_impl.hpp"
+
+#endif
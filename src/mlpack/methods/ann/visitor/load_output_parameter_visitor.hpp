@@ -15,6 +15,7 @@
 #define MLPACK_METHODS_ANN_VISITOR_LOAD_OUTPUT_PARAMETER_VISITOR_HPP
 
 #include <mlpack/methods/ann/layer/layer_traits.hpp>
+#include <mlpack/methods/ann/layer/matrix_views.hpp>
 
 #include <boost/variant.hpp>
 
@@ -31,6 +32,18 @@ class LoadOutputParameterVisitor : public boost::static_visitor<void>
   //! Restore the output parameter given a parameter set.
   LoadOutputParameterVisitor(std::vector<arma::mat>&& parameter);
 
+  /**
+   * Restore the output parameter given a parameter set that was filled by
+   * SaveOutputParameterVisitor with a stack position.  The entries are left in
+   * the parameter set so that their memory can be reused.
+   *
+   * @param parameter The parameter set.
+   * @param position The number of entries of the stack in use; decremented
+   *     for each restored output parameter.
+   */
+  LoadOutputParameterVisitor(std::vector<arma::mat>&& parameter,
+                             size_t& position);
+
   //! Restore the output parameter.
   template<typename LayerType>
   void operator()(LayerType* layer) const;
@@ -39,6 +52,12 @@ class LoadOutputParameterVisitor : public boost::static_visitor<void>
   //! The parameter set.
   std::vector<arma::mat>&& parameter;
 
+  //! The stack position, or NULL if the output parameter is popped.
+  size_t* position;
+
+  //! Restore the given output parameter from the parameter set.
+  void Load(arma::mat& output) const;
+
   //! Restore the output parameter for a module which doesn't implement the
   //! Model() function.
   template<typename T>
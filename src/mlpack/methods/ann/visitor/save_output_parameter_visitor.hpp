@@ -30,6 +30,19 @@ class SaveOutputParameterVisitor : public boost::static_visitor<void>
   //! Save the output parameter into the given parameter set.
   SaveOutputParameterVisitor(std::vector<arma::mat>&& parameter);
 
+  /**
+   * Save the output parameter into the given parameter set, which is used as
+   * a stack whose size is given by position.  Entries above the position are
+   * overwritten instead of appended, so that a parameter set which is filled
+   * once per batch reuses the memory of the previous batch.
+   *
+   * @param parameter The parameter set.
+   * @param position The number of entries of the stack in use; incremented
+   *     for each saved output parameter.
+   */
+  SaveOutputParameterVisitor(std::vector<arma::mat>&& parameter,
+                             size_t& position);
+
   //! Save the output parameter.
   template<typename LayerType>
   void operator()(LayerType* layer) const;
@@ -38,6 +51,12 @@ class SaveOutputParameterVisitor : public boost::static_visitor<void>
   //! The parameter set.
   std::vector<arma::mat>&& parameter;
 
+  //! The stack position, or NULL if the output parameter is appended.
+  size_t* position;
+
+  //! Save the given output parameter into the parameter set.
+  void Save(const arma::mat& output) const;
+
   //! Save the output parameter for a module which doesn't implement the
   //! Model() function.
   template<typename T>
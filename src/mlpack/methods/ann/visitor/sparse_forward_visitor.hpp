@@ -0,0 +1,67 @@
+/**
+ * @file sparse_forward_visitor.hpp
+ *
+ * This file provides an abstraction for the Forward() function of the layers
+ * that take sparse input.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_SPARSE_FORWARD_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_SPARSE_FORWARD_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer_traits.hpp>
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * SparseForwardVisitor executes the Forward() function of a layer that takes
+ * sparse input (like Linear and LinearNoBias) given the sparse input and the
+ * output parameter.  Other layers throw std::invalid_argument.
+ */
+class SparseForwardVisitor : public boost::static_visitor<void>
+{
+ public:
+  //! Execute the Forward() function given the sparse input and the output
+  //! parameter.
+  SparseForwardVisitor(const arma::sp_mat& input, arma::mat&& output);
+
+  //! Execute the Forward() function.
+  template<typename LayerType>
+  void operator()(LayerType* layer) const;
+
+ private:
+  //! The sparse input.
+  const arma::sp_mat& input;
+
+  //! The output parameter set.
+  arma::mat&& output;
+
+  //! Execute the Forward() function if the layer takes sparse input.
+  template<typename T>
+  typename std::enable_if<
+      HasForwardCheck<T, void(T::*)(const arma::sp_mat&,
+          arma::mat&&)>::value, void>::type
+  LayerForward(T* layer) const;
+
+  //! Throw if the layer doesn't take sparse input.
+  template<typename T>
+  typename std::enable_if<
+      !HasForwardCheck<T, void(T::*)(const arma::sp_mat&,
+          arma::mat&&)>::value, void>::type
+  LayerForward(T* layer) const;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "sparse_forward_visitor_impl.hpp"
+
+#endif
@@ -0,0 +1,58 @@
+/**
+ * @file sparse_forward_visitor_impl.hpp
+ *
+ * Implementation of the Forward() function abstraction for layers that take
+ * sparse input.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_SPARSE_FORWARD_VISITOR_IMPL_HPP
+#define MLPACK_METHODS_ANN_VISITOR_SPARSE_FORWARD_VISITOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "sparse_forward_visitor.hpp"
+
+namespace mlpack {
+namespace ann {
+
+//! SparseForwardVisitor visitor class.
+inline SparseForwardVisitor::SparseForwardVisitor(const arma::sp_mat& input,
+                                                  arma::mat&& output) :
+    input(input),
+    output(std::move(output))
+{
+  /* Nothing to do here. */
+}
+
+template<typename LayerType>
+inline void SparseForwardVisitor::operator()(LayerType* layer) const
+{
+  LayerForward(layer);
+}
+
+template<typename T>
+inline typename std::enable_if<
+    HasForwardCheck<T, void(T::*)(const arma::sp_mat&,
+        arma::mat&&)>::value, void>::type
+SparseForwardVisitor::LayerForward(T* layer) const
+{
+  layer->Forward(input, std::move(output));
+}
+
+template<typename T>
+inline typename std::enable_if<
+    !HasForwardCheck<T, void(T::*)(const arma::sp_mat&,
+        arma::mat&&)>::value, void>::type
+SparseForwardVisitor::LayerForward(T* /* layer */) const
+{
+  throw std::invalid_argument("sparse input can only be passed to a layer "
+      "that takes it, like Linear or LinearNoBias");
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
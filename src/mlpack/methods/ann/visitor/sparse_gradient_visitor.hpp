@@ -0,0 +1,67 @@
+/**
+ * @file sparse_gradient_visitor.hpp
+ *
+ * This file provides an abstraction for the Gradient() function of the layers
+ * that take sparse input.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_SPARSE_GRADIENT_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_SPARSE_GRADIENT_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer_traits.hpp>
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * SparseGradientVisitor executes the Gradient() method of a layer that takes
+ * sparse input (like Linear and LinearNoBias) using the sparse input and the
+ * delta parameter.  Other layers throw std::invalid_argument.
+ */
+class SparseGradientVisitor : public boost::static_visitor<void>
+{
+ public:
+  //! Executes the Gradient() method of the given module using the sparse
+  //! input and the delta parameter.
+  SparseGradientVisitor(const arma::sp_mat& input, arma::mat&& delta);
+
+  //! Executes the Gradient() method.
+  template<typename LayerType>
+  void operator()(LayerType* layer) const;
+
+ private:
+  //! The sparse input.
+  const arma::sp_mat& input;
+
+  //! The delta parameter.
+  arma::mat&& delta;
+
+  //! Execute the Gradient() function if the layer takes sparse input.
+  template<typename T>
+  typename std::enable_if<
+      HasGradientCheck<T, void(T::*)(const arma::sp_mat&, arma::mat&&,
+          arma::mat&&)>::value, void>::type
+  LayerGradients(T* layer) const;
+
+  //! Throw if the layer doesn't take sparse input.
+  template<typename T>
+  typename std::enable_if<
+      !HasGradientCheck<T, void(T::*)(const arma::sp_mat&, arma::mat&&,
+          arma::mat&&)>::value, void>::type
+  LayerGradients(T* layer) const;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "sparse_gradient_visitor_impl.hpp"
+
+#endif
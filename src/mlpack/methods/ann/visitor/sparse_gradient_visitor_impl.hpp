@@ -0,0 +1,58 @@
+/**
+ * @file sparse_gradient_visitor_impl.hpp
+ *
+ * Implementation of the Gradient() function abstraction for layers that take
+ * sparse input.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_SPARSE_GRADIENT_VISITOR_IMPL_HPP
+#define MLPACK_METHODS_ANN_VISITOR_SPARSE_GRADIENT_VISITOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "sparse_gradient_visitor.hpp"
+
+namespace mlpack {
+namespace ann {
+
+//! SparseGradientVisitor visitor class.
+inline SparseGradientVisitor::SparseGradientVisitor(const arma::sp_mat& input,
+                                                    arma::mat&& delta) :
+    input(input),
+    delta(std::move(delta))
+{
+  /* Nothing to do here. */
+}
+
+template<typename LayerType>
+inline void SparseGradientVisitor::operator()(LayerType* layer) const
+{
+  LayerGradients(layer);
+}
+
+template<typename T>
+inline typename std::enable_if<
+    HasGradientCheck<T, void(T::*)(const arma::sp_mat&, arma::mat&&,
+        arma::mat&&)>::value, void>::type
+SparseGradientVisitor::LayerGradients(T* layer) const
+{
+  layer->Gradient(input, std::move(delta), std::move(layer->Gradient()));
+}
+
+template<typename T>
+inline typename std::enable_if<
+    !HasGradientCheck<T, void(T::*)(const arma::sp_mat&, arma::mat&&,
+        arma::mat&&)>::value, void>::type
+SparseGradientVisitor::LayerGradients(T* /* layer */) const
+{
+  throw std::invalid_argument("sparse input can only be passed to a layer "
+      "that takes it, like Linear or LinearNoBias");
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
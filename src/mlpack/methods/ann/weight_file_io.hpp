@@ -0,0 +1,105 @@
+/**
+ * @file weight_file_io.hpp
+ *
+ * Definition of WeightFileIO, which saves the layers and the parameters of a
+ * network in a binary file whose parameters can be mapped into memory and
+ * used without copying.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_WEIGHT_FILE_IO_HPP
+#define MLPACK_METHODS_ANN_WEIGHT_FILE_IO_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/mapped_file.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * WeightFileIO reads and writes the weight files used by FFN::SaveFlat() and
+ * RNN::SaveFlat().  A weight file holds the following, in order:
+ *
+ *  - a fixed-size header (containing the magic string "MLPKANN", the format
+ *    version, the element size, and the sizes and offsets of each section);
+ *  - the layer graph of the network: a binary archive of the layers and the
+ *    settings of the network, without the parameters;
+ *  - the parameters of the network, in column-major order, aligned to the
+ *    page size.
+ *
+ * When a network is loaded, the parameters are not copied: the parameter
+ * matrix is an alias of the memory of the mapped file.  Since the mapping is
+ * copy-on-write, every process that loads the same file shares the physical
+ * pages of the parameters until it modifies them, and only the pages that are
+ * touched are read from disk.
+ *
+ * The file format depends on the endianness of the machine it was written on.
+ */
+class WeightFileIO
+{
+ public:
+  /**
+   * Save the given layer graph and parameters to the given file.
+   *
+   * @param filename File to save to.
+   * @param graph Binary archive of the layer graph of the network.
+   * @param parameters Parameters of the network.
+   */
+  static void Save(const std::string& filename,
+                   const std::string& graph,
+                   const arma::mat& parameters);
+
+  /**
+   * Load a weight file from the given mapped file.  The layer graph is
+   * returned, and the given parameter matrix is made an alias of the memory of
+   * the mapped file, so the file must outlive it.  If the file is not a valid
+   * weight file, std::runtime_error is thrown.
+   *
+   * @param file Mapped weight file.
+   * @param parameters Matrix to alias the parameters of the network with.
+   */
+  static std::string Load(const util::MappedFile& file,
+                          arma::mat& parameters);
+
+ private:
+  //! The header of a weight file.
+  struct Header
+  {
+    //! Magic string identifying the file type: "MLPKANN".
+    char magic[8];
+    //! The version of the format.
+    uint64_t version;
+    //! The size of each parameter, in bytes.
+    uint64_t elemSize;
+    //! The offset of the layer graph in the file.
+    uint64_t graphOffset;
+    //! The size of the layer graph, in bytes.
+    uint64_t graphSize;
+    //! The offset of the parameters in the file.
+    uint64_t parameterOffset;
+    //! The number of rows of the parameter matrix.
+    uint64_t rows;
+    //! The number of columns of the parameter matrix.
+    uint64_t cols;
+  };
+
+  //! The current version of the format.
+  static const uint64_t Version = 1;
+
+  //! Round the given offset up to a multiple of the page size (4096 bytes).
+  static uint64_t Align(const uint64_t offset)
+  {
+    return (offset + 4095) & ~((uint64_t) 4095);
+  }
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "weight_file_io_impl.hpp"
+
+#endif
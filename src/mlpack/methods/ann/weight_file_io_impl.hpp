@@ -0,0 +1,92 @@
+/**
+ * @file weight_file_io_impl.hpp
+ *
+ * Implementation of WeightFileIO, which saves the layers and the parameters of
+ * a network in a binary file whose parameters can be mapped into memory.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_WEIGHT_FILE_IO_IMPL_HPP
+#define MLPACK_METHODS_ANN_WEIGHT_FILE_IO_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "weight_file_io.hpp"
+
+#include <fstream>
+#include <cstring>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+inline void WeightFileIO::Save(const std::string& filename,
+                               const std::string& graph,
+                               const arma::mat& parameters)
+{
+  Header header;
+  std::memcpy(header.magic, "MLPKANN", 8);
+  header.version = Version;
+  header.elemSize = sizeof(double);
+  header.graphOffset = sizeof(Header);
+  header.graphSize = graph.size();
+  header.parameterOffset = Align(header.graphOffset + header.graphSize);
+  header.rows = parameters.n_rows;
+  header.cols = parameters.n_cols;
+
+  std::ofstream stream(filename, std::ios::binary);
+  if (!stream.is_open())
+    throw std::runtime_error("WeightFileIO::Save(): cannot open file '" +
+        filename + "' for writing");
+
+  stream.write((const char*) &header, sizeof(Header));
+  stream.write(graph.data(), graph.size());
+
+  // Pad the stream with zeros up to the parameters.
+  while ((uint64_t) stream.tellp() < header.parameterOffset)
+    stream.put(0);
+
+  stream.write((const char*) parameters.memptr(),
+      parameters.n_elem * sizeof(double));
+
+  if (!stream.good())
+    throw std::runtime_error("WeightFileIO::Save(): error writing to file '" +
+        filename + "'");
+}
+
+inline std::string WeightFileIO::Load(const util::MappedFile& file,
+                                      arma::mat& parameters)
+{
+  const std::string error = "WeightFileIO::Load(): '" + file.Filename() + "' ";
+  if (file.Size() < sizeof(Header))
+    throw std::runtime_error(error + "is not a weight file");
+
+  Header header;
+  std::memcpy(&header, file.Data(), sizeof(Header));
+  if (std::memcmp(header.magic, "MLPKANN", 8) != 0)
+    throw std::runtime_error(error + "is not a weight file");
+  if (header.version != Version)
+    throw std::runtime_error(error + "has an unsupported format version");
+  if (header.elemSize != sizeof(double))
+    throw std::runtime_error(error + "holds parameters of a different element "
+        "type");
+  if (header.graphOffset < sizeof(Header) ||
+      header.parameterOffset < header.graphOffset + header.graphSize ||
+      header.parameterOffset % 4096 != 0 ||
+      header.parameterOffset + header.rows * header.cols * sizeof(double) >
+          file.Size())
+    throw std::runtime_error(error + "is truncated or corrupt");
+
+  // Alias the parameters directly from the mapped memory.  The alias is not
+  // strict, so that the parameters can still be moved and swapped.
+  parameters = arma::mat((double*) (file.Data() + header.parameterOffset),
+      header.rows, header.cols, false, false);
+
+  return std::string(file.Data() + header.graphOffset, header.graphSize);
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
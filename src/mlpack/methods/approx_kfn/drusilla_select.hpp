@@ -47,10 +47,13 @@ class DrusillaSelect
    * @param referenceSet Set of reference data.
    * @param l Number of projections.
    * @param m Number of elements to store for each projection.
+   * @param storeCandidates If false, store only the indices of the candidate
+   *     points instead of copies of them (see StoreCandidates()).
    */
   DrusillaSelect(const MatType& referenceSet,
                  const size_t l,
-                 const size_t m);
+                 const size_t m,
+                 const bool storeCandidates = true);
 
   /**
    * Construct the DrusillaSelect object with no given reference set.  Be sure
@@ -58,13 +61,18 @@ class DrusillaSelect
    *
    * @param l Number of projections.
    * @param m Number of elements to store for each projection.
+   * @param storeCandidates If false, store only the indices of the candidate
+   *     points instead of copies of them (see StoreCandidates()).
    */
-  DrusillaSelect(const size_t l, const size_t m);
+  DrusillaSelect(const size_t l,
+                 const size_t m,
+                 const bool storeCandidates = true);
 
   /**
    * Build the set of candidate points on the given reference set.  If l and m
    * are left unspecified, then the values set in the constructor will be used
-   * instead.
+   * instead.  The scores of the points for each projection are computed in
+   * parallel when OpenMP is available.
    *
    * @param referenceSet Set to extract candidate points from.
    * @param l Number of projections.
@@ -81,7 +89,8 @@ class DrusillaSelect
    * NeighborSearch and LSHSearch classes.  That is, each column in the
    * neighbors and distances matrices will refer to a single query point, and
    * the k'th row in that column will refer to the k'th candidate neighbor or
-   * distance for that query point.
+   * distance for that query point.  The query points are searched in parallel
+   * when OpenMP is available.
    *
    * @param querySet Set of query points to search.
    * @param k Number of furthest neighbors to search for.
@@ -94,12 +103,15 @@ class DrusillaSelect
               arma::mat& distances);
 
   /**
-   * Serialize the model.
+   * Serialize the model.  A model that only stores the indices of its
+   * candidates saves copies of them, so a loaded model does not depend on the
+   * reference set.
    */
   template<typename Archive>
   void serialize(Archive& ar, const unsigned int /* version */);
 
-  //! Access the candidate set.
+  //! Access the candidate set.  This is empty if only the indices of the
+  //! candidates are stored.
   const MatType& CandidateSet() const { return candidateSet; }
   //! Modify the candidate set.  Be careful!
   MatType& CandidateSet() { return candidateSet; }
@@ -109,11 +121,25 @@ class DrusillaSelect
   //! Modify the indices of points in the candidate set.  Be careful!
   arma::Col<size_t>& CandidateIndices() { return candidateIndices; }
 
+  /**
+   * Get whether copies of the candidate points are stored.  If not, only their
+   * indices are stored, and Search() reads the candidates from the reference
+   * set given to Train(), which must then outlive the model (or be given again
+   * with Train()).  Changes take effect at the next call to Train().
+   */
+  bool StoreCandidates() const { return storeCandidates; }
+  //! Modify whether copies of the candidate points are stored.
+  bool& StoreCandidates() { return storeCandidates; }
+
  private:
-  //! The reference set.
+  //! The candidate points, if copies of them are stored.
   MatType candidateSet;
   //! Indices of each point in the reference set.
   arma::Col<size_t> candidateIndices;
+  //! Whether copies of the candidate points are stored.
+  bool storeCandidates;
+  //! The reference set, if only the indices of the candidates are stored.
+  const MatType* referenceSet;
 
   //! The number of projections.
   size_t l;
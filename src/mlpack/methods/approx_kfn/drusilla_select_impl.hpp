@@ -16,9 +16,7 @@
 #include "drusilla_select.hpp"
 
 #include <queue>
-#include <mlpack/methods/neighbor_search/neighbor_search_rules.hpp>
-#include <mlpack/methods/neighbor_search/sort_policies/furthest_neighbor_sort.hpp>
-#include <mlpack/core/tree/binary_space_tree.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
 #include <algorithm>
 
 namespace mlpack {
@@ -28,9 +26,12 @@ namespace neighbor {
 template<typename MatType>
 DrusillaSelect<MatType>::DrusillaSelect(const MatType& referenceSet,
                                         const size_t l,
-                                        const size_t m) :
+                                        const size_t m,
+                                        const bool storeCandidates) :
     candidateSet(referenceSet.n_cols, l * m),
     candidateIndices(l * m),
+    storeCandidates(storeCandidates),
+    referenceSet(NULL),
     l(l),
     m(m)
 {
@@ -46,9 +47,13 @@ DrusillaSelect<MatType>::DrusillaSelect(const MatType& referenceSet,
 
 // Constructor with no training.
 template<typename MatType>
-DrusillaSelect<MatType>::DrusillaSelect(const size_t l, const size_t m) :
+DrusillaSelect<MatType>::DrusillaSelect(const size_t l,
+                                        const size_t m,
+                                        const bool storeCandidates) :
     candidateSet(0, l * m),
     candidateIndices(l * m),
+    storeCandidates(storeCandidates),
+    referenceSet(NULL),
     l(l),
     m(m)
 {
@@ -78,19 +83,29 @@ void DrusillaSelect<MatType>::Train(
         "large!  Choose smaller values.  l*m must be smaller than the number "
         "of points in the dataset.");
 
-  candidateSet.set_size(referenceSet.n_rows, l * m);
+  if (storeCandidates)
+    candidateSet.set_size(referenceSet.n_rows, l * m);
+  else
+    candidateSet.reset();
   candidateIndices.set_size(l * m);
+  this->referenceSet = storeCandidates ? NULL : &referenceSet;
 
   arma::vec dataMean(arma::mean(referenceSet, 1));
   arma::vec norms(referenceSet.n_cols);
 
   MatType refCopy(referenceSet.n_rows, referenceSet.n_cols);
-  for (size_t i = 0; i < refCopy.n_cols; ++i)
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) refCopy.n_cols; ++i)
   {
     refCopy.col(i) = referenceSet.col(i) - dataMean;
     norms[i] = arma::norm(refCopy.col(i));
   }
 
+  // Each projection depends on the points chosen by the previous ones, so only
+  // the scoring of the points for each projection is parallel.
+  std::vector<char> closeAngle(referenceSet.n_cols);
+  arma::vec sums(referenceSet.n_cols);
+
   // Find the top m points for each of the l projections...
   for (size_t i = 0; i < l; ++i)
   {
@@ -101,10 +116,10 @@ void DrusillaSelect<MatType>::Train(
     arma::vec line(refCopy.col(maxIndex) / arma::norm(refCopy.col(maxIndex)));
 
     // Calculate distortion and offset and make scores.
-    std::vector<bool> closeAngle(referenceSet.n_cols, false);
-    arma::vec sums(referenceSet.n_cols);
-    for (size_t j = 0; j < referenceSet.n_cols; ++j)
+    #pragma omp parallel for
+    for (omp_size_t j = 0; j < (omp_size_t) referenceSet.n_cols; ++j)
     {
+      closeAngle[j] = false;
       if (norms[j] > 0.0)
       {
         const double offset = arma::dot(refCopy.col(j), line);
@@ -149,7 +164,8 @@ void DrusillaSelect<MatType>::Train(
     {
       const size_t index = pq.top().second;
       pq.pop();
-      candidateSet.col(i * m + j) = referenceSet.col(index);
+      if (storeCandidates)
+        candidateSet.col(i * m + j) = referenceSet.col(index);
       candidateIndices[i * m + j] = index;
 
       // Mark the norm as -1 so we don't see this point again.
@@ -171,7 +187,7 @@ void DrusillaSelect<MatType>::Search(const MatType& querySet,
                                      arma::Mat<size_t>& neighbors,
                                      arma::mat& distances)
 {
-  if (candidateSet.n_cols == 0)
+  if (candidateSet.n_cols == 0 && referenceSet == NULL)
     throw std::runtime_error("DrusillaSelect::Search(): candidate set not "
         "initialized!  Call Train() first.");
 
@@ -179,23 +195,49 @@ void DrusillaSelect<MatType>::Search(const MatType& querySet,
     throw std::invalid_argument("DrusillaSelect::Search(): requested k is "
         "greater than number of points in candidate set!  Increase l or m.");
 
-  // We'll use the NeighborSearchRules class to perform our brute-force search.
-  // Note that we aren't using trees for our search, so we can use 'int' as a
-  // TreeType.
-  metric::EuclideanDistance metric;
-  NeighborSearchRules<FurthestNeighborSort, metric::EuclideanDistance,
-      tree::KDTree<metric::EuclideanDistance, tree::EmptyStatistic, MatType>>
-      rules(candidateSet, querySet, k, metric, 0, false);
+  neighbors.set_size(k, querySet.n_cols);
+  distances.set_size(k, querySet.n_cols);
 
-  for (size_t q = 0; q < querySet.n_cols; ++q)
-    for (size_t r = 0; r < candidateSet.n_cols; ++r)
-      rules.BaseCase(q, r);
+  // The search is brute-force over the candidate set.  Each query only writes
+  // its own column of the results, so the queries are searched in parallel.
+  typedef std::pair<double, size_t> Candidate;
+  #pragma omp parallel for schedule(dynamic, 16)
+  for (omp_size_t q = 0; q < (omp_size_t) querySet.n_cols; ++q)
+  {
+    // Keep the k furthest candidates; the closest of them is on top.
+    std::priority_queue<Candidate, std::vector<Candidate>,
+        std::greater<Candidate>> results;
+    for (size_t r = 0; r < candidateIndices.n_elem; ++r)
+    {
+      double distance;
+      if (referenceSet == NULL)
+      {
+        distance = metric::EuclideanDistance::Evaluate(querySet.col(q),
+            candidateSet.col(r));
+      }
+      else
+      {
+        distance = metric::EuclideanDistance::Evaluate(querySet.col(q),
+            referenceSet->col(candidateIndices[r]));
+      }
 
-  rules.GetResults(neighbors, distances);
+      if (results.size() < k)
+        results.push(std::make_pair(distance, candidateIndices[r]));
+      else if (distance > results.top().first)
+      {
+        results.pop();
+        results.push(std::make_pair(distance, candidateIndices[r]));
+      }
+    }
 
-  // Map the neighbors back to their original indices in the reference set.
-  for (size_t i = 0; i < neighbors.n_elem; ++i)
-    neighbors[i] = candidateIndices[neighbors[i]];
+    // Extract the results, furthest first.
+    for (size_t j = 1; j <= k; ++j)
+    {
+      neighbors(k - j, q) = results.top().second;
+      distances(k - j, q) = results.top().first;
+      results.pop();
+    }
+  }
 }
 
 //! Serialize the model.
@@ -204,10 +246,28 @@ template<typename Archive>
 void DrusillaSelect<MatType>::serialize(Archive& ar,
                                         const unsigned int /* version */)
 {
-  ar & BOOST_SERIALIZATION_NVP(candidateSet);
+  // A model that only stores the indices of its candidates saves copies of
+  // them, so that it can be loaded without the reference set.
+  if (Archive::is_saving::value && referenceSet != NULL)
+  {
+    MatType candidateSet(referenceSet->n_rows, candidateIndices.n_elem);
+    for (size_t i = 0; i < candidateIndices.n_elem; ++i)
+      candidateSet.col(i) = referenceSet->col(candidateIndices[i]);
+    ar & BOOST_SERIALIZATION_NVP(candidateSet);
+  }
+  else
+  {
+    ar & BOOST_SERIALIZATION_NVP(candidateSet);
+  }
   ar & BOOST_SERIALIZATION_NVP(candidateIndices);
   ar & BOOST_SERIALIZATION_NVP(l);
   ar & BOOST_SERIALIZATION_NVP(m);
+
+  if (Archive::is_loading::value)
+  {
+    storeCandidates = true;
+    referenceSet = NULL;
+  }
 }
 
 } // namespace neighbor
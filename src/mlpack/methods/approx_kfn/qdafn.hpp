@@ -40,8 +40,10 @@ class QDAFN
    *
    * @param l Number of projections.
    * @param m Number of elements to store for each projection.
+   * @param storeCandidates If false, store only the indices of the candidate
+   *     points instead of copies of them (see StoreCandidates()).
    */
-  QDAFN(const size_t l, const size_t m);
+  QDAFN(const size_t l, const size_t m, const bool storeCandidates = true);
 
   /**
    * Construct the QDAFN object with the given reference set (this is the set
@@ -50,15 +52,19 @@ class QDAFN
    * @param referenceSet Set of reference data.
    * @param l Number of projections.
    * @param m Number of elements to store for each projection.
+   * @param storeCandidates If false, store only the indices of the candidate
+   *     points instead of copies of them (see StoreCandidates()).
    */
   QDAFN(const MatType& referenceSet,
         const size_t l,
-        const size_t m);
+        const size_t m,
+        const bool storeCandidates = true);
 
   /**
    * Train the QDAFN model on the given reference set, optionally setting new
    * parameters for the number of projections/tables (l) and the number of
-   * elements stored for each projection/table (m).
+   * elements stored for each projection/table (m).  The tables are built in
+   * parallel when OpenMP is available.
    *
    * @param referenceSet Reference set to train on.
    * @param l Number of projections.
@@ -72,47 +78,75 @@ class QDAFN
    * Search for the k furthest neighbors of the given query set.  (The query set
    * can contain just one point, that is okay.)  The results will be stored in
    * the given neighbors and distances matrices, in the same format as the
-   * mlpack NeighborSearch and LSHSearch classes.
+   * mlpack NeighborSearch and LSHSearch classes.  The query points are
+   * searched in parallel when OpenMP is available.
    */
   void Search(const MatType& querySet,
               const size_t k,
               arma::Mat<size_t>& neighbors,
               arma::mat& distances);
 
-  //! Serialize the model.
+  /**
+   * Serialize the model.  A model that only stores the indices of its
+   * candidates saves copies of them, so a loaded model does not depend on the
+   * reference set.
+   */
   template<typename Archive>
-  void serialize(Archive& ar, const unsigned int /* version */);
+  void serialize(Archive& ar, const unsigned int version);
 
   //! Get the number of projections.
-  size_t NumProjections() const { return candidateSet.size(); }
+  size_t NumProjections() const { return lines.n_cols; }
 
-  //! Get the candidate set for the given projection table.
+  //! Get the candidate set for the given projection table.  This is empty if
+  //! only the indices of the candidates are stored.
   const MatType& CandidateSet(const size_t t) const { return candidateSet[t]; }
   //! Modify the candidate set for the given projection table.  Careful!
   MatType& CandidateSet(const size_t t) { return candidateSet[t]; }
 
+  //! Get the indices of the candidates (one column for each projection table).
+  const arma::Mat<size_t>& CandidateIndices() const { return sIndices; }
+
+  /**
+   * Get whether copies of the candidate points are stored.  If not, only their
+   * indices are stored, and Search() reads the candidates from the reference
+   * set given to Train(), which must then outlive the model (or be given again
+   * with Train()).  Changes take effect at the next call to Train().
+   */
+  bool StoreCandidates() const { return storeCandidates; }
+  //! Modify whether copies of the candidate points are stored.
+  bool& StoreCandidates() { return storeCandidates; }
+
  private:
   //! The number of projections.
   size_t l;
   //! The number of elements to store for each projection.
   size_t m;
+  //! Whether copies of the candidate points are stored.
+  bool storeCandidates;
   //! The random lines we are projecting onto.  Has l columns.
   arma::mat lines;
-  //! Projections of each point onto each random line.
-  arma::mat projections;
 
   //! Indices of the points for each S.
   arma::Mat<size_t> sIndices;
-  //! Values of a_i * x for each point in S.
-  arma::mat sValues;
+  //! Values of a_i * x for each point in S.  These are only used to order the
+  //! tables during search, so single precision is enough.
+  arma::fmat sValues;
 
-  // Candidate sets; one element in the vector for each table.
+  // Candidate sets; one element in the vector for each table.  Empty if only
+  // the indices of the candidates are stored.
   std::vector<MatType> candidateSet;
+  //! The reference set, if only the indices of the candidates are stored.
+  const MatType* referenceSet;
 };
 
 } // namespace neighbor
 } // namespace mlpack
 
+//! Set the serialization version of the QDAFN class.  Version 0 also stored
+//! the projections of every reference point.
+BOOST_TEMPLATE_CLASS_VERSION(template<typename MatType>,
+    mlpack::neighbor::QDAFN<MatType>, 1);
+
 // Include implementation.
 #include "qdafn_impl.hpp"
 
@@ -16,6 +16,7 @@
 #include "qdafn.hpp"
 
 #include <queue>
+#include <algorithm>
 #include <mlpack/methods/neighbor_search/sort_policies/furthest_neighbor_sort.hpp>
 
 namespace mlpack {
@@ -23,7 +24,13 @@ namespace neighbor {
 
 // Non-training constructor.
 template<typename MatType>
-QDAFN<MatType>::QDAFN(const size_t l, const size_t m) : l(l), m(m)
+QDAFN<MatType>::QDAFN(const size_t l,
+                      const size_t m,
+                      const bool storeCandidates) :
+    l(l),
+    m(m),
+    storeCandidates(storeCandidates),
+    referenceSet(NULL)
 {
   if (l == 0)
     throw std::invalid_argument("QDAFN::QDAFN(): l must be greater than 0!");
@@ -35,9 +42,12 @@ QDAFN<MatType>::QDAFN(const size_t l, const size_t m) : l(l), m(m)
 template<typename MatType>
 QDAFN<MatType>::QDAFN(const MatType& referenceSet,
                       const size_t l,
-                      const size_t m) :
+                      const size_t m,
+                      const bool storeCandidates) :
     l(l),
-    m(m)
+    m(m),
+    storeCandidates(storeCandidates),
+    referenceSet(NULL)
 {
   if (l == 0)
     throw std::invalid_argument("QDAFN::QDAFN(): l must be greater than 0!");
@@ -58,33 +68,59 @@ void QDAFN<MatType>::Train(const MatType& referenceSet,
   if (mIn != 0)
     m = mIn;
 
+  if (m > referenceSet.n_cols)
+    throw std::invalid_argument("QDAFN::Train(): m must not be greater than "
+        "the number of points in the reference set!");
+
   // Build tables.  This is done by drawing random points from a Gaussian
   // distribution as the vectors we project onto.  The Gaussian should have zero
-  // mean and unit variance.
+  // mean and unit variance.  The random number generator is not thread-safe,
+  // so the lines are drawn before the parallel section.
   mlpack::distribution::GaussianDistribution gd(referenceSet.n_rows);
   lines.set_size(referenceSet.n_rows, l);
   for (size_t i = 0; i < l; ++i)
     lines.col(i) = gd.Random();
 
-  // Now, project each of the reference points onto each line, and collect the
-  // top m elements.
-  projections = referenceSet.t() * lines;
-
-  // Loop over each projection and find the top m elements.
   sIndices.set_size(m, l);
   sValues.set_size(m, l);
-  candidateSet.resize(l);
-  for (size_t i = 0; i < l; ++i)
+  candidateSet.clear();
+  candidateSet.resize(storeCandidates ? l : 0);
+  this->referenceSet = storeCandidates ? NULL : &referenceSet;
+
+  // Now, project each of the reference points onto each line and collect the
+  // top m elements.  Each table only needs the projections onto its own line,
+  // so the full matrix of projections is never held.
+  #pragma omp parallel
   {
-    candidateSet[i].set_size(referenceSet.n_rows, m);
-    arma::uvec sortedIndices = arma::sort_index(projections.col(i), "descend");
+    arma::vec projections(referenceSet.n_cols);
+    std::vector<size_t> order(referenceSet.n_cols);
 
-    // Grab the top m elements.
-    for (size_t j = 0; j < m; ++j)
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t i = 0; i < (omp_size_t) l; ++i)
     {
-      sIndices(j, i) = sortedIndices[j];
-      sValues(j, i) = projections(sortedIndices[j], i);
-      candidateSet[i].col(j) = referenceSet.col(sortedIndices[j]);
+      projections = trans(trans(lines.col(i)) * referenceSet);
+
+      // Only the top m elements need to be sorted.
+      for (size_t j = 0; j < order.size(); ++j)
+        order[j] = j;
+      std::partial_sort(order.begin(), order.begin() + m, order.end(),
+          [&projections](const size_t a, const size_t b)
+          {
+            return projections[a] > projections[b];
+          });
+
+      for (size_t j = 0; j < m; ++j)
+      {
+        sIndices(j, i) = order[j];
+        sValues(j, i) = (float) projections[order[j]];
+      }
+
+      if (storeCandidates)
+      {
+        candidateSet[i].set_size(referenceSet.n_rows, m);
+        for (size_t j = 0; j < m; ++j)
+          candidateSet[i].col(j) = referenceSet.col(order[j]);
+      }
     }
   }
 }
@@ -100,12 +136,22 @@ void QDAFN<MatType>::Search(const MatType& querySet,
     throw std::invalid_argument("QDAFN::Search(): requested k is greater than "
         "value of m!");
 
+  if (candidateSet.empty() && referenceSet == NULL)
+    throw std::runtime_error("QDAFN::Search(): model not trained!  Call "
+        "Train() first.");
+
+  if (querySet.n_rows != lines.n_rows)
+    throw std::invalid_argument("QDAFN::Search(): dimensionality of query set "
+        "does not match dimensionality of reference set!");
+
   neighbors.set_size(k, querySet.n_cols);
   neighbors.fill(size_t() - 1);
   distances.zeros(k, querySet.n_cols);
 
-  // Search for each point.
-  for (size_t q = 0; q < querySet.n_cols; ++q)
+  // Search for each point.  Each query only writes its own column of the
+  // results.
+  #pragma omp parallel for schedule(dynamic, 16)
+  for (omp_size_t q = 0; q < (omp_size_t) querySet.n_cols; ++q)
   {
     // Initialize a priority queue.
     // The size_t represents the index of the table, and the double represents
@@ -129,21 +175,31 @@ void QDAFN<MatType>::Search(const MatType& querySet,
         resultsQueue(std::less<std::pair<double, size_t>>(), std::move(v));
     for (size_t i = 0; i < m; ++i)
     {
-      std::pair<size_t, double> p = queue.top();
+      std::pair<double, size_t> p = queue.top();
       queue.pop();
 
       // Get index of reference point to look at.
       const size_t tableIndex = tableLocations[p.second];
+      const size_t referenceIndex = sIndices(tableIndex, p.second);
 
       // Calculate distance from query point.
-      const double dist = mlpack::metric::EuclideanDistance::Evaluate(
-          querySet.col(q), candidateSet[p.second].col(tableIndex));
+      double dist;
+      if (referenceSet == NULL)
+      {
+        dist = mlpack::metric::EuclideanDistance::Evaluate(querySet.col(q),
+            candidateSet[p.second].col(tableIndex));
+      }
+      else
+      {
+        dist = mlpack::metric::EuclideanDistance::Evaluate(querySet.col(q),
+            referenceSet->col(referenceIndex));
+      }
 
       // Is this neighbor good enough to insert into the results?
       if (dist > resultsQueue.top().first)
       {
         resultsQueue.pop();
-        resultsQueue.push(std::make_pair(dist, sIndices(tableIndex, p.second)));
+        resultsQueue.push(std::make_pair(dist, referenceIndex));
       }
 
       // Now (line 14) get the next element and insert into the queue.  Do this
@@ -171,17 +227,53 @@ void QDAFN<MatType>::Search(const MatType& querySet,
 
 template<typename MatType>
 template<typename Archive>
-void QDAFN<MatType>::serialize(Archive& ar, const unsigned int /* version */)
+void QDAFN<MatType>::serialize(Archive& ar, const unsigned int version)
 {
   ar & BOOST_SERIALIZATION_NVP(l);
   ar & BOOST_SERIALIZATION_NVP(m);
   ar & BOOST_SERIALIZATION_NVP(lines);
-  ar & BOOST_SERIALIZATION_NVP(projections);
-  ar & BOOST_SERIALIZATION_NVP(sIndices);
-  ar & BOOST_SERIALIZATION_NVP(sValues);
+
+  // Backward compatibility: older versions stored the projections of every
+  // reference point, and the values of S in double precision.
+  if (Archive::is_loading::value && version == 0)
+  {
+    arma::mat projections, oldSValues;
+    ar & BOOST_SERIALIZATION_NVP(projections);
+    ar & BOOST_SERIALIZATION_NVP(sIndices);
+    ar & boost::serialization::make_nvp("sValues", oldSValues);
+    sValues = arma::conv_to<arma::fmat>::from(oldSValues);
+  }
+  else
+  {
+    ar & BOOST_SERIALIZATION_NVP(sIndices);
+    ar & BOOST_SERIALIZATION_NVP(sValues);
+  }
+
+  // A model that only stores the indices of its candidates saves copies of
+  // them, so that it can be loaded without the reference set.
+  if (Archive::is_saving::value && referenceSet != NULL)
+  {
+    std::vector<MatType> candidateSet(l);
+    for (size_t i = 0; i < l; ++i)
+    {
+      candidateSet[i].set_size(referenceSet->n_rows, m);
+      for (size_t j = 0; j < m; ++j)
+        candidateSet[i].col(j) = referenceSet->col(sIndices(j, i));
+    }
+    ar & BOOST_SERIALIZATION_NVP(candidateSet);
+  }
+  else
+  {
+    if (Archive::is_loading::value)
+      candidateSet.clear();
+    ar & BOOST_SERIALIZATION_NVP(candidateSet);
+  }
+
   if (Archive::is_loading::value)
-    candidateSet.clear();
-  ar & BOOST_SERIALIZATION_NVP(candidateSet);
+  {
+    storeCandidates = true;
+    referenceSet = NULL;
+  }
 }
 
 } // namespace neighbor
@@ -19,6 +19,7 @@
 #include <mlpack/methods/cf/cf.hpp>
 
 #include "bias_svd_function.hpp"
+#include <mlpack/methods/regularized_svd/stratified_sgd.hpp>
 
 namespace mlpack {
 namespace svd {
@@ -59,7 +60,9 @@ class BiasSVD
  public:
   /**
    * Constructor of Bias SVD. By default SGD optimizer is used in BiasSVD.
-   * The optimizer uses a template specialization of Optimize().
+   * The optimizer uses a template specialization of Optimize().  If
+   * OptimizerType is StratifiedSGD, the ratings are processed in parallel in
+   * conflict-free blocks instead.
    *
    * @param iterations Number of optimization iterations.
    * @param alpha Learning rate for the SGD optimizer.
@@ -87,6 +90,15 @@ class BiasSVD
              arma::vec& q);
 
  private:
+  //! Optimize the parameters with SGD (batch size 1).
+  void Optimize(BiasSVDFunction<arma::mat>& function,
+                arma::mat& parameters,
+                std::false_type /* stratified */) const;
+  //! Optimize the parameters with StratifiedSGD.
+  void Optimize(BiasSVDFunction<arma::mat>& function,
+                arma::mat& parameters,
+                std::true_type /* stratified */) const;
+
   //! Number of optimization iterations.
   size_t iterations;
   //! Learning rate for the SGD optimizer.
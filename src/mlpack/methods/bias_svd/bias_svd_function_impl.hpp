@@ -178,6 +178,35 @@ void BiasSVDFunction<MatType>::Gradient(const arma::mat& parameters,
   }
 }
 
+template <typename MatType>
+void BiasSVDFunction<MatType>::Step(arma::mat& parameters,
+                                    const size_t i,
+                                    const double stepSize) const
+{
+  // Indices for accessing the correct parameter columns.
+  const size_t user = data(0, i);
+  const size_t item = data(1, i) + numUsers;
+
+  // Prediction error for the example.
+  double* userColumn = parameters.colptr(user);
+  double* itemColumn = parameters.colptr(item);
+  double ratingError = data(2, i) - userColumn[rank] - itemColumn[rank];
+  for (size_t r = 0; r < rank; ++r)
+    ratingError -= userColumn[r] * itemColumn[r];
+
+  // Both updates are computed from the parameters before the step.
+  for (size_t r = 0; r < rank; ++r)
+  {
+    const double userValue = userColumn[r];
+    userColumn[r] -= stepSize * 2 * (lambda * userValue -
+        ratingError * itemColumn[r]);
+    itemColumn[r] -= stepSize * 2 * (lambda * itemColumn[r] -
+        ratingError * userValue);
+  }
+  userColumn[rank] -= stepSize * 2 * (lambda * userColumn[rank] - ratingError);
+  itemColumn[rank] -= stepSize * 2 * (lambda * itemColumn[rank] - ratingError);
+}
+
 } // namespace svd
 } // namespace mlpack
 
@@ -36,20 +36,11 @@ void BiasSVD<OptimizerType>::Apply(const arma::mat& data,
                                    arma::vec& p,
                                    arma::vec& q)
 {
-  // batchSize is 1 in our implementation of Bias SVD.
-  // batchSize other than 1 has not been supported yet.
-  const int batchSize = 1;
-  Log::Warn << "The batch size for optimizing BiasSVD is 1."
-      << std::endl;
-
-  // Make the optimizer object using a BiasSVDFunction object.
+  // Make the function object and optimize the parameters.
   BiasSVDFunction<arma::mat> biasSVDFunc(data, rank, lambda);
-  ens::StandardSGD optimizer(alpha, batchSize,
-      iterations * data.n_cols);
-
-  // Get optimized parameters.
   arma::mat parameters = biasSVDFunc.GetInitialPoint();
-  optimizer.Optimize(biasSVDFunc, parameters);
+  Optimize(biasSVDFunc, parameters,
+      std::is_same<OptimizerType, StratifiedSGD>());
 
   // Constants for extracting user and item matrices.
   const size_t numUsers = max(data.row(0)) + 1;
@@ -63,6 +54,34 @@ void BiasSVD<OptimizerType>::Apply(const arma::mat& data,
   q = parameters.row(rank).subvec(0, numUsers - 1).t();
 }
 
+template<typename OptimizerType>
+void BiasSVD<OptimizerType>::Optimize(
+    BiasSVDFunction<arma::mat>& function,
+    arma::mat& parameters,
+    std::false_type /* stratified */) const
+{
+  // batchSize is 1 in our implementation of Bias SVD.
+  // batchSize other than 1 has not been supported yet.
+  const int batchSize = 1;
+  Log::Warn << "The batch size for optimizing BiasSVD is 1."
+      << std::endl;
+
+  ens::StandardSGD optimizer(alpha, batchSize,
+      iterations * function.NumFunctions());
+  optimizer.Optimize(function, parameters);
+}
+
+template<typename OptimizerType>
+void BiasSVD<OptimizerType>::Optimize(
+    BiasSVDFunction<arma::mat>& function,
+    arma::mat& parameters,
+    std::true_type /* stratified */) const
+{
+  // Each epoch is one pass over the data, like the iterations of SGD.
+  StratifiedSGD optimizer(alpha, iterations);
+  optimizer.Optimize(function, parameters);
+}
+
 } // namespace svd
 } // namespace mlpack
 
@@ -12,6 +12,8 @@
 
 #include "randomized_block_krylov_svd.hpp"
 
+#include <mlpack/core/math/lin_alg.hpp>
+
 namespace mlpack {
 namespace svd {
 
@@ -43,13 +45,17 @@ RandomizedBlockKrylovSVD::RandomizedBlockKrylovSVD(const size_t maxIterations,
   /* Nothing to do here */
 }
 
-void RandomizedBlockKrylovSVD::Apply(const arma::mat& data,
-                                     arma::mat& u,
-                                     arma::vec& s,
-                                     arma::mat& v,
-                                     const size_t rank)
+template<typename TimesType, typename TransTimesType>
+void RandomizedBlockKrylovSVD::Factorize(const size_t nRows,
+                                         const size_t nCols,
+                                         TimesType times,
+                                         TransTimesType transTimes,
+                                         arma::mat& u,
+                                         arma::vec& s,
+                                         arma::mat& v,
+                                         const size_t rank)
 {
-  arma::mat Q, R, block, blockIteration;
+  arma::mat Q, R, block;
 
   if (blockSize == 0)
   {
@@ -57,34 +63,28 @@ void RandomizedBlockKrylovSVD::Apply(const arma::mat& data,
   }
 
   // Random block initialization.
-  arma::mat G = arma::randn(data.n_cols, blockSize);
-
-  // Construct and orthonormalize Krylov subspace.
-  arma::mat K(data.n_rows, blockSize * (maxIterations + 1));
+  arma::mat G = arma::randn(nCols, blockSize);
 
-  // Create a working matrix using data from writable auxiliary memory
-  // (K matrix). Doing so avoids an uncessary copy in upcoming step.
-  block = arma::mat(K.memptr(), data.n_rows, blockSize, false, false);
-  arma::qr_econ(block, R, data * G);
+  // Construct and orthonormalize Krylov subspace, one block at a time.
+  arma::mat K(nRows, blockSize * (maxIterations + 1));
+  block = times(G);
+  math::OrthonormalizeColumns(block);
+  K.cols(0, blockSize - 1) = block;
 
-  for (size_t blockOffset = block.n_elem; blockOffset < K.n_elem;
-      blockOffset += block.n_elem)
+  for (size_t i = 1; i <= maxIterations; ++i)
   {
-    // Temporary working matrix to store the result in the correct place.
-    blockIteration = arma::mat(K.memptr() + blockOffset, block.n_rows,
-        block.n_cols, false, false);
-
-    arma::qr_econ(blockIteration, R, data * (data.t() * block));
-
-    // Update working matrix for the next iteration.
-    block = arma::mat(K.memptr() + blockOffset, block.n_rows, block.n_cols,
-        false, false);
+    block = times(transTimes(block));
+    math::OrthonormalizeColumns(block);
+    K.cols(i * blockSize, (i + 1) * blockSize - 1) = block;
   }
 
+  // The blocks are orthonormal, but not orthogonal to each other, and the
+  // Krylov subspace may be close to rank-deficient, so use the Householder QR
+  // decomposition here.
   arma::qr_econ(Q, R, K);
 
   // Approximate eigenvalues and eigenvectors using Rayleigh–Ritz method.
-  arma::svd_econ(u, s, v, Q.t() * data);
+  arma::svd_econ(u, s, v, arma::mat(arma::trans(transTimes(Q))));
 
   // Do economical singular value decomposition and compute only the
   // approximations of the left singular vectors by using the centered data
@@ -92,5 +92,67 @@ void RandomizedBlockKrylovSVD::Apply(const arma::mat& data,
   u = Q * u;
 }
 
+void RandomizedBlockKrylovSVD::Apply(const arma::mat& data,
+                                     arma::mat& u,
+                                     arma::vec& s,
+                                     arma::mat& v,
+                                     const size_t rank)
+{
+  auto times = [&](const arma::mat& q) { return arma::mat(data * q); };
+  auto transTimes = [&](const arma::mat& q)
+  {
+    return arma::mat(data.t() * q);
+  };
+
+  Factorize(data.n_rows, data.n_cols, times, transTimes, u, s, v, rank);
+}
+
+void RandomizedBlockKrylovSVD::Apply(const arma::sp_mat& data,
+                                     arma::mat& u,
+                                     arma::vec& s,
+                                     arma::mat& v,
+                                     const size_t rank)
+{
+  Apply(data, u, s, v, rank, arma::zeros<arma::vec>(data.n_rows));
+}
+
+void RandomizedBlockKrylovSVD::Apply(const arma::sp_mat& data,
+                                     arma::mat& u,
+                                     arma::vec& s,
+                                     arma::mat& v,
+                                     const size_t rank,
+                                     const arma::vec& rowMean)
+{
+  if (rowMean.n_elem != data.n_rows)
+  {
+    std::ostringstream oss;
+    oss << "RandomizedBlockKrylovSVD::Apply(): mean has " << rowMean.n_elem
+        << " elements, but the data has " << data.n_rows << " rows";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // The products with the data are computed in parallel over its columns,
+  // which needs a transposed copy of the data for data * Q.  Each product
+  // with the centered data is the product with the data, minus a rank-one
+  // correction for the mean.
+  const arma::sp_mat dataT = data.t();
+  auto times = [&](const arma::mat& q)
+  {
+    arma::mat result;
+    math::SparseTransposeMultiply(dataT, q, result);
+    result -= rowMean * arma::sum(q, 0);
+    return result;
+  };
+  auto transTimes = [&](const arma::mat& q)
+  {
+    arma::mat result;
+    math::SparseTransposeMultiply(data, q, result);
+    result.each_row() -= rowMean.t() * q;
+    return result;
+  };
+
+  Factorize(data.n_rows, data.n_cols, times, transTimes, u, s, v, rank);
+}
+
 } // namespace svd
 } // namespace mlpack
@@ -104,6 +104,43 @@ class RandomizedBlockKrylovSVD
              arma::mat& v,
              const size_t rank);
 
+  /**
+   * Apply the randomized block krylov SVD to the given sparse matrix.  The
+   * products with the data are computed in parallel (if OpenMP is available),
+   * and the data is never densified.
+   *
+   * @param data Sparse data matrix.
+   * @param u First unitary matrix.
+   * @param v Second unitary matrix.
+   * @param s Diagonal matrix of singular values.
+   * @param rank Rank of the approximation.
+   */
+  void Apply(const arma::sp_mat& data,
+             arma::mat& u,
+             arma::vec& s,
+             arma::mat& v,
+             const size_t rank);
+
+  /**
+   * Apply the randomized block krylov SVD to the given sparse matrix minus
+   * rowMean (in each column), as needed for Principal Component Analysis.  The
+   * data is centered implicitly: the mean is applied as a rank-one correction
+   * of every product with the data, so it is never densified.
+   *
+   * @param data Sparse data matrix.
+   * @param u First unitary matrix.
+   * @param v Second unitary matrix.
+   * @param s Diagonal matrix of singular values.
+   * @param rank Rank of the approximation.
+   * @param rowMean Mean to subtract from each column of the data.
+   */
+  void Apply(const arma::sp_mat& data,
+             arma::mat& u,
+             arma::vec& s,
+             arma::mat& v,
+             const size_t rank,
+             const arma::vec& rowMean);
+
   //! Get the number of iterations for the power method.
   size_t MaxIterations() const { return maxIterations; }
   //! Modify the number of iterations for the power method.
@@ -115,6 +152,21 @@ class RandomizedBlockKrylovSVD
   size_t& BlockSize() { return blockSize; }
 
  private:
+  /**
+   * Run the randomized block krylov SVD on an implicitly given matrix A of the
+   * given size, where times(Q) computes A * Q and transTimes(Q) computes
+   * A^T * Q.
+   */
+  template<typename TimesType, typename TransTimesType>
+  void Factorize(const size_t nRows,
+                 const size_t nCols,
+                 TimesType times,
+                 TransTimesType transTimes,
+                 arma::mat& u,
+                 arma::vec& s,
+                 arma::mat& v,
+                 const size_t rank);
+
   //! Locally stored number of iterations for the power method.
   size_t maxIterations;
 
@@ -17,7 +17,10 @@
 #define MLPACK_METHODS_CF_CF_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+#include <mlpack/methods/fastmks/fastmks.hpp>
+#include <mlpack/core/kernels/linear_kernel.hpp>
 #include <mlpack/methods/amf/amf.hpp>
 #include <mlpack/methods/amf/update_rules/nmf_als.hpp>
 #include <mlpack/methods/amf/termination_policies/simple_residue_termination.hpp>
@@ -25,6 +28,7 @@
 #include <mlpack/methods/cf/decomposition_policies/nmf_method.hpp>
 #include <mlpack/methods/cf/neighbor_search_policies/lmetric_search.hpp>
 #include <mlpack/methods/cf/interpolation_policies/average_interpolation.hpp>
+#include <mlpack/methods/cf/cf_serving_model.hpp>
 #include <set>
 #include <map>
 #include <iostream>
@@ -182,6 +186,70 @@ class CFType
   //! Get the normalization object.
   const NormalizationType& Normalization() const { return normalization; }
 
+  /**
+   * Fold the given ratings of a user into the model without refactorizing the
+   * rating matrix.  The ratings are merged into the user's existing ratings
+   * (replacing earlier ratings of the same items), normalized, and the user's
+   * vector is recomputed against the fixed item vectors with the FoldIn()
+   * method of the decomposition policy (which the SVD, NMF and BiasSVD
+   * policies provide).  To add a new user, pass the current number of users
+   * as its ID.
+   *
+   * The item vectors do not change, so an item index built by BuildItemIndex()
+   * stays valid.  Other users' vectors and the normalization of other users
+   * are not updated, so the model should still be retrained from time to
+   * time.
+   *
+   * @param user ID of the user; at most the current number of users.
+   * @param ratings Ratings of the user, one element per item.
+   * @param lambda Regularization parameter for the user's vector.
+   */
+  void FoldIn(const size_t user,
+              const arma::sp_vec& ratings,
+              const double lambda = 0.02);
+
+  /**
+   * Build a FastMKS index (with the linear kernel) over the item vectors of
+   * the trained decomposition, so that GetRecommendations() retrieves only
+   * the items with the largest inner products with each user's interpolated
+   * vector, instead of scoring every item.  The decomposition policy must
+   * provide GetItemVectors() and GetWeightedUserVectors(), as the SVD, NMF and
+   * BiasSVD policies do; otherwise std::invalid_argument is thrown.
+   *
+   * The index is discarded by Train() and is not serialized, so it has to be
+   * built again after training or loading a model.  The recommendations are
+   * the same as without the index, unless the normalization adds item-specific
+   * offsets (ItemMeanNormalization or CombinedNormalization), in which case
+   * the candidates are only ranked by the normalized ratings.
+   */
+  void BuildItemIndex();
+
+  //! Return whether GetRecommendations() answers queries with an item index.
+  bool HasItemIndex() const { return hasItemIndex; }
+
+  /**
+   * Save a compact, read-only copy of the model for serving recommendations,
+   * which CFServingModel maps into memory.  The interpolated vector of every
+   * user is computed with the given policies and stored in single precision,
+   * along with the item vectors, the denormalization, and the items each user
+   * has rated; the training ratings themselves are not stored.
+   *
+   * The decomposition policy must provide GetItemVectors() and
+   * GetWeightedUserVectors(), and the normalization must be of the form
+   * scale * rating + user term + item term (all of mlpack's normalizations
+   * are); otherwise std::invalid_argument is thrown.
+   *
+   * @tparam NeighborSearchPolicy The policy used to search neighbors of
+   *     query set in referece set.
+   * @tparam InterpolationPolicy The policy used to calculate interpolation
+   *     weights.
+   *
+   * @param filename File to save the serving model to.
+   */
+  template<typename NeighborSearchPolicy = EuclideanSearch,
+           typename InterpolationPolicy = AverageInterpolation>
+  void SaveServingModel(const std::string& filename) const;
+
   /**
    * Generates the given number of recommendations for all users.
    *
@@ -200,6 +268,13 @@ class CFType
 
   /**
    * Generates the given number of recommendations for the specified users.
+   * The interpolation weights of all users are computed first; then the users
+   * are processed in blocks, in parallel if OpenMP is available.  If the
+   * decomposition policy provides GetWeightedRatings(), the ratings of each
+   * block are computed with one matrix multiplication; otherwise
+   * GetRatingOfUser() is called for each neighbor.  The decomposition and
+   * normalization objects must be safe to use from several threads at once
+   * (all of mlpack's are).
    *
    * @tparam NeighborSearchPolicy The policy used to search neighbors of
    *     query set in referece set.
@@ -243,6 +318,12 @@ class CFType
    * have length equal to combinations.n_cols, and predictions[i] will be equal
    * to the prediction for the user/item combination in combinations.col(i).
    *
+   * The neighborhood and interpolation weights of each distinct user are
+   * computed once, and the combinations are then evaluated in parallel if
+   * OpenMP is available.  If the decomposition policy provides
+   * GetItemVectors(), each prediction is a single inner product of the item
+   * vector with the user's interpolated vector.
+   *
    * @tparam NeighborSearchPolicy The policy used to search neighbors of
    *     query set in referece set.
    * @tparam InterpolationPolicy The policy used to calculate interpolation
@@ -273,6 +354,14 @@ class CFType
   arma::sp_mat cleanedData;
   //! Data normalization object.
   NormalizationType normalization;
+  //! The FastMKS index over the item vectors, if hasItemIndex is true.
+  fastmks::FastMKS<kernel::LinearKernel> itemIndex;
+  //! Whether the item index has been built for the current decomposition.
+  bool hasItemIndex;
+
+  //! The number of users whose ratings are computed at once in
+  //! GetRecommendations().
+  static const size_t RecommendationBlockSize = 64;
 
   //! Candidate represents a possible recommendation (value, item).
   typedef std::pair<double, size_t> Candidate;
@@ -22,6 +22,191 @@
 namespace mlpack {
 namespace cf {
 
+/**
+ * This gives us a HasWeightedRatings object that we can use to tell whether or
+ * not a DecompositionPolicy can compute the ratings of many users at once.
+ */
+HAS_MEM_FUNC(GetWeightedRatings, HasWeightedRatingsCheck);
+
+/**
+ * 'value' is true if the DecompositionPolicy class has a member
+ * GetWeightedRatings(const arma::Mat<size_t>& neighborhood,
+ *     const arma::mat& weights, arma::mat& ratings) const.
+ */
+template<typename DecompositionPolicy>
+struct HasWeightedRatings
+{
+  static const bool value =
+    HasWeightedRatingsCheck<DecompositionPolicy,
+        void(DecompositionPolicy::*)(const arma::Mat<size_t>&,
+                                     const arma::mat&,
+                                     arma::mat&) const>::value;
+};
+
+//! Compute the weighted sums of the ratings of the neighbors of each user with
+//! one call to the decomposition policy, if it supports that.
+template<typename DecompositionPolicy>
+void GetWeightedRatings(
+    const DecompositionPolicy& decomposition,
+    const arma::Mat<size_t>& neighborhood,
+    const arma::mat& weights,
+    const size_t /* numItems */,
+    arma::mat& ratings,
+    const typename std::enable_if_t<
+        HasWeightedRatings<DecompositionPolicy>::value>* = 0)
+{
+  decomposition.GetWeightedRatings(neighborhood, weights, ratings);
+}
+
+//! Compute the weighted sums of the ratings of the neighbors of each user one
+//! neighbor at a time, if the decomposition policy can't do any better.
+template<typename DecompositionPolicy>
+void GetWeightedRatings(
+    const DecompositionPolicy& decomposition,
+    const arma::Mat<size_t>& neighborhood,
+    const arma::mat& weights,
+    const size_t numItems,
+    arma::mat& ratings,
+    const typename std::enable_if_t<
+        !HasWeightedRatings<DecompositionPolicy>::value>* = 0)
+{
+  ratings.zeros(numItems, neighborhood.n_cols);
+  arma::vec neighborRatings;
+  for (size_t i = 0; i < neighborhood.n_cols; ++i)
+  {
+    for (size_t j = 0; j < neighborhood.n_rows; ++j)
+    {
+      decomposition.GetRatingOfUser(neighborhood(j, i), neighborRatings);
+      ratings.col(i) += weights(j, i) * neighborRatings;
+    }
+  }
+}
+
+/**
+ * This gives us a HasItemVectors object that we can use to tell whether or not
+ * the ratings of a DecompositionPolicy are inner products of item and user
+ * vectors.
+ */
+HAS_MEM_FUNC(GetItemVectors, HasItemVectorsCheck);
+
+/**
+ * 'value' is true if the DecompositionPolicy class has a member
+ * GetItemVectors(arma::mat& itemVectors) const (and then also
+ * GetWeightedUserVectors()).
+ */
+template<typename DecompositionPolicy>
+struct HasItemVectors
+{
+  static const bool value =
+    HasItemVectorsCheck<DecompositionPolicy,
+        void(DecompositionPolicy::*)(arma::mat&) const>::value;
+};
+
+//! Get the item vectors of the decomposition policy, if it has them.
+template<typename DecompositionPolicy>
+void GetItemVectors(
+    const DecompositionPolicy& decomposition,
+    arma::mat& itemVectors,
+    const typename std::enable_if_t<
+        HasItemVectors<DecompositionPolicy>::value>* = 0)
+{
+  decomposition.GetItemVectors(itemVectors);
+}
+
+//! Throw an exception, since the decomposition policy has no item vectors.
+template<typename DecompositionPolicy>
+void GetItemVectors(
+    const DecompositionPolicy& /* decomposition */,
+    arma::mat& /* itemVectors */,
+    const typename std::enable_if_t<
+        !HasItemVectors<DecompositionPolicy>::value>* = 0)
+{
+  throw std::invalid_argument("CFType::BuildItemIndex(): the decomposition "
+      "policy does not provide item vectors");
+}
+
+//! Get the weighted user vectors of the decomposition policy, if it has them.
+template<typename DecompositionPolicy>
+void GetWeightedUserVectors(
+    const DecompositionPolicy& decomposition,
+    const arma::Mat<size_t>& neighborhood,
+    const arma::mat& weights,
+    arma::mat& userVectors,
+    const typename std::enable_if_t<
+        HasItemVectors<DecompositionPolicy>::value>* = 0)
+{
+  decomposition.GetWeightedUserVectors(neighborhood, weights, userVectors);
+}
+
+//! Throw an exception, since the decomposition policy has no user vectors.
+template<typename DecompositionPolicy>
+void GetWeightedUserVectors(
+    const DecompositionPolicy& /* decomposition */,
+    const arma::Mat<size_t>& /* neighborhood */,
+    const arma::mat& /* weights */,
+    arma::mat& /* userVectors */,
+    const typename std::enable_if_t<
+        !HasItemVectors<DecompositionPolicy>::value>* = 0)
+{
+  throw std::invalid_argument("CFType::GetRecommendations(): the "
+      "decomposition policy does not provide user vectors");
+}
+
+//! Predict the rating of each user/item combination as the inner product of
+//! the item vector and the interpolated user vector, if the decomposition
+//! policy has them.  userIndices[i] is the column of neighborhood and weights
+//! for the user of combination i.
+template<typename DecompositionPolicy>
+void PredictCombinations(
+    const DecompositionPolicy& decomposition,
+    const arma::Mat<size_t>& neighborhood,
+    const arma::mat& weights,
+    const arma::Mat<size_t>& combinations,
+    const arma::Col<size_t>& userIndices,
+    arma::vec& predictions,
+    const typename std::enable_if_t<
+        HasItemVectors<DecompositionPolicy>::value>* = 0)
+{
+  arma::mat itemVectors, userVectors;
+  decomposition.GetItemVectors(itemVectors);
+  decomposition.GetWeightedUserVectors(neighborhood, weights, userVectors);
+
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) combinations.n_cols; ++i)
+  {
+    predictions[i] = arma::dot(itemVectors.col(combinations(1, i)),
+        userVectors.col(userIndices[i]));
+  }
+}
+
+//! Predict the rating of each user/item combination as the weighted sum of
+//! the ratings of the user's neighbors, if the decomposition policy can't do
+//! any better.
+template<typename DecompositionPolicy>
+void PredictCombinations(
+    const DecompositionPolicy& decomposition,
+    const arma::Mat<size_t>& neighborhood,
+    const arma::mat& weights,
+    const arma::Mat<size_t>& combinations,
+    const arma::Col<size_t>& userIndices,
+    arma::vec& predictions,
+    const typename std::enable_if_t<
+        !HasItemVectors<DecompositionPolicy>::value>* = 0)
+{
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) combinations.n_cols; ++i)
+  {
+    const size_t user = userIndices[i];
+    double rating = 0.0;
+    for (size_t j = 0; j < neighborhood.n_rows; ++j)
+    {
+      rating += weights(j, user) * decomposition.GetRating(
+          neighborhood(j, user), combinations(1, i));
+    }
+    predictions[i] = rating;
+  }
+}
+
 // Default CF constructor.
 template<typename DecompositionPolicy,
          typename NormalizationType>
@@ -30,7 +215,8 @@ CFType<DecompositionPolicy,
 CFType(const size_t numUsersForSimilarity,
        const size_t rank) :
     numUsersForSimilarity(numUsersForSimilarity),
-    rank(rank)
+    rank(rank),
+    hasItemIndex(false)
 {
   // Validate neighbourhood size.
   if (numUsersForSimilarity < 1)
@@ -58,7 +244,8 @@ CFType(const MatType& data,
        const double minResidue,
        const bool mit) :
     numUsersForSimilarity(numUsersForSimilarity),
-    rank(rank)
+    rank(rank),
+    hasItemIndex(false)
 {
   // Validate neighbourhood size.
   if (numUsersForSimilarity < 1)
@@ -84,6 +271,7 @@ Train(const arma::mat& data,
       const bool mit)
 {
   this->decomposition = decomposition;
+  hasItemIndex = false;
 
   // Make a copy of data before performing normalization.
   arma::mat normalizedData(data);
@@ -125,6 +313,7 @@ Train(const arma::sp_mat& data,
       const bool mit)
 {
   this->decomposition = decomposition;
+  hasItemIndex = false;
 
   // data is not used in the following decomposition.Apply() method, so we only
   // need to Normalize cleanedData.
@@ -154,6 +343,151 @@ Train(const arma::sp_mat& data,
   Timer::Stop("cf_factorization");
 }
 
+template<typename DecompositionPolicy,
+         typename NormalizationType>
+void CFType<DecompositionPolicy,
+            NormalizationType>::
+FoldIn(const size_t user,
+       const arma::sp_vec& ratings,
+       const double lambda)
+{
+  if (user > cleanedData.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "CFType::FoldIn(): user ID " << user << " is not an existing user "
+        << "or the next new user (" << cleanedData.n_cols << ")";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (ratings.n_elem != cleanedData.n_rows)
+  {
+    std::ostringstream oss;
+    oss << "CFType::FoldIn(): ratings have " << ratings.n_elem << " items, "
+        << "but the model has " << cleanedData.n_rows;
+    throw std::invalid_argument(oss.str());
+  }
+
+  // Collect the raw ratings of the user: the existing ones (denormalized), and
+  // then the given ones, which take precedence.
+  std::map<size_t, double> rawRatings;
+  if (user < cleanedData.n_cols)
+  {
+    const arma::sp_mat& data = cleanedData;
+    arma::sp_mat::const_iterator it = data.begin_col(user);
+    for (; it != data.end_col(user); ++it)
+      rawRatings[it.row()] = normalization.Denormalize(user, it.row(), *it);
+  }
+
+  arma::sp_vec::const_iterator it = ratings.begin();
+  for (; it != ratings.end(); ++it)
+    rawRatings[it.row()] = *it;
+
+  arma::umat locations(2, rawRatings.size());
+  arma::vec values(rawRatings.size());
+  size_t i = 0;
+  for (std::map<size_t, double>::const_iterator r = rawRatings.begin();
+       r != rawRatings.end(); ++r, ++i)
+  {
+    locations(0, i) = r->first;
+    locations(1, i) = 0;
+    values(i) = r->second;
+  }
+
+  arma::sp_vec userRatings(arma::sp_mat(locations, values, cleanedData.n_rows,
+      1));
+  normalization.NormalizeUser(user, userRatings);
+
+  // Store the user's ratings, and recompute its vector.
+  if (user == cleanedData.n_cols)
+    cleanedData.resize(cleanedData.n_rows, user + 1);
+  cleanedData.col(user) = userRatings;
+
+  decomposition.FoldIn(user, userRatings, lambda);
+}
+
+template<typename DecompositionPolicy,
+         typename NormalizationType>
+void CFType<DecompositionPolicy,
+            NormalizationType>::
+BuildItemIndex()
+{
+  arma::mat itemVectors;
+  GetItemVectors(decomposition, itemVectors);
+
+  Timer::Start("cf_item_index");
+  itemIndex.Train(std::move(itemVectors));
+  Timer::Stop("cf_item_index");
+
+  hasItemIndex = true;
+}
+
+template<typename DecompositionPolicy,
+         typename NormalizationType>
+template<typename NeighborSearchPolicy,
+         typename InterpolationPolicy>
+void CFType<DecompositionPolicy,
+            NormalizationType>::
+SaveServingModel(const std::string& filename) const
+{
+  if (!HasItemVectors<DecompositionPolicy>::value)
+    throw std::invalid_argument("CFType::SaveServingModel(): the "
+        "decomposition policy does not provide item vectors");
+
+  const size_t numUsers = cleanedData.n_cols;
+  const size_t numItems = cleanedData.n_rows;
+
+  // Interpolate the vector of every user, as GetRecommendations() does.
+  arma::Col<size_t> users = arma::linspace<arma::Col<size_t> >(0,
+      numUsers - 1, numUsers);
+  arma::Mat<size_t> neighborhood;
+  arma::mat similarities;
+  decomposition.template GetNeighborhood<NeighborSearchPolicy>(
+      users, numUsersForSimilarity, neighborhood, similarities);
+
+  InterpolationPolicy interpolation(cleanedData);
+  arma::mat weights(numUsersForSimilarity, numUsers);
+  for (size_t i = 0; i < numUsers; i++)
+  {
+    interpolation.GetWeights(weights.col(i), decomposition, users(i),
+        neighborhood.col(i), similarities.col(i), cleanedData);
+  }
+
+  arma::mat itemVectors, userVectors;
+  GetItemVectors(decomposition, itemVectors);
+  GetWeightedUserVectors(decomposition, neighborhood, weights, userVectors);
+
+  // Recover the terms of the denormalization, which is affine in the rating:
+  // Denormalize(u, i, r) = scale * r + (user term of u) + (item term of i).
+  const double base = normalization.Denormalize(0, 0, 0.0);
+  const double scale = normalization.Denormalize(0, 0, 1.0) - base;
+  arma::vec itemTerms(numItems), userTerms(numUsers);
+  for (size_t i = 0; i < numItems; ++i)
+    itemTerms[i] = normalization.Denormalize(0, i, 0.0);
+  for (size_t u = 0; u < numUsers; ++u)
+    userTerms[u] = normalization.Denormalize(u, 0, 0.0) - base;
+
+  // Check the decomposition on some combinations, in case the normalization
+  // is not of that form.
+  for (size_t k = 0; k < 10; ++k)
+  {
+    const size_t u = math::RandInt(numUsers);
+    const size_t i = math::RandInt(numItems);
+    const double rating = math::Random(-1.0, 1.0);
+    const double expected = normalization.Denormalize(u, i, rating);
+    const double actual = scale * rating + itemTerms[i] + userTerms[u];
+    if (std::abs(expected - actual) > 1e-8 * std::max(1.0,
+        std::abs(expected)))
+    {
+      throw std::invalid_argument("CFType::SaveServingModel(): the "
+          "normalization is not affine in the rating");
+    }
+  }
+
+  CFServingModel::Save(filename, arma::conv_to<arma::fmat>::from(itemVectors),
+      arma::conv_to<arma::fmat>::from(userVectors), scale, itemTerms,
+      userTerms, cleanedData);
+}
+
 template<typename DecompositionPolicy,
          typename NormalizationType>
 template<typename NeighborSearchPolicy,
@@ -201,72 +535,170 @@ GetRecommendations(const size_t numRecs,
   // Generate recommendations for each query user by finding the maximum numRecs
   // elements in the ratings vector.
   recommendations.set_size(numRecs, users.n_elem);
-  arma::mat values(numRecs, users.n_elem);
   recommendations.fill(SIZE_MAX);
-  values.fill(DBL_MAX);
 
   // Initialization of an InterpolationPolicy object should be put ahead of the
   // following loop, because the initialization may takes a relatively long
   // time and we don't want to repeat the initialization process in each loop.
   InterpolationPolicy interpolation(cleanedData);
 
+  // Calculate interpolation weights.  Some interpolation policies cache
+  // results between calls, so this is done serially.
+  arma::mat weights(numUsersForSimilarity, users.n_elem);
   for (size_t i = 0; i < users.n_elem; i++)
   {
-    // First, calculate the weighted sum of neighborhood values.
-    arma::vec ratings;
-    ratings.zeros(cleanedData.n_rows);
-
-    // Calculate interpolation weights.
-    arma::vec weights(numUsersForSimilarity);
-    interpolation.GetWeights(weights, decomposition, users(i),
+    interpolation.GetWeights(weights.col(i), decomposition, users(i),
         neighborhood.col(i), similarities.col(i), cleanedData);
+  }
 
-    for (size_t j = 0; j < neighborhood.n_rows; ++j)
-    {
-      arma::vec neighborRatings;
-      decomposition.GetRatingOfUser(neighborhood(j, i), neighborRatings);
-      ratings += weights(j) * neighborRatings;
-    }
+  // The threads only read the rating table, so they use a const reference.
+  const arma::sp_mat& ratedItems = cleanedData;
 
-    // Let's build the list of candidate recomendations for the given user.
-    // Default candidate: the smallest possible value and invalid item number.
-    const Candidate def = std::make_pair(-DBL_MAX, cleanedData.n_rows);
-    std::vector<Candidate> vect(numRecs, def);
-    typedef std::priority_queue<Candidate, std::vector<Candidate>, CandidateCmp>
-        CandidateList;
-    CandidateList pqueue(CandidateCmp(), std::move(vect));
+  // Default candidate: the smallest possible value and invalid item number.
+  const Candidate def = std::make_pair(-DBL_MAX, cleanedData.n_rows);
 
-    // Look through the ratings column corresponding to the current user.
-    for (size_t j = 0; j < ratings.n_rows; ++j)
+  const size_t numBlocks = (users.n_elem + RecommendationBlockSize - 1) /
+      RecommendationBlockSize;
+
+  // With an item index, only the items with the largest inner products with
+  // each user's vector are candidates.  FastMKS searches can't run
+  // concurrently, so the blocks are searched one after another.
+  if (hasItemIndex)
+  {
+    std::vector<Candidate> candidates;
+    candidates.reserve(numRecs);
+    for (size_t b = 0; b < numBlocks; ++b)
     {
-      // Ensure that the user hasn't already rated the item.
-      // The algorithm omits rating of zero. Thus, when normalizing original
-      // ratings in Normalize(), if normalized rating equals zero, it is set
-      // to the smallest positive double value.
-      if (cleanedData(j, users(i)) != 0.0)
-        continue; // The user already rated the item.
-
-      // Is the estimated value better than the worst candidate?
-      // Denormalize rating before comparison.
-      double realRating = normalization.Denormalize(users(i), j, ratings[j]);
-      if (realRating > pqueue.top().first)
+      const size_t begin = b * RecommendationBlockSize;
+      const size_t end = std::min(begin + RecommendationBlockSize,
+          (size_t) users.n_elem);
+
+      arma::mat userVectors;
+      GetWeightedUserVectors(decomposition, neighborhood.cols(begin, end - 1),
+          weights.cols(begin, end - 1), userVectors);
+
+      // Ask for enough items that numRecs are left for every user of the
+      // block once the items the user already rated are removed.
+      size_t k = numRecs;
+      for (size_t i = begin; i < end; ++i)
+        k = std::max(k, numRecs + (size_t) ratedItems.col(users(i)).n_nonzero);
+      k = std::min(k, (size_t) ratedItems.n_rows);
+
+      arma::Mat<size_t> items;
+      arma::mat products;
+      itemIndex.Search(userVectors, k, items, products);
+
+      for (size_t i = begin; i < end; ++i)
       {
-        Candidate c = std::make_pair(realRating, j);
-        pqueue.pop();
-        pqueue.push(c);
+        const size_t user = users(i);
+        candidates.assign(numRecs, def);
+        for (size_t j = 0; j < k; ++j)
+        {
+          const size_t item = items(j, i - begin);
+          if (ratedItems(item, user) != 0.0)
+            continue; // The user already rated the item.
+
+          // The normalization may reorder the candidates, so they are ranked
+          // by their denormalized ratings.
+          double realRating = normalization.Denormalize(user, item,
+              products(j, i - begin));
+          if (realRating > candidates.front().first)
+          {
+            std::pop_heap(candidates.begin(), candidates.end(),
+                CandidateCmp());
+            candidates.back() = std::make_pair(realRating, item);
+            std::push_heap(candidates.begin(), candidates.end(),
+                CandidateCmp());
+          }
+        }
+
+        for (size_t p = 1; p <= numRecs; p++)
+        {
+          recommendations(numRecs - p, i) = candidates.front().second;
+          std::pop_heap(candidates.begin(), candidates.end() - (p - 1),
+              CandidateCmp());
+        }
       }
     }
-
-    for (size_t p = 1; p <= numRecs; p++)
+  }
+  else
+  {
+    // Without an index, compute the ratings of each block of users, and find
+    // the best candidates for each user of the block.  Each thread keeps its
+    // own ratings and candidate list.
+    #pragma omp parallel
     {
-      recommendations(numRecs - p, i) = pqueue.top().second;
-      values(numRecs - p, i) = pqueue.top().first;
-      pqueue.pop();
+      arma::mat ratings;
+      std::vector<Candidate> candidates;
+      candidates.reserve(numRecs);
+
+      #pragma omp for schedule(dynamic)
+      for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+      {
+        const size_t begin = b * RecommendationBlockSize;
+        const size_t end = std::min(begin + RecommendationBlockSize,
+            (size_t) users.n_elem);
+
+        // First, calculate the weighted sum of neighborhood values.
+        GetWeightedRatings(decomposition, neighborhood.cols(begin, end - 1),
+            weights.cols(begin, end - 1), cleanedData.n_rows, ratings);
+
+        for (size_t i = begin; i < end; ++i)
+        {
+          const size_t user = users(i);
+          const double* userRatings = ratings.colptr(i - begin);
+
+          // Let's build the list of candidate recomendations for the given
+          // user.  This is a heap with the worst candidate on top.
+          candidates.assign(numRecs, def);
+
+          // Look through the ratings column corresponding to the current user.
+          // The algorithm omits rating of zero. Thus, when normalizing
+          // original ratings in Normalize(), if normalized rating equals zero,
+          // it is set to the smallest positive double value.  So the items the
+          // user has already rated are exactly the nonzero elements of the
+          // user's column, which we walk alongside the items.
+          arma::sp_mat::const_iterator it = ratedItems.begin_col(user);
+          const arma::sp_mat::const_iterator itEnd = ratedItems.end_col(user);
+          for (size_t j = 0; j < ratedItems.n_rows; ++j)
+          {
+            // Ensure that the user hasn't already rated the item.
+            if (it != itEnd && it.row() == j)
+            {
+              ++it;
+              continue; // The user already rated the item.
+            }
+
+            // Is the estimated value better than the worst candidate?
+            // Denormalize rating before comparison.
+            double realRating = normalization.Denormalize(user, j,
+                userRatings[j]);
+            if (realRating > candidates.front().first)
+            {
+              std::pop_heap(candidates.begin(), candidates.end(),
+                  CandidateCmp());
+              candidates.back() = std::make_pair(realRating, j);
+              std::push_heap(candidates.begin(), candidates.end(),
+                  CandidateCmp());
+            }
+          }
+
+          for (size_t p = 1; p <= numRecs; p++)
+          {
+            recommendations(numRecs - p, i) = candidates.front().second;
+            std::pop_heap(candidates.begin(), candidates.end() - (p - 1),
+                CandidateCmp());
+          }
+        }
+      }
     }
+  }
 
-    // If we were not able to come up with enough recommendations, issue a
-    // warning.
-    if (recommendations(numRecs - 1, i) == def.second)
+  // If we were not able to come up with enough recommendations, issue a
+  // warning.
+  for (size_t i = 0; i < users.n_elem; i++)
+  {
+    if (numRecs > 0 && recommendations(numRecs - 1, i) == def.second)
       Log::Warn << "Could not provide " << numRecs << " recommendations "
           << "for user " << users(i) << " (not enough un-rated items)!"
           << std::endl;
@@ -327,15 +759,8 @@ void CFType<DecompositionPolicy,
 Predict(const arma::Mat<size_t>& combinations,
         arma::vec& predictions) const
 {
-  // Now, we must determine those query indices we need to find the nearest
-  // neighbors for.  This is easiest if we just sort the combinations matrix.
-  arma::Mat<size_t> sortedCombinations(combinations.n_rows,
-                                       combinations.n_cols);
-  arma::uvec ordering = arma::sort_index(combinations.row(0).t());
-  for (size_t i = 0; i < ordering.n_elem; ++i)
-    sortedCombinations.col(i) = combinations.col(ordering[i]);
-
-  // Now, we have to get the list of unique users we will be searching for.
+  // Get the (sorted) list of unique users we will be searching for, so that
+  // the neighborhood of each user is computed only once.
   arma::Col<size_t> users = arma::unique(combinations.row(0).t());
 
   // Temporary storage for neighborhood of the queried users.
@@ -361,29 +786,21 @@ Predict(const arma::Mat<size_t>& combinations,
         neighborhood.col(i), similarities.col(i), cleanedData);
   }
 
-  // Now that we have the neighborhoods we need, calculate the predictions.
-  predictions.set_size(combinations.n_cols);
-
-  size_t user = 0; // Cumulative user count, because we are doing it in order.
-  for (size_t i = 0; i < sortedCombinations.n_cols; ++i)
+  // Map the user of each combination to its column of neighborhood and
+  // weights.
+  arma::Col<size_t> userIndices(combinations.n_cols);
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) combinations.n_cols; ++i)
   {
-    // Could this be made faster by calculating dot products for multiple items
-    // at once?
-    double rating = 0.0;
-
-    // Map the combination's user to the user ID used for kNN.
-    while (users[user] < sortedCombinations(0, i))
-      ++user;
-
-    for (size_t j = 0; j < neighborhood.n_rows; ++j)
-    {
-      rating += weights(j, user) * decomposition.GetRating(
-          neighborhood(j, user), sortedCombinations(1, i));
-    }
-
-    predictions(ordering[i]) = rating;
+    userIndices[i] = std::lower_bound(users.begin(), users.end(),
+        combinations(0, i)) - users.begin();
   }
 
+  // Now that we have the neighborhoods we need, calculate the predictions.
+  predictions.set_size(combinations.n_cols);
+  PredictCombinations(decomposition, neighborhood, weights, combinations,
+      userIndices, predictions);
+
   // Denormalize ratings.
   normalization.Denormalize(combinations, predictions);
 }
@@ -436,6 +853,10 @@ serialize(Archive& ar, const unsigned int /* version */)
   ar & BOOST_SERIALIZATION_NVP(decomposition);
   ar & BOOST_SERIALIZATION_NVP(cleanedData);
   ar & BOOST_SERIALIZATION_NVP(normalization);
+
+  // The item index is not saved; it has to be built again.
+  if (Archive::is_loading::value)
+    hasItemIndex = false;
 }
 
 } // namespace cf
@@ -16,6 +16,7 @@
 
 #include "cf.hpp"
 #include "cf_model.hpp"
+#include "load_ratings.hpp"
 
 #include <mlpack/methods/cf/decomposition_policies/batch_svd_method.hpp>
 #include <mlpack/methods/cf/decomposition_policies/randomized_svd_method.hpp>
@@ -61,7 +62,10 @@ PROGRAM_INFO("Collaborative Filtering",
     "first dimension is the user, the second dimension is the item, and the "
     "third dimension is that user's rating of that item.  Both the users and "
     "items should be numeric indices, not names. The indices are assumed to "
-    "start from 0."
+    "start from 0.  Datasets too large to load into memory as a matrix may "
+    "be given as a file of (user, item, rating) lines with the " +
+    PRINT_PARAM_STRING("training_file") + " parameter instead; that file is "
+    "parsed in chunks directly into a sparse rating matrix."
     "\n\n"
     "A set of query users for which recommendations can be generated may be "
     "specified with the " + PRINT_PARAM_STRING("query") + " parameter; "
@@ -134,6 +138,11 @@ PROGRAM_INFO("Collaborative Filtering",
 
 // Parameters for training a model.
 PARAM_MATRIX_IN("training", "Input dataset to perform CF on.", "t");
+// Large datasets may instead be streamed from a file directly into a sparse
+// rating matrix.
+PARAM_STRING_IN("training_file", "File of (user, item, rating) lines to "
+    "perform CF on; it is parsed in chunks directly into a sparse rating "
+    "matrix, for datasets too large to load with --training.", "F", "");
 PARAM_STRING_IN("algorithm", "Algorithm used for matrix factorization.", "a",
     "NMF");
 PARAM_INT_IN("neighborhood", "Size of the neighborhood of similar users to "
@@ -364,8 +373,8 @@ void PerformAction(CFModel* c)
   CLI::GetParam<CFModel*>("output_model") = c;
 }
 
-template<typename DecompositionPolicy>
-void PerformAction(arma::mat& dataset,
+template<typename DecompositionPolicy, typename MatType>
+void PerformAction(MatType& dataset,
                    const size_t rank,
                    const size_t maxIterations,
                    const double minResidue)
@@ -378,8 +387,43 @@ void PerformAction(arma::mat& dataset,
   PerformAction(c);
 }
 
+// Decompositions that are trained on the coordinate list itself can use the
+// dataset as it is.
+template<typename DecompositionPolicy>
+void PerformCoordinateListAction(arma::mat& dataset,
+                                 const size_t rank,
+                                 const size_t maxIterations,
+                                 const double minResidue)
+{
+  PerformAction<DecompositionPolicy>(dataset, rank, maxIterations, minResidue);
+}
+
+// A sparse rating matrix has to be converted back to a coordinate list for
+// them.
+template<typename DecompositionPolicy>
+void PerformCoordinateListAction(arma::sp_mat& dataset,
+                                 const size_t rank,
+                                 const size_t maxIterations,
+                                 const double minResidue)
+{
+  arma::mat coordinates(3, dataset.n_nonzero);
+  size_t i = 0;
+  for (arma::sp_mat::const_iterator it = dataset.begin(); it != dataset.end();
+      ++it, ++i)
+  {
+    coordinates(0, i) = it.col();
+    coordinates(1, i) = it.row();
+    coordinates(2, i) = *it;
+  }
+  dataset.reset();
+
+  PerformAction<DecompositionPolicy>(coordinates, rank, maxIterations,
+      minResidue);
+}
+
+template<typename MatType>
 void AssembleFactorizerType(const std::string& algorithm,
-                            arma::mat& dataset,
+                            MatType& dataset,
                             const size_t rank)
 {
   const size_t maxIterations = (size_t) CLI::GetParam<int>("max_iterations");
@@ -406,7 +450,8 @@ void AssembleFactorizerType(const std::string& algorithm,
   {
     ReportIgnoredParam("min_residue", "Regularized SVD terminates only "
         "when max_iterations is reached");
-    PerformAction<RegSVDPolicy>(dataset, rank, maxIterations, minResidue);
+    PerformCoordinateListAction<RegSVDPolicy>(dataset, rank, maxIterations,
+        minResidue);
   }
   else if (algorithm == "RandSVD")
   {
@@ -419,13 +464,15 @@ void AssembleFactorizerType(const std::string& algorithm,
   {
     ReportIgnoredParam("min_residue", "Bias SVD terminates only "
         "when max_iterations is reached");
-    PerformAction<BiasSVDPolicy>(dataset, rank, maxIterations, minResidue);
+    PerformCoordinateListAction<BiasSVDPolicy>(dataset, rank, maxIterations,
+        minResidue);
   }
   else if (algorithm == "SVDPP")
   {
     ReportIgnoredParam("min_residue", "SVD++ terminates only "
         "when max_iterations is reached");
-    PerformAction<SVDPlusPlusPolicy>(dataset, rank, maxIterations, minResidue);
+    PerformCoordinateListAction<SVDPlusPlusPolicy>(dataset, rank,
+        maxIterations, minResidue);
   }
 }
 
@@ -437,7 +484,7 @@ static void mlpackMain()
     math::RandomSeed(CLI::GetParam<int>("seed"));
 
   // Validate parameters.
-  RequireOnlyOnePassed({ "training", "input_model" }, true);
+  RequireOnlyOnePassed({ "training", "training_file", "input_model" }, true);
 
   // Check that nothing stupid is happening.
   if (CLI::HasParam("query") || CLI::HasParam("all_user_recommendations"))
@@ -458,7 +505,7 @@ static void mlpackMain()
         "recommendations must be positive");
 
   // Either load from a model, or train a model.
-  if (CLI::HasParam("training"))
+  if (CLI::HasParam("training") || CLI::HasParam("training_file"))
   {
     // Train a model.
     // Validate Parameters.
@@ -472,26 +519,42 @@ static void mlpackMain()
     RequireParamValue<int>("neighborhood", [](int x) { return x > 0; }, true,
         "neighborhood must be positive");
 
-    // Read from the input file.
-    arma::mat dataset = std::move(CLI::GetParam<arma::mat>("training"));
-
-    RequireParamValue<int>("neighborhood",
-        [&dataset](int x) { return x <= max(dataset.row(0)) + 1; }, true,
-        "neighborbood must be less than or equal to the number of users");
-
-    // Recommendation matrix.
-    arma::Mat<size_t> recommendations;
-
     // Get parameters.
     const size_t rank = (size_t) CLI::GetParam<int>("rank");
-
-    // Perform decomposition to prepare for recommendations.
-    Log::Info << "Performing CF matrix decomposition on dataset..." << endl;
-
     const string algo = CLI::GetParam<string>("algorithm");
 
-    // Perform the factorization and do whatever the user wanted.
-    AssembleFactorizerType(algo, dataset, rank);
+    if (CLI::HasParam("training"))
+    {
+      // Read from the input file.
+      arma::mat dataset = std::move(CLI::GetParam<arma::mat>("training"));
+
+      RequireParamValue<int>("neighborhood",
+          [&dataset](int x) { return x <= max(dataset.row(0)) + 1; }, true,
+          "neighborbood must be less than or equal to the number of users");
+
+      // Perform decomposition to prepare for recommendations.
+      Log::Info << "Performing CF matrix decomposition on dataset..." << endl;
+
+      // Perform the factorization and do whatever the user wanted.
+      AssembleFactorizerType(algo, dataset, rank);
+    }
+    else
+    {
+      // Stream the input file into a sparse rating matrix.
+      arma::sp_mat dataset;
+      Timer::Start("loading_ratings");
+      LoadRatings(CLI::GetParam<string>("training_file"), dataset);
+      Timer::Stop("loading_ratings");
+
+      RequireParamValue<int>("neighborhood",
+          [&dataset](int x) { return x <= (int) dataset.n_cols; }, true,
+          "neighborbood must be less than or equal to the number of users");
+
+      Log::Info << "Performing CF matrix decomposition on " << dataset.n_nonzero
+          << " ratings..." << endl;
+
+      AssembleFactorizerType(algo, dataset, rank);
+    }
   }
   else
   {
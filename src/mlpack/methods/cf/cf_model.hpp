@@ -104,6 +104,27 @@ class RecommendationVisitor : public boost::static_visitor<void>
   void operator()(CFType<DecompositionPolicy>* c) const;
 };
 
+/**
+ * SaveServingModelVisitor uses the CFType object to save a serving model (see
+ * CFServingModel) to the given file.
+ */
+template <typename NeighborSearchPolicy,
+          typename InterpolationPolicy>
+class SaveServingModelVisitor : public boost::static_visitor<void>
+{
+ private:
+  //! File to save the serving model to.
+  const std::string& filename;
+
+ public:
+  //! Visitor constructor.
+  SaveServingModelVisitor(const std::string& filename);
+
+  //! Save the serving model.
+  template<typename DecompositionPolicy>
+  void operator()(CFType<DecompositionPolicy>* c) const;
+};
+
 /**
  * The model to save to disk.
  */
@@ -164,6 +185,11 @@ class CFModel
   void GetRecommendations(const size_t numRecs,
                           arma::Mat<size_t>& recommendations);
 
+  //! Save a serving model (see CFServingModel) to the given file.
+  template<typename NeighborSearchPolicy,
+           typename InterpolationPolicy>
+  void SaveServingModel(const std::string& filename) const;
+
   //! Serialize the model.
   template<typename Archive>
   void serialize(Archive& ar, const unsigned int /* version */);
@@ -93,6 +93,26 @@ void RecommendationVisitor<NeighborSearchPolicy, InterpolationPolicy>
         (numRecs, recommendations);
 }
 
+template <typename NeighborSearchPolicy,
+          typename InterpolationPolicy>
+SaveServingModelVisitor<NeighborSearchPolicy, InterpolationPolicy>
+        ::SaveServingModelVisitor(const std::string& filename) :
+    filename(filename)
+{ }
+
+template <typename NeighborSearchPolicy,
+          typename InterpolationPolicy>
+template<typename DecompositionPolicy>
+void SaveServingModelVisitor<NeighborSearchPolicy, InterpolationPolicy>
+        ::operator()(CFType<DecompositionPolicy>* c) const
+{
+  if (!c)
+    throw std::runtime_error("no cf model initialized");
+
+  c->template SaveServingModel<NeighborSearchPolicy, InterpolationPolicy>(
+      filename);
+}
+
 CFModel::~CFModel()
 {
   boost::apply_visitor(DeleteVisitor(), cf);
@@ -151,6 +171,16 @@ void CFModel::GetRecommendations(const size_t numRecs,
   boost::apply_visitor(recommendation, cf);
 }
 
+//! Save a serving model.
+template<typename NeighborSearchPolicy,
+         typename InterpolationPolicy>
+void CFModel::SaveServingModel(const std::string& filename) const
+{
+  SaveServingModelVisitor<NeighborSearchPolicy, InterpolationPolicy>
+      save(filename);
+  boost::apply_visitor(save, cf);
+}
+
 template<typename DecompositionPolicy>
 const CFType<DecompositionPolicy>* CFModel::CFPtr() const
 {
@@ -0,0 +1,233 @@
+/**
+ * @file cf_serving_model.hpp
+ *
+ * Definition of CFServingModel, a read-only collaborative filtering model that
+ * is mapped into memory from a compact file, for serving recommendations.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_CF_CF_SERVING_MODEL_HPP
+#define MLPACK_METHODS_CF_CF_SERVING_MODEL_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/mapped_file.hpp>
+
+namespace mlpack {
+namespace cf {
+
+/**
+ * A CFServingModel holds only what is needed to recommend items to the users
+ * of a trained CFType model and to predict their ratings: the item vectors and
+ * the interpolated vector of each user, in single precision, the parameters of
+ * the denormalization, and the items each user has already rated (without the
+ * ratings).  It is written with CFType::SaveServingModel() and loaded by the
+ * constructor.
+ *
+ * The file holds the following, in order:
+ *
+ *  - a fixed-size header (containing the magic string "MLPKCF", the format
+ *    version, the sizes of the model, the denormalization scale, and the
+ *    offsets of each section);
+ *  - the item vectors and the user vectors, one per column, as floats; the
+ *    normalized rating of an item by a user is the inner product of their
+ *    vectors;
+ *  - the denormalization terms of each item and of each user, as doubles; the
+ *    rating is scale * (normalized rating) + item term + user term;
+ *  - the rated items of each user, in compressed sparse column form (column
+ *    offsets as 64-bit integers, sorted item IDs as 32-bit integers).
+ *
+ * Each section is aligned to the page size.  When a model is loaded, nothing
+ * is copied or parsed: the matrices are aliases of the memory of the mapped
+ * file.  Since the mapping is copy-on-write and the model never modifies it,
+ * every process that loads the same file shares its physical pages, and only
+ * the pages that are touched are read from disk.
+ *
+ * The file format depends on the endianness of the machine it was written on.
+ *
+ * @code
+ * extern arma::mat data; // (user, item, rating) table.
+ * CFType<> cf(data);
+ * cf.SaveServingModel("model.cf");
+ *
+ * // In the serving process:
+ * CFServingModel model("model.cf");
+ * arma::Mat<size_t> recommendations;
+ * model.GetRecommendations(10, recommendations, users);
+ * @endcode
+ */
+class CFServingModel
+{
+ public:
+  /**
+   * Map the given serving model file into memory.  If the file is not a valid
+   * serving model, std::runtime_error is thrown.
+   *
+   * @param filename Serving model file to load.
+   */
+  CFServingModel(const std::string& filename);
+
+  //! The model aliases a mapping, so it cannot be copied.
+  CFServingModel(const CFServingModel& other) = delete;
+  //! The model aliases a mapping, so it cannot be copied.
+  CFServingModel& operator=(const CFServingModel& other) = delete;
+
+  /**
+   * Save a serving model to the given file.  This is usually called through
+   * CFType::SaveServingModel().
+   *
+   * @param filename File to save to.
+   * @param itemVectors Vectors of the items, one per column.
+   * @param userVectors Vectors of the users, one per column.
+   * @param scale Scale of the denormalization.
+   * @param itemTerms Denormalization term of each item.
+   * @param userTerms Denormalization term of each user.
+   * @param ratings Rating table (items x users); only the locations of the
+   *     nonzero elements are saved.
+   */
+  static void Save(const std::string& filename,
+                   const arma::fmat& itemVectors,
+                   const arma::fmat& userVectors,
+                   const double scale,
+                   const arma::vec& itemTerms,
+                   const arma::vec& userTerms,
+                   const arma::sp_mat& ratings);
+
+  /**
+   * Generate the given number of recommendations for all users.
+   *
+   * @param numRecs Number of recommendations.
+   * @param recommendations Matrix to save recommendations into.
+   */
+  void GetRecommendations(const size_t numRecs,
+                          arma::Mat<size_t>& recommendations) const;
+
+  /**
+   * Generate the given number of recommendations for the given users: the
+   * unrated items with the largest predicted ratings, in descending order.
+   * The users are processed in blocks, in parallel if OpenMP is available.  If
+   * a user has fewer unrated items than numRecs, the remaining
+   * recommendations are set to SIZE_MAX.
+   *
+   * @param numRecs Number of recommendations.
+   * @param recommendations Matrix to save recommendations into.
+   * @param users Users for which recommendations are to be generated.
+   */
+  void GetRecommendations(const size_t numRecs,
+                          arma::Mat<size_t>& recommendations,
+                          const arma::Col<size_t>& users) const;
+
+  /**
+   * Predict the rating of an item by a user.
+   *
+   * @param user User to predict for.
+   * @param item Item to predict for.
+   */
+  double Predict(const size_t user, const size_t item) const;
+
+  /**
+   * Predict the ratings of user/item combinations (one per column: the user
+   * and then the item).
+   *
+   * @param combinations User/item combinations to predict.
+   * @param predictions Predicted ratings for each user/item combination.
+   */
+  void Predict(const arma::Mat<size_t>& combinations,
+               arma::vec& predictions) const;
+
+  //! Get the number of users.
+  size_t NumUsers() const { return userVectors.n_cols; }
+  //! Get the number of items.
+  size_t NumItems() const { return itemVectors.n_cols; }
+  //! Get the dimensionality of the item and user vectors.
+  size_t Rank() const { return itemVectors.n_rows; }
+
+  //! Get the item vectors (an alias of the mapped file).
+  const arma::fmat& ItemVectors() const { return itemVectors; }
+  //! Get the user vectors (an alias of the mapped file).
+  const arma::fmat& UserVectors() const { return userVectors; }
+
+ private:
+  //! The header of a serving model file.
+  struct Header
+  {
+    //! Magic string identifying the file type: "MLPKCF".
+    char magic[8];
+    //! The version of the format.
+    uint64_t version;
+    //! The number of users.
+    uint64_t numUsers;
+    //! The number of items.
+    uint64_t numItems;
+    //! The dimensionality of the vectors.
+    uint64_t rank;
+    //! The number of rated (user, item) pairs.
+    uint64_t numRated;
+    //! The scale of the denormalization.
+    double scale;
+    //! The offset of the item vectors in the file.
+    uint64_t itemVectorsOffset;
+    //! The offset of the user vectors in the file.
+    uint64_t userVectorsOffset;
+    //! The offset of the item terms in the file.
+    uint64_t itemTermsOffset;
+    //! The offset of the user terms in the file.
+    uint64_t userTermsOffset;
+    //! The offset of the column offsets of the rated items in the file.
+    uint64_t ratedOffsetsOffset;
+    //! The offset of the rated items in the file.
+    uint64_t ratedItemsOffset;
+  };
+
+  //! The current version of the format.
+  static const uint64_t Version = 1;
+
+  //! The maximum number of scores computed at once by each thread in
+  //! GetRecommendations().
+  static const size_t MaxBlockScores = 1 << 22;
+
+  //! Round the given offset up to a multiple of the page size (4096 bytes).
+  static uint64_t Align(const uint64_t offset)
+  {
+    return (offset + 4095) & ~((uint64_t) 4095);
+  }
+
+  //! Candidate represents a possible recommendation (value, item).
+  typedef std::pair<double, size_t> Candidate;
+
+  //! Compare two candidates based on the value.
+  struct CandidateCmp {
+    bool operator()(const Candidate& c1, const Candidate& c2)
+    {
+      return c1.first > c2.first;
+    };
+  };
+
+  //! The mapped file.
+  util::MappedFile file;
+  //! The item vectors, one per column.
+  arma::fmat itemVectors;
+  //! The user vectors, one per column.
+  arma::fmat userVectors;
+  //! The scale of the denormalization.
+  double scale;
+  //! The denormalization term of each item.
+  arma::vec itemTerms;
+  //! The denormalization term of each user.
+  arma::vec userTerms;
+  //! The rated items of user u are ratedItems[ratedOffsets[u]] to
+  //! ratedItems[ratedOffsets[u + 1] - 1].
+  const uint64_t* ratedOffsets;
+  //! The rated items of all the users.
+  const uint32_t* ratedItems;
+};
+
+} // namespace cf
+} // namespace mlpack
+
+// Include implementation.
+#include "cf_serving_model_impl.hpp"
+
+#endif
@@ -0,0 +1,284 @@
+/**
+ * @file cf_serving_model_impl.hpp
+ *
+ * Implementation of CFServingModel, a read-only collaborative filtering model
+ * that is mapped into memory from a compact file.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_CF_CF_SERVING_MODEL_IMPL_HPP
+#define MLPACK_METHODS_CF_CF_SERVING_MODEL_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "cf_serving_model.hpp"
+
+#include <fstream>
+#include <cstring>
+
+namespace mlpack {
+namespace cf {
+
+inline CFServingModel::CFServingModel(const std::string& filename) :
+    file(filename)
+{
+  const std::string error = "CFServingModel::CFServingModel(): '" + filename +
+      "' ";
+  if (file.Size() < sizeof(Header))
+    throw std::runtime_error(error + "is not a serving model file");
+
+  Header header;
+  std::memcpy(&header, file.Data(), sizeof(Header));
+  if (std::memcmp(header.magic, "MLPKCF", 7) != 0)
+    throw std::runtime_error(error + "is not a serving model file");
+  if (header.version != Version)
+    throw std::runtime_error(error + "has an unsupported format version");
+
+  // Check that every section lies in the file, in order.
+  const uint64_t ends[] = {
+      header.itemVectorsOffset + header.rank * header.numItems * sizeof(float),
+      header.userVectorsOffset + header.rank * header.numUsers * sizeof(float),
+      header.itemTermsOffset + header.numItems * sizeof(double),
+      header.userTermsOffset + header.numUsers * sizeof(double),
+      header.ratedOffsetsOffset + (header.numUsers + 1) * sizeof(uint64_t),
+      header.ratedItemsOffset + header.numRated * sizeof(uint32_t) };
+  const uint64_t offsets[] = { header.itemVectorsOffset,
+      header.userVectorsOffset, header.itemTermsOffset, header.userTermsOffset,
+      header.ratedOffsetsOffset, header.ratedItemsOffset };
+  uint64_t end = sizeof(Header);
+  for (size_t i = 0; i < 6; ++i)
+  {
+    if (offsets[i] < end || offsets[i] % 4096 != 0)
+      throw std::runtime_error(error + "is truncated or corrupt");
+    end = ends[i];
+  }
+  if (end > file.Size())
+    throw std::runtime_error(error + "is truncated or corrupt");
+
+  // Alias the sections directly from the mapped memory.  Nothing writes to
+  // them, so the pages stay shared with other processes.
+  char* data = file.Data();
+  itemVectors = arma::fmat((float*) (data + header.itemVectorsOffset),
+      header.rank, header.numItems, false, true);
+  userVectors = arma::fmat((float*) (data + header.userVectorsOffset),
+      header.rank, header.numUsers, false, true);
+  itemTerms = arma::vec((double*) (data + header.itemTermsOffset),
+      header.numItems, false, true);
+  userTerms = arma::vec((double*) (data + header.userTermsOffset),
+      header.numUsers, false, true);
+  ratedOffsets = (const uint64_t*) (data + header.ratedOffsetsOffset);
+  ratedItems = (const uint32_t*) (data + header.ratedItemsOffset);
+  scale = header.scale;
+
+  if (ratedOffsets[header.numUsers] != header.numRated)
+    throw std::runtime_error(error + "is truncated or corrupt");
+}
+
+inline void CFServingModel::Save(const std::string& filename,
+                                 const arma::fmat& itemVectors,
+                                 const arma::fmat& userVectors,
+                                 const double scale,
+                                 const arma::vec& itemTerms,
+                                 const arma::vec& userTerms,
+                                 const arma::sp_mat& ratings)
+{
+  if (itemVectors.n_rows != userVectors.n_rows)
+    throw std::invalid_argument("CFServingModel::Save(): the item and user "
+        "vectors have different dimensionalities");
+  if (itemTerms.n_elem != itemVectors.n_cols ||
+      ratings.n_rows != itemVectors.n_cols)
+    throw std::invalid_argument("CFServingModel::Save(): the numbers of items "
+        "do not match");
+  if (userTerms.n_elem != userVectors.n_cols ||
+      ratings.n_cols != userVectors.n_cols)
+    throw std::invalid_argument("CFServingModel::Save(): the numbers of users "
+        "do not match");
+  if (itemVectors.n_cols > std::numeric_limits<uint32_t>::max())
+    throw std::invalid_argument("CFServingModel::Save(): too many items");
+
+  Header header;
+  std::memset(&header, 0, sizeof(Header));
+  std::memcpy(header.magic, "MLPKCF", 7);
+  header.version = Version;
+  header.numUsers = userVectors.n_cols;
+  header.numItems = itemVectors.n_cols;
+  header.rank = itemVectors.n_rows;
+  header.numRated = ratings.n_nonzero;
+  header.scale = scale;
+  header.itemVectorsOffset = Align(sizeof(Header));
+  header.userVectorsOffset = Align(header.itemVectorsOffset +
+      itemVectors.n_elem * sizeof(float));
+  header.itemTermsOffset = Align(header.userVectorsOffset +
+      userVectors.n_elem * sizeof(float));
+  header.userTermsOffset = Align(header.itemTermsOffset +
+      itemTerms.n_elem * sizeof(double));
+  header.ratedOffsetsOffset = Align(header.userTermsOffset +
+      userTerms.n_elem * sizeof(double));
+  header.ratedItemsOffset = Align(header.ratedOffsetsOffset +
+      (ratings.n_cols + 1) * sizeof(uint64_t));
+
+  // The locations of the ratings, in compressed sparse column form.
+  std::vector<uint64_t> offsets(ratings.n_cols + 1);
+  for (size_t i = 0; i <= ratings.n_cols; ++i)
+    offsets[i] = ratings.col_ptrs[i];
+  std::vector<uint32_t> items(ratings.n_nonzero);
+  for (size_t i = 0; i < ratings.n_nonzero; ++i)
+    items[i] = (uint32_t) ratings.row_indices[i];
+
+  std::ofstream stream(filename, std::ios::binary);
+  if (!stream.is_open())
+    throw std::runtime_error("CFServingModel::Save(): cannot open file '" +
+        filename + "' for writing");
+
+  // Write each section, padding the stream with zeros up to its offset.
+  stream.write((const char*) &header, sizeof(Header));
+  const uint64_t sectionOffsets[] = { header.itemVectorsOffset,
+      header.userVectorsOffset, header.itemTermsOffset, header.userTermsOffset,
+      header.ratedOffsetsOffset, header.ratedItemsOffset };
+  const char* sections[] = { (const char*) itemVectors.memptr(),
+      (const char*) userVectors.memptr(), (const char*) itemTerms.memptr(),
+      (const char*) userTerms.memptr(), (const char*) offsets.data(),
+      (const char*) items.data() };
+  const size_t sizes[] = { itemVectors.n_elem * sizeof(float),
+      userVectors.n_elem * sizeof(float), itemTerms.n_elem * sizeof(double),
+      userTerms.n_elem * sizeof(double), offsets.size() * sizeof(uint64_t),
+      items.size() * sizeof(uint32_t) };
+  for (size_t i = 0; i < 6; ++i)
+  {
+    while ((uint64_t) stream.tellp() < sectionOffsets[i])
+      stream.put(0);
+    stream.write(sections[i], sizes[i]);
+  }
+
+  if (!stream.good())
+    throw std::runtime_error("CFServingModel::Save(): error writing to file '"
+        + filename + "'");
+}
+
+inline void CFServingModel::GetRecommendations(
+    const size_t numRecs,
+    arma::Mat<size_t>& recommendations) const
+{
+  const arma::Col<size_t> users = arma::linspace<arma::Col<size_t>>(0,
+      NumUsers() - 1, NumUsers());
+  GetRecommendations(numRecs, recommendations, users);
+}
+
+inline void CFServingModel::GetRecommendations(
+    const size_t numRecs,
+    arma::Mat<size_t>& recommendations,
+    const arma::Col<size_t>& users) const
+{
+  for (size_t i = 0; i < users.n_elem; ++i)
+  {
+    if (users[i] >= NumUsers())
+    {
+      std::ostringstream oss;
+      oss << "CFServingModel::GetRecommendations(): user " << users[i]
+          << " is not in the model (" << NumUsers() << " users)";
+      throw std::invalid_argument(oss.str());
+    }
+  }
+
+  recommendations.set_size(numRecs, users.n_elem);
+  recommendations.fill(SIZE_MAX);
+
+  // The scores of a block of users are computed with one matrix
+  // multiplication, but the block is kept small enough that the scores of
+  // each thread take bounded memory.
+  const size_t blockSize = std::max((size_t) 1, std::min((size_t) 64,
+      MaxBlockScores / std::max((size_t) 1, NumItems())));
+  const size_t numBlocks = (users.n_elem + blockSize - 1) / blockSize;
+
+  // Default candidate: the smallest possible value and invalid item number.
+  const Candidate def = std::make_pair(-DBL_MAX, SIZE_MAX);
+
+  #pragma omp parallel
+  {
+    arma::fmat blockVectors;
+    arma::fmat scores;
+    std::vector<Candidate> candidates;
+    candidates.reserve(numRecs);
+
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+    {
+      const size_t begin = b * blockSize;
+      const size_t end = std::min(begin + blockSize, (size_t) users.n_elem);
+
+      blockVectors.set_size(Rank(), end - begin);
+      for (size_t i = begin; i < end; ++i)
+        blockVectors.col(i - begin) = userVectors.col(users[i]);
+      scores = itemVectors.t() * blockVectors;
+
+      for (size_t i = begin; i < end; ++i)
+      {
+        const size_t user = users[i];
+        const float* userScores = scores.colptr(i - begin);
+
+        // This is a heap with the worst candidate on top.  The rated items
+        // are sorted, so they are walked alongside the items.
+        candidates.assign(numRecs, def);
+        const uint32_t* rated = ratedItems + ratedOffsets[user];
+        const uint32_t* ratedEnd = ratedItems + ratedOffsets[user + 1];
+        for (size_t j = 0; j < NumItems(); ++j)
+        {
+          if (rated != ratedEnd && *rated == j)
+          {
+            ++rated;
+            continue; // The user already rated the item.
+          }
+
+          const double rating = scale * userScores[j] + itemTerms[j] +
+              userTerms[user];
+          if (rating > candidates.front().first)
+          {
+            std::pop_heap(candidates.begin(), candidates.end(),
+                CandidateCmp());
+            candidates.back() = std::make_pair(rating, j);
+            std::push_heap(candidates.begin(), candidates.end(),
+                CandidateCmp());
+          }
+        }
+
+        for (size_t p = 1; p <= numRecs; p++)
+        {
+          recommendations(numRecs - p, i) = candidates.front().second;
+          std::pop_heap(candidates.begin(), candidates.end() - (p - 1),
+              CandidateCmp());
+        }
+      }
+    }
+  }
+}
+
+inline double CFServingModel::Predict(const size_t user,
+                                      const size_t item) const
+{
+  if (user >= NumUsers() || item >= NumItems())
+  {
+    std::ostringstream oss;
+    oss << "CFServingModel::Predict(): user " << user << " or item " << item
+        << " is not in the model (" << NumUsers() << " users, " << NumItems()
+        << " items)";
+    throw std::invalid_argument(oss.str());
+  }
+
+  return scale * arma::dot(itemVectors.col(item), userVectors.col(user)) +
+      itemTerms[item] + userTerms[user];
+}
+
+inline void CFServingModel::Predict(const arma::Mat<size_t>& combinations,
+                                    arma::vec& predictions) const
+{
+  predictions.set_size(combinations.n_cols);
+  for (size_t i = 0; i < combinations.n_cols; ++i)
+    predictions[i] = Predict(combinations(0, i), combinations(1, i));
+}
+
+} // namespace cf
+} // namespace mlpack
+
+#endif
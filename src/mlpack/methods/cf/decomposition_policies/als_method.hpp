@@ -0,0 +1,296 @@
+/**
+ * @file als_method.hpp
+ *
+ * Alternating least squares method for use in Collaborative Filtering.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+
+#ifndef MLPACK_METHODS_CF_DECOMPOSITION_POLICIES_ALS_METHOD_HPP
+#define MLPACK_METHODS_CF_DECOMPOSITION_POLICIES_ALS_METHOD_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/methods/amf/amf.hpp>
+#include <mlpack/methods/amf/update_rules/sparse_als.hpp>
+#include <mlpack/methods/amf/termination_policies/max_iteration_termination.hpp>
+#include <mlpack/methods/amf/termination_policies/simple_residue_termination.hpp>
+
+namespace mlpack {
+namespace cf {
+
+/**
+ * Implementation of the ALS policy to act as a wrapper when accessing the
+ * SparseALSUpdate rule of AMF from within CFType.  Unlike NMFPolicy, only the
+ * observed ratings are fit, and the factors are not constrained to be
+ * nonnegative.  With implicit feedback, the ratings are treated as
+ * confidences instead (see amf::SparseALSUpdate).
+ *
+ * An example of how to use ALSPolicy in CF is shown below:
+ *
+ * @code
+ * extern arma::mat data; // data is a (user, item, rating) table.
+ * // Users for whom recommendations are generated.
+ * extern arma::Col<size_t> users;
+ * arma::Mat<size_t> recommendations; // Resulting recommendations.
+ *
+ * CFType<ALSPolicy> cf(data);
+ *
+ * // Generate 10 recommendations for all users.
+ * cf.GetRecommendations(10, recommendations);
+ * @endcode
+ */
+class ALSPolicy
+{
+ public:
+  /**
+   * Use alternating least squares with the given parameters.
+   *
+   * @param lambda Regularization parameter.
+   * @param implicit If true, the ratings are implicit feedback.
+   * @param alpha Confidence scale of implicit feedback.
+   */
+  ALSPolicy(const double lambda = 0.01,
+            const bool implicit = false,
+            const double alpha = 1.0) :
+      lambda(lambda),
+      implicit(implicit),
+      alpha(alpha)
+  {
+    /* Nothing to do here */
+  }
+
+  /**
+   * Apply Collaborative Filtering to the provided dataset using alternating
+   * least squares.
+   *
+   * @param data Data matrix: dense matrix (coordinate lists)
+   *    or sparse matrix(cleaned).
+   * @param cleanedData item user table in form of sparse matrix.
+   * @param rank Rank parameter for matrix factorization.
+   * @param maxIterations Maximum number of iterations.
+   * @param minResidue Residue required to terminate.
+   * @param mit Whether to terminate only when maxIterations is reached.
+   */
+  template<typename MatType>
+  void Apply(const MatType& /* data */,
+             const arma::sp_mat& cleanedData,
+             const size_t rank,
+             const size_t maxIterations,
+             const double minResidue,
+             const bool mit)
+  {
+    amf::SparseALSUpdate update(lambda, implicit, alpha);
+    if (mit)
+    {
+      amf::MaxIterationTermination iter(maxIterations);
+
+      amf::AMF<amf::MaxIterationTermination, amf::RandomInitialization,
+          amf::SparseALSUpdate> als(iter, amf::RandomInitialization(), update);
+      als.Apply(cleanedData, rank, w, h);
+    }
+    else
+    {
+      amf::SimpleResidueTermination srt(minResidue, maxIterations);
+
+      amf::AMF<amf::SimpleResidueTermination, amf::RandomInitialization,
+          amf::SparseALSUpdate> als(srt, amf::RandomInitialization(), update);
+      als.Apply(cleanedData, rank, w, h);
+    }
+  }
+
+  /**
+   * Return predicted rating given user ID and item ID.
+   *
+   * @param user User ID.
+   * @param item Item ID.
+   */
+  double GetRating(const size_t user, const size_t item) const
+  {
+    double rating = arma::as_scalar(w.row(item) * h.col(user));
+    return rating;
+  }
+
+  /**
+   * Get predicted ratings for a user.
+   *
+   * @param user User ID.
+   * @param rating Resulting rating vector.
+   */
+  void GetRatingOfUser(const size_t user, arma::vec& rating) const
+  {
+    rating = w * h.col(user);
+  }
+
+  /**
+   * Get the weighted sums of the predicted ratings of groups of users: column
+   * i of ratings is the sum over j of weights(j, i) times the predicted
+   * ratings of user neighborhood(j, i).  The ratings are linear in the user
+   * vectors, so the user vectors are combined first, and the ratings of all
+   * groups are computed with a single matrix multiplication.
+   *
+   * @param neighborhood Users of each group, one group per column.
+   * @param weights Weight of each user of each group.
+   * @param ratings Resulting ratings, one column per group.
+   */
+  void GetWeightedRatings(const arma::Mat<size_t>& neighborhood,
+                          const arma::mat& weights,
+                          arma::mat& ratings) const
+  {
+    arma::mat userVectors;
+    GetWeightedUserVectors(neighborhood, weights, userVectors);
+    ratings = w * userVectors;
+  }
+
+  /**
+   * Get the vectors of the items, one per column, such that the ratings
+   * computed by GetWeightedRatings() are the inner products of the item
+   * vectors with the vectors given by GetWeightedUserVectors().
+   *
+   * @param itemVectors Resulting item vectors.
+   */
+  void GetItemVectors(arma::mat& itemVectors) const
+  {
+    itemVectors = w.t();
+  }
+
+  /**
+   * Get the weighted sums of the user vectors of groups of users (see
+   * GetWeightedRatings() and GetItemVectors()).
+   *
+   * @param neighborhood Users of each group, one group per column.
+   * @param weights Weight of each user of each group.
+   * @param userVectors Resulting vectors, one column per group.
+   */
+  void GetWeightedUserVectors(const arma::Mat<size_t>& neighborhood,
+                              const arma::mat& weights,
+                              arma::mat& userVectors) const
+  {
+    userVectors.zeros(h.n_rows, neighborhood.n_cols);
+    for (size_t i = 0; i < neighborhood.n_cols; ++i)
+      for (size_t j = 0; j < neighborhood.n_rows; ++j)
+        userVectors.col(i) += weights(j, i) * h.col(neighborhood(j, i));
+  }
+
+  /**
+   * Fold in the given ratings of a user without refactorizing: the user's
+   * vector is the ridge regression solution that predicts the ratings from
+   * the fixed item vectors, which is one half-step of the alternating least
+   * squares used by Apply() for explicit feedback.  If the user is new (its
+   * ID is the number of users), a vector is added.
+   *
+   * @param user User ID.
+   * @param ratings Normalized ratings of the user (one element per item).
+   * @param lambda Regularization parameter.
+   */
+  void FoldIn(const size_t user,
+              const arma::sp_vec& ratings,
+              const double lambda)
+  {
+    arma::mat items(ratings.n_nonzero, w.n_cols);
+    arma::vec values(ratings.n_nonzero);
+    size_t i = 0;
+    arma::sp_vec::const_iterator it = ratings.begin();
+    for (; it != ratings.end(); ++it, ++i)
+    {
+      items.row(i) = w.row(it.row());
+      values[i] = *it;
+    }
+
+    if (user >= h.n_cols)
+      h.resize(h.n_rows, user + 1);
+    h.col(user) = arma::solve(items.t() * items + lambda *
+        arma::eye(w.n_cols, w.n_cols), items.t() * values);
+  }
+
+  /**
+   * Get the neighborhood and corresponding similarities for a set of users.
+   *
+   * @tparam NeighborSearchPolicy The policy to perform neighbor search.
+   *
+   * @param users Users whose neighborhood is to be computed.
+   * @param numUsersForSimilarity The number of neighbors returned for
+   *     each user.
+   * @param neighborhood Neighbors represented by user IDs.
+   * @param similarities Similarity between each user and each of its
+   *     neighbors.
+   */
+  template<typename NeighborSearchPolicy>
+  void GetNeighborhood(const arma::Col<size_t>& users,
+                       const size_t numUsersForSimilarity,
+                       arma::Mat<size_t>& neighborhood,
+                       arma::mat& similarities) const
+  {
+    // We want to avoid calculating the full rating matrix, so we will do
+    // nearest neighbor search only on the H matrix, using the observation that
+    // if the rating matrix X = W*H, then d(X.col(i), X.col(j)) = d(W H.col(i),
+    // W H.col(j)).  This can be seen as nearest neighbor search on the H
+    // matrix with the Mahalanobis distance where M^{-1} = W^T W.  So, we'll
+    // decompose M^{-1} = L L^T (the Cholesky decomposition), and then multiply
+    // H by L^T. Then we can perform nearest neighbor search.
+    arma::mat l = arma::chol(w.t() * w);
+    arma::mat stretchedH = l * h; // Due to the Armadillo API, l is L^T.
+
+    // Temporarily store feature vector of queried users.
+    arma::mat query(stretchedH.n_rows, users.n_elem);
+    // Select feature vectors of queried users.
+    for (size_t i = 0; i < users.n_elem; i++)
+      query.col(i) = stretchedH.col(users(i));
+
+    NeighborSearchPolicy neighborSearch(stretchedH);
+    neighborSearch.Search(
+        query, numUsersForSimilarity, neighborhood, similarities);
+  }
+
+  //! Get the regularization parameter.
+  double Lambda() const { return lambda; }
+  //! Modify the regularization parameter.
+  double& Lambda() { return lambda; }
+
+  //! Get whether the ratings are implicit feedback.
+  bool Implicit() const { return implicit; }
+  //! Modify whether the ratings are implicit feedback.
+  bool& Implicit() { return implicit; }
+
+  //! Get the confidence scale of implicit feedback.
+  double Alpha() const { return alpha; }
+  //! Modify the confidence scale of implicit feedback.
+  double& Alpha() { return alpha; }
+
+  //! Get the Item Matrix.
+  const arma::mat& W() const { return w; }
+  //! Get the User Matrix.
+  const arma::mat& H() const { return h; }
+
+  /**
+   * Serialization.
+   */
+  template<typename Archive>
+  void serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & BOOST_SERIALIZATION_NVP(lambda);
+    ar & BOOST_SERIALIZATION_NVP(implicit);
+    ar & BOOST_SERIALIZATION_NVP(alpha);
+    ar & BOOST_SERIALIZATION_NVP(w);
+    ar & BOOST_SERIALIZATION_NVP(h);
+  }
+
+ private:
+  //! Regularization parameter.
+  double lambda;
+  //! Whether the ratings are implicit feedback.
+  bool implicit;
+  //! Confidence scale of implicit feedback.
+  double alpha;
+  //! Item matrix.
+  arma::mat w;
+  //! User matrix.
+  arma::mat h;
+};
+
+} // namespace cf
+} // namespace mlpack
+
+#endif
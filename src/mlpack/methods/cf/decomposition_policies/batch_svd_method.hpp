@@ -107,6 +107,86 @@ class BatchSVDPolicy
     rating = w * h.col(user);
   }
 
+  /**
+   * Get the weighted sums of the predicted ratings of groups of users: column
+   * i of ratings is the sum over j of weights(j, i) times the predicted
+   * ratings of user neighborhood(j, i).  The ratings are linear in the user
+   * vectors, so the user vectors are combined first, and the ratings of all
+   * groups are computed with a single matrix multiplication.
+   *
+   * @param neighborhood Users of each group, one group per column.
+   * @param weights Weight of each user of each group.
+   * @param ratings Resulting ratings, one column per group.
+   */
+  void GetWeightedRatings(const arma::Mat<size_t>& neighborhood,
+                          const arma::mat& weights,
+                          arma::mat& ratings) const
+  {
+    arma::mat userVectors;
+    GetWeightedUserVectors(neighborhood, weights, userVectors);
+    ratings = w * userVectors;
+  }
+
+  /**
+   * Get the vectors of the items, one per column, such that the ratings
+   * computed by GetWeightedRatings() are the inner products of the item
+   * vectors with the vectors given by GetWeightedUserVectors().
+   *
+   * @param itemVectors Resulting item vectors.
+   */
+  void GetItemVectors(arma::mat& itemVectors) const
+  {
+    itemVectors = w.t();
+  }
+
+  /**
+   * Get the weighted sums of the user vectors of groups of users (see
+   * GetWeightedRatings() and GetItemVectors()).
+   *
+   * @param neighborhood Users of each group, one group per column.
+   * @param weights Weight of each user of each group.
+   * @param userVectors Resulting vectors, one column per group.
+   */
+  void GetWeightedUserVectors(const arma::Mat<size_t>& neighborhood,
+                              const arma::mat& weights,
+                              arma::mat& userVectors) const
+  {
+    userVectors.zeros(h.n_rows, neighborhood.n_cols);
+    for (size_t i = 0; i < neighborhood.n_cols; ++i)
+      for (size_t j = 0; j < neighborhood.n_rows; ++j)
+        userVectors.col(i) += weights(j, i) * h.col(neighborhood(j, i));
+  }
+
+  /**
+   * Fold in the given ratings of a user without refactorizing: the user's
+   * vector is the ridge regression solution that predicts the ratings from
+   * the fixed item vectors.  If the user is new (its ID is the number of
+   * users), a vector is added.
+   *
+   * @param user User ID.
+   * @param ratings Normalized ratings of the user (one element per item).
+   * @param lambda Regularization parameter.
+   */
+  void FoldIn(const size_t user,
+              const arma::sp_vec& ratings,
+              const double lambda)
+  {
+    arma::mat items(ratings.n_nonzero, w.n_cols);
+    arma::vec values(ratings.n_nonzero);
+    size_t i = 0;
+    arma::sp_vec::const_iterator it = ratings.begin();
+    for (; it != ratings.end(); ++it, ++i)
+    {
+      items.row(i) = w.row(it.row());
+      values[i] = *it;
+    }
+
+    if (user >= h.n_cols)
+      h.resize(h.n_rows, user + 1);
+    h.col(user) = arma::solve(items.t() * items + lambda *
+        arma::eye(w.n_cols, w.n_cols), items.t() * values);
+  }
+
   /**
    * Get the neighborhood and corresponding similarities for a set of users.
    *
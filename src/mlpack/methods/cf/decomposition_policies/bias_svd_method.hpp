@@ -47,13 +47,17 @@ class BiasSVDPolicy
    * @param maxIterations Number of iterations.
    * @param alpha Learning rate for optimization.
    * @param Regularization parameter for optimization.
+   * @param stratified If true, optimize with StratifiedSGD, which processes
+   *     the ratings in parallel in blocks that share no user and no item.
    */
   BiasSVDPolicy(const size_t maxIterations = 10,
                 const double alpha = 0.02,
-                const double lambda = 0.05) :
+                const double lambda = 0.05,
+                const bool stratified = false) :
       maxIterations(maxIterations),
       alpha(alpha),
-      lambda(lambda)
+      lambda(lambda),
+      stratified(stratified)
   {
     /* Nothing to do here */
   }
@@ -78,8 +82,16 @@ class BiasSVDPolicy
              const bool /* mit */)
   {
     // Perform decomposition using the bias SVD algorithm.
-    svd::BiasSVD<> biassvd(maxIterations, alpha, lambda);
-    biassvd.Apply(data, rank, w, h, p, q);
+    if (stratified)
+    {
+      svd::BiasSVD<svd::StratifiedSGD> biassvd(maxIterations, alpha, lambda);
+      biassvd.Apply(data, rank, w, h, p, q);
+    }
+    else
+    {
+      svd::BiasSVD<> biassvd(maxIterations, alpha, lambda);
+      biassvd.Apply(data, rank, w, h, p, q);
+    }
   }
 
   /**
@@ -106,6 +118,120 @@ class BiasSVDPolicy
     rating = w * h.col(user) + p + q(user);
   }
 
+  /**
+   * Get the weighted sums of the predicted ratings of groups of users: column
+   * i of ratings is the sum over j of weights(j, i) times the predicted
+   * ratings of user neighborhood(j, i).  The ratings are linear in the user
+   * vectors and biases, so those are combined first, and the ratings of all
+   * groups are computed with a single matrix multiplication.
+   *
+   * @param neighborhood Users of each group, one group per column.
+   * @param weights Weight of each user of each group.
+   * @param ratings Resulting ratings, one column per group.
+   */
+  void GetWeightedRatings(const arma::Mat<size_t>& neighborhood,
+                          const arma::mat& weights,
+                          arma::mat& ratings) const
+  {
+    // The last element of each user vector is the total weight of the group,
+    // so the item biases are added once for each unit of weight.
+    arma::mat userVectors;
+    GetWeightedUserVectors(neighborhood, weights, userVectors);
+    ratings = w * userVectors.head_rows(h.n_rows) +
+        p * userVectors.row(h.n_rows);
+
+    for (size_t i = 0; i < neighborhood.n_cols; ++i)
+    {
+      double userBias = 0.0;
+      for (size_t j = 0; j < neighborhood.n_rows; ++j)
+        userBias += weights(j, i) * q(neighborhood(j, i));
+      ratings.col(i) += userBias;
+    }
+  }
+
+  /**
+   * Get the vectors of the items, one per column, such that the ratings
+   * computed by GetWeightedRatings() are, up to a constant for each group
+   * (the weighted user biases), the inner products of the item vectors with
+   * the vectors given by GetWeightedUserVectors().  The item bias is the last
+   * element of each item vector.
+   *
+   * @param itemVectors Resulting item vectors.
+   */
+  void GetItemVectors(arma::mat& itemVectors) const
+  {
+    itemVectors = arma::join_cols(w.t(), p.t());
+  }
+
+  /**
+   * Get the weighted sums of the user vectors of groups of users (see
+   * GetWeightedRatings() and GetItemVectors()).  The last element of each
+   * vector is the total weight of the group.
+   *
+   * @param neighborhood Users of each group, one group per column.
+   * @param weights Weight of each user of each group.
+   * @param userVectors Resulting vectors, one column per group.
+   */
+  void GetWeightedUserVectors(const arma::Mat<size_t>& neighborhood,
+                              const arma::mat& weights,
+                              arma::mat& userVectors) const
+  {
+    userVectors.zeros(h.n_rows + 1, neighborhood.n_cols);
+    for (size_t i = 0; i < neighborhood.n_cols; ++i)
+    {
+      for (size_t j = 0; j < neighborhood.n_rows; ++j)
+      {
+        userVectors.col(i).head(h.n_rows) += weights(j, i) *
+            h.col(neighborhood(j, i));
+      }
+      userVectors(h.n_rows, i) = arma::accu(weights.col(i));
+    }
+  }
+
+  /**
+   * Fold in the given ratings of a user without refactorizing: the user's
+   * vector and bias are the ridge regression solution that predicts the
+   * ratings (minus the item biases) from the fixed item vectors.  If the user
+   * is new (its ID is the number of users), a vector and bias are added.
+   *
+   * @param user User ID.
+   * @param ratings Normalized ratings of the user (one element per item).
+   * @param lambda Regularization parameter.
+   */
+  void FoldIn(const size_t user,
+              const arma::sp_vec& ratings,
+              const double lambda)
+  {
+    // Each item contributes its vector, with a one for the user bias.
+    arma::mat items(ratings.n_nonzero, h.n_rows + 1);
+    arma::vec values(ratings.n_nonzero);
+    size_t i = 0;
+    arma::sp_vec::const_iterator it = ratings.begin();
+    for (; it != ratings.end(); ++it, ++i)
+    {
+      items.row(i).head(h.n_rows) = w.row(it.row());
+      items(i, h.n_rows) = 1.0;
+      values[i] = *it - p(it.row());
+    }
+
+    const arma::vec solution = arma::solve(items.t() * items + lambda *
+        arma::eye(h.n_rows + 1, h.n_rows + 1), items.t() * values);
+
+    if (user >= h.n_cols)
+    {
+      h.resize(h.n_rows, user + 1);
+      q.resize(user + 1);
+    }
+    h.col(user) = solution.head(h.n_rows);
+    q(user) = solution[h.n_rows];
+  }
+    }
+
+    // The item biases are added once for each unit of weight.
+    ratings = w * userVectors + p * arma::sum(weights, 0);
+    ratings.each_row() += userBiases;
+  }
+
   /**
    * Get the neighborhood and corresponding similarities for a set of users.
    *
@@ -160,6 +286,11 @@ class BiasSVDPolicy
   //! Modify regularization parameter.
   double& Lambda() { return lambda; }
 
+  //! Get whether StratifiedSGD is used for training.
+  bool Stratified() const { return stratified; }
+  //! Modify whether StratifiedSGD is used for training.
+  bool& Stratified() { return stratified; }
+
   /**
    * Serialization.
    */
@@ -182,6 +313,9 @@ class BiasSVDPolicy
   double alpha;
   //! Regularization parameter for optimization.
   double lambda;
+  //! Whether to train with StratifiedSGD (only used for training, so it is
+  //! not serialized).
+  bool stratified;
   //! Item matrix.
   arma::mat w;
   //! User matrix.
@@ -0,0 +1,189 @@
+/**
+ * @file load_ratings.cpp
+ *
+ * Implementation of the functions that load a (user, item, rating) file
+ * directly into a sparse rating matrix.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "load_ratings.hpp"
+
+#include <fstream>
+#include <cstdlib>
+#include <unordered_map>
+
+namespace mlpack {
+namespace cf {
+
+/**
+ * Parse one number of a line, and skip the separator after it.  Returns false
+ * if there is no number at p.
+ */
+static bool ParseField(const char*& p, const char* end, double& value)
+{
+  char* next;
+  value = std::strtod(p, &next);
+  if (next == p || next > end)
+    return false;
+
+  p = next;
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+    ++p;
+  if (p < end && *p == ',')
+    ++p;
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+    ++p;
+
+  return true;
+}
+
+/**
+ * Parse the given file chunk by chunk, calling the given functions to turn the
+ * IDs of each line into a column (user) and a row (item) of the matrix.
+ */
+template<typename UserMapType, typename ItemMapType>
+static void ParseRatings(const std::string& filename,
+                         arma::sp_mat& ratings,
+                         UserMapType mapUser,
+                         ItemMapType mapItem,
+                         const size_t chunkSize)
+{
+  std::ifstream stream(filename, std::ios::binary);
+  if (!stream.is_open())
+    throw std::runtime_error("LoadRatings(): cannot open file '" + filename +
+        "'");
+
+  // The locations are stored as (item, user) pairs, so that they can be used
+  // as the columns of the location matrix of the batch insert constructor.
+  std::vector<arma::uword> locations;
+  std::vector<double> values;
+  size_t numUsers = 0, numItems = 0, numZeros = 0;
+
+  // Handle one line (from begin to end, which is not part of it).
+  size_t lineNumber = 0;
+  auto parseLine = [&](const char* begin, const char* end)
+  {
+    ++lineNumber;
+    const char* p = begin;
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+      ++p;
+    if (p == end)
+      return; // Skip empty lines.
+
+    double user, item, rating;
+    if (!ParseField(p, end, user) || !ParseField(p, end, item) ||
+        !ParseField(p, end, rating) || p != end || user < 0 || item < 0)
+    {
+      std::ostringstream oss;
+      oss << "LoadRatings(): cannot parse line " << lineNumber << " of '"
+          << filename << "' as a (user, item, rating) triple";
+      throw std::runtime_error(oss.str());
+    }
+
+    // Ratings of zero can't be stored in the sparse matrix.
+    if (rating == 0.0)
+    {
+      ++numZeros;
+      return;
+    }
+
+    const size_t column = mapUser((size_t) user);
+    const size_t row = mapItem((size_t) item);
+    numUsers = std::max(numUsers, column + 1);
+    numItems = std::max(numItems, row + 1);
+
+    locations.push_back(row);
+    locations.push_back(column);
+    values.push_back(rating);
+  };
+
+  // The buffer holds the incomplete last line of the previous chunk, followed
+  // by the current chunk.
+  std::vector<char> chunk(chunkSize);
+  std::string buffer;
+  while (stream)
+  {
+    stream.read(chunk.data(), chunkSize);
+    const size_t count = (size_t) stream.gcount();
+    if (count == 0)
+      break;
+    buffer.append(chunk.data(), count);
+
+    size_t begin = 0, end;
+    while ((end = buffer.find('\n', begin)) != std::string::npos)
+    {
+      parseLine(buffer.data() + begin, buffer.data() + end);
+      begin = end + 1;
+    }
+    buffer.erase(0, begin);
+  }
+
+  if (stream.bad())
+    throw std::runtime_error("LoadRatings(): error reading file '" + filename +
+        "'");
+
+  // The last line may not end with a newline.
+  if (!buffer.empty())
+    parseLine(buffer.data(), buffer.data() + buffer.size());
+
+  if (numZeros > 0)
+    Log::Warn << "LoadRatings(): " << numZeros << " user ratings of 0 ignored."
+        << std::endl;
+
+  // Batch insert the ratings straight from the arrays they were parsed into.
+  if (values.empty())
+  {
+    ratings.zeros(numItems, numUsers);
+    return;
+  }
+
+  const arma::umat locationMatrix(locations.data(), 2, values.size(), false,
+      true);
+  const arma::vec valueVector(values.data(), values.size(), false, true);
+  ratings = arma::sp_mat(locationMatrix, valueVector, numItems, numUsers);
+}
+
+void LoadRatings(const std::string& filename,
+                 arma::sp_mat& ratings,
+                 const size_t chunkSize)
+{
+  auto identity = [](const size_t id) { return id; };
+  ParseRatings(filename, ratings, identity, identity, chunkSize);
+}
+
+void LoadRatings(const std::string& filename,
+                 arma::sp_mat& ratings,
+                 arma::Col<size_t>& userIDs,
+                 arma::Col<size_t>& itemIDs,
+                 const size_t chunkSize)
+{
+  std::unordered_map<size_t, size_t> userMap, itemMap;
+  std::vector<size_t> users, items;
+
+  // Each new ID gets the next index.
+  auto mapUser = [&](const size_t id)
+  {
+    auto result = userMap.insert(std::make_pair(id, users.size()));
+    if (result.second)
+      users.push_back(id);
+    return result.first->second;
+  };
+  auto mapItem = [&](const size_t id)
+  {
+    auto result = itemMap.insert(std::make_pair(id, items.size()));
+    if (result.second)
+      items.push_back(id);
+    return result.first->second;
+  };
+
+  ParseRatings(filename, ratings, mapUser, mapItem, chunkSize);
+
+  userIDs = arma::Col<size_t>(users);
+  itemIDs = arma::Col<size_t>(items);
+}
+
+} // namespace cf
+} // namespace mlpack
@@ -0,0 +1,69 @@
+/**
+ * @file load_ratings.hpp
+ *
+ * Functions to load a (user, item, rating) file directly into a sparse rating
+ * matrix, without holding the whole coordinate list in memory.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_CF_LOAD_RATINGS_HPP
+#define MLPACK_METHODS_CF_LOAD_RATINGS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace cf {
+
+/**
+ * Load a ratings file into a sparse rating matrix (items x users), as
+ * CFType::CleanData() would build from the same file loaded with data::Load().
+ * Each line of the file holds a user ID, an item ID and a rating, separated by
+ * commas, tabs or spaces; empty lines are skipped.  The IDs are used as the
+ * column and row of the rating, so the matrix has (largest user ID + 1)
+ * columns and (largest item ID + 1) rows.  As with CleanData(), ratings of
+ * zero are ignored.
+ *
+ * The file is read and parsed in chunks of the given size, and the locations
+ * and values of the ratings are appended to the arrays that the sparse matrix
+ * is batch-inserted from, so the ratings are only held once before the matrix
+ * is built (instead of also as a dense coordinate list).
+ *
+ * If the file cannot be read or a line cannot be parsed, std::runtime_error is
+ * thrown.
+ *
+ * @param filename Ratings file to load.
+ * @param ratings Sparse matrix to store the ratings in.
+ * @param chunkSize Number of bytes of the file to read at once.
+ */
+void LoadRatings(const std::string& filename,
+                 arma::sp_mat& ratings,
+                 const size_t chunkSize = (1 << 24));
+
+/**
+ * Load a ratings file into a sparse rating matrix (items x users), mapping the
+ * user and item IDs of the file to contiguous indices, in the order they are
+ * first seen.  The mapping is built as the file is parsed, so the IDs may be
+ * arbitrary (sparse) integers.  After loading, userIDs[u] is the ID in the file
+ * of the user in column u, and itemIDs[i] is the ID of the item in row i.
+ *
+ * The file format is the same as for the other overload of LoadRatings().
+ *
+ * @param filename Ratings file to load.
+ * @param ratings Sparse matrix to store the ratings in.
+ * @param userIDs Will be set to the file IDs of the users.
+ * @param itemIDs Will be set to the file IDs of the items.
+ * @param chunkSize Number of bytes of the file to read at once.
+ */
+void LoadRatings(const std::string& filename,
+                 arma::sp_mat& ratings,
+                 arma::Col<size_t>& userIDs,
+                 arma::Col<size_t>& itemIDs,
+                 const size_t chunkSize = (1 << 24));
+
+} // namespace cf
+} // namespace mlpack
+
+#endif
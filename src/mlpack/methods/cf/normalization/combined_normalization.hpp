@@ -60,6 +60,18 @@ class CombinedNormalization
     SequenceNormalize<0>(data);
   }
 
+  /**
+   * Normalize the ratings of a single (possibly new) user by calling
+   * NormalizeUser() in each normalization object.
+   *
+   * @param user User ID.
+   * @param ratings Ratings of the user (one element per item).
+   */
+  void NormalizeUser(const size_t user, arma::sp_vec& ratings)
+  {
+    SequenceNormalizeUser<0>(user, ratings);
+  }
+
   /**
    * Denormalize rating by calling Denormalize() in each normalization object.
    * Note that the order of objects calling Denormalize() should be the
@@ -130,6 +142,24 @@ class CombinedNormalization
       typename = void>
   void SequenceNormalize(MatType& /* data */) { }
 
+  //! Unpack normalizations tuple to normalize the ratings of a user.
+  template<
+      int I, /* Which normalization in tuple to use */
+      typename = std::enable_if_t<(I < std::tuple_size<TupleType>::value)>>
+  void SequenceNormalizeUser(const size_t user, arma::sp_vec& ratings)
+  {
+    std::get<I>(normalizations).NormalizeUser(user, ratings);
+    SequenceNormalizeUser<I+1>(user, ratings);
+  }
+
+  //! End of tuple unpacking.
+  template<
+      int I, /* Which normalization in tuple to use */
+      typename = std::enable_if_t<(I >= std::tuple_size<TupleType>::value)>,
+      typename = void>
+  void SequenceNormalizeUser(const size_t /* user */,
+                             arma::sp_vec& /* ratings */) { }
+
   //! Unpack normalizations tuple to denormalize.
   template<
       int I, /* Which normalization in tuple to use */
@@ -36,6 +36,15 @@ class NoNormalization
   template<typename MatType>
   inline void Normalize(const MatType& /* data */) const { }
 
+  /**
+   * Do nothing.
+   *
+   * @param user User ID.
+   * @param ratings Ratings of the user (one element per item).
+   */
+  inline void NormalizeUser(const size_t /* user */,
+                            const arma::sp_vec& /* ratings */) const { }
+
   /**
    * Do nothing.
    *
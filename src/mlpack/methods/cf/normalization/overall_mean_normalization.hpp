@@ -90,6 +90,26 @@ class OverallMeanNormalization
     }
   }
 
+  /**
+   * Normalize the ratings of a single (possibly new) user by subtracting the
+   * mean computed by Normalize().
+   *
+   * @param user User ID.
+   * @param ratings Ratings of the user (one element per item).
+   */
+  void NormalizeUser(const size_t /* user */, arma::sp_vec& ratings) const
+  {
+    arma::sp_vec::iterator it = ratings.begin();
+    for (; it != ratings.end(); ++it)
+    {
+      *it = *it - mean;
+      // The algorithm omits rating of zero. If normalized rating equals zero,
+      // it is set to the smallest positive double value.
+      if (*it == 0)
+        *it = std::numeric_limits<double>::min();
+    }
+  }
+
   /**
    * Denormalize computed rating by adding mean.
    *
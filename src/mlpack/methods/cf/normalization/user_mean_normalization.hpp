@@ -117,6 +117,33 @@ class UserMeanNormalization
     }
   }
 
+  /**
+   * Normalize the ratings of a single user by subtracting the mean of the
+   * given ratings, which becomes the user's mean.  If the user is new (its ID
+   * is the number of users seen so far), its mean is added.
+   *
+   * @param user User ID.
+   * @param ratings Ratings of the user (one element per item).
+   */
+  void NormalizeUser(const size_t user, arma::sp_vec& ratings)
+  {
+    if (user >= userMean.n_elem)
+      userMean.resize(user + 1);
+
+    userMean(user) = (ratings.n_nonzero == 0) ? 0.0 :
+        arma::accu(ratings) / ratings.n_nonzero;
+
+    arma::sp_vec::iterator it = ratings.begin();
+    for (; it != ratings.end(); ++it)
+    {
+      *it = *it - userMean(user);
+      // The algorithm omits rating of zero. If normalized rating equals zero,
+      // it is set to the smallest positive double value.
+      if (*it == 0)
+        *it = std::numeric_limits<double>::min();
+    }
+  }
+
   /**
    * Denormalize computed rating by adding user mean.
    *
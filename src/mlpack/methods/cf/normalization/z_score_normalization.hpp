@@ -100,6 +100,26 @@ class ZScoreNormalization
     }
   }
 
+  /**
+   * Normalize the ratings of a single (possibly new) user with the mean and
+   * standard deviation computed by Normalize().
+   *
+   * @param user User ID.
+   * @param ratings Ratings of the user (one element per item).
+   */
+  void NormalizeUser(const size_t /* user */, arma::sp_vec& ratings) const
+  {
+    arma::sp_vec::iterator it = ratings.begin();
+    for (; it != ratings.end(); ++it)
+    {
+      *it = (*it - mean) / stddev;
+      // The algorithm omits rating of zero. If normalized rating equals zero,
+      // it is set to the smallest positive double value.
+      if (*it == 0)
+        *it = std::numeric_limits<double>::min();
+    }
+  }
+
   /**
    * Denormalize computed rating by adding mean and multiplying stddev.
    *
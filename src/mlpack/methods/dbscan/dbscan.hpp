@@ -16,8 +16,10 @@
 #include <mlpack/core.hpp>
 #include <mlpack/methods/range_search/range_search.hpp>
 #include <mlpack/methods/emst/union_find.hpp>
+#include <mlpack/methods/emst/concurrent_union_find.hpp>
 #include "random_point_selection.hpp"
 #include "ordered_point_selection.hpp"
+#include "grid_range_search.hpp"
 #include <boost/dynamic_bitset.hpp>
 
 namespace mlpack {
@@ -44,6 +46,10 @@ namespace dbscan {
  * range search technique used and the point selection strategy by means of
  * template parameters.
  *
+ * For low-dimensional data, GridRangeSearch can be used as the
+ * RangeSearchType; in batch mode, the clusters are then found from the cells
+ * of a grid with few distance calculations.
+ *
  * @tparam RangeSearchType Class to use for range searching.
  * @tparam PointSelectionPolicy Strategy for selecting next point to cluster
  *      with.
@@ -54,11 +60,12 @@ class DBSCAN
 {
  public:
   /**
-   * Construct the DBSCAN object with the given parameters.  The batchMode
-   * parameter should be set to false in the case where RAM issues will be
-   * encountered (i.e. if the dataset is very large or if epsilon is large).
-   * When batchMode is false, each point will be searched iteratively, which
-   * could be slower but will use less memory.
+   * Construct the DBSCAN object with the given parameters.  When batchMode is
+   * false, each point will be searched iteratively, which is usually slower.
+   * When batchMode is true, the range search runs with all available threads,
+   * whether it is a dual-tree or single-tree search.  In either mode the
+   * neighborhoods found by the range searches are consumed as they are found
+   * and never stored, so memory use does not grow with epsilon.
    *
    * @param epsilon Size of range query.
    * @param minPoints Minimum number of points for each cluster.
@@ -146,15 +153,16 @@ class DBSCAN
   /**
    * Performs DBSCAN clustering on the data, returning number of clusters
    * and also the list of cluster assignments.  This can perform search in batch,
-   * so it is well suited for dual-tree or naive search.
+   * so it is well suited for dual-tree or naive search.  The search uses all
+   * available threads.
    *
    * @param data Dataset to cluster.
    * @param assignments Assignments for each point.
-   * @param uf UnionFind structure that will be modified.
+   * @param uf ConcurrentUnionFind structure that will be modified.
    */
   template<typename MatType>
   void BatchCluster(const MatType& data,
-                    emst::UnionFind& uf);
+                    emst::ConcurrentUnionFind& uf);
 };
 
 } // namespace dbscan
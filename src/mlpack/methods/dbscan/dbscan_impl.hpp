@@ -17,6 +17,47 @@
 namespace mlpack {
 namespace dbscan {
 
+//! Check whether a range search type can unite the points in range itself.
+HAS_MEM_FUNC(ParallelUnion, HasParallelUnion);
+
+//! Unite all the points in range of each other with a range search type that
+//! can do it directly (like GridRangeSearch).
+template<typename RangeSearchType>
+void ParallelUnion(RangeSearchType& rangeSearch,
+                   const math::Range& range,
+                   emst::ConcurrentUnionFind& uf,
+                   const typename std::enable_if_t<HasParallelUnion<
+                       RangeSearchType, void(RangeSearchType::*)(
+                       const math::Range&, emst::ConcurrentUnionFind&)>::value>*
+                       = 0)
+{
+  rangeSearch.ParallelUnion(range, uf);
+}
+
+//! Unite all the points in range of each other, as they are found by the
+//! range search.
+template<typename RangeSearchType>
+void ParallelUnion(RangeSearchType& rangeSearch,
+                   const math::Range& range,
+                   emst::ConcurrentUnionFind& uf,
+                   const typename std::enable_if_t<!HasParallelUnion<
+                       RangeSearchType, void(RangeSearchType::*)(
+                       const math::Range&, emst::ConcurrentUnionFind&)>::value>*
+                       = 0)
+{
+  // Union to each neighbor as it is found, so that the neighborhoods are never
+  // stored.  The resulting clusters do not depend on the order of the unions,
+  // so the search runs with all threads, which may call this concurrently.
+  auto unionNeighbor = [&uf](const size_t index,
+                             const size_t neighbor,
+                             const double /* distance */)
+  {
+    uf.Union(index, neighbor);
+  };
+
+  rangeSearch.ParallelSearch(range, unionNeighbor);
+}
+
 /**
  * Construct the DBSCAN object with the given parameters.
  */
@@ -100,19 +141,30 @@ size_t DBSCAN<RangeSearchType, PointSelectionPolicy>::Cluster(
     const MatType& data,
     arma::Row<size_t>& assignments)
 {
-  // Initialize the UnionFind object.
-  emst::UnionFind uf(data.n_cols);
   rangeSearch.Train(data);
 
+  // Find the connected components of the points, and set assignments to the
+  // index of the component of each point.
+  assignments.set_size(data.n_cols);
   if (batchMode)
+  {
+    // The range search is run with all threads, so the components are found
+    // with a concurrent UnionFind object.
+    emst::ConcurrentUnionFind uf(data.n_cols);
     BatchCluster(data, uf);
+
+    #pragma omp parallel for
+    for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
+      assignments[i] = uf.Find(i);
+  }
   else
+  {
+    emst::UnionFind uf(data.n_cols);
     PointwiseCluster(data, uf);
 
-  // Now set assignments.
-  assignments.set_size(data.n_cols);
-  for (size_t i = 0; i < data.n_cols; ++i)
-    assignments[i] = uf.Find(i);
+    for (size_t i = 0; i < data.n_cols; ++i)
+      assignments[i] = uf.Find(i);
+  }
 
   // Get a count of all clusters.
   const size_t numClusters = arma::max(assignments) + 1;
@@ -152,21 +204,20 @@ void DBSCAN<RangeSearchType, PointSelectionPolicy>::PointwiseCluster(
     const MatType& data,
     emst::UnionFind& uf)
 {
-  std::vector<std::vector<size_t>> neighbors;
-  std::vector<std::vector<double>> distances;
-
   for (size_t i = 0; i < data.n_cols; ++i)
   {
     if (i % 10000 == 0 && i > 0)
       Log::Info << "DBSCAN clustering on point " << i << "..." << std::endl;
 
-    // Do the range search for only this point.
-    rangeSearch.Search(data.col(i), math::Range(0.0, epsilon), neighbors,
-        distances);
-
-    // Union to all neighbors.
-    for (size_t j = 0; j < neighbors[0].size(); ++j)
-      uf.Union(i, neighbors[0][j]);
+    // Do the range search for only this point, and union to all neighbors as
+    // they are found.
+    auto unionNeighbor = [&uf, i](const size_t /* queryIndex */,
+                                  const size_t neighbor,
+                                  const double /* distance */)
+    {
+      uf.Union(i, neighbor);
+    };
+    rangeSearch.Search(data.col(i), math::Range(0.0, epsilon), unionNeighbor);
   }
 }
 
@@ -178,25 +229,14 @@ void DBSCAN<RangeSearchType, PointSelectionPolicy>::PointwiseCluster(
 template<typename RangeSearchType, typename PointSelectionPolicy>
 template<typename MatType>
 void DBSCAN<RangeSearchType, PointSelectionPolicy>::BatchCluster(
-    const MatType& data,
-    emst::UnionFind& uf)
+    const MatType& /* data */,
+    emst::ConcurrentUnionFind& uf)
 {
-  // For each point, find the points in epsilon-nighborhood and their distances.
-  std::vector<std::vector<size_t>> neighbors;
-  std::vector<std::vector<double>> distances;
+  // For each point, find the points in its epsilon-neighborhood, and union to
+  // each of them.  The range search was trained on the data by Cluster().
   Log::Info << "Performing range search." << std::endl;
-  rangeSearch.Train(data);
-  rangeSearch.Search(data, math::Range(0.0, epsilon), neighbors, distances);
+  ParallelUnion(rangeSearch, math::Range(0.0, epsilon), uf);
   Log::Info << "Range search complete." << std::endl;
-
-  // Now loop over all points.
-  for (size_t i = 0; i < data.n_cols; ++i)
-  {
-    // Get the next index.
-    const size_t index = pointSelector.Select(i, data);
-    for (size_t j = 0; j < neighbors[index].size(); ++j)
-      uf.Union(index, neighbors[index][j]);
-  }
 }
 
 } // namespace dbscan
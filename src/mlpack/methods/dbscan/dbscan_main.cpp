@@ -55,7 +55,10 @@ PROGRAM_INFO("DBSCAN clustering",
     PRINT_PARAM_STRING("naive") + " parameters.  " +
     PRINT_PARAM_STRING("tree_type") + " can control the type of tree used for "
     "range search; this can take a variety of values: 'kd', 'r', 'r-star', 'x',"
-    " 'hilbert-r', 'r-plus', 'r-plus-plus', 'cover', 'ball'. The " +
+    " 'hilbert-r', 'r-plus', 'r-plus-plus', 'cover', 'ball', or 'grid'.  "
+    "'grid' does not use a tree, but a uniform grid of cells of the size of "
+    "the radius, which is much faster for low-dimensional data (like "
+    "geographic points, in two or three dimensions).  The " +
     PRINT_PARAM_STRING("single_mode") + " parameter will force single-tree "
     "search (as opposed to the default dual-tree search), and '" +
     PRINT_PARAM_STRING("naive") + " will force brute-force range search."
@@ -82,7 +85,7 @@ PARAM_INT_IN("min_size", "Minimum number of points for a cluster.", "m", 5);
 
 PARAM_STRING_IN("tree_type", "If using single-tree or dual-tree search, the "
     "type of tree to use ('kd', 'r', 'r-star', 'x', 'hilbert-r', 'r-plus', "
-    "'r-plus-plus', 'cover', 'ball').", "t", "kd");
+    "'r-plus-plus', 'cover', 'ball', 'grid').", "t", "kd");
 PARAM_STRING_IN("selection_type", "If using point selection policy, the "
     "type of selection to use ('ordered', 'random').", "s", "ordered");
 PARAM_FLAG("single_mode", "If set, single-tree range search (not dual-tree) "
@@ -145,7 +148,7 @@ static void mlpackMain()
   ReportIgnoredParam({{ "naive", true }}, "single_mode");
 
   RequireParamInSet<string>("tree_type", { "kd", "cover", "r", "r-star", "x",
-      "hilbert-r", "r-plus", "r-plus-plus", "ball" }, true,
+      "hilbert-r", "r-plus", "r-plus-plus", "ball", "grid" }, true,
       "unknown tree type");
 
   // Value of epsilon should be positive.
@@ -209,5 +212,9 @@ static void mlpackMain()
       ChoosePointSelectionPolicy<RangeSearch<EuclideanDistance, arma::mat,
           BallTree>>();
     }
+    else if (treeType == "grid")
+    {
+      ChoosePointSelectionPolicy<GridRangeSearch<>>();
+    }
   }
 }
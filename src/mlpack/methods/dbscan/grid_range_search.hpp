@@ -0,0 +1,207 @@
+/**
+ * @file grid_range_search.hpp
+ *
+ * Range search on a uniform grid of cells, for low-dimensional data (like
+ * geographic points), with the API that DBSCAN needs from its RangeSearchType.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DBSCAN_GRID_RANGE_SEARCH_HPP
+#define MLPACK_METHODS_DBSCAN_GRID_RANGE_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/range.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+#include <mlpack/methods/emst/concurrent_union_find.hpp>
+
+namespace mlpack {
+namespace dbscan {
+
+/**
+ * GridRangeSearch finds the points within a range of Euclidean distances of
+ * each query point by dividing space into a uniform grid of cells whose
+ * diagonal is (just under) the upper bound of the range, so that only a fixed
+ * set of neighboring cells needs to be visited for each point.  The grid is
+ * built for the upper bound of the range the first time it is searched with,
+ * and rebuilt only if the upper bound changes.
+ *
+ * This can be used as the RangeSearchType of DBSCAN.  With batch mode,
+ * DBSCAN then uses ParallelUnion() instead of reporting every pair of points:
+ * all the points of a cell are within range of each other, so they are united
+ * without any distance calculations, and two neighboring cells are united as
+ * soon as one pair of their points is found to be in range (or skipped if
+ * they are already in the same cluster).
+ *
+ * The number of neighboring cells grows exponentially with the
+ * dimensionality, so this is only suitable for data of two to four or so
+ * dimensions; for higher dimensions, a tree-based RangeSearch is better.
+ *
+ * @tparam MatType Type of data matrix.
+ */
+template<typename MatType = arma::mat>
+class GridRangeSearch
+{
+ public:
+  /**
+   * Create the GridRangeSearch object.  The singleMode parameter is ignored
+   * (every search visits the cells of each query point), and exists only so
+   * that this can be used in place of RangeSearch.
+   *
+   * @param singleMode Ignored.
+   */
+  GridRangeSearch(const bool singleMode = false);
+
+  /**
+   * Set the reference set to the given dataset.  The grid is built when it is
+   * first searched.
+   *
+   * @param referenceSet New reference set to use.
+   */
+  void Train(MatType referenceSet);
+
+  /**
+   * Search for all reference points in the given range for each point in the
+   * query set, passing each result to the given callback, which must be
+   * callable as
+   *
+   * @code
+   * callback(queryIndex, referenceIndex, distance);
+   * @endcode
+   *
+   * The callback is only ever called from one thread.
+   *
+   * @param querySet Set of query points to search with.
+   * @param range Range of distances in which to search.
+   * @param callback Callback to pass each result to.
+   */
+  template<typename CallbackType>
+  void Search(const MatType& querySet,
+              const math::Range& range,
+              CallbackType& callback);
+
+  /**
+   * Search for all points in the given range for each point in the reference
+   * set, passing each result to the given callback.  A point is never passed
+   * as its own result.
+   *
+   * @param range Range of distances in which to search.
+   * @param callback Callback to pass each result to.
+   */
+  template<typename CallbackType>
+  void Search(const math::Range& range, CallbackType& callback);
+
+  /**
+   * Search for all points in the given range for each point in the query set,
+   * like Search(), but with the query points split between all available
+   * threads.  The callback may be called concurrently, and must be
+   * thread-safe.
+   *
+   * @param querySet Set of query points to search with.
+   * @param range Range of distances in which to search.
+   * @param callback Thread-safe callback to pass each result to.
+   */
+  template<typename CallbackType>
+  void ParallelSearch(const MatType& querySet,
+                      const math::Range& range,
+                      CallbackType& callback);
+
+  /**
+   * Search for all points in the given range for each point in the reference
+   * set, with the cells split between all available threads.  The callback
+   * may be called concurrently, and must be thread-safe.  A point is never
+   * passed as its own result.
+   *
+   * @param range Range of distances in which to search.
+   * @param callback Thread-safe callback to pass each result to.
+   */
+  template<typename CallbackType>
+  void ParallelSearch(const math::Range& range, CallbackType& callback);
+
+  /**
+   * Unite, in the given union-find structure, every pair of reference points
+   * whose distance is in the given range, with the cells split between all
+   * available threads.  The result is the same as calling uf.Union() for
+   * every pair found by ParallelSearch(), but much cheaper, since not every
+   * pair is visited.  If the lower bound of the range is not zero, this just
+   * unites every pair found by ParallelSearch().
+   *
+   * @param range Range of distances in which to unite points.
+   * @param uf Union-find structure to unite points in.
+   */
+  void ParallelUnion(const math::Range& range, emst::ConcurrentUnionFind& uf);
+
+  //! Get whether single mode was requested (this is ignored).
+  bool SingleMode() const { return singleMode; }
+  //! Modify whether single mode was requested (this is ignored).
+  bool& SingleMode() { return singleMode; }
+
+  //! Get the reference set.
+  const MatType& ReferenceSet() const { return referenceSet; }
+
+  //! Get the width of each cell of the grid (0 if it has not been built).
+  double CellWidth() const { return cellWidth; }
+  //! Get the number of non-empty cells of the grid.
+  size_t NumCells() const { return cellBegins.empty() ? 0 :
+      cellBegins.size() - 1; }
+
+ private:
+  //! Ignored.
+  bool singleMode;
+  //! The reference set.
+  MatType referenceSet;
+
+  //! The upper bound of the range the grid was built for (0 if not built).
+  double radius;
+  //! The width of each cell.
+  double cellWidth;
+  //! The minimum of each dimension of the reference set.
+  arma::vec minimums;
+  //! The reference points, ordered by cell.
+  std::vector<size_t> order;
+  //! The index in order of the first point of each cell, followed by the
+  //! number of points.
+  std::vector<size_t> cellBegins;
+  //! The coordinates of each cell, with one column per cell, sorted
+  //! lexicographically.
+  arma::Mat<arma::sword> cellCoordinates;
+  //! The offsets (with one column per offset) of the cells that may hold
+  //! points in range of the points in a cell.
+  arma::Mat<arma::sword> neighborOffsets;
+
+  //! Build the grid for the given range, if it has not been built for it.
+  void BuildGrid(const math::Range& range);
+
+  //! Compute the cell coordinates of the given point.
+  void CellOf(const MatType& points,
+              const size_t point,
+              arma::sword* coordinates) const;
+
+  //! Find the cell with the given coordinates, returning NumCells() if it is
+  //! empty.
+  size_t FindCell(const arma::sword* coordinates) const;
+
+  //! Find the non-empty cells around the given cell coordinates.
+  void NeighborCells(const arma::sword* coordinates,
+                     std::vector<size_t>& cells) const;
+
+  //! Pass the reference points of the given cells that are in range of the
+  //! given query point to the callback.
+  template<typename CallbackType>
+  void SearchPoint(const MatType& querySet,
+                   const size_t queryIndex,
+                   const std::vector<size_t>& cells,
+                   const math::Range& range,
+                   const bool skipSelf,
+                   CallbackType& callback) const;
+};
+
+} // namespace dbscan
+} // namespace mlpack
+
+// Include implementation.
+#include "grid_range_search_impl.hpp"
+
+#endif
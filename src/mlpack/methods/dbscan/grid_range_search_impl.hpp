@@ -0,0 +1,396 @@
+/**
+ * @file grid_range_search_impl.hpp
+ *
+ * Implementation of range search on a uniform grid of cells.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DBSCAN_GRID_RANGE_SEARCH_IMPL_HPP
+#define MLPACK_METHODS_DBSCAN_GRID_RANGE_SEARCH_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "grid_range_search.hpp"
+
+namespace mlpack {
+namespace dbscan {
+
+template<typename MatType>
+GridRangeSearch<MatType>::GridRangeSearch(const bool singleMode) :
+    singleMode(singleMode),
+    radius(0.0),
+    cellWidth(0.0)
+{
+  // Nothing to do.
+}
+
+template<typename MatType>
+void GridRangeSearch<MatType>::Train(MatType referenceSet)
+{
+  this->referenceSet = std::move(referenceSet);
+
+  // The grid is rebuilt by the next search.
+  radius = 0.0;
+  cellWidth = 0.0;
+  cellBegins.clear();
+}
+
+template<typename MatType>
+template<typename CallbackType>
+void GridRangeSearch<MatType>::Search(const MatType& querySet,
+                                      const math::Range& range,
+                                      CallbackType& callback)
+{
+  if (querySet.n_rows != referenceSet.n_rows)
+    throw std::invalid_argument("GridRangeSearch::Search(): dimensionality of "
+        "query set does not match dimensionality of reference set");
+
+  BuildGrid(range);
+
+  arma::Col<arma::sword> coordinates(referenceSet.n_rows);
+  std::vector<size_t> cells;
+  for (size_t i = 0; i < querySet.n_cols; ++i)
+  {
+    CellOf(querySet, i, coordinates.memptr());
+    NeighborCells(coordinates.memptr(), cells);
+    SearchPoint(querySet, i, cells, range, false, callback);
+  }
+}
+
+template<typename MatType>
+template<typename CallbackType>
+void GridRangeSearch<MatType>::Search(const math::Range& range,
+                                      CallbackType& callback)
+{
+  BuildGrid(range);
+
+  // All the points of a cell have the same neighboring cells.
+  std::vector<size_t> cells;
+  for (size_t c = 0; c < NumCells(); ++c)
+  {
+    NeighborCells(cellCoordinates.colptr(c), cells);
+    for (size_t i = cellBegins[c]; i < cellBegins[c + 1]; ++i)
+      SearchPoint(referenceSet, order[i], cells, range, true, callback);
+  }
+}
+
+template<typename MatType>
+template<typename CallbackType>
+void GridRangeSearch<MatType>::ParallelSearch(const MatType& querySet,
+                                              const math::Range& range,
+                                              CallbackType& callback)
+{
+  if (querySet.n_rows != referenceSet.n_rows)
+    throw std::invalid_argument("GridRangeSearch::ParallelSearch(): "
+        "dimensionality of query set does not match dimensionality of "
+        "reference set");
+
+  BuildGrid(range);
+
+  #pragma omp parallel
+  {
+    arma::Col<arma::sword> coordinates(referenceSet.n_rows);
+    std::vector<size_t> cells;
+
+    #pragma omp for schedule(dynamic, 64)
+    for (omp_size_t i = 0; i < (omp_size_t) querySet.n_cols; ++i)
+    {
+      CellOf(querySet, i, coordinates.memptr());
+      NeighborCells(coordinates.memptr(), cells);
+      SearchPoint(querySet, i, cells, range, false, callback);
+    }
+  }
+}
+
+template<typename MatType>
+template<typename CallbackType>
+void GridRangeSearch<MatType>::ParallelSearch(const math::Range& range,
+                                              CallbackType& callback)
+{
+  BuildGrid(range);
+
+  // The cells hold very different numbers of points, so they are scheduled
+  // dynamically.
+  #pragma omp parallel
+  {
+    std::vector<size_t> cells;
+
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t c = 0; c < (omp_size_t) NumCells(); ++c)
+    {
+      NeighborCells(cellCoordinates.colptr(c), cells);
+      for (size_t i = cellBegins[c]; i < cellBegins[c + 1]; ++i)
+        SearchPoint(referenceSet, order[i], cells, range, true, callback);
+    }
+  }
+}
+
+template<typename MatType>
+void GridRangeSearch<MatType>::ParallelUnion(const math::Range& range,
+                                             emst::ConcurrentUnionFind& uf)
+{
+  // Only the points in a ball are all in range of each other.
+  if (range.Lo() > 0.0)
+  {
+    auto unite = [&uf](const size_t i,
+                       const size_t j,
+                       const double /* distance */)
+    {
+      uf.Union(i, j);
+    };
+    ParallelSearch(range, unite);
+    return;
+  }
+
+  BuildGrid(range);
+
+  #pragma omp parallel
+  {
+    // The diagonal of a cell is less than the radius, so all the points of a
+    // cell are in range of each other.
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t c = 0; c < (omp_size_t) NumCells(); ++c)
+    {
+      for (size_t i = cellBegins[c] + 1; i < cellBegins[c + 1]; ++i)
+        uf.Union(order[cellBegins[c]], order[i]);
+    }
+
+    // Two neighboring cells only need to be united once, by the first pair of
+    // their points that is in range, and not at all if they have already been
+    // united through other cells.
+    std::vector<size_t> cells;
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t c = 0; c < (omp_size_t) NumCells(); ++c)
+    {
+      NeighborCells(cellCoordinates.colptr(c), cells);
+      for (size_t n = 0; n < cells.size(); ++n)
+      {
+        const size_t other = cells[n];
+        if (other <= (size_t) c || uf.Find(order[cellBegins[c]]) ==
+            uf.Find(order[cellBegins[other]]))
+          continue;
+
+        bool united = false;
+        for (size_t i = cellBegins[c]; i < cellBegins[c + 1] && !united; ++i)
+        {
+          for (size_t j = cellBegins[other]; j < cellBegins[other + 1]; ++j)
+          {
+            const double distance = metric::EuclideanDistance::Evaluate(
+                referenceSet.col(order[i]), referenceSet.col(order[j]));
+            if (range.Contains(distance))
+            {
+              uf.Union(order[i], order[j]);
+              united = true;
+              break;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+template<typename MatType>
+void GridRangeSearch<MatType>::BuildGrid(const math::Range& range)
+{
+  if (!std::isfinite(range.Hi()) || range.Hi() <= 0.0)
+    throw std::invalid_argument("GridRangeSearch: the upper bound of the range "
+        "must be positive and finite");
+
+  if (cellWidth > 0.0 && range.Hi() == radius)
+    return;
+
+  const size_t dims = referenceSet.n_rows;
+  radius = range.Hi();
+
+  // Just under radius / sqrt(dims), so that the points of a cell are in range
+  // of each other even with the rounding of their cell coordinates.
+  cellWidth = 0.999 * radius / std::sqrt((double) std::max(dims, (size_t) 1));
+
+  minimums.set_size(dims);
+  minimums.fill(DBL_MAX);
+  arma::vec maximums(dims);
+  maximums.fill(-DBL_MAX);
+  for (size_t i = 0; i < referenceSet.n_cols; ++i)
+  {
+    for (size_t d = 0; d < dims; ++d)
+    {
+      minimums[d] = std::min(minimums[d], (double) referenceSet(d, i));
+      maximums[d] = std::max(maximums[d], (double) referenceSet(d, i));
+    }
+  }
+
+  // The cell coordinates must be small enough to be exact in a double.
+  for (size_t d = 0; d < dims && referenceSet.n_cols > 0; ++d)
+  {
+    if ((maximums[d] - minimums[d]) / cellWidth > std::pow(2.0, 40.0))
+    {
+      cellWidth = 0.0;
+      throw std::invalid_argument("GridRangeSearch: the range is too small "
+          "relative to the extent of the reference set for a grid");
+    }
+  }
+
+  // Find the offsets of the cells that may hold points in range of the points
+  // of a cell: the gap between the cells along each dimension is one less
+  // than the offset (with some slack for rounding).
+  const arma::sword reach = 1 + (arma::sword) std::floor(radius / cellWidth);
+  double numOffsets = std::pow(2.0 * reach + 1.0, (double) dims);
+  if (numOffsets > 1e6)
+  {
+    cellWidth = 0.0;
+    throw std::invalid_argument("GridRangeSearch: the dimensionality of the "
+        "reference set is too high for a grid");
+  }
+
+  std::vector<arma::sword> offsets;
+  arma::Col<arma::sword> offset(dims);
+  offset.fill(-reach);
+  for (size_t o = 0; o < (size_t) numOffsets; ++o)
+  {
+    double gap = 0.0;
+    for (size_t d = 0; d < dims; ++d)
+    {
+      const double g = std::max(std::abs((double) offset[d]) - 1.001, 0.0);
+      gap += g * g;
+    }
+
+    if (gap * cellWidth * cellWidth <= radius * radius)
+      offsets.insert(offsets.end(), offset.begin(), offset.end());
+
+    // Move to the next offset.
+    for (size_t d = 0; d < dims; ++d)
+    {
+      if (++offset[d] <= reach)
+        break;
+      offset[d] = -reach;
+    }
+  }
+  neighborOffsets = arma::Mat<arma::sword>(offsets.data(), dims,
+      offsets.size() / std::max(dims, (size_t) 1));
+
+  // Sort the points by cell.
+  arma::Mat<arma::sword> pointCoordinates(dims, referenceSet.n_cols);
+  for (size_t i = 0; i < referenceSet.n_cols; ++i)
+    CellOf(referenceSet, i, pointCoordinates.colptr(i));
+
+  order.resize(referenceSet.n_cols);
+  for (size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+  std::sort(order.begin(), order.end(),
+      [&pointCoordinates, dims](const size_t a, const size_t b)
+      {
+        return std::lexicographical_compare(pointCoordinates.colptr(a),
+            pointCoordinates.colptr(a) + dims, pointCoordinates.colptr(b),
+            pointCoordinates.colptr(b) + dims);
+      });
+
+  // Each run of points with the same coordinates is a cell.
+  cellBegins.clear();
+  std::vector<size_t> cellPoints;
+  for (size_t i = 0; i < order.size(); ++i)
+  {
+    if (i == 0 || !std::equal(pointCoordinates.colptr(order[i]),
+        pointCoordinates.colptr(order[i]) + dims,
+        pointCoordinates.colptr(order[i - 1])))
+    {
+      cellBegins.push_back(i);
+      cellPoints.push_back(order[i]);
+    }
+  }
+  cellBegins.push_back(order.size());
+
+  cellCoordinates.set_size(dims, cellPoints.size());
+  for (size_t c = 0; c < cellPoints.size(); ++c)
+    cellCoordinates.col(c) = pointCoordinates.col(cellPoints[c]);
+
+  Log::Info << "GridRangeSearch: built grid with " << NumCells() << " cells "
+      << "of width " << cellWidth << "." << std::endl;
+}
+
+template<typename MatType>
+void GridRangeSearch<MatType>::CellOf(const MatType& points,
+                                      const size_t point,
+                                      arma::sword* coordinates) const
+{
+  for (size_t d = 0; d < points.n_rows; ++d)
+  {
+    // Query points may be far outside the reference set; their cells are
+    // empty anyway, so the coordinates are clamped to stay representable.
+    const double c = std::floor((points(d, point) - minimums[d]) / cellWidth);
+    coordinates[d] = (arma::sword) std::max(std::min(c, 1e15), -1e15);
+  }
+}
+
+template<typename MatType>
+size_t GridRangeSearch<MatType>::FindCell(const arma::sword* coordinates) const
+{
+  const size_t dims = cellCoordinates.n_rows;
+  size_t lo = 0;
+  size_t hi = NumCells();
+  while (lo < hi)
+  {
+    const size_t mid = (lo + hi) / 2;
+    if (std::lexicographical_compare(cellCoordinates.colptr(mid),
+        cellCoordinates.colptr(mid) + dims, coordinates, coordinates + dims))
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  if (lo < NumCells() && std::equal(coordinates, coordinates + dims,
+      cellCoordinates.colptr(lo)))
+    return lo;
+
+  return NumCells();
+}
+
+template<typename MatType>
+void GridRangeSearch<MatType>::NeighborCells(const arma::sword* coordinates,
+                                             std::vector<size_t>& cells) const
+{
+  const size_t dims = neighborOffsets.n_rows;
+  cells.clear();
+  std::vector<arma::sword> neighbor(dims);
+  for (size_t o = 0; o < neighborOffsets.n_cols; ++o)
+  {
+    for (size_t d = 0; d < dims; ++d)
+      neighbor[d] = coordinates[d] + neighborOffsets(d, o);
+
+    const size_t cell = FindCell(neighbor.data());
+    if (cell != NumCells())
+      cells.push_back(cell);
+  }
+}
+
+template<typename MatType>
+template<typename CallbackType>
+void GridRangeSearch<MatType>::SearchPoint(const MatType& querySet,
+                                           const size_t queryIndex,
+                                           const std::vector<size_t>& cells,
+                                           const math::Range& range,
+                                           const bool skipSelf,
+                                           CallbackType& callback) const
+{
+  for (size_t n = 0; n < cells.size(); ++n)
+  {
+    for (size_t i = cellBegins[cells[n]]; i < cellBegins[cells[n] + 1]; ++i)
+    {
+      const size_t reference = order[i];
+      if (skipSelf && reference == queryIndex)
+        continue;
+
+      const double distance = metric::EuclideanDistance::Evaluate(
+          querySet.col(queryIndex), referenceSet.col(reference));
+      if (range.Contains(distance))
+        callback(queryIndex, reference, distance);
+    }
+  }
+}
+
+} // namespace dbscan
+} // namespace mlpack
+
+#endif
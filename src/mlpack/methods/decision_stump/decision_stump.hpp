@@ -65,6 +65,28 @@ class DecisionStump
                 const size_t numClasses,
                 const arma::rowvec& weights);
 
+  /**
+   * Alternate constructor which copies the parameters bucketSize and classes
+   * from an already initiated decision stump, and trains with the given
+   * weights, using the given presorted order of the points in each dimension
+   * (as computed by SortDimensions()).  When many stumps are trained on the
+   * same data, as in boosting, this saves sorting the data for every stump.
+   *
+   * @param other The other initiated Decision Stump object from
+   *      which we copy the values.
+   * @param data The data on which to train this object on.
+   * @param labels The labels of data.
+   * @param numClasses Number of distinct classes in labels.
+   * @param weights Weight vector to use while training. For boosting purposes.
+   * @param sortedIndices Order of the points in each dimension of data.
+   */
+  DecisionStump(const DecisionStump<>& other,
+                const MatType& data,
+                const arma::Row<size_t>& labels,
+                const size_t numClasses,
+                const arma::rowvec& weights,
+                const arma::umat& sortedIndices);
+
   /**
    * Create a decision stump without training.  This stump will not be useful
    * and will always return a class of 0 for anything that is to be classified,
@@ -106,6 +128,17 @@ class DecisionStump
                const size_t numClasses,
                const size_t bucketSize);
 
+  /**
+   * Compute the order of the points in each dimension of the given data, for
+   * use with the constructor that takes presorted indices.  Column i of
+   * sortedIndices holds the indices of the points sorted (stably) by their
+   * values in dimension i.
+   *
+   * @param data Dataset to sort.
+   * @param sortedIndices Output order of the points in each dimension.
+   */
+  static void SortDimensions(const MatType& data, arma::umat& sortedIndices);
+
   /**
    * Classification function. After training, classify test, and put the
    * predicted classes in predictedLabels.
@@ -148,18 +181,35 @@ class DecisionStump
   //! Stores the labels for each splitting bin.
   arma::Col<size_t> binLabels;
 
+  //! The minimum number of values (points times dimensions) for which the
+  //! dimensions are searched in parallel.
+  static const size_t ParallelSearchThreshold = 16384;
+
   /**
    * Sets up dimension as if it were splitting on it and finds entropy when
    * splitting on dimension.
    *
-   * @param dimension A row from the training data, which might be a
+   * @param sortedIndex Order of the points in a dimension that might be a
    *     candidate for the splitting dimension.
    * @tparam UseWeights Whether we need to run a weighted Decision Stump.
    */
-  template<bool UseWeights, typename VecType>
-  double SetupSplitDimension(const VecType& dimension,
+  template<bool UseWeights>
+  double SetupSplitDimension(const arma::uvec& sortedIndex,
                              const arma::Row<size_t>& labels,
-                             const arma::rowvec& weightD);
+                             const arma::rowvec& weights);
+
+  /**
+   * Calculate the entropy of the bin [begin, end] of a dimension, given the
+   * labels in sorted order.  binWeights is used as scratch space, so that no
+   * memory has to be allocated for each bin.
+   */
+  template<bool UseWeights>
+  double BinEntropy(const arma::Row<size_t>& sortedLabels,
+                    const arma::uvec& sortedIndex,
+                    const arma::rowvec& weights,
+                    const size_t begin,
+                    const size_t end,
+                    arma::vec& binWeights);
 
   /**
    * After having decided the dimension on which to split, train on that
@@ -167,9 +217,11 @@ class DecisionStump
    *
    * @tparam dimension dimension is the dimension decided by the constructor
    *      on which we now train the decision stump.
+   * @param sortedIndex Order of the points in the dimension.
    */
   template<typename VecType>
   void TrainOnDim(const VecType& dimension,
+                  const arma::uvec& sortedIndex,
                   const arma::Row<size_t>& labels);
 
   /**
@@ -222,6 +274,16 @@ class DecisionStump
   double Train(const MatType& data,
                const arma::Row<size_t>& labels,
                const arma::rowvec& weights);
+
+  /**
+   * Train the decision stump on the given data and labels, given the order of
+   * the points in each dimension (see SortDimensions()).
+   */
+  template<bool UseWeights>
+  double Train(const MatType& data,
+               const arma::Row<size_t>& labels,
+               const arma::rowvec& weights,
+               const arma::umat& sortedIndices);
 };
 
 } // namespace decision_stump
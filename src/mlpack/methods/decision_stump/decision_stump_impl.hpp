@@ -101,42 +101,83 @@ template<bool UseWeights>
 double DecisionStump<MatType>::Train(const MatType& data,
                                      const arma::Row<size_t>& labels,
                                      const arma::rowvec& weights)
+{
+  arma::umat sortedIndices;
+  SortDimensions(data, sortedIndices);
+  return Train<UseWeights>(data, labels, weights, sortedIndices);
+}
+
+/**
+ * Train the decision stump on the given data and labels, using the given order
+ * of the points in each dimension.
+ */
+template<typename MatType>
+template<bool UseWeights>
+double DecisionStump<MatType>::Train(const MatType& data,
+                                     const arma::Row<size_t>& labels,
+                                     const arma::rowvec& weights,
+                                     const arma::umat& sortedIndices)
 {
   // If classLabels are not all identical, proceed with training.
   size_t bestDim = 0;
-  double entropy;
   const double rootEntropy = CalculateEntropy<UseWeights>(labels, weights);
 
-  double gain, bestGain = 0.0;
-  for (size_t i = 0; i < data.n_rows; i++)
+  // The dimensions are independent, so they can be evaluated in parallel.
+  // Dimensions with identical values can't be split on, so their gain is left
+  // at zero and they are never chosen.
+  arma::vec gains(data.n_rows, arma::fill::zeros);
+  #pragma omp parallel for schedule(dynamic) \
+      if (data.n_rows * data.n_cols >= ParallelSearchThreshold && \
+          !omp_in_parallel())
+  for (omp_size_t i = 0; i < (omp_size_t) data.n_rows; i++)
   {
     // Go through each dimension of the data.
     if (IsDistinct(data.row(i)))
     {
       // For each dimension with non-identical values, treat it as a potential
       // splitting dimension and calculate entropy if split on it.
-      entropy = SetupSplitDimension<UseWeights>(data.row(i), labels, weights);
-
-      gain = rootEntropy - entropy;
-      // Find the dimension with the best entropy so that the gain is
-      // maximized.
+      const double entropy = SetupSplitDimension<UseWeights>(
+          sortedIndices.unsafe_col(i), labels, weights);
+      gains[i] = rootEntropy - entropy;
+    }
+  }
 
-      // We are maximizing gain, which is what is returned from
-      // SetupSplitDimension().
-      if (gain < bestGain)
-      {
-        bestDim = i;
-        bestGain = gain;
-      }
+  // Find the dimension with the best entropy so that the gain is maximized.
+  // We are maximizing gain, which is what is returned from
+  // SetupSplitDimension().  The first best dimension is taken, as in a serial
+  // search.
+  double bestGain = 0.0;
+  for (size_t i = 0; i < data.n_rows; i++)
+  {
+    if (gains[i] < bestGain)
+    {
+      bestDim = i;
+      bestGain = gains[i];
     }
   }
   splitDimension = bestDim;
 
   // Once the splitting column/dimension has been decided, train on it.
-  TrainOnDim(data.row(splitDimension), labels);
+  TrainOnDim(data.row(splitDimension), sortedIndices.unsafe_col(splitDimension),
+      labels);
   return -bestGain;
 }
 
+/**
+ * Compute the order of the points in each dimension of the data.
+ */
+template<typename MatType>
+void DecisionStump<MatType>::SortDimensions(const MatType& data,
+                                            arma::umat& sortedIndices)
+{
+  sortedIndices.set_size(data.n_cols, data.n_rows);
+  #pragma omp parallel for schedule(dynamic) \
+      if (data.n_rows * data.n_cols >= ParallelSearchThreshold && \
+          !omp_in_parallel())
+  for (omp_size_t i = 0; i < (omp_size_t) data.n_rows; i++)
+    sortedIndices.col(i) = arma::stable_sort_index(data.row(i).t());
+}
+
 /**
  * Classification function. After training, classify test, and put the predicted
  * classes in predictedLabels.
@@ -194,6 +235,24 @@ DecisionStump<MatType>::DecisionStump(const DecisionStump<>& other,
   Train<true>(data, labels, weights);
 }
 
+/**
+ * Alternate constructor which copies parameters bucketSize and numClasses
+ * from an already initiated decision stump, other, and uses the given
+ * presorted order of the points in each dimension.
+ */
+template<typename MatType>
+DecisionStump<MatType>::DecisionStump(const DecisionStump<>& other,
+                                      const MatType& data,
+                                      const arma::Row<size_t>& labels,
+                                      const size_t numClasses,
+                                      const arma::rowvec& weights,
+                                      const arma::umat& sortedIndices) :
+    numClasses(numClasses),
+    bucketSize(other.bucketSize)
+{
+  Train<true>(data, labels, weights, sortedIndices);
+}
+
 /**
  * Serialize the decision stump.
  */
@@ -215,35 +274,28 @@ void DecisionStump<MatType>::serialize(Archive& ar,
  * Sets up dimension as if it were splitting on it and finds entropy when
  * splitting on dimension.
  *
- * @param dimension A row from the training data, which might be a candidate for
- *      the splitting dimension.
+ * @param sortedIndex Order of the points in a dimension of the training data,
+ *      which might be a candidate for the splitting dimension.
  * @param UseWeights Whether we need to run a weighted Decision Stump.
  */
 template<typename MatType>
-template<bool UseWeights, typename VecType>
+template<bool UseWeights>
 double DecisionStump<MatType>::SetupSplitDimension(
-    const VecType& dimension,
+    const arma::uvec& sortedIndex,
     const arma::Row<size_t>& labels,
     const arma::rowvec& weights)
 {
   size_t i, count, begin, end;
   double entropy = 0.0;
 
-  // Store the indices of the sorted dimension to build a vector of sorted
-  // labels.  This sort is stable.
-  arma::uvec sortedIndexDim = arma::stable_sort_index(dimension.t());
-
-  arma::Row<size_t> sortedLabels(dimension.n_elem);
-  arma::rowvec sortedWeights(dimension.n_elem);
-
-  for (i = 0; i < dimension.n_elem; i++)
-  {
-    sortedLabels(i) = labels(sortedIndexDim(i));
+  // Build a vector of sorted labels, using the stable order of the points in
+  // this dimension.
+  arma::Row<size_t> sortedLabels(sortedIndex.n_elem);
+  for (i = 0; i < sortedIndex.n_elem; i++)
+    sortedLabels(i) = labels(sortedIndex(i));
 
-    // Apply weights if necessary.
-    if (UseWeights)
-      sortedWeights(i) = weights(sortedIndexDim(i));
-  }
+  // The class weights of each bin are accumulated here.
+  arma::vec binWeights(numClasses);
 
   i = 0;
   count = 0;
@@ -263,8 +315,8 @@ double DecisionStump<MatType>::SetupSplitDimension(
       // Use ratioEl to calculate the ratio of elements in this split.
       const double ratioEl = ((double) (end - begin + 1) / sortedLabels.n_elem);
 
-      entropy += ratioEl * CalculateEntropy<UseWeights>(
-          sortedLabels.subvec(begin, end), sortedWeights.subvec(begin, end));
+      entropy += ratioEl * BinEntropy<UseWeights>(sortedLabels, sortedIndex,
+          weights, begin, end, binWeights);
       i++;
     }
     else if (sortedLabels(i) != sortedLabels(i + 1))
@@ -290,8 +342,8 @@ double DecisionStump<MatType>::SetupSplitDimension(
       }
       const double ratioEl = ((double) (end - begin + 1) / sortedLabels.n_elem);
 
-      entropy += ratioEl * CalculateEntropy<UseWeights>(
-          sortedLabels.subvec(begin, end), sortedWeights.subvec(begin, end));
+      entropy += ratioEl * BinEntropy<UseWeights>(sortedLabels, sortedIndex,
+          weights, begin, end, binWeights);
 
       i = end + 1;
       count = 0;
@@ -302,6 +354,46 @@ double DecisionStump<MatType>::SetupSplitDimension(
   return entropy;
 }
 
+/**
+ * Calculate the entropy of one bin of a dimension.  This gives the same result
+ * as CalculateEntropy() on the labels and weights of the bin, without copying
+ * them.
+ */
+template<typename MatType>
+template<bool UseWeights>
+double DecisionStump<MatType>::BinEntropy(
+    const arma::Row<size_t>& sortedLabels,
+    const arma::uvec& sortedIndex,
+    const arma::rowvec& weights,
+    const size_t begin,
+    const size_t end,
+    arma::vec& binWeights)
+{
+  binWeights.zeros();
+
+  // Accumulate the weight of each class, and the total weight, in this bin.
+  double accWeight = 0.0;
+  for (size_t j = begin; j <= end; j++)
+  {
+    const double weight = UseWeights ? weights(sortedIndex(j)) : 1.0;
+    binWeights(sortedLabels(j)) += weight;
+    accWeight += weight;
+  }
+
+  double entropy = 0.0;
+  for (size_t j = 0; j < numClasses; j++)
+  {
+    const double p1 = binWeights(j) / accWeight;
+
+    // Instead of using log2(), which is C99 and may not exist on some
+    // compilers, use std::log(), then use the change-of-base formula to make
+    // the result correct.
+    entropy += (p1 == 0) ? 0 : p1 * std::log(p1);
+  }
+
+  return entropy / std::log(2.0);
+}
+
 /**
  * After having decided the dimension on which to split, train on that
  * dimension.
@@ -312,17 +404,19 @@ double DecisionStump<MatType>::SetupSplitDimension(
 template<typename MatType>
 template<typename VecType>
 void DecisionStump<MatType>::TrainOnDim(const VecType& dimension,
+                                        const arma::uvec& sortedIndex,
                                         const arma::Row<size_t>& labels)
 {
   size_t i, count, begin, end;
 
-  typename MatType::row_type sortedSplitDim = arma::sort(dimension);
-  arma::uvec sortedSplitIndexDim = arma::stable_sort_index(dimension.t());
+  arma::rowvec sortedSplitDim(dimension.n_elem);
   arma::Row<size_t> sortedLabels(dimension.n_elem);
-  sortedLabels.fill(0);
 
   for (i = 0; i < dimension.n_elem; i++)
-    sortedLabels(i) = labels(sortedSplitIndexDim(i));
+  {
+    sortedSplitDim(i) = dimension(sortedIndex(i));
+    sortedLabels(i) = labels(sortedIndex(i));
+  }
 
   arma::rowvec subCols;
   double mostFreq;
@@ -16,6 +16,7 @@
 #include <mlpack/prereqs.hpp>
 #include "gini_gain.hpp"
 #include "best_binary_numeric_split.hpp"
+#include "histogram_numeric_split.hpp"
 #include "all_categorical_split.hpp"
 #include "all_dimension_select.hpp"
 #include <type_traits>
@@ -391,6 +392,21 @@ class DecisionTree :
   //! trained tree).
   size_t SplitDimension() const { return splitDimension; }
 
+  //! Get whether the node splits on a categorical dimension (only meaningful
+  //! if this is a non-leaf in a trained tree).
+  bool IsCategoricalSplit() const
+  {
+    return (data::Datatype) dimensionTypeOrMajorityClass ==
+        data::Datatype::categorical;
+  }
+
+  /**
+   * Get the class probabilities of a leaf.  For a non-leaf, this holds the
+   * split information used by the CalculateDirection() function of the split
+   * type instead; for the BestBinaryNumericSplit, this is the split value.
+   */
+  const arma::vec& ClassProbabilities() const { return classProbabilities; }
+
   /**
    * Given a point and that this node is not a leaf, calculate the index of the
    * child node this point would go towards.  This method is primarily used by
@@ -431,6 +447,13 @@ class DecisionTree :
   typedef typename CategoricalSplit::template AuxiliarySplitInfo<ElemType>
       CategoricalAuxiliarySplitInfo;
 
+  //! The number of values (points times dimensions) a node must have to search
+  //! the dimensions for a split in parallel.
+  static const size_t ParallelSearchThreshold = 16384;
+  //! The number of points a node must have to grow its children as OpenMP
+  //! tasks.
+  static const size_t ParallelGrowThreshold = 1024;
+
   /**
    * Calculate the class probabilities of the given labels.
    */
@@ -439,6 +462,41 @@ class DecisionTree :
                                    const size_t numClasses,
                                    const WeightsRowType& weights);
 
+  /**
+   * Search the dimensions given by the dimension selector for the best split
+   * of the points in the given range.  The dimensions are checked in parallel
+   * when OpenMP is available and the node is large enough.  If a split
+   * improves on bestGain, bestGain is set to its gain, classProbabilities and
+   * the auxiliary split information are set for it, and its dimension is
+   * returned; otherwise, the number of dimensions is returned.
+   *
+   * @param data Dataset to train on.
+   * @param begin Index of the starting point in the dataset that belongs to
+   *      this node.
+   * @param count Number of points in this node.
+   * @param datasetInfo Type information for each dimension, or NULL if all
+   *      dimensions are numeric.
+   * @param labels Labels for each training point.
+   * @param numClasses Number of classes in the dataset.
+   * @param weights Weights of each training point, if UseWeights is true.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param minimumGainSplit Minimum gain for the node to split.
+   * @param dimensionSelector Selector of the dimensions to check.
+   * @param bestGain Gain of the unsplit node; set to the gain of the split.
+   */
+  template<bool UseWeights, typename MatType>
+  size_t BestSplit(MatType& data,
+                   const size_t begin,
+                   const size_t count,
+                   const data::DatasetInfo* datasetInfo,
+                   const arma::Row<size_t>& labels,
+                   const size_t numClasses,
+                   const arma::rowvec& weights,
+                   const size_t minimumLeafSize,
+                   const double minimumGainSplit,
+                   DimensionSelectionType& dimensionSelector,
+                   double& bestGain);
+
   /**
    * Corresponding to the public Train() method, this method is designed for
    * avoiding unnecessary copies during training.  This function is called to
@@ -453,6 +511,9 @@ class DecisionTree :
    * @param numClasses Number of classes in the dataset.
    * @param minimumLeafSize Minimum number of points in each leaf node.
    * @param minimumGainSplit Minimum gain for the node to split.
+   * @param dimensionSelector Instantiated dimension selection policy.
+   * @param inTasks Whether the node is trained in a task of the parallel
+   *      region started by an ancestor (see TrainChildren()).
    * @return The final entropy of decision tree.
    */
   template<bool UseWeights, typename MatType>
@@ -465,7 +526,8 @@ class DecisionTree :
                arma::rowvec& weights,
                const size_t minimumLeafSize,
                const double minimumGainSplit,
-               DimensionSelectionType& dimensionSelector);
+               DimensionSelectionType& dimensionSelector,
+               const bool inTasks = false);
 
   /**
    * Corresponding to the public Train() method, this method is designed for
@@ -480,6 +542,9 @@ class DecisionTree :
    * @param numClasses Number of classes in the dataset.
    * @param minimumLeafSize Minimum number of points in each leaf node.
    * @param minimumGainSplit Minimum gain for the node to split.
+   * @param dimensionSelector Instantiated dimension selection policy.
+   * @param inTasks Whether the node is trained in a task of the parallel
+   *      region started by an ancestor (see TrainChildren()).
    * @return The final entropy of decision tree.
    */
   template<bool UseWeights, typename MatType>
@@ -491,7 +556,27 @@ class DecisionTree :
                arma::rowvec& weights,
                const size_t minimumLeafSize,
                const double minimumGainSplit,
-               DimensionSelectionType& dimensionSelector);
+               DimensionSelectionType& dimensionSelector,
+               const bool inTasks = false);
+
+  /**
+   * Call trainChild(i, childInTasks) for each of the children of a node that
+   * is being trained.  The children of large nodes are trained as OpenMP
+   * tasks, unless the tree is trained inside another parallel region (such as
+   * a random forest); childInTasks is true for the children trained in tasks.
+   *
+   * @param numChildren Number of children.
+   * @param count Number of points in the node.
+   * @param totalCount Number of points in the dataset.
+   * @param inTasks Whether the node is trained in a task.
+   * @param trainChild Function that trains the given child.
+   */
+  template<typename ChildFunction>
+  static void TrainChildren(const size_t numChildren,
+                            const size_t count,
+                            const size_t totalCount,
+                            const bool inTasks,
+                            ChildFunction& trainChild);
 };
 
 /**
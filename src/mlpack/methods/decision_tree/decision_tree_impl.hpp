@@ -579,7 +579,8 @@ double DecisionTree<FitnessFunction,
     arma::rowvec& weights,
     const size_t minimumLeafSize,
     const double minimumGainSplit,
-    DimensionSelectionType& dimensionSelector)
+    DimensionSelectionType& dimensionSelector,
+    const bool inTasks)
 {
   // Clear children if needed.
   for (size_t i = 0; i < children.size(); ++i)
@@ -595,51 +596,9 @@ double DecisionTree<FitnessFunction,
       labels.subvec(begin, begin + count - 1),
       numClasses,
       UseWeights ? weights.subvec(begin, begin + count - 1) : weights);
-  size_t bestDim = datasetInfo.Dimensionality(); // This means "no split".
-  const size_t end = dimensionSelector.End();
-  for (size_t i = dimensionSelector.Begin(); i != end;
-       i = dimensionSelector.Next())
-  {
-    double dimGain = -DBL_MAX;
-    if (datasetInfo.Type(i) == data::Datatype::categorical)
-    {
-      dimGain = CategoricalSplit::template SplitIfBetter<UseWeights>(bestGain,
-          data.cols(begin, begin + count - 1).row(i),
-          datasetInfo.NumMappings(i),
-          labels.subvec(begin, begin + count - 1),
-          numClasses,
-          UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
-          minimumLeafSize,
-          minimumGainSplit,
-          classProbabilities,
-          *this);
-    }
-    else if (datasetInfo.Type(i) == data::Datatype::numeric)
-    {
-      dimGain = NumericSplit::template SplitIfBetter<UseWeights>(bestGain,
-          data.cols(begin, begin + count - 1).row(i),
-          labels.subvec(begin, begin + count - 1),
-          numClasses,
-          UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
-          minimumLeafSize,
-          minimumGainSplit,
-          classProbabilities,
-          *this);
-    }
-
-    // If the splitter reported that it did not split, move to the next
-    // dimension.
-    if (dimGain == DBL_MAX)
-      continue;
-
-    // Was there an improvement?  If so mark that it's the new best dimension.
-    bestDim = i;
-    bestGain = dimGain;
-
-    // If the gain is the best possible, no need to keep looking.
-    if (bestGain >= 0.0)
-      break;
-  }
+  const size_t bestDim = BestSplit<UseWeights>(data, begin, count,
+      &datasetInfo, labels, numClasses, weights, minimumLeafSize,
+      minimumGainSplit, dimensionSelector, bestGain);
 
   // Did we split or not?  If so, then split the data and create the children.
   if (bestDim != datasetInfo.Dimensionality())
@@ -682,12 +641,15 @@ double DecisionTree<FitnessFunction,
       bestGain = 0.0;
     }
 
-    // Split into children.
+    // Split into children.  The points of each child are moved together first,
+    // so that the children own disjoint ranges of the dataset and can be built
+    // independently.
+    std::vector<size_t> childBegins(numChildren + 1, begin + count);
     size_t currentCol = begin;
     for (size_t i = 0; i < numChildren; ++i)
     {
-      size_t currentChildBegin = currentCol;
-      for (size_t j = currentChildBegin; j < begin + count; ++j)
+      childBegins[i] = currentCol;
+      for (size_t j = currentCol; j < begin + count; ++j)
       {
         if (childAssignments[j - begin] == i)
         {
@@ -699,25 +661,45 @@ double DecisionTree<FitnessFunction,
           ++currentCol;
         }
       }
+    }
 
-      // Now build the child recursively.
+    // Now build the children recursively.
+    children.resize(numChildren, NULL);
+    std::vector<double> childGains(numChildren, 0.0);
+    auto trainChild = [&](const size_t i, const bool childInTasks)
+    {
+      const size_t childBegin = childBegins[i];
+      const size_t childCount = childBegins[i + 1] - childBegins[i];
       DecisionTree* child = new DecisionTree();
       if (NoRecursion)
       {
-        child->Train<UseWeights>(data, currentChildBegin,
-            currentCol - currentChildBegin, datasetInfo, labels, numClasses,
-            weights, currentCol - currentChildBegin, minimumGainSplit,
+        child->Train<UseWeights>(data, childBegin, childCount, datasetInfo,
+            labels, numClasses, weights, childCount, minimumGainSplit,
             dimensionSelector);
       }
+      else if (childInTasks)
+      {
+        // Tasks can't share the state of the dimension selector.
+        DimensionSelectionType childSelector(dimensionSelector);
+        childGains[i] = child->Train<UseWeights>(data, childBegin, childCount,
+            datasetInfo, labels, numClasses, weights, minimumLeafSize,
+            minimumGainSplit, childSelector, true);
+      }
       else
       {
-        // During recursion entropy of child node may change.
-        double childGain = child->Train<UseWeights>(data, currentChildBegin,
-            currentCol - currentChildBegin, datasetInfo, labels, numClasses,
-            weights, minimumLeafSize, minimumGainSplit, dimensionSelector);
-        bestGain += double(childCounts[i]) / double(count) * (-childGain);
+        childGains[i] = child->Train<UseWeights>(data, childBegin, childCount,
+            datasetInfo, labels, numClasses, weights, minimumLeafSize,
+            minimumGainSplit, dimensionSelector);
       }
-      children.push_back(child);
+      children[i] = child;
+    };
+    TrainChildren(numChildren, count, data.n_cols, inTasks, trainChild);
+
+    // During recursion entropy of child node may change.
+    if (!NoRecursion)
+    {
+      for (size_t i = 0; i < numChildren; ++i)
+        bestGain += double(childCounts[i]) / double(count) * (-childGains[i]);
     }
   }
   else
@@ -757,7 +739,8 @@ double DecisionTree<FitnessFunction,
     arma::rowvec& weights,
     const size_t minimumLeafSize,
     const double minimumGainSplit,
-    DimensionSelectionType& dimensionSelector)
+    DimensionSelectionType& dimensionSelector,
+    const bool inTasks)
 {
   // Clear children if needed.
   for (size_t i = 0; i < children.size(); ++i)
@@ -776,35 +759,9 @@ double DecisionTree<FitnessFunction,
       labels.subvec(begin, begin + count - 1),
       numClasses,
       UseWeights ? weights.subvec(begin, begin + count - 1) : weights);
-  size_t bestDim = data.n_rows; // This means "no split".
-  for (size_t i = dimensionSelector.Begin(); i != dimensionSelector.End();
-       i = dimensionSelector.Next())
-  {
-    const double dimGain = NumericSplitType<FitnessFunction>::template
-        SplitIfBetter<UseWeights>(bestGain,
-                                  data.cols(begin, begin + count - 1).row(i),
-                                  labels.cols(begin, begin + count - 1),
-                                  numClasses,
-                                  UseWeights ?
-                                      weights.cols(begin, begin + count - 1) :
-                                      weights,
-                                  minimumLeafSize,
-                                  minimumGainSplit,
-                                  classProbabilities,
-                                  *this);
-
-    // If the splitter did not report that it improved, then move to the next
-    // dimension.
-    if (dimGain == DBL_MAX)
-      continue;
-
-    bestDim = i;
-    bestGain = dimGain;
-
-    // If the gain is the best possible, no need to keep looking.
-    if (bestGain >= 0.0)
-      break;
-  }
+  const size_t bestDim = BestSplit<UseWeights>(data, begin, count, NULL,
+      labels, numClasses, weights, minimumLeafSize, minimumGainSplit,
+      dimensionSelector, bestGain);
 
   // Did we split or not?  If so, then split the data and create the children.
   if (bestDim != data.n_rows)
@@ -835,11 +792,14 @@ double DecisionTree<FitnessFunction,
       bestGain = 0.0;
     }
 
+    // Move the points of each child together, so that the children own
+    // disjoint ranges of the dataset and can be built independently.
+    std::vector<size_t> childBegins(numChildren + 1, begin + count);
     size_t currentCol = begin;
     for (size_t i = 0; i < numChildren; ++i)
     {
-      size_t currentChildBegin = currentCol;
-      for (size_t j = currentChildBegin; j < begin + count; ++j)
+      childBegins[i] = currentCol;
+      for (size_t j = currentCol; j < begin + count; ++j)
       {
         if (childAssignments[j - begin] == i)
         {
@@ -851,25 +811,45 @@ double DecisionTree<FitnessFunction,
           ++currentCol;
         }
       }
+    }
 
-      // Now build the child recursively.
+    // Now build the children recursively.
+    children.resize(numChildren, NULL);
+    std::vector<double> childGains(numChildren, 0.0);
+    auto trainChild = [&](const size_t i, const bool childInTasks)
+    {
+      const size_t childBegin = childBegins[i];
+      const size_t childCount = childBegins[i + 1] - childBegins[i];
       DecisionTree* child = new DecisionTree();
       if (NoRecursion)
       {
-        child->Train<UseWeights>(data, currentChildBegin,
-            currentCol - currentChildBegin, labels, numClasses, weights,
-            currentCol - currentChildBegin, minimumGainSplit,
+        child->Train<UseWeights>(data, childBegin, childCount, labels,
+            numClasses, weights, childCount, minimumGainSplit,
             dimensionSelector);
       }
+      else if (childInTasks)
+      {
+        // Tasks can't share the state of the dimension selector.
+        DimensionSelectionType childSelector(dimensionSelector);
+        childGains[i] = child->Train<UseWeights>(data, childBegin, childCount,
+            labels, numClasses, weights, minimumLeafSize, minimumGainSplit,
+            childSelector, true);
+      }
       else
       {
-        // During recursion entropy of child node may change.
-        double childGain = child->Train<UseWeights>(data, currentChildBegin,
-            currentCol - currentChildBegin, labels, numClasses, weights,
-            minimumLeafSize, minimumGainSplit, dimensionSelector);
-        bestGain += double(childCounts[i]) / double(count) * (-childGain);
+        childGains[i] = child->Train<UseWeights>(data, childBegin, childCount,
+            labels, numClasses, weights, minimumLeafSize, minimumGainSplit,
+            dimensionSelector);
       }
-      children.push_back(child);
+      children[i] = child;
+    };
+    TrainChildren(numChildren, count, data.n_cols, inTasks, trainChild);
+
+    // During recursion entropy of child node may change.
+    if (!NoRecursion)
+    {
+      for (size_t i = 0; i < numChildren; ++i)
+        bestGain += double(childCounts[i]) / double(count) * (-childGains[i]);
     }
   }
   else
@@ -1083,6 +1063,200 @@ size_t DecisionTree<FitnessFunction,
     return children[0]->NumClasses();
 }
 
+//! Train the children of a node, in parallel if the node is large enough.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+template<typename ChildFunction>
+void DecisionTree<FitnessFunction,
+                  NumericSplitType,
+                  CategoricalSplitType,
+                  DimensionSelectionType,
+                  ElemType,
+                  NoRecursion>::TrainChildren(const size_t numChildren,
+                                              const size_t count,
+                                              const size_t totalCount,
+                                              const bool inTasks,
+                                              ChildFunction& trainChild)
+{
+  #ifdef HAS_OPENMP
+  // Growing a small subtree is not worth a task.  Random dimension selectors
+  // draw random numbers for each node, so the tree would depend on the order
+  // in which the threads reach the nodes; those trees are grown serially.
+  if (!NoRecursion && numChildren > 1 && count >= ParallelGrowThreshold &&
+      std::is_same<DimensionSelectionType, AllDimensionSelect>::value &&
+      omp_get_max_threads() > 1)
+  {
+    // The children hold disjoint ranges of the dataset, so they can be grown
+    // at the same time.
+    if (inTasks)
+    {
+      for (size_t i = 0; i + 1 < numChildren; ++i)
+      {
+        #pragma omp task firstprivate(i)
+        trainChild(i, true);
+      }
+      trainChild(numChildren - 1, true);
+      #pragma omp taskwait
+      return;
+    }
+
+    // As long as the node is a large part of the dataset, its children are
+    // grown one after another, so that the dimensions of each of them are
+    // searched by all threads (see BestSplit()).  Below that, we start a
+    // parallel region in which the rest of the subtree is grown with tasks.
+    // Inside another parallel region (such as a random forest) the threads are
+    // already busy, so the tree is grown serially.
+    if (!omp_in_parallel() &&
+        count * omp_get_max_threads() <= 2 * totalCount)
+    {
+      #pragma omp parallel
+      {
+        #pragma omp single
+        {
+          for (size_t i = 0; i + 1 < numChildren; ++i)
+          {
+            #pragma omp task firstprivate(i)
+            trainChild(i, true);
+          }
+          trainChild(numChildren - 1, true);
+          #pragma omp taskwait
+        }
+      }
+      return;
+    }
+  }
+  #else
+  (void) count;
+  (void) totalCount;
+  (void) inTasks;
+  #endif
+
+  for (size_t i = 0; i < numChildren; ++i)
+    trainChild(i, false);
+}
+
+//! Find the best split of the given points over the selected dimensions.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+template<bool UseWeights, typename MatType>
+size_t DecisionTree<FitnessFunction,
+                    NumericSplitType,
+                    CategoricalSplitType,
+                    DimensionSelectionType,
+                    ElemType,
+                    NoRecursion>::BestSplit(
+    MatType& data,
+    const size_t begin,
+    const size_t count,
+    const data::DatasetInfo* datasetInfo,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const arma::rowvec& weights,
+    const size_t minimumLeafSize,
+    const double minimumGainSplit,
+    DimensionSelectionType& dimensionSelector,
+    double& bestGain)
+{
+  // Collect the dimensions first: the dimension selector may draw random
+  // numbers, so it has to be used by one thread, in order.
+  std::vector<size_t> dimensions;
+  const size_t end = dimensionSelector.End();
+  for (size_t i = dimensionSelector.Begin(); i != end;
+       i = dimensionSelector.Next())
+    dimensions.push_back(i);
+
+  // Every dimension is checked against the gain of the unsplit node, with its
+  // own auxiliary split information, so that the dimensions can be checked in
+  // parallel.  Only use threads if there is enough work to share, and not if
+  // we are already inside a parallel region (such as a random forest).
+  const double nodeGain = bestGain;
+  std::vector<double> gains(dimensions.size(), DBL_MAX);
+  std::vector<arma::vec> probabilities(dimensions.size());
+  std::vector<NumericAuxiliarySplitInfo> numericAux(dimensions.size());
+  std::vector<CategoricalAuxiliarySplitInfo> categoricalAux(
+      datasetInfo ? dimensions.size() : 0);
+
+  #pragma omp parallel for schedule(dynamic) \
+      if (dimensions.size() > 1 && \
+          count * dimensions.size() >= ParallelSearchThreshold && \
+          !omp_in_parallel())
+  for (omp_size_t k = 0; k < (omp_size_t) dimensions.size(); ++k)
+  {
+    const size_t i = dimensions[k];
+    if (datasetInfo && datasetInfo->Type(i) == data::Datatype::categorical)
+    {
+      gains[k] = CategoricalSplit::template SplitIfBetter<UseWeights>(nodeGain,
+          data.cols(begin, begin + count - 1).row(i),
+          datasetInfo->NumMappings(i),
+          labels.subvec(begin, begin + count - 1),
+          numClasses,
+          UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
+          minimumLeafSize,
+          minimumGainSplit,
+          probabilities[k],
+          categoricalAux[k]);
+    }
+    else
+    {
+      gains[k] = NumericSplit::template SplitIfBetter<UseWeights>(nodeGain,
+          data.cols(begin, begin + count - 1).row(i),
+          labels.subvec(begin, begin + count - 1),
+          numClasses,
+          UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
+          minimumLeafSize,
+          minimumGainSplit,
+          probabilities[k],
+          numericAux[k]);
+    }
+  }
+
+  // Now pick the dimension that a search over the dimensions in order would
+  // have picked: a later dimension only wins if it improves on the best gain so
+  // far by minimumGainSplit, and a perfect split ends the search.
+  const size_t noSplit = datasetInfo ? datasetInfo->Dimensionality() :
+      data.n_rows;
+  size_t bestDim = noSplit;
+  size_t bestIndex = 0;
+  for (size_t k = 0; k < dimensions.size(); ++k)
+  {
+    // If the splitter reported that it did not split, move to the next
+    // dimension.
+    if (gains[k] == DBL_MAX)
+      continue;
+    if (bestDim != noSplit && gains[k] < 0.0 &&
+        gains[k] <= std::min(bestGain + minimumGainSplit, 0.0))
+      continue;
+
+    bestDim = dimensions[k];
+    bestIndex = k;
+    bestGain = gains[k];
+
+    // If the gain is the best possible, no need to keep looking.
+    if (bestGain >= 0.0)
+      break;
+  }
+
+  if (bestDim != noSplit)
+  {
+    classProbabilities = std::move(probabilities[bestIndex]);
+    if (datasetInfo &&
+        datasetInfo->Type(bestDim) == data::Datatype::categorical)
+      CategoricalAuxiliarySplitInfo::operator=(categoricalAux[bestIndex]);
+    else
+      NumericAuxiliarySplitInfo::operator=(numericAux[bestIndex]);
+  }
+
+  return bestDim;
+}
+
 template<typename FitnessFunction,
          template<typename> class NumericSplitType,
          template<typename> class CategoricalSplitType,
@@ -0,0 +1,123 @@
+/**
+ * @file histogram_numeric_split.hpp
+ *
+ * A numeric splitting function for decision trees that searches for the best
+ * binary split over a histogram of the values, instead of over the sorted
+ * values.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_TREE_HISTOGRAM_NUMERIC_SPLIT_HPP
+#define MLPACK_METHODS_DECISION_TREE_HISTOGRAM_NUMERIC_SPLIT_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The BinnedNumericSplit is a splitting function for decision trees that
+ * divides the values of a node into NumBins bins at quantiles of the values,
+ * counts the classes of the points in each bin, and then searches the bin
+ * boundaries for the best binary split.  The quantiles are estimated from an
+ * evenly strided sample of at most 16 * NumBins values, so only the sample is
+ * sorted, and finding the split takes O(n log NumBins + NumBins * numClasses)
+ * time instead of the O(n log n) of sorting all the values.  Since the bins
+ * hold about as many points each, heavy-tailed or skewed values don't end up
+ * in a few bins as they would with bins of equal width.
+ *
+ * The split value is placed halfway between the largest value of the bin on
+ * the left and the smallest value of the bin on the right, so points are
+ * always assigned to children exactly as the histogram counted them.  Since
+ * the bins are recomputed from the values of each node, the resolution of the
+ * bins grows as the tree gets deeper.  If a node has at most NumBins points,
+ * every distinct value gets its own bin, and the result is the same as for the
+ * BestBinaryNumericSplit.
+ *
+ * This class cannot be given to a DecisionTree directly, since it takes two
+ * template parameters; use HistogramNumericSplit (256 bins) or an alias
+ * template that fixes the number of bins.
+ *
+ * @tparam FitnessFunction Fitness function to use to calculate gain.
+ * @tparam NumBins Number of bins of the histogram.
+ */
+template<typename FitnessFunction, size_t NumBins>
+class BinnedNumericSplit
+{
+ public:
+  // No extra info needed for split.
+  template<typename ElemType>
+  class AuxiliarySplitInfo { };
+
+  /**
+   * Check if we can split a node.  If we can split a node in a way that
+   * improves on 'bestGain', then we return the improved gain.  Otherwise we
+   * return the value 'bestGain'.  If a split is made, then classProbabilities
+   * and aux may be modified.
+   *
+   * @param bestGain Best gain seen so far (we'll only split if we find gain
+   *      better than this).
+   * @param data The dimension of data points to check for a split in.
+   * @param labels Labels for each point.
+   * @param numClasses Number of classes in the dataset.
+   * @param weights Weights of each point.
+   * @param minimumLeafSize Minimum number of points in a leaf node for
+   *      splitting.
+   * @param minimumGainSplit Minimum gain split.
+   * @param classProbabilities Class probabilities vector, which may be filled
+   *      with split information a successful split.
+   * @param aux Auxiliary split information, which may be modified on a
+   *      successful split.
+   */
+  template<bool UseWeights, typename VecType, typename WeightVecType>
+  static double SplitIfBetter(
+      const double bestGain,
+      const VecType& data,
+      const arma::Row<size_t>& labels,
+      const size_t numClasses,
+      const WeightVecType& weights,
+      const size_t minimumLeafSize,
+      const double minimumGainSplit,
+      arma::Col<typename VecType::elem_type>& classProbabilities,
+      AuxiliarySplitInfo<typename VecType::elem_type>& aux);
+
+  /**
+   * Returns 2, since the binary split always has two children.
+   */
+  template<typename ElemType>
+  static size_t NumChildren(const arma::Col<ElemType>& /* classProbabilities */,
+                            const AuxiliarySplitInfo<ElemType>& /* aux */)
+  {
+    return 2;
+  }
+
+  /**
+   * Given a point, calculate which child it should go to (left or right).
+   *
+   * @param point Point to calculate direction of.
+   * @param classProbabilities Auxiliary information for the split.
+   * @param aux (Unused) auxiliary information for the split.
+   */
+  template<typename ElemType>
+  static size_t CalculateDirection(
+      const ElemType& point,
+      const arma::Col<ElemType>& classProbabilities,
+      const AuxiliarySplitInfo<ElemType>& /* aux */);
+};
+
+/**
+ * The HistogramNumericSplit is a BinnedNumericSplit with 256 bins.
+ */
+template<typename FitnessFunction>
+using HistogramNumericSplit = BinnedNumericSplit<FitnessFunction, 256>;
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "histogram_numeric_split_impl.hpp"
+
+#endif
@@ -0,0 +1,255 @@
+/**
+ * @file histogram_numeric_split_impl.hpp
+ *
+ * Implementation of the BinnedNumericSplit, which searches a histogram of the
+ * values of a dimension for the best binary split.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_TREE_HISTOGRAM_NUMERIC_SPLIT_IMPL_HPP
+#define MLPACK_METHODS_DECISION_TREE_HISTOGRAM_NUMERIC_SPLIT_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "histogram_numeric_split.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename FitnessFunction, size_t NumBins>
+template<bool UseWeights, typename VecType, typename WeightVecType>
+double BinnedNumericSplit<FitnessFunction, NumBins>::SplitIfBetter(
+    const double bestGain,
+    const VecType& data,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const WeightVecType& weights,
+    const size_t minimumLeafSize,
+    const double minimumGainSplit,
+    arma::Col<typename VecType::elem_type>& classProbabilities,
+    AuxiliarySplitInfo<typename VecType::elem_type>& /* aux */)
+{
+  typedef typename VecType::elem_type ElemType;
+
+  // First sanity check: if we don't have enough points, we can't split.
+  if (data.n_elem < (minimumLeafSize * 2))
+    return DBL_MAX;
+  if (bestGain == 0.0)
+    return DBL_MAX; // It can't be outperformed.
+
+  // Find the range of the values.
+  ElemType minValue = data[0];
+  ElemType maxValue = data[0];
+  for (size_t i = 1; i < data.n_elem; ++i)
+  {
+    minValue = std::min(minValue, (ElemType) data[i]);
+    maxValue = std::max(maxValue, (ElemType) data[i]);
+  }
+
+  // Sanity check: if all the values are the same, we can't split in this
+  // dimension.
+  if (minValue == maxValue)
+    return DBL_MAX;
+
+  // Choose the bin boundaries at quantiles of the values, so that the bins
+  // hold about as many points each whatever the distribution of the values
+  // is.  The quantiles are taken from an evenly strided sample of at most
+  // 16 * NumBins values, so only the sample needs to be sorted.
+  const size_t sampleSize = std::min((size_t) data.n_elem, 16 * NumBins);
+  std::vector<ElemType> sample(sampleSize);
+  for (size_t i = 0; i < sampleSize; ++i)
+    sample[i] = data[i * data.n_elem / sampleSize];
+  std::sort(sample.begin(), sample.end());
+
+  // A value goes into the bin given by the number of boundaries that are not
+  // greater than it.  Equal boundaries are merged, so equal values always
+  // share a bin, and if there are at most NumBins values, each distinct value
+  // gets its own bin.
+  std::vector<ElemType> boundaries;
+  boundaries.reserve(NumBins - 1);
+  for (size_t b = 1; b < NumBins; ++b)
+  {
+    const ElemType boundary = sample[b * sampleSize / NumBins];
+    if (boundaries.empty() || boundary > boundaries.back())
+      boundaries.push_back(boundary);
+  }
+  const size_t numBins = boundaries.size() + 1;
+
+  // Build the histogram: the class counts (or class weight sums) of each bin,
+  // along with the number of points and the smallest and largest value in each
+  // bin.
+  arma::Mat<size_t> classCounts;
+  arma::mat classWeightSums;
+  arma::vec binWeights;
+  if (UseWeights)
+  {
+    classWeightSums.zeros(numClasses, numBins);
+    binWeights.zeros(numBins);
+  }
+  else
+  {
+    classCounts.zeros(numClasses, numBins);
+  }
+
+  std::vector<size_t> binPoints(numBins, 0);
+  std::vector<ElemType> binMin(numBins, maxValue);
+  std::vector<ElemType> binMax(numBins, minValue);
+  for (size_t i = 0; i < data.n_elem; ++i)
+  {
+    const ElemType value = data[i];
+    const size_t bin = std::upper_bound(boundaries.begin(), boundaries.end(),
+        value) - boundaries.begin();
+
+    if (UseWeights)
+    {
+      classWeightSums(labels[i], bin) += weights[i];
+      binWeights[bin] += weights[i];
+    }
+    else
+    {
+      ++classCounts(labels[i], bin);
+    }
+
+    ++binPoints[bin];
+    binMin[bin] = std::min(binMin[bin], value);
+    binMax[bin] = std::max(binMax[bin], value);
+  }
+
+  // Loop through the boundaries between non-empty bins, choosing the best one.
+  // Also, force a minimum leaf size of 1 (empty children don't make sense).
+  double bestFoundGain = std::min(bestGain + minimumGainSplit, 0.0);
+  bool improved = false;
+  const size_t minimum = std::max(minimumLeafSize, (size_t) 1);
+
+  // The counts of the left child (column 0) and the right child (column 1),
+  // starting with every point on the right.
+  arma::Mat<size_t> childCounts;
+  arma::mat childWeightSums;
+  double totalWeight = 0.0;
+  double totalLeftWeight = 0.0;
+  double totalRightWeight = 0.0;
+  if (UseWeights)
+  {
+    childWeightSums.zeros(numClasses, 2);
+    childWeightSums.col(1) = arma::sum(classWeightSums, 1);
+    totalWeight = arma::accu(binWeights);
+    totalRightWeight = totalWeight;
+    bestFoundGain *= totalWeight;
+  }
+  else
+  {
+    childCounts.zeros(numClasses, 2);
+    childCounts.col(1) = arma::sum(classCounts, 1);
+    bestFoundGain *= data.n_elem;
+  }
+
+  size_t leftPoints = 0;
+  size_t bin = 0;
+  while (binPoints[bin] == 0)
+    ++bin;
+
+  while (true)
+  {
+    // Find the next non-empty bin; if there is none, every point is on the
+    // left.
+    size_t nextBin = bin + 1;
+    while (nextBin < numBins && binPoints[nextBin] == 0)
+      ++nextBin;
+    if (nextBin == numBins)
+      break;
+
+    // Move the points of this bin to the left.
+    leftPoints += binPoints[bin];
+    if (UseWeights)
+    {
+      childWeightSums.col(0) += classWeightSums.col(bin);
+      childWeightSums.col(1) -= classWeightSums.col(bin);
+      totalLeftWeight += binWeights[bin];
+      totalRightWeight -= binWeights[bin];
+    }
+    else
+    {
+      childCounts.col(0) += classCounts.col(bin);
+      childCounts.col(1) -= classCounts.col(bin);
+    }
+
+    const size_t rightPoints = data.n_elem - leftPoints;
+    const ElemType splitValue = (binMax[bin] + binMin[nextBin]) / 2.0;
+    bin = nextBin;
+
+    // Make sure that both children are large enough.
+    if (leftPoints < minimum)
+      continue;
+    if (rightPoints < minimum)
+      break;
+
+    // Calculate the gain for the left and right child.  Only use weights if
+    // needed.
+    const double leftGain = UseWeights ?
+        FitnessFunction::template EvaluatePtr<true>(childWeightSums.colptr(0),
+            numClasses, totalLeftWeight) :
+        FitnessFunction::template EvaluatePtr<false>(childCounts.colptr(0),
+            numClasses, leftPoints);
+    const double rightGain = UseWeights ?
+        FitnessFunction::template EvaluatePtr<true>(childWeightSums.colptr(1),
+            numClasses, totalRightWeight) :
+        FitnessFunction::template EvaluatePtr<false>(childCounts.colptr(1),
+            numClasses, rightPoints);
+
+    double gain;
+    if (UseWeights)
+      gain = totalLeftWeight * leftGain + totalRightWeight * rightGain;
+    else
+      gain = double(leftPoints) * leftGain + double(rightPoints) * rightGain;
+
+    // Corner case: is this the best possible split?
+    if (gain >= 0.0)
+    {
+      // We can take a shortcut: no split will be better than this, so just take
+      // this one.
+      classProbabilities.set_size(1);
+      classProbabilities[0] = splitValue;
+      return gain;
+    }
+    else if (gain > bestFoundGain)
+    {
+      // We still have a better split.
+      bestFoundGain = gain;
+      classProbabilities.set_size(1);
+      classProbabilities[0] = splitValue;
+      improved = true;
+    }
+  }
+
+  // If we didn't improve, return the original gain exactly as we got it
+  // (without introducing floating point errors).
+  if (!improved)
+    return DBL_MAX;
+
+  if (UseWeights)
+    bestFoundGain /= totalWeight;
+  else
+    bestFoundGain /= data.n_elem;
+
+  return bestFoundGain;
+}
+
+template<typename FitnessFunction, size_t NumBins>
+template<typename ElemType>
+size_t BinnedNumericSplit<FitnessFunction, NumBins>::CalculateDirection(
+    const ElemType& point,
+    const arma::Col<ElemType>& classProbabilities,
+    const AuxiliarySplitInfo<ElemType>& /* aux */)
+{
+  if (point <= classProbabilities[0])
+    return 0; // Go left.
+  else
+    return 1; // Go right.
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -148,7 +148,10 @@ class DTree
 
   /**
    * Greedily expand the tree.  The points in the dataset will be reordered
-   * during tree growth.
+   * during tree growth.  Dense datasets are sorted once in each dimension, and
+   * the sorted orders are passed down the tree, so that no node sorts its
+   * points again; the orders take data.n_rows * data.n_cols indices.  Large
+   * subtrees are grown in parallel when OpenMP is available.
    *
    * @param data Dataset to build tree on.
    * @param oldFromNew Mappings from old points to new points.
@@ -334,10 +337,58 @@ class DTree
  private:
   // Utility methods.
 
+  //! Nodes with at least this many points grow their children as tasks.
+  static const size_t ParallelGrowThreshold = 1024;
+  //! The sorted orders are partitioned in parallel if a node has at least this
+  //! many (point, dimension) entries.
+  static const size_t ParallelPartitionThreshold = 16384;
+
+  /**
+   * Grow the tree, given the order of the points of this node in each
+   * dimension (see details::SortDimensions()); if sortedIndices is empty, each
+   * node sorts its points itself.  The orders are partitioned along with the
+   * points.
+   */
+  double Grow(MatType& data,
+              arma::Col<size_t>& oldFromNew,
+              arma::Mat<size_t>& sortedIndices,
+              const bool useVolReg,
+              const size_t maxLeafSize,
+              const size_t minLeafSize);
+
+  /**
+   * Grow the two children of this node, as parallel tasks if the node is large
+   * enough, and store the minimum alpha values of their subtrees.
+   */
+  void GrowChildren(MatType& data,
+                    arma::Col<size_t>& oldFromNew,
+                    arma::Mat<size_t>& sortedIndices,
+                    const bool useVolReg,
+                    const size_t maxLeafSize,
+                    const size_t minLeafSize,
+                    double& leftG,
+                    double& rightG);
+
   /**
    * Find the dimension to split on.
    */
   bool FindSplit(const MatType& data,
+                 size_t& splitDim,
+                 ElemType& splitValue,
+                 double& leftError,
+                 double& rightError,
+                 const size_t minLeafSize = 5) const
+  {
+    return FindSplit(data, arma::Mat<size_t>(), splitDim, splitValue,
+        leftError, rightError, minLeafSize);
+  }
+
+  /**
+   * Find the dimension to split on, using the given order of the points of
+   * this node in each dimension if it is not empty.
+   */
+  bool FindSplit(const MatType& data,
+                 const arma::Mat<size_t>& sortedIndices,
                  size_t& splitDim,
                  ElemType& splitValue,
                  double& leftError,
@@ -350,7 +401,22 @@ class DTree
   size_t SplitData(MatType& data,
                    const size_t splitDim,
                    const ElemType splitValue,
-                   arma::Col<size_t>& oldFromNew) const;
+                   arma::Col<size_t>& oldFromNew) const
+  {
+    arma::Mat<size_t> sortedIndices;
+    return SplitData(data, splitDim, splitValue, oldFromNew, sortedIndices);
+  }
+
+  /**
+   * Split the data, returning the number of points left of the split.  If the
+   * given order of the points of this node in each dimension is not empty, it
+   * is partitioned into the orders of the children.
+   */
+  size_t SplitData(MatType& data,
+                   const size_t splitDim,
+                   const ElemType splitValue,
+                   arma::Col<size_t>& oldFromNew,
+                   arma::Mat<size_t>& sortedIndices) const;
 
   void  FillMinMax(const StatType& mins,
                    const StatType& maxs);
@@ -147,6 +147,64 @@ void ExtractSplits(std::vector<std::pair<ElemType, size_t>>& splitVec,
   }
 }
 
+/**
+ * The same as the dense ExtractSplits(), but the points of the node are
+ * already sorted in this dimension: sortedIndex holds the columns of the points
+ * of the node in sorted order, so no sorting is needed.
+ */
+template<typename ElemType, typename MatType>
+void ExtractSortedSplits(std::vector<std::pair<ElemType, size_t>>& splitVec,
+                         const MatType& data,
+                         const size_t* sortedIndex,
+                         size_t dim,
+                         const size_t start,
+                         const size_t end,
+                         const size_t minLeafSize)
+{
+  typedef std::pair<ElemType, size_t> SplitItem;
+  const size_t n_elem = end - start;
+
+  for (size_t i = minLeafSize - 1; i < n_elem - minLeafSize; ++i)
+  {
+    const ElemType value = data(dim, sortedIndex[start + i]);
+    const ElemType nextValue = data(dim, sortedIndex[start + i + 1]);
+    const ElemType split = (value + nextValue) / 2.0;
+
+    if (split != value)
+      splitVec.push_back(SplitItem(split, i + 1));
+  }
+}
+
+/**
+ * Sort the points of the data in each dimension, for ExtractSortedSplits().
+ * Column d of sortedIndices holds the columns of the points, sorted by their
+ * values in dimension d.  General implementation, which sorts nothing; only
+ * dense matrices are presorted, since sparse matrices have their own
+ * ExtractSplits() that skips the zeros.
+ */
+template<typename MatType>
+void SortDimensions(const MatType& /* data */,
+                    arma::Mat<size_t>& sortedIndices)
+{
+  sortedIndices.clear();
+}
+
+// Now the dense arma::Mat implementation.
+template<typename ElemType>
+void SortDimensions(const arma::Mat<ElemType>& data,
+                    arma::Mat<size_t>& sortedIndices)
+{
+  sortedIndices.set_size(data.n_cols, data.n_rows);
+
+  #pragma omp parallel for
+  for (omp_size_t dim = 0; dim < (omp_size_t) data.n_rows; ++dim)
+  {
+    const arma::uvec order = arma::stable_sort_index(data.row(dim));
+    for (size_t i = 0; i < order.n_elem; ++i)
+      sortedIndices(i, dim) = order[i];
+  }
+}
+
 } // namespace details
 
 template<typename MatType, typename TagType>
@@ -435,6 +493,7 @@ double DTree<MatType, TagType>::LogNegativeError(const size_t totalPoints) const
 // end are used to obtain the point in this node.
 template<typename MatType, typename TagType>
 bool DTree<MatType, TagType>::FindSplit(const MatType& data,
+                                        const arma::Mat<size_t>& sortedIndices,
                                         size_t& splitDim,
                                         ElemType& splitValue,
                                         double& leftError,
@@ -487,9 +546,18 @@ bool DTree<MatType, TagType>::FindSplit(const MatType& data,
     // copy operations (3). This one has custom implementation for dense and
     // sparse matrices.
 
+    // If the points are presorted, the splits can be read off directly.
     std::vector<SplitItem> splitVec;
-    details::ExtractSplits<ElemType>(splitVec, data, dim, start, end,
-        minLeafSize);
+    if (sortedIndices.n_elem > 0)
+    {
+      details::ExtractSortedSplits<ElemType>(splitVec, data,
+          sortedIndices.colptr(dim), dim, start, end, minLeafSize);
+    }
+    else
+    {
+      details::ExtractSplits<ElemType>(splitVec, data, dim, start, end,
+          minLeafSize);
+    }
 
     // Iterate on all the splits for this dimension
     for (typename std::vector<SplitItem>::iterator i = splitVec.begin();
@@ -555,8 +623,22 @@ template<typename MatType, typename TagType>
 size_t DTree<MatType, TagType>::SplitData(MatType& data,
                                           const size_t splitDim,
                                           const ElemType splitValue,
-                                          arma::Col<size_t>& oldFromNew) const
+                                          arma::Col<size_t>& oldFromNew,
+                                          arma::Mat<size_t>& sortedIndices)
+    const
 {
+  // If the points are presorted, we need to know where each point of the node
+  // moves to; oldPosition[i - start] is the column that the point now in
+  // column i was in.
+  const bool presorted = (sortedIndices.n_elem > 0);
+  std::vector<size_t> oldPosition;
+  if (presorted)
+  {
+    oldPosition.resize(end - start);
+    for (size_t i = start; i < end; ++i)
+      oldPosition[i - start] = i;
+  }
+
   // Swap all columns such that any columns with value in dimension splitDim
   // less than or equal to splitValue are on the left side, and all others are
   // on the right side.  A similar sort to this is also performed in
@@ -579,10 +661,47 @@ size_t DTree<MatType, TagType>::SplitData(MatType& data,
     const size_t tmp = oldFromNew[left];
     oldFromNew[left] = oldFromNew[right];
     oldFromNew[right] = tmp;
+
+    if (presorted)
+      std::swap(oldPosition[left - start], oldPosition[right - start]);
   }
 
   // This now refers to the first index of the "right" side.
-  return left;
+  const size_t splitIndex = left;
+
+  if (presorted)
+  {
+    std::vector<size_t> newPosition(end - start);
+    for (size_t i = start; i < end; ++i)
+      newPosition[oldPosition[i - start] - start] = i;
+
+    // Partition the sorted order of the node in each dimension into the orders
+    // of the two children.  The partition is stable, so both orders stay
+    // sorted.
+    #pragma omp parallel for \
+        if ((end - start) * sortedIndices.n_cols >= \
+            ParallelPartitionThreshold && !omp_in_parallel())
+    for (omp_size_t dim = 0; dim < (omp_size_t) sortedIndices.n_cols; ++dim)
+    {
+      size_t* order = sortedIndices.colptr(dim);
+      std::vector<size_t> rightOrder;
+      rightOrder.reserve(end - splitIndex);
+
+      size_t leftEnd = start;
+      for (size_t i = start; i < end; ++i)
+      {
+        const size_t position = newPosition[order[i] - start];
+        if (position < splitIndex)
+          order[leftEnd++] = position;
+        else
+          rightOrder.push_back(position);
+      }
+
+      std::copy(rightOrder.begin(), rightOrder.end(), order + leftEnd);
+    }
+  }
+
+  return splitIndex;
 }
 
 // Greedily expand the tree.
@@ -592,6 +711,23 @@ double DTree<MatType, TagType>::Grow(MatType& data,
                                      const bool useVolReg,
                                      const size_t maxLeafSize,
                                      const size_t minLeafSize)
+{
+  // Sort the points in each dimension once; the orders are then partitioned
+  // along with the points, so no node has to sort its points again.
+  arma::Mat<size_t> sortedIndices;
+  details::SortDimensions(data, sortedIndices);
+
+  return Grow(data, oldFromNew, sortedIndices, useVolReg, maxLeafSize,
+      minLeafSize);
+}
+
+template<typename MatType, typename TagType>
+double DTree<MatType, TagType>::Grow(MatType& data,
+                                     arma::Col<size_t>& oldFromNew,
+                                     arma::Mat<size_t>& sortedIndices,
+                                     const bool useVolReg,
+                                     const size_t maxLeafSize,
+                                     const size_t minLeafSize)
 {
   Log::Assert(data.n_rows == maxVals.n_elem);
   Log::Assert(data.n_rows == minVals.n_elem);
@@ -614,11 +750,13 @@ double DTree<MatType, TagType>::Grow(MatType& data,
     size_t dim;
     double splitValueTmp;
     double leftError, rightError;
-    if (FindSplit(data, dim, splitValueTmp, leftError, rightError, minLeafSize))
+    if (FindSplit(data, sortedIndices, dim, splitValueTmp, leftError,
+        rightError, minLeafSize))
     {
       // Move the data around for the children to have points in a node lie
       // contiguously (to increase efficiency during the training).
-      const size_t splitIndex = SplitData(data, dim, splitValueTmp, oldFromNew);
+      const size_t splitIndex = SplitData(data, dim, splitValueTmp, oldFromNew,
+          sortedIndices);
 
       // Make max and min vals for the children.
       StatType maxValsL(maxVals);
@@ -637,10 +775,8 @@ double DTree<MatType, TagType>::Grow(MatType& data,
       left = new DTree(maxValsL, minValsL, start, splitIndex, leftError);
       right = new DTree(maxValsR, minValsR, splitIndex, end, rightError);
 
-      leftG = left->Grow(data, oldFromNew, useVolReg, maxLeafSize,
-                         minLeafSize);
-      rightG = right->Grow(data, oldFromNew, useVolReg, maxLeafSize,
-                           minLeafSize);
+      GrowChildren(data, oldFromNew, sortedIndices, useVolReg, maxLeafSize,
+          minLeafSize, leftG, rightG);
 
       // Store values of R(T~) and |T~|.
       subtreeLeaves = left->SubtreeLeaves() + right->SubtreeLeaves();
@@ -735,6 +871,68 @@ double DTree<MatType, TagType>::Grow(MatType& data,
 }
 
 
+template<typename MatType, typename TagType>
+void DTree<MatType, TagType>::GrowChildren(MatType& data,
+                                           arma::Col<size_t>& oldFromNew,
+                                           arma::Mat<size_t>& sortedIndices,
+                                           const bool useVolReg,
+                                           const size_t maxLeafSize,
+                                           const size_t minLeafSize,
+                                           double& leftG,
+                                           double& rightG)
+{
+  auto growLeft = [&]()
+  {
+    leftG = left->Grow(data, oldFromNew, sortedIndices, useVolReg,
+        maxLeafSize, minLeafSize);
+  };
+  auto growRight = [&]()
+  {
+    rightG = right->Grow(data, oldFromNew, sortedIndices, useVolReg,
+        maxLeafSize, minLeafSize);
+  };
+
+  #ifdef HAS_OPENMP
+  // Growing a small subtree is not worth a task.
+  const size_t points = end - start;
+  if (points >= ParallelGrowThreshold && omp_get_max_threads() > 1)
+  {
+    // The children hold disjoint ranges of the dataset (and of oldFromNew and
+    // the sorted orders), so they can be grown at the same time.
+    if (omp_in_parallel())
+    {
+      #pragma omp task
+      growLeft();
+      growRight();
+      #pragma omp taskwait
+      return;
+    }
+
+    // As long as the node is a large part of the dataset, its children are
+    // grown one after another, so that the dimensions of each of them are
+    // searched by all threads (see FindSplit()).  Below that, we start a
+    // parallel region in which the rest of the subtree is grown with tasks.
+    if (points * omp_get_max_threads() <= 2 * data.n_cols)
+    {
+      #pragma omp parallel
+      {
+        #pragma omp single
+        {
+          #pragma omp task
+          growLeft();
+          growRight();
+          #pragma omp taskwait
+        }
+      }
+      return;
+    }
+  }
+  #endif
+
+  growLeft();
+  growRight();
+}
+
 template<typename MatType, typename TagType>
 double DTree<MatType, TagType>::PruneAndUpdate(const double oldAlpha,
                                                const size_t points,
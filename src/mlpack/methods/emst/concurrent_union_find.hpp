@@ -0,0 +1,105 @@
+/**
+ * @file concurrent_union_find.hpp
+ *
+ * A Union-Find data structure that may be used from several threads at once.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_EMST_CONCURRENT_UNION_FIND_HPP
+#define MLPACK_METHODS_EMST_CONCURRENT_UNION_FIND_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <atomic>
+
+namespace mlpack {
+namespace emst {
+
+/**
+ * A lock-free Union-Find data structure, with the same interface as UnionFind.
+ * Find() and Union() may be called concurrently from any number of threads.
+ *
+ * Instead of union by rank, the root with the larger index is always linked
+ * below the root with the smaller index, so every parent index is at most the
+ * index of its child and no cycles can form even when unions race.  Links are
+ * made with compare-and-swap on the root, and a Union() that loses a race
+ * retries with the new roots.  Find() uses path halving, which only ever
+ * replaces a parent with one of its ancestors, so it is safe to do
+ * concurrently as well.
+ */
+class ConcurrentUnionFind
+{
+ private:
+  std::vector<std::atomic<size_t>> parent;
+
+ public:
+  //! Construct the object with the given size.
+  ConcurrentUnionFind(const size_t size) : parent(size)
+  {
+    for (size_t i = 0; i < size; ++i)
+      parent[i].store(i, std::memory_order_relaxed);
+  }
+
+  /**
+   * Returns the component containing an element.
+   *
+   * @param x the component to be found
+   * @return The index of the component containing x
+   */
+  size_t Find(size_t x)
+  {
+    while (true)
+    {
+      size_t p = parent[x].load(std::memory_order_relaxed);
+      if (p == x)
+        return x;
+
+      // Point x at its grandparent, if another thread hasn't changed it.
+      const size_t grandparent = parent[p].load(std::memory_order_relaxed);
+      if (grandparent != p)
+      {
+        parent[x].compare_exchange_weak(p, grandparent,
+            std::memory_order_relaxed);
+      }
+
+      x = grandparent;
+    }
+  }
+
+  /**
+   * Union the components containing x and y.
+   *
+   * @param x one component
+   * @param y the other component
+   * @return Whether the components were merged by this call; false if x and y
+   *     were already in the same component.
+   */
+  bool Union(size_t x, size_t y)
+  {
+    while (true)
+    {
+      x = Find(x);
+      y = Find(y);
+
+      if (x == y)
+        return false;
+
+      // Link the root with the larger index below the other one.
+      if (x < y)
+        std::swap(x, y);
+
+      size_t expected = x;
+      if (parent[x].compare_exchange_strong(expected, y,
+          std::memory_order_relaxed))
+        return true;
+    }
+  }
+}; // class ConcurrentUnionFind
+
+} // namespace emst
+} // namespace mlpack
+
+#endif // MLPACK_METHODS_EMST_CONCURRENT_UNION_FIND_HPP
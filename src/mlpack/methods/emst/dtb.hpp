@@ -27,6 +27,8 @@
 
 #include "dtb_stat.hpp"
 #include "edge_pair.hpp"
+#include "union_find.hpp"
+#include "concurrent_union_find.hpp"
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
@@ -99,8 +101,8 @@ class DualTreeBoruvka
   //! Indicates whether or not O(n^2) naive mode will be used.
   bool naive;
 
-  //! Edges.
-  std::vector<EdgePair> edges; // We must use vector with non-numerical types.
+  //! Number of edges found so far.
+  size_t numEdges;
 
   //! Connections.
   UnionFind connections;
@@ -121,7 +123,8 @@ class DualTreeBoruvka
   //! For sorting the edge list after the computation.
   struct SortEdgesHelper
   {
-    bool operator()(const EdgePair& pairA, const EdgePair& pairB)
+    template<typename EdgeType>
+    bool operator()(const EdgeType& pairA, const EdgeType& pairB)
     {
       return (pairA.Distance() < pairB.Distance());
     }
@@ -172,31 +175,119 @@ class DualTreeBoruvka
    * index of the edge; the second row will contain the greater index of the
    * edge; and the third row will contain the distance between the two edges.
    *
+   * If parallel is true (and OpenMP is available), each Boruvka round is run
+   * in parallel: the query side of the tree is split into disjoint subtrees
+   * that are traversed against the whole tree by different threads, each
+   * thread keeps its own candidate edge for every component, the candidates
+   * are reduced per component, and the components are merged with a lock-free
+   * union-find.  When edges have equal lengths, the spanning tree may differ
+   * from the serial one, but its total length is the same.
+   *
    * @param results Matrix which results will be stored in.
+   * @param parallel Whether to run the Boruvka rounds in parallel.
+   */
+  void ComputeMST(arma::mat& results, const bool parallel = false);
+
+  /**
+   * Compute the minimum spanning tree, like above, but store the edges in the
+   * given list of EdgePairs (sorted by distance, with the lesser index first)
+   * instead of a matrix.  The edge list is the only copy of the results, so a
+   * list of CompactEdgePairs takes half the memory of the default EdgePairs
+   * and a third of a 3xN matrix (which is filled from an edge list).
+   *
+   * @param results List which the edges will be stored in.
+   * @param parallel Whether to run the Boruvka rounds in parallel.
+   */
+  template<typename EdgeType>
+  void ComputeMST(std::vector<EdgeType>& results,
+                  const bool parallel = false);
+
+  /**
+   * Compute the minimum spanning tree, passing each edge to the given callback
+   * as soon as it is found, instead of storing the edges.  The callback must
+   * be callable as
+   *
+   * @code
+   * callback(lesser, greater, distance);
+   * @endcode
+   *
+   * with the indices of the points of the edge (the lesser first) and the
+   * distance between them.  The edges are not passed in order of distance,
+   * and the callback is only ever called from one thread at a time.
+   *
+   * @param callback Callback to pass each edge to.
+   * @param parallel Whether to run the Boruvka rounds in parallel.
    */
-  void ComputeMST(arma::mat& results);
+  template<typename CallbackType>
+  void StreamMST(CallbackType& callback, const bool parallel = false);
+
+  /**
+   * Compute the single-linkage dendrogram of the dataset (the order in which
+   * the points are merged into clusters as the distance grows), which is
+   * given by the edges of the minimum spanning tree in order of distance.
+   * The results will be a 4x(N - 1) matrix (with N equal to the number of
+   * points), in the same format as the (transposed) linkage matrix of SciPy:
+   * column i merges the clusters with the indices in the first two rows (with
+   * indices below N being single points, and index N + j being the cluster
+   * made by column j) at the distance in the third row, into a cluster with
+   * the number of points in the fourth row.
+   *
+   * @param linkage Matrix which the dendrogram will be stored in.
+   * @param parallel Whether to run the Boruvka rounds in parallel.
+   */
+  void ComputeDendrogram(arma::mat& linkage, const bool parallel = false);
 
  private:
   /**
-   * Adds a single edge to the edge list
+   * Adds a single edge to the MST, passing it (with its original indices) to
+   * the callback.
    */
-  void AddEdge(const size_t e1, const size_t e2, const double distance);
+  template<typename CallbackType>
+  void AddEdge(const size_t e1,
+               const size_t e2,
+               const double distance,
+               CallbackType& callback);
 
   /**
    * Adds all the edges found in one iteration to the list of neighbors.
    */
-  void AddAllEdges();
+  template<typename CallbackType>
+  void AddAllEdges(CallbackType& callback);
 
   /**
-   * Unpermute the edge list and output it to results.
+   * Run all Boruvka rounds in parallel, passing the edges of the MST to the
+   * callback.
    */
-  void EmitResults(arma::mat& results);
+  template<typename CallbackType>
+  void ComputeParallelMST(CallbackType& callback);
+
+  /**
+   * Split the tree into disjoint subtrees that can be traversed in parallel.
+   * Nodes are expanded breadth-first until there are enough subtrees; nodes
+   * holding points of their own are never expanded, so every point is in
+   * exactly one subtree.
+   *
+   * @param expanded Nodes that were split, in breadth-first order.
+   * @param subtrees Roots of the disjoint subtrees.
+   * @param minSubtrees Number of subtrees to create, if possible.
+   */
+  void SplitTree(std::vector<Tree*>& expanded,
+                 std::vector<Tree*>& subtrees,
+                 const size_t minSubtrees);
 
   /**
    * This function resets the values in the nodes of the tree nearest neighbor
    * distance, and checks for fully connected nodes.
    */
-  void CleanupHelper(Tree* tree);
+  template<typename UnionFindType>
+  void CleanupHelper(Tree* tree, UnionFindType& unionFind);
+
+  /**
+   * Reset the values in a single node and check whether it is fully connected;
+   * the children of the node must already be cleaned up.
+   */
+  template<typename UnionFindType>
+  void CleanupNode(Tree* tree, UnionFindType& unionFind);
 
   /**
    * The values stored in the tree must be reset on each iteration.
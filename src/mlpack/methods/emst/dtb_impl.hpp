@@ -14,6 +14,8 @@
 
 #include "dtb_rules.hpp"
 
+#include <queue>
+
 namespace mlpack {
 namespace emst {
 
@@ -57,12 +59,11 @@ DualTreeBoruvka<MetricType, MatType, TreeType>::DualTreeBoruvka(
     data(naive ? dataset : tree->Dataset()),
     ownTree(!naive),
     naive(naive),
+    numEdges(0),
     connections(dataset.n_cols),
     totalDist(0.0),
     metric(metric)
 {
-  edges.reserve(data.n_cols - 1); // Set size.
-
   neighborsInComponent.set_size(data.n_cols);
   neighborsOutComponent.set_size(data.n_cols);
   neighborsDistances.set_size(data.n_cols);
@@ -82,12 +83,11 @@ DualTreeBoruvka<MetricType, MatType, TreeType>::DualTreeBoruvka(
     data(tree->Dataset()),
     ownTree(false),
     naive(false),
+    numEdges(0),
     connections(data.n_cols),
     totalDist(0.0),
     metric(metric)
 {
-  edges.reserve(data.n_cols - 1); // Fill with EdgePairs.
-
   neighborsInComponent.set_size(data.n_cols);
   neighborsOutComponent.set_size(data.n_cols);
   neighborsDistances.set_size(data.n_cols);
@@ -117,52 +117,160 @@ template<
              typename TreeStatType,
              typename TreeMatType> class TreeType>
 void DualTreeBoruvka<MetricType, MatType, TreeType>::ComputeMST(
-    arma::mat& results)
+    arma::mat& results,
+    const bool parallel)
+{
+  std::vector<EdgePair> edges;
+  ComputeMST(edges, parallel);
+
+  results.set_size(3, edges.size());
+  for (size_t i = 0; i < edges.size(); ++i)
+  {
+    results(0, i) = edges[i].Lesser();
+    results(1, i) = edges[i].Greater();
+    results(2, i) = edges[i].Distance();
+  }
+}
+
+/**
+ * Compute the MST into a (sorted) edge list.
+ */
+template<
+    typename MetricType,
+    typename MatType,
+    template<typename TreeMetricType,
+             typename TreeStatType,
+             typename TreeMatType> class TreeType>
+template<typename EdgeType>
+void DualTreeBoruvka<MetricType, MatType, TreeType>::ComputeMST(
+    std::vector<EdgeType>& results,
+    const bool parallel)
+{
+  results.clear();
+  results.reserve(data.n_cols - 1);
+
+  auto callback = [&results](const size_t lesser,
+                             const size_t greater,
+                             const double distance)
+  {
+    results.push_back(EdgeType(lesser, greater, distance));
+  };
+  StreamMST(callback, parallel);
+
+  std::sort(results.begin(), results.end(), SortFun);
+}
+
+/**
+ * Compute the MST, passing each edge to the callback as it is found.
+ */
+template<
+    typename MetricType,
+    typename MatType,
+    template<typename TreeMetricType,
+             typename TreeStatType,
+             typename TreeMatType> class TreeType>
+template<typename CallbackType>
+void DualTreeBoruvka<MetricType, MatType, TreeType>::StreamMST(
+    CallbackType& callback,
+    const bool parallel)
 {
   Timer::Start("emst/mst_computation");
 
   totalDist = 0; // Reset distance.
 
-  typedef DTBRules<MetricType, Tree> RuleType;
-  RuleType rules(data, connections, neighborsDistances, neighborsInComponent,
-                 neighborsOutComponent, metric);
-  while (edges.size() < (data.n_cols - 1))
+  if (parallel)
   {
-    if (naive)
-    {
-      // Full O(N^2) traversal.
-      for (size_t i = 0; i < data.n_cols; ++i)
-        for (size_t j = 0; j < data.n_cols; ++j)
-          rules.BaseCase(i, j);
-    }
-    else
+    ComputeParallelMST(callback);
+  }
+  else
+  {
+    typedef DTBRules<MetricType, Tree> RuleType;
+    RuleType rules(data, connections, neighborsDistances, neighborsInComponent,
+                   neighborsOutComponent, metric);
+    while (numEdges < (data.n_cols - 1))
     {
-      typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
-      traverser.Traverse(*tree, *tree);
-    }
+      if (naive)
+      {
+        // Full O(N^2) traversal.
+        for (size_t i = 0; i < data.n_cols; ++i)
+          for (size_t j = 0; j < data.n_cols; ++j)
+            rules.BaseCase(i, j);
+      }
+      else
+      {
+        typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+        traverser.Traverse(*tree, *tree);
+      }
 
-    AddAllEdges();
+      AddAllEdges(callback);
 
-    Cleanup();
+      Cleanup();
 
-    Log::Info << edges.size() << " edges found so far." << std::endl;
-    if (!naive)
-    {
-      Log::Info << rules.BaseCases() << " cumulative base cases." << std::endl;
-      Log::Info << rules.Scores() << " cumulative node combinations scored."
-          << std::endl;
+      Log::Info << numEdges << " edges found so far." << std::endl;
+      if (!naive)
+      {
+        Log::Info << rules.BaseCases() << " cumulative base cases."
+            << std::endl;
+        Log::Info << rules.Scores() << " cumulative node combinations scored."
+            << std::endl;
+      }
     }
   }
 
   Timer::Stop("emst/mst_computation");
 
-  EmitResults(results);
-
+  Log::Assert(numEdges == data.n_cols - 1);
   Log::Info << "Total spanning tree length: " << totalDist << std::endl;
 }
 
 /**
- * Adds a single edge to the edge list
+ * Compute the single-linkage dendrogram from the MST.
+ */
+template<
+    typename MetricType,
+    typename MatType,
+    template<typename TreeMetricType,
+             typename TreeStatType,
+             typename TreeMatType> class TreeType>
+void DualTreeBoruvka<MetricType, MatType, TreeType>::ComputeDendrogram(
+    arma::mat& linkage,
+    const bool parallel)
+{
+  std::vector<EdgePair> edges;
+  ComputeMST(edges, parallel);
+
+  // Merge the clusters in order of distance, keeping the index and size of
+  // the cluster at the root of each component.
+  const size_t n = data.n_cols;
+  UnionFind clusters(n);
+  arma::Col<size_t> clusterIndex(n);
+  arma::Col<size_t> clusterSize(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    clusterIndex[i] = i;
+    clusterSize[i] = 1;
+  }
+
+  linkage.set_size(4, edges.size());
+  for (size_t i = 0; i < edges.size(); ++i)
+  {
+    const size_t rootA = clusters.Find(edges[i].Lesser());
+    const size_t rootB = clusters.Find(edges[i].Greater());
+    linkage(0, i) = std::min(clusterIndex[rootA], clusterIndex[rootB]);
+    linkage(1, i) = std::max(clusterIndex[rootA], clusterIndex[rootB]);
+    linkage(2, i) = edges[i].Distance();
+    const size_t size = clusterSize[rootA] + clusterSize[rootB];
+    linkage(3, i) = size;
+
+    clusters.Union(rootA, rootB);
+    const size_t root = clusters.Find(rootA);
+    clusterIndex[root] = n + i;
+    clusterSize[root] = size;
+  }
+}
+
+/**
+ * Adds a single edge to the MST.
  */
 template<
     typename MetricType,
@@ -170,18 +278,34 @@ template<
     template<typename TreeMetricType,
              typename TreeStatType,
              typename TreeMatType> class TreeType>
+template<typename CallbackType>
 void DualTreeBoruvka<MetricType, MatType, TreeType>::AddEdge(
     const size_t e1,
     const size_t e2,
-    const double distance)
+    const double distance,
+    CallbackType& callback)
 {
   Log::Assert((distance >= 0.0),
       "DualTreeBoruvka::AddEdge(): distance cannot be negative.");
 
-  if (e1 < e2)
-    edges.push_back(EdgePair(e1, e2, distance));
+  ++numEdges;
+  totalDist += distance;
+
+  // Need to unpermute the point labels.
+  size_t ind1 = e1;
+  size_t ind2 = e2;
+  if (!naive && ownTree && tree::TreeTraits<Tree>::RearrangesDataset)
+  {
+    ind1 = oldFromNew[e1];
+    ind2 = oldFromNew[e2];
+  }
+
+  // Make sure the edge list stores the smaller index first to make checking
+  // correctness easier.
+  if (ind1 < ind2)
+    callback(ind1, ind2, distance);
   else
-    edges.push_back(EdgePair(e2, e1, distance));
+    callback(ind2, ind1, distance);
 }
 
 /**
@@ -193,7 +317,9 @@ template<
     template<typename TreeMetricType,
              typename TreeStatType,
              typename TreeMatType> class TreeType>
-void DualTreeBoruvka<MetricType, MatType, TreeType>::AddAllEdges()
+template<typename CallbackType>
+void DualTreeBoruvka<MetricType, MatType, TreeType>::AddAllEdges(
+    CallbackType& callback)
 {
   for (size_t i = 0; i < data.n_cols; i++)
   {
@@ -202,17 +328,14 @@ void DualTreeBoruvka<MetricType, MatType, TreeType>::AddAllEdges()
     size_t outEdge = neighborsOutComponent[component];
     if (connections.Find(inEdge) != connections.Find(outEdge))
     {
-      // totalDist = totalDist + dist;
-      // changed to make this agree with the cover tree code
-      totalDist += neighborsDistances[component];
-      AddEdge(inEdge, outEdge, neighborsDistances[component]);
+      AddEdge(inEdge, outEdge, neighborsDistances[component], callback);
       connections.Union(inEdge, outEdge);
     }
   }
 }
 
 /**
- * Unpermute the edge list (if necessary) and output it to results.
+ * Run all the Boruvka rounds in parallel.
  */
 template<
     typename MetricType,
@@ -220,49 +343,188 @@ template<
     template<typename TreeMetricType,
              typename TreeStatType,
              typename TreeMatType> class TreeType>
-void DualTreeBoruvka<MetricType, MatType, TreeType>::EmitResults(
-    arma::mat& results)
+template<typename CallbackType>
+void DualTreeBoruvka<MetricType, MatType, TreeType>::ComputeParallelMST(
+    CallbackType& callback)
 {
-  // Sort the edges.
-  std::sort(edges.begin(), edges.end(), SortFun);
+  // The components are found concurrently during the traversals and merged
+  // concurrently afterwards, so the lock-free union-find is used instead of
+  // the member one.
+  ConcurrentUnionFind parallelConnections(data.n_cols);
+
+  #ifdef HAS_OPENMP
+  const size_t maxThreads = omp_get_max_threads();
+  #else
+  const size_t maxThreads = 1;
+  #endif
+
+  // Every thread traverses whole subtrees of the query tree, so the bounds
+  // stored in each query node are only ever updated by one thread.
+  std::vector<Tree*> expanded;
+  std::vector<Tree*> subtrees;
+  if (!naive)
+    SplitTree(expanded, subtrees, 4 * maxThreads);
 
-  Log::Assert(edges.size() == data.n_cols - 1);
-  results.set_size(3, edges.size());
+  // The candidate edge of each component found by each thread.
+  std::vector<arma::vec> threadDistances(maxThreads);
+  std::vector<arma::Col<size_t>> threadInComponent(maxThreads);
+  std::vector<arma::Col<size_t>> threadOutComponent(maxThreads);
 
-  // Need to unpermute the point labels.
-  if (!naive && ownTree && tree::TreeTraits<Tree>::RearrangesDataset)
+  typedef DTBRules<MetricType, Tree, ConcurrentUnionFind> RuleType;
+  size_t baseCases = 0;
+  size_t scores = 0;
+  while (numEdges < (data.n_cols - 1))
   {
-    for (size_t i = 0; i < (data.n_cols - 1); i++)
+    size_t numThreads = 1;
+    #pragma omp parallel
     {
-      // Make sure the edge list stores the smaller index first to
-      // make checking correctness easier
-      size_t ind1 = oldFromNew[edges[i].Lesser()];
-      size_t ind2 = oldFromNew[edges[i].Greater()];
-
-      if (ind1 < ind2)
+      #ifdef HAS_OPENMP
+      const size_t thread = omp_get_thread_num();
+      #pragma omp single
+      numThreads = omp_get_num_threads();
+      #else
+      const size_t thread = 0;
+      #endif
+
+      threadDistances[thread].set_size(data.n_cols);
+      threadDistances[thread].fill(DBL_MAX);
+      threadInComponent[thread].set_size(data.n_cols);
+      threadOutComponent[thread].set_size(data.n_cols);
+
+      MetricType threadMetric(metric);
+      RuleType rules(data, parallelConnections, threadDistances[thread],
+          threadInComponent[thread], threadOutComponent[thread], threadMetric);
+
+      if (naive)
       {
-        edges[i].Lesser() = ind1;
-        edges[i].Greater() = ind2;
+        // Full O(N^2) traversal.
+        #pragma omp for schedule(dynamic, 64)
+        for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
+          for (size_t j = 0; j < data.n_cols; ++j)
+            rules.BaseCase(i, j);
       }
       else
       {
-        edges[i].Lesser() = ind2;
-        edges[i].Greater() = ind1;
+        typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+        #pragma omp for schedule(dynamic)
+        for (omp_size_t i = 0; i < (omp_size_t) subtrees.size(); ++i)
+          traverser.Traverse(*subtrees[i], *tree);
       }
 
-      results(0, i) = edges[i].Lesser();
-      results(1, i) = edges[i].Greater();
-      results(2, i) = edges[i].Distance();
+      #pragma omp atomic
+      baseCases += rules.BaseCases();
+      #pragma omp atomic
+      scores += rules.Scores();
+    }
+
+    // Reduce the candidate edges of each component.
+    #pragma omp parallel for
+    for (omp_size_t c = 0; c < (omp_size_t) data.n_cols; ++c)
+    {
+      for (size_t t = 0; t < numThreads; ++t)
+      {
+        if (threadDistances[t][c] < neighborsDistances[c])
+        {
+          neighborsDistances[c] = threadDistances[t][c];
+          neighborsInComponent[c] = threadInComponent[t][c];
+          neighborsOutComponent[c] = threadOutComponent[t][c];
+        }
+      }
+    }
+
+    // Merge the components.  Only the thread whose union succeeds adds the
+    // edge, so an edge found by both of its components is added once.
+    #pragma omp parallel
+    {
+      std::vector<EdgePair> threadEdges;
+
+      #pragma omp for
+      for (omp_size_t c = 0; c < (omp_size_t) data.n_cols; ++c)
+      {
+        if (neighborsDistances[c] == DBL_MAX)
+          continue;
+
+        const size_t inEdge = neighborsInComponent[c];
+        const size_t outEdge = neighborsOutComponent[c];
+        if (parallelConnections.Union(inEdge, outEdge))
+        {
+          threadEdges.push_back(EdgePair(inEdge, outEdge,
+              neighborsDistances[c]));
+        }
+      }
+
+      #pragma omp critical
+      {
+        for (size_t i = 0; i < threadEdges.size(); ++i)
+        {
+          AddEdge(threadEdges[i].Lesser(), threadEdges[i].Greater(),
+              threadEdges[i].Distance(), callback);
+        }
+      }
+    }
+
+    // Reset the candidates and the statistics of the tree.
+    #pragma omp parallel for
+    for (omp_size_t c = 0; c < (omp_size_t) data.n_cols; ++c)
+      neighborsDistances[c] = DBL_MAX;
+
+    if (!naive)
+    {
+      #pragma omp parallel for schedule(dynamic)
+      for (omp_size_t i = 0; i < (omp_size_t) subtrees.size(); ++i)
+        CleanupHelper(subtrees[i], parallelConnections);
+
+      // Children come after their parents in the breadth-first order.
+      for (size_t i = expanded.size(); i > 0; --i)
+        CleanupNode(expanded[i - 1], parallelConnections);
+    }
+
+    Log::Info << numEdges << " edges found so far." << std::endl;
+    if (!naive)
+    {
+      Log::Info << baseCases << " cumulative base cases." << std::endl;
+      Log::Info << scores << " cumulative node combinations scored."
+          << std::endl;
     }
   }
-  else
+}
+
+/**
+ * Split the tree into disjoint subtrees for the parallel traversals.
+ */
+template<
+    typename MetricType,
+    typename MatType,
+    template<typename TreeMetricType,
+             typename TreeStatType,
+             typename TreeMatType> class TreeType>
+void DualTreeBoruvka<MetricType, MatType, TreeType>::SplitTree(
+    std::vector<Tree*>& expanded,
+    std::vector<Tree*>& subtrees,
+    const size_t minSubtrees)
+{
+  std::queue<Tree*> queue;
+  queue.push(tree);
+  while (!queue.empty() && subtrees.size() + queue.size() < minSubtrees)
   {
-    for (size_t i = 0; i < edges.size(); i++)
+    Tree* node = queue.front();
+    queue.pop();
+
+    if (node->NumChildren() == 0 || node->NumPoints() != 0)
     {
-      results(0, i) = edges[i].Lesser();
-      results(1, i) = edges[i].Greater();
-      results(2, i) = edges[i].Distance();
+      subtrees.push_back(node);
+      continue;
     }
+
+    expanded.push_back(node);
+    for (size_t i = 0; i < node->NumChildren(); ++i)
+      queue.push(&node->Child(i));
+  }
+
+  while (!queue.empty())
+  {
+    subtrees.push_back(queue.front());
+    queue.pop();
   }
 }
 
@@ -276,22 +538,42 @@ template<
     template<typename TreeMetricType,
              typename TreeStatType,
              typename TreeMatType> class TreeType>
-void DualTreeBoruvka<MetricType, MatType, TreeType>::CleanupHelper(Tree* tree)
+template<typename UnionFindType>
+void DualTreeBoruvka<MetricType, MatType, TreeType>::CleanupHelper(
+    Tree* tree,
+    UnionFindType& unionFind)
+{
+  // Recurse into all children.
+  for (size_t i = 0; i < tree->NumChildren(); ++i)
+    CleanupHelper(&tree->Child(i), unionFind);
+
+  CleanupNode(tree, unionFind);
+}
+
+/**
+ * Reset the values in a single node and check whether it is fully connected.
+ */
+template<
+    typename MetricType,
+    typename MatType,
+    template<typename TreeMetricType,
+             typename TreeStatType,
+             typename TreeMatType> class TreeType>
+template<typename UnionFindType>
+void DualTreeBoruvka<MetricType, MatType, TreeType>::CleanupNode(
+    Tree* tree,
+    UnionFindType& unionFind)
 {
   // Reset the statistic information.
   tree->Stat().MaxNeighborDistance() = DBL_MAX;
   tree->Stat().MinNeighborDistance() = DBL_MAX;
   tree->Stat().Bound() = DBL_MAX;
 
-  // Recurse into all children.
-  for (size_t i = 0; i < tree->NumChildren(); ++i)
-    CleanupHelper(&tree->Child(i));
-
   // Get the component of the first child or point.  Then we will check to see
   // if all other components of children and points are the same.
   const int component = (tree->NumChildren() != 0) ?
       tree->Child(0).Stat().ComponentMembership() :
-      connections.Find(tree->Point(0));
+      unionFind.Find(tree->Point(0));
 
   // Check components of children.
   for (size_t i = 0; i < tree->NumChildren(); ++i)
@@ -300,7 +582,7 @@ void DualTreeBoruvka<MetricType, MatType, TreeType>::CleanupHelper(Tree* tree)
 
   // Check components of points.
   for (size_t i = 0; i < tree->NumPoints(); ++i)
-    if (connections.Find(tree->Point(i)) != size_t(component))
+    if (unionFind.Find(tree->Point(i)) != size_t(component))
       return;
 
   // If we made it this far, all components are the same.
@@ -322,7 +604,7 @@ void DualTreeBoruvka<MetricType, MatType, TreeType>::Cleanup()
     neighborsDistances[i] = DBL_MAX;
 
   if (!naive)
-    CleanupHelper(tree);
+    CleanupHelper(tree, connections);
 }
 
 } // namespace emst
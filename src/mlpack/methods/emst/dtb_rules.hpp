@@ -16,15 +16,27 @@
 
 #include <mlpack/core/tree/traversal_info.hpp>
 
+#include "union_find.hpp"
+
 namespace mlpack {
 namespace emst {
 
-template<typename MetricType, typename TreeType>
+/**
+ * The rules for the dual-tree Boruvka traversal.
+ *
+ * @tparam MetricType Metric to use.
+ * @tparam TreeType Type of tree to traverse.
+ * @tparam UnionFindType Union-find structure holding the components; this is
+ *     ConcurrentUnionFind when several traversals run in parallel.
+ */
+template<typename MetricType,
+         typename TreeType,
+         typename UnionFindType = UnionFind>
 class DTBRules
 {
  public:
   DTBRules(const arma::mat& dataSet,
-           UnionFind& connections,
+           UnionFindType& connections,
            arma::vec& neighborsDistances,
            arma::Col<size_t>& neighborsInComponent,
            arma::Col<size_t>& neighborsOutComponent,
@@ -102,7 +114,7 @@ class DTBRules
   const arma::mat& dataSet;
 
   //! Stores the tree structure so far
-  UnionFind& connections;
+  UnionFindType& connections;
 
   //! The distance to the candidate nearest neighbor for each component.
   arma::vec& neighborsDistances;
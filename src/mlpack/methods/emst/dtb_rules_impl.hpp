@@ -15,10 +15,10 @@
 namespace mlpack {
 namespace emst {
 
-template<typename MetricType, typename TreeType>
-DTBRules<MetricType, TreeType>::
+template<typename MetricType, typename TreeType, typename UnionFindType>
+DTBRules<MetricType, TreeType, UnionFindType>::
 DTBRules(const arma::mat& dataSet,
-         UnionFind& connections,
+         UnionFindType& connections,
          arma::vec& neighborsDistances,
          arma::Col<size_t>& neighborsInComponent,
          arma::Col<size_t>& neighborsOutComponent,
@@ -36,10 +36,11 @@ DTBRules(const arma::mat& dataSet,
   // Nothing else to do.
 }
 
-template<typename MetricType, typename TreeType>
+template<typename MetricType, typename TreeType, typename UnionFindType>
 inline force_inline
-double DTBRules<MetricType, TreeType>::BaseCase(const size_t queryIndex,
-                                                const size_t referenceIndex)
+double DTBRules<MetricType, TreeType, UnionFindType>::BaseCase(
+    const size_t queryIndex,
+    const size_t referenceIndex)
 {
   // Check if the points are in the same component at this iteration.
   // If not, return the distance between them.  Also, store a better result as
@@ -75,9 +76,10 @@ double DTBRules<MetricType, TreeType>::BaseCase(const size_t queryIndex,
   return newUpperBound;
 }
 
-template<typename MetricType, typename TreeType>
-double DTBRules<MetricType, TreeType>::Score(const size_t queryIndex,
-                                             TreeType& referenceNode)
+template<typename MetricType, typename TreeType, typename UnionFindType>
+double DTBRules<MetricType, TreeType, UnionFindType>::Score(
+    const size_t queryIndex,
+    TreeType& referenceNode)
 {
   size_t queryComponentIndex = connections.Find(queryIndex);
 
@@ -97,10 +99,11 @@ double DTBRules<MetricType, TreeType>::Score(const size_t queryIndex,
       ? DBL_MAX : distance;
 }
 
-template<typename MetricType, typename TreeType>
-double DTBRules<MetricType, TreeType>::Rescore(const size_t queryIndex,
-                                               TreeType& /* referenceNode */,
-                                               const double oldScore)
+template<typename MetricType, typename TreeType, typename UnionFindType>
+double DTBRules<MetricType, TreeType, UnionFindType>::Rescore(
+    const size_t queryIndex,
+    TreeType& /* referenceNode */,
+    const double oldScore)
 {
   // We don't need to check component membership again, because it can't
   // change inside a single iteration.
@@ -108,9 +111,10 @@ double DTBRules<MetricType, TreeType>::Rescore(const size_t queryIndex,
       ? DBL_MAX : oldScore;
 }
 
-template<typename MetricType, typename TreeType>
-double DTBRules<MetricType, TreeType>::Score(TreeType& queryNode,
-                                             TreeType& referenceNode)
+template<typename MetricType, typename TreeType, typename UnionFindType>
+double DTBRules<MetricType, TreeType, UnionFindType>::Score(
+    TreeType& queryNode,
+    TreeType& referenceNode)
 {
   // If all the queries belong to the same component as all the references
   // then we prune.
@@ -128,10 +132,11 @@ double DTBRules<MetricType, TreeType>::Score(TreeType& queryNode,
   return (bound < distance) ? DBL_MAX : distance;
 }
 
-template<typename MetricType, typename TreeType>
-double DTBRules<MetricType, TreeType>::Rescore(TreeType& queryNode,
-                                               TreeType& /* referenceNode */,
-                                               const double oldScore) const
+template<typename MetricType, typename TreeType, typename UnionFindType>
+double DTBRules<MetricType, TreeType, UnionFindType>::Rescore(
+    TreeType& queryNode,
+    TreeType& /* referenceNode */,
+    const double oldScore) const
 {
   const double bound = CalculateBound(queryNode);
   return (oldScore > bound) ? DBL_MAX : oldScore;
@@ -139,8 +144,8 @@ double DTBRules<MetricType, TreeType>::Rescore(TreeType& queryNode,
 
 // Calculate the bound for a given query node in its current state and update
 // it.
-template<typename MetricType, typename TreeType>
-inline double DTBRules<MetricType, TreeType>::CalculateBound(
+template<typename MetricType, typename TreeType, typename UnionFindType>
+inline double DTBRules<MetricType, TreeType, UnionFindType>::CalculateBound(
     TreeType& queryNode) const
 {
   double worstPointBound = -DBL_MAX;
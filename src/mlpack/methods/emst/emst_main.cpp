@@ -28,6 +28,8 @@
 #include <mlpack/core/util/cli.hpp>
 #include <mlpack/core/util/mlpack_main.hpp>
 
+#include <mlpack/core/tree/fixed_dimension.hpp>
+
 #include "dtb.hpp"
 
 PROGRAM_INFO("Fast Euclidean Minimum Spanning Tree",
@@ -72,6 +74,7 @@ PROGRAM_INFO("Fast Euclidean Minimum Spanning Tree",
 PARAM_MATRIX_IN_REQ("input", "Input data matrix.", "i");
 PARAM_MATRIX_OUT("output", "Output data.  Stored as an edge list.", "o");
 PARAM_FLAG("naive", "Compute the MST using O(n^2) naive algorithm.", "n");
+PARAM_FLAG("parallel", "Run each Boruvka round in parallel with OpenMP.", "p");
 PARAM_INT_IN("leaf_size", "Leaf size in the kd-tree.  One-element leaves give "
     "the empirically best performance, but at the cost of greater memory "
     "requirements.", "l", 1);
@@ -83,53 +86,45 @@ using namespace mlpack::metric;
 using namespace mlpack::util;
 using namespace std;
 
-static void mlpackMain()
+/**
+ * Compute the MST with a kd-tree whose bound and metric are specialized for
+ * data of dimensionality Dim (see FixedDimension), and store it with the
+ * original indices of the points.
+ */
+struct TreeMST
 {
-  RequireAtLeastOnePassed({ "output" }, false, "no output will be saved");
-
-  arma::mat dataPoints = std::move(CLI::GetParam<arma::mat>("input"));
-
-  // Do naive computation if necessary.
-  if (CLI::GetParam<bool>("naive"))
-  {
-    Log::Info << "Running naive algorithm." << endl;
-
-    DualTreeBoruvka<> naive(dataPoints, true);
-
-    arma::mat naiveResults;
-    naive.ComputeMST(naiveResults);
-
-    if (CLI::HasParam("output"))
-      CLI::GetParam<arma::mat>("output") = std::move(naiveResults);
-  }
-  else
+  TreeMST(arma::mat& dataPoints,
+          const size_t leafSize,
+          arma::mat& unmappedResults) :
+      dataPoints(dataPoints),
+      leafSize(leafSize),
+      unmappedResults(unmappedResults)
+  { }
+
+  template<size_t Dim>
+  void operator()(std::integral_constant<size_t, Dim>) const
   {
-    Log::Info << "Building tree.\n";
-
-    // Check that the leaf size is reasonable.
-    RequireParamValue<int>("leaf_size", [](int x) { return x > 0; }, true,
-        "leaf size must be greater than or equal to 1");
-
-    // Initialize the tree and get ready to compute the MST.  Compute the tree
-    // by hand.
-    const size_t leafSize = (size_t) CLI::GetParam<int>("leaf_size");
+    typedef FixedDimension<Dim> Fixed;
+    typedef typename Fixed::EuclideanDistance MetricType;
+    typedef typename Fixed::template KDTree<MetricType, DTBStat, arma::mat>
+        TreeType;
 
     Timer::Start("tree_building");
     std::vector<size_t> oldFromNew;
-    KDTree<EuclideanDistance, DTBStat, arma::mat> tree(dataPoints, oldFromNew,
-        leafSize);
-    metric::LMetric<2, true> metric;
+    TreeType tree(dataPoints, oldFromNew, leafSize);
+    MetricType metric;
     Timer::Stop("tree_building");
 
-    DualTreeBoruvka<> dtb(&tree, metric);
+    DualTreeBoruvka<MetricType, arma::mat, Fixed::template KDTree> dtb(&tree,
+        metric);
 
     // Run the DTB algorithm.
     Log::Info << "Calculating minimum spanning tree." << endl;
     arma::mat results;
-    dtb.ComputeMST(results);
+    dtb.ComputeMST(results, CLI::HasParam("parallel"));
 
     // Unmap the results.
-    arma::mat unmappedResults(results.n_rows, results.n_cols);
+    unmappedResults.set_size(results.n_rows, results.n_cols);
     for (size_t i = 0; i < results.n_cols; ++i)
     {
       const size_t indexA = oldFromNew[size_t(results(0, i))];
@@ -148,6 +143,49 @@ static void mlpackMain()
 
       unmappedResults(2, i) = results(2, i);
     }
+  }
+
+  arma::mat& dataPoints;
+  const size_t leafSize;
+  arma::mat& unmappedResults;
+};
+
+static void mlpackMain()
+{
+  RequireAtLeastOnePassed({ "output" }, false, "no output will be saved");
+
+  arma::mat dataPoints = std::move(CLI::GetParam<arma::mat>("input"));
+
+  // Do naive computation if necessary.
+  if (CLI::GetParam<bool>("naive"))
+  {
+    Log::Info << "Running naive algorithm." << endl;
+
+    DualTreeBoruvka<> naive(dataPoints, true);
+
+    arma::mat naiveResults;
+    naive.ComputeMST(naiveResults, CLI::HasParam("parallel"));
+
+    if (CLI::HasParam("output"))
+      CLI::GetParam<arma::mat>("output") = std::move(naiveResults);
+  }
+  else
+  {
+    Log::Info << "Building tree.\n";
+
+    // Check that the leaf size is reasonable.
+    RequireParamValue<int>("leaf_size", [](int x) { return x > 0; }, true,
+        "leaf size must be greater than or equal to 1");
+
+    // Initialize the tree and get ready to compute the MST.  Compute the tree
+    // by hand.
+    const size_t leafSize = (size_t) CLI::GetParam<int>("leaf_size");
+
+    // The kd-tree and the metric are specialized for the dimensionality of the
+    // data, if it is a common one.
+    arma::mat unmappedResults;
+    DispatchFixedDimension(dataPoints.n_rows,
+        TreeMST(dataPoints, leafSize, unmappedResults));
 
     if (CLI::HasParam("output"))
       CLI::GetParam<arma::mat>("output") = std::move(unmappedResults);
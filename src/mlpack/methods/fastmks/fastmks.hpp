@@ -17,6 +17,7 @@
 #include <mlpack/core/metrics/ip_metric.hpp>
 #include "fastmks_stat.hpp"
 #include <mlpack/core/tree/cover_tree.hpp>
+#include <mlpack/core/tree/traversal_statistics.hpp>
 #include <queue>
 
 namespace mlpack {
@@ -48,8 +49,16 @@ namespace fastmks /** Fast max-kernel search. */ {
  * on points in the dataset (and not centroids of regions or anything like
  * that).
  *
+ * If OpenMP is available, searches use several threads.  Naive and single-tree
+ * search split the query points between the threads, each with its own rules.
+ * Dual-tree search with a query set splits the query set into one block per
+ * thread, builds a query tree on each block, and traverses each query tree
+ * against the shared reference tree.  The self-kernels sqrt(K(r, r)) of the
+ * reference points are computed once and reused by every search.
+ *
  * @tparam KernelType Type of kernel to run FastMKS with.
- * @tparam MatType Type of data matrix (usually arma::mat).
+ * @tparam MatType Type of data matrix (usually arma::mat; arma::fmat and
+ *     arma::sp_mat are also supported).
  * @tparam TreeType Type of tree to run FastMKS with; it must satisfy the
  *     TreeType policy API.
  */
@@ -298,6 +307,15 @@ class FastMKS
   //! Modify whether or not brute-force (naive) search is used.
   bool& Naive() { return naive; }
 
+  /**
+   * Access the detailed traversal statistics of the last search.  These are
+   * only collected if Statistics().Enabled() is set to true before searching;
+   * when they are, they are also printed to Log::Info after each search.
+   */
+  const tree::TraversalStatistics& Statistics() const { return statistics; }
+  //! Modify the traversal statistics (i.e. to enable their collection).
+  tree::TraversalStatistics& Statistics() { return statistics; }
+
   //! Serialize the model.
   template<typename Archive>
   void serialize(Archive& ar, const unsigned int /* version */);
@@ -321,6 +339,41 @@ class FastMKS
   //! The instantiated inner-product metric induced by the given kernel.
   metric::IPMetric<KernelType> metric;
 
+  //! Detailed statistics of the last search.
+  tree::TraversalStatistics statistics;
+
+  //! Self-kernels sqrt(K(r, r)) of the reference points, or empty if they
+  //! have not been computed since the last call to Train().
+  arma::vec referenceKernels;
+
+  //! Store the statistics of the given rules, whose traversal took the given
+  //! number of seconds, and report them if they are enabled.
+  template<typename RuleType>
+  void RecordStatistics(const RuleType& rules, const double traversalTime);
+
+  //! Store the given totals of a traversal whose statistics have already been
+  //! merged, and report them if they are enabled.
+  void RecordStatistics(const size_t baseCases,
+                        const size_t scores,
+                        const double traversalTime);
+
+  //! Compute sqrt(K(x, x)) for each point x of the given dataset, in parallel.
+  void SelfKernels(const MatType& data, arma::vec& selfKernels);
+
+  //! Get the self-kernels of the reference points, computing them if needed.
+  const arma::vec& ReferenceKernels();
+
+  /**
+   * Run single-tree search for every point of the given query set, with one
+   * rules object per thread, and store the results in the given matrices
+   * (which must already have the right size).
+   */
+  void SingleTreeSearch(const MatType& querySet,
+                        const arma::vec& queryKernels,
+                        const size_t k,
+                        arma::Mat<size_t>& indices,
+                        arma::mat& kernels);
+
   //! Candidate represents a possible candidate point (value, index).
   typedef std::pair<double, size_t> Candidate;
 
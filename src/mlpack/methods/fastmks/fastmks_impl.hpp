@@ -180,7 +180,8 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(const FastMKS& other) :
     setOwner(other.referenceTree == NULL),
     singleMode(other.singleMode),
     naive(other.naive),
-    metric(other.metric)
+    metric(other.metric),
+    referenceKernels(other.referenceKernels)
 {
   // Set reference set correctly.
   if (referenceTree)
@@ -201,7 +202,8 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(FastMKS&& other) :
     setOwner(other.setOwner),
     singleMode(other.singleMode),
     naive(other.naive),
-    metric(std::move(other.metric))
+    metric(std::move(other.metric)),
+    referenceKernels(std::move(other.referenceKernels))
 {
   // Clear information from the other.
   other.referenceSet = NULL;
@@ -248,6 +250,9 @@ FastMKS<KernelType, MatType, TreeType>::operator=(const FastMKS& other)
 
   singleMode = other.singleMode;
   naive = other.naive;
+  referenceKernels = other.referenceKernels;
+
+  return *this;
 }
 
 template<typename KernelType,
@@ -276,6 +281,7 @@ void FastMKS<KernelType, MatType, TreeType>::Train(const MatType& referenceSet)
 
   this->referenceSet = &referenceSet;
   this->setOwner = false;
+  referenceKernels.reset();
 
   if (!naive)
   {
@@ -300,6 +306,7 @@ void FastMKS<KernelType, MatType, TreeType>::Train(const MatType& referenceSet,
   this->referenceSet = &referenceSet;
   this->metric = metric::IPMetric<KernelType>(kernel);
   this->setOwner = false;
+  referenceKernels.reset();
 
   if (!naive)
   {
@@ -320,12 +327,14 @@ void FastMKS<KernelType, MatType, TreeType>::Train(MatType&& referenceSet)
   if (setOwner)
     delete this->referenceSet;
 
+  referenceKernels.reset();
+
   if (!naive)
   {
     if (treeOwner && referenceTree)
       delete referenceTree;
     referenceTree = new Tree(std::move(referenceSet), metric);
-    referenceSet = referenceTree->Dataset();
+    this->referenceSet = &referenceTree->Dataset();
     treeOwner = true;
     setOwner = false;
   }
@@ -348,12 +357,14 @@ void FastMKS<KernelType, MatType, TreeType>::Train(MatType&& referenceSet,
     delete this->referenceSet;
 
   this->metric = metric::IPMetric<KernelType>(kernel);
+  referenceKernels.reset();
 
   if (!naive)
   {
     if (treeOwner && referenceTree)
       delete referenceTree;
     referenceTree = new Tree(std::move(referenceSet), metric);
+    this->referenceSet = &referenceTree->Dataset();
     treeOwner = true;
     setOwner = false;
   }
@@ -381,6 +392,7 @@ void FastMKS<KernelType, MatType, TreeType>::Train(Tree* tree)
   this->referenceSet = &tree->Dataset();
   this->metric = metric::IPMetric<KernelType>(tree->Metric().Kernel());
   this->setOwner = false;
+  referenceKernels.reset();
 
   if (treeOwner && referenceTree)
     delete referenceTree;
@@ -426,8 +438,10 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   // Naive implementation.
   if (naive)
   {
-    // Simple double loop.  Stupid, slow, but a good benchmark.
-    for (size_t q = 0; q < querySet.n_cols; ++q)
+    // Simple double loop.  Stupid, slow, but a good benchmark.  Each query
+    // point is independent, so they are split between the threads.
+    #pragma omp parallel for schedule(dynamic)
+    for (omp_size_t q = 0; q < (omp_size_t) querySet.n_cols; ++q)
     {
       const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
       std::vector<Candidate> cList(k, def);
@@ -462,33 +476,88 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   // Single-tree implementation.
   if (singleMode)
   {
-    // Create rules object (this will store the results).  This constructor
-    // precalculates each self-kernel value.
-    typedef FastMKSRules<KernelType, Tree> RuleType;
-    RuleType rules(*referenceSet, querySet, k, metric.Kernel());
+    arma::vec queryKernels;
+    SelfKernels(querySet, queryKernels);
+    SingleTreeSearch(querySet, queryKernels, k, indices, kernels);
 
-    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
+    Timer::Stop("computing_products");
+    return;
+  }
 
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
+  // Dual-tree implementation.  Each thread gets a block of the query set.  The
+  // blocks should not be so small that their trees can't prune anything.
+  const size_t minBlockSize = 1000;
+  size_t numBlocks = 1;
+  #ifdef HAS_OPENMP
+    numBlocks = omp_get_max_threads();
+  #endif
+  numBlocks = std::max((size_t) 1, std::min(numBlocks,
+      (size_t) querySet.n_cols / minBlockSize));
+
+  if (numBlocks == 1)
+  {
+    // First, we need to build the query tree.  We are assuming it doesn't map
+    // anything...
+    Timer::Stop("computing_products");
+    Timer::Start("tree_building");
+    Tree queryTree(querySet, metric);
+    Timer::Stop("tree_building");
+
+    Search(&queryTree, k, indices, kernels);
+    return;
+  }
 
-    Log::Info << rules.BaseCases() << " base cases." << std::endl;
-    Log::Info << rules.Scores() << " scores." << std::endl;
+  typedef FastMKSRules<KernelType, Tree> RuleType;
+  const arma::vec& refKernels = ReferenceKernels();
+  statistics.Reset();
+  arma::wall_clock traversalTimer;
+  traversalTimer.tic();
+
+  size_t totalBaseCases = 0;
+  size_t totalScores = 0;
+  #pragma omp parallel for schedule(dynamic) \
+      reduction(+:totalBaseCases, totalScores)
+  for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+  {
+    const size_t begin = b * querySet.n_cols / numBlocks;
+    const size_t end = (b + 1) * querySet.n_cols / numBlocks;
+
+    // The query tree owns its block, so the points of the block are
+    // numbered from 0.  The reference tree is only read by the traversal.
+    Tree queryTree(MatType(querySet.cols(begin, end - 1)), metric);
+    arma::vec queryKernels;
+    queryKernels.set_size(end - begin);
+    for (size_t i = 0; i < end - begin; ++i)
+    {
+      queryKernels[i] = sqrt(metric.Kernel().Evaluate(
+          queryTree.Dataset().col(i), queryTree.Dataset().col(i)));
+    }
 
-    rules.GetResults(indices, kernels);
+    RuleType rules(*referenceSet, queryTree.Dataset(), k, metric.Kernel(),
+        refKernels, queryKernels);
+    rules.Statistics().Enabled() = statistics.Enabled();
 
-    Timer::Stop("computing_products");
-    return;
+    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+    traverser.Traverse(queryTree, *referenceTree);
+
+    arma::Mat<size_t> blockIndices;
+    arma::mat blockKernels;
+    rules.GetResults(blockIndices, blockKernels);
+    indices.cols(begin, end - 1) = blockIndices;
+    kernels.cols(begin, end - 1) = blockKernels;
+
+    totalBaseCases += rules.BaseCases();
+    totalScores += rules.Scores();
+
+    #pragma omp critical
+    statistics.Merge(rules.Statistics());
   }
 
-  // Dual-tree implementation.  First, we need to build the query tree.  We are
-  // assuming it doesn't map anything...
-  Timer::Stop("computing_products");
-  Timer::Start("tree_building");
-  Tree queryTree(querySet);
-  Timer::Stop("tree_building");
+  Log::Info << totalBaseCases << " base cases." << std::endl;
+  Log::Info << totalScores << " scores." << std::endl;
+  RecordStatistics(totalBaseCases, totalScores, traversalTimer.toc());
 
-  Search(&queryTree, k, indices, kernels);
+  Timer::Stop("computing_products");
 }
 
 template<typename KernelType,
@@ -531,7 +600,19 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
 
   Timer::Start("computing_products");
   typedef FastMKSRules<KernelType, Tree> RuleType;
-  RuleType rules(*referenceSet, queryTree->Dataset(), k, metric.Kernel());
+  const arma::vec& refKernels = ReferenceKernels();
+  arma::vec queryKernels;
+  if (&queryTree->Dataset() == referenceSet)
+    queryKernels = refKernels;
+  else
+    SelfKernels(queryTree->Dataset(), queryKernels);
+
+  RuleType rules(*referenceSet, queryTree->Dataset(), k, metric.Kernel(),
+      refKernels, queryKernels);
+  statistics.Reset();
+  rules.Statistics().Enabled() = statistics.Enabled();
+  arma::wall_clock traversalTimer;
+  traversalTimer.tic();
 
   typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
 
@@ -539,6 +620,7 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
 
   Log::Info << rules.BaseCases() << " base cases." << std::endl;
   Log::Info << rules.Scores() << " scores." << std::endl;
+  RecordStatistics(rules, traversalTimer.toc());
 
   rules.GetResults(indices, kernels);
 
@@ -563,8 +645,10 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   // Naive implementation.
   if (naive)
   {
-    // Simple double loop.  Stupid, slow, but a good benchmark.
-    for (size_t q = 0; q < referenceSet->n_cols; ++q)
+    // Simple double loop.  Stupid, slow, but a good benchmark.  Each point is
+    // independent, so they are split between the threads.
+    #pragma omp parallel for schedule(dynamic)
+    for (omp_size_t q = 0; q < (omp_size_t) referenceSet->n_cols; ++q)
     {
       const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
       std::vector<Candidate> cList(k, def);
@@ -572,7 +656,7 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
 
       for (size_t r = 0; r < referenceSet->n_cols; ++r)
       {
-        if (q == r)
+        if ((size_t) q == r)
           continue; // Don't return the point as its own candidate.
 
         const double eval = metric.Kernel().Evaluate(referenceSet->col(q),
@@ -602,25 +686,7 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   // Single-tree implementation.
   if (singleMode)
   {
-    // Create rules object (this will store the results).  This constructor
-    // precalculates each self-kernel value.
-    typedef FastMKSRules<KernelType, Tree> RuleType;
-    RuleType rules(*referenceSet, *referenceSet, k, metric.Kernel());
-
-    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
-
-    for (size_t i = 0; i < referenceSet->n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
-
-    // Save the number of pruned nodes.
-    const size_t numPrunes = traverser.NumPrunes();
-
-    Log::Info << "Pruned " << numPrunes << " nodes." << std::endl;
-
-    Log::Info << rules.BaseCases() << " base cases." << std::endl;
-    Log::Info << rules.Scores() << " scores." << std::endl;
-
-    rules.GetResults(indices, kernels);
+    SingleTreeSearch(*referenceSet, ReferenceKernels(), k, indices, kernels);
 
     Timer::Stop("computing_products");
     return;
@@ -632,6 +698,121 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   Search(referenceTree, k, indices, kernels);
 }
 
+template<typename KernelType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename RuleType>
+void FastMKS<KernelType, MatType, TreeType>::RecordStatistics(
+    const RuleType& rules,
+    const double traversalTime)
+{
+  statistics.Merge(rules.Statistics());
+  RecordStatistics(rules.BaseCases(), rules.Scores(), traversalTime);
+}
+
+template<typename KernelType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void FastMKS<KernelType, MatType, TreeType>::RecordStatistics(
+    const size_t baseCases,
+    const size_t scores,
+    const double traversalTime)
+{
+  statistics.BaseCases() = baseCases;
+  statistics.Scores() = scores;
+  statistics.TraversalTime() = traversalTime;
+
+  if (statistics.Enabled())
+    statistics.Report();
+}
+
+template<typename KernelType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void FastMKS<KernelType, MatType, TreeType>::SelfKernels(
+    const MatType& data,
+    arma::vec& selfKernels)
+{
+  selfKernels.set_size(data.n_cols);
+
+  #pragma omp parallel for schedule(static)
+  for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
+    selfKernels[i] = sqrt(metric.Kernel().Evaluate(data.col(i), data.col(i)));
+}
+
+template<typename KernelType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+const arma::vec& FastMKS<KernelType, MatType, TreeType>::ReferenceKernels()
+{
+  if (referenceKernels.n_elem != referenceSet->n_cols)
+    SelfKernels(*referenceSet, referenceKernels);
+
+  return referenceKernels;
+}
+
+template<typename KernelType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void FastMKS<KernelType, MatType, TreeType>::SingleTreeSearch(
+    const MatType& querySet,
+    const arma::vec& queryKernels,
+    const size_t k,
+    arma::Mat<size_t>& indices,
+    arma::mat& kernels)
+{
+  typedef FastMKSRules<KernelType, Tree> RuleType;
+  const arma::vec& refKernels = ReferenceKernels();
+  statistics.Reset();
+  arma::wall_clock traversalTimer;
+  traversalTimer.tic();
+
+  // The search for each query point is independent, so each thread gets its
+  // own rules and writes the results of its query points directly.  The rules
+  // keep their cached kernel values themselves, so the reference tree is only
+  // read.
+  size_t totalBaseCases = 0;
+  size_t totalScores = 0;
+  size_t totalPrunes = 0;
+  #pragma omp parallel reduction(+:totalBaseCases, totalScores, totalPrunes)
+  {
+    RuleType rules(*referenceSet, querySet, k, metric.Kernel(), refKernels,
+        queryKernels);
+    rules.Statistics().Enabled() = statistics.Enabled();
+
+    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
+
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t i = 0; i < (omp_size_t) querySet.n_cols; ++i)
+    {
+      traverser.Traverse(i, *referenceTree);
+      rules.GetResults(i, indices, kernels);
+    }
+
+    totalBaseCases += rules.BaseCases();
+    totalScores += rules.Scores();
+    totalPrunes += traverser.NumPrunes();
+
+    #pragma omp critical
+    statistics.Merge(rules.Statistics());
+  }
+
+  Log::Info << "Pruned " << totalPrunes << " nodes." << std::endl;
+  Log::Info << totalBaseCases << " base cases." << std::endl;
+  Log::Info << totalScores << " scores." << std::endl;
+  RecordStatistics(totalBaseCases, totalScores, traversalTimer.toc());
+}
+
 //! Serialize the model.
 template<typename KernelType,
          typename MatType,
@@ -92,6 +92,10 @@ PARAM_INT_IN("k", "Number of maximum kernels to find.", "k", 0);
 PARAM_FLAG("naive", "If true, O(n^2) naive mode is used for computation.", "N");
 PARAM_FLAG("single", "If true, single-tree search is used (as opposed to "
     "dual-tree search.", "S");
+PARAM_FLAG("traversal_statistics", "If set, detailed statistics of the tree "
+    "traversal (nodes visited and pruned at each level, prunes by reason, "
+    "reference leaf sizes reached, and time per phase) are collected and printed"
+    " when verbose output is enabled.", "");
 
 PARAM_MATRIX_OUT("kernels", "Output matrix of kernels.", "p");
 PARAM_UMATRIX_OUT("indices", "Output matrix of indices.", "i");
@@ -200,6 +204,7 @@ static void mlpackMain()
   // Set search preferences.
   model->Naive() = CLI::HasParam("naive");
   model->SingleMode() = CLI::HasParam("single");
+  model->Statistics().Enabled() = CLI::HasParam("traversal_statistics");
 
   // Should we do search?
   if (CLI::HasParam("k"))
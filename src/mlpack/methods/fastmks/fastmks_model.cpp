@@ -173,6 +173,52 @@ bool& FastMKSModel::Naive()
   throw std::runtime_error("invalid model type");
 }
 
+const tree::TraversalStatistics& FastMKSModel::Statistics() const
+{
+  switch (kernelType)
+  {
+    case LINEAR_KERNEL:
+      return linear->Statistics();
+    case POLYNOMIAL_KERNEL:
+      return polynomial->Statistics();
+    case COSINE_DISTANCE:
+      return cosine->Statistics();
+    case GAUSSIAN_KERNEL:
+      return gaussian->Statistics();
+    case EPANECHNIKOV_KERNEL:
+      return epan->Statistics();
+    case TRIANGULAR_KERNEL:
+      return triangular->Statistics();
+    case HYPTAN_KERNEL:
+      return hyptan->Statistics();
+  }
+
+  throw std::runtime_error("invalid model type");
+}
+
+tree::TraversalStatistics& FastMKSModel::Statistics()
+{
+  switch (kernelType)
+  {
+    case LINEAR_KERNEL:
+      return linear->Statistics();
+    case POLYNOMIAL_KERNEL:
+      return polynomial->Statistics();
+    case COSINE_DISTANCE:
+      return cosine->Statistics();
+    case GAUSSIAN_KERNEL:
+      return gaussian->Statistics();
+    case EPANECHNIKOV_KERNEL:
+      return epan->Statistics();
+    case TRIANGULAR_KERNEL:
+      return triangular->Statistics();
+    case HYPTAN_KERNEL:
+      return hyptan->Statistics();
+  }
+
+  throw std::runtime_error("invalid model type");
+}
+
 bool FastMKSModel::SingleMode() const
 {
   switch (kernelType)
@@ -86,6 +86,11 @@ class FastMKSModel
   //! Set whether or not single-tree search is used.
   bool& SingleMode();
 
+  //! Get the traversal statistics of the last search.
+  const tree::TraversalStatistics& Statistics() const;
+  //! Modify the traversal statistics (i.e. to enable their collection).
+  tree::TraversalStatistics& Statistics();
+
   //! Get the kernel type.
   int KernelType() const { return kernelType; }
   //! Modify the kernel type.
@@ -16,7 +16,9 @@
 #include <mlpack/core/kernels/kernel_traits.hpp>
 #include <mlpack/core/tree/cover_tree/cover_tree.hpp>
 #include <mlpack/core/tree/traversal_info.hpp>
+#include <mlpack/core/tree/traversal_statistics.hpp>
 #include <boost/heap/priority_queue.hpp>
+#include <unordered_map>
 
 namespace mlpack {
 namespace fastmks {
@@ -48,6 +50,25 @@ class FastMKSRules
                const size_t k,
                KernelType& kernel);
 
+  /**
+   * Construct the FastMKSRules object with precomputed self-kernels, so that
+   * several rules objects (i.e. one per thread) can share them.  The
+   * self-kernels must outlive the rules object.
+   *
+   * @param referenceSet Set of reference data.
+   * @param querySet Set of query data.
+   * @param k Number of candidates to search for.
+   * @param kernel Kernel to run FastMKS with.
+   * @param referenceKernels sqrt(K(r, r)) for each reference point r.
+   * @param queryKernels sqrt(K(q, q)) for each query point q.
+   */
+  FastMKSRules(const typename TreeType::Mat& referenceSet,
+               const typename TreeType::Mat& querySet,
+               const size_t k,
+               KernelType& kernel,
+               const arma::vec& referenceKernels,
+               const arma::vec& queryKernels);
+
   /**
    * Store the list of candidates for each query point in the given matrices.
    *
@@ -56,6 +77,21 @@ class FastMKSRules
    */
   void GetResults(arma::Mat<size_t>& indices, arma::mat& products);
 
+  /**
+   * Store the list of candidates for a single query point in the given column
+   * of the given matrices, which must already have the right size.  Different
+   * rules objects can write the results of different query points into the
+   * same matrices at the same time.  The list of candidates for that query
+   * point is emptied.
+   *
+   * @param queryIndex Index of query point to store the results of.
+   * @param indices Matrix storing lists of candidate for each query point.
+   * @param products Matrix storing kernel value for each candidate.
+   */
+  void GetResults(const size_t queryIndex,
+                  arma::Mat<size_t>& indices,
+                  arma::mat& products);
+
   //! Compute the base case (kernel value) between two points.
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
@@ -124,6 +160,11 @@ class FastMKSRules
   const TraversalInfoType& TraversalInfo() const { return traversalInfo; }
   TraversalInfoType& TraversalInfo() { return traversalInfo; }
 
+  //! Get the detailed traversal statistics.
+  const tree::TraversalStatistics& Statistics() const { return statistics; }
+  //! Modify the detailed traversal statistics.
+  tree::TraversalStatistics& Statistics() { return statistics; }
+
  private:
   //! The reference dataset.
   const typename TreeType::Mat& referenceSet;
@@ -154,10 +195,14 @@ class FastMKSRules
   //! Number of points to search for.
   const size_t k;
 
+  //! Query set self-kernels, if they were computed by this object.
+  arma::vec ownedQueryKernels;
+  //! Reference set self-kernels, if they were computed by this object.
+  arma::vec ownedReferenceKernels;
   //! Cached query set self-kernels (|| q || for each q).
-  arma::vec queryKernels;
+  const arma::vec& queryKernels;
   //! Cached reference set self-kernels (|| r || for each r).
-  arma::vec referenceKernels;
+  const arma::vec& referenceKernels;
 
   //! The instantiated kernel.
   KernelType& kernel;
@@ -169,6 +214,13 @@ class FastMKSRules
   //! The last kernel evaluation resulting from BaseCase().
   double lastKernel;
 
+  //! The query index of the kernel values in lastNodeKernels.
+  size_t lastNodeKernelsQuery;
+  //! For single-tree search, the kernel value between the current query point
+  //! and the centroid of each scored reference node.  This is held here and
+  //! not in the reference tree, so that threads can share the tree.
+  std::unordered_map<const TreeType*, double> lastNodeKernels;
+
   //! Calculate the bound for a given query node.
   double CalculateBound(TreeType& queryNode) const;
 
@@ -189,6 +241,9 @@ class FastMKSRules
   size_t scores;
 
   TraversalInfoType traversalInfo;
+
+  //! Detailed traversal statistics; these are modified by Rescore() too.
+  mutable tree::TraversalStatistics statistics;
 };
 
 } // namespace fastmks
@@ -27,23 +27,26 @@ FastMKSRules<KernelType, TreeType>::FastMKSRules(
     referenceSet(referenceSet),
     querySet(querySet),
     k(k),
+    queryKernels(ownedQueryKernels),
+    referenceKernels(ownedReferenceKernels),
     kernel(kernel),
     lastQueryIndex(-1),
     lastReferenceIndex(-1),
     lastKernel(0.0),
+    lastNodeKernelsQuery(-1),
     baseCases(0),
     scores(0)
 {
   // Precompute each self-kernel.
-  queryKernels.set_size(querySet.n_cols);
+  ownedQueryKernels.set_size(querySet.n_cols);
   for (size_t i = 0; i < querySet.n_cols; ++i)
-    queryKernels[i] = sqrt(kernel.Evaluate(querySet.col(i),
-                                           querySet.col(i)));
+    ownedQueryKernels[i] = sqrt(kernel.Evaluate(querySet.col(i),
+                                                querySet.col(i)));
 
-  referenceKernels.set_size(referenceSet.n_cols);
+  ownedReferenceKernels.set_size(referenceSet.n_cols);
   for (size_t i = 0; i < referenceSet.n_cols; ++i)
-    referenceKernels[i] = sqrt(kernel.Evaluate(referenceSet.col(i),
-                                               referenceSet.col(i)));
+    ownedReferenceKernels[i] = sqrt(kernel.Evaluate(referenceSet.col(i),
+                                                    referenceSet.col(i)));
 
   // Set to invalid memory, so that the first node combination does not try to
   // dereference null pointers.
@@ -64,6 +67,44 @@ FastMKSRules<KernelType, TreeType>::FastMKSRules(
   candidates.swap(tmp);
 }
 
+template<typename KernelType, typename TreeType>
+FastMKSRules<KernelType, TreeType>::FastMKSRules(
+    const typename TreeType::Mat& referenceSet,
+    const typename TreeType::Mat& querySet,
+    const size_t k,
+    KernelType& kernel,
+    const arma::vec& referenceKernels,
+    const arma::vec& queryKernels) :
+    referenceSet(referenceSet),
+    querySet(querySet),
+    k(k),
+    queryKernels(queryKernels),
+    referenceKernels(referenceKernels),
+    kernel(kernel),
+    lastQueryIndex(-1),
+    lastReferenceIndex(-1),
+    lastKernel(0.0),
+    lastNodeKernelsQuery(-1),
+    baseCases(0),
+    scores(0)
+{
+  // Set to invalid memory, so that the first node combination does not try to
+  // dereference null pointers.
+  traversalInfo.LastQueryNode() = (TreeType*) this;
+  traversalInfo.LastReferenceNode() = (TreeType*) this;
+
+  // Build the list of k candidates (-DBL_MAX, size_t() - 1) for each query
+  // point.
+  const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
+
+  CandidateList pqueue;
+  pqueue.reserve(k);
+  for (size_t i = 0; i < k; i++)
+    pqueue.push(def);
+  std::vector<CandidateList> tmp(querySet.n_cols, pqueue);
+  candidates.swap(tmp);
+}
+
 template<typename KernelType, typename TreeType>
 void FastMKSRules<KernelType, TreeType>::GetResults(
     arma::Mat<size_t>& indices,
@@ -73,14 +114,21 @@ void FastMKSRules<KernelType, TreeType>::GetResults(
   products.set_size(k, querySet.n_cols);
 
   for (size_t i = 0; i < querySet.n_cols; i++)
+    GetResults(i, indices, products);
+}
+
+template<typename KernelType, typename TreeType>
+void FastMKSRules<KernelType, TreeType>::GetResults(
+    const size_t queryIndex,
+    arma::Mat<size_t>& indices,
+    arma::mat& products)
+{
+  CandidateList& pqueue = candidates[queryIndex];
+  for (size_t j = 1; j <= k; j++)
   {
-    CandidateList& pqueue = candidates[i];
-    for (size_t j = 1; j <= k; j++)
-    {
-      indices(k - j, i) = pqueue.top().second;
-      products(k - j, i) = pqueue.top().first;
-      pqueue.pop();
-    }
+    indices(k - j, queryIndex) = pqueue.top().second;
+    products(k - j, queryIndex) = pqueue.top().first;
+    pqueue.pop();
   }
 }
 
@@ -131,14 +179,28 @@ double FastMKSRules<KernelType, TreeType>::Score(const size_t queryIndex,
   // Compare with the current best.
   const double bestKernel = candidates[queryIndex].top().first;
 
-  // See if we can perform a parent-child prune.
+  // The kernel values of the scored reference nodes are only valid for one
+  // query point.
+  if (queryIndex != lastNodeKernelsQuery)
+  {
+    lastNodeKernels.clear();
+    lastNodeKernelsQuery = queryIndex;
+  }
+
+  // See if we can perform a parent-child prune.  The parent has always been
+  // scored before its children for the same query point.
   const double furthestDist = referenceNode.FurthestDescendantDistance();
+  typename std::unordered_map<const TreeType*, double>::const_iterator
+      parentKernel = lastNodeKernels.end();
   if (referenceNode.Parent() != NULL)
+    parentKernel = lastNodeKernels.find(referenceNode.Parent());
+
+  if (parentKernel != lastNodeKernels.end())
   {
     double maxKernelBound;
     const double parentDist = referenceNode.ParentDistance();
     const double combinedDistBound = parentDist + furthestDist;
-    const double lastKernel = referenceNode.Parent()->Stat().LastKernel();
+    const double lastKernel = parentKernel->second;
     if (kernel::KernelTraits<KernelType>::IsNormalized)
     {
       const double squaredDist = std::pow(combinedDistBound, 2.0);
@@ -161,7 +223,7 @@ double FastMKSRules<KernelType, TreeType>::Score(const size_t queryIndex,
     }
 
     if (maxKernelBound < bestKernel)
-      return DBL_MAX;
+      return statistics.Score(referenceNode, DBL_MAX);
   }
 
   // Calculate the maximum possible kernel value, either by calculating the
@@ -172,10 +234,10 @@ double FastMKSRules<KernelType, TreeType>::Score(const size_t queryIndex,
   {
     // Could it be that this kernel evaluation has already been calculated?
     if (tree::TreeTraits<TreeType>::HasSelfChildren &&
-        referenceNode.Parent() != NULL &&
+        parentKernel != lastNodeKernels.end() &&
         referenceNode.Point(0) == referenceNode.Parent()->Point(0))
     {
-      kernelEval = referenceNode.Parent()->Stat().LastKernel();
+      kernelEval = parentKernel->second;
     }
     else
     {
@@ -187,10 +249,13 @@ double FastMKSRules<KernelType, TreeType>::Score(const size_t queryIndex,
     arma::vec refCenter;
     referenceNode.Center(refCenter);
 
-    kernelEval = kernel.Evaluate(querySet.col(queryIndex), refCenter);
+    // The center is always held in double precision.
+    typedef typename TreeType::ElemType ElemType;
+    kernelEval = kernel.Evaluate(querySet.col(queryIndex),
+        arma::conv_to<arma::Col<ElemType>>::from(refCenter));
   }
 
-  referenceNode.Stat().LastKernel() = kernelEval;
+  lastNodeKernels[&referenceNode] = kernelEval;
 
   double maxKernel;
   if (kernel::KernelTraits<KernelType>::IsNormalized)
@@ -215,7 +280,8 @@ double FastMKSRules<KernelType, TreeType>::Score(const size_t queryIndex,
 
   // We return the inverse of the maximum kernel so that larger kernels are
   // recursed into first.
-  return (maxKernel >= bestKernel) ? (1.0 / maxKernel) : DBL_MAX;
+  return statistics.Score(referenceNode,
+      (maxKernel >= bestKernel) ? (1.0 / maxKernel) : DBL_MAX);
 }
 
 template<typename KernelType, typename TreeType>
@@ -316,7 +382,7 @@ double FastMKSRules<KernelType, TreeType>::Score(TreeType& queryNode,
     // It is not possible that this node combination can contain a point
     // combination with kernel value better than the minimum kernel value to
     // improve any of the results, so we can prune it.
-    return DBL_MAX;
+    return statistics.Score(referenceNode, DBL_MAX);
   }
 
   // We were unable to perform a parent-child or parent-parent prune, so now we
@@ -404,7 +470,8 @@ double FastMKSRules<KernelType, TreeType>::Score(TreeType& queryNode,
 
   // We return the inverse of the maximum kernel so that larger kernels are
   // recursed into first.
-  return (maxKernel >= bestKernel) ? (1.0 / maxKernel) : DBL_MAX;
+  return statistics.Score(referenceNode,
+      (maxKernel >= bestKernel) ? (1.0 / maxKernel) : DBL_MAX);
 }
 
 template<typename KernelType, typename TreeType>
@@ -414,7 +481,8 @@ double FastMKSRules<KernelType, TreeType>::Rescore(const size_t queryIndex,
 {
   const double bestKernel = candidates[queryIndex].top().first;
 
-  return ((1.0 / oldScore) >= bestKernel) ? oldScore : DBL_MAX;
+  return statistics.Rescore(oldScore,
+      ((1.0 / oldScore) >= bestKernel) ? oldScore : DBL_MAX);
 }
 
 template<typename KernelType, typename TreeType>
@@ -425,7 +493,8 @@ double FastMKSRules<KernelType, TreeType>::Rescore(TreeType& queryNode,
   queryNode.Stat().Bound() = CalculateBound(queryNode);
   const double bestKernel = queryNode.Stat().Bound();
 
-  return ((1.0 / oldScore) >= bestKernel) ? oldScore : DBL_MAX;
+  return statistics.Rescore(oldScore,
+      ((1.0 / oldScore) >= bestKernel) ? oldScore : DBL_MAX);
 }
 
 /**
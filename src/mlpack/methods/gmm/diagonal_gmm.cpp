@@ -28,7 +28,8 @@ DiagonalGMM::DiagonalGMM(const size_t gaussians, const size_t dimensionality) :
     dimensionality(dimensionality),
     dists(gaussians,
     distribution::DiagonalGaussianDistribution(dimensionality)),
-    weights(gaussians)
+    weights(gaussians),
+    batches(0)
 {
   // Set equal weights. Technically this model is still valid, but only barely.
   weights.fill(1.0 / gaussians);
@@ -39,7 +40,8 @@ DiagonalGMM::DiagonalGMM(const DiagonalGMM& other) :
     gaussians(other.Gaussians()),
     dimensionality(other.dimensionality),
     dists(other.dists),
-    weights(other.weights) { /* Nothing to do. */ }
+    weights(other.weights),
+    batches(other.batches) { /* Nothing to do. */ }
 
 DiagonalGMM& DiagonalGMM::operator=(const DiagonalGMM& other)
 {
@@ -47,6 +49,7 @@ DiagonalGMM& DiagonalGMM::operator=(const DiagonalGMM& other)
   dimensionality = other.dimensionality;
   dists = other.dists;
   weights = other.weights;
+  batches = other.batches;
 
   return *this;
 }
@@ -15,10 +15,13 @@
 #define MLPACK_METHODS_GMM_DIAGONAL_GMM_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <exception>
 #include <mlpack/core/dists/diagonal_gaussian_distribution.hpp>
 
 // This is the default fitting method class.
 #include "em_fit.hpp"
+// This is the default incremental update method class.
+#include "stepwise_em.hpp"
 
 // This is the default covariance matrix constraint.
 #include "diagonal_constraint.hpp"
@@ -85,13 +88,17 @@ class DiagonalGMM
   //! Vector of a priori weights for each Gaussian.
   arma::vec weights;
 
+  //! The number of batches the model has been fit to, by Train() or Update().
+  size_t batches;
+
  public:
   /**
    * Create an empty Diagonal Gaussian Mixture Model, with zero gaussians.
    */
   DiagonalGMM() :
       gaussians(0),
-      dimensionality(0)
+      dimensionality(0),
+      batches(0)
   {
     // Warn the user.  They probably don't want to do this.  If this
     // constructor is being used (because it is required by some template
@@ -120,7 +127,8 @@ class DiagonalGMM
       gaussians(dists.size()),
       dimensionality((!dists.empty()) ? dists[0].Mean().n_elem : 0),
       dists(dists),
-      weights(weights) { /* Nothing to do. */ }
+      weights(weights),
+      batches(1) { /* Nothing to do. */ }
 
   //! Copy constructor for DiagonalGMMs.
   DiagonalGMM(const DiagonalGMM& other);
@@ -158,6 +166,11 @@ class DiagonalGMM
   //! Return a reference to the a priori weights of each Gaussian.
   arma::vec& Weights() { return weights; }
 
+  //! Return the number of batches the model has been fit to.
+  size_t Batches() const { return batches; }
+  //! Modify the number of batches the model has been fit to.
+  size_t& Batches() { return batches; }
+
   /**
    * Return the probability that the given observation came from this
    * distribution.
@@ -193,6 +206,30 @@ class DiagonalGMM
    */
   double LogProbability(const arma::vec& observation,
                         const size_t component) const;
+
+  /**
+   * Compute the log probability of each of the given observations coming from
+   * this distribution.  Unlike calling LogProbability() on each column, the
+   * log probabilities of all components are computed with two matrix
+   * multiplications, so this is the fast way to score many points; the matrix
+   * and the output may be single-precision (arma::fmat and arma::fvec) to
+   * halve the memory traffic.  The per-component terms take O(gaussians *
+   * dimensionality) time to prepare each call, so batches should not be too
+   * small.
+   *
+   * The observations are centered on the weighted mean of the components
+   * before expanding the squared distances, which keeps the cancellation of
+   * the expansion small unless the components are very far apart relative to
+   * their variances.
+   *
+   * @tparam eT Element type of the observations (double or float).
+   * @param observations Observations to evaluate the probability of.
+   * @param logProbabilities Output log probabilities, one per observation.
+   */
+  template<typename eT>
+  void LogProbability(const arma::Mat<eT>& observations,
+                      arma::Col<eT>& logProbabilities) const;
+
   /**
    * Return a randomly generated observation according to the probability
    * distribution defined by this object.
@@ -263,6 +300,33 @@ class DiagonalGMM
                const bool useExistingModel = false,
                FittingType fitter = FittingType());
 
+  /**
+   * Update the model with a batch of observations, using the given algorithm
+   * in the UpdaterType class, so that the model can be trained on a stream of
+   * batches instead of the whole dataset at once.  With the default
+   * StepwiseEM<> updater, the model is moved towards the maximum likelihood
+   * estimate of the batch by a step that shrinks with the number of batches
+   * already seen (see Batches(); training with Train() counts as one batch).
+   * If the model hasn't been fit to anything yet, it is fit to the first batch
+   * with the EM algorithm.
+   *
+   * The UpdaterType class must provide the following function:
+   *
+   * @code
+   * double Update(const arma::mat& batch,
+   *               std::vector<DiagonalGaussianDistribution>& dists,
+   *               arma::vec& weights,
+   *               const size_t batches);
+   * @endcode
+   *
+   * @param batch Batch of observations.
+   * @param updater Updater to use.
+   * @return The log-likelihood of the batch under the model before the update.
+   */
+  template<typename UpdaterType = StepwiseEM<kmeans::KMeans<>,
+      DiagonalConstraint, distribution::DiagonalGaussianDistribution>>
+  double Update(const arma::mat& batch, UpdaterType updater = UpdaterType());
+
   /**
    * Classify the given observations as being from an individual component in
    * this DiagonalGMM. The resultant classifications are stored in the 'labels'
@@ -287,9 +351,34 @@ class DiagonalGMM
    * Serialize the DiagonalGMM.
    */
   template<typename Archive>
-  void serialize(Archive& ar, const unsigned int /* version */);
+  void serialize(Archive& ar, const unsigned int version);
 
  private:
+  /**
+   * Run the given number of trials of Train() one after another, keeping the
+   * model with the greatest log-likelihood.
+   */
+  template<typename FittingType>
+  double TrainTrials(const arma::mat& observations,
+                     const size_t trials,
+                     const bool useExistingModel,
+                     FittingType& fitter);
+
+  /**
+   * Run the given number of trials of Train() in parallel, keeping the model
+   * with the greatest log-likelihood.  This is used for EMFit, which can draw
+   * the random initial models of the trials up front, so that the model is the
+   * same as with the trials run one after another.  If
+   * EMFit::AbandonTrials() is true, the trials that can't beat the best
+   * log-likelihood so far are abandoned.
+   */
+  template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+  double TrainTrials(const arma::mat& observations,
+                     const size_t trials,
+                     const bool useExistingModel,
+                     EMFit<InitialClusteringType, CovarianceConstraintPolicy,
+                         distribution::DiagonalGaussianDistribution>& fitter);
+
   /**
    * This function computes the log-likelihood of the given model and is used
    * by DiagonalGMM::Train().
@@ -308,6 +397,9 @@ class DiagonalGMM
 } // namespace gmm
 } // namespace mlpack
 
+//! Set the serialization version of the DiagonalGMM class.
+BOOST_CLASS_VERSION(mlpack::gmm::DiagonalGMM, 1);
+
 // Include implementation.
 #include "diagonal_gmm_impl.hpp"
 
@@ -42,63 +42,191 @@ double DiagonalGMM::Train(const arma::mat& observations,
     if (trials == 0)
       return -DBL_MAX; // It's what they asked for...
 
-    // If each trial must start from the same initial location,
-    // we must save it.
-    std::vector<distribution::DiagonalGaussianDistribution> distsOrig;
-    arma::vec weightsOrig;
+    bestLikelihood = TrainTrials(observations, trials, useExistingModel,
+        fitter);
+  }
+
+  // The model has now been fit to a single batch.
+  batches = 1;
+
+  // Report final log-likelihood and return it.
+  Log::Info << "DiagonalGMM::Train(): log-likelihood of trained GMM is "
+      << bestLikelihood << "." << std::endl;
+  return bestLikelihood;
+}
+
+/**
+ * Run the trials of Train() one after another.
+ */
+template<typename FittingType>
+double DiagonalGMM::TrainTrials(const arma::mat& observations,
+                                const size_t trials,
+                                const bool useExistingModel,
+                                FittingType& fitter)
+{
+  double bestLikelihood;
+
+  // If each trial must start from the same initial location,
+  // we must save it.
+  std::vector<distribution::DiagonalGaussianDistribution> distsOrig;
+  arma::vec weightsOrig;
+  if (useExistingModel)
+  {
+    distsOrig = dists;
+    weightsOrig = weights;
+  }
+
+  // We need to keep temporary copies.  We'll do the first training into the
+  // actual model position, so that if it's the best we don't need to
+  // copy it.
+  fitter.Estimate(observations, dists, weights, useExistingModel);
+  bestLikelihood = LogLikelihood(observations, dists, weights);
+
+  Log::Info << "DiagonalGMM::Train(): Log-likelihood of trial 0 is "
+      << bestLikelihood << "." << std::endl;
+
+  // Now the temporary model.
+  std::vector<distribution::DiagonalGaussianDistribution> distsTrial(
+      gaussians, distribution::DiagonalGaussianDistribution(dimensionality));
+  arma::vec weightsTrial(gaussians);
+
+  for (size_t trial = 1; trial < trials; ++trial)
+  {
     if (useExistingModel)
     {
-      distsOrig = dists;
-      weightsOrig = weights;
+      distsTrial = distsOrig;
+      weightsTrial = weightsOrig;
     }
 
-    // We need to keep temporary copies.  We'll do the first training into the
-    // actual model position, so that if it's the best we don't need to
-    // copy it.
-    fitter.Estimate(observations, dists, weights, useExistingModel);
-    bestLikelihood = LogLikelihood(observations, dists, weights);
+    fitter.Estimate(observations, distsTrial, weightsTrial,
+        useExistingModel);
 
-    Log::Info << "DiagonalGMM::Train(): Log-likelihood of trial 0 is "
-        << bestLikelihood << "." << std::endl;
+    // Check to see if the log-likelihood of this one is better.
+    double newLikelihood = LogLikelihood(observations, distsTrial,
+        weightsTrial);
 
-    // Now the temporary model.
-    std::vector<distribution::DiagonalGaussianDistribution> distsTrial(
-        gaussians, distribution::DiagonalGaussianDistribution(dimensionality));
-    arma::vec weightsTrial(gaussians);
+    Log::Info << "DiagonalGMM::Train(): Log-likelihood of trial " << trial
+        << " is " << newLikelihood << "." << std::endl;
 
-    for (size_t trial = 1; trial < trials; ++trial)
+    if (newLikelihood > bestLikelihood)
     {
-      if (useExistingModel)
-      {
-        distsTrial = distsOrig;
-        weightsTrial = weightsOrig;
-      }
+      // Save new likelihood and copy new model.
+      bestLikelihood = newLikelihood;
 
-      fitter.Estimate(observations, distsTrial, weightsTrial,
-          useExistingModel);
+      dists = distsTrial;
+      weights = weightsTrial;
+    }
+  }
 
-      // Check to see if the log-likelihood of this one is better.
-      double newLikelihood = LogLikelihood(observations, distsTrial,
-          weightsTrial);
+  return bestLikelihood;
+}
 
-      Log::Info << "DiagonalGMM::Train(): Log-likelihood of trial " << trial
-          << " is " << newLikelihood << "." << std::endl;
+/**
+ * Run the trials of Train() with EMFit in parallel.
+ */
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+double DiagonalGMM::TrainTrials(
+    const arma::mat& observations,
+    const size_t trials,
+    const bool useExistingModel,
+    EMFit<InitialClusteringType, CovarianceConstraintPolicy,
+        distribution::DiagonalGaussianDistribution>& fitter)
+{
+  // Draw the initial models of all trials first, in order.  The initial
+  // clustering is the only part of a trial that uses random numbers, so the
+  // trials give the same models as when they are run one after another, no
+  // matter how many threads run them.  This is also done with the default
+  // k-means: otherwise Armadillo would do its own deterministic
+  // initialization (see EMFit::ArmadilloGMMWrapper()), and every trial would
+  // give the same model.
+  const bool drawInitialModels = !useExistingModel;
+  std::vector<std::vector<distribution::DiagonalGaussianDistribution>>
+      trialDists(trials, dists);
+  std::vector<arma::vec> trialWeights(trials, weights);
+  if (drawInitialModels)
+  {
+    for (size_t trial = 0; trial < trials; ++trial)
+    {
+      fitter.InitialClustering(observations, trialDists[trial],
+          trialWeights[trial]);
+    }
+  }
 
-      if (newLikelihood > bestLikelihood)
-      {
-        // Save new likelihood and copy new model.
-        bestLikelihood = newLikelihood;
+  // If the fitter may abandon trials, the best log-likelihood so far is shared
+  // between the trials, so that the trials that can't reach it are abandoned.
+  // Otherwise every trial runs to the end against a bound that can't be
+  // missed, and the model is the same as when the trials run one after
+  // another.
+  std::atomic<double> bestLikelihood(-DBL_MAX);
+  const std::atomic<double> noBound(-DBL_MAX);
+  const std::atomic<double>& bound = fitter.AbandonTrials() ? bestLikelihood :
+      noBound;
+  arma::vec likelihoods(trials);
+  likelihoods.fill(-DBL_MAX);
+  std::vector<char> finished(trials, 0);
+  std::exception_ptr error;
+
+  #pragma omp parallel
+  {
+    EMFit<InitialClusteringType, CovarianceConstraintPolicy,
+        distribution::DiagonalGaussianDistribution> threadFitter(fitter);
 
-        dists = distsTrial;
-        weights = weightsTrial;
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t trial = 0; trial < (omp_size_t) trials; ++trial)
+    {
+      // Exceptions can't leave the parallel region, so the first one is kept
+      // and thrown afterwards.
+      try
+      {
+        if (!threadFitter.Estimate(observations, trialDists[trial],
+            trialWeights[trial], useExistingModel || drawInitialModels,
+            bound))
+          continue;
+
+        finished[trial] = 1;
+        likelihoods[trial] = LogLikelihood(observations, trialDists[trial],
+            trialWeights[trial]);
+
+        double best = bestLikelihood.load();
+        while (likelihoods[trial] > best &&
+            !bestLikelihood.compare_exchange_weak(best, likelihoods[trial]))
+        { /* best now holds the current value; try again. */ }
+      }
+      catch (...)
+      {
+        #pragma omp critical
+        {
+          if (!error)
+            error = std::current_exception();
+        }
       }
     }
   }
 
-  // Report final log-likelihood and return it.
-  Log::Info << "DiagonalGMM::Train(): log-likelihood of trained GMM is "
-      << bestLikelihood << "." << std::endl;
-  return bestLikelihood;
+  if (error)
+    std::rethrow_exception(error);
+
+  for (size_t trial = 0; trial < trials; ++trial)
+  {
+    if (finished[trial])
+    {
+      Log::Info << "DiagonalGMM::Train(): Log-likelihood of trial " << trial
+          << " is " << likelihoods[trial] << "." << std::endl;
+    }
+    else
+    {
+      Log::Info << "DiagonalGMM::Train(): trial " << trial << " abandoned "
+          << "because it could not reach the best log-likelihood." << std::endl;
+    }
+  }
+
+  // Ties go to the earliest trial, like when the trials run in order.
+  arma::uword bestTrial;
+  likelihoods.max(bestTrial);
+  dists = std::move(trialDists[bestTrial]);
+  weights = std::move(trialWeights[bestTrial]);
+
+  return likelihoods[bestTrial];
 }
 
 /**
@@ -183,20 +311,96 @@ double DiagonalGMM::Train(const arma::mat& observations,
     }
   }
 
+  // The model has now been fit to a single batch.
+  batches = 1;
+
   // Report final log-likelihood and return it.
   Log::Info << "DiagonalGMM::Train(): log-likelihood of trained GMM is "
       << bestLikelihood << "." << std::endl;
   return bestLikelihood;
 }
 
+/**
+ * Update the model with a batch of observations.
+ */
+template<typename UpdaterType>
+double DiagonalGMM::Update(const arma::mat& batch, UpdaterType updater)
+{
+  const double likelihood = updater.Update(batch, dists, weights, batches);
+  ++batches;
+
+  Log::Info << "DiagonalGMM::Update(): log-likelihood of batch " << batches
+      << " is " << likelihood << "." << std::endl;
+  return likelihood;
+}
+
+//! Compute the log probabilities of the given observations.
+template<typename eT>
+void DiagonalGMM::LogProbability(const arma::Mat<eT>& observations,
+                                 arma::Col<eT>& logProbabilities) const
+{
+  const double log2pi = 1.83787706640934533908193770912475883;
+
+  // Center the points on the mixture to reduce the cancellation in the
+  // expansion of the squared distances below.
+  arma::vec center = arma::zeros<arma::vec>(dimensionality);
+  for (size_t i = 0; i < gaussians; ++i)
+    center += weights[i] * dists[i].Mean();
+
+  // For a component with mean m and inverse variances v, the log probability
+  // of x is c - 0.5 * (v' (x % x)) + (m % v)' x, where c holds the log weight,
+  // the normalizer, and -0.5 * (m % m)' v.  The terms are prepared in double
+  // precision and only then converted.
+  arma::Mat<eT> inverseVariances(gaussians, dimensionality);
+  arma::Mat<eT> scaledMeans(gaussians, dimensionality);
+  arma::vec constants(gaussians);
+  for (size_t i = 0; i < gaussians; ++i)
+  {
+    const arma::vec invCov = 1.0 / dists[i].Covariance();
+    const arma::vec mean = dists[i].Mean() - center;
+
+    inverseVariances.row(i) = arma::conv_to<arma::Row<eT>>::from(
+        trans(invCov));
+    scaledMeans.row(i) = arma::conv_to<arma::Row<eT>>::from(
+        trans(mean % invCov));
+    constants[i] = std::log(weights[i]) - 0.5 * (dimensionality * log2pi +
+        arma::accu(arma::log(dists[i].Covariance())) +
+        arma::dot(mean % mean, invCov));
+  }
+
+  const arma::Mat<eT> centered = observations.each_col() -
+      arma::conv_to<arma::Col<eT>>::from(center);
+
+  // One row per component, one column per observation.
+  arma::Mat<eT> logProbs = scaledMeans * centered -
+      eT(0.5) * inverseVariances * arma::square(centered);
+  logProbs.each_col() += arma::conv_to<arma::Col<eT>>::from(constants);
+
+  // Sum the probabilities of the components with the log-sum-exp trick.  A
+  // point with zero probability under every component has maximum -inf;
+  // shifting by zero instead gives -inf instead of NaN.
+  arma::Row<eT> maxima = arma::max(logProbs, 0);
+  maxima.elem(arma::find(maxima ==
+      -std::numeric_limits<eT>::infinity())).zeros();
+
+  logProbabilities = trans(maxima +
+      arma::log(arma::sum(arma::exp(logProbs.each_row() - maxima), 0)));
+}
+
 //! Serialize the object.
 template<typename Archive>
-void DiagonalGMM::serialize(Archive& ar, const unsigned int /* version */)
+void DiagonalGMM::serialize(Archive& ar, const unsigned int version)
 {
   ar & BOOST_SERIALIZATION_NVP(gaussians);
   ar & BOOST_SERIALIZATION_NVP(dimensionality);
   ar & BOOST_SERIALIZATION_NVP(dists);
   ar & BOOST_SERIALIZATION_NVP(weights);
+
+  // Older models don't store the number of batches; they have been trained.
+  if (version > 0)
+    ar & BOOST_SERIALIZATION_NVP(batches);
+  else if (Archive::is_loading::value)
+    batches = (gaussians > 0) ? 1 : 0;
 }
 
 } // namespace gmm
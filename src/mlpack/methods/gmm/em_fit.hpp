@@ -15,6 +15,7 @@
 #define MLPACK_METHODS_GMM_EM_FIT_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <atomic>
 #include <mlpack/core/dists/gaussian_distribution.hpp>
 #include <mlpack/core/dists/diagonal_gaussian_distribution.hpp>
 
@@ -109,6 +110,69 @@ class EMFit
                 arma::vec& weights,
                 const bool useInitialModel = false);
 
+  /**
+   * Fit the observations to a Gaussian mixture model (GMM) like the first
+   * overload of Estimate(), but give up on fits that will not reach the given
+   * log-likelihood.  The bound may be raised by other threads while the fit is
+   * running; this is how GMM::Train() shares the best log-likelihood between
+   * trials that run in parallel, if AbandonTrials() is true.  The log-likelihood that the fit converges to
+   * is extrapolated from the last three iterations (EM converges linearly, so
+   * the gains shrink geometrically), and the fit is abandoned if that limit is
+   * below the bound.  Iterations are not logged, so that this can be called in
+   * parallel.
+   *
+   * If the distribution is DiagonalGaussianDistribution, the fit is done by
+   * Armadillo and is never abandoned.
+   *
+   * @param observations List of observations to train on.
+   * @param dists Distributions of the model.
+   * @param weights Vector to store a priori weights in.
+   * @param useInitialModel If true, the given model is used for the initial
+   *      clustering.
+   * @param bound Log-likelihood that the fit must be able to reach.
+   * @return false if the fit was abandoned.
+   */
+  bool Estimate(const arma::mat& observations,
+                std::vector<Distribution>& dists,
+                arma::vec& weights,
+                const bool useInitialModel,
+                const std::atomic<double>& bound);
+
+  /**
+   * Run the clusterer, and then turn the cluster assignments into Gaussians.
+   * This is how Estimate() finds the initial model when useInitialModel is
+   * false, and it is the only part of the fit that uses random numbers, so
+   * GMM::Train() calls it in order for each trial before it runs the trials in
+   * parallel.  The vectors must be already set to the number of clusters.
+   *
+   * @param observations List of observations.
+   * @param dists Vector to store the distributions in.
+   * @param weights Vector to store a priori weights in.
+   */
+  void InitialClustering(
+      const arma::mat& observations,
+      std::vector<Distribution>& dists,
+      arma::vec& weights);
+
+  /**
+   * Calculate the conditional probability of each observation being from each
+   * component of the model (the E-step), and return the log-likelihood of the
+   * model.  The observations are processed in parallel blocks, and each
+   * observation is normalized in log space so that observations far away from
+   * every component don't underflow.
+   *
+   * @param observations List of observations.
+   * @param dists Distributions of the model.
+   * @param weights A priori weights of the model.
+   * @param condProb Matrix to store the conditional probabilities in, with one
+   *     row for each observation and one column for each component.
+   */
+  static double ConditionalProbabilities(
+      const arma::mat& observations,
+      const std::vector<Distribution>& dists,
+      const arma::vec& weights,
+      arma::mat& condProb);
+
   //! Get the clusterer.
   const InitialClusteringType& Clusterer() const { return clusterer; }
   //! Modify the clusterer.
@@ -129,40 +193,48 @@ class EMFit
   //! Modify the tolerance for the convergence of the EM algorithm.
   double& Tolerance() { return tolerance; }
 
+  //! Get whether GMM::Train() may abandon the trials that can't reach the best
+  //! log-likelihood so far.
+  bool AbandonTrials() const { return abandonTrials; }
+  //! Modify whether GMM::Train() may abandon the trials that can't reach the
+  //! best log-likelihood so far (false by default).  This saves time when
+  //! there are many trials, but which trials are abandoned depends on the
+  //! order in which they finish, and the limit of a fit is only estimated, so
+  //! the model may differ from the model of the trials run one at a time.
+  bool& AbandonTrials() { return abandonTrials; }
+
   //! Serialize the fitter.
   template<typename Archive>
   void serialize(Archive& ar, const unsigned int version);
 
  private:
   /**
-   * Run the clusterer, and then turn the cluster assignments into Gaussians.
-   * This is a helper function for both overloads of Estimate().  The vectors
-   * must be already set to the number of clusters.
-   *
-   * @param observations List of observations.
-   * @param means Vector to store means in.
-   * @param covariances Vector to store covariances in.
-   * @param weights Vector to store a priori weights in.
+   * Fit the model; this implements the overloads of Estimate() without
+   * probabilities.  If bound is not NULL, the fit may be abandoned, and then
+   * false is returned.
    */
-  void InitialClustering(
-      const arma::mat& observations,
-      std::vector<Distribution>& dists,
-      arma::vec& weights);
+  bool Fit(const arma::mat& observations,
+           std::vector<Distribution>& dists,
+           arma::vec& weights,
+           const bool useInitialModel,
+           const std::atomic<double>* bound);
 
   /**
-   * Calculate the log-likelihood of a model.  Yes, this is reimplemented in the
-   * GMM code.  Intuition suggests that the log-likelihood is not the best way
-   * to determine if the EM algorithm has converged.
+   * Calculate the new means and covariances of the model from the conditional
+   * probabilities (the M-step).  The components are updated in parallel.
+   * Components with no probability of having points are left unchanged.
    *
-   * @param data Data matrix.
-   * @param means Vector of means.
-   * @param covariances Vector of covariance matrices.
-   * @param weights Vector of a priori weights.
+   * @param observations List of observations.
+   * @param condProb (Possibly weighted) conditional probabilities of each
+   *     observation being from each component.
+   * @param dists Distributions to update.
+   * @param probRowSums Vector to store the sum of the conditional
+   *     probabilities of each component in.
    */
-  double LogLikelihood(
-      const arma::mat& data,
-      const std::vector<Distribution>& dists,
-      const arma::vec& weights) const;
+  void UpdateDistributions(const arma::mat& observations,
+                           const arma::mat& condProb,
+                           std::vector<Distribution>& dists,
+                           arma::vec& probRowSums);
 
   /**
    * Use the Armadillo gmm_diag clusterer to train a GMM with diagonal
@@ -188,6 +260,8 @@ class EMFit
   InitialClusteringType clusterer;
   //! Object which applies constraints to the covariance matrix.
   CovarianceConstraintPolicy constraint;
+  //! Whether GMM::Train() may abandon trials.
+  bool abandonTrials;
 };
 
 } // namespace gmm
@@ -32,7 +32,8 @@ EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::EMFit(
     maxIterations(maxIterations),
     tolerance(tolerance),
     clusterer(clusterer),
-    constraint(constraint)
+    constraint(constraint),
+    abandonTrials(false)
 { /* Nothing to do. */ }
 
 template<typename InitialClusteringType,
@@ -43,6 +44,32 @@ Estimate(const arma::mat& observations,
          std::vector<Distribution>& dists,
          arma::vec& weights,
          const bool useInitialModel)
+{
+  Fit(observations, dists, weights, useInitialModel, NULL);
+}
+
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+bool EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+Estimate(const arma::mat& observations,
+         std::vector<Distribution>& dists,
+         arma::vec& weights,
+         const bool useInitialModel,
+         const std::atomic<double>& bound)
+{
+  return Fit(observations, dists, weights, useInitialModel, &bound);
+}
+
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+bool EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+Fit(const arma::mat& observations,
+    std::vector<Distribution>& dists,
+    arma::vec& weights,
+    const bool useInitialModel,
+    const std::atomic<double>* bound)
 {
   if (std::is_same<Distribution,
       distribution::DiagonalGaussianDistribution>::value)
@@ -53,7 +80,7 @@ Estimate(const arma::mat& observations,
           << std::endl;
     #else
       ArmadilloGMMWrapper(observations, dists, weights, useInitialModel);
-      return;
+      return true;
     #endif
   }
   else if (std::is_same<CovarianceConstraintPolicy, DiagonalConstraint>::value
@@ -70,93 +97,60 @@ Estimate(const arma::mat& observations,
   if (!useInitialModel)
     InitialClustering(observations, dists, weights);
 
-  double l = LogLikelihood(observations, dists, weights);
+  // The conditional probabilities of the current model are computed along
+  // with its log-likelihood.
+  arma::mat condProb;
+  double l = ConditionalProbabilities(observations, dists, weights, condProb);
 
   Log::Debug << "EMFit::Estimate(): initial clustering log-likelihood: "
       << l << std::endl;
 
   double lOld = -DBL_MAX;
-  arma::mat condProb(observations.n_cols, dists.size());
+  double lOlder = -DBL_MAX;
 
   // Iterate to update the model until no more improvement is found.
   size_t iteration = 1;
   while (std::abs(l - lOld) > tolerance && iteration != maxIterations)
   {
-    Log::Info << "EMFit::Estimate(): iteration " << iteration << ", "
-        << "log-likelihood " << l << "." << std::endl;
-
-    // Calculate the conditional probabilities of choosing a particular
-    // Gaussian given the observations and the present theta value.
-    for (size_t i = 0; i < dists.size(); i++)
-    {
-      // Store conditional probabilities into condProb vector for each
-      // Gaussian.  First we make an alias of the condProb vector.
-      arma::vec condProbAlias = condProb.unsafe_col(i);
-      dists[i].Probability(observations, condProbAlias);
-      condProbAlias *= weights[i];
-    }
-
-    // Normalize row-wise.
-    for (size_t i = 0; i < condProb.n_rows; i++)
+    if (!bound)
     {
-      // Avoid dividing by zero; if the probability for everything is 0, we
-      // don't want to make it NaN.
-      const double probSum = accu(condProb.row(i));
-      if (probSum != 0.0)
-        condProb.row(i) /= probSum;
+      Log::Info << "EMFit::Estimate(): iteration " << iteration << ", "
+          << "log-likelihood " << l << "." << std::endl;
     }
 
-    // Store the sum of the probability of each state over all the observations.
-    arma::vec probRowSums = trans(arma::sum(condProb, 0 /* columnwise */));
-
-    // Calculate the new value of the means using the updated conditional
-    // probabilities.
-    for (size_t i = 0; i < dists.size(); i++)
-    {
-      // Don't update if there's no probability of the Gaussian having points.
-      if (probRowSums[i] != 0)
-        dists[i].Mean() = (observations * condProb.col(i)) / probRowSums[i];
-      else
-        continue;
-
-      // Calculate the new value of the covariances using the updated
-      // conditional probabilities and the updated means.
-      arma::mat tmp = observations.each_col() - dists[i].Mean();
-
-      // If the distribution is DiagonalGaussianDistribution, calculate the
-      // covariance only with diagonal components.
-      if (std::is_same<Distribution,
-          distribution::DiagonalGaussianDistribution>::value)
-      {
-        arma::vec covariance = arma::sum((tmp % tmp) %
-            (arma::ones<arma::vec>(observations.n_rows) *
-            trans(condProb.col(i))), 1) / probRowSums[i];
-
-        // Apply covariance constraint.
-        constraint.ApplyConstraint(covariance);
-        dists[i].Covariance(std::move(covariance));
-      }
-      else
-      {
-        arma::mat tmpB = tmp.each_row() % trans(condProb.col(i));
-        arma::mat covariance = (tmp * trans(tmpB)) / probRowSums[i];
-
-        // Apply covariance constraint.
-        constraint.ApplyConstraint(covariance);
-        dists[i].Covariance(std::move(covariance));
-      }
-    }
+    // Calculate the new means and covariances using the conditional
+    // probabilities of the present model.
+    arma::vec probRowSums;
+    UpdateDistributions(observations, condProb, dists, probRowSums);
 
     // Calculate the new values for omega using the updated conditional
     // probabilities.
     weights = probRowSums / observations.n_cols;
 
-    // Update values of l; calculate new log-likelihood.
+    // Update values of l; calculate new log-likelihood and the conditional
+    // probabilities for the next iteration.
+    lOlder = lOld;
     lOld = l;
-    l = LogLikelihood(observations, dists, weights);
+    l = ConditionalProbabilities(observations, dists, weights, condProb);
 
     iteration++;
+
+    // Once the gains shrink, extrapolate them geometrically to estimate the
+    // log-likelihood of convergence, and give up if it can't reach the bound.
+    if (bound && iteration > 3)
+    {
+      const double gain = l - lOld;
+      const double lastGain = lOld - lOlder;
+      if (gain > 0 && gain < lastGain)
+      {
+        const double rate = gain / lastGain;
+        if (l + gain * rate / (1.0 - rate) < bound->load())
+          return false;
+      }
+    }
   }
+
+  return true;
 }
 
 template<typename InitialClusteringType,
@@ -172,98 +166,36 @@ Estimate(const arma::mat& observations,
   if (!useInitialModel)
     InitialClustering(observations, dists, weights);
 
-  double l = LogLikelihood(observations, dists, weights);
+  arma::mat condProb;
+  double l = ConditionalProbabilities(observations, dists, weights, condProb);
 
   Log::Debug << "EMFit::Estimate(): initial clustering log-likelihood: "
       << l << std::endl;
 
   double lOld = -DBL_MAX;
-  arma::mat condProb(observations.n_cols, dists.size());
 
   // Iterate to update the model until no more improvement is found.
   size_t iteration = 1;
   while (std::abs(l - lOld) > tolerance && iteration != maxIterations)
   {
-    // Calculate the conditional probabilities of choosing a particular
-    // Gaussian given the observations and the present theta value.
-    for (size_t i = 0; i < dists.size(); i++)
-    {
-      // Store conditional probabilities into condProb vector for each
-      // Gaussian.  First we make an alias of the condProb vector.
-      arma::vec condProbAlias = condProb.unsafe_col(i);
-      dists[i].Probability(observations, condProbAlias);
-      condProbAlias *= weights[i];
-    }
+    // The conditional probability of each point being from each Gaussian is
+    // multiplied by the probability of the point being from this mixture
+    // model.
+    condProb.each_col() %= probabilities;
 
-    // Normalize row-wise.
-    for (size_t i = 0; i < condProb.n_rows; i++)
-    {
-      // Avoid dividing by zero; if the probability for everything is 0, we
-      // don't want to make it NaN.
-      const double probSum = accu(condProb.row(i));
-      if (probSum != 0.0)
-        condProb.row(i) /= probSum;
-    }
-
-    // This will store the sum of probabilities of each state over all the
-    // observations.
-    arma::vec probRowSums(dists.size());
-
-    // Calculate the new value of the means using the updated conditional
+    // Calculate the new means and covariances using the weighted conditional
     // probabilities.
-    for (size_t i = 0; i < dists.size(); i++)
-    {
-      // Calculate the sum of probabilities of points, which is the
-      // conditional probability of each point being from Gaussian i
-      // multiplied by the probability of the point being from this mixture
-      // model.
-      probRowSums[i] = accu(condProb.col(i) % probabilities);
-
-      // Don't update if there's no probability of the Gaussian having points.
-      if (probRowSums[i] != 0)
-      {
-        dists[i].Mean() = (observations * (condProb.col(i) % probabilities)) /
-            probRowSums[i];
-      }
-      else
-        continue;
-
-      // Calculate the new value of the covariances using the updated
-      // conditional probabilities and the updated means.
-      arma::mat tmp = observations.each_col() - dists[i].Mean();
-
-      // If the distribution is DiagonalGaussianDistribution, calculate the
-      // covariance only with diagonal components.
-      if (std::is_same<Distribution,
-          distribution::DiagonalGaussianDistribution>::value)
-      {
-        arma::vec cov = arma::sum((tmp % tmp) %
-            (arma::ones<arma::vec>(observations.n_rows) *
-            trans(condProb.col(i) % probabilities)), 1) / probRowSums[i];
-
-        // Apply covariance constraint.
-        constraint.ApplyConstraint(cov);
-        dists[i].Covariance(std::move(cov));
-      }
-      else
-      {
-        arma::mat tmpB = tmp.each_row() % trans(condProb.col(i) %
-            probabilities);
-        arma::mat cov = (tmp * trans(tmpB)) / probRowSums[i];
-
-        // Apply covariance constraint.
-        constraint.ApplyConstraint(cov);
-        dists[i].Covariance(std::move(cov));
-      }
-    }
+    arma::vec probRowSums;
+    UpdateDistributions(observations, condProb, dists, probRowSums);
 
     // Calculate the new values for omega using the updated conditional
     // probabilities.
     weights = probRowSums / accu(probabilities);
 
-    // Update values of l; calculate new log-likelihood.
+    // Update values of l; calculate new log-likelihood and the conditional
+    // probabilities for the next iteration.
     lOld = l;
-    l = LogLikelihood(observations, dists, weights);
+    l = ConditionalProbabilities(observations, dists, weights, condProb);
 
     iteration++;
   }
@@ -367,32 +299,147 @@ template<typename InitialClusteringType,
          typename CovarianceConstraintPolicy,
          typename Distribution>
 double EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
-LogLikelihood(const arma::mat& observations,
-              const std::vector<Distribution>& dists,
-              const arma::vec& weights) const
+ConditionalProbabilities(const arma::mat& observations,
+                         const std::vector<Distribution>& dists,
+                         const arma::vec& weights,
+                         arma::mat& condProb)
 {
-  double logLikelihood = 0;
+  condProb.set_size(observations.n_cols, dists.size());
+  const arma::vec logWeights = arma::log(weights);
+
+  // The points are processed in blocks, so that the log-probabilities of a
+  // block under every component stay in cache while they are normalized.
+  const size_t blockSize = 1024;
+  const size_t numBlocks = (observations.n_cols + blockSize - 1) / blockSize;
+
+  double logLikelihood = 0.0;
+  omp_size_t zeroLikelihoods = 0;
+  #pragma omp parallel for schedule(dynamic) \
+      reduction(+:logLikelihood, zeroLikelihoods)
+  for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+  {
+    const size_t begin = b * blockSize;
+    const size_t count = std::min(blockSize, observations.n_cols - begin);
 
-  arma::vec phis;
-  arma::mat likelihoods(dists.size(), observations.n_cols);
+    // An alias of the block of points.
+    const arma::mat block(const_cast<double*>(observations.colptr(begin)),
+        observations.n_rows, count, false, true);
 
-  for (size_t i = 0; i < dists.size(); ++i)
-  {
-    dists[i].Probability(observations, phis);
-    likelihoods.row(i) = weights(i) * trans(phis);
+    // Column j holds the weighted log-probabilities of point j under every
+    // component.
+    arma::mat logProbs(dists.size(), count);
+    arma::vec componentLogProbs;
+    for (size_t i = 0; i < dists.size(); ++i)
+    {
+      dists[i].LogProbability(block, componentLogProbs);
+      logProbs.row(i) = trans(componentLogProbs) + logWeights[i];
+    }
+
+    // Normalize each point with the log-sum-exp trick, so that points far away
+    // from every component don't underflow.
+    for (size_t j = 0; j < count; ++j)
+    {
+      const double maxLogProb = logProbs.col(j).max();
+      if (maxLogProb == -std::numeric_limits<double>::infinity())
+      {
+        // Avoid dividing by zero; if the probability for everything is 0, we
+        // don't want to make it NaN.
+        logProbs.col(j).zeros();
+        logLikelihood += maxLogProb;
+        ++zeroLikelihoods;
+        continue;
+      }
+
+      const double logSum = maxLogProb +
+          std::log(arma::accu(arma::exp(logProbs.col(j) - maxLogProb)));
+      logProbs.col(j) = arma::exp(logProbs.col(j) - logSum);
+      logLikelihood += logSum;
+    }
+
+    condProb.rows(begin, begin + count - 1) = trans(logProbs);
   }
-  // Now sum over every point.
-  for (size_t j = 0; j < observations.n_cols; ++j)
+
+  if (zeroLikelihoods > 0)
   {
-    if (accu(likelihoods.col(j)) == 0)
-      Log::Info << "Likelihood of point " << j << " is 0!  It is probably an "
-          << "outlier." << std::endl;
-    logLikelihood += log(accu(likelihoods.col(j)));
+    Log::Info << "Likelihood of " << zeroLikelihoods << " points is 0!  They "
+        << "are probably outliers." << std::endl;
   }
 
   return logLikelihood;
 }
 
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+UpdateDistributions(const arma::mat& observations,
+                    const arma::mat& condProb,
+                    std::vector<Distribution>& dists,
+                    arma::vec& probRowSums)
+{
+  // Store the sum of the probability of each state over all the observations.
+  probRowSums = trans(arma::sum(condProb, 0 /* columnwise */));
+
+  // If the distribution is DiagonalGaussianDistribution, calculate the
+  // covariance only with diagonal components.
+  const bool isDiagGaussDist = std::is_same<Distribution,
+      distribution::DiagonalGaussianDistribution>::value;
+
+  // Conditional covariance instantiation.
+  std::vector<typename std::conditional<isDiagGaussDist,
+      arma::vec, arma::mat>::type> covs(dists.size());
+
+  // Each component is updated by one thread, and its covariance is accumulated
+  // over blocks of points so that the centered points never have to be stored
+  // all at once.
+  const size_t blockSize = 1024;
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t i = 0; i < (omp_size_t) dists.size(); ++i)
+  {
+    // Don't update if there's no probability of the Gaussian having points.
+    if (probRowSums[i] == 0)
+      continue;
+
+    // Calculate the new value of the means using the updated conditional
+    // probabilities.
+    dists[i].Mean() = (observations * condProb.col(i)) / probRowSums[i];
+    const arma::vec& mean = dists[i].Mean();
+
+    // Calculate the new value of the covariances using the updated
+    // conditional probabilities and the updated means.
+    if (isDiagGaussDist)
+      covs[i].zeros(observations.n_rows);
+    else
+      covs[i].zeros(observations.n_rows, observations.n_rows);
+
+    for (size_t begin = 0; begin < observations.n_cols; begin += blockSize)
+    {
+      const size_t end = std::min(begin + blockSize, observations.n_cols) - 1;
+      const arma::mat tmp = observations.cols(begin, end).each_col() - mean;
+      const arma::rowvec prob = trans(condProb.col(i).subvec(begin, end));
+
+      if (isDiagGaussDist)
+        covs[i] += (tmp % tmp) * trans(prob);
+      else
+        covs[i] += tmp * trans(tmp.each_row() % prob);
+    }
+
+    covs[i] /= probRowSums[i];
+  }
+
+  // Factoring the covariances may throw, so this is done outside of the
+  // parallel region.
+  for (size_t i = 0; i < dists.size(); ++i)
+  {
+    if (probRowSums[i] == 0)
+      continue;
+
+    // Apply covariance constraint.
+    constraint.ApplyConstraint(covs[i]);
+    dists[i].Covariance(std::move(covs[i]));
+  }
+}
+
 template<typename InitialClusteringType,
          typename CovarianceConstraintPolicy,
          typename Distribution>
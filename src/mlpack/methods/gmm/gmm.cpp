@@ -28,7 +28,8 @@ GMM::GMM(const size_t gaussians, const size_t dimensionality) :
     gaussians(gaussians),
     dimensionality(dimensionality),
     dists(gaussians, distribution::GaussianDistribution(dimensionality)),
-    weights(gaussians)
+    weights(gaussians),
+    batches(0)
 {
   // Set equal weights.  Technically this model is still valid, but only barely.
   weights.fill(1.0 / gaussians);
@@ -39,7 +40,8 @@ GMM::GMM(const GMM& other) :
     gaussians(other.Gaussians()),
     dimensionality(other.dimensionality),
     dists(other.dists),
-    weights(other.weights) { /* Nothing to do. */ }
+    weights(other.weights),
+    batches(other.batches) { /* Nothing to do. */ }
 
 GMM& GMM::operator=(const GMM& other)
 {
@@ -47,6 +49,7 @@ GMM& GMM::operator=(const GMM& other)
   dimensionality = other.dimensionality;
   dists = other.dists;
   weights = other.weights;
+  batches = other.batches;
 
   return *this;
 }
@@ -86,6 +89,27 @@ double GMM::LogProbability(const arma::vec& observation,
   return log(weights[component]) + dists[component].LogProbability(observation);
 }
 
+/**
+ * Return the log probability of each of the given observations being from this
+ * GMM.
+ */
+void GMM::LogProbability(const arma::mat& observations,
+                         arma::vec& logProbabilities) const
+{
+  // One row per component, one column per observation.
+  arma::mat logProbs(gaussians, observations.n_cols);
+  arma::vec componentLogProbs;
+  for (size_t i = 0; i < gaussians; i++)
+  {
+    dists[i].LogProbability(observations, componentLogProbs);
+    logProbs.row(i) = log(weights[i]) + trans(componentLogProbs);
+  }
+
+  logProbabilities.set_size(observations.n_cols);
+  for (size_t j = 0; j < observations.n_cols; j++)
+    logProbabilities[j] = math::AccuLog(logProbs.col(j));
+}
+
 /**
  * Return the probability of the given observation being from the given
  * component in the mixture.
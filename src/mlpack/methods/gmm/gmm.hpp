@@ -14,9 +14,12 @@
 #define MLPACK_METHODS_MOG_MOG_EM_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <exception>
 
 // This is the default fitting method class.
 #include "em_fit.hpp"
+// This is the default incremental update method class.
+#include "stepwise_em.hpp"
 
 namespace mlpack {
 namespace gmm /** Gaussian Mixture Models. */ {
@@ -89,13 +92,17 @@ class GMM
   //! Vector of a priori weights for each Gaussian.
   arma::vec weights;
 
+  //! The number of batches the model has been fit to, by Train() or Update().
+  size_t batches;
+
  public:
   /**
    * Create an empty Gaussian Mixture Model, with zero gaussians.
    */
   GMM() :
       gaussians(0),
-      dimensionality(0)
+      dimensionality(0),
+      batches(0)
   {
     // Warn the user.  They probably don't want to do this.  If this constructor
     // is being used (because it is required by some template classes), the user
@@ -124,7 +131,8 @@ class GMM
       gaussians(dists.size()),
       dimensionality((!dists.empty()) ? dists[0].Mean().n_elem : 0),
       dists(dists),
-      weights(weights) { /* Nothing to do. */ }
+      weights(weights),
+      batches(1) { /* Nothing to do. */ }
 
   //! Copy constructor for GMMs.
   GMM(const GMM& other);
@@ -156,6 +164,11 @@ class GMM
   //! Return a reference to the a priori weights of each Gaussian.
   arma::vec& Weights() { return weights; }
 
+  //! Return the number of batches the model has been fit to.
+  size_t Batches() const { return batches; }
+  //! Modify the number of batches the model has been fit to.
+  size_t& Batches() { return batches; }
+
   /**
    * Return the probability that the given observation came from this
    * distribution.
@@ -191,6 +204,18 @@ class GMM
    */
   double LogProbability(const arma::vec& observation,
                         const size_t component) const;
+
+  /**
+   * Compute the log probability of each of the given observations coming from
+   * this distribution.  Each component scores all of the observations with one
+   * call, which is much faster than calling LogProbability() on each column.
+   *
+   * @param observations Observations to evaluate the probability of.
+   * @param logProbabilities Output log probabilities, one per observation.
+   */
+  void LogProbability(const arma::mat& observations,
+                      arma::vec& logProbabilities) const;
+
   /**
    * Return a randomly generated observation according to the probability
    * distribution defined by this object.
@@ -258,6 +283,32 @@ class GMM
                const bool useExistingModel = false,
                FittingType fitter = FittingType());
 
+  /**
+   * Update the model with a batch of observations, using the given algorithm
+   * in the UpdaterType class, so that the model can be trained on a stream of
+   * batches instead of the whole dataset at once.  With the default
+   * StepwiseEM<> updater, the model is moved towards the maximum likelihood
+   * estimate of the batch by a step that shrinks with the number of batches
+   * already seen (see Batches(); training with Train() counts as one batch).
+   * If the model hasn't been fit to anything yet, it is fit to the first batch
+   * with the EM algorithm.
+   *
+   * The UpdaterType class must provide the following function:
+   *
+   * @code
+   * double Update(const arma::mat& batch,
+   *               std::vector<GaussianDistribution>& dists,
+   *               arma::vec& weights,
+   *               const size_t batches);
+   * @endcode
+   *
+   * @param batch Batch of observations.
+   * @param updater Updater to use.
+   * @return The log-likelihood of the batch under the model before the update.
+   */
+  template<typename UpdaterType = StepwiseEM<>>
+  double Update(const arma::mat& batch, UpdaterType updater = UpdaterType());
+
   /**
    * Classify the given observations as being from an individual component in
    * this GMM.  The resultant classifications are stored in the 'labels' object,
@@ -281,9 +332,34 @@ class GMM
    * Serialize the GMM.
    */
   template<typename Archive>
-  void serialize(Archive& ar, const unsigned int /* version */);
+  void serialize(Archive& ar, const unsigned int version);
 
  private:
+  /**
+   * Run the given number of trials of Train() one after another, keeping the
+   * model with the greatest log-likelihood.
+   */
+  template<typename FittingType>
+  double TrainTrials(const arma::mat& observations,
+                     const size_t trials,
+                     const bool useExistingModel,
+                     FittingType& fitter);
+
+  /**
+   * Run the given number of trials of Train() in parallel, keeping the model
+   * with the greatest log-likelihood.  This is used for EMFit, which can draw
+   * the random initial models of the trials up front, so that the model is the
+   * same as with the trials run one after another.  If
+   * EMFit::AbandonTrials() is true, the trials that can't beat the best
+   * log-likelihood so far are abandoned.
+   */
+  template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+  double TrainTrials(const arma::mat& observations,
+                     const size_t trials,
+                     const bool useExistingModel,
+                     EMFit<InitialClusteringType, CovarianceConstraintPolicy,
+                         distribution::GaussianDistribution>& fitter);
+
   /**
    * This function computes the loglikelihood of the given model.  This function
    * is used by GMM::Train().
@@ -302,6 +378,9 @@ class GMM
 } // namespace gmm
 } // namespace mlpack
 
+//! Set the serialization version of the GMM class.
+BOOST_CLASS_VERSION(mlpack::gmm::GMM, 1);
+
 // Include implementation.
 #include "gmm_impl.hpp"
 
@@ -44,61 +44,184 @@ double GMM::Train(const arma::mat& observations,
     if (trials == 0)
       return -DBL_MAX; // It's what they asked for...
 
-    // If each trial must start from the same initial location, we must save it.
-    std::vector<distribution::GaussianDistribution> distsOrig;
-    arma::vec weightsOrig;
+    bestLikelihood = TrainTrials(observations, trials, useExistingModel,
+        fitter);
+  }
+
+  // The model has now been fit to a single batch.
+  batches = 1;
+
+  // Report final log-likelihood and return it.
+  Log::Info << "GMM::Train(): log-likelihood of trained GMM is "
+      << bestLikelihood << "." << std::endl;
+  return bestLikelihood;
+}
+
+/**
+ * Run the trials of Train() one after another.
+ */
+template<typename FittingType>
+double GMM::TrainTrials(const arma::mat& observations,
+                        const size_t trials,
+                        const bool useExistingModel,
+                        FittingType& fitter)
+{
+  double bestLikelihood;
+
+  // If each trial must start from the same initial location, we must save it.
+  std::vector<distribution::GaussianDistribution> distsOrig;
+  arma::vec weightsOrig;
+  if (useExistingModel)
+  {
+    distsOrig = dists;
+    weightsOrig = weights;
+  }
+
+  // We need to keep temporary copies.  We'll do the first training into the
+  // actual model position, so that if it's the best we don't need to copy it.
+  fitter.Estimate(observations, dists, weights, useExistingModel);
+
+  bestLikelihood = LogLikelihood(observations, dists, weights);
+
+  Log::Info << "GMM::Train(): Log-likelihood of trial 0 is "
+      << bestLikelihood << "." << std::endl;
+
+  // Now the temporary model.
+  std::vector<distribution::GaussianDistribution> distsTrial(gaussians,
+      distribution::GaussianDistribution(dimensionality));
+  arma::vec weightsTrial(gaussians);
+
+  for (size_t trial = 1; trial < trials; ++trial)
+  {
     if (useExistingModel)
     {
-      distsOrig = dists;
-      weightsOrig = weights;
+      distsTrial = distsOrig;
+      weightsTrial = weightsOrig;
     }
 
-    // We need to keep temporary copies.  We'll do the first training into the
-    // actual model position, so that if it's the best we don't need to copy it.
-    fitter.Estimate(observations, dists, weights, useExistingModel);
+    fitter.Estimate(observations, distsTrial, weightsTrial, useExistingModel);
 
-    bestLikelihood = LogLikelihood(observations, dists, weights);
+    // Check to see if the log-likelihood of this one is better.
+    double newLikelihood = LogLikelihood(observations, distsTrial,
+        weightsTrial);
 
-    Log::Info << "GMM::Train(): Log-likelihood of trial 0 is "
-        << bestLikelihood << "." << std::endl;
+    Log::Info << "GMM::Train(): Log-likelihood of trial " << trial << " is "
+        << newLikelihood << "." << std::endl;
 
-    // Now the temporary model.
-    std::vector<distribution::GaussianDistribution> distsTrial(gaussians,
-        distribution::GaussianDistribution(dimensionality));
-    arma::vec weightsTrial(gaussians);
-
-    for (size_t trial = 1; trial < trials; ++trial)
+    if (newLikelihood > bestLikelihood)
     {
-      if (useExistingModel)
-      {
-        distsTrial = distsOrig;
-        weightsTrial = weightsOrig;
-      }
+      // Save new likelihood and copy new model.
+      bestLikelihood = newLikelihood;
 
-      fitter.Estimate(observations, distsTrial, weightsTrial, useExistingModel);
+      dists = distsTrial;
+      weights = weightsTrial;
+    }
+  }
 
-      // Check to see if the log-likelihood of this one is better.
-      double newLikelihood = LogLikelihood(observations, distsTrial,
-          weightsTrial);
+  return bestLikelihood;
+}
 
-      Log::Info << "GMM::Train(): Log-likelihood of trial " << trial << " is "
-          << newLikelihood << "." << std::endl;
+/**
+ * Run the trials of Train() with EMFit in parallel.
+ */
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+double GMM::TrainTrials(
+    const arma::mat& observations,
+    const size_t trials,
+    const bool useExistingModel,
+    EMFit<InitialClusteringType, CovarianceConstraintPolicy,
+        distribution::GaussianDistribution>& fitter)
+{
+  // Draw the initial models of all trials first, in order.  The initial
+  // clustering is the only part of a trial that uses random numbers, so the
+  // trials give the same models as when they are run one after another, no
+  // matter how many threads run them.
+  std::vector<std::vector<distribution::GaussianDistribution>> trialDists(
+      trials, dists);
+  std::vector<arma::vec> trialWeights(trials, weights);
+  if (!useExistingModel)
+  {
+    for (size_t trial = 0; trial < trials; ++trial)
+    {
+      fitter.InitialClustering(observations, trialDists[trial],
+          trialWeights[trial]);
+    }
+  }
 
-      if (newLikelihood > bestLikelihood)
-      {
-        // Save new likelihood and copy new model.
-        bestLikelihood = newLikelihood;
+  // If the fitter may abandon trials, the best log-likelihood so far is shared
+  // between the trials, so that the trials that can't reach it are abandoned.
+  // Otherwise every trial runs to the end against a bound that can't be
+  // missed, and the model is the same as when the trials run one after
+  // another.
+  std::atomic<double> bestLikelihood(-DBL_MAX);
+  const std::atomic<double> noBound(-DBL_MAX);
+  const std::atomic<double>& bound = fitter.AbandonTrials() ? bestLikelihood :
+      noBound;
+  arma::vec likelihoods(trials);
+  likelihoods.fill(-DBL_MAX);
+  std::vector<char> finished(trials, 0);
+  std::exception_ptr error;
+
+  #pragma omp parallel
+  {
+    EMFit<InitialClusteringType, CovarianceConstraintPolicy,
+        distribution::GaussianDistribution> threadFitter(fitter);
 
-        dists = distsTrial;
-        weights = weightsTrial;
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t trial = 0; trial < (omp_size_t) trials; ++trial)
+    {
+      // Exceptions can't leave the parallel region, so the first one is kept
+      // and thrown afterwards.
+      try
+      {
+        if (!threadFitter.Estimate(observations, trialDists[trial],
+            trialWeights[trial], true, bound))
+          continue;
+
+        finished[trial] = 1;
+        likelihoods[trial] = LogLikelihood(observations, trialDists[trial],
+            trialWeights[trial]);
+
+        double best = bestLikelihood.load();
+        while (likelihoods[trial] > best &&
+            !bestLikelihood.compare_exchange_weak(best, likelihoods[trial]))
+        { /* best now holds the current value; try again. */ }
+      }
+      catch (...)
+      {
+        #pragma omp critical
+        {
+          if (!error)
+            error = std::current_exception();
+        }
       }
     }
   }
 
-  // Report final log-likelihood and return it.
-  Log::Info << "GMM::Train(): log-likelihood of trained GMM is "
-      << bestLikelihood << "." << std::endl;
-  return bestLikelihood;
+  if (error)
+    std::rethrow_exception(error);
+
+  for (size_t trial = 0; trial < trials; ++trial)
+  {
+    if (finished[trial])
+    {
+      Log::Info << "GMM::Train(): Log-likelihood of trial " << trial
+          << " is " << likelihoods[trial] << "." << std::endl;
+    }
+    else
+    {
+      Log::Info << "GMM::Train(): trial " << trial << " abandoned because "
+          << "it could not reach the best log-likelihood." << std::endl;
+    }
+  }
+
+  // Ties go to the earliest trial, like when the trials run in order.
+  arma::uword bestTrial;
+  likelihoods.max(bestTrial);
+  dists = std::move(trialDists[bestTrial]);
+  weights = std::move(trialWeights[bestTrial]);
+
+  return likelihoods[bestTrial];
 }
 
 /**
@@ -181,17 +304,34 @@ double GMM::Train(const arma::mat& observations,
     }
   }
 
+  // The model has now been fit to a single batch.
+  batches = 1;
+
   // Report final log-likelihood and return it.
   Log::Info << "GMM::Train(): log-likelihood of trained GMM is "
       << bestLikelihood << "." << std::endl;
   return bestLikelihood;
 }
 
+/**
+ * Update the model with a batch of observations.
+ */
+template<typename UpdaterType>
+double GMM::Update(const arma::mat& batch, UpdaterType updater)
+{
+  const double likelihood = updater.Update(batch, dists, weights, batches);
+  ++batches;
+
+  Log::Info << "GMM::Update(): log-likelihood of batch " << batches << " is "
+      << likelihood << "." << std::endl;
+  return likelihood;
+}
+
 /**
  * Serialize the object.
  */
 template<typename Archive>
-void GMM::serialize(Archive& ar, const unsigned int /* version */)
+void GMM::serialize(Archive& ar, const unsigned int version)
 {
   ar & BOOST_SERIALIZATION_NVP(gaussians);
   ar & BOOST_SERIALIZATION_NVP(dimensionality);
@@ -205,6 +345,12 @@ void GMM::serialize(Archive& ar, const unsigned int /* version */)
   ar & BOOST_SERIALIZATION_NVP(dists);
 
   ar & BOOST_SERIALIZATION_NVP(weights);
+
+  // Older models don't store the number of batches; they have been trained.
+  if (version > 0)
+    ar & BOOST_SERIALIZATION_NVP(batches);
+  else if (Archive::is_loading::value)
+    batches = (gaussians > 0) ? 1 : 0;
 }
 
 } // namespace gmm
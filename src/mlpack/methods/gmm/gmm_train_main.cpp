@@ -59,6 +59,15 @@ PROGRAM_INFO("Gaussian Mixture Model (GMM) Training",
     "Bradley-Fayyad refined start initialization will be used.  This can often "
     "lead to better clustering results."
     "\n\n"
+    "If " + PRINT_PARAM_STRING("batch_size") + " is positive, the model is "
+    "instead trained incrementally with stepwise EM, on consecutive batches of "
+    "that many points, and " + PRINT_PARAM_STRING("trials") + " is ignored.  "
+    "The first batch is fit with EM (unless an input model is given), and each"
+    " later batch moves the model by a step that decays with the number of "
+    "batches seen; " + PRINT_PARAM_STRING("decay") + " controls how fast the "
+    "step decays.  An input model trained this way can be trained further on "
+    "new data, so a stream can be processed one piece at a time."
+    "\n\n"
     "The 'diagonal_covariance' flag will cause the learned covariances to be "
     "diagonal matrices.  This significantly simplifies the model itself and "
     "causes training to be faster, but restricts the ability to fit more "
@@ -115,6 +124,12 @@ PARAM_INT_IN("max_iterations", "Maximum number of iterations of EM algorithm "
 PARAM_FLAG("diagonal_covariance", "Force the covariance of the Gaussians to "
     "be diagonal.  This can accelerate training time significantly.", "d");
 
+// Parameters for incremental training.
+PARAM_INT_IN("batch_size", "If positive, train incrementally with stepwise EM "
+    "on batches of this many points.", "b", 0);
+PARAM_DOUBLE_IN("decay", "Decay of the step size of stepwise EM (between 0.5 "
+    "and 1; smaller values adapt faster to new batches).", "D", 0.6);
+
 // Parameters for dataset modification.
 PARAM_DOUBLE_IN("noise", "Variance of zero-mean Gaussian noise to add to data.",
     "N", 0);
@@ -133,6 +148,32 @@ PARAM_MODEL_IN(GMM, "input_model", "Initial input GMM model to start training "
     "with.", "m");
 PARAM_MODEL_OUT(GMM, "output_model", "Output for trained GMM model.", "M");
 
+/**
+ * Fit the model to the data: with the given fitter for all the data at once,
+ * or, if --batch_size is positive, incrementally with the given updater.  When
+ * training incrementally, an input model is updated instead of replaced, and
+ * the sum of the log-likelihoods of the batches is returned.
+ */
+template<typename GMMType, typename FittingType, typename UpdaterType>
+double FitModel(GMMType& gmm,
+                const arma::mat& dataPoints,
+                FittingType& fitter,
+                UpdaterType& updater)
+{
+  const size_t batchSize = (size_t) CLI::GetParam<int>("batch_size");
+  if (batchSize == 0)
+    return gmm.Train(dataPoints, CLI::GetParam<int>("trials"), false, fitter);
+
+  double likelihood = 0.0;
+  for (size_t begin = 0; begin < dataPoints.n_cols; begin += batchSize)
+  {
+    const size_t end = std::min(begin + batchSize, dataPoints.n_cols) - 1;
+    likelihood += gmm.Update(dataPoints.cols(begin, end), updater);
+  }
+
+  return likelihood;
+}
+
 static void mlpackMain()
 {
   // Check parameters and load data.
@@ -151,6 +192,17 @@ static void mlpackMain()
   RequireParamValue<double>("noise", [](double x) { return x >= 0.0; }, true,
       "variance of noise must be greater than or equal to 0");
 
+  RequireParamValue<int>("batch_size", [](int x) { return x >= 0; }, true,
+      "batch size must be greater than or equal to 0");
+  RequireParamValue<double>("decay", [](double x) {
+      return x > 0.5 && x <= 1.0; }, true, "decay must be greater than 0.5 and "
+      "less than or equal to 1");
+  if (CLI::GetParam<int>("batch_size") > 0)
+    ReportIgnoredParam("trials", "--batch_size is positive");
+  else
+    ReportIgnoredParam("decay", "--batch_size is not positive");
+  const double decay = CLI::GetParam<double>("decay");
+
   arma::mat dataPoints = std::move(CLI::GetParam<arma::mat>("input"));
 
   // Do we need to add noise to the dataset?
@@ -221,15 +273,18 @@ static void mlpackMain()
             std::move(arma::diagvec(gmm->Component(i).Covariance())));
       }
       dgmm.Weights() = gmm->Weights();
+      dgmm.Batches() = gmm->Batches();
 
       // Compute the parameters of the model using the EM algorithm.
       Timer::Start("em");
       EMFit<KMeansType, PositiveDefiniteConstraint,
           distribution::DiagonalGaussianDistribution> em(maxIterations,
           tolerance, k);
+      StepwiseEM<KMeansType, PositiveDefiniteConstraint,
+          distribution::DiagonalGaussianDistribution> updater(decay,
+          maxIterations, tolerance, k);
 
-      likelihood = dgmm.Train(dataPoints, CLI::GetParam<int>("trials"), false,
-          em);
+      likelihood = FitModel(dgmm, dataPoints, em, updater);
       Timer::Stop("em");
 
       // Convert DiagonalGMMs into GMMs.
@@ -240,14 +295,15 @@ static void mlpackMain()
             std::move(arma::diagmat(dgmm.Component(i).Covariance())));
       }
       gmm->Weights() = dgmm.Weights();
+      gmm->Batches() = dgmm.Batches();
     }
     else if (forcePositive)
     {
       // Compute the parameters of the model using the EM algorithm.
       Timer::Start("em");
       EMFit<KMeansType> em(maxIterations, tolerance, k);
-      likelihood = gmm->Train(dataPoints, CLI::GetParam<int>("trials"), false,
-          em);
+      StepwiseEM<KMeansType> updater(decay, maxIterations, tolerance, k);
+      likelihood = FitModel(*gmm, dataPoints, em, updater);
       Timer::Stop("em");
     }
     else
@@ -255,8 +311,9 @@ static void mlpackMain()
       // Compute the parameters of the model using the EM algorithm.
       Timer::Start("em");
       EMFit<KMeansType, NoConstraint> em(maxIterations, tolerance, k);
-      likelihood = gmm->Train(dataPoints, CLI::GetParam<int>("trials"), false,
-          em);
+      StepwiseEM<KMeansType, NoConstraint> updater(decay, maxIterations,
+          tolerance, k);
+      likelihood = FitModel(*gmm, dataPoints, em, updater);
       Timer::Stop("em");
     }
   }
@@ -275,15 +332,18 @@ static void mlpackMain()
             std::move(arma::diagvec(gmm->Component(i).Covariance())));
       }
       dgmm.Weights() = gmm->Weights();
+      dgmm.Batches() = gmm->Batches();
 
       // Compute the parameters of the model using the EM algorithm.
       Timer::Start("em");
       EMFit<kmeans::KMeans<>, PositiveDefiniteConstraint,
           distribution::DiagonalGaussianDistribution> em(maxIterations,
           tolerance);
+      StepwiseEM<kmeans::KMeans<>, PositiveDefiniteConstraint,
+          distribution::DiagonalGaussianDistribution> updater(decay,
+          maxIterations, tolerance);
 
-      likelihood = dgmm.Train(dataPoints, CLI::GetParam<int>("trials"), false,
-          em);
+      likelihood = FitModel(dgmm, dataPoints, em, updater);
       Timer::Stop("em");
 
       // Convert DiagonalGMMs into GMMs.
@@ -294,14 +354,15 @@ static void mlpackMain()
             std::move(arma::diagmat(dgmm.Component(i).Covariance())));
       }
       gmm->Weights() = dgmm.Weights();
+      gmm->Batches() = dgmm.Batches();
     }
     else if (forcePositive)
     {
       // Compute the parameters of the model using the EM algorithm.
       Timer::Start("em");
       EMFit<> em(maxIterations, tolerance);
-      likelihood = gmm->Train(dataPoints, CLI::GetParam<int>("trials"), false,
-          em);
+      StepwiseEM<> updater(decay, maxIterations, tolerance);
+      likelihood = FitModel(*gmm, dataPoints, em, updater);
       Timer::Stop("em");
     }
     else
@@ -309,8 +370,9 @@ static void mlpackMain()
       // Compute the parameters of the model using the EM algorithm.
       Timer::Start("em");
       EMFit<KMeans<>, NoConstraint> em(maxIterations, tolerance);
-      likelihood = gmm->Train(dataPoints, CLI::GetParam<int>("trials"), false,
-          em);
+      StepwiseEM<KMeans<>, NoConstraint> updater(decay, maxIterations,
+          tolerance);
+      likelihood = FitModel(*gmm, dataPoints, em, updater);
       Timer::Stop("em");
     }
   }
@@ -0,0 +1,151 @@
+/**
+ * @file stepwise_em.hpp
+ *
+ * Utility class to update a GMM incrementally with the stepwise EM algorithm.
+ * Used by GMM::Update<>() and DiagonalGMM::Update<>().
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_GMM_STEPWISE_EM_HPP
+#define MLPACK_METHODS_GMM_STEPWISE_EM_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "em_fit.hpp"
+
+namespace mlpack {
+namespace gmm {
+
+/**
+ * This class updates a GMM with one batch of observations at a time, using the
+ * stepwise EM algorithm, so that models can be trained on streams that don't
+ * fit in memory and can adapt to them over time.  After the E-step on a batch,
+ * the sufficient statistics of the model (its weights, and the weighted first
+ * and second moments of each component) are interpolated towards the
+ * statistics of the batch with the step size
+ *
+ *   eta_k = (k + 1)^(-decay),
+ *
+ * where k is the number of batches the model has already been fit to, and the
+ * model is then recomputed from the interpolated statistics.  For more
+ * information, see the following paper:
+ *
+ * @code
+ * @inproceedings{liang2009online,
+ *   title={Online EM for Unsupervised Models},
+ *   author={Liang, Percy and Klein, Dan},
+ *   booktitle={Proceedings of Human Language Technologies: The 2009 Annual
+ *       Conference of the North American Chapter of the Association for
+ *       Computational Linguistics},
+ *   pages={611--619},
+ *   year={2009}
+ * }
+ * @endcode
+ *
+ * A model that hasn't been fit to anything yet is fit to its first batch with
+ * the full EM algorithm (see EMFit), starting from the given initial
+ * clustering.
+ *
+ * @tparam InitialClusteringType Clustering used to initialize the model on the
+ *     first batch.
+ * @tparam CovarianceConstraintPolicy Constraint applied to the covariances
+ *     after each update.
+ * @tparam Distribution Type of the components of the model.
+ */
+template<typename InitialClusteringType = kmeans::KMeans<>,
+         typename CovarianceConstraintPolicy = PositiveDefiniteConstraint,
+         typename Distribution = distribution::GaussianDistribution>
+class StepwiseEM
+{
+ public:
+  /**
+   * Construct the StepwiseEM object.  The decay of the step size must be in
+   * (0.5, 1]; smaller values forget old batches faster.  The maximum number of
+   * iterations and the tolerance are used to fit the first batch.
+   *
+   * @param decay Decay of the step size.
+   * @param maxIterations Maximum number of iterations of EM on the first batch.
+   * @param tolerance Log-likelihood tolerance of EM on the first batch.
+   * @param clusterer Object which will perform the initial clustering.
+   * @param constraint Constraint policy of covariance.
+   */
+  StepwiseEM(const double decay = 0.6,
+             const size_t maxIterations = 300,
+             const double tolerance = 1e-10,
+             InitialClusteringType clusterer = InitialClusteringType(),
+             CovarianceConstraintPolicy constraint =
+                 CovarianceConstraintPolicy());
+
+  /**
+   * Update the model with the given batch of observations.  The size of the
+   * vectors (indicating the number of components) must already be set.
+   *
+   * @param batch Batch of observations.
+   * @param dists Distributions of the model to update.
+   * @param weights A priori weights of the model to update.
+   * @param batches Number of batches the model has already been fit to; if 0,
+   *     the model is fit to the batch from scratch.
+   * @return The log-likelihood of the batch under the model before the update
+   *     (or under the fitted model, for the first batch).
+   */
+  double Update(const arma::mat& batch,
+                std::vector<Distribution>& dists,
+                arma::vec& weights,
+                const size_t batches);
+
+  //! Get the decay of the step size.
+  double Decay() const { return decay; }
+  //! Modify the decay of the step size.
+  double& Decay() { return decay; }
+
+  //! Get the maximum number of iterations of EM on the first batch.
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of iterations of EM on the first batch.
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the tolerance of EM on the first batch.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance of EM on the first batch.
+  double& Tolerance() { return tolerance; }
+
+  //! Get the clusterer.
+  const InitialClusteringType& Clusterer() const { return clusterer; }
+  //! Modify the clusterer.
+  InitialClusteringType& Clusterer() { return clusterer; }
+
+  //! Get the covariance constraint policy class.
+  const CovarianceConstraintPolicy& Constraint() const { return constraint; }
+  //! Modify the covariance constraint policy class.
+  CovarianceConstraintPolicy& Constraint() { return constraint; }
+
+  //! Serialize the updater.
+  template<typename Archive>
+  void serialize(Archive& ar, const unsigned int version);
+
+ private:
+  //! The EM fitter used for the first batch and for the E-step.
+  typedef EMFit<InitialClusteringType, CovarianceConstraintPolicy,
+      Distribution> EMType;
+
+  //! Decay of the step size.
+  double decay;
+  //! Maximum iterations of EM on the first batch.
+  size_t maxIterations;
+  //! Tolerance for convergence of EM on the first batch.
+  double tolerance;
+  //! Object which will perform the clustering.
+  InitialClusteringType clusterer;
+  //! Object which applies constraints to the covariance matrix.
+  CovarianceConstraintPolicy constraint;
+};
+
+} // namespace gmm
+} // namespace mlpack
+
+// Include implementation.
+#include "stepwise_em_impl.hpp"
+
+#endif
@@ -0,0 +1,147 @@
+/**
+ * @file stepwise_em_impl.hpp
+ *
+ * Implementation of the stepwise EM algorithm for updating GMMs.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_GMM_STEPWISE_EM_IMPL_HPP
+#define MLPACK_METHODS_GMM_STEPWISE_EM_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "stepwise_em.hpp"
+
+namespace mlpack {
+namespace gmm {
+
+//! Constructor.
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+StepwiseEM<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+StepwiseEM(const double decay,
+           const size_t maxIterations,
+           const double tolerance,
+           InitialClusteringType clusterer,
+           CovarianceConstraintPolicy constraint) :
+    decay(decay),
+    maxIterations(maxIterations),
+    tolerance(tolerance),
+    clusterer(clusterer),
+    constraint(constraint)
+{
+  if (decay <= 0.5 || decay > 1.0)
+  {
+    std::ostringstream oss;
+    oss << "StepwiseEM::StepwiseEM(): decay (" << decay << ") must be in "
+        << "(0.5, 1]!";
+    throw std::invalid_argument(oss.str());
+  }
+}
+
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+double StepwiseEM<InitialClusteringType, CovarianceConstraintPolicy,
+    Distribution>::Update(const arma::mat& batch,
+                          std::vector<Distribution>& dists,
+                          arma::vec& weights,
+                          const size_t batches)
+{
+  arma::mat condProb;
+  if (batches == 0)
+  {
+    // There is nothing to interpolate with yet, so fit the batch directly.
+    EMType em(maxIterations, tolerance, clusterer, constraint);
+    em.Estimate(batch, dists, weights, false);
+    return EMType::ConditionalProbabilities(batch, dists, weights, condProb);
+  }
+
+  const double logLikelihood = EMType::ConditionalProbabilities(batch, dists,
+      weights, condProb);
+
+  const double stepSize = std::pow(double(batches + 1), -decay);
+
+  // The new weights are the interpolated first statistic of each component.
+  const arma::vec newWeights = (1.0 - stepSize) * weights + stepSize *
+      trans(arma::sum(condProb, 0)) / batch.n_cols;
+
+  // If the distribution is DiagonalGaussianDistribution, only the diagonal
+  // of the covariance is needed.
+  const bool isDiagGaussDist = std::is_same<Distribution,
+      distribution::DiagonalGaussianDistribution>::value;
+
+  std::vector<arma::vec> means(dists.size());
+  std::vector<typename std::conditional<isDiagGaussDist,
+      arma::vec, arma::mat>::type> covs(dists.size());
+
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t i = 0; i < (omp_size_t) dists.size(); ++i)
+  {
+    // Don't update if there's no probability of the Gaussian having points.
+    if (newWeights[i] == 0)
+      continue;
+
+    // The statistics are taken around the current mean, so the old model
+    // contributes no first moment and its covariance as the second moment;
+    // this avoids cancellation when the covariance is recovered.
+    const arma::mat centered = batch.each_col() - dists[i].Mean();
+    const arma::vec prob = condProb.col(i) * (stepSize / batch.n_cols);
+    const double oldWeight = (1.0 - stepSize) * weights[i];
+
+    const arma::vec shift = (centered * prob) / newWeights[i];
+    means[i] = dists[i].Mean() + shift;
+
+    if (isDiagGaussDist)
+    {
+      covs[i] = (oldWeight * dists[i].Covariance() +
+          (centered % centered) * prob) / newWeights[i] - shift % shift;
+    }
+    else
+    {
+      covs[i] = (oldWeight * dists[i].Covariance() +
+          centered * trans(centered.each_row() % trans(prob))) /
+          newWeights[i] - shift * trans(shift);
+    }
+  }
+
+  // Factoring the covariances may throw, so this is done outside of the
+  // parallel region.
+  for (size_t i = 0; i < dists.size(); ++i)
+  {
+    if (newWeights[i] == 0)
+      continue;
+
+    std::swap(dists[i].Mean(), means[i]);
+
+    // Apply covariance constraint.
+    constraint.ApplyConstraint(covs[i]);
+    dists[i].Covariance(std::move(covs[i]));
+  }
+
+  weights = newWeights / arma::accu(newWeights);
+
+  return logLikelihood;
+}
+
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+template<typename Archive>
+void StepwiseEM<InitialClusteringType, CovarianceConstraintPolicy,
+    Distribution>::serialize(Archive& ar, const unsigned int /* version */)
+{
+  ar & BOOST_SERIALIZATION_NVP(decay);
+  ar & BOOST_SERIALIZATION_NVP(maxIterations);
+  ar & BOOST_SERIALIZATION_NVP(tolerance);
+  ar & BOOST_SERIALIZATION_NVP(clusterer);
+  ar & BOOST_SERIALIZATION_NVP(constraint);
+}
+
+} // namespace gmm
+} // namespace mlpack
+
+#endif
@@ -276,13 +276,39 @@ class HMM
    * sequence, using the Viterbi algorithm, returning the log-likelihood of the
    * most likely state sequence.
    *
+   * If beamWidth is not 0, only the beamWidth most probable states at each time
+   * step are extended to the next one (beam search).  This takes
+   * O(states * beamWidth) time per observation instead of O(states^2), but the
+   * returned state sequence may not be the most probable one if the beam is
+   * too narrow.
+   *
    * @param dataSeq Sequence of observations.
    * @param stateSeq Vector in which the most probable state sequence will be
    *    stored.
+   * @param beamWidth Number of states to keep at each time step (0 keeps all
+   *    states, giving the exact Viterbi path).
    * @return Log-likelihood of most probable state sequence.
    */
   double Predict(const arma::mat& dataSeq,
-                 arma::Row<size_t>& stateSeq) const;
+                 arma::Row<size_t>& stateSeq,
+                 const size_t beamWidth = 0) const;
+
+  /**
+   * Compute the most probable hidden state sequence for each of the given data
+   * sequences, using the Viterbi algorithm.  The sequences are decoded in
+   * parallel.  See the single-sequence overload for the meaning of beamWidth.
+   *
+   * @param dataSeq Sequences of observations.
+   * @param stateSeq Vector in which the most probable state sequence of each
+   *    data sequence will be stored.
+   * @param beamWidth Number of states to keep at each time step (0 keeps all
+   *    states, giving the exact Viterbi path).
+   * @return Log-likelihood of the most probable state sequence of each data
+   *    sequence.
+   */
+  arma::vec Predict(const std::vector<arma::mat>& dataSeq,
+                    std::vector<arma::Row<size_t>>& stateSeq,
+                    const size_t beamWidth = 0) const;
 
   /**
    * Compute the log-likelihood of the given data sequence.
@@ -384,6 +410,47 @@ class HMM
                 const arma::vec& logScales,
                 arma::mat& backwardLogProb) const;
 
+  /**
+   * Compute the log probability of each observation in the given data
+   * sequence under the emission distribution of each state, with one batched
+   * call per state.  The returned matrix has rows equal to the number of
+   * hidden states and columns equal to the number of observations.
+   *
+   * @param dataSeq Data sequence to compute probabilities for.
+   * @param emissionLogProb Matrix in which emission log probabilities will be
+   *     saved.
+   */
+  void EmissionLogProbabilities(const arma::mat& dataSeq,
+                                arma::mat& emissionLogProb) const;
+
+  /**
+   * The Forward algorithm, given the emission log probabilities computed by
+   * EmissionLogProbabilities().  Each step is one matrix-vector product with
+   * the transition matrix.
+   *
+   * @param emissionLogProb Emission log probabilities of the data sequence.
+   * @param logScales Vector in which log scaling factors will be saved.
+   * @param forwardLogProb Matrix in which forward log probabilities will be
+   *     saved.
+   */
+  void LogForward(const arma::mat& emissionLogProb,
+                  arma::vec& logScales,
+                  arma::mat& forwardLogProb) const;
+
+  /**
+   * The Backward algorithm, given the emission log probabilities computed by
+   * EmissionLogProbabilities() and the scaling factors found by LogForward().
+   * Each step is one matrix-vector product with the transition matrix.
+   *
+   * @param emissionLogProb Emission log probabilities of the data sequence.
+   * @param logScales Vector of log scaling factors.
+   * @param backwardLogProb Matrix in which backward log probabilities will be
+   *     saved.
+   */
+  void LogBackward(const arma::mat& emissionLogProb,
+                   const arma::vec& logScales,
+                   arma::mat& backwardLogProb) const;
+
   //! Set of emission probability distributions; one for each state.
   std::vector<Distribution> emission;
 
@@ -92,10 +92,13 @@ double HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
   // Maximum iterations?
   size_t iterations = 1000;
 
-  // Find length of all sequences and ensure they are the correct size.
+  // Find length of all sequences and ensure they are the correct size.  We
+  // also store where each sequence starts in the list of all observations.
   size_t totalLength = 0;
+  std::vector<size_t> offsets(dataSeq.size());
   for (size_t seq = 0; seq < dataSeq.size(); seq++)
   {
+    offsets[seq] = totalLength;
     totalLength += dataSeq[seq].n_cols;
 
     if (dataSeq[seq].n_rows != dimensionality)
@@ -105,72 +108,110 @@ double HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
   }
 
   // These are used later for training of each distribution.  We initialize it
-  // all now so we don't have to do any allocation later on.
+  // all now so we don't have to do any allocation later on.  The list of
+  // observations is the same in every iteration, so it is filled only once.
   std::vector<arma::vec> emissionProb(transition.n_cols,
       arma::vec(totalLength));
   arma::mat emissionList(dimensionality, totalLength);
+  for (size_t seq = 0; seq < dataSeq.size(); seq++)
+  {
+    if (dataSeq[seq].n_cols > 0)
+    {
+      emissionList.cols(offsets[seq], offsets[seq] + dataSeq[seq].n_cols - 1) =
+          dataSeq[seq];
+    }
+  }
 
   // This should be the Baum-Welch algorithm (EM for HMM estimation). This
   // follows the procedure outlined in Elliot, Aggoun, and Moore's book "Hidden
   // Markov Models: Estimation and Control", pp. 36-40.
   for (size_t iter = 0; iter < iterations; iter++)
   {
-    // Clear new transition matrix and emission probabilities.
-    arma::vec newLogInitial(transition.n_rows);
-    newLogInitial.fill(-std::numeric_limits<double>::infinity());
-    arma::mat newLogTransition(transition.n_rows, transition.n_cols);
-    newLogTransition.fill(-std::numeric_limits<double>::infinity());
+    // Clear new transition matrix and initial probabilities.
+    arma::vec newInitial(transition.n_rows, arma::fill::zeros);
+    arma::mat newTransition(transition.n_rows, transition.n_cols,
+        arma::fill::zeros);
 
     // Reset log likelihood.
     loglik = 0;
 
-    // Sum over time.
-    size_t sumTime = 0;
-
-    // Loop over each sequence.
-    for (size_t seq = 0; seq < dataSeq.size(); seq++)
+    // The sequences are independent, so they are split between threads.  Each
+    // thread sums the statistics of its sequences, and the sums are combined
+    // at the end.  The posterior state probabilities of each sequence go into
+    // their own range of emissionProb, so they need no combining.
+    #pragma omp parallel
     {
-      arma::mat stateLogProb;
+      arma::vec threadInitial(transition.n_rows, arma::fill::zeros);
+      arma::mat threadTransition(transition.n_rows, transition.n_cols,
+          arma::fill::zeros);
+      double threadLoglik = 0;
+
+      arma::mat emissionLogProb;
       arma::mat forwardLog;
       arma::mat backwardLog;
       arma::vec logScales;
 
-      // Add the log-likelihood of this sequence.  This is the E-step.
-      loglik += LogEstimate(dataSeq[seq], stateLogProb, forwardLog,
-          backwardLog, logScales);
-
-      // Add to estimate of initial probability for state j.
-      for (size_t j = 0; j < transition.n_cols; ++j)
-        newLogInitial[j] = math::LogAdd(newLogInitial[j], stateLogProb(j, 0));
-
-      // Now re-estimate the parameters.  This is the M-step.
-      //   pi_i = sum_d ((1 / P(seq[d])) sum_t (f(i, 0) b(i, 0))
-      //   T_ij = sum_d ((1 / P(seq[d])) sum_t (f(i, t) T_ij E_i(seq[d][t]) b(i,
-      //           t + 1)))
-      //   E_ij = sum_d ((1 / P(seq[d])) sum_{t | seq[d][t] = j} f(i, t) b(i, t)
-      // We store the new estimates in a different matrix.
-      for (size_t t = 0; t < dataSeq[seq].n_cols; ++t)
+      #pragma omp for schedule(dynamic)
+      for (omp_size_t seq = 0; seq < (omp_size_t) dataSeq.size(); seq++)
       {
+        const size_t length = dataSeq[seq].n_cols;
+        if (length == 0)
+          continue;
+
+        // Add the log-likelihood of this sequence.  This is the E-step.
+        EmissionLogProbabilities(dataSeq[seq], emissionLogProb);
+        LogForward(emissionLogProb, logScales, forwardLog);
+        LogBackward(emissionLogProb, logScales, backwardLog);
+        threadLoglik += accu(logScales);
+
+        // Now re-estimate the parameters.  This is the M-step.
+        //   pi_i = sum_d ((1 / P(seq[d])) sum_t (f(i, 0) b(i, 0))
+        //   T_ij = sum_d ((1 / P(seq[d])) sum_t (f(i, t) T_ij E_i(seq[d][t])
+        //           b(i, t + 1)))
+        //   E_ij = sum_d ((1 / P(seq[d])) sum_{t | seq[d][t] = j} f(i, t)
+        //           b(i, t)
+        // We store the new estimates in a different matrix.
+        const arma::mat stateProb = exp(forwardLog + backwardLog);
+        threadInitial += stateProb.col(0);
         for (size_t j = 0; j < transition.n_cols; ++j)
         {
-          if (t < dataSeq[seq].n_cols - 1)
+          emissionProb[j].subvec(offsets[seq], offsets[seq] + length - 1) =
+              trans(stateProb.row(j));
+        }
+
+        if (length > 1)
+        {
+          // The estimate of T_ij (probability of transition from state j to
+          // state i) without the old T_ij, which we postpone until later, is a
+          // sum over t of outer products, so it is one matrix product.  Each
+          // column of the first factor is shifted by its maximum so that the
+          // exponential cannot overflow, and the shift is moved to the
+          // corresponding column of the second factor.
+          arma::vec nextLogScales = logScales.subvec(1, length - 1);
+          nextLogScales.elem(arma::find_nonfinite(nextLogScales)).zeros();
+          arma::mat nextLog = backwardLog.cols(1, length - 1) +
+              emissionLogProb.cols(1, length - 1);
+          nextLog.each_row() -= trans(nextLogScales);
+          arma::mat prevLog = forwardLog.cols(0, length - 2);
+          for (size_t t = 0; t < length - 1; ++t)
           {
-            // Estimate of T_ij (probability of transition from state j to state
-            // i).  We postpone multiplication of the old T_ij until later.
-            for (size_t i = 0; i < transition.n_rows; i++)
+            const double shift = nextLog.col(t).max();
+            if (std::isfinite(shift))
             {
-              newLogTransition(i, j) = math::LogAdd(newLogTransition(i, j),
-                  forwardLog(j, t) + backwardLog(i, t + 1) +
-                  emission[i].LogProbability(dataSeq[seq].unsafe_col(t + 1)) -
-                  logScales[t + 1]);
+              nextLog.col(t) -= shift;
+              prevLog.col(t) += shift;
             }
           }
 
-          // Add to list of emission observations, for Distribution::Train().
-          emissionList.col(sumTime) = dataSeq[seq].col(t);
-          emissionProb[j][sumTime] = exp(stateLogProb(j, t));
+          threadTransition += exp(nextLog) * trans(exp(prevLog));
         }
-        sumTime++;
+      }
+
+      #pragma omp critical
+      {
+        newInitial += threadInitial;
+        newTransition += threadTransition;
+        loglik += threadLoglik;
       }
     }
 
@@ -184,15 +225,15 @@ double HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
 
     // Normalize the new initial probabilities.
     if (dataSeq.size() > 1)
-      initial = exp(newLogInitial) / dataSeq.size();
+      initial = newInitial / dataSeq.size();
     else
-      initial = exp(newLogInitial);
+      initial = newInitial;
 
     // Assign the new transition matrix.  We use %= (element-wise
     // multiplication) because every element of the new transition matrix must
     // still be multiplied by the old elements (this is the multiplication we
     // earlier postponed).
-    transition %= exp(newLogTransition);
+    transition %= newTransition;
 
     // Now we normalize the transition matrix.
     for (size_t i = 0; i < transition.n_cols; i++)
@@ -320,9 +361,12 @@ double HMM<Distribution>::LogEstimate(const arma::mat& dataSeq,
                                       arma::mat& backwardLogProb,
                                       arma::vec& logScales) const
 {
-  // First run the forward-backward algorithm.
-  Forward(dataSeq, logScales, forwardLogProb);
-  Backward(dataSeq, logScales, backwardLogProb);
+  // First run the forward-backward algorithm.  The emission probabilities are
+  // shared by both passes.
+  arma::mat emissionLogProb;
+  EmissionLogProbabilities(dataSeq, emissionLogProb);
+  LogForward(emissionLogProb, logScales, forwardLogProb);
+  LogBackward(emissionLogProb, logScales, backwardLogProb);
 
   // Now assemble the state probability matrix based on the forward and backward
   // probabilities.
@@ -437,57 +481,112 @@ void HMM<Distribution>::Generate(const size_t length,
  */
 template<typename Distribution>
 double HMM<Distribution>::Predict(const arma::mat& dataSeq,
-                                  arma::Row<size_t>& stateSeq) const
+                                  arma::Row<size_t>& stateSeq,
+                                  const size_t beamWidth) const
 {
   // This is an implementation of the Viterbi algorithm for finding the most
-  // probable sequence of states to produce the observed data sequence.  We
-  // don't use log-likelihoods to save that little bit of time, but we'll
-  // calculate the log-likelihood at the end of it all.
-  stateSeq.set_size(dataSeq.n_cols);
-  arma::mat logStateProb(transition.n_rows, dataSeq.n_cols);
-  arma::mat stateSeqBack(transition.n_rows, dataSeq.n_cols);
-
-  // Store the logs of the transposed transition matrix.  This is because we
-  // will be using the rows of the transition matrix.
-  arma::mat logTrans(log(trans(transition)));
+  // probable sequence of states to produce the observed data sequence.  Only
+  // the log-likelihoods of the last time step are kept; to backtrack, we store
+  // the best previous state of every state at every time step, as 32-bit
+  // integers to save memory.
+  const size_t states = transition.n_rows;
+  const size_t length = dataSeq.n_cols;
+  stateSeq.set_size(length);
+  if (length == 0)
+    return 0.0;
+
+  arma::mat emissionLogProb;
+  EmissionLogProbabilities(dataSeq, emissionLogProb);
+
+  // Column j of logTrans holds the log probabilities of transitioning from
+  // each state to state j, so that the inner loop below is contiguous.
+  const arma::mat logTrans(log(trans(transition)));
+  arma::Mat<arma::u32> stateSeqBack(states, length);
 
   // The calculation of the first state is slightly different; the probability
-  // of the first state being state j is the maximum probability that the state
-  // came to be j from another state.
-  logStateProb.col(0).zeros();
-  for (size_t state = 0; state < transition.n_rows; state++)
-  {
-    logStateProb(state, 0) = log(initial[state]) +
-        emission[state].LogProbability(dataSeq.unsafe_col(0));
-    stateSeqBack(state, 0) = state;
-  }
+  // of the first state being state j is the probability of starting in state j
+  // and emitting the first observation.
+  arma::vec logStateProb = log(initial) + emissionLogProb.col(0);
+  arma::vec nextLogStateProb(states);
+
+  // The states that are extended to the next time step; with a beam, these
+  // are only the most probable ones.
+  const bool useBeam = (beamWidth > 0 && beamWidth < states);
+  std::vector<size_t> active(states);
+  for (size_t i = 0; i < states; i++)
+    active[i] = i;
 
-  // Store the best first state.
-  arma::uword index;
-  for (size_t t = 1; t < dataSeq.n_cols; t++)
+  for (size_t t = 1; t < length; t++)
   {
-    // Assemble the state probability for this element.
-    // Given that we are in state j, we use state with the highest probability
-    // of being the previous state.
-    for (size_t j = 0; j < transition.n_rows; j++)
+    if (useBeam)
     {
-      arma::vec prob = logStateProb.col(t - 1) + logTrans.col(j);
-      logStateProb(j, t) = prob.max(index) +
-          emission[j].LogProbability(dataSeq.unsafe_col(t));
-      stateSeqBack(j, t) = index;
+      // Select the beamWidth states with the highest probability, and sort
+      // them by index so that they are read in order below.
+      active.resize(states);
+      for (size_t i = 0; i < states; i++)
+        active[i] = i;
+      std::nth_element(active.begin(), active.begin() + beamWidth - 1,
+          active.end(), [&logStateProb](const size_t a, const size_t b)
+          {
+            return logStateProb[a] > logStateProb[b];
+          });
+      active.resize(beamWidth);
+      std::sort(active.begin(), active.end());
+    }
+
+    // Given that we are in state j, we use the state with the highest
+    // probability of being the previous state.
+    for (size_t j = 0; j < states; j++)
+    {
+      const double* logTransCol = logTrans.colptr(j);
+      double best = -std::numeric_limits<double>::infinity();
+      size_t bestIndex = active[0];
+      for (size_t k = 0; k < active.size(); k++)
+      {
+        const size_t i = active[k];
+        const double prob = logStateProb[i] + logTransCol[i];
+        if (prob > best)
+        {
+          best = prob;
+          bestIndex = i;
+        }
+      }
+
+      nextLogStateProb[j] = best + emissionLogProb(j, t);
+      stateSeqBack(j, t) = (arma::u32) bestIndex;
     }
+
+    logStateProb.swap(nextLogStateProb);
   }
 
   // Backtrack to find the most probable state sequence.
-  logStateProb.unsafe_col(dataSeq.n_cols - 1).max(index);
-  stateSeq[dataSeq.n_cols - 1] = index;
-  for (size_t t = 2; t <= dataSeq.n_cols; t++)
-  {
-    stateSeq[dataSeq.n_cols - t] =
-        stateSeqBack(stateSeq[dataSeq.n_cols - t + 1], dataSeq.n_cols - t + 1);
-  }
+  arma::uword index;
+  const double logLikelihood = logStateProb.max(index);
+  stateSeq[length - 1] = index;
+  for (size_t t = length - 1; t > 0; t--)
+    stateSeq[t - 1] = stateSeqBack(stateSeq[t], t);
 
-  return logStateProb(stateSeq(dataSeq.n_cols - 1), dataSeq.n_cols - 1);
+  return logLikelihood;
+}
+
+/**
+ * Compute the most probable hidden state sequence for each of the given
+ * observation sequences, in parallel.
+ */
+template<typename Distribution>
+arma::vec HMM<Distribution>::Predict(
+    const std::vector<arma::mat>& dataSeq,
+    std::vector<arma::Row<size_t>>& stateSeq,
+    const size_t beamWidth) const
+{
+  stateSeq.resize(dataSeq.size());
+  arma::vec logLikelihoods(dataSeq.size());
+
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t seq = 0; seq < (omp_size_t) dataSeq.size(); seq++)
+    logLikelihoods[seq] = Predict(dataSeq[seq], stateSeq[seq], beamWidth);
+
+  return logLikelihoods;
 }
 
 /**
@@ -560,26 +659,55 @@ template<typename Distribution>
 void HMM<Distribution>::Forward(const arma::mat& dataSeq,
                                 arma::vec& logScales,
                                 arma::mat& forwardLogProb) const
+{
+  arma::mat emissionLogProb;
+  EmissionLogProbabilities(dataSeq, emissionLogProb);
+  LogForward(emissionLogProb, logScales, forwardLogProb);
+}
+
+template<typename Distribution>
+void HMM<Distribution>::Backward(const arma::mat& dataSeq,
+                                 const arma::vec& logScales,
+                                 arma::mat& backwardLogProb) const
+{
+  arma::mat emissionLogProb;
+  EmissionLogProbabilities(dataSeq, emissionLogProb);
+  LogBackward(emissionLogProb, logScales, backwardLogProb);
+}
+
+template<typename Distribution>
+void HMM<Distribution>::EmissionLogProbabilities(
+    const arma::mat& dataSeq,
+    arma::mat& emissionLogProb) const
+{
+  emissionLogProb.set_size(transition.n_rows, dataSeq.n_cols);
+  arma::vec logProbs;
+  for (size_t state = 0; state < transition.n_rows; state++)
+  {
+    emission[state].LogProbability(dataSeq, logProbs);
+    emissionLogProb.row(state) = trans(logProbs);
+  }
+}
+
+template<typename Distribution>
+void HMM<Distribution>::LogForward(const arma::mat& emissionLogProb,
+                                   arma::vec& logScales,
+                                   arma::mat& forwardLogProb) const
 {
   // Our goal is to calculate the forward probabilities:
   //  P(X_k | o_{1:k}) for all possible states X_k, for each time point k.
-  forwardLogProb.resize(transition.n_rows, dataSeq.n_cols);
-  forwardLogProb.fill(-std::numeric_limits<double>::infinity());
-  logScales.resize(dataSeq.n_cols);
-  logScales.fill(-std::numeric_limits<double>::infinity());
-
-  arma::mat logTrans = trans(log(transition));
+  const size_t length = emissionLogProb.n_cols;
+  forwardLogProb.set_size(transition.n_rows, length);
+  logScales.set_size(length);
+  if (length == 0)
+    return;
 
   // The first entry in the forward algorithm uses the initial state
   // probabilities.  Note that MATLAB assumes that the starting state (at
   // t = -1) is state 0; this is not our assumption here.  To force that
   // behavior, you could append a single starting state to every single data
   // sequence and that should produce results in line with MATLAB.
-  for (size_t state = 0; state < transition.n_rows; state++)
-  {
-    forwardLogProb(state, 0) = log(initial(state)) +
-        emission[state].LogProbability(dataSeq.unsafe_col(0));
-  }
+  forwardLogProb.col(0) = log(initial) + emissionLogProb.col(0);
 
   // Then normalize the column.
   logScales[0] = math::AccuLog(forwardLogProb.col(0));
@@ -587,59 +715,71 @@ void HMM<Distribution>::Forward(const arma::mat& dataSeq,
     forwardLogProb.col(0) -= logScales[0];
 
   // Now compute the probabilities for each successive observation.
-  for (size_t t = 1; t < dataSeq.n_cols; t++)
+  for (size_t t = 1; t < length; t++)
   {
-    for (size_t j = 0; j < transition.n_rows; j++)
+    // The forward probability of state j at time t is the sum over all states
+    // of the probability of the previous state transitioning to the current
+    // state and emitting the given observation.  The sum over all states is a
+    // matrix-vector product with the transition matrix; the previous column is
+    // shifted by its maximum so that the exponential cannot overflow.
+    const double shift = forwardLogProb.col(t - 1).max();
+    if (std::isfinite(shift))
     {
-      // The forward probability of state j at time t is the sum over all states
-      // of the probability of the previous state transitioning to the current
-      // state and emitting the given observation.
-      arma::vec tmp = forwardLogProb.col(t - 1) + logTrans.col(j);
-      forwardLogProb(j, t) = math::AccuLog(tmp) +
-          emission[j].LogProbability(dataSeq.unsafe_col(t));
+      forwardLogProb.col(t) = log(transition *
+          exp(forwardLogProb.col(t - 1) - shift)) + shift +
+          emissionLogProb.col(t);
+    }
+    else
+    {
+      forwardLogProb.col(t).fill(-std::numeric_limits<double>::infinity());
     }
 
     // Normalize probability.
     logScales[t] = math::AccuLog(forwardLogProb.col(t));
     if (std::isfinite(logScales[t]))
-        forwardLogProb.col(t) -= logScales[t];
+      forwardLogProb.col(t) -= logScales[t];
   }
 }
 
 template<typename Distribution>
-void HMM<Distribution>::Backward(const arma::mat& dataSeq,
-                                 const arma::vec& logScales,
-                                 arma::mat& backwardLogProb) const
+void HMM<Distribution>::LogBackward(const arma::mat& emissionLogProb,
+                                    const arma::vec& logScales,
+                                    arma::mat& backwardLogProb) const
 {
   // Our goal is to calculate the backward probabilities:
   //  P(X_k | o_{k + 1:T}) for all possible states X_k, for each time point k.
-  backwardLogProb.resize(transition.n_rows, dataSeq.n_cols);
-  backwardLogProb.fill(-std::numeric_limits<double>::infinity());
-  arma::mat logTrans = log(transition);
+  const size_t length = emissionLogProb.n_cols;
+  backwardLogProb.set_size(transition.n_rows, length);
+  if (length == 0)
+    return;
 
   // The last element probability is 1.
-  backwardLogProb.col(dataSeq.n_cols - 1).fill(0);
+  backwardLogProb.col(length - 1).zeros();
 
   // Now step backwards through all other observations.
-  for (size_t t = dataSeq.n_cols - 2; t + 1 > 0; t--)
+  arma::vec next;
+  for (size_t t = length - 2; t + 1 > 0; t--)
   {
-    for (size_t j = 0; j < transition.n_rows; j++)
+    // The backward probability of state j at time t is the sum over all states
+    // of the probability of the next state having been a transition from the
+    // current state multiplied by the probability of each of those states
+    // emitting the given observation.  As in LogForward(), this is a shifted
+    // matrix-vector product, with the transposed transition matrix.
+    next = backwardLogProb.col(t + 1) + emissionLogProb.col(t + 1);
+    const double shift = next.max();
+    if (std::isfinite(shift))
     {
-      // The backward probability of state j at time t is the sum over all state
-      // of the probability of the next state having been a transition from the
-      // current state multiplied by the probability of each of those states
-      // emitting the given observation.
-      for (size_t state = 0; state < transition.n_rows; state++)
-      {
-        backwardLogProb(j, t) = math::LogAdd(backwardLogProb(j, t),
-            logTrans(state, j) + backwardLogProb(state, t + 1)
-            + emission[state].LogProbability(dataSeq.unsafe_col(t + 1)));
-      }
-
-      // Normalize by the weights from the forward algorithm.
-      if (std::isfinite(logScales[t + 1]))
-        backwardLogProb(j, t) -= logScales[t + 1];
+      backwardLogProb.col(t) = log(trans(transition) * exp(next - shift)) +
+          shift;
     }
+    else
+    {
+      backwardLogProb.col(t).fill(-std::numeric_limits<double>::infinity());
+    }
+
+    // Normalize by the weights from the forward algorithm.
+    if (std::isfinite(logScales[t + 1]))
+      backwardLogProb.col(t) -= logScales[t + 1];
   }
 }
 
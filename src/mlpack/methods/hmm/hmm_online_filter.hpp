@@ -0,0 +1,157 @@
+/**
+ * @file hmm_online_filter.hpp
+ *
+ * Definition of HMMOnlineFilter, which runs the forward algorithm of an HMM
+ * one observation at a time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_HMM_HMM_ONLINE_FILTER_HPP
+#define MLPACK_METHODS_HMM_HMM_ONLINE_FILTER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace hmm {
+
+/**
+ * An online filter for a trained HMM.  Observations are given one at a time
+ * (or in small batches) to Update(), and the filter keeps the normalized
+ * forward probabilities P(X_t | o_{1:t}) of the last observation and the
+ * log-likelihood of all the observations so far.  Each observation takes
+ * O(states^2) time and no memory is allocated after construction, so this is
+ * the way to track a stream of observations; calling HMM::Filter() or
+ * HMM::LogLikelihood() on every prefix of a stream takes time quadratic in its
+ * length.
+ *
+ * After the same observations, StateProbabilities() is the last column of the
+ * forward probabilities of HMM::Estimate(), and LogLikelihood() is
+ * HMM::LogLikelihood().
+ *
+ * @code
+ * HMMOnlineFilter<HMM<GaussianDistribution>> filter(hmm);
+ * while (...)
+ * {
+ *   filter.Update(observation);
+ *   arma::vec expected;
+ *   filter.ExpectedEmission(expected, 1); // Expected next observation.
+ * }
+ * @endcode
+ *
+ * HMMOnlineFilter works with any HMM<Distribution> (including the models held
+ * by an HMMModel, through HMMModel::PerformAction()) and with HMMRegression,
+ * whose observations can be given as predictors and a response.
+ *
+ * The filter holds a reference to the HMM, which must outlive it and must not
+ * be modified while it is used.
+ *
+ * @tparam HMMType Type of HMM to filter with.
+ */
+template<typename HMMType>
+class HMMOnlineFilter
+{
+ public:
+  /**
+   * Create a filter for the given HMM, with no observations yet.
+   *
+   * @param hmm Trained HMM to filter with.
+   */
+  HMMOnlineFilter(const HMMType& hmm);
+
+  //! Forget all observations, so that the next one is the first of a new
+  //! sequence.
+  void Reset();
+
+  /**
+   * Add the given observation to the sequence.
+   *
+   * @param observation Next observation.
+   * @return Log-likelihood of the observation given the previous ones.
+   */
+  double Update(const arma::vec& observation);
+
+  /**
+   * Add the given observation of an HMMRegression to the sequence.
+   *
+   * @param predictors Predictors of the next observation.
+   * @param response Response of the next observation.
+   * @return Log-likelihood of the observation given the previous ones.
+   */
+  double Update(const arma::vec& predictors, const double response);
+
+  /**
+   * Add each of the given observations (one per column) to the sequence, in
+   * order.  The emission probabilities of the batch are computed with one
+   * call per state.
+   *
+   * @param observations Next observations.
+   * @return Log-likelihood of the observations given the previous ones.
+   */
+  double UpdateBatch(const arma::mat& observations);
+
+  /**
+   * Compute the probability of each hidden state the given number of steps
+   * after the last observation, given all the observations.
+   *
+   * @param stateProb Vector to store the state probabilities in.
+   * @param ahead Number of steps to look ahead (0 gives the probabilities of
+   *     the current state).
+   */
+  void PredictStates(arma::vec& stateProb, const size_t ahead = 0) const;
+
+  /**
+   * Compute the expected emission the given number of steps after the last
+   * observation, given all the observations.  This requires that the emission
+   * distributions have a Mean() function.
+   *
+   * @param expected Vector to store the expected emission in.
+   * @param ahead Number of steps to look ahead.
+   */
+  void ExpectedEmission(arma::vec& expected, const size_t ahead = 0) const;
+
+  //! Get the probability of each hidden state at the last observation.
+  const arma::vec& StateProbabilities() const { return forward; }
+
+  //! Get the log-likelihood of all the observations so far.
+  double LogLikelihood() const { return logLikelihood; }
+
+  //! Get the number of observations so far.
+  size_t NumObservations() const { return numObservations; }
+
+ private:
+  //! Advance the filter given the emission log probability of each state for
+  //! the next observation, which must be stored in logEmission.
+  double Step();
+
+  //! The HMM.
+  const HMMType& hmm;
+
+  //! Normalized forward probabilities of the last observation.
+  arma::vec forward;
+
+  //! Buffer for the predicted state probabilities of the next observation.
+  arma::vec predicted;
+
+  //! Buffer for the emission log probabilities of the next observation.
+  arma::vec logEmission;
+
+  //! Buffer for a stacked HMMRegression observation.
+  arma::vec stacked;
+
+  //! Log-likelihood of all the observations so far.
+  double logLikelihood;
+
+  //! Number of observations so far.
+  size_t numObservations;
+};
+
+} // namespace hmm
+} // namespace mlpack
+
+// Include implementation.
+#include "hmm_online_filter_impl.hpp"
+
+#endif
@@ -0,0 +1,166 @@
+/**
+ * @file hmm_online_filter_impl.hpp
+ *
+ * Implementation of HMMOnlineFilter.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_HMM_HMM_ONLINE_FILTER_IMPL_HPP
+#define MLPACK_METHODS_HMM_HMM_ONLINE_FILTER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "hmm_online_filter.hpp"
+
+namespace mlpack {
+namespace hmm {
+
+template<typename HMMType>
+HMMOnlineFilter<HMMType>::HMMOnlineFilter(const HMMType& hmm) :
+    hmm(hmm),
+    forward(hmm.Transition().n_rows),
+    predicted(hmm.Transition().n_rows),
+    logEmission(hmm.Transition().n_rows),
+    stacked(hmm.Dimensionality()),
+    logLikelihood(0.0),
+    numObservations(0)
+{
+  Reset();
+}
+
+template<typename HMMType>
+void HMMOnlineFilter<HMMType>::Reset()
+{
+  // Before any observation, the state probabilities are the initial ones.
+  forward = hmm.Initial();
+  logLikelihood = 0.0;
+  numObservations = 0;
+}
+
+template<typename HMMType>
+double HMMOnlineFilter<HMMType>::Update(const arma::vec& observation)
+{
+  if (observation.n_elem != hmm.Dimensionality())
+  {
+    std::ostringstream oss;
+    oss << "HMMOnlineFilter::Update(): observation has dimensionality "
+        << observation.n_elem << " (expected " << hmm.Dimensionality()
+        << " dimensions)";
+    throw std::invalid_argument(oss.str());
+  }
+
+  for (size_t state = 0; state < logEmission.n_elem; ++state)
+    logEmission[state] = hmm.Emission()[state].LogProbability(observation);
+
+  return Step();
+}
+
+template<typename HMMType>
+double HMMOnlineFilter<HMMType>::Update(const arma::vec& predictors,
+                                        const double response)
+{
+  // HMMRegression stacks the response on top of the predictors.
+  if (predictors.n_elem + 1 != stacked.n_elem)
+  {
+    std::ostringstream oss;
+    oss << "HMMOnlineFilter::Update(): predictors have dimensionality "
+        << predictors.n_elem << " (expected " << stacked.n_elem - 1
+        << " dimensions)";
+    throw std::invalid_argument(oss.str());
+  }
+
+  stacked[0] = response;
+  stacked.subvec(1, stacked.n_elem - 1) = predictors;
+  return Update(stacked);
+}
+
+template<typename HMMType>
+double HMMOnlineFilter<HMMType>::UpdateBatch(const arma::mat& observations)
+{
+  if (observations.n_rows != hmm.Dimensionality())
+  {
+    std::ostringstream oss;
+    oss << "HMMOnlineFilter::UpdateBatch(): observations have dimensionality "
+        << observations.n_rows << " (expected " << hmm.Dimensionality()
+        << " dimensions)";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // One row per state, one column per observation.
+  arma::mat logEmissions(logEmission.n_elem, observations.n_cols);
+  arma::vec logProbs;
+  for (size_t state = 0; state < logEmission.n_elem; ++state)
+  {
+    hmm.Emission()[state].LogProbability(observations, logProbs);
+    logEmissions.row(state) = trans(logProbs);
+  }
+
+  double batchLogLikelihood = 0.0;
+  for (size_t i = 0; i < observations.n_cols; ++i)
+  {
+    logEmission = logEmissions.col(i);
+    batchLogLikelihood += Step();
+  }
+
+  return batchLogLikelihood;
+}
+
+template<typename HMMType>
+double HMMOnlineFilter<HMMType>::Step()
+{
+  // The first observation uses the initial state probabilities; the others
+  // propagate the last forward probabilities through the transition matrix.
+  if (numObservations == 0)
+    predicted = hmm.Initial();
+  else
+    predicted = hmm.Transition() * forward;
+
+  // Combine with the emission probabilities in log-space, so that an
+  // observation that is very unlikely under every state does not underflow,
+  // and normalize.  This is the same computation as HMM::Forward().
+  logEmission += arma::log(predicted);
+  const double shift = logEmission.max();
+  double logScale = shift;
+  if (std::isfinite(shift))
+  {
+    logScale += std::log(arma::accu(arma::exp(logEmission - shift)));
+    forward = arma::exp(logEmission - logScale);
+  }
+  else
+  {
+    forward.zeros();
+  }
+
+  logLikelihood += logScale;
+  ++numObservations;
+  return logScale;
+}
+
+template<typename HMMType>
+void HMMOnlineFilter<HMMType>::PredictStates(arma::vec& stateProb,
+                                             const size_t ahead) const
+{
+  stateProb = forward;
+  for (size_t i = 0; i < ahead; ++i)
+    stateProb = hmm.Transition() * stateProb;
+}
+
+template<typename HMMType>
+void HMMOnlineFilter<HMMType>::ExpectedEmission(arma::vec& expected,
+                                                const size_t ahead) const
+{
+  arma::vec stateProb;
+  PredictStates(stateProb, ahead);
+
+  // Will not work for distributions without a Mean() function.
+  expected.zeros(hmm.Dimensionality());
+  for (size_t i = 0; i < hmm.Emission().size(); ++i)
+    expected += stateProb[i] * hmm.Emission()[i].Mean();
+}
+
+} // namespace hmm
+} // namespace mlpack
+
+#endif
@@ -42,6 +42,12 @@ PROGRAM_INFO("Hidden Markov Model (HMM) Viterbi State Prediction",
     "computed state sequence may be saved using the " +
     PRINT_PARAM_STRING("output") + " output parameter."
     "\n\n"
+    "For models with many hidden states, the search can be restricted to the "
+    "most probable states at each time step with the " +
+    PRINT_PARAM_STRING("beam_width") + " parameter; this is much faster, but "
+    "the returned sequence may not be the most probable one if the beam is too "
+    "narrow.  The default, 0, searches all states."
+    "\n\n"
     "For example, to predict the state sequence of the observations " +
     PRINT_DATASET("obs") + " using the HMM " + PRINT_MODEL("hmm") + ", "
     "storing the predicted state sequence to " + PRINT_DATASET("states") +
@@ -60,6 +66,8 @@ PROGRAM_INFO("Hidden Markov Model (HMM) Viterbi State Prediction",
 PARAM_MATRIX_IN_REQ("input", "Matrix containing observations,", "i");
 PARAM_MODEL_IN_REQ(HMMModel, "input_model", "Trained HMM to use.", "m");
 PARAM_UMATRIX_OUT("output", "File to save predicted state sequence to.", "o");
+PARAM_INT_IN("beam_width", "Number of most probable states to keep at each "
+    "time step (0 keeps all states).", "b", 0);
 
 // Because we don't know what the type of our HMM is, we need to write a
 // function that can take arbitrary HMM types.
@@ -88,7 +96,8 @@ struct Viterbi
     }
 
     arma::Row<size_t> sequence;
-    hmm.Predict(dataSeq, sequence);
+    hmm.Predict(dataSeq, sequence,
+        (size_t) CLI::GetParam<int>("beam_width"));
 
     // Save output.
     CLI::GetParam<arma::Mat<size_t>>("output") = std::move(sequence);
@@ -98,6 +107,8 @@ struct Viterbi
 static void mlpackMain()
 {
   RequireAtLeastOnePassed({ "output" }, false, "no results will be saved");
+  RequireParamValue<int>("beam_width", [](int x) { return x >= 0; }, true,
+      "beam width must be non-negative");
 
   CLI::GetParam<HMMModel*>("input_model")->PerformAction<Viterbi>((void*) NULL);
 }
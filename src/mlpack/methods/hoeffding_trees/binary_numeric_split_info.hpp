@@ -32,6 +32,9 @@ class BinaryNumericSplitInfo
     return (value < splitPoint) ? 0 : 1;
   }
 
+  //! Get the split point.
+  ObservationType SplitPoint() const { return splitPoint; }
+
   //! Serialize the split (save/load the split points).
   template<typename Archive>
   void serialize(Archive& ar, const unsigned int /* version */)
@@ -0,0 +1,218 @@
+/**
+ * @file flat_hoeffding_tree.hpp
+ *
+ * A read-only Hoeffding tree stored in a single array of nodes, for fast
+ * classification with a tree exported from a HoeffdingTree.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_HOEFFDING_TREES_FLAT_HOEFFDING_TREE_HPP
+#define MLPACK_METHODS_HOEFFDING_TREES_FLAT_HOEFFDING_TREE_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "numeric_split_info.hpp"
+#include "binary_numeric_split_info.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * FlatHoeffdingTree is a snapshot of a trained HoeffdingTree, made with
+ * HoeffdingTree::Flatten(), that can only classify points.  Instead of a tree
+ * of HoeffdingTree objects, each holding the split objects used for training,
+ * the nodes are stored in one array in breadth-first order, with the children
+ * of each node next to each other, and the split points of all numeric splits
+ * are stored in another array.  So classifying a point only walks down a few
+ * small nodes, and the batch Classify() functions classify the points in
+ * parallel.
+ *
+ * The HoeffdingTree it was made from can keep training; the snapshot does not
+ * change, and a new one can be made with Flatten() whenever the model should
+ * be updated.  The predictions of the snapshot are exactly those of the
+ * HoeffdingTree at the time it was made.
+ */
+class FlatHoeffdingTree
+{
+ public:
+  //! The ways a node can direct a point to its children.
+  enum SplitType
+  {
+    //! The node is a leaf.
+    LEAF,
+    //! Each child is a category of the split dimension.
+    CATEGORICAL,
+    //! The child is the number of leading split points that the value is
+    //! greater than (as with NumericSplitInfo).
+    NUMERIC,
+    //! The second child is taken if the value is not less than the one split
+    //! point (as with BinaryNumericSplitInfo).
+    BINARY_NUMERIC
+  };
+
+  //! A node of the flattened tree.
+  struct Node
+  {
+    //! The dimension the node splits on.
+    size_t splitDimension;
+    //! The index of the first child; the others follow it.
+    size_t firstChild;
+    //! The index of the first split point of the node in SplitPoints().
+    size_t splitBegin;
+    //! The number of split points of the node.
+    uint32_t numSplitPoints;
+    //! How the node splits (a SplitType).
+    uint32_t splitType;
+    //! The majority class of the node.
+    size_t majorityClass;
+    //! The probability of the majority class of the node.
+    double majorityProbability;
+
+    //! Serialize the node.
+    template<typename Archive>
+    void serialize(Archive& ar, const unsigned int /* version */)
+    {
+      ar & BOOST_SERIALIZATION_NVP(splitDimension);
+      ar & BOOST_SERIALIZATION_NVP(firstChild);
+      ar & BOOST_SERIALIZATION_NVP(splitBegin);
+      ar & BOOST_SERIALIZATION_NVP(numSplitPoints);
+      ar & BOOST_SERIALIZATION_NVP(splitType);
+      ar & BOOST_SERIALIZATION_NVP(majorityClass);
+      ar & BOOST_SERIALIZATION_NVP(majorityProbability);
+    }
+  };
+
+  //! Create an empty tree.  Don't call Classify() until it is loaded or
+  //! assigned from HoeffdingTree::Flatten()!
+  FlatHoeffdingTree() { }
+
+  /**
+   * Create the tree from the given nodes (with the root first) and split
+   * points.  Use HoeffdingTree::Flatten() instead of calling this directly.
+   *
+   * @param nodes Nodes of the tree.
+   * @param splitPoints Split points of the numeric splits.
+   */
+  FlatHoeffdingTree(std::vector<Node> nodes, arma::vec splitPoints) :
+      nodes(std::move(nodes)), splitPoints(std::move(splitPoints)) { }
+
+  /**
+   * Find the index of the leaf the given point falls into.
+   *
+   * @param point Point to find the leaf of.
+   */
+  template<typename VecType>
+  size_t Leaf(const VecType& point) const;
+
+  /**
+   * Classify the given point.
+   *
+   * @param point Point to classify.
+   * @return Predicted label of point.
+   */
+  template<typename VecType>
+  size_t Classify(const VecType& point) const
+  {
+    return nodes[Leaf(point)].majorityClass;
+  }
+
+  /**
+   * Classify the given point and also return an estimate of the probability
+   * that the prediction is correct (the probability of the majority class in
+   * the leaf, as with HoeffdingTree).
+   *
+   * @param point Point to classify.
+   * @param prediction Predicted label of point.
+   * @param probability An estimate of the probability that the prediction is
+   *     correct.
+   */
+  template<typename VecType>
+  void Classify(const VecType& point,
+                size_t& prediction,
+                double& probability) const
+  {
+    const Node& leaf = nodes[Leaf(point)];
+    prediction = leaf.majorityClass;
+    probability = leaf.majorityProbability;
+  }
+
+  /**
+   * Classify the given points, with the points split between all available
+   * threads.
+   *
+   * @param data Points to classify.
+   * @param predictions Predicted labels for each point.
+   */
+  template<typename MatType>
+  void Classify(const MatType& data, arma::Row<size_t>& predictions) const;
+
+  /**
+   * Classify the given points and also return estimates of the probabilities
+   * that the predictions are correct, with the points split between all
+   * available threads.
+   *
+   * @param data Points to classify.
+   * @param predictions Predicted labels for each point.
+   * @param probabilities Probability estimates for each predicted label.
+   */
+  template<typename MatType>
+  void Classify(const MatType& data,
+                arma::Row<size_t>& predictions,
+                arma::rowvec& probabilities) const;
+
+  //! Get the number of nodes.
+  size_t NumNodes() const { return nodes.size(); }
+  //! Get the nodes.
+  const std::vector<Node>& Nodes() const { return nodes; }
+  //! Get the split points of the numeric splits.
+  const arma::vec& SplitPoints() const { return splitPoints; }
+
+  //! Serialize the tree.
+  template<typename Archive>
+  void serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & BOOST_SERIALIZATION_NVP(nodes);
+    ar & BOOST_SERIALIZATION_NVP(splitPoints);
+  }
+
+ private:
+  //! The nodes, in breadth-first order.
+  std::vector<Node> nodes;
+  //! The split points of all numeric splits.
+  arma::vec splitPoints;
+};
+
+/**
+ * Append the split points of the given numeric split to the given list, and
+ * return the type of the split.  A numeric split type must provide an overload
+ * of this function for its SplitInfo to be used with FlatHoeffdingTree.
+ */
+template<typename ObservationType>
+FlatHoeffdingTree::SplitType FlattenSplit(
+    const NumericSplitInfo<ObservationType>& split,
+    std::vector<double>& splitPoints)
+{
+  for (size_t i = 0; i < split.SplitPoints().n_elem; ++i)
+    splitPoints.push_back(split.SplitPoints()[i]);
+  return FlatHoeffdingTree::NUMERIC;
+}
+
+//! Append the split point of the given binary numeric split to the given list.
+template<typename ObservationType>
+FlatHoeffdingTree::SplitType FlattenSplit(
+    const BinaryNumericSplitInfo<ObservationType>& split,
+    std::vector<double>& splitPoints)
+{
+  splitPoints.push_back(split.SplitPoint());
+  return FlatHoeffdingTree::BINARY_NUMERIC;
+}
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "flat_hoeffding_tree_impl.hpp"
+
+#endif
@@ -0,0 +1,80 @@
+/**
+ * @file flat_hoeffding_tree_impl.hpp
+ *
+ * Implementation of classification with FlatHoeffdingTree.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_HOEFFDING_TREES_FLAT_HOEFFDING_TREE_IMPL_HPP
+#define MLPACK_METHODS_HOEFFDING_TREES_FLAT_HOEFFDING_TREE_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "flat_hoeffding_tree.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename VecType>
+size_t FlatHoeffdingTree::Leaf(const VecType& point) const
+{
+  size_t index = 0;
+  while (nodes[index].splitType != LEAF)
+  {
+    const Node& node = nodes[index];
+    const double value = point[node.splitDimension];
+
+    // These are the same as CalculateDirection() of the split information
+    // objects.
+    size_t direction = 0;
+    if (node.splitType == CATEGORICAL)
+    {
+      direction = size_t(value);
+    }
+    else if (node.splitType == NUMERIC)
+    {
+      const double* points = splitPoints.memptr() + node.splitBegin;
+      while (direction < node.numSplitPoints && value > points[direction])
+        ++direction;
+    }
+    else
+    {
+      direction = (value < splitPoints[node.splitBegin]) ? 0 : 1;
+    }
+
+    index = node.firstChild + direction;
+  }
+
+  return index;
+}
+
+template<typename MatType>
+void FlatHoeffdingTree::Classify(const MatType& data,
+                                 arma::Row<size_t>& predictions) const
+{
+  predictions.set_size(data.n_cols);
+
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
+    predictions[i] = Classify(data.col(i));
+}
+
+template<typename MatType>
+void FlatHoeffdingTree::Classify(const MatType& data,
+                                 arma::Row<size_t>& predictions,
+                                 arma::rowvec& probabilities) const
+{
+  predictions.set_size(data.n_cols);
+  probabilities.set_size(data.n_cols);
+
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
+    Classify(data.col(i), predictions[i], probabilities[i]);
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -15,9 +15,13 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/data/dataset_mapper.hpp>
+#include <mlpack/core/data/stream_reader.hpp>
+#include <atomic>
+#include <mutex>
 #include "gini_impurity.hpp"
 #include "hoeffding_numeric_split.hpp"
 #include "hoeffding_categorical_split.hpp"
+#include "flat_hoeffding_tree.hpp"
 
 namespace mlpack {
 namespace tree {
@@ -186,6 +190,41 @@ class HoeffdingTree
   template<typename VecType>
   void Train(const VecType& point, const size_t label);
 
+  /**
+   * Train in streaming mode on every remaining point of the given stream, one
+   * chunk at a time.  The last dimension of each point is its label.  If
+   * parallel is true, each chunk is trained on with ParallelTrain().
+   *
+   * @param reader Stream to read points and labels from.
+   * @param parallel Whether to train on each chunk with several threads.
+   */
+  void Train(data::StreamReader& reader, const bool parallel = false);
+
+  /**
+   * Train on a set of points in streaming mode, using multiple threads if
+   * OpenMP is available.  Each point is passed down the tree to a leaf, and
+   * only that leaf is locked while it is trained (and split, if a split check
+   * succeeds), so points that reach different leaves are processed at the
+   * same time.  Since the points are not seen in order, the tree may differ
+   * from the tree that Train() would build with batchTraining = false.
+   *
+   * @param data Data points to train on.
+   * @param labels Labels of data points.
+   */
+  template<typename MatType>
+  void ParallelTrain(const MatType& data, const arma::Row<size_t>& labels);
+
+  /**
+   * Train on a single point in streaming mode, with the given label.  Unlike
+   * Train(), this may be called from several threads at the same time, as
+   * long as nothing else uses the tree while they do.
+   *
+   * @param point Point to train on.
+   * @param label Label of point to train on.
+   */
+  template<typename VecType>
+  void ParallelTrain(const VecType& point, const size_t label);
+
   /**
    * Check if a split would satisfy the conditions of the Hoeffding bound with
    * the node's specified success probability.  If so, the number of children
@@ -298,6 +337,17 @@ class HoeffdingTree
                 arma::Row<size_t>& predictions,
                 arma::rowvec& probabilities) const;
 
+  /**
+   * Export the tree (this node and the entire (sub)tree beneath it) into a
+   * FlatHoeffdingTree, which is faster for classification and classifies
+   * batches of points in parallel.  This tree is not modified and can keep
+   * training.  The numeric split type must have an overload of
+   * FlattenSplit() for its SplitInfo.
+   *
+   * @return The flattened tree.
+   */
+  FlatHoeffdingTree Flatten() const;
+
   /**
    * Given that this node should split, create the children.
    */
@@ -352,6 +402,16 @@ class HoeffdingTree
   typename NumericSplitType<FitnessFunction>::SplitInfo numericSplit;
   //! If the split has occurred, these are the children.
   std::vector<HoeffdingTree*> children;
+
+  //! Whether the node has split and its children have been created.  Once this
+  //! is set, ParallelTrain() passes points to the children without locking.
+  std::atomic<bool> isSplit;
+  //! The lock held by ParallelTrain() while the node is trained as a leaf.
+  std::mutex nodeMutex;
+
+  //! The number of consecutive points given to a thread at a time by
+  //! ParallelTrain().
+  static const size_t ParallelChunkSize = 256;
 };
 
 } // namespace tree
@@ -14,6 +14,7 @@
 
 // In case it hasn't been included yet.
 #include "hoeffding_tree.hpp"
+#include <queue>
 #include <stack>
 
 namespace mlpack {
@@ -54,7 +55,8 @@ HoeffdingTree<
     majorityClass(0),
     majorityProbability(0.0),
     categoricalSplit(0),
-    numericSplit()
+    numericSplit(),
+    isSplit(false)
 {
   // Generate dimension mappings and create split objects.
   for (size_t i = 0; i < datasetInfo.Dimensionality(); ++i)
@@ -112,7 +114,8 @@ HoeffdingTree<
     majorityClass(0),
     majorityProbability(0.0),
     categoricalSplit(0),
-    numericSplit()
+    numericSplit(),
+    isSplit(false)
 {
   // Do we need to generate the mappings too?
   if (ownsMappings)
@@ -176,7 +179,8 @@ HoeffdingTree<
     majorityClass(0),
     majorityProbability(0.0),
     categoricalSplit(0),
-    numericSplit()
+    numericSplit(),
+    isSplit(false)
 {
   // Nothing to do.
 }
@@ -204,7 +208,8 @@ HoeffdingTree<FitnessFunction, NumericSplitType, CategoricalSplitType>::
     majorityClass(other.majorityClass),
     majorityProbability(other.majorityProbability),
     categoricalSplit(other.categoricalSplit),
-    numericSplit(other.numericSplit)
+    numericSplit(other.numericSplit),
+    isSplit(other.splitDimension != size_t(-1))
 {
   // Copy each of the children.
   for (size_t i = 0; i < other.children.size(); ++i)
@@ -359,6 +364,33 @@ void HoeffdingTree<
   Train(data, labels, batchTraining);
 }
 
+//! Train on a stream of points.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType>
+void HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::Train(data::StreamReader& reader, const bool parallel)
+{
+  arma::mat chunk;
+  while (reader.Next(chunk))
+  {
+    if (chunk.n_rows < 2)
+      throw std::runtime_error("HoeffdingTree::Train(): each point of '" +
+          reader.Filename() + "' must hold at least one dimension and a label");
+
+    const arma::mat points = chunk.rows(0, chunk.n_rows - 2);
+    const arma::Row<size_t> labels = arma::conv_to<arma::Row<size_t>>::from(
+        chunk.row(chunk.n_rows - 1));
+    if (parallel)
+      ParallelTrain(points, labels);
+    else
+      Train(points, labels, false);
+  }
+}
+
 //! Train on one point.
 template<typename FitnessFunction,
          template<typename> class NumericSplitType,
@@ -416,6 +448,62 @@ void HoeffdingTree<
   }
 }
 
+//! Train on a set of points with multiple threads.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType>
+template<typename MatType>
+void HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::ParallelTrain(const MatType& data, const arma::Row<size_t>& labels)
+{
+  #pragma omp parallel for schedule(static, ParallelChunkSize)
+  for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
+    ParallelTrain(data.col(i), labels[i]);
+}
+
+//! Train on one point, possibly at the same time as other threads.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType>
+template<typename VecType>
+void HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::ParallelTrain(const VecType& point, const size_t label)
+{
+  HoeffdingTree* node = this;
+  while (true)
+  {
+    // The split and the children of a node never change once the node has
+    // split, so they can be read without holding the lock.
+    if (node->isSplit.load(std::memory_order_acquire))
+    {
+      node = node->children[node->CalculateDirection(point)];
+      continue;
+    }
+
+    HoeffdingTree* child;
+    {
+      std::lock_guard<std::mutex> lock(node->nodeMutex);
+
+      // Another thread may have split the node while we were waiting for the
+      // lock; if not, this is the leaf to train.
+      if (node->splitDimension == size_t(-1))
+      {
+        node->Train(point, label);
+        return;
+      }
+
+      child = node->children[node->CalculateDirection(point)];
+    }
+    node = child;
+  }
+}
+
 template<typename FitnessFunction,
          template<typename> class NumericSplitType,
          template<typename> class CategoricalSplitType>
@@ -705,6 +793,61 @@ void HoeffdingTree<
     Classify(data.col(i), predictions[i], probabilities[i]);
 }
 
+//! Export the tree to a FlatHoeffdingTree.
+template<
+    typename FitnessFunction,
+    template<typename> class NumericSplitType,
+    template<typename> class CategoricalSplitType
+>
+FlatHoeffdingTree HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::Flatten() const
+{
+  std::vector<FlatHoeffdingTree::Node> nodes;
+  std::vector<double> splitPoints;
+
+  // Visit the nodes breadth-first, so that the children of each node get
+  // consecutive indices, after those of all the nodes already in the queue.
+  std::queue<const HoeffdingTree*> queue;
+  queue.push(this);
+  while (!queue.empty())
+  {
+    const HoeffdingTree* node = queue.front();
+    queue.pop();
+
+    FlatHoeffdingTree::Node flatNode;
+    flatNode.splitDimension = node->splitDimension;
+    flatNode.firstChild = nodes.size() + queue.size() + 1;
+    flatNode.splitBegin = splitPoints.size();
+    flatNode.numSplitPoints = 0;
+    flatNode.majorityClass = node->majorityClass;
+    flatNode.majorityProbability = node->majorityProbability;
+
+    if (node->children.size() == 0)
+    {
+      flatNode.splitType = FlatHoeffdingTree::LEAF;
+    }
+    else if (node->datasetInfo->Type(node->splitDimension) ==
+        data::Datatype::categorical)
+    {
+      flatNode.splitType = FlatHoeffdingTree::CATEGORICAL;
+    }
+    else
+    {
+      flatNode.splitType = FlattenSplit(node->numericSplit, splitPoints);
+      flatNode.numSplitPoints = splitPoints.size() - flatNode.splitBegin;
+    }
+    nodes.push_back(flatNode);
+
+    for (size_t i = 0; i < node->children.size(); ++i)
+      queue.push(node->children[i]);
+  }
+
+  return FlatHoeffdingTree(std::move(nodes), arma::vec(splitPoints));
+}
+
 template<
     typename FitnessFunction,
     template<typename> class NumericSplitType,
@@ -768,6 +911,10 @@ void HoeffdingTree<
   // Eliminate now-unnecessary split information.
   numericSplits.clear();
   categoricalSplits.clear();
+
+  // The children are ready, so ParallelTrain() may now pass points to them
+  // without locking this node.
+  isSplit.store(true, std::memory_order_release);
 }
 
 template<
@@ -808,6 +955,9 @@ void HoeffdingTree<
     for (size_t i = 0; i < children.size(); ++i)
       delete children[i];
     children.clear();
+
+    // If we have split, the children are loaded below.
+    isSplit = (splitDimension != size_t(-1));
   }
 
   ar & BOOST_SERIALIZATION_NVP(majorityClass);
@@ -49,6 +49,9 @@ PROGRAM_INFO("Hoeffding trees",
     "(like a typical decision tree algorithm) by specifying the " +
     PRINT_PARAM_STRING("batch_mode") + " option, but this may not be the best "
     "option for large datasets."
+    "  When training is not performed in batch mode, the " +
+    PRINT_PARAM_STRING("parallel") + " option may be specified to process the "
+    "training points with several threads at once."
     "\n\n"
     "When a model is trained, it may be saved via the " +
     PRINT_PARAM_STRING("output_model") + " output parameter.  A model may be "
@@ -115,6 +118,9 @@ PARAM_FLAG("batch_mode", "If true, samples will be considered in batch instead "
 PARAM_FLAG("info_gain", "If set, information gain is used instead of Gini "
     "impurity for calculating Hoeffding bounds.", "i");
 PARAM_INT_IN("passes", "Number of passes to take over the dataset.", "s", 1);
+PARAM_FLAG("parallel", "If true, streaming training points are processed by "
+    "several threads at once.  The resulting tree may differ from run to run.",
+    "j");
 
 PARAM_INT_IN("bins", "If the 'domingos' split strategy is used, this specifies "
     "the number of bins for each numeric split.", "B", 10);
@@ -141,6 +147,7 @@ static void mlpackMain()
 
   ReportIgnoredParam({{ "training", false }}, "batch_mode");
   ReportIgnoredParam({{ "training", false }}, "passes");
+  ReportIgnoredParam({{ "training", false }}, "parallel");
 
   if (CLI::HasParam("test"))
   {
@@ -187,6 +194,7 @@ static void mlpackMain()
     size_t passes = (size_t) CLI::GetParam<int>("passes");
     if (passes > 1)
       batchTraining = false; // We already warned about this earlier.
+    const bool parallel = CLI::HasParam("parallel") && !batchTraining;
 
     // We need to train the model.  First, load the data.
     datasetInfo = std::move(std::get<0>(CLI::GetParam<TupleType>("training")));
@@ -218,11 +226,21 @@ static void mlpackMain()
     // Do we need to initialize a model?
     if (!CLI::HasParam("input_model"))
     {
-      // Build the model.
-      model->BuildModel(trainingSet, datasetInfo, labels,
-          arma::max(labels) + 1, batchTraining, confidence, maxSamples,
-          100, minSamples, bins, observationsBeforeBinning);
-      --passes; // This model-building takes one pass.
+      // Build the model.  In parallel mode, the model is built without any
+      // points, and all the passes are taken below.
+      if (parallel)
+      {
+        model->BuildModel(arma::mat(trainingSet.n_rows, 0), datasetInfo,
+            arma::Row<size_t>(), arma::max(labels) + 1, false, confidence,
+            maxSamples, 100, minSamples, bins, observationsBeforeBinning);
+      }
+      else
+      {
+        model->BuildModel(trainingSet, datasetInfo, labels,
+            arma::max(labels) + 1, batchTraining, confidence, maxSamples,
+            100, minSamples, bins, observationsBeforeBinning);
+        --passes; // This model-building takes one pass.
+      }
     }
 
     // Now pass over the trees as many times as we need to.
@@ -236,7 +254,7 @@ static void mlpackMain()
     else
     {
       for (size_t p = 0; p < passes; ++p)
-        model->Train(trainingSet, labels, false);
+        model->Train(trainingSet, labels, false, parallel);
     }
 
     Timer::Stop("tree_training");
@@ -181,8 +181,33 @@ void HoeffdingTreeModel::BuildModel(
 // Train the model on one pass of the dataset.
 void HoeffdingTreeModel::Train(const arma::mat& dataset,
                                const arma::Row<size_t>& labels,
-                               const bool batchTraining)
+                               const bool batchTraining,
+                               const bool parallel)
 {
+  if (parallel && !batchTraining)
+  {
+    switch (type)
+    {
+      case GINI_HOEFFDING:
+        giniHoeffdingTree->ParallelTrain(dataset, labels);
+        break;
+
+      case GINI_BINARY:
+        giniBinaryTree->ParallelTrain(dataset, labels);
+        break;
+
+      case INFO_HOEFFDING:
+        infoHoeffdingTree->ParallelTrain(dataset, labels);
+        break;
+
+      case INFO_BINARY:
+        infoBinaryTree->ParallelTrain(dataset, labels);
+        break;
+    }
+
+    return;
+  }
+
   // Depending on the type, pass through once.
   switch (type)
   {
@@ -130,10 +130,13 @@ class HoeffdingTreeModel
    * @param dataset Dataset to train on.
    * @param labels Labels for training set.
    * @param batchTraining Whether or not to train in batch.
+   * @param parallel If true and batchTraining is false, points are trained on
+   *      in parallel (see HoeffdingTree::ParallelTrain()).
    */
   void Train(const arma::mat& dataset,
              const arma::Row<size_t>& labels,
-             const bool batchTraining);
+             const bool batchTraining,
+             const bool parallel = false);
 
   /**
    * Using the model, classify the given test points.  Be sure that BuildModel()
@@ -36,6 +36,9 @@ class NumericSplitInfo
     return bin;
   }
 
+  //! Get the split points.
+  const arma::Col<ObservationType>& SplitPoints() const { return splitPoints; }
+
   //! Serialize the split (save/load the split points).
   template<typename Archive>
   void serialize(Archive& ar, const unsigned int /* version */)
@@ -0,0 +1,183 @@
+/**
+ * @file quantile_numeric_split.hpp
+ *
+ * A numeric splitting procedure for Hoeffding trees that keeps a quantile
+ * sketch of the points it has seen, so that it uses bounded memory.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_HOEFFDING_TREES_QUANTILE_NUMERIC_SPLIT_HPP
+#define MLPACK_METHODS_HOEFFDING_TREES_QUANTILE_NUMERIC_SPLIT_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
+#include "binary_numeric_split_info.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The QuantileNumericSplit class is a binary numeric splitting procedure that,
+ * like the BinaryNumericSplit, searches for the best split point among the
+ * values it has seen, but only keeps a KLL quantile sketch of the (value,
+ * label) pairs instead of every pair.  The sketch is described in the
+ * following paper:
+ *
+ * @code
+ * @inproceedings{karnin2016optimal,
+ *    title={Optimal Quantile Approximation in Streams},
+ *    author={Karnin, Z. and Lang, K. and Liberty, E.},
+ *    year={2016},
+ *    booktitle={Proceedings of the 57th Annual IEEE Symposium on Foundations
+ *        of Computer Science (FOCS '16)},
+ *    pages={71--78}
+ * }
+ * @endcode
+ *
+ * The sketch is a stack of compactors; a pair kept by the compactor at level h
+ * stands for 2^h observed pairs.  When the sketch is full, the lowest full
+ * compactor is sorted and every other pair in it (starting at a random offset)
+ * is promoted to the next level, while the rest are dropped.  The capacity of
+ * compactor h is about sketchSize * (2/3)^(H - 1 - h), for H compactors, so at
+ * most about 3 * sketchSize + 2 log(n) pairs are kept after n observations,
+ * and the number of points on either side of a split point is estimated with
+ * an error of about n / sketchSize.  Train() takes O(log sketchSize) amortized
+ * time, and EvaluateFitnessFunction() takes time linear in the size of the
+ * sketch, not in the number of points seen.
+ *
+ * Sketches of the same dimension can be combined with Merge(), so a stream may
+ * be summarized in pieces.
+ *
+ * @tparam FitnessFunction Fitness function to use for calculating gain.
+ * @tparam ObservationType Type of observation used by this dimension.
+ */
+template<typename FitnessFunction,
+         typename ObservationType = double>
+class QuantileNumericSplit
+{
+ public:
+  //! The splitting information required by the QuantileNumericSplit.
+  typedef BinaryNumericSplitInfo<ObservationType> SplitInfo;
+
+  /**
+   * Create the QuantileNumericSplit object with the given number of classes.
+   *
+   * @param numClasses Number of classes in dataset.
+   * @param sketchSize Capacity of the largest compactor of the sketch; larger
+   *      values give more accurate splits but use more memory.
+   */
+  QuantileNumericSplit(const size_t numClasses = 0,
+                       const size_t sketchSize = 200);
+
+  /**
+   * Create the QuantileNumericSplit object with the given number of classes,
+   * using the sketch size of the given other split.
+   */
+  QuantileNumericSplit(const size_t numClasses,
+                       const QuantileNumericSplit& other);
+
+  /**
+   * Train on the given value with the given label.
+   *
+   * @param value The value to train on.
+   * @param label The label to train on.
+   */
+  void Train(ObservationType value, const size_t label);
+
+  /**
+   * Add the points summarized by the given other split (which must have the
+   * same number of classes) to this one.
+   *
+   * @param other Split to merge into this one.
+   */
+  void Merge(const QuantileNumericSplit& other);
+
+  /**
+   * Given the points seen so far, evaluate the fitness function, returning the
+   * best possible gain of a binary split in bestFitness and the second best in
+   * secondBestFitness.  Only the split points kept in the sketch are
+   * considered.
+   *
+   * @param bestFitness Fitness function value for best possible split.
+   * @param secondBestFitness Fitness function value for second best possible
+   *      split.
+   */
+  void EvaluateFitnessFunction(double& bestFitness,
+                               double& secondBestFitness);
+
+  // Return the number of children if this node were to split on this feature.
+  size_t NumChildren() const { return 2; }
+
+  /**
+   * Given that a split should happen, return the majority classes of the (two)
+   * children and an initialized SplitInfo object.
+   *
+   * @param childMajorities Majority classes of the children after the split.
+   * @param splitInfo Split information.
+   */
+  void Split(arma::Col<size_t>& childMajorities, SplitInfo& splitInfo);
+
+  //! The majority class of the points seen so far.
+  size_t MajorityClass() const;
+  //! The probability of the majority class given the points seen so far.
+  double MajorityProbability() const;
+
+  //! Get the capacity of the largest compactor.
+  size_t SketchSize() const { return sketchSize; }
+  //! Get the number of (value, label) pairs currently kept in the sketch.
+  size_t NumRetained() const { return retained; }
+
+  //! Serialize the object.
+  template<typename Archive>
+  void serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! A (value, label) pair kept by a compactor.
+  typedef std::pair<ObservationType, size_t> Item;
+  //! A pair along with the number of points it stands for.
+  typedef std::pair<Item, size_t> WeightedItem;
+
+  //! Get the capacity of the compactor at the given level.
+  size_t Capacity(const size_t level) const;
+
+  //! Compact the sketch until it holds fewer pairs than its capacity.
+  void Compress();
+
+  /**
+   * Collect the pairs of the sketch, sorted by value, and compute the number
+   * of points of each class they stand for.
+   */
+  void SortedItems(std::vector<WeightedItem>& items,
+                   arma::Col<size_t>& counts) const;
+
+  //! The compactors of the sketch, from the lowest level up.
+  std::vector<std::vector<Item>> levels;
+  //! The number of pairs kept in all the compactors.
+  size_t retained;
+  //! The capacity of the largest compactor.
+  size_t sketchSize;
+  //! The exact class counts of the points seen so far.
+  arma::Col<size_t> classCounts;
+
+  //! A cached best split point.
+  ObservationType bestSplit;
+  //! If true, the cached best split point is accurate (that is, we have not
+  //! seen any more samples since we calculated it).
+  bool isAccurate;
+};
+
+// Convenience typedef.
+template<typename FitnessFunction>
+using QuantileDoubleNumericSplit =
+    QuantileNumericSplit<FitnessFunction, double>;
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "quantile_numeric_split_impl.hpp"
+
+#endif
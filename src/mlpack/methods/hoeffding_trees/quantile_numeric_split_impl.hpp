@@ -0,0 +1,275 @@
+/**
+ * @file quantile_numeric_split_impl.hpp
+ *
+ * Implementation of the QuantileNumericSplit class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_HOEFFDING_TREES_QUANTILE_NUMERIC_SPLIT_IMPL_HPP
+#define MLPACK_METHODS_HOEFFDING_TREES_QUANTILE_NUMERIC_SPLIT_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "quantile_numeric_split.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename FitnessFunction, typename ObservationType>
+QuantileNumericSplit<FitnessFunction, ObservationType>::QuantileNumericSplit(
+    const size_t numClasses,
+    const size_t sketchSize) :
+    retained(0),
+    sketchSize(std::max(sketchSize, (size_t) 2)),
+    classCounts(numClasses),
+    bestSplit(std::numeric_limits<ObservationType>::lowest()),
+    isAccurate(true)
+{
+  // Zero out class counts.
+  classCounts.zeros();
+}
+
+template<typename FitnessFunction, typename ObservationType>
+QuantileNumericSplit<FitnessFunction, ObservationType>::QuantileNumericSplit(
+    const size_t numClasses,
+    const QuantileNumericSplit& other) :
+    retained(0),
+    sketchSize(other.sketchSize),
+    classCounts(numClasses),
+    bestSplit(std::numeric_limits<ObservationType>::lowest()),
+    isAccurate(true)
+{
+  // Zero out class counts.
+  classCounts.zeros();
+}
+
+template<typename FitnessFunction, typename ObservationType>
+void QuantileNumericSplit<FitnessFunction, ObservationType>::Train(
+    ObservationType value,
+    const size_t label)
+{
+  if (levels.empty())
+    levels.resize(1);
+
+  levels[0].push_back(Item(value, label));
+  ++retained;
+  ++classCounts[label];
+
+  // Whatever we have cached is no longer valid.
+  isAccurate = false;
+
+  Compress();
+}
+
+template<typename FitnessFunction, typename ObservationType>
+void QuantileNumericSplit<FitnessFunction, ObservationType>::Merge(
+    const QuantileNumericSplit& other)
+{
+  if (other.classCounts.n_elem != classCounts.n_elem)
+    throw std::invalid_argument("QuantileNumericSplit::Merge(): splits have "
+        "different numbers of classes");
+
+  if (levels.size() < other.levels.size())
+    levels.resize(other.levels.size());
+
+  for (size_t h = 0; h < other.levels.size(); ++h)
+    levels[h].insert(levels[h].end(), other.levels[h].begin(),
+        other.levels[h].end());
+
+  retained += other.retained;
+  classCounts += other.classCounts;
+  isAccurate = false;
+
+  Compress();
+}
+
+template<typename FitnessFunction, typename ObservationType>
+void QuantileNumericSplit<FitnessFunction, ObservationType>::
+    EvaluateFitnessFunction(double& bestFitness,
+                            double& secondBestFitness)
+{
+  bestSplit = std::numeric_limits<ObservationType>::lowest();
+
+  std::vector<WeightedItem> items;
+  arma::Col<size_t> totals;
+  SortedItems(items, totals);
+
+  // Initialize the sufficient statistics, with every point on the right.
+  arma::Mat<size_t> counts(classCounts.n_elem, 2);
+  counts.col(0).zeros();
+  counts.col(1) = totals;
+
+  bestFitness = FitnessFunction::Evaluate(counts);
+  secondBestFitness = 0.0;
+
+  for (size_t i = 0; i < items.size(); ++i)
+  {
+    // Splits can only be made between different values, and points equal to
+    // the split point go to the right.
+    const ObservationType value = items[i].first.first;
+    if (i > 0 && value != items[i - 1].first.first)
+    {
+      const double fitness = FitnessFunction::Evaluate(counts);
+      if (fitness > bestFitness)
+      {
+        secondBestFitness = bestFitness;
+        bestFitness = fitness;
+        bestSplit = value;
+      }
+      else if (fitness > secondBestFitness)
+      {
+        secondBestFitness = fitness;
+      }
+    }
+
+    // Move the points to the left side of the split.
+    const size_t label = items[i].first.second;
+    counts(label, 1) -= items[i].second;
+    counts(label, 0) += items[i].second;
+  }
+
+  isAccurate = true;
+}
+
+template<typename FitnessFunction, typename ObservationType>
+void QuantileNumericSplit<FitnessFunction, ObservationType>::Split(
+    arma::Col<size_t>& childMajorities,
+    SplitInfo& splitInfo)
+{
+  if (!isAccurate)
+  {
+    double bestGain, secondBestGain;
+    EvaluateFitnessFunction(bestGain, secondBestGain);
+  }
+
+  // Make one child for each side of the split.
+  childMajorities.set_size(2);
+
+  arma::Mat<size_t> counts(classCounts.n_elem, 2, arma::fill::zeros);
+  for (size_t h = 0; h < levels.size(); ++h)
+  {
+    for (size_t i = 0; i < levels[h].size(); ++i)
+    {
+      const Item& item = levels[h][i];
+      const size_t direction = (item.first < bestSplit) ? 0 : 1;
+      counts(item.second, direction) += (size_t(1) << h);
+    }
+  }
+
+  // Calculate the majority classes of the children.
+  arma::uword maxIndex;
+  counts.unsafe_col(0).max(maxIndex);
+  childMajorities[0] = size_t(maxIndex);
+  counts.unsafe_col(1).max(maxIndex);
+  childMajorities[1] = size_t(maxIndex);
+
+  // Create the according SplitInfo object.
+  splitInfo = SplitInfo(bestSplit);
+}
+
+template<typename FitnessFunction, typename ObservationType>
+size_t QuantileNumericSplit<FitnessFunction, ObservationType>::MajorityClass()
+    const
+{
+  arma::uword maxIndex;
+  classCounts.max(maxIndex);
+  return size_t(maxIndex);
+}
+
+template<typename FitnessFunction, typename ObservationType>
+double QuantileNumericSplit<FitnessFunction, ObservationType>::
+    MajorityProbability() const
+{
+  return double(arma::max(classCounts)) / double(arma::accu(classCounts));
+}
+
+template<typename FitnessFunction, typename ObservationType>
+size_t QuantileNumericSplit<FitnessFunction, ObservationType>::Capacity(
+    const size_t level) const
+{
+  // The top compactor holds sketchSize pairs, and each compactor below it
+  // holds 2/3 as many, but never fewer than two.
+  const size_t depth = levels.size() - 1 - level;
+  const double capacity = std::ceil(sketchSize * std::pow(2.0 / 3.0, depth));
+  return std::max((size_t) capacity, (size_t) 2);
+}
+
+template<typename FitnessFunction, typename ObservationType>
+void QuantileNumericSplit<FitnessFunction, ObservationType>::Compress()
+{
+  if (levels.empty())
+    return;
+
+  while (true)
+  {
+    size_t capacity = 0;
+    for (size_t h = 0; h < levels.size(); ++h)
+      capacity += Capacity(h);
+    if (retained < capacity)
+      return;
+
+    // Since the sketch is full, at least one compactor is full; compact the
+    // lowest one.
+    size_t h = 0;
+    while (levels[h].size() < Capacity(h))
+      ++h;
+    if (h + 1 == levels.size())
+      levels.resize(levels.size() + 1);
+
+    std::vector<Item>& level = levels[h];
+    std::sort(level.begin(), level.end());
+
+    // If there is an odd number of pairs, the largest one stays behind, so that
+    // the number of points the sketch stands for does not change.
+    const size_t end = level.size() - (level.size() % 2);
+    for (size_t i = (size_t) math::RandInt(2); i < end; i += 2)
+      levels[h + 1].push_back(level[i]);
+
+    level.erase(level.begin(), level.begin() + end);
+    retained -= end / 2;
+  }
+}
+
+template<typename FitnessFunction, typename ObservationType>
+void QuantileNumericSplit<FitnessFunction, ObservationType>::SortedItems(
+    std::vector<WeightedItem>& items,
+    arma::Col<size_t>& counts) const
+{
+  items.clear();
+  items.reserve(retained);
+  counts.zeros(classCounts.n_elem);
+  for (size_t h = 0; h < levels.size(); ++h)
+  {
+    const size_t weight = (size_t(1) << h);
+    for (size_t i = 0; i < levels[h].size(); ++i)
+    {
+      items.push_back(WeightedItem(levels[h][i], weight));
+      counts[levels[h][i].second] += weight;
+    }
+  }
+
+  std::sort(items.begin(), items.end());
+}
+
+template<typename FitnessFunction, typename ObservationType>
+template<typename Archive>
+void QuantileNumericSplit<FitnessFunction, ObservationType>::serialize(
+    Archive& ar,
+    const unsigned int /* version */)
+{
+  // Serialize.
+  ar & BOOST_SERIALIZATION_NVP(levels);
+  ar & BOOST_SERIALIZATION_NVP(retained);
+  ar & BOOST_SERIALIZATION_NVP(sketchSize);
+  ar & BOOST_SERIALIZATION_NVP(classCounts);
+
+  if (Archive::is_loading::value)
+    isAccurate = false;
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
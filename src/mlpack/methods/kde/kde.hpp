@@ -15,6 +15,8 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/tree/binary_space_tree.hpp>
+#include <mlpack/core/tree/space_filling_curve.hpp>
+#include <mlpack/core/tree/traversal_statistics.hpp>
 
 #include "kde_stat.hpp"
 
@@ -175,6 +177,39 @@ class KDE
    */
   void Evaluate(arma::vec& estimations);
 
+  /**
+   * Estimate the density of each point in the query set for each of the given
+   * bandwidths with a single traversal.  Estimations might not be normalized.
+   * The kernel of the model is not used; instead a KernelType is constructed
+   * for each bandwidth, so KernelType must have a constructor that takes the
+   * bandwidth.  Monte Carlo estimation is not used by this overload.
+   *
+   * - Use std::move if the query set is no longer needed.
+   *
+   * @pre The model has to be previously trained.
+   * @param querySet Set of query points to get the density of.
+   * @param bandwidths Bandwidths to evaluate.
+   * @param estimations Object which will hold the density of query point j for
+   *     bandwidth i in estimations(i, j).
+   */
+  void Evaluate(MatType querySet,
+                const arma::vec& bandwidths,
+                arma::mat& estimations);
+
+  /**
+   * Estimate the density of each point in the reference set for each of the
+   * given bandwidths with a single traversal, without the contribution of each
+   * point to its own estimation.  This gives the leave-one-out estimations that
+   * are used to select a bandwidth by likelihood cross-validation.
+   * Estimations might not be normalized.
+   *
+   * @pre The model has to be previously trained.
+   * @param bandwidths Bandwidths to evaluate.
+   * @param estimations Object which will hold the density of reference point j
+   *     for bandwidth i in estimations(i, j).
+   */
+  void Evaluate(const arma::vec& bandwidths, arma::mat& estimations);
+
   //! Get the kernel.
   const KernelType& Kernel() const { return kernel; }
 
@@ -214,6 +249,57 @@ class KDE
   //! Modify the mode of KDE.
   KDEMode& Mode() { return mode; }
 
+  //! Get the space-filling curve along which the query points are visited in
+  //! single-tree mode.
+  tree::SpaceFillingCurve QueryCurve() const { return queryCurve; }
+
+  //! Modify the space-filling curve along which the query points of a query
+  //! set are visited in single-tree mode (see tree::SpaceFillingCurveOrder()).
+  tree::SpaceFillingCurve& QueryCurve() { return queryCurve; }
+
+  //! Get whether Monte Carlo estimation is used.
+  bool MonteCarlo() const { return monteCarlo; }
+
+  //! Modify whether Monte Carlo estimation is used.
+  bool& MonteCarlo() { return monteCarlo; }
+
+  //! Get the probability that the Monte Carlo error bound holds.
+  double MCProb() const { return mcProb; }
+
+  //! Modify the probability that the Monte Carlo error bound holds
+  //! (0 < newProb < 1).
+  void MCProb(const double newProb);
+
+  //! Get the size of the first Monte Carlo sample.
+  size_t MCInitialSampleSize() const { return initialSampleSize; }
+
+  //! Modify the size of the first Monte Carlo sample.
+  size_t& MCInitialSampleSize() { return initialSampleSize; }
+
+  //! Get the minimum reference node size for Monte Carlo estimation, as a
+  //! multiple of the initial sample size.
+  double MCEntryCoefficient() const { return mcEntryCoef; }
+
+  //! Modify the minimum reference node size for Monte Carlo estimation
+  //! (1 <= newCoef).
+  void MCEntryCoefficient(const double newCoef);
+
+  //! Get the maximum Monte Carlo sample size, as a fraction of the reference
+  //! node size.
+  double MCBreakCoefficient() const { return mcBreakCoef; }
+
+  //! Modify the maximum Monte Carlo sample size (0 < newCoef <= 1).
+  void MCBreakCoefficient(const double newCoef);
+
+  /**
+   * Access the detailed traversal statistics of the last evaluation.  These
+   * are only collected if Statistics().Enabled() is set to true before
+   * evaluating; when they are, they are also printed to Log::Info.
+   */
+  const tree::TraversalStatistics& Statistics() const { return statistics; }
+  //! Modify the traversal statistics (i.e. to enable their collection).
+  tree::TraversalStatistics& Statistics() { return statistics; }
+
   //! Serialize the model.
   template<typename Archive>
   void serialize(Archive& ar, const unsigned int /* version */);
@@ -246,12 +332,44 @@ class KDE
   //! Mode of the KDE algorithm.
   KDEMode mode;
 
+  //! Space-filling curve along which query points are visited in single-tree
+  //! mode.
+  tree::SpaceFillingCurve queryCurve;
+
+  //! If true, node combinations may be estimated by Monte Carlo sampling.
+  bool monteCarlo;
+
+  //! Probability that the Monte Carlo error bound holds.
+  double mcProb;
+
+  //! Size of the first Monte Carlo sample.
+  size_t initialSampleSize;
+
+  //! Minimum reference node size for Monte Carlo estimation.
+  double mcEntryCoef;
+
+  //! Maximum Monte Carlo sample size.
+  double mcBreakCoef;
+
+  //! Detailed statistics of the last evaluation.
+  tree::TraversalStatistics statistics;
+
+  //! Store the statistics of the given rules, whose traversal took the given
+  //! number of seconds, and report them if they are enabled.
+  template<typename RuleType>
+  void RecordStatistics(const RuleType& rules, const double traversalTime);
+
   //! Check whether absolute and relative error values are compatible.
   static void CheckErrorValues(const double relError, const double absError);
 
   //! Rearrange estimations vector if required.
   static void RearrangeEstimations(const std::vector<size_t>& oldFromNew,
                                    arma::vec& estimations);
+
+  //! Rearrange the columns of a multi-bandwidth estimations matrix if
+  //! required.
+  static void RearrangeEstimations(const std::vector<size_t>& oldFromNew,
+                                   arma::mat& estimations);
 };
 
 } // namespace kde
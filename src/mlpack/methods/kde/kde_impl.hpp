@@ -12,6 +12,8 @@
 
 #include "kde.hpp"
 #include "kde_rules.hpp"
+#include "multi_bandwidth_kde_rules.hpp"
+#include <mlpack/core/tree/parallel_dual_tree_traverser.hpp>
 
 namespace mlpack {
 namespace kde {
@@ -38,6 +40,91 @@ TreeType* BuildTree(
   return new TreeType(std::forward<MatType>(dataset));
 }
 
+//! Run a dual-tree traversal.  If parallel is true, the query tree is split
+//! into subtrees that are traversed by different threads, each with its own
+//! copy of the rules.  This is only valid for trees that do not duplicate
+//! points between nodes.
+template<template<typename> class TraversalType,
+         typename TreeType,
+         typename RuleType>
+void DualTreeTraversal(
+    RuleType& rules,
+    TreeType& queryTree,
+    TreeType& referenceTree,
+    const bool parallel,
+    const typename std::enable_if<
+        tree::TreeTraits<TreeType>::BinaryTree &&
+        !tree::TreeTraits<TreeType>::HasDuplicatedPoints>::type* = 0)
+{
+  if (parallel)
+  {
+    tree::ParallelDualTreeTraverser<TreeType, RuleType,
+        TraversalType<RuleType>> traverser(rules);
+    traverser.Traverse(queryTree, referenceTree);
+  }
+  else
+  {
+    TraversalType<RuleType> traverser(rules);
+    traverser.Traverse(queryTree, referenceTree);
+  }
+}
+
+//! Run a serial dual-tree traversal.
+template<template<typename> class TraversalType,
+         typename TreeType,
+         typename RuleType>
+void DualTreeTraversal(
+    RuleType& rules,
+    TreeType& queryTree,
+    TreeType& referenceTree,
+    const bool /* parallel */,
+    const typename std::enable_if<
+        !tree::TreeTraits<TreeType>::BinaryTree ||
+        tree::TreeTraits<TreeType>::HasDuplicatedPoints>::type* = 0)
+{
+  TraversalType<RuleType> traverser(rules);
+  traverser.Traverse(queryTree, referenceTree);
+}
+
+//! Run a single-tree traversal for each of the given number of query points,
+//! in the given order (if it is not empty).  If parallel is true, the query
+//! points are split between threads, each with its own copy of the rules,
+//! which are merged back into the given rules.
+template<template<typename> class TraversalType,
+         typename TreeType,
+         typename RuleType>
+void SingleTreeTraversal(RuleType& rules,
+                         const size_t numQueries,
+                         TreeType& referenceTree,
+                         const bool parallel,
+                         const std::vector<size_t>& order =
+                             std::vector<size_t>())
+{
+  if (!parallel)
+  {
+    TraversalType<RuleType> traverser(rules);
+    for (size_t i = 0; i < numQueries; ++i)
+      traverser.Traverse(order.empty() ? i : order[i], referenceTree);
+
+    return;
+  }
+
+  #pragma omp parallel
+  {
+    RuleType threadRules(rules);
+    TraversalType<RuleType> traverser(threadRules);
+
+    #pragma omp for schedule(dynamic, 16)
+    for (omp_size_t i = 0; i < (omp_size_t) numQueries; ++i)
+      traverser.Traverse(order.empty() ? i : order[i], referenceTree);
+
+    // The implicit barrier after the loop makes sure that every thread has
+    // copied the rules before any of them is merged back.
+    #pragma omp critical
+    rules.Merge(threadRules, std::vector<TreeType*>());
+  }
+}
+
 template<typename KernelType,
          typename MetricType,
          typename MatType,
@@ -65,7 +152,13 @@ KDE(const double relError,
     absError(absError),
     ownsReferenceTree(false),
     trained(false),
-    mode(mode)
+    mode(mode),
+    queryCurve(tree::NO_CURVE),
+    monteCarlo(false),
+    mcProb(0.95),
+    initialSampleSize(100),
+    mcEntryCoef(3.0),
+    mcBreakCoef(0.4)
 {
   CheckErrorValues(relError, absError);
 }
@@ -91,7 +184,13 @@ KDE(const KDE& other) :
     absError(other.absError),
     ownsReferenceTree(other.ownsReferenceTree),
     trained(other.trained),
-    mode(other.mode)
+    mode(other.mode),
+    queryCurve(other.queryCurve),
+    monteCarlo(other.monteCarlo),
+    mcProb(other.mcProb),
+    initialSampleSize(other.initialSampleSize),
+    mcEntryCoef(other.mcEntryCoef),
+    mcBreakCoef(other.mcBreakCoef)
 {
   if (trained)
   {
@@ -132,7 +231,13 @@ KDE(KDE&& other) :
     absError(other.absError),
     ownsReferenceTree(other.ownsReferenceTree),
     trained(other.trained),
-    mode(other.mode)
+    mode(other.mode),
+    queryCurve(other.queryCurve),
+    monteCarlo(other.monteCarlo),
+    mcProb(other.mcProb),
+    initialSampleSize(other.initialSampleSize),
+    mcEntryCoef(other.mcEntryCoef),
+    mcBreakCoef(other.mcBreakCoef)
 {
   other.kernel = std::move(KernelType());
   other.metric = std::move(MetricType());
@@ -181,6 +286,12 @@ operator=(KDE other)
   this->ownsReferenceTree = other.ownsReferenceTree;
   this->trained = other.trained;
   this->mode = other.mode;
+  this->queryCurve = other.queryCurve;
+  this->monteCarlo = other.monteCarlo;
+  this->mcProb = other.mcProb;
+  this->initialSampleSize = other.initialSampleSize;
+  this->mcEntryCoef = other.mcEntryCoef;
+  this->mcBreakCoef = other.mcBreakCoef;
 
   return *this;
 }
@@ -346,14 +457,23 @@ Evaluate(MatType querySet, arma::vec& estimations)
                               absError,
                               metric,
                               kernel,
-                              false);
-
-    // Create traverser.
-    SingleTreeTraversalType<RuleType> traverser(rules);
+                              false,
+                              monteCarlo,
+                              mcProb,
+                              initialSampleSize,
+                              mcEntryCoef,
+                              mcBreakCoef);
 
-    // Traverse for each point.
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
+    // Traverse for each point.  Monte Carlo estimation draws from the shared
+    // random number generator, so it is only done by one thread.
+    statistics.Reset();
+    rules.Statistics().Enabled() = statistics.Enabled();
+    arma::wall_clock traversalTimer;
+    traversalTimer.tic();
+    std::vector<size_t> queryOrder;
+    tree::SpaceFillingCurveOrder(querySet, queryCurve, queryOrder);
+    SingleTreeTraversal<SingleTreeTraversalType>(rules, querySet.n_cols,
+        *referenceTree, !monteCarlo, queryOrder);
 
     estimations /= referenceTree->Dataset().n_cols;
     Timer::Stop("computing_kde");
@@ -362,6 +482,7 @@ Evaluate(MatType querySet, arma::vec& estimations)
               << std::endl;
     Log::Info << rules.BaseCases() << " base cases were calculated."
               << std::endl;
+    RecordStatistics(rules, traversalTimer.toc());
   }
 }
 
@@ -429,19 +550,31 @@ Evaluate(Tree* queryTree,
                             absError,
                             metric,
                             kernel,
-                            false);
+                            false,
+                            monteCarlo,
+                            mcProb,
+                            initialSampleSize,
+                            mcEntryCoef,
+                            mcBreakCoef);
 
-  // Create traverser.
-  DualTreeTraversalType<RuleType> traverser(rules);
-  traverser.Traverse(*queryTree, *referenceTree);
+  // Traverse, in parallel if possible.  Monte Carlo estimation draws from
+  // the shared random number generator, so it is only done by one thread.
+  statistics.Reset();
+  rules.Statistics().Enabled() = statistics.Enabled();
+  arma::wall_clock traversalTimer;
+  traversalTimer.tic();
+  DualTreeTraversal<DualTreeTraversalType>(rules, *queryTree, *referenceTree,
+      !monteCarlo);
   estimations /= referenceTree->Dataset().n_cols;
   Timer::Stop("computing_kde");
+  const double traversalTime = traversalTimer.toc();
 
   // Rearrange if necessary.
   RearrangeEstimations(oldFromNewQueries, estimations);
 
   Log::Info << rules.Scores() << " node combinations were scored." << std::endl;
   Log::Info << rules.BaseCases() << " base cases were calculated." << std::endl;
+  RecordStatistics(rules, traversalTime);
 }
 
 template<typename KernelType,
@@ -483,21 +616,30 @@ Evaluate(arma::vec& estimations)
                             absError,
                             metric,
                             kernel,
-                            true);
+                            true,
+                            monteCarlo,
+                            mcProb,
+                            initialSampleSize,
+                            mcEntryCoef,
+                            mcBreakCoef);
 
+  statistics.Reset();
+  rules.Statistics().Enabled() = statistics.Enabled();
+  arma::wall_clock traversalTimer;
+  traversalTimer.tic();
   if (mode == DUAL_TREE_MODE)
   {
-    // Create traverser.
-    DualTreeTraversalType<RuleType> traverser(rules);
-    traverser.Traverse(*referenceTree, *referenceTree);
+    // Monte Carlo estimation is only done by one thread (see above).
+    DualTreeTraversal<DualTreeTraversalType>(rules, *referenceTree,
+        *referenceTree, !monteCarlo);
   }
   else if (mode == SINGLE_TREE_MODE)
   {
-    SingleTreeTraversalType<RuleType> traverser(rules);
-    for (size_t i = 0; i < referenceTree->Dataset().n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
+    SingleTreeTraversal<SingleTreeTraversalType>(rules,
+        referenceTree->Dataset().n_cols, *referenceTree, !monteCarlo);
   }
 
+  const double traversalTime = traversalTimer.toc();
   estimations /= referenceTree->Dataset().n_cols;
   // Rearrange if necessary.
   RearrangeEstimations(*oldFromNewReferences, estimations);
@@ -505,6 +647,161 @@ Evaluate(arma::vec& estimations)
 
   Log::Info << rules.Scores() << " node combinations were scored." << std::endl;
   Log::Info << rules.BaseCases() << " base cases were calculated." << std::endl;
+  RecordStatistics(rules, traversalTime);
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void KDE<KernelType,
+         MetricType,
+         MatType,
+         TreeType,
+         DualTreeTraversalType,
+         SingleTreeTraversalType>::
+Evaluate(MatType querySet,
+         const arma::vec& bandwidths,
+         arma::mat& estimations)
+{
+  // Check whether has already been trained.
+  if (!trained)
+  {
+    throw std::runtime_error("cannot evaluate KDE model: model needs to be "
+                             "trained before evaluation");
+  }
+
+  // Get estimations matrix ready.
+  estimations.zeros(bandwidths.n_elem, querySet.n_cols);
+
+  // Check querySet has at least 1 element to evaluate.
+  if (querySet.n_cols == 0)
+  {
+    Log::Warn << "KDE::Evaluate(): querySet is empty, no predictions will "
+              << "be returned" << std::endl;
+    return;
+  }
+
+  // Check whether dimensions match.
+  if (querySet.n_rows != referenceTree->Dataset().n_rows)
+  {
+    throw std::invalid_argument("cannot evaluate KDE model: querySet and "
+                                "referenceSet dimensions don't match");
+  }
+
+  typedef MultiBandwidthKDERules<MetricType, KernelType, Tree> RuleType;
+  statistics.Reset();
+  arma::wall_clock traversalTimer;
+  if (mode == DUAL_TREE_MODE)
+  {
+    Timer::Start("building_query_tree");
+    std::vector<size_t> oldFromNewQueries;
+    Tree* queryTree = BuildTree<Tree>(std::move(querySet), oldFromNewQueries);
+    Timer::Stop("building_query_tree");
+
+    Timer::Start("computing_kde");
+    RuleType rules(referenceTree->Dataset(), queryTree->Dataset(), bandwidths,
+        estimations, relError, absError, metric, false);
+    rules.Statistics().Enabled() = statistics.Enabled();
+    traversalTimer.tic();
+    DualTreeTraversal<DualTreeTraversalType>(rules, *queryTree,
+        *referenceTree, true);
+    const double traversalTime = traversalTimer.toc();
+    estimations /= referenceTree->Dataset().n_cols;
+    RearrangeEstimations(oldFromNewQueries, estimations);
+    Timer::Stop("computing_kde");
+    delete queryTree;
+
+    Log::Info << rules.Scores() << " node combinations were scored."
+              << std::endl;
+    Log::Info << rules.BaseCases() << " base cases were calculated."
+              << std::endl;
+    RecordStatistics(rules, traversalTime);
+  }
+  else if (mode == SINGLE_TREE_MODE)
+  {
+    Timer::Start("computing_kde");
+    RuleType rules(referenceTree->Dataset(), querySet, bandwidths, estimations,
+        relError, absError, metric, false);
+    rules.Statistics().Enabled() = statistics.Enabled();
+    traversalTimer.tic();
+    std::vector<size_t> queryOrder;
+    tree::SpaceFillingCurveOrder(querySet, queryCurve, queryOrder);
+    SingleTreeTraversal<SingleTreeTraversalType>(rules, querySet.n_cols,
+        *referenceTree, true, queryOrder);
+    const double traversalTime = traversalTimer.toc();
+    estimations /= referenceTree->Dataset().n_cols;
+    Timer::Stop("computing_kde");
+
+    Log::Info << rules.Scores() << " node combinations were scored."
+              << std::endl;
+    Log::Info << rules.BaseCases() << " base cases were calculated."
+              << std::endl;
+    RecordStatistics(rules, traversalTime);
+  }
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void KDE<KernelType,
+         MetricType,
+         MatType,
+         TreeType,
+         DualTreeTraversalType,
+         SingleTreeTraversalType>::
+Evaluate(const arma::vec& bandwidths, arma::mat& estimations)
+{
+  // Check whether has already been trained.
+  if (!trained)
+  {
+    throw std::runtime_error("cannot evaluate KDE model: model needs to be "
+                             "trained before evaluation");
+  }
+
+  // Get estimations matrix ready.
+  estimations.zeros(bandwidths.n_elem, referenceTree->Dataset().n_cols);
+
+  Timer::Start("computing_kde");
+
+  // Evaluate.
+  typedef MultiBandwidthKDERules<MetricType, KernelType, Tree> RuleType;
+  RuleType rules(referenceTree->Dataset(), referenceTree->Dataset(),
+      bandwidths, estimations, relError, absError, metric, true);
+
+  statistics.Reset();
+  rules.Statistics().Enabled() = statistics.Enabled();
+  arma::wall_clock traversalTimer;
+  traversalTimer.tic();
+  if (mode == DUAL_TREE_MODE)
+  {
+    DualTreeTraversal<DualTreeTraversalType>(rules, *referenceTree,
+        *referenceTree, true);
+  }
+  else if (mode == SINGLE_TREE_MODE)
+  {
+    SingleTreeTraversal<SingleTreeTraversalType>(rules,
+        referenceTree->Dataset().n_cols, *referenceTree, true);
+  }
+
+  const double traversalTime = traversalTimer.toc();
+  estimations /= referenceTree->Dataset().n_cols;
+  // Rearrange if necessary.
+  RearrangeEstimations(*oldFromNewReferences, estimations);
+  Timer::Stop("computing_kde");
+
+  Log::Info << rules.Scores() << " node combinations were scored." << std::endl;
+  Log::Info << rules.BaseCases() << " base cases were calculated." << std::endl;
+  RecordStatistics(rules, traversalTime);
 }
 
 template<typename KernelType,
@@ -547,6 +844,78 @@ AbsoluteError(const double newError)
   absError = newError;
 }
 
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void KDE<KernelType,
+         MetricType,
+         MatType,
+         TreeType,
+         DualTreeTraversalType,
+         SingleTreeTraversalType>::
+MCProb(const double newProb)
+{
+  if (newProb <= 0 || newProb >= 1)
+  {
+    throw std::invalid_argument("Monte Carlo probability must be a value "
+                                "between 0 and 1 (exclusive)");
+  }
+  mcProb = newProb;
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void KDE<KernelType,
+         MetricType,
+         MatType,
+         TreeType,
+         DualTreeTraversalType,
+         SingleTreeTraversalType>::
+MCEntryCoefficient(const double newCoef)
+{
+  if (newCoef < 1)
+  {
+    throw std::invalid_argument("Monte Carlo entry coefficient must be a "
+                                "value greater or equal to 1");
+  }
+  mcEntryCoef = newCoef;
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void KDE<KernelType,
+         MetricType,
+         MatType,
+         TreeType,
+         DualTreeTraversalType,
+         SingleTreeTraversalType>::
+MCBreakCoefficient(const double newCoef)
+{
+  if (newCoef <= 0 || newCoef > 1)
+  {
+    throw std::invalid_argument("Monte Carlo break coefficient must be a "
+                                "value greater than 0 and at most 1");
+  }
+  mcBreakCoef = newCoef;
+}
+
 template<typename KernelType,
          typename MetricType,
          typename MatType,
@@ -589,6 +958,32 @@ serialize(Archive& ar, const unsigned int /* version */)
   ar & BOOST_SERIALIZATION_NVP(oldFromNewReferences);
 }
 
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+template<typename RuleType>
+void KDE<KernelType,
+         MetricType,
+         MatType,
+         TreeType,
+         DualTreeTraversalType,
+         SingleTreeTraversalType>::
+RecordStatistics(const RuleType& rules, const double traversalTime)
+{
+  statistics.Merge(rules.Statistics());
+  statistics.BaseCases() = rules.BaseCases();
+  statistics.Scores() = rules.Scores();
+  statistics.TraversalTime() = traversalTime;
+
+  if (statistics.Enabled())
+    statistics.Report();
+}
+
 template<typename KernelType,
          typename MetricType,
          typename MatType,
@@ -647,5 +1042,35 @@ RearrangeEstimations(const std::vector<size_t>& oldFromNew,
   }
 }
 
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void KDE<KernelType,
+         MetricType,
+         MatType,
+         TreeType,
+         DualTreeTraversalType,
+         SingleTreeTraversalType>::
+RearrangeEstimations(const std::vector<size_t>& oldFromNew,
+                     arma::mat& estimations)
+{
+  if (tree::TreeTraits<Tree>::RearrangesDataset)
+  {
+    const size_t nQueries = oldFromNew.size();
+    arma::mat rearrangedEstimations(estimations.n_rows, nQueries);
+
+    // Remap columns.
+    for (size_t i = 0; i < nQueries; ++i)
+      rearrangedEstimations.col(oldFromNew.at(i)) = estimations.col(i);
+
+    estimations = std::move(rearrangedEstimations);
+  }
+}
+
 } // namespace kde
 } // namespace mlpack
@@ -108,6 +108,10 @@ PARAM_DOUBLE_IN("abs_error",
                 "Relative error tolerance for the prediction.",
                 "E",
                 0.0);
+PARAM_FLAG("traversal_statistics", "If set, detailed statistics of the tree "
+    "traversal (nodes visited and pruned at each level, prunes by reason, "
+    "reference leaf sizes reached, and time per phase) are collected and printed"
+    " when verbose output is enabled.", "");
 
 // Output predictions options.
 PARAM_COL_OUT("predictions", "Vector to store density predictions.",
@@ -199,6 +203,7 @@ static void mlpackMain()
   }
 
   // Evaluation.
+  kde->Statistics().Enabled() = CLI::HasParam("traversal_statistics");
   if (CLI::HasParam("query"))
   {
     arma::mat query = std::move(CLI::GetParam<arma::mat>("query"));
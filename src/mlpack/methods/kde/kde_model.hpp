@@ -182,6 +182,18 @@ class ModeVisitor : public boost::static_visitor<KDEMode&>
   KDEMode& operator()(KDEType* kde) const;
 };
 
+/**
+ * StatisticsVisitor exposes the traversal statistics of the KDEType.
+ */
+class StatisticsVisitor :
+    public boost::static_visitor<tree::TraversalStatistics&>
+{
+ public:
+  //! Return the traversal statistics of KDEType instance.
+  template<typename KDEType>
+  tree::TraversalStatistics& operator()(KDEType* kde) const;
+};
+
 class DeleteVisitor : public boost::static_visitor<void>
 {
  public:
@@ -335,6 +347,12 @@ class KDEModel
   //! Modify the mode of the model.
   KDEMode& Mode();
 
+  //! Get the traversal statistics of the last evaluation.
+  const tree::TraversalStatistics& Statistics() const;
+
+  //! Modify the traversal statistics (i.e. to enable their collection).
+  tree::TraversalStatistics& Statistics();
+
   /**
    * Build the KDE model with the given parameters and then trains it with the
    * given reference data.
@@ -343,6 +343,28 @@ KDEMode& KDEModel::Mode()
   return boost::apply_visitor(ModeVisitor(), kdeModel);
 }
 
+// Traversal statistics of model.
+template<typename KDEType>
+tree::TraversalStatistics& StatisticsVisitor::operator()(KDEType* kde) const
+{
+  if (kde)
+    return kde->Statistics();
+  else
+    throw std::runtime_error("no KDE model initialized");
+}
+
+// Get traversal statistics of model.
+inline const tree::TraversalStatistics& KDEModel::Statistics() const
+{
+  return boost::apply_visitor(StatisticsVisitor(), kdeModel);
+}
+
+// Modify traversal statistics of model.
+inline tree::TraversalStatistics& KDEModel::Statistics()
+{
+  return boost::apply_visitor(StatisticsVisitor(), kdeModel);
+}
+
 // Serialize the model.
 template<typename Archive>
 void KDEModel::serialize(Archive& ar, const unsigned int /* version */)
@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_KDE_RULES_HPP
 
 #include <mlpack/core/tree/traversal_info.hpp>
+#include <mlpack/core/tree/traversal_statistics.hpp>
 
 namespace mlpack {
 namespace kde {
@@ -21,6 +22,16 @@ namespace kde {
 /**
  * A dual-tree traversal Rules class for kernel density estimation.  This
  * contains the Score() and BaseCase() implementations.
+ *
+ * If Monte Carlo estimation is enabled, a combination whose error bound is too
+ * loose to approximate deterministically, and whose reference node holds at
+ * least mcEntryCoef * initialSampleSize points, is estimated from a uniform
+ * sample of the points of the reference node instead.  Samples are added until
+ * the half-width of the mcProb confidence interval of the mean kernel value of
+ * every query point is at most relError times that mean (plus the absolute
+ * error tolerance divided among the reference points).  If that takes more
+ * than mcBreakCoef times the number of points in the reference node, the
+ * estimation is abandoned and the traversal recurses as usual.
  */
 template<typename MetricType, typename KernelType, typename TreeType>
 class KDERules
@@ -38,6 +49,13 @@ class KDERules
    * @param kernel Instantiated kernel.
    * @param sameSet True if query and reference sets are the same
    *                (monochromatic evaluation).
+   * @param monteCarlo Whether to use Monte Carlo estimation.
+   * @param mcProb Probability that the Monte Carlo error bound holds.
+   * @param initialSampleSize Number of points in the first Monte Carlo sample.
+   * @param mcEntryCoef Minimum size of a reference node for Monte Carlo
+   *     estimation, as a multiple of initialSampleSize.
+   * @param mcBreakCoef Maximum size of a Monte Carlo sample, as a fraction of
+   *     the size of the reference node.
    */
   KDERules(const arma::mat& referenceSet,
            const arma::mat& querySet,
@@ -46,7 +64,12 @@ class KDERules
            const double absError,
            MetricType& metric,
            KernelType& kernel,
-           const bool sameSet);
+           const bool sameSet,
+           const bool monteCarlo = false,
+           const double mcProb = 0.95,
+           const size_t initialSampleSize = 100,
+           const double mcEntryCoef = 3.0,
+           const double mcBreakCoef = 0.4);
 
   //! Base Case.
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
@@ -75,13 +98,41 @@ class KDERules
   //! Modify traversal information.
   TraversalInfoType& TraversalInfo() { return traversalInfo; }
 
+  /**
+   * Merge the statistics of another KDERules object (usually a per-thread copy
+   * of this one).  The densities need no merging, since every copy adds
+   * directly to the densities of its own query points.  This is used by
+   * tree::ParallelDualTreeTraverser and by parallel single-tree evaluation.
+   *
+   * @param other Rules object to take statistics from.
+   * @param queryNodes Query nodes whose descendants were evaluated by 'other'.
+   */
+  void Merge(const KDERules& other, const std::vector<TreeType*>& queryNodes);
+
   //! Get the number of base cases.
   size_t BaseCases() const { return baseCases; }
 
   //! Get the number of scores.
   size_t Scores() const { return scores; }
 
+  //! Get the detailed traversal statistics.
+  const tree::TraversalStatistics& Statistics() const { return statistics; }
+  //! Modify the detailed traversal statistics.
+  tree::TraversalStatistics& Statistics() { return statistics; }
+
  private:
+  /**
+   * Try to estimate the contribution of the given reference node to the
+   * densities of the given query points by Monte Carlo sampling.  If the
+   * estimate meets the error bound, it is added to the densities and true is
+   * returned; otherwise the densities are unchanged.
+   *
+   * @param queryIndices Indices of the query points to estimate.
+   * @param referenceNode Reference node to sample from.
+   */
+  bool MonteCarloEstimate(const std::vector<size_t>& queryIndices,
+                          TreeType& referenceNode);
+
   //! Evaluate kernel value of 2 points given their indexes.
   double EvaluateKernel(const size_t queryIndex,
                         const size_t referenceIndex) const;
@@ -114,6 +165,21 @@ class KDERules
   //! Whether reference and query sets are the same.
   const bool sameSet;
 
+  //! Whether Monte Carlo estimation is used.
+  const bool monteCarlo;
+
+  //! Number of standard deviations in the Monte Carlo confidence interval.
+  double mcZ;
+
+  //! Number of points in the first Monte Carlo sample.
+  const size_t initialSampleSize;
+
+  //! Minimum reference node size for Monte Carlo, relative to the sample size.
+  const double mcEntryCoef;
+
+  //! Maximum sample size, relative to the reference node size.
+  const double mcBreakCoef;
+
   //! The last query index.
   size_t lastQueryIndex;
 
@@ -128,6 +194,9 @@ class KDERules
 
   //! The number of scores.
   size_t scores;
+
+  //! Detailed traversal statistics.
+  tree::TraversalStatistics statistics;
 };
 
 } // namespace kde
@@ -16,6 +16,8 @@
 // In case it hasn't been included yet.
 #include "kde_rules.hpp"
 
+#include <boost/math/distributions/normal.hpp>
+
 namespace mlpack {
 namespace kde {
 
@@ -28,7 +30,12 @@ KDERules<MetricType, KernelType, TreeType>::KDERules(
     const double absError,
     MetricType& metric,
     KernelType& kernel,
-    const bool sameSet) :
+    const bool sameSet,
+    const bool monteCarlo,
+    const double mcProb,
+    const size_t initialSampleSize,
+    const double mcEntryCoef,
+    const double mcBreakCoef) :
     referenceSet(referenceSet),
     querySet(querySet),
     densities(densities),
@@ -37,12 +44,33 @@ KDERules<MetricType, KernelType, TreeType>::KDERules(
     metric(metric),
     kernel(kernel),
     sameSet(sameSet),
+    monteCarlo(monteCarlo),
+    mcZ(0.0),
+    initialSampleSize(initialSampleSize),
+    mcEntryCoef(mcEntryCoef),
+    mcBreakCoef(mcBreakCoef),
     lastQueryIndex(querySet.n_cols),
     lastReferenceIndex(referenceSet.n_cols),
     baseCases(0),
     scores(0)
 {
-  // Nothing to do.
+  // The half-width of a two-sided confidence interval with probability mcProb
+  // is mcZ standard deviations.
+  if (monteCarlo)
+  {
+    boost::math::normal normal;
+    mcZ = boost::math::quantile(normal, 1.0 - (1.0 - mcProb) / 2.0);
+  }
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+void KDERules<MetricType, KernelType, TreeType>::Merge(
+    const KDERules& other,
+    const std::vector<TreeType*>& /* queryNodes */)
+{
+  baseCases += other.baseCases;
+  scores += other.scores;
+  statistics.Merge(other.statistics);
 }
 
 //! The base case.
@@ -122,6 +150,13 @@ Score(const size_t queryIndex, TreeType& referenceNode)
     // Don't explore this tree branch.
     score = DBL_MAX;
   }
+  else if (newCalculations && monteCarlo &&
+      referenceNode.NumDescendants() >= mcEntryCoef * initialSampleSize &&
+      MonteCarloEstimate(std::vector<size_t>(1, queryIndex), referenceNode))
+  {
+    // The contribution of the node was estimated by sampling.
+    score = DBL_MAX;
+  }
   else
   {
     score = minDistance;
@@ -130,7 +165,8 @@ Score(const size_t queryIndex, TreeType& referenceNode)
   ++scores;
   traversalInfo.LastReferenceNode() = &referenceNode;
   traversalInfo.LastScore() = score;
-  return score;
+  return statistics.Score(referenceNode, score,
+      tree::TraversalStatistics::APPROXIMATION_PRUNE);
 }
 
 template<typename MetricType, typename KernelType, typename TreeType>
@@ -201,6 +237,18 @@ Score(TreeType& queryNode, TreeType& referenceNode)
     }
     score = DBL_MAX;
   }
+  else if (newCalculations && monteCarlo &&
+      referenceNode.NumDescendants() >= mcEntryCoef * initialSampleSize)
+  {
+    // Every query point of the node uses the same sample of the reference
+    // node.
+    std::vector<size_t> queryIndices(queryNode.NumDescendants());
+    for (size_t i = 0; i < queryNode.NumDescendants(); ++i)
+      queryIndices[i] = queryNode.Descendant(i);
+
+    score = MonteCarloEstimate(queryIndices, referenceNode) ? DBL_MAX :
+        minDistance;
+  }
   else
   {
     score = minDistance;
@@ -210,7 +258,8 @@ Score(TreeType& queryNode, TreeType& referenceNode)
   traversalInfo.LastQueryNode() = &queryNode;
   traversalInfo.LastReferenceNode() = &referenceNode;
   traversalInfo.LastScore() = score;
-  return score;
+  return statistics.Score(referenceNode, score,
+      tree::TraversalStatistics::APPROXIMATION_PRUNE);
 }
 
 //! Double-tree rescore.
@@ -224,6 +273,77 @@ Rescore(TreeType& /*queryNode*/,
   return oldScore;
 }
 
+template<typename MetricType, typename KernelType, typename TreeType>
+bool KDERules<MetricType, KernelType, TreeType>::MonteCarloEstimate(
+    const std::vector<size_t>& queryIndices,
+    TreeType& referenceNode)
+{
+  const size_t numDescendants = referenceNode.NumDescendants();
+  const size_t maxSamples = (size_t) (mcBreakCoef * numDescendants);
+
+  // Running sums of the sampled kernel values and of their squares.
+  arma::vec sums(queryIndices.size(), arma::fill::zeros);
+  arma::vec squaredSums(queryIndices.size(), arma::fill::zeros);
+
+  size_t numSamples = 0;
+  size_t batchSize = std::max(initialSampleSize, (size_t) 2);
+  while (numSamples + batchSize <= maxSamples)
+  {
+    for (size_t s = 0; s < batchSize; ++s)
+    {
+      const size_t referenceIndex =
+          referenceNode.Descendant(math::RandInt(numDescendants));
+      for (size_t i = 0; i < queryIndices.size(); ++i)
+      {
+        // As in BaseCase(), a point does not contribute to its own density.
+        if (sameSet && queryIndices[i] == referenceIndex)
+          continue;
+
+        const double kernelValue = EvaluateKernel(queryIndices[i],
+            referenceIndex);
+        sums[i] += kernelValue;
+        squaredSums[i] += kernelValue * kernelValue;
+      }
+    }
+    baseCases += batchSize * queryIndices.size();
+    numSamples += batchSize;
+
+    // Find the sample size that the worst query point needs for its error
+    // bound.
+    size_t requiredSamples = numSamples;
+    for (size_t i = 0; i < queryIndices.size(); ++i)
+    {
+      const double mean = sums[i] / numSamples;
+      const double variance = std::max(0.0, (squaredSums[i] - numSamples *
+          mean * mean) / (numSamples - 1));
+      if (variance == 0.0)
+        continue;
+
+      const double allowedError = relError * mean +
+          absError / referenceSet.n_cols;
+      if (allowedError <= 0.0)
+        return false;
+
+      const double required = std::ceil(mcZ * mcZ * variance /
+          (allowedError * allowedError));
+      if (required > maxSamples)
+        return false;
+      requiredSamples = std::max(requiredSamples, (size_t) required);
+    }
+
+    if (requiredSamples <= numSamples)
+    {
+      for (size_t i = 0; i < queryIndices.size(); ++i)
+        densities(queryIndices[i]) += numDescendants * sums[i] / numSamples;
+      return true;
+    }
+
+    batchSize = requiredSamples - numSamples;
+  }
+
+  return false;
+}
+
 template<typename MetricType, typename KernelType, typename TreeType>
 inline force_inline double KDERules<MetricType, KernelType, TreeType>::
 EvaluateKernel(const size_t queryIndex,
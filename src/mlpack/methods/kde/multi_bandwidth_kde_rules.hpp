@@ -0,0 +1,168 @@
+/**
+ * @file multi_bandwidth_kde_rules.hpp
+ *
+ * Rules for Kernel Density Estimation with several bandwidths at once, so that
+ * the estimations for all bandwidths are computed with a single traversal.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KDE_MULTI_BANDWIDTH_KDE_RULES_HPP
+#define MLPACK_METHODS_KDE_MULTI_BANDWIDTH_KDE_RULES_HPP
+
+#include <mlpack/core/tree/traversal_info.hpp>
+#include <mlpack/core/tree/traversal_statistics.hpp>
+
+namespace mlpack {
+namespace kde {
+
+/**
+ * A tree traversal Rules class for kernel density estimation with several
+ * bandwidths.  The estimation for bandwidth i of query point j is written to
+ * densities(i, j).  Each distance is only computed once and shared by all the
+ * kernels, and a node combination is only approximated when the error bound
+ * holds for every bandwidth, so the result for each bandwidth satisfies the
+ * same error tolerances as a KDERules traversal with that bandwidth alone.
+ *
+ * KernelType must have a constructor that takes the bandwidth.
+ */
+template<typename MetricType, typename KernelType, typename TreeType>
+class MultiBandwidthKDERules
+{
+ public:
+  /**
+   * Construct MultiBandwidthKDERules.
+   *
+   * @param referenceSet Reference set data.
+   * @param querySet Query set data.
+   * @param bandwidths Bandwidths to evaluate.
+   * @param densities Matrix where estimations will be written; it must be of
+   *     size bandwidths.n_elem x querySet.n_cols and filled with zeros.
+   * @param relError Relative error tolerance.
+   * @param absError Absolute error tolerance.
+   * @param metric Instantiated metric.
+   * @param sameSet True if query and reference sets are the same
+   *                (monochromatic evaluation).
+   */
+  MultiBandwidthKDERules(const arma::mat& referenceSet,
+                         const arma::mat& querySet,
+                         const arma::vec& bandwidths,
+                         arma::mat& densities,
+                         const double relError,
+                         const double absError,
+                         MetricType& metric,
+                         const bool sameSet);
+
+  //! Base Case.
+  double BaseCase(const size_t queryIndex, const size_t referenceIndex);
+
+  //! SingleTree Score.
+  double Score(const size_t queryIndex, TreeType& referenceNode);
+
+  //! SingleTree Rescore.
+  double Rescore(const size_t queryIndex,
+                 TreeType& referenceNode,
+                 const double oldScore) const;
+
+  //! DoubleTree Score.
+  double Score(TreeType& queryNode, TreeType& referenceNode);
+
+  //! DoubleTree Rescore.
+  double Rescore(TreeType& queryNode,
+                 TreeType& referenceNode,
+                 const double oldScore) const;
+
+  typedef typename tree::TraversalInfo<TreeType> TraversalInfoType;
+
+  //! Get traversal information.
+  const TraversalInfoType& TraversalInfo() const { return traversalInfo; }
+
+  //! Modify traversal information.
+  TraversalInfoType& TraversalInfo() { return traversalInfo; }
+
+  /**
+   * Merge the statistics of another MultiBandwidthKDERules object (usually a
+   * per-thread copy of this one).  The densities need no merging, since every
+   * copy adds directly to the densities of its own query points.  This is used
+   * by tree::ParallelDualTreeTraverser and by parallel single-tree evaluation.
+   *
+   * @param other Rules object to take statistics from.
+   * @param queryNodes Query nodes whose descendants were evaluated by 'other'.
+   */
+  void Merge(const MultiBandwidthKDERules& other,
+             const std::vector<TreeType*>& queryNodes);
+
+  //! Get the number of base cases.
+  size_t BaseCases() const { return baseCases; }
+
+  //! Get the number of scores.
+  size_t Scores() const { return scores; }
+
+  //! Get the detailed traversal statistics.
+  const tree::TraversalStatistics& Statistics() const { return statistics; }
+  //! Modify the detailed traversal statistics.
+  tree::TraversalStatistics& Statistics() { return statistics; }
+
+ private:
+  //! Check whether the kernel values of all bandwidths are known to within
+  //! the error tolerance for the given distance range.
+  bool CanPrune(const double minDistance, const double maxDistance) const;
+
+  //! Add numPoints times the kernel value of every bandwidth at the given
+  //! distance to the densities of the given query point.
+  void AddEstimation(const size_t queryIndex,
+                     const double distance,
+                     const size_t numPoints);
+
+  //! The reference set.
+  const arma::mat& referenceSet;
+
+  //! The query set.
+  const arma::mat& querySet;
+
+  //! One kernel for each bandwidth.
+  std::vector<KernelType> kernels;
+
+  //! Density values (one row per bandwidth, one column per query point).
+  arma::mat& densities;
+
+  //! Absolute error tolerance.
+  const double absError;
+
+  //! Relatve error tolerance.
+  const double relError;
+
+  //! Instantiated metric.
+  MetricType& metric;
+
+  //! Whether reference and query sets are the same.
+  const bool sameSet;
+
+  //! The last query index.
+  size_t lastQueryIndex;
+
+  //! The last reference index.
+  size_t lastReferenceIndex;
+
+  //! Traversal information.
+  TraversalInfoType traversalInfo;
+
+  //! The number of base cases.
+  size_t baseCases;
+
+  //! The number of scores.
+  size_t scores;
+
+  //! Detailed traversal statistics.
+  tree::TraversalStatistics statistics;
+};
+
+} // namespace kde
+} // namespace mlpack
+
+// Include implementation.
+#include "multi_bandwidth_kde_rules_impl.hpp"
+
+#endif
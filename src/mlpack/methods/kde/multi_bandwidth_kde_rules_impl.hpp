@@ -0,0 +1,233 @@
+/**
+ * @file multi_bandwidth_kde_rules_impl.hpp
+ *
+ * Implementation of rules for Kernel Density Estimation with several
+ * bandwidths.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KDE_MULTI_BANDWIDTH_KDE_RULES_IMPL_HPP
+#define MLPACK_METHODS_KDE_MULTI_BANDWIDTH_KDE_RULES_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "multi_bandwidth_kde_rules.hpp"
+
+namespace mlpack {
+namespace kde {
+
+template<typename MetricType, typename KernelType, typename TreeType>
+MultiBandwidthKDERules<MetricType, KernelType, TreeType>::
+MultiBandwidthKDERules(const arma::mat& referenceSet,
+                       const arma::mat& querySet,
+                       const arma::vec& bandwidths,
+                       arma::mat& densities,
+                       const double relError,
+                       const double absError,
+                       MetricType& metric,
+                       const bool sameSet) :
+    referenceSet(referenceSet),
+    querySet(querySet),
+    densities(densities),
+    absError(absError),
+    relError(relError),
+    metric(metric),
+    sameSet(sameSet),
+    lastQueryIndex(querySet.n_cols),
+    lastReferenceIndex(referenceSet.n_cols),
+    baseCases(0),
+    scores(0)
+{
+  kernels.reserve(bandwidths.n_elem);
+  for (size_t i = 0; i < bandwidths.n_elem; ++i)
+    kernels.push_back(KernelType(bandwidths[i]));
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+void MultiBandwidthKDERules<MetricType, KernelType, TreeType>::Merge(
+    const MultiBandwidthKDERules& other,
+    const std::vector<TreeType*>& /* queryNodes */)
+{
+  baseCases += other.baseCases;
+  scores += other.scores;
+  statistics.Merge(other.statistics);
+}
+
+//! The base case.
+template<typename MetricType, typename KernelType, typename TreeType>
+inline force_inline
+double MultiBandwidthKDERules<MetricType, KernelType, TreeType>::BaseCase(
+    const size_t queryIndex,
+    const size_t referenceIndex)
+{
+  // If reference and query sets are the same we don't want to compute the
+  // estimation of a point with itself.
+  if (sameSet && (queryIndex == referenceIndex))
+    return 0.0;
+
+  // Avoid duplicated calculations.
+  if ((lastQueryIndex == queryIndex) && (lastReferenceIndex == referenceIndex))
+    return 0.0;
+
+  // The distance is computed once for all the bandwidths.
+  const double distance = metric.Evaluate(querySet.col(queryIndex),
+                                          referenceSet.col(referenceIndex));
+  AddEstimation(queryIndex, distance, 1);
+
+  ++baseCases;
+  lastQueryIndex = queryIndex;
+  lastReferenceIndex = referenceIndex;
+  return distance;
+}
+
+//! Single-tree scoring function.
+template<typename MetricType, typename KernelType, typename TreeType>
+inline double MultiBandwidthKDERules<MetricType, KernelType, TreeType>::
+Score(const size_t queryIndex, TreeType& referenceNode)
+{
+  double score;
+  const arma::vec& queryPoint = querySet.unsafe_col(queryIndex);
+  const double minDistance = referenceNode.MinDistance(queryPoint);
+
+  // Don't duplicate calculations (see KDERules::Score()).
+  const bool newCalculations = !(tree::TreeTraits<TreeType>::
+      FirstPointIsCentroid && lastQueryIndex == queryIndex &&
+      traversalInfo.LastReferenceNode() != NULL &&
+      traversalInfo.LastReferenceNode()->Point(0) == referenceNode.Point(0));
+
+  if (newCalculations &&
+      CanPrune(minDistance, referenceNode.MaxDistance(queryPoint)))
+  {
+    double distance;
+    if (tree::TreeTraits<TreeType>::FirstPointIsCentroid)
+    {
+      distance = metric.Evaluate(queryPoint,
+          referenceSet.unsafe_col(referenceNode.Point(0)));
+    }
+    else
+    {
+      distance = metric.Evaluate(queryPoint, referenceNode.Stat().Centroid());
+    }
+
+    AddEstimation(queryIndex, distance, referenceNode.NumDescendants());
+    score = DBL_MAX;
+  }
+  else
+  {
+    score = minDistance;
+  }
+
+  ++scores;
+  traversalInfo.LastReferenceNode() = &referenceNode;
+  traversalInfo.LastScore() = score;
+  return statistics.Score(referenceNode, score,
+      tree::TraversalStatistics::APPROXIMATION_PRUNE);
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+inline double MultiBandwidthKDERules<MetricType, KernelType, TreeType>::
+Rescore(const size_t /* queryIndex */,
+        TreeType& /* referenceNode */,
+        const double oldScore) const
+{
+  // If it's pruned it continues to be pruned.
+  return oldScore;
+}
+
+//! Dual-tree scoring function.
+template<typename MetricType, typename KernelType, typename TreeType>
+inline double MultiBandwidthKDERules<MetricType, KernelType, TreeType>::
+Score(TreeType& queryNode, TreeType& referenceNode)
+{
+  double score;
+  const double minDistance = queryNode.MinDistance(referenceNode);
+
+  // Don't duplicate calculations (see KDERules::Score()).
+  const bool newCalculations = !(tree::TreeTraits<TreeType>::
+      FirstPointIsCentroid && (traversalInfo.LastQueryNode() != NULL) &&
+      (traversalInfo.LastReferenceNode() != NULL) &&
+      (traversalInfo.LastQueryNode()->Point(0) == queryNode.Point(0)) &&
+      (traversalInfo.LastReferenceNode()->Point(0) == referenceNode.Point(0)));
+
+  if (newCalculations &&
+      CanPrune(minDistance, queryNode.MaxDistance(referenceNode)))
+  {
+    double distance;
+    if (tree::TreeTraits<TreeType>::FirstPointIsCentroid)
+    {
+      distance = metric.Evaluate(querySet.unsafe_col(queryNode.Point(0)),
+          referenceSet.unsafe_col(referenceNode.Point(0)));
+    }
+    else
+    {
+      distance = metric.Evaluate(queryNode.Stat().Centroid(),
+          referenceNode.Stat().Centroid());
+    }
+
+    for (size_t i = 0; i < queryNode.NumDescendants(); ++i)
+    {
+      AddEstimation(queryNode.Descendant(i), distance,
+          referenceNode.NumDescendants());
+    }
+    score = DBL_MAX;
+  }
+  else
+  {
+    score = minDistance;
+  }
+
+  ++scores;
+  traversalInfo.LastQueryNode() = &queryNode;
+  traversalInfo.LastReferenceNode() = &referenceNode;
+  traversalInfo.LastScore() = score;
+  return statistics.Score(referenceNode, score,
+      tree::TraversalStatistics::APPROXIMATION_PRUNE);
+}
+
+//! Dual-tree rescore.
+template<typename MetricType, typename KernelType, typename TreeType>
+inline double MultiBandwidthKDERules<MetricType, KernelType, TreeType>::
+Rescore(TreeType& /* queryNode */,
+        TreeType& /* referenceNode */,
+        const double oldScore) const
+{
+  // If a node is pruned it continues to be pruned.
+  return oldScore;
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+inline force_inline bool
+MultiBandwidthKDERules<MetricType, KernelType, TreeType>::CanPrune(
+    const double minDistance,
+    const double maxDistance) const
+{
+  for (size_t i = 0; i < kernels.size(); ++i)
+  {
+    const double maxKernel = kernels[i].Evaluate(minDistance);
+    const double minKernel = kernels[i].Evaluate(maxDistance);
+    if (maxKernel - minKernel >
+        (absError + relError * minKernel) / referenceSet.n_cols)
+      return false;
+  }
+
+  return true;
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+inline force_inline void
+MultiBandwidthKDERules<MetricType, KernelType, TreeType>::AddEstimation(
+    const size_t queryIndex,
+    const double distance,
+    const size_t numPoints)
+{
+  double* queryDensities = densities.colptr(queryIndex);
+  for (size_t i = 0; i < kernels.size(); ++i)
+    queryDensities[i] += numPoints * kernels[i].Evaluate(distance);
+}
+
+} // namespace kde
+} // namespace mlpack
+
+#endif
@@ -98,7 +98,9 @@ PROGRAM_INFO("Kernel Principal Components Analysis",
     "the kernel matrix; to specify the sampling scheme, the " +
     PRINT_PARAM_STRING("sampling") + " parameter is used.  The "
     "sampling scheme for the Nystr\u00F6m method can be chosen from the "
-    "following list: 'kmeans', 'random', 'ordered'.",
+    "following list: 'kmeans', 'mini-batch-kmeans', 'random', 'ordered'.  "
+    "'mini-batch-kmeans' selects the points with mini-batch k-means, which is "
+    "much faster than 'kmeans' for large datasets.",
     SEE_ALSO("Kernel principal component analysis on Wikipedia",
         "https://en.wikipedia.org/wiki/Kernel_principal_component_analysis"),
     SEE_ALSO("Kernel Principal Component Analysis (pdf)",
@@ -121,7 +123,7 @@ PARAM_FLAG("center", "If set, the transformed data will be centered about the "
 PARAM_FLAG("nystroem_method", "If set, the Nystroem method will be used.", "n");
 
 PARAM_STRING_IN("sampling", "Sampling scheme to use for the Nystroem method: "
-    "'kmeans', 'random', 'ordered'", "s", "kmeans");
+    "'kmeans', 'mini-batch-kmeans', 'random', 'ordered'", "s", "kmeans");
 
 PARAM_DOUBLE_IN("kernel_scale", "Scale, for 'hyptan' kernel.", "S", 1.0);
 PARAM_DOUBLE_IN("offset", "Offset, for 'hyptan' and 'polynomial' kernels.", "O",
@@ -149,6 +151,12 @@ void RunKPCA(arma::mat& dataset,
           KMeansSelection<> > > kpca(kernel, centerTransformedData);
       kpca.Apply(dataset, newDim);
     }
+    else if (sampling == "mini-batch-kmeans")
+    {
+      KernelPCA<KernelType, NystroemKernelRule<KernelType,
+          MiniBatchKMeansSelection<> > > kpca(kernel, centerTransformedData);
+      kpca.Apply(dataset, newDim);
+    }
     else if (sampling == "random")
     {
       KernelPCA<KernelType, NystroemKernelRule<KernelType,
@@ -165,7 +173,8 @@ void RunKPCA(arma::mat& dataset,
     {
       // Invalid sampling scheme.
       Log::Fatal << "Invalid sampling scheme ('" << sampling << "'); valid "
-        << "choices are 'kmeans', 'random' and 'ordered'" << endl;
+        << "choices are 'kmeans', 'mini-batch-kmeans', 'random' and 'ordered'"
+        << endl;
     }
   }
   else
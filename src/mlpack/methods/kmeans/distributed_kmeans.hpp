@@ -0,0 +1,176 @@
+/**
+ * @file distributed_kmeans.hpp
+ *
+ * K-means clustering of a dataset that is split across the processes of an MPI
+ * communicator.  This is only available if mlpack was built with MPI
+ * (-DUSE_MPI=ON, which defines HAS_MPI).
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_DISTRIBUTED_KMEANS_HPP
+#define MLPACK_METHODS_KMEANS_DISTRIBUTED_KMEANS_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+
+#include "max_variance_new_cluster.hpp"
+#include "naive_kmeans.hpp"
+
+#include <mpi.h>
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * K-means clustering of a dataset that is split into shards, one held by each
+ * process (rank) of an MPI communicator; every rank calls Cluster() with its
+ * own shard, and gets the same centroids.
+ *
+ * In each iteration, every rank runs the LloydStepType on its shard, which
+ * gives the mean and the number of the points of the shard that are closest to
+ * each centroid; the sums of the points and the counts of all the ranks are
+ * then combined with MPI_Allreduce(), so the iterations are exactly those of
+ * KMeans on the whole dataset.  Only the centroids are communicated, never the
+ * points.
+ *
+ * The LloydStepType must compute each iteration from the given centroids only,
+ * like NaiveKMeans and PellegMooreKMeans; ElkanKMeans, HamerlyKMeans and
+ * DualTreeKMeans keep bounds on the centroids that they computed themselves,
+ * which are not the combined centroids, and MiniBatchKMeans does not compute
+ * means.
+ *
+ * The initial centroids are points sampled uniformly from the whole dataset
+ * (like SampleInitialization), unless they are given.  Empty clusters are
+ * handled by the EmptyClusterPolicy on the shard of rank 0, whose decision is
+ * then sent to the other ranks.
+ *
+ * @code
+ * MPI_Init(&argc, &argv);
+ * arma::mat shard; // Load the shard of this rank.
+ * arma::mat centroids;
+ * DistributedKMeans<> kmeans(MPI_COMM_WORLD);
+ * kmeans.Cluster(shard, 100, centroids);
+ * MPI_Finalize();
+ * @endcode
+ *
+ * @tparam MetricType The distance metric to use for this KMeans.
+ * @tparam EmptyClusterPolicy Policy for what to do on an empty cluster.
+ * @tparam LloydStepType Implementation of single Lloyd step to use.
+ * @tparam MatType Type of data (arma::mat or arma::sp_mat).
+ */
+template<typename MetricType = metric::EuclideanDistance,
+         typename EmptyClusterPolicy = MaxVarianceNewCluster,
+         template<class, class> class LloydStepType = NaiveKMeans,
+         typename MatType = arma::mat>
+class DistributedKMeans
+{
+ public:
+  /**
+   * Create a DistributedKMeans object for the given communicator.
+   *
+   * @param communicator Communicator of the ranks that hold the shards.
+   * @param maxIterations Maximum number of iterations allowed before giving up
+   *     (0 is valid, but the algorithm may never terminate).
+   * @param metric Optional MetricType object; for when the metric has state
+   *     it needs to store.
+   * @param emptyClusterAction Optional EmptyClusterPolicy object; for when a
+   *     specially initialized empty cluster policy is required.
+   */
+  DistributedKMeans(const MPI_Comm communicator = MPI_COMM_WORLD,
+                    const size_t maxIterations = 1000,
+                    const MetricType metric = MetricType(),
+                    const EmptyClusterPolicy emptyClusterAction =
+                        EmptyClusterPolicy());
+
+  /**
+   * Perform k-means clustering on the shards of all the ranks, returning the
+   * centroids of each cluster (the same on every rank).  Every rank of the
+   * communicator must call this.
+   *
+   * @param shard Points of this rank; every rank must hold at least one point,
+   *     of the same dimensionality.
+   * @param clusters Number of clusters to compute.
+   * @param centroids Matrix in which centroids are stored.
+   * @param initialGuess If true, then it is assumed that centroids contains the
+   *      initial cluster centroids; the centroids of rank 0 are used.
+   */
+  void Cluster(const MatType& shard,
+               const size_t clusters,
+               arma::mat& centroids,
+               const bool initialGuess = false);
+
+  /**
+   * Perform k-means clustering on the shards of all the ranks, returning the
+   * centroids of each cluster, and the assignments of the points of this rank.
+   * Every rank of the communicator must call this.
+   *
+   * @param shard Points of this rank; every rank must hold at least one point,
+   *     of the same dimensionality.
+   * @param clusters Number of clusters to compute.
+   * @param assignments Vector to store cluster assignments of the points of
+   *     the shard in.
+   * @param centroids Matrix in which centroids are stored.
+   * @param initialGuess If true, then it is assumed that centroids contains the
+   *      initial cluster centroids; the centroids of rank 0 are used.
+   */
+  void Cluster(const MatType& shard,
+               const size_t clusters,
+               arma::Row<size_t>& assignments,
+               arma::mat& centroids,
+               const bool initialGuess = false);
+
+  //! Get the communicator.
+  MPI_Comm Communicator() const { return communicator; }
+  //! Get the rank of this process in the communicator.
+  size_t Rank() const;
+  //! Get the number of ranks in the communicator.
+  size_t Ranks() const;
+
+  //! Get the maximum number of iterations.
+  size_t MaxIterations() const { return maxIterations; }
+  //! Set the maximum number of iterations.
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the distance metric.
+  const MetricType& Metric() const { return metric; }
+  //! Modify the distance metric.
+  MetricType& Metric() { return metric; }
+
+  //! Get the empty cluster policy.
+  const EmptyClusterPolicy& EmptyClusterAction() const
+  { return emptyClusterAction; }
+  //! Modify the empty cluster policy.
+  EmptyClusterPolicy& EmptyClusterAction() { return emptyClusterAction; }
+
+ private:
+  /**
+   * Choose the initial centroids: points sampled uniformly, without
+   * replacement, from the shards of all the ranks.
+   */
+  void InitialCentroids(const MatType& shard,
+                        const size_t clusters,
+                        arma::mat& centroids);
+
+  //! Send the given matrix of rank 0 to all the ranks.
+  void Broadcast(arma::mat& matrix);
+
+  //! The communicator of the ranks that hold the shards.
+  MPI_Comm communicator;
+  //! Maximum number of iterations before giving up.
+  size_t maxIterations;
+  //! Instantiated distance metric.
+  MetricType metric;
+  //! Instantiated empty cluster policy.
+  EmptyClusterPolicy emptyClusterAction;
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "distributed_kmeans_impl.hpp"
+
+#endif
@@ -0,0 +1,315 @@
+/**
+ * @file distributed_kmeans_impl.hpp
+ *
+ * Implementation of k-means clustering across the processes of an MPI
+ * communicator.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_DISTRIBUTED_KMEANS_IMPL_HPP
+#define MLPACK_METHODS_KMEANS_DISTRIBUTED_KMEANS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "distributed_kmeans.hpp"
+
+#include <set>
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MetricType,
+         typename EmptyClusterPolicy,
+         template<class, class> class LloydStepType,
+         typename MatType>
+DistributedKMeans<MetricType, EmptyClusterPolicy, LloydStepType, MatType>::
+DistributedKMeans(const MPI_Comm communicator,
+                  const size_t maxIterations,
+                  const MetricType metric,
+                  const EmptyClusterPolicy emptyClusterAction) :
+    communicator(communicator),
+    maxIterations(maxIterations),
+    metric(metric),
+    emptyClusterAction(emptyClusterAction)
+{
+  // Nothing to do.
+}
+
+template<typename MetricType,
+         typename EmptyClusterPolicy,
+         template<class, class> class LloydStepType,
+         typename MatType>
+size_t DistributedKMeans<MetricType, EmptyClusterPolicy, LloydStepType,
+    MatType>::Rank() const
+{
+  int rank;
+  MPI_Comm_rank(communicator, &rank);
+  return (size_t) rank;
+}
+
+template<typename MetricType,
+         typename EmptyClusterPolicy,
+         template<class, class> class LloydStepType,
+         typename MatType>
+size_t DistributedKMeans<MetricType, EmptyClusterPolicy, LloydStepType,
+    MatType>::Ranks() const
+{
+  int ranks;
+  MPI_Comm_size(communicator, &ranks);
+  return (size_t) ranks;
+}
+
+template<typename MetricType,
+         typename EmptyClusterPolicy,
+         template<class, class> class LloydStepType,
+         typename MatType>
+void DistributedKMeans<MetricType, EmptyClusterPolicy, LloydStepType,
+    MatType>::Cluster(const MatType& shard,
+                      const size_t clusters,
+                      arma::mat& centroids,
+                      const bool initialGuess)
+{
+  const bool root = (Rank() == 0);
+
+  if (initialGuess)
+  {
+    Broadcast(centroids);
+
+    if (centroids.n_cols != clusters)
+      Log::Fatal << "DistributedKMeans::Cluster(): wrong number of initial "
+          << "cluster centroids (" << centroids.n_cols << ", should be "
+          << clusters << ")!" << std::endl;
+
+    if (centroids.n_rows != shard.n_rows)
+      Log::Fatal << "DistributedKMeans::Cluster(): initial cluster centroids "
+          << "have wrong dimensionality (" << centroids.n_rows << ", should be "
+          << shard.n_rows << ")!" << std::endl;
+  }
+  else
+  {
+    InitialCentroids(shard, clusters, centroids);
+  }
+
+  // Counts of points in each cluster, on this rank and on all of them.
+  arma::Col<size_t> counts(clusters);
+  std::vector<unsigned long long> shardCounts(clusters), totalCounts(clusters);
+
+  size_t iteration = 0;
+
+  LloydStepType<MetricType, MatType> lloydStep(shard, metric);
+  arma::mat newCentroids;
+  arma::mat sums;
+  double cNorm;
+
+  static const TimerSection iterationSection("kmeans_iteration");
+  do
+  {
+    ScopedTimer iterationTimer(iterationSection);
+
+    // Find the means of the points of this shard, and turn them back into
+    // sums, which can be added across the ranks.
+    lloydStep.Iterate(centroids, newCentroids, counts);
+    sums.zeros(centroids.n_rows, clusters);
+    for (size_t i = 0; i < clusters; ++i)
+    {
+      shardCounts[i] = counts[i];
+      if (counts[i] != 0)
+        sums.col(i) = newCentroids.col(i) * (double) counts[i];
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE, sums.memptr(), (int) sums.n_elem, MPI_DOUBLE,
+        MPI_SUM, communicator);
+    MPI_Allreduce(shardCounts.data(), totalCounts.data(), (int) clusters,
+        MPI_UNSIGNED_LONG_LONG, MPI_SUM, communicator);
+
+    // The means of the whole dataset are the same on every rank, and so is
+    // the residual.
+    cNorm = 0.0;
+    newCentroids.zeros(centroids.n_rows, clusters);
+    bool empty = false;
+    for (size_t i = 0; i < clusters; ++i)
+    {
+      counts[i] = (size_t) totalCounts[i];
+      if (counts[i] == 0)
+      {
+        empty = true;
+        continue;
+      }
+
+      newCentroids.col(i) = sums.col(i) / (double) counts[i];
+      cNorm += std::pow(metric.Evaluate(centroids.col(i),
+          newCentroids.col(i)), 2.0);
+    }
+    cNorm = std::sqrt(cNorm);
+
+    // Rank 0 decides what to do with empty clusters.
+    if (empty)
+    {
+      if (root)
+      {
+        for (size_t i = 0; i < counts.n_elem; i++)
+        {
+          if (counts[i] == 0)
+          {
+            Log::Info << "Cluster " << i << " is empty.\n";
+            emptyClusterAction.EmptyCluster(shard, i, centroids, newCentroids,
+                counts, metric, iteration);
+          }
+        }
+      }
+
+      Broadcast(newCentroids);
+    }
+
+    centroids.swap(newCentroids);
+
+    iteration++;
+    if (root)
+    {
+      Log::Info << "DistributedKMeans::Cluster(): iteration " << iteration
+          << ", residual " << cNorm << ".\n";
+    }
+    if (std::isnan(cNorm) || std::isinf(cNorm))
+      cNorm = 1e-4; // Keep iterating.
+  } while (cNorm > 1e-5 && iteration != maxIterations);
+
+  if (root)
+  {
+    if (iteration != maxIterations)
+    {
+      Log::Info << "DistributedKMeans::Cluster(): converged after "
+          << iteration << " iterations." << std::endl;
+    }
+    else
+    {
+      Log::Info << "DistributedKMeans::Cluster(): terminated after limit of "
+          << iteration << " iterations." << std::endl;
+    }
+  }
+  Log::Info << lloydStep.DistanceCalculations() << " distance calculations on "
+      << "rank " << Rank() << "." << std::endl;
+}
+
+template<typename MetricType,
+         typename EmptyClusterPolicy,
+         template<class, class> class LloydStepType,
+         typename MatType>
+void DistributedKMeans<MetricType, EmptyClusterPolicy, LloydStepType,
+    MatType>::Cluster(const MatType& shard,
+                      const size_t clusters,
+                      arma::Row<size_t>& assignments,
+                      arma::mat& centroids,
+                      const bool initialGuess)
+{
+  Cluster(shard, clusters, centroids, initialGuess);
+
+  // Calculate final assignments in parallel over the shard.
+  assignments.set_size(shard.n_cols);
+
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) shard.n_cols; ++i)
+  {
+    // Find the closest centroid to this point.
+    double minDistance = std::numeric_limits<double>::infinity();
+    size_t closestCluster = centroids.n_cols; // Invalid value.
+
+    for (size_t j = 0; j < centroids.n_cols; j++)
+    {
+      const double distance = metric.Evaluate(shard.col(i), centroids.col(j));
+
+      if (distance < minDistance)
+      {
+        minDistance = distance;
+        closestCluster = j;
+      }
+    }
+
+    Log::Assert(closestCluster != centroids.n_cols);
+    assignments[i] = closestCluster;
+  }
+}
+
+template<typename MetricType,
+         typename EmptyClusterPolicy,
+         template<class, class> class LloydStepType,
+         typename MatType>
+void DistributedKMeans<MetricType, EmptyClusterPolicy, LloydStepType,
+    MatType>::InitialCentroids(const MatType& shard,
+                               const size_t clusters,
+                               arma::mat& centroids)
+{
+  // Find which points of the whole dataset each rank holds.
+  const size_t ranks = Ranks();
+  const size_t rank = Rank();
+  unsigned long long shardPoints = shard.n_cols;
+  std::vector<unsigned long long> points(ranks);
+  MPI_Allgather(&shardPoints, 1, MPI_UNSIGNED_LONG_LONG, points.data(), 1,
+      MPI_UNSIGNED_LONG_LONG, communicator);
+
+  unsigned long long first = 0, total = 0;
+  for (size_t i = 0; i < ranks; ++i)
+  {
+    if (i < rank)
+      first += points[i];
+    total += points[i];
+  }
+
+  if (clusters > total)
+  {
+    Log::Fatal << "DistributedKMeans::Cluster(): more clusters requested ("
+        << clusters << ") than points given (" << total << ")!" << std::endl;
+  }
+
+  // Rank 0 chooses the points (so the random seed of the other ranks does not
+  // matter).
+  std::vector<unsigned long long> chosen(clusters);
+  if (rank == 0)
+  {
+    std::uniform_int_distribution<unsigned long long> distribution(0,
+        total - 1);
+    std::set<unsigned long long> taken;
+    for (size_t i = 0; i < clusters; ++i)
+    {
+      unsigned long long point;
+      do
+      {
+        point = distribution(math::randGen);
+      } while (!taken.insert(point).second);
+      chosen[i] = point;
+    }
+  }
+  MPI_Bcast(chosen.data(), (int) clusters, MPI_UNSIGNED_LONG_LONG, 0,
+      communicator);
+
+  // Each rank fills in the points that it holds.
+  centroids.zeros(shard.n_rows, clusters);
+  for (size_t i = 0; i < clusters; ++i)
+  {
+    if (chosen[i] >= first && chosen[i] < first + shardPoints)
+      centroids.col(i) = arma::vec(shard.col((size_t) (chosen[i] - first)));
+  }
+
+  MPI_Allreduce(MPI_IN_PLACE, centroids.memptr(), (int) centroids.n_elem,
+      MPI_DOUBLE, MPI_SUM, communicator);
+}
+
+template<typename MetricType,
+         typename EmptyClusterPolicy,
+         template<class, class> class LloydStepType,
+         typename MatType>
+void DistributedKMeans<MetricType, EmptyClusterPolicy, LloydStepType,
+    MatType>::Broadcast(arma::mat& matrix)
+{
+  unsigned long long size[2] = { matrix.n_rows, matrix.n_cols };
+  MPI_Bcast(size, 2, MPI_UNSIGNED_LONG_LONG, 0, communicator);
+  matrix.set_size((size_t) size[0], (size_t) size[1]);
+  MPI_Bcast(matrix.memptr(), (int) matrix.n_elem, MPI_DOUBLE, 0,
+      communicator);
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
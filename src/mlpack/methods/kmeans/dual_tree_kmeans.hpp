@@ -18,12 +18,16 @@
 #include <mlpack/core/tree/binary_space_tree.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
 
 #include "dual_tree_kmeans_statistic.hpp"
 
 namespace mlpack {
 namespace kmeans {
 
+//! Check whether a tree type has Refit().
+HAS_MEM_FUNC(Refit, HasRefit);
+
 /**
  * An algorithm for an exact Lloyd iteration which simply uses dual-tree
  * nearest-neighbor search to find the nearest centroid for each point in the
@@ -50,11 +54,31 @@ class DualTreeKMeans
   using NNSTreeType =
       TreeType<TreeMetricType, DualTreeKMeansStatistic, TreeMatType>;
 
+  //! The nearest neighbor search type used on the centroids.
+  typedef neighbor::NeighborSearch<neighbor::NearestNeighborSort, MetricType,
+      MatType, NNSTreeType> NNSType;
+
   /**
    * Construct the DualTreeKMeans object, which will construct a tree on the
    * points.
+   *
+   * The tree on the centroids is built in the first iteration.  In later
+   * iterations, if the tree type supports it (see BinarySpaceTree::Refit()),
+   * the existing tree is refit to the moved centroids instead of being
+   * rebuilt; since refitting keeps the structure of the tree, its nodes get
+   * looser as the centroids move relative to each other, so the tree is
+   * rebuilt once the sum of the diameters of its nodes exceeds rebuildRatio
+   * times the sum when it was built.
+   *
+   * @param dataset Dataset to cluster.
+   * @param metric Instantiated metric.
+   * @param rebuildRatio Ratio of the diameters of the refit centroid tree to
+   *     those of the built tree above which it is rebuilt (DBL_MAX means
+   *     never; 1.0 means every iteration).
    */
-  DualTreeKMeans(const MatType& dataset, MetricType& metric);
+  DualTreeKMeans(const MatType& dataset,
+                 MetricType& metric,
+                 const double rebuildRatio = 1.5);
 
   /**
    * Delete the tree constructed by the DualTreeKMeans object.
@@ -78,6 +102,13 @@ class DualTreeKMeans
   //! Modify the number of distance calculations.
   size_t& DistanceCalculations() { return distanceCalculations; }
 
+  //! Get the number of times the centroid tree was rebuilt.
+  size_t TreeBuilds() const { return treeBuilds; }
+  //! Get the ratio of centroid tree diameters above which it is rebuilt.
+  double RebuildRatio() const { return rebuildRatio; }
+  //! Modify the ratio of centroid tree diameters above which it is rebuilt.
+  double& RebuildRatio() { return rebuildRatio; }
+
  private:
   //! The original dataset reference.
   const MatType& datasetOrig; // Maybe not necessary.
@@ -88,6 +119,17 @@ class DualTreeKMeans
   //! The metric.
   MetricType metric;
 
+  //! The search on the centroids, which holds the tree built on them.
+  NNSType* nns;
+  //! Mappings from the order of the centroid tree to the centroids.
+  std::vector<size_t> oldFromNewCentroids;
+  //! The sum of the node diameters of the centroid tree when it was built.
+  double builtDiameters;
+  //! Ratio of centroid tree diameters above which it is rebuilt.
+  double rebuildRatio;
+  //! Number of times the centroid tree was built.
+  size_t treeBuilds;
+
   //! Track distance calculations.
   size_t distanceCalculations;
   //! Track iteration number.
@@ -127,8 +169,34 @@ class DualTreeKMeans
 
   void CoalesceTree(Tree& node, const size_t child = 0);
   void DecoalesceTree(Tree& node);
+
+  //! Build (or refit) the tree on the given centroids.
+  void UpdateCentroidTree(const arma::mat& centroids);
 };
 
+//! Utility function for refitting a tree to the moved points of its dataset.
+//! This is called if the tree type has Refit(), and returns true.
+template<typename TreeType>
+bool RefitTree(TreeType& tree,
+               const arma::mat& points,
+               const std::vector<size_t>& oldFromNew,
+               const typename std::enable_if_t<
+                   HasRefit<TreeType, void(TreeType::*)()>::value>* junk = 0);
+
+//! Utility function for refitting a tree.  This is called if the tree type
+//! cannot be refit, and returns false, so that the tree will be rebuilt.
+template<typename TreeType>
+bool RefitTree(TreeType& tree,
+               const arma::mat& points,
+               const std::vector<size_t>& oldFromNew,
+               const typename std::enable_if_t<
+                   !HasRefit<TreeType, void(TreeType::*)()>::value>* junk = 0);
+
+//! Utility function returning the sum of the diameters of the bounds of all
+//! the nodes of a tree.
+template<typename TreeType>
+double TreeDiameters(const TreeType& node);
+
 //! Utility function for hiding children.  This actually does something, and is
 //! called if the tree is not a binary tree.
 template<typename TreeType>
@@ -54,11 +54,16 @@ template<typename MetricType,
                   typename TreeMatType> class TreeType>
 DualTreeKMeans<MetricType, MatType, TreeType>::DualTreeKMeans(
     const MatType& dataset,
-    MetricType& metric) :
+    MetricType& metric,
+    const double rebuildRatio) :
     datasetOrig(dataset),
     tree(new Tree(const_cast<MatType&>(dataset))),
     dataset(tree->Dataset()),
     metric(metric),
+    nns(NULL),
+    builtDiameters(0.0),
+    rebuildRatio(rebuildRatio),
+    treeBuilds(0),
     distanceCalculations(0),
     iteration(0),
     upperBounds(dataset.n_cols),
@@ -86,6 +91,8 @@ DualTreeKMeans<MetricType, MatType, TreeType>::~DualTreeKMeans()
 {
   if (tree)
     delete tree;
+  if (nns)
+    delete nns;
 }
 
 // Run a single iteration.
@@ -99,16 +106,9 @@ double DualTreeKMeans<MetricType, MatType, TreeType>::Iterate(
     arma::mat& newCentroids,
     arma::Col<size_t>& counts)
 {
-  // Build a tree on the centroids.  This will make a copy if necessary, which
-  // is unfortunate, but I don't see a reasonable way around it.
-  std::vector<size_t> oldFromNewCentroids;
-  Tree* centroidTree = BuildTree<Tree>(centroids, oldFromNewCentroids);
-
-  // Find the nearest neighbors of each of the clusters.  We have to make our
-  // own TreeType, which is a little bit abuse, but we know for sure the
-  // TreeStatType we have will work.
-  neighbor::NeighborSearch<neighbor::NearestNeighborSort, MetricType, MatType,
-      NNSTreeType> nns(std::move(*centroidTree));
+  // Build a tree on the centroids, or refit the one from the last iteration.
+  UpdateCentroidTree(centroids);
+  NNSType& nns = *this->nns;
 
   // Reset information in the tree, if we need to.
   if (iteration > 0)
@@ -199,13 +199,43 @@ double DualTreeKMeans<MetricType, MatType, TreeType>::Iterate(
   }
   distanceCalculations += centroids.n_cols;
 
-  delete centroidTree;
-
   ++iteration;
 
   return std::sqrt(residual);
 }
 
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void DualTreeKMeans<MetricType, MatType, TreeType>::UpdateCentroidTree(
+    const arma::mat& centroids)
+{
+  // The centroids move less and less as the algorithm converges, so it is
+  // much cheaper to refit the bounds of the tree than to rebuild it, as long
+  // as the bounds have not become too loose.
+  if (nns && nns->ReferenceTree().Dataset().n_cols == centroids.n_cols &&
+      RefitTree(nns->ReferenceTree(), centroids, oldFromNewCentroids) &&
+      TreeDiameters(nns->ReferenceTree()) <= rebuildRatio * builtDiameters)
+    return;
+
+  // Build a tree on the centroids.  This will make a copy if necessary, which
+  // is unfortunate, but I don't see a reasonable way around it.
+  oldFromNewCentroids.clear();
+  Tree* centroidTree = BuildTree<Tree>(centroids, oldFromNewCentroids);
+
+  // Find the nearest neighbors of each of the clusters.  We have to make our
+  // own TreeType, which is a little bit abuse, but we know for sure the
+  // TreeStatType we have will work.
+  delete nns;
+  nns = new NNSType(std::move(*centroidTree));
+  delete centroidTree;
+
+  builtDiameters = TreeDiameters(nns->ReferenceTree());
+  ++treeBuilds;
+}
+
 template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
@@ -684,6 +714,52 @@ void RestoreChildren(TreeType& node,
   }
 }
 
+//! Utility function for refitting a tree that has Refit().
+template<typename TreeType>
+bool RefitTree(TreeType& tree,
+               const arma::mat& points,
+               const std::vector<size_t>& oldFromNew,
+               const typename std::enable_if_t<
+                   HasRefit<TreeType, void(TreeType::*)()>::value>*)
+{
+  // Write the new points in the order of the tree.
+  typename TreeType::Mat& dataset = tree.Dataset();
+  if (oldFromNew.size() == dataset.n_cols)
+  {
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+      dataset.col(i) = points.col(oldFromNew[i]);
+  }
+  else
+  {
+    dataset = points;
+  }
+
+  tree.Refit();
+  return true;
+}
+
+//! Utility function for refitting a tree that does not have Refit().
+template<typename TreeType>
+bool RefitTree(TreeType& /* tree */,
+               const arma::mat& /* points */,
+               const std::vector<size_t>& /* oldFromNew */,
+               const typename std::enable_if_t<
+                   !HasRefit<TreeType, void(TreeType::*)()>::value>*)
+{
+  return false;
+}
+
+//! Utility function returning the sum of the node diameters of a tree.
+template<typename TreeType>
+double TreeDiameters(const TreeType& node)
+{
+  double diameters = 2.0 * node.FurthestDescendantDistance();
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+    diameters += TreeDiameters(node.Child(i));
+
+  return diameters;
+}
+
 } // namespace kmeans
 } // namespace mlpack
 
@@ -2,7 +2,8 @@
  * @file elkan_kmeans.hpp
  * @author Ryan Curtin
  *
- * An implementation of Elkan's algorithm for exact Lloyd iterations.
+ * An implementation of Elkan's algorithm for exact Lloyd iterations, using
+ * OpenMP for parallelization over multiple threads.
  *
  * mlpack is free software; you may redistribute it and/or modify it under the
  * terms of the 3-clause BSD license.  You should have received a copy of the
@@ -12,6 +13,8 @@
 #ifndef MLPACK_METHODS_KMEANS_ELKAN_KMEANS_HPP
 #define MLPACK_METHODS_KMEANS_ELKAN_KMEANS_HPP
 
+#include "point_distances.hpp"
+
 namespace mlpack {
 namespace kmeans {
 
@@ -43,6 +46,8 @@ class ElkanKMeans
   const MatType& dataset;
   //! The instantiated metric.
   MetricType& metric;
+  //! The distances between points and the current centroids.
+  PointDistances<MetricType, MatType> pointDistances;
 
   //! Holds intra-cluster distances.
   arma::mat clusterDistances;
@@ -2,7 +2,8 @@
  * @file hamerly_kmeans.hpp
  * @author Ryan Curtin
  *
- * An implementation of Greg Hamerly's algorithm for k-means clustering.
+ * An implementation of Greg Hamerly's algorithm for k-means clustering, using
+ * OpenMP for parallelization over multiple threads.
  *
  * mlpack is free software; you may redistribute it and/or modify it under the
  * terms of the 3-clause BSD license.  You should have received a copy of the
@@ -12,6 +13,8 @@
 #ifndef MLPACK_METHODS_KMEANS_HAMERLY_KMEANS_HPP
 #define MLPACK_METHODS_KMEANS_HAMERLY_KMEANS_HPP
 
+#include "point_distances.hpp"
+
 namespace mlpack {
 namespace kmeans {
 
@@ -44,6 +47,8 @@ class HamerlyKMeans
   const MatType& dataset;
   //! The instantiated metric.
   MetricType& metric;
+  //! The distances between points and the current centroids.
+  PointDistances<MetricType, MatType> pointDistances;
 
   //! Minimum cluster distances from each cluster.
   arma::vec minClusterDistances;
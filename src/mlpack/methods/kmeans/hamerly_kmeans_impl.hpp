@@ -23,6 +23,7 @@ HamerlyKMeans<MetricType, MatType>::HamerlyKMeans(const MatType& dataset,
                                                   MetricType& metric) :
     dataset(dataset),
     metric(metric),
+    pointDistances(dataset, metric),
     distanceCalculations(0)
 {
   // Nothing to do.
@@ -48,82 +49,114 @@ double HamerlyKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
   // Reset new centroids.
   newCentroids.zeros(centroids.n_rows, centroids.n_cols);
   counts.zeros(centroids.n_cols);
+  pointDistances.Centroids(centroids);
 
-  // Calculate minimum intra-cluster distance for each cluster.
+  // Calculate minimum intra-cluster distance for each cluster.  Each pair is
+  // evaluated by only one thread, which keeps the minima it finds for both
+  // clusters; the minima of the threads are merged at the end.  The rows get
+  // shorter, so they are scheduled dynamically.
   minClusterDistances.fill(DBL_MAX);
-  for (size_t i = 0; i < centroids.n_cols; ++i)
+  #pragma omp parallel
   {
-    for (size_t j = i + 1; j < centroids.n_cols; ++j)
+    arma::vec localMinClusterDistances(centroids.n_cols);
+    localMinClusterDistances.fill(DBL_MAX);
+
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t i = 0; i < (omp_size_t) centroids.n_cols; ++i)
     {
-      const double dist = metric.Evaluate(centroids.col(i), centroids.col(j)) /
-          2.0;
-      ++distanceCalculations;
-
-      // Update bounds, if this intra-cluster distance is smaller.
-      if (dist < minClusterDistances(i))
-        minClusterDistances(i) = dist;
-      if (dist < minClusterDistances(j))
-        minClusterDistances(j) = dist;
+      for (size_t j = i + 1; j < centroids.n_cols; ++j)
+      {
+        const double dist = metric.Evaluate(centroids.col(i),
+            centroids.col(j)) / 2.0;
+        if (dist < localMinClusterDistances(i))
+          localMinClusterDistances(i) = dist;
+        if (dist < localMinClusterDistances(j))
+          localMinClusterDistances(j) = dist;
+      }
     }
+
+    #pragma omp critical
+    minClusterDistances = arma::min(minClusterDistances,
+        localMinClusterDistances);
   }
+  distanceCalculations += centroids.n_cols * (centroids.n_cols - 1) / 2;
 
-  for (size_t i = 0; i < dataset.n_cols; ++i)
+  // The bounds and assignment of each point are only touched by the thread
+  // that handles it, and each thread accumulates its own centroids.
+  #pragma omp parallel reduction(+:hamerlyPruned)
   {
-    const double m = std::max(minClusterDistances(assignments[i]),
-                              lowerBounds(i));
-
-    // First bound test.
-    if (upperBounds(i) <= m)
-    {
-      ++hamerlyPruned;
-      newCentroids.col(assignments[i]) += dataset.col(i);
-      ++counts(assignments[i]);
-      continue;
-    }
-
-    // Tighten upper bound.
-    upperBounds(i) = metric.Evaluate(dataset.col(i),
-                                     centroids.col(assignments[i]));
-    ++distanceCalculations;
+    arma::mat localCentroids(centroids.n_rows, centroids.n_cols,
+        arma::fill::zeros);
+    arma::Col<size_t> localCounts(centroids.n_cols, arma::fill::zeros);
+    size_t localDistanceCalculations = 0;
 
-    // Second bound test.
-    if (upperBounds(i) <= m)
+    #pragma omp for
+    for (omp_size_t i = 0; i < (omp_size_t) dataset.n_cols; ++i)
     {
-      newCentroids.col(assignments[i]) += dataset.col(i);
-      ++counts(assignments[i]);
-      continue;
-    }
+      const double m = std::max(minClusterDistances(assignments[i]),
+                                lowerBounds(i));
 
-    // The bounds failed.  So test against all other clusters.
-    // This is Hamerly's Point-All-Ctrs() function from the paper.
-    // We have to reset the lower bound first.
-    lowerBounds(i) = DBL_MAX;
-    for (size_t c = 0; c < centroids.n_cols; ++c)
-    {
-      if (c == assignments[i])
+      // First bound test.
+      if (upperBounds(i) <= m)
+      {
+        ++hamerlyPruned;
+        AddPoint(dataset, i, localCentroids, assignments[i]);
+        ++localCounts(assignments[i]);
         continue;
+      }
 
-      const double dist = metric.Evaluate(dataset.col(i), centroids.col(c));
+      // Tighten upper bound.
+      upperBounds(i) = pointDistances.Evaluate(i, assignments[i]);
+      ++localDistanceCalculations;
 
-      // Is this a better cluster?  At this point, upperBounds[i] = d(i, c(i)).
-      if (dist < upperBounds(i))
+      // Second bound test.
+      if (upperBounds(i) <= m)
       {
-        // lowerBounds holds the second closest cluster.
-        lowerBounds(i) = upperBounds(i);
-        upperBounds(i) = dist;
-        assignments[i] = c;
+        AddPoint(dataset, i, localCentroids, assignments[i]);
+        ++localCounts(assignments[i]);
+        continue;
       }
-      else if (dist < lowerBounds(i))
+
+      // The bounds failed.  So test against all other clusters.
+      // This is Hamerly's Point-All-Ctrs() function from the paper.
+      // We have to reset the lower bound first.
+      lowerBounds(i) = DBL_MAX;
+      for (size_t c = 0; c < centroids.n_cols; ++c)
       {
-        // This is a closer second-closest cluster.
-        lowerBounds(i) = dist;
+        if (c == assignments[i])
+          continue;
+
+        const double dist = pointDistances.Evaluate(i, c);
+
+        // Is this a better cluster?  At this point, upperBounds[i] =
+        // d(i, c(i)).
+        if (dist < upperBounds(i))
+        {
+          // lowerBounds holds the second closest cluster.
+          lowerBounds(i) = upperBounds(i);
+          upperBounds(i) = dist;
+          assignments[i] = c;
+        }
+        else if (dist < lowerBounds(i))
+        {
+          // This is a closer second-closest cluster.
+          lowerBounds(i) = dist;
+        }
       }
+      localDistanceCalculations += centroids.n_cols - 1;
+
+      // Update new centroids.
+      AddPoint(dataset, i, localCentroids, assignments[i]);
+      ++localCounts(assignments[i]);
     }
-    distanceCalculations += centroids.n_cols - 1;
 
-    // Update new centroids.
-    newCentroids.col(assignments[i]) += dataset.col(i);
-    ++counts(assignments[i]);
+    // Combine the results of each thread.
+    #pragma omp critical
+    {
+      newCentroids += localCentroids;
+      counts += localCounts;
+      distanceCalculations += localDistanceCalculations;
+    }
   }
 
   // Normalize centroids and calculate cluster movement (contains parts of
@@ -158,7 +191,8 @@ double HamerlyKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
   }
 
   // Now update bounds (lines 3-8 of Update-Bounds()).
-  for (size_t i = 0; i < dataset.n_cols; ++i)
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) dataset.n_cols; ++i)
   {
     upperBounds(i) += centroidMovements(assignments[i]);
     if (assignments[i] == furthestMovingCluster)
@@ -192,7 +192,7 @@ Cluster(const MatType& data,
       centroids.zeros(data.n_rows, clusters);
       for (size_t i = 0; i < data.n_cols; ++i)
       {
-        centroids.col(assignments[i]) += arma::vec(data.col(i));
+        AddPoint(data, i, centroids, assignments[i]);
         counts[assignments[i]]++;
       }
 
@@ -211,8 +211,11 @@ Cluster(const MatType& data,
   arma::mat centroidsOther;
   double cNorm;
 
+  static const TimerSection iterationSection("kmeans_iteration");
   do
   {
+    ScopedTimer iterationTimer(iterationSection);
+
     // We have two centroid matrices.  We don't want to copy anything, so,
     // depending on the iteration number, we use a different centroid matrix...
     if (iteration % 2 == 0)
@@ -299,7 +302,7 @@ Cluster(const MatType& data,
     centroids.zeros(data.n_rows, clusters);
     for (size_t i = 0; i < data.n_cols; ++i)
     {
-      centroids.col(assignments[i]) += arma::vec(data.col(i));
+      AddPoint(data, i, centroids, assignments[i]);
       counts[assignments[i]]++;
     }
 
@@ -313,6 +316,8 @@ Cluster(const MatType& data,
 
   // Calculate final assignments in parallel over the entire dataset.
   assignments.set_size(data.n_cols);
+  PointDistances<MetricType, MatType> distances(data, metric);
+  distances.Centroids(centroids);
 
   #pragma omp parallel for
   for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
@@ -323,7 +328,7 @@ Cluster(const MatType& data,
 
     for (size_t j = 0; j < centroids.n_cols; j++)
     {
-      const double distance = metric.Evaluate(data.col(i), centroids.col(j));
+      const double distance = distances.Evaluate(i, j);
 
       if (distance < minDistance)
       {
@@ -19,8 +19,13 @@
 #include "refined_start.hpp"
 #include "elkan_kmeans.hpp"
 #include "hamerly_kmeans.hpp"
+#include "yinyang_kmeans.hpp"
 #include "pelleg_moore_kmeans.hpp"
 #include "dual_tree_kmeans.hpp"
+#include "mini_batch_kmeans.hpp"
+#ifdef HAS_MPI
+  #include "distributed_kmeans.hpp"
+#endif
 
 using namespace mlpack;
 using namespace mlpack::kmeans;
@@ -54,9 +59,15 @@ PROGRAM_INFO("K-Means Clustering",
     " option.  The standard O(kN) approach can be used ('naive').  Other "
     "options include the Pelleg-Moore tree-based algorithm ('pelleg-moore'), "
     "Elkan's triangle-inequality based algorithm ('elkan'), Hamerly's "
-    "modification to Elkan's algorithm ('hamerly'), the dual-tree k-means "
-    "algorithm ('dualtree'), and the dual-tree k-means algorithm using the "
-    "cover tree ('dualtree-covertree')."
+    "modification to Elkan's algorithm ('hamerly'), Yinyang k-means, which "
+    "keeps bounds for groups of centroids and is a good choice for large k "
+    "('yinyang'), the dual-tree k-means "
+    "algorithm ('dualtree'), the dual-tree k-means algorithm using the "
+    "cover tree ('dualtree-covertree'), and mini-batch k-means "
+    "('mini-batch'), which only looks at a random sample of " +
+    PRINT_PARAM_STRING("batch_size") + " points in each iteration and is the "
+    "fastest option for very large datasets, at the price of approximate "
+    "centroids."
     "\n\n"
     "The behavior for when an empty cluster is encountered can be modified with"
     " the " + PRINT_PARAM_STRING("allow_empty_clusters") + " option.  When "
@@ -71,6 +82,14 @@ PROGRAM_INFO("K-Means Clustering",
     "calculate; therefore, specifying either of these parameters will often "
     "accelerate runtime."
     "\n\n"
+    "If mlpack was built with MPI, the " + PRINT_PARAM_STRING("distributed") +
+    " option clusters a dataset that is split across the processes that the "
+    "program was started with (with mpirun): each process loads its own shard "
+    "of the dataset from the input file, with '{rank}' in the filename "
+    "replaced by the rank of the process, and process 0 saves the centroids.  "
+    "Only the 'naive' and 'pelleg-moore' algorithms can be distributed, and the"
+    " assignments of the points are not saved."
+    "\n\n"
     "Initial clustering assignments may be specified using the " +
     PRINT_PARAM_STRING("initial_centroids") + " parameter, and the maximum "
     "number of iterations may be specified with the " +
@@ -141,8 +160,26 @@ PARAM_DOUBLE_IN("percentage", "Percentage of dataset to use for each refined "
     "start sampling (use when --refined_start is specified).", "p", 0.02);
 
 PARAM_STRING_IN("algorithm", "Algorithm to use for the Lloyd iteration "
-    "('naive', 'pelleg-moore', 'elkan', 'hamerly', 'dualtree', or "
-    "'dualtree-covertree').", "a", "naive");
+    "('naive', 'pelleg-moore', 'elkan', 'hamerly', 'yinyang', 'dualtree', "
+    "'dualtree-covertree', or 'mini-batch').", "a", "naive");
+PARAM_FLAG("distributed", "Cluster a dataset split across the MPI processes of "
+    "the program; the input filename may contain '{rank}' (requires mlpack "
+    "built with MPI; do not use in Python).", "");
+
+PARAM_INT_IN("batch_size", "Number of points sampled in each iteration of "
+    "mini-batch k-means (use when --algorithm is 'mini-batch').", "b", 1000);
+
+// MiniBatchKMeans with the batch size given on the command line, so that it can
+// be used as a LloydStepType.
+template<typename MetricType, typename MatType>
+class CLIMiniBatchKMeans : public MiniBatchKMeans<MetricType, MatType>
+{
+ public:
+  CLIMiniBatchKMeans(const MatType& dataset, MetricType& metric) :
+      MiniBatchKMeans<MetricType, MatType>(dataset, metric,
+          (size_t) CLI::GetParam<int>("batch_size"))
+  { }
+};
 
 // Given the type of initial partition policy, figure out the empty cluster
 // policy and run k-means.
@@ -160,6 +197,12 @@ template<typename InitialPartitionPolicy,
          template<class, class> class LloydStepType>
 void RunKMeans(const InitialPartitionPolicy& ipp);
 
+// Given the template parameters, load the shard of this process and run
+// distributed k-means.
+template<typename EmptyClusterPolicy,
+         template<class, class> class LloydStepType>
+void RunDistributedKMeans();
+
 static void mlpackMain()
 {
   // Initialize random seed.
@@ -171,6 +214,9 @@ static void mlpackMain()
   // Now, start building the KMeans type that we'll be using.  Start with the
   // initial partition policy.  The call to FindEmptyClusterPolicy<> results in
   // a call to RunKMeans<> and the algorithm is completed.
+  // Distributed k-means samples the initial centroids from all the shards.
+  ReportIgnoredParam({{ "distributed", true }}, "refined_start");
+
   if (CLI::HasParam("refined_start"))
   {
     RequireParamValue<int>("samplings", [](int x) { return x > 0; }, true,
@@ -212,15 +258,32 @@ void FindEmptyClusterPolicy(const InitialPartitionPolicy& ipp)
 template<typename InitialPartitionPolicy, typename EmptyClusterPolicy>
 void FindLloydStepType(const InitialPartitionPolicy& ipp)
 {
-  RequireParamInSet<string>("algorithm", { "elkan", "hamerly", "pelleg-moore",
-      "dualtree", "dualtree-covertree", "naive" }, true, "unknown k-means "
-      "algorithm");
+  RequireParamInSet<string>("algorithm", { "elkan", "hamerly", "yinyang",
+      "pelleg-moore", "dualtree", "dualtree-covertree", "naive", "mini-batch" },
+      true,
+      "unknown k-means algorithm");
 
   const string algorithm = CLI::GetParam<string>("algorithm");
+  if (algorithm != "mini-batch")
+    ReportIgnoredParam("batch_size", "the algorithm is not 'mini-batch'");
+
+  if (CLI::HasParam("distributed"))
+  {
+    RequireParamInSet<string>("algorithm", { "naive", "pelleg-moore" }, true,
+        "only the 'naive' and 'pelleg-moore' algorithms can be distributed");
+    if (algorithm == "naive")
+      RunDistributedKMeans<EmptyClusterPolicy, NaiveKMeans>();
+    else
+      RunDistributedKMeans<EmptyClusterPolicy, PellegMooreKMeans>();
+    return;
+  }
+
   if (algorithm == "elkan")
     RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, ElkanKMeans>(ipp);
   else if (algorithm == "hamerly")
     RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, HamerlyKMeans>(ipp);
+  else if (algorithm == "yinyang")
+    RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, YinyangKMeans>(ipp);
   else if (algorithm == "pelleg-moore")
     RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy,
         PellegMooreKMeans>(ipp);
@@ -232,6 +295,13 @@ void FindLloydStepType(const InitialPartitionPolicy& ipp)
         CoverTreeDualTreeKMeans>(ipp);
   else if (algorithm == "naive")
     RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, NaiveKMeans>(ipp);
+  else if (algorithm == "mini-batch")
+  {
+    RequireParamValue<int>("batch_size", [](int x) { return x > 0; }, true,
+        "batch size must be positive");
+    RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy,
+        CLIMiniBatchKMeans>(ipp);
+  }
 }
 
 // Given the template parameters, sanitize/load input and run k-means.
@@ -348,3 +418,80 @@ void RunKMeans(const InitialPartitionPolicy& ipp)
   if (CLI::HasParam("centroid"))
     CLI::GetParam<arma::mat>("centroid") = std::move(centroids);
 }
+
+// Given the template parameters, load the shard of this process and run
+// distributed k-means.
+template<typename EmptyClusterPolicy,
+         template<class, class> class LloydStepType>
+void RunDistributedKMeans()
+{
+#ifdef HAS_MPI
+  if (!CLI::HasParam("initial_centroids"))
+  {
+    RequireParamValue<int>("clusters", [](int x) { return x > 0; }, true,
+        "number of clusters must be positive");
+  }
+  else
+  {
+    ReportIgnoredParam({{ "initial_centroids", true }}, "clusters");
+  }
+
+  RequireParamValue<int>("max_iterations", [](int x) { return x >= 0; }, true,
+    "maximum iterations must be positive or 0 (for no limit)");
+  const int maxIterations = CLI::GetParam<int>("max_iterations");
+
+  // The shards are too large to gather the assignments in one file.
+  ReportIgnoredParam({{ "distributed", true }}, "output");
+  ReportIgnoredParam({{ "distributed", true }}, "in_place");
+  ReportIgnoredParam({{ "distributed", true }}, "labels_only");
+  RequireAtLeastOnePassed({ "centroid" }, false, "no results will be saved");
+
+  int initialized;
+  MPI_Initialized(&initialized);
+  if (!initialized)
+    MPI_Init(NULL, NULL);
+
+  int rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+  // Each process loads its own shard.
+  string filename = CLI::GetPrintableParam<arma::mat>("input");
+  const size_t position = filename.find("{rank}");
+  if (position != string::npos)
+    filename.replace(position, 6, std::to_string(rank));
+
+  arma::mat shard;
+  data::Load(filename, shard, true);
+
+  // Only the initial centroids of process 0 are used.
+  int clusters = CLI::GetParam<int>("clusters");
+  arma::mat centroids;
+  const bool initialCentroidGuess = CLI::HasParam("initial_centroids");
+  if (initialCentroidGuess)
+  {
+    if (rank == 0)
+      centroids = std::move(CLI::GetParam<arma::mat>("initial_centroids"));
+
+    unsigned long long columns = centroids.n_cols;
+    MPI_Bcast(&columns, 1, MPI_UNSIGNED_LONG_LONG, 0, MPI_COMM_WORLD);
+    if (clusters == 0)
+      clusters = (int) columns;
+  }
+
+  Timer::Start("clustering");
+  DistributedKMeans<metric::EuclideanDistance,
+                    EmptyClusterPolicy,
+                    LloydStepType> kmeans(MPI_COMM_WORLD, maxIterations);
+  kmeans.Cluster(shard, clusters, centroids, initialCentroidGuess);
+  Timer::Stop("clustering");
+
+  // The centroids are the same on every process.
+  if (rank == 0 && CLI::HasParam("centroid"))
+    CLI::GetParam<arma::mat>("centroid") = std::move(centroids);
+
+  MPI_Finalize();
+#else
+  Log::Fatal << "Distributed k-means is not available; mlpack must be built "
+      << "with MPI (-DUSE_MPI=ON)." << endl;
+#endif
+}
@@ -0,0 +1,137 @@
+/**
+ * @file kmeans_parallel_initialization.hpp
+ *
+ * An implementation of the k-means|| (scalable k-means++) initialization
+ * strategy, which chooses initial centroids that are spread out over the data
+ * with a few parallel passes over the dataset.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_INITIALIZATION_HPP
+#define MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_INITIALIZATION_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * The k-means|| initialization strategy, a parallel version of k-means++
+ * seeding.  k-means++ picks the centroids one at a time, each with probability
+ * proportional to its squared distance to the centroids picked so far, so it
+ * needs k sequential passes over the data.  k-means|| instead starts from one
+ * random point and, in each of a few rounds, samples about oversampling * k
+ * candidates at once with the same kind of probabilities.  Each candidate is
+ * then weighted by the number of points closest to it, and the candidates are
+ * reclustered into k centroids with weighted k-means++ seeding followed by
+ * weighted Lloyd iterations.  The passes over the dataset run in parallel with
+ * OpenMP; the reclustering only looks at the candidates, of which there are
+ * about rounds * oversampling * k.
+ *
+ * The random decisions for each point of the dataset are derived from
+ * math::RandInt() and the index of the point, so the results only depend on
+ * the random seed and not on the number of threads.
+ *
+ * For more information, see the following paper.
+ *
+ * @code
+ * @article{bahmani2012scalable,
+ *   title={Scalable k-means++},
+ *   author={Bahmani, B. and Moseley, B. and Vattani, A. and Kumar, R. and
+ *       Vassilvitskii, S.},
+ *   journal={Proceedings of the VLDB Endowment},
+ *   volume={5},
+ *   number={7},
+ *   pages={622--633},
+ *   year={2012}
+ * }
+ * @endcode
+ */
+class KMeansParallelInitialization
+{
+ public:
+  /**
+   * Create the KMeansParallelInitialization object, optionally specifying the
+   * number of sampling rounds and the oversampling factor.
+   *
+   * @param rounds Number of sampling rounds.
+   * @param oversampling Expected number of candidates sampled in each round,
+   *     as a multiple of the number of clusters.
+   */
+  KMeansParallelInitialization(const size_t rounds = 5,
+                               const double oversampling = 2.0) :
+      rounds(rounds), oversampling(oversampling) { }
+
+  /**
+   * Choose initial centroids for the given number of clusters with the
+   * k-means|| algorithm.
+   *
+   * @tparam MatType Type of data (arma::mat or arma::sp_mat).
+   * @param data Dataset.
+   * @param clusters Number of clusters.
+   * @param centroids Matrix to put initial centroids into.
+   */
+  template<typename MatType>
+  void Cluster(const MatType& data,
+               const size_t clusters,
+               arma::mat& centroids) const;
+
+  //! Get the number of sampling rounds.
+  size_t Rounds() const { return rounds; }
+  //! Modify the number of sampling rounds.
+  size_t& Rounds() { return rounds; }
+
+  //! Get the oversampling factor.
+  double Oversampling() const { return oversampling; }
+  //! Modify the oversampling factor.
+  double& Oversampling() { return oversampling; }
+
+  //! Serialize the object.
+  template<typename Archive>
+  void serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & BOOST_SERIALIZATION_NVP(rounds);
+    ar & BOOST_SERIALIZATION_NVP(oversampling);
+  }
+
+ private:
+  //! The number of sampling rounds.
+  size_t rounds;
+  //! The expected number of candidates of each round, per cluster.
+  double oversampling;
+
+  /**
+   * Update the squared distance of each point to its closest candidate, given
+   * that the candidates with indices of at least firstNew are new.
+   */
+  template<typename MatType>
+  static void UpdateDistances(const MatType& data,
+                              const arma::mat& candidates,
+                              const size_t firstNew,
+                              arma::vec& distances,
+                              arma::Col<size_t>& closest);
+
+  /**
+   * Recluster the weighted candidates into the given number of centroids with
+   * weighted k-means++ seeding and weighted Lloyd iterations.
+   */
+  static void Recluster(const arma::mat& candidates,
+                        const arma::vec& weights,
+                        const size_t clusters,
+                        arma::mat& centroids);
+
+  //! Get a uniform random number in [0, 1) for the given seed and index.
+  static double HashedRandom(const uint64_t seed, const size_t index);
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "kmeans_parallel_initialization_impl.hpp"
+
+#endif
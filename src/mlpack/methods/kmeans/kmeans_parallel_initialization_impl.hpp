@@ -0,0 +1,234 @@
+/**
+ * @file kmeans_parallel_initialization_impl.hpp
+ *
+ * Implementation of the k-means|| initialization strategy.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_INITIALIZATION_IMPL_HPP
+#define MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_INITIALIZATION_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "kmeans_parallel_initialization.hpp"
+
+#include <mlpack/core/metrics/lmetric.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MatType>
+void KMeansParallelInitialization::Cluster(const MatType& data,
+                                           const size_t clusters,
+                                           arma::mat& centroids) const
+{
+  if (data.n_cols == 0)
+  {
+    throw std::invalid_argument("KMeansParallelInitialization::Cluster(): "
+        "dataset must not be empty!");
+  }
+
+  // Start with one point chosen uniformly at random.
+  arma::mat candidates(data.n_rows, 1);
+  candidates.col(0) = data.col(math::RandInt(0, data.n_cols));
+
+  arma::vec distances(data.n_cols);
+  distances.fill(DBL_MAX);
+  arma::Col<size_t> closest(data.n_cols, arma::fill::zeros);
+  UpdateDistances(data, candidates, 0, distances, closest);
+
+  const double expectedSamples = oversampling * clusters;
+  for (size_t r = 0; r < rounds; ++r)
+  {
+    const double cost = arma::accu(distances);
+    if (cost == 0.0)
+      break; // Every point is a candidate already.
+
+    // Sample each point independently with probability proportional to its
+    // squared distance to the closest candidate.
+    const uint64_t seed = (uint64_t(math::RandInt(0, 1 << 30)) << 30) |
+        uint64_t(math::RandInt(0, 1 << 30));
+    std::vector<size_t> sampled;
+    #pragma omp parallel
+    {
+      std::vector<size_t> localSampled;
+
+      #pragma omp for
+      for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
+      {
+        if (HashedRandom(seed, i) * cost < expectedSamples * distances[i])
+          localSampled.push_back(i);
+      }
+
+      #pragma omp critical
+      sampled.insert(sampled.end(), localSampled.begin(), localSampled.end());
+    }
+
+    if (sampled.empty())
+      continue;
+
+    // Keep the candidates in a deterministic order.
+    std::sort(sampled.begin(), sampled.end());
+
+    const size_t firstNew = candidates.n_cols;
+    candidates.resize(data.n_rows, firstNew + sampled.size());
+    for (size_t j = 0; j < sampled.size(); ++j)
+      candidates.col(firstNew + j) = data.col(sampled[j]);
+
+    UpdateDistances(data, candidates, firstNew, distances, closest);
+  }
+
+  // Weight each candidate by the number of points that are closest to it.
+  arma::vec weights(candidates.n_cols, arma::fill::zeros);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    weights[closest[i]] += 1.0;
+
+  Log::Info << "KMeansParallelInitialization::Cluster(): reclustering "
+      << candidates.n_cols << " candidates." << std::endl;
+
+  if (candidates.n_cols <= clusters)
+  {
+    // There are not enough candidates; fill the rest with random points.
+    centroids.set_size(data.n_rows, clusters);
+    centroids.cols(0, candidates.n_cols - 1) = candidates;
+    for (size_t i = candidates.n_cols; i < clusters; ++i)
+      centroids.col(i) = data.col(math::RandInt(0, data.n_cols));
+    return;
+  }
+
+  Recluster(candidates, weights, clusters, centroids);
+}
+
+template<typename MatType>
+void KMeansParallelInitialization::UpdateDistances(
+    const MatType& data,
+    const arma::mat& candidates,
+    const size_t firstNew,
+    arma::vec& distances,
+    arma::Col<size_t>& closest)
+{
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
+  {
+    for (size_t c = firstNew; c < candidates.n_cols; ++c)
+    {
+      const double distance = metric::SquaredEuclideanDistance::Evaluate(
+          data.col(i), candidates.col(c));
+      if (distance < distances[i])
+      {
+        distances[i] = distance;
+        closest[i] = c;
+      }
+    }
+  }
+}
+
+inline void KMeansParallelInitialization::Recluster(
+    const arma::mat& candidates,
+    const arma::vec& weights,
+    const size_t clusters,
+    arma::mat& centroids)
+{
+  // Pick an index with probability proportional to the given values.
+  auto pick = [](const arma::vec& values)
+  {
+    const double total = arma::accu(values);
+    if (total <= 0.0)
+      return (size_t) math::RandInt(0, values.n_elem);
+
+    const double target = math::Random() * total;
+    double sum = 0.0;
+    for (size_t i = 0; i < values.n_elem; ++i)
+    {
+      sum += values[i];
+      if (sum > target)
+        return i;
+    }
+
+    return (size_t) values.n_elem - 1;
+  };
+
+  // Weighted k-means++ seeding.
+  centroids.set_size(candidates.n_rows, clusters);
+  arma::vec distances(candidates.n_cols);
+  distances.fill(DBL_MAX);
+  for (size_t c = 0; c < clusters; ++c)
+  {
+    const size_t index = (c == 0) ? pick(weights) : pick(weights % distances);
+    centroids.col(c) = candidates.col(index);
+
+    for (size_t i = 0; i < candidates.n_cols; ++i)
+    {
+      const double distance = metric::SquaredEuclideanDistance::Evaluate(
+          candidates.col(i), centroids.col(c));
+      distances[i] = std::min(distances[i], distance);
+    }
+  }
+
+  // Weighted Lloyd iterations, until the assignments don't change.
+  const size_t maxIterations = 100;
+  arma::Col<size_t> assignments(candidates.n_cols);
+  assignments.fill(clusters);
+  for (size_t iteration = 0; iteration < maxIterations; ++iteration)
+  {
+    bool changed = false;
+    for (size_t i = 0; i < candidates.n_cols; ++i)
+    {
+      double minDistance = DBL_MAX;
+      size_t closestCluster = 0;
+      for (size_t c = 0; c < clusters; ++c)
+      {
+        const double distance = metric::SquaredEuclideanDistance::Evaluate(
+            candidates.col(i), centroids.col(c));
+        if (distance < minDistance)
+        {
+          minDistance = distance;
+          closestCluster = c;
+        }
+      }
+
+      if (assignments[i] != closestCluster)
+      {
+        assignments[i] = closestCluster;
+        changed = true;
+      }
+    }
+
+    if (!changed)
+      break;
+
+    // Empty clusters keep their centroid.
+    arma::mat sums(candidates.n_rows, clusters, arma::fill::zeros);
+    arma::vec totalWeights(clusters, arma::fill::zeros);
+    for (size_t i = 0; i < candidates.n_cols; ++i)
+    {
+      sums.col(assignments[i]) += weights[i] * candidates.col(i);
+      totalWeights[assignments[i]] += weights[i];
+    }
+
+    for (size_t c = 0; c < clusters; ++c)
+      if (totalWeights[c] > 0.0)
+        centroids.col(c) = sums.col(c) / totalWeights[c];
+  }
+}
+
+inline double KMeansParallelInitialization::HashedRandom(const uint64_t seed,
+                                                         const size_t index)
+{
+  // The SplitMix64 finalizer, which mixes the bits of the seed and the index
+  // well enough that neighboring indices give independent-looking numbers.
+  uint64_t z = seed + (uint64_t(index) + 1) * 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  z = z ^ (z >> 31);
+
+  // Use the top 53 bits as the mantissa of a double in [0, 1).
+  return (z >> 11) * (1.0 / 9007199254740992.0);
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,118 @@
+/**
+ * @file mini_batch_kmeans.hpp
+ *
+ * An implementation of a step of mini-batch k-means, which updates the
+ * centroids with a random sample of the dataset instead of the whole dataset.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_HPP
+#define MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * An implementation of mini-batch k-means, for use as the LloydStepType of the
+ * KMeans class.  Instead of assigning every point of the dataset to its nearest
+ * centroid in each iteration, each iteration samples a batch of points
+ * uniformly at random (with replacement), assigns them to their nearest
+ * centroids, and moves each centroid towards each point assigned to it with a
+ * per-centroid learning rate of one over the number of points that the
+ * centroid has been assigned so far.  Each iteration therefore costs
+ * O(batchSize * k) distance calculations regardless of the size of the
+ * dataset, at the price of centroids that are only approximately those that
+ * Lloyd's algorithm would find.
+ *
+ * The counts returned by Iterate() are the number of points assigned to each
+ * centroid over all iterations so far.  When the change of the centroids in an
+ * iteration, relative to their norm, falls below the tolerance, Iterate()
+ * returns 0 so that KMeans terminates.
+ *
+ * For more information, see the following paper.
+ *
+ * @code
+ * @inproceedings{sculley2010web,
+ *   title={Web-scale k-means clustering},
+ *   author={Sculley, D.},
+ *   booktitle={Proceedings of the 19th International Conference on World Wide
+ *       Web (WWW '10)},
+ *   pages={1177--1178},
+ *   year={2010}
+ * }
+ * @endcode
+ *
+ * @tparam MetricType Type of metric used with this implementation.
+ * @tparam MatType Matrix type (arma::mat or arma::sp_mat).
+ */
+template<typename MetricType, typename MatType>
+class MiniBatchKMeans
+{
+ public:
+  /**
+   * Construct the MiniBatchKMeans object with the given dataset and metric.
+   *
+   * @param dataset Dataset.
+   * @param metric Instantiated metric.
+   * @param batchSize Number of points sampled in each iteration.
+   * @param tolerance Relative change of the centroids below which the
+   *     iterations stop.
+   */
+  MiniBatchKMeans(const MatType& dataset,
+                  MetricType& metric,
+                  const size_t batchSize = 1000,
+                  const double tolerance = 1e-4);
+
+  /**
+   * Run a single iteration of mini-batch k-means, updating the given centroids
+   * into the newCentroids matrix.
+   *
+   * @param centroids Current cluster centroids.
+   * @param newCentroids New cluster centroids.
+   * @param counts Number of points assigned to each cluster so far.
+   */
+  double Iterate(const arma::mat& centroids,
+                 arma::mat& newCentroids,
+                 arma::Col<size_t>& counts);
+
+  size_t DistanceCalculations() const { return distanceCalculations; }
+
+  //! Get the number of points sampled in each iteration.
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the number of points sampled in each iteration.
+  size_t& BatchSize() { return batchSize; }
+
+  //! Get the tolerance for the relative change of the centroids.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance for the relative change of the centroids.
+  double& Tolerance() { return tolerance; }
+
+ private:
+  //! The dataset.
+  const MatType& dataset;
+  //! The instantiated metric.
+  MetricType& metric;
+  //! Number of points sampled in each iteration.
+  size_t batchSize;
+  //! Relative change of the centroids below which the iterations stop.
+  double tolerance;
+
+  //! Number of points assigned to each centroid over all iterations.
+  arma::Col<size_t> totalCounts;
+
+  //! Number of distance calculations.
+  size_t distanceCalculations;
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "mini_batch_kmeans_impl.hpp"
+
+#endif
@@ -0,0 +1,116 @@
+/**
+ * @file mini_batch_kmeans_impl.hpp
+ *
+ * Implementation of a step of mini-batch k-means.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_IMPL_HPP
+#define MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "mini_batch_kmeans.hpp"
+
+#include <mlpack/core/math/random.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MetricType, typename MatType>
+MiniBatchKMeans<MetricType, MatType>::MiniBatchKMeans(const MatType& dataset,
+                                                      MetricType& metric,
+                                                      const size_t batchSize,
+                                                      const double tolerance) :
+    dataset(dataset),
+    metric(metric),
+    batchSize(batchSize),
+    tolerance(tolerance),
+    distanceCalculations(0)
+{
+  if (batchSize == 0)
+  {
+    throw std::invalid_argument("MiniBatchKMeans::MiniBatchKMeans(): batch "
+        "size must be positive!");
+  }
+}
+
+// Run a single iteration.
+template<typename MetricType, typename MatType>
+double MiniBatchKMeans<MetricType, MatType>::Iterate(
+    const arma::mat& centroids,
+    arma::mat& newCentroids,
+    arma::Col<size_t>& counts)
+{
+  if (totalCounts.n_elem != centroids.n_cols)
+    totalCounts.zeros(centroids.n_cols);
+
+  // Sample the batch.
+  arma::Col<size_t> batch(batchSize);
+  for (size_t i = 0; i < batchSize; ++i)
+    batch[i] = math::RandInt(0, dataset.n_cols);
+
+  // Find the closest centroid to each point of the batch, in parallel.
+  arma::Col<size_t> closest(batchSize);
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) batchSize; ++i)
+  {
+    double minDistance = std::numeric_limits<double>::infinity();
+    size_t closestCluster = centroids.n_cols; // Invalid value.
+
+    for (size_t j = 0; j < centroids.n_cols; ++j)
+    {
+      const double distance = metric.Evaluate(dataset.col(batch[i]),
+          centroids.unsafe_col(j));
+      if (distance < minDistance)
+      {
+        minDistance = distance;
+        closestCluster = j;
+      }
+    }
+
+    Log::Assert(closestCluster != centroids.n_cols);
+    closest[i] = closestCluster;
+  }
+
+  distanceCalculations += batchSize * centroids.n_cols;
+
+  // Move each centroid towards the points assigned to it.  The learning rate of
+  // a centroid is one over the number of points it has been assigned so far, so
+  // each centroid is the running mean of the points assigned to it.
+  newCentroids = centroids;
+  for (size_t i = 0; i < batchSize; ++i)
+  {
+    const size_t c = closest[i];
+    ++totalCounts[c];
+    const double eta = 1.0 / totalCounts[c];
+    newCentroids.col(c) = (1.0 - eta) * newCentroids.col(c) +
+        eta * arma::vec(dataset.col(batch[i]));
+  }
+
+  counts = totalCounts;
+
+  // Calculate the change of the centroids in this iteration.
+  double cNorm = 0.0;
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+  {
+    cNorm += std::pow(metric.Evaluate(centroids.col(i), newCentroids.col(i)),
+        2.0);
+  }
+  distanceCalculations += centroids.n_cols;
+  cNorm = std::sqrt(cNorm);
+
+  // Report convergence when the change is small relative to the centroids.
+  const double scale = arma::norm(newCentroids, "fro");
+  if (cNorm <= tolerance * (scale > 0.0 ? scale : 1.0))
+    return 0.0;
+
+  return cNorm;
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
@@ -15,6 +15,7 @@
 #ifndef MLPACK_METHODS_KMEANS_NAIVE_KMEANS_HPP
 #define MLPACK_METHODS_KMEANS_NAIVE_KMEANS_HPP
 #include <mlpack/prereqs.hpp>
+#include "point_distances.hpp"
 
 namespace mlpack {
 namespace kmeans {
@@ -61,6 +62,8 @@ class NaiveKMeans
   const MatType& dataset;
   //! The instantiated metric.
   MetricType& metric;
+  //! The distances between points and the current centroids.
+  PointDistances<MetricType, MatType> pointDistances;
 
   //! Number of distance calculations.
   size_t distanceCalculations;
@@ -0,0 +1,180 @@
+/**
+ * @file point_distances.hpp
+ *
+ * Distances between the points of a (dense or sparse) dataset and a set of
+ * dense centroids, for the Lloyd step types of k-means.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_POINT_DISTANCES_HPP
+#define MLPACK_METHODS_KMEANS_POINT_DISTANCES_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+//! Whether the given metric is the (squared) Euclidean distance.
+template<typename MetricType>
+struct IsL2Metric
+{
+  static const bool value = false;
+};
+
+//! The Euclidean distance, with or without the root.
+template<bool TakeRoot>
+struct IsL2Metric<metric::LMetric<2, TakeRoot>>
+{
+  static const bool value = true;
+};
+
+/**
+ * Add the given point of a dense dataset to the given column of the given
+ * matrix.
+ */
+template<typename MatType>
+inline void AddPoint(const MatType& dataset,
+                     const size_t point,
+                     arma::mat& sums,
+                     const size_t column,
+                     const typename std::enable_if_t<
+                         !arma::is_arma_sparse_type<MatType>::value>* = 0)
+{
+  sums.col(column) += dataset.col(point);
+}
+
+/**
+ * Add the given point of a sparse dataset to the given column of the given
+ * matrix.  Only the nonzero elements of the point are visited.
+ */
+template<typename MatType>
+inline void AddPoint(const MatType& dataset,
+                     const size_t point,
+                     arma::mat& sums,
+                     const size_t column,
+                     const typename std::enable_if_t<
+                         arma::is_arma_sparse_type<MatType>::value>* = 0)
+{
+  double* sum = sums.colptr(column);
+  typename MatType::const_iterator it = dataset.begin_col(point);
+  typename MatType::const_iterator end = dataset.end_col(point);
+  for (; it != end; ++it)
+    sum[it.row()] += (*it);
+}
+
+/**
+ * PointDistances computes the distances between the points of a dataset and
+ * the current centroids of a Lloyd step.  In general, this just calls
+ * MetricType::Evaluate().  The centroids are dense, so for a sparse dataset
+ * that would visit every dimension; with the (squared) Euclidean distance,
+ * the specialization below uses
+ *
+ *   || x - c ||^2 = || x ||^2 + || c ||^2 - 2 x^T c
+ *
+ * instead, with the norms of the points computed once and those of the
+ * centroids once per iteration, so each distance only visits the nonzero
+ * elements of the point.  For spherical (cosine) k-means, normalize the
+ * points to unit length first.
+ *
+ * @tparam MetricType The distance metric.
+ * @tparam MatType The type of the dataset.
+ * @tparam UseNorms Whether to compute distances from norms and dot products.
+ */
+template<typename MetricType,
+         typename MatType,
+         bool UseNorms = arma::is_arma_sparse_type<MatType>::value &&
+             IsL2Metric<MetricType>::value>
+class PointDistances
+{
+ public:
+  //! Prepare to compute distances from the points of the given dataset.
+  PointDistances(const MatType& dataset, MetricType& metric) :
+      dataset(dataset), metric(metric), centroids(NULL)
+  { }
+
+  //! Set the centroids to compute distances to.  They must outlive any call
+  //! to Evaluate().
+  void Centroids(const arma::mat& newCentroids) { centroids = &newCentroids; }
+
+  //! Compute the distance between the given point and the given centroid.
+  double Evaluate(const size_t point, const size_t centroid) const
+  {
+    return metric.Evaluate(dataset.col(point), centroids->col(centroid));
+  }
+
+ private:
+  //! The dataset.
+  const MatType& dataset;
+  //! The metric.
+  MetricType& metric;
+  //! The current centroids.
+  const arma::mat* centroids;
+};
+
+/**
+ * Distances between sparse points and dense centroids with the (squared)
+ * Euclidean distance, computed from norms and sparse dot products.
+ */
+template<typename MetricType, typename MatType>
+class PointDistances<MetricType, MatType, true>
+{
+ public:
+  //! Prepare to compute distances from the points of the given dataset, and
+  //! compute their squared norms.
+  PointDistances(const MatType& dataset, MetricType& /* metric */) :
+      dataset(dataset), centroids(NULL), pointNorms(dataset.n_cols)
+  {
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+    {
+      double norm = 0.0;
+      typename MatType::const_iterator it = dataset.begin_col(i);
+      typename MatType::const_iterator end = dataset.end_col(i);
+      for (; it != end; ++it)
+        norm += (*it) * (*it);
+      pointNorms[i] = norm;
+    }
+  }
+
+  //! Set the centroids to compute distances to, and compute their squared
+  //! norms.  They must outlive any call to Evaluate().
+  void Centroids(const arma::mat& newCentroids)
+  {
+    centroids = &newCentroids;
+    centroidNorms = arma::sum(arma::square(newCentroids), 0).t();
+  }
+
+  //! Compute the distance between the given point and the given centroid.
+  double Evaluate(const size_t point, const size_t centroid) const
+  {
+    const double* c = centroids->colptr(centroid);
+    double dot = 0.0;
+    typename MatType::const_iterator it = dataset.begin_col(point);
+    typename MatType::const_iterator end = dataset.end_col(point);
+    for (; it != end; ++it)
+      dot += (*it) * c[it.row()];
+
+    // Cancellation may make the result slightly negative.
+    const double squared = std::max(pointNorms[point] +
+        centroidNorms[centroid] - 2.0 * dot, 0.0);
+    return MetricType::TakeRoot ? std::sqrt(squared) : squared;
+  }
+
+ private:
+  //! The dataset.
+  const MatType& dataset;
+  //! The current centroids.
+  const arma::mat* centroids;
+  //! The squared norm of each point.
+  arma::vec pointNorms;
+  //! The squared norm of each centroid.
+  arma::vec centroidNorms;
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
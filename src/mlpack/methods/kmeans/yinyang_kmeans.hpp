@@ -0,0 +1,114 @@
+/**
+ * @file yinyang_kmeans.hpp
+ *
+ * An implementation of Yinyang k-means, which keeps one upper bound and a lower
+ * bound for each of a small number of groups of centroids for each point,
+ * using OpenMP for parallelization over multiple threads.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_YINYANG_KMEANS_HPP
+#define MLPACK_METHODS_KMEANS_YINYANG_KMEANS_HPP
+
+#include "point_distances.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * Yinyang k-means, from the following paper:
+ *
+ * @code
+ * @inproceedings{ding2015yinyang,
+ *   title={Yinyang k-means: A drop-in replacement of the classic k-means with
+ *       consistent speedup},
+ *   author={Ding, Yufei and Zhao, Yue and Shen, Xipeng and Musuvathi, Madanlal
+ *       and Mytkowicz, Todd},
+ *   booktitle={Proceedings of the 32nd International Conference on Machine
+ *       Learning (ICML '15)},
+ *   pages={579--587},
+ *   year={2015}
+ * }
+ * @endcode
+ *
+ * The centroids are clustered into t groups in the first iteration (t is about
+ * k / 10 by default), and each point keeps an upper bound on the distance to
+ * its centroid and, for each group, a lower bound on the distance to the
+ * centroids of the group (other than its own).  A point is skipped entirely if
+ * its upper bound is below all of its group bounds, and otherwise only the
+ * groups whose bound is below the upper bound are searched.  This takes
+ * O(n t) memory, between that of HamerlyKMeans (O(n)) and ElkanKMeans (O(n k)),
+ * and prunes much better than HamerlyKMeans for large k.
+ */
+template<typename MetricType, typename MatType>
+class YinyangKMeans
+{
+ public:
+  /**
+   * Construct the YinyangKMeans object, which must store the bounds of each
+   * point.
+   *
+   * @param dataset Dataset to cluster.
+   * @param metric Instantiated metric.
+   * @param groups Number of groups of centroids (0 means k / 10, rounded up).
+   */
+  YinyangKMeans(const MatType& dataset,
+                MetricType& metric,
+                const size_t groups = 0);
+
+  /**
+   * Run a single iteration of Yinyang k-means, updating the given centroids
+   * into the newCentroids matrix.
+   *
+   * @param centroids Current cluster centroids.
+   * @param newCentroids New cluster centroids.
+   * @param counts Current counts, to be overwritten with new counts.
+   */
+  double Iterate(const arma::mat& centroids,
+                 arma::mat& newCentroids,
+                 arma::Col<size_t>& counts);
+
+  size_t DistanceCalculations() const { return distanceCalculations; }
+
+  //! Get the number of groups of centroids (0 before the first iteration).
+  size_t Groups() const { return groupCentroids.size(); }
+
+ private:
+  //! The dataset.
+  const MatType& dataset;
+  //! The instantiated metric.
+  MetricType& metric;
+  //! The distances between points and the current centroids.
+  PointDistances<MetricType, MatType> pointDistances;
+
+  //! The requested number of groups of centroids (0 means k / 10).
+  size_t groups;
+  //! The group of each centroid.
+  arma::Col<size_t> centroidGroups;
+  //! The centroids in each group.
+  std::vector<std::vector<size_t>> groupCentroids;
+
+  //! Upper bounds for each point.
+  arma::vec upperBounds;
+  //! Lower bounds for each group (rows) and each point (columns).
+  arma::mat lowerBounds;
+  //! Assignments for each point.
+  arma::Col<size_t> assignments;
+
+  //! Track distance calculations.
+  size_t distanceCalculations;
+
+  //! Cluster the centroids into groups.
+  void GroupCentroids(const arma::mat& centroids);
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "yinyang_kmeans_impl.hpp"
+
+#endif
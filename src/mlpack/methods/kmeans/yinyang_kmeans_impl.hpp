@@ -0,0 +1,275 @@
+/**
+ * @file yinyang_kmeans_impl.hpp
+ *
+ * An implementation of Yinyang k-means.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_YINYANG_KMEANS_IMPL_HPP
+#define MLPACK_METHODS_KMEANS_YINYANG_KMEANS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "yinyang_kmeans.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MetricType, typename MatType>
+YinyangKMeans<MetricType, MatType>::YinyangKMeans(const MatType& dataset,
+                                                  MetricType& metric,
+                                                  const size_t groups) :
+    dataset(dataset),
+    metric(metric),
+    pointDistances(dataset, metric),
+    groups(groups),
+    distanceCalculations(0)
+{
+  // Nothing to do.
+}
+
+template<typename MetricType, typename MatType>
+double YinyangKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
+                                                   arma::mat& newCentroids,
+                                                   arma::Col<size_t>& counts)
+{
+  size_t yinyangPruned = 0;
+
+  // If this is the first iteration, we need to group the centroids, and all
+  // the distances are computed to set the bounds.
+  const bool firstIteration = (centroidGroups.n_elem != centroids.n_cols ||
+      assignments.n_elem != dataset.n_cols);
+  if (firstIteration)
+  {
+    GroupCentroids(centroids);
+    upperBounds.set_size(dataset.n_cols);
+    lowerBounds.set_size(groupCentroids.size(), dataset.n_cols);
+    assignments.set_size(dataset.n_cols);
+  }
+  const size_t numGroups = groupCentroids.size();
+
+  // Reset new centroids.
+  newCentroids.zeros(centroids.n_rows, centroids.n_cols);
+  counts.zeros(centroids.n_cols);
+  pointDistances.Centroids(centroids);
+
+  // The bounds and assignment of each point are only touched by the thread
+  // that handles it, and each thread accumulates its own centroids.
+  #pragma omp parallel reduction(+:yinyangPruned)
+  {
+    arma::mat localCentroids(centroids.n_rows, centroids.n_cols,
+        arma::fill::zeros);
+    arma::Col<size_t> localCounts(centroids.n_cols, arma::fill::zeros);
+    size_t localDistanceCalculations = 0;
+
+    // The closest and second closest distances to the centroids of each
+    // searched group.
+    std::vector<double> groupClosest(numGroups);
+    std::vector<double> groupSecondClosest(numGroups);
+    std::vector<size_t> groupClosestCentroid(numGroups);
+    std::vector<bool> searched(numGroups);
+
+    #pragma omp for
+    for (omp_size_t i = 0; i < (omp_size_t) dataset.n_cols; ++i)
+    {
+      double* pointLowerBounds = lowerBounds.colptr(i);
+      const size_t oldAssignment = firstIteration ? centroids.n_cols :
+          assignments[i];
+      double upperBound = DBL_MAX;
+
+      if (!firstIteration)
+      {
+        double lowerBound = DBL_MAX;
+        for (size_t g = 0; g < numGroups; ++g)
+          lowerBound = std::min(lowerBound, pointLowerBounds[g]);
+
+        // Global bound test.
+        if (upperBounds(i) <= lowerBound)
+        {
+          ++yinyangPruned;
+          AddPoint(dataset, i, localCentroids, oldAssignment);
+          ++localCounts(oldAssignment);
+          continue;
+        }
+
+        // Tighten the upper bound, and test again.
+        upperBound = pointDistances.Evaluate(i, oldAssignment);
+        ++localDistanceCalculations;
+        if (upperBound <= lowerBound)
+        {
+          upperBounds(i) = upperBound;
+          AddPoint(dataset, i, localCentroids, oldAssignment);
+          ++localCounts(oldAssignment);
+          continue;
+        }
+      }
+
+      // Search each group whose bound is below the distance to the best
+      // centroid found so far; the centroids of the other groups can't be any
+      // closer.
+      double closest = upperBound;
+      size_t assignment = oldAssignment;
+      for (size_t g = 0; g < numGroups; ++g)
+      {
+        searched[g] = (firstIteration || pointLowerBounds[g] < closest);
+        if (!searched[g])
+          continue;
+
+        groupClosest[g] = DBL_MAX;
+        groupSecondClosest[g] = DBL_MAX;
+        groupClosestCentroid[g] = centroids.n_cols;
+        for (size_t j = 0; j < groupCentroids[g].size(); ++j)
+        {
+          const size_t c = groupCentroids[g][j];
+          double dist = upperBound;
+          if (c != oldAssignment)
+          {
+            dist = pointDistances.Evaluate(i, c);
+            ++localDistanceCalculations;
+          }
+
+          if (dist < groupClosest[g])
+          {
+            groupSecondClosest[g] = groupClosest[g];
+            groupClosest[g] = dist;
+            groupClosestCentroid[g] = c;
+          }
+          else if (dist < groupSecondClosest[g])
+          {
+            groupSecondClosest[g] = dist;
+          }
+
+          if (dist < closest)
+          {
+            closest = dist;
+            assignment = c;
+          }
+        }
+      }
+
+      // Now the bound of each searched group is the distance to its closest
+      // centroid other than the new assignment.  If the point left its old
+      // centroid, the bound of its old group must cover that centroid too.
+      for (size_t g = 0; g < numGroups; ++g)
+      {
+        if (searched[g])
+        {
+          pointLowerBounds[g] = (groupClosestCentroid[g] == assignment) ?
+              groupSecondClosest[g] : groupClosest[g];
+        }
+        else if (assignment != oldAssignment &&
+                 g == centroidGroups[oldAssignment])
+        {
+          pointLowerBounds[g] = std::min(pointLowerBounds[g], upperBound);
+        }
+      }
+
+      upperBounds(i) = closest;
+      assignments[i] = assignment;
+
+      // Update new centroids.
+      AddPoint(dataset, i, localCentroids, assignment);
+      ++localCounts(assignment);
+    }
+
+    // Combine the results of each thread.
+    #pragma omp critical
+    {
+      newCentroids += localCentroids;
+      counts += localCounts;
+      distanceCalculations += localDistanceCalculations;
+    }
+  }
+
+  // Normalize centroids and calculate cluster movement.
+  arma::vec centroidMovements(centroids.n_cols);
+  arma::vec groupMovements(numGroups, arma::fill::zeros);
+  double centroidMovement = 0.0;
+  for (size_t c = 0; c < centroids.n_cols; ++c)
+  {
+    if (counts(c) > 0)
+      newCentroids.col(c) /= counts(c);
+
+    const double movement = metric.Evaluate(centroids.col(c),
+                                            newCentroids.col(c));
+    centroidMovements(c) = movement;
+    centroidMovement += std::pow(movement, 2.0);
+    ++distanceCalculations;
+
+    const size_t g = centroidGroups[c];
+    groupMovements(g) = std::max(groupMovements(g), movement);
+  }
+
+  // Now update the bounds for the new centroids.
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) dataset.n_cols; ++i)
+  {
+    upperBounds(i) += centroidMovements(assignments[i]);
+    lowerBounds.unsafe_col(i) -= groupMovements;
+  }
+
+  Log::Info << "Yinyang prunes: " << yinyangPruned << ".\n";
+
+  return std::sqrt(centroidMovement);
+}
+
+template<typename MetricType, typename MatType>
+void YinyangKMeans<MetricType, MatType>::GroupCentroids(
+    const arma::mat& centroids)
+{
+  const size_t k = centroids.n_cols;
+  const size_t numGroups = (groups == 0) ? (k + 9) / 10 :
+      std::min(groups, k);
+
+  // Cluster the centroids with a few Lloyd iterations, starting from evenly
+  // spaced centroids.  The groups don't need to be good for the results to be
+  // correct; better groups only give tighter bounds.
+  arma::mat groupCenters(centroids.n_rows, numGroups);
+  for (size_t g = 0; g < numGroups; ++g)
+    groupCenters.col(g) = centroids.col(g * k / numGroups);
+
+  centroidGroups.set_size(k);
+  for (size_t iteration = 0; iteration < 5; ++iteration)
+  {
+    for (size_t c = 0; c < k; ++c)
+    {
+      double closest = DBL_MAX;
+      for (size_t g = 0; g < numGroups; ++g)
+      {
+        const double dist = metric.Evaluate(centroids.col(c),
+            groupCenters.col(g));
+        if (dist < closest)
+        {
+          closest = dist;
+          centroidGroups[c] = g;
+        }
+      }
+    }
+    distanceCalculations += k * numGroups;
+
+    arma::mat newCenters(centroids.n_rows, numGroups, arma::fill::zeros);
+    arma::Col<size_t> groupCounts(numGroups, arma::fill::zeros);
+    for (size_t c = 0; c < k; ++c)
+    {
+      newCenters.col(centroidGroups[c]) += centroids.col(c);
+      ++groupCounts[centroidGroups[c]];
+    }
+
+    // Empty groups keep their centers.
+    for (size_t g = 0; g < numGroups; ++g)
+      if (groupCounts[g] > 0)
+        groupCenters.col(g) = newCenters.col(g) / groupCounts[g];
+  }
+
+  groupCentroids.clear();
+  groupCentroids.resize(numGroups);
+  for (size_t c = 0; c < k; ++c)
+    groupCentroids[centroidGroups[c]].push_back(c);
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
@@ -75,6 +75,90 @@ double LARS::Train(const arma::mat& matX,
 {
   Timer::Start("lars_regression");
 
+  // Compute X' * y.  The data is not transposed: if it is column-major, X' is
+  // the data itself.
+  const arma::vec vecXTy = transposeData ? arma::vec(matX * y.t()) :
+      arma::vec(trans(y * matX));
+
+  ComputeGram(matX, transposeData);
+  const double maxCorr = TrainWithGram(vecXTy, beta);
+
+  Timer::Stop("lars_regression");
+  return maxCorr;
+}
+
+void LARS::Train(const arma::mat& matX,
+                 const arma::mat& responses,
+                 arma::mat& beta,
+                 const bool transposeData)
+{
+  Timer::Start("lars_regression");
+
+  // Compute X' * y for every response at once.
+  arma::mat matXTy = transposeData ? arma::mat(matX * responses) :
+      arma::mat(trans(matX) * responses);
+
+  ComputeGram(matX, transposeData);
+
+  // Each response is solved independently with the shared Gram matrix, by a
+  // solver that each thread reuses for all of its responses.  The last
+  // response is solved by this object, so that its solution path is kept.
+  beta.set_size(matXTy.n_rows, responses.n_cols);
+  #pragma omp parallel
+  {
+    LARS local(useCholesky, *matGram, lambda1, lambda2, tolerance);
+
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t i = 0; i < (omp_size_t) responses.n_cols; ++i)
+    {
+      LARS& solver = ((size_t) i == responses.n_cols - 1) ? *this : local;
+
+      // The solution is placed directly into the column of beta.
+      arma::vec b = beta.unsafe_col(i);
+      solver.TrainWithGram(matXTy.unsafe_col(i), b);
+    }
+  }
+
+  Timer::Stop("lars_regression");
+}
+
+void LARS::ComputeGram(const arma::mat& matX, const bool transposeData)
+{
+  // A given Gram matrix is only used if it fits; otherwise (and if no Gram
+  // matrix was given) it is recomputed for this data.  The product of a
+  // matrix with its own transpose is computed by Armadillo with a (possibly
+  // multithreaded) syrk call.
+  const size_t dims = (transposeData ? matX.n_rows : matX.n_cols);
+  if (matGram == &matGramInternal || matGram->n_elem != dims * dims)
+  {
+    if (transposeData)
+      matGramInternal = matX * trans(matX);
+    else
+      matGramInternal = trans(matX) * matX;
+    matGram = &matGramInternal;
+  }
+}
+
+void LARS::GramProduct(const arma::vec& coefficients,
+                       arma::vec& product) const
+{
+  // product = G.cols(activeSet) * coefficients, computed one row at a time.
+  // Since G is symmetric, row j is column j, which is contiguous.
+  const size_t dims = matGram->n_cols;
+  product.set_size(dims);
+  #pragma omp parallel for schedule(static)
+  for (omp_size_t j = 0; j < (omp_size_t) dims; ++j)
+  {
+    const double* gramCol = matGram->colptr(j);
+    double sum = 0.0;
+    for (size_t i = 0; i < activeSet.size(); ++i)
+      sum += gramCol[activeSet[i]] * coefficients[i];
+    product[j] = sum;
+  }
+}
+
+double LARS::TrainWithGram(const arma::vec& vecXTy, arma::vec& beta)
+{
   // Clear any previous solution information.
   betaPath.clear();
   lambdaPath.clear();
@@ -84,27 +168,19 @@ double LARS::Train(const arma::mat& matX,
   isIgnored.clear();
   matUtriCholFactor.reset();
 
-  // This matrix may end up holding the transpose -- if necessary.
-  arma::mat dataTrans;
-  // dataRef is row-major.
-  const arma::mat& dataRef = (transposeData ? dataTrans : matX);
-  if (transposeData)
-    dataTrans = trans(matX);
-
-  // Compute X' * y.
-  arma::vec vecXTy = trans(y * dataRef);
+  // All the correlations are computed from the Gram matrix, as
+  // X' (y - X beta) = X' y - G beta, so the data is not needed.
+  const size_t dims = vecXTy.n_elem;
 
   // Set up active set variables.  In the beginning, the active set has size 0
   // (all dimensions are inactive).
-  isActive.resize(dataRef.n_cols, false);
+  isActive.resize(dims, false);
 
   // Set up ignores set variables. Initialized empty.
-  isIgnored.resize(dataRef.n_cols, false);
+  isIgnored.resize(dims, false);
 
-  // Initialize yHat and beta.
-  beta = arma::zeros(dataRef.n_cols);
-  arma::vec yHat = arma::zeros(dataRef.n_rows);
-  arma::vec yHatDirection(dataRef.n_rows);
+  // Initialize beta.
+  beta = arma::zeros(dims);
 
   bool lassocond = false;
 
@@ -128,28 +204,17 @@ double LARS::Train(const arma::mat& matX,
   if (maxCorr < lambda1)
   {
     lambdaPath[0] = lambda1;
-    Timer::Stop("lars_regression");
     return maxCorr;
   }
 
-  // Compute the Gram matrix.  If this is the elastic net problem, we will add
-  // lambda2 * I_n to the matrix.
-  if (matGram->n_elem != dataRef.n_cols * dataRef.n_cols)
-  {
-    // In this case, matGram should reference matGramInternal.
-    matGramInternal = trans(dataRef) * dataRef;
-
-    if (elasticNet && !useCholesky)
-      matGramInternal += lambda2 * arma::eye(dataRef.n_cols, dataRef.n_cols);
-  }
-
   // Main loop.
-  while (((activeSet.size() + ignoreSet.size()) < dataRef.n_cols) &&
+  arma::vec dirCorr, gramBeta;
+  while (((activeSet.size() + ignoreSet.size()) < dims) &&
          (maxCorr > tolerance))
   {
     // Compute the maximum correlation among inactive dimensions.
     maxCorr = 0;
-    for (size_t i = 0; i < dataRef.n_cols; i++)
+    for (size_t i = 0; i < dims; i++)
     {
       if ((!isActive[i]) && (!isIgnored[i]) && (fabs(corr(i)) > maxCorr))
       {
@@ -168,7 +233,7 @@ double LARS::Train(const arma::mat& matX,
         //   newGramCol[i] = dot(matX.col(activeSet[i]), matX.col(changeInd));
         // }
         // This is equivalent to the above 5 lines.
-        arma::vec newGramCol = matGram->elem(changeInd * dataRef.n_cols +
+        arma::vec newGramCol = matGram->elem(changeInd * dims +
             arma::conv_to<arma::uvec>::from(activeSet));
 
         CholeskyInsert((*matGram)(changeInd, changeInd), newGramCol);
@@ -234,6 +299,10 @@ double LARS::Train(const arma::mat& matX,
         for (size_t j = 0; j < activeSet.size(); j++)
           matGramActive(i, j) = (*matGram)(activeSet[i], activeSet[j]);
 
+      // For the elastic net, the system is (G + lambda2 * I).
+      if (elasticNet)
+        matGramActive.diag() += lambda2;
+
       // Check for singularity.
       arma::mat matS = s * arma::ones<arma::mat>(1, activeSet.size());
       const bool solvedOk = solve(unnormalizedBetaDirection,
@@ -258,23 +327,22 @@ double LARS::Train(const arma::mat& matX,
       }
     }
 
-    // compute "equiangular" direction in output space
-    ComputeYHatDirection(dataRef, betaDirection, yHatDirection);
-
     double gamma = maxCorr / normalization;
 
     // If not all variables are active.
-    if ((activeSet.size() + ignoreSet.size()) < dataRef.n_cols)
+    if ((activeSet.size() + ignoreSet.size()) < dims)
     {
-      // Compute correlations with direction.
-      for (size_t ind = 0; ind < dataRef.n_cols; ind++)
+      // Compute correlations with the "equiangular" direction in output space,
+      // X' (X_A betaDirection) = G_A betaDirection.
+      GramProduct(betaDirection, dirCorr);
+
+      for (size_t ind = 0; ind < dims; ind++)
       {
         if (isActive[ind] || isIgnored[ind])
           continue;
 
-        double dirCorr = dot(dataRef.col(ind), yHatDirection);
-        double val1 = (maxCorr - corr(ind)) / (normalization - dirCorr);
-        double val2 = (maxCorr + corr(ind)) / (normalization + dirCorr);
+        double val1 = (maxCorr - corr(ind)) / (normalization - dirCorr(ind));
+        double val2 = (maxCorr + corr(ind)) / (normalization + dirCorr(ind));
         if ((val1 > 0) && (val1 < gamma))
           gamma = val1;
         if ((val2 > 0) && (val2 < gamma))
@@ -307,9 +375,6 @@ double LARS::Train(const arma::mat& matX,
       }
     }
 
-    // Update the prediction.
-    yHat += gamma * yHatDirection;
-
     // Update the estimator.
     for (size_t i = 0; i < activeSet.size(); i++)
     {
@@ -334,7 +399,13 @@ double LARS::Train(const arma::mat& matX,
       Deactivate(changeInd);
     }
 
-    corr = vecXTy - trans(dataRef) * yHat;
+    // Only the active dimensions of beta are nonzero.
+    arma::vec activeBeta(activeSet.size());
+    for (size_t i = 0; i < activeSet.size(); i++)
+      activeBeta(i) = beta(activeSet[i]);
+    GramProduct(activeBeta, gramBeta);
+
+    corr = vecXTy - gramBeta;
     if (elasticNet)
       corr -= lambda2 * beta;
 
@@ -360,7 +431,6 @@ double LARS::Train(const arma::mat& matX,
   // Unfortunate copy...
   beta = betaPath.back();
 
-  Timer::Stop("lars_regression");
   return maxCorr;
 }
 
@@ -402,15 +472,6 @@ void LARS::Ignore(const size_t varInd)
   ignoreSet.push_back(varInd);
 }
 
-void LARS::ComputeYHatDirection(const arma::mat& matX,
-                                const arma::vec& betaDirection,
-                                arma::vec& yHatDirection)
-{
-  yHatDirection.fill(0);
-  for (size_t i = 0; i < activeSet.size(); i++)
-    yHatDirection += betaDirection(i) * matX.col(activeSet[i]);
-}
-
 void LARS::InterpolateBeta()
 {
   int pathLength = betaPath.size();
@@ -173,10 +173,10 @@ class LARS
   /**
    * Run LARS.  The input matrix (like all mlpack matrices) should be
    * column-major -- each column is an observation and each row is a dimension.
-   * However, because LARS is more efficient on a row-major matrix, this method
-   * will (internally) transpose the matrix.  If this transposition is not
-   * necessary (i.e., you want to pass in a row-major matrix), pass 'false' for
-   * the transposeData parameter.
+   * If you want to pass in a row-major matrix instead, pass 'false' for the
+   * transposeData parameter.  Either way the data is only used to compute
+   * X' y and (if one was not given) the Gram matrix X' X; the path itself is
+   * computed from those alone.
    *
    * @param data Column-major input data (or row-major input data if rowMajor =
    *     true).
@@ -193,10 +193,10 @@ class LARS
   /**
    * Run LARS.  The input matrix (like all mlpack matrices) should be
    * column-major -- each column is an observation and each row is a dimension.
-   * However, because LARS is more efficient on a row-major matrix, this method
-   * will (internally) transpose the matrix.  If this transposition is not
-   * necessary (i.e., you want to pass in a row-major matrix), pass 'false' for
-   * the transposeData parameter.
+   * If you want to pass in a row-major matrix instead, pass 'false' for the
+   * transposeData parameter.  Either way the data is only used to compute
+   * X' y and (if one was not given) the Gram matrix X' X; the path itself is
+   * computed from those alone.
    *
    * @param data Input data.
    * @param responses A vector of targets.
@@ -208,6 +208,27 @@ class LARS
                const arma::rowvec& responses,
                const bool transposeData = true);
 
+  /**
+   * Run LARS for many response vectors on the same data, such as when encoding
+   * many points with the same dictionary.  The Gram matrix and X' y are
+   * computed once for all responses (with matrix products), and then the
+   * responses are solved independently, in parallel if OpenMP is available.
+   * After this, the active set and paths held by this object are those of the
+   * last response.  The data is given the same way as for the other overloads
+   * of Train().
+   *
+   * @param data Input data.
+   * @param responses Matrix of targets; each column is one response vector,
+   *     with one element per observation.
+   * @param beta Matrix to store the solutions in, one column per response.
+   * @param transposeData Should be true if the input data is column-major and
+   *     false otherwise.
+   */
+  void Train(const arma::mat& data,
+             const arma::mat& responses,
+             arma::mat& beta,
+             const bool transposeData = true);
+
   /**
    * Predict y_i for each data point in the given data matrix using the
    * currently-trained LARS model.
@@ -311,10 +332,31 @@ class LARS
    */
   void Ignore(const size_t varInd);
 
-  // compute "equiangular" direction in output space
-  void ComputeYHatDirection(const arma::mat& matX,
-                            const arma::vec& betaDirection,
-                            arma::vec& yHatDirection);
+  /**
+   * Compute the Gram matrix of the given data, unless a Gram matrix of the
+   * right size was passed to the constructor.
+   *
+   * @param matX Input data.
+   * @param transposeData Whether the input data is column-major.
+   */
+  void ComputeGram(const arma::mat& matX, const bool transposeData);
+
+  /**
+   * Compute G.cols(activeSet) * coefficients, in parallel over the rows.
+   *
+   * @param coefficients One coefficient for each active dimension.
+   * @param product Vector to store the product in.
+   */
+  void GramProduct(const arma::vec& coefficients, arma::vec& product) const;
+
+  /**
+   * Compute the LARS path for the given X' y, using only the Gram matrix.
+   *
+   * @param vecXTy Correlations of the dimensions with the responses.
+   * @param beta Vector to store the solution in.
+   * @return The final absolute maximum correlation.
+   */
+  double TrainWithGram(const arma::vec& vecXTy, arma::vec& beta);
 
   // interpolate to compute last solution vector
   void InterpolateBeta();
@@ -88,6 +88,27 @@ double LinearRegression::Train(const arma::mat& predictors,
   return ComputeError(predictors, responses);
 }
 
+double LinearRegression::Train(const NormalEquations& equations)
+{
+  if (equations.NumPoints() == 0)
+    throw std::invalid_argument("LinearRegression::Train(): cannot train on "
+        "empty NormalEquations");
+
+  intercept = equations.Intercept();
+
+  const arma::mat& xtx = equations.XtX();
+  const arma::vec& xty = equations.XtY();
+  arma::mat cov = xtx + lambda * arma::eye<arma::mat>(xtx.n_rows, xtx.n_rows);
+  parameters = arma::solve(cov, xty);
+
+  // The squared error can be expanded as
+  //   ||y - X^T a||^2 = y y^T - 2 a^T X y^T + a^T (X X^T) a,
+  // so it can be computed from the sums too.
+  const double error = equations.YtY() - 2 * arma::dot(parameters, xty) +
+      arma::as_scalar(parameters.t() * xtx * parameters);
+  return std::max(error, 0.0) / equations.NumPoints();
+}
+
 void LinearRegression::Predict(const arma::mat& points,
     arma::rowvec& predictions) const
 {
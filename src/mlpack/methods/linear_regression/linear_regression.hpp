@@ -15,6 +15,8 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include "normal_equations.hpp"
+
 namespace mlpack {
 namespace regression /** Regression methods. */ {
 
@@ -95,6 +97,19 @@ class LinearRegression
                const arma::rowvec& weights,
                const bool intercept = true);
 
+  /**
+   * Train the LinearRegression model on the sums accumulated by a
+   * NormalEquations object, without needing the data itself.  This solves the
+   * same system as the other overloads of Train(), so on the same data (and
+   * with the same lambda) it gives the same model.  The intercept setting is
+   * taken from the NormalEquations object.  Careful! This will completely
+   * ignore and overwrite the existing model.
+   *
+   * @param equations Sums over the data to train on.
+   * @return The least squares error on the data after training.
+   */
+  double Train(const NormalEquations& equations);
+
   /**
    * Calculate y_i for each data point in points.
    *
@@ -0,0 +1,306 @@
+/**
+ * @file normal_equations.cpp
+ *
+ * Implementation of the NormalEquations class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "normal_equations.hpp"
+
+#include <fstream>
+#include <cstdlib>
+#include <algorithm>
+
+using namespace mlpack;
+using namespace mlpack::regression;
+
+NormalEquations::NormalEquations(const size_t dimensionality,
+                                 const bool intercept) :
+    dimensionality(0),
+    intercept(intercept),
+    numPoints(0),
+    yty(0.0)
+{
+  if (dimensionality > 0)
+    CheckDimensionality(dimensionality);
+}
+
+void NormalEquations::CheckDimensionality(const size_t pointDimensionality)
+{
+  if (dimensionality == 0 && numPoints == 0)
+  {
+    dimensionality = pointDimensionality;
+    const size_t size = dimensionality + (intercept ? 1 : 0);
+    xtx.zeros(size, size);
+    xty.zeros(size);
+  }
+  else if (pointDimensionality != dimensionality)
+  {
+    std::ostringstream oss;
+    oss << "NormalEquations: points have " << pointDimensionality
+        << " dimensions, but " << dimensionality << " were expected";
+    throw std::invalid_argument(oss.str());
+  }
+}
+
+void NormalEquations::Add(const arma::mat& predictors,
+                          const arma::rowvec& responses)
+{
+  Add(predictors, responses, arma::rowvec());
+}
+
+void NormalEquations::Add(const arma::mat& predictors,
+                          const arma::rowvec& responses,
+                          const arma::rowvec& weights)
+{
+  if (predictors.n_cols == 0)
+    return;
+
+  CheckDimensionality(predictors.n_rows);
+  if (responses.n_elem != predictors.n_cols ||
+      (weights.n_elem > 0 && weights.n_elem != predictors.n_cols))
+  {
+    throw std::invalid_argument("NormalEquations::Add(): number of responses "
+        "or weights does not match number of points");
+  }
+
+  // As in LinearRegression::Train(), the intercept is a leading row of ones.
+  arma::mat p;
+  if (intercept)
+    p = arma::join_cols(arma::ones<arma::rowvec>(predictors.n_cols),
+        predictors);
+  const arma::mat& x = intercept ? p : predictors;
+
+  if (weights.n_elem > 0)
+  {
+    const arma::mat weighted = x.each_row() % weights;
+    xtx += weighted * x.t();
+    xty += weighted * responses.t();
+    yty += arma::accu(weights % arma::square(responses));
+  }
+  else
+  {
+    xtx += x * x.t();
+    xty += x * responses.t();
+    yty += arma::dot(responses, responses);
+  }
+
+  numPoints += predictors.n_cols;
+}
+
+void NormalEquations::Merge(const NormalEquations& other)
+{
+  if (other.numPoints == 0)
+    return;
+
+  if (other.intercept != intercept)
+    throw std::invalid_argument("NormalEquations::Merge(): cannot merge sums "
+        "with different intercept settings");
+  CheckDimensionality(other.dimensionality);
+
+  xtx += other.xtx;
+  xty += other.xty;
+  yty += other.yty;
+  numPoints += other.numPoints;
+}
+
+void NormalEquations::Add(data::StreamReader& reader)
+{
+  arma::mat chunk;
+  while (reader.Next(chunk))
+  {
+    if (chunk.n_rows < 2)
+      throw std::runtime_error("NormalEquations::Add(): each point of '" +
+          reader.Filename() + "' must hold at least one dimension and a "
+          "response");
+
+    Add(chunk.rows(0, chunk.n_rows - 2), chunk.row(chunk.n_rows - 1));
+  }
+}
+
+/**
+ * Parse one number of a line, and skip the separator after it.  Returns false
+ * if there is no number at p.
+ */
+static bool ParseField(const char*& p, const char* end, double& value)
+{
+  char* next;
+  value = std::strtod(p, &next);
+  if (next == p || next > end)
+    return false;
+
+  p = next;
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+    ++p;
+  if (p < end && *p == ',')
+    ++p;
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+    ++p;
+
+  return true;
+}
+
+/**
+ * Parse the line from begin to end into the given column, and return whether
+ * it holds exactly size values.  If column is NULL, the values are only
+ * counted, and the count is returned through numFields.
+ */
+static bool ParseLine(const char* begin,
+                      const char* end,
+                      double* column,
+                      const size_t size,
+                      size_t& numFields)
+{
+  const char* p = begin;
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+    ++p;
+
+  numFields = 0;
+  double value;
+  while (p < end)
+  {
+    if (!ParseField(p, end, value))
+      return false;
+    if (column && numFields >= size)
+      return false;
+    if (column)
+      column[numFields] = value;
+    ++numFields;
+  }
+
+  return (column == NULL || numFields == size);
+}
+
+void NormalEquations::AddFile(const std::string& filename,
+                              const size_t chunkSize)
+{
+  std::ifstream stream(filename, std::ios::binary);
+  if (!stream.is_open())
+    throw std::runtime_error("NormalEquations::AddFile(): cannot open file '" +
+        filename + "'");
+
+  // The buffer holds the incomplete last line of the previous chunk, followed
+  // by the current chunk.  The complete lines of the buffer are parsed in
+  // parallel.
+  std::vector<char> chunk(chunkSize);
+  std::string buffer;
+  std::vector<std::pair<size_t, size_t>> lines;
+  size_t lineNumber = 0;
+
+  auto addLines = [&](const bool last)
+  {
+    // Find the non-empty complete lines in the buffer.
+    lines.clear();
+    size_t begin = 0, end, numLines = 0;
+    while (begin < buffer.size())
+    {
+      end = buffer.find('\n', begin);
+      if (end == std::string::npos)
+      {
+        if (!last)
+          break;
+        end = buffer.size();
+      }
+
+      ++numLines;
+      if (buffer.find_first_not_of(" \t\r", begin) < end)
+        lines.push_back(std::make_pair(begin, end));
+      begin = end + 1;
+    }
+
+    if (!lines.empty())
+    {
+      // The first line sets the dimensionality, if that's not known yet.
+      size_t numFields = 0;
+      if (dimensionality == 0 && numPoints == 0)
+      {
+        if (!ParseLine(buffer.data() + lines[0].first,
+            buffer.data() + lines[0].second, NULL, 0, numFields) ||
+            numFields < 2)
+        {
+          std::ostringstream oss;
+          oss << "NormalEquations::AddFile(): cannot parse data in '"
+              << filename << "'; each line must hold at least one dimension "
+              << "and a response";
+          throw std::runtime_error(oss.str());
+        }
+        CheckDimensionality(numFields - 1);
+      }
+
+      // Parse the lines in parallel.  Exceptions can't leave the parallel
+      // region, so just remember which line failed.
+      const size_t size = dimensionality + 1;
+      arma::mat values(size, lines.size());
+      size_t firstError = lines.size();
+      #pragma omp parallel for schedule(static)
+      for (omp_size_t i = 0; i < (omp_size_t) lines.size(); ++i)
+      {
+        size_t fields;
+        if (!ParseLine(buffer.data() + lines[i].first,
+            buffer.data() + lines[i].second, values.colptr(i), size, fields))
+        {
+          #pragma omp critical
+          firstError = std::min(firstError, (size_t) i);
+        }
+      }
+
+      if (firstError < lines.size())
+      {
+        // Recover the line number of the failed line.
+        const size_t errorLine = lineNumber + 1 + std::count(buffer.begin(),
+            buffer.begin() + lines[firstError].first, '\n');
+        std::ostringstream oss;
+        oss << "NormalEquations::AddFile(): cannot parse line " << errorLine
+            << " of '" << filename << "' as " << dimensionality
+            << " dimensions and a response";
+        throw std::runtime_error(oss.str());
+      }
+
+      // Sum each thread's share of the points separately, and merge the
+      // partial sums.
+      #pragma omp parallel
+      {
+        size_t numThreads = 1, thread = 0;
+        #ifdef HAS_OPENMP
+          numThreads = omp_get_num_threads();
+          thread = omp_get_thread_num();
+        #endif
+
+        const size_t first = thread * values.n_cols / numThreads;
+        const size_t last = (thread + 1) * values.n_cols / numThreads;
+        NormalEquations partial(dimensionality, intercept);
+        if (last > first)
+        {
+          partial.Add(values.submat(0, first, dimensionality - 1, last - 1),
+              values.submat(dimensionality, first, dimensionality, last - 1));
+        }
+
+        #pragma omp critical
+        Merge(partial);
+      }
+    }
+
+    lineNumber += numLines;
+    buffer.erase(0, std::min(begin, buffer.size()));
+  };
+
+  while (stream)
+  {
+    stream.read(chunk.data(), chunkSize);
+    const size_t count = (size_t) stream.gcount();
+    if (count == 0)
+      break;
+    buffer.append(chunk.data(), count);
+    addLines(false);
+  }
+
+  if (stream.bad())
+    throw std::runtime_error("NormalEquations::AddFile(): error reading file '"
+        + filename + "'");
+
+  // The last line may not end with a newline.
+  addLines(true);
+}
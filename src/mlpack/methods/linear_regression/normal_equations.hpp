@@ -0,0 +1,141 @@
+/**
+ * @file normal_equations.hpp
+ *
+ * The NormalEquations class, which accumulates the sufficient statistics of a
+ * least-squares problem so that LinearRegression can be trained on data that
+ * does not fit in memory.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_LINEAR_REGRESSION_NORMAL_EQUATIONS_HPP
+#define MLPACK_METHODS_LINEAR_REGRESSION_NORMAL_EQUATIONS_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/data/stream_reader.hpp>
+
+namespace mlpack {
+namespace regression {
+
+/**
+ * NormalEquations holds the sums X X^T, X y^T and y y^T over the points seen so
+ * far (where X holds one point per column, with a leading row of ones if an
+ * intercept is fit), which is all LinearRegression needs to solve for its
+ * parameters.  Points can be added in any number of chunks, and the sums of
+ * NormalEquations objects built from different parts of a dataset can be
+ * merged, so a dataset can be processed in parallel and never has to be in
+ * memory all at once.
+ *
+ * @code
+ * NormalEquations equations;
+ * equations.AddFile("huge_dataset.csv"); // Responses in the last column.
+ *
+ * LinearRegression lr;
+ * lr.Lambda() = 0.1;
+ * lr.Train(equations);
+ * @endcode
+ */
+class NormalEquations
+{
+ public:
+  /**
+   * Create empty sums for points of the given dimensionality.  If the
+   * dimensionality is 0, it is set by the first points that are added.
+   *
+   * @param dimensionality Dimensionality of the points (without intercept).
+   * @param intercept Whether or not an intercept term is fit.
+   */
+  NormalEquations(const size_t dimensionality = 0,
+                  const bool intercept = true);
+
+  /**
+   * Add the given points (one per column) and their responses to the sums.
+   *
+   * @param predictors Points to add.
+   * @param responses Responses of the points.
+   */
+  void Add(const arma::mat& predictors, const arma::rowvec& responses);
+
+  /**
+   * Add the given points (one per column), their responses and their weights
+   * to the sums.
+   *
+   * @param predictors Points to add.
+   * @param responses Responses of the points.
+   * @param weights Observation weights of the points.
+   */
+  void Add(const arma::mat& predictors,
+           const arma::rowvec& responses,
+           const arma::rowvec& weights);
+
+  /**
+   * Add the sums of another NormalEquations object (built with the same
+   * dimensionality and intercept setting) to these sums.
+   *
+   * @param other Sums to merge into these.
+   */
+  void Merge(const NormalEquations& other);
+
+  /**
+   * Add every point of the given text file to the sums.  Each line of the file
+   * holds one point: its dimensions and then its response, separated by commas,
+   * tabs or spaces; empty lines are skipped.  The file is read in chunks of the
+   * given number of bytes, and the lines of each chunk are parsed and summed
+   * in parallel (if OpenMP is available), with one partial sum per thread
+   * merged in at the end of the chunk.
+   *
+   * If the file cannot be read, a line cannot be parsed, or a line has the
+   * wrong number of values, std::runtime_error is thrown.
+   *
+   * @param filename File to read points from.
+   * @param chunkSize Number of bytes of the file to read at once.
+   */
+  void AddFile(const std::string& filename,
+               const size_t chunkSize = (1 << 26));
+
+  /**
+   * Add every remaining point of the given stream to the sums.  The last
+   * dimension of each point is its response.
+   *
+   * @param reader Stream to read points from.
+   */
+  void Add(data::StreamReader& reader);
+
+  //! Get the dimensionality of the points (without intercept).
+  size_t Dimensionality() const { return dimensionality; }
+  //! Get whether an intercept term is fit.
+  bool Intercept() const { return intercept; }
+  //! Get the number of points added.
+  size_t NumPoints() const { return numPoints; }
+
+  //! Get the sum of x x^T over the added points.
+  const arma::mat& XtX() const { return xtx; }
+  //! Get the sum of x y over the added points.
+  const arma::vec& XtY() const { return xty; }
+  //! Get the sum of y^2 over the added points.
+  double YtY() const { return yty; }
+
+ private:
+  //! Set the dimensionality, if it is not set yet, and check it.
+  void CheckDimensionality(const size_t pointDimensionality);
+
+  //! The dimensionality of the points (without intercept).
+  size_t dimensionality;
+  //! Whether an intercept term is fit.
+  bool intercept;
+  //! The number of points added.
+  size_t numPoints;
+  //! The sum of x x^T.
+  arma::mat xtx;
+  //! The sum of x y.
+  arma::vec xty;
+  //! The sum of y^2.
+  double yty;
+};
+
+} // namespace regression
+} // namespace mlpack
+
+#endif
@@ -164,9 +164,9 @@ class LinearSVMFunction
   arma::mat& InitialPoint() { return initialPoint; }
 
   //! Get the dataset.
-  const arma::sp_mat& Dataset() const { return dataset; }
+  const MatType& Dataset() const { return dataset; }
   //! Modify the dataset.
-  arma::sp_mat& Dataset() { return dataset; }
+  MatType& Dataset() { return dataset; }
 
   //! Sets the regularization parameter.
   double& Lambda() { return lambda; }
@@ -180,11 +180,31 @@ class LinearSVMFunction
   size_t NumFunctions() const;
 
  private:
+  /**
+   * Compute the hinge loss objective on the given points, and its gradient if
+   * gradient is not NULL.  The points are processed in blocks, in parallel if
+   * OpenMP is available; the scores, margins and gradient contributions of a
+   * block are computed together, so the only temporaries are per-block and
+   * per-thread.  Sparse points are handled by only touching their nonzero
+   * features.
+   *
+   * @param parameters The parameters of the SVM.
+   * @param firstId Index of the first point to use.
+   * @param batchSize Number of points to use.
+   * @param gradient Matrix to output the gradient into, or NULL.
+   * @return The value of the objective on the given points.
+   */
+  template <typename GradType>
+  double HingeLoss(const arma::mat& parameters,
+                   const size_t firstId,
+                   const size_t batchSize,
+                   GradType* gradient) const;
+
   //! The initial point, from which to start the optimization.
   arma::mat initialPoint;
 
-  //! Label matrix for provided data
-  arma::sp_mat groundTruth;
+  //! Labels of the datapoints.
+  arma::Row<size_t> labels;
 
   //! The datapoints for training.
   MatType dataset;
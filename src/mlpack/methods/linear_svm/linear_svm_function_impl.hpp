@@ -31,6 +31,7 @@ LinearSVMFunction<MatType>::LinearSVMFunction(
     const double lambda,
     const double delta,
     const bool fitIntercept) :
+    labels(labels),
     dataset(math::MakeAlias(const_cast<MatType&>(dataset), false)),
     numClasses(numClasses),
     lambda(lambda),
@@ -40,8 +41,6 @@ LinearSVMFunction<MatType>::LinearSVMFunction(
   InitializeWeights(initialPoint, dataset.n_rows, numClasses, fitIntercept);
   initialPoint *= 0.005;
 
-  // Calculate the label matrix.
-  GetGroundTruthMatrix(labels, groundTruth);
 }
 
 /**
@@ -110,86 +109,218 @@ void LinearSVMFunction<MatType>::GetGroundTruthMatrix(
 template <typename MatType>
 void LinearSVMFunction<MatType>::Shuffle()
 {
-  // Determine new ordering.
-  arma::uvec ordering = arma::shuffle(arma::linspace<arma::uvec>(0,
-      dataset.n_cols - 1, dataset.n_cols));
+  MatType newData;
+  arma::Row<size_t> newLabels;
 
-  // Re-sort data.
-  arma::mat newData = dataset.cols(ordering);
+  math::ShuffleData(dataset, labels, newData, newLabels);
+
+  // If we are an alias, make sure we don't write to the original data.
   math::ClearAlias(dataset);
+
+  // Take ownership of the new data.
   dataset = std::move(newData);
+  labels = std::move(newLabels);
+}
 
-  // Assemble data for batch constructor.  We need reverse orderings though...
-  arma::uvec reverseOrdering(ordering.n_elem);
-  for (size_t i = 0; i < ordering.n_elem; ++i)
-    reverseOrdering[ordering[i]] = i;
+//! Compute the class scores of a block of dense points; the weights are given
+//! transposed (one row per class).
+template<typename MatType>
+void BlockScores(
+    const arma::mat& weightsT,
+    const MatType& dataset,
+    const size_t begin,
+    const size_t count,
+    arma::mat& scores,
+    const typename std::enable_if_t<!arma::is_SpMat<MatType>::value>* = 0)
+{
+  const arma::mat block(const_cast<double*>(dataset.colptr(begin)),
+      dataset.n_rows, count, false, true);
+  scores = weightsT * block;
+}
 
-  arma::umat newLocations(2, groundTruth.n_nonzero);
-  arma::vec values(groundTruth.n_nonzero);
-  arma::sp_mat::const_iterator it = groundTruth.begin();
-  size_t loc = 0;
-  while (it != groundTruth.end())
+//! Compute the class scores of a block of sparse points; only the nonzero
+//! features contribute.
+template<typename MatType>
+void BlockScores(
+    const arma::mat& weightsT,
+    const MatType& dataset,
+    const size_t begin,
+    const size_t count,
+    arma::mat& scores,
+    const typename std::enable_if_t<arma::is_SpMat<MatType>::value>* = 0)
+{
+  scores.zeros(weightsT.n_rows, count);
+  for (size_t i = 0; i < count; ++i)
   {
-    newLocations(0, loc) = reverseOrdering(it.col());
-    newLocations(1, loc) = it.row();
-    values(loc) = (*it);
-
-    ++it;
-    ++loc;
+    typename MatType::const_iterator it = dataset.begin_col(begin + i);
+    for (; it != dataset.end_col(begin + i); ++it)
+      scores.col(i) += (*it) * weightsT.col(it.row());
   }
+}
 
-  groundTruth = arma::sp_mat(newLocations, values, groundTruth.n_rows,
-                             groundTruth.n_cols);
+//! Add the gradient contribution of a block of dense points, given the
+//! coefficient of each (class, point) pair, to the transposed gradient.
+template<typename MatType>
+void AddBlockGradient(
+    const MatType& dataset,
+    const size_t begin,
+    const arma::mat& coefficients,
+    arma::mat& gradientT,
+    const typename std::enable_if_t<!arma::is_SpMat<MatType>::value>* = 0)
+{
+  const arma::mat block(const_cast<double*>(dataset.colptr(begin)),
+      dataset.n_rows, coefficients.n_cols, false, true);
+  gradientT += coefficients * block.t();
 }
 
-template <typename MatType>
-double LinearSVMFunction<MatType>::Evaluate(
-    const arma::mat& parameters)
+//! Add the gradient contribution of a block of sparse points, given the
+//! coefficient of each (class, point) pair, to the transposed gradient; only
+//! the columns of nonzero features are touched.
+template<typename MatType>
+void AddBlockGradient(
+    const MatType& dataset,
+    const size_t begin,
+    const arma::mat& coefficients,
+    arma::mat& gradientT,
+    const typename std::enable_if_t<arma::is_SpMat<MatType>::value>* = 0)
 {
-  // The objective function is the hinge loss function and it is
-  // calculated over all the training examples.
+  for (size_t i = 0; i < coefficients.n_cols; ++i)
+  {
+    typename MatType::const_iterator it = dataset.begin_col(begin + i);
+    for (; it != dataset.end_col(begin + i); ++it)
+      gradientT.col(it.row()) += (*it) * coefficients.col(i);
+  }
+}
 
-  // Calculate the loss and regularization terms.
+template <typename MatType>
+template <typename GradType>
+double LinearSVMFunction<MatType>::HingeLoss(
+    const arma::mat& parameters,
+    const size_t firstId,
+    const size_t batchSize,
+    GradType* gradient) const
+{
+  // The loss is
   // L_i = Σ_i Σ_m max(0, Δ + (w_m x_i + b_m) - (w_{y_i} x_i + b_{y_i}))
-  // where (m != y_i)
-  double loss, regularization;
-
-  // Scores for each class are evaluated.
-  arma::mat scores;
+  // where (m != y_i).  The points are processed in blocks; for each block the
+  // scores are computed, then the margins of each point, and then the
+  // gradient, which is
+  //  - x_i added to w_m for each positive margin of x_i, and
+  //  - x_i subtracted from w_{y_i} once for each positive margin of x_i.
+  // Working on one block at a time keeps the temporaries small, and lets the
+  // blocks be processed in parallel.
+  const size_t dimensionality = dataset.n_rows;
+  const size_t blockSize = 256;
+  const size_t numBlocks = (batchSize + blockSize - 1) / blockSize;
+
+  // Keep the weights transposed (one row per class), so that the weights of a
+  // feature are contiguous, and get the intercepts.
+  const arma::mat weightsT = parameters.rows(0, dimensionality - 1).t();
+  arma::vec intercepts;
+  if (fitIntercept)
+    intercepts = parameters.row(dimensionality).t();
 
-  // Check intercept condition.
-  if (!fitIntercept)
+  // The gradient is accumulated transposed too.
+  arma::mat gradientT;
+  arma::vec interceptGradient;
+  if (gradient)
   {
-    scores = parameters.t() * dataset;
+    gradientT.zeros(numClasses, dimensionality);
+    if (fitIntercept)
+      interceptGradient.zeros(numClasses);
   }
-  else
+
+  double loss = 0.0;
+  #pragma omp parallel reduction(+:loss)
   {
-    // When using `fitIntercept` we need to add the `b_i` term explicitly.
-    // The first `parameters.n_rows - 1` rows of parameters holds the value
-    // of Weights `w_i`, and the last row holds `b_i`.
-    // On calculating the score, we add `b_i` term to each element of
-    // `i_th` row of `scores`.
-    scores = parameters.rows(0, dataset.n_rows - 1).t() * dataset
-        + arma::repmat(parameters.row(dataset.n_rows).t(), 1,
-        dataset.n_cols);
+    // Per-thread buffers, reused for each block.
+    arma::mat scores, coefficients;
+    arma::mat threadGradientT;
+    arma::vec threadInterceptGradient;
+    if (gradient)
+    {
+      threadGradientT.zeros(numClasses, dimensionality);
+      if (fitIntercept)
+        threadInterceptGradient.zeros(numClasses);
+    }
+
+    #pragma omp for schedule(static)
+    for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+    {
+      const size_t begin = firstId + b * blockSize;
+      const size_t count = std::min(blockSize, firstId + batchSize - begin);
+
+      BlockScores(weightsT, dataset, begin, count, scores);
+      if (fitIntercept)
+        scores.each_col() += intercepts;
+
+      if (gradient)
+        coefficients.set_size(numClasses, count);
+
+      for (size_t i = 0; i < count; ++i)
+      {
+        const size_t label = labels[begin + i];
+        const double correctScore = scores(label, i);
+        double numPositive = 0.0;
+        for (size_t m = 0; m < numClasses; ++m)
+        {
+          const double margin = scores(m, i) - correctScore + delta;
+          const bool positive = (m != label && margin > 0);
+          if (positive)
+          {
+            loss += margin;
+            numPositive += 1.0;
+          }
+
+          if (gradient)
+            coefficients(m, i) = positive ? 1.0 : 0.0;
+        }
+
+        if (gradient)
+          coefficients(label, i) = -numPositive;
+      }
+
+      if (gradient)
+      {
+        AddBlockGradient(dataset, begin, coefficients, threadGradientT);
+        if (fitIntercept)
+          threadInterceptGradient += arma::sum(coefficients, 1);
+      }
+    }
+
+    if (gradient)
+    {
+      #pragma omp critical
+      {
+        gradientT += threadGradientT;
+        if (fitIntercept)
+          interceptGradient += threadInterceptGradient;
+      }
+    }
   }
 
-  // Evaluate the margin by the following steps:
-  //  - Subtracting the score of correct class from all the class scores.
-  //  - Adding the margin parameter `delta`.
-  //  - Removing the `delta` parameter from correct class label in each
-  //    column.
-  arma::mat margin = scores - (arma::repmat(arma::ones(numClasses).t()
-      * (scores % groundTruth), numClasses, 1)) + delta
-      - (delta * groundTruth);
+  if (gradient)
+  {
+    gradient->set_size(arma::size(parameters));
+    gradient->rows(0, dimensionality - 1) = gradientT.t();
+    if (fitIntercept)
+      gradient->row(dimensionality) = interceptGradient.t();
+
+    (*gradient) /= batchSize;
 
-  // The Hinge Loss Function
-  loss = arma::accu(arma::clamp(margin, 0.0, DBL_MAX)) / dataset.n_cols;
+    // Adding the regularization contribution to the gradient.
+    (*gradient) += lambda * parameters;
+  }
 
   // Adding the regularization term.
-  regularization = 0.5 * lambda * arma::dot(parameters, parameters);
+  return loss / batchSize + 0.5 * lambda * arma::dot(parameters, parameters);
+}
 
-  return loss + regularization;
+template <typename MatType>
+double LinearSVMFunction<MatType>::Evaluate(
+    const arma::mat& parameters)
+{
+  return HingeLoss(parameters, 0, dataset.n_cols, (arma::mat*) NULL);
 }
 
 template <typename MatType>
@@ -198,40 +329,7 @@ double LinearSVMFunction<MatType>::Evaluate(
     const size_t firstId,
     const size_t batchSize)
 {
-  const size_t lastId = firstId + batchSize - 1;
-
-  // Calculate the loss and regularization terms.
-  double loss, regularization, cost;
-
-  // Scores for each class are evaluated.
-  arma::mat scores;
-
-  // Check intercept condition.
-  if (!fitIntercept)
-  {
-    scores = parameters.t() * dataset.cols(firstId, lastId);
-  }
-  else
-  {
-    scores = parameters.rows(0, dataset.n_rows - 1).t()
-        * dataset.cols(firstId, lastId)
-        + arma::repmat(parameters.row(dataset.n_rows).t(), 1,
-        dataset.n_cols);
-  }
-
-  arma::mat margin = scores - (arma::repmat(arma::ones(numClasses).t()
-      * (scores % groundTruth.cols(firstId, lastId)), numClasses, 1))
-      + delta - (delta * groundTruth.cols(firstId, lastId));
-
-  // The Hinge Loss Function
-  loss = arma::accu(arma::clamp(margin, 0.0, DBL_MAX));
-  loss /= batchSize;
-
-  // Adding the regularization term.
-  regularization = 0.5 * lambda * arma::dot(parameters, parameters);
-
-  cost = loss + regularization;
-  return cost;
+  return HingeLoss(parameters, firstId, batchSize, (arma::mat*) NULL);
 }
 
 template <typename MatType>
@@ -240,62 +338,7 @@ void LinearSVMFunction<MatType>::Gradient(
     const arma::mat& parameters,
     GradType& gradient)
 {
-  // The objective is to minimize the loss, which is evaluated as the sum
-  // of all the positive elements of `margin` matrix.
-  // So, we focus of these positive elements and reduce them.
-  // Also, we need to increase the score of the correct class.
-
-  // Scores for each class are evaluated.
-  arma::mat scores;
-
-  if (!fitIntercept)
-  {
-    scores = parameters.t() * dataset;
-  }
-  else
-  {
-    scores = parameters.rows(0, dataset.n_rows - 1).t() * dataset
-        + arma::repmat(parameters.row(dataset.n_rows).t(), 1,
-        dataset.n_cols);
-  }
-
-  arma::mat margin = scores - (arma::repmat(arma::ones(numClasses).t()
-      * (scores % groundTruth), numClasses, 1)) + delta
-      - (delta * groundTruth);
-
-  // An element of `mask` matrix holds `1` corresponding to
-  // each positive element of `margin` matrix.
-  arma::mat mask = margin.for_each([](arma::mat::elem_type& val)
-      { val = (val > 0) ? 1: 0; });
-
-  arma::mat difference = groundTruth
-      % (-arma::repmat(arma::sum(mask), numClasses, 1)) + mask;
-
-  // The gradient is evaluated as follows:
-  //  - Add `x_i` to `w_j` if `margin_i_m`is positive.
-  //  - Subtract `x_i` from `w_y_i` for each positive
-  //    `margin_i_j`.
-  //  - Take the average over the size of dataset.
-  //  - Add the regularization parameter.
-
-  // Check intercept condition
-  if (!fitIntercept)
-  {
-    gradient = dataset * difference.t();
-  }
-  else
-  {
-    gradient.set_size(size(parameters));
-    gradient.submat(0, 0, parameters.n_rows - 2, parameters.n_cols - 1) =
-        dataset * difference.t();
-    gradient.row(parameters.n_rows - 1) =
-        arma::ones<arma::rowvec>(dataset.n_cols) * difference.t();
-  }
-
-  gradient /= dataset.n_cols;
-
-  // Adding the regularization contribution to the gradient.
-  gradient += lambda * parameters;
+  HingeLoss(parameters, 0, dataset.n_cols, &gradient);
 }
 
 template <typename MatType>
@@ -306,53 +349,7 @@ void LinearSVMFunction<MatType>::Gradient(
     GradType& gradient,
     const size_t batchSize)
 {
-  const size_t lastId = firstId + batchSize - 1;
-
-  // Scores for each class are evaluated.
-  arma::mat scores;
-
-  // Check intercept condition.
-  if (!fitIntercept)
-  {
-    scores = parameters.t() * dataset.cols(firstId, lastId);
-  }
-  else
-  {
-    scores = parameters.rows(0, dataset.n_rows - 1).t()
-        * dataset.cols(firstId, lastId)
-        + arma::repmat(parameters.row(dataset.n_rows).t(), 1, dataset.n_cols);
-  }
-
-  arma::mat margin = scores - (arma::repmat(arma::ones(numClasses).t()
-      * (scores % groundTruth.cols(firstId, lastId)), numClasses, 1))
-      + delta - (delta * groundTruth.cols(firstId, lastId));
-
-  // For each sample, find the total number of classes where
-  // ( margin > 0 ).
-  arma::mat mask = margin.for_each([](arma::mat::elem_type& val)
-      { val = (val > 0) ? 1: 0; });
-
-  arma::mat difference = groundTruth.cols(firstId, lastId)
-      % (-arma::repmat(arma::sum(mask), numClasses, 1)) + mask;
-
-  // Check intercept condition
-  if (!fitIntercept)
-  {
-    gradient = dataset.cols(firstId, lastId) * difference.t();
-  }
-  else
-  {
-    gradient.set_size(size(parameters));
-    gradient.submat(0, 0, parameters.n_rows - 2, parameters.n_cols - 1) =
-        dataset.cols(firstId, lastId) * difference.t();
-    gradient.row(parameters.n_rows - 1) =
-        arma::ones<arma::rowvec>(batchSize) * difference.t();
-  }
-
-  gradient /= batchSize;
-
-  // Adding the regularization contribution to the gradient.
-  gradient += lambda * parameters;
+  HingeLoss(parameters, firstId, batchSize, &gradient);
 }
 
 template <typename MatType>
@@ -361,62 +358,7 @@ double LinearSVMFunction<MatType>::EvaluateWithGradient(
     const arma::mat& parameters,
     GradType& gradient) const
 {
-  double loss, regularization, cost;
-
-  // Scores for each class are evaluated.
-  arma::mat scores;
-
-  if (!fitIntercept)
-  {
-    scores = parameters.t() * dataset;
-  }
-  else
-  {
-    scores = parameters.rows(0, dataset.n_rows - 1).t() * dataset
-        + arma::repmat(parameters.row(dataset.n_rows).t(), 1,
-        dataset.n_cols);
-  }
-
-  arma::mat margin = scores - (arma::repmat(arma::ones(numClasses).t()
-      * (scores % groundTruth), numClasses, 1)) + delta
-      - (delta * groundTruth);
-
-  // For each sample, find the total number of classes where
-  // ( margin > 0 ).
-  arma::mat mask = margin.for_each([](arma::mat::elem_type& val)
-      { val = (val > 0) ? 1: 0; });
-
-  arma::mat difference = groundTruth
-      % (-arma::repmat(arma::sum(mask), numClasses, 1)) + mask;
-
-  // Check intercept condition
-  if (!fitIntercept)
-  {
-    gradient = dataset * difference.t();
-  }
-  else
-  {
-    gradient.set_size(size(parameters));
-    gradient.submat(0, 0, parameters.n_rows - 2, parameters.n_cols - 1) =
-            dataset * difference.t();
-    gradient.row(parameters.n_rows - 1) =
-            arma::ones<arma::rowvec>(dataset.n_cols) * difference.t();
-  }
-
-  gradient /= dataset.n_cols;
-
-  // Adding the regularization contribution to the gradient.
-  gradient += lambda * parameters;
-
-  // The Hinge Loss Function
-  loss = arma::accu(arma::clamp(margin, 0.0, DBL_MAX));
-  loss /= dataset.n_cols;
-
-  // Adding the regularization term.
-  regularization = 0.5 * lambda * arma::dot(parameters, parameters);
-
-  cost = loss + regularization;
-  return cost;
+  return HingeLoss(parameters, 0, dataset.n_cols, &gradient);
 }
 
 template <typename MatType>
@@ -427,67 +369,7 @@ double LinearSVMFunction<MatType>::EvaluateWithGradient(
     GradType& gradient,
     const size_t batchSize) const
 {
-  const size_t lastId = firstId + batchSize - 1;
-
-  // Calculate the loss and regularization terms.
-  double loss, regularization, cost;
-
-  // Scores for each class are evaluated.
-  arma::mat scores;
-
-  // Check intercept condition.
-  if (!fitIntercept)
-  {
-    scores = parameters.t() * dataset.cols(firstId, lastId);
-  }
-  else
-  {
-    scores = parameters.rows(0, dataset.n_rows - 1).t()
-        * dataset.cols(firstId, lastId)
-        + arma::repmat(parameters.row(dataset.n_rows).t(), 1, dataset.n_cols);
-  }
-
-  arma::mat margin = scores - (arma::repmat(arma::ones(numClasses).t()
-      * (scores % groundTruth.cols(firstId, lastId)), numClasses, 1))
-      + delta - (delta * groundTruth.cols(firstId, lastId));
-
-  // For each sample, find the total number of classes where
-  // ( margin > 0 ).
-  arma::mat mask = margin.for_each([](arma::mat::elem_type& val)
-      { val = (val > 0) ? 1: 0; });
-
-  arma::mat difference = groundTruth.cols(firstId, lastId)
-      % (-arma::repmat(arma::sum(mask), numClasses, 1)) + mask;
-
-  // Check intercept condition
-  if (!fitIntercept)
-  {
-    gradient = dataset.cols(firstId, lastId) * difference.t();
-  }
-  else
-  {
-    gradient.set_size(size(parameters));
-    gradient.submat(0, 0, parameters.n_rows - 2, parameters.n_cols - 1) =
-        dataset.cols(firstId, lastId) * difference.t();
-    gradient.row(parameters.n_rows - 1) =
-        arma::ones<arma::rowvec>(batchSize) * difference.t();
-  }
-
-  gradient /= batchSize;
-
-
-  // Adding the regularization contribution to the gradient.
-  gradient += lambda * parameters;
-
-  // The Hinge Loss Function
-  loss = arma::accu(arma::clamp(margin.cols(firstId, lastId), 0.0, DBL_MAX));
-  loss /= batchSize;
-
-  // Adding the regularization term.
-  regularization = 0.5 * lambda * arma::dot(parameters, parameters);
-
-  cost = loss + regularization;
-  return cost;
+  return HingeLoss(parameters, firstId, batchSize, &gradient);
 }
 
 template <typename MatType>
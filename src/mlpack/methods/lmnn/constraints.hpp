@@ -178,6 +178,17 @@ class Constraints
   //! Modify the number of target neighbors (k).
   size_t& K() { return k; }
 
+  /**
+   * Get whether the trees of the impostor searches are reused (and refit to
+   * the given dataset, see NeighborSearch::Refit()) instead of rebuilt.  The
+   * trees are kept for each class from one call to Impostors() to the next
+   * either way; this should only be set when the dataset given to Impostors()
+   * has changed little since the trees were last built.
+   */
+  const bool& RefitTrees() const { return refitTrees; }
+  //! Modify whether the trees of the impostor searches are refit.
+  bool& RefitTrees() { return refitTrees; }
+
   //! Access the boolean value of precalculated.
   const bool& PreCalulated() const { return precalculated; }
   //! Modify the value of precalculated.
@@ -199,12 +210,25 @@ class Constraints
   //! False if nothing has ever been precalculated.
   bool precalculated;
 
+  //! Searchers over the differently labeled points of each class, whose trees
+  //! are kept for the next impostor search.
+  std::vector<KNN> impostorSearchers;
+
+  //! If true, the cached impostor search trees are refit instead of rebuilt.
+  bool refitTrees;
+
   /**
   * Precalculate the unique labels, and indices of similar
   * and different datapoints on the basis of labels.
   */
   inline void Precalculate(const arma::Row<size_t>& labels);
 
+  /**
+  * Get the searcher over the differently labeled points of the i'th class,
+  * with its reference set updated to the given dataset.
+  */
+  inline KNN& ImpostorSearcher(const size_t i, const arma::mat& dataset);
+
   /**
   * Re-order neighbors on the basis of increasing norm in case
   * of ties among distances.
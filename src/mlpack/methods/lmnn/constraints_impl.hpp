@@ -24,7 +24,8 @@ Constraints<MetricType>::Constraints(
     const arma::Row<size_t>& labels,
     const size_t k) :
     k(k),
-    precalculated(false)
+    precalculated(false),
+    refitTrees(false)
 {
   // Ensure a valid k is passed.
   size_t minCount = arma::min(arma::histc(labels, arma::unique(labels)));
@@ -77,6 +78,23 @@ inline void Constraints<MetricType>::ReorderResults(
   }
 }
 
+template<typename MetricType>
+inline typename Constraints<MetricType>::KNN&
+Constraints<MetricType>::ImpostorSearcher(const size_t i,
+                                          const arma::mat& dataset)
+{
+  // Building the tree is the most expensive part of the search when the
+  // impostors are recomputed often, so if the dataset has changed little, we
+  // only move the points of the last tree.
+  KNN& knn = impostorSearchers[i];
+  if (refitTrees && knn.ReferenceSet().n_cols == indexDiff[i].n_elem)
+    knn.Refit(dataset.cols(indexDiff[i]));
+  else
+    knn.Train(dataset.cols(indexDiff[i]));
+
+  return knn;
+}
+
 // Calculates k similar labeled nearest neighbors.
 template<typename MetricType>
 void Constraints<MetricType>::TargetNeighbors(arma::Mat<size_t>& outputMatrix,
@@ -171,9 +189,6 @@ void Constraints<MetricType>::Impostors(arma::Mat<size_t>& outputMatrix,
   // Perform pre-calculation. If neccesary.
   Precalculate(labels);
 
-  // KNN instance.
-  KNN knn;
-
   arma::Mat<size_t> neighbors;
   arma::mat distances;
 
@@ -181,7 +196,7 @@ void Constraints<MetricType>::Impostors(arma::Mat<size_t>& outputMatrix,
   {
     // Perform KNN search with differently labeled points as reference
     // set and  same class points as query set.
-    knn.Train(dataset.cols(indexDiff[i]));
+    KNN& knn = ImpostorSearcher(i, dataset);
     knn.Search(dataset.cols(indexSame[i]), k, neighbors, distances);
 
     // Re-order neighbors on the basis of increasing norm in case
@@ -209,9 +224,6 @@ void Constraints<MetricType>::Impostors(arma::Mat<size_t>& outputNeighbors,
   // Perform pre-calculation. If neccesary.
   Precalculate(labels);
 
-  // KNN instance.
-  KNN knn;
-
   arma::Mat<size_t> neighbors;
   arma::mat distances;
 
@@ -219,7 +231,7 @@ void Constraints<MetricType>::Impostors(arma::Mat<size_t>& outputNeighbors,
   {
     // Perform KNN search with differently labeled points as reference
     // set and  same class points as query set.
-    knn.Train(dataset.cols(indexDiff[i]));
+    KNN& knn = ImpostorSearcher(i, dataset);
     knn.Search(dataset.cols(indexSame[i]), k, neighbors, distances);
 
     // Re-order neighbors on the basis of increasing norm in case
@@ -252,9 +264,6 @@ void Constraints<MetricType>::Impostors(arma::Mat<size_t>& outputMatrix,
   arma::mat subDataset = dataset.cols(begin, begin + batchSize - 1);
   arma::Row<size_t> sublabels = labels.cols(begin, begin + batchSize - 1);
 
-  // KNN instance.
-  KNN knn;
-
   arma::Mat<size_t> neighbors;
   arma::mat distances;
 
@@ -268,7 +277,7 @@ void Constraints<MetricType>::Impostors(arma::Mat<size_t>& outputMatrix,
 
     // Perform KNN search with differently labeled points as reference
     // set and same class points as query set.
-    knn.Train(dataset.cols(indexDiff[i]));
+    KNN& knn = ImpostorSearcher(i, dataset);
     knn.Search(subDataset.cols(subIndexSame), k, neighbors, distances);
 
     // Re-order neighbors on the basis of increasing norm in case
@@ -301,9 +310,6 @@ void Constraints<MetricType>::Impostors(arma::Mat<size_t>& outputNeighbors,
   arma::mat subDataset = dataset.cols(begin, begin + batchSize - 1);
   arma::Row<size_t> sublabels = labels.cols(begin, begin + batchSize - 1);
 
-  // KNN instance.
-  KNN knn;
-
   arma::Mat<size_t> neighbors;
   arma::mat distances;
 
@@ -317,7 +323,7 @@ void Constraints<MetricType>::Impostors(arma::Mat<size_t>& outputNeighbors,
 
     // Perform KNN search with differently labeled points as reference
     // set and same class points as query set.
-    knn.Train(dataset.cols(indexDiff[i]));
+    KNN& knn = ImpostorSearcher(i, dataset);
     knn.Search(subDataset.cols(subIndexSame), k, neighbors, distances);
 
     // Re-order neighbors on the basis of increasing norm in case
@@ -345,12 +351,13 @@ void Constraints<MetricType>::Impostors(arma::Mat<size_t>& outputNeighbors,
                                         const arma::uvec& points,
                                         const size_t numPoints)
 {
+  // The bounds may show that no impostors can have changed.
+  if (numPoints == 0)
+    return;
+
   // Perform pre-calculation. If neccesary.
   Precalculate(labels);
 
-  // KNN instance.
-  KNN knn;
-
   arma::Mat<size_t> neighbors;
   arma::mat distances;
 
@@ -362,10 +369,12 @@ void Constraints<MetricType>::Impostors(arma::Mat<size_t>& outputNeighbors,
     // Calculate impostors.
     subIndexSame = arma::find(labels.cols(points.head(numPoints)) ==
         uniqueLabels[i]);
+    if (subIndexSame.n_elem == 0)
+      continue;
 
     // Perform KNN search with differently labeled points as reference
     // set and same class points as query set.
-    knn.Train(dataset.cols(indexDiff[i]));
+    KNN& knn = ImpostorSearcher(i, dataset);
     knn.Search(dataset.cols(points.elem(subIndexSame)),
         k, neighbors, distances);
 
@@ -432,6 +441,10 @@ inline void Constraints<MetricType>::Precalculate(
   indexSame.resize(uniqueLabels.n_elem);
   indexDiff.resize(uniqueLabels.n_elem);
 
+  // The cached trees hold the old indices.
+  impostorSearchers.clear();
+  impostorSearchers.resize(uniqueLabels.n_elem);
+
   for (size_t i = 0; i < uniqueLabels.n_elem; i++)
   {
     // Store same and diff indices.
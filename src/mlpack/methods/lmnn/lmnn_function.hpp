@@ -236,6 +236,8 @@ class LMNNFunction
   arma::uvec points;
   //! Flag for controlling use of bounds over impostors.
   bool impBounds;
+  //! Transformation the impostor search trees were last built with.
+  arma::mat treeTransformation;
   /**
   * Precalculate the gradient part due to target neighbors and stores
   * the result as a matrix. Used for L-BFGS like optimizers which does not
@@ -246,6 +248,18 @@ class LMNNFunction
   inline void UpdateCache(const arma::mat& transformation,
                           const size_t begin,
                           const size_t batchSize);
+  /**
+  * Sum the outer products of the differences between the points from begin
+  * on and their neighbors, weighted by the given weights (one column per
+  * point, one row per neighbor), and store the result in outer.
+  */
+  inline void OuterProducts(const arma::Mat<size_t>& neighbors,
+                            const arma::mat& weights,
+                            const size_t begin,
+                            arma::mat& outer) const;
+  //! Decide whether the impostor search trees can be refit to the dataset
+  //! transformed by the given transformation, or must be rebuilt.
+  inline void UpdateTreeTransformation(const arma::mat& transformation);
   //! Calculate norm of change in transformation.
   inline void TransDiff(std::map<size_t, double>& transformationDiffs,
                         const arma::mat& transformation,
@@ -86,6 +86,7 @@ LMNNFunction<MetricType>::LMNNFunction(const arma::mat& dataset,
 
   constraint.TargetNeighbors(targetNeighbors, dataset, labels, norm);
   constraint.Impostors(impostors, dataset, labels, norm);
+  treeTransformation = initialPoint;
 
   // Precalculate and save the gradient due to target neighbors.
   Precalculate();
@@ -240,12 +241,16 @@ double LMNNFunction<MetricType>::Evaluate(const arma::mat& transformation)
         }
       }
 
+      UpdateTreeTransformation(transformation);
+
       // Re-calculate impostors on transformed dataset.
       constraint.Impostors(impostors, distance,
           transformedDataset, labels, norm, points, numPoints);
     }
     else
     {
+      UpdateTreeTransformation(transformation);
+
       // Re-calculate impostors on transformed dataset.
       constraint.Impostors(impostors, distance, transformedDataset, labels,
           norm);
@@ -253,6 +258,8 @@ double LMNNFunction<MetricType>::Evaluate(const arma::mat& transformation)
   }
   else if (iteration++ % range == 0)
   {
+    UpdateTreeTransformation(transformation);
+
     // Re-calculate impostors on transformed dataset.
     constraint.Impostors(impostors, distance, transformedDataset, labels, norm);
   }
@@ -373,12 +380,16 @@ double LMNNFunction<MetricType>::Evaluate(const arma::mat& transformation,
       }
     }
 
+    UpdateTreeTransformation(transformation);
+
     // Re-calculate impostors on transformed dataset.
     constraint.Impostors(impostors, distance,
         transformedDataset, labels, norm, points, numPoints);
   }
   else if (iteration++ % range == 0)
   {
+    UpdateTreeTransformation(transformation);
+
     // Re-calculate impostors on transformed dataset.
     constraint.Impostors(impostors, distance, transformedDataset, labels,
         norm, begin, batchSize);
@@ -494,12 +505,16 @@ void LMNNFunction<MetricType>::Gradient(const arma::mat& transformation,
         }
       }
 
+      UpdateTreeTransformation(transformation);
+
       // Re-calculate impostors on transformed dataset.
       constraint.Impostors(impostors, distance,
           transformedDataset, labels, norm, points, numPoints);
     }
     else
     {
+      UpdateTreeTransformation(transformation);
+
       // Re-calculate impostors on transformed dataset.
       constraint.Impostors(impostors, distance, transformedDataset, labels,
           norm);
@@ -507,6 +522,8 @@ void LMNNFunction<MetricType>::Gradient(const arma::mat& transformation,
   }
   else if (iteration++ % range == 0)
   {
+      UpdateTreeTransformation(transformation);
+
       // Re-calculate impostors on transformed dataset.
       constraint.Impostors(impostors, distance, transformedDataset, labels,
           norm);
@@ -517,8 +534,9 @@ void LMNNFunction<MetricType>::Gradient(const arma::mat& transformation,
   // Calculate gradient due to target neighbors.
   arma::mat cij = pCij;
 
-  // Calculate gradient due to impostors.
-  arma::mat cil = arma::zeros(dataset.n_rows, dataset.n_rows);
+  // Count the triplets that contribute to the gradient due to impostors.
+  arma::mat targetWeights(k, dataset.n_cols, arma::fill::zeros);
+  arma::mat impostorWeights(k, dataset.n_cols, arma::fill::zeros);
 
   for (size_t i = 0; i < dataset.n_cols; i++)
   {
@@ -579,16 +597,19 @@ void LMNNFunction<MetricType>::Gradient(const arma::mat& transformation,
           maxImpNorm(l, i) = 0;
         }
 
-        // Caculate gradient due to impostors.
-        arma::vec diff = dataset.col(i) - dataset.col(targetNeighbors(j, i));
-        cil += diff * arma::trans(diff);
-
-        diff = dataset.col(i) - dataset.col(impostors(l, i));
-        cil -= diff * arma::trans(diff);
+        // Count the triplet for the gradient due to impostors.
+        ++targetWeights(j, i);
+        ++impostorWeights(l, i);
       }
     }
   }
 
+  // Calculate gradient due to impostors.
+  arma::mat cil, impostorOuter;
+  OuterProducts(targetNeighbors, targetWeights, 0, cil);
+  OuterProducts(impostors, impostorWeights, 0, impostorOuter);
+  cil -= impostorOuter;
+
   gradient = 2 * transformation * ((1 - regularization) * cij +
       regularization * cil);
 
@@ -633,12 +654,16 @@ void LMNNFunction<MetricType>::Gradient(const arma::mat& transformation,
       }
     }
 
+    UpdateTreeTransformation(transformation);
+
     // Re-calculate impostors on transformed dataset.
     constraint.Impostors(impostors, distance,
         transformedDataset, labels, norm, points, numPoints);
   }
   else if (iteration++ % range == 0)
   {
+    UpdateTreeTransformation(transformation);
+
     // Re-calculate impostors on transformed dataset.
     constraint.Impostors(impostors, distance, transformedDataset, labels,
         norm, begin, batchSize);
@@ -646,18 +671,16 @@ void LMNNFunction<MetricType>::Gradient(const arma::mat& transformation,
 
   gradient.zeros(transformation.n_rows, transformation.n_cols);
 
-  arma::mat cij = arma::zeros(dataset.n_rows, dataset.n_rows);
-  arma::mat cil = arma::zeros(dataset.n_rows, dataset.n_rows);
+  // Calculate gradient due to target neighbors.
+  arma::mat cij;
+  OuterProducts(targetNeighbors, arma::ones(k, batchSize), begin, cij);
+
+  // Count the triplets that contribute to the gradient due to impostors.
+  arma::mat targetWeights(k, batchSize, arma::fill::zeros);
+  arma::mat impostorWeights(k, batchSize, arma::fill::zeros);
 
   for (size_t i = begin; i < begin + batchSize; i++)
   {
-    for (size_t j = 0; j < k ; j++)
-    {
-      // Calculate gradient due to target neighbors.
-      arma::vec diff = dataset.col(i) - dataset.col(targetNeighbors(j, i));
-      cij += diff * arma::trans(diff);
-    }
-
     for (int j = k - 1; j >= 0; j--)
     {
       // Bound constraints to avoid uneccesary computation.
@@ -717,16 +740,19 @@ void LMNNFunction<MetricType>::Gradient(const arma::mat& transformation,
           lastTransformationIndices(i) = 0;
         }
 
-        // Caculate gradient due to impostors.
-        arma::vec diff = dataset.col(i) - dataset.col(targetNeighbors(j, i));
-        cil += diff * arma::trans(diff);
-
-        diff = dataset.col(i) - dataset.col(impostors(l, i));
-        cil -= diff * arma::trans(diff);
+        // Count the triplet for the gradient due to impostors.
+        ++targetWeights(j, i - begin);
+        ++impostorWeights(l, i - begin);
       }
     }
   }
 
+  // Calculate gradient due to impostors.
+  arma::mat cil, impostorOuter;
+  OuterProducts(targetNeighbors, targetWeights, begin, cil);
+  OuterProducts(impostors, impostorWeights, begin, impostorOuter);
+  cil -= impostorOuter;
+
   gradient = 2 * transformation * ((1 - regularization) * cij +
       regularization * cil);
 
@@ -769,12 +795,16 @@ double LMNNFunction<MetricType>::EvaluateWithGradient(
         }
       }
 
+      UpdateTreeTransformation(transformation);
+
       // Re-calculate impostors on transformed dataset.
       constraint.Impostors(impostors, distance,
           transformedDataset, labels, norm, points, numPoints);
     }
     else
     {
+      UpdateTreeTransformation(transformation);
+
       // Re-calculate impostors on transformed dataset.
       constraint.Impostors(impostors, distance, transformedDataset, labels,
           norm);
@@ -782,6 +812,8 @@ double LMNNFunction<MetricType>::EvaluateWithGradient(
   }
   else if (iteration++ % range == 0)
   {
+      UpdateTreeTransformation(transformation);
+
       // Re-calculate impostors on transformed dataset.
       constraint.Impostors(impostors, distance, transformedDataset, labels,
           norm);
@@ -792,8 +824,9 @@ double LMNNFunction<MetricType>::EvaluateWithGradient(
   // Calculate gradient due to target neighbors.
   arma::mat cij = pCij;
 
-  // Calculate gradient due to impostors.
-  arma::mat cil = arma::zeros(dataset.n_rows, dataset.n_rows);
+  // Count the triplets that contribute to the gradient due to impostors.
+  arma::mat targetWeights(k, dataset.n_cols, arma::fill::zeros);
+  arma::mat impostorWeights(k, dataset.n_cols, arma::fill::zeros);
 
   for (size_t i = 0; i < dataset.n_cols; i++)
   {
@@ -856,16 +889,19 @@ double LMNNFunction<MetricType>::EvaluateWithGradient(
 
         cost += regularization * (1 + eval);
 
-        // Caculate gradient due to impostors.
-        arma::vec diff = dataset.col(i) - dataset.col(targetNeighbors(j, i));
-        cil += diff * arma::trans(diff);
-
-        diff = dataset.col(i) - dataset.col(impostors(l, i));
-        cil -= diff * arma::trans(diff);
+        // Count the triplet for the gradient due to impostors.
+        ++targetWeights(j, i);
+        ++impostorWeights(l, i);
       }
     }
   }
 
+  // Calculate gradient due to impostors.
+  arma::mat cil, impostorOuter;
+  OuterProducts(targetNeighbors, targetWeights, 0, cil);
+  OuterProducts(impostors, impostorWeights, 0, impostorOuter);
+  cil -= impostorOuter;
+
   gradient = 2 * transformation * ((1 - regularization) * cij +
       regularization * cil);
 
@@ -915,12 +951,16 @@ double LMNNFunction<MetricType>::EvaluateWithGradient(
       }
     }
 
+    UpdateTreeTransformation(transformation);
+
     // Re-calculate impostors on transformed dataset.
     constraint.Impostors(impostors, distance,
         transformedDataset, labels, norm, points, numPoints);
   }
   else if (iteration++ % range == 0)
   {
+    UpdateTreeTransformation(transformation);
+
     // Re-calculate impostors on transformed dataset.
     constraint.Impostors(impostors, distance, transformedDataset, labels,
         norm, begin, batchSize);
@@ -928,8 +968,13 @@ double LMNNFunction<MetricType>::EvaluateWithGradient(
 
   gradient.zeros(transformation.n_rows, transformation.n_cols);
 
-  arma::mat cij = arma::zeros(dataset.n_rows, dataset.n_rows);
-  arma::mat cil = arma::zeros(dataset.n_rows, dataset.n_rows);
+  // Calculate gradient due to target neighbors.
+  arma::mat cij;
+  OuterProducts(targetNeighbors, arma::ones(k, batchSize), begin, cij);
+
+  // Count the triplets that contribute to the gradient due to impostors.
+  arma::mat targetWeights(k, batchSize, arma::fill::zeros);
+  arma::mat impostorWeights(k, batchSize, arma::fill::zeros);
 
   for (size_t i = begin; i < begin + batchSize; i++)
   {
@@ -939,10 +984,6 @@ double LMNNFunction<MetricType>::EvaluateWithGradient(
       double eval = metric.Evaluate(transformedDataset.col(i),
                         transformedDataset.col(targetNeighbors(j, i)));
       cost += (1 - regularization) * eval;
-
-      // Calculate gradient due to target neighbors.
-      arma::vec diff = dataset.col(i) - dataset.col(targetNeighbors(j, i));
-      cij += diff * arma::trans(diff);
     }
 
     for (int j = k - 1; j >= 0; j--)
@@ -996,16 +1037,19 @@ double LMNNFunction<MetricType>::EvaluateWithGradient(
 
         cost += regularization * (1 + eval);
 
-        // Caculate gradient due to impostors.
-        arma::vec diff = dataset.col(i) - dataset.col(targetNeighbors(j, i));
-        cil += diff * arma::trans(diff);
-
-        diff = dataset.col(i) - dataset.col(impostors(l, i));
-        cil -= diff * arma::trans(diff);
+        // Count the triplet for the gradient due to impostors.
+        ++targetWeights(j, i - begin);
+        ++impostorWeights(l, i - begin);
       }
     }
   }
 
+  // Calculate gradient due to impostors.
+  arma::mat cil, impostorOuter;
+  OuterProducts(targetNeighbors, targetWeights, begin, cil);
+  OuterProducts(impostors, impostorWeights, begin, impostorOuter);
+  cil -= impostorOuter;
+
   gradient = 2 * transformation * ((1 - regularization) * cij +
       regularization * cil);
 
@@ -1018,16 +1062,78 @@ double LMNNFunction<MetricType>::EvaluateWithGradient(
 template<typename MetricType>
 inline void LMNNFunction<MetricType>::Precalculate()
 {
-  pCij.zeros(dataset.n_rows, dataset.n_rows);
+  // Calculate gradient due to target neighbors.
+  OuterProducts(targetNeighbors, arma::ones(k, dataset.n_cols), 0, pCij);
+}
 
-  for (size_t i = 0; i < dataset.n_cols; i++)
+template<typename MetricType>
+inline void LMNNFunction<MetricType>::OuterProducts(
+    const arma::Mat<size_t>& neighbors,
+    const arma::mat& weights,
+    const size_t begin,
+    arma::mat& outer) const
+{
+  outer.zeros(dataset.n_rows, dataset.n_rows);
+
+  // Each thread sums the outer products of blocks of points into its own
+  // matrix, with one matrix product per block.  The weights are counts, so
+  // their square roots can be applied to both sides of the product.
+  const size_t blockSize = 256;
+  const size_t numBlocks = (weights.n_cols + blockSize - 1) / blockSize;
+  #pragma omp parallel
   {
-    for (size_t j = 0; j < k ; j++)
+    arma::mat localOuter(dataset.n_rows, dataset.n_rows, arma::fill::zeros);
+    arma::mat diffs(dataset.n_rows, blockSize * weights.n_rows);
+
+    #pragma omp for schedule(static)
+    for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
     {
-      // Calculate gradient due to target neighbors.
-      arma::vec diff = dataset.col(i) - dataset.col(targetNeighbors(j, i));
-      pCij += diff * arma::trans(diff);
+      const size_t first = b * blockSize;
+      const size_t last = std::min((size_t) weights.n_cols, first + blockSize);
+
+      size_t numDiffs = 0;
+      for (size_t i = first; i < last; ++i)
+      {
+        for (size_t j = 0; j < weights.n_rows; ++j)
+        {
+          if (weights(j, i) == 0.0)
+            continue;
+
+          diffs.col(numDiffs++) = std::sqrt(weights(j, i)) *
+              (dataset.col(begin + i) - dataset.col(neighbors(j, begin + i)));
+        }
+      }
+
+      if (numDiffs > 0)
+      {
+        const arma::mat blockDiffs(diffs.memptr(), diffs.n_rows, numDiffs,
+            false, true);
+        localOuter += blockDiffs * blockDiffs.t();
+      }
     }
+
+    #pragma omp critical
+    outer += localOuter;
+  }
+}
+
+template<typename MetricType>
+inline void LMNNFunction<MetricType>::UpdateTreeTransformation(
+    const arma::mat& transformation)
+{
+  // Refit trees give exact results, but they get slower to search as the
+  // points move relative to each other, so the trees are only refit while the
+  // transformation is within a tenth of the one they were built with.
+  if (!treeTransformation.is_empty() &&
+      arma::norm(transformation - treeTransformation) <=
+      0.1 * arma::norm(treeTransformation))
+  {
+    constraint.RefitTrees() = true;
+  }
+  else
+  {
+    constraint.RefitTrees() = false;
+    treeTransformation = transformation;
   }
 }
 
@@ -34,32 +34,36 @@ void LocalCoordinateCoding::Encode(const arma::mat& data, arma::mat& codes)
       data.n_cols) + repmat(sum(square(data)), atoms, 1) - 2 * trans(dictionary)
       * data);
 
-  arma::mat dictGram = trans(dictionary) * dictionary;
-  arma::mat dictGramTD(dictGram.n_rows, dictGram.n_cols);
+  const arma::mat dictGram = trans(dictionary) * dictionary;
 
+  // The points are independent, so they are encoded in parallel.  Each thread
+  // keeps its own weighted dictionary and Gram matrix, which are refilled for
+  // each of its points; the unweighted Gram matrix is shared.
   codes.set_size(atoms, data.n_cols);
-  for (size_t i = 0; i < data.n_cols; i++)
+  #pragma omp parallel
   {
-    // Report progress.
-    if ((i % 100) == 0)
+    arma::mat dictPrime, dictGramTD;
+
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; i++)
     {
-      Log::Debug << "Optimization at point " << i << "." << std::endl;
+      // Weight the dictionary atoms by the inverse squared distance to the
+      // point; this is dictionary * diagmat(invW) and
+      // diagmat(invW) * dictGram * diagmat(invW).
+      const arma::vec invW = invSqDists.unsafe_col(i);
+      dictPrime = dictionary.each_row() % invW.t();
+      dictGramTD = dictGram % (invW * invW.t());
+
+      bool useCholesky = false;
+      regression::LARS lars(useCholesky, dictGramTD, 0.5 * lambda);
+
+      // Run LARS for this point, by making an alias of the point and passing
+      // that.
+      arma::vec beta = codes.unsafe_col(i);
+      arma::rowvec responses = data.unsafe_col(i).t();
+      lars.Train(dictPrime, responses, beta, false);
+      beta %= invW; // Remember, beta is an alias of codes.col(i).
     }
-
-    arma::vec invW = invSqDists.unsafe_col(i);
-    arma::mat dictPrime = dictionary * diagmat(invW);
-
-    arma::mat dictGramTD = diagmat(invW) * dictGram * diagmat(invW);
-
-    bool useCholesky = false;
-    regression::LARS lars(useCholesky, dictGramTD, 0.5 * lambda);
-
-    // Run LARS for this point, by making an alias of the point and passing
-    // that.
-    arma::vec beta = codes.unsafe_col(i);
-    arma::rowvec responses = data.unsafe_col(i).t();
-    lars.Train(dictPrime, responses, beta, false);
-    beta %= invW; // Remember, beta is an alias of codes.col(i).
   }
 }
 
@@ -16,6 +16,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <ensmallen.hpp>
+#include <mlpack/core/cv/warm_start.hpp>
 
 #include "logistic_regression_function.hpp"
 
@@ -243,6 +244,35 @@ class LogisticRegression
 };
 
 } // namespace regression
+
+namespace cv {
+
+/**
+ * The objective of LogisticRegression is convex, and Train() starts from the
+ * current parameters, so it can be warm-started (for instance along a path of
+ * values of lambda).
+ */
+template<typename MatType>
+class WarmStart<regression::LogisticRegression<MatType>>
+{
+ public:
+  static const bool IsSupported = true;
+
+  static bool Train(regression::LogisticRegression<MatType>& model,
+                    const MatType& xs,
+                    const arma::Row<size_t>& ys,
+                    const double lambda = 0.0)
+  {
+    if (model.Parameters().n_elem != xs.n_rows + 1)
+      return false;
+
+    model.Lambda() = lambda;
+    model.Train(xs, ys);
+    return true;
+  }
+};
+
+} // namespace cv
 } // namespace mlpack
 
 // Include implementation.
@@ -23,6 +23,13 @@ namespace regression {
  * The log-likelihood function for the logistic regression objective function.
  * This is used by various mlpack optimizers to train a logistic regression
  * model.
+ *
+ * The predictors may be sparse (arma::sp_mat).  The separable Gradient() and
+ * EvaluateWithGradient() may then also be called with an arma::sp_mat
+ * gradient (for instance by an optimizer whose gradient type is arma::sp_mat),
+ * in which case only the intercept and the features that are nonzero in the
+ * batch are computed, in time proportional to the nonzero elements of the
+ * batch; the regularization is then only applied to those features.
  */
 template<typename MatType = arma::mat>
 class LogisticRegressionFunction
@@ -124,7 +131,8 @@ class LogisticRegressionFunction
    * @param parameters Vector of logistic regression parameters.
    * @param begin Index of the starting point to use for objective function
    *     gradient evaluation.
-   * @param gradient Vector to output gradient into.
+   * @param gradient Vector to output gradient into; if it is an arma::sp_mat,
+   *     only the features that are nonzero in the batch are computed.
    * @param batchSize Number of points to be processed as a batch for objective
    *     function gradient evaluation.
    */
@@ -160,7 +168,9 @@ class LogisticRegressionFunction
   /**
    * Evaluate the objective function and gradient of the logistic regression
    * log-likelihood function simultaneously with the given parameters, for
-   * the given batch size from a given point in the dataset.
+   * the given batch size from a given point in the dataset.  As with the
+   * separable Gradient(), an arma::sp_mat gradient only holds the features that
+   * are nonzero in the batch.
    */
   template<typename GradType>
   double EvaluateWithGradient(const arma::mat& parameters,
@@ -188,6 +198,25 @@ class LogisticRegressionFunction
   arma::Row<size_t> responses;
   //! The regularization parameter for L2-regularization.
   double lambda;
+
+  /**
+   * Compute the gradient for a batch, given the differences between the
+   * sigmoids and the responses of its points.
+   */
+  template<typename GradType>
+  void BatchGradient(const arma::mat& parameters,
+                     const arma::rowvec& diffs,
+                     const size_t begin,
+                     GradType& gradient) const;
+
+  /**
+   * Compute the gradient for a batch as a sparse matrix that only holds the
+   * intercept and the features that are nonzero in the batch.
+   */
+  void BatchGradient(const arma::mat& parameters,
+                     const arma::rowvec& diffs,
+                     const size_t begin,
+                     arma::sp_mat& gradient) const;
 };
 
 } // namespace regression
@@ -18,6 +18,39 @@
 namespace mlpack {
 namespace regression {
 
+//! Collect the (feature, value) gradient terms of the points of a batch of
+//! sparse predictors; only the nonzero elements contribute.
+template<typename MatType>
+void CollectGradientTerms(
+    const MatType& predictors,
+    const arma::rowvec& diffs,
+    const size_t begin,
+    std::vector<std::pair<size_t, double>>& terms,
+    const typename std::enable_if_t<arma::is_SpMat<MatType>::value>* = 0)
+{
+  for (size_t i = 0; i < diffs.n_elem; ++i)
+  {
+    typename MatType::const_iterator it = predictors.begin_col(begin + i);
+    for (; it != predictors.end_col(begin + i); ++it)
+      terms.push_back(std::make_pair((size_t) it.row(), diffs[i] * (*it)));
+  }
+}
+
+//! Collect the (feature, value) gradient terms of the points of a batch of
+//! dense predictors; every feature contributes.
+template<typename MatType>
+void CollectGradientTerms(
+    const MatType& predictors,
+    const arma::rowvec& diffs,
+    const size_t begin,
+    std::vector<std::pair<size_t, double>>& terms,
+    const typename std::enable_if_t<!arma::is_SpMat<MatType>::value>* = 0)
+{
+  for (size_t i = 0; i < diffs.n_elem; ++i)
+    for (size_t j = 0; j < predictors.n_rows; ++j)
+      terms.push_back(std::make_pair(j, diffs[i] * predictors(j, begin + i)));
+}
+
 template<typename MatType>
 LogisticRegressionFunction<MatType>::LogisticRegressionFunction(
     const MatType& predictors,
@@ -180,23 +213,14 @@ void LogisticRegressionFunction<MatType>::Gradient(
                 GradType& gradient,
                 const size_t batchSize) const
 {
-  // Regularization term.
-  arma::mat regularization;
-  regularization = lambda * parameters.tail_cols(parameters.n_elem - 1)
-      / predictors.n_cols * batchSize;
-
   const arma::rowvec exponents = parameters(0, 0) +
       parameters.tail_cols(parameters.n_elem - 1) *
       predictors.cols(begin, begin + batchSize - 1);
   // Calculating the sigmoid function values.
   const arma::rowvec sigmoids = 1.0 / (1.0 + arma::exp(-exponents));
 
-  gradient.set_size(parameters.n_rows, parameters.n_cols);
-  gradient[0] = -arma::accu(responses.subvec(begin, begin + batchSize - 1) -
-      sigmoids);
-  gradient.tail_cols(parameters.n_elem - 1) = (sigmoids -
-      responses.subvec(begin, begin + batchSize - 1)) *
-      predictors.cols(begin, begin + batchSize - 1).t() + regularization;
+  BatchGradient(parameters, sigmoids - arma::conv_to<arma::rowvec>::from(
+      responses.subvec(begin, begin + batchSize - 1)), begin, gradient);
 }
 
 /**
@@ -265,11 +289,6 @@ double LogisticRegressionFunction<MatType>::EvaluateWithGradient(
     GradType& gradient,
     const size_t batchSize) const
 {
-  // Regularization term.
-  arma::mat regularization =
-      lambda * parameters.tail_cols(parameters.n_elem - 1) / predictors.n_cols *
-      batchSize;
-
   const double objectiveRegularization = lambda *
       (batchSize / (2.0 * predictors.n_cols)) *
       arma::dot(parameters.tail_cols(parameters.n_elem - 1),
@@ -280,16 +299,11 @@ double LogisticRegressionFunction<MatType>::EvaluateWithGradient(
       parameters.tail_cols(parameters.n_elem - 1) *
       predictors.cols(begin, begin + batchSize - 1))));
 
-  gradient.set_size(parameters.n_rows, parameters.n_cols);
-  gradient[0] = -arma::accu(responses.subvec(begin, begin + batchSize - 1) -
-      sigmoids);
-  gradient.tail_cols(parameters.n_elem - 1) = (sigmoids -
-      responses.subvec(begin, begin + batchSize - 1)) *
-      predictors.cols(begin, begin + batchSize - 1).t() + regularization;
-
-  // Now compute the objective function using the sigmoids.
+  // Now compute the gradient and the objective function using the sigmoids.
   arma::rowvec respD = arma::conv_to<arma::rowvec>::from(responses.subvec(begin,
       begin + batchSize - 1));
+  BatchGradient(parameters, sigmoids - respD, begin, gradient);
+
   const double result = arma::accu(arma::log(1.0 - respD + sigmoids %
       (2 * respD - 1.0)));
 
@@ -297,6 +311,66 @@ double LogisticRegressionFunction<MatType>::EvaluateWithGradient(
   return objectiveRegularization - result;
 }
 
+template<typename MatType>
+template<typename GradType>
+void LogisticRegressionFunction<MatType>::BatchGradient(
+    const arma::mat& parameters,
+    const arma::rowvec& diffs,
+    const size_t begin,
+    GradType& gradient) const
+{
+  const size_t batchSize = diffs.n_elem;
+
+  // Regularization term.
+  arma::mat regularization;
+  regularization = lambda * parameters.tail_cols(parameters.n_elem - 1)
+      / predictors.n_cols * batchSize;
+
+  gradient.set_size(parameters.n_rows, parameters.n_cols);
+  gradient[0] = arma::accu(diffs);
+  gradient.tail_cols(parameters.n_elem - 1) = diffs *
+      predictors.cols(begin, begin + batchSize - 1).t() + regularization;
+}
+
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::BatchGradient(
+    const arma::mat& parameters,
+    const arma::rowvec& diffs,
+    const size_t begin,
+    arma::sp_mat& gradient) const
+{
+  const size_t batchSize = diffs.n_elem;
+  const double regularization = lambda * batchSize / predictors.n_cols;
+
+  // Collect the contribution of every nonzero element of the batch, and sum
+  // the contributions to each feature.
+  std::vector<std::pair<size_t, double>> terms;
+  CollectGradientTerms(predictors, diffs, begin, terms);
+  std::sort(terms.begin(), terms.end());
+
+  std::vector<arma::uword> columns;
+  std::vector<double> values;
+  columns.push_back(0);
+  values.push_back(arma::accu(diffs));
+  for (size_t i = 0; i < terms.size(); ++i)
+  {
+    if (i == 0 || terms[i].first != terms[i - 1].first)
+    {
+      // The intercept is parameter 0, so feature j is parameter j + 1.
+      columns.push_back(terms[i].first + 1);
+      values.push_back(regularization * parameters[terms[i].first + 1]);
+    }
+    values.back() += terms[i].second;
+  }
+
+  arma::umat locations(2, columns.size(), arma::fill::zeros);
+  for (size_t i = 0; i < columns.size(); ++i)
+    locations(1, i) = columns[i];
+
+  gradient = arma::sp_mat(locations, arma::vec(values), parameters.n_rows,
+      parameters.n_cols);
+}
+
 } // namespace regression
 } // namespace mlpack
 
@@ -83,8 +83,9 @@ class LSHSearch
    *     large prime number.
    * @param bucketSize The size of the bucket in the second hash table. This is
    *     the maximum number of points that can be hashed into single bucket.  A
-   *     value of 0 indicates that there is no limit (so the second hash table
-   *     can be arbitrarily large---be careful!).
+   *     value of 0 indicates that there is no limit; since the buckets are
+   *     stored contiguously, the second hash table then holds exactly one
+   *     entry for each point in each table.
    */
   LSHSearch(arma::mat referenceSet,
             const arma::cube& projections,
@@ -111,8 +112,9 @@ class LSHSearch
    *     large prime number.
    * @param bucketSize The size of the bucket in the second hash table. This is
    *     the maximum number of points that can be hashed into single bucket.  A
-   *     value of 0 indicates that there is no limit (so the second hash table
-   *     can be arbitrarily large---be careful!).
+   *     value of 0 indicates that there is no limit; since the buckets are
+   *     stored contiguously, the second hash table then holds exactly one
+   *     entry for each point in each table.
    */
   LSHSearch(arma::mat referenceSet,
             const size_t numProj,
@@ -174,8 +176,9 @@ class LSHSearch
    *     large prime number.
    * @param bucketSize The size of the bucket in the second hash table. This is
    *     the maximum number of points that can be hashed into single bucket.  A
-   *     value of 0 indicates that there is no limit (so the second hash table
-   *     can be arbitrarily large---be careful!).
+   *     value of 0 indicates that there is no limit; since the buckets are
+   *     stored contiguously, the second hash table then holds exactly one
+   *     entry for each point in each table.
    * @param projections Cube of projection tables. For a cube of size (a, b, c)
    *     we set numProj = a, numTables = c. b is the reference set
    *     dimensionality.
@@ -188,6 +191,31 @@ class LSHSearch
              const size_t bucketSize = 500,
              const arma::cube& projection = arma::cube());
 
+  /**
+   * Insert the given points into the model, without rebuilding it: the points
+   * are appended to the reference set, hashed with the existing projections,
+   * and added to the buckets of the second hash table.  The points get the
+   * indices n to (n + points.n_cols - 1), where n is the number of reference
+   * points before the call.  As in Train(), points that would overflow a
+   * bucket are not stored.
+   *
+   * The second hash table is stored contiguously, so each call copies it once;
+   * inserting many points in one call is much faster than inserting them one
+   * by one.
+   *
+   * @param points Points to insert.
+   */
+  void Insert(const arma::mat& points);
+
+  /**
+   * Remove the points with the given indices from the hash tables, so that they
+   * are not returned as neighbors anymore.  The points stay in the reference
+   * set, so the indices of the other points don't change.
+   *
+   * @param indices Indices of the points to remove.
+   */
+  void Remove(const arma::uvec& indices);
+
   /**
    * Compute the nearest neighbors of the points in the given query set and
    * store the output in the given matrices.  The matrices will be set to the
@@ -280,9 +308,13 @@ class LSHSearch
   //! Get the bucket size of the second hash.
   size_t BucketSize() const { return bucketSize; }
 
-  //! Get the second hash table.
-  const std::vector<arma::Col<size_t>>& SecondHashTable() const
-      { return secondHashTable; }
+  //! Get the offsets of the rows of the second hash table: the points in row
+  //! i are BucketContents()[BucketOffsets()[i]] to
+  //! BucketContents()[BucketOffsets()[i + 1] - 1].
+  const arma::Col<size_t>& BucketOffsets() const { return bucketOffsets; }
+
+  //! Get the points in all of the rows of the second hash table.
+  const arma::Col<size_t>& BucketContents() const { return bucketContents; }
 
   //! Get the projection tables.
   const arma::cube& Projections() { return projections; }
@@ -297,24 +329,63 @@ class LSHSearch
 
  private:
   /**
-   * This function takes a query and hashes it into each of the hash tables to
-   * get keys for the query and then the key is hashed to a bucket of the second
-   * hash table and all the points (if any) in those buckets are collected as
-   * the potential neighbor candidates.
+   * Hash the given points into the second hash table in each table, using the
+   * existing projections, offsets, and second hash weights.
+   *
+   * @param points Points to hash.
+   * @param secondHashVectors Set to the bucket of each point (column) in each
+   *    table (row).
+   */
+  void HashReferencePoints(const arma::mat& points,
+                           arma::Mat<size_t>& secondHashVectors) const;
+
+  //! The number of queries that are hashed together by Search().
+  static const size_t QueryBatchSize = 1024;
+
+  /**
+   * Get the number of tables to search, given the number requested by the
+   * user (0 means all tables).
+   */
+  size_t EffectiveNumTables(const size_t numTablesToSearch) const;
+
+  /**
+   * This function hashes a batch of queries into each of the hash tables to
+   * get keys for the queries, and then hashes the keys to buckets of the
+   * second hash table.  The projections of all queries in a table are computed
+   * with one matrix multiplication.  If T > 0, the keys of the T additional
+   * probing bins of each query are hashed too.
+   *
+   * @param querySet The batch of queries to hash.
+   * @param numTablesToSearch The number of tables to hash the queries in.
+   * @param T The number of additional probing bins for multiprobe LSH.
+   * @param hashCodes Set to the codes of the queries in the second hash table.
+   *    Column q holds the (T + 1) x numTablesToSearch codes of query q in
+   *    column-major order; the primary code in each table comes first.
+   */
+  template<typename MatType>
+  void ComputeHashCodes(const MatType& querySet,
+                        const size_t numTablesToSearch,
+                        const size_t T,
+                        arma::Mat<size_t>& hashCodes) const;
+
+  /**
+   * This function takes the codes of a query computed by ComputeHashCodes()
+   * and collects all the points (if any) in the corresponding buckets of the
+   * second hash table as the potential neighbor candidates.
    *
-   * @param queryPoint The query point currently being processed.
+   * @param hashCodes The codes of a batch of queries.
+   * @param queryIndex The index of the query in the batch.
    * @param referenceIndices The list of neighbor candidates obtained from
    *    hashing the query into all the hash tables and eventually into
    *    multiple buckets of the second hash table.
-   * @param numTablesToSearch The number of tables to perform the search in. If
-   *    0, all tables are searched.
+   * @param numTablesToSearch The number of tables the codes were computed for.
    * @param T The number of additional probing bins for multiprobe LSH. If 0,
    *    single-probe is used.
    */
-  template<typename VecType>
-  void ReturnIndicesFromTable(const VecType& queryPoint,
+  void ReturnIndicesFromTable(const arma::Mat<size_t>& hashCodes,
+                              const size_t queryIndex,
                               arma::uvec& referenceIndices,
-                              size_t numTablesToSearch,
+                              const size_t numTablesToSearch,
                               const size_t T) const;
 
   /**
@@ -359,7 +430,7 @@ class LSHSearch
 
   /**
    * This function implements the core idea behind Multiprobe LSH. It is called
-   * by ReturnIndicesFromTables when T > 0. Given a query's code and its
+   * by ComputeHashCodes() when T > 0. Given a query's code and its
    * projection location, GetAdditionalProbingBins will calculate the T most
    * likely alternative bin codes (other than queryCode) where a query's
    * neighbors might be found in.
@@ -440,15 +511,15 @@ class LSHSearch
   //! The bucket size of the second hash.
   size_t bucketSize;
 
-  //! The final hash table; should be (< secondHashSize) vectors each with
-  //! (<= bucketSize) elements.
-  std::vector<arma::Col<size_t>> secondHashTable;
+  //! The offsets of the rows of the final hash table in bucketContents; there
+  //! are (< secondHashSize) rows, each with (<= bucketSize) elements, and one
+  //! extra offset that marks the end of the last row.
+  arma::Col<size_t> bucketOffsets;
 
-  //! The number of elements present in each hash bucket; should be
-  //! secondHashSize.
-  arma::Col<size_t> bucketContentSize;
+  //! The points in each row of the final hash table, stored contiguously.
+  arma::Col<size_t> bucketContents;
 
-  //! For a particular hash value, points to the row in secondHashTable
+  //! For a particular hash value, points to the row of the second hash table
   //! corresponding to this value. Length secondHashSize.
   arma::Col<size_t> bucketRowInHashTable;
 
@@ -476,7 +547,7 @@ class LSHSearch
 
 //! Set the serialization version of the LSHSearch class.
 BOOST_TEMPLATE_CLASS_VERSION(template<typename SortPolicy>,
-    mlpack::neighbor::LSHSearch<SortPolicy>, 1);
+    mlpack::neighbor::LSHSearch<SortPolicy>, 2);
 
 // Include implementation.
 #include "lsh_search_impl.hpp"
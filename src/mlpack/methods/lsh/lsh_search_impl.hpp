@@ -83,8 +83,8 @@ LSHSearch<SortPolicy>::LSHSearch(const LSHSearch& other) :
     secondHashSize(other.secondHashSize),
     secondHashWeights(other.secondHashWeights),
     bucketSize(other.bucketSize),
-    secondHashTable(other.secondHashTable),
-    bucketContentSize(other.bucketContentSize),
+    bucketOffsets(other.bucketOffsets),
+    bucketContents(other.bucketContents),
     bucketRowInHashTable(other.bucketRowInHashTable),
     distanceEvaluations(other.distanceEvaluations)
 {
@@ -103,8 +103,8 @@ LSHSearch<SortPolicy>::LSHSearch(LSHSearch&& other) :
     secondHashSize(other.secondHashSize),
     secondHashWeights(std::move(other.secondHashWeights)),
     bucketSize(other.bucketSize),
-    secondHashTable(std::move(other.secondHashTable)),
-    bucketContentSize(std::move(other.bucketContentSize)),
+    bucketOffsets(std::move(other.bucketOffsets)),
+    bucketContents(std::move(other.bucketContents)),
     bucketRowInHashTable(std::move(other.bucketRowInHashTable)),
     distanceEvaluations(other.distanceEvaluations)
 {
@@ -130,8 +130,8 @@ LSHSearch<SortPolicy>& LSHSearch<SortPolicy>::operator=(const LSHSearch& other)
   secondHashSize = other.secondHashSize;
   secondHashWeights = other.secondHashWeights;
   bucketSize = other.bucketSize;
-  secondHashTable = other.secondHashTable;
-  bucketContentSize = other.bucketContentSize;
+  bucketOffsets = other.bucketOffsets;
+  bucketContents = other.bucketContents;
   bucketRowInHashTable = other.bucketRowInHashTable;
   distanceEvaluations = other.distanceEvaluations;
 
@@ -151,8 +151,8 @@ LSHSearch<SortPolicy>& LSHSearch<SortPolicy>::operator=(LSHSearch&& other)
   secondHashSize = other.secondHashSize;
   secondHashWeights = std::move(other.secondHashWeights);
   bucketSize = other.bucketSize;
-  secondHashTable = std::move(other.secondHashTable);
-  bucketContentSize = std::move(other.bucketContentSize);
+  bucketOffsets = std::move(other.bucketOffsets);
+  bucketContents = std::move(other.bucketContents);
   bucketRowInHashTable = std::move(other.bucketRowInHashTable);
   distanceEvaluations = other.distanceEvaluations;
 
@@ -251,10 +251,77 @@ void LSHSearch<SortPolicy>::Train(arma::mat referenceSet,
         "tables provided must be equal to numProj");
   }
 
-  // We will store the second hash vectors in this matrix; the second hash
-  // vector for table i will be held in row i.  We have to use int and not
-  // size_t, otherwise negative numbers are cast to 0.
-  arma::Mat<size_t> secondHashVectors(numTables, this->referenceSet.n_cols);
+  // Hash every point into the second hash table in every table.
+  arma::Mat<size_t> secondHashVectors;
+  HashReferencePoints(this->referenceSet, secondHashVectors);
+
+  // The second hash table is stored in compressed (CSR) form, and built in two
+  // passes.  First, count the number of points in each bucket.
+  arma::Row<size_t> secondHashBinCounts(secondHashSize, arma::fill::zeros);
+  for (size_t i = 0; i < secondHashVectors.n_elem; ++i)
+    secondHashBinCounts[secondHashVectors[i]]++;
+
+  // Enforce the maximum bucket size.
+  const size_t effectiveBucketSize = (bucketSize == 0) ? SIZE_MAX : bucketSize;
+  const size_t totalPoints = arma::accu(secondHashBinCounts);
+  secondHashBinCounts.transform([effectiveBucketSize](size_t val)
+      { return std::min(val, effectiveBucketSize); });
+  const size_t storedPoints = arma::accu(secondHashBinCounts);
+  if (storedPoints < totalPoints)
+  {
+    Log::Warn << "LSHSearch::Train(): " << (totalPoints - storedPoints)
+        << " points were not stored because their buckets were full; use a "
+        << "bucket size of 0 to store all points." << std::endl;
+  }
+
+  // Assign a row to each non-empty bucket, in the order that the buckets are
+  // first seen, and compute the offset of each row.
+  const size_t numRowsInTable = arma::accu(secondHashBinCounts > 0);
+  bucketOffsets.set_size(numRowsInTable + 1);
+  bucketOffsets[0] = 0;
+  size_t currentRow = 0;
+  for (size_t i = 0; i < numTables; ++i)
+  {
+    for (size_t j = 0; j < secondHashVectors.n_cols; ++j)
+    {
+      const size_t hashInd = (size_t) secondHashVectors(i, j);
+      if (bucketRowInHashTable[hashInd] == secondHashSize)
+      {
+        bucketRowInHashTable[hashInd] = currentRow;
+        bucketOffsets[currentRow + 1] = bucketOffsets[currentRow] +
+            secondHashBinCounts[hashInd];
+        currentRow++;
+      }
+    }
+  }
+
+  // Second pass: put each point into its bucket.  The points are visited in
+  // order, so the indices in each bucket are sorted, and scanning a bucket
+  // visits the reference set in increasing order.
+  bucketContents.set_size(storedPoints);
+  arma::Col<size_t> next(bucketOffsets.head(numRowsInTable));
+  for (size_t i = 0; i < numTables; ++i)
+  {
+    for (size_t j = 0; j < secondHashVectors.n_cols; ++j)
+    {
+      const size_t row = bucketRowInHashTable[secondHashVectors(i, j)];
+      if (next[row] < bucketOffsets[row + 1])
+        bucketContents[next[row]++] = j;
+    }
+  }
+
+  Log::Info << "Final hash table size: " << numRowsInTable << " rows, with a "
+            << "maximum length of " << arma::max(secondHashBinCounts) << ", "
+            << "totaling " << storedPoints << " elements." << std::endl;
+}
+
+template<typename SortPolicy>
+void LSHSearch<SortPolicy>::HashReferencePoints(
+    const arma::mat& points,
+    arma::Mat<size_t>& secondHashVectors) const
+{
+  // The second hash vector for table i will be held in row i.
+  secondHashVectors.set_size(numTables, points.n_cols);
 
   for (size_t i = 0; i < numTables; i++)
   {
@@ -263,15 +330,15 @@ void LSHSearch<SortPolicy>::Train(arma::mat referenceSet,
 
     // The following code performs the task of hashing each point to a
     // 'numProj'-dimensional integer key.  Hence you get a ('numProj' x
-    // 'referenceSet.n_cols') key matrix.
+    // 'points.n_cols') key matrix.
     //
     // For a single table, let the 'numProj' projections be denoted by 'proj_i'
     // and the corresponding offset be 'offset_i'.  Then the key of a single
     // point is obtained as:
     // key = { floor((<proj_i, point> + offset_i) / 'hashWidth') forall i }
     arma::mat offsetMat = arma::repmat(offsets.unsafe_col(i), 1,
-                                       this->referenceSet.n_cols);
-    arma::mat hashMat = projections.slice(i).t() * (this->referenceSet);
+                                       points.n_cols);
+    arma::mat hashMat = projections.slice(i).t() * points;
     hashMat += offsetMat;
     hashMat /= hashWidth;
 
@@ -295,56 +362,146 @@ void LSHSearch<SortPolicy>::Train(arma::mat referenceSet,
       }
     }
   }
+}
 
-  // Now, using the hash vectors for each table, count the number of rows we
-  // have in the second hash table.
-  arma::Row<size_t> secondHashBinCounts(secondHashSize, arma::fill::zeros);
-  for (size_t i = 0; i < secondHashVectors.n_elem; ++i)
-    secondHashBinCounts[secondHashVectors[i]]++;
+// Insert new points into the hash tables.
+template<typename SortPolicy>
+void LSHSearch<SortPolicy>::Insert(const arma::mat& points)
+{
+  if (bucketOffsets.n_elem == 0)
+  {
+    throw std::invalid_argument("LSHSearch::Insert(): the model must be "
+        "trained before points can be inserted!");
+  }
+
+  if (points.n_rows != referenceSet.n_rows)
+  {
+    std::ostringstream oss;
+    oss << "LSHSearch::Insert(): dimensionality of points (" << points.n_rows
+        << ") is not equal to the dimensionality the model was trained on ("
+        << referenceSet.n_rows << ")!" << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (points.n_cols == 0)
+    return;
+
+  const size_t first = referenceSet.n_cols;
+  referenceSet.insert_cols(first, points);
+
+  // Hash the new points with the existing projections.
+  arma::Mat<size_t> secondHashVectors;
+  HashReferencePoints(points, secondHashVectors);
+
+  // Compute the new size of each row, assigning new rows to buckets that were
+  // empty.  The entries of secondHashVectors are replaced by the row each
+  // point goes into, or SIZE_MAX if the row is full.
+  const size_t oldNumRows = bucketOffsets.n_elem - 1;
+  std::vector<size_t> rowSizes(oldNumRows);
+  for (size_t r = 0; r < oldNumRows; ++r)
+    rowSizes[r] = bucketOffsets[r + 1] - bucketOffsets[r];
 
-  // Enforce the maximum bucket size.
   const size_t effectiveBucketSize = (bucketSize == 0) ? SIZE_MAX : bucketSize;
-  secondHashBinCounts.transform([effectiveBucketSize](size_t val)
-      { return std::min(val, effectiveBucketSize); });
+  size_t droppedPoints = 0;
+  for (size_t i = 0; i < secondHashVectors.n_elem; ++i)
+  {
+    size_t& row = bucketRowInHashTable[secondHashVectors[i]];
+    if (row == secondHashSize)
+    {
+      row = rowSizes.size();
+      rowSizes.push_back(0);
+    }
 
-  const size_t numRowsInTable = arma::accu(secondHashBinCounts > 0);
-  bucketContentSize.zeros(numRowsInTable);
-  secondHashTable.resize(numRowsInTable);
+    if (rowSizes[row] < effectiveBucketSize)
+    {
+      ++rowSizes[row];
+      secondHashVectors[i] = row;
+    }
+    else
+    {
+      secondHashVectors[i] = SIZE_MAX;
+      ++droppedPoints;
+    }
+  }
+
+  if (droppedPoints > 0)
+  {
+    Log::Warn << "LSHSearch::Insert(): " << droppedPoints << " points were not "
+        << "stored because their buckets were full." << std::endl;
+  }
+
+  // Move the existing rows to their new offsets, then append the new points to
+  // their rows.  The new points have larger indices than all existing points,
+  // so the indices in each row stay sorted.
+  arma::Col<size_t> newOffsets(rowSizes.size() + 1);
+  newOffsets[0] = 0;
+  for (size_t r = 0; r < rowSizes.size(); ++r)
+    newOffsets[r + 1] = newOffsets[r] + rowSizes[r];
+
+  arma::Col<size_t> newContents(newOffsets[rowSizes.size()]);
+  arma::Col<size_t> next(newOffsets.head(rowSizes.size()));
+  for (size_t r = 0; r < oldNumRows; ++r)
+  {
+    for (size_t j = bucketOffsets[r]; j < bucketOffsets[r + 1]; ++j)
+      newContents[next[r]++] = bucketContents[j];
+  }
 
-  // Next we must assign each point in each table to the right second hash
-  // table.
-  size_t currentRow = 0;
   for (size_t i = 0; i < numTables; ++i)
   {
-    // Insert the point in the corresponding row to its bucket in the
-    // 'secondHashTable'.
-    for (size_t j = 0; j < secondHashVectors.n_cols; j++)
+    for (size_t j = 0; j < secondHashVectors.n_cols; ++j)
     {
-      // This is the bucket number.
-      size_t hashInd = (size_t) secondHashVectors(i, j);
-      // The point ID is 'j'.
+      const size_t row = secondHashVectors(i, j);
+      if (row != SIZE_MAX)
+        newContents[next[row]++] = first + j;
+    }
+  }
 
-      // If this is currently an empty bucket, start a new row keep track of
-      // which row corresponds to the bucket.
-      const size_t maxSize = secondHashBinCounts[hashInd];
-      if (bucketRowInHashTable[hashInd] == secondHashSize)
-      {
-        bucketRowInHashTable[hashInd] = currentRow;
-        secondHashTable[currentRow].set_size(maxSize);
-        currentRow++;
-      }
+  bucketOffsets = std::move(newOffsets);
+  bucketContents = std::move(newContents);
+}
 
-      // If this vector in the hash table is not full, add the point.
-      const size_t index = bucketRowInHashTable[hashInd];
-      if (bucketContentSize[index] < maxSize)
-        secondHashTable[index](bucketContentSize[index]++) = j;
-    } // Loop over all points in the reference set.
-  } // Loop over tables.
+// Remove points from the hash tables.
+template<typename SortPolicy>
+void LSHSearch<SortPolicy>::Remove(const arma::uvec& indices)
+{
+  std::vector<bool> removed(referenceSet.n_cols, false);
+  for (size_t i = 0; i < indices.n_elem; ++i)
+  {
+    if (indices[i] >= referenceSet.n_cols)
+    {
+      std::ostringstream oss;
+      oss << "LSHSearch::Remove(): index " << indices[i] << " is out of "
+          << "bounds; the reference set has " << referenceSet.n_cols
+          << " points!" << std::endl;
+      throw std::invalid_argument(oss.str());
+    }
 
-  Log::Info << "Final hash table size: " << numRowsInTable << " rows, with a "
-            << "maximum length of " << arma::max(secondHashBinCounts) << ", "
-            << "totaling " << arma::accu(secondHashBinCounts) << " elements."
-            << std::endl;
+    removed[indices[i]] = true;
+  }
+
+  if (bucketOffsets.n_elem == 0)
+    return;
+
+  // Compact the rows in place.  Rows that become empty are kept, so that the
+  // mapping from buckets to rows doesn't change.
+  const size_t numRows = bucketOffsets.n_elem - 1;
+  size_t position = 0;
+  size_t rowStart = bucketOffsets[0];
+  for (size_t r = 0; r < numRows; ++r)
+  {
+    const size_t rowEnd = bucketOffsets[r + 1];
+    bucketOffsets[r] = position;
+    for (size_t j = rowStart; j < rowEnd; ++j)
+    {
+      if (!removed[bucketContents[j]])
+        bucketContents[position++] = bucketContents[j];
+    }
+
+    rowStart = rowEnd;
+  }
+
+  bucketOffsets[numRows] = position;
+  bucketContents.resize(position);
 }
 
 // Base case where the query set is the reference set.  (So, we can't return
@@ -697,70 +854,86 @@ void LSHSearch<SortPolicy>::GetAdditionalProbingBins(
 }
 
 template<typename SortPolicy>
-template<typename VecType>
-void LSHSearch<SortPolicy>::ReturnIndicesFromTable(
-    const VecType& queryPoint,
-    arma::uvec& referenceIndices,
-    size_t numTablesToSearch,
-    const size_t T) const
+size_t LSHSearch<SortPolicy>::EffectiveNumTables(
+    const size_t numTablesToSearch) const
 {
-  // Decide on the number of tables to look into.
-  if (numTablesToSearch == 0) // If no user input is given, search all.
-    numTablesToSearch = numTables;
+  // If no user input is given, search all tables, and make sure that the
+  // existing number of tables is not exceeded.
+  if (numTablesToSearch == 0 || numTablesToSearch > numTables)
+    return numTables;
 
-  // Sanity check to make sure that the existing number of tables is not
-  // exceeded.
-  if (numTablesToSearch > numTables)
-    numTablesToSearch = numTables;
+  return numTablesToSearch;
+}
 
-  // Hash the query in each of the 'numTablesToSearch' hash tables using the
+template<typename SortPolicy>
+template<typename MatType>
+void LSHSearch<SortPolicy>::ComputeHashCodes(
+    const MatType& querySet,
+    const size_t numTablesToSearch,
+    const size_t T,
+    arma::Mat<size_t>& hashCodes) const
+{
+  // Hash the queries in each of the 'numTablesToSearch' hash tables using the
   // 'numProj' projections for each table. This gives us 'numTablesToSearch'
-  // keys for the query where each key is a 'numProj' dimensional integer
-  // vector.
-
-  // Compute the projection of the query in each table.
-  arma::mat allProjInTables(numProj, numTablesToSearch);
-  arma::mat queryCodesNotFloored(numProj, numTablesToSearch);
-  for (size_t i = 0; i < numTablesToSearch; i++)
-    queryCodesNotFloored.unsafe_col(i) = projections.slice(i).t() * queryPoint;
-
-  queryCodesNotFloored += offsets.cols(0, numTablesToSearch - 1);
-  allProjInTables = arma::floor(queryCodesNotFloored / hashWidth);
-
-  // Use hashMat to store the primary probing codes and any additional codes
-  // from multiprobe LSH.
-  arma::Mat<size_t> hashMat;
-  hashMat.set_size(T + 1, numTablesToSearch);
-
-  // Compute the primary hash value of each key of the query into a bucket of
-  // the secondHashTable using the secondHashWeights.
-  hashMat.row(0) = arma::conv_to<arma::Row<size_t>> // Floor by typecasting
-      ::from(secondHashWeights.t() * allProjInTables);
-  // Mod to compute 2nd-level codes.
-  for (size_t i = 0; i < numTablesToSearch; i++)
-    hashMat(0, i) = (hashMat(0, i) % secondHashSize);
-
-  // Compute hash codes of additional probing bins.
-  if (T > 0)
+  // keys for each query where each key is a 'numProj' dimensional integer
+  // vector.  Each column of hashCodes holds the (T + 1) x numTablesToSearch
+  // codes of one query, in column-major order.
+  hashCodes.set_size((T + 1) * numTablesToSearch, querySet.n_cols);
+
+  for (size_t i = 0; i < numTablesToSearch; ++i)
   {
-    for (size_t i = 0; i < numTablesToSearch; ++i)
+    // Compute the projections of all queries in this table at once.
+    arma::mat queryCodesNotFloored = projections.slice(i).t() * querySet;
+    queryCodesNotFloored.each_col() += offsets.unsafe_col(i);
+    const arma::mat allProjInTable = arma::floor(queryCodesNotFloored /
+        hashWidth);
+
+    // Compute the primary hash value of each key into a bucket of the second
+    // hash table using the secondHashWeights.
+    const arma::Row<size_t> primaryCodes =
+        arma::conv_to<arma::Row<size_t>>::from( // Floor by typecasting.
+        secondHashWeights.t() * allProjInTable);
+    for (size_t q = 0; q < querySet.n_cols; ++q)
+      hashCodes(i * (T + 1), q) = primaryCodes[q] % secondHashSize;
+
+    // Compute hash codes of additional probing bins.  Each query has its own
+    // probing sequence, so this part can't be batched, but the queries are
+    // independent.
+    if (T > 0)
     {
-      // Construct this table's probing sequence of length T.
-      arma::mat additionalProbingBins;
-      GetAdditionalProbingBins(allProjInTables.unsafe_col(i),
-                                queryCodesNotFloored.unsafe_col(i),
-                                T,
-                                additionalProbingBins);
-
-      // Map each probing bin to a bin in secondHashTable (just like we did for
-      // the primary hash table).
-      hashMat(arma::span(1, T), i) = // Compute code of rows 1:end of column i
-        arma::conv_to< arma::Col<size_t> >:: // floor by typecasting to size_t
-        from(secondHashWeights.t() * additionalProbingBins);
-      for (size_t p = 1; p < T + 1; ++p)
-        hashMat(p, i) = (hashMat(p, i) % secondHashSize);
+      #pragma omp parallel for schedule(dynamic)
+      for (omp_size_t q = 0; q < (omp_size_t) querySet.n_cols; ++q)
+      {
+        // Construct this query's probing sequence of length T.
+        arma::mat additionalProbingBins;
+        GetAdditionalProbingBins(allProjInTable.unsafe_col(q),
+                                 queryCodesNotFloored.unsafe_col(q),
+                                 T,
+                                 additionalProbingBins);
+
+        // Map each probing bin to a bin in the second hash table (just like we
+        // did for the primary hash table).
+        const arma::Row<size_t> probingCodes =
+            arma::conv_to<arma::Row<size_t>>::from( // Floor by typecasting.
+            secondHashWeights.t() * additionalProbingBins);
+        for (size_t p = 1; p < T + 1; ++p)
+          hashCodes(i * (T + 1) + p, q) = probingCodes[p - 1] % secondHashSize;
+      }
     }
   }
+}
+
+template<typename SortPolicy>
+void LSHSearch<SortPolicy>::ReturnIndicesFromTable(
+    const arma::Mat<size_t>& hashCodes,
+    const size_t queryIndex,
+    arma::uvec& referenceIndices,
+    const size_t numTablesToSearch,
+    const size_t T) const
+{
+  // View the codes of this query as a (T + 1) x numTablesToSearch matrix.
+  const arma::Mat<size_t> hashMat(const_cast<size_t*>(
+      hashCodes.colptr(queryIndex)), T + 1, numTablesToSearch, false, true);
 
   // Count number of points hashed in the same bucket as the query.
   size_t maxNumPoints = 0;
@@ -770,8 +943,8 @@ void LSHSearch<SortPolicy>::ReturnIndicesFromTable(
     {
       const size_t hashInd = hashMat(p, i); // find query's bucket
       const size_t tableRow = bucketRowInHashTable[hashInd];
-      if (tableRow < secondHashSize)
-        maxNumPoints += bucketContentSize[tableRow]; // count bucket contents
+      if (tableRow < secondHashSize) // count bucket contents
+        maxNumPoints += bucketOffsets[tableRow + 1] - bucketOffsets[tableRow];
     }
   }
 
@@ -802,11 +975,12 @@ void LSHSearch<SortPolicy>::ReturnIndicesFromTable(
         size_t hashInd = hashMat(p, i);
         size_t tableRow = bucketRowInHashTable[hashInd];
 
-        if (tableRow < secondHashSize && bucketContentSize[tableRow] > 0)
+        if (tableRow < secondHashSize)
         {
           // Pick the indices in the bucket corresponding to hashInd.
-          for (size_t j = 0; j < bucketContentSize[tableRow]; ++j)
-            refPointsConsidered[ secondHashTable[tableRow](j) ]++;
+          for (size_t j = bucketOffsets[tableRow];
+               j < bucketOffsets[tableRow + 1]; ++j)
+            refPointsConsidered[bucketContents[j]]++;
         }
       }
     }
@@ -836,8 +1010,9 @@ void LSHSearch<SortPolicy>::ReturnIndicesFromTable(
         if (tableRow < secondHashSize)
         {
           // Store all secondHashTable points in the candidates set.
-          for (size_t j = 0; j < bucketContentSize[tableRow]; ++j)
-            refPointsConsideredSmall(start++) = secondHashTable[tableRow](j);
+          for (size_t j = bucketOffsets[tableRow];
+               j < bucketOffsets[tableRow + 1]; ++j)
+            refPointsConsideredSmall(start++) = bucketContents[j];
        }
       }
     }
@@ -900,33 +1075,43 @@ void LSHSearch<SortPolicy>::Search(const arma::mat& querySet,
     Log::Info << "Running multiprobe LSH with " << Teffective
         <<" additional probing bins per table per query." << std::endl;
 
+  const size_t tablesToSearch = EffectiveNumTables(numTablesToSearch);
   size_t avgIndicesReturned = 0;
 
   Timer::Start("computing_neighbors");
 
-  // Parallelization to process more than one query at a time.
-  #pragma omp parallel for \
-      shared(resultingNeighbors, distances) \
-      schedule(dynamic)\
-      reduction(+:avgIndicesReturned)
-  for (omp_size_t i = 0; i < (omp_size_t) querySet.n_cols; ++i)
+  // Process the queries in batches, so that all queries of a batch are hashed
+  // with one matrix multiplication per table, without having to store the
+  // codes of all queries at once.
+  arma::Mat<size_t> hashCodes;
+  for (size_t begin = 0; begin < querySet.n_cols; begin += QueryBatchSize)
   {
-    // Go through every query point.
-    // Hash every query into every hash table and eventually into the
-    // 'secondHashTable' to obtain the neighbor candidates.
-    arma::uvec refIndices;
-    ReturnIndicesFromTable(querySet.col(i), refIndices, numTablesToSearch,
-        Teffective);
-
-    // An informative book-keeping for the number of neighbor candidates
-    // returned on average.
-    // Make atomic to avoid race conditions when multiple threads are running
-    // #pragma omp atomic
-    avgIndicesReturned = avgIndicesReturned + refIndices.n_elem;
-
-    // Sequentially go through all the candidates and save the best 'k'
-    // candidates.
-    BaseCase(i, refIndices, k, querySet, resultingNeighbors, distances);
+    const size_t end = std::min(begin + QueryBatchSize,
+        (size_t) querySet.n_cols);
+    ComputeHashCodes(querySet.cols(begin, end - 1), tablesToSearch, Teffective,
+        hashCodes);
+
+    // Parallelization to process more than one query at a time.
+    #pragma omp parallel for \
+        shared(resultingNeighbors, distances, hashCodes) \
+        schedule(dynamic)\
+        reduction(+:avgIndicesReturned)
+    for (omp_size_t i = begin; i < (omp_size_t) end; ++i)
+    {
+      // Go through every query point, and look up the buckets of the second
+      // hash table that it was hashed into to obtain the neighbor candidates.
+      arma::uvec refIndices;
+      ReturnIndicesFromTable(hashCodes, i - begin, refIndices, tablesToSearch,
+          Teffective);
+
+      // An informative book-keeping for the number of neighbor candidates
+      // returned on average.
+      avgIndicesReturned = avgIndicesReturned + refIndices.n_elem;
+
+      // Sequentially go through all the candidates and save the best 'k'
+      // candidates.
+      BaseCase(i, refIndices, k, querySet, resultingNeighbors, distances);
+    }
   }
 
   Timer::Stop("computing_neighbors");
@@ -966,33 +1151,41 @@ Search(const size_t k,
     Log::Info << "Running multiprobe LSH with " << Teffective <<
       " additional probing bins per table per query."<< std::endl;
 
+  const size_t tablesToSearch = EffectiveNumTables(numTablesToSearch);
   size_t avgIndicesReturned = 0;
 
   Timer::Start("computing_neighbors");
 
-  // Parallelization to process more than one query at a time.
-  #pragma omp parallel for \
-      shared(resultingNeighbors, distances) \
-      schedule(dynamic)\
-      reduction(+:avgIndicesReturned)
-  for (omp_size_t i = 0; i < (omp_size_t) referenceSet.n_cols; ++i)
+  // Process the queries in batches, as in bichromatic search.
+  arma::Mat<size_t> hashCodes;
+  for (size_t begin = 0; begin < referenceSet.n_cols; begin += QueryBatchSize)
   {
-    // Go through every query point.
-    // Hash every query into every hash table and eventually into the
-    // 'secondHashTable' to obtain the neighbor candidates.
-    arma::uvec refIndices;
-    ReturnIndicesFromTable(referenceSet.col(i), refIndices, numTablesToSearch,
-        Teffective);
-
-    // An informative book-keeping for the number of neighbor candidates
-    // returned on average.
-    // Make atomic to avoid race conditions when multiple threads are running.
-    // #pragma omp atomic
-    avgIndicesReturned += refIndices.n_elem;
-
-    // Sequentially go through all the candidates and save the best 'k'
-    // candidates.
-    BaseCase(i, refIndices, k, resultingNeighbors, distances);
+    const size_t end = std::min(begin + QueryBatchSize,
+        (size_t) referenceSet.n_cols);
+    ComputeHashCodes(referenceSet.cols(begin, end - 1), tablesToSearch,
+        Teffective, hashCodes);
+
+    // Parallelization to process more than one query at a time.
+    #pragma omp parallel for \
+        shared(resultingNeighbors, distances, hashCodes) \
+        schedule(dynamic)\
+        reduction(+:avgIndicesReturned)
+    for (omp_size_t i = begin; i < (omp_size_t) end; ++i)
+    {
+      // Go through every query point, and look up the buckets of the second
+      // hash table that it was hashed into to obtain the neighbor candidates.
+      arma::uvec refIndices;
+      ReturnIndicesFromTable(hashCodes, i - begin, refIndices, tablesToSearch,
+          Teffective);
+
+      // An informative book-keeping for the number of neighbor candidates
+      // returned on average.
+      avgIndicesReturned += refIndices.n_elem;
+
+      // Sequentially go through all the candidates and save the best 'k'
+      // candidates.
+      BaseCase(i, refIndices, k, resultingNeighbors, distances);
+    }
   }
 
   Timer::Stop("computing_neighbors");
@@ -1064,76 +1257,80 @@ void LSHSearch<SortPolicy>::serialize(Archive& ar,
   ar & BOOST_SERIALIZATION_NVP(secondHashSize);
   ar & BOOST_SERIALIZATION_NVP(secondHashWeights);
   ar & BOOST_SERIALIZATION_NVP(bucketSize);
-  // needs specific handling for new version
 
-  // Backward compatibility: in older versions of LSHSearch, the secondHashTable
-  // was stored as an arma::Mat<size_t>.  So we need to properly load that, then
-  // prune it down to size.
-  if (version == 0)
+  // Current versions store the second hash table in compressed (CSR) form.
+  if (version >= 2)
   {
-    arma::Mat<size_t> tmpSecondHashTable;
-    ar & BOOST_SERIALIZATION_NVP(tmpSecondHashTable);
-
-    // The old secondHashTable was stored in row-major format, so we transpose
-    // it.
-    tmpSecondHashTable = tmpSecondHashTable.t();
-
-    secondHashTable.resize(tmpSecondHashTable.n_cols);
-    for (size_t i = 0; i < tmpSecondHashTable.n_cols; ++i)
-    {
-      // Find length of each column.  We know we are at the end of the list when
-      // the value referenceSet.n_cols is seen.
-
-      size_t len = 0;
-      for (; len < tmpSecondHashTable.n_rows; ++len)
-        if (tmpSecondHashTable(len, i) == referenceSet.n_cols)
-          break;
-
-      // Set the size of the new column correctly.
-      secondHashTable[i].set_size(len);
-      for (size_t j = 0; j < len; ++j)
-        secondHashTable[i](j) = tmpSecondHashTable(j, i);
-    }
+    ar & BOOST_SERIALIZATION_NVP(bucketOffsets);
+    ar & BOOST_SERIALIZATION_NVP(bucketContents);
+    ar & BOOST_SERIALIZATION_NVP(bucketRowInHashTable);
   }
   else
   {
-    size_t tables;
-    if (Archive::is_saving::value)
-      tables = secondHashTable.size();
-    ar & BOOST_SERIALIZATION_NVP(tables);
+    // Backward compatibility: older versions held one vector for each row of
+    // the second hash table, and the number of points in each row.  Version 0
+    // held those in uncompressed matrices.
+    std::vector<arma::Col<size_t>> secondHashTable;
+    arma::Col<size_t> bucketContentSize;
+    if (version == 0)
+    {
+      arma::Mat<size_t> tmpSecondHashTable;
+      ar & BOOST_SERIALIZATION_NVP(tmpSecondHashTable);
 
-    // Set size of second hash table if needed.
-    if (Archive::is_loading::value)
+      // The old secondHashTable was stored in row-major format, so we
+      // transpose it.
+      tmpSecondHashTable = tmpSecondHashTable.t();
+
+      secondHashTable.resize(tmpSecondHashTable.n_cols);
+      for (size_t i = 0; i < tmpSecondHashTable.n_cols; ++i)
+      {
+        // Find length of each column.  We know we are at the end of the list
+        // when the value referenceSet.n_cols is seen.
+
+        size_t len = 0;
+        for (; len < tmpSecondHashTable.n_rows; ++len)
+          if (tmpSecondHashTable(len, i) == referenceSet.n_cols)
+            break;
+
+        // Set the size of the new column correctly.
+        secondHashTable[i].set_size(len);
+        for (size_t j = 0; j < len; ++j)
+          secondHashTable[i](j) = tmpSecondHashTable(j, i);
+      }
+
+      // The vector was stored in the old uncompressed form.  So we need to
+      // shrink it.  But we can't do that until we have bucketRowInHashTable,
+      // so we also have to load that.
+      arma::Col<size_t> tmpBucketContentSize;
+      ar & BOOST_SERIALIZATION_NVP(tmpBucketContentSize);
+      ar & BOOST_SERIALIZATION_NVP(bucketRowInHashTable);
+
+      // Compress into a smaller vector by just dropping all of the zeros.
+      bucketContentSize.zeros(secondHashTable.size());
+      for (size_t i = 0; i < tmpBucketContentSize.n_elem; ++i)
+        if (tmpBucketContentSize[i] > 0)
+          bucketContentSize[bucketRowInHashTable[i]] = tmpBucketContentSize[i];
+    }
+    else
     {
-      secondHashTable.clear();
+      size_t tables;
+      ar & BOOST_SERIALIZATION_NVP(tables);
       secondHashTable.resize(tables);
+      ar & BOOST_SERIALIZATION_NVP(secondHashTable);
+      ar & BOOST_SERIALIZATION_NVP(bucketContentSize);
+      ar & BOOST_SERIALIZATION_NVP(bucketRowInHashTable);
     }
 
-    ar & BOOST_SERIALIZATION_NVP(secondHashTable);
-  }
-
-  // Backward compatibility: old versions of LSHSearch held bucketContentSize
-  // for all possible buckets (of size secondHashSize), but now we hold a
-  // compressed representation.
-  if (version == 0)
-  {
-    // The vector was stored in the old uncompressed form.  So we need to shrink
-    // it.  But we can't do that until we have bucketRowInHashTable, so we also
-    // have to load that.
-    arma::Col<size_t> tmpBucketContentSize;
-    ar & BOOST_SERIALIZATION_NVP(tmpBucketContentSize);
-    ar & BOOST_SERIALIZATION_NVP(bucketRowInHashTable);
+    // Convert to the compressed form.
+    bucketOffsets.set_size(secondHashTable.size() + 1);
+    bucketOffsets[0] = 0;
+    for (size_t i = 0; i < secondHashTable.size(); ++i)
+      bucketOffsets[i + 1] = bucketOffsets[i] + bucketContentSize[i];
 
-    // Compress into a smaller vector by just dropping all of the zeros.
-    bucketContentSize.set_size(secondHashTable.size());
-    for (size_t i = 0; i < tmpBucketContentSize.n_elem; ++i)
-      if (tmpBucketContentSize[i] > 0)
-        bucketContentSize[bucketRowInHashTable[i]] = tmpBucketContentSize[i];
-  }
-  else
-  {
-    ar & BOOST_SERIALIZATION_NVP(bucketContentSize);
-    ar & BOOST_SERIALIZATION_NVP(bucketRowInHashTable);
+    bucketContents.set_size(bucketOffsets[secondHashTable.size()]);
+    for (size_t i = 0; i < secondHashTable.size(); ++i)
+      for (size_t j = 0; j < bucketContentSize[i]; ++j)
+        bucketContents[bucketOffsets[i] + j] = secondHashTable[i][j];
   }
 
   ar & BOOST_SERIALIZATION_NVP(distanceEvaluations);
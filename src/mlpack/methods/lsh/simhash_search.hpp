@@ -0,0 +1,282 @@
+/**
+ * @file simhash_search.hpp
+ *
+ * Defines the SimHashSearch class, which performs approximate maximum cosine
+ * similarity (or maximum inner product) search with sign random projections
+ * (SimHash), with the codes of the points packed into 64-bit words.
+ *
+ * The hash family was presented in the following paper:
+ *
+ * @inproceedings{charikar2002similarity,
+ *  title={Similarity estimation techniques from rounding algorithms},
+ *  author={Charikar, Moses S.},
+ *  booktitle={Proceedings of the 34th Annual ACM Symposium on Theory of
+ *      Computing},
+ *  pages={380--388},
+ *  year={2002},
+ *  organization={ACM}
+ * }
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_LSH_SIMHASH_SEARCH_HPP
+#define MLPACK_METHODS_LSH_SIMHASH_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/kernels/cosine_distance.hpp>
+
+#include <cstdint>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * Return the number of bits that differ between the given codes of the given
+ * number of 64-bit words.
+ */
+inline size_t HammingDistance(const uint64_t* a,
+                              const uint64_t* b,
+                              const size_t words)
+{
+  size_t distance = 0;
+  for (size_t i = 0; i < words; ++i)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    distance += __builtin_popcountll(a[i] ^ b[i]);
+#else
+    uint64_t x = a[i] ^ b[i];
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    distance += (x * 0x0101010101010101ULL) >> 56;
+#endif
+  }
+  return distance;
+}
+
+/**
+ * The SimHashSearch class hashes each point with sign random projections: in
+ * each of numTables tables, bit b of the code of a point is whether it is on
+ * the positive side of the b'th random hyperplane of the table.  The codes of
+ * up to 64 bits of each table are packed into one 64-bit word, so the index
+ * takes numTables words per point, and the points with each code are found by
+ * a binary search in the sorted codes of the table.
+ *
+ * Two points at angle theta get the same bit with probability 1 - theta / pi,
+ * so the neighbor candidates of a query are the points in its bucket in each
+ * table (and, with multiprobe, in the T buckets reached by flipping the bits
+ * whose hyperplanes are closest to the query).  The candidates are ranked by
+ * the Hamming distance between their codes and the code of the query over all
+ * tables, which only takes a few popcounts each, and only the best
+ * numCandidates of them are reranked with the kernel.
+ *
+ * With the default CosineDistance kernel this searches for the points with
+ * the largest cosine similarity; with kernel::LinearKernel it searches for the
+ * largest inner products among the candidates, which is a good approximation
+ * when the norms of the reference points are similar (i.e. for normalized
+ * embeddings).
+ *
+ * @tparam KernelType Kernel to rerank the candidates with.
+ */
+template<typename KernelType = kernel::CosineDistance>
+class SimHashSearch
+{
+ public:
+  /**
+   * Build the hash tables on the given reference set.  In order to avoid
+   * copying the reference set, consider passing it with std::move().
+   *
+   * @param referenceSet Set of reference points.
+   * @param numBits Number of bits (hyperplanes) in each table; between 1 and
+   *     64.
+   * @param numTables Number of hash tables.
+   * @param kernel Kernel to rerank the candidates with.
+   */
+  SimHashSearch(arma::mat referenceSet,
+                const size_t numBits = 16,
+                const size_t numTables = 8,
+                KernelType kernel = KernelType());
+
+  /**
+   * Create an untrained model.  Be sure to call Train() before calling
+   * Search().
+   */
+  SimHashSearch();
+
+  /**
+   * Build the hash tables on the given reference set.  If projections are
+   * given, they are used instead of random ones.
+   *
+   * @param referenceSet Set of reference points.
+   * @param numBits Number of bits (hyperplanes) in each table; between 1 and
+   *     64.
+   * @param numTables Number of hash tables.
+   * @param projections Normals of the hyperplanes: a cube of size
+   *     (dimensionality, numBits, numTables), or an empty cube.
+   */
+  void Train(arma::mat referenceSet,
+             const size_t numBits = 16,
+             const size_t numTables = 8,
+             const arma::cube& projections = arma::cube());
+
+  /**
+   * Search for the k reference points with the largest kernel values for each
+   * point in the query set.  Queries are processed in parallel.  If fewer than
+   * k candidates are found for a query, the remaining indices are SIZE_MAX and
+   * the remaining kernel values are -DBL_MAX.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of results to find for each query point.
+   * @param indices Matrix to store the indices of the results of each query
+   *     point in, with the best first.
+   * @param kernels Matrix to store the kernel values of the results in.
+   * @param T Number of additional buckets to probe in each table
+   *     (multiprobe); 0 only probes the bucket of the query.
+   * @param numCandidates Number of candidates with the smallest Hamming
+   *     distances to rerank with the kernel; 0 reranks all candidates.
+   */
+  void Search(const arma::mat& querySet,
+              const size_t k,
+              arma::Mat<size_t>& indices,
+              arma::mat& kernels,
+              const size_t T = 0,
+              const size_t numCandidates = 0);
+
+  /**
+   * Search for the k other reference points with the largest kernel values
+   * for each point in the reference set.  See the other overload of Search()
+   * for the parameters.
+   */
+  void Search(const size_t k,
+              arma::Mat<size_t>& indices,
+              arma::mat& kernels,
+              const size_t T = 0,
+              const size_t numCandidates = 0);
+
+  //! Get the reference set.
+  const arma::mat& ReferenceSet() const { return referenceSet; }
+  //! Get the number of bits in each table.
+  size_t NumBits() const { return numBits; }
+  //! Get the number of tables.
+  size_t NumTables() const { return numTables; }
+  //! Get the normals of the hyperplanes.
+  const arma::cube& Projections() const { return projections; }
+  //! Get the codes of the reference points; the codes of point i in all
+  //! tables are Codes()[i * NumTables()] to Codes()[(i + 1) * NumTables() - 1].
+  const std::vector<uint64_t>& Codes() const { return codes; }
+
+  //! Get the number of kernel evaluations of the last searches.
+  size_t KernelEvaluations() const { return kernelEvaluations; }
+  //! Modify the number of kernel evaluations.
+  size_t& KernelEvaluations() { return kernelEvaluations; }
+
+  //! Get the kernel.
+  const KernelType& Kernel() const { return kernel; }
+  //! Modify the kernel.
+  KernelType& Kernel() { return kernel; }
+
+  //! Serialize the model.
+  template<typename Archive>
+  void serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  /**
+   * Compute the codes of the given points in every table, and optionally the
+   * distance of each point to every hyperplane (the absolute value of its
+   * projection), for multiprobe.
+   *
+   * @param points Points to hash.
+   * @param pointCodes Set to the numTables codes of each point.
+   * @param margins If not NULL, set to the numBits x numTables margins of
+   *     each point (one column per point).
+   */
+  template<typename MatType>
+  void Hash(const MatType& points,
+            std::vector<uint64_t>& pointCodes,
+            arma::mat* margins) const;
+
+  /**
+   * Get the codes of the T buckets with the smallest total margin of flipped
+   * bits, other than the bucket of the query, for one table.  The flip sets
+   * are enumerated in order of increasing score with shift and expand
+   * operations, as in multiprobe LSH.
+   *
+   * @param code Code of the query.
+   * @param margins Margins of the query to the hyperplanes of the table.
+   * @param T Number of additional buckets.
+   * @param probes The codes of the buckets are appended to this.
+   */
+  void ProbeCodes(const uint64_t code,
+                  const double* margins,
+                  const size_t T,
+                  std::vector<uint64_t>& probes) const;
+
+  /**
+   * Search for the results of one query.
+   *
+   * @param query Query point.
+   * @param queryCodes Codes of the query in all tables.
+   * @param queryMargins Margins of the query (if T > 0).
+   * @param T Number of additional buckets to probe in each table.
+   * @param numCandidates Number of candidates to rerank (0 for all).
+   * @param skipIndex Index of a reference point to skip (for monochromatic
+   *     search), or SIZE_MAX.
+   * @param indices Column to store the indices of the results in.
+   * @param kernels Column to store the kernel values of the results in.
+   * @param k Number of results to find.
+   * @return Number of kernel evaluations.
+   */
+  template<typename VecType>
+  size_t SearchQuery(const VecType& query,
+                     const uint64_t* queryCodes,
+                     const double* queryMargins,
+                     const size_t T,
+                     const size_t numCandidates,
+                     const size_t skipIndex,
+                     size_t* indices,
+                     double* kernels,
+                     const size_t k) const;
+
+  //! Search the given query set in batches (shared by both Search()
+  //! overloads).
+  void SearchBatches(const arma::mat& querySet,
+                     const size_t k,
+                     arma::Mat<size_t>& indices,
+                     arma::mat& kernels,
+                     const size_t T,
+                     const size_t numCandidates,
+                     const bool sameSet);
+
+  //! The number of queries that are hashed together by Search().
+  static const size_t QueryBatchSize = 1024;
+
+  //! The reference set.
+  arma::mat referenceSet;
+  //! The number of bits in each table.
+  size_t numBits;
+  //! The number of tables.
+  size_t numTables;
+  //! The normals of the hyperplanes, (dimensionality x numBits x numTables).
+  arma::cube projections;
+  //! The codes of each reference point in each table (point-major).
+  std::vector<uint64_t> codes;
+  //! The codes of each table, sorted (table-major).
+  std::vector<uint64_t> sortedCodes;
+  //! The reference points in the order of sortedCodes.
+  std::vector<size_t> sortedPoints;
+  //! The kernel.
+  KernelType kernel;
+  //! The number of kernel evaluations.
+  size_t kernelEvaluations;
+};
+
+} // namespace neighbor
+} // namespace mlpack
+
+// Include implementation.
+#include "simhash_search_impl.hpp"
+
+#endif
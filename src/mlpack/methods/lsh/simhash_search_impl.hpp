@@ -0,0 +1,372 @@
+/**
+ * @file simhash_search_impl.hpp
+ *
+ * Implementation of the SimHashSearch class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_LSH_SIMHASH_SEARCH_IMPL_HPP
+#define MLPACK_METHODS_LSH_SIMHASH_SEARCH_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "simhash_search.hpp"
+
+#include <queue>
+
+namespace mlpack {
+namespace neighbor {
+
+template<typename KernelType>
+SimHashSearch<KernelType>::SimHashSearch(arma::mat referenceSet,
+                                         const size_t numBits,
+                                         const size_t numTables,
+                                         KernelType kernel) :
+    numBits(numBits),
+    numTables(numTables),
+    kernel(std::move(kernel)),
+    kernelEvaluations(0)
+{
+  Train(std::move(referenceSet), numBits, numTables);
+}
+
+template<typename KernelType>
+SimHashSearch<KernelType>::SimHashSearch() :
+    numBits(0),
+    numTables(0),
+    kernelEvaluations(0)
+{
+  // Nothing to do.
+}
+
+template<typename KernelType>
+void SimHashSearch<KernelType>::Train(arma::mat referenceSet,
+                                      const size_t numBits,
+                                      const size_t numTables,
+                                      const arma::cube& projections)
+{
+  if (numBits == 0 || numBits > 64)
+    throw std::invalid_argument("SimHashSearch::Train(): the number of bits "
+        "must be between 1 and 64");
+  if (numTables == 0)
+    throw std::invalid_argument("SimHashSearch::Train(): the number of tables "
+        "must be positive");
+
+  if (projections.n_slices == 0)
+  {
+    // The normals of the hyperplanes are uniformly distributed directions.
+    this->projections.randn(referenceSet.n_rows, numBits, numTables);
+  }
+  else if (projections.n_rows == referenceSet.n_rows &&
+           projections.n_cols == numBits && projections.n_slices == numTables)
+  {
+    this->projections = projections;
+  }
+  else
+  {
+    throw std::invalid_argument("SimHashSearch::Train(): the projections must "
+        "have size (dimensionality, numBits, numTables)");
+  }
+
+  this->referenceSet = std::move(referenceSet);
+  this->numBits = numBits;
+  this->numTables = numTables;
+  kernelEvaluations = 0;
+
+  Hash(this->referenceSet, codes, NULL);
+
+  // Sort the codes of each table, so that the points of each bucket are next
+  // to each other and can be found with a binary search.
+  const size_t n = this->referenceSet.n_cols;
+  sortedCodes.resize(numTables * n);
+  sortedPoints.resize(numTables * n);
+  std::vector<std::pair<uint64_t, size_t>> table(n);
+  for (size_t t = 0; t < numTables; ++t)
+  {
+    for (size_t i = 0; i < n; ++i)
+      table[i] = std::make_pair(codes[i * numTables + t], i);
+    std::sort(table.begin(), table.end());
+
+    for (size_t i = 0; i < n; ++i)
+    {
+      sortedCodes[t * n + i] = table[i].first;
+      sortedPoints[t * n + i] = table[i].second;
+    }
+  }
+}
+
+template<typename KernelType>
+void SimHashSearch<KernelType>::Search(const arma::mat& querySet,
+                                       const size_t k,
+                                       arma::Mat<size_t>& indices,
+                                       arma::mat& kernels,
+                                       const size_t T,
+                                       const size_t numCandidates)
+{
+  if (querySet.n_rows != referenceSet.n_rows)
+  {
+    std::ostringstream oss;
+    oss << "SimHashSearch::Search(): dimensionality of query set ("
+        << querySet.n_rows << ") is not equal to the dimensionality the model "
+        << "was trained on (" << referenceSet.n_rows << ")!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  SearchBatches(querySet, k, indices, kernels, T, numCandidates, false);
+}
+
+template<typename KernelType>
+void SimHashSearch<KernelType>::Search(const size_t k,
+                                       arma::Mat<size_t>& indices,
+                                       arma::mat& kernels,
+                                       const size_t T,
+                                       const size_t numCandidates)
+{
+  SearchBatches(referenceSet, k, indices, kernels, T, numCandidates, true);
+}
+
+template<typename KernelType>
+template<typename MatType>
+void SimHashSearch<KernelType>::Hash(const MatType& points,
+                                     std::vector<uint64_t>& pointCodes,
+                                     arma::mat* margins) const
+{
+  pointCodes.assign(points.n_cols * numTables, 0);
+  if (margins)
+    margins->set_size(numBits * numTables, points.n_cols);
+
+  for (size_t t = 0; t < numTables; ++t)
+  {
+    // Project all points onto the normals of the table at once.
+    const arma::mat projected = projections.slice(t).t() * points;
+    for (size_t j = 0; j < points.n_cols; ++j)
+    {
+      uint64_t code = 0;
+      for (size_t b = 0; b < numBits; ++b)
+      {
+        if (projected(b, j) >= 0.0)
+          code |= ((uint64_t) 1) << b;
+      }
+      pointCodes[j * numTables + t] = code;
+
+      if (margins)
+      {
+        for (size_t b = 0; b < numBits; ++b)
+          (*margins)(t * numBits + b, j) = std::abs(projected(b, j));
+      }
+    }
+  }
+}
+
+template<typename KernelType>
+void SimHashSearch<KernelType>::ProbeCodes(const uint64_t code,
+                                           const double* margins,
+                                           const size_t T,
+                                           std::vector<uint64_t>& probes) const
+{
+  // Flipping the bits of the hyperplanes closest to the query is the most
+  // likely way to reach the buckets of its neighbors, so the bits are ordered
+  // by their margins, and flip sets are positions in that order.
+  std::vector<size_t> order(numBits);
+  for (size_t b = 0; b < numBits; ++b)
+    order[b] = b;
+  std::sort(order.begin(), order.end(),
+      [margins](const size_t a, const size_t b)
+      { return margins[a] < margins[b]; });
+
+  // A flip set and its score (the sum of the margins of its bits).
+  typedef std::pair<double, std::vector<size_t>> FlipSet;
+  std::priority_queue<FlipSet, std::vector<FlipSet>, std::greater<FlipSet>>
+      flipSets;
+  flipSets.push(FlipSet(margins[order[0]], std::vector<size_t>(1, 0)));
+
+  // Each non-empty flip set is generated exactly once by shifting its last
+  // position or appending the next one, and never before a set with a smaller
+  // score.
+  for (size_t i = 0; i < T && !flipSets.empty(); ++i)
+  {
+    const FlipSet flipSet = flipSets.top();
+    flipSets.pop();
+
+    uint64_t probe = code;
+    for (size_t p = 0; p < flipSet.second.size(); ++p)
+      probe ^= ((uint64_t) 1) << order[flipSet.second[p]];
+    probes.push_back(probe);
+
+    const size_t last = flipSet.second.back();
+    if (last + 1 < numBits)
+    {
+      FlipSet shifted = flipSet;
+      shifted.second.back() = last + 1;
+      shifted.first += margins[order[last + 1]] - margins[order[last]];
+      flipSets.push(std::move(shifted));
+
+      FlipSet expanded = flipSet;
+      expanded.second.push_back(last + 1);
+      expanded.first += margins[order[last + 1]];
+      flipSets.push(std::move(expanded));
+    }
+  }
+}
+
+template<typename KernelType>
+template<typename VecType>
+size_t SimHashSearch<KernelType>::SearchQuery(const VecType& query,
+                                              const uint64_t* queryCodes,
+                                              const double* queryMargins,
+                                              const size_t T,
+                                              const size_t numCandidates,
+                                              const size_t skipIndex,
+                                              size_t* indices,
+                                              double* kernels,
+                                              const size_t k) const
+{
+  // Collect the points in the buckets of the query in every table.
+  const size_t n = referenceSet.n_cols;
+  std::vector<size_t> candidates;
+  std::vector<uint64_t> probes;
+  for (size_t t = 0; t < numTables; ++t)
+  {
+    probes.assign(1, queryCodes[t]);
+    if (T > 0)
+      ProbeCodes(queryCodes[t], queryMargins + t * numBits, T, probes);
+
+    const uint64_t* begin = sortedCodes.data() + t * n;
+    for (size_t p = 0; p < probes.size(); ++p)
+    {
+      const std::pair<const uint64_t*, const uint64_t*> bucket =
+          std::equal_range(begin, begin + n, probes[p]);
+      for (const uint64_t* it = bucket.first; it != bucket.second; ++it)
+        candidates.push_back(sortedPoints[it - sortedCodes.data()]);
+    }
+  }
+
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()),
+      candidates.end());
+  if (skipIndex != SIZE_MAX)
+  {
+    std::vector<size_t>::iterator it = std::lower_bound(candidates.begin(),
+        candidates.end(), skipIndex);
+    if (it != candidates.end() && *it == skipIndex)
+      candidates.erase(it);
+  }
+
+  // Only keep the candidates with the closest codes over all tables.
+  if (numCandidates > 0 && candidates.size() > numCandidates)
+  {
+    std::vector<std::pair<size_t, size_t>> ranked(candidates.size());
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+      ranked[i] = std::make_pair(HammingDistance(queryCodes,
+          codes.data() + candidates[i] * numTables, numTables), candidates[i]);
+    }
+    std::nth_element(ranked.begin(), ranked.begin() + numCandidates,
+        ranked.end());
+
+    candidates.resize(numCandidates);
+    for (size_t i = 0; i < numCandidates; ++i)
+      candidates[i] = ranked[i].second;
+  }
+
+  // Rerank the candidates with the kernel.
+  std::vector<std::pair<double, size_t>> results(candidates.size());
+  for (size_t i = 0; i < candidates.size(); ++i)
+  {
+    results[i] = std::make_pair(kernel.Evaluate(query,
+        referenceSet.unsafe_col(candidates[i])), candidates[i]);
+  }
+
+  const size_t found = std::min(k, results.size());
+  std::partial_sort(results.begin(), results.begin() + found, results.end(),
+      [](const std::pair<double, size_t>& a, const std::pair<double, size_t>& b)
+      {
+        return (a.first > b.first) ||
+            (a.first == b.first && a.second < b.second);
+      });
+
+  for (size_t i = 0; i < found; ++i)
+  {
+    indices[i] = results[i].second;
+    kernels[i] = results[i].first;
+  }
+  for (size_t i = found; i < k; ++i)
+  {
+    indices[i] = SIZE_MAX;
+    kernels[i] = -DBL_MAX;
+  }
+
+  return results.size();
+}
+
+template<typename KernelType>
+void SimHashSearch<KernelType>::SearchBatches(const arma::mat& querySet,
+                                              const size_t k,
+                                              arma::Mat<size_t>& indices,
+                                              arma::mat& kernels,
+                                              const size_t T,
+                                              const size_t numCandidates,
+                                              const bool sameSet)
+{
+  if (numTables == 0)
+    throw std::invalid_argument("SimHashSearch::Search(): the model has not "
+        "been trained");
+
+  indices.set_size(k, querySet.n_cols);
+  kernels.set_size(k, querySet.n_cols);
+
+  Timer::Start("computing_neighbors");
+
+  // Hash the queries in batches, so that the codes and margins of all queries
+  // don't have to be stored at once.
+  size_t evaluations = 0;
+  std::vector<uint64_t> queryCodes;
+  arma::mat margins;
+  for (size_t begin = 0; begin < querySet.n_cols; begin += QueryBatchSize)
+  {
+    const size_t end = std::min(begin + QueryBatchSize,
+        (size_t) querySet.n_cols);
+    Hash(querySet.cols(begin, end - 1), queryCodes, (T > 0) ? &margins : NULL);
+
+    #pragma omp parallel for schedule(dynamic) reduction(+:evaluations)
+    for (omp_size_t i = begin; i < (omp_size_t) end; ++i)
+    {
+      evaluations += SearchQuery(querySet.unsafe_col(i),
+          queryCodes.data() + (i - begin) * numTables,
+          (T > 0) ? margins.colptr(i - begin) : NULL, T, numCandidates,
+          sameSet ? (size_t) i : SIZE_MAX, indices.colptr(i),
+          kernels.colptr(i), k);
+    }
+  }
+
+  Timer::Stop("computing_neighbors");
+
+  kernelEvaluations += evaluations;
+  Log::Info << evaluations / std::max((size_t) querySet.n_cols, (size_t) 1)
+      << " candidates reranked on average." << std::endl;
+}
+
+template<typename KernelType>
+template<typename Archive>
+void SimHashSearch<KernelType>::serialize(Archive& ar,
+                                          const unsigned int /* version */)
+{
+  ar & BOOST_SERIALIZATION_NVP(referenceSet);
+  ar & BOOST_SERIALIZATION_NVP(numBits);
+  ar & BOOST_SERIALIZATION_NVP(numTables);
+  ar & BOOST_SERIALIZATION_NVP(projections);
+  ar & BOOST_SERIALIZATION_NVP(codes);
+  ar & BOOST_SERIALIZATION_NVP(sortedCodes);
+  ar & BOOST_SERIALIZATION_NVP(sortedPoints);
+  ar & BOOST_SERIALIZATION_NVP(kernel);
+
+  if (Archive::is_loading::value)
+    kernelEvaluations = 0;
+}
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
@@ -78,18 +78,29 @@ class MeanShift
    * Perform mean shift clustering on the data, returning a list of cluster
    * assignments and centroids.
    *
+   * The tree on the data is built once and shared by all range searches.  By
+   * default the seeds are shifted independently of each other, in parallel if
+   * OpenMP is available.  In batch mode, all seeds that have not converged yet
+   * are instead advanced together, with one dual-tree range search per
+   * iteration; this is usually faster when there are many seeds.  Both modes
+   * give the same centroids.
+   *
    * @tparam MatType Type of matrix.
    * @param data Dataset to cluster.
    * @param assignments Vector to store cluster assignments in.
    * @param centroids Matrix in which centroids are stored.
    * @param forceConvergence Flag whether to force each centroid seed to
    * converge regardless of maxIterations.
+   * @param useSeeds Whether to generate seeds from binned points instead of
+   *      starting from every point in the dataset.
+   * @param batch Whether to advance all seeds at once with dual-tree searches.
    */
   void Cluster(const MatType& data,
                arma::Row<size_t>& assignments,
                arma::mat& centroids,
                bool forceConvergence = true,
-               bool useSeeds = true);
+               bool useSeeds = true,
+               bool batch = false);
 
   //! Get the maximum number of iterations.
   size_t MaxIterations() const { return maxIterations; }
@@ -155,6 +166,24 @@ class MeanShift
                     const std::vector<double>&, /*unused*/
                     arma::colvec& centroid);
 
+  /**
+   * Perform one mean shift step on the given centroid, given the points within
+   * the radius of it.  If the centroid moves less than a small fraction of the
+   * radius it has converged, and true is returned; otherwise, the centroid is
+   * moved and false is returned.
+   *
+   * @param data The whole dataset
+   * @param neighbors Valid neighbors
+   * @param distances Distances to neighbors
+   * @param allCentroids Matrix of centroids of every seed
+   * @param index Index of the centroid to move
+   */
+  bool ShiftCentroid(const MatType& data,
+                     const std::vector<size_t>& neighbors,
+                     const std::vector<double>& distances,
+                     arma::mat& allCentroids,
+                     const size_t index);
+
   /**
    * If distance of two centroids is less than radius, one will be removed.
    * Points with distance to current centroid less than radius will be used
@@ -176,6 +176,32 @@ CalculateCentroid(const MatType& data,
   return true;
 }
 
+// Perform one mean shift step of a centroid.
+template<bool UseKernel, typename KernelType, typename MatType>
+bool MeanShift<UseKernel, KernelType, MatType>::ShiftCentroid(
+    const MatType& data,
+    const std::vector<size_t>& neighbors,
+    const std::vector<double>& distances,
+    arma::mat& allCentroids,
+    const size_t index)
+{
+  // Store new centroid in this.
+  arma::colvec newCentroid = arma::zeros<arma::colvec>(allCentroids.n_rows);
+
+  // Calculate new centroid.
+  if (!CalculateCentroid(data, neighbors, distances, newCentroid))
+    newCentroid = allCentroids.unsafe_col(index);
+
+  // If the mean shift vector is small enough, it has converged.
+  if (metric::EuclideanDistance::Evaluate(newCentroid,
+      allCentroids.unsafe_col(index)) < 1e-3 * radius)
+    return true;
+
+  // Update the centroid.
+  allCentroids.col(index) = newCentroid;
+  return false;
+}
+
 /**
  * Perform Mean Shift clustering on the data set, returning a list of cluster
  * assignments and centroids.
@@ -186,7 +212,8 @@ inline void MeanShift<UseKernel, KernelType, MatType>::Cluster(
     arma::Row<size_t>& assignments,
     arma::mat& centroids,
     bool forceConvergence,
-    bool useSeeds)
+    bool useSeeds,
+    bool batch)
 {
   if (radius <= 0)
   {
@@ -202,63 +229,119 @@ inline void MeanShift<UseKernel, KernelType, MatType>::Cluster(
     pSeeds = &seeds;
   }
 
-  // Holds all centroids before removing duplicate ones.
-  arma::mat allCentroids(pSeeds->n_rows, pSeeds->n_cols);
+  // Holds all centroids before removing duplicate ones.  The initial centroid
+  // of each seed is the seed itself.
+  arma::mat allCentroids(*pSeeds);
+  // Whether each centroid has converged.
+  std::vector<char> converged(pSeeds->n_cols, 0);
 
   assignments.set_size(data.n_cols);
 
-  range::RangeSearch<> rangeSearcher(data);
+  // The reference tree is built only once and shared by all searches.  It is
+  // built on a reordered copy of the data, and the neighbor indices returned
+  // by the searches refer to that copy.
+  typedef range::RangeSearch<> RangeSearchType;
+  typename RangeSearchType::Tree referenceTree(data);
+  const arma::mat& referenceSet = referenceTree.Dataset();
   math::Range validRadius(0, radius);
-  std::vector<std::vector<size_t> > neighbors;
-  std::vector<std::vector<double> > distances;
 
-  // For each seed, perform mean shift algorithm.
-  for (size_t i = 0; i < pSeeds->n_cols; ++i)
+  if (batch)
   {
-    // Initial centroid is the seed itself.
-    allCentroids.col(i) = pSeeds->unsafe_col(i);
-    for (size_t completedIterations = 0; completedIterations < maxIterations
-        || forceConvergence; completedIterations++)
+    // Advance all active seeds at once, with a dual-tree search per iteration.
+    RangeSearchType rangeSearcher(&referenceTree);
+    std::vector<size_t> active(pSeeds->n_cols);
+    for (size_t i = 0; i < active.size(); ++i)
+      active[i] = i;
+
+    std::vector<std::vector<size_t> > neighbors;
+    std::vector<std::vector<double> > distances;
+    for (size_t completedIterations = 0; !active.empty() &&
+        (completedIterations < maxIterations || forceConvergence);
+        completedIterations++)
     {
-      // Store new centroid in this.
-      arma::colvec newCentroid = arma::zeros<arma::colvec>(pSeeds->n_rows);
+      arma::mat activeCentroids(allCentroids.n_rows, active.size());
+      for (size_t j = 0; j < active.size(); ++j)
+        activeCentroids.col(j) = allCentroids.unsafe_col(active[j]);
 
-      rangeSearcher.Search(allCentroids.unsafe_col(i), validRadius,
-          neighbors, distances);
-      if (neighbors[0].size() == 0) // There are no points in the cluster.
-        break;
+      rangeSearcher.Search(activeCentroids, validRadius, neighbors, distances);
 
-      // Calculate new centroid.
-      if (!CalculateCentroid(data, neighbors[0], distances[0], newCentroid))
-        newCentroid = allCentroids.unsafe_col(i);
+      // A seed stops once it has converged or there are no points around it.
+      std::vector<char> stopped(active.size(), 0);
+      #pragma omp parallel for schedule(dynamic, 16)
+      for (omp_size_t j = 0; j < (omp_size_t) active.size(); ++j)
+      {
+        if (neighbors[j].size() == 0)
+        {
+          stopped[j] = 1;
+        }
+        else if (ShiftCentroid(referenceSet, neighbors[j], distances[j],
+            allCentroids, active[j]))
+        {
+          converged[active[j]] = 1;
+          stopped[j] = 1;
+        }
+      }
 
-      // If the mean shift vector is small enough, it has converged.
-      if (metric::EuclideanDistance::Evaluate(newCentroid,
-          allCentroids.unsafe_col(i)) < 1e-3 * radius)
+      size_t numActive = 0;
+      for (size_t j = 0; j < active.size(); ++j)
+        if (!stopped[j])
+          active[numActive++] = active[j];
+      active.resize(numActive);
+    }
+  }
+  else
+  {
+    // Each seed is independent, so they are shifted in parallel.
+    #pragma omp parallel
+    {
+      // Searching modifies the search object, so each thread has its own.
+      RangeSearchType rangeSearcher(&referenceTree, true);
+      std::vector<std::vector<size_t> > neighbors;
+      std::vector<std::vector<double> > distances;
+
+      #pragma omp for schedule(dynamic)
+      for (omp_size_t i = 0; i < (omp_size_t) pSeeds->n_cols; ++i)
       {
-        // Determine if the new centroid is duplicate with old ones.
-        bool isDuplicated = false;
-        for (size_t k = 0; k < centroids.n_cols; ++k)
+        for (size_t completedIterations = 0; completedIterations < maxIterations
+            || forceConvergence; completedIterations++)
         {
-          const double distance = metric::EuclideanDistance::Evaluate(
-              allCentroids.unsafe_col(i), centroids.unsafe_col(k));
-          if (distance < radius)
+          rangeSearcher.Search(allCentroids.unsafe_col(i), validRadius,
+              neighbors, distances);
+          if (neighbors[0].size() == 0) // There are no points in the cluster.
+            break;
+
+          if (ShiftCentroid(referenceSet, neighbors[0], distances[0],
+              allCentroids, i))
           {
-            isDuplicated = true;
+            converged[i] = 1;
             break;
           }
         }
+      }
+    }
+  }
 
-        if (!isDuplicated)
-          centroids.insert_cols(centroids.n_cols, allCentroids.unsafe_col(i));
+  // Remove duplicate centroids, in the order of the seeds.
+  for (size_t i = 0; i < allCentroids.n_cols; ++i)
+  {
+    if (!converged[i])
+      continue;
 
-        // Get out of the loop.
+    // Determine if the new centroid is duplicate with old ones.
+    bool isDuplicated = false;
+    for (size_t k = 0; k < centroids.n_cols; ++k)
+    {
+      const double distance = metric::EuclideanDistance::Evaluate(
+          allCentroids.unsafe_col(i), centroids.unsafe_col(k));
+      if (distance < radius)
+      {
+        isDuplicated = true;
         break;
       }
-
-      // Update the centroid.
-      allCentroids.col(i) = newCentroid;
     }
+
+    if (!isDuplicated)
+      centroids.insert_cols(centroids.n_cols, allCentroids.unsafe_col(i));
   }
 
   // If no centroid has converged due to too little iterations and without
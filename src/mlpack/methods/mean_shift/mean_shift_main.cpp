@@ -71,6 +71,9 @@ PARAM_FLAG("labels_only", "If specified, only the output labels will be "
 PARAM_FLAG("force_convergence", "If specified, the mean shift algorithm will "
   "continue running regardless of max_iterations until the clusters converge."
   , "f");
+PARAM_FLAG("batch", "If specified, all seeds are advanced together with one "
+    "dual-tree range search per iteration, which is faster for large datasets.",
+    "b");
 PARAM_MATRIX_OUT("output", "Matrix to write output labels or labeled data to.",
     "o");
 PARAM_MATRIX_OUT("centroid", "If specified, the centroids of each cluster will "
@@ -108,7 +111,7 @@ static void mlpackMain()
   Timer::Start("clustering");
   Log::Info << "Performing mean shift clustering..." << endl;
   meanShift.Cluster(dataset, assignments, centroids,
-    CLI::HasParam("force_convergence"));
+    CLI::HasParam("force_convergence"), true, CLI::HasParam("batch"));
   Timer::Stop("clustering");
 
   Log::Info << "Found " << centroids.n_cols << " centroids." << endl;
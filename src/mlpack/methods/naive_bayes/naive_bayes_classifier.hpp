@@ -16,6 +16,7 @@
 #define MLPACK_METHODS_NAIVE_BAYES_NAIVE_BAYES_CLASSIFIER_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/data/stream_reader.hpp>
 
 namespace mlpack {
 namespace naive_bayes /** The Naive Bayes Classifier. */ {
@@ -99,6 +100,9 @@ class NaiveBayesClassifier
    * algorithm is used, the current model is used as a starting point (this is
    * the default).  If the incremental algorithm is not used, then the current
    * model is ignored and the new model will be trained only on the given data.
+   * The statistics of the data are merged exactly into the current model, so
+   * training on several batches in turn gives the same model as training on
+   * all of them at once; this can be used to train on streaming data.
    * Note that even if the incremental algorithm is not used, the data must have
    * the same dimensionality and number of classes that the model was
    * initialized with.  If you want to change the dimensionality or number of
@@ -128,6 +132,17 @@ class NaiveBayesClassifier
   template<typename VecType>
   void Train(const VecType& point, const size_t label);
 
+  /**
+   * Train the Naive Bayes classifier incrementally on every remaining point of
+   * the given stream, one chunk at a time.  The last dimension of each point
+   * is its label.  As with Train(data, labels, numClasses), the current model
+   * is discarded if it has a different dimensionality or number of classes.
+   *
+   * @param reader Stream to read points and labels from.
+   * @param numClasses The number of classes in the dataset.
+   */
+  void Train(data::StreamReader& reader, const size_t numClasses);
+
   /**
    * Classify the given point, using the trained NaiveBayesClassifier model. The
    * predicted label is returned.
@@ -81,87 +81,74 @@ void NaiveBayesClassifier<ModelMatType>::Train(
       "NaiveBayesClassifier: element type of given data must match the element "
       "type of the model!");
 
-  // Do we need to resize the model?
-  if (probabilities.n_elem != numClasses)
+  // Do we need to resize the model?  If so, the current model is discarded.
+  if (probabilities.n_elem != numClasses || means.n_rows != data.n_rows)
   {
-    // Perform training, after initializing the model to 0 (that is, if Train()
-    // won't do that for us, which it won't if we're using the incremental
-    // algorithm).
-    if (incremental)
-    {
-      probabilities.zeros(numClasses);
-      means.zeros(data.n_rows, numClasses);
-      variances.zeros(data.n_rows, numClasses);
-    }
-    else
-    {
-      probabilities.set_size(numClasses);
-      means.set_size(data.n_rows, numClasses);
-      variances.set_size(data.n_rows, numClasses);
-    }
+    probabilities.zeros(numClasses);
+    means.zeros(data.n_rows, numClasses);
+    variances.zeros(data.n_rows, numClasses);
+    trainingPoints = 0;
   }
 
-  // Calculate the class probabilities as well as the sample mean and variance
-  // for each of the features with respect to each of the labels.
-  if (incremental)
-  {
-    // Use incremental algorithm.
-    // Fist, de-normalize probabilities.
-    probabilities *= trainingPoints;
-
-    for (size_t j = 0; j < data.n_cols; ++j)
-    {
-      const size_t label = labels[j];
-      ++probabilities[label];
-
-      arma::vec delta = data.col(j) - means.col(label);
-      means.col(label) += delta / probabilities[label];
-      variances.col(label) += delta % (data.col(j) - means.col(label));
-    }
-
-    for (size_t i = 0; i < probabilities.n_elem; ++i)
-    {
-      if (probabilities[i] > 2)
-        variances.col(i) /= (probabilities[i] - 1);
-    }
-  }
-  else
+  // If the incremental algorithm is not used, the current model is ignored.
+  if (!incremental)
   {
-    // Set all parameters to zero.
     probabilities.zeros();
     means.zeros();
     variances.zeros();
+    trainingPoints = 0;
+  }
+
+  // Calculate the class counts as well as the sample mean and the sum of
+  // squared differences from the mean (M2) for each of the features with
+  // respect to each of the labels in this batch.  This is a two-pass
+  // algorithm, to avoid the precision issues of summing squares.
+  arma::Col<ElemType> batchCounts(numClasses, arma::fill::zeros);
+  ModelMatType batchMeans(data.n_rows, numClasses, arma::fill::zeros);
+  ModelMatType batchM2(data.n_rows, numClasses, arma::fill::zeros);
 
-    // Don't use incremental algorithm.  This is a two-pass algorithm.  It is
-    // possible to calculate the means and variances using a faster one-pass
-    // algorithm but there are some precision and stability issues.  If this is
-    // too slow, it's an option to use the faster algorithm by default and then
-    // have this (and the incremental algorithm) be other options.
-
-    // Calculate the means.
-    for (size_t j = 0; j < data.n_cols; ++j)
-    {
-      const size_t label = labels[j];
-      ++probabilities[label];
-      means.col(label) += data.col(j);
-    }
-
-    // Normalize means.
-    for (size_t i = 0; i < probabilities.n_elem; ++i)
-      if (probabilities[i] != 0.0)
-        means.col(i) /= probabilities[i];
-
-    // Calculate variances.
-    for (size_t j = 0; j < data.n_cols; ++j)
-    {
-      const size_t label = labels[j];
-      variances.col(label) += square(data.col(j) - means.col(label));
-    }
-
-    // Normalize variances.
-    for (size_t i = 0; i < probabilities.n_elem; ++i)
-      if (probabilities[i] > 1)
-        variances.col(i) /= (probabilities[i] - 1);
+  for (size_t j = 0; j < data.n_cols; ++j)
+  {
+    const size_t label = labels[j];
+    ++batchCounts[label];
+    batchMeans.col(label) += data.col(j);
+  }
+
+  for (size_t i = 0; i < numClasses; ++i)
+    if (batchCounts[i] != 0.0)
+      batchMeans.col(i) /= batchCounts[i];
+
+  for (size_t j = 0; j < data.n_cols; ++j)
+  {
+    const size_t label = labels[j];
+    batchM2.col(label) += square(data.col(j) - batchMeans.col(label));
+  }
+
+  // Now merge the batch into the model with the pairwise form of Welford's
+  // update (Chan et al.), so that training on several batches in turn gives
+  // the same model as training on all of them at once.  The M2 of the model
+  // is recovered from its sample variances.
+  arma::Col<ElemType> counts = arma::round(probabilities * trainingPoints);
+  for (size_t i = 0; i < numClasses; ++i)
+  {
+    const ElemType oldCount = counts[i];
+    const ElemType newCount = batchCounts[i];
+    if (newCount == 0.0)
+      continue;
+
+    const ElemType count = oldCount + newCount;
+    arma::Col<ElemType> m2 = batchM2.col(i);
+    if (oldCount > 1)
+      m2 += variances.col(i) * (oldCount - 1);
+
+    const arma::Col<ElemType> delta = batchMeans.col(i) - means.col(i);
+    means.col(i) += delta * (newCount / count);
+    m2 += square(delta) * (oldCount * newCount / count);
+
+    if (count > 1)
+      variances.col(i) = m2 / (count - 1);
+    else
+      variances.col(i).zeros();
   }
 
   // Ensure that the variances are invertible.
@@ -169,8 +156,10 @@ void NaiveBayesClassifier<ModelMatType>::Train(
     if (variances[i] == 0.0)
       variances[i] = 1e-50;
 
-  probabilities /= data.n_cols;
+  counts += batchCounts;
   trainingPoints += data.n_cols;
+  if (trainingPoints > 0)
+    probabilities = counts / trainingPoints;
 }
 
 template<typename ModelMatType>
@@ -198,6 +187,26 @@ void NaiveBayesClassifier<ModelMatType>::Train(const VecType& point,
   probabilities /= trainingPoints;
 }
 
+template<typename ModelMatType>
+void NaiveBayesClassifier<ModelMatType>::Train(data::StreamReader& reader,
+                                               const size_t numClasses)
+{
+  arma::mat chunk;
+  while (reader.Next(chunk))
+  {
+    if (chunk.n_rows < 2)
+      throw std::runtime_error("NaiveBayesClassifier::Train(): each point of '"
+          + reader.Filename() + "' must hold at least one dimension and a "
+          "label");
+
+    const ModelMatType points = arma::conv_to<ModelMatType>::from(
+        chunk.rows(0, chunk.n_rows - 2));
+    const arma::Row<size_t> labels = arma::conv_to<arma::Row<size_t>>::from(
+        chunk.row(chunk.n_rows - 1));
+    Train(points, labels, numClasses, true);
+  }
+}
+
 template<typename ModelMatType>
 template<typename MatType>
 void NaiveBayesClassifier<ModelMatType>::LogLikelihood(
@@ -208,23 +217,46 @@ void NaiveBayesClassifier<ModelMatType>::LogLikelihood(
       "NaiveBayesClassifier: element type of given data must match the element "
       "type of the model!");
 
-  logLikelihoods = arma::log(arma::repmat(probabilities, 1, data.n_cols));
-  ModelMatType invVar = 1.0 / variances;
-
-  // Calculate the joint log likelihood of point for each of the
-  // means.n_cols.
+  // The log likelihood of a point x for class k is
+  //   log(p_k) - 0.5 * (d log(2 pi) + sum_j log(var_jk) +
+  //       sum_j (x_j - mu_jk)^2 / var_jk),
+  // and with the square expanded, the last sum is
+  //   invVar_k' (x % x) - 2 (mu_k % invVar_k)' x + mu_k' (mu_k % invVar_k),
+  // so the log likelihoods of all points for all classes can be computed with
+  // two matrix products.
+  const ModelMatType invVar = 1.0 / variances;
+  const ModelMatType weightedMeans = means % invVar;
+  const arma::Col<ElemType> logNormalizers = arma::log(probabilities) - 0.5 *
+      (data.n_rows * log(2 * M_PI) + arma::sum(arma::log(variances), 0).t() +
+      arma::sum(means % weightedMeans, 0).t());
+
+  logLikelihoods = weightedMeans.t() * data - 0.5 * invVar.t() *
+      arma::square(data);
+  logLikelihoods.each_col() += logNormalizers;
+
+  // The expanded form loses precision when the terms of the square are large
+  // compared to the square itself, which happens for classes with tiny
+  // variances (such as the placeholders for zero variances).  For these
+  // classes, use the direct form instead.  The rounding error of the expanded
+  // form is at most about eps * sum_j invVar_jk * (max(x_j^2) + mu_jk^2).
+  const ModelMatType maxSquares(arma::max(arma::square(data), 1));
+  const arma::Row<ElemType> errorBounds =
+      std::numeric_limits<ElemType>::epsilon() * (maxSquares.t() * invVar +
+      arma::sum(means % weightedMeans, 0));
 
-  // Loop over every class.
   for (size_t i = 0; i < means.n_cols; i++)
   {
+    if (errorBounds[i] <= 1e-6)
+      continue;
+
     // This is an adaptation of gmm::phi() for the case where the covariance is
     // a diagonal matrix.
     ModelMatType diffs = data - arma::repmat(means.col(i), 1, data.n_cols);
     ModelMatType rhs = -0.5 * arma::diagmat(invVar.col(i)) * diffs;
     arma::Mat<ElemType> exponents = arma::sum(diffs % rhs, 0);
 
-    logLikelihoods.row(i) += (data.n_rows / -2.0 * log(2 * M_PI) - 0.5 *
-        std::log(arma::det(arma::diagmat(variances.col(i)))) + exponents);
+    logLikelihoods.row(i) = logNormalizers[i] + 0.5 *
+        arma::accu(means.col(i) % weightedMeans.col(i)) + exponents;
   }
 }
 
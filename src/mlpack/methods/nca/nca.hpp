@@ -82,6 +82,12 @@ class NCA
   //! Get the labels reference.
   const arma::Row<size_t>& Labels() const { return labels; }
 
+  //! Get the tolerance below which terms of the softmax are ignored (see
+  //! SoftmaxErrorFunction).
+  double SoftmaxTolerance() const { return errorFunction.Tolerance(); }
+  //! Modify the tolerance below which terms of the softmax are ignored.
+  double& SoftmaxTolerance() { return errorFunction.Tolerance(); }
+
   //! Get the optimizer.
   const OptimizerType& Optimizer() const { return optimizer; }
   OptimizerType& Optimizer() { return optimizer; }
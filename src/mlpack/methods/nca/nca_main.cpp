@@ -129,6 +129,10 @@ PARAM_DOUBLE_IN("min_step", "Minimum step of line search for L-BFGS.", "m",
 PARAM_DOUBLE_IN("max_step", "Maximum step of line search for L-BFGS.", "M",
     1e20);
 
+PARAM_DOUBLE_IN("softmax_tolerance", "Terms of the softmax below this value "
+    "are ignored, and the others are found with a kd-tree (0 uses every "
+    "term).", "S", 0.0);
+
 PARAM_INT_IN("seed", "Random seed.  If 0, 'std::time(NULL)' is used.", "s", 0);
 
 using namespace mlpack;
@@ -182,6 +186,11 @@ static void mlpackMain()
   const double maxStep = CLI::GetParam<double>("max_step");
   const size_t batchSize = (size_t) CLI::GetParam<int>("batch_size");
 
+  RequireParamValue<double>("softmax_tolerance", [](double x)
+      { return x >= 0.0 && x < 1.0; }, true, "softmax tolerance must be in "
+      "[0, 1)");
+  const double softmaxTolerance = CLI::GetParam<double>("softmax_tolerance");
+
   // Load data.
   arma::mat data = std::move(CLI::GetParam<arma::mat>("input"));
 
@@ -235,6 +244,7 @@ static void mlpackMain()
   if (optimizerType == "sgd")
   {
     NCA<LMetric<2> > nca(data, labels);
+    nca.SoftmaxTolerance() = softmaxTolerance;
     nca.Optimizer().StepSize() = stepSize;
     nca.Optimizer().MaxIterations() = maxIterations;
     nca.Optimizer().Tolerance() = tolerance;
@@ -246,6 +256,7 @@ static void mlpackMain()
   else if (optimizerType == "lbfgs")
   {
     NCA<LMetric<2>, ens::L_BFGS> nca(data, labels);
+    nca.SoftmaxTolerance() = softmaxTolerance;
     nca.Optimizer().NumBasis() = numBasis;
     nca.Optimizer().MaxIterations() = maxIterations;
     nca.Optimizer().ArmijoConstant() = armijoConstant;
@@ -15,6 +15,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
+#include <mlpack/methods/range_search/range_search.hpp>
 
 namespace mlpack {
 namespace nca {
@@ -38,6 +39,15 @@ namespace nca {
  * optimizers use, overloads of Evaluate() and Gradient() are given which only
  * operate on one point in the dataset.  This is useful for optimizers like
  * stochastic gradient descent (see mlpack::optimization::SGD).
+ *
+ * Every evaluation sums exp(-d(A x_i, A x_k)) over all other points k, which
+ * takes O(n) time per point.  If a tolerance is given, the terms below the
+ * tolerance are ignored instead: a kd-tree is built on the stretched dataset,
+ * and a range search finds, for each point, the other points whose terms are
+ * at least the tolerance.  This is only possible when MetricType is the
+ * Euclidean or the squared Euclidean distance; for other metrics, the
+ * tolerance is ignored.  The points of a batch are processed in parallel (if
+ * OpenMP is available) either way.
  */
 template<typename MetricType = metric::SquaredEuclideanDistance>
 class SoftmaxErrorFunction
@@ -52,10 +62,13 @@ class SoftmaxErrorFunction
    * @param dataset Matrix containing the dataset.
    * @param labels Vector of class labels for each point in the dataset.
    * @param kernel Instantiated kernel (optional).
+   * @param tolerance Terms of the softmax below this value are ignored (0
+   *     means that every term is used).
    */
   SoftmaxErrorFunction(const arma::mat& dataset,
                        const arma::Row<size_t>& labels,
-                       MetricType metric = MetricType());
+                       MetricType metric = MetricType(),
+                       const double tolerance = 0.0);
 
   /**
    * Shuffle the dataset.
@@ -129,6 +142,12 @@ class SoftmaxErrorFunction
    */
   size_t NumFunctions() const { return dataset.n_cols; }
 
+  //! Get the tolerance below which terms of the softmax are ignored.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance below which terms of the softmax are ignored.  This
+  //! must be in [0, 1).
+  double& Tolerance() { return tolerance; }
+
  private:
   //! The dataset.  This is an alias until Shuffle() is called.
   arma::mat dataset;
@@ -149,6 +168,13 @@ class SoftmaxErrorFunction
   //! Evaluate() and Gradient().
   arma::vec denominators;
 
+  //! Terms of the softmax below this value are ignored.
+  double tolerance;
+  //! If the tolerance is used, holds the points whose terms are at least the
+  //! tolerance for each point, for the non-separable Evaluate() and
+  //! Gradient().
+  std::vector<std::vector<size_t>> candidates;
+
   //! False if nothing has ever been precalculated (only at construction time).
   bool precalculated;
 
@@ -166,6 +192,42 @@ class SoftmaxErrorFunction
    * @param coordinates Coordinates matrix to use for precalculation.
    */
   void Precalculate(const arma::mat& coordinates);
+
+  //! Return whether the tree is used to ignore the terms below the tolerance.
+  bool UseTree() const;
+
+  /**
+   * Find, for each of the given points of the stretched dataset, the other
+   * points whose terms in the softmax are at least the tolerance.  The list of
+   * a point may include the point itself.
+   *
+   * @param begin Index of the first point to find candidates for.
+   * @param batchSize Number of points to find candidates for.
+   * @param pointCandidates Vector to store the candidates of each point in.
+   */
+  void Candidates(const size_t begin,
+                  const size_t batchSize,
+                  std::vector<std::vector<size_t>>& pointCandidates);
+
+  /**
+   * Compute the numerator and the denominator of p_i, and, if firstTerm and
+   * secondTerm are not NULL, the sums of exp(-d(A x_i, A x_k)) x_ik x_ik^T over
+   * all other points k and over the other points k in the class of i.  Only
+   * the given candidates are used, if they are not NULL.
+   *
+   * @param i Index of the point.
+   * @param pointCandidates Points to use, or NULL to use all points.
+   * @param numerator Will be set to the numerator of p_i.
+   * @param denominator Will be set to the denominator of p_i.
+   * @param firstTerm Matrix to store the sum over all points in, or NULL.
+   * @param secondTerm Matrix to store the sum over the class of i in, or NULL.
+   */
+  void PointTerms(const size_t i,
+                  const std::vector<size_t>* pointCandidates,
+                  double& numerator,
+                  double& denominator,
+                  arma::mat* firstTerm,
+                  arma::mat* secondTerm);
 };
 
 } // namespace nca
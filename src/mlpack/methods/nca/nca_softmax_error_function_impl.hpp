@@ -23,12 +23,18 @@ template<typename MetricType>
 SoftmaxErrorFunction<MetricType>::SoftmaxErrorFunction(
     const arma::mat& dataset,
     const arma::Row<size_t>& labels,
-    MetricType metric) :
+    MetricType metric,
+    const double tolerance) :
     dataset(math::MakeAlias(const_cast<arma::mat&>(dataset), false)),
     labels(math::MakeAlias(const_cast<arma::Row<size_t>&>(labels), false)),
     metric(metric),
+    tolerance(tolerance),
     precalculated(false)
-{ /* nothing to do */ }
+{
+  if (tolerance < 0.0 || tolerance >= 1.0)
+    throw std::invalid_argument("SoftmaxErrorFunction: tolerance must be in "
+        "[0, 1)");
+}
 
 //! Shuffle the dataset.
 template<typename MetricType>
@@ -65,36 +71,30 @@ double SoftmaxErrorFunction<MetricType>::Evaluate(const arma::mat& coordinates,
                                                   const size_t batchSize)
 {
   // Unfortunately each evaluation will take O(N) time because it requires a
-  // scan over all points in the dataset.  Our objective is to compute p_i.
-  double denominator = 0;
-  double numerator = 0;
-  double result = 0;
+  // scan over all points in the dataset (or, with the tree, over all points
+  // within range).  Our objective is to compute p_i.
 
   // It's quicker to do this now than one point at a time later.
   stretchedDataset = coordinates * dataset;
-  for (size_t i = begin; i < begin + batchSize; i++)
-  {
-    for (size_t k = 0; k < dataset.n_cols; ++k)
-    {
-      // Don't consider the case where the points are the same.
-      if (k == i)
-        continue;
 
-      // We want to evaluate exp(-D(A x_i, A x_k)).
-      double eval = std::exp(-metric.Evaluate(stretchedDataset.unsafe_col(i),
-                                              stretchedDataset.unsafe_col(k)));
+  std::vector<std::vector<size_t>> batchCandidates;
+  if (UseTree())
+    Candidates(begin, batchSize, batchCandidates);
 
-      // If they are in the same class, update the numerator.
-      if (labels[i] == labels[k])
-        numerator += eval;
-
-      denominator += eval;
-    }
+  double result = 0;
+  #pragma omp parallel for schedule(dynamic) reduction(+:result)
+  for (omp_size_t b = 0; b < (omp_size_t) batchSize; ++b)
+  {
+    const size_t i = begin + b;
+    double numerator, denominator;
+    PointTerms(i, batchCandidates.empty() ? NULL : &batchCandidates[b],
+        numerator, denominator, NULL, NULL);
 
     // Now the result is just a simple division, but we have to be sure that the
     // denominator is not 0.
     if (denominator == 0.0)
     {
+      #pragma omp critical
       Log::Warn << "Denominator of p_" << i << " is 0!" << std::endl;
       continue;
     }
@@ -102,6 +102,7 @@ double SoftmaxErrorFunction<MetricType>::Evaluate(const arma::mat& coordinates,
     result += -(numerator / denominator); // Negate because the optimizer is a
                                           // minimizer.
   }
+
   return result;
 }
 
@@ -126,7 +127,75 @@ void SoftmaxErrorFunction<MetricType>::Gradient(const arma::mat& coordinates,
   //   otherwise, add
   //     (p_i p_ik + p_k p_ki) x_ik x_ik^T
   arma::mat sum;
-  sum.zeros(stretchedDataset.n_rows, stretchedDataset.n_rows);
+  sum.zeros(dataset.n_rows, dataset.n_rows);
+  if (UseTree())
+  {
+    // Only the pairs within range are used.  Each thread sums the terms of its
+    // points with one matrix product per point, keeping the positive and
+    // negative weights apart (the square roots of the weights are applied to
+    // both sides of the product).
+    #pragma omp parallel
+    {
+      arma::mat localSum(dataset.n_rows, dataset.n_rows, arma::fill::zeros);
+      arma::mat positive, negative;
+
+      #pragma omp for schedule(dynamic)
+      for (omp_size_t i = 0; i < (omp_size_t) dataset.n_cols; i++)
+      {
+        positive.set_size(dataset.n_rows, candidates[i].size());
+        negative.set_size(dataset.n_rows, candidates[i].size());
+        size_t numPositive = 0, numNegative = 0;
+
+        for (size_t c = 0; c < candidates[i].size(); ++c)
+        {
+          // The candidates are symmetric, so each pair is seen twice.
+          const size_t k = candidates[i][c];
+          if (k <= (size_t) i)
+            continue;
+
+          const double eval = exp(-metric.Evaluate(
+              stretchedDataset.unsafe_col(i), stretchedDataset.unsafe_col(k)));
+          const double p_ik = eval / denominators(i);
+          const double p_ki = eval / denominators(k);
+
+          const double weight = (labels[i] == labels[k]) ?
+              ((p[i] - 1) * p_ik + (p[k] - 1) * p_ki) :
+              (p[i] * p_ik + p[k] * p_ki);
+
+          // We are not using stretched points here.
+          if (weight > 0)
+          {
+            positive.col(numPositive++) = std::sqrt(weight) *
+                (dataset.col(i) - dataset.col(k));
+          }
+          else if (weight < 0)
+          {
+            negative.col(numNegative++) = std::sqrt(-weight) *
+                (dataset.col(i) - dataset.col(k));
+          }
+        }
+
+        if (numPositive > 0)
+        {
+          localSum += positive.cols(0, numPositive - 1) *
+              positive.cols(0, numPositive - 1).t();
+        }
+        if (numNegative > 0)
+        {
+          localSum -= negative.cols(0, numNegative - 1) *
+              negative.cols(0, numNegative - 1).t();
+        }
+      }
+
+      #pragma omp critical
+      sum += localSum;
+    }
+
+    // Assemble the final gradient.
+    gradient = -2 * coordinates * sum;
+    return;
+  }
+
   for (size_t i = 0; i < stretchedDataset.n_cols; i++)
   {
     for (size_t k = (i + 1); k < stretchedDataset.n_cols; k++)
@@ -161,72 +230,51 @@ void SoftmaxErrorFunction<MetricType>::Gradient(const arma::mat& coordinates,
                                                 GradType& gradient,
                                                 const size_t batchSize)
 {
-  // The gradient involves two matrix terms which are eventually combined into
-  // one.
-  GradType firstTerm, secondTerm;
-  // We will need to calculate p_i before this evaluation is done, so
-  // these two variables will hold the information necessary for that.
-  double numerator, denominator;
-
-  gradient.zeros(coordinates.n_rows, coordinates.n_rows);
-
   // Compute the stretched dataset.
   stretchedDataset = coordinates * dataset;
-  for (size_t i = begin; i < begin + batchSize; i++)
-  {
-    numerator = 0;
-    denominator = 0;
 
-    firstTerm.zeros(coordinates.n_rows, coordinates.n_cols);
-    secondTerm.zeros(coordinates.n_rows, coordinates.n_cols);
+  std::vector<std::vector<size_t>> batchCandidates;
+  if (UseTree())
+    Candidates(begin, batchSize, batchCandidates);
 
-    for (size_t k = 0; k < dataset.n_cols; ++k)
-    {
-      // Don't consider the case where the points are the same.
-      if (i == k)
-        continue;
+  // The gradient of p_i involves two matrix terms which are combined into one;
+  // each thread sums the combined terms of its points, and the sum is then
+  // multiplied by 2 * A.
+  arma::mat sum(dataset.n_rows, dataset.n_rows, arma::fill::zeros);
+  #pragma omp parallel
+  {
+    arma::mat localSum(dataset.n_rows, dataset.n_rows, arma::fill::zeros);
+    arma::mat firstTerm, secondTerm;
 
-      // Calculate the numerator of p_ik.
-      double eval = exp(-metric.Evaluate(stretchedDataset.unsafe_col(i),
-                                         stretchedDataset.unsafe_col(k)));
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t b = 0; b < (omp_size_t) batchSize; ++b)
+    {
+      const size_t i = begin + b;
+      double numerator, denominator;
+      PointTerms(i, batchCandidates.empty() ? NULL : &batchCandidates[b],
+          numerator, denominator, &firstTerm, &secondTerm);
 
-      // If the points are in the same class, we must add to the second term of
-      // the gradient as well as the numerator of p_i.  We will divide by the
-      // denominator of p_ik later.  For x_ik we are not using stretched points.
-      GradType x_ik = dataset.col(i) - dataset.col(k);
-      if (labels[i] == labels[k])
+      if (denominator == 0)
       {
-        numerator += eval;
-        secondTerm += eval * x_ik * trans(x_ik);
+        #pragma omp critical
+        Log::Warn << "Denominator of p_" << i << " is 0!" << std::endl;
+        // If the denominator is zero, then all p_ik should be zero and there
+        // is no gradient contribution from this point.
+        continue;
       }
 
-      // We always have to add to the denominator of p_i
-      // and the first term of the gradient computation.
-      // We will divide by the denominator of p_ik later.
-      denominator += eval;
-      firstTerm += eval * x_ik * trans(x_ik);
+      // Divide both terms by the denominator of p_ik, and multiply the first
+      // term by p_i.
+      const double p = numerator / denominator;
+      localSum += (p * firstTerm - secondTerm) / denominator;
     }
 
-    // Calculate p_i.
-    double p = 0;
-    if (denominator == 0)
-    {
-      Log::Warn << "Denominator of p_" << i << " is 0!" << std::endl;
-      // If the denominator is zero, then all p_ik should be zero and there is
-      // no gradient contribution from this point.
-      continue;
-    }
-    else
-    {
-      p = numerator / denominator;
-      firstTerm /= denominator;
-      secondTerm /= denominator;
-    }
-
-    // Now multiply the first term by p_i, and add the two together and multiply
-    // all by 2 * A.  We negate it though, because our optimizer is a minimizer.
-    gradient += -2 * coordinates * (p * firstTerm - secondTerm);
+    #pragma omp critical
+    sum += localSum;
   }
+
+  // We negate the gradient, because our optimizer is a minimizer.
+  gradient = -2 * coordinates * sum;
 }
 
 template<typename MetricType>
@@ -263,23 +311,36 @@ void SoftmaxErrorFunction<MetricType>::Precalculate(
   // order of O((n * (n + 1)) / 2), which really isn't all that great.
   p.zeros(stretchedDataset.n_cols);
   denominators.zeros(stretchedDataset.n_cols);
-  for (size_t i = 0; i < stretchedDataset.n_cols; i++)
+  candidates.clear();
+  if (UseTree())
   {
-    for (size_t j = (i + 1); j < stretchedDataset.n_cols; j++)
-    {
-      // Evaluate exp(-d(x_i, x_j)).
-      double eval = exp(-metric.Evaluate(stretchedDataset.unsafe_col(i),
-                                         stretchedDataset.unsafe_col(j)));
-
-      // Add this to the denominators of both p_i and p_j: K(i, j) = K(j, i).
-      denominators[i] += eval;
-      denominators[j] += eval;
+    // With the tree, only the points within range are visited.
+    Candidates(0, stretchedDataset.n_cols, candidates);
 
-      // If i and j are the same class, add to numerator of both.
-      if (labels[i] == labels[j])
+    #pragma omp parallel for schedule(dynamic)
+    for (omp_size_t i = 0; i < (omp_size_t) stretchedDataset.n_cols; i++)
+      PointTerms(i, &candidates[i], p[i], denominators[i], NULL, NULL);
+  }
+  else
+  {
+    for (size_t i = 0; i < stretchedDataset.n_cols; i++)
+    {
+      for (size_t j = (i + 1); j < stretchedDataset.n_cols; j++)
       {
-        p[i] += eval;
-        p[j] += eval;
+        // Evaluate exp(-d(x_i, x_j)).
+        double eval = exp(-metric.Evaluate(stretchedDataset.unsafe_col(i),
+                                           stretchedDataset.unsafe_col(j)));
+
+        // Add this to the denominators of both p_i and p_j: K(i, j) = K(j, i).
+        denominators[i] += eval;
+        denominators[j] += eval;
+
+        // If i and j are the same class, add to numerator of both.
+        if (labels[i] == labels[j])
+        {
+          p[i] += eval;
+          p[j] += eval;
+        }
       }
     }
   }
@@ -304,6 +365,119 @@ void SoftmaxErrorFunction<MetricType>::Precalculate(
   precalculated = true;
 }
 
+template<typename MetricType>
+bool SoftmaxErrorFunction<MetricType>::UseTree() const
+{
+  return (tolerance > 0.0) &&
+      (std::is_same<MetricType, metric::EuclideanDistance>::value ||
+      std::is_same<MetricType, metric::SquaredEuclideanDistance>::value);
+}
+
+template<typename MetricType>
+void SoftmaxErrorFunction<MetricType>::Candidates(
+    const size_t begin,
+    const size_t batchSize,
+    std::vector<std::vector<size_t>>& pointCandidates)
+{
+  // exp(-d) is below the tolerance when d is above -log(tolerance), so we
+  // search for the points within that distance (taking the square root for
+  // the squared Euclidean distance).
+  double radius = -std::log(tolerance);
+  if (std::is_same<MetricType, metric::SquaredEuclideanDistance>::value)
+    radius = std::sqrt(radius);
+
+  std::vector<std::vector<double>> distances;
+  range::RangeSearch<> rangeSearch(stretchedDataset);
+  if (begin == 0 && batchSize == stretchedDataset.n_cols)
+  {
+    rangeSearch.Search(math::Range(0.0, radius), pointCandidates, distances);
+  }
+  else
+  {
+    rangeSearch.Search(stretchedDataset.cols(begin, begin + batchSize - 1),
+        math::Range(0.0, radius), pointCandidates, distances);
+  }
+}
+
+template<typename MetricType>
+void SoftmaxErrorFunction<MetricType>::PointTerms(
+    const size_t i,
+    const std::vector<size_t>* pointCandidates,
+    double& numerator,
+    double& denominator,
+    arma::mat* firstTerm,
+    arma::mat* secondTerm)
+{
+  numerator = 0;
+  denominator = 0;
+
+  // The outer products are collected in blocks, and each block is summed with
+  // one matrix product.  Both terms weigh x_ik x_ik^T by exp(-d(A x_i, A x_k)),
+  // so the square root of the weight is applied to both sides of the product.
+  const size_t blockSize = 256;
+  arma::mat diffs, sameDiffs;
+  if (firstTerm)
+  {
+    firstTerm->zeros(dataset.n_rows, dataset.n_rows);
+    secondTerm->zeros(dataset.n_rows, dataset.n_rows);
+    diffs.set_size(dataset.n_rows, blockSize);
+    sameDiffs.set_size(dataset.n_rows, blockSize);
+  }
+  size_t numDiffs = 0, numSameDiffs = 0;
+
+  const size_t numPoints = pointCandidates ? pointCandidates->size() :
+      dataset.n_cols;
+  for (size_t c = 0; c < numPoints; ++c)
+  {
+    const size_t k = pointCandidates ? (*pointCandidates)[c] : c;
+
+    // Don't consider the case where the points are the same.
+    if (k == i)
+      continue;
+
+    // We want to evaluate exp(-D(A x_i, A x_k)).
+    const double eval = std::exp(-metric.Evaluate(
+        stretchedDataset.unsafe_col(i), stretchedDataset.unsafe_col(k)));
+
+    // If they are in the same class, update the numerator.
+    const bool sameClass = (labels[i] == labels[k]);
+    if (sameClass)
+      numerator += eval;
+    denominator += eval;
+
+    if (!firstTerm || eval == 0.0)
+      continue;
+
+    // For x_ik we are not using stretched points.
+    diffs.col(numDiffs) = std::sqrt(eval) * (dataset.col(i) - dataset.col(k));
+    if (sameClass)
+      sameDiffs.col(numSameDiffs++) = diffs.col(numDiffs);
+    ++numDiffs;
+
+    if (numDiffs == blockSize)
+    {
+      *firstTerm += diffs * diffs.t();
+      numDiffs = 0;
+    }
+    if (numSameDiffs == blockSize)
+    {
+      *secondTerm += sameDiffs * sameDiffs.t();
+      numSameDiffs = 0;
+    }
+  }
+
+  if (numDiffs > 0)
+  {
+    *firstTerm += diffs.cols(0, numDiffs - 1) *
+        diffs.cols(0, numDiffs - 1).t();
+  }
+  if (numSameDiffs > 0)
+  {
+    *secondTerm += sameDiffs.cols(0, numSameDiffs - 1) *
+        sameDiffs.cols(0, numSameDiffs - 1).t();
+  }
+}
+
 } // namespace nca
 } // namespace mlpack
 
@@ -0,0 +1,250 @@
+/**
+ * @file candidate_lists.hpp
+ *
+ * The lists of the k best candidate neighbors of a set of query points, kept
+ * in flat arrays of a fixed size.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_CANDIDATE_LISTS_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_CANDIDATE_LISTS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The k best candidate neighbors of each of a set of query points.  The
+ * distances and the indices of the candidates are held in two flat arrays, k
+ * entries per query point, and the worst distance of each list is also kept in
+ * an array of its own, so that the bounds of a node, which need the worst
+ * distance of each of its points, read contiguous memory.
+ *
+ * Each list starts with k placeholder candidates, with the worst distance and
+ * the index size_t() - 1.  The worst candidate of a list is always its first
+ * entry; the rest of the list is either sorted, from worst to best, or a heap.
+ * Inserting into a sorted list shifts the candidates that are worse than the
+ * new one, which is faster than a heap for small k (and is the default for k up
+ * to MaxSortedK); a heap is used for larger k.
+ *
+ * @tparam SortPolicy The sort policy for distances; see NearestNeighborSort.
+ */
+template<typename SortPolicy>
+class CandidateLists
+{
+ public:
+  //! The largest k for which the lists are sorted by default.
+  static const size_t MaxSortedK = 32;
+
+  /**
+   * Create the lists of the given number of query points, as sorted lists if k
+   * is at most MaxSortedK and as heaps otherwise.
+   *
+   * @param k Number of candidates of each query point.
+   * @param points Number of query points.
+   */
+  CandidateLists(const size_t k = 0, const size_t points = 0) :
+      CandidateLists(k, points, k <= MaxSortedK)
+  { }
+
+  /**
+   * Create the lists of the given number of query points.
+   *
+   * @param k Number of candidates of each query point.
+   * @param points Number of query points.
+   * @param sorted If true, the lists are sorted; otherwise, they are heaps.
+   */
+  CandidateLists(const size_t k, const size_t points, const bool sorted) :
+      k(k),
+      sorted(sorted),
+      distances(k * points, SortPolicy::WorstDistance()),
+      indices(k * points, size_t() - 1),
+      worst(points, SortPolicy::WorstDistance())
+  { }
+
+  /**
+   * Insert a candidate into the list of the given query point, if it is at
+   * least as good as the worst candidate of the list (which it replaces).
+   *
+   * @param point Index of the query point.
+   * @param index Index of the candidate.
+   * @param distance Distance from the query point to the candidate.
+   */
+  void Insert(const size_t point, const size_t index, const double distance)
+  {
+    if (SortPolicy::IsBetter(worst[point], distance))
+      return;
+
+    double* listDistances = distances.data() + point * k;
+    size_t* listIndices = indices.data() + point * k;
+    if (sorted)
+    {
+      // Shift the worse candidates towards the front, over the worst one.
+      size_t i = 0;
+      while (i + 1 < k && SortPolicy::IsBetter(distance, listDistances[i + 1]))
+      {
+        listDistances[i] = listDistances[i + 1];
+        listIndices[i] = listIndices[i + 1];
+        ++i;
+      }
+      listDistances[i] = distance;
+      listIndices[i] = index;
+    }
+    else
+    {
+      SiftDown(listDistances, listIndices, k, index, distance);
+    }
+
+    worst[point] = listDistances[0];
+  }
+
+  //! Get the distance of the worst candidate of the given query point.
+  double Worst(const size_t point) const { return worst[point]; }
+
+  /**
+   * Update the given distances with the worst and the best of the worst
+   * candidate distances of a range of query points.
+   *
+   * @param begin Index of the first query point.
+   * @param count Number of query points.
+   * @param worstDistance Worst distance, to be updated.
+   * @param bestDistance Best distance, to be updated.
+   */
+  void WorstRange(const size_t begin,
+                  const size_t count,
+                  double& worstDistance,
+                  double& bestDistance) const
+  {
+    // Written without branches over contiguous memory, so it can be
+    // vectorized.
+    double rangeWorst = worstDistance;
+    double rangeBest = bestDistance;
+    const double* w = worst.data() + begin;
+    for (size_t i = 0; i < count; ++i)
+    {
+      rangeWorst = SortPolicy::IsBetter(rangeWorst, w[i]) ? w[i] : rangeWorst;
+      rangeBest = SortPolicy::IsBetter(w[i], rangeBest) ? w[i] : rangeBest;
+    }
+
+    worstDistance = rangeWorst;
+    bestDistance = rangeBest;
+  }
+
+  //! Get the index of the i'th candidate of the given query point (in no
+  //! particular order).
+  size_t Index(const size_t point, const size_t i) const
+  {
+    return indices[point * k + i];
+  }
+
+  //! Get the distance of the i'th candidate of the given query point (in no
+  //! particular order).
+  double Distance(const size_t point, const size_t i) const
+  {
+    return distances[point * k + i];
+  }
+
+  /**
+   * Store the candidates of the given query point, best first, in the given
+   * column of the given matrices (which must have k rows), and then reset the
+   * list of the query point to the placeholder candidates.
+   *
+   * @param point Index of the query point.
+   * @param neighbors Matrix to store the indices of the candidates in.
+   * @param neighborDistances Matrix to store the distances of the candidates
+   *     in.
+   * @param column Column to store the candidates in.
+   */
+  void Extract(const size_t point,
+               arma::Mat<size_t>& neighbors,
+               arma::mat& neighborDistances,
+               const size_t column)
+  {
+    double* listDistances = distances.data() + point * k;
+    size_t* listIndices = indices.data() + point * k;
+    if (sorted)
+    {
+      for (size_t i = 0; i < k; ++i)
+      {
+        neighbors(k - 1 - i, column) = listIndices[i];
+        neighborDistances(k - 1 - i, column) = listDistances[i];
+      }
+    }
+    else
+    {
+      // Take the worst candidate out of the heap until it is empty.
+      for (size_t size = k; size > 0; --size)
+      {
+        neighbors(size - 1, column) = listIndices[0];
+        neighborDistances(size - 1, column) = listDistances[0];
+        SiftDown(listDistances, listIndices, size - 1, listIndices[size - 1],
+            listDistances[size - 1]);
+      }
+    }
+
+    std::fill(listDistances, listDistances + k, SortPolicy::WorstDistance());
+    std::fill(listIndices, listIndices + k, size_t() - 1);
+    worst[point] = SortPolicy::WorstDistance();
+  }
+
+  //! Get the number of candidates of each query point.
+  size_t K() const { return k; }
+  //! Get the number of query points.
+  size_t Points() const { return worst.size(); }
+  //! Get whether the lists are sorted (otherwise, they are heaps).
+  bool Sorted() const { return sorted; }
+
+ private:
+  /**
+   * Replace the worst candidate of a heap of the given size with the given
+   * candidate, and restore the heap.
+   */
+  static void SiftDown(double* listDistances,
+                       size_t* listIndices,
+                       const size_t size,
+                       const size_t index,
+                       const double distance)
+  {
+    size_t i = 0;
+    for (size_t child = 1; child < size; child = 2 * i + 1)
+    {
+      // Take the worse of the two children.
+      if (child + 1 < size && SortPolicy::IsBetter(listDistances[child],
+          listDistances[child + 1]))
+        ++child;
+
+      if (!SortPolicy::IsBetter(distance, listDistances[child]))
+        break;
+
+      listDistances[i] = listDistances[child];
+      listIndices[i] = listIndices[child];
+      i = child;
+    }
+
+    if (size > 0)
+    {
+      listDistances[i] = distance;
+      listIndices[i] = index;
+    }
+  }
+
+  //! The number of candidates of each query point.
+  size_t k;
+  //! Whether the lists are sorted (otherwise, they are heaps).
+  bool sorted;
+  //! The distances of the candidates, k for each query point.
+  std::vector<double> distances;
+  //! The indices of the candidates, k for each query point.
+  std::vector<size_t> indices;
+  //! The distance of the worst candidate of each query point.
+  std::vector<double> worst;
+};
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,201 @@
+/**
+ * @file distributed_neighbor_search.hpp
+ *
+ * Neighbor search with a reference set that is split across the processes of
+ * an MPI communicator.  This is only available if mlpack was built with MPI
+ * (-DUSE_MPI=ON, which defines HAS_MPI).
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_DISTRIBUTED_NEIGHBOR_SEARCH_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_DISTRIBUTED_NEIGHBOR_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "neighbor_search.hpp"
+
+#include <mpi.h>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * Neighbor search with a reference set that is split into shards, one held by
+ * each process (rank) of an MPI communicator.  Each rank builds a
+ * NeighborSearch (and its tree) on its own shard; a search is answered by every
+ * rank on its shard, and the k best results of each query point are then
+ * selected across the ranks with MPI_Reduce(), so only the candidates of each
+ * query point are communicated, never the reference points.
+ *
+ * The reference points are numbered across the whole reference set: the points
+ * of rank 0 first, then those of rank 1, and so on, each shard in its own
+ * order.
+ *
+ * @code
+ * MPI_Init(&argc, &argv);
+ * arma::mat shard; // Load the shard of this rank.
+ * DistributedNeighborSearch<> knn(std::move(shard));
+ *
+ * // Queries are given by rank 0, which gets the results.
+ * arma::mat queries; // Load the queries on rank 0.
+ * arma::Mat<size_t> neighbors;
+ * arma::mat distances;
+ * knn.Search(queries, 5, neighbors, distances);
+ *
+ * // All-k-nearest-neighbors: each rank gets the neighbors of its own points.
+ * knn.Search(5, neighbors, distances);
+ * MPI_Finalize();
+ * @endcode
+ *
+ * @tparam SortPolicy The sort policy for distances; see NearestNeighborSort.
+ * @tparam MetricType The metric to use for computation.
+ * @tparam TreeType The tree type to use; must adhere to the TreeType API.
+ */
+template<typename SortPolicy = NearestNeighborSort,
+         typename MetricType = mlpack::metric::EuclideanDistance,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType = tree::KDTree>
+class DistributedNeighborSearch
+{
+ public:
+  //! The type of the search on each shard.
+  typedef NeighborSearch<SortPolicy, MetricType, arma::mat, TreeType>
+      LocalSearchType;
+  //! Convenience typedef.
+  typedef typename LocalSearchType::Tree Tree;
+
+  /**
+   * Build the search on the shard of this rank.  Every rank of the
+   * communicator must call this.
+   *
+   * @param shard Reference points of this rank (possibly none).
+   * @param communicator Communicator of the ranks that hold the shards.
+   * @param mode Neighbor search mode used on each shard.
+   * @param epsilon Relative approximate error (non-negative).
+   * @param metric An optional instance of the MetricType class.
+   */
+  DistributedNeighborSearch(arma::mat shard,
+                            const MPI_Comm communicator = MPI_COMM_WORLD,
+                            const NeighborSearchMode mode = DUAL_TREE_MODE,
+                            const double epsilon = 0,
+                            const MetricType metric = MetricType());
+
+  /**
+   * Search for the neighbors of the query points of rank 0 in the whole
+   * reference set.  Every rank of the communicator must call this; the query
+   * set of the other ranks is ignored, and only rank 0 gets results.
+   *
+   * @param querySet Set of query points (on rank 0).
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point
+   *     (on rank 0).
+   * @param distances Matrix storing distances of neighbors for each query
+   *     point (on rank 0).
+   */
+  void Search(const arma::mat& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances);
+
+  /**
+   * Search for the neighbors of every point of the reference set
+   * (all-k-nearest-neighbors), not counting each point itself.  The shard of
+   * each rank is searched in turn by all the ranks (a dual-tree search for
+   * each pair of shards, in the default mode).  Every rank of the communicator
+   * must call this, and gets the neighbors of the points of its own shard.
+   *
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each point of the
+   *     shard.
+   * @param distances Matrix storing distances of neighbors for each point of
+   *     the shard.
+   */
+  void Search(const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances);
+
+  //! Get the communicator.
+  MPI_Comm Communicator() const { return communicator; }
+  //! Get the rank of this process in the communicator.
+  size_t Rank() const { return rank; }
+  //! Get the number of ranks in the communicator.
+  size_t Ranks() const { return shardPoints.size(); }
+
+  //! Get the number of points of the whole reference set.
+  size_t ReferencePoints() const { return totalPoints; }
+  //! Get the index, in the whole reference set, of the first point of the
+  //! shard of this rank.
+  size_t ShardOffset() const { return shardOffsets[rank]; }
+
+  //! Access the search on the shard of this rank.
+  const LocalSearchType& LocalSearch() const { return search; }
+  //! Modify the search on the shard of this rank.
+  LocalSearchType& LocalSearch() { return search; }
+
+ private:
+  //! A candidate neighbor, as it is sent between ranks.
+  struct Candidate
+  {
+    double distance;
+    unsigned long long index;
+  };
+
+  /**
+   * Search for the neighbors of the given query points in the shard of this
+   * rank, and return them as k candidates for each query point, with the
+   * indices of the whole reference set.  If fewer than k points can be
+   * candidates, the list is filled with the worst distance.
+   */
+  void LocalCandidates(const arma::mat* querySet,
+                       const size_t k,
+                       std::vector<Candidate>& candidates);
+
+  /**
+   * Select the k best candidates of each query point across all the ranks, on
+   * the given rank.
+   */
+  void ReduceCandidates(std::vector<Candidate>& candidates,
+                        const size_t k,
+                        const int root);
+
+  //! Merge two lists of candidates (an MPI_User_function).
+  static void MergeCandidates(void* in,
+                              void* inout,
+                              int* len,
+                              MPI_Datatype* type);
+
+  //! Convert candidates to neighbors and distances, for the given query
+  //! order (none for the order of the candidates).
+  void Unpack(const std::vector<Candidate>& candidates,
+              const size_t k,
+              const std::vector<size_t>& order,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances) const;
+
+  //! The communicator of the ranks that hold the shards.
+  MPI_Comm communicator;
+  //! The rank of this process.
+  size_t rank;
+  //! The search on the shard of this rank.
+  LocalSearchType search;
+  //! The original index of each point of the shard, in the order of the tree
+  //! (empty if the points were not rearranged).
+  std::vector<size_t> oldFromNew;
+  //! The number of points of the shard of each rank.
+  std::vector<size_t> shardPoints;
+  //! The index of the first point of the shard of each rank.
+  std::vector<size_t> shardOffsets;
+  //! The number of points of the whole reference set.
+  size_t totalPoints;
+};
+
+} // namespace neighbor
+} // namespace mlpack
+
+// Include implementation.
+#include "distributed_neighbor_search_impl.hpp"
+
+#endif
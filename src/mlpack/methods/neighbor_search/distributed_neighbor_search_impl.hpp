@@ -0,0 +1,323 @@
+/**
+ * @file distributed_neighbor_search_impl.hpp
+ *
+ * Implementation of neighbor search with a reference set that is split across
+ * the processes of an MPI communicator.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_DISTRIBUTED_NEIGHBOR_SEARCH_IMPL_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_DISTRIBUTED_NEIGHBOR_SEARCH_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "distributed_neighbor_search.hpp"
+
+#include <climits>
+
+namespace mlpack {
+namespace neighbor {
+
+//! Send the given matrix of the root rank to all the ranks (in pieces, since
+//! MPI counts are ints).
+inline void BroadcastMatrix(arma::mat& matrix,
+                            const int root,
+                            const MPI_Comm communicator)
+{
+  int rank;
+  MPI_Comm_rank(communicator, &rank);
+
+  unsigned long long size[2] = { matrix.n_rows, matrix.n_cols };
+  MPI_Bcast(size, 2, MPI_UNSIGNED_LONG_LONG, root, communicator);
+  if (rank != root)
+    matrix.set_size((size_t) size[0], (size_t) size[1]);
+
+  const size_t piece = (size_t) INT_MAX;
+  for (size_t start = 0; start < matrix.n_elem; start += piece)
+  {
+    MPI_Bcast(matrix.memptr() + start,
+        (int) std::min(piece, (size_t) matrix.n_elem - start), MPI_DOUBLE,
+        root, communicator);
+  }
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+DistributedNeighborSearch<SortPolicy, MetricType, TreeType>::
+DistributedNeighborSearch(arma::mat shard,
+                          const MPI_Comm communicator,
+                          const NeighborSearchMode mode,
+                          const double epsilon,
+                          const MetricType metric) :
+    communicator(communicator),
+    search(mode, epsilon, metric)
+{
+  int commRank, commSize;
+  MPI_Comm_rank(communicator, &commRank);
+  MPI_Comm_size(communicator, &commSize);
+  rank = (size_t) commRank;
+
+  // Find which points of the whole reference set each rank holds.
+  unsigned long long points = shard.n_cols;
+  std::vector<unsigned long long> allPoints(commSize);
+  MPI_Allgather(&points, 1, MPI_UNSIGNED_LONG_LONG, allPoints.data(), 1,
+      MPI_UNSIGNED_LONG_LONG, communicator);
+
+  shardPoints.resize(commSize);
+  shardOffsets.resize(commSize);
+  totalPoints = 0;
+  for (size_t i = 0; i < (size_t) commSize; ++i)
+  {
+    shardPoints[i] = (size_t) allPoints[i];
+    shardOffsets[i] = totalPoints;
+    totalPoints += shardPoints[i];
+  }
+
+  // The tree is built here, so that the order of its points is known: the
+  // shard is sent in that order for all-k-nearest-neighbors search.
+  if (IsNaiveMode(mode) || shard.n_cols == 0)
+  {
+    search.Train(std::move(shard));
+  }
+  else
+  {
+    Tree* tree = BuildTree<Tree>(std::move(shard), oldFromNew);
+    search.Train(std::move(*tree));
+    delete tree;
+  }
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void DistributedNeighborSearch<SortPolicy, MetricType, TreeType>::Search(
+    const arma::mat& querySet,
+    const size_t k,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances)
+{
+  if (k == 0 || k > totalPoints)
+  {
+    Log::Fatal << "Requested value of k (" << k << ") is invalid for the "
+        << "reference set size (" << totalPoints << ")!" << std::endl;
+  }
+
+  // Rank 0 sends the queries to the other ranks.
+  std::vector<Candidate> candidates;
+  if (rank == 0)
+  {
+    arma::mat queries(const_cast<double*>(querySet.memptr()), querySet.n_rows,
+        querySet.n_cols, false, true);
+    BroadcastMatrix(queries, 0, communicator);
+    LocalCandidates(&queries, k, candidates);
+  }
+  else
+  {
+    arma::mat queries;
+    BroadcastMatrix(queries, 0, communicator);
+    LocalCandidates(&queries, k, candidates);
+  }
+  ReduceCandidates(candidates, k, 0);
+
+  if (rank == 0)
+    Unpack(candidates, k, std::vector<size_t>(), neighbors, distances);
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void DistributedNeighborSearch<SortPolicy, MetricType, TreeType>::Search(
+    const size_t k,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances)
+{
+  if (k == 0 || k >= totalPoints)
+  {
+    Log::Fatal << "Requested value of k (" << k << ") is invalid for the "
+        << "reference set size (" << totalPoints << ")!" << std::endl;
+  }
+
+  // In turn, the shard of each rank is the query set of all the ranks.
+  for (size_t r = 0; r < shardPoints.size(); ++r)
+  {
+    std::vector<Candidate> candidates;
+    if (r == rank)
+    {
+      // The shard is sent in the order of the tree, which is the order of the
+      // results of the search of the shard on itself.
+      const arma::mat& shard = search.ReferenceSet();
+      arma::mat queries(const_cast<double*>(shard.memptr()), shard.n_rows,
+          shard.n_cols, false, true);
+      BroadcastMatrix(queries, (int) r, communicator);
+
+      LocalCandidates(NULL, k, candidates);
+      ReduceCandidates(candidates, k, (int) r);
+      Unpack(candidates, k, oldFromNew, neighbors, distances);
+    }
+    else
+    {
+      arma::mat queries;
+      BroadcastMatrix(queries, (int) r, communicator);
+
+      LocalCandidates(&queries, k, candidates);
+      ReduceCandidates(candidates, k, (int) r);
+    }
+  }
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void DistributedNeighborSearch<SortPolicy, MetricType, TreeType>::
+LocalCandidates(const arma::mat* querySet,
+                const size_t k,
+                std::vector<Candidate>& candidates)
+{
+  // A point of the shard is not a candidate for itself.
+  const size_t queries = (querySet == NULL) ? shardPoints[rank] :
+      querySet->n_cols;
+  const size_t available = (querySet != NULL) ? shardPoints[rank] :
+      ((shardPoints[rank] > 0) ? shardPoints[rank] - 1 : 0);
+  const size_t localK = std::min(k, available);
+
+  Candidate worst;
+  worst.distance = SortPolicy::WorstDistance();
+  worst.index = ULLONG_MAX;
+  candidates.assign(queries * k, worst);
+  if (localK == 0 || queries == 0)
+    return;
+
+  arma::Mat<size_t> localNeighbors;
+  arma::mat localDistances;
+  if (querySet == NULL)
+    search.Search(localK, localNeighbors, localDistances);
+  else
+    search.Search(*querySet, localK, localNeighbors, localDistances);
+
+  const size_t offset = shardOffsets[rank];
+  for (size_t i = 0; i < queries; ++i)
+  {
+    for (size_t j = 0; j < localK; ++j)
+    {
+      const size_t index = localNeighbors(j, i);
+      Candidate& candidate = candidates[i * k + j];
+      candidate.distance = localDistances(j, i);
+      candidate.index = offset + (oldFromNew.empty() ? index :
+          oldFromNew[index]);
+    }
+  }
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void DistributedNeighborSearch<SortPolicy, MetricType, TreeType>::
+ReduceCandidates(std::vector<Candidate>& candidates,
+                 const size_t k,
+                 const int root)
+{
+  // The candidates of each query point are one element.
+  MPI_Datatype type;
+  MPI_Type_contiguous((int) (k * sizeof(Candidate)), MPI_BYTE, &type);
+  MPI_Type_commit(&type);
+  MPI_Op op;
+  MPI_Op_create(&MergeCandidates, 1, &op);
+
+  const int queries = (int) (candidates.size() / k);
+  if ((int) rank == root)
+  {
+    MPI_Reduce(MPI_IN_PLACE, candidates.data(), queries, type, op, root,
+        communicator);
+  }
+  else
+  {
+    MPI_Reduce(candidates.data(), NULL, queries, type, op, root,
+        communicator);
+  }
+
+  MPI_Op_free(&op);
+  MPI_Type_free(&type);
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void DistributedNeighborSearch<SortPolicy, MetricType, TreeType>::
+MergeCandidates(void* in, void* inout, int* len, MPI_Datatype* type)
+{
+  int bytes;
+  MPI_Type_size(*type, &bytes);
+  const size_t k = (size_t) bytes / sizeof(Candidate);
+
+  // Ties are broken by index, so that the result does not depend on the order
+  // in which the ranks are merged.
+  auto better = [](const Candidate& a, const Candidate& b)
+  {
+    if (a.distance == b.distance)
+      return a.index < b.index;
+    return SortPolicy::IsBetter(a.distance, b.distance);
+  };
+
+  const Candidate* a = (const Candidate*) in;
+  Candidate* b = (Candidate*) inout;
+  std::vector<Candidate> merged(k);
+  for (int q = 0; q < *len; ++q)
+  {
+    // Both lists are sorted, best first.
+    size_t i = 0, j = 0;
+    for (size_t l = 0; l < k; ++l)
+      merged[l] = (j == k || (i < k && better(a[i], b[j]))) ? a[i++] : b[j++];
+
+    std::copy(merged.begin(), merged.end(), b);
+    a += k;
+    b += k;
+  }
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void DistributedNeighborSearch<SortPolicy, MetricType, TreeType>::Unpack(
+    const std::vector<Candidate>& candidates,
+    const size_t k,
+    const std::vector<size_t>& order,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances) const
+{
+  const size_t queries = candidates.size() / k;
+  neighbors.set_size(k, queries);
+  distances.set_size(k, queries);
+  for (size_t i = 0; i < queries; ++i)
+  {
+    const size_t col = order.empty() ? i : order[i];
+    for (size_t j = 0; j < k; ++j)
+    {
+      const Candidate& candidate = candidates[i * k + j];
+      distances(j, col) = candidate.distance;
+      neighbors(j, col) = (candidate.index == ULLONG_MAX) ? size_t(-1) :
+          (size_t) candidate.index;
+    }
+  }
+}
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,84 @@
+/**
+ * @file intrinsic_dimension.hpp
+ *
+ * A fast estimate of the intrinsic dimension of a dataset, used to decide
+ * whether trees are likely to be useful for neighbor search.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_INTRINSIC_DIMENSION_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_INTRINSIC_DIMENSION_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "neighbor_search.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * Estimate the intrinsic dimension of the given dataset with the two-nearest-
+ * neighbors maximum likelihood estimator: if r1 and r2 are the distances from
+ * a point to its first and second nearest neighbors, then r2 / r1 follows a
+ * Pareto distribution whose exponent is the intrinsic dimension.  The estimate
+ * is computed on a random sample of at most maxSamples points, so it is cheap
+ * even for large datasets.
+ *
+ * Trees can only prune well when the intrinsic dimension is low; when it is
+ * high, BLOCKED_NAIVE_MODE is usually faster than any tree-based search.
+ *
+ * @param dataset Dataset to estimate the intrinsic dimension of.
+ * @param maxSamples Maximum number of points to use for the estimate.
+ * @return Estimated intrinsic dimension (the dimensionality of the dataset if
+ *     it cannot be estimated).
+ */
+template<typename MatType>
+double EstimateIntrinsicDimension(const MatType& dataset,
+                                  const size_t maxSamples = 1000)
+{
+  if (dataset.n_cols < 3)
+    return dataset.n_rows;
+
+  arma::mat sample;
+  if (dataset.n_cols > maxSamples)
+  {
+    const arma::uvec indices = arma::shuffle(arma::linspace<arma::uvec>(0,
+        dataset.n_cols - 1, dataset.n_cols));
+    sample = arma::conv_to<arma::mat>::from(
+        dataset.cols(indices.head(maxSamples)));
+  }
+  else
+  {
+    sample = arma::conv_to<arma::mat>::from(dataset);
+  }
+
+  NeighborSearch<> knn(std::move(sample), BLOCKED_NAIVE_MODE);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  knn.Search(2, neighbors, distances);
+
+  // Duplicate points carry no information about the dimension.
+  double sumLogRatios = 0.0;
+  size_t count = 0;
+  for (size_t i = 0; i < distances.n_cols; ++i)
+  {
+    if (distances(0, i) > 0.0)
+    {
+      sumLogRatios += std::log(distances(1, i) / distances(0, i));
+      ++count;
+    }
+  }
+
+  if (sumLogRatios == 0.0)
+    return dataset.n_rows;
+
+  return std::min((double) count / sumLogRatios, (double) dataset.n_rows);
+}
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
@@ -95,13 +95,23 @@ PARAM_INT_IN("leaf_size", "Leaf size for tree building (used for kd-trees, "
     "Hilbert R trees, R+ trees, R++ trees, and octrees).", "l", 20);
 PARAM_FLAG("random_basis", "Before tree-building, project the data onto a "
     "random orthogonal basis.", "R");
+PARAM_STRING_IN("precision", "Precision of the reference set and trees: "
+    "'double' or 'single'.  Single precision halves the memory used by the "
+    "model, and is only supported for kd-trees and ball trees.", "P",
+    "double");
 PARAM_INT_IN("seed", "Random seed (if 0, std::time(NULL) is used).", "s", 0);
 
 // Search settings.
-PARAM_STRING_IN("algorithm", "Type of neighbor search: 'naive', 'single_tree', "
-    "'dual_tree', 'greedy'.", "a", "dual_tree");
+PARAM_STRING_IN("algorithm", "Type of neighbor search: 'naive', "
+    "'blocked_naive', 'single_tree', 'dual_tree', 'greedy'.  'blocked_naive' "
+    "is a brute-force search that computes distances between blocks of points "
+    "at once.", "a", "dual_tree");
 PARAM_DOUBLE_IN("epsilon", "If specified, will do approximate furthest neighbor"
     " search with given relative error. Must be in the range [0,1).", "e", 0);
+PARAM_FLAG("traversal_statistics", "If set, detailed statistics of the tree "
+    "traversal (nodes visited and pruned at each level, prunes by reason, "
+    "reference leaf sizes reached, and time per phase) are collected and printed"
+    " when verbose output is enabled.", "");
 PARAM_DOUBLE_IN("percentage", "If specified, will do approximate furthest "
     "neighbor search. Must be in the range (0,1] (decimal form). Resultant "
     "neighbors will be at least (p*100) % of the distance as the true furthest "
@@ -119,6 +129,7 @@ static void mlpackMain()
 
   ReportIgnoredParam({{ "input_model", true }}, "tree_type");
   ReportIgnoredParam({{ "input_model", true }}, "random_basis");
+  ReportIgnoredParam({{ "input_model", true }}, "precision");
 
   // Notify the user of parameters that will be only be considered for query
   // tree.
@@ -172,12 +183,15 @@ static void mlpackMain()
   NSModel<FurthestNS>* kfn;
 
   const string algorithm = CLI::GetParam<string>("algorithm");
-  RequireParamInSet<string>("algorithm", { "naive", "single_tree", "dual_tree",
-      "greedy" }, true, "unknown neighbor search algorithm");
+  RequireParamInSet<string>("algorithm", { "naive", "blocked_naive",
+      "single_tree", "dual_tree", "greedy" }, true,
+      "unknown neighbor search algorithm");
   NeighborSearchMode searchMode = DUAL_TREE_MODE;
 
   if (algorithm == "naive")
     searchMode = NAIVE_MODE;
+  else if (algorithm == "blocked_naive")
+    searchMode = BLOCKED_NAIVE_MODE;
   else if (algorithm == "single_tree")
     searchMode = SINGLE_TREE_MODE;
   else if (algorithm == "dual_tree")
@@ -229,6 +243,17 @@ static void mlpackMain()
     kfn->TreeType() = tree;
     kfn->RandomBasis() = randomBasis;
 
+    RequireParamInSet<string>("precision", { "double", "single" }, true,
+        "unknown precision");
+    kfn->SinglePrecision() = (CLI::GetParam<string>("precision") ==
+        "single");
+    if (kfn->SinglePrecision() && tree != KFNModel::KD_TREE &&
+        tree != KFNModel::BALL_TREE)
+    {
+      Log::Fatal << "Single precision is only supported for kd-trees and ball "
+          << "trees!" << endl;
+    }
+
     arma::mat referenceSet = std::move(CLI::GetParam<arma::mat>("reference"));
 
     Log::Info << "Using reference data from '"
@@ -255,7 +280,7 @@ static void mlpackMain()
 
     Log::Info << "Using kFN model from '"
         << CLI::GetPrintableParam<KFNModel*>("input_model") << "' (trained on "
-        << kfn->Dataset().n_rows << "x" << kfn->Dataset().n_cols
+        << kfn->DatasetSize().n_rows << "x" << kfn->DatasetSize().n_cols
         << " dataset)." << endl;
   }
 
@@ -276,19 +301,19 @@ static void mlpackMain()
     // Sanity check on k value: must be greater than 0, must be less than or
     // equal to the number of reference points.  Since it is unsigned,
     // we only test the upper bound.
-    if (k > kfn->Dataset().n_cols)
+    if (k > kfn->DatasetSize().n_cols)
     {
       Log::Fatal << "Invalid k: " << k << "; must be greater than 0 and less "
           << "than or equal to the number of reference points ("
-          << kfn->Dataset().n_cols << ")." << endl;
+          << kfn->DatasetSize().n_cols << ")." << endl;
     }
 
     // Sanity check on k value: must not be equal to the number of reference
     // points when query data has not been provided.
-    if (!CLI::HasParam("query") && k == kfn->Dataset().n_cols)
+    if (!CLI::HasParam("query") && k == kfn->DatasetSize().n_cols)
     {
       Log::Fatal << "Invalid k: " << k << "; must be less than the number of "
-          << "reference points (" << kfn->Dataset().n_cols << ") "
+          << "reference points (" << kfn->DatasetSize().n_cols << ") "
           << "if query data has not been provided." << endl;
     }
 
@@ -296,6 +321,7 @@ static void mlpackMain()
     arma::Mat<size_t> neighbors;
     arma::mat distances;
 
+    kfn->Statistics().Enabled() = CLI::HasParam("traversal_statistics");
     if (CLI::HasParam("query"))
       kfn->Search(std::move(queryData), k, neighbors, distances);
     else
@@ -21,6 +21,7 @@
 #include <iostream>
 
 #include "neighbor_search.hpp"
+#include "intrinsic_dimension.hpp"
 #include "unmap.hpp"
 #include "ns_model.hpp"
 
@@ -85,6 +86,15 @@ PARAM_MODEL_IN(KNNModel, "input_model", "Pre-trained kNN model.", "m");
 PARAM_MODEL_OUT(KNNModel, "output_model", "If specified, the kNN model will be "
     "output here.", "M");
 
+// The reference tree may also be loaded from or saved to a flat tree file, which
+// is mapped into memory instead of being deserialized.
+PARAM_STRING_IN("input_flat_model_file", "File containing a flat kd-tree "
+    "reference tree (saved with --output_flat_model_file) to map into memory.",
+    "F", "");
+PARAM_STRING_IN("output_flat_model_file", "If specified, the kd-tree reference "
+    "tree will be saved to this file in flat format, so that it can be mapped "
+    "into memory later.", "O", "");
+
 // The user may specify a query file of query points and a number of nearest
 // neighbors to search for.
 PARAM_MATRIX_IN("query", "Matrix containing query points (optional).", "q");
@@ -106,13 +116,39 @@ PARAM_DOUBLE_IN("rho", "Balance threshold (only valid for spill trees).", "b",
 
 PARAM_FLAG("random_basis", "Before tree-building, project the data onto a "
     "random orthogonal basis.", "R");
+PARAM_STRING_IN("precision", "Precision of the reference set and trees: "
+    "'double' or 'single'.  Single precision halves the memory used by the "
+    "model, and is only supported for kd-trees and ball trees.", "P",
+    "double");
 PARAM_INT_IN("seed", "Random seed (if 0, std::time(NULL) is used).", "s", 0);
 
 // Search settings.
-PARAM_STRING_IN("algorithm", "Type of neighbor search: 'naive', 'single_tree', "
-    "'dual_tree', 'greedy'.", "a", "dual_tree");
+PARAM_STRING_IN("algorithm", "Type of neighbor search: 'naive', "
+    "'blocked_naive', 'single_tree', 'dual_tree', 'greedy', 'best_first', or "
+    "'auto'.  'blocked_naive' is a brute-force search that computes distances "
+    "between blocks of points at once; 'auto' uses it instead of 'dual_tree' "
+    "when the estimated intrinsic dimension of the reference set is too high "
+    "for trees to be effective.  'best_first' is a single-tree search that "
+    "visits the closest nodes first, and can be bounded with "
+    "'max_base_cases' and 'max_query_time'.", "a", "auto");
 PARAM_DOUBLE_IN("epsilon", "If specified, will do approximate nearest neighbor "
     "search with given relative error.", "e", 0);
+PARAM_INT_IN("max_base_cases", "With the 'best_first' algorithm, the maximum "
+    "number of distance computations for each query point (0 means no limit); "
+    "the best neighbors found within that budget are returned.", "", 0);
+PARAM_DOUBLE_IN("max_query_time", "With the 'best_first' algorithm, the "
+    "maximum search time for each query point, in seconds (0 means no limit); "
+    "the best neighbors found within that time are returned.", "", 0);
+PARAM_FLAG("traversal_statistics", "If set, detailed statistics of the tree "
+    "traversal (nodes visited and pruned at each level, prunes by reason, "
+    "reference leaf sizes reached, and time per phase) are collected and printed"
+    " when verbose output is enabled.", "");
+
+// With 'auto', blocked naive search is used instead of dual-tree search when the
+// estimated intrinsic dimension of the reference set is higher than this.  The
+// estimate is biased low for high-dimensional data, so this corresponds to more
+// than about 20 true dimensions.
+static const double AutoBlockedNaiveDimension = 15.0;
 
 static void mlpackMain()
 {
@@ -122,12 +158,19 @@ static void mlpackMain()
     math::RandomSeed((size_t) std::time(NULL));
 
   // A user cannot specify both reference data and a model.
-  RequireOnlyOnePassed({ "reference", "input_model" }, true);
+  RequireOnlyOnePassed({ "reference", "input_model", "input_flat_model_file" },
+      true);
 
   ReportIgnoredParam({{ "input_model", true }}, "tree_type");
   ReportIgnoredParam({{ "input_model", true }}, "random_basis");
+  ReportIgnoredParam({{ "input_model", true }}, "precision");
   ReportIgnoredParam({{ "input_model", true }}, "tau");
   ReportIgnoredParam({{ "input_model", true }}, "rho");
+  ReportIgnoredParam({{ "input_flat_model_file", true }}, "tree_type");
+  ReportIgnoredParam({{ "input_flat_model_file", true }}, "random_basis");
+  ReportIgnoredParam({{ "input_flat_model_file", true }}, "precision");
+  ReportIgnoredParam({{ "input_flat_model_file", true }}, "tau");
+  ReportIgnoredParam({{ "input_flat_model_file", true }}, "rho");
   if (CLI::HasParam("input_model") && CLI::HasParam("leaf_size"))
   {
     Log::Warn << PRINT_PARAM_STRING("leaf_size") << " will only be considered"
@@ -136,8 +179,8 @@ static void mlpackMain()
   }
 
   // The user should give something to do...
-  RequireAtLeastOnePassed({ "k", "output_model" }, false,
-      "no results will be saved");
+  RequireAtLeastOnePassed({ "k", "output_model", "output_flat_model_file" },
+      false, "no results will be saved");
 
   // If the user specifies k but no output files, they should be warned.
   if (CLI::HasParam("k"))
@@ -184,18 +227,34 @@ static void mlpackMain()
   KNNModel* knn;
 
   const string algorithm = CLI::GetParam<string>("algorithm");
-  RequireParamInSet<string>("algorithm", { "naive", "single_tree", "dual_tree",
-      "greedy" }, true, "unknown neighbor search algorithm");
+  RequireParamInSet<string>("algorithm", { "naive", "blocked_naive",
+      "single_tree", "dual_tree", "greedy", "best_first", "auto" }, true,
+      "unknown neighbor search algorithm");
+  RequireParamValue<int>("max_base_cases", [](int x) { return x >= 0; }, true,
+      "max_base_cases must be non-negative");
+  RequireParamValue<double>("max_query_time", [](double x) { return x >= 0.0; },
+      true, "max_query_time must be non-negative");
+  if (algorithm != "best_first")
+  {
+    ReportIgnoredParam("max_base_cases", "the 'best_first' algorithm is not "
+        "being used");
+    ReportIgnoredParam("max_query_time", "the 'best_first' algorithm is not "
+        "being used");
+  }
   NeighborSearchMode searchMode = DUAL_TREE_MODE;
 
   if (algorithm == "naive")
     searchMode = NAIVE_MODE;
+  else if (algorithm == "blocked_naive")
+    searchMode = BLOCKED_NAIVE_MODE;
   else if (algorithm == "single_tree")
     searchMode = SINGLE_TREE_MODE;
   else if (algorithm == "dual_tree")
     searchMode = DUAL_TREE_MODE;
   else if (algorithm == "greedy")
     searchMode = GREEDY_SINGLE_TREE_MODE;
+  else if (algorithm == "best_first")
+    searchMode = BEST_FIRST_SINGLE_TREE_MODE;
 
   if (CLI::HasParam("reference"))
   {
@@ -242,6 +301,17 @@ static void mlpackMain()
 
     knn->TreeType() = tree;
     knn->RandomBasis() = randomBasis;
+
+    RequireParamInSet<string>("precision", { "double", "single" }, true,
+        "unknown precision");
+    knn->SinglePrecision() = (CLI::GetParam<string>("precision") ==
+        "single");
+    if (knn->SinglePrecision() && tree != KNNModel::KD_TREE &&
+        tree != KNNModel::BALL_TREE)
+    {
+      Log::Fatal << "Single precision is only supported for kd-trees and ball "
+          << "trees!" << endl;
+    }
     knn->LeafSize() = size_t(lsInt);
     knn->Tau() = tau;
     knn->Rho() = rho;
@@ -253,16 +323,43 @@ static void mlpackMain()
         << referenceSet.n_rows << " x " << referenceSet.n_cols << ")."
         << endl;
 
+    // Trees stop pruning when the intrinsic dimension is high, and then a
+    // brute-force search is faster.
+    if (algorithm == "auto")
+    {
+      const double dimension = EstimateIntrinsicDimension(referenceSet);
+      Log::Info << "Estimated intrinsic dimension of reference data: "
+          << dimension << "." << endl;
+      if (dimension > AutoBlockedNaiveDimension)
+        searchMode = BLOCKED_NAIVE_MODE;
+    }
+
     knn->BuildModel(std::move(referenceSet), size_t(lsInt), searchMode,
         epsilon);
   }
+  else if (CLI::HasParam("input_flat_model_file"))
+  {
+    if (IsNaiveMode(searchMode))
+      Log::Fatal << "Cannot use a flat reference tree with naive search!"
+          << endl;
+
+    const string flatFile = CLI::GetParam<string>("input_flat_model_file");
+    knn = new KNNModel();
+    knn->LeafSize() = size_t(lsInt);
+    knn->LoadFlat(flatFile, searchMode, epsilon);
+
+    Log::Info << "Mapped flat kd-tree from '" << flatFile << "' (trained on "
+        << knn->DatasetSize().n_rows << "x" << knn->DatasetSize().n_cols
+        << " dataset)." << endl;
+  }
   else
   {
     // Load the model from file.
     knn = CLI::GetParam<KNNModel*>("input_model");
 
-    // Adjust search mode.
-    knn->SearchMode() = searchMode;
+    // Adjust search mode; with 'auto', the mode of the model is kept.
+    if (algorithm != "auto")
+      knn->SearchMode() = searchMode;
     knn->Epsilon() = epsilon;
 
     // If leaf_size wasn't provided, let's consider the current value in the
@@ -273,10 +370,21 @@ static void mlpackMain()
 
     Log::Info << "Loaded kNN model from '"
         << CLI::GetPrintableParam<KNNModel*>("input_model") << "' (trained on "
-        << knn->Dataset().n_rows << "x" << knn->Dataset().n_cols
+        << knn->DatasetSize().n_rows << "x" << knn->DatasetSize().n_cols
         << " dataset)." << endl;
   }
 
+  // Save the flat reference tree, if desired.
+  if (CLI::HasParam("output_flat_model_file"))
+  {
+    if (knn->TreeType() != KNNModel::KD_TREE || knn->RandomBasis() ||
+        IsNaiveMode(knn->SearchMode()))
+      Log::Fatal << "Flat reference trees can only be saved for kd-trees "
+          << "without a random basis and with tree-based search!" << endl;
+
+    knn->SaveFlat(CLI::GetParam<string>("output_flat_model_file"));
+  }
+
   // Perform search, if desired.
   if (CLI::HasParam("k"))
   {
@@ -294,19 +402,19 @@ static void mlpackMain()
     // Sanity check on k value: must be greater than 0, must be less than or
     // equal to the number of reference points.  Since it is unsigned,
     // we only test the upper bound.
-    if (k > knn->Dataset().n_cols)
+    if (k > knn->DatasetSize().n_cols)
     {
       Log::Fatal << "Invalid k: " << k << "; must be greater than 0 and less "
           << "than or equal to the number of reference points ("
-          << knn->Dataset().n_cols << ")." << endl;
+          << knn->DatasetSize().n_cols << ")." << endl;
     }
 
     // Sanity check on k value: must not be equal to the number of reference
     // points when query data has not been provided.
-    if (!CLI::HasParam("query") && k == knn->Dataset().n_cols)
+    if (!CLI::HasParam("query") && k == knn->DatasetSize().n_cols)
     {
       Log::Fatal << "Invalid k: " << k << "; must be less than the number of "
-          << "reference points (" << knn->Dataset().n_cols << ") "
+          << "reference points (" << knn->DatasetSize().n_cols << ") "
           << "if query data has not been provided." << endl;
     }
 
@@ -314,6 +422,9 @@ static void mlpackMain()
     arma::Mat<size_t> neighbors;
     arma::mat distances;
 
+    knn->Statistics().Enabled() = CLI::HasParam("traversal_statistics");
+    knn->MaxBaseCases() = (size_t) CLI::GetParam<int>("max_base_cases");
+    knn->MaxQueryTime() = CLI::GetParam<double>("max_query_time");
     if (CLI::HasParam("query"))
       knn->Search(std::move(queryData), k, neighbors, distances);
     else
@@ -327,7 +438,11 @@ static void mlpackMain()
     // Calculate the effective error, if desired.
     if (CLI::HasParam("true_distances"))
     {
-      if (knn->TreeType() != KNNModel::SPILL_TREE && knn->Epsilon() == 0)
+      const bool budgeted = (knn->SearchMode() ==
+          BEST_FIRST_SINGLE_TREE_MODE) && (knn->MaxBaseCases() > 0 ||
+          knn->MaxQueryTime() > 0.0);
+      if (knn->TreeType() != KNNModel::SPILL_TREE && knn->Epsilon() == 0 &&
+          !budgeted)
         Log::Warn << PRINT_PARAM_STRING("true_distances") << "specified, but "
             << "the search is exact, so there is no need to calculate the "
             << "error!" << endl;
@@ -347,7 +462,11 @@ static void mlpackMain()
     // Calculate the recall, if desired.
     if (CLI::HasParam("true_neighbors"))
     {
-      if (knn->TreeType() != KNNModel::SPILL_TREE && knn->Epsilon() == 0)
+      const bool budgeted = (knn->SearchMode() ==
+          BEST_FIRST_SINGLE_TREE_MODE) && (knn->MaxBaseCases() > 0 ||
+          knn->MaxQueryTime() > 0.0);
+      if (knn->TreeType() != KNNModel::SPILL_TREE && knn->Epsilon() == 0 &&
+          !budgeted)
         Log::Warn << PRINT_PARAM_STRING("true_neighbors") << " specified, but "
             << " the search is exact, so there is no need to calculate the "
             << "recall!" << endl;
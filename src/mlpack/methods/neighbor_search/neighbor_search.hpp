@@ -20,6 +20,8 @@
 #include <mlpack/core/tree/binary_space_tree.hpp>
 #include <mlpack/core/tree/rectangle_tree.hpp>
 #include <mlpack/core/tree/binary_space_tree/binary_space_tree.hpp>
+#include <mlpack/core/tree/space_filling_curve.hpp>
+#include <mlpack/core/util/mapped_file.hpp>
 
 #include "neighbor_search_stat.hpp"
 #include "sort_policies/nearest_neighbor_sort.hpp"
@@ -34,15 +36,37 @@ namespace neighbor  {
 template<typename SortPolicy>
 class TrainVisitor;
 
-//! NeighborSearchMode represents the different neighbor search modes available.
+/**
+ * NeighborSearchMode represents the different neighbor search modes available.
+ * BLOCKED_NAIVE_MODE is a brute-force search like NAIVE_MODE, but distances
+ * between blocks of query points and blocks of reference points are computed
+ * at once (with a matrix multiplication for Euclidean distances), in parallel
+ * over blocks of query points.  Like NAIVE_MODE, it does not use trees, so it
+ * is the best choice when the data is too high-dimensional for trees to prune.
+ *
+ * BEST_FIRST_SINGLE_TREE_MODE is a single-tree search that visits the nodes
+ * with the best bounds first (see tree::BestFirstSingleTreeTraverser).  By
+ * itself it is exact, but the search of each query point can be bounded with
+ * NeighborSearch::MaxBaseCases() and NeighborSearch::MaxQueryTime(); the
+ * results are then the best neighbors found within the budget.
+ */
 enum NeighborSearchMode
 {
   NAIVE_MODE,
   SINGLE_TREE_MODE,
   DUAL_TREE_MODE,
-  GREEDY_SINGLE_TREE_MODE
+  GREEDY_SINGLE_TREE_MODE,
+  BLOCKED_NAIVE_MODE,
+  BEST_FIRST_SINGLE_TREE_MODE
 };
 
+//! Return whether the given search mode is a brute-force mode that does not
+//! use a reference tree.
+inline bool IsNaiveMode(const NeighborSearchMode mode)
+{
+  return (mode == NAIVE_MODE || mode == BLOCKED_NAIVE_MODE);
+}
+
 /**
  * The NeighborSearch class is a template class for performing distance-based
  * neighbor searches.  It takes a query dataset and a reference dataset (or just
@@ -207,6 +231,43 @@ class NeighborSearch
    */
   void Train(Tree referenceTree);
 
+  /**
+   * Add the given points to the reference set, without rebuilding the
+   * reference tree (see BinarySpaceTree::Insert()).  The i'th new point gets
+   * the index of the number of reference points before the insertion plus i,
+   * so results are reported in terms of the original reference set followed by
+   * all of the inserted points.  Since the tree is not rebalanced by
+   * insertions, it is rebuilt from scratch once the number of points inserted
+   * since it was last built exceeds rebuildRatio times the number of points
+   * it was built with.  This is only available for BinarySpaceTree types
+   * (such as the KDTree), or when naive search is used.
+   *
+   * @param newPoints Points to add to the reference set.
+   * @param rebuildRatio Ratio of inserted points to built points above which
+   *     the tree is rebuilt (DBL_MAX means never).
+   * @param maxLeafSize Maximum number of points in a leaf of the tree.
+   */
+  void Insert(const MatType& newPoints,
+              const double rebuildRatio = 1.0,
+              const size_t maxLeafSize = 20);
+
+  /**
+   * Replace the reference points with the given points, which must be the
+   * same number of points in the same order as the original reference set,
+   * keeping the structure of the reference tree and only recomputing its
+   * bounds (see BinarySpaceTree::Refit()).  This is much cheaper than
+   * rebuilding the tree when the points have moved a little, for instance
+   * under a slowly changing linear transformation.  The search results are
+   * exact either way, but the more the points have moved relative to each
+   * other, the slower the refit tree will be to search, so it is best to
+   * rebuild the tree with Train() once they have moved a lot.  This is only
+   * available for BinarySpaceTree types (such as the KDTree), or when naive
+   * search is used.
+   *
+   * @param newReferenceSet New positions of the reference points.
+   */
+  void Refit(const MatType& newReferenceSet);
+
   /**
    * For each point in the query set, compute the nearest neighbors and store
    * the output in the given matrices.  The matrices will be set to the size of
@@ -273,6 +334,28 @@ class NeighborSearch
               arma::Mat<size_t>& neighbors,
               arma::mat& distances);
 
+  /**
+   * Save the reference tree (and the reordered reference set) to the given file
+   * in the flat tree format (see tree::FlatTreeIO), so that it can later be
+   * used with LoadFlat().  This is only available for BinarySpaceTrees that use
+   * HRectBound, such as the KDTree, and not in naive mode.
+   *
+   * @param filename File to save the reference tree to.
+   */
+  void SaveFlat(const std::string& filename) const;
+
+  /**
+   * Use the reference tree stored in the given flat tree file (see
+   * tree::FlatTreeIO and SaveFlat()).  The file is mapped into memory and the
+   * reference set is used directly from the mapped memory, so no dataset is
+   * parsed or copied and no tree is built; pages of the file are loaded as the
+   * search touches them.  The file stays mapped until the reference set is
+   * changed or this object is destroyed.  This is not available in naive mode.
+   *
+   * @param filename Flat tree file to load the reference tree from.
+   */
+  void LoadFlat(const std::string& filename);
+
   /**
    * Calculate the average relative error (effective error) between the
    * distances calculated and the true distances provided.  The input matrices
@@ -312,6 +395,15 @@ class NeighborSearch
   //! Return the number of node combination scores during the last search.
   size_t Scores() const { return scores; }
 
+  /**
+   * Access the detailed traversal statistics of the last search.  These are
+   * only collected if Statistics().Enabled() is set to true before searching;
+   * when they are, they are also printed to Log::Info after each search.
+   */
+  const tree::TraversalStatistics& Statistics() const { return statistics; }
+  //! Modify the traversal statistics (i.e. to enable their collection).
+  tree::TraversalStatistics& Statistics() { return statistics; }
+
   //! Access the search mode.
   NeighborSearchMode SearchMode() const { return searchMode; }
   //! Modify the search mode.
@@ -322,6 +414,37 @@ class NeighborSearch
   //! Modify the relative error to be considered in approximate search.
   double& Epsilon() { return epsilon; }
 
+  //! Access the maximum number of base cases for each query point in
+  //! BEST_FIRST_SINGLE_TREE_MODE (0 for no limit).
+  size_t MaxBaseCases() const { return maxBaseCases; }
+  //! Modify the maximum number of base cases for each query point in
+  //! BEST_FIRST_SINGLE_TREE_MODE (0 for no limit).  At least k base cases are
+  //! always computed, so that k neighbors are found.
+  size_t& MaxBaseCases() { return maxBaseCases; }
+
+  //! Access the maximum search time for each query point, in seconds, in
+  //! BEST_FIRST_SINGLE_TREE_MODE (0 for no limit).
+  double MaxQueryTime() const { return maxQueryTime; }
+  //! Modify the maximum search time for each query point, in seconds, in
+  //! BEST_FIRST_SINGLE_TREE_MODE (0 for no limit).  The time is checked after
+  //! each node, so it may be exceeded by the time of one node, and k base cases
+  //! are always computed.
+  double& MaxQueryTime() { return maxQueryTime; }
+
+  //! Access the space-filling curve along which the query points are visited
+  //! in the single-tree modes.
+  tree::SpaceFillingCurve QueryCurve() const { return queryCurve; }
+  //! Modify the space-filling curve along which the query points are visited
+  //! in the single-tree modes (see tree::SpaceFillingCurveOrder()).  Visiting
+  //! nearby query points one after another makes better use of the cache when
+  //! the query set is large and in no particular order; the results are the
+  //! same.
+  tree::SpaceFillingCurve& QueryCurve() { return queryCurve; }
+
+  //! Return the number of query points whose search was stopped by
+  //! MaxBaseCases() or MaxQueryTime() during the last search.
+  size_t StoppedQueries() const { return stoppedQueries; }
+
   //! Access the reference dataset.
   const MatType& ReferenceSet() const { return *referenceSet; }
 
@@ -346,6 +469,13 @@ class NeighborSearch
   NeighborSearchMode searchMode;
   //! Indicates the relative error to be considered in approximate search.
   double epsilon;
+  //! The maximum number of base cases for each query point in best-first mode.
+  size_t maxBaseCases;
+  //! The maximum search time for each query point in best-first mode.
+  double maxQueryTime;
+  //! The space-filling curve along which query points are visited in the
+  //! single-tree modes.
+  tree::SpaceFillingCurve queryCurve;
 
   //! Instantiation of metric.
   MetricType metric;
@@ -354,11 +484,55 @@ class NeighborSearch
   size_t baseCases;
   //! The total number of scores (applicable for non-naive search).
   size_t scores;
+  //! The number of query points whose search was stopped by the budget.
+  size_t stoppedQueries;
 
   //! If this is true, the reference tree bounds need to be reset on a call to
   //! Search() without a query set.
   bool treeNeedsReset;
 
+  //! The number of reference points inserted with Insert() since the reference
+  //! tree was last built.
+  size_t insertedPoints;
+
+  //! If the reference tree was loaded with LoadFlat(), this holds the mapped
+  //! file that the reference set lives in.
+  std::shared_ptr<util::MappedFile> mappedFile;
+
+  //! Detailed statistics of the last search.
+  tree::TraversalStatistics statistics;
+
+  //! Store the totals of the last search, which took the given number of
+  //! seconds, in the statistics, and report them if they are enabled.
+  void RecordStatistics(const double searchTime);
+
+#ifdef HAS_NVBLAS
+  // NVBLAS runs small matrix products on the CPU, and each product it runs on
+  // the GPU pays for copying its operands there and back; so the blocks are
+  // made large enough (at least the default NVBLAS tile size) for the distance
+  // products to be worth running on the GPU.
+  //! The number of query points in each block of BLOCKED_NAIVE_MODE.
+  static const size_t QueryBlockSize = 2048;
+  //! The number of reference points in each block of BLOCKED_NAIVE_MODE.
+  static const size_t ReferenceBlockSize = 2048;
+#else
+  //! The number of query points in each block of BLOCKED_NAIVE_MODE.
+  static const size_t QueryBlockSize = 128;
+  //! The number of reference points in each block of BLOCKED_NAIVE_MODE.
+  static const size_t ReferenceBlockSize = 1024;
+#endif
+
+  /**
+   * Compute the base cases between the first numQueries query points of the
+   * given rules and all of the reference points, one block of points at a
+   * time, and store the results.  Each thread works on a copy of the rules.
+   */
+  template<typename RuleType>
+  void BlockedNaiveSearch(const RuleType& rules,
+                          const size_t numQueries,
+                          arma::Mat<size_t>& neighbors,
+                          arma::mat& distances);
+
   //! The NSModel class should have access to internal members.
   template<typename SortPol>
   friend class TrainVisitor;
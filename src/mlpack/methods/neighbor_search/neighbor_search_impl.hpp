@@ -15,6 +15,8 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/tree/greedy_single_tree_traverser.hpp>
+#include <mlpack/core/tree/best_first_single_tree_traverser.hpp>
+#include <mlpack/core/tree/parallel_dual_tree_traverser.hpp>
 #include "neighbor_search_rules.hpp"
 #include <mlpack/core/tree/spill_tree/is_spill_tree.hpp>
 
@@ -45,6 +47,38 @@ TreeType* BuildTree(
   return new TreeType(std::forward<MatType>(dataset));
 }
 
+//! Run a dual-tree traversal that splits the query tree into parallel tasks.
+//! This is only valid for trees that do not duplicate points between nodes.
+template<typename TraverserType, typename TreeType, typename RuleType>
+void DualTreeTraversal(
+    RuleType& rules,
+    TreeType& queryTree,
+    TreeType& referenceTree,
+    typename std::enable_if_t<
+        tree::TreeTraits<TreeType>::BinaryTree &&
+        !tree::TreeTraits<TreeType>::HasDuplicatedPoints, TreeType
+    >* = 0)
+{
+  tree::ParallelDualTreeTraverser<TreeType, RuleType, TraverserType>
+      traverser(rules);
+  traverser.Traverse(queryTree, referenceTree);
+}
+
+//! Run a serial dual-tree traversal.
+template<typename TraverserType, typename TreeType, typename RuleType>
+void DualTreeTraversal(
+    RuleType& rules,
+    TreeType& queryTree,
+    TreeType& referenceTree,
+    const typename std::enable_if_t<
+        !tree::TreeTraits<TreeType>::BinaryTree ||
+        tree::TreeTraits<TreeType>::HasDuplicatedPoints, TreeType
+    >* = 0)
+{
+  TraverserType traverser(rules);
+  traverser.Traverse(queryTree, referenceTree);
+}
+
 // Construct the object.
 template<typename SortPolicy,
          typename MetricType,
@@ -59,16 +93,21 @@ SingleTreeTraversalType>::NeighborSearch(MatType referenceSetIn,
                                          const NeighborSearchMode mode,
                                          const double epsilon,
                                          const MetricType metric) :
-    referenceTree(mode == NAIVE_MODE ? NULL :
+    referenceTree(IsNaiveMode(mode) ? NULL :
         BuildTree<Tree>(std::move(referenceSetIn), oldFromNewReferences)),
-    referenceSet(mode == NAIVE_MODE ?  new MatType(std::move(referenceSetIn)) :
+    referenceSet(IsNaiveMode(mode) ?  new MatType(std::move(referenceSetIn)) :
         &referenceTree->Dataset()),
     searchMode(mode),
     epsilon(epsilon),
+    maxBaseCases(0),
+    maxQueryTime(0.0),
+    queryCurve(tree::NO_CURVE),
     metric(metric),
     baseCases(0),
     scores(0),
-    treeNeedsReset(false)
+    stoppedQueries(0),
+    treeNeedsReset(false),
+    insertedPoints(0)
 {
   if (epsilon < 0)
     throw std::invalid_argument("epsilon must be non-negative");
@@ -92,10 +131,15 @@ SingleTreeTraversalType>::NeighborSearch(Tree referenceTree,
     referenceSet(&this->referenceTree->Dataset()),
     searchMode(mode),
     epsilon(epsilon),
+    maxBaseCases(0),
+    maxQueryTime(0.0),
+    queryCurve(tree::NO_CURVE),
     metric(metric),
     baseCases(0),
     scores(0),
-    treeNeedsReset(false)
+    stoppedQueries(0),
+    treeNeedsReset(false),
+    insertedPoints(0)
 {
   if (epsilon < 0)
     throw std::invalid_argument("epsilon must be non-negative");
@@ -118,16 +162,21 @@ SingleTreeTraversalType>::NeighborSearch(const NeighborSearchMode mode,
     referenceSet(new MatType()), // Empty matrix.
     searchMode(mode),
     epsilon(epsilon),
+    maxBaseCases(0),
+    maxQueryTime(0.0),
+    queryCurve(tree::NO_CURVE),
     metric(metric),
     baseCases(0),
     scores(0),
-    treeNeedsReset(false)
+    stoppedQueries(0),
+    treeNeedsReset(false),
+    insertedPoints(0)
 {
   if (epsilon < 0)
     throw std::invalid_argument("epsilon must be non-negative");
 
   // Build the tree on the empty dataset, if necessary.
-  if (mode != NAIVE_MODE)
+  if (!IsNaiveMode(mode))
   {
     referenceTree = BuildTree<Tree>(*referenceSet, oldFromNewReferences);
     referenceSet = &referenceTree->Dataset();
@@ -151,10 +200,15 @@ SingleTreeTraversalType>::NeighborSearch(const NeighborSearch& other) :
         new MatType(*other.referenceSet)),
     searchMode(other.searchMode),
     epsilon(other.epsilon),
+    maxBaseCases(other.maxBaseCases),
+    maxQueryTime(other.maxQueryTime),
+    queryCurve(other.queryCurve),
     metric(other.metric),
     baseCases(other.baseCases),
     scores(other.scores),
-    treeNeedsReset(false)
+    stoppedQueries(other.stoppedQueries),
+    treeNeedsReset(false),
+    insertedPoints(other.insertedPoints)
 {
   // Nothing else to do.
 }
@@ -175,10 +229,16 @@ SingleTreeTraversalType>::NeighborSearch(NeighborSearch&& other) :
     referenceSet(other.referenceSet),
     searchMode(other.searchMode),
     epsilon(other.epsilon),
+    maxBaseCases(other.maxBaseCases),
+    maxQueryTime(other.maxQueryTime),
+    queryCurve(other.queryCurve),
     metric(std::move(other.metric)),
     baseCases(other.baseCases),
     scores(other.scores),
-    treeNeedsReset(other.treeNeedsReset)
+    stoppedQueries(other.stoppedQueries),
+    treeNeedsReset(other.treeNeedsReset),
+    insertedPoints(other.insertedPoints),
+    mappedFile(std::move(other.mappedFile))
 {
   // Clear the other model.
   other.referenceSet = new MatType();
@@ -187,9 +247,14 @@ SingleTreeTraversalType>::NeighborSearch(NeighborSearch&& other) :
   other.referenceSet = &other.referenceTree->Dataset();
   other.searchMode = DUAL_TREE_MODE,
   other.epsilon = 0.0;
+  other.maxBaseCases = 0;
+  other.maxQueryTime = 0.0;
+  other.queryCurve = tree::NO_CURVE;
   other.baseCases = 0;
   other.scores = 0;
+  other.stoppedQueries = 0;
   other.treeNeedsReset = false;
+  other.insertedPoints = 0;
 }
 
 // Copy operator.
@@ -223,16 +288,24 @@ NeighborSearch<SortPolicy,
   else
     delete referenceSet;
 
+  // The copied reference set does not live in a mapped file.
+  mappedFile.reset();
+
   oldFromNewReferences = other.oldFromNewReferences;
   referenceTree = other.referenceTree ? new Tree(*other.referenceTree) : NULL;
   referenceSet = other.referenceTree ? &referenceTree->Dataset() :
       new MatType(*other.referenceSet);
   searchMode = other.searchMode;
   epsilon = other.epsilon;
+  maxBaseCases = other.maxBaseCases;
+  maxQueryTime = other.maxQueryTime;
+  queryCurve = other.queryCurve;
   metric = other.metric;
   baseCases = other.baseCases;
   scores = other.scores;
+  stoppedQueries = other.stoppedQueries;
   treeNeedsReset = false;
+  insertedPoints = other.insertedPoints;
 }
 
 // Move operator.
@@ -271,10 +344,16 @@ NeighborSearch<SortPolicy,
   referenceSet = other.referenceSet;
   searchMode = other.searchMode;
   epsilon = other.epsilon;
+  maxBaseCases = other.maxBaseCases;
+  maxQueryTime = other.maxQueryTime;
+  queryCurve = other.queryCurve;
   metric = other.metric;
   baseCases = other.baseCases;
   scores = other.scores;
+  stoppedQueries = other.stoppedQueries;
   treeNeedsReset = other.treeNeedsReset;
+  insertedPoints = other.insertedPoints;
+  mappedFile = std::move(other.mappedFile);
 
   // Reset the other object.
   other.referenceTree = BuildTree<Tree>(*other.referenceSet,
@@ -282,9 +361,14 @@ NeighborSearch<SortPolicy,
   other.referenceSet = &other.referenceTree->Dataset();
   other.searchMode = DUAL_TREE_MODE,
   other.epsilon = 0.0;
+  other.maxBaseCases = 0;
+  other.maxQueryTime = 0.0;
+  other.queryCurve = tree::NO_CURVE;
   other.baseCases = 0;
   other.scores = 0;
+  other.stoppedQueries = 0;
   other.treeNeedsReset = false;
+  other.insertedPoints = 0;
 }
 
 // Clean memory.
@@ -327,9 +411,11 @@ DualTreeTraversalType, SingleTreeTraversalType>::Train(MatType referenceSetIn)
   {
     delete referenceSet;
   }
+  mappedFile.reset();
+  insertedPoints = 0;
 
   // We may need to rebuild the tree.
-  if (searchMode != NAIVE_MODE)
+  if (!IsNaiveMode(searchMode))
   {
     referenceTree = BuildTree<Tree>(std::move(referenceSetIn),
         oldFromNewReferences);
@@ -352,7 +438,7 @@ template<typename SortPolicy,
 void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
 DualTreeTraversalType, SingleTreeTraversalType>::Train(Tree referenceTree)
 {
-  if (searchMode == NAIVE_MODE)
+  if (IsNaiveMode(searchMode))
     throw std::invalid_argument("cannot train on given reference tree when "
         "naive search (without trees) is desired");
 
@@ -365,11 +451,128 @@ DualTreeTraversalType, SingleTreeTraversalType>::Train(Tree referenceTree)
   {
     delete this->referenceSet;
   }
+  mappedFile.reset();
+  insertedPoints = 0;
 
   this->referenceTree = new Tree(std::move(referenceTree));
   this->referenceSet = &this->referenceTree->Dataset();
 }
 
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::Insert(
+    const MatType& newPoints,
+    const double rebuildRatio,
+    const size_t maxLeafSize)
+{
+  if (newPoints.n_cols == 0)
+    return;
+
+  // There is nothing to insert into if we have no reference points yet.
+  if (referenceSet->n_cols == 0)
+  {
+    Train(newPoints);
+    return;
+  }
+
+  if (newPoints.n_rows != referenceSet->n_rows)
+    throw std::invalid_argument("NeighborSearch::Insert(): dimensionality of "
+        "new points does not match dimensionality of reference set");
+
+  if (IsNaiveMode(searchMode))
+  {
+    const MatType* newReferenceSet = new MatType(arma::join_rows(*referenceSet,
+        newPoints));
+    delete referenceSet;
+    referenceSet = newReferenceSet;
+    return;
+  }
+
+  // If the tree has received too many points since it was built, rebuild it
+  // from all of the points, in their original order.
+  const size_t oldSize = referenceSet->n_cols;
+  const size_t builtPoints = oldSize - insertedPoints;
+  if ((double) (insertedPoints + newPoints.n_cols) >
+      rebuildRatio * (double) builtPoints)
+  {
+    MatType dataset(referenceSet->n_rows, oldSize + newPoints.n_cols);
+    if (oldFromNewReferences.size() == oldSize)
+    {
+      for (size_t i = 0; i < oldSize; ++i)
+        dataset.col(oldFromNewReferences[i]) = referenceSet->col(i);
+    }
+    else
+    {
+      dataset.cols(0, oldSize - 1) = *referenceSet;
+    }
+    dataset.cols(oldSize, dataset.n_cols - 1) = newPoints;
+
+    Train(std::move(dataset));
+    return;
+  }
+
+  referenceTree->Insert(newPoints, oldFromNewReferences, maxLeafSize);
+  referenceSet = &referenceTree->Dataset();
+  insertedPoints += newPoints.n_cols;
+
+  // The tree now has its own copy of the dataset, so a mapped file is not
+  // needed anymore.
+  mappedFile.reset();
+
+  // The statistics were rebuilt by the insertion.
+  treeNeedsReset = false;
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::Refit(
+    const MatType& newReferenceSet)
+{
+  if (newReferenceSet.n_rows != referenceSet->n_rows ||
+      newReferenceSet.n_cols != referenceSet->n_cols)
+    throw std::invalid_argument("NeighborSearch::Refit(): size of new "
+        "reference set does not match size of reference set");
+
+  // Without a tree there is nothing to refit, and a tree that lives in a
+  // mapped file can't be overwritten.
+  if (IsNaiveMode(searchMode) || mappedFile)
+  {
+    Train(newReferenceSet);
+    return;
+  }
+
+  // Write the new points in the order of the tree.
+  MatType& dataset = referenceTree->Dataset();
+  if (oldFromNewReferences.size() == dataset.n_cols)
+  {
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+      dataset.col(i) = newReferenceSet.col(oldFromNewReferences[i]);
+  }
+  else
+  {
+    dataset = newReferenceSet;
+  }
+
+  referenceTree->Refit();
+
+  // The statistics were rebuilt by the refit.
+  treeNeedsReset = false;
+}
+
 /**
  * Computes the best neighbors and stores them in resultingNeighbors and
  * distances.
@@ -398,9 +601,13 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   }
 
   Timer::Start("computing_neighbors");
+  arma::wall_clock searchTimer;
+  searchTimer.tic();
 
   baseCases = 0;
   scores = 0;
+  stoppedQueries = 0;
+  statistics.Reset();
 
   // This will hold mappings for query points, if necessary.
   std::vector<size_t> oldFromNewQueries;
@@ -428,6 +635,13 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   neighborPtr->set_size(k, querySet.n_cols);
   distancePtr->set_size(k, querySet.n_cols);
 
+  // The single-tree modes may visit the query points along a space-filling
+  // curve.  Each result is still written to the column of its query point.
+  std::vector<size_t> queryOrder;
+  if (searchMode == SINGLE_TREE_MODE || searchMode == GREEDY_SINGLE_TREE_MODE ||
+      searchMode == BEST_FIRST_SINGLE_TREE_MODE)
+    tree::SpaceFillingCurveOrder(querySet, queryCurve, queryOrder);
+
   typedef NeighborSearchRules<SortPolicy, MetricType, Tree> RuleType;
 
   switch (searchMode)
@@ -447,27 +661,53 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       rules.GetResults(*neighborPtr, *distancePtr);
       break;
     }
-    case SINGLE_TREE_MODE:
+    case BLOCKED_NAIVE_MODE:
     {
-      // Create the helper object for the tree traversal.
       RuleType rules(*referenceSet, querySet, k, metric, epsilon);
+      BlockedNaiveSearch(rules, querySet.n_cols, *neighborPtr, *distancePtr);
+      break;
+    }
+    case SINGLE_TREE_MODE:
+    {
+      // The search for each query point is independent, so each thread gets
+      // its own rules and writes the results of its query points directly.
+      // Trees whose first point is the centroid cache base cases in the
+      // statistics of the reference tree, so those must be searched serially.
+      size_t treeScores = 0;
+      size_t treeBaseCases = 0;
+      #pragma omp parallel if (!tree::TreeTraits<Tree>::FirstPointIsCentroid) \
+          reduction(+:treeScores, treeBaseCases)
+      {
+        // Create the helper object for the tree traversal.
+        RuleType rules(*referenceSet, querySet, k, metric, epsilon);
+        rules.Statistics().Enabled() = statistics.Enabled();
 
-      // Create the traverser.
-      SingleTreeTraversalType<RuleType> traverser(rules);
+        // Create the traverser.
+        SingleTreeTraversalType<RuleType> traverser(rules);
 
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < querySet.n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+        // Now have it traverse for each point.
+        #pragma omp for schedule(dynamic)
+        for (omp_size_t i = 0; i < (omp_size_t) querySet.n_cols; ++i)
+        {
+          const size_t queryIndex = queryOrder.empty() ? i : queryOrder[i];
+          traverser.Traverse(queryIndex, *referenceTree);
+          rules.GetResults(queryIndex, *neighborPtr, *distancePtr);
+        }
 
-      scores += rules.Scores();
-      baseCases += rules.BaseCases();
+        treeScores += rules.Scores();
+        treeBaseCases += rules.BaseCases();
 
-      Log::Info << rules.Scores() << " node combinations were scored."
+        #pragma omp critical
+        statistics.Merge(rules.Statistics());
+      }
+
+      scores += treeScores;
+      baseCases += treeBaseCases;
+
+      Log::Info << treeScores << " node combinations were scored."
           << std::endl;
-      Log::Info << rules.BaseCases() << " base cases were calculated."
+      Log::Info << treeBaseCases << " base cases were calculated."
           << std::endl;
-
-      rules.GetResults(*neighborPtr, *distancePtr);
       break;
     }
     case DUAL_TREE_MODE:
@@ -475,17 +715,21 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       // Build the query tree.
       Timer::Stop("computing_neighbors");
       Timer::Start("tree_building");
+      arma::wall_clock treeTimer;
+      treeTimer.tic();
       Tree* queryTree = BuildTree<Tree>(querySet, oldFromNewQueries);
+      statistics.TreeBuildingTime() = treeTimer.toc();
       Timer::Stop("tree_building");
       Timer::Start("computing_neighbors");
 
       // Create the helper object for the tree traversal.
       RuleType rules(*referenceSet, queryTree->Dataset(), k, metric, epsilon);
+      rules.Statistics().Enabled() = statistics.Enabled();
 
-      // Create the traverser.
-      DualTreeTraversalType<RuleType> traverser(rules);
-
-      traverser.Traverse(*queryTree, *referenceTree);
+      // Run the traversal, in parallel if possible.
+      DualTreeTraversal<DualTreeTraversalType<RuleType>>(rules, *queryTree,
+          *referenceTree);
+      statistics.Merge(rules.Statistics());
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
@@ -502,33 +746,102 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     }
     case GREEDY_SINGLE_TREE_MODE:
     {
-      // Create the helper object for the tree traversal.
-      RuleType rules(*referenceSet, querySet, k, metric);
+      // Greedy (defeatist) queries are independent too, so they are run in
+      // parallel in the same way as single-tree queries.
+      size_t treeScores = 0;
+      size_t treeBaseCases = 0;
+      #pragma omp parallel if (!tree::TreeTraits<Tree>::FirstPointIsCentroid) \
+          reduction(+:treeScores, treeBaseCases)
+      {
+        // Create the helper object for the tree traversal.
+        RuleType rules(*referenceSet, querySet, k, metric);
+        rules.Statistics().Enabled() = statistics.Enabled();
 
-      // Create the traverser.
-      tree::GreedySingleTreeTraverser<Tree, RuleType> traverser(rules);
+        // Create the traverser.
+        tree::GreedySingleTreeTraverser<Tree, RuleType> traverser(rules);
 
-      // Set the value of minBaseCases.
-      traverser.MinBaseCases() = k;
+        // Set the value of minBaseCases.
+        traverser.MinBaseCases() = k;
 
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < querySet.n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+        // Now have it traverse for each point.
+        #pragma omp for schedule(dynamic)
+        for (omp_size_t i = 0; i < (omp_size_t) querySet.n_cols; ++i)
+        {
+          const size_t queryIndex = queryOrder.empty() ? i : queryOrder[i];
+          traverser.Traverse(queryIndex, *referenceTree);
+          rules.GetResults(queryIndex, *neighborPtr, *distancePtr);
+        }
 
-      scores += rules.Scores();
-      baseCases += rules.BaseCases();
+        treeScores += rules.Scores();
+        treeBaseCases += rules.BaseCases();
 
-      Log::Info << rules.Scores() << " node combinations were scored."
+        #pragma omp critical
+        statistics.Merge(rules.Statistics());
+      }
+
+      scores += treeScores;
+      baseCases += treeBaseCases;
+
+      Log::Info << treeScores << " node combinations were scored."
           << std::endl;
-      Log::Info << rules.BaseCases() << " base cases were calculated."
+      Log::Info << treeBaseCases << " base cases were calculated."
           << std::endl;
+      break;
+    }
+    case BEST_FIRST_SINGLE_TREE_MODE:
+    {
+      // Best-first queries are independent too, so they are run in parallel in
+      // the same way as single-tree queries.
+      size_t treeScores = 0;
+      size_t treeBaseCases = 0;
+      size_t treeStopped = 0;
+      #pragma omp parallel if (!tree::TreeTraits<Tree>::FirstPointIsCentroid) \
+          reduction(+:treeScores, treeBaseCases, treeStopped)
+      {
+        // Create the helper object for the tree traversal.
+        RuleType rules(*referenceSet, querySet, k, metric, epsilon);
+        rules.Statistics().Enabled() = statistics.Enabled();
+
+        // Create the traverser, which runs enough base cases to find k
+        // neighbors.
+        tree::BestFirstSingleTreeTraverser<Tree, RuleType> traverser(rules);
+        traverser.MinBaseCases() = k;
+        traverser.MaxBaseCases() = maxBaseCases;
+        traverser.MaxTime() = maxQueryTime;
+
+        // Now have it traverse for each point.
+        #pragma omp for schedule(dynamic)
+        for (omp_size_t i = 0; i < (omp_size_t) querySet.n_cols; ++i)
+        {
+          const size_t queryIndex = queryOrder.empty() ? i : queryOrder[i];
+          traverser.Traverse(queryIndex, *referenceTree);
+          rules.GetResults(queryIndex, *neighborPtr, *distancePtr);
+        }
 
-      rules.GetResults(*neighborPtr, *distancePtr);
+        treeScores += rules.Scores();
+        treeBaseCases += rules.BaseCases();
+        treeStopped += traverser.NumStopped();
+
+        #pragma omp critical
+        statistics.Merge(rules.Statistics());
+      }
+
+      scores += treeScores;
+      baseCases += treeBaseCases;
+      stoppedQueries += treeStopped;
+
+      Log::Info << treeScores << " node combinations were scored."
+          << std::endl;
+      Log::Info << treeBaseCases << " base cases were calculated."
+          << std::endl;
+      Log::Info << treeStopped << " queries were stopped by the search budget."
+          << std::endl;
       break;
     }
   }
 
   Timer::Stop("computing_neighbors");
+  RecordStatistics(searchTimer.toc());
 
   // Map points back to original indices, if necessary.
   if (tree::TreeTraits<Tree>::RearrangesDataset)
@@ -620,9 +933,13 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
         "query tree when naive or singleMode are set to true");
 
   Timer::Start("computing_neighbors");
+  arma::wall_clock searchTimer;
+  searchTimer.tic();
 
   baseCases = 0;
   scores = 0;
+  stoppedQueries = 0;
+  statistics.Reset();
 
   // Get a reference to the query set.
   const MatType& querySet = queryTree.Dataset();
@@ -640,10 +957,12 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   // Create the helper object for the traversal.
   typedef NeighborSearchRules<SortPolicy, MetricType, Tree> RuleType;
   RuleType rules(*referenceSet, querySet, k, metric, epsilon, sameSet);
+  rules.Statistics().Enabled() = statistics.Enabled();
 
-  // Create the traverser.
-  DualTreeTraversalType<RuleType> traverser(rules);
-  traverser.Traverse(queryTree, *referenceTree);
+  // Run the traversal, in parallel if possible.
+  DualTreeTraversal<DualTreeTraversalType<RuleType>>(rules, queryTree,
+      *referenceTree);
+  statistics.Merge(rules.Statistics());
 
   scores += rules.Scores();
   baseCases += rules.BaseCases();
@@ -657,6 +976,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   Log::Info << rules.BaseCases() << " base cases were calculated.\n";
 
   Timer::Stop("computing_neighbors");
+  RecordStatistics(searchTimer.toc());
 
   // Do we need to map indices?
   if (!oldFromNewReferences.empty() &&
@@ -706,9 +1026,13 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   }
 
   Timer::Start("computing_neighbors");
+  arma::wall_clock searchTimer;
+  searchTimer.tic();
 
   baseCases = 0;
   scores = 0;
+  stoppedQueries = 0;
+  statistics.Reset();
 
   arma::Mat<size_t>* neighborPtr = &neighbors;
   arma::mat* distancePtr = &distances;
@@ -729,6 +1053,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   typedef NeighborSearchRules<SortPolicy, MetricType, Tree> RuleType;
   RuleType rules(*referenceSet, *referenceSet, k, metric, epsilon,
       true /* don't return the same point as nearest neighbor */);
+  rules.Statistics().Enabled() = statistics.Enabled();
 
   switch (searchMode)
   {
@@ -742,21 +1067,49 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       baseCases += referenceSet->n_cols * referenceSet->n_cols;
       break;
     }
+    case BLOCKED_NAIVE_MODE:
+    {
+      BlockedNaiveSearch(rules, referenceSet->n_cols, *neighborPtr,
+          *distancePtr);
+      break;
+    }
     case SINGLE_TREE_MODE:
     {
-      // Create the traverser.
-      SingleTreeTraversalType<RuleType> traverser(rules);
+      // The search for each point is independent, so each thread gets its own
+      // copy of the rules and writes the results of its points directly.
+      // Trees whose first point is the centroid cache base cases in the
+      // statistics of the reference tree, so those must be searched serially.
+      size_t treeScores = 0;
+      size_t treeBaseCases = 0;
+      #pragma omp parallel if (!tree::TreeTraits<Tree>::FirstPointIsCentroid) \
+          reduction(+:treeScores, treeBaseCases)
+      {
+        RuleType threadRules(rules);
 
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < referenceSet->n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+        // Create the traverser.
+        SingleTreeTraversalType<RuleType> traverser(threadRules);
 
-      scores += rules.Scores();
-      baseCases += rules.BaseCases();
+        // Now have it traverse for each point.
+        #pragma omp for schedule(dynamic)
+        for (omp_size_t i = 0; i < (omp_size_t) referenceSet->n_cols; ++i)
+        {
+          traverser.Traverse(i, *referenceTree);
+          threadRules.GetResults(i, *neighborPtr, *distancePtr);
+        }
 
-      Log::Info << rules.Scores() << " node combinations were scored."
+        treeScores += threadRules.Scores();
+        treeBaseCases += threadRules.BaseCases();
+
+        #pragma omp critical
+        statistics.Merge(threadRules.Statistics());
+      }
+
+      scores += treeScores;
+      baseCases += treeBaseCases;
+
+      Log::Info << treeScores << " node combinations were scored."
           << std::endl;
-      Log::Info << rules.BaseCases() << " base cases were calculated."
+      Log::Info << treeBaseCases << " base cases were calculated."
           << std::endl;
       break;
     }
@@ -782,19 +1135,19 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
         }
       }
 
-      // Create the traverser.
-      DualTreeTraversalType<RuleType> traverser(rules);
-
       if (tree::IsSpillTree<Tree>::value)
       {
         // For Dual Tree Search on SpillTree, the queryTree must be built with
         // non overlapping (tau = 0).
         Tree queryTree(*referenceSet);
+        DualTreeTraversalType<RuleType> traverser(rules);
         traverser.Traverse(queryTree, *referenceTree);
       }
       else
       {
-        traverser.Traverse(*referenceTree, *referenceTree);
+        // Run the traversal, in parallel if possible.
+        DualTreeTraversal<DualTreeTraversalType<RuleType>>(rules,
+            *referenceTree, *referenceTree);
         // Next time we perform this search, we'll need to reset the tree.
         treeNeedsReset = true;
       }
@@ -813,30 +1166,105 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     }
     case GREEDY_SINGLE_TREE_MODE:
     {
-      // Create the traverser.
-      tree::GreedySingleTreeTraverser<Tree, RuleType> traverser(rules);
+      // Greedy (defeatist) queries are independent too, so they are run in
+      // parallel in the same way as single-tree queries.
+      size_t treeScores = 0;
+      size_t treeBaseCases = 0;
+      #pragma omp parallel if (!tree::TreeTraits<Tree>::FirstPointIsCentroid) \
+          reduction(+:treeScores, treeBaseCases)
+      {
+        RuleType threadRules(rules);
 
-      // Set the value of minBaseCases.
-      traverser.MinBaseCases() = k;
+        // Create the traverser.
+        tree::GreedySingleTreeTraverser<Tree, RuleType> traverser(threadRules);
 
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < referenceSet->n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+        // Set the value of minBaseCases.
+        traverser.MinBaseCases() = k;
 
-      scores += rules.Scores();
-      baseCases += rules.BaseCases();
+        // Now have it traverse for each point.
+        #pragma omp for schedule(dynamic)
+        for (omp_size_t i = 0; i < (omp_size_t) referenceSet->n_cols; ++i)
+        {
+          traverser.Traverse(i, *referenceTree);
+          threadRules.GetResults(i, *neighborPtr, *distancePtr);
+        }
 
-      Log::Info << rules.Scores() << " node combinations were scored."
+        treeScores += threadRules.Scores();
+        treeBaseCases += threadRules.BaseCases();
+
+        #pragma omp critical
+        statistics.Merge(threadRules.Statistics());
+      }
+
+      scores += treeScores;
+      baseCases += treeBaseCases;
+
+      Log::Info << treeScores << " node combinations were scored."
           << std::endl;
-      Log::Info << rules.BaseCases() << " base cases were calculated."
+      Log::Info << treeBaseCases << " base cases were calculated."
+          << std::endl;
+      break;
+    }
+    case BEST_FIRST_SINGLE_TREE_MODE:
+    {
+      // Best-first queries are run in parallel in the same way as single-tree
+      // queries.
+      size_t treeScores = 0;
+      size_t treeBaseCases = 0;
+      size_t treeStopped = 0;
+      #pragma omp parallel if (!tree::TreeTraits<Tree>::FirstPointIsCentroid) \
+          reduction(+:treeScores, treeBaseCases, treeStopped)
+      {
+        RuleType threadRules(rules);
+
+        // Create the traverser.  The base case of each point with itself is
+        // skipped, so one more base case is needed to find k neighbors.
+        tree::BestFirstSingleTreeTraverser<Tree, RuleType>
+            traverser(threadRules);
+        traverser.MinBaseCases() = k + 1;
+        traverser.MaxBaseCases() = maxBaseCases;
+        traverser.MaxTime() = maxQueryTime;
+
+        // Now have it traverse for each point.
+        #pragma omp for schedule(dynamic)
+        for (omp_size_t i = 0; i < (omp_size_t) referenceSet->n_cols; ++i)
+        {
+          traverser.Traverse(i, *referenceTree);
+          threadRules.GetResults(i, *neighborPtr, *distancePtr);
+        }
+
+        treeScores += threadRules.Scores();
+        treeBaseCases += threadRules.BaseCases();
+        treeStopped += traverser.NumStopped();
+
+        #pragma omp critical
+        statistics.Merge(threadRules.Statistics());
+      }
+
+      scores += treeScores;
+      baseCases += treeBaseCases;
+      stoppedQueries += treeStopped;
+
+      Log::Info << treeScores << " node combinations were scored."
+          << std::endl;
+      Log::Info << treeBaseCases << " base cases were calculated."
+          << std::endl;
+      Log::Info << treeStopped << " queries were stopped by the search budget."
           << std::endl;
       break;
     }
   }
 
-  rules.GetResults(*neighborPtr, *distancePtr);
+  // In single-tree, greedy single-tree, best-first and blocked naive mode, the
+  // results have already been stored.
+  if (searchMode != SINGLE_TREE_MODE && searchMode != BLOCKED_NAIVE_MODE &&
+      searchMode != GREEDY_SINGLE_TREE_MODE &&
+      searchMode != BEST_FIRST_SINGLE_TREE_MODE)
+    rules.GetResults(*neighborPtr, *distancePtr);
+  statistics.Merge(rules.Statistics());
 
   Timer::Stop("computing_neighbors");
+  RecordStatistics(searchTimer.toc());
 
   // Do we need to map the reference indices?
   if (!oldFromNewReferences.empty() &&
@@ -862,6 +1290,139 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   }
 }
 
+//! Store the totals of the last search in the traversal statistics.
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::RecordStatistics(
+    const double searchTime)
+{
+  statistics.BaseCases() = baseCases;
+  statistics.Scores() = scores;
+  statistics.TraversalTime() = searchTime - statistics.TreeBuildingTime();
+
+  if (statistics.Enabled())
+    statistics.Report();
+}
+
+//! Compute all base cases one block of points at a time.
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+template<typename RuleType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::BlockedNaiveSearch(
+    const RuleType& rules,
+    const size_t numQueries,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances)
+{
+  const size_t numReferences = referenceSet->n_cols;
+  const size_t numBlocks = (numQueries + QueryBlockSize - 1) / QueryBlockSize;
+
+  // Each block of query points is independent.  Inside a block, the rules'
+  // BaseCaseBlock() computes the distances to each block of reference points
+  // at once, and only the pairs that can enter the current candidate lists are
+  // inserted; so after the first few reference blocks most pairs are skipped.
+  size_t blockBaseCases = 0;
+  #pragma omp parallel reduction(+:blockBaseCases)
+  {
+    RuleType threadRules(rules);
+
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+    {
+      const size_t queryBegin = b * QueryBlockSize;
+      const size_t queryEnd = (queryBegin + QueryBlockSize < numQueries) ?
+          queryBegin + QueryBlockSize : numQueries;
+      const arma::uvec queryIndices = arma::regspace<arma::uvec>(queryBegin,
+          queryEnd - 1);
+
+      for (size_t r = 0; r < numReferences; r += ReferenceBlockSize)
+      {
+        const size_t count = (r + ReferenceBlockSize < numReferences) ?
+            ReferenceBlockSize : numReferences - r;
+        threadRules.BaseCaseBlock(queryIndices, r, count);
+      }
+
+      for (size_t i = queryBegin; i < queryEnd; ++i)
+        threadRules.GetResults(i, neighbors, distances);
+    }
+
+    blockBaseCases += threadRules.BaseCases();
+  }
+
+  baseCases += blockBaseCases;
+  Log::Info << blockBaseCases << " base cases were calculated." << std::endl;
+}
+
+//! Save the reference tree in flat format.
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::SaveFlat(
+    const std::string& filename) const
+{
+  if (IsNaiveMode(searchMode))
+    throw std::invalid_argument("cannot save a flat reference tree when naive "
+        "search (without trees) is used");
+
+  tree::FlatTreeIO::Save(filename, *referenceTree, oldFromNewReferences);
+}
+
+//! Load the reference tree from a flat tree file.
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::LoadFlat(
+    const std::string& filename)
+{
+  if (IsNaiveMode(searchMode))
+    throw std::invalid_argument("cannot load a flat reference tree when naive "
+        "search (without trees) is used");
+
+  // Map the new file and build the tree before releasing the old one, so that
+  // we are left unchanged if the file is invalid.
+  std::shared_ptr<util::MappedFile> newFile(new util::MappedFile(filename));
+  std::vector<size_t> newOldFromNew;
+  Tree* newTree = tree::FlatTreeIO::Load<Tree>(*newFile, newOldFromNew);
+
+  if (referenceTree)
+    delete referenceTree;
+  else
+    delete referenceSet;
+
+  referenceTree = newTree;
+  referenceSet = &referenceTree->Dataset();
+  oldFromNewReferences = std::move(newOldFromNew);
+  mappedFile = std::move(newFile);
+  treeNeedsReset = false;
+  insertedPoints = 0;
+}
+
 //! Calculate the average relative error.
 template<typename SortPolicy,
          typename MetricType,
@@ -952,7 +1513,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::serialize(
 
   // If we are doing naive search, we serialize the dataset.  Otherwise we
   // serialize the tree.
-  if (searchMode == NAIVE_MODE)
+  if (IsNaiveMode(searchMode))
   {
     // Delete the current reference set, if necessary and if we are loading.
     if (Archive::is_loading::value && referenceSet)
@@ -993,11 +1554,15 @@ DualTreeTraversalType, SingleTreeTraversalType>::serialize(
     }
   }
 
-  // Reset base cases and scores.
+  // Reset base cases and scores.  The loaded reference set never lives in a
+  // mapped file.
   if (Archive::is_loading::value)
   {
     baseCases = 0;
     scores = 0;
+    stoppedQueries = 0;
+    insertedPoints = 0;
+    mappedFile.reset();
   }
 }
 
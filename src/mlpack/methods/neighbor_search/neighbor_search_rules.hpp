@@ -14,12 +14,32 @@
 #define MLPACK_METHODS_NEIGHBOR_SEARCH_NEIGHBOR_SEARCH_RULES_HPP
 
 #include <mlpack/core/tree/traversal_info.hpp>
-
-#include <queue>
+#include <mlpack/core/tree/traversal_statistics.hpp>
+#include <mlpack/core/tree/hrectbound.hpp>
+#include "candidate_lists.hpp"
 
 namespace mlpack {
 namespace neighbor {
 
+/**
+ * Whether MetricType::EvaluateBlock() is faster than calling Evaluate() for
+ * each pair, which is only the case for the squared-L2 and L2 LMetrics (see
+ * LMetric::EvaluateBlock()).
+ */
+template<typename MetricType,
+         bool IsLMetric = bound::meta::IsLMetric<MetricType>::Value>
+struct HasFastEvaluateBlock
+{
+  static const bool Value = false;
+};
+
+//! Specialization for LMetrics: only the power 2 has a fast block evaluation.
+template<typename MetricType>
+struct HasFastEvaluateBlock<MetricType, true>
+{
+  static const bool Value = (MetricType::Power == 2);
+};
+
 /**
  * The NeighborSearchRules class is a template helper class used by
  * NeighborSearch class when performing distance-based neighbor searches.  For
@@ -63,6 +83,35 @@ class NeighborSearchRules
    */
   void GetResults(arma::Mat<size_t>& neighbors, arma::mat& distances);
 
+  /**
+   * Store the list of candidates for a single query point in the given column
+   * of the given matrices, which must already have the right size.  Since only
+   * one column is written, different rules objects can write the results of
+   * different query points into the same matrices at the same time.  The list
+   * of candidates for that query point is reset.
+   *
+   * @param queryIndex Index of query point to store the results of.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *     point.
+   */
+  void GetResults(const size_t queryIndex,
+                  arma::Mat<size_t>& neighbors,
+                  arma::mat& distances);
+
+  /**
+   * Merge the candidates found by another NeighborSearchRules object (usually a
+   * per-thread copy of this one) for all descendants of the given query nodes
+   * into this object's candidate lists.  The number of base cases and scores
+   * of the other object are added to ours.  This is used by
+   * tree::ParallelDualTreeTraverser.
+   *
+   * @param other Rules object to take candidates from.
+   * @param queryNodes Query nodes whose descendants were searched by 'other'.
+   */
+  void Merge(const NeighborSearchRules& other,
+             const std::vector<TreeType*>& queryNodes);
+
   /**
    * Get the distance from the query point to the reference point.
    * This will update the list of candidates with the new point if appropriate
@@ -73,6 +122,24 @@ class NeighborSearchRules
    */
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
+  /**
+   * Compute the base cases between each of the given query points and each of
+   * the reference points in [referenceBegin, referenceBegin + referenceCount)
+   * at once.  This is used by the traversers of the BinarySpaceTree when both
+   * nodes are leaves.  If the metric is the L2 (or squared L2) LMetric and the
+   * data is dense, all the distances are computed with
+   * LMetric::EvaluateBlock(), and only the pairs that may enter the list of
+   * candidates are computed again exactly with BaseCase(); so the results are
+   * the same as calling BaseCase() for every pair.
+   *
+   * @param queryIndices Indices of query points.
+   * @param referenceBegin Index of the first reference point.
+   * @param referenceCount Number of reference points.
+   */
+  void BaseCaseBlock(const arma::uvec& queryIndices,
+                     const size_t referenceBegin,
+                     const size_t referenceCount);
+
   /**
    * Get the score for recursion order.  A low score indicates priority for
    * recursion, while DBL_MAX indicates that the node should not be recursed
@@ -149,6 +216,11 @@ class NeighborSearchRules
   //! Modify the number of scores that have been performed.
   size_t& Scores() { return scores; }
 
+  //! Get the detailed traversal statistics.
+  const tree::TraversalStatistics& Statistics() const { return statistics; }
+  //! Modify the detailed traversal statistics.
+  tree::TraversalStatistics& Statistics() { return statistics; }
+
   //! Convenience typedef.
   typedef typename tree::TraversalInfo<TreeType> TraversalInfoType;
 
@@ -164,23 +236,8 @@ class NeighborSearchRules
   //! The query set.
   const typename TreeType::Mat& querySet;
 
-  //! Candidate represents a possible candidate neighbor (distance, index).
-  typedef std::pair<double, size_t> Candidate;
-
-  //! Compare two candidates based on the distance.
-  struct CandidateCmp {
-    bool operator()(const Candidate& c1, const Candidate& c2)
-    {
-      return !SortPolicy::IsBetter(c2.first, c1.first);
-    };
-  };
-
-  //! Use a priority queue to represent the list of candidate neighbors.
-  typedef std::priority_queue<Candidate, std::vector<Candidate>, CandidateCmp>
-      CandidateList;
-
   //! Set of candidate neighbors for each point.
-  std::vector<CandidateList> candidates;
+  CandidateLists<SortPolicy> candidates;
 
   //! Number of neighbors to search for.
   const size_t k;
@@ -210,6 +267,10 @@ class NeighborSearchRules
   //! traversal before each call to Score().
   TraversalInfoType traversalInfo;
 
+  //! Detailed traversal statistics (only collected if enabled).  Rescore() is
+  //! const, so this is mutable.
+  mutable tree::TraversalStatistics statistics;
+
   /**
    * Recalculate the bound for a given query node.
    */
@@ -225,6 +286,26 @@ class NeighborSearchRules
   void InsertNeighbor(const size_t queryIndex,
                       const size_t neighbor,
                       const double distance);
+
+  //! Whether BaseCaseBlock() can compute distances with
+  //! MetricType::EvaluateBlock().
+  static const bool UseEvaluateBlock =
+      HasFastEvaluateBlock<MetricType>::Value &&
+      !arma::is_arma_sparse_type<typename TreeType::Mat>::value;
+
+  //! Compute a block of base cases with MetricType::EvaluateBlock().
+  template<bool UseBlock = UseEvaluateBlock>
+  void BaseCaseBlockImpl(const arma::uvec& queryIndices,
+                         const size_t referenceBegin,
+                         const size_t referenceCount,
+                         const typename std::enable_if_t<UseBlock>* = 0);
+
+  //! Compute a block of base cases one pair at a time.
+  template<bool UseBlock = UseEvaluateBlock>
+  void BaseCaseBlockImpl(const arma::uvec& queryIndices,
+                         const size_t referenceBegin,
+                         const size_t referenceCount,
+                         const typename std::enable_if_t<!UseBlock>* = 0);
 };
 
 } // namespace neighbor
@@ -29,6 +29,7 @@ NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
     const bool sameSet) :
     referenceSet(referenceSet),
     querySet(querySet),
+    candidates(k, querySet.n_cols),
     k(k),
     metric(metric),
     sameSet(sameSet),
@@ -44,19 +45,9 @@ NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
   traversalInfo.LastQueryNode() = (TreeType*) this;
   traversalInfo.LastReferenceNode() = (TreeType*) this;
 
-  // Let's build the list of candidate neighbors for each query point.
-  // It will be initialized with k candidates: (WorstDistance, size_t() - 1)
-  // The list of candidates will be updated when visiting new points with the
-  // BaseCase() method.
-  const Candidate def = std::make_pair(SortPolicy::WorstDistance(),
-      size_t() - 1);
-
-  std::vector<Candidate> vect(k, def);
-  CandidateList pqueue(CandidateCmp(), std::move(vect));
-
-  candidates.reserve(querySet.n_cols);
-  for (size_t i = 0; i < querySet.n_cols; i++)
-    candidates.push_back(pqueue);
+  // The list of candidate neighbors of each query point starts with k
+  // candidates (WorstDistance, size_t() - 1), and is updated when visiting new
+  // points with the BaseCase() method.
 }
 
 template<typename SortPolicy, typename MetricType, typename TreeType>
@@ -68,16 +59,44 @@ void NeighborSearchRules<SortPolicy, MetricType, TreeType>::GetResults(
   distances.set_size(k, querySet.n_cols);
 
   for (size_t i = 0; i < querySet.n_cols; i++)
+    GetResults(i, neighbors, distances);
+};
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void NeighborSearchRules<SortPolicy, MetricType, TreeType>::GetResults(
+    const size_t queryIndex,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances)
+{
+  candidates.Extract(queryIndex, neighbors, distances, queryIndex);
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void NeighborSearchRules<SortPolicy, MetricType, TreeType>::Merge(
+    const NeighborSearchRules& other,
+    const std::vector<TreeType*>& queryNodes)
+{
+  for (size_t i = 0; i < queryNodes.size(); ++i)
   {
-    CandidateList& pqueue = candidates[i];
-    for (size_t j = 1; j <= k; j++)
+    for (size_t j = 0; j < queryNodes[i]->NumDescendants(); ++j)
     {
-      neighbors(k - j, i) = pqueue.top().second;
-      distances(k - j, i) = pqueue.top().first;
-      pqueue.pop();
+      const size_t queryIndex = queryNodes[i]->Descendant(j);
+
+      for (size_t l = 0; l < k; ++l)
+      {
+        // Skip placeholder candidates that were never filled.
+        const size_t neighbor = other.candidates.Index(queryIndex, l);
+        if (neighbor != size_t() - 1)
+          InsertNeighbor(queryIndex, neighbor,
+              other.candidates.Distance(queryIndex, l));
+      }
     }
   }
-};
+
+  baseCases += other.baseCases;
+  scores += other.scores;
+  statistics.Merge(other.statistics);
+}
 
 template<typename SortPolicy, typename MetricType, typename TreeType>
 inline force_inline // Absolutely MUST be inline so optimizations can happen.
@@ -107,6 +126,81 @@ BaseCase(const size_t queryIndex, const size_t referenceIndex)
   return distance;
 }
 
+template<typename SortPolicy, typename MetricType, typename TreeType>
+inline void NeighborSearchRules<SortPolicy, MetricType, TreeType>::
+BaseCaseBlock(const arma::uvec& queryIndices,
+              const size_t referenceBegin,
+              const size_t referenceCount)
+{
+  if (queryIndices.n_elem == 0 || referenceCount == 0)
+    return;
+
+  BaseCaseBlockImpl(queryIndices, referenceBegin, referenceCount);
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+template<bool UseBlock>
+inline void NeighborSearchRules<SortPolicy, MetricType, TreeType>::
+BaseCaseBlockImpl(const arma::uvec& queryIndices,
+                  const size_t referenceBegin,
+                  const size_t referenceCount,
+                  const typename std::enable_if_t<UseBlock>*)
+{
+  typedef typename TreeType::Mat::elem_type ElemType;
+
+  // Compute all of the distances at once.  They may be off by a little bit, so
+  // any pair that might improve the candidates of its query point is computed
+  // again exactly.  In most leaf combinations only a few pairs do.  If the
+  // distances are exact, they are used directly.
+  const arma::Mat<ElemType> queries = querySet.cols(queryIndices);
+  arma::Mat<ElemType> distances;
+  const double tolerance = MetricType::EvaluateBlock(queries,
+      referenceSet.cols(referenceBegin, referenceBegin + referenceCount - 1),
+      distances);
+
+  for (size_t i = 0; i < queryIndices.n_elem; ++i)
+  {
+    const size_t queryIndex = queryIndices[i];
+    for (size_t j = 0; j < referenceCount; ++j)
+    {
+      const double bestDistance = SortPolicy::CombineBest(distances(i, j),
+          tolerance);
+      if (SortPolicy::IsBetter(candidates.Worst(queryIndex), bestDistance))
+      {
+        // This point cannot be inserted, but the base case was still done.
+        ++baseCases;
+        continue;
+      }
+
+      if (tolerance == 0.0)
+      {
+        if (!sameSet || queryIndex != referenceBegin + j)
+        {
+          ++baseCases;
+          InsertNeighbor(queryIndex, referenceBegin + j, distances(i, j));
+        }
+        continue;
+      }
+
+      BaseCase(queryIndex, referenceBegin + j);
+    }
+  }
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+template<bool UseBlock>
+inline void NeighborSearchRules<SortPolicy, MetricType, TreeType>::
+BaseCaseBlockImpl(const arma::uvec& queryIndices,
+                  const size_t referenceBegin,
+                  const size_t referenceCount,
+                  const typename std::enable_if_t<!UseBlock>*)
+{
+  const size_t referenceEnd = referenceBegin + referenceCount;
+  for (size_t i = 0; i < queryIndices.n_elem; ++i)
+    for (size_t ref = referenceBegin; ref < referenceEnd; ++ref)
+      BaseCase(queryIndices[i], ref);
+}
+
 template<typename SortPolicy, typename MetricType, typename TreeType>
 inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Score(
     const size_t queryIndex,
@@ -143,11 +237,12 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Score(
   }
 
   // Compare against the best k'th distance for this query point so far.
-  double bestDistance = candidates[queryIndex].top().first;
+  double bestDistance = candidates.Worst(queryIndex);
   bestDistance = SortPolicy::Relax(bestDistance, epsilon);
 
-  return (SortPolicy::IsBetter(distance, bestDistance)) ?
-      SortPolicy::ConvertToScore(distance) : DBL_MAX;
+  return statistics.Score(referenceNode,
+      (SortPolicy::IsBetter(distance, bestDistance)) ?
+      SortPolicy::ConvertToScore(distance) : DBL_MAX);
 }
 
 template<typename SortPolicy, typename MetricType, typename TreeType>
@@ -179,10 +274,11 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Rescore(
   const double distance = SortPolicy::ConvertToDistance(oldScore);
 
   // Just check the score again against the distances.
-  double bestDistance = candidates[queryIndex].top().first;
+  double bestDistance = candidates.Worst(queryIndex);
   bestDistance = SortPolicy::Relax(bestDistance, epsilon);
 
-  return (SortPolicy::IsBetter(distance, bestDistance)) ? oldScore : DBL_MAX;
+  return statistics.Rescore(oldScore,
+      (SortPolicy::IsBetter(distance, bestDistance)) ? oldScore : DBL_MAX);
 }
 
 template<typename SortPolicy, typename MetricType, typename TreeType>
@@ -290,7 +386,7 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Score(
       // There isn't any need to set the traversal information because no
       // descendant combinations will be visited, and those are the only
       // combinations that would depend on the traversal information.
-      return DBL_MAX;
+      return statistics.Score(referenceNode, DBL_MAX);
     }
   }
 
@@ -335,14 +431,15 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Score(
     traversalInfo.LastReferenceNode() = &referenceNode;
     traversalInfo.LastScore() = distance;
 
-    return SortPolicy::ConvertToScore(distance);
+    return statistics.Score(referenceNode,
+        SortPolicy::ConvertToScore(distance));
   }
   else
   {
     // There isn't any need to set the traversal information because no
     // descendant combinations will be visited, and those are the only
     // combinations that would depend on the traversal information.
-    return DBL_MAX;
+    return statistics.Score(referenceNode, DBL_MAX);
   }
 }
 
@@ -360,7 +457,8 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Rescore(
   // Update our bound.
   const double bestDistance = CalculateBound(queryNode);
 
-  return (SortPolicy::IsBetter(distance, bestDistance)) ? oldScore : DBL_MAX;
+  return statistics.Rescore(oldScore,
+      (SortPolicy::IsBetter(distance, bestDistance)) ? oldScore : DBL_MAX);
 }
 
 // Calculate the bound for a given query node in its current state and update
@@ -401,14 +499,26 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::
   double bestPointDistance = SortPolicy::WorstDistance();
   double auxDistance = SortPolicy::WorstDistance();
 
-  // Loop over points held in the node.
-  for (size_t i = 0; i < queryNode.NumPoints(); ++i)
+  // Loop over points held in the node.  The points of a node of a tree that
+  // rearranges the dataset are contiguous.
+  if (tree::TreeTraits<TreeType>::RearrangesDataset)
+  {
+    if (queryNode.NumPoints() > 0)
+    {
+      candidates.WorstRange(queryNode.Point(0), queryNode.NumPoints(),
+          worstDistance, bestPointDistance);
+    }
+  }
+  else
   {
-    const double distance = candidates[queryNode.Point(i)].top().first;
-    if (SortPolicy::IsBetter(worstDistance, distance))
-      worstDistance = distance;
-    if (SortPolicy::IsBetter(distance, bestPointDistance))
-      bestPointDistance = distance;
+    for (size_t i = 0; i < queryNode.NumPoints(); ++i)
+    {
+      const double distance = candidates.Worst(queryNode.Point(i));
+      if (SortPolicy::IsBetter(worstDistance, distance))
+        worstDistance = distance;
+      if (SortPolicy::IsBetter(distance, bestPointDistance))
+        bestPointDistance = distance;
+    }
   }
 
   auxDistance = bestPointDistance;
@@ -499,14 +609,7 @@ InsertNeighbor(
     const size_t neighbor,
     const double distance)
 {
-  CandidateList& pqueue = candidates[queryIndex];
-  Candidate c = std::make_pair(distance, neighbor);
-
-  if (CandidateCmp()(c, pqueue.top()))
-  {
-    pqueue.pop();
-    pqueue.push(c);
-  }
+  candidates.Insert(queryIndex, neighbor, distance);
 }
 
 } // namespace neighbor
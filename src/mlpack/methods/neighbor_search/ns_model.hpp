@@ -20,6 +20,7 @@
 #include <mlpack/core/tree/rectangle_tree.hpp>
 #include <mlpack/core/tree/spill_tree.hpp>
 #include <mlpack/core/tree/octree.hpp>
+#include <mlpack/core/tree/query_tree_handle.hpp>
 #include <boost/variant.hpp>
 #include "neighbor_search.hpp"
 
@@ -27,19 +28,21 @@ namespace mlpack {
 namespace neighbor {
 
 /**
- * Alias template for euclidean neighbor search.
+ * Alias template for euclidean neighbor search.  The matrix type is arma::fmat
+ * for single-precision models.
  */
 template<typename SortPolicy,
          template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
+                  typename TreeMatType> class TreeType,
+         typename MatType = arma::mat>
 using NSType = NeighborSearch<SortPolicy,
                               metric::EuclideanDistance,
-                              arma::mat,
+                              MatType,
                               TreeType,
                               TreeType<metric::EuclideanDistance,
                                   NeighborSearchStat<SortPolicy>,
-                                  arma::mat>::template DualTreeTraverser>;
+                                  MatType>::template DualTreeTraverser>;
 
 /**
  * MonoSearchVisitor executes a monochromatic neighbor search on the given
@@ -99,12 +102,24 @@ class BiSearchVisitor : public boost::static_visitor<void>
   template<typename NSType>
   void SearchLeaf(NSType* ns) const;
 
+  //! Get the query set for a single-precision model, by converting it into the
+  //! given matrix.
+  template<typename MatType>
+  const MatType& QuerySet(MatType& converted) const;
+
+  //! Get the query set for a double-precision model (no copy is made).
+  const arma::mat& QuerySet(arma::mat& /* converted */) const
+  {
+    return querySet;
+  }
+
  public:
   //! Alias template necessary for visual c++ compiler.
   template<template<typename TreeMetricType,
                     typename TreeStatType,
-                    typename TreeMatType> class TreeType>
-  using NSTypeT = NSType<SortPolicy, TreeType>;
+                    typename TreeMatType> class TreeType,
+           typename MatType = arma::mat>
+  using NSTypeT = NSType<SortPolicy, TreeType, MatType>;
 
   //! Default Bichromatic neighbor search on the given NSType instance.
   template<template<typename TreeMetricType,
@@ -124,6 +139,12 @@ class BiSearchVisitor : public boost::static_visitor<void>
   //! Bichromatic neighbor search specialized for octrees.
   void operator()(NSTypeT<tree::Octree>* ns) const;
 
+  //! Bichromatic neighbor search specialized for single-precision KDTrees.
+  void operator()(NSTypeT<tree::KDTree, arma::fmat>* ns) const;
+
+  //! Bichromatic neighbor search specialized for single-precision BallTrees.
+  void operator()(NSTypeT<tree::BallTree, arma::fmat>* ns) const;
+
   //! Construct the BiSearchVisitor.
   BiSearchVisitor(const arma::mat& querySet,
                   const size_t k,
@@ -157,12 +178,25 @@ class TrainVisitor : public boost::static_visitor<void>
   template<typename NSType>
   void TrainLeaf(NSType* ns) const;
 
+  //! Convert the reference set into the given matrix, for single-precision
+  //! models.
+  template<typename MatType>
+  void ReferenceSet(MatType& converted) const;
+
+  //! Move the reference set into the given matrix, for double-precision
+  //! models.
+  void ReferenceSet(arma::mat& converted) const
+  {
+    converted = std::move(referenceSet);
+  }
+
  public:
   //! Alias template necessary for visual c++ compiler.
   template<template<typename TreeMetricType,
                     typename TreeStatType,
-                    typename TreeMatType> class TreeType>
-  using NSTypeT = NSType<SortPolicy, TreeType>;
+                    typename TreeMatType> class TreeType,
+           typename MatType = arma::mat>
+  using NSTypeT = NSType<SortPolicy, TreeType, MatType>;
 
   //! Default Train on the given NSType instance.
   template<template<typename TreeMetricType,
@@ -182,6 +216,12 @@ class TrainVisitor : public boost::static_visitor<void>
   //! Train specialized for octrees.
   void operator()(NSTypeT<tree::Octree>* ns) const;
 
+  //! Train on the given NSType specialized for single-precision KDTrees.
+  void operator()(NSTypeT<tree::KDTree, arma::fmat>* ns) const;
+
+  //! Train on the given NSType specialized for single-precision BallTrees.
+  void operator()(NSTypeT<tree::BallTree, arma::fmat>* ns) const;
+
   //! Construct the TrainVisitor object with the given reference set, leafSize
   //! for BinarySpaceTrees, and tau and rho for spill trees.
   TrainVisitor(arma::mat&& referenceSet,
@@ -190,6 +230,117 @@ class TrainVisitor : public boost::static_visitor<void>
                const double rho);
 };
 
+/**
+ * BuildQueryTreeVisitor builds a query tree for a dual-tree search with the
+ * given NSType, in the same way BiSearchVisitor does, and returns a handle to
+ * it.
+ */
+template<typename SortPolicy>
+class BuildQueryTreeVisitor :
+    public boost::static_visitor<tree::QueryTreeHandle>
+{
+ private:
+  //! The query set to build the tree on (it is moved into the tree).
+  arma::mat& querySet;
+  //! The number of points in a leaf (for BinarySpaceTrees).
+  const size_t leafSize;
+  //! Balance threshold (for spill trees).
+  const double rho;
+
+  //! Build the query tree for the given NSType considering the leafSize.
+  template<typename NSType>
+  tree::QueryTreeHandle BuildLeaf(NSType* ns) const;
+
+  //! Get the query set for a double-precision model (no copy is made).
+  template<typename MatType>
+  MatType QuerySet(const typename std::enable_if_t<
+      std::is_same<MatType, arma::mat>::value>* = 0) const
+  {
+    return std::move(querySet);
+  }
+
+  //! Get the query set for a single-precision model, by converting it.
+  template<typename MatType>
+  MatType QuerySet(const typename std::enable_if_t<
+      !std::is_same<MatType, arma::mat>::value>* = 0) const
+  {
+    return arma::conv_to<MatType>::from(querySet);
+  }
+
+ public:
+  //! Alias template necessary for visual c++ compiler.
+  template<template<typename TreeMetricType,
+                    typename TreeStatType,
+                    typename TreeMatType> class TreeType,
+           typename MatType = arma::mat>
+  using NSTypeT = NSType<SortPolicy, TreeType, MatType>;
+
+  //! Default query tree construction for the given NSType instance.
+  template<template<typename TreeMetricType,
+                    typename TreeStatType,
+                    typename TreeMatType> class TreeType>
+  tree::QueryTreeHandle operator()(NSTypeT<TreeType>* ns) const;
+
+  //! Query tree construction specialized for KDTrees.
+  tree::QueryTreeHandle operator()(NSTypeT<tree::KDTree>* ns) const;
+
+  //! Query tree construction specialized for BallTrees.
+  tree::QueryTreeHandle operator()(NSTypeT<tree::BallTree>* ns) const;
+
+  //! Query tree construction specialized for SPTrees.
+  tree::QueryTreeHandle operator()(SpillKNN* ns) const;
+
+  //! Query tree construction specialized for octrees.
+  tree::QueryTreeHandle operator()(NSTypeT<tree::Octree>* ns) const;
+
+  //! Query tree construction specialized for single-precision KDTrees.
+  tree::QueryTreeHandle operator()(NSTypeT<tree::KDTree, arma::fmat>* ns)
+      const;
+
+  //! Query tree construction specialized for single-precision BallTrees.
+  tree::QueryTreeHandle operator()(NSTypeT<tree::BallTree, arma::fmat>* ns)
+      const;
+
+  //! Construct the BuildQueryTreeVisitor.
+  BuildQueryTreeVisitor(arma::mat& querySet,
+                        const size_t leafSize,
+                        const double rho);
+};
+
+/**
+ * QueryTreeSearchVisitor executes a dual-tree neighbor search with a query tree
+ * built by BuildQueryTreeVisitor.  The bounds left in the query tree by the
+ * last search are reset first, so the tree can be used any number of times.
+ */
+class QueryTreeSearchVisitor : public boost::static_visitor<void>
+{
+ private:
+  //! The query tree.
+  const tree::QueryTreeHandle& queryTree;
+  //! The number of neighbors to search for.
+  const size_t k;
+  //! The result matrix for neighbors.
+  arma::Mat<size_t>& neighbors;
+  //! The result matrix for distances.
+  arma::mat& distances;
+
+ public:
+  //! Search with the query tree on the given NSType.
+  template<typename NSType>
+  void operator()(NSType* ns) const;
+
+  //! Construct the QueryTreeSearchVisitor.
+  QueryTreeSearchVisitor(const tree::QueryTreeHandle& queryTree,
+                         const size_t k,
+                         arma::Mat<size_t>& neighbors,
+                         arma::mat& distances) :
+      queryTree(queryTree),
+      k(k),
+      neighbors(neighbors),
+      distances(distances)
+  { }
+};
+
 /**
  * SearchModeVisitor exposes the SearchMode() method of the given NSType.
  */
@@ -212,6 +363,40 @@ class EpsilonVisitor : public boost::static_visitor<double&>
   double& operator()(NSType *ns) const;
 };
 
+/**
+ * MaxBaseCasesVisitor exposes the MaxBaseCases method of the given NSType.
+ */
+class MaxBaseCasesVisitor : public boost::static_visitor<size_t&>
+{
+ public:
+  //! Return the maximum number of base cases of each query point.
+  template<typename NSType>
+  size_t& operator()(NSType *ns) const;
+};
+
+/**
+ * MaxQueryTimeVisitor exposes the MaxQueryTime method of the given NSType.
+ */
+class MaxQueryTimeVisitor : public boost::static_visitor<double&>
+{
+ public:
+  //! Return the maximum search time of each query point.
+  template<typename NSType>
+  double& operator()(NSType *ns) const;
+};
+
+/**
+ * StatisticsVisitor exposes the traversal statistics of the given NSType.
+ */
+class StatisticsVisitor :
+    public boost::static_visitor<tree::TraversalStatistics&>
+{
+ public:
+  //! Return the traversal statistics.
+  template<typename NSType>
+  tree::TraversalStatistics& operator()(NSType* ns) const;
+};
+
 /**
  * ReferenceSetVisitor exposes the referenceSet of the given NSType.
  */
@@ -221,6 +406,27 @@ class ReferenceSetVisitor : public boost::static_visitor<const arma::mat&>
   //! Return the reference set.
   template<typename NSType>
   const arma::mat& operator()(NSType *ns) const;
+
+  //! Single-precision models do not hold an arma::mat reference set, so this
+  //! throws std::invalid_argument.
+  template<typename SortPolicy,
+           template<typename TreeMetricType,
+                    typename TreeStatType,
+                    typename TreeMatType> class TreeType>
+  const arma::mat& operator()(NSType<SortPolicy, TreeType, arma::fmat>* ns)
+      const;
+};
+
+/**
+ * ReferenceSetSizeVisitor returns the size of the reference set of the given
+ * NSType, for both single-precision and double-precision models.
+ */
+class ReferenceSetSizeVisitor : public boost::static_visitor<arma::SizeMat>
+{
+ public:
+  //! Return the size of the reference set.
+  template<typename NSType>
+  arma::SizeMat operator()(NSType *ns) const;
 };
 
 /**
@@ -285,6 +491,9 @@ class NSModel
   //! This is the random projection matrix; only used if randomBasis is true.
   arma::mat q;
 
+  //! If true, the reference set and trees are stored in single precision.
+  bool singlePrecision;
+
   /**
    * nSearch holds an instance of the NeigborSearch class for the current
    * treeType. It is initialized every time BuildModel is executed.
@@ -304,7 +513,9 @@ class NSModel
                  NSType<SortPolicy, tree::MaxRPTree>*,
                  SpillKNN*,
                  NSType<SortPolicy, tree::UBTree>*,
-                 NSType<SortPolicy, tree::Octree>*> nSearch;
+                 NSType<SortPolicy, tree::Octree>*,
+                 NSType<SortPolicy, tree::KDTree, arma::fmat>*,
+                 NSType<SortPolicy, tree::BallTree, arma::fmat>*> nSearch;
 
  public:
   /**
@@ -314,8 +525,12 @@ class NSModel
    * @param treeType Type of tree to use.
    * @param randomBasis Whether or not to project the points onto a random basis
    *      before searching.
+   * @param singlePrecision Whether or not to store the reference set and tree
+   *      in single precision (only for kd-trees and ball trees).
    */
-  NSModel(TreeTypes treeType = TreeTypes::KD_TREE, bool randomBasis = false);
+  NSModel(TreeTypes treeType = TreeTypes::KD_TREE,
+          bool randomBasis = false,
+          bool singlePrecision = false);
 
   /**
    * Copy the given NSModel.
@@ -352,9 +567,13 @@ class NSModel
   template<typename Archive>
   void serialize(Archive& ar, const unsigned int /* version */);
 
-  //! Expose the dataset.
+  //! Expose the dataset.  This is not available for single-precision models;
+  //! use DatasetSize() to get the size of the reference set instead.
   const arma::mat& Dataset() const;
 
+  //! Get the size of the reference set (for any precision).
+  arma::SizeMat DatasetSize() const;
+
   //! Expose SearchMode.
   NeighborSearchMode SearchMode() const;
   NeighborSearchMode& SearchMode();
@@ -363,6 +582,18 @@ class NSModel
   double Epsilon() const;
   double& Epsilon();
 
+  //! Expose MaxBaseCases (for BEST_FIRST_SINGLE_TREE_MODE).
+  size_t MaxBaseCases() const;
+  size_t& MaxBaseCases();
+
+  //! Expose MaxQueryTime (for BEST_FIRST_SINGLE_TREE_MODE).
+  double MaxQueryTime() const;
+  double& MaxQueryTime();
+
+  //! Expose the traversal statistics of the last search.
+  const tree::TraversalStatistics& Statistics() const;
+  tree::TraversalStatistics& Statistics();
+
   //! Expose leafSize.
   size_t LeafSize() const { return leafSize; }
   size_t& LeafSize() { return leafSize; }
@@ -383,12 +614,41 @@ class NSModel
   bool RandomBasis() const { return randomBasis; }
   bool& RandomBasis() { return randomBasis; }
 
+  //! Expose singlePrecision.  This only takes effect when BuildModel() is
+  //! called, which throws std::invalid_argument if single precision is not
+  //! supported for the tree type.
+  bool SinglePrecision() const { return singlePrecision; }
+  bool& SinglePrecision() { return singlePrecision; }
+
   //! Build the reference tree.
   void BuildModel(arma::mat&& referenceSet,
                   const size_t leafSize,
                   const NeighborSearchMode searchMode,
                   const double epsilon = 0);
 
+  /**
+   * Save the reference tree in flat format (see tree::FlatTreeIO), so that it
+   * can be loaded quickly later with LoadFlat().  This is only supported for
+   * kd-trees without a random basis; otherwise, std::invalid_argument is
+   * thrown.
+   *
+   * @param filename File to save the reference tree to.
+   */
+  void SaveFlat(const std::string& filename) const;
+
+  /**
+   * Load a kd-tree reference tree from a flat tree file saved by SaveFlat().
+   * The file is mapped into memory and used directly.  The tree type is set to
+   * kd-tree and the random basis is disabled.
+   *
+   * @param filename Flat tree file to load the reference tree from.
+   * @param searchMode Search mode to use (it cannot be a naive mode).
+   * @param epsilon Relative approximate error.
+   */
+  void LoadFlat(const std::string& filename,
+                const NeighborSearchMode searchMode,
+                const double epsilon = 0);
+
   //! Perform neighbor search.  The query set will be reordered.
   void Search(arma::mat&& querySet,
               const size_t k,
@@ -400,6 +660,35 @@ class NSModel
               arma::Mat<size_t>& neighbors,
               arma::mat& distances);
 
+  /**
+   * Build a query tree on the given query set, so that the same query set can
+   * be searched many times (i.e. with different values of k) without building
+   * a tree each time.  The handle can be passed to Search() as long as the
+   * model is not built again; it can only be used in dual-tree mode, and
+   * otherwise std::invalid_argument is thrown.
+   *
+   * @param querySet Set of query points (it is moved into the tree).
+   * @return Handle to the query tree.
+   */
+  tree::QueryTreeHandle BuildQueryTree(arma::mat&& querySet) const;
+
+  /**
+   * Perform dual-tree neighbor search with a query tree built by
+   * BuildQueryTree().  The results are given in the order of the original
+   * query set.  std::invalid_argument is thrown if the query tree was built
+   * for a different type of tree.
+   *
+   * @param queryTree Handle to the query tree.
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *     point.
+   */
+  void Search(const tree::QueryTreeHandle& queryTree,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances);
+
   //! Return a string representation of the current tree type.
   std::string TreeName() const;
 };
@@ -409,7 +698,7 @@ class NSModel
 
 //! Set the serialization version of the NSModel class.
 BOOST_TEMPLATE_CLASS_VERSION(template<typename SortPolicy>,
-    mlpack::neighbor::NSModel<SortPolicy>, 1);
+    mlpack::neighbor::NSModel<SortPolicy>, 2);
 
 // Include implementation.
 #include "ns_model_impl.hpp"
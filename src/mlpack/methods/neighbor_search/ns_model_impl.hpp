@@ -110,16 +110,48 @@ void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<tree::Octree>* ns) const
   throw std::runtime_error("no neighbor search model initialized");
 }
 
+//! Bichromatic neighbor search specialized for single-precision KDTrees.
+template<typename SortPolicy>
+void BiSearchVisitor<SortPolicy>::operator()(
+    NSTypeT<tree::KDTree, arma::fmat>* ns) const
+{
+  if (ns)
+    return SearchLeaf(ns);
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Bichromatic neighbor search specialized for single-precision BallTrees.
+template<typename SortPolicy>
+void BiSearchVisitor<SortPolicy>::operator()(
+    NSTypeT<tree::BallTree, arma::fmat>* ns) const
+{
+  if (ns)
+    return SearchLeaf(ns);
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Convert the query set for a single-precision model.
+template<typename SortPolicy>
+template<typename MatType>
+const MatType& BiSearchVisitor<SortPolicy>::QuerySet(MatType& converted) const
+{
+  converted = arma::conv_to<MatType>::from(querySet);
+  return converted;
+}
+
 //! Bichromatic neighbor search on the given NSType considering the leafSize.
 template<typename SortPolicy>
 template<typename NSType>
 void BiSearchVisitor<SortPolicy>::SearchLeaf(NSType* ns) const
 {
+  typedef typename NSType::Tree::Mat MatType;
+
+  MatType converted;
   if (ns->SearchMode() == DUAL_TREE_MODE)
   {
     std::vector<size_t> oldFromNewQueries;
-    typename NSType::Tree queryTree(std::move(querySet), oldFromNewQueries,
-        leafSize);
+    typename NSType::Tree queryTree(MatType(QuerySet(converted)),
+        oldFromNewQueries, leafSize);
 
     arma::Mat<size_t> neighborsOut;
     arma::mat distancesOut;
@@ -135,7 +167,7 @@ void BiSearchVisitor<SortPolicy>::SearchLeaf(NSType* ns) const
     }
   }
   else
-    ns->Search(querySet, k, neighbors, distances);
+    ns->Search(QuerySet(converted), k, neighbors, distances);
 }
 
 //! Save parameters for Train.
@@ -186,7 +218,7 @@ void TrainVisitor<SortPolicy>::operator()(SpillKNN* ns) const
 {
   if (ns)
   {
-    if (ns->SearchMode() == NAIVE_MODE)
+    if (IsNaiveMode(ns->SearchMode()))
       ns->Train(std::move(referenceSet));
     else
     {
@@ -207,17 +239,51 @@ void TrainVisitor<SortPolicy>::operator()(NSTypeT<tree::Octree>* ns) const
   throw std::runtime_error("no neighbor search model initialized");
 }
 
+//! Train on the given NSType specialized for single-precision KDTrees.
+template<typename SortPolicy>
+void TrainVisitor<SortPolicy>::operator()(
+    NSTypeT<tree::KDTree, arma::fmat>* ns) const
+{
+  if (ns)
+    return TrainLeaf(ns);
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Train on the given NSType specialized for single-precision BallTrees.
+template<typename SortPolicy>
+void TrainVisitor<SortPolicy>::operator()(
+    NSTypeT<tree::BallTree, arma::fmat>* ns) const
+{
+  if (ns)
+    return TrainLeaf(ns);
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Convert the reference set for a single-precision model.
+template<typename SortPolicy>
+template<typename MatType>
+void TrainVisitor<SortPolicy>::ReferenceSet(MatType& converted) const
+{
+  converted = arma::conv_to<MatType>::from(referenceSet);
+
+  // The original reference set is not needed anymore.
+  referenceSet.reset();
+}
+
 //! Train on the given NSType considering the leafSize.
 template<typename SortPolicy>
 template<typename NSType>
 void TrainVisitor<SortPolicy>::TrainLeaf(NSType* ns) const
 {
-  if (ns->SearchMode() == NAIVE_MODE)
-    ns->Train(std::move(referenceSet));
+  typename NSType::Tree::Mat dataset;
+  ReferenceSet(dataset);
+
+  if (IsNaiveMode(ns->SearchMode()))
+    ns->Train(std::move(dataset));
   else
   {
     std::vector<size_t> oldFromNewReferences;
-    typename NSType::Tree referenceTree(std::move(referenceSet),
+    typename NSType::Tree referenceTree(std::move(dataset),
         oldFromNewReferences, leafSize);
     ns->Train(std::move(referenceTree));
     // Set the mappings.
@@ -225,6 +291,159 @@ void TrainVisitor<SortPolicy>::TrainLeaf(NSType* ns) const
   }
 }
 
+//! Save parameters for building a query tree.
+template<typename SortPolicy>
+BuildQueryTreeVisitor<SortPolicy>::BuildQueryTreeVisitor(arma::mat& querySet,
+                                                         const size_t leafSize,
+                                                         const double rho) :
+    querySet(querySet),
+    leafSize(leafSize),
+    rho(rho)
+{}
+
+//! Default query tree construction on the given NSType instance.
+template<typename SortPolicy>
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+tree::QueryTreeHandle BuildQueryTreeVisitor<SortPolicy>::operator()(
+    NSTypeT<TreeType>* ns) const
+{
+  if (!ns)
+    throw std::runtime_error("no neighbor search model initialized");
+
+  typedef typename NSTypeT<TreeType>::Tree Tree;
+  std::vector<size_t> oldFromNewQueries;
+  Tree* queryTree = BuildTree<Tree>(std::move(querySet), oldFromNewQueries);
+  return tree::QueryTreeHandle(queryTree, std::move(oldFromNewQueries));
+}
+
+//! Query tree construction specialized for KDTrees.
+template<typename SortPolicy>
+tree::QueryTreeHandle BuildQueryTreeVisitor<SortPolicy>::operator()(
+    NSTypeT<tree::KDTree>* ns) const
+{
+  if (ns)
+    return BuildLeaf(ns);
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Query tree construction specialized for BallTrees.
+template<typename SortPolicy>
+tree::QueryTreeHandle BuildQueryTreeVisitor<SortPolicy>::operator()(
+    NSTypeT<tree::BallTree>* ns) const
+{
+  if (ns)
+    return BuildLeaf(ns);
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Query tree construction specialized for SPTrees.
+template<typename SortPolicy>
+tree::QueryTreeHandle BuildQueryTreeVisitor<SortPolicy>::operator()(
+    SpillKNN* ns) const
+{
+  if (!ns)
+    throw std::runtime_error("no neighbor search model initialized");
+
+  // For Dual Tree Search on SpillTrees, the queryTree must be built with
+  // non overlapping (tau = 0).
+  typename SpillKNN::Tree* queryTree = new typename SpillKNN::Tree(
+      std::move(querySet), 0 /* tau */, leafSize, rho);
+  return tree::QueryTreeHandle(queryTree, std::vector<size_t>());
+}
+
+//! Query tree construction specialized for octrees.
+template<typename SortPolicy>
+tree::QueryTreeHandle BuildQueryTreeVisitor<SortPolicy>::operator()(
+    NSTypeT<tree::Octree>* ns) const
+{
+  if (ns)
+    return BuildLeaf(ns);
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Query tree construction specialized for single-precision KDTrees.
+template<typename SortPolicy>
+tree::QueryTreeHandle BuildQueryTreeVisitor<SortPolicy>::operator()(
+    NSTypeT<tree::KDTree, arma::fmat>* ns) const
+{
+  if (ns)
+    return BuildLeaf(ns);
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Query tree construction specialized for single-precision BallTrees.
+template<typename SortPolicy>
+tree::QueryTreeHandle BuildQueryTreeVisitor<SortPolicy>::operator()(
+    NSTypeT<tree::BallTree, arma::fmat>* ns) const
+{
+  if (ns)
+    return BuildLeaf(ns);
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Query tree construction on the given NSType considering the leafSize.
+template<typename SortPolicy>
+template<typename NSType>
+tree::QueryTreeHandle BuildQueryTreeVisitor<SortPolicy>::BuildLeaf(
+    NSType* /* ns */) const
+{
+  typedef typename NSType::Tree Tree;
+
+  std::vector<size_t> oldFromNewQueries;
+  Tree* queryTree = new Tree(QuerySet<typename Tree::Mat>(), oldFromNewQueries,
+      leafSize);
+  return tree::QueryTreeHandle(queryTree, std::move(oldFromNewQueries));
+}
+
+//! Search with the query tree on the given NSType.
+template<typename NSType>
+void QueryTreeSearchVisitor::operator()(NSType* ns) const
+{
+  if (!ns)
+    throw std::runtime_error("no neighbor search model initialized");
+
+  typedef typename NSType::Tree Tree;
+  Tree* tree = queryTree.Get<Tree>();
+  if (!tree)
+    throw std::invalid_argument("the query tree was not built for the type of "
+        "tree used by the model");
+
+  // Reset the bounds that the last search left in the query tree.
+  std::stack<Tree*> nodes;
+  nodes.push(tree);
+  while (!nodes.empty())
+  {
+    Tree* node = nodes.top();
+    nodes.pop();
+
+    node->Stat().Reset();
+    for (size_t i = 0; i < node->NumChildren(); ++i)
+      nodes.push(&node->Child(i));
+  }
+
+  const std::vector<size_t>& oldFromNewQueries = queryTree.OldFromNew();
+  if (oldFromNewQueries.empty())
+  {
+    ns->Search(*tree, k, neighbors, distances);
+    return;
+  }
+
+  arma::Mat<size_t> neighborsOut;
+  arma::mat distancesOut;
+  ns->Search(*tree, k, neighborsOut, distancesOut);
+
+  // Unmap the query points.
+  distances.set_size(distancesOut.n_rows, distancesOut.n_cols);
+  neighbors.set_size(neighborsOut.n_rows, neighborsOut.n_cols);
+  for (size_t i = 0; i < neighborsOut.n_cols; ++i)
+  {
+    neighbors.col(oldFromNewQueries[i]) = neighborsOut.col(i);
+    distances.col(oldFromNewQueries[i]) = distancesOut.col(i);
+  }
+}
+
 //! Return the search mode.
 template<typename NSType>
 NeighborSearchMode& SearchModeVisitor::operator()(NSType* ns) const
@@ -243,6 +462,33 @@ double& EpsilonVisitor::operator()(NSType* ns) const
   throw std::runtime_error("no neighbor search model initialized");
 }
 
+//! Expose the MaxBaseCases method of the given NSType.
+template<typename NSType>
+size_t& MaxBaseCasesVisitor::operator()(NSType* ns) const
+{
+  if (ns)
+    return ns->MaxBaseCases();
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Expose the MaxQueryTime method of the given NSType.
+template<typename NSType>
+double& MaxQueryTimeVisitor::operator()(NSType* ns) const
+{
+  if (ns)
+    return ns->MaxQueryTime();
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Expose the traversal statistics of the given NSType.
+template<typename NSType>
+tree::TraversalStatistics& StatisticsVisitor::operator()(NSType* ns) const
+{
+  if (ns)
+    return ns->Statistics();
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
 //! Expose the referenceSet of the given NSType.
 template<typename NSType>
 const arma::mat& ReferenceSetVisitor::operator()(NSType* ns) const
@@ -252,6 +498,27 @@ const arma::mat& ReferenceSetVisitor::operator()(NSType* ns) const
   throw std::runtime_error("no neighbor search model initialized");
 }
 
+//! Single-precision models do not hold an arma::mat reference set.
+template<typename SortPolicy,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+const arma::mat& ReferenceSetVisitor::operator()(
+    NSType<SortPolicy, TreeType, arma::fmat>* /* ns */) const
+{
+  throw std::invalid_argument("the reference set of a single-precision model "
+      "cannot be accessed as an arma::mat");
+}
+
+//! Return the size of the reference set of the given NSType.
+template<typename NSType>
+arma::SizeMat ReferenceSetSizeVisitor::operator()(NSType* ns) const
+{
+  if (ns)
+    return arma::size(ns->ReferenceSet());
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
 //! Clean memory, if necessary.
 template<typename NSType>
 void DeleteVisitor::operator()(NSType* ns) const
@@ -265,12 +532,15 @@ void DeleteVisitor::operator()(NSType* ns) const
  * basis should be used.
  */
 template<typename SortPolicy>
-NSModel<SortPolicy>::NSModel(TreeTypes treeType, bool randomBasis) :
+NSModel<SortPolicy>::NSModel(TreeTypes treeType,
+                             bool randomBasis,
+                             bool singlePrecision) :
     treeType(treeType),
     leafSize(20),
     tau(0),
     rho(0.7),
-    randomBasis(randomBasis)
+    randomBasis(randomBasis),
+    singlePrecision(singlePrecision)
 {
   // Nothing to do.
 }
@@ -283,6 +553,7 @@ NSModel<SortPolicy>::NSModel(const NSModel& other) :
     rho(other.rho),
     randomBasis(other.randomBasis),
     q(other.q),
+    singlePrecision(other.singlePrecision),
     nSearch(other.nSearch)
 {
   // Nothing to do.
@@ -296,6 +567,7 @@ NSModel<SortPolicy>::NSModel(NSModel&& other) :
     rho(other.rho),
     randomBasis(other.randomBasis),
     q(std::move(other.q)),
+    singlePrecision(other.singlePrecision),
     nSearch(other.nSearch)
 {
   // Reset parameters of the other model.
@@ -304,6 +576,7 @@ NSModel<SortPolicy>::NSModel(NSModel&& other) :
   other.tau = 0;
   other.rho = 0.7;
   other.randomBasis = false;
+  other.singlePrecision = false;
   other.nSearch = decltype(other.nSearch)();
 }
 
@@ -318,6 +591,7 @@ NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(const NSModel& other)
   rho = other.rho;
   randomBasis = other.randomBasis;
   q = other.q;
+  singlePrecision = other.singlePrecision;
   nSearch = other.nSearch;
 
   return *this;
@@ -334,6 +608,7 @@ NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(NSModel&& other)
   rho = other.rho;
   randomBasis = other.randomBasis;
   q = std::move(other.q);
+  singlePrecision = other.singlePrecision;
   // Copy the pointer and type.
   nSearch = other.nSearch;
 
@@ -343,6 +618,7 @@ NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(NSModel&& other)
   other.tau = 0;
   other.rho = 0.7;
   other.randomBasis = false;
+  other.singlePrecision = false;
   other.nSearch = decltype(other.nSearch)();
 
   return *this;
@@ -372,6 +648,12 @@ void NSModel<SortPolicy>::serialize(Archive& ar, const unsigned int version)
   ar & BOOST_SERIALIZATION_NVP(randomBasis);
   ar & BOOST_SERIALIZATION_NVP(q);
 
+  // Older versions of NSModel only held double-precision models.
+  if (version > 1)
+    ar & BOOST_SERIALIZATION_NVP(singlePrecision);
+  else if (Archive::is_loading::value)
+    singlePrecision = false;
+
   // This should never happen, but just in case, be clean with memory.
   if (Archive::is_loading::value)
     boost::apply_visitor(DeleteVisitor(), nSearch);
@@ -386,6 +668,13 @@ const arma::mat& NSModel<SortPolicy>::Dataset() const
   return boost::apply_visitor(ReferenceSetVisitor(), nSearch);
 }
 
+//! Get the size of the reference set.
+template<typename SortPolicy>
+arma::SizeMat NSModel<SortPolicy>::DatasetSize() const
+{
+  return boost::apply_visitor(ReferenceSetSizeVisitor(), nSearch);
+}
+
 //! Access the search mode.
 template<typename SortPolicy>
 NeighborSearchMode NSModel<SortPolicy>::SearchMode() const
@@ -412,6 +701,42 @@ double& NSModel<SortPolicy>::Epsilon()
   return boost::apply_visitor(EpsilonVisitor(), nSearch);
 }
 
+template<typename SortPolicy>
+size_t NSModel<SortPolicy>::MaxBaseCases() const
+{
+  return boost::apply_visitor(MaxBaseCasesVisitor(), nSearch);
+}
+
+template<typename SortPolicy>
+size_t& NSModel<SortPolicy>::MaxBaseCases()
+{
+  return boost::apply_visitor(MaxBaseCasesVisitor(), nSearch);
+}
+
+template<typename SortPolicy>
+double NSModel<SortPolicy>::MaxQueryTime() const
+{
+  return boost::apply_visitor(MaxQueryTimeVisitor(), nSearch);
+}
+
+template<typename SortPolicy>
+double& NSModel<SortPolicy>::MaxQueryTime()
+{
+  return boost::apply_visitor(MaxQueryTimeVisitor(), nSearch);
+}
+
+template<typename SortPolicy>
+const tree::TraversalStatistics& NSModel<SortPolicy>::Statistics() const
+{
+  return boost::apply_visitor(StatisticsVisitor(), nSearch);
+}
+
+template<typename SortPolicy>
+tree::TraversalStatistics& NSModel<SortPolicy>::Statistics()
+{
+  return boost::apply_visitor(StatisticsVisitor(), nSearch);
+}
+
 //! Build the reference tree.
 template<typename SortPolicy>
 void NSModel<SortPolicy>::BuildModel(arma::mat&& referenceSet,
@@ -419,6 +744,10 @@ void NSModel<SortPolicy>::BuildModel(arma::mat&& referenceSet,
                                      const NeighborSearchMode searchMode,
                                      const double epsilon)
 {
+  if (singlePrecision && treeType != KD_TREE && treeType != BALL_TREE)
+    throw std::invalid_argument("single-precision models are only supported "
+        "for kd-trees and ball trees");
+
   this->leafSize = leafSize;
   // Initialize random basis if necessary.
   if (randomBasis)
@@ -459,7 +788,7 @@ void NSModel<SortPolicy>::BuildModel(arma::mat&& referenceSet,
   if (randomBasis)
     referenceSet = q * referenceSet;
 
-  if (searchMode != NAIVE_MODE)
+  if (!IsNaiveMode(searchMode))
   {
     Timer::Start("tree_building");
     Log::Info << "Building reference tree..." << std::endl;
@@ -468,7 +797,11 @@ void NSModel<SortPolicy>::BuildModel(arma::mat&& referenceSet,
   switch (treeType)
   {
     case KD_TREE:
-      nSearch = new NSType<SortPolicy, tree::KDTree>(searchMode, epsilon);
+      if (singlePrecision)
+        nSearch = new NSType<SortPolicy, tree::KDTree, arma::fmat>(searchMode,
+            epsilon);
+      else
+        nSearch = new NSType<SortPolicy, tree::KDTree>(searchMode, epsilon);
       break;
     case COVER_TREE:
       nSearch = new NSType<SortPolicy, tree::StandardCoverTree>(searchMode,
@@ -481,7 +814,11 @@ void NSModel<SortPolicy>::BuildModel(arma::mat&& referenceSet,
       nSearch = new NSType<SortPolicy, tree::RStarTree>(searchMode, epsilon);
       break;
     case BALL_TREE:
-      nSearch = new NSType<SortPolicy, tree::BallTree>(searchMode, epsilon);
+      if (singlePrecision)
+        nSearch = new NSType<SortPolicy, tree::BallTree, arma::fmat>(
+            searchMode, epsilon);
+      else
+        nSearch = new NSType<SortPolicy, tree::BallTree>(searchMode, epsilon);
       break;
     case X_TREE:
       nSearch = new NSType<SortPolicy, tree::XTree>(searchMode, epsilon);
@@ -519,7 +856,7 @@ void NSModel<SortPolicy>::BuildModel(arma::mat&& referenceSet,
   TrainVisitor<SortPolicy> tn(std::move(referenceSet), leafSize, tau, rho);
   boost::apply_visitor(tn, nSearch);
 
-  if (searchMode != NAIVE_MODE)
+  if (!IsNaiveMode(searchMode))
   {
     Timer::Stop("tree_building");
     Log::Info << "Tree built." << std::endl;
@@ -544,6 +881,9 @@ void NSModel<SortPolicy>::Search(arma::mat&& querySet,
     case NAIVE_MODE:
       Log::Info << "brute-force (naive) search..." << std::endl;
       break;
+    case BLOCKED_NAIVE_MODE:
+      Log::Info << "blocked brute-force (naive) search..." << std::endl;
+      break;
     case SINGLE_TREE_MODE:
       Log::Info << "single-tree " << TreeName() << " search..." << std::endl;
       break;
@@ -554,6 +894,10 @@ void NSModel<SortPolicy>::Search(arma::mat&& querySet,
       Log::Info << "greedy single-tree " << TreeName() << " search..."
           << std::endl;
       break;
+    case BEST_FIRST_SINGLE_TREE_MODE:
+      Log::Info << "best-first single-tree " << TreeName() << " search..."
+          << std::endl;
+      break;
   }
 
   BiSearchVisitor<SortPolicy> search(querySet, k, neighbors, distances,
@@ -561,6 +905,46 @@ void NSModel<SortPolicy>::Search(arma::mat&& querySet,
   boost::apply_visitor(search, nSearch);
 }
 
+//! Save the reference tree in flat format.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::SaveFlat(const std::string& filename) const
+{
+  if (treeType != KD_TREE || randomBasis || singlePrecision)
+    throw std::invalid_argument("flat reference trees are only supported for "
+        "double-precision kd-trees without a random basis");
+
+  boost::get<NSType<SortPolicy, tree::KDTree>*>(nSearch)->SaveFlat(filename);
+}
+
+//! Load the reference tree from a flat tree file.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::LoadFlat(const std::string& filename,
+                                   const NeighborSearchMode searchMode,
+                                   const double epsilon)
+{
+  if (IsNaiveMode(searchMode))
+    throw std::invalid_argument("cannot load a flat reference tree when naive "
+        "search (without trees) is used");
+
+  NSType<SortPolicy, tree::KDTree>* ns =
+      new NSType<SortPolicy, tree::KDTree>(searchMode, epsilon);
+  try
+  {
+    ns->LoadFlat(filename);
+  }
+  catch (...)
+  {
+    delete ns;
+    throw;
+  }
+
+  boost::apply_visitor(DeleteVisitor(), nSearch);
+  nSearch = ns;
+  treeType = KD_TREE;
+  randomBasis = false;
+  singlePrecision = false;
+}
+
 //! Perform neighbor search.
 template<typename SortPolicy>
 void NSModel<SortPolicy>::Search(const size_t k,
@@ -574,6 +958,9 @@ void NSModel<SortPolicy>::Search(const size_t k,
     case NAIVE_MODE:
       Log::Info << "brute-force (naive) search..." << std::endl;
       break;
+    case BLOCKED_NAIVE_MODE:
+      Log::Info << "blocked brute-force (naive) search..." << std::endl;
+      break;
     case SINGLE_TREE_MODE:
       Log::Info << "single-tree " << TreeName() << " search..." << std::endl;
       break;
@@ -584,9 +971,13 @@ void NSModel<SortPolicy>::Search(const size_t k,
       Log::Info << "greedy single-tree " << TreeName() << " search..."
           << std::endl;
       break;
+    case BEST_FIRST_SINGLE_TREE_MODE:
+      Log::Info << "best-first single-tree " << TreeName() << " search..."
+          << std::endl;
+      break;
   }
 
-  if (Epsilon() != 0 && SearchMode() != NAIVE_MODE)
+  if (Epsilon() != 0 && !IsNaiveMode(SearchMode()))
     Log::Info << "Maximum of " << Epsilon() * 100 << "% relative error."
         << std::endl;
 
@@ -594,6 +985,43 @@ void NSModel<SortPolicy>::Search(const size_t k,
   boost::apply_visitor(search, nSearch);
 }
 
+//! Build a query tree for repeated dual-tree searches.
+template<typename SortPolicy>
+tree::QueryTreeHandle NSModel<SortPolicy>::BuildQueryTree(
+    arma::mat&& querySet) const
+{
+  if (SearchMode() != DUAL_TREE_MODE)
+    throw std::invalid_argument("query trees can only be used for dual-tree "
+        "search");
+
+  // We may need to map the query set randomly.
+  if (randomBasis)
+    querySet = q * querySet;
+
+  Timer::Start("tree_building");
+  Log::Info << "Building query tree..." << std::endl;
+  BuildQueryTreeVisitor<SortPolicy> build(querySet, leafSize, rho);
+  tree::QueryTreeHandle queryTree = boost::apply_visitor(build, nSearch);
+  Log::Info << "Tree built." << std::endl;
+  Timer::Stop("tree_building");
+
+  return queryTree;
+}
+
+//! Perform dual-tree neighbor search with a prebuilt query tree.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::Search(const tree::QueryTreeHandle& queryTree,
+                                 const size_t k,
+                                 arma::Mat<size_t>& neighbors,
+                                 arma::mat& distances)
+{
+  Log::Info << "Searching for " << k << " neighbors with dual-tree "
+      << TreeName() << " search (with a prebuilt query tree)..." << std::endl;
+
+  QueryTreeSearchVisitor search(queryTree, k, neighbors, distances);
+  boost::apply_visitor(search, nSearch);
+}
+
 //! Get the name of the tree type.
 template<typename SortPolicy>
 std::string NSModel<SortPolicy>::TreeName() const
@@ -0,0 +1,173 @@
+/**
+ * @file spill_tuning.cpp
+ *
+ * Implementation of TuneSpillTree().
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "spill_tuning.hpp"
+
+#include <mlpack/core/tree/spill_tree.hpp>
+#include "neighbor_search.hpp"
+
+using namespace mlpack;
+using namespace mlpack::neighbor;
+
+namespace {
+
+//! The result of a defeatist search with given parameters.
+struct SpillTrial
+{
+  double tau;
+  double rho;
+  double recall;
+  size_t baseCases;
+};
+
+//! Run defeatist search with the given parameters and measure its recall.
+SpillTrial RunSpillTrial(const arma::mat& referenceSet,
+                         const arma::mat& validationSet,
+                         const size_t k,
+                         arma::Mat<size_t>& trueNeighbors,
+                         const double tau,
+                         const double rho,
+                         const size_t leafSize)
+{
+  SpillKNN::Tree tree(referenceSet, tau, leafSize, rho);
+  SpillKNN knn(std::move(tree), SINGLE_TREE_MODE);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  knn.Search(validationSet, k, neighbors, distances);
+
+  SpillTrial trial;
+  trial.tau = tau;
+  trial.rho = rho;
+  trial.recall = SpillKNN::Recall(neighbors, trueNeighbors);
+  trial.baseCases = knn.BaseCases();
+
+  Log::Info << "Spill tree with tau " << tau << " and rho " << rho
+      << ": recall " << trial.recall << ", " << trial.baseCases
+      << " base cases." << std::endl;
+
+  return trial;
+}
+
+} // namespace
+
+double mlpack::neighbor::TuneSpillTree(const arma::mat& referenceSet,
+                                       const arma::mat& validationSet,
+                                       const size_t k,
+                                       const double targetRecall,
+                                       double& tau,
+                                       double& rho,
+                                       const size_t leafSize,
+                                       const size_t bisectionSteps)
+{
+  if (targetRecall <= 0.0 || targetRecall > 1.0)
+  {
+    std::ostringstream oss;
+    oss << "TuneSpillTree(): target recall (" << targetRecall << ") must be "
+        << "in (0, 1]!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (k == 0 || k > referenceSet.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "TuneSpillTree(): k (" << k << ") must be between 1 and the number "
+        << "of reference points (" << referenceSet.n_cols << ")!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (validationSet.n_cols == 0 || validationSet.n_rows != referenceSet.n_rows)
+  {
+    std::ostringstream oss;
+    oss << "TuneSpillTree(): the validation set must be non-empty and have the "
+        << "same dimensionality as the reference set (" << referenceSet.n_rows
+        << ")!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // Find the true neighbors of the validation points.
+  arma::Mat<size_t> trueNeighbors;
+  arma::mat trueDistances;
+  KNN exact(referenceSet);
+  exact.Search(validationSet, k, trueNeighbors, trueDistances);
+
+  // Overlapping buffers as wide as the distance to the k-th nearest neighbor
+  // give nearly exact results, so that's where the search for tau starts.
+  double tauScale = arma::mean(trueDistances.row(k - 1));
+  if (tauScale <= 0.0)
+    tauScale = 1.0;
+
+  // Larger values of rho allow more overlapping splits.
+  const double rhos[] = { 0.5, 0.6, 0.7, 0.8, 0.9 };
+  const size_t maxDoublings = 4;
+
+  SpillTrial best;
+  best.recall = -1.0;
+  bool reached = false;
+  for (const double candidateRho : rhos)
+  {
+    SpillTrial low = RunSpillTrial(referenceSet, validationSet, k,
+        trueNeighbors, 0.0, candidateRho, leafSize);
+    SpillTrial feasible = low;
+    if (low.recall < targetRecall)
+    {
+      // Find a tau that reaches the target.
+      SpillTrial high = RunSpillTrial(referenceSet, validationSet, k,
+          trueNeighbors, tauScale, candidateRho, leafSize);
+      for (size_t i = 0; i < maxDoublings && high.recall < targetRecall; ++i)
+      {
+        low = high;
+        high = RunSpillTrial(referenceSet, validationSet, k, trueNeighbors,
+            2.0 * high.tau, candidateRho, leafSize);
+      }
+
+      if (high.recall < targetRecall)
+      {
+        // The target can't be reached with this rho; keep the best effort in
+        // case no rho reaches it.
+        if (!reached && high.recall > best.recall)
+          best = high;
+        continue;
+      }
+
+      // Bisect for the smallest tau that reaches the target.
+      for (size_t i = 0; i < bisectionSteps; ++i)
+      {
+        const SpillTrial mid = RunSpillTrial(referenceSet, validationSet, k,
+            trueNeighbors, (low.tau + high.tau) / 2.0, candidateRho, leafSize);
+        if (mid.recall >= targetRecall)
+          high = mid;
+        else
+          low = mid;
+      }
+
+      feasible = high;
+    }
+
+    if (!reached || feasible.baseCases < best.baseCases)
+      best = feasible;
+    reached = true;
+  }
+
+  if (!reached)
+  {
+    Log::Warn << "TuneSpillTree(): target recall " << targetRecall << " could "
+        << "not be reached; the best recall found was " << best.recall << "."
+        << std::endl;
+  }
+
+  tau = best.tau;
+  rho = best.rho;
+
+  Log::Info << "Chose tau " << tau << " and rho " << rho << " (recall "
+      << best.recall << ")." << std::endl;
+
+  return best.recall;
+}
@@ -0,0 +1,60 @@
+/**
+ * @file spill_tuning.hpp
+ *
+ * Automatic tuning of the tau and rho parameters of spill trees for defeatist
+ * k-nearest-neighbor search.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_SPILL_TUNING_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_SPILL_TUNING_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * Find the tau (overlapping size) and rho (balance threshold) parameters of
+ * a spill tree that make defeatist k-nearest-neighbor search (SpillKNN in
+ * single-tree mode) reach the given recall on a validation set at the lowest
+ * cost.
+ *
+ * The true neighbors of the validation points are computed once with exact
+ * search.  Then, for each candidate value of rho, the smallest tau that reaches
+ * the target recall is found by bisection (recall grows with tau), starting
+ * from a scale given by the distances to the true k-th nearest neighbors.
+ * Among the candidates that reach the target, the one that computes the fewest
+ * base cases is chosen.  If no candidate reaches the target, the one with the
+ * highest recall is chosen and a warning is printed.
+ *
+ * Each step builds a spill tree on the reference set, so a sample of the
+ * reference set should be used when it is large; the validation set should be
+ * drawn from the same distribution as the real queries.
+ *
+ * @param referenceSet Set of reference points.
+ * @param validationSet Set of query points to measure the recall with.
+ * @param k Number of neighbors to search for.
+ * @param targetRecall Recall to reach, in (0, 1].
+ * @param tau Set to the chosen overlapping size.
+ * @param rho Set to the chosen balance threshold.
+ * @param leafSize Leaf size of the spill trees.
+ * @param bisectionSteps Number of bisection steps for each value of rho.
+ * @return Recall reached with the chosen parameters.
+ */
+double TuneSpillTree(const arma::mat& referenceSet,
+                     const arma::mat& validationSet,
+                     const size_t k,
+                     const double targetRecall,
+                     double& tau,
+                     double& rho,
+                     const size_t leafSize = 20,
+                     const size_t bisectionSteps = 8);
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
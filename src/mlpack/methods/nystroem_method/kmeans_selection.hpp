@@ -15,12 +15,16 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/methods/kmeans/kmeans.hpp>
+#include <mlpack/methods/kmeans/allow_empty_clusters.hpp>
+#include <mlpack/methods/kmeans/mini_batch_kmeans.hpp>
 
 namespace mlpack {
 namespace kernel {
 
 /**
- * Implementation of the kmeans sampling scheme.
+ * Implementation of the kmeans sampling scheme.  The default clustering type
+ * runs the Lloyd iterations of NaiveKMeans, which are split between threads;
+ * for very large datasets, MiniBatchKMeansSelection is much cheaper.
  *
  * @tparam ClusteringType Type of clustering.
  * @tparam maxIterations Maximum number of iterations allowed before giving up.
@@ -50,6 +54,19 @@ class KMeansSelection
   }
 };
 
+/**
+ * The kmeans sampling scheme with mini-batch k-means, whose iterations only
+ * look at a random sample of the points, so its cost does not depend on the
+ * size of the dataset.  Empty clusters keep their centroids, since finding a
+ * new one would take a pass over the whole dataset.
+ *
+ * @tparam maxIterations Maximum number of mini-batch iterations.
+ */
+template<size_t maxIterations = 100>
+using MiniBatchKMeansSelection = KMeansSelection<kmeans::KMeans<
+    metric::EuclideanDistance, kmeans::SampleInitialization,
+    kmeans::AllowEmptyClusters, kmeans::MiniBatchKMeans>, maxIterations>;
+
 } // namespace kernel
 } // namespace mlpack
 
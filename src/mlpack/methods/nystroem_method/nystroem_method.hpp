@@ -40,7 +40,10 @@ class NystroemMethod
 
   /**
    * Apply the low-rank factorization to obtain an output matrix G such that
-   * K' = G * G^T.
+   * K' = G * G^T.  The kernel evaluations between all the points and the
+   * selected points are computed and multiplied into G in blocks of
+   * blockSize points, so the whole n x rank kernel matrix is never held in
+   * memory besides G itself.
    *
    * @param output Matrix to store kernel approximation into.
    */
@@ -68,7 +71,17 @@ class NystroemMethod
                        arma::mat& miniKernel,
                        arma::mat& semiKernel);
 
+  //! The number of points whose kernel evaluations Apply() computes at once.
+  static const size_t blockSize = 4096;
+
  private:
+  //! Gather the selected points, given as points (which are deleted).
+  void SelectedData(const arma::mat* selectedPoints, arma::mat& selectedData);
+
+  //! Gather the selected points, given as indices into the dataset.
+  void SelectedData(const arma::Col<size_t>& selectedPoints,
+                    arma::mat& selectedData);
+
   //! The reference dataset.
   const arma::mat& data;
   //! The locally stored kernel, if it is necessary.
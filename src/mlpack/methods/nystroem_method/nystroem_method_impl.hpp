@@ -16,6 +16,8 @@
 // In case it hasn't been included yet.
 #include "nystroem_method.hpp"
 
+#include <mlpack/core/kernels/kernel_matrix.hpp>
+
 namespace mlpack {
 namespace kernel {
 
@@ -36,17 +38,12 @@ void NystroemMethod<KernelType, PointSelectionPolicy>::GetKernelMatrix(
     arma::mat& semiKernel)
 {
   // Assemble mini-kernel matrix.
-  for (size_t i = 0; i < rank; ++i)
-    for (size_t j = 0; j < rank; ++j)
-      miniKernel(i, j) = kernel.Evaluate(selectedData->col(i),
-                                         selectedData->col(j));
+  KernelMatrix(selectedData->cols(0, rank - 1), miniKernel, kernel);
 
   // Construct semi-kernel matrix with interactions between selected data and
   // all points.
-  for (size_t i = 0; i < data.n_cols; ++i)
-    for (size_t j = 0; j < rank; ++j)
-      semiKernel(i, j) = kernel.Evaluate(data.col(i),
-                                         selectedData->col(j));
+  KernelMatrix(data, selectedData->cols(0, rank - 1), semiKernel, kernel);
+
   // Clean the memory.
   delete selectedData;
 }
@@ -57,46 +54,78 @@ void NystroemMethod<KernelType, PointSelectionPolicy>::GetKernelMatrix(
     arma::mat& miniKernel,
     arma::mat& semiKernel)
 {
-  // Assemble mini-kernel matrix.
+  // Gather the selected points, so that the kernel matrices can be built in
+  // blocks.
+  arma::mat selectedData(data.n_rows, rank);
   for (size_t i = 0; i < rank; ++i)
-  {
-    for (size_t j = 0; j < rank; ++j)
-    {
-      miniKernel(i, j) = kernel.Evaluate(data.col(selectedPoints(i)),
-                                         data.col(selectedPoints(j)));
-    }
-  }
+    selectedData.col(i) = data.col(selectedPoints(i));
+
+  // Assemble mini-kernel matrix.
+  KernelMatrix(selectedData, miniKernel, kernel);
 
   // Construct semi-kernel matrix with interactions between selected points and
   // all points.
-  for (size_t i = 0; i < data.n_cols; ++i)
-    for (size_t j = 0; j < rank; ++j)
-      semiKernel(i, j) = kernel.Evaluate(data.col(i),
-                                         data.col(selectedPoints(j)));
+  KernelMatrix(data, selectedData, semiKernel, kernel);
+}
+
+template<typename KernelType, typename PointSelectionPolicy>
+void NystroemMethod<KernelType, PointSelectionPolicy>::SelectedData(
+    const arma::mat* selectedPoints,
+    arma::mat& selectedData)
+{
+  selectedData = selectedPoints->cols(0, rank - 1);
+  delete selectedPoints;
+}
+
+template<typename KernelType, typename PointSelectionPolicy>
+void NystroemMethod<KernelType, PointSelectionPolicy>::SelectedData(
+    const arma::Col<size_t>& selectedPoints,
+    arma::mat& selectedData)
+{
+  selectedData.set_size(data.n_rows, rank);
+  for (size_t i = 0; i < rank; ++i)
+    selectedData.col(i) = data.col(selectedPoints(i));
 }
 
 template<typename KernelType, typename PointSelectionPolicy>
 void NystroemMethod<KernelType, PointSelectionPolicy>::Apply(arma::mat& output)
 {
-  arma::mat miniKernel(rank, rank);
-  arma::mat semiKernel(data.n_cols, rank);
+  arma::mat selectedData;
+  SelectedData(PointSelectionPolicy::Select(data, rank), selectedData);
 
-  GetKernelMatrix(PointSelectionPolicy::Select(data, rank), miniKernel,
-                  semiKernel);
+  // Assemble mini-kernel matrix.
+  arma::mat miniKernel;
+  KernelMatrix(selectedData, miniKernel, kernel);
 
   // Singular value decomposition mini-kernel matrix.
   arma::mat U, V;
   arma::vec s;
   arma::svd(U, s, V, miniKernel);
 
-  // Construct the output matrix.  We need to have special handling when
-  // miniKernel ended up being low-rank.
+  // Construct the transformation of the semi-kernel matrix.  We need to have
+  // special handling when miniKernel ended up being low-rank.
   arma::mat normalization = arma::diagmat(1.0 / sqrt(s));
   for (size_t i = 0; i < s.n_elem; ++i)
     if (std::abs(s[i]) <= 1e-20)
       normalization(i, i) = 0.0;
+  const arma::mat transformation = U * normalization * V;
 
-  output = semiKernel * U * normalization * V;
+  // The output is the semi-kernel matrix (with interactions between all points
+  // and the selected points) times the transformation.  Each block of rows of
+  // the semi-kernel matrix is built (in parallel) and multiplied into the
+  // output in turn, so that it never has to be held whole.
+  output.set_size(data.n_cols, rank);
+  arma::mat semiKernel;
+  for (size_t begin = 0; begin < data.n_cols; begin += blockSize)
+  {
+    const size_t count = std::min((size_t) blockSize, data.n_cols - begin);
+
+    // Alias the block of points, to avoid a copy.
+    const arma::mat block(const_cast<double*>(data.colptr(begin)), data.n_rows,
+        count, false, true);
+    KernelMatrix(block, selectedData, semiKernel, kernel);
+    output.rows(begin, begin + count - 1) = semiKernel * transformation;
+  }
 }
 
 } // namespace kernel
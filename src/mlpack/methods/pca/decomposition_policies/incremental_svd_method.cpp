@@ -0,0 +1,434 @@
+/**
+ * @file incremental_svd_method.cpp
+ *
+ * Implementation of the IncrementalSVDPolicy class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "incremental_svd_method.hpp"
+
+#include <fstream>
+#include <cstdlib>
+#include <algorithm>
+
+using namespace mlpack;
+using namespace mlpack::pca;
+
+IncrementalSVDPolicy::IncrementalSVDPolicy(const size_t rank,
+                                           const size_t batchSize) :
+    rank(rank),
+    batchSize(batchSize),
+    dimensionality(0),
+    numPoints(0),
+    scatter(0.0)
+{
+  if (batchSize == 0)
+    throw std::invalid_argument("IncrementalSVDPolicy: batch size must be "
+        "positive");
+}
+
+void IncrementalSVDPolicy::Apply(const arma::mat& /* data */,
+                                 const arma::mat& centeredData,
+                                 arma::mat& transformedData,
+                                 arma::vec& eigVal,
+                                 arma::mat& eigvec,
+                                 const size_t /* rank */)
+{
+  Reset();
+  Update(centeredData);
+
+  // The singular values are squared and divided by N - 1 to get the
+  // eigenvalues of the covariance matrix, as for the other policies.
+  eigVal = EigenValues();
+  eigvec = components;
+
+  // Project the samples to the principals.
+  transformedData = arma::trans(eigvec) * centeredData;
+}
+
+void IncrementalSVDPolicy::CheckDimensionality(
+    const size_t pointDimensionality)
+{
+  if (dimensionality == 0 && numPoints == 0)
+  {
+    dimensionality = pointDimensionality;
+  }
+  else if (pointDimensionality != dimensionality)
+  {
+    std::ostringstream oss;
+    oss << "IncrementalSVDPolicy: points have " << pointDimensionality
+        << " dimensions, but " << dimensionality << " were expected";
+    throw std::invalid_argument(oss.str());
+  }
+}
+
+void IncrementalSVDPolicy::Update(const arma::mat& data)
+{
+  if (data.n_cols == 0)
+    return;
+
+  CheckDimensionality(data.n_rows);
+
+  // Give each thread a contiguous share of at least one batch.
+  size_t numShares = 1;
+  #ifdef HAS_OPENMP
+    numShares = std::min((size_t) omp_get_max_threads(),
+        (data.n_cols + batchSize - 1) / batchSize);
+  #endif
+
+  if (numShares <= 1)
+  {
+    UpdateBatches(data, 0, data.n_cols);
+    return;
+  }
+
+  // Decompose each share separately.  The partial decompositions are merged
+  // in order afterwards, so the result does not depend on the scheduling.
+  std::vector<IncrementalSVDPolicy> partials(numShares,
+      IncrementalSVDPolicy(rank, batchSize));
+  #pragma omp parallel for schedule(static, 1)
+  for (omp_size_t i = 0; i < (omp_size_t) numShares; ++i)
+  {
+    partials[i].CheckDimensionality(dimensionality);
+    partials[i].UpdateBatches(data, i * data.n_cols / numShares,
+        (i + 1) * data.n_cols / numShares);
+  }
+
+  for (size_t i = 0; i < numShares; ++i)
+    Merge(partials[i]);
+}
+
+void IncrementalSVDPolicy::UpdateBatches(const arma::mat& data,
+                                         const size_t begin,
+                                         const size_t end)
+{
+  for (size_t first = begin; first < end; first += batchSize)
+  {
+    const size_t last = std::min(first + batchSize, end);
+    const arma::vec batchMean = arma::mean(data.cols(first, last - 1), 1);
+    const arma::mat centered = data.cols(first, last - 1).each_col() -
+        batchMean;
+
+    Combine(centered, last - first, batchMean, arma::accu(arma::square(
+        centered)));
+  }
+}
+
+void IncrementalSVDPolicy::Merge(const IncrementalSVDPolicy& other)
+{
+  if (other.numPoints == 0)
+    return;
+
+  CheckDimensionality(other.dimensionality);
+  Combine(other.components * arma::diagmat(other.singularValues),
+      other.numPoints, other.mean, other.scatter);
+}
+
+void IncrementalSVDPolicy::Combine(const arma::mat& basis,
+                                   const size_t otherPoints,
+                                   const arma::vec& otherMean,
+                                   const double otherScatter)
+{
+  // The scatter matrix of the union of both sets of points is the sum of the
+  // scatter matrices of each set, plus the outer product of the shift
+  // between the means (scaled by n1 * n2 / (n1 + n2)).  Put the square roots
+  // of all three side by side, so that the SVD of that matrix holds the
+  // decomposition of the union.
+  arma::mat stacked;
+  double shiftScatter = 0.0;
+  if (numPoints == 0)
+  {
+    stacked = basis;
+  }
+  else
+  {
+    const double weight = (double) numPoints * otherPoints /
+        (numPoints + otherPoints);
+    const arma::vec shift = std::sqrt(weight) * (mean - otherMean);
+    shiftScatter = arma::dot(shift, shift);
+
+    stacked = arma::join_rows(arma::join_rows(
+        components * arma::diagmat(singularValues), basis), shift);
+  }
+
+  arma::mat u, v;
+  arma::vec s;
+  if (!arma::svd_econ(u, s, v, stacked, 'l'))
+    throw std::runtime_error("IncrementalSVDPolicy: SVD failed");
+
+  const size_t keep = (rank == 0) ? s.n_elem :
+      std::min(rank, (size_t) s.n_elem);
+  components = u.cols(0, keep - 1);
+  singularValues = s.subvec(0, keep - 1);
+
+  if (numPoints == 0)
+    mean = otherMean;
+  else
+    mean = ((double) numPoints * mean + (double) otherPoints * otherMean) /
+        (double) (numPoints + otherPoints);
+  scatter += otherScatter + shiftScatter;
+  numPoints += otherPoints;
+}
+
+void IncrementalSVDPolicy::Transform(const arma::mat& data,
+                                     arma::mat& transformedData) const
+{
+  if (data.n_rows != dimensionality)
+  {
+    std::ostringstream oss;
+    oss << "IncrementalSVDPolicy::Transform(): points have " << data.n_rows
+        << " dimensions, but " << dimensionality << " were expected";
+    throw std::invalid_argument(oss.str());
+  }
+
+  transformedData = arma::trans(components) * (data.each_col() - mean);
+}
+
+void IncrementalSVDPolicy::Truncate(const size_t newRank)
+{
+  if (newRank < components.n_cols)
+  {
+    components.shed_cols(newRank, components.n_cols - 1);
+    singularValues.shed_rows(newRank, singularValues.n_elem - 1);
+  }
+}
+
+void IncrementalSVDPolicy::Reset()
+{
+  dimensionality = 0;
+  numPoints = 0;
+  mean.clear();
+  components.clear();
+  singularValues.clear();
+  scatter = 0.0;
+}
+
+arma::vec IncrementalSVDPolicy::EigenValues() const
+{
+  if (numPoints < 2)
+    return arma::zeros<arma::vec>(singularValues.n_elem);
+
+  return arma::square(singularValues) / (double) (numPoints - 1);
+}
+
+double IncrementalSVDPolicy::TotalVariance() const
+{
+  return (numPoints < 2) ? 0.0 : scatter / (numPoints - 1);
+}
+
+/**
+ * Parse one number of a line, and skip the separator after it.  Returns false
+ * if there is no number at p.
+ */
+static bool ParseField(const char*& p, const char* end, double& value)
+{
+  char* next;
+  value = std::strtod(p, &next);
+  if (next == p || next > end)
+    return false;
+
+  p = next;
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+    ++p;
+  if (p < end && *p == ',')
+    ++p;
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+    ++p;
+
+  return true;
+}
+
+/**
+ * Parse the line from begin to end into the given column, and return whether
+ * it holds exactly size values.  If column is NULL, the values are only
+ * counted, and the count is returned through numFields.
+ */
+static bool ParseLine(const char* begin,
+                      const char* end,
+                      double* column,
+                      const size_t size,
+                      size_t& numFields)
+{
+  const char* p = begin;
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+    ++p;
+
+  numFields = 0;
+  double value;
+  while (p < end)
+  {
+    if (!ParseField(p, end, value))
+      return false;
+    if (column && numFields >= size)
+      return false;
+    if (column)
+      column[numFields] = value;
+    ++numFields;
+  }
+
+  return (column == NULL || numFields == size);
+}
+
+/**
+ * Read the given file in chunks of chunkSize bytes, parse the complete lines
+ * of each chunk in parallel into a matrix with one point per column, and pass
+ * the matrix to handle().  If dimensionality is 0, it is set by the first
+ * line.  Errors are reported with the given function name.
+ */
+template<typename HandleType>
+static void ParseChunks(const std::string& filename,
+                        size_t dimensionality,
+                        const size_t chunkSize,
+                        const std::string& function,
+                        HandleType handle)
+{
+  std::ifstream stream(filename, std::ios::binary);
+  if (!stream.is_open())
+    throw std::runtime_error(function + ": cannot open file '" + filename +
+        "'");
+
+  // The buffer holds the incomplete last line of the previous chunk, followed
+  // by the current chunk.
+  std::vector<char> chunk(chunkSize);
+  std::string buffer;
+  std::vector<std::pair<size_t, size_t>> lines;
+  size_t lineNumber = 0;
+
+  auto parseLines = [&](const bool last)
+  {
+    // Find the non-empty complete lines in the buffer.
+    lines.clear();
+    size_t begin = 0, end, numLines = 0;
+    while (begin < buffer.size())
+    {
+      end = buffer.find('\n', begin);
+      if (end == std::string::npos)
+      {
+        if (!last)
+          break;
+        end = buffer.size();
+      }
+
+      ++numLines;
+      if (buffer.find_first_not_of(" \t\r", begin) < end)
+        lines.push_back(std::make_pair(begin, end));
+      begin = end + 1;
+    }
+
+    if (!lines.empty())
+    {
+      // The first line sets the dimensionality, if that's not known yet.
+      size_t numFields = 0;
+      if (dimensionality == 0)
+      {
+        if (!ParseLine(buffer.data() + lines[0].first,
+            buffer.data() + lines[0].second, NULL, 0, numFields) ||
+            numFields == 0)
+        {
+          throw std::runtime_error(function + ": cannot parse data in '" +
+              filename + "'");
+        }
+        dimensionality = numFields;
+      }
+
+      // Parse the lines in parallel.  Exceptions can't leave the parallel
+      // region, so just remember which line failed.
+      arma::mat values(dimensionality, lines.size());
+      size_t firstError = lines.size();
+      #pragma omp parallel for schedule(static)
+      for (omp_size_t i = 0; i < (omp_size_t) lines.size(); ++i)
+      {
+        size_t fields;
+        if (!ParseLine(buffer.data() + lines[i].first,
+            buffer.data() + lines[i].second, values.colptr(i), dimensionality,
+            fields))
+        {
+          #pragma omp critical
+          firstError = std::min(firstError, (size_t) i);
+        }
+      }
+
+      if (firstError < lines.size())
+      {
+        // Recover the line number of the failed line.
+        const size_t errorLine = lineNumber + 1 + std::count(buffer.begin(),
+            buffer.begin() + lines[firstError].first, '\n');
+        std::ostringstream oss;
+        oss << function << ": cannot parse line " << errorLine << " of '"
+            << filename << "' as " << dimensionality << " dimensions";
+        throw std::runtime_error(oss.str());
+      }
+
+      handle(values);
+    }
+
+    lineNumber += numLines;
+    buffer.erase(0, std::min(begin, buffer.size()));
+  };
+
+  while (stream)
+  {
+    stream.read(chunk.data(), chunkSize);
+    const size_t count = (size_t) stream.gcount();
+    if (count == 0)
+      break;
+    buffer.append(chunk.data(), count);
+    parseLines(false);
+  }
+
+  if (stream.bad())
+    throw std::runtime_error(function + ": error reading file '" + filename +
+        "'");
+
+  // The last line may not end with a newline.
+  parseLines(true);
+}
+
+void IncrementalSVDPolicy::UpdateFile(const std::string& filename,
+                                      const size_t chunkSize)
+{
+  ParseChunks(filename, dimensionality, chunkSize,
+      "IncrementalSVDPolicy::UpdateFile()",
+      [this](const arma::mat& values) { Update(values); });
+}
+
+void IncrementalSVDPolicy::Update(data::StreamReader& reader)
+{
+  arma::mat chunk;
+  while (reader.Next(chunk))
+    Update(chunk);
+}
+
+void IncrementalSVDPolicy::TransformFile(const std::string& filename,
+                                         arma::mat& transformedData,
+                                         const size_t chunkSize) const
+{
+  if (dimensionality == 0)
+    throw std::invalid_argument("IncrementalSVDPolicy::TransformFile(): no "
+        "points have been added");
+
+  // Project each chunk as it is parsed, and put the projections together at
+  // the end.
+  std::vector<arma::mat> projected;
+  size_t numProjected = 0;
+  ParseChunks(filename, dimensionality, chunkSize,
+      "IncrementalSVDPolicy::TransformFile()",
+      [&](const arma::mat& values)
+      {
+        projected.push_back(arma::mat());
+        Transform(values, projected.back());
+        numProjected += values.n_cols;
+      });
+
+  transformedData.set_size(components.n_cols, numProjected);
+  size_t column = 0;
+  for (size_t i = 0; i < projected.size(); ++i)
+  {
+    transformedData.cols(column, column + projected[i].n_cols - 1) =
+        projected[i];
+    column += projected[i].n_cols;
+  }
+}
@@ -0,0 +1,224 @@
+/**
+ * @file incremental_svd_method.hpp
+ *
+ * Implementation of the incremental SVD policy for use in the Principal
+ * Components Analysis method.  The decomposition is updated from chunks of the
+ * data, so the data never has to be in memory all at once.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+
+#ifndef MLPACK_METHODS_PCA_DECOMPOSITION_POLICIES_INCREMENTAL_SVD_METHOD_HPP
+#define MLPACK_METHODS_PCA_DECOMPOSITION_POLICIES_INCREMENTAL_SVD_METHOD_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/data/stream_reader.hpp>
+
+namespace mlpack {
+namespace pca {
+
+/**
+ * Implementation of the incremental SVD policy.  The policy holds the mean, the
+ * number of points and a (possibly truncated) SVD of the centered points seen
+ * so far, and each chunk of points updates it: the scaled singular vectors,
+ * the centered chunk and a column for the shift of the mean are put side by
+ * side, and the SVD of that matrix is truncated to the given rank (Ross et al.,
+ * "Incremental Learning for Robust Visual Tracking", 2008).  If the rank is 0,
+ * nothing is truncated and the result is the same as the exact SVD of the
+ * whole dataset.
+ *
+ * Two policies built from different parts of a dataset can be merged the same
+ * way, so Update() splits large chunks between threads (if OpenMP is
+ * available) and merges the partial decompositions, and UpdateFile() streams
+ * a text file through the policy.  Transform() and TransformFile() project new
+ * points onto the components without refitting.
+ *
+ * @code
+ * IncrementalSVDPolicy svd(10); // Keep 10 components.
+ * svd.UpdateFile("huge_dataset.csv");
+ *
+ * arma::mat reduced;
+ * svd.TransformFile("huge_dataset.csv", reduced);
+ * @endcode
+ *
+ * When used by PCA, the policy decomposes the centered data in chunks of
+ * batchSize points with its own rank (like the QUIC-SVD policy, it does not
+ * use the rank requested by PCA), so with the default rank of 0 the results of
+ * PCA are exact.
+ */
+class IncrementalSVDPolicy
+{
+ public:
+  /**
+   * Create an empty incremental SVD.
+   *
+   * @param rank Number of components to keep (0 keeps all of them).
+   * @param batchSize Number of points to update the SVD with at once.
+   */
+  IncrementalSVDPolicy(const size_t rank = 0, const size_t batchSize = 4096);
+
+  /**
+   * Apply Principal Component Analysis to the provided data set using the
+   * incremental SVD.  Any points added before are discarded.
+   *
+   * @param data Data matrix.
+   * @param centeredData Centered data matrix.
+   * @param transformedData Matrix to put results of PCA into.
+   * @param eigVal Vector to put eigenvalues into.
+   * @param eigvec Matrix to put eigenvectors (loadings) into.
+   * @param rank Rank of the decomposition (ignored; Rank() is used).
+   */
+  void Apply(const arma::mat& data,
+             const arma::mat& centeredData,
+             arma::mat& transformedData,
+             arma::vec& eigVal,
+             arma::mat& eigvec,
+             const size_t rank);
+
+  /**
+   * Update the decomposition with the given points (one per column), in
+   * batches of BatchSize() points.  If there are enough batches, they are
+   * split between threads, and the partial decompositions are merged.  If
+   * the dimensionality of the points does not match the points added before,
+   * std::invalid_argument is thrown.
+   *
+   * @param data Points to add.
+   */
+  void Update(const arma::mat& data);
+
+  /**
+   * Merge the decomposition of another set of points (of the same
+   * dimensionality) into this one.
+   *
+   * @param other Decomposition to merge into this one.
+   */
+  void Merge(const IncrementalSVDPolicy& other);
+
+  /**
+   * Update the decomposition with every point of the given text file.  Each
+   * line of the file holds one point, with its dimensions separated by commas,
+   * tabs or spaces; empty lines are skipped.  The file is read in chunks of
+   * the given number of bytes, and the lines of each chunk are parsed in
+   * parallel and passed to Update().
+   *
+   * If the file cannot be read, a line cannot be parsed, or a line has the
+   * wrong number of values, std::runtime_error is thrown.
+   *
+   * @param filename File to read points from.
+   * @param chunkSize Number of bytes of the file to read at once.
+   */
+  void UpdateFile(const std::string& filename,
+                  const size_t chunkSize = (1 << 26));
+
+  /**
+   * Update the decomposition with every remaining point of the given stream,
+   * one chunk at a time.
+   *
+   * @param reader Stream to read points from.
+   */
+  void Update(data::StreamReader& reader);
+
+  /**
+   * Project the given points onto the components, after centering them with
+   * the mean of the points the decomposition was built from.
+   *
+   * @param data Points to project.
+   * @param transformedData Matrix to store the projected points in.
+   */
+  void Transform(const arma::mat& data, arma::mat& transformedData) const;
+
+  /**
+   * Project every point of the given text file (in the format of
+   * UpdateFile()) onto the components.  The file is read in chunks of the
+   * given number of bytes.
+   *
+   * @param filename File to read points from.
+   * @param transformedData Matrix to store the projected points in.
+   * @param chunkSize Number of bytes of the file to read at once.
+   */
+  void TransformFile(const std::string& filename,
+                     arma::mat& transformedData,
+                     const size_t chunkSize = (1 << 26)) const;
+
+  /**
+   * Drop every component past the given number of components.
+   *
+   * @param newRank Number of components to keep.
+   */
+  void Truncate(const size_t newRank);
+
+  //! Forget every point added so far.
+  void Reset();
+
+  //! Get the number of components to keep (0 keeps all of them).
+  size_t Rank() const { return rank; }
+  //! Modify the number of components to keep (0 keeps all of them).
+  size_t& Rank() { return rank; }
+
+  //! Get the number of points to update the SVD with at once.
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the number of points to update the SVD with at once.
+  size_t& BatchSize() { return batchSize; }
+
+  //! Get the dimensionality of the points.
+  size_t Dimensionality() const { return dimensionality; }
+  //! Get the number of points added.
+  size_t NumPoints() const { return numPoints; }
+  //! Get the mean of the points added.
+  const arma::vec& Mean() const { return mean; }
+  //! Get the components (left singular vectors), one per column.
+  const arma::mat& Components() const { return components; }
+  //! Get the singular values of the centered points.
+  const arma::vec& SingularValues() const { return singularValues; }
+
+  //! Get the eigenvalues of the covariance matrix for the components.
+  arma::vec EigenValues() const;
+  //! Get the total variance of the points (the trace of their covariance),
+  //! including the variance of any components that were dropped.
+  double TotalVariance() const;
+
+ private:
+  //! Set the dimensionality, if it is not set yet, and check it.
+  void CheckDimensionality(const size_t pointDimensionality);
+
+  //! Update the decomposition with the given columns of data, one batch at a
+  //! time.
+  void UpdateBatches(const arma::mat& data,
+                     const size_t begin,
+                     const size_t end);
+
+  /**
+   * Combine the decomposition with that of another set of points, given by a
+   * basis whose outer product is the scatter matrix of the points, their
+   * number, mean and total scatter.
+   */
+  void Combine(const arma::mat& basis,
+               const size_t otherPoints,
+               const arma::vec& otherMean,
+               const double otherScatter);
+
+  //! The number of components to keep.
+  size_t rank;
+  //! The number of points to update the SVD with at once.
+  size_t batchSize;
+  //! The dimensionality of the points.
+  size_t dimensionality;
+  //! The number of points added.
+  size_t numPoints;
+  //! The mean of the points added.
+  arma::vec mean;
+  //! The left singular vectors of the centered points.
+  arma::mat components;
+  //! The singular values of the centered points.
+  arma::vec singularValues;
+  //! The sum of the squared distances of the points to their mean.
+  double scatter;
+};
+
+} // namespace pca
+} // namespace mlpack
+
+#endif
@@ -104,6 +104,23 @@ class PCA
    */
   double Apply(arma::mat& data, const double varRetained);
 
+  /**
+   * Project new points onto the principal components found by the last call
+   * to Apply(), without refitting.  The points are centered (and scaled, if
+   * the data was scaled) with the statistics of the data given to Apply(),
+   * and projected onto as many components as Apply() kept.  It is safe to
+   * pass the same matrix reference for both data and transformedData.
+   *
+   * @param data Points to project.
+   * @param transformedData Matrix to store the projected points in.
+   */
+  void Transform(const arma::mat& data, arma::mat& transformedData) const;
+
+  //! Get the mean of the data given to the last call to Apply().
+  const arma::vec& Mean() const { return mean; }
+  //! Get the principal components kept by the last call to Apply().
+  const arma::mat& Components() const { return components; }
+
   //! Get whether or not this PCA object will scale (by standard deviation)
   //! the data when PCA is performed.
   bool ScaleData() const { return scaleData; }
@@ -120,8 +137,7 @@ class PCA
       // Scaling the data is when we reduce the variance of each dimension
       // to 1. We do this by dividing each dimension by its standard
       // deviation.
-      arma::vec stdDev = arma::stddev(
-          centeredData, 0, 1 /* for each dimension */);
+      stdDev = arma::stddev(centeredData, 0, 1 /* for each dimension */);
 
       // If there are any zeroes, make them very small.
       for (size_t i = 0; i < stdDev.n_elem; ++i)
@@ -130,6 +146,17 @@ class PCA
 
       centeredData /= arma::repmat(stdDev, 1, centeredData.n_cols);
     }
+    else
+    {
+      stdDev.clear();
+    }
+  }
+
+  //! Center the data into centeredData, and remember the mean.
+  void CenterData(const arma::mat& data, arma::mat& centeredData)
+  {
+    mean = arma::mean(data, 1);
+    centeredData = data.each_col() - mean;
   }
 
   //! Whether or not the data will be scaled by standard deviation when PCA is
@@ -138,6 +165,14 @@ class PCA
 
   //! Decomposition method used to perform principal components analysis.
   DecompositionPolicy decomposition;
+
+  //! The mean of the data given to the last call to Apply().
+  arma::vec mean;
+  //! The standard deviation of each dimension of the centered data, if it was
+  //! scaled.
+  arma::vec stdDev;
+  //! The principal components kept by the last call to Apply().
+  arma::mat components;
 }; // class PCA
 
 } // namespace pca
@@ -50,13 +50,14 @@ void PCA<DecompositionPolicy>::Apply(const arma::mat& data,
 
   // Center the data into a temporary matrix.
   arma::mat centeredData;
-  math::Center(data, centeredData);
+  CenterData(data, centeredData);
 
   // Scale the data if the user ask for.
   ScaleData(centeredData);
 
   decomposition.Apply(data, centeredData, transformedData, eigVal, eigvec,
       data.n_rows);
+  components = eigvec;
 
   Timer::Stop("pca");
 }
@@ -108,16 +109,19 @@ double PCA<DecompositionPolicy>::Apply(arma::mat& data,
 
   // Center the data into a temporary matrix.
   arma::mat centeredData;
-  math::Center(data, centeredData);
+  CenterData(data, centeredData);
 
   // Scale the data if the user ask for.
   ScaleData(centeredData);
 
   decomposition.Apply(data, centeredData, data, eigVal, eigvec, newDimension);
 
-  if (newDimension < eigvec.n_rows)
-    // Drop unnecessary rows.
+  // Drop unnecessary rows.  Some decomposition policies may keep fewer
+  // components than there are dimensions.
+  if (newDimension < data.n_rows)
     data.shed_rows(newDimension, data.n_rows - 1);
+  components = eigvec.cols(0, std::min(newDimension, (size_t) eigvec.n_cols) -
+      1);
 
   // The svd method returns only non-zero eigenvalues so we have to calculate
   // the right dimension before calculating the amount of variance retained.
@@ -168,11 +172,41 @@ double PCA<DecompositionPolicy>::Apply(arma::mat& data,
 
   // varSum is the actual variance we will retain.
   if (newDimension < eigVal.n_elem)
+  {
     data.shed_rows(newDimension, data.n_rows - 1);
+    components.shed_cols(newDimension, components.n_cols - 1);
+  }
 
   return varSum;
 }
 
+/**
+ * Project new points onto the principal components found by the last call to
+ * Apply().
+ *
+ * @param data Points to project.
+ * @param transformedData Matrix to store the projected points in.
+ */
+template<typename DecompositionPolicy>
+void PCA<DecompositionPolicy>::Transform(const arma::mat& data,
+                                         arma::mat& transformedData) const
+{
+  // Parameter validation.
+  if (components.is_empty())
+    Log::Fatal << "PCA::Transform(): no principal components; call Apply() "
+        << "first!" << endl;
+  if (data.n_rows != mean.n_elem)
+    Log::Fatal << "PCA::Transform(): dimensionality of the data ("
+        << data.n_rows << ") must match the dimensionality of the data given "
+        << "to Apply() (" << mean.n_elem << ")!" << endl;
+
+  arma::mat centeredData = data.each_col() - mean;
+  if (!stdDev.is_empty())
+    centeredData.each_col() /= stdDev;
+
+  transformedData = arma::trans(components) * centeredData;
+}
+
 } // namespace pca
 } // namespace mlpack
 
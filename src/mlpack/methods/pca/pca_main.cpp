@@ -16,6 +16,7 @@
 
 #include "pca.hpp"
 #include <mlpack/methods/pca/decomposition_policies/exact_svd_method.hpp>
+#include <mlpack/methods/pca/decomposition_policies/incremental_svd_method.hpp>
 #include <mlpack/methods/pca/decomposition_policies/quic_svd_method.hpp>
 #include <mlpack/methods/pca/decomposition_policies/randomized_svd_method.hpp>
 #include <mlpack/methods/pca/decomposition_policies/randomized_block_krylov_method.hpp>
@@ -34,7 +35,8 @@ PROGRAM_INFO("Principal Components Analysis",
     "linear transformation determined by PCA.",
     // Long description.
     "This program performs principal components analysis on the given dataset "
-    "using the exact, randomized, randomized block Krylov, or QUIC SVD method. "
+    "using the exact, randomized, randomized block Krylov, QUIC, or "
+    "incremental SVD method.  "
     "It will transform the data onto its principal components, optionally "
     "performing dimensionality reduction by ignoring the principal components "
     "with the smallest eigenvalues."
@@ -50,7 +52,17 @@ PROGRAM_INFO("Principal Components Analysis",
     "Multiple different decomposition techniques can be used.  The method to "
     "use can be specified with the " +
     PRINT_PARAM_STRING("decomposition_method") + " parameter, and it may take "
-    "the values 'exact', 'randomized', or 'quic'."
+    "the values 'exact', 'randomized', 'randomized-block-krylov', 'quic', or "
+    "'incremental'.  The 'incremental' method updates the decomposition with "
+    "batches of points (their number can be set with the " +
+    PRINT_PARAM_STRING("batch_size") + " parameter), split between threads."
+    "\n\n"
+    "Datasets too large to load into memory may be given as a text file with "
+    "the " + PRINT_PARAM_STRING("input_file") + " parameter instead of the " +
+    PRINT_PARAM_STRING("input") + " parameter.  The file is read in chunks "
+    "twice with the 'incremental' method: once to find the principal "
+    "components, and once to project the points onto them.  Scaling is not "
+    "supported for such files."
     "\n\n"
     "For example, to reduce the dimensionality of the matrix " +
     PRINT_DATASET("data") + " to 5 dimensions using randomized SVD for the "
@@ -65,7 +77,12 @@ PROGRAM_INFO("Principal Components Analysis",
         "@doxygen/classmlpack_1_1pca_1_1PCA.html"));
 
 // Parameters for program.
-PARAM_MATRIX_IN_REQ("input", "Input dataset to perform PCA on.", "i");
+PARAM_MATRIX_IN("input", "Input dataset to perform PCA on.", "i");
+// Large datasets may instead be streamed from a file through the incremental
+// SVD.
+PARAM_STRING_IN("input_file", "Text file of points (one per line) to perform "
+    "PCA on; it is read in chunks with the 'incremental' method, for datasets "
+    "too large to load with --input.", "F", "");
 PARAM_MATRIX_OUT("output", "Matrix to save modified dataset to.", "o");
 PARAM_INT_IN("new_dimensionality", "Desired dimensionality of output dataset. "
     "If 0, no dimensionality reduction is performed.", "d", 0);
@@ -77,7 +94,9 @@ PARAM_FLAG("scale", "If set, the data will be scaled before running PCA, such "
 
 PARAM_STRING_IN("decomposition_method", "Method used for the principal "
     "components analysis: 'exact', 'randomized', 'randomized-block-krylov', "
-    "'quic'.", "c", "exact");
+    "'quic', 'incremental'.", "c", "exact");
+PARAM_INT_IN("batch_size", "Number of points to update the decomposition with "
+    "at once, for the 'incremental' method.", "b", 4096);
 
 
 //! Run RunPCA on the specified dataset with the given decomposition method.
@@ -85,9 +104,10 @@ template<typename DecompositionPolicy>
 void RunPCA(arma::mat& dataset,
             const size_t newDimension,
             const bool scale,
-            const double varToRetain)
+            const double varToRetain,
+            const DecompositionPolicy& decomposition = DecompositionPolicy())
 {
-  PCA<DecompositionPolicy> p(scale);
+  PCA<DecompositionPolicy> p(scale, decomposition);
 
   Log::Info << "Performing PCA on dataset..." << endl;
   double varRetained;
@@ -109,22 +129,109 @@ void RunPCA(arma::mat& dataset,
       dataset.n_rows << " dimensions)." << endl;
 }
 
+//! Run PCA on the points of the given file with the incremental SVD, reading
+//! the file once to fit and once to transform.
+void RunIncrementalPCAOnFile(const string& filename,
+                             const size_t newDimension,
+                             const double varToRetain,
+                             const size_t batchSize)
+{
+  // If the variance to retain is given, all the components are needed to find
+  // out how many to keep.
+  const bool useVariance = CLI::HasParam("var_to_retain");
+  if (useVariance && CLI::HasParam("new_dimensionality"))
+    Log::Warn << "New dimensionality (-d) ignored because --var_to_retain "
+        << "(-r) was specified." << endl;
+  IncrementalSVDPolicy svd(useVariance ? 0 : newDimension, batchSize);
+
+  Log::Info << "Performing PCA on '" << filename << "'..." << endl;
+  Timer::Start("pca");
+  svd.UpdateFile(filename);
+  Timer::Stop("pca");
+
+  if (newDimension > svd.Dimensionality())
+  {
+    Log::Fatal << "Invalid value for new dimensionality: cannot be greater "
+        << "than existing dimensionality (" << svd.Dimensionality() << ")!"
+        << endl;
+  }
+
+  // Find the number of components to keep, as PCA::Apply() does.
+  const arma::vec eigVal = svd.EigenValues();
+  const double totalVariance = svd.TotalVariance();
+  size_t dimension = eigVal.n_elem;
+  double varSum = arma::accu(eigVal);
+  if (useVariance && totalVariance > 0.0)
+  {
+    dimension = 0;
+    varSum = 0.0;
+    while ((varSum < varToRetain * totalVariance) &&
+        (dimension < eigVal.n_elem))
+    {
+      varSum += eigVal[dimension];
+      ++dimension;
+    }
+    svd.Truncate(dimension);
+  }
+
+  Log::Info << ((totalVariance > 0.0) ? (varSum / totalVariance * 100) : 100)
+      << "% of variance retained (" << dimension << " dimensions)." << endl;
+
+  if (CLI::HasParam("output"))
+  {
+    Timer::Start("pca_transform");
+    svd.TransformFile(filename, CLI::GetParam<arma::mat>("output"));
+    Timer::Stop("pca_transform");
+  }
+}
+
 static void mlpackMain()
 {
-  // Load input dataset.
-  arma::mat& dataset = CLI::GetParam<arma::mat>("input");
+  RequireOnlyOnePassed({ "input", "input_file" }, true);
 
   // Issue a warning if the user did not specify an output file.
   RequireAtLeastOnePassed({ "output" }, false, "no output will be saved");
 
   // Check decomposition method validity.
   RequireParamInSet<string>("decomposition_method", { "exact", "randomized",
-      "randomized-block-krylov", "quic" }, true,
+      "randomized-block-krylov", "quic", "incremental" }, true,
       "unknown decomposition method");
+  RequireParamValue<int>("batch_size", [](int x) { return x > 0; }, true,
+      "batch size must be positive");
+  const size_t batchSize = (size_t) CLI::GetParam<int>("batch_size");
 
-  // Find out what dimension we want.
   RequireParamValue<int>("new_dimensionality", [](int x) { return x >= 0; },
       true, "new dimensionality must be non-negative");
+  RequireParamValue<double>("var_to_retain",
+      [](double x) { return x >= 0.0 && x <= 1.0; }, true,
+      "variance retained must be between 0 and 1");
+
+  if (CLI::HasParam("input_file"))
+  {
+    // The file is streamed through the incremental SVD, so the other methods
+    // and scaling (which needs another pass over the data) can't be used.
+    if (CLI::GetParam<string>("decomposition_method") != "incremental")
+      Log::Fatal << "--input_file (-F) requires --decomposition_method (-c) "
+          << "'incremental'." << endl;
+    if (CLI::HasParam("scale"))
+      Log::Fatal << "--scale (-s) is not supported with --input_file (-F)."
+          << endl;
+
+    RunIncrementalPCAOnFile(CLI::GetParam<string>("input_file"),
+        (size_t) CLI::GetParam<int>("new_dimensionality"),
+        CLI::GetParam<double>("var_to_retain"), batchSize);
+    return;
+  }
+
+  if (CLI::HasParam("batch_size") &&
+      CLI::GetParam<string>("decomposition_method") != "incremental")
+    Log::Warn << "--batch_size (-b) ignored because --decomposition_method "
+        << "(-c) is not 'incremental'." << endl;
+
+  // Load input dataset.
+  arma::mat& dataset = CLI::GetParam<arma::mat>("input");
+
+  // Find out what dimension we want.
   std::ostringstream error;
   error << "cannot be greater than existing dimensionality (" << dataset.n_rows
       << ")";
@@ -132,9 +239,6 @@ static void mlpackMain()
       [dataset](int x) { return x <= (int) dataset.n_rows; }, true,
       error.str());
 
-  RequireParamValue<double>("var_to_retain",
-      [](double x) { return x >= 0.0 && x <= 1.0; }, true,
-      "variance retained must be between 0 and 1");
   size_t newDimension = (CLI::GetParam<int>("new_dimensionality") == 0) ?
       dataset.n_rows : CLI::GetParam<int>("new_dimensionality");
 
@@ -162,6 +266,11 @@ static void mlpackMain()
   {
     RunPCA<QUICSVDPolicy>(dataset, newDimension, scale, varToRetain);
   }
+  else if (decompositionMethod == "incremental")
+  {
+    RunPCA<IncrementalSVDPolicy>(dataset, newDimension, scale, varToRetain,
+        IncrementalSVDPolicy(0, batchSize));
+  }
 
   // Now save the results.
   if (CLI::HasParam("output"))
@@ -95,6 +95,13 @@ class Perceptron
    * This training does not reset the model weights, so you can call Train() on
    * multiple datasets sequentially.
    *
+   * If Parallel() is set, each pass through the data is split into one shard
+   * per thread (if OpenMP is available).  Each thread runs the perceptron
+   * algorithm on its shard, starting from a copy of the current weights, and
+   * the weights of the threads are averaged at the end of the pass (this is
+   * iterative parameter mixing).  Like the sequential algorithm, this
+   * converges if the data is linearly separable.
+   *
    * @param data Dataset on which training should be performed.
    * @param labels Labels of the dataset.
    * @param numClasses Number of classes in the data.
@@ -108,7 +115,9 @@ class Perceptron
 
   /**
    * Classification function. After training, use the weights matrix to
-   * classify test, and put the predicted classes in predictedLabels.
+   * classify test, and put the predicted classes in predictedLabels.  The
+   * scores of all classes are computed for blocks of points at once, with one
+   * matrix product per block.
    *
    * @param test Testing data or data to classify.
    * @param predictedLabels Vector to store the predicted classes after
@@ -127,6 +136,11 @@ class Perceptron
   //! Modify the maximum number of iterations.
   size_t& MaxIterations() { return maxIterations; }
 
+  //! Get whether training runs in parallel with averaged weights.
+  bool Parallel() const { return parallel; }
+  //! Modify whether training runs in parallel with averaged weights.
+  bool& Parallel() { return parallel; }
+
   //! Get the number of classes this perceptron has been trained for.
   size_t NumClasses() const { return weights.n_cols; }
 
@@ -154,6 +168,30 @@ class Perceptron
 
   //! The biases for each class.
   arma::vec biases;
+
+  //! Whether training runs in parallel with averaged weights.
+  bool parallel;
+
+  /**
+   * Run one pass of the perceptron learning algorithm over the points of the
+   * dataset from begin to end (not included), updating the given weights and
+   * biases, and return whether all of the points were classified correctly.
+   *
+   * @param data Dataset on which training should be performed.
+   * @param labels Labels of the dataset.
+   * @param instanceWeights Cost of mispredicting each point (may be empty).
+   * @param begin Index of the first point to train on.
+   * @param end Index after the last point to train on.
+   * @param passWeights Weights to update.
+   * @param passBiases Biases to update.
+   */
+  bool TrainPass(const MatType& data,
+                 const arma::Row<size_t>& labels,
+                 const arma::rowvec& instanceWeights,
+                 const size_t begin,
+                 const size_t end,
+                 arma::mat& passWeights,
+                 arma::vec& passBiases) const;
 };
 
 } // namespace perceptron
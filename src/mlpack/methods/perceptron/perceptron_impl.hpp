@@ -30,7 +30,8 @@ Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Perceptron(
     const size_t numClasses,
     const size_t dimensionality,
     const size_t maxIterations) :
-    maxIterations(maxIterations)
+    maxIterations(maxIterations),
+    parallel(false)
 {
   WeightInitializationPolicy wip;
   wip.Initialize(weights, biases, dimensionality, numClasses);
@@ -56,7 +57,8 @@ Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Perceptron(
     const arma::Row<size_t>& labels,
     const size_t numClasses,
     const size_t maxIterations) :
-    maxIterations(maxIterations)
+    maxIterations(maxIterations),
+    parallel(false)
 {
   // Start training.
   Train(data, labels, numClasses);
@@ -84,7 +86,8 @@ Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Perceptron(
     const arma::Row<size_t>& labels,
     const size_t numClasses,
     const arma::rowvec& instanceWeights) :
-    maxIterations(other.maxIterations)
+    maxIterations(other.maxIterations),
+    parallel(other.parallel)
 {
   Train(data, labels, numClasses, instanceWeights);
 }
@@ -106,15 +109,23 @@ void Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Classify(
     const MatType& test,
     arma::Row<size_t>& predictedLabels)
 {
-  arma::vec tempLabelMat;
-  arma::uword maxIndex = 0;
+  predictedLabels.set_size(test.n_cols);
 
-  // Could probably be faster if done in batch.
-  for (size_t i = 0; i < test.n_cols; i++)
+  // Compute the scores of a block of points with one matrix product, so the
+  // memory used for the scores stays bounded.
+  const size_t blockSize = 4096;
+  const size_t numBlocks = (test.n_cols + blockSize - 1) / blockSize;
+  #pragma omp parallel for schedule(static)
+  for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
   {
-    tempLabelMat = weights.t() * test.col(i) + biases;
-    tempLabelMat.max(maxIndex);
-    predictedLabels(0, i) = maxIndex;
+    const size_t begin = b * blockSize;
+    const size_t end = std::min((size_t) test.n_cols, begin + blockSize);
+
+    arma::mat scores = weights.t() * test.cols(begin, end - 1);
+    scores.each_col() += biases;
+
+    for (size_t i = begin; i < end; ++i)
+      predictedLabels[i] = scores.col(i - begin).index_max();
   }
 }
 
@@ -139,14 +150,78 @@ void Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Train(
     const arma::rowvec& instanceWeights)
 {
   // Do we need to resize the weights?
-  if (weights.n_elem != numClasses)
+  if (weights.n_cols != numClasses || weights.n_rows != data.n_rows)
   {
     WeightInitializationPolicy wip;
     wip.Initialize(weights, biases, data.n_rows, numClasses);
   }
 
-  size_t j, i = 0;
+  size_t numShards = 1;
+  #ifdef HAS_OPENMP
+    if (parallel)
+      numShards = omp_get_max_threads();
+  #endif
+  numShards = std::max((size_t) 1, std::min(numShards, (size_t) data.n_cols));
+
+  size_t i = 0;
   bool converged = false;
+  while ((i < maxIterations) && (!converged))
+  {
+    // This outer loop is for each iteration, and we use the 'converged'
+    // variable for noting whether or not convergence has been reached.
+    i++;
+
+    if (numShards == 1)
+    {
+      converged = TrainPass(data, labels, instanceWeights, 0, data.n_cols,
+          weights, biases);
+      continue;
+    }
+
+    // Each thread trains a copy of the weights on its own shard of the data,
+    // and the copies are averaged.
+    converged = true;
+    arma::mat weightSum(weights.n_rows, weights.n_cols, arma::fill::zeros);
+    arma::vec biasSum(biases.n_elem, arma::fill::zeros);
+
+    #pragma omp parallel for schedule(static)
+    for (omp_size_t s = 0; s < (omp_size_t) numShards; ++s)
+    {
+      arma::mat shardWeights = weights;
+      arma::vec shardBiases = biases;
+      const bool shardConverged = TrainPass(data, labels, instanceWeights,
+          s * data.n_cols / numShards, (s + 1) * data.n_cols / numShards,
+          shardWeights, shardBiases);
+
+      #pragma omp critical
+      {
+        weightSum += shardWeights;
+        biasSum += shardBiases;
+        if (!shardConverged)
+          converged = false;
+      }
+    }
+
+    weights = weightSum / numShards;
+    biases = biasSum / numShards;
+  }
+}
+
+template<
+    typename LearnPolicy,
+    typename WeightInitializationPolicy,
+    typename MatType
+>
+bool Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::TrainPass(
+    const MatType& data,
+    const arma::Row<size_t>& labels,
+    const arma::rowvec& instanceWeights,
+    const size_t begin,
+    const size_t end,
+    arma::mat& passWeights,
+    arma::vec& passBiases) const
+{
+  bool converged = true;
   size_t tempLabel;
   arma::uword maxIndexRow = 0, maxIndexCol = 0;
   arma::mat tempLabelMat;
@@ -155,41 +230,35 @@ void Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Train(
 
   const bool hasWeights = (instanceWeights.n_elem > 0);
 
-  while ((i < maxIterations) && (!converged))
+  // Now this loop is for going through the dataset in each iteration.
+  for (size_t j = begin; j < end; j++)
   {
-    // This outer loop is for each iteration, and we use the 'converged'
-    // variable for noting whether or not convergence has been reached.
-    i++;
-    converged = true;
+    // Multiply for each variable and check whether the current weight vector
+    // correctly classifies this.
+    tempLabelMat = passWeights.t() * data.col(j) + passBiases;
 
-    // Now this inner loop is for going through the dataset in each iteration.
-    for (j = 0; j < data.n_cols; j++)
-    {
-      // Multiply for each variable and check whether the current weight vector
-      // correctly classifies this.
-      tempLabelMat = weights.t() * data.col(j) + biases;
+    tempLabelMat.max(maxIndexRow, maxIndexCol);
 
-      tempLabelMat.max(maxIndexRow, maxIndexCol);
+    // Check whether prediction is correct.
+    if (maxIndexRow != labels(0, j))
+    {
+      // Due to incorrect prediction, convergence set to false.
+      converged = false;
+      tempLabel = labels(0, j);
 
-      // Check whether prediction is correct.
-      if (maxIndexRow != labels(0, j))
-      {
-        // Due to incorrect prediction, convergence set to false.
-        converged = false;
-        tempLabel = labels(0, j);
-
-        // Send maxIndexRow for knowing which weight to update, send j to know
-        // the value of the vector to update it with.  Send tempLabel to know
-        // the correct class.
-        if (hasWeights)
-          LP.UpdateWeights(data.col(j), weights, biases, maxIndexRow, tempLabel,
-              instanceWeights(j));
-        else
-          LP.UpdateWeights(data.col(j), weights, biases, maxIndexRow,
-              tempLabel);
-      }
+      // Send maxIndexRow for knowing which weight to update, send j to know
+      // the value of the vector to update it with.  Send tempLabel to know
+      // the correct class.
+      if (hasWeights)
+        LP.UpdateWeights(data.col(j), passWeights, passBiases, maxIndexRow,
+            tempLabel, instanceWeights(j));
+      else
+        LP.UpdateWeights(data.col(j), passWeights, passBiases, maxIndexRow,
+            tempLabel);
     }
   }
+
+  return converged;
 }
 
 //! Serialize the perceptron.
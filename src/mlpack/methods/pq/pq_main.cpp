@@ -0,0 +1,292 @@
+/**
+ * @file pq_main.cpp
+ *
+ * This file computes approximate nearest neighbors on a reference set
+ * compressed with product quantization.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/cli.hpp>
+#include <mlpack/core/util/mlpack_main.hpp>
+
+#include <mlpack/methods/lsh/lsh_search.hpp>
+
+#include "pq_search.hpp"
+
+using namespace std;
+using namespace mlpack;
+using namespace mlpack::neighbor;
+using namespace mlpack::util;
+
+// Information about the program itself.
+PROGRAM_INFO("K-Approximate-Nearest-Neighbor Search with Product Quantization",
+    // Short description.
+    "An implementation of approximate k-nearest-neighbor search on a reference "
+    "set compressed with product quantization, optionally with a coarse "
+    "inverted file.  Given a set of reference points and a set of query points,"
+    " this will compute the k approximate nearest neighbors of each query point"
+    " in the reference set; models can be saved for future use.",
+    // Long description.
+    "This program will calculate the k approximate-nearest-neighbors of a set "
+    "of points with product quantization.  Each reference point is stored as "
+    "one byte per subspace: the dimensions are split into " +
+    PRINT_PARAM_STRING("subspaces") + " subspaces, and in each of them the "
+    "point is replaced by the index of the closest of " +
+    PRINT_PARAM_STRING("centroids") + " centroids found with k-means.  The "
+    "distances between a query and the reference points are approximated from "
+    "a table of the distances between the query and the centroids.  The "
+    "reference points themselves are not stored in the model, so a model only "
+    "takes a small fraction of the memory of the reference set."
+    "\n\n"
+    "If " + PRINT_PARAM_STRING("lists") + " is not 0, the reference points are "
+    "first clustered into that many lists, the residuals of the points to the "
+    "centers of their lists are encoded, and each query only scans the " +
+    PRINT_PARAM_STRING("num_probes") + " lists with the closest centers.  "
+    "Increasing " + PRINT_PARAM_STRING("num_probes") + " increases the recall "
+    "and the search time."
+    "\n\n"
+    "For example, the following will return 5 neighbors from the data for each "
+    "point in " + PRINT_DATASET("input") + " and store the distances in " +
+    PRINT_DATASET("distances") + " and the neighbors in " +
+    PRINT_DATASET("neighbors") + ":"
+    "\n\n" +
+    PRINT_CALL("pq", "k", 5, "reference", "input", "distances", "distances",
+        "neighbors", "neighbors") +
+    "\n\n"
+    "The following will encode " + PRINT_DATASET("input") + " with 16 "
+    "subspaces and 1000 lists, save the model to " + PRINT_MODEL("model") +
+    ", and search for the 10 approximate nearest neighbors of the points in " +
+    PRINT_DATASET("queries") + " in the 20 closest lists:"
+    "\n\n" +
+    PRINT_CALL("pq", "reference", "input", "subspaces", 16, "lists", 1000,
+        "query", "queries", "k", 10, "num_probes", 20, "neighbors",
+        "neighbors", "output_model", "model") +
+    "\n\n"
+    "The output is organized such that row i and column j in the neighbors "
+    "output corresponds to the index of the point in the reference set which "
+    "is the j'th nearest neighbor from the point in the query set with index "
+    "i.  Row j and column i in the distances output file corresponds to the "
+    "approximate distance between those two points.",
+    SEE_ALSO("@knn", "#knn"),
+    SEE_ALSO("@lsh", "#lsh"),
+    SEE_ALSO("@krann", "#krann"),
+    SEE_ALSO("@kmeans", "#kmeans"),
+    SEE_ALSO("Product quantization for nearest neighbor search (pdf)",
+        "https://hal.inria.fr/inria-00514462/document"),
+    SEE_ALSO("mlpack::neighbor::PQSearch C++ class documentation",
+        "@doxygen/classmlpack_1_1neighbor_1_1PQSearch.html"));
+
+// Define our input parameters that this program will take.
+PARAM_MATRIX_IN("reference", "Matrix containing the reference dataset.", "r");
+PARAM_MATRIX_OUT("distances", "Matrix to output distances into.", "d");
+PARAM_UMATRIX_OUT("neighbors", "Matrix to output neighbors into.", "n");
+
+// We can load or save models.
+PARAM_MODEL_IN(PQSearch, "input_model", "Input product quantization model.",
+    "m");
+PARAM_MODEL_OUT(PQSearch, "output_model", "Output for trained product "
+    "quantization model.", "M");
+
+// For testing recall.
+PARAM_UMATRIX_IN("true_neighbors", "Matrix of true neighbors to compute "
+    "recall with (the recall is printed when -v is specified).", "t");
+
+PARAM_INT_IN("k", "Number of nearest neighbors to find.", "k", 0);
+PARAM_MATRIX_IN("query", "Matrix containing query points (optional).", "q");
+
+PARAM_INT_IN("subspaces", "The number of subspaces (bytes per encoded point).",
+    "S", 8);
+PARAM_INT_IN("centroids", "The number of centroids in each subspace (at most "
+    "256).", "C", 256);
+PARAM_INT_IN("lists", "The number of lists of the coarse quantizer; if 0, "
+    "every query scans all the points.", "L", 0);
+PARAM_INT_IN("num_probes", "The number of lists to scan for each query.", "P",
+    1);
+PARAM_INT_IN("max_iterations", "The maximum number of iterations of each "
+    "k-means clustering.", "i", 25);
+PARAM_INT_IN("training_points", "The number of random reference points to "
+    "train the quantizers on; if 0, all of them are used.", "T", 0);
+PARAM_INT_IN("seed", "Random seed.  If 0, 'std::time(NULL)' is used.", "s", 0);
+
+static void mlpackMain()
+{
+  if (CLI::GetParam<int>("seed") != 0)
+    math::RandomSeed((size_t) CLI::GetParam<int>("seed"));
+  else
+    math::RandomSeed((size_t) time(NULL));
+
+  // Get all the parameters after checking them.
+  if (CLI::HasParam("k"))
+  {
+    RequireParamValue<int>("k", [](int x) { return x > 0; }, true,
+        "k must be greater than 0");
+  }
+  RequireParamValue<int>("subspaces", [](int x) { return x > 0; }, true,
+      "number of subspaces must be greater than 0");
+  RequireParamValue<int>("centroids", [](int x) { return x > 0 && x <= 256; },
+      true, "number of centroids must be between 1 and 256");
+  RequireParamValue<int>("lists", [](int x) { return x >= 0; }, true,
+      "number of lists must be non-negative");
+  RequireParamValue<int>("num_probes", [](int x) { return x > 0; }, true,
+      "number of probes must be greater than 0");
+  RequireParamValue<int>("max_iterations", [](int x) { return x >= 0; }, true,
+      "maximum number of iterations must be non-negative");
+  RequireParamValue<int>("training_points", [](int x) { return x >= 0; }, true,
+      "number of training points must be non-negative");
+
+  RequireOnlyOnePassed({ "input_model", "reference" }, true);
+  RequireAtLeastOnePassed({ "neighbors", "distances", "output_model" }, false,
+      "no results will be saved");
+  if (CLI::HasParam("input_model") && CLI::HasParam("k"))
+  {
+    RequireAtLeastOnePassed({ "query" }, true, "the reference points are not "
+        "stored in the model");
+  }
+
+  ReportIgnoredParam({{ "k", false }}, "neighbors");
+  ReportIgnoredParam({{ "k", false }}, "distances");
+  ReportIgnoredParam({{ "k", false }}, "query");
+  ReportIgnoredParam({{ "k", false }}, "num_probes");
+  ReportIgnoredParam({{ "k", false }}, "true_neighbors");
+
+  ReportIgnoredParam({{ "reference", false }}, "subspaces");
+  ReportIgnoredParam({{ "reference", false }}, "centroids");
+  ReportIgnoredParam({{ "reference", false }}, "lists");
+  ReportIgnoredParam({{ "reference", false }}, "max_iterations");
+  ReportIgnoredParam({{ "reference", false }}, "training_points");
+
+  // These declarations are here so that the matrices don't go out of scope.
+  arma::mat referenceData;
+  arma::mat queryData;
+
+  PQSearch* pq = NULL;
+  size_t dimensionality, numReferencePoints;
+  if (CLI::HasParam("reference"))
+  {
+    referenceData = std::move(CLI::GetParam<arma::mat>("reference"));
+    Log::Info << "Using reference data from '"
+        << CLI::GetPrintableParam<arma::mat>("reference") << "' ("
+        << referenceData.n_rows << " x " << referenceData.n_cols << ")."
+        << endl;
+    dimensionality = referenceData.n_rows;
+    numReferencePoints = referenceData.n_cols;
+  }
+  else // We must have an input model.
+  {
+    pq = CLI::GetParam<PQSearch*>("input_model");
+    dimensionality = pq->Dimensionality();
+    numReferencePoints = pq->NumPoints();
+  }
+
+  // Check the search parameters before a model is trained, so that it isn't
+  // leaked on errors.
+  const size_t k = (size_t) CLI::GetParam<int>("k");
+  if (CLI::HasParam("k"))
+  {
+    if (CLI::HasParam("query"))
+    {
+      queryData = std::move(CLI::GetParam<arma::mat>("query"));
+      Log::Info << "Loaded query data from '"
+          << CLI::GetPrintableParam<arma::mat>("query") << "' ("
+          << queryData.n_rows << " x " << queryData.n_cols << ")." << endl;
+
+      if (queryData.n_rows != dimensionality)
+      {
+        Log::Fatal << "Query has invalid dimensions(" << queryData.n_rows
+            << "); should be " << dimensionality << "!" << endl;
+      }
+      if (k > numReferencePoints)
+      {
+        Log::Fatal << "Invalid k: " << k << "; must be greater than 0 and less "
+            << "than or equal to the number of reference points ("
+            << numReferencePoints << ")." << endl;
+      }
+    }
+    else if (k >= numReferencePoints)
+    {
+      Log::Fatal << "Invalid k: " << k << "; must be greater than 0 and less "
+          << "than the number of reference points (" << numReferencePoints
+          << ")." << endl;
+    }
+  }
+
+  if (CLI::HasParam("reference"))
+  {
+    const size_t subspaces = (size_t) CLI::GetParam<int>("subspaces");
+    const size_t centroids = (size_t) CLI::GetParam<int>("centroids");
+    const size_t lists = (size_t) CLI::GetParam<int>("lists");
+    const size_t maxIterations = (size_t) CLI::GetParam<int>("max_iterations");
+    const size_t trainingPoints =
+        (size_t) CLI::GetParam<int>("training_points");
+
+    if (subspaces > dimensionality)
+    {
+      Log::Fatal << "Number of subspaces (" << subspaces << ") must not be "
+          << "greater than the dimensionality of the reference set ("
+          << dimensionality << ")!" << endl;
+    }
+    const size_t numTraining = (trainingPoints == 0) ? numReferencePoints :
+        std::min(trainingPoints, numReferencePoints);
+    if (std::max(centroids, lists) > numTraining)
+    {
+      Log::Fatal << "Number of centroids (" << centroids << ") and of lists ("
+          << lists << ") must not be greater than the number of training "
+          << "points (" << numTraining << ")!" << endl;
+    }
+
+    pq = new PQSearch();
+    Timer::Start("pq_training");
+    pq->Train(referenceData, subspaces, centroids, lists, maxIterations,
+        trainingPoints);
+    Timer::Stop("pq_training");
+  }
+
+  if (CLI::HasParam("k"))
+  {
+    const size_t numProbes = (size_t) CLI::GetParam<int>("num_probes");
+
+    Log::Info << "Computing " << k << " approximate nearest neighbors."
+        << endl;
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    Timer::Start("computing_neighbors");
+    if (CLI::HasParam("query"))
+      pq->Search(queryData, k, neighbors, distances, numProbes);
+    else
+      pq->Search(referenceData, k, neighbors, distances, numProbes, true);
+    Timer::Stop("computing_neighbors");
+
+    Log::Info << "Neighbors computed." << endl;
+
+    // Compute recall, if desired.
+    if (CLI::HasParam("true_neighbors"))
+    {
+      const arma::Mat<size_t>& trueNeighbors =
+          CLI::GetParam<arma::Mat<size_t>>("true_neighbors");
+
+      if (trueNeighbors.n_rows != neighbors.n_rows ||
+          trueNeighbors.n_cols != neighbors.n_cols)
+      {
+        Log::Fatal << "The true neighbors file must have the same number of "
+            << "values as the set of neighbors being queried!" << endl;
+      }
+
+      Log::Info << "Using true neighbor indices from '"
+          << CLI::GetPrintableParam<arma::Mat<size_t>>("true_neighbors")
+          << "'." << endl;
+
+      const double recallPercentage = 100 *
+          LSHSearch<>::ComputeRecall(neighbors, trueNeighbors);
+      Log::Info << "Recall: " << recallPercentage << endl;
+    }
+
+    CLI::GetParam<arma::mat>("distances") = std::move(distances);
+    CLI::GetParam<arma::Mat<size_t>>("neighbors") = std::move(neighbors);
+  }
+
+  CLI::GetParam<PQSearch*>("output_model") = pq;
+}
@@ -0,0 +1,324 @@
+/**
+ * @file pq_search.cpp
+ *
+ * Implementation of PQSearch.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "pq_search.hpp"
+
+#include <mlpack/methods/kmeans/kmeans.hpp>
+
+#include <algorithm>
+#include <queue>
+#include <sstream>
+
+using namespace mlpack;
+using namespace mlpack::neighbor;
+
+/**
+ * Return the index of the column of the given centroids that is the closest to
+ * the given point, in the dimensions begin to end - 1 only.
+ */
+static size_t NearestCentroid(const arma::mat& centroids,
+                              const double* point,
+                              const size_t begin,
+                              const size_t end)
+{
+  size_t nearest = 0;
+  double nearestDistance = DBL_MAX;
+  for (size_t j = 0; j < centroids.n_cols; ++j)
+  {
+    const double* centroid = centroids.colptr(j);
+    double distance = 0.0;
+    for (size_t r = begin; r < end; ++r)
+      distance += (point[r] - centroid[r]) * (point[r] - centroid[r]);
+
+    if (distance < nearestDistance)
+    {
+      nearest = j;
+      nearestDistance = distance;
+    }
+  }
+
+  return nearest;
+}
+
+PQSearch::PQSearch(const arma::mat& referenceSet,
+                   const size_t numSubspaces,
+                   const size_t numCentroids,
+                   const size_t numLists,
+                   const size_t maxIterations,
+                   const size_t numTrainingPoints)
+{
+  Train(referenceSet, numSubspaces, numCentroids, numLists, maxIterations,
+      numTrainingPoints);
+}
+
+PQSearch::PQSearch() :
+    subspaceBegin(1, 0),
+    listOffsets(2, 0)
+{
+  // Nothing to do.
+}
+
+void PQSearch::Train(const arma::mat& referenceSet,
+                     const size_t numSubspaces,
+                     const size_t numCentroids,
+                     const size_t numLists,
+                     const size_t maxIterations,
+                     const size_t numTrainingPoints)
+{
+  const size_t dimensionality = referenceSet.n_rows;
+  const size_t numPoints = referenceSet.n_cols;
+
+  if (numSubspaces == 0 || numSubspaces > dimensionality)
+  {
+    std::ostringstream oss;
+    oss << "PQSearch::Train(): the number of subspaces (" << numSubspaces
+        << ") must be between 1 and the dimensionality (" << dimensionality
+        << ")!";
+    throw std::invalid_argument(oss.str());
+  }
+  if (numCentroids == 0 || numCentroids > 256)
+  {
+    std::ostringstream oss;
+    oss << "PQSearch::Train(): the number of centroids (" << numCentroids
+        << ") must be between 1 and 256!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // The quantizers may be trained on a random subset of the points only.
+  arma::mat sample;
+  const arma::mat* trainingSet = &referenceSet;
+  if (numTrainingPoints != 0 && numTrainingPoints < numPoints)
+  {
+    const arma::uvec order = arma::shuffle(arma::linspace<arma::uvec>(0,
+        numPoints - 1, numPoints));
+    sample = referenceSet.cols(order.head(numTrainingPoints));
+    trainingSet = &sample;
+  }
+
+  if (std::max(numCentroids, numLists) > trainingSet->n_cols)
+  {
+    std::ostringstream oss;
+    oss << "PQSearch::Train(): the number of centroids (" << numCentroids
+        << ") and of lists (" << numLists << ") must not be greater than the "
+        << "number of training points (" << trainingSet->n_cols << ")!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  kmeans::KMeans<> kmeans(maxIterations);
+
+  // Train the coarse quantizer, and get the residuals of the training points
+  // to the centroids of their lists.
+  arma::mat residuals(*trainingSet);
+  if (numLists > 0)
+  {
+    Log::Info << "Training coarse quantizer with " << numLists << " lists."
+        << std::endl;
+    arma::Row<size_t> assignments;
+    kmeans.Cluster(*trainingSet, numLists, assignments, coarseCentroids);
+    for (size_t i = 0; i < residuals.n_cols; ++i)
+      residuals.col(i) -= coarseCentroids.col(assignments[i]);
+  }
+  else
+  {
+    coarseCentroids.clear();
+  }
+
+  // Train the centroids of each subspace.
+  subspaceBegin.resize(numSubspaces + 1);
+  for (size_t m = 0; m <= numSubspaces; ++m)
+    subspaceBegin[m] = m * dimensionality / numSubspaces;
+
+  codebooks.set_size(dimensionality, numCentroids);
+  for (size_t m = 0; m < numSubspaces; ++m)
+  {
+    Log::Info << "Training quantizer of subspace " << m << " (dimensions "
+        << subspaceBegin[m] << " to " << subspaceBegin[m + 1] - 1 << ")."
+        << std::endl;
+    const arma::mat subspace = residuals.rows(subspaceBegin[m],
+        subspaceBegin[m + 1] - 1);
+    arma::mat centroids;
+    kmeans.Cluster(subspace, numCentroids, centroids);
+    codebooks.rows(subspaceBegin[m], subspaceBegin[m + 1] - 1) = centroids;
+  }
+
+  // Encode every reference point.
+  std::vector<size_t> pointLists(numPoints, 0);
+  std::vector<uint8_t> pointCodes(numPoints * numSubspaces);
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) numPoints; ++i)
+  {
+    arma::vec residual = referenceSet.col(i);
+    if (numLists > 0)
+    {
+      pointLists[i] = NearestCentroid(coarseCentroids, residual.memptr(), 0,
+          dimensionality);
+      residual -= coarseCentroids.col(pointLists[i]);
+    }
+
+    for (size_t m = 0; m < numSubspaces; ++m)
+    {
+      pointCodes[i * numSubspaces + m] = (uint8_t) NearestCentroid(codebooks,
+          residual.memptr(), subspaceBegin[m], subspaceBegin[m + 1]);
+    }
+  }
+
+  // Sort the points by list, so that each list is scanned sequentially.
+  const size_t listCount = std::max(numLists, (size_t) 1);
+  listOffsets.assign(listCount + 1, 0);
+  for (size_t i = 0; i < numPoints; ++i)
+    ++listOffsets[pointLists[i] + 1];
+  for (size_t l = 0; l < listCount; ++l)
+    listOffsets[l + 1] += listOffsets[l];
+
+  std::vector<size_t> next(listOffsets.begin(), listOffsets.end() - 1);
+  listPoints.resize(numPoints);
+  codes.resize(numPoints * numSubspaces);
+  for (size_t i = 0; i < numPoints; ++i)
+  {
+    const size_t position = next[pointLists[i]]++;
+    listPoints[position] = i;
+    std::copy(pointCodes.begin() + i * numSubspaces,
+        pointCodes.begin() + (i + 1) * numSubspaces,
+        codes.begin() + position * numSubspaces);
+  }
+
+  Log::Info << "Encoded " << numPoints << " points with " << numSubspaces
+      << " bytes each." << std::endl;
+}
+
+void PQSearch::Search(const arma::mat& querySet,
+                      const size_t k,
+                      arma::Mat<size_t>& neighbors,
+                      arma::mat& distances,
+                      const size_t numProbes,
+                      const bool sameSet) const
+{
+  if (querySet.n_rows != Dimensionality())
+  {
+    std::ostringstream oss;
+    oss << "PQSearch::Search(): dimensionality of query set ("
+        << querySet.n_rows << ") is not equal to the dimensionality the model "
+        << "was trained on (" << Dimensionality() << ")!";
+    throw std::invalid_argument(oss.str());
+  }
+  if (sameSet && querySet.n_cols != NumPoints())
+  {
+    std::ostringstream oss;
+    oss << "PQSearch::Search(): the query set has " << querySet.n_cols
+        << " points, but the reference set has " << NumPoints() << "!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  neighbors.set_size(k, querySet.n_cols);
+  distances.set_size(k, querySet.n_cols);
+  if (k == 0)
+    return;
+
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t i = 0; i < (omp_size_t) querySet.n_cols; ++i)
+  {
+    SearchQuery(querySet.col(i), k, numProbes, sameSet ? (size_t) i : SIZE_MAX,
+        neighbors.colptr(i), distances.colptr(i));
+  }
+}
+
+void PQSearch::DistanceTable(const arma::vec& query, arma::mat& table) const
+{
+  const size_t numSubspaces = NumSubspaces();
+  table.set_size(codebooks.n_cols, numSubspaces);
+  for (size_t m = 0; m < numSubspaces; ++m)
+  {
+    for (size_t j = 0; j < codebooks.n_cols; ++j)
+    {
+      const double* centroid = codebooks.colptr(j);
+      double distance = 0.0;
+      for (size_t r = subspaceBegin[m]; r < subspaceBegin[m + 1]; ++r)
+        distance += (query[r] - centroid[r]) * (query[r] - centroid[r]);
+      table(j, m) = distance;
+    }
+  }
+}
+
+void PQSearch::SearchQuery(const arma::vec& query,
+                           const size_t k,
+                           const size_t numProbes,
+                           const size_t skipIndex,
+                           size_t* neighbors,
+                           double* distances) const
+{
+  const size_t numSubspaces = NumSubspaces();
+  const size_t numCentroids = NumCentroids();
+
+  // Scan the lists with the closest centroids (or the only list).
+  std::vector<size_t> lists(1, 0);
+  if (NumLists() > 0)
+  {
+    std::vector<std::pair<double, size_t>> listDistances(NumLists());
+    for (size_t l = 0; l < NumLists(); ++l)
+    {
+      listDistances[l] = std::make_pair(arma::accu(arma::square(query -
+          coarseCentroids.col(l))), l);
+    }
+
+    const size_t probes = std::min(std::max(numProbes, (size_t) 1),
+        NumLists());
+    std::partial_sort(listDistances.begin(), listDistances.begin() + probes,
+        listDistances.end());
+    lists.resize(probes);
+    for (size_t p = 0; p < probes; ++p)
+      lists[p] = listDistances[p].second;
+  }
+
+  // The k best candidates so far, with the worst on top.
+  std::priority_queue<std::pair<double, size_t>> best;
+  arma::mat table;
+  for (size_t l : lists)
+  {
+    if (NumLists() > 0)
+      DistanceTable(query - coarseCentroids.col(l), table);
+    else
+      DistanceTable(query, table);
+
+    // The distance to each point is a sum of one lookup in the column of each
+    // subspace.
+    const double* tableColumns = table.memptr();
+    for (size_t p = listOffsets[l]; p < listOffsets[l + 1]; ++p)
+    {
+      if (listPoints[p] == skipIndex)
+        continue;
+
+      const uint8_t* code = codes.data() + p * numSubspaces;
+      double distance = 0.0;
+      for (size_t m = 0; m < numSubspaces; ++m)
+        distance += tableColumns[m * numCentroids + code[m]];
+
+      if (best.size() < k)
+        best.push(std::make_pair(distance, listPoints[p]));
+      else if (distance < best.top().first)
+      {
+        best.pop();
+        best.push(std::make_pair(distance, listPoints[p]));
+      }
+    }
+  }
+
+  // Fill the results from the worst found to the best.
+  for (size_t j = best.size(); j < k; ++j)
+  {
+    neighbors[j] = SIZE_MAX;
+    distances[j] = DBL_MAX;
+  }
+  for (size_t j = best.size(); j > 0; --j)
+  {
+    neighbors[j - 1] = best.top().second;
+    distances[j - 1] = std::sqrt(best.top().first);
+    best.pop();
+  }
+}
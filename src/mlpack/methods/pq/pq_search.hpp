@@ -0,0 +1,205 @@
+/**
+ * @file pq_search.hpp
+ *
+ * Defines the PQSearch class, which performs approximate nearest neighbor
+ * search on a reference set compressed with product quantization, optionally
+ * with a coarse inverted file (IVFADC).
+ *
+ * @article{jegou2011product,
+ *   title={Product Quantization for Nearest Neighbor Search},
+ *   author={J{\'e}gou, Herv{\'e} and Douze, Matthijs and Schmid, Cordelia},
+ *   journal={IEEE Transactions on Pattern Analysis and Machine Intelligence},
+ *   volume={33},
+ *   number={1},
+ *   pages={117--128},
+ *   year={2011}
+ * }
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_PQ_PQ_SEARCH_HPP
+#define MLPACK_METHODS_PQ_PQ_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <cstdint>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The PQSearch class stores each reference point as numSubspaces bytes: the
+ * dimensions are split into numSubspaces contiguous subspaces, and in each of
+ * them the point is replaced by the index of the closest of numCentroids
+ * centroids, which are trained with k-means.  With 8 subspaces, a point of 128
+ * doubles (1024 bytes) takes 8 bytes.  The reference points themselves are not
+ * kept.
+ *
+ * The squared distance between a query and an encoded point is approximated
+ * by the sum over the subspaces of the squared distance between the query and
+ * the centroid of the point (asymmetric distance computation).  These squared
+ * distances are computed once per query in a table of numCentroids x
+ * numSubspaces values, so that the distance to each encoded point only takes
+ * numSubspaces table lookups.
+ *
+ * If numLists is not 0, the points are first clustered into numLists lists
+ * with k-means (the coarse quantizer), the product quantizer encodes the
+ * residual of each point to the centroid of its list, and each query only
+ * scans the numProbes lists with the closest centroids.  This trades recall
+ * for speed, and the residuals are encoded more accurately than the points.
+ *
+ * @code
+ * extern arma::mat references, queries;
+ * PQSearch pq(references, 8, 256, 100);
+ * arma::Mat<size_t> neighbors;
+ * arma::mat distances;
+ * pq.Search(queries, 10, neighbors, distances, 8);
+ * @endcode
+ */
+class PQSearch
+{
+ public:
+  /**
+   * Train the quantizers on the given reference set, and encode it.
+   *
+   * @param referenceSet Set of reference points.
+   * @param numSubspaces Number of subspaces (bytes per point); at most the
+   *     dimensionality.
+   * @param numCentroids Number of centroids in each subspace; between 1 and
+   *     256.
+   * @param numLists Number of lists of the coarse quantizer; 0 scans all the
+   *     points for every query.
+   * @param maxIterations Maximum number of iterations of each k-means.
+   * @param numTrainingPoints Number of random reference points to train the
+   *     quantizers on; 0 uses all of them.
+   */
+  PQSearch(const arma::mat& referenceSet,
+           const size_t numSubspaces = 8,
+           const size_t numCentroids = 256,
+           const size_t numLists = 0,
+           const size_t maxIterations = 25,
+           const size_t numTrainingPoints = 0);
+
+  /**
+   * Create an untrained model.  Be sure to call Train() before calling
+   * Search().
+   */
+  PQSearch();
+
+  /**
+   * Train the quantizers on the given reference set, and encode it.  See the
+   * constructor for the parameters.
+   */
+  void Train(const arma::mat& referenceSet,
+             const size_t numSubspaces = 8,
+             const size_t numCentroids = 256,
+             const size_t numLists = 0,
+             const size_t maxIterations = 25,
+             const size_t numTrainingPoints = 0);
+
+  /**
+   * Search for the k approximate nearest neighbors of each point in the query
+   * set.  Queries are processed in parallel.  If fewer than k points are
+   * scanned for a query, the remaining indices are SIZE_MAX and the remaining
+   * distances are DBL_MAX.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of neighbors to find for each query point.
+   * @param neighbors Matrix to store the indices of the neighbors of each
+   *     query point in, with the nearest first.
+   * @param distances Matrix to store the approximate distances in.
+   * @param numProbes Number of lists to scan for each query (ignored if there
+   *     is no coarse quantizer).
+   * @param sameSet If true, the query set is the reference set the model was
+   *     trained on, and no point is returned as its own neighbor.
+   */
+  void Search(const arma::mat& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances,
+              const size_t numProbes = 1,
+              const bool sameSet = false) const;
+
+  //! Get the dimensionality of the points.
+  size_t Dimensionality() const { return codebooks.n_rows; }
+  //! Get the number of encoded reference points.
+  size_t NumPoints() const { return listPoints.size(); }
+  //! Get the number of subspaces (bytes per encoded point).
+  size_t NumSubspaces() const { return subspaceBegin.size() - 1; }
+  //! Get the number of centroids in each subspace.
+  size_t NumCentroids() const { return codebooks.n_cols; }
+  //! Get the number of lists of the coarse quantizer (0 if there is none).
+  size_t NumLists() const { return coarseCentroids.n_cols; }
+
+  //! Get the centroids of the subspaces: rows SubspaceBegin()[m] to
+  //! SubspaceBegin()[m + 1] - 1 of column j are centroid j of subspace m.
+  const arma::mat& Codebooks() const { return codebooks; }
+  //! Get the first dimension of each subspace (and the dimensionality last).
+  const std::vector<size_t>& SubspaceBegin() const { return subspaceBegin; }
+  //! Get the centroids of the lists of the coarse quantizer.
+  const arma::mat& CoarseCentroids() const { return coarseCentroids; }
+  //! Get the codes of the points, NumSubspaces() bytes per point, in the
+  //! order of ListPoints().
+  const std::vector<uint8_t>& Codes() const { return codes; }
+  //! Get the indices of the points of each list; the points of list l are
+  //! ListPoints()[ListOffsets()[l]] to ListPoints()[ListOffsets()[l + 1] - 1].
+  const std::vector<size_t>& ListPoints() const { return listPoints; }
+  //! Get the offsets of the lists in ListPoints().
+  const std::vector<size_t>& ListOffsets() const { return listOffsets; }
+
+  //! Serialize the model.
+  template<typename Archive>
+  void serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  /**
+   * Fill the table of the squared distances between the given (residual)
+   * query and every centroid of every subspace.
+   *
+   * @param query Query (or residual of the query to a list centroid).
+   * @param table Table to fill, numCentroids x numSubspaces.
+   */
+  void DistanceTable(const arma::vec& query, arma::mat& table) const;
+
+  /**
+   * Search for the neighbors of one query.
+   *
+   * @param query Query point.
+   * @param k Number of neighbors to find.
+   * @param numProbes Number of lists to scan.
+   * @param skipIndex Index of a reference point to skip (for monochromatic
+   *     search), or SIZE_MAX.
+   * @param neighbors Column to store the indices of the neighbors in.
+   * @param distances Column to store the distances in.
+   */
+  void SearchQuery(const arma::vec& query,
+                   const size_t k,
+                   const size_t numProbes,
+                   const size_t skipIndex,
+                   size_t* neighbors,
+                   double* distances) const;
+
+  //! The first dimension of each subspace, and the dimensionality.
+  std::vector<size_t> subspaceBegin;
+  //! The centroids of the subspaces (dimensionality x numCentroids).
+  arma::mat codebooks;
+  //! The centroids of the lists (empty if there is no coarse quantizer).
+  arma::mat coarseCentroids;
+  //! The codes of the points, in list order.
+  std::vector<uint8_t> codes;
+  //! The indices of the points, in list order.
+  std::vector<size_t> listPoints;
+  //! The offset of each list in listPoints, and the number of points.
+  std::vector<size_t> listOffsets;
+};
+
+} // namespace neighbor
+} // namespace mlpack
+
+// Include implementation.
+#include "pq_search_impl.hpp"
+
+#endif
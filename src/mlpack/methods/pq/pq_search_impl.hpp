@@ -0,0 +1,34 @@
+/**
+ * @file pq_search_impl.hpp
+ *
+ * Implementation of the templated functions of PQSearch.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_PQ_PQ_SEARCH_IMPL_HPP
+#define MLPACK_METHODS_PQ_PQ_SEARCH_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "pq_search.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+template<typename Archive>
+void PQSearch::serialize(Archive& ar, const unsigned int /* version */)
+{
+  ar & BOOST_SERIALIZATION_NVP(subspaceBegin);
+  ar & BOOST_SERIALIZATION_NVP(codebooks);
+  ar & BOOST_SERIALIZATION_NVP(coarseCentroids);
+  ar & BOOST_SERIALIZATION_NVP(codes);
+  ar & BOOST_SERIALIZATION_NVP(listPoints);
+  ar & BOOST_SERIALIZATION_NVP(listOffsets);
+}
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
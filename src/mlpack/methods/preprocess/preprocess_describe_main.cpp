@@ -12,6 +12,9 @@
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/util/cli.hpp>
 #include <mlpack/core/util/mlpack_main.hpp>
+#include <mlpack/core/data/stream_reader.hpp>
+#include <mlpack/core/math/random.hpp>
+#include <mlpack/core/math/running_moments.hpp>
 
 #include <boost/format.hpp>
 #include <boost/lexical_cast.hpp>
@@ -42,6 +45,13 @@ PROGRAM_INFO("Descriptive Statistics",
     "dataset should be considered as a population.  Otherwise, the dataset "
     "will be considered as a sample."
     "\n\n"
+    "All of the statistics other than the median are computed in one "
+    "(parallel) pass over the data.  Datasets too large to load into memory "
+    "may be given as a file with the " + PRINT_PARAM_STRING("input_file") +
+    " parameter instead of the " + PRINT_PARAM_STRING("input") + " parameter; "
+    "the file is then read in chunks, and the medians are estimated from a "
+    "random sample of 10000 points."
+    "\n\n"
     "So, a simple example where we want to print out statistical facts about "
     "the dataset " + PRINT_DATASET("X") + " using the default settings, we "
     "could run "
@@ -58,7 +68,11 @@ PROGRAM_INFO("Descriptive Statistics",
     SEE_ALSO("@preprocess_split", "#preprocess_split"));
 
 // Define parameters for data.
-PARAM_MATRIX_IN_REQ("input", "Matrix containing data,", "i");
+PARAM_MATRIX_IN("input", "Matrix containing data,", "i");
+// Large datasets may instead be streamed from a file.
+PARAM_STRING_IN("input_file", "File of points (one per line, or a binary file "
+    "with one point per row) to describe; it is read in chunks, for datasets "
+    "too large to load with --input.", "F", "");
 PARAM_INT_IN("dimension", "Dimension of the data. Use this to specify a "
     "dimension", "d", 0);
 PARAM_INT_IN("precision", "Precision of the output statistics.", "p", 4);
@@ -70,72 +84,59 @@ PARAM_FLAG("row_major", "If specified, the program will calculate statistics "
     "across rows, not across columns.  (Remember that in mlpack, a column "
     "represents a point, so this option is generally not necessary.)", "r");
 
-/**
- * Calculates the sum of deviations to the Nth Power.
- *
- * @param input Vector that captures a dimension of a dataset.
- * @param rowMean Mean of the given vector.
- * @param n Degree of power.
- * @return sum of nth power deviations.
- */
-double SumNthPowerDeviations(const arma::rowvec& input,
-                             const double& fMean,
-                             size_t n)
-{
-  return arma::sum(arma::pow(input - fMean, static_cast<double>(n)));
-}
+
+//! The number of points that the medians are estimated from when the dataset
+//! is read from a file.
+static const size_t MedianSampleSize = 10000;
 
 /**
- * Calculates Skewness of the given vector.
+ * Calculates skewness from the sum of the cubed deviations from the mean.
  *
- * @param input Vector that captures a dimension of a dataset
- * @param rowStd Standard Deviation of the given vector.
- * @param rowMean Mean of the given vector.
- * @return Skewness of the given vector.
+ * @param n Number of values.
+ * @param m3 Sum of the cubed deviations from the mean.
+ * @param fStd Standard deviation of the values.
+ * @param population Whether the values are a population (or a sample).
+ * @return Skewness of the values.
  */
-double Skewness(const arma::rowvec& input,
-                const double& fStd,
-                const double& fMean,
+double Skewness(const double n,
+                const double m3,
+                const double fStd,
                 const bool population)
 {
-  double skewness = 0;
   const double S3 = pow(fStd, 3);
-  const double M3 = SumNthPowerDeviations(input, fMean, 3);
-  const double n = input.n_elem;
   if (population)
   {
-    // Calculate population skewness
-    skewness = M3 / (n * S3);
+    // Calculate population skewness.
+    return m3 / (n * S3);
   }
   else
   {
     // Calculate sample skewness.
-    skewness = n * M3 / ((n - 1) * (n - 2) * S3);
+    return n * m3 / ((n - 1) * (n - 2) * S3);
   }
-  return skewness;
 }
 
 /**
- * Calculates excess kurtosis of the given vector.
+ * Calculates excess kurtosis from the sums of the squared and fourth powers of
+ * the deviations from the mean.
  *
- * @param input Vector that captures a dimension of a dataset
- * @param rowStd Standard Deviation of the given vector.
- * @param rowMean Mean of the given vector.
- * @return Kurtosis of the given vector.
+ * @param n Number of values.
+ * @param m2 Sum of the squared deviations from the mean.
+ * @param m4 Sum of the fourth powers of the deviations from the mean.
+ * @param fStd Standard deviation of the values.
+ * @param population Whether the values are a population (or a sample).
+ * @return Excess kurtosis of the values.
  */
-double Kurtosis(const arma::rowvec& input,
-                const double& fStd,
-                const double& fMean,
+double Kurtosis(const double n,
+                const double m2,
+                const double m4,
+                const double fStd,
                 const bool population)
 {
-  double kurtosis = 0;
-  const double M4 = SumNthPowerDeviations(input, fMean, 4);
-  const double n = input.n_elem;
   if (population)
   {
     // Calculate population excess kurtosis.
-    const double M2 = SumNthPowerDeviations(input, fMean, 2);
-    kurtosis = n * (M4 / pow(M2, 2)) - 3;
+    return n * (m4 / pow(m2, 2)) - 3;
   }
   else
   {
@@ -143,34 +144,62 @@ double Kurtosis(const arma::rowvec& input,
     const double S4 = pow(fStd, 4);
     const double norm3 = (3 * (n - 1) * (n - 1)) / ((n - 2) * (n - 3));
     const double normC = (n * (n + 1)) / ((n - 1) * (n - 2) * (n - 3));
-    const double normM = M4 / S4;
-    kurtosis = normC * normM - norm3;
+    const double normM = m4 / S4;
+    return normC * normM - norm3;
   }
-  return kurtosis;
 }
 
 /**
  * Calculates standard error of standard deviation.
  *
- * @param input Vector that captures a dimension of a dataset
- * @param rowStd Standard Deviation of the given vector.
- * @return Standard error of the stanrdard devation of the given vector.
+ * @param size Number of values.
+ * @param fStd Standard Deviation of the values.
+ * @return Standard error of the standard devation of the values.
  */
-double StandardError(const size_t size, const double& fStd)
+double StandardError(const size_t size, const double fStd)
 {
   return fStd / sqrt(size);
 }
 
+/**
+ * Update a uniform random sample of the points of a stream with the given
+ * chunk (reservoir sampling).
+ *
+ * @param chunk Next points of the stream.
+ * @param pointsSeen Number of points of the stream before the chunk.
+ * @param sample Sample of up to MedianSampleSize points.
+ */
+void SamplePoints(const arma::mat& chunk,
+                  const size_t pointsSeen,
+                  arma::mat& sample)
+{
+  if (pointsSeen == 0)
+    sample.set_size(chunk.n_rows, MedianSampleSize);
+
+  for (size_t i = 0; i < chunk.n_cols; ++i)
+  {
+    const size_t index = pointsSeen + i;
+    const size_t position = (index < MedianSampleSize) ? index :
+        (size_t) (mlpack::math::Random() * (index + 1));
+    if (position < MedianSampleSize)
+      sample.col(position) = chunk.col(i);
+  }
+}
+
 static void mlpackMain()
 {
+  RequireOnlyOnePassed({ "input", "input_file" }, true);
+
   const size_t dimension = static_cast<size_t>(CLI::GetParam<int>("dimension"));
   const size_t precision = static_cast<size_t>(CLI::GetParam<int>("precision"));
   const size_t width = static_cast<size_t>(CLI::GetParam<int>("width"));
   const bool population = CLI::HasParam("population");
   const bool rowMajor = CLI::HasParam("row_major");
+  const bool oneDimension = CLI::HasParam("dimension");
 
-  // Load the data.
-  arma::mat& data = CLI::GetParam<arma::mat>("input");
+  if (CLI::HasParam("input_file") && rowMajor)
+    Log::Fatal << "--row_major (-r) is not supported with --input_file (-F)."
+        << endl;
 
   // Generate boost format recipe.
   const string widthPrecision("%-" + to_string(width) + "." +
@@ -187,56 +216,98 @@ static void mlpackMain()
   }
 
   Timer::Start("statistics");
+
+  // All of the moments are accumulated in one pass over the data.  If the user
+  // specified a dimension, only that dimension is described.
+  mlpack::math::RunningMoments moments;
+  arma::vec medians;
+  if (CLI::HasParam("input_file"))
+  {
+    // The file is read in chunks, and the moments of each chunk are computed
+    // while the next chunk is being read.  The medians can't be found in one
+    // pass, so they are estimated from a random sample of the points.
+    data::StreamReader reader(CLI::GetParam<string>("input_file"));
+    arma::mat chunk;
+    arma::mat sample;
+    while (reader.Next(chunk))
+    {
+      if (oneDimension)
+      {
+        if (dimension >= chunk.n_rows)
+          Log::Fatal << "Dimension " << dimension << " is not in the dataset "
+              << "(which has " << chunk.n_rows << " dimensions)." << endl;
+        chunk = chunk.row(dimension);
+      }
+
+      SamplePoints(chunk, moments.Count(), sample);
+      moments.Add(chunk);
+    }
+
+    if (moments.Count() == 0)
+      Log::Fatal << "No points in '" << reader.Filename() << "'." << endl;
+
+    if (moments.Count() < sample.n_cols)
+      sample.shed_cols(moments.Count(), sample.n_cols - 1);
+    else
+      Log::Info << "The medians are estimated from a random sample of "
+          << sample.n_cols << " points." << endl;
+    medians = arma::median(sample, 1);
+  }
+  else
+  {
+    arma::mat& data = CLI::GetParam<arma::mat>("input");
+
+    // Statistics across rows are the statistics of the transposed data.
+    arma::mat transposed;
+    if (rowMajor)
+      transposed = data.t();
+    const arma::mat& points = rowMajor ? transposed : data;
+
+    if (oneDimension)
+    {
+      if (dimension >= points.n_rows)
+        Log::Fatal << "Dimension " << dimension << " is not in the dataset "
+            << "(which has " << points.n_rows << " dimensions)." << endl;
+
+      const arma::mat feature = points.row(dimension);
+      moments.Add(feature);
+      medians = arma::median(feature, 1);
+    }
+    else
+    {
+      moments.Add(points);
+      medians = arma::median(points, 1);
+    }
+  }
+
   // Print the headers.
   Log::Info << boost::format(stringFormat)
       % "dim" % "var" % "mean" % "std" % "median" % "min" % "max"
       % "range" % "skew" % "kurt" % "SE" << endl;
 
-  // Lambda function to print out the results.
-  auto PrintStatResults = [&](size_t dim, bool rowMajor)
+  const double n = moments.Count();
+  const arma::vec variances = moments.Variance(population);
+  for (size_t i = 0; i < variances.n_elem; ++i)
   {
-    arma::rowvec feature;
-    if (rowMajor)
-      feature = arma::conv_to<arma::rowvec>::from(data.col(dim));
-    else
-      feature = data.row(dim);
-
     // f at the front of the variable names means "feature".
-    const double fMax = arma::max(feature);
-    const double fMin = arma::min(feature);
-    const double fMean = arma::mean(feature);
-    const double fStd = arma::stddev(feature, population);
+    const double fMax = moments.Max()[i];
+    const double fMin = moments.Min()[i];
+    const double fStd = sqrt(variances[i]);
 
     // Print statistics of the given dimension.
     Log::Info << boost::format(numberFormat)
-        % dim
-        % arma::var(feature, population)
-        % fMean
+        % (oneDimension ? dimension : i)
+        % variances[i]
+        % moments.Mean()[i]
         % fStd
-        % arma::median(feature)
+        % medians[i]
         % fMin
         % fMax
         % (fMax - fMin) // range
-        % Skewness(feature, fStd, fMean, population)
-        % Kurtosis(feature, fStd, fMean, population)
-        % StandardError(feature.n_elem, fStd)
+        % Skewness(n, moments.M3()[i], fStd, population)
+        % Kurtosis(n, moments.M2()[i], moments.M4()[i], fStd, population)
+        % StandardError(moments.Count(), fStd)
         << endl;
-  };
-
-  // If the user specified dimension, describe statistics of the given
-  // dimension. If a dimension is not specified, describe all dimensions.
-  if (CLI::HasParam("dimension"))
-  {
-    PrintStatResults(dimension, rowMajor);
-  }
-  else
-  {
-    const size_t dimensions = rowMajor ? data.n_cols : data.n_rows;
-    for (size_t i = 0; i < dimensions; ++i)
-    {
-      PrintStatResults(i, rowMajor);
-    }
   }
   Timer::Stop("statistics");
 }
-
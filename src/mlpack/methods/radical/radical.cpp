@@ -45,7 +45,8 @@ void Radical::CopyAndPerturb(mat& xNew, const mat& x) const
 
 double Radical::Vasicek(vec& z) const
 {
-  z = sort(z);
+  // Sort in place, so that callers can reuse the memory of z.
+  std::sort(z.begin(), z.end());
 
   // Apparently slower.
   /*
@@ -70,26 +71,33 @@ double Radical::DoRadical2D(const mat& matX)
 {
   CopyAndPerturb(perturbed, matX);
 
-  mat::fixed<2, 2> matJacobi;
+  return BestAngle(perturbed);
+}
+
 
+double Radical::BestAngle(const mat& perturbedX) const
+{
   vec values(angles);
 
-  for (size_t i = 0; i < angles; i++)
+  #pragma omp parallel
   {
-    const double theta = (i / (double) angles) * M_PI / 2.0;
-    const double cosTheta = cos(theta);
-    const double sinTheta = sin(theta);
+    // Each thread rotates and sorts the candidates in its own buffers.
+    vec candidateY1(perturbedX.n_rows);
+    vec candidateY2(perturbedX.n_rows);
 
-    matJacobi(0, 0) = cosTheta;
-    matJacobi(1, 0) = -sinTheta;
-    matJacobi(0, 1) = sinTheta;
-    matJacobi(1, 1) = cosTheta;
+    #pragma omp for schedule(static)
+    for (omp_size_t i = 0; i < (omp_size_t) angles; i++)
+    {
+      const double theta = (i / (double) angles) * M_PI / 2.0;
+      const double cosTheta = cos(theta);
+      const double sinTheta = sin(theta);
 
-    candidate = perturbed * matJacobi;
-    vec candidateY1 = candidate.unsafe_col(0);
-    vec candidateY2 = candidate.unsafe_col(1);
+      // This is perturbedX times the Jacobi rotation matrix.
+      candidateY1 = cosTheta * perturbedX.col(0) - sinTheta * perturbedX.col(1);
+      candidateY2 = sinTheta * perturbedX.col(0) + cosTheta * perturbedX.col(1);
 
-    values(i) = Vasicek(candidateY1) + Vasicek(candidateY2);
+      values(i) = Vasicek(candidateY1) + Vasicek(candidateY2);
+    }
   }
 
   uword indOpt = 0;
@@ -132,42 +140,78 @@ void Radical::DoRadical(const mat& matXT, mat& matY, mat& matW)
   Timer::Start("radical_do_radical");
   matW = matWhitening;
 
-  mat matYSubspace(nPoints, 2);
+  // Build a round-robin schedule of the pairs of dimensions: each round is a
+  // set of disjoint pairs, and every pair appears in exactly one round.  With
+  // an odd number of dimensions, the pairs with the dummy dimension nDims are
+  // skipped.
+  const size_t nSlots = nDims + (nDims % 2);
+  std::vector<std::vector<std::pair<size_t, size_t>>> rounds(nSlots - 1);
+  for (size_t r = 0; r < nSlots - 1; r++)
+  {
+    for (size_t k = 0; k < nSlots / 2; k++)
+    {
+      // The last slot stays in place and the others rotate.
+      const size_t a = (k == 0) ? nSlots - 1 : (r + k) % (nSlots - 1);
+      const size_t b = (r + nSlots - 1 - k) % (nSlots - 1);
+      if (a < nDims && b < nDims)
+        rounds[r].push_back(std::make_pair(std::min(a, b), std::max(a, b)));
+    }
+  }
+
+  // The pairs of a round are processed in blocks of one pair per thread, so
+  // that only one perturbed copy of the data per thread is held at once.
+  size_t blockSize = 1;
+  #ifdef HAS_OPENMP
+    blockSize = omp_get_max_threads();
+  #endif
 
-  mat matJ = eye(nDims, nDims);
+  std::vector<mat> perturbedPairs(blockSize);
+  mat matYSubspace(nPoints, 2);
 
   for (size_t sweepNum = 0; sweepNum < sweeps; sweepNum++)
   {
     Log::Info << "RADICAL: sweep " << sweepNum << "." << std::endl;
 
-    for (size_t i = 0; i < nDims - 1; i++)
+    for (size_t r = 0; r < rounds.size(); r++)
     {
-      for (size_t j = i + 1; j < nDims; j++)
+      for (size_t begin = 0; begin < rounds[r].size(); begin += blockSize)
       {
-        Log::Debug << "RADICAL 2D on dimensions " << i << " and " << j << "."
-            << std::endl;
-
-        matYSubspace.col(0) = matY.col(i);
-        matYSubspace.col(1) = matY.col(j);
-
-        const double thetaOpt = DoRadical2D(matYSubspace);
-
-        const double cosThetaOpt = cos(thetaOpt);
-        const double sinThetaOpt = sin(thetaOpt);
-
-        // Set elements of transformation matrix.
-        matJ(i, i) = cosThetaOpt;
-        matJ(j, i) = -sinThetaOpt;
-        matJ(i, j) = sinThetaOpt;
-        matJ(j, j) = cosThetaOpt;
-
-        matY *= matJ;
-
-        // Unset elements of transformation matrix, so matJ = eye() again.
-        matJ(i, i) = 1;
-        matJ(j, i) = 0;
-        matJ(i, j) = 0;
-        matJ(j, j) = 1;
+        const size_t end = std::min(rounds[r].size(), begin + blockSize);
+
+        // The noise is drawn serially, since the random number generator is
+        // shared.
+        for (size_t p = begin; p < end; p++)
+        {
+          Log::Debug << "RADICAL 2D on dimensions " << rounds[r][p].first
+              << " and " << rounds[r][p].second << "." << std::endl;
+
+          matYSubspace.col(0) = matY.col(rounds[r][p].first);
+          matYSubspace.col(1) = matY.col(rounds[r][p].second);
+          CopyAndPerturb(perturbedPairs[p - begin], matYSubspace);
+        }
+
+        // When the block has a single pair, the angles are searched in
+        // parallel instead.
+        #pragma omp parallel for schedule(dynamic) if (end - begin > 1)
+        for (omp_size_t p = begin; p < (omp_size_t) end; p++)
+        {
+          const size_t i = rounds[r][p].first;
+          const size_t j = rounds[r][p].second;
+
+          const double thetaOpt = BestAngle(perturbedPairs[p - begin]);
+          const double cosThetaOpt = cos(thetaOpt);
+          const double sinThetaOpt = sin(thetaOpt);
+
+          // Apply the Jacobi rotation to dimensions i and j, of both the data
+          // and the unmixing matrix.
+          const vec yI = matY.col(i);
+          matY.col(i) = cosThetaOpt * yI - sinThetaOpt * matY.col(j);
+          matY.col(j) = sinThetaOpt * yI + cosThetaOpt * matY.col(j);
+
+          const vec wI = matW.col(i);
+          matW.col(i) = cosThetaOpt * wI - sinThetaOpt * matW.col(j);
+          matW.col(j) = sinThetaOpt * wI + cosThetaOpt * matW.col(j);
+        }
       }
     }
   }
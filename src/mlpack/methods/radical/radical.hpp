@@ -65,6 +65,11 @@ class Radical
   /**
    * Run RADICAL.
    *
+   * Each sweep visits every pair of dimensions once, in rounds of disjoint
+   * pairs (a round-robin schedule).  The pairs of a round touch different
+   * dimensions, so they are searched and rotated in parallel (if OpenMP is
+   * available).
+   *
    * @param matX Input data into the algorithm - a matrix where each column is
    *    a point and each row is a dimension.
    * @param matY Estimated independent components - a matrix where each column
@@ -75,7 +80,7 @@ class Radical
 
   /**
    * Vasicek's m-spacing estimator of entropy, with overlap modification from
-   * (Learned-Miller and Fisher, 2003).
+   * (Learned-Miller and Fisher, 2003).  The sample is sorted in place.
    *
    * @param x Empirical sample (one-dimensional) over which to estimate entropy.
    */
@@ -88,7 +93,8 @@ class Radical
    */
   void CopyAndPerturb(arma::mat& xNew, const arma::mat& x) const;
 
-  //! Two-dimensional version of RADICAL.
+  //! Two-dimensional version of RADICAL.  The candidate angles are evaluated
+  //! in parallel (if OpenMP is available).
   double DoRadical2D(const arma::mat& matX);
 
   //! Get the standard deviation of the additive Gaussian noise.
@@ -112,6 +118,14 @@ class Radical
   size_t& Sweeps() { return sweeps; }
 
  private:
+  /**
+   * Return the rotation angle in [0, pi / 2) that minimizes the sum of the
+   * entropies of the two rotated dimensions of the given perturbed data.
+   *
+   * @param perturbedX Perturbed two-dimensional data, one point per row.
+   */
+  double BestAngle(const arma::mat& perturbedX) const;
+
   //! Standard deviation of the Gaussian noise added to the replicates of
   //! the data points during Radical2D.
   double noiseStdDev;
@@ -131,8 +145,6 @@ class Radical
 
   //! Internal matrix, held as member variable to prevent memory reallocations.
   arma::mat perturbed;
-  //! Internal matrix, held as member variable to prevent memory reallocations.
-  arma::mat candidate;
 };
 
 void WhitenFeatureMajorMatrix(const arma::mat& matX,
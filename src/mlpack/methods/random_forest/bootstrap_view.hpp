@@ -0,0 +1,121 @@
+/**
+ * @file bootstrap_view.hpp
+ *
+ * Definition of the BootstrapView class, which lets a decision tree train on a
+ * bootstrap sample of a dataset without copying the dataset.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RANDOM_FOREST_BOOTSTRAP_VIEW_HPP
+#define MLPACK_METHODS_RANDOM_FOREST_BOOTSTRAP_VIEW_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * A BootstrapView is a read-only view of some columns of a dataset, selected
+ * (possibly more than once) by an array of indices.  It provides the parts of
+ * the Armadillo matrix interface that the DecisionTree uses for training, so
+ * it can be given to DecisionTree::Train() in place of a matrix.  When the
+ * tree reorders the points of a node, only the indices are swapped, so the
+ * dataset itself is never copied or modified; the only per-tree memory is the
+ * index array.
+ *
+ * Since the columns are gathered through the indices, a row of a range of
+ * columns (as requested by the split types) is returned as a new vector.
+ *
+ * The dataset must outlive the view.
+ *
+ * @tparam MatType Type of the dataset (usually arma::mat).
+ */
+template<typename MatType>
+class BootstrapView
+{
+ public:
+  //! The type of the elements of the dataset.
+  typedef typename MatType::elem_type elem_type;
+
+  /**
+   * A range of columns of a BootstrapView, as returned by cols().
+   */
+  class Columns
+  {
+   public:
+    //! Create the range of the given columns of the given view.
+    Columns(const BootstrapView& view, const size_t begin, const size_t end) :
+        view(view), begin(begin), end(end) { }
+
+    //! Gather the values of the given dimension of the points in the range.
+    arma::Row<elem_type> row(const size_t i) const
+    {
+      arma::Row<elem_type> values(end - begin + 1);
+      for (size_t j = begin; j <= end; ++j)
+        values[j - begin] = view.dataset(i, view.indices[j]);
+
+      return values;
+    }
+
+   private:
+    //! The view the columns belong to.
+    const BootstrapView& view;
+    //! The first column of the range.
+    size_t begin;
+    //! The last column of the range.
+    size_t end;
+  };
+
+  /**
+   * Create a view of the columns of the given dataset with the given indices.
+   *
+   * @param dataset Dataset to view; it is not copied.
+   * @param indices Indices of the columns of the view.
+   */
+  BootstrapView(const MatType& dataset, arma::uvec indices) :
+      n_rows(dataset.n_rows),
+      n_cols(indices.n_elem),
+      dataset(dataset),
+      indices(std::move(indices))
+  { }
+
+  //! Get the value of the given dimension of the given point of the view.
+  elem_type operator()(const size_t row, const size_t col) const
+  {
+    return dataset(row, indices[col]);
+  }
+
+  //! Get the range of the given columns (from begin to end, inclusive).
+  Columns cols(const size_t begin, const size_t end) const
+  {
+    return Columns(*this, begin, end);
+  }
+
+  //! Swap two points of the view (the dataset is not modified).
+  void swap_cols(const size_t a, const size_t b)
+  {
+    std::swap(indices[a], indices[b]);
+  }
+
+  //! Get the indices of the columns of the view.
+  const arma::uvec& Indices() const { return indices; }
+
+  //! The dimensionality of the dataset.
+  size_t n_rows;
+  //! The number of points in the view.
+  size_t n_cols;
+
+ private:
+  //! The viewed dataset.
+  const MatType& dataset;
+  //! The indices of the columns of the view.
+  arma::uvec indices;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,173 @@
+/**
+ * @file flat_forest.hpp
+ *
+ * Definition of the FlatForest class, a compact read-only representation of a
+ * trained random forest that is meant for fast classification.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RANDOM_FOREST_FLAT_FOREST_HPP
+#define MLPACK_METHODS_RANDOM_FOREST_FLAT_FOREST_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * A FlatForest holds the trees of a trained RandomForest in a single
+ * contiguous array of small nodes, instead of in DecisionTree objects that
+ * are linked by pointers and that each hold their split information in a
+ * separate vector.  The nodes of each tree are stored in breadth-first order,
+ * so the children of a node are adjacent, and the class probabilities of all
+ * the leaves are stored in a single matrix.
+ *
+ * When a batch of points is classified, the points are processed in blocks:
+ * every tree is walked for every point of a block before moving to the next
+ * tree, so that the upper levels of a tree stay in cache while the block is
+ * classified.  Blocks are classified in parallel when OpenMP is available.
+ *
+ * A FlatForest can be built from a RandomForest (or anything else with
+ * NumTrees() and Tree() methods) whose numeric splits send points with values
+ * less than or equal to the split value to the first of two children, and
+ * whose categorical splits send points to the child of their category.  This
+ * holds for the BestBinaryNumericSplit, the HistogramNumericSplit, and the
+ * AllCategoricalSplit.  The FlatForest does not change when the forest it was
+ * built from is modified or retrained.
+ *
+ * @code
+ * RandomForest<> rf(data, labels, numClasses);
+ * FlatForest flat(rf);
+ * flat.Classify(testData, predictions, probabilities);
+ * @endcode
+ */
+class FlatForest
+{
+ public:
+  //! Create an empty forest, which cannot classify anything.
+  FlatForest() : numClasses(0) { }
+
+  /**
+   * Flatten the given trained forest.  If the forest has no trees, or a tree
+   * uses a split that sends points to more than two children along a numeric
+   * dimension, std::invalid_argument is thrown.
+   *
+   * @param forest Trained forest to flatten.
+   */
+  template<typename ForestType>
+  FlatForest(const ForestType& forest);
+
+  /**
+   * Predict the class of the given point.
+   *
+   * @param point Point to be classified.
+   */
+  template<typename VecType>
+  size_t Classify(const VecType& point) const;
+
+  /**
+   * Predict the class of the given point and return the predicted class
+   * probabilities for each class.
+   *
+   * @param point Point to be classified.
+   * @param prediction size_t to store predicted class in.
+   * @param probabilities Output vector of class probabilities.
+   */
+  template<typename VecType>
+  void Classify(const VecType& point,
+                size_t& prediction,
+                arma::vec& probabilities) const;
+
+  /**
+   * Predict the classes of each point in the given dataset.
+   *
+   * @param data Dataset to be classified.
+   * @param predictions Output predictions for each point in the dataset.
+   */
+  template<typename MatType>
+  void Classify(const MatType& data,
+                arma::Row<size_t>& predictions) const;
+
+  /**
+   * Predict the classes of each point in the given dataset, also returning the
+   * predicted class probabilities for each point.
+   *
+   * @param data Dataset to be classified.
+   * @param predictions Output predictions for each point in the dataset.
+   * @param probabilities Output matrix of class probabilities for each point.
+   */
+  template<typename MatType>
+  void Classify(const MatType& data,
+                arma::Row<size_t>& predictions,
+                arma::mat& probabilities) const;
+
+  //! Get the number of trees in the forest.
+  size_t NumTrees() const { return roots.size(); }
+  //! Get the number of nodes of all the trees in the forest.
+  size_t NumNodes() const { return nodes.size(); }
+  //! Get the number of classes.
+  size_t NumClasses() const { return numClasses; }
+
+ private:
+  //! The kinds of node.
+  enum NodeType
+  {
+    NumericNode,
+    CategoricalNode,
+    LeafNode
+  };
+
+  //! A node of a flattened tree.
+  struct Node
+  {
+    //! The split value of a numeric node.
+    double value;
+    //! The dimension a non-leaf splits on.
+    uint32_t dimension;
+    //! The NodeType of the node.
+    uint32_t type;
+    //! The index of the first child of a non-leaf, or the column of the class
+    //! probabilities of a leaf.
+    uint64_t offset;
+  };
+
+  //! The number of points classified together, tree by tree.
+  static const size_t BlockSize = 64;
+
+  /**
+   * Append the nodes of the given tree.
+   *
+   * @param tree Root of the tree to flatten.
+   * @param leaves Class probabilities of the leaves, which the leaves of the
+   *      tree are appended to.
+   */
+  template<typename TreeType>
+  void AddTree(const TreeType& tree, std::vector<arma::vec>& leaves);
+
+  /**
+   * Find the leaf the given point falls into in the tree with the given root,
+   * and return the column of its class probabilities.
+   */
+  template<typename VecType>
+  size_t Leaf(const size_t root, const VecType& point) const;
+
+  //! The nodes of all the trees.
+  std::vector<Node> nodes;
+  //! The index of the root of each tree.
+  std::vector<size_t> roots;
+  //! The class probabilities of each leaf, one leaf per column.
+  arma::mat leafProbabilities;
+  //! The number of classes.
+  size_t numClasses;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "flat_forest_impl.hpp"
+
+#endif
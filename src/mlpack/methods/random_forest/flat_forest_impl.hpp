@@ -0,0 +1,211 @@
+/**
+ * @file flat_forest_impl.hpp
+ *
+ * Implementation of the FlatForest class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RANDOM_FOREST_FLAT_FOREST_IMPL_HPP
+#define MLPACK_METHODS_RANDOM_FOREST_FLAT_FOREST_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "flat_forest.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename ForestType>
+FlatForest::FlatForest(const ForestType& forest) : numClasses(0)
+{
+  if (forest.NumTrees() == 0)
+    throw std::invalid_argument("FlatForest::FlatForest(): no random forest "
+        "trained!");
+
+  numClasses = forest.Tree(0).NumClasses();
+
+  std::vector<arma::vec> leaves;
+  for (size_t i = 0; i < forest.NumTrees(); ++i)
+    AddTree(forest.Tree(i), leaves);
+
+  leafProbabilities.set_size(numClasses, leaves.size());
+  for (size_t i = 0; i < leaves.size(); ++i)
+    leafProbabilities.col(i) = leaves[i];
+}
+
+template<typename TreeType>
+void FlatForest::AddTree(const TreeType& tree, std::vector<arma::vec>& leaves)
+{
+  roots.push_back(nodes.size());
+
+  // Walk the tree in breadth-first order, so that the children of each node
+  // are next to each other.  The children of a node are the next unassigned
+  // nodes, so we know where they will be before we get to them.
+  const size_t first = nodes.size();
+  std::vector<const TreeType*> queue;
+  queue.push_back(&tree);
+  for (size_t i = 0; i < queue.size(); ++i)
+  {
+    const TreeType& node = *queue[i];
+
+    Node flatNode;
+    flatNode.value = 0.0;
+    flatNode.dimension = 0;
+    if (node.NumChildren() == 0)
+    {
+      if (node.ClassProbabilities().n_elem != numClasses)
+        throw std::invalid_argument("FlatForest::FlatForest(): the trees of "
+            "the forest have different numbers of classes");
+
+      flatNode.type = LeafNode;
+      flatNode.offset = leaves.size();
+      leaves.push_back(node.ClassProbabilities());
+    }
+    else
+    {
+      flatNode.dimension = node.SplitDimension();
+      flatNode.offset = first + queue.size();
+      if (node.IsCategoricalSplit())
+      {
+        flatNode.type = CategoricalNode;
+      }
+      else
+      {
+        if (node.NumChildren() != 2)
+          throw std::invalid_argument("FlatForest::FlatForest(): only binary "
+              "numeric splits can be flattened");
+
+        flatNode.type = NumericNode;
+        flatNode.value = node.ClassProbabilities()[0];
+      }
+
+      for (size_t c = 0; c < node.NumChildren(); ++c)
+        queue.push_back(&node.Child(c));
+    }
+
+    nodes.push_back(flatNode);
+  }
+}
+
+template<typename VecType>
+size_t FlatForest::Leaf(const size_t root, const VecType& point) const
+{
+  size_t i = root;
+  while (true)
+  {
+    const Node& node = nodes[i];
+    if (node.type == NumericNode)
+    {
+      // Points equal to the split value go left and NaNs go right, as in the
+      // DecisionTree.
+      i = node.offset + (point[node.dimension] <= node.value ? 0 : 1);
+    }
+    else if (node.type == CategoricalNode)
+    {
+      i = node.offset + (size_t) point[node.dimension];
+    }
+    else
+    {
+      return node.offset;
+    }
+  }
+}
+
+template<typename VecType>
+size_t FlatForest::Classify(const VecType& point) const
+{
+  // Pass off to another Classify() overload.
+  size_t predictedClass;
+  arma::vec probabilities;
+  Classify(point, predictedClass, probabilities);
+
+  return predictedClass;
+}
+
+template<typename VecType>
+void FlatForest::Classify(const VecType& point,
+                          size_t& prediction,
+                          arma::vec& probabilities) const
+{
+  if (roots.empty())
+    throw std::invalid_argument("FlatForest::Classify(): no random forest "
+        "trained!");
+
+  probabilities.zeros(numClasses);
+  for (size_t t = 0; t < roots.size(); ++t)
+    probabilities += leafProbabilities.col(Leaf(roots[t], point));
+
+  // Find maximum element after renormalizing probabilities.
+  probabilities /= roots.size();
+  arma::uword maxIndex = 0;
+  probabilities.max(maxIndex);
+
+  prediction = (size_t) maxIndex;
+}
+
+template<typename MatType>
+void FlatForest::Classify(const MatType& data,
+                          arma::Row<size_t>& predictions) const
+{
+  arma::mat probabilities;
+  Classify(data, predictions, probabilities);
+}
+
+template<typename MatType>
+void FlatForest::Classify(const MatType& data,
+                          arma::Row<size_t>& predictions,
+                          arma::mat& probabilities) const
+{
+  typedef typename MatType::elem_type ElemType;
+
+  if (roots.empty())
+  {
+    predictions.clear();
+    probabilities.clear();
+
+    throw std::invalid_argument("FlatForest::Classify(): no random forest "
+        "trained!");
+  }
+
+  probabilities.zeros(numClasses, data.n_cols);
+  predictions.set_size(data.n_cols);
+
+  // Classify each block of points with every tree in turn, so that the nodes
+  // near the root of the tree stay in cache for the whole block.
+  const size_t numBlocks = (data.n_cols + BlockSize - 1) / BlockSize;
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+  {
+    const size_t begin = b * BlockSize;
+    const size_t end = std::min(begin + BlockSize, (size_t) data.n_cols);
+    for (size_t t = 0; t < roots.size(); ++t)
+    {
+      for (size_t i = begin; i < end; ++i)
+      {
+        const ElemType* point = data.colptr(i);
+        const double* leaf = leafProbabilities.colptr(Leaf(roots[t], point));
+        double* out = probabilities.colptr(i);
+        for (size_t c = 0; c < numClasses; ++c)
+          out[c] += leaf[c];
+      }
+    }
+
+    // Find maximum element after renormalizing probabilities.
+    for (size_t i = begin; i < end; ++i)
+    {
+      arma::vec probs = probabilities.unsafe_col(i);
+      probs /= roots.size();
+
+      arma::uword maxIndex = 0;
+      probs.max(maxIndex);
+      predictions[i] = (size_t) maxIndex;
+    }
+  }
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
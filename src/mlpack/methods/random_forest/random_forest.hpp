@@ -15,6 +15,8 @@
 #include <mlpack/methods/decision_tree/decision_tree.hpp>
 #include <mlpack/methods/decision_tree/multiple_random_dimension_select.hpp>
 #include "bootstrap.hpp"
+#include "bootstrap_view.hpp"
+#include "flat_forest.hpp"
 
 namespace mlpack {
 namespace tree {
@@ -456,12 +456,18 @@ double RandomForest<
   #pragma omp parallel for reduction( + : avgGain)
   for (omp_size_t i = 0; i < numTrees; ++i)
   {
+    // Sample the points with replacement, but only gather the labels and the
+    // weights: each tree trains on a view of the shared dataset, so the memory
+    // used does not grow with the size of the dataset or the number of
+    // threads.
     Timer::Start("bootstrap");
-    MatType bootstrapDataset;
-    arma::Row<size_t> bootstrapLabels;
+    arma::uvec indices = arma::randi<arma::uvec>(dataset.n_cols,
+        arma::distr_param(0, dataset.n_cols - 1));
+    arma::Row<size_t> bootstrapLabels = labels.cols(indices);
     arma::rowvec bootstrapWeights;
-    Bootstrap<UseWeights>(dataset, labels, weights, bootstrapDataset,
-        bootstrapLabels, bootstrapWeights);
+    if (UseWeights)
+      bootstrapWeights = weights.cols(indices);
+    BootstrapView<MatType> bootstrapDataset(dataset, std::move(indices));
     Timer::Stop("bootstrap");
 
     // Now build the decision tree.
@@ -470,14 +476,16 @@ double RandomForest<
     {
       if (UseDatasetInfo)
       {
-        avgGain += trees[i].Train(bootstrapDataset, datasetInfo,
-            bootstrapLabels, numClasses, bootstrapWeights, minimumLeafSize,
-            minimumGainSplit, dimensionSelector);
+        avgGain += trees[i].Train(std::move(bootstrapDataset), datasetInfo,
+            std::move(bootstrapLabels), numClasses,
+            std::move(bootstrapWeights), minimumLeafSize, minimumGainSplit,
+            dimensionSelector);
       }
       else
       {
-        avgGain += trees[i].Train(bootstrapDataset, bootstrapLabels, numClasses,
-            bootstrapWeights, minimumLeafSize, minimumGainSplit,
+        avgGain += trees[i].Train(std::move(bootstrapDataset),
+            std::move(bootstrapLabels), numClasses,
+            std::move(bootstrapWeights), minimumLeafSize, minimumGainSplit,
             dimensionSelector);
       }
     }
@@ -485,14 +493,15 @@ double RandomForest<
     {
       if (UseDatasetInfo)
       {
-        avgGain += trees[i].Train(bootstrapDataset, datasetInfo,
-            bootstrapLabels, numClasses, minimumLeafSize, minimumGainSplit,
-            dimensionSelector);
+        avgGain += trees[i].Train(std::move(bootstrapDataset), datasetInfo,
+            std::move(bootstrapLabels), numClasses, minimumLeafSize,
+            minimumGainSplit, dimensionSelector);
       }
       else
       {
-        avgGain += trees[i].Train(bootstrapDataset, bootstrapLabels, numClasses,
-            minimumLeafSize, minimumGainSplit, dimensionSelector);
+        avgGain += trees[i].Train(std::move(bootstrapDataset),
+            std::move(bootstrapLabels), numClasses, minimumLeafSize,
+            minimumGainSplit, dimensionSelector);
       }
     }
     Timer::Stop("train_tree");
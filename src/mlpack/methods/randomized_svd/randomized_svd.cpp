@@ -12,6 +12,8 @@
 
 #include "randomized_svd.hpp"
 
+#include <mlpack/core/math/lin_alg.hpp>
+
 namespace mlpack {
 namespace svd {
 
@@ -54,10 +56,11 @@ void RandomizedSVD::Apply(const arma::sp_mat& data,
                           arma::mat& v,
                           const size_t rank)
 {
-  // Center the data into a temporary matrix for sparse matrix.
-  arma::sp_mat rowMean = arma::sum(data, 1) / data.n_cols;
+  // The data is centered implicitly, so it stays sparse.
+  const arma::vec rowMean = arma::vec(arma::mat(arma::sum(data, 1))) /
+      data.n_cols;
 
-  Apply(data, u, s, v, rank, rowMean);
+  Factorize(data, u, s, v, rank, rowMean);
 }
 
 void RandomizedSVD::Apply(const arma::mat& data,
@@ -66,10 +69,146 @@ void RandomizedSVD::Apply(const arma::mat& data,
                           arma::mat& v,
                           const size_t rank)
 {
-  // Center the data into a temporary matrix.
-  arma::mat rowMean = arma::sum(data, 1) / data.n_cols + eps;
+  // Center the data implicitly.
+  const arma::vec rowMean = arma::sum(data, 1) / data.n_cols + eps;
+
+  Factorize(data, u, s, v, rank, rowMean);
+}
+
+template<typename TimesType, typename TransTimesType>
+void RandomizedSVD::Factorize(const size_t nRows,
+                              const size_t nCols,
+                              TimesType times,
+                              TransTimesType transTimes,
+                              arma::mat& u,
+                              arma::vec& s,
+                              arma::mat& v,
+                              const size_t rank)
+{
+  if (iteratedPower == 0)
+    iteratedPower = rank + 2;
+
+  arma::mat R, Q, Qdata;
+
+  // Apply the centered data matrix to a random matrix, obtaining Q.
+  if (nCols >= nRows)
+  {
+    R = arma::randn<arma::mat>(nRows, iteratedPower);
+    Q = transTimes(R);
+  }
+  else
+  {
+    R = arma::randn<arma::mat>(nCols, iteratedPower);
+    Q = times(R);
+  }
+
+  // Form a matrix Q whose columns constitute a
+  // well-conditioned basis for the columns of the earlier Q.
+  if (maxIterations == 0)
+  {
+    math::OrthonormalizeColumns(Q);
+  }
+  else
+  {
+    arma::lu(Q, v, Q);
+  }
+
+  // Perform normalized power iterations.
+  for (size_t i = 0; i < maxIterations; ++i)
+  {
+    if (nCols >= nRows)
+    {
+      Q = times(Q);
+      arma::lu(Q, v, Q);
+      Q = transTimes(Q);
+    }
+    else
+    {
+      Q = transTimes(Q);
+      arma::lu(Q, v, Q);
+      Q = times(Q);
+    }
+
+    // Computing the LU decomposition is more efficient than computing the QR
+    // decomposition, so we only use it in the last iteration, a Cholesky QR
+    // decomposition (made of matrix products, so it runs in parallel) which
+    // renormalizes Q, ensuring that the columns of Q are orthonormal.
+    if (i < (maxIterations - 1))
+    {
+      arma::lu(Q, v, Q);
+    }
+    else
+    {
+      math::OrthonormalizeColumns(Q);
+    }
+  }
+
+  // Do economical singular value decomposition and compute only the
+  // approximations of the left singular vectors by using the centered data
+  // applied to Q.
+  if (nCols >= nRows)
+  {
+    Qdata = times(Q);
+    arma::svd_econ(u, s, v, Qdata);
+    v = Q * v;
+  }
+  else
+  {
+    Qdata = arma::trans(transTimes(Q));
+    arma::svd_econ(u, s, v, Qdata);
+    u = Q * u;
+  }
+}
+
+void RandomizedSVD::Factorize(const arma::mat& data,
+                              arma::mat& u,
+                              arma::vec& s,
+                              arma::mat& v,
+                              const size_t rank,
+                              const arma::vec& rowMean)
+{
+  // Each product with the centered data is the product with the data, minus a
+  // rank-one correction for the mean.
+  auto times = [&](const arma::mat& q)
+  {
+    return arma::mat(data * q - rowMean * arma::sum(q, 0));
+  };
+  auto transTimes = [&](const arma::mat& q)
+  {
+    arma::mat result = data.t() * q;
+    result.each_row() -= rowMean.t() * q;
+    return result;
+  };
+
+  Factorize(data.n_rows, data.n_cols, times, transTimes, u, s, v, rank);
+}
+
+void RandomizedSVD::Factorize(const arma::sp_mat& data,
+                              arma::mat& u,
+                              arma::vec& s,
+                              arma::mat& v,
+                              const size_t rank,
+                              const arma::vec& rowMean)
+{
+  // The products with the data are computed in parallel over its columns,
+  // which needs a transposed copy of the data for data * Q.
+  const arma::sp_mat dataT = data.t();
+  auto times = [&](const arma::mat& q)
+  {
+    arma::mat result;
+    math::SparseTransposeMultiply(dataT, q, result);
+    result -= rowMean * arma::sum(q, 0);
+    return result;
+  };
+  auto transTimes = [&](const arma::mat& q)
+  {
+    arma::mat result;
+    math::SparseTransposeMultiply(data, q, result);
+    result.each_row() -= rowMean.t() * q;
+    return result;
+  };
 
-  Apply(data, u, s, v, rank, rowMean);
+  Factorize(data.n_rows, data.n_cols, times, transTimes, u, s, v, rank);
 }
 
 } // namespace svd
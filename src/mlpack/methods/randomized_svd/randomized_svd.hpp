@@ -138,7 +138,9 @@ class RandomizedSVD
 
   /**
    * Apply Principal Component Analysis to the provided matrix data set
-   * using the randomized SVD.
+   * using the randomized SVD.  The data is centered implicitly: rowMean is
+   * subtracted from each column as a rank-one correction of every product
+   * with the data, so a sparse data matrix is never densified.
    *
    * @param data Data matrix.
    * @param u First unitary matrix.
@@ -155,80 +157,8 @@ class RandomizedSVD
              const size_t rank,
              MatType rowMean)
   {
-    if (iteratedPower == 0)
-      iteratedPower = rank + 2;
-
-    arma::mat R, Q, Qdata;
-
-    // Apply the centered data matrix to a random matrix, obtaining Q.
-    if (data.n_cols >= data.n_rows)
-    {
-      R = arma::randn<arma::mat>(data.n_rows, iteratedPower);
-      Q = (data.t() * R) - arma::repmat(arma::trans(R.t() * rowMean),
-          data.n_cols, 1);
-    }
-    else
-    {
-      R = arma::randn<arma::mat>(data.n_cols, iteratedPower);
-      Q = (data * R) - (rowMean * (arma::ones(1, data.n_cols) * R));
-    }
-
-    // Form a matrix Q whose columns constitute a
-    // well-conditioned basis for the columns of the earlier Q.
-    if (maxIterations == 0)
-    {
-      arma::qr_econ(Q, v, Q);
-    }
-    else
-    {
-      arma::lu(Q, v, Q);
-    }
-
-    // Perform normalized power iterations.
-    for (size_t i = 0; i < maxIterations; ++i)
-    {
-      if (data.n_cols >= data.n_rows)
-      {
-        Q = (data * Q) - rowMean * (arma::ones(1, data.n_cols) * Q);
-        arma::lu(Q, v, Q);
-        Q = (data.t() * Q) - arma::repmat(rowMean.t() * Q, data.n_cols, 1);
-      }
-      else
-      {
-        Q = (data.t() * Q) - arma::repmat(rowMean.t() * Q, data.n_cols, 1);
-        arma::lu(Q, v, Q);
-        Q = (data * Q) - (rowMean * (arma::ones(1, data.n_cols) * Q));
-      }
-
-      // Computing the LU decomposition is more efficient than computing the QR
-      // decomposition, so we only use it in the last iteration, a pivoted QR
-      // decomposition which renormalizes Q, ensuring that the columns of Q are
-      // orthonormal.
-      if (i < (maxIterations - 1))
-      {
-        arma::lu(Q, v, Q);
-      }
-      else
-      {
-        arma::qr_econ(Q, v, Q);
-      }
-    }
-
-    // Do economical singular value decomposition and compute only the
-    // approximations of the left singular vectors by using the centered data
-    // applied to Q.
-    if (data.n_cols >= data.n_rows)
-    {
-      Qdata = (data * Q) - rowMean * (arma::ones(1, data.n_cols) * Q);
-      arma::svd_econ(u, s, v, Qdata);
-      v = Q * v;
-    }
-    else
-    {
-      Qdata = (Q.t() * data) - arma::repmat(Q.t() * rowMean, 1,  data.n_cols);
-      arma::svd_econ(u, s, v, Qdata);
-      u = Q * u;
-    }
+    // The mean is dense even if the data is sparse.
+    Factorize(data, u, s, v, rank, arma::vec(arma::mat(rowMean)));
   }
 
   //! Get the size of the normalized power iterations.
@@ -247,6 +177,43 @@ class RandomizedSVD
   double& Epsilon() { return eps; }
 
  private:
+  /**
+   * Run the randomized SVD on the given dense data matrix minus rowMean (in
+   * each column), without forming the centered matrix.
+   */
+  void Factorize(const arma::mat& data,
+                 arma::mat& u,
+                 arma::vec& s,
+                 arma::mat& v,
+                 const size_t rank,
+                 const arma::vec& rowMean);
+
+  /**
+   * Run the randomized SVD on the given sparse data matrix minus rowMean (in
+   * each column), without forming the centered matrix.  The products with the
+   * data are computed in parallel.
+   */
+  void Factorize(const arma::sp_mat& data,
+                 arma::mat& u,
+                 arma::vec& s,
+                 arma::mat& v,
+                 const size_t rank,
+                 const arma::vec& rowMean);
+
+  /**
+   * Run the randomized SVD on an implicitly given matrix A of the given size,
+   * where times(Q) computes A * Q and transTimes(Q) computes A^T * Q.
+   */
+  template<typename TimesType, typename TransTimesType>
+  void Factorize(const size_t nRows,
+                 const size_t nCols,
+                 TimesType times,
+                 TransTimesType transTimes,
+                 arma::mat& u,
+                 arma::vec& s,
+                 arma::mat& v,
+                 const size_t rank);
+
   //! Locally stored size of the normalized power iterations.
   size_t iteratedPower;
 
@@ -16,7 +16,10 @@
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/tree/binary_space_tree.hpp>
+#include <mlpack/core/tree/space_filling_curve.hpp>
+#include <mlpack/core/tree/traversal_statistics.hpp>
 #include "range_search_stat.hpp"
+#include "range_search_callbacks.hpp"
 
 namespace mlpack {
 namespace range /** Range-search routines. */ {
@@ -262,6 +265,152 @@ class RangeSearch
               std::vector<std::vector<size_t>>& neighbors,
               std::vector<std::vector<double>>& distances);
 
+  /**
+   * Search for all reference points in the given range for each point in the
+   * query set, passing each result to the given callback as it is found
+   * instead of storing it.  The callback must be callable as
+   *
+   * @code
+   * callback(queryIndex, referenceIndex, distance);
+   * @endcode
+   *
+   * and is given the indices of the points in the original datasets.  Results
+   * are found in no particular order, and the callback is only ever called
+   * from one thread.  This allows results to be consumed without ever being
+   * materialized.
+   *
+   * @param querySet Set of query points to search with.
+   * @param range Range of distances in which to search.
+   * @param callback Callback to pass each result to.
+   */
+  template<typename CallbackType>
+  void Search(const MatType& querySet,
+              const math::Range& range,
+              CallbackType& callback);
+
+  /**
+   * Search for all points in the given range for each point in the reference
+   * set, passing each result to the given callback as it is found instead of
+   * storing it.  See the overload that takes a query set for the requirements
+   * of the callback.  A point is never passed as its own result.
+   *
+   * @param range Range of distances in which to search.
+   * @param callback Callback to pass each result to.
+   */
+  template<typename CallbackType>
+  void Search(const math::Range& range, CallbackType& callback);
+
+  /**
+   * Search for all points in the given range for each point in the query set,
+   * passing each result to the given callback as it is found, like the
+   * callback overload of Search(), but using all available threads: query
+   * points are split between threads in naive and single-tree mode, and the
+   * query tree is split into parallel tasks in dual-tree mode.  The callback
+   * may therefore be called concurrently from several threads, and must be
+   * thread-safe.
+   *
+   * @param querySet Set of query points to search with.
+   * @param range Range of distances in which to search.
+   * @param callback Thread-safe callback to pass each result to.
+   */
+  template<typename CallbackType>
+  void ParallelSearch(const MatType& querySet,
+                      const math::Range& range,
+                      CallbackType& callback);
+
+  /**
+   * Search for all points in the given range for each point in the reference
+   * set, passing each result to the given callback from several threads.  See
+   * the overload that takes a query set for the requirements of the callback.
+   * A point is never passed as its own result.
+   *
+   * @param range Range of distances in which to search.
+   * @param callback Thread-safe callback to pass each result to.
+   */
+  template<typename CallbackType>
+  void ParallelSearch(const math::Range& range, CallbackType& callback);
+
+  /**
+   * Search for all reference points in the given range for each point in the
+   * query set, returning the results in compact (CSR-style) form: the
+   * neighbors of query point i are neighbors[offsets[i]] to
+   * neighbors[offsets[i + 1] - 1], with the corresponding distances in the
+   * same positions of distances.  This avoids one vector allocation (and its
+   * reallocations) per query point, and uses much less memory than the
+   * vector-of-vectors overload when there are many results.
+   *
+   * @param querySet Set of query points to search with.
+   * @param range Range of distances in which to search.
+   * @param offsets Will hold the query set size + 1 offsets of the results of
+   *      each query point.
+   * @param neighbors Will hold the neighbors of all query points.
+   * @param distances Will hold the distances of all query points.
+   */
+  void Search(const MatType& querySet,
+              const math::Range& range,
+              arma::Col<size_t>& offsets,
+              arma::Col<size_t>& neighbors,
+              arma::vec& distances);
+
+  /**
+   * Search for all points in the given range for each point in the reference
+   * set, returning the results in compact (CSR-style) form.  See the overload
+   * that takes a query set for the format of the results.
+   *
+   * @param range Range of distances in which to search.
+   * @param offsets Will hold the reference set size + 1 offsets of the results
+   *      of each point.
+   * @param neighbors Will hold the neighbors of all points.
+   * @param distances Will hold the distances of all points.
+   */
+  void Search(const math::Range& range,
+              arma::Col<size_t>& offsets,
+              arma::Col<size_t>& neighbors,
+              arma::vec& distances);
+
+  /**
+   * Search for all reference points within each of several radii of each point
+   * in the query set, with one traversal that is pruned with the largest
+   * radius.  Each result is put in the bucket of the smallest radius that
+   * contains it:
+   *
+   * - neighbors.size() and distances.size() both equal radii.size(), and
+   *   neighbors[r].size() equals the number of query points.
+   *
+   * - neighbors[0][i] holds the reference points within distance radii[0] of
+   *   query point i, and neighbors[r][i] (for r > 0) holds those at a distance
+   *   greater than radii[r - 1] and at most radii[r].  So the results within
+   *   radii[r] are those of buckets 0 to r.
+   *
+   * - distances[r][i] holds the distances of the points in neighbors[r][i].
+   *
+   * This is much faster than one search for each radius.
+   *
+   * @param querySet Set of query points to search with.
+   * @param radii Radii to search with, in strictly increasing order.
+   * @param neighbors Will hold the neighbors of each query point, for each
+   *      bucket.
+   * @param distances Will hold the distances of each query point, for each
+   *      bucket.
+   */
+  void Search(const MatType& querySet,
+              const std::vector<double>& radii,
+              std::vector<std::vector<std::vector<size_t>>>& neighbors,
+              std::vector<std::vector<std::vector<double>>>& distances);
+
+  /**
+   * Search for all points within each of several radii of each point in the
+   * reference set, with one traversal.  See the overload that takes a query
+   * set for the format of the results.  A point is never its own result.
+   *
+   * @param radii Radii to search with, in strictly increasing order.
+   * @param neighbors Will hold the neighbors of each point, for each bucket.
+   * @param distances Will hold the distances of each point, for each bucket.
+   */
+  void Search(const std::vector<double>& radii,
+              std::vector<std::vector<std::vector<size_t>>>& neighbors,
+              std::vector<std::vector<std::vector<double>>>& distances);
+
   //! Get whether single-tree search is being used.
   bool SingleMode() const { return singleMode; }
   //! Modify whether single-tree search is being used.
@@ -272,11 +421,29 @@ class RangeSearch
   //! Modify whether naive search is being used.
   bool& Naive() { return naive; }
 
+  //! Get the space-filling curve along which the query points are visited in
+  //! single-tree mode.
+  tree::SpaceFillingCurve QueryCurve() const { return queryCurve; }
+  //! Modify the space-filling curve along which the query points of a query
+  //! set are visited in single-tree mode (see tree::SpaceFillingCurveOrder()).
+  //! The results are the same, but a callback is called for the query points
+  //! in the order of the curve.
+  tree::SpaceFillingCurve& QueryCurve() { return queryCurve; }
+
   //! Get the number of base cases during the last search.
   size_t BaseCases() const { return baseCases; }
   //! Get the number of scores during the last search.
   size_t Scores() const { return scores; }
 
+  /**
+   * Access the detailed traversal statistics of the last search.  These are
+   * only collected if Statistics().Enabled() is set to true before searching;
+   * when they are, they are also printed to Log::Info after each search.
+   */
+  const tree::TraversalStatistics& Statistics() const { return statistics; }
+  //! Modify the traversal statistics (i.e. to enable their collection).
+  tree::TraversalStatistics& Statistics() { return statistics; }
+
   //! Serialize the model.
   template<typename Archive>
   void serialize(Archive& ar, const unsigned int version);
@@ -303,6 +470,9 @@ class RangeSearch
   bool naive;
   //! If true, single-tree computation is used.
   bool singleMode;
+  //! The space-filling curve along which query points are visited in
+  //! single-tree mode.
+  tree::SpaceFillingCurve queryCurve;
 
   //! Instantiated distance metric.
   MetricType metric;
@@ -312,6 +482,27 @@ class RangeSearch
   //! The total number of scores during the last search.
   size_t scores;
 
+  //! Detailed statistics of the last search.
+  tree::TraversalStatistics statistics;
+
+  //! Store the totals of the last search, which took the given number of
+  //! seconds, in the statistics, and report them if they are enabled.
+  void RecordStatistics(const double searchTime);
+
+  /**
+   * Run a search and pass each result, with the indices of the points in the
+   * original datasets, to the given callback.  The query points are the given
+   * query set, or the points of the given query tree (whose indices are not
+   * mapped), or the reference set if both are NULL.  The dual-tree traversal
+   * is only run in parallel if Parallel is true, which requires that the
+   * callback may be called from several threads for different query points.
+   */
+  template<bool Parallel, typename CallbackType>
+  void ComputeResults(const MatType* querySet,
+                      Tree* queryTree,
+                      const math::Range& range,
+                      CallbackType& callback);
+
   //! For access to mappings when building models.
   friend class TrainVisitor;
 };
@@ -0,0 +1,226 @@
+/**
+ * @file range_search_callbacks.hpp
+ *
+ * Callbacks that receive the results of a range search as they are found:
+ * VectorResults stores them in vectors of vectors, CompactResults stores them
+ * in a compact (CSR-style) form, and MappedResults maps the indices of results
+ * back to the original indices of rearranged datasets.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RANGE_SEARCH_RANGE_SEARCH_CALLBACKS_HPP
+#define MLPACK_METHODS_RANGE_SEARCH_RANGE_SEARCH_CALLBACKS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace range {
+
+/**
+ * VectorResults stores the results of a range search in one vector of
+ * neighbor indices and one vector of distances for each query point.  The
+ * vectors must already have one element for each query point.  Each query
+ * point is only ever handled by one thread, so this callback can be used with
+ * parallel traversals.
+ */
+class VectorResults
+{
+ public:
+  /**
+   * Store results in the given vectors.
+   *
+   * @param neighbors Vector to store the neighbors of each query point in.
+   * @param distances Vector to store the distances of each query point in.
+   */
+  VectorResults(std::vector<std::vector<size_t>>& neighbors,
+                std::vector<std::vector<double>>& distances) :
+      neighbors(neighbors),
+      distances(distances)
+  { }
+
+  //! Store the given result.
+  void operator()(const size_t queryIndex,
+                  const size_t referenceIndex,
+                  const double distance)
+  {
+    neighbors[queryIndex].push_back(referenceIndex);
+    distances[queryIndex].push_back(distance);
+  }
+
+ private:
+  //! The neighbors of each query point.
+  std::vector<std::vector<size_t>>& neighbors;
+  //! The distances of each query point.
+  std::vector<std::vector<double>>& distances;
+};
+
+/**
+ * RadiusBucketResults stores the results of a search with several radii: each
+ * result is put in the bucket of the smallest radius that contains it, so the
+ * results within radius r are those of buckets 0 to r.  The vectors of each
+ * bucket must already have one element for each query point.  Like
+ * VectorResults, this callback can be used with parallel traversals.
+ */
+class RadiusBucketResults
+{
+ public:
+  /**
+   * Store results in the given vectors.
+   *
+   * @param radii Radii of the buckets, in increasing order.
+   * @param neighbors Vectors to store the neighbors of each query point in,
+   *     for each bucket.
+   * @param distances Vectors to store the distances of each query point in,
+   *     for each bucket.
+   */
+  RadiusBucketResults(
+      const std::vector<double>& radii,
+      std::vector<std::vector<std::vector<size_t>>>& neighbors,
+      std::vector<std::vector<std::vector<double>>>& distances) :
+      radii(radii),
+      neighbors(neighbors),
+      distances(distances)
+  { }
+
+  //! Store the given result in its bucket.
+  void operator()(const size_t queryIndex,
+                  const size_t referenceIndex,
+                  const double distance)
+  {
+    const size_t bucket = std::lower_bound(radii.begin(), radii.end(),
+        distance) - radii.begin();
+    neighbors[bucket][queryIndex].push_back(referenceIndex);
+    distances[bucket][queryIndex].push_back(distance);
+  }
+
+ private:
+  //! The radii of the buckets.
+  const std::vector<double>& radii;
+  //! The neighbors of each query point in each bucket.
+  std::vector<std::vector<std::vector<size_t>>>& neighbors;
+  //! The distances of each query point in each bucket.
+  std::vector<std::vector<std::vector<double>>>& distances;
+};
+
+/**
+ * CompactResults collects the results of a range search in flat arrays, and
+ * then compacts them into a CSR-style form with Compact(): the neighbors of
+ * query point i are neighbors[offsets[i]] to neighbors[offsets[i + 1] - 1].
+ * This avoids one allocation per query point, and the reallocations of each of
+ * those, which dominate the cost of searches with large ranges.
+ *
+ * This callback is not thread-safe.
+ */
+class CompactResults
+{
+ public:
+  //! Store the given result.
+  void operator()(const size_t queryIndex,
+                  const size_t referenceIndex,
+                  const double distance)
+  {
+    queries.push_back(queryIndex);
+    neighbors.push_back(referenceIndex);
+    distances.push_back(distance);
+  }
+
+  /**
+   * Sort the collected results by query point and store them in CSR form.
+   * The results of each query point keep the order they were found in.  The
+   * collected results are cleared.
+   *
+   * @param numQueries Number of query points.
+   * @param offsets Set to the numQueries + 1 offsets of the results of each
+   *     query point.
+   * @param neighborsOut Set to the neighbor indices of all query points.
+   * @param distancesOut Set to the distances of all query points.
+   */
+  void Compact(const size_t numQueries,
+               arma::Col<size_t>& offsets,
+               arma::Col<size_t>& neighborsOut,
+               arma::vec& distancesOut)
+  {
+    offsets.zeros(numQueries + 1);
+    for (size_t i = 0; i < queries.size(); ++i)
+      ++offsets[queries[i] + 1];
+    for (size_t i = 0; i < numQueries; ++i)
+      offsets[i + 1] += offsets[i];
+
+    neighborsOut.set_size(queries.size());
+    distancesOut.set_size(queries.size());
+    arma::Col<size_t> next(offsets.head(numQueries));
+    for (size_t i = 0; i < queries.size(); ++i)
+    {
+      const size_t position = next[queries[i]]++;
+      neighborsOut[position] = neighbors[i];
+      distancesOut[position] = distances[i];
+    }
+
+    std::vector<size_t>().swap(queries);
+    std::vector<size_t>().swap(neighbors);
+    std::vector<double>().swap(distances);
+  }
+
+ private:
+  //! The query point of each result.
+  std::vector<size_t> queries;
+  //! The neighbor of each result.
+  std::vector<size_t> neighbors;
+  //! The distance of each result.
+  std::vector<double> distances;
+};
+
+/**
+ * MappedResults passes each result to another callback after mapping its query
+ * and reference indices back to the original indices of datasets that were
+ * rearranged when trees were built on them.
+ *
+ * @tparam CallbackType Type of the callback to pass results to.
+ */
+template<typename CallbackType>
+class MappedResults
+{
+ public:
+  /**
+   * Pass results to the given callback.
+   *
+   * @param callback Callback to pass results to.
+   * @param oldFromNewQueries Mapping of query indices, or NULL if the query
+   *     indices need no mapping.
+   * @param oldFromNewReferences Mapping of reference indices, or NULL if the
+   *     reference indices need no mapping.
+   */
+  MappedResults(CallbackType& callback,
+                const std::vector<size_t>* oldFromNewQueries,
+                const std::vector<size_t>* oldFromNewReferences) :
+      callback(callback),
+      oldFromNewQueries(oldFromNewQueries),
+      oldFromNewReferences(oldFromNewReferences)
+  { }
+
+  //! Map the indices of the given result and pass it to the callback.
+  void operator()(const size_t queryIndex,
+                  const size_t referenceIndex,
+                  const double distance)
+  {
+    callback(oldFromNewQueries ? (*oldFromNewQueries)[queryIndex] : queryIndex,
+        oldFromNewReferences ? (*oldFromNewReferences)[referenceIndex] :
+        referenceIndex, distance);
+  }
+
+ private:
+  //! The callback to pass results to.
+  CallbackType& callback;
+  //! The mapping of query indices (or NULL).
+  const std::vector<size_t>* oldFromNewQueries;
+  //! The mapping of reference indices (or NULL).
+  const std::vector<size_t>* oldFromNewReferences;
+};
+
+} // namespace range
+} // namespace mlpack
+
+#endif
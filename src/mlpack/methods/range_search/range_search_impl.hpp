@@ -17,6 +17,7 @@
 
 // The rules for traversal.
 #include "range_search_rules.hpp"
+#include <mlpack/core/tree/parallel_dual_tree_traverser.hpp>
 
 namespace mlpack {
 namespace range {
@@ -42,6 +43,125 @@ TreeType* BuildTree(
   return new TreeType(std::forward<MatType>(dataset));
 }
 
+//! Check the radii of a multi-radius search, set up the buckets of the results,
+//! and return the range that contains all the radii.
+inline math::Range RadiusBuckets(
+    const std::vector<double>& radii,
+    const size_t numQueries,
+    std::vector<std::vector<std::vector<size_t>>>& neighbors,
+    std::vector<std::vector<std::vector<double>>>& distances)
+{
+  if (radii.empty())
+    throw std::invalid_argument("RangeSearch::Search(): no radii given");
+  for (size_t i = 0; i < radii.size(); ++i)
+  {
+    if (radii[i] < 0.0 || (i > 0 && radii[i] <= radii[i - 1]))
+      throw std::invalid_argument("RangeSearch::Search(): radii must be "
+          "nonnegative and in strictly increasing order");
+  }
+
+  neighbors.clear();
+  neighbors.resize(radii.size(),
+      std::vector<std::vector<size_t>>(numQueries));
+  distances.clear();
+  distances.resize(radii.size(),
+      std::vector<std::vector<double>>(numQueries));
+
+  return math::Range(0.0, radii.back());
+}
+
+//! Run a dual-tree traversal that splits the query tree into parallel tasks.
+//! This is only valid for trees that do not duplicate points between nodes,
+//! and for callbacks that may be called from several threads (for different
+//! query points).
+template<bool Parallel, typename TreeType, typename RuleType>
+void DualTreeTraversal(
+    RuleType& rules,
+    TreeType& queryTree,
+    TreeType& referenceTree,
+    const typename std::enable_if<
+        Parallel &&
+        tree::TreeTraits<TreeType>::BinaryTree &&
+        !tree::TreeTraits<TreeType>::HasDuplicatedPoints>::type* = 0)
+{
+  tree::ParallelDualTreeTraverser<TreeType, RuleType> traverser(rules);
+  traverser.Traverse(queryTree, referenceTree);
+}
+
+//! Run a serial dual-tree traversal.
+template<bool Parallel, typename TreeType, typename RuleType>
+void DualTreeTraversal(
+    RuleType& rules,
+    TreeType& queryTree,
+    TreeType& referenceTree,
+    const typename std::enable_if<
+        !Parallel ||
+        !tree::TreeTraits<TreeType>::BinaryTree ||
+        tree::TreeTraits<TreeType>::HasDuplicatedPoints>::type* = 0)
+{
+  typename TreeType::template DualTreeTraverser<RuleType> traverser(rules);
+  traverser.Traverse(queryTree, referenceTree);
+}
+
+//! Run the base cases (if referenceTree is NULL) or single-tree traversals for
+//! the given number of query points, in the given order (if it is not empty).
+//! If Parallel is true, the query points are split between threads, each with
+//! its own copy of the rules, which are merged back into the given rules; this
+//! requires that the callback may be called from several threads (for
+//! different query points).
+template<bool Parallel, typename TreeType, typename RuleType>
+void QueryTraversal(RuleType& rules,
+                    const size_t numQueries,
+                    const size_t numReferences,
+                    TreeType* referenceTree,
+                    const std::vector<size_t>& order = std::vector<size_t>())
+{
+  if (!Parallel)
+  {
+    if (!referenceTree)
+    {
+      for (size_t i = 0; i < numQueries; ++i)
+        for (size_t j = 0; j < numReferences; ++j)
+          rules.BaseCase(i, j);
+    }
+    else
+    {
+      typename TreeType::template SingleTreeTraverser<RuleType>
+          traverser(rules);
+      for (size_t i = 0; i < numQueries; ++i)
+        traverser.Traverse(order.empty() ? i : order[i], *referenceTree);
+    }
+
+    return;
+  }
+
+  #pragma omp parallel
+  {
+    RuleType threadRules(rules);
+    typename TreeType::template SingleTreeTraverser<RuleType>
+        traverser(threadRules);
+
+    #pragma omp for schedule(dynamic, 16)
+    for (omp_size_t i = 0; i < (omp_size_t) numQueries; ++i)
+    {
+      if (!referenceTree)
+      {
+        for (size_t j = 0; j < numReferences; ++j)
+          threadRules.BaseCase(i, j);
+      }
+      else
+      {
+        traverser.Traverse(order.empty() ? i : order[i], *referenceTree);
+      }
+    }
+
+    // The implicit barrier after the loop makes sure that every thread has
+    // copied the rules before any of them is merged back.
+    #pragma omp critical
+    rules.Merge(threadRules, std::vector<TreeType*>());
+  }
+}
+
 template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
@@ -59,6 +179,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
     treeOwner(!naive),
     naive(naive),
     singleMode(!naive && singleMode),
+    queryCurve(tree::NO_CURVE),
     metric(metric),
     baseCases(0),
     scores(0)
@@ -80,6 +201,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
     treeOwner(false),
     naive(false),
     singleMode(singleMode),
+    queryCurve(tree::NO_CURVE),
     metric(metric),
     baseCases(0),
     scores(0)
@@ -101,6 +223,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
     treeOwner(false),
     naive(naive),
     singleMode(singleMode),
+    queryCurve(tree::NO_CURVE),
     metric(metric),
     baseCases(0),
     scores(0)
@@ -128,6 +251,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
     treeOwner(other.referenceTree),
     naive(other.naive),
     singleMode(other.singleMode),
+    queryCurve(other.queryCurve),
     metric(other.metric),
     baseCases(other.baseCases),
     scores(other.scores)
@@ -147,6 +271,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(RangeSearch&& other) :
     treeOwner(other.treeOwner),
     naive(other.naive),
     singleMode(other.singleMode),
+    queryCurve(other.queryCurve),
     metric(std::move(other.metric)),
     baseCases(other.baseCases),
     scores(other.scores)
@@ -159,6 +284,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(RangeSearch&& other) :
   other.treeOwner = true;
   other.naive = false;
   other.singleMode = false;
+  other.queryCurve = tree::NO_CURVE;
   other.baseCases = 0;
   other.scores = 0;
 }
@@ -184,6 +310,7 @@ RangeSearch<MetricType, MatType, TreeType>::operator=(RangeSearch other)
   treeOwner = other.treeOwner;
   naive = other.naive;
   singleMode = other.singleMode;
+  queryCurve = other.queryCurve;
   metric = std::move(other.metric);
   baseCases = other.baseCases;
   scores = other.scores;
@@ -273,177 +400,15 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
     std::vector<std::vector<size_t>>& neighbors,
     std::vector<std::vector<double>>& distances)
 {
-  if (querySet.n_rows != referenceSet->n_rows)
-  {
-    std::ostringstream oss;
-    oss << "RangeSearch::Search(): dimensionalities of query set ("
-        << querySet.n_rows << ") and reference set (" << referenceSet->n_rows
-        << ") do not match!";
-    throw std::invalid_argument(oss.str());
-  }
-
-  // If there are no points, there is no search to be done.
-  if (referenceSet->n_cols == 0)
-    return;
-
-  Timer::Start("range_search/computing_neighbors");
-
-  // This will hold mappings for query points, if necessary.
-  std::vector<size_t> oldFromNewQueries;
-
-  // If we have built the trees ourselves, then we will have to map all the
-  // indices back to their original indices when this computation is finished.
-  // To avoid extra copies, we will store the unmapped neighbors and distances
-  // in a separate object.
-  std::vector<std::vector<size_t>>* neighborPtr = &neighbors;
-  std::vector<std::vector<double>>* distancePtr = &distances;
-
-  // Mapping is only necessary if the tree rearranges points.
-  if (tree::TreeTraits<Tree>::RearrangesDataset)
-  {
-    // Query indices only need to be mapped if we are building the query tree
-    // ourselves.
-    if (!singleMode && !naive)
-    {
-      distancePtr = new std::vector<std::vector<double>>;
-      neighborPtr = new std::vector<std::vector<size_t>>;
-    }
-
-    // Reference indices only need to be mapped if we built the reference tree
-    // ourselves.
-    else if (treeOwner)
-      neighborPtr = new std::vector<std::vector<size_t>>;
-  }
-
-  // Resize each vector.
-  neighborPtr->clear(); // Just in case there was anything in it.
-  neighborPtr->resize(querySet.n_cols);
-  distancePtr->clear();
-  distancePtr->resize(querySet.n_cols);
-
-  // Create the helper object for the traversal.
-  typedef RangeSearchRules<MetricType, Tree> RuleType;
-
-  // Reset counts.
-  baseCases = 0;
-  scores = 0;
-
-  if (naive)
-  {
-    RuleType rules(*referenceSet, querySet, range, *neighborPtr, *distancePtr,
-        metric);
-
-    // The naive brute-force solution.
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      for (size_t j = 0; j < referenceSet->n_cols; ++j)
-        rules.BaseCase(i, j);
-
-    baseCases += (querySet.n_cols * referenceSet->n_cols);
-  }
-  else if (singleMode)
-  {
-    // Create the traverser.
-    RuleType rules(*referenceSet, querySet, range, *neighborPtr, *distancePtr,
-        metric);
-    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
-
-    // Now have it traverse for each point.
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
-
-    baseCases += rules.BaseCases();
-    scores += rules.Scores();
-  }
-  else // Dual-tree recursion.
-  {
-    // Build the query tree.
-    Timer::Stop("range_search/computing_neighbors");
-    Timer::Start("range_search/tree_building");
-    Tree* queryTree = BuildTree<Tree>(querySet, oldFromNewQueries);
-    Timer::Stop("range_search/tree_building");
-    Timer::Start("range_search/computing_neighbors");
-
-    // Create the traverser.
-    RuleType rules(*referenceSet, queryTree->Dataset(), range, *neighborPtr,
-        *distancePtr, metric);
-    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
-
-    traverser.Traverse(*queryTree, *referenceTree);
-
-    baseCases += rules.BaseCases();
-    scores += rules.Scores();
-
-    // Clean up tree memory.
-    delete queryTree;
-  }
-
-  Timer::Stop("range_search/computing_neighbors");
-
-  // Map points back to original indices, if necessary.
-  if (tree::TreeTraits<Tree>::RearrangesDataset)
-  {
-    if (!singleMode && !naive && treeOwner)
-    {
-      // We must map both query and reference indices.
-      neighbors.clear();
-      neighbors.resize(querySet.n_cols);
-      distances.clear();
-      distances.resize(querySet.n_cols);
-
-      for (size_t i = 0; i < distances.size(); i++)
-      {
-        // Map distances (copy a column).
-        const size_t queryMapping = oldFromNewQueries[i];
-        distances[queryMapping] = (*distancePtr)[i];
-
-        // Copy each neighbor individually, because we need to map it.
-        neighbors[queryMapping].resize(distances[queryMapping].size());
-        for (size_t j = 0; j < distances[queryMapping].size(); j++)
-          neighbors[queryMapping][j] =
-              oldFromNewReferences[(*neighborPtr)[i][j]];
-      }
-
-      // Finished with temporary objects.
-      delete neighborPtr;
-      delete distancePtr;
-    }
-    else if (!singleMode && !naive)
-    {
-      // We must map query indices only.
-      neighbors.clear();
-      neighbors.resize(querySet.n_cols);
-      distances.clear();
-      distances.resize(querySet.n_cols);
-
-      for (size_t i = 0; i < distances.size(); ++i)
-      {
-        // Map distances and neighbors (copy a column).
-        const size_t queryMapping = oldFromNewQueries[i];
-        distances[queryMapping] = (*distancePtr)[i];
-        neighbors[queryMapping] = (*neighborPtr)[i];
-      }
-
-      // Finished with temporary objects.
-      delete neighborPtr;
-      delete distancePtr;
-    }
-    else if (treeOwner)
-    {
-      // We must map reference indices only.
-      neighbors.clear();
-      neighbors.resize(querySet.n_cols);
-
-      for (size_t i = 0; i < neighbors.size(); i++)
-      {
-        neighbors[i].resize((*neighborPtr)[i].size());
-        for (size_t j = 0; j < neighbors[i].size(); j++)
-          neighbors[i][j] = oldFromNewReferences[(*neighborPtr)[i][j]];
-      }
+  neighbors.clear();
+  neighbors.resize(querySet.n_cols);
+  distances.clear();
+  distances.resize(querySet.n_cols);
 
-      // Finished with temporary object.
-      delete neighborPtr;
-    }
-  }
+  // Each query point is handled by one thread, so the traversal can be
+  // parallel.
+  VectorResults results(neighbors, distances);
+  ComputeResults<true>(&querySet, NULL, range, results);
 }
 
 template<typename MetricType,
@@ -457,64 +422,144 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
     std::vector<std::vector<size_t>>& neighbors,
     std::vector<std::vector<double>>& distances)
 {
-  // If there are no points, there is no search to be done.
-  if (referenceSet->n_cols == 0)
-    return;
-
-  Timer::Start("range_search/computing_neighbors");
-
-  // Get a reference to the query set.
-  const MatType& querySet = queryTree->Dataset();
-
   // Make sure we are in dual-tree mode.
   if (singleMode || naive)
     throw std::invalid_argument("cannot call RangeSearch::Search() with a "
         "query tree when naive or singleMode are set to true");
 
-  // We won't need to map query indices, but will we need to map distances?
-  std::vector<std::vector<size_t>>* neighborPtr = &neighbors;
+  neighbors.clear();
+  neighbors.resize(queryTree->Dataset().n_cols);
+  distances.clear();
+  distances.resize(queryTree->Dataset().n_cols);
 
-  if (treeOwner && tree::TreeTraits<Tree>::RearrangesDataset)
-    neighborPtr = new std::vector<std::vector<size_t>>;
+  VectorResults results(neighbors, distances);
+  ComputeResults<true>(NULL, queryTree, range, results);
+}
 
-  // Resize each vector.
-  neighborPtr->clear(); // Just in case there was anything in it.
-  neighborPtr->resize(querySet.n_cols);
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::Search(
+    const math::Range& range,
+    std::vector<std::vector<size_t>>& neighbors,
+    std::vector<std::vector<double>>& distances)
+{
+  neighbors.clear();
+  neighbors.resize(referenceSet->n_cols);
   distances.clear();
-  distances.resize(querySet.n_cols);
+  distances.resize(referenceSet->n_cols);
+
+  VectorResults results(neighbors, distances);
+  ComputeResults<true>(NULL, NULL, range, results);
+}
 
-  // Create the helper object for the traversal.
-  typedef RangeSearchRules<MetricType, Tree> RuleType;
-  RuleType rules(*referenceSet, queryTree->Dataset(), range, *neighborPtr,
-      distances, metric);
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename CallbackType>
+void RangeSearch<MetricType, MatType, TreeType>::Search(
+    const MatType& querySet,
+    const math::Range& range,
+    CallbackType& callback)
+{
+  ComputeResults<false>(&querySet, NULL, range, callback);
+}
 
-  // Create the traverser.
-  typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename CallbackType>
+void RangeSearch<MetricType, MatType, TreeType>::Search(
+    const math::Range& range,
+    CallbackType& callback)
+{
+  ComputeResults<false>(NULL, NULL, range, callback);
+}
 
-  traverser.Traverse(*queryTree, *referenceTree);
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename CallbackType>
+void RangeSearch<MetricType, MatType, TreeType>::ParallelSearch(
+    const MatType& querySet,
+    const math::Range& range,
+    CallbackType& callback)
+{
+  ComputeResults<true>(&querySet, NULL, range, callback);
+}
 
-  Timer::Stop("range_search/computing_neighbors");
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename CallbackType>
+void RangeSearch<MetricType, MatType, TreeType>::ParallelSearch(
+    const math::Range& range,
+    CallbackType& callback)
+{
+  ComputeResults<true>(NULL, NULL, range, callback);
+}
 
-  baseCases = rules.BaseCases();
-  scores = rules.Scores();
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::Search(
+    const MatType& querySet,
+    const math::Range& range,
+    arma::Col<size_t>& offsets,
+    arma::Col<size_t>& neighbors,
+    arma::vec& distances)
+{
+  CompactResults results;
+  ComputeResults<false>(&querySet, NULL, range, results);
+  results.Compact(querySet.n_cols, offsets, neighbors, distances);
+}
 
-  // Do we need to map indices?
-  if (treeOwner && tree::TreeTraits<Tree>::RearrangesDataset)
-  {
-    // We must map reference indices only.
-    neighbors.clear();
-    neighbors.resize(querySet.n_cols);
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::Search(
+    const math::Range& range,
+    arma::Col<size_t>& offsets,
+    arma::Col<size_t>& neighbors,
+    arma::vec& distances)
+{
+  CompactResults results;
+  ComputeResults<false>(NULL, NULL, range, results);
+  results.Compact(referenceSet->n_cols, offsets, neighbors, distances);
+}
 
-    for (size_t i = 0; i < neighbors.size(); i++)
-    {
-      neighbors[i].resize((*neighborPtr)[i].size());
-      for (size_t j = 0; j < neighbors[i].size(); j++)
-        neighbors[i][j] = oldFromNewReferences[(*neighborPtr)[i][j]];
-    }
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::Search(
+    const MatType& querySet,
+    const std::vector<double>& radii,
+    std::vector<std::vector<std::vector<size_t>>>& neighbors,
+    std::vector<std::vector<std::vector<double>>>& distances)
+{
+  const math::Range range = RadiusBuckets(radii, querySet.n_cols, neighbors,
+      distances);
 
-    // Finished with temporary object.
-    delete neighborPtr;
-  }
+  // Each query point is handled by one thread, so the traversal can be
+  // parallel.
+  RadiusBucketResults results(radii, neighbors, distances);
+  ComputeResults<true>(&querySet, NULL, range, results);
 }
 
 template<typename MetricType,
@@ -523,99 +568,190 @@ template<typename MetricType,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType>
 void RangeSearch<MetricType, MatType, TreeType>::Search(
+    const std::vector<double>& radii,
+    std::vector<std::vector<std::vector<size_t>>>& neighbors,
+    std::vector<std::vector<std::vector<double>>>& distances)
+{
+  const math::Range range = RadiusBuckets(radii, referenceSet->n_cols,
+      neighbors, distances);
+
+  RadiusBucketResults results(radii, neighbors, distances);
+  ComputeResults<true>(NULL, NULL, range, results);
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<bool Parallel, typename CallbackType>
+void RangeSearch<MetricType, MatType, TreeType>::ComputeResults(
+    const MatType* querySet,
+    Tree* queryTree,
     const math::Range& range,
-    std::vector<std::vector<size_t>>& neighbors,
-    std::vector<std::vector<double>>& distances)
+    CallbackType& callback)
 {
+  if (querySet && querySet->n_rows != referenceSet->n_rows)
+  {
+    std::ostringstream oss;
+    oss << "RangeSearch::Search(): dimensionalities of query set ("
+        << querySet->n_rows << ") and reference set (" << referenceSet->n_rows
+        << ") do not match!";
+    throw std::invalid_argument(oss.str());
+  }
+
   // If there are no points, there is no search to be done.
   if (referenceSet->n_cols == 0)
     return;
 
   Timer::Start("range_search/computing_neighbors");
 
-  // Here, we will use the query set as the reference set.
-  std::vector<std::vector<size_t>>* neighborPtr = &neighbors;
-  std::vector<std::vector<double>>* distancePtr = &distances;
+  // Reset counts.
+  baseCases = 0;
+  scores = 0;
+  statistics.Reset();
+  arma::wall_clock searchTimer;
+  searchTimer.tic();
 
-  if (tree::TreeTraits<Tree>::RearrangesDataset && treeOwner)
-  {
-    // We will always need to rearrange in this case.
-    distancePtr = new std::vector<std::vector<double>>;
-    neighborPtr = new std::vector<std::vector<size_t>>;
-  }
+  // Reference indices only need to be mapped if we built the reference tree
+  // ourselves and it rearranged the dataset.  When searching with the
+  // reference set, the same holds for the query indices.
+  const std::vector<size_t>* referenceMapping =
+      (treeOwner && tree::TreeTraits<Tree>::RearrangesDataset) ?
+      &oldFromNewReferences : NULL;
 
-  // Resize each vector.
-  neighborPtr->clear(); // Just in case there was anything in it.
-  neighborPtr->resize(referenceSet->n_cols);
-  distancePtr->clear();
-  distancePtr->resize(referenceSet->n_cols);
+  typedef MappedResults<CallbackType> MappedType;
+  typedef RangeSearchRules<MetricType, Tree, MappedType> RuleType;
 
-  // Create the helper object for the traversal.
-  typedef RangeSearchRules<MetricType, Tree> RuleType;
-  RuleType rules(*referenceSet, *referenceSet, range, *neighborPtr,
-      *distancePtr, metric, true /* don't return the query in the results */);
+  // This will hold mappings for query points, if necessary.
+  std::vector<size_t> oldFromNewQueries;
 
-  if (naive)
+  if (!querySet && !queryTree)
   {
-    // The naive brute-force solution.
-    for (size_t i = 0; i < referenceSet->n_cols; ++i)
-      for (size_t j = 0; j < referenceSet->n_cols; ++j)
-        rules.BaseCase(i, j);
+    // Search with the reference set as the query set.
+    MappedType results(callback, referenceMapping, referenceMapping);
+    RuleType rules(*referenceSet, *referenceSet, range, results, metric,
+        true /* don't return the query in the results */);
+    rules.Statistics().Enabled() = statistics.Enabled();
 
-    baseCases = (referenceSet->n_cols * referenceSet->n_cols);
-    scores = 0;
+    if (naive)
+    {
+      // The naive brute-force solution.
+      QueryTraversal<Parallel, Tree>(rules, referenceSet->n_cols,
+          referenceSet->n_cols, NULL);
+
+      baseCases = (referenceSet->n_cols * referenceSet->n_cols);
+    }
+    else if (singleMode)
+    {
+      // Traverse the tree for each point.
+      QueryTraversal<Parallel>(rules, referenceSet->n_cols,
+          referenceSet->n_cols, referenceTree);
+
+      baseCases = rules.BaseCases();
+      scores = rules.Scores();
+    }
+    else // Dual-tree recursion.
+    {
+      // Run the traversal, in parallel if possible.
+      DualTreeTraversal<Parallel>(rules, *referenceTree, *referenceTree);
+
+      baseCases = rules.BaseCases();
+      scores = rules.Scores();
+    }
+
+    statistics.Merge(rules.Statistics());
   }
-  else if (singleMode)
+  else if (queryTree)
   {
-    // Create the traverser.
-    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
+    // The query tree was built by the user, so its indices are not mapped.
+    MappedType results(callback, NULL, referenceMapping);
+    RuleType rules(*referenceSet, queryTree->Dataset(), range, results,
+        metric);
+    rules.Statistics().Enabled() = statistics.Enabled();
 
-    // Now have it traverse for each point.
-    for (size_t i = 0; i < referenceSet->n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
+    // Run the traversal, in parallel if possible.
+    DualTreeTraversal<Parallel>(rules, *queryTree, *referenceTree);
 
     baseCases = rules.BaseCases();
     scores = rules.Scores();
+    statistics.Merge(rules.Statistics());
+  }
+  else if (naive || singleMode)
+  {
+    MappedType results(callback, NULL, referenceMapping);
+    RuleType rules(*referenceSet, *querySet, range, results, metric);
+    rules.Statistics().Enabled() = statistics.Enabled();
+
+    if (naive)
+    {
+      // The naive brute-force solution.
+      QueryTraversal<Parallel, Tree>(rules, querySet->n_cols,
+          referenceSet->n_cols, NULL);
+
+      baseCases = (querySet->n_cols * referenceSet->n_cols);
+    }
+    else
+    {
+      // Traverse the tree for each point, along the query curve.
+      std::vector<size_t> queryOrder;
+      tree::SpaceFillingCurveOrder(*querySet, queryCurve, queryOrder);
+      QueryTraversal<Parallel>(rules, querySet->n_cols, referenceSet->n_cols,
+          referenceTree, queryOrder);
+
+      baseCases = rules.BaseCases();
+      scores = rules.Scores();
+      statistics.Merge(rules.Statistics());
+    }
   }
   else // Dual-tree recursion.
   {
-    // Create the traverser.
-    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+    // Build the query tree.
+    Timer::Stop("range_search/computing_neighbors");
+    Timer::Start("range_search/tree_building");
+    arma::wall_clock treeTimer;
+    treeTimer.tic();
+    Tree* builtQueryTree = BuildTree<Tree>(*querySet, oldFromNewQueries);
+    statistics.TreeBuildingTime() = treeTimer.toc();
+    Timer::Stop("range_search/tree_building");
+    Timer::Start("range_search/computing_neighbors");
+
+    // Query indices need to be mapped if the query tree rearranged them.
+    MappedType results(callback, tree::TreeTraits<Tree>::RearrangesDataset ?
+        &oldFromNewQueries : NULL, referenceMapping);
+    RuleType rules(*referenceSet, builtQueryTree->Dataset(), range, results,
+        metric);
+    rules.Statistics().Enabled() = statistics.Enabled();
 
-    traverser.Traverse(*referenceTree, *referenceTree);
+    // Run the traversal, in parallel if possible.
+    DualTreeTraversal<Parallel>(rules, *builtQueryTree, *referenceTree);
 
     baseCases = rules.BaseCases();
     scores = rules.Scores();
+    statistics.Merge(rules.Statistics());
+
+    // Clean up tree memory.
+    delete builtQueryTree;
   }
 
   Timer::Stop("range_search/computing_neighbors");
+  RecordStatistics(searchTimer.toc());
+}
 
-  // Do we need to map the reference indices?
-  if (treeOwner && tree::TreeTraits<Tree>::RearrangesDataset)
-  {
-    neighbors.clear();
-    neighbors.resize(referenceSet->n_cols);
-    distances.clear();
-    distances.resize(referenceSet->n_cols);
-
-    for (size_t i = 0; i < distances.size(); i++)
-    {
-      // Map distances (copy a column).
-      const size_t refMapping = oldFromNewReferences[i];
-      distances[refMapping] = (*distancePtr)[i];
-
-      // Copy each neighbor individually, because we need to map it.
-      neighbors[refMapping].resize(distances[refMapping].size());
-      for (size_t j = 0; j < distances[refMapping].size(); j++)
-      {
-        neighbors[refMapping][j] = oldFromNewReferences[(*neighborPtr)[i][j]];
-      }
-    }
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::RecordStatistics(
+    const double searchTime)
+{
+  statistics.BaseCases() = baseCases;
+  statistics.Scores() = scores;
+  statistics.TraversalTime() = searchTime - statistics.TreeBuildingTime();
 
-    // Finished with temporary objects.
-    delete neighborPtr;
-    delete distancePtr;
-  }
+  if (statistics.Enabled())
+    statistics.Report();
 }
 
 template<typename MetricType,
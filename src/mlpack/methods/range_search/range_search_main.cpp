@@ -98,12 +98,20 @@ PARAM_INT_IN("leaf_size", "Leaf size for tree building (used for kd-trees, "
     "Hilbert R trees, R+ trees, R++ trees, and octrees).", "l", 20);
 PARAM_FLAG("random_basis", "Before tree-building, project the data onto a "
     "random orthogonal basis.", "R");
+PARAM_STRING_IN("precision", "Precision of the reference set and trees: "
+    "'double' or 'single'.  Single precision halves the memory used by the "
+    "model, and is only supported for kd-trees and ball trees.", "P",
+    "double");
 PARAM_INT_IN("seed", "Random seed (if 0, std::time(NULL) is used).", "s", 0);
 
 // Search settings.
 PARAM_FLAG("naive", "If true, O(n^2) naive mode is used for computation.", "N");
 PARAM_FLAG("single_mode", "If true, single-tree search is used (as opposed to "
     "dual-tree search).", "S");
+PARAM_FLAG("traversal_statistics", "If set, detailed statistics of the tree "
+    "traversal (nodes visited and pruned at each level, prunes by reason, "
+    "reference leaf sizes reached, and time per phase) are collected and printed"
+    " when verbose output is enabled.", "");
 
 static void mlpackMain()
 {
@@ -117,6 +125,7 @@ static void mlpackMain()
 
   ReportIgnoredParam({{ "input_model", true }}, "tree_type");
   ReportIgnoredParam({{ "input_model", true }}, "random_basis");
+  ReportIgnoredParam({{ "input_model", true }}, "precision");
   ReportIgnoredParam({{ "input_model", true }}, "leaf_size");
   ReportIgnoredParam({{ "input_model", true }}, "naive");
 
@@ -197,6 +206,16 @@ static void mlpackMain()
     rs->TreeType() = tree;
     rs->RandomBasis() = randomBasis;
 
+    RequireParamInSet<string>("precision", { "double", "single" }, true,
+        "unknown precision");
+    rs->SinglePrecision() = (CLI::GetParam<string>("precision") == "single");
+    if (rs->SinglePrecision() && tree != RSModel::KD_TREE &&
+        tree != RSModel::BALL_TREE)
+    {
+      Log::Fatal << "Single precision is only supported for kd-trees and ball "
+          << "trees!" << endl;
+    }
+
     arma::mat referenceSet = std::move(CLI::GetParam<arma::mat>("reference"));
 
     Log::Info << "Using reference data from '"
@@ -214,7 +233,7 @@ static void mlpackMain()
 
     Log::Info << "Using range search model from '"
         << CLI::GetPrintableParam<RSModel*>("input_model") << "' ("
-        << "trained on " << rs->Dataset().n_rows << "x" << rs->Dataset().n_cols
+        << "trained on " << rs->DatasetSize().n_rows << "x" << rs->DatasetSize().n_cols
         << " dataset)." << endl;
 
     // Adjust singleMode and naive if necessary.
@@ -250,6 +269,7 @@ static void mlpackMain()
     vector<vector<size_t>> neighbors;
     vector<vector<double>> distances;
 
+    rs->Statistics().Enabled() = CLI::HasParam("traversal_statistics");
     if (CLI::HasParam("query"))
       rs->Search(std::move(queryData), r, neighbors, distances);
     else
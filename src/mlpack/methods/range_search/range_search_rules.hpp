@@ -13,6 +13,7 @@
 #define MLPACK_METHODS_RANGE_SEARCH_RANGE_SEARCH_RULES_HPP
 
 #include <mlpack/core/tree/traversal_info.hpp>
+#include <mlpack/core/tree/traversal_statistics.hpp>
 
 namespace mlpack {
 namespace range {
@@ -21,10 +22,23 @@ namespace range {
  * The RangeSearchRules class is a template helper class used by RangeSearch
  * class when performing range searches.
  *
+ * Each result is passed to a callback as it is found, with the signature
+ *
+ * @code
+ * void operator()(const size_t queryIndex,
+ *                 const size_t referenceIndex,
+ *                 const double distance);
+ * @endcode
+ *
+ * so results need not be stored at all; VectorResults stores them in vectors.
+ * The indices given to the callback are the indices in the datasets the rules
+ * were constructed with.
+ *
  * @tparam MetricType The metric to use for computation.
  * @tparam TreeType The tree type to use; must adhere to the TreeType API.
+ * @tparam CallbackType The type of the callback results are passed to.
  */
-template<typename MetricType, typename TreeType>
+template<typename MetricType, typename TreeType, typename CallbackType>
 class RangeSearchRules
 {
  public:
@@ -35,17 +49,15 @@ class RangeSearchRules
    * @param referenceSet Set of reference data.
    * @param querySet Set of query data.
    * @param range Range to search for.
-   * @param neighbors Vector to store resulting neighbors in.
-   * @param distances Vector to store resulting distances in.
+   * @param callback Callback to pass each result to.
    * @param metric Instantiated metric.
    * @param sameSet If true, the query and reference set are taken to be the
    *      same, and a query point will not return itself in the results.
    */
-  RangeSearchRules(const arma::mat& referenceSet,
-                   const arma::mat& querySet,
+  RangeSearchRules(const typename TreeType::Mat& referenceSet,
+                   const typename TreeType::Mat& querySet,
                    const math::Range& range,
-                   std::vector<std::vector<size_t> >& neighbors,
-                   std::vector<std::vector<double> >& distances,
+                   CallbackType& callback,
                    MetricType& metric,
                    const bool sameSet = false);
 
@@ -112,26 +124,41 @@ class RangeSearchRules
   const TraversalInfoType& TraversalInfo() const { return traversalInfo; }
   TraversalInfoType& TraversalInfo() { return traversalInfo; }
 
+  /**
+   * Merge the statistics of another RangeSearchRules object (usually a
+   * per-thread copy of this one).  The results themselves need no merging,
+   * since every copy passes the results of its own query points directly to
+   * the callback.
+   * This is used by tree::ParallelDualTreeTraverser.
+   *
+   * @param other Rules object to take statistics from.
+   * @param queryNodes Query nodes whose descendants were searched by 'other'.
+   */
+  void Merge(const RangeSearchRules& other,
+             const std::vector<TreeType*>& queryNodes);
+
   //! Get the number of base cases.
   size_t BaseCases() const { return baseCases; }
   //! Get the number of scores (that is, calls to RangeDistance()).
   size_t Scores() const { return scores; }
 
+  //! Get the detailed traversal statistics.
+  const tree::TraversalStatistics& Statistics() const { return statistics; }
+  //! Modify the detailed traversal statistics.
+  tree::TraversalStatistics& Statistics() { return statistics; }
+
  private:
   //! The reference set.
-  const arma::mat& referenceSet;
+  const typename TreeType::Mat& referenceSet;
 
   //! The query set.
-  const arma::mat& querySet;
+  const typename TreeType::Mat& querySet;
 
   //! The range of distances for which we are searching.
   const math::Range& range;
 
-  //! The vector the resultant neighbor indices should be stored in.
-  std::vector<std::vector<size_t> >& neighbors;
-
-  //! The vector the resultant neighbor distances should be stored in.
-  std::vector<std::vector<double> >& distances;
+  //! The callback each result is passed to.
+  CallbackType& callback;
 
   //! The instantiated metric.
   MetricType& metric;
@@ -156,6 +183,9 @@ class RangeSearchRules
   size_t baseCases;
   //! THe number of scores.
   size_t scores;
+
+  //! Detailed traversal statistics (only collected if enabled).
+  tree::TraversalStatistics statistics;
 };
 
 } // namespace range
@@ -19,6 +19,7 @@
 #include <mlpack/core/tree/cover_tree.hpp>
 #include <mlpack/core/tree/rectangle_tree.hpp>
 #include <mlpack/core/tree/octree.hpp>
+#include <mlpack/core/tree/query_tree_handle.hpp>
 #include <boost/variant.hpp>
 #include "range_search.hpp"
 
@@ -26,12 +27,14 @@ namespace mlpack {
 namespace range {
 
 /**
- * Alias template for Range Search.
+ * Alias template for Range Search.  The matrix type is arma::fmat for
+ * single-precision models.
  */
 template<template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
-using RSType = RangeSearch<metric::EuclideanDistance, arma::mat, TreeType>;
+                  typename TreeMatType> class TreeType,
+         typename MatType = arma::mat>
+using RSType = RangeSearch<metric::EuclideanDistance, MatType, TreeType>;
 
 /**
  * MonoSearchVisitor executes a monochromatic range search on the given
@@ -86,12 +89,24 @@ class BiSearchVisitor : public boost::static_visitor<void>
   template<typename RSType>
   void SearchLeaf(RSType* rs) const;
 
+  //! Get the query set for a single-precision model, by converting it into the
+  //! given matrix.
+  template<typename MatType>
+  const MatType& QuerySet(MatType& converted) const;
+
+  //! Get the query set for a double-precision model (no copy is made).
+  const arma::mat& QuerySet(arma::mat& /* converted */) const
+  {
+    return querySet;
+  }
+
  public:
   //! Alias template necessary for visual c++ compiler.
   template<template<typename TreeMetricType,
                     typename TreeStatType,
-                    typename TreeMatType> class TreeType>
-  using RSTypeT = RSType<TreeType>;
+                    typename TreeMatType> class TreeType,
+           typename MatType = arma::mat>
+  using RSTypeT = RSType<TreeType, MatType>;
 
   //! Default Bichromatic range search on the given RSType instance.
   template<template<typename TreeMetricType,
@@ -108,6 +123,12 @@ class BiSearchVisitor : public boost::static_visitor<void>
   //! Bichromatic range search specialized for octrees.
   void operator()(RSTypeT<tree::Octree>* rs) const;
 
+  //! Bichromatic range search specialized for single-precision KDTrees.
+  void operator()(RSTypeT<tree::KDTree, arma::fmat>* rs) const;
+
+  //! Bichromatic range search specialized for single-precision BallTrees.
+  void operator()(RSTypeT<tree::BallTree, arma::fmat>* rs) const;
+
   //! Construct the BiSearchVisitor.
   BiSearchVisitor(const arma::mat& querySet,
                   const math::Range& range,
@@ -133,12 +154,25 @@ class TrainVisitor : public boost::static_visitor<void>
   template<typename RSType>
   void TrainLeaf(RSType* rs) const;
 
+  //! Convert the reference set into the given matrix, for single-precision
+  //! models.
+  template<typename MatType>
+  void ReferenceSet(MatType& converted) const;
+
+  //! Move the reference set into the given matrix, for double-precision
+  //! models.
+  void ReferenceSet(arma::mat& converted) const
+  {
+    converted = std::move(referenceSet);
+  }
+
  public:
   //! Alias template necessary for visual c++ compiler.
   template<template<typename TreeMetricType,
                     typename TreeStatType,
-                    typename TreeMatType> class TreeType>
-  using RSTypeT = RSType<TreeType>;
+                    typename TreeMatType> class TreeType,
+           typename MatType = arma::mat>
+  using RSTypeT = RSType<TreeType, MatType>;
 
   //! Default Train on the given RSType instance.
   template<template<typename TreeMetricType,
@@ -155,11 +189,119 @@ class TrainVisitor : public boost::static_visitor<void>
   //! Train specialized for octrees.
   void operator()(RSTypeT<tree::Octree>* rs) const;
 
+  //! Train on the given RSType specialized for single-precision KDTrees.
+  void operator()(RSTypeT<tree::KDTree, arma::fmat>* rs) const;
+
+  //! Train on the given RSType specialized for single-precision BallTrees.
+  void operator()(RSTypeT<tree::BallTree, arma::fmat>* rs) const;
+
   //! Construct the TrainVisitor object with the given reference set, leafSize
   TrainVisitor(arma::mat&& referenceSet,
                const size_t leafSize);
 };
 
+/**
+ * BuildQueryTreeVisitor builds a query tree for a dual-tree search with the
+ * given RSType, in the same way BiSearchVisitor does, and returns a handle to
+ * it.
+ */
+class BuildQueryTreeVisitor :
+    public boost::static_visitor<tree::QueryTreeHandle>
+{
+ private:
+  //! The query set to build the tree on (it is moved into the tree).
+  arma::mat& querySet;
+  //! The number of points in a leaf (for BinarySpaceTrees).
+  const size_t leafSize;
+
+  //! Build the query tree for the given RSType considering the leafSize.
+  template<typename RSType>
+  tree::QueryTreeHandle BuildLeaf(RSType* rs) const;
+
+  //! Get the query set for a double-precision model (no copy is made).
+  template<typename MatType>
+  MatType QuerySet(const typename std::enable_if_t<
+      std::is_same<MatType, arma::mat>::value>* = 0) const
+  {
+    return std::move(querySet);
+  }
+
+  //! Get the query set for a single-precision model, by converting it.
+  template<typename MatType>
+  MatType QuerySet(const typename std::enable_if_t<
+      !std::is_same<MatType, arma::mat>::value>* = 0) const
+  {
+    return arma::conv_to<MatType>::from(querySet);
+  }
+
+ public:
+  //! Alias template necessary for visual c++ compiler.
+  template<template<typename TreeMetricType,
+                    typename TreeStatType,
+                    typename TreeMatType> class TreeType,
+           typename MatType = arma::mat>
+  using RSTypeT = RSType<TreeType, MatType>;
+
+  //! Default query tree construction for the given RSType instance.
+  template<template<typename TreeMetricType,
+                    typename TreeStatType,
+                    typename TreeMatType> class TreeType>
+  tree::QueryTreeHandle operator()(RSTypeT<TreeType>* rs) const;
+
+  //! Query tree construction specialized for KDTrees.
+  tree::QueryTreeHandle operator()(RSTypeT<tree::KDTree>* rs) const;
+
+  //! Query tree construction specialized for BallTrees.
+  tree::QueryTreeHandle operator()(RSTypeT<tree::BallTree>* rs) const;
+
+  //! Query tree construction specialized for octrees.
+  tree::QueryTreeHandle operator()(RSTypeT<tree::Octree>* rs) const;
+
+  //! Query tree construction specialized for single-precision KDTrees.
+  tree::QueryTreeHandle operator()(RSTypeT<tree::KDTree, arma::fmat>* rs)
+      const;
+
+  //! Query tree construction specialized for single-precision BallTrees.
+  tree::QueryTreeHandle operator()(RSTypeT<tree::BallTree, arma::fmat>* rs)
+      const;
+
+  //! Construct the BuildQueryTreeVisitor.
+  BuildQueryTreeVisitor(arma::mat& querySet, const size_t leafSize);
+};
+
+/**
+ * QueryTreeSearchVisitor executes a dual-tree range search with a query tree
+ * built by BuildQueryTreeVisitor.
+ */
+class QueryTreeSearchVisitor : public boost::static_visitor<void>
+{
+ private:
+  //! The query tree.
+  const tree::QueryTreeHandle& queryTree;
+  //! Range to search neighbours for.
+  const math::Range& range;
+  //! The result vector for neighbors.
+  std::vector<std::vector<size_t>>& neighbors;
+  //! The result vector for distances.
+  std::vector<std::vector<double>>& distances;
+
+ public:
+  //! Search with the query tree on the given RSType.
+  template<typename RSType>
+  void operator()(RSType* rs) const;
+
+  //! Construct the QueryTreeSearchVisitor.
+  QueryTreeSearchVisitor(const tree::QueryTreeHandle& queryTree,
+                         const math::Range& range,
+                         std::vector<std::vector<size_t>>& neighbors,
+                         std::vector<std::vector<double>>& distances) :
+      queryTree(queryTree),
+      range(range),
+      neighbors(neighbors),
+      distances(distances)
+  { }
+};
+
 /**
  * ReferenceSetVisitor exposes the referenceSet of the given RSType.
  */
@@ -169,6 +311,25 @@ class ReferenceSetVisitor : public boost::static_visitor<const arma::mat&>
   //! Return the reference set.
   template<typename RSType>
   const arma::mat& operator()(RSType* rs) const;
+
+  //! Single-precision models do not hold an arma::mat reference set, so this
+  //! throws std::invalid_argument.
+  template<template<typename TreeMetricType,
+                    typename TreeStatType,
+                    typename TreeMatType> class TreeType>
+  const arma::mat& operator()(RSType<TreeType, arma::fmat>* rs) const;
+};
+
+/**
+ * ReferenceSetSizeVisitor returns the size of the reference set of the given
+ * RSType, for both single-precision and double-precision models.
+ */
+class ReferenceSetSizeVisitor : public boost::static_visitor<arma::SizeMat>
+{
+ public:
+  //! Return the size of the reference set.
+  template<typename RSType>
+  arma::SizeMat operator()(RSType* rs) const;
 };
 
 /**
@@ -209,6 +370,18 @@ class NaiveVisitor : public boost::static_visitor<bool&>
   bool& operator()(RSType* rs) const;
 };
 
+/**
+ * StatisticsVisitor exposes the traversal statistics of the given RSType.
+ */
+class StatisticsVisitor :
+    public boost::static_visitor<tree::TraversalStatistics&>
+{
+ public:
+  //! Return the traversal statistics of the given RangeSearch object.
+  template<typename RSType>
+  tree::TraversalStatistics& operator()(RSType* rs) const;
+};
+
 class RSModel
 {
  public:
@@ -239,6 +412,9 @@ class RSModel
   //! Random projection matrix.
   arma::mat q;
 
+  //! If true, the reference set and trees are stored in single precision.
+  bool singlePrecision;
+
   /**
    * rSearch holds an instance of the RangeSearch class for the current
    * treeType. It is initialized every time BuildModel is executed.
@@ -257,7 +433,9 @@ class RSModel
                  RSType<tree::RPTree>*,
                  RSType<tree::MaxRPTree>*,
                  RSType<tree::UBTree>*,
-                 RSType<tree::Octree>*> rSearch;
+                 RSType<tree::Octree>*,
+                 RSType<tree::KDTree, arma::fmat>*,
+                 RSType<tree::BallTree, arma::fmat>*> rSearch;
 
  public:
   /**
@@ -266,9 +444,12 @@ class RSModel
    *
    * @param treeType Type of tree to use.
    * @param randomBasis Whether or not to use a random basis.
+   * @param singlePrecision Whether or not to store the reference set and tree
+   *      in single precision (only for kd-trees and ball trees).
    */
   RSModel(const TreeTypes treeType = TreeTypes::KD_TREE,
-          const bool randomBasis = false);
+          const bool randomBasis = false,
+          const bool singlePrecision = false);
 
   /**
    * Copy the given RSModel.
@@ -300,11 +481,15 @@ class RSModel
 
   //! Serialize the range search model.
   template<typename Archive>
-  void serialize(Archive& ar, const unsigned int /* version */);
+  void serialize(Archive& ar, const unsigned int version);
 
-  //! Expose the dataset.
+  //! Expose the dataset.  This is not available for single-precision models;
+  //! use DatasetSize() to get the size of the reference set instead.
   const arma::mat& Dataset() const;
 
+  //! Get the size of the reference set (for any precision).
+  arma::SizeMat DatasetSize() const;
+
   //! Get whether the model is in single-tree search mode.
   bool SingleMode() const;
   //! Modify whether the model is in single-tree search mode.
@@ -315,6 +500,11 @@ class RSModel
   //! Modify whether the model is in naive search mode.
   bool& Naive();
 
+  //! Get the traversal statistics of the last search.
+  const tree::TraversalStatistics& Statistics() const;
+  //! Modify the traversal statistics (i.e. to enable their collection).
+  tree::TraversalStatistics& Statistics();
+
   //! Get the leaf size (applicable to everything but the cover tree).
   size_t LeafSize() const { return leafSize; }
   //! Modify the leaf size (applicable to everything but the cover tree).
@@ -331,6 +521,14 @@ class RSModel
   //! been built).
   bool& RandomBasis() { return randomBasis; }
 
+  //! Get whether the model is stored in single precision.
+  bool SinglePrecision() const { return singlePrecision; }
+  //! Modify whether the model is stored in single precision (don't do this
+  //! after the model has been built).  BuildModel() throws
+  //! std::invalid_argument if single precision is not supported for the tree
+  //! type.
+  bool& SinglePrecision() { return singlePrecision; }
+
   /**
    * Build the reference tree on the given dataset with the given parameters.
    * This takes possession of the reference set to avoid a copy.
@@ -373,6 +571,34 @@ class RSModel
               std::vector<std::vector<size_t>>& neighbors,
               std::vector<std::vector<double>>& distances);
 
+  /**
+   * Build a query tree on the given query set, so that the same query set can
+   * be searched many times (i.e. with different ranges) without building a
+   * tree each time.  The handle can be passed to Search() as long as the model
+   * is not built again; it can only be used in dual-tree mode, and otherwise
+   * std::invalid_argument is thrown.
+   *
+   * @param querySet Set of query points (it is moved into the tree).
+   * @return Handle to the query tree.
+   */
+  tree::QueryTreeHandle BuildQueryTree(arma::mat&& querySet) const;
+
+  /**
+   * Perform dual-tree range search with a query tree built by
+   * BuildQueryTree().  The results are given in the order of the original
+   * query set.  std::invalid_argument is thrown if the query tree was built
+   * for a different type of tree.
+   *
+   * @param queryTree Handle to the query tree.
+   * @param range Range to search for.
+   * @param neighbors Output: neighbors falling within the desired range.
+   * @param distances Output: distances of neighbors.
+   */
+  void Search(const tree::QueryTreeHandle& queryTree,
+              const math::Range& range,
+              std::vector<std::vector<size_t>>& neighbors,
+              std::vector<std::vector<double>>& distances);
+
  private:
   /**
    * Return a string representing the name of the tree.  This is used for
@@ -389,6 +615,9 @@ class RSModel
 } // namespace range
 } // namespace mlpack
 
+//! Set the serialization version of the RSModel class.
+BOOST_CLASS_VERSION(mlpack::range::RSModel, 1);
+
 // Include implementation (of serialize() and inline functions).
 #include "rs_model_impl.hpp"
 
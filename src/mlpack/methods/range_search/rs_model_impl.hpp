@@ -25,10 +25,13 @@ namespace range {
  * Initialize the RSModel with the given tree type and whether or not a random
  * basis should be used.
  */
-inline RSModel::RSModel(TreeTypes treeType, bool randomBasis) :
+inline RSModel::RSModel(TreeTypes treeType,
+                        bool randomBasis,
+                        bool singlePrecision) :
     treeType(treeType),
     leafSize(0),
-    randomBasis(randomBasis)
+    randomBasis(randomBasis),
+    singlePrecision(singlePrecision)
 {
   // Nothing to do.
 }
@@ -39,6 +42,7 @@ inline RSModel::RSModel(const RSModel& other) :
     leafSize(other.leafSize),
     randomBasis(other.randomBasis),
     q(other.q),
+    singlePrecision(other.singlePrecision),
     rSearch(other.rSearch)
 {
   // Nothing to do.
@@ -50,12 +54,14 @@ inline RSModel::RSModel(RSModel&& other) :
     leafSize(other.leafSize),
     randomBasis(other.randomBasis),
     q(std::move(other.q)),
+    singlePrecision(other.singlePrecision),
     rSearch(std::move(other.rSearch))
 {
   // Reset other model.
   other.treeType = TreeTypes::KD_TREE;
   other.leafSize = 0;
   other.randomBasis = false;
+  other.singlePrecision = false;
   other.rSearch = decltype(other.rSearch)();
 }
 
@@ -67,6 +73,7 @@ inline RSModel& RSModel::operator=(RSModel other)
   leafSize = other.leafSize;
   randomBasis = other.randomBasis;
   q = std::move(other.q);
+  singlePrecision = other.singlePrecision;
   rSearch = std::move(other.rSearch);
 
   return *this;
@@ -83,6 +90,10 @@ inline void RSModel::BuildModel(arma::mat&& referenceSet,
                                 const bool naive,
                                 const bool singleMode)
 {
+  if (singlePrecision && treeType != KD_TREE && treeType != BALL_TREE)
+    throw std::invalid_argument("single-precision models are only supported "
+        "for kd-trees and ball trees");
+
   // Initialize random basis if necessary.
   if (randomBasis)
   {
@@ -108,7 +119,10 @@ inline void RSModel::BuildModel(arma::mat&& referenceSet,
   switch (treeType)
   {
     case KD_TREE:
-      rSearch = new RSType<tree::KDTree> (naive, singleMode);
+      if (singlePrecision)
+        rSearch = new RSType<tree::KDTree, arma::fmat>(naive, singleMode);
+      else
+        rSearch = new RSType<tree::KDTree>(naive, singleMode);
       break;
 
     case COVER_TREE:
@@ -124,7 +138,10 @@ inline void RSModel::BuildModel(arma::mat&& referenceSet,
       break;
 
     case BALL_TREE:
-      rSearch = new RSType<tree::BallTree>(naive, singleMode);
+      if (singlePrecision)
+        rSearch = new RSType<tree::BallTree, arma::fmat>(naive, singleMode);
+      else
+        rSearch = new RSType<tree::BallTree>(naive, singleMode);
       break;
 
     case X_TREE:
@@ -217,6 +234,42 @@ inline void RSModel::Search(const math::Range& range,
   boost::apply_visitor(search, rSearch);
 }
 
+// Build a query tree for repeated dual-tree searches.
+inline tree::QueryTreeHandle RSModel::BuildQueryTree(
+    arma::mat&& querySet) const
+{
+  if (Naive() || SingleMode())
+    throw std::invalid_argument("query trees can only be used for dual-tree "
+        "search");
+
+  // We may need to map the query set randomly.
+  if (randomBasis)
+    querySet = q * querySet;
+
+  Timer::Start("tree_building");
+  Log::Info << "Building query tree..." << std::endl;
+  BuildQueryTreeVisitor build(querySet, leafSize);
+  tree::QueryTreeHandle queryTree = boost::apply_visitor(build, rSearch);
+  Log::Info << "Tree built." << std::endl;
+  Timer::Stop("tree_building");
+
+  return queryTree;
+}
+
+// Perform dual-tree range search with a prebuilt query tree.
+inline void RSModel::Search(const tree::QueryTreeHandle& queryTree,
+                            const math::Range& range,
+                            std::vector<std::vector<size_t>>& neighbors,
+                            std::vector<std::vector<double>>& distances)
+{
+  Log::Info << "Search for points in the range [" << range.Lo() << ", "
+      << range.Hi() << "] with dual-tree " << TreeName() << " search (with a "
+      << "prebuilt query tree)..." << std::endl;
+
+  QueryTreeSearchVisitor search(queryTree, range, neighbors, distances);
+  boost::apply_visitor(search, rSearch);
+}
+
 // Get the name of the tree type.
 inline std::string RSModel::TreeName() const
 {
@@ -319,18 +372,47 @@ inline void BiSearchVisitor::operator()(RSTypeT<tree::Octree>* rs) const
   throw std::runtime_error("no range search model initialized");
 }
 
+//! Bichromatic range search specialized for single-precision KDTrees.
+inline void BiSearchVisitor::operator()(
+    RSTypeT<tree::KDTree, arma::fmat>* rs) const
+{
+  if (rs)
+    return SearchLeaf(rs);
+  throw std::runtime_error("no range search model initialized");
+}
+
+//! Bichromatic range search specialized for single-precision BallTrees.
+inline void BiSearchVisitor::operator()(
+    RSTypeT<tree::BallTree, arma::fmat>* rs) const
+{
+  if (rs)
+    return SearchLeaf(rs);
+  throw std::runtime_error("no range search model initialized");
+}
+
+//! Convert the query set for a single-precision model.
+template<typename MatType>
+const MatType& BiSearchVisitor::QuerySet(MatType& converted) const
+{
+  converted = arma::conv_to<MatType>::from(querySet);
+  return converted;
+}
+
 //! Bichromatic range search on the given RSType considering the leafSize.
 template<typename RSType>
 void BiSearchVisitor::SearchLeaf(RSType* rs) const
 {
+  typedef typename RSType::Tree::Mat MatType;
+
+  MatType converted;
   if (!rs->Naive() && !rs->SingleMode())
   {
     // Build a second tree and search.
     Timer::Start("tree_building");
     Log::Info << "Building query tree..." << std::endl;
     std::vector<size_t> oldFromNewQueries;
-    typename RSType::Tree queryTree(std::move(querySet), oldFromNewQueries,
-        leafSize);
+    typename RSType::Tree queryTree(MatType(QuerySet(converted)),
+        oldFromNewQueries, leafSize);
     Log::Info << "Tree built." << std::endl;
     Timer::Stop("tree_building");
 
@@ -348,7 +430,7 @@ void BiSearchVisitor::SearchLeaf(RSType* rs) const
     }
   }
   else
-    rs->Search(querySet, range, neighbors, distances);
+    rs->Search(QuerySet(converted), range, neighbors, distances);
 }
 
 //! Save parameters for Train.
@@ -393,17 +475,48 @@ inline void TrainVisitor::operator()(RSTypeT<tree::Octree>* rs) const
   throw std::runtime_error("no range search model initialized");
 }
 
+//! Train on the given RSType specialized for single-precision KDTrees.
+inline void TrainVisitor::operator()(
+    RSTypeT<tree::KDTree, arma::fmat>* rs) const
+{
+  if (rs)
+    return TrainLeaf(rs);
+  throw std::runtime_error("no range search model initialized");
+}
+
+//! Train on the given RSType specialized for single-precision BallTrees.
+inline void TrainVisitor::operator()(
+    RSTypeT<tree::BallTree, arma::fmat>* rs) const
+{
+  if (rs)
+    return TrainLeaf(rs);
+  throw std::runtime_error("no range search model initialized");
+}
+
+//! Convert the reference set for a single-precision model.
+template<typename MatType>
+void TrainVisitor::ReferenceSet(MatType& converted) const
+{
+  converted = arma::conv_to<MatType>::from(referenceSet);
+
+  // The original reference set is not needed anymore.
+  referenceSet.reset();
+}
+
 //! Train on the given RSType considering the leafSize.
 template<typename RSType>
 void TrainVisitor::TrainLeaf(RSType* rs) const
 {
+  typename RSType::Tree::Mat dataset;
+  ReferenceSet(dataset);
+
   if (rs->Naive())
-    rs->Train(std::move(referenceSet));
+    rs->Train(std::move(dataset));
   else
   {
     std::vector<size_t> oldFromNewReferences;
     typename RSType::Tree* tree =
-        new typename RSType::Tree(std::move(referenceSet), oldFromNewReferences,
+        new typename RSType::Tree(std::move(dataset), oldFromNewReferences,
         leafSize);
     rs->Train(tree);
 
@@ -413,6 +526,122 @@ void TrainVisitor::TrainLeaf(RSType* rs) const
   }
 }
 
+//! Save parameters for building a query tree.
+inline BuildQueryTreeVisitor::BuildQueryTreeVisitor(arma::mat& querySet,
+                                                    const size_t leafSize) :
+    querySet(querySet),
+    leafSize(leafSize)
+{}
+
+//! Default query tree construction on the given RSType instance.
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+tree::QueryTreeHandle BuildQueryTreeVisitor::operator()(
+    RSTypeT<TreeType>* rs) const
+{
+  if (!rs)
+    throw std::runtime_error("no range search model initialized");
+
+  typedef typename RSTypeT<TreeType>::Tree Tree;
+  std::vector<size_t> oldFromNewQueries;
+  Tree* queryTree = BuildTree<Tree>(std::move(querySet), oldFromNewQueries);
+  return tree::QueryTreeHandle(queryTree, std::move(oldFromNewQueries));
+}
+
+//! Query tree construction specialized for KDTrees.
+inline tree::QueryTreeHandle BuildQueryTreeVisitor::operator()(
+    RSTypeT<tree::KDTree>* rs) const
+{
+  if (rs)
+    return BuildLeaf(rs);
+  throw std::runtime_error("no range search model initialized");
+}
+
+//! Query tree construction specialized for BallTrees.
+inline tree::QueryTreeHandle BuildQueryTreeVisitor::operator()(
+    RSTypeT<tree::BallTree>* rs) const
+{
+  if (rs)
+    return BuildLeaf(rs);
+  throw std::runtime_error("no range search model initialized");
+}
+
+//! Query tree construction specialized for octrees.
+inline tree::QueryTreeHandle BuildQueryTreeVisitor::operator()(
+    RSTypeT<tree::Octree>* rs) const
+{
+  if (rs)
+    return BuildLeaf(rs);
+  throw std::runtime_error("no range search model initialized");
+}
+
+//! Query tree construction specialized for single-precision KDTrees.
+inline tree::QueryTreeHandle BuildQueryTreeVisitor::operator()(
+    RSTypeT<tree::KDTree, arma::fmat>* rs) const
+{
+  if (rs)
+    return BuildLeaf(rs);
+  throw std::runtime_error("no range search model initialized");
+}
+
+//! Query tree construction specialized for single-precision BallTrees.
+inline tree::QueryTreeHandle BuildQueryTreeVisitor::operator()(
+    RSTypeT<tree::BallTree, arma::fmat>* rs) const
+{
+  if (rs)
+    return BuildLeaf(rs);
+  throw std::runtime_error("no range search model initialized");
+}
+
+//! Query tree construction on the given RSType considering the leafSize.
+template<typename RSType>
+tree::QueryTreeHandle BuildQueryTreeVisitor::BuildLeaf(RSType* /* rs */) const
+{
+  typedef typename RSType::Tree Tree;
+
+  std::vector<size_t> oldFromNewQueries;
+  Tree* queryTree = new Tree(QuerySet<typename Tree::Mat>(), oldFromNewQueries,
+      leafSize);
+  return tree::QueryTreeHandle(queryTree, std::move(oldFromNewQueries));
+}
+
+//! Search with the query tree on the given RSType.
+template<typename RSType>
+void QueryTreeSearchVisitor::operator()(RSType* rs) const
+{
+  if (!rs)
+    throw std::runtime_error("no range search model initialized");
+
+  typedef typename RSType::Tree Tree;
+  Tree* tree = queryTree.Get<Tree>();
+  if (!tree)
+    throw std::invalid_argument("the query tree was not built for the type of "
+        "tree used by the model");
+
+  // The statistics of the query tree are not used by range search, so nothing
+  // needs to be reset.
+  const std::vector<size_t>& oldFromNewQueries = queryTree.OldFromNew();
+  if (oldFromNewQueries.empty())
+  {
+    rs->Search(tree, range, neighbors, distances);
+    return;
+  }
+
+  std::vector<std::vector<size_t>> neighborsOut;
+  std::vector<std::vector<double>> distancesOut;
+  rs->Search(tree, range, neighborsOut, distancesOut);
+
+  // Remap the query points.
+  neighbors.resize(neighborsOut.size());
+  distances.resize(distancesOut.size());
+  for (size_t i = 0; i < neighborsOut.size(); ++i)
+  {
+    neighbors[oldFromNewQueries[i]] = std::move(neighborsOut[i]);
+    distances[oldFromNewQueries[i]] = std::move(distancesOut[i]);
+  }
+}
+
 //! Expose the referenceSet of the given RSType.
 template<typename RSType>
 const arma::mat& ReferenceSetVisitor::operator()(RSType* rs) const
@@ -422,6 +651,26 @@ const arma::mat& ReferenceSetVisitor::operator()(RSType* rs) const
   throw std::runtime_error("no range search model initialized");
 }
 
+//! Single-precision models do not hold an arma::mat reference set.
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+const arma::mat& ReferenceSetVisitor::operator()(
+    RSType<TreeType, arma::fmat>* /* rs */) const
+{
+  throw std::invalid_argument("the reference set of a single-precision model "
+      "cannot be accessed as an arma::mat");
+}
+
+//! Return the size of the reference set of the given RSType.
+template<typename RSType>
+arma::SizeMat ReferenceSetSizeVisitor::operator()(RSType* rs) const
+{
+  if (rs)
+    return arma::size(rs->ReferenceSet());
+  throw std::runtime_error("no range search model initialized");
+}
+
 //! For cleaning memory
 template<typename RSType>
 void DeleteVisitor::operator()(RSType* rs) const
@@ -448,14 +697,29 @@ bool& NaiveVisitor::operator()(RSType* rs) const
   throw std::runtime_error("no range search model initialized");
 }
 
+//! Exposes the traversal statistics of the given RSType.
+template<typename RSType>
+tree::TraversalStatistics& StatisticsVisitor::operator()(RSType* rs) const
+{
+  if (rs)
+    return rs->Statistics();
+  throw std::runtime_error("no range search model initialized");
+}
+
 // Serialize the model.
 template<typename Archive>
-void RSModel::serialize(Archive& ar, const unsigned int /* version */)
+void RSModel::serialize(Archive& ar, const unsigned int version)
 {
   ar & BOOST_SERIALIZATION_NVP(treeType);
   ar & BOOST_SERIALIZATION_NVP(randomBasis);
   ar & BOOST_SERIALIZATION_NVP(q);
 
+  // Older versions of RSModel only held double-precision models.
+  if (version > 0)
+    ar & BOOST_SERIALIZATION_NVP(singlePrecision);
+  else if (Archive::is_loading::value)
+    singlePrecision = false;
+
   // This should never happen, but just in case...
   if (Archive::is_loading::value)
     boost::apply_visitor(DeleteVisitor(), rSearch);
@@ -469,6 +733,11 @@ inline const arma::mat& RSModel::Dataset() const
   return boost::apply_visitor(ReferenceSetVisitor(), rSearch);
 }
 
+inline arma::SizeMat RSModel::DatasetSize() const
+{
+  return boost::apply_visitor(ReferenceSetSizeVisitor(), rSearch);
+}
+
 inline bool RSModel::SingleMode() const
 {
   return boost::apply_visitor(SingleModeVisitor(), rSearch);
@@ -489,6 +758,16 @@ inline bool& RSModel::Naive()
   return boost::apply_visitor(NaiveVisitor(), rSearch);
 }
 
+inline const tree::TraversalStatistics& RSModel::Statistics() const
+{
+  return boost::apply_visitor(StatisticsVisitor(), rSearch);
+}
+
+inline tree::TraversalStatistics& RSModel::Statistics()
+{
+  return boost::apply_visitor(StatisticsVisitor(), rSearch);
+}
+
 } // namespace range
 } // namespace mlpack
 
@@ -58,6 +58,12 @@ class TrainVisitor;
  *
  * RASearch is currently known to not work with ball trees (#356).
  *
+ * When OpenMP is available, naive and single-tree search process the query
+ * points in parallel.  The samples for each query point are drawn from a random
+ * number generator seeded from the global one (see math::RandomSeed()) and the
+ * index of the query point, so the results for a given seed do not depend on
+ * the number of threads.
+ *
  * @tparam SortPolicy The sort policy for distances; see NearestNeighborSort.
  * @tparam MetricType The metric to use for computation.
  * @tparam TreeType The tree type to use.
@@ -291,52 +291,56 @@ Search(const MatType& querySet,
 
   typedef RASearchRules<SortPolicy, MetricType, Tree> RuleType;
 
-  if (naive)
+  if (naive || singleMode)
   {
-    RuleType rules(*referenceSet, querySet, k, metric, tau, alpha, naive,
+    // The sampling for each query point is independent, so each thread gets
+    // its own copy of the rules and writes the results of its query points
+    // directly.  The random number generator is reseeded for each query point
+    // from a seed drawn from the global random number generator, so that the
+    // results for a given seed don't depend on the number of threads.
+    RuleType rules(*referenceSet, querySet, k, metric, tau, alpha, false,
         sampleAtLeaves, firstLeafExact, singleSampleLimit, false);
 
-    // Find how many samples from the reference set we need and sample uniformly
-    // from the reference set without replacement.
-    const size_t numSamples = RAUtil::MinimumSamplesReqd(referenceSet->n_cols,
-        k, tau, alpha);
-    arma::uvec distinctSamples;
-    math::ObtainDistinctSamples(0, referenceSet->n_cols, numSamples,
-        distinctSamples);
+    // If the reference root node is a leaf, there is nothing to traverse.
+    if (naive || !referenceTree->IsLeaf())
+    {
+      if (!naive)
+        Log::Info << "Performing single-tree traversal..." << std::endl;
 
-    // Run the base case on each combination of query point and sampled
-    // reference point.
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      for (size_t j = 0; j < distinctSamples.n_elem; ++j)
-        rules.BaseCase(i, (size_t) distinctSamples[j]);
+      const size_t seed = math::randGen();
+      size_t numDistComputations = 0;
+      #pragma omp parallel reduction(+:numDistComputations)
+      {
+        RuleType threadRules(rules);
 
-    rules.GetResults(*neighborPtr, *distancePtr);
-  }
-  else if (singleMode)
-  {
-    RuleType rules(*referenceSet, querySet, k, metric, tau, alpha, naive,
-        sampleAtLeaves, firstLeafExact, singleSampleLimit, false);
+        // The traverser is only used in single-tree mode.
+        typename Tree::template SingleTreeTraverser<RuleType>
+            traverser(threadRules);
 
-    // If the reference root node is a leaf, then the sampling has already been
-    // done in the RASearchRules constructor.  This happens when naive = true.
-    if (!referenceTree->IsLeaf())
-    {
-      Log::Info << "Performing single-tree traversal..." << std::endl;
+        #pragma omp for schedule(dynamic)
+        for (omp_size_t i = 0; i < (omp_size_t) querySet.n_cols; ++i)
+        {
+          threadRules.SeedQuery(seed, i);
+          if (naive)
+            threadRules.SampleReferenceSet(i);
+          else
+            traverser.Traverse(i, *referenceTree);
 
-      // Create the traverser.
-      typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
+          threadRules.GetResults(i, *neighborPtr, *distancePtr);
+        }
 
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < querySet.n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+        numDistComputations += threadRules.NumDistComputations();
+      }
 
-      Log::Info << "Single-tree traversal complete." << std::endl;
+      if (!naive)
+        Log::Info << "Single-tree traversal complete." << std::endl;
       Log::Info << "Average number of distance calculations per query point: "
-          << (rules.NumDistComputations() / querySet.n_cols) << "."
-          << std::endl;
+          << (numDistComputations / querySet.n_cols) << "." << std::endl;
+    }
+    else
+    {
+      rules.GetResults(*neighborPtr, *distancePtr);
     }
-
-    rules.GetResults(*neighborPtr, *distancePtr);
   }
   else // Dual-tree recursion.
   {
@@ -519,32 +523,34 @@ void RASearch<SortPolicy, MetricType, MatType, TreeType>::Search(
 
   // Create the helper object for the tree traversal.
   typedef RASearchRules<SortPolicy, MetricType, Tree> RuleType;
-  RuleType rules(*referenceSet, *referenceSet, k, metric, tau, alpha, naive,
+  RuleType rules(*referenceSet, *referenceSet, k, metric, tau, alpha, false,
       sampleAtLeaves, firstLeafExact, singleSampleLimit, true /* same sets */);
 
-  if (naive)
-  {
-    // Find how many samples from the reference set we need and sample uniformly
-    // from the reference set without replacement.
-    const size_t numSamples = RAUtil::MinimumSamplesReqd(referenceSet->n_cols,
-        k, tau, alpha);
-    arma::uvec distinctSamples;
-    math::ObtainDistinctSamples(0, referenceSet->n_cols, numSamples,
-        distinctSamples);
-
-    // The naive brute-force solution.
-    for (size_t i = 0; i < referenceSet->n_cols; ++i)
-      for (size_t j = 0; j < referenceSet->n_cols; ++j)
-        rules.BaseCase(i, j);
-  }
-  else if (singleMode)
+  if (naive || singleMode)
   {
-    // Create the traverser.
-    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
+    // As in bichromatic search, each thread gets its own copy of the rules,
+    // and the random number generator is reseeded for each query point.
+    const size_t seed = math::randGen();
+    #pragma omp parallel
+    {
+      RuleType threadRules(rules);
+
+      // The traverser is only used in single-tree mode.
+      typename Tree::template SingleTreeTraverser<RuleType>
+          traverser(threadRules);
 
-    // Now have it traverse for each point.
-    for (size_t i = 0; i < referenceSet->n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
+      #pragma omp for schedule(dynamic)
+      for (omp_size_t i = 0; i < (omp_size_t) referenceSet->n_cols; ++i)
+      {
+        threadRules.SeedQuery(seed, i);
+        if (naive)
+          threadRules.SampleReferenceSet(i);
+        else
+          traverser.Traverse(i, *referenceTree);
+
+        threadRules.GetResults(i, *neighborPtr, *distancePtr);
+      }
+    }
   }
   else
   {
@@ -552,9 +558,9 @@ void RASearch<SortPolicy, MetricType, MatType, TreeType>::Search(
     typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
 
     traverser.Traverse(*referenceTree, *referenceTree);
-  }
 
-  rules.GetResults(*neighborPtr, *distancePtr);
+    rules.GetResults(*neighborPtr, *distancePtr);
+  }
 
   Timer::Stop("computing_neighbors");
 
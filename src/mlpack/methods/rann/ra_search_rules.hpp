@@ -15,8 +15,10 @@
 #define MLPACK_METHODS_RANN_RA_SEARCH_RULES_HPP
 
 #include <mlpack/core/tree/traversal_info.hpp>
+#include <mlpack/core/math/philox.hpp>
 
 #include <queue>
+#include <random>
 
 namespace mlpack {
 namespace neighbor {
@@ -75,6 +77,43 @@ class RASearchRules
    */
   void GetResults(arma::Mat<size_t>& neighbors, arma::mat& distances);
 
+  /**
+   * Store the list of candidates for the given query point in the given
+   * matrices.  This is used when each query point is searched by its own
+   * thread, so that the matrices can be shared.
+   *
+   * @param queryIndex Index of the query point.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *     point.
+   */
+  void GetResults(const size_t queryIndex,
+                  arma::Mat<size_t>& neighbors,
+                  arma::mat& distances);
+
+  /**
+   * Reseed the random number generator used for sampling, so that the samples
+   * for the given query point only depend on the seed and the query index.
+   * Calling this before each query point is searched makes the results
+   * independent of the thread that handles each query point.
+   *
+   * @param seed Seed of the search.
+   * @param queryIndex Index of the query point.
+   */
+  void SeedQuery(const size_t seed, const size_t queryIndex)
+  {
+    rng.Seed(seed, queryIndex);
+  }
+
+  /**
+   * Run the base case on a uniform sample (without replacement) of the whole
+   * reference set for the given query point.  This is the naive
+   * rank-approximate search, without trees.
+   *
+   * @param queryIndex Index of the query point.
+   */
+  void SampleReferenceSet(const size_t queryIndex);
+
   /**
    * Get the distance from the query point to the reference point.
    * This will update the list of candidates with the new point if appropriate.
@@ -298,6 +337,10 @@ class RASearchRules
 
   TraversalInfoType traversalInfo;
 
+  //! The random number generator used for sampling, with one stream for
+  //! each query point.
+  math::PhiloxEngine rng;
+
   /**
    * Helper function to insert a point into the list of candidate points.
    *
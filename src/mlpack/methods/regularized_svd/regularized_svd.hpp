@@ -18,6 +18,7 @@
 #include <mlpack/methods/cf/cf.hpp>
 
 #include "regularized_svd_function.hpp"
+#include "stratified_sgd.hpp"
 
 namespace mlpack {
 namespace svd {
@@ -62,7 +63,9 @@ class RegularizedSVD
    * Constructor for Regularized SVD. Obtains the user and item matrices after
    * training on the passed data. The constructor initiates an object of class
    * RegularizedSVDFunction for optimization. It uses the SGD optimizer by
-   * default. The optimizer uses a template specialization of Optimize().
+   * default. The optimizer uses a template specialization of Optimize().  If
+   * OptimizerType is StratifiedSGD, the ratings are processed in parallel in
+   * conflict-free blocks instead.
    *
    * @param iterations Number of optimization iterations.
    * @param alpha Learning rate for the SGD optimizer.
@@ -86,6 +89,15 @@ class RegularizedSVD
              arma::mat& v);
 
  private:
+  //! Optimize the parameters with SGD (batch size 1).
+  void Optimize(RegularizedSVDFunction<arma::mat>& function,
+                arma::mat& parameters,
+                std::false_type /* stratified */) const;
+  //! Optimize the parameters with StratifiedSGD.
+  void Optimize(RegularizedSVDFunction<arma::mat>& function,
+                arma::mat& parameters,
+                std::true_type /* stratified */) const;
+
   //! Number of optimization iterations.
   size_t iterations;
   //! Learning rate for the SGD optimizer.
@@ -94,6 +94,20 @@ class RegularizedSVDFunction
                 GradType& gradient,
                 const size_t batchSize = 1) const;
 
+  /**
+   * Take one SGD step on the given training example, in place.  Only the
+   * parameter columns of the example's user and item are touched, so steps on
+   * examples that share no user and no item may be taken concurrently.  This
+   * is used by StratifiedSGD.
+   *
+   * @param parameters Parameters(user/item matrices) of the decomposition.
+   * @param i Index of the training example.
+   * @param stepSize Step size for the update.
+   */
+  void Step(arma::mat& parameters,
+            const size_t i,
+            const double stepSize) const;
+
   //! Return the initial point for the optimization.
   const arma::mat& GetInitialPoint() const { return initialPoint; }
 
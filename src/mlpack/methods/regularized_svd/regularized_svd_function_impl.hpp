@@ -150,6 +150,32 @@ void RegularizedSVDFunction<MatType>::Gradient(const arma::mat& parameters,
   }
 }
 
+template <typename MatType>
+void RegularizedSVDFunction<MatType>::Step(arma::mat& parameters,
+                                           const size_t i,
+                                           const double stepSize) const
+{
+  // Indices for accessing the correct parameter columns.
+  const size_t user = data(0, i);
+  const size_t item = data(1, i) + numUsers;
+
+  // Prediction error for the example.
+  const double ratingError = data(2, i) - arma::dot(parameters.col(user),
+      parameters.col(item));
+
+  // Both updates are computed from the parameters before the step.
+  double* userColumn = parameters.colptr(user);
+  double* itemColumn = parameters.colptr(item);
+  for (size_t r = 0; r < parameters.n_rows; ++r)
+  {
+    const double userValue = userColumn[r];
+    userColumn[r] -= stepSize * (lambda * userValue -
+        ratingError * itemColumn[r]);
+    itemColumn[r] -= stepSize * (lambda * itemColumn[r] -
+        ratingError * userValue);
+  }
+}
+
 } // namespace svd
 } // namespace mlpack
 
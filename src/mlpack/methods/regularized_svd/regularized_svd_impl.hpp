@@ -33,20 +33,11 @@ void RegularizedSVD<OptimizerType>::Apply(const arma::mat& data,
                                           arma::mat& u,
                                           arma::mat& v)
 {
-  // batchSize is 1 in our implementation of Regularized SVD.
-  // batchSize other than 1 has not been supported yet.
-  const int batchSize = 1;
-  Log::Warn << "The batch size for optimizing RegularizedSVD is 1."
-      << std::endl;
-
-  // Make the optimizer object using a RegularizedSVDFunction object.
+  // Make the function object and optimize the parameters.
   RegularizedSVDFunction<arma::mat> rSVDFunc(data, rank, lambda);
-  ens::StandardSGD optimizer(alpha, batchSize,
-      iterations * data.n_cols);
-
-  // Get optimized parameters.
   arma::mat parameters = rSVDFunc.GetInitialPoint();
-  optimizer.Optimize(rSVDFunc, parameters);
+  Optimize(rSVDFunc, parameters,
+      std::is_same<OptimizerType, StratifiedSGD>());
 
   // Constants for extracting user and item matrices.
   const size_t numUsers = max(data.row(0)) + 1;
@@ -57,6 +48,34 @@ void RegularizedSVD<OptimizerType>::Apply(const arma::mat& data,
   v = parameters.submat(0, 0, rank - 1, numUsers - 1);
 }
 
+template<typename OptimizerType>
+void RegularizedSVD<OptimizerType>::Optimize(
+    RegularizedSVDFunction<arma::mat>& function,
+    arma::mat& parameters,
+    std::false_type /* stratified */) const
+{
+  // batchSize is 1 in our implementation of Regularized SVD.
+  // batchSize other than 1 has not been supported yet.
+  const int batchSize = 1;
+  Log::Warn << "The batch size for optimizing RegularizedSVD is 1."
+      << std::endl;
+
+  ens::StandardSGD optimizer(alpha, batchSize,
+      iterations * function.NumFunctions());
+  optimizer.Optimize(function, parameters);
+}
+
+template<typename OptimizerType>
+void RegularizedSVD<OptimizerType>::Optimize(
+    RegularizedSVDFunction<arma::mat>& function,
+    arma::mat& parameters,
+    std::true_type /* stratified */) const
+{
+  // Each epoch is one pass over the data, like the iterations of SGD.
+  StratifiedSGD optimizer(alpha, iterations);
+  optimizer.Optimize(function, parameters);
+}
+
 } // namespace svd
 } // namespace mlpack
 
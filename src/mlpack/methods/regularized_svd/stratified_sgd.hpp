@@ -0,0 +1,133 @@
+/**
+ * @file stratified_sgd.hpp
+ *
+ * Stratified SGD for matrix factorization: the rating matrix is split into a
+ * grid of blocks, and blocks that share no user and no item are processed in
+ * parallel without any synchronization on the parameters.
+ *
+ * @inproceedings{gemulla2011large,
+ *   title={Large-Scale Matrix Factorization with Distributed Stochastic
+ *       Gradient Descent},
+ *   author={Gemulla, Rainer and Nijkamp, Erik and Haas, Peter J. and
+ *       Sismanis, Yannis},
+ *   booktitle={Proceedings of the 17th ACM SIGKDD International Conference on
+ *       Knowledge Discovery and Data Mining},
+ *   pages={69--77},
+ *   year={2011}
+ * }
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_REGULARIZED_SVD_STRATIFIED_SGD_HPP
+#define MLPACK_METHODS_REGULARIZED_SVD_STRATIFIED_SGD_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <algorithm>
+
+namespace mlpack {
+namespace svd {
+
+/**
+ * StratifiedSGD is an SGD optimizer for matrix factorization objectives such
+ * as RegularizedSVDFunction and BiasSVDFunction, where each rating only
+ * updates the parameters of its user and its item.  The users and the items
+ * are randomly split into p groups each, which splits the ratings into a p x p
+ * grid of blocks.  An epoch is made of p strata; the s'th stratum holds the p
+ * blocks (b, (b + s) mod p), which share no user and no item, so each of them
+ * is processed by one thread with plain (non-atomic) updates.  Within a block
+ * the ratings are sorted by user and then item, so that consecutive updates
+ * reuse the same parameter columns.
+ *
+ * The function type must provide Dataset(), NumUsers(), NumItems(),
+ * NumFunctions(), Evaluate(parameters, i) and Step(parameters, i, stepSize).
+ *
+ * @code
+ * RegularizedSVDFunction<arma::mat> f(data, rank, lambda);
+ * arma::mat parameters = f.GetInitialPoint();
+ * StratifiedSGD optimizer(0.01, 10);
+ * optimizer.Optimize(f, parameters);
+ * @endcode
+ */
+class StratifiedSGD
+{
+ public:
+  /**
+   * Create the optimizer with the given parameters.
+   *
+   * @param stepSize Step size for each update.
+   * @param maxEpochs Maximum number of passes over the data (0 means no
+   *     limit).
+   * @param numStrata Number of user groups and item groups; if 0, the maximum
+   *     number of OpenMP threads is used.
+   * @param tolerance Minimum change of the objective between two epochs.
+   * @param shuffle If true, the order of the strata in each epoch is random.
+   */
+  StratifiedSGD(const double stepSize = 0.01,
+                const size_t maxEpochs = 10,
+                const size_t numStrata = 0,
+                const double tolerance = 1e-5,
+                const bool shuffle = true);
+
+  /**
+   * Optimize the given function, starting from (and overwriting) the given
+   * parameters.  The objective after the last epoch is returned.
+   *
+   * @param function Function to optimize.
+   * @param iterate Starting point; will hold the final point.
+   */
+  template<typename FunctionType>
+  double Optimize(FunctionType& function, arma::mat& iterate);
+
+  //! Get the step size.
+  double StepSize() const { return stepSize; }
+  //! Modify the step size.
+  double& StepSize() { return stepSize; }
+
+  //! Get the maximum number of epochs (0 means no limit).
+  size_t MaxEpochs() const { return maxEpochs; }
+  //! Modify the maximum number of epochs (0 means no limit).
+  size_t& MaxEpochs() { return maxEpochs; }
+
+  //! Get the number of strata (0 means the number of threads).
+  size_t NumStrata() const { return numStrata; }
+  //! Modify the number of strata (0 means the number of threads).
+  size_t& NumStrata() { return numStrata; }
+
+  //! Get the tolerance for termination.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance for termination.
+  double& Tolerance() { return tolerance; }
+
+  //! Get whether or not the strata are visited in random order.
+  bool Shuffle() const { return shuffle; }
+  //! Modify whether or not the strata are visited in random order.
+  bool& Shuffle() { return shuffle; }
+
+ private:
+  //! Randomly assign each of n indices to one of p groups of (almost) equal
+  //! size.
+  static arma::Col<size_t> RandomGroups(const size_t n, const size_t p);
+
+  //! Step size for each update.
+  double stepSize;
+  //! Maximum number of epochs.
+  size_t maxEpochs;
+  //! Number of user groups and item groups.
+  size_t numStrata;
+  //! Minimum change of the objective between two epochs.
+  double tolerance;
+  //! Whether or not to visit the strata in random order.
+  bool shuffle;
+};
+
+} // namespace svd
+} // namespace mlpack
+
+// Include implementation.
+#include "stratified_sgd_impl.hpp"
+
+#endif
@@ -0,0 +1,156 @@
+/**
+ * @file stratified_sgd_impl.hpp
+ *
+ * Implementation of StratifiedSGD.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_REGULARIZED_SVD_STRATIFIED_SGD_IMPL_HPP
+#define MLPACK_METHODS_REGULARIZED_SVD_STRATIFIED_SGD_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "stratified_sgd.hpp"
+
+namespace mlpack {
+namespace svd {
+
+inline StratifiedSGD::StratifiedSGD(const double stepSize,
+                                    const size_t maxEpochs,
+                                    const size_t numStrata,
+                                    const double tolerance,
+                                    const bool shuffle) :
+    stepSize(stepSize),
+    maxEpochs(maxEpochs),
+    numStrata(numStrata),
+    tolerance(tolerance),
+    shuffle(shuffle)
+{
+  // Nothing to do.
+}
+
+inline arma::Col<size_t> StratifiedSGD::RandomGroups(const size_t n,
+                                                     const size_t p)
+{
+  const arma::Col<size_t> order = arma::shuffle(
+      arma::linspace<arma::Col<size_t>>(0, n - 1, n));
+  arma::Col<size_t> groups(n);
+  for (size_t i = 0; i < n; ++i)
+    groups[order[i]] = i * p / n;
+
+  return groups;
+}
+
+template<typename FunctionType>
+double StratifiedSGD::Optimize(FunctionType& function, arma::mat& iterate)
+{
+  const arma::mat& data = function.Dataset();
+  const size_t numUsers = function.NumUsers();
+  const size_t numItems = function.NumItems();
+  const size_t numRatings = function.NumFunctions();
+
+  size_t p = numStrata;
+  if (p == 0)
+  {
+    #ifdef HAS_OPENMP
+      p = omp_get_max_threads();
+    #else
+      p = 1;
+    #endif
+  }
+  p = std::max((size_t) 1, std::min(p, std::min(numUsers, numItems)));
+
+  // Random groups balance the number of ratings in each block, even if the
+  // users and items are ordered by popularity.
+  const arma::Col<size_t> userGroups = RandomGroups(numUsers, p);
+  const arma::Col<size_t> itemGroups = RandomGroups(numItems, p);
+
+  // Counting sort of the ratings into the blocks: the ratings of block
+  // (userGroup, itemGroup) are order[offsets[b]] to order[offsets[b + 1] - 1],
+  // where b = userGroup * p + itemGroup.
+  std::vector<size_t> offsets(p * p + 1, 0);
+  std::vector<size_t> blocks(numRatings);
+  for (size_t i = 0; i < numRatings; ++i)
+  {
+    blocks[i] = userGroups[(size_t) data(0, i)] * p +
+        itemGroups[(size_t) data(1, i)];
+    ++offsets[blocks[i] + 1];
+  }
+  for (size_t b = 0; b < p * p; ++b)
+    offsets[b + 1] += offsets[b];
+
+  std::vector<size_t> order(numRatings);
+  std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+  for (size_t i = 0; i < numRatings; ++i)
+    order[next[blocks[i]]++] = i;
+
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t b = 0; b < (omp_size_t) (p * p); ++b)
+  {
+    std::sort(order.begin() + offsets[b], order.begin() + offsets[b + 1],
+        [&data](const size_t i, const size_t j)
+        {
+          return (data(0, i) < data(0, j)) ||
+              (data(0, i) == data(0, j) && data(1, i) < data(1, j));
+        });
+  }
+
+  arma::Col<size_t> strata = arma::linspace<arma::Col<size_t>>(0, p - 1, p);
+  double overallObjective = DBL_MAX;
+  double lastObjective;
+  for (size_t epoch = 1; maxEpochs == 0 || epoch <= maxEpochs; ++epoch)
+  {
+    if (shuffle)
+      strata = arma::shuffle(strata);
+
+    for (size_t s = 0; s < p; ++s)
+    {
+      // The blocks of a stratum share no user and no item, so the threads
+      // never update the same parameters.
+      #pragma omp parallel for schedule(dynamic)
+      for (omp_size_t g = 0; g < (omp_size_t) p; ++g)
+      {
+        const size_t b = g * p + (g + strata[s]) % p;
+        for (size_t k = offsets[b]; k < offsets[b + 1]; ++k)
+          function.Step(iterate, order[k], stepSize);
+      }
+    }
+
+    // Calculate the overall objective.
+    lastObjective = overallObjective;
+    overallObjective = 0;
+
+    #pragma omp parallel for reduction(+:overallObjective)
+    for (omp_size_t i = 0; i < (omp_size_t) numRatings; ++i)
+      overallObjective += function.Evaluate(iterate, i);
+
+    Log::Info << "Stratified SGD: epoch " << epoch << ", objective "
+        << overallObjective << "." << std::endl;
+
+    if (std::isnan(overallObjective) || std::isinf(overallObjective))
+    {
+      Log::Warn << "Stratified SGD: converged to " << overallObjective
+          << "; terminating with failure.  Try a smaller step size?"
+          << std::endl;
+      return overallObjective;
+    }
+
+    if (std::abs(lastObjective - overallObjective) < tolerance)
+    {
+      Log::Info << "Stratified SGD: minimized within tolerance " << tolerance
+          << "; terminating optimization." << std::endl;
+      return overallObjective;
+    }
+  }
+
+  Log::Info << "Stratified SGD: maximum epochs (" << maxEpochs << ") reached; "
+      << "terminating optimization." << std::endl;
+  return overallObjective;
+}
+
+} // namespace svd
+} // namespace mlpack
+
+#endif
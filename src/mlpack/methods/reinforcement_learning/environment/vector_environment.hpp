@@ -0,0 +1,145 @@
+/**
+ * @file vector_environment.hpp
+ *
+ * Wrapper that steps several copies of an RL environment in lockstep.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_ENVIRONMENT_VECTOR_ENVIRONMENT_HPP
+#define MLPACK_METHODS_RL_ENVIRONMENT_VECTOR_ENVIRONMENT_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace rl {
+
+/**
+ * Wrapper that holds several copies of an environment and advances them in
+ * lockstep. The encoded states of all the copies are kept as the columns of
+ * one matrix, so that an agent can evaluate its network once for all the
+ * copies instead of once per copy. A copy that reaches a terminal state is
+ * not stepped any more until the next call to Reset().
+ *
+ * @tparam EnvironmentType A type of Environment that is being wrapped.
+ */
+template <typename EnvironmentType>
+class VectorEnvironment
+{
+ public:
+  //! Convenient typedef for state.
+  using State = typename EnvironmentType::State;
+
+  //! Convenient typedef for action.
+  using Action = typename EnvironmentType::Action;
+
+  /**
+   * Construct the wrapper with the given number of copies of the given
+   * environment.
+   *
+   * @param numEnvironments Number of environments to step in lockstep.
+   * @param environment The environment to copy.
+   */
+  VectorEnvironment(const size_t numEnvironments,
+                    const EnvironmentType& environment = EnvironmentType()) :
+      environments(numEnvironments, environment),
+      states(numEnvironments),
+      previousStates(numEnvironments),
+      active(numEnvironments, false)
+  {
+    // Nothing to do here.
+  }
+
+  /**
+   * Draw an initial state for every environment and mark all of them as
+   * active.
+   */
+  void Reset()
+  {
+    for (size_t i = 0; i < environments.size(); ++i)
+    {
+      states[i] = environments[i].InitialSample();
+      active[i] = !environments[i].IsTerminal(states[i]);
+
+      const arma::colvec encoded = states[i].Encode();
+      if (i == 0)
+        encodedStates.set_size(encoded.n_elem, environments.size());
+      encodedStates.col(i) = encoded;
+    }
+  }
+
+  /**
+   * Advance every active environment with its action. The rewards of the
+   * environments that are not active any more are set to zero.
+   *
+   * @param actions The action of each environment.
+   * @param rewards The reward of each environment.
+   */
+  void Step(const std::vector<Action>& actions, arma::colvec& rewards)
+  {
+    rewards.zeros(environments.size());
+    for (size_t i = 0; i < environments.size(); ++i)
+    {
+      if (!active[i])
+        continue;
+
+      previousStates[i] = states[i];
+      rewards[i] = environments[i].Sample(previousStates[i], actions[i],
+          states[i]);
+      encodedStates.col(i) = states[i].Encode();
+      active[i] = !environments[i].IsTerminal(states[i]);
+    }
+  }
+
+  //! Check whether every environment has reached a terminal state.
+  bool Done() const
+  {
+    return std::find(active.begin(), active.end(), true) == active.end();
+  }
+
+  //! Get the number of environments.
+  size_t NumEnvironments() const { return environments.size(); }
+
+  //! Get the current states of the environments.
+  const std::vector<State>& States() const { return states; }
+
+  //! Get the states of the environments before the last step.
+  const std::vector<State>& PreviousStates() const { return previousStates; }
+
+  //! Get the encoded current states, one column per environment.
+  const arma::mat& EncodedStates() const { return encodedStates; }
+
+  //! Get the flags indicating which environments are still running.
+  const std::vector<bool>& Active() const { return active; }
+
+  //! Get the given environment.
+  const EnvironmentType& Environment(const size_t i) const
+  {
+    return environments[i];
+  }
+  //! Modify the given environment.
+  EnvironmentType& Environment(const size_t i) { return environments[i]; }
+
+ private:
+  //! Locally-stored copies of the environment.
+  std::vector<EnvironmentType> environments;
+
+  //! Locally-stored current states.
+  std::vector<State> states;
+
+  //! Locally-stored states before the last step.
+  std::vector<State> previousStates;
+
+  //! Locally-stored encoded current states.
+  arma::mat encodedStates;
+
+  //! Locally-stored flags indicating which environments are running.
+  std::vector<bool> active;
+};
+
+} // namespace rl
+} // namespace mlpack
+
+#endif
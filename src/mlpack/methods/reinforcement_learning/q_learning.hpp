@@ -16,6 +16,8 @@
 #include <mlpack/prereqs.hpp>
 
 #include "replay/random_replay.hpp"
+#include "environment/vector_environment.hpp"
+#include "replay/prioritized_replay.hpp"
 #include "training_config.hpp"
 
 namespace mlpack {
@@ -95,6 +97,17 @@ class QLearning
    */
   double Episode();
 
+  /**
+   * Execute one episode in each of the given environments, stepping them in
+   * lockstep. The actions of all the running environments are computed by a
+   * single batched forward pass, the transitions of a step are all stored at
+   * once, and one replay update is performed per lockstep step.
+   *
+   * @param environments The environments to run.
+   * @return Return of the episode of each environment.
+   */
+  arma::colvec VectorEpisode(VectorEnvironment<EnvironmentType>& environments);
+
   /**
    * @return Total steps from beginning.
    */
@@ -128,6 +141,18 @@ class QLearning
    */
   arma::Col<size_t> BestAction(const arma::mat& actionValues);
 
+  /**
+   * Sample a batch from the replay method and update the learning network
+   * with it.
+   */
+  void TrainAgent();
+
+  /**
+   * Count one environment step: synchronize the target network and anneal
+   * the policy when needed.
+   */
+  void CountStep();
+
   //! Locally-stored hyper-parameters.
   TrainingConfig config;
 
@@ -115,6 +115,26 @@ double QLearning<
   if (deterministic || totalSteps < config.ExplorationSteps())
     return reward;
 
+  TrainAgent();
+
+  return reward;
+}
+
+template <
+  typename EnvironmentType,
+  typename NetworkType,
+  typename UpdaterType,
+  typename BehaviorPolicyType,
+  typename ReplayType
+>
+void QLearning<
+  EnvironmentType,
+  NetworkType,
+  UpdaterType,
+  BehaviorPolicyType,
+  ReplayType
+>::TrainAgent()
+{
   // Start experience replay.
 
   // Sample from previous experience.
@@ -146,6 +166,7 @@ double QLearning<
   // Compute the update target.
   arma::mat target;
   learningNetwork.Forward(sampledStates, target);
+  const arma::mat sampledActionValues = target;
   /**
    * If the agent is at a terminal state, then we don't need to add the
    * discounted reward. At terminal state, the agent wont perform any
@@ -160,12 +181,38 @@ double QLearning<
           nextActionValues(bestActions[i], i);
   }
 
+  // Feed the temporal difference errors back to the replay method.
+  replayMethod.Update(target, sampledActions, sampledActionValues);
+
   // Learn form experience.
   arma::mat gradients;
   learningNetwork.Backward(target, gradients);
   updater.Update(learningNetwork.Parameters(), config.StepSize(), gradients);
+}
 
-  return reward;
+template <
+  typename EnvironmentType,
+  typename NetworkType,
+  typename UpdaterType,
+  typename BehaviorPolicyType,
+  typename ReplayType
+>
+void QLearning<
+  EnvironmentType,
+  NetworkType,
+  UpdaterType,
+  BehaviorPolicyType,
+  ReplayType
+>::CountStep()
+{
+  totalSteps++;
+
+  // Update target network
+  if (totalSteps % config.TargetNetworkSyncInterval() == 0)
+    targetNetwork = learningNetwork;
+
+  if (totalSteps > config.ExplorationSteps())
+    policy.Anneal();
 }
 
 template <
@@ -204,17 +251,80 @@ double QLearning<
     if (deterministic)
       continue;
 
-    totalSteps++;
+    CountStep();
+  }
 
-    // Update target network
-    if (totalSteps % config.TargetNetworkSyncInterval() == 0)
-      targetNetwork = learningNetwork;
+  return totalReturn;
+}
+
+template <
+  typename EnvironmentType,
+  typename NetworkType,
+  typename UpdaterType,
+  typename BehaviorPolicyType,
+  typename ReplayType
+>
+arma::colvec QLearning<
+  EnvironmentType,
+  NetworkType,
+  UpdaterType,
+  BehaviorPolicyType,
+  ReplayType
+>::VectorEpisode(VectorEnvironment<EnvironmentType>& environments)
+{
+  const size_t numEnvironments = environments.NumEnvironments();
+  environments.Reset();
 
-    if (totalSteps > config.ExplorationSteps())
-      policy.Anneal();
+  // Track the steps in this episode.
+  size_t steps = 0;
+
+  // Track the return of the episode of each environment.
+  arma::colvec totalReturns(numEnvironments, arma::fill::zeros);
+
+  arma::mat actionValues;
+  arma::colvec rewards;
+  std::vector<ActionType> actions(numEnvironments);
+  std::vector<bool> stepped;
+
+  // Running until all the environments get to a terminal state.
+  while (!environments.Done())
+  {
+    if (config.StepLimit() && steps >= config.StepLimit())
+      break;
+
+    // Get the action values of all the environments in one forward pass.
+    learningNetwork.Predict(environments.EncodedStates(), actionValues);
+
+    stepped = environments.Active();
+    for (size_t i = 0; i < numEnvironments; ++i)
+    {
+      if (stepped[i])
+        actions[i] = policy.Sample(actionValues.col(i), deterministic);
+    }
+
+    environments.Step(actions, rewards);
+    totalReturns += rewards;
+    steps++;
+
+    if (deterministic)
+      continue;
+
+    // Store the transitions of all the environments that were stepped.
+    for (size_t i = 0; i < numEnvironments; ++i)
+    {
+      if (!stepped[i])
+        continue;
+
+      replayMethod.Store(environments.PreviousStates()[i], actions[i],
+          rewards[i], environments.States()[i], !environments.Active()[i]);
+      CountStep();
+    }
+
+    if (totalSteps >= config.ExplorationSteps())
+      TrainAgent();
   }
 
-  return totalReturn;
+  return totalReturns;
 }
 
 } // namespace rl
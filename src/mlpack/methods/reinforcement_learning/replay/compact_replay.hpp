@@ -0,0 +1,254 @@
+/**
+ * @file compact_replay.hpp
+ *
+ * This file is an implementation of random experience replay that stores
+ * every state only once.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_REPLAY_COMPACT_REPLAY_HPP
+#define MLPACK_METHODS_RL_REPLAY_COMPACT_REPLAY_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace rl {
+
+/**
+ * Implementation of random experience replay with compact storage.
+ *
+ * RandomReplay stores the state and the next state of every transition, so
+ * during an episode every state is stored twice. This class keeps a single
+ * ring buffer of states: slot i holds the state reached by a transition, and
+ * the state the transition started from is the one in slot i - 1. When the
+ * stored state does not continue the previous transition (the start of an
+ * episode), it is written to its own slot, which is never sampled as a
+ * transition. The states are stored in the given element type, e.g. float or
+ * unsigned char for image observations; they are converted back to double
+ * when sampled.
+ *
+ * Consecutive transitions of one episode take one slot each, so interleaving
+ * the transitions of several environments gives no saving.
+ *
+ * @tparam EnvironmentType Desired task.
+ * @tparam ElemType Element type used to store the encoded states.
+ */
+template <typename EnvironmentType, typename ElemType = float>
+class CompactReplay
+{
+ public:
+  //! Convenient typedef for action.
+  using ActionType = typename EnvironmentType::Action;
+
+  //! Convenient typedef for state.
+  using StateType = typename EnvironmentType::State;
+
+  /**
+   * Construct an instance of compact experience replay class.
+   *
+   * @param batchSize Number of examples returned at each sample.
+   * @param capacity Total memory size in terms of number of stored states
+   *        (at least 2).
+   * @param dimension The dimension of an encoded state.
+   */
+  CompactReplay(const size_t batchSize,
+                const size_t capacity,
+                const size_t dimension = StateType::dimension) :
+      batchSize(batchSize),
+      capacity(capacity),
+      position(0),
+      full(false),
+      states(dimension, capacity),
+      actions(capacity),
+      rewards(capacity),
+      isTerminal(capacity),
+      isTransition(capacity)
+  { /* Nothing to do here. */ }
+
+  /**
+   * Store the given experience. The state is only written when it does not
+   * continue the previously stored transition.
+   *
+   * @param state Given state.
+   * @param action Given action.
+   * @param reward Given reward.
+   * @param nextState Given next state.
+   * @param isEnd Whether next state is terminal state.
+   */
+  void Store(const StateType& state,
+             ActionType action,
+             double reward,
+             const StateType& nextState,
+             bool isEnd)
+  {
+    if (!ContinuesLast(state))
+    {
+      StoreState(state);
+      isTransition(Last()) = false;
+    }
+
+    StoreState(nextState);
+    const size_t last = Last();
+    actions(last) = action;
+    rewards(last) = reward;
+    isTerminal(last) = isEnd;
+    isTransition(last) = true;
+  }
+
+  /**
+   * Sample some experiences. The given matrices are only resized if they do
+   * not have the batch size already, and the states are written into them
+   * directly.
+   *
+   * @param sampledStates Sampled encoded states.
+   * @param sampledActions Sampled actions.
+   * @param sampledRewards Sampled rewards.
+   * @param sampledNextStates Sampled encoded next states.
+   * @param isTerminal Indicate whether corresponding next state is terminal
+   *        state.
+   */
+  void Sample(arma::mat& sampledStates,
+              arma::icolvec& sampledActions,
+              arma::colvec& sampledRewards,
+              arma::mat& sampledNextStates,
+              arma::icolvec& isTerminal)
+  {
+    const size_t upperBound = full ? capacity : position;
+
+    sampledStates.set_size(states.n_rows, batchSize);
+    sampledNextStates.set_size(states.n_rows, batchSize);
+    sampledActions.set_size(batchSize);
+    sampledRewards.set_size(batchSize);
+    isTerminal.set_size(batchSize);
+
+    for (size_t i = 0; i < batchSize; ++i)
+    {
+      // Draw slots until one holds a transition whose start is still stored.
+      size_t index;
+      do
+      {
+        index = math::RandInt(upperBound);
+      } while (!IsSampleable(index));
+
+      const size_t previous = (index == 0) ? capacity - 1 : index - 1;
+      CopyState(previous, sampledStates.colptr(i));
+      CopyState(index, sampledNextStates.colptr(i));
+      sampledActions(i) = actions(index);
+      sampledRewards(i) = rewards(index);
+      isTerminal(i) = this->isTerminal(index);
+    }
+  }
+
+  /**
+   * Update the sampled transitions with their new targets. Uniform replay has
+   * no priorities, so there is nothing to do.
+   *
+   * @param target Update target of the sampled transitions.
+   * @param sampledActions Actions of the sampled transitions.
+   * @param actionValues Current action values of the sampled states.
+   */
+  void Update(arma::mat& /* target */,
+              const arma::icolvec& /* sampledActions */,
+              const arma::mat& /* actionValues */)
+  { /* Nothing to do here. */ }
+
+  /**
+   * Get the number of stored states, including the episode starts.
+   *
+   * @return Actual used memory size
+   */
+  const size_t& Size()
+  {
+    return full ? capacity : position;
+  }
+
+ private:
+  //! Get the slot that was written last.
+  size_t Last() const { return (position == 0) ? capacity - 1 : position - 1; }
+
+  //! Check whether the given state is the last stored state.
+  bool ContinuesLast(const StateType& state) const
+  {
+    if (position == 0 && !full)
+      return false;
+
+    const arma::colvec encoded = state.Encode();
+    const ElemType* stored = states.colptr(Last());
+    for (size_t i = 0; i < states.n_rows; ++i)
+    {
+      if (stored[i] != static_cast<ElemType>(encoded[i]))
+        return false;
+    }
+
+    return true;
+  }
+
+  //! Write the given state into the next slot.
+  void StoreState(const StateType& state)
+  {
+    const arma::colvec encoded = state.Encode();
+    ElemType* stored = states.colptr(position);
+    for (size_t i = 0; i < states.n_rows; ++i)
+      stored[i] = static_cast<ElemType>(encoded[i]);
+
+    position++;
+    if (position == capacity)
+    {
+      full = true;
+      position = 0;
+    }
+  }
+
+  //! Check whether the given slot holds a transition that can be sampled.
+  bool IsSampleable(const size_t index) const
+  {
+    if (!isTransition(index))
+      return false;
+
+    // The start of the transition in the oldest slot has been overwritten.
+    return full ? (index != position) : (index != 0);
+  }
+
+  //! Copy the given stored state into the given column of a batch.
+  void CopyState(const size_t index, double* column) const
+  {
+    const ElemType* stored = states.colptr(index);
+    for (size_t i = 0; i < states.n_rows; ++i)
+      column[i] = static_cast<double>(stored[i]);
+  }
+
+  //! Locally-stored number of examples of each sample.
+  size_t batchSize;
+
+  //! Locally-stored total memory limit.
+  size_t capacity;
+
+  //! Indicate the position to store new state.
+  size_t position;
+
+  //! Locally-stored indicator that whether the memory is full or not
+  bool full;
+
+  //! Locally-stored encoded states, one per slot.
+  arma::Mat<ElemType> states;
+
+  //! Locally-stored actions leading to the state of each slot.
+  arma::icolvec actions;
+
+  //! Locally-stored rewards of the transition into each slot.
+  arma::colvec rewards;
+
+  //! Locally-stored termination information of each slot.
+  arma::icolvec isTerminal;
+
+  //! Locally-stored flags indicating which slots end a transition.
+  arma::icolvec isTransition;
+};
+
+} // namespace rl
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,269 @@
+/**
+ * @file prioritized_replay.hpp
+ *
+ * This file is an implementation of prioritized experience replay.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_REPLAY_PRIORITIZED_REPLAY_HPP
+#define MLPACK_METHODS_RL_REPLAY_PRIORITIZED_REPLAY_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "sumtree.hpp"
+
+namespace mlpack {
+namespace rl {
+
+/**
+ * Implementation of prioritized experience replay.
+ *
+ * Transitions are sampled with probability proportional to p_i^alpha, where
+ * p_i is the magnitude of the last temporal difference error of transition
+ * i. New transitions get the largest priority seen so far, so that every
+ * transition is replayed at least once. The priorities live in a sum tree,
+ * so updating a priority and drawing a sample both take O(log n) time.
+ * A batch is drawn by stratified sampling: the total priority mass is split
+ * into batchSize equal segments, and one transition is drawn from each.
+ *
+ * The resulting bias is corrected with the importance sampling weights
+ * (N * P(i))^-beta, normalized by the largest weight of the batch; beta is
+ * annealed linearly to 1 over the given number of samples.
+ *
+ * For more information, see the following.
+ *
+ * @code
+ * @article{schaul2015prioritized,
+ *  title   = {Prioritized Experience Replay},
+ *  author  = {Schaul, Tom and Quan, John and Antonoglou, Ioannis and
+ *             Silver, David},
+ *  journal = {arXiv preprint arXiv:1511.05952},
+ *  year    = {2015}
+ * }
+ * @endcode
+ *
+ * @tparam EnvironmentType Desired task.
+ */
+template <typename EnvironmentType>
+class PrioritizedReplay
+{
+ public:
+  //! Convenient typedef for action.
+  using ActionType = typename EnvironmentType::Action;
+
+  //! Convenient typedef for state.
+  using StateType = typename EnvironmentType::State;
+
+  /**
+   * Construct an instance of prioritized experience replay class.
+   *
+   * @param batchSize Number of examples returned at each sample.
+   * @param capacity Total memory size in terms of number of examples.
+   * @param alpha How much prioritization is used (0 is uniform sampling).
+   * @param beta Initial exponent of the importance sampling weights.
+   * @param betaSteps Number of samples over which beta is annealed to 1.
+   * @param epsilon Small constant added to the priorities, so that no
+   *        transition becomes impossible to sample.
+   * @param dimension The dimension of an encoded state.
+   */
+  PrioritizedReplay(const size_t batchSize,
+                    const size_t capacity,
+                    const double alpha = 0.6,
+                    const double beta = 0.4,
+                    const size_t betaSteps = 10000,
+                    const double epsilon = 1e-6,
+                    const size_t dimension = StateType::dimension) :
+      batchSize(batchSize),
+      capacity(capacity),
+      position(0),
+      alpha(alpha),
+      beta(beta),
+      betaIncrement(betaSteps == 0 ? 0 : (1.0 - beta) / betaSteps),
+      epsilon(epsilon),
+      maxPriority(1.0),
+      priorities(capacity),
+      states(dimension, capacity),
+      actions(capacity),
+      rewards(capacity),
+      nextStates(dimension, capacity),
+      isTerminal(capacity),
+      full(false)
+  { /* Nothing to do here. */ }
+
+  /**
+   * Store the given experience with the largest priority seen so far.
+   *
+   * @param state Given state.
+   * @param action Given action.
+   * @param reward Given reward.
+   * @param nextState Given next state.
+   * @param isEnd Whether next state is terminal state.
+   */
+  void Store(const StateType& state,
+             ActionType action,
+             double reward,
+             const StateType& nextState,
+             bool isEnd)
+  {
+    states.col(position) = state.Encode();
+    actions(position) = action;
+    rewards(position) = reward;
+    nextStates.col(position) = nextState.Encode();
+    isTerminal(position) = isEnd;
+    priorities.Set(position, std::pow(maxPriority, alpha));
+    position++;
+    if (position == capacity)
+    {
+      full = true;
+      position = 0;
+    }
+  }
+
+  /**
+   * Sample some experiences by stratified sampling of the priorities. The
+   * sampled indices and their importance sampling weights are kept for the
+   * following call to Update().
+   *
+   * @param sampledStates Sampled encoded states.
+   * @param sampledActions Sampled actions.
+   * @param sampledRewards Sampled rewards.
+   * @param sampledNextStates Sampled encoded next states.
+   * @param isTerminal Indicate whether corresponding next state is terminal
+   *        state.
+   */
+  void Sample(arma::mat& sampledStates,
+              arma::icolvec& sampledActions,
+              arma::colvec& sampledRewards,
+              arma::mat& sampledNextStates,
+              arma::icolvec& isTerminal)
+  {
+    const double total = priorities.Sum();
+    const double segment = total / batchSize;
+    const arma::colvec offsets = arma::randu<arma::colvec>(batchSize);
+
+    sampledIndices.set_size(batchSize);
+    weights.set_size(batchSize);
+    for (size_t i = 0; i < batchSize; ++i)
+    {
+      sampledIndices[i] = priorities.FindPrefixSum((i + offsets[i]) *
+          segment);
+      weights[i] = priorities.Get(sampledIndices[i]) / total;
+    }
+
+    // Weights (N * P(i))^-beta, normalized so that the largest one is 1.
+    weights = arma::pow((double) Size() * weights, -beta);
+    weights /= weights.max();
+    beta = std::min(1.0, beta + betaIncrement);
+
+    sampledStates = states.cols(sampledIndices);
+    sampledActions = actions.elem(sampledIndices);
+    sampledRewards = rewards.elem(sampledIndices);
+    sampledNextStates = nextStates.cols(sampledIndices);
+    isTerminal = this->isTerminal.elem(sampledIndices);
+  }
+
+  /**
+   * Update the priorities of the last sampled transitions with their
+   * temporal difference errors, and scale those errors in the target by the
+   * importance sampling weights.
+   *
+   * @param target Update target of the sampled transitions; the entries of
+   *        the sampled actions are moved towards the current action values.
+   * @param sampledActions Actions of the sampled transitions.
+   * @param actionValues Current action values of the sampled states.
+   */
+  void Update(arma::mat& target,
+              const arma::icolvec& sampledActions,
+              const arma::mat& actionValues)
+  {
+    for (size_t i = 0; i < sampledIndices.n_elem; ++i)
+    {
+      const double prediction = actionValues(sampledActions[i], i);
+      const double tdError = target(sampledActions[i], i) - prediction;
+      const double priority = std::fabs(tdError) + epsilon;
+
+      priorities.Set(sampledIndices[i], std::pow(priority, alpha));
+      maxPriority = std::max(maxPriority, priority);
+
+      target(sampledActions[i], i) = prediction + weights[i] * tdError;
+    }
+  }
+
+  /**
+   * Get the number of transitions in the memory.
+   *
+   * @return Actual used memory size
+   */
+  const size_t& Size()
+  {
+    return full ? capacity : position;
+  }
+
+  //! Get the importance sampling weights of the last sample.
+  const arma::colvec& Weights() const { return weights; }
+
+  //! Get the indices of the last sampled transitions.
+  const arma::uvec& SampledIndices() const { return sampledIndices; }
+
+  //! Get the current importance sampling exponent.
+  double Beta() const { return beta; }
+
+ private:
+  //! Locally-stored number of examples of each sample.
+  size_t batchSize;
+
+  //! Locally-stored total memory limit.
+  size_t capacity;
+
+  //! Indicate the position to store new transition.
+  size_t position;
+
+  //! Locally-stored prioritization exponent.
+  double alpha;
+
+  //! Locally-stored importance sampling exponent.
+  double beta;
+
+  //! Locally-stored increment of beta at each sample.
+  double betaIncrement;
+
+  //! Locally-stored constant added to the priorities.
+  double epsilon;
+
+  //! Locally-stored largest priority seen so far.
+  double maxPriority;
+
+  //! Locally-stored priorities (raised to alpha) of the transitions.
+  SumTree<double> priorities;
+
+  //! Locally-stored indices of the last sampled transitions.
+  arma::uvec sampledIndices;
+
+  //! Locally-stored importance sampling weights of the last sample.
+  arma::colvec weights;
+
+  //! Locally-stored encoded previous states.
+  arma::mat states;
+
+  //! Locally-stored previous actions.
+  arma::icolvec actions;
+
+  //! Locally-stored previous rewards.
+  arma::colvec rewards;
+
+  //! Locally-stored encoded previous next states.
+  arma::mat nextStates;
+
+  //! Locally-stored termination information of previous experience.
+  arma::icolvec isTerminal;
+
+  //! Locally-stored indicator that whether the memory is full or not
+  bool full;
+};
+
+} // namespace rl
+} // namespace mlpack
+
+#endif
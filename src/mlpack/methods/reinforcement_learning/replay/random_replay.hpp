@@ -125,6 +125,19 @@ class RandomReplay
     isTerminal = this->isTerminal.elem(sampledIndices);
   }
 
+  /**
+   * Update the sampled transitions with their new targets. Uniform replay has
+   * no priorities, so there is nothing to do.
+   *
+   * @param target Update target of the sampled transitions.
+   * @param sampledActions Actions of the sampled transitions.
+   * @param actionValues Current action values of the sampled states.
+   */
+  void Update(arma::mat& /* target */,
+              const arma::icolvec& /* sampledActions */,
+              const arma::mat& /* actionValues */)
+  { /* Nothing to do here. */ }
+
   /**
    * Get the number of transitions in the memory.
    *
@@ -0,0 +1,120 @@
+/**
+ * @file sumtree.hpp
+ *
+ * This file is an implementation of a sum tree, used to sample indices with
+ * probability proportional to their priority.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_REPLAY_SUMTREE_HPP
+#define MLPACK_METHODS_RL_REPLAY_SUMTREE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace rl {
+
+/**
+ * Implementation of a sum tree (a segment tree whose nodes hold the sum of
+ * their children). The leaves hold non-negative values; setting a value and
+ * finding the leaf at which a given prefix sum is reached both take
+ * O(log n) time.
+ *
+ * The tree is stored implicitly in a contiguous array: the root is at index
+ * 1 and the children of node i are at 2i and 2i + 1.
+ *
+ * @tparam T The type of the stored values.
+ */
+template<typename T = double>
+class SumTree
+{
+ public:
+  /**
+   * Construct a sum tree with the given number of leaves, all set to zero.
+   *
+   * @param capacity Number of leaves.
+   */
+  SumTree(const size_t capacity = 1) :
+      capacity(capacity),
+      leaves(1)
+  {
+    while (leaves < capacity)
+      leaves *= 2;
+
+    tree.zeros(2 * leaves);
+  }
+
+  /**
+   * Set the value of the given leaf and update the sums on its path to the
+   * root.
+   *
+   * @param index Index of the leaf.
+   * @param value New non-negative value.
+   */
+  void Set(const size_t index, const T value)
+  {
+    size_t node = index + leaves;
+    tree[node] = value;
+    for (node /= 2; node >= 1; node /= 2)
+      tree[node] = tree[2 * node] + tree[2 * node + 1];
+  }
+
+  /**
+   * Get the value of the given leaf.
+   *
+   * @param index Index of the leaf.
+   */
+  T Get(const size_t index) const { return tree[index + leaves]; }
+
+  //! Get the sum of all the values.
+  T Sum() const { return tree[1]; }
+
+  /**
+   * Find the smallest leaf index such that the sum of the values up to and
+   * including that leaf exceeds the given mass. Empty subtrees are never
+   * entered, so rounding errors cannot select a zero leaf.
+   *
+   * @param mass Prefix sum to search for, in [0, Sum()).
+   * @return Index of the found leaf.
+   */
+  size_t FindPrefixSum(T mass) const
+  {
+    size_t node = 1;
+    while (node < leaves)
+    {
+      const size_t left = 2 * node;
+      if (mass < tree[left] || tree[left + 1] == 0)
+      {
+        node = left;
+      }
+      else
+      {
+        mass -= tree[left];
+        node = left + 1;
+      }
+    }
+
+    return std::min(node - leaves, capacity - 1);
+  }
+
+  //! Get the number of leaves.
+  size_t Capacity() const { return capacity; }
+
+ private:
+  //! Locally-stored number of leaves.
+  size_t capacity;
+
+  //! Locally-stored number of leaves rounded up to a power of two.
+  size_t leaves;
+
+  //! Locally-stored values of the nodes.
+  arma::Col<T> tree;
+};
+
+} // namespace rl
+} // namespace mlpack
+
+#endif
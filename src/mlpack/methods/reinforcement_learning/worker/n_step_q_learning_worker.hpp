@@ -13,6 +13,8 @@
 #ifndef MLPACK_METHODS_RL_WORKER_N_STEP_Q_LEARNING_WORKER_HPP
 #define MLPACK_METHODS_RL_WORKER_N_STEP_Q_LEARNING_WORKER_HPP
 
+#include <atomic>
+
 #include <mlpack/methods/reinforcement_learning/training_config.hpp>
 
 namespace mlpack {
@@ -68,15 +70,26 @@ class NStepQLearningWorker
   {
     updater.Initialize(learningNetwork.Parameters().n_rows,
         learningNetwork.Parameters().n_cols);
-    // Build local network.
+    // Build the local networks. Their layers are linked to their own
+    // parameters, so later syncs with the shared network only copy the
+    // parameters instead of the whole network.
     network = learningNetwork;
+    network.ResetParameters();
+    network.Parameters() = learningNetwork.Parameters();
+    targetNetwork = network;
+    targetNetwork.ResetParameters();
+    targetNetwork.Parameters() = learningNetwork.Parameters();
+    targetSyncs = 0;
   }
 
   /**
    * The agent will execute one step.
    *
+   * The shared learning network is updated without locking (Hogwild!), and
+   * the target network is a local snapshot of it that is refreshed once per
+   * target network sync interval of the shared step counter.
+   *
    * @param learningNetwork The shared learning network.
-   * @param targetNetwork The shared target network.
    * @param totalSteps The shared counter for total steps.
    * @param policy The shared behavior policy.
    * @param totalReward This will be the episode return if the episode ends
@@ -84,8 +97,7 @@ class NStepQLearningWorker
    * @return Indicate whether current episode ends after this step.
    */
   bool Step(NetworkType& learningNetwork,
-            NetworkType& targetNetwork,
-            size_t& totalSteps,
+            std::atomic<size_t>& totalSteps,
             PolicyType& policy,
             double& totalReward)
   {
@@ -108,15 +120,14 @@ class NStepQLearningWorker
         totalReward = episodeReturn;
         Reset();
         // Sync with latest learning network.
-        network = learningNetwork;
+        network.Parameters() = learningNetwork.Parameters();
         return true;
       }
       state = nextState;
       return false;
     }
 
-    #pragma omp atomic
-    totalSteps++;
+    const size_t currentSteps = ++totalSteps;
 
     pending[pendingIndex] = std::make_tuple(state, action, reward, nextState);
     pendingIndex++;
@@ -132,8 +143,7 @@ class NStepQLearningWorker
       double target = 0;
       if (!terminal)
       {
-        #pragma omp critical
-        { targetNetwork.Predict(nextState.Encode(), actionValue); };
+        targetNetwork.Predict(nextState.Encode(), actionValue);
         target = actionValue.max();
       }
 
@@ -166,16 +176,18 @@ class NStepQLearningWorker
           config.StepSize(), totalGradients);
 
       // Sync the local network with the global network.
-      network = learningNetwork;
+      network.Parameters() = learningNetwork.Parameters();
 
       pendingIndex = 0;
     }
 
-    // Update global target network.
-    if (totalSteps % config.TargetNetworkSyncInterval() == 0)
+    // Refresh the local target network once the shared step counter enters
+    // a new sync interval.
+    const size_t syncs = currentSteps / config.TargetNetworkSyncInterval();
+    if (syncs != targetSyncs)
     {
-      #pragma omp critical
-      { targetNetwork = learningNetwork; }
+      targetNetwork.Parameters() = learningNetwork.Parameters();
+      targetSyncs = syncs;
     }
 
     policy.Anneal();
@@ -229,6 +241,12 @@ class NStepQLearningWorker
   //! Local network of the worker.
   NetworkType network;
 
+  //! Local snapshot of the target network.
+  NetworkType targetNetwork;
+
+  //! Number of target network syncs the local snapshot corresponds to.
+  size_t targetSyncs;
+
   //! Current state of the agent.
   StateType state;
 };
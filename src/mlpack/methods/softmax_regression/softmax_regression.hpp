@@ -14,6 +14,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <ensmallen.hpp>
+#include <mlpack/core/cv/warm_start.hpp>
 
 #include "softmax_regression_function.hpp"
 
@@ -215,6 +216,40 @@ class SoftmaxRegression
 };
 
 } // namespace regression
+
+namespace cv {
+
+/**
+ * The objective of SoftmaxRegression is convex, and Train() starts from the
+ * current parameters, so it can be warm-started (for instance along a path of
+ * values of lambda).
+ */
+template<>
+class WarmStart<regression::SoftmaxRegression>
+{
+ public:
+  static const bool IsSupported = true;
+
+  static bool Train(regression::SoftmaxRegression& model,
+                    const arma::mat& xs,
+                    const arma::Row<size_t>& ys,
+                    const size_t numClasses,
+                    const double lambda = 0.0001,
+                    const bool fitIntercept = false)
+  {
+    if (model.NumClasses() != numClasses ||
+        model.FitIntercept() != fitIntercept ||
+        model.Parameters().n_rows != numClasses ||
+        model.FeatureSize() != xs.n_rows)
+      return false;
+
+    model.Lambda() = lambda;
+    model.Train(xs, ys, numClasses);
+    return true;
+  }
+};
+
+} // namespace cv
 } // namespace mlpack
 
 // Include implementation.
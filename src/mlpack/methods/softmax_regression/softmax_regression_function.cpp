@@ -11,6 +11,7 @@
  */
 #include "softmax_regression_function.hpp"
 #include <mlpack/core/math/make_alias.hpp>
+#include <mlpack/core/math/shuffle_data.hpp>
 
 using namespace mlpack;
 using namespace mlpack::regression;
@@ -22,15 +23,13 @@ SoftmaxRegressionFunction::SoftmaxRegressionFunction(
     const double lambda,
     const bool fitIntercept) :
     data(math::MakeAlias(const_cast<arma::mat&>(data), false)),
+    labels(labels),
     numClasses(numClasses),
     lambda(lambda),
     fitIntercept(fitIntercept)
 {
   // Initialize the parameters to suitable values.
   initialPoint = InitializeWeights();
-
-  // Calculate the label matrix.
-  GetGroundTruthMatrix(labels, groundTruth);
 }
 
 /**
@@ -38,36 +37,17 @@ SoftmaxRegressionFunction::SoftmaxRegressionFunction(
  */
 void SoftmaxRegressionFunction::Shuffle()
 {
-  // Determine new ordering.
-  arma::uvec ordering = arma::shuffle(arma::linspace<arma::uvec>(0,
-      data.n_cols - 1, data.n_cols));
-
-  // Re-sort data.
-  arma::mat newData = data.cols(ordering);
-  math::ClearAlias(data);
-  data = std::move(newData);
-
-  // Assemble data for batch constructor.  We need reverse orderings though...
-  arma::uvec reverseOrdering(ordering.n_elem);
-  for (size_t i = 0; i < ordering.n_elem; ++i)
-    reverseOrdering[ordering[i]] = i;
+  arma::mat newData;
+  arma::Row<size_t> newLabels;
 
-  arma::umat newLocations(2, groundTruth.n_nonzero);
-  arma::vec values(groundTruth.n_nonzero);
-  arma::sp_mat::const_iterator it = groundTruth.begin();
-  size_t loc = 0;
-  while (it != groundTruth.end())
-  {
-    newLocations(0, loc) = reverseOrdering(it.col());
-    newLocations(1, loc) = it.row();
-    values(loc) = (*it);
+  math::ShuffleData(data, labels, newData, newLabels);
 
-    ++it;
-    ++loc;
-  }
+  // If we are an alias, make sure we don't write to the original data.
+  math::ClearAlias(data);
 
-  groundTruth = arma::sp_mat(newLocations, values, groundTruth.n_rows,
-      groundTruth.n_cols);
+  // Take ownership of the new data.
+  data = std::move(newData);
+  labels = std::move(newLabels);
 }
 
 /**
@@ -153,29 +133,141 @@ void SoftmaxRegressionFunction::GetProbabilitiesMatrix(
     const size_t start,
     const size_t batchSize) const
 {
-  arma::mat hypothesis;
+  arma::mat scores;
 
   if (fitIntercept)
   {
     // In order to add the intercept term, we should compute following matrix:
     //     [1; data] = arma::join_cols(ones(1, data.n_cols), data)
-    //     hypothesis = arma::exp(parameters * [1; data]).
+    //     scores = parameters * [1; data].
     //
     // Since the cost of join may be high due to the copy of original data,
-    // split the hypothesis computation to two components.
-    hypothesis = arma::exp(
-        arma::repmat(parameters.col(0), 1, batchSize) +
+    // split the score computation to two components.
+    scores = arma::repmat(parameters.col(0), 1, batchSize) +
         parameters.cols(1, parameters.n_cols - 1) *
-        data.cols(start, start + batchSize - 1));
+        data.cols(start, start + batchSize - 1);
   }
   else
   {
-    hypothesis = arma::exp(parameters *
-        data.cols(start, start + batchSize - 1));
+    scores = parameters * data.cols(start, start + batchSize - 1);
+  }
+
+  // Subtracting the largest score of each point doesn't change the
+  // probabilities, but keeps exp() from overflowing.
+  scores.each_row() -= arma::max(scores, 0);
+  probabilities = arma::exp(scores);
+  probabilities.each_row() /= arma::sum(probabilities, 0);
+}
+
+/**
+ * Compute the scores of the points in [begin, begin + count), and the negative
+ * log likelihood of their labels.  If residuals is true, each column of scores
+ * is then turned into the residuals (probabilities - ground truth) of its
+ * point.
+ */
+double SoftmaxRegressionFunction::BlockResiduals(const arma::mat& parameters,
+                                                 const size_t begin,
+                                                 const size_t count,
+                                                 arma::mat& scores,
+                                                 const bool residuals) const
+{
+  // The weights (without the intercept) are contiguous columns of the
+  // parameters, as are the points of the block, so neither is copied.
+  const arma::mat weights(const_cast<double*>(parameters.colptr(
+      fitIntercept ? 1 : 0)), numClasses, data.n_rows, false, true);
+  const arma::mat block(const_cast<double*>(data.colptr(begin)), data.n_rows,
+      count, false, true);
+
+  scores = weights * block;
+  if (fitIntercept)
+    scores.each_col() += parameters.col(0);
+
+  // The log-sum-exp of each column is computed after subtracting its maximum,
+  // so that exp() can't overflow.
+  double loss = 0.0;
+  #pragma omp parallel for schedule(static) reduction(+:loss)
+  for (omp_size_t i = 0; i < (omp_size_t) count; ++i)
+  {
+    double* column = scores.colptr(i);
+    const size_t label = labels[begin + i];
+
+    double maxScore = column[0];
+    for (size_t j = 1; j < numClasses; ++j)
+      maxScore = std::max(maxScore, column[j]);
+
+    double sum = 0.0;
+    for (size_t j = 0; j < numClasses; ++j)
+      sum += std::exp(column[j] - maxScore);
+    const double logSum = maxScore + std::log(sum);
+
+    loss += logSum - column[label];
+
+    if (residuals)
+    {
+      for (size_t j = 0; j < numClasses; ++j)
+        column[j] = std::exp(column[j] - logSum);
+      column[label] -= 1.0;
+    }
   }
 
-  probabilities = hypothesis / arma::repmat(arma::sum(hypothesis, 0),
-                                            numClasses, 1);
+  return loss;
+}
+
+/**
+ * Compute the objective on the points in [start, start + batchSize), and the
+ * gradient if gradient is not NULL.
+ */
+double SoftmaxRegressionFunction::Objective(const arma::mat& parameters,
+                                            const size_t start,
+                                            const size_t batchSize,
+                                            arma::mat* gradient) const
+{
+  // The points are processed in blocks, so that only the scores of one block
+  // are held at a time; the gradient of a block is added with one matrix
+  // product.
+  const size_t blockSize = 256;
+
+  // With an intercept the gradient of the weights is accumulated separately,
+  // so that the product can be added in place.
+  arma::mat weightGradient;
+  if (gradient)
+  {
+    gradient->zeros(parameters.n_rows, parameters.n_cols);
+    if (fitIntercept)
+      weightGradient.zeros(numClasses, data.n_rows);
+  }
+  arma::mat* weightGradientPtr = fitIntercept ? &weightGradient : gradient;
+
+  double loss = 0.0;
+  arma::mat residuals;
+  for (size_t begin = start; begin < start + batchSize; begin += blockSize)
+  {
+    const size_t count = std::min(blockSize, start + batchSize - begin);
+    loss += BlockResiduals(parameters, begin, count, residuals,
+        gradient != NULL);
+
+    if (gradient)
+    {
+      const arma::mat block(const_cast<double*>(data.colptr(begin)),
+          data.n_rows, count, false, true);
+      (*weightGradientPtr) += residuals * block.t();
+      if (fitIntercept)
+        gradient->col(0) += arma::sum(residuals, 1);
+    }
+  }
+
+  if (gradient)
+  {
+    if (fitIntercept)
+      gradient->cols(1, parameters.n_cols - 1) = weightGradient;
+
+    (*gradient) /= batchSize;
+    (*gradient) += lambda * parameters;
+  }
+
+  // The cost is the sum of the negative log likelihood and the regularization
+  // terms.
+  return loss / batchSize + 0.5 * lambda * arma::dot(parameters, parameters);
 }
 
 /**
@@ -192,28 +284,10 @@ double SoftmaxRegressionFunction::Evaluate(const arma::mat& parameters) const
   // 'm' is the number of training examples.
   // The cost also takes into account the regularization to control the
   // parameter weights.
-
-  // Calculate the class probabilities for each training example. The
-  // probabilities for each of the classes are given by:
-  // p_j = exp(theta_j' * x_i) / sum(exp(theta_k' * x_i))
-  // The sum is calculated over all the classes.
-  // x_i is the input vector for a particular training example.
-  // theta_j is the parameter vector associated with a particular class.
-  arma::mat probabilities;
-  GetProbabilitiesMatrix(parameters, probabilities, 0, data.n_cols);
-
-  // Calculate the log likelihood and regularization terms.
-  double logLikelihood, weightDecay, cost;
-
-  logLikelihood = arma::accu(groundTruth % arma::log(probabilities)) /
-                  data.n_cols;
-  weightDecay = 0.5 * lambda * arma::accu(parameters % parameters);
-
-  // The cost is the sum of the negative log likelihood and the regularization
-  // terms.
-  cost = -logLikelihood + weightDecay;
-
-  return cost;
+  //
+  // Since only the label term of the sum is nonzero, the log likelihood of a
+  // point is just theta_{y_i}' * x_i - log(sum(exp(theta_k' * x_i))).
+  return Objective(parameters, 0, data.n_cols, NULL);
 }
 
 /**
@@ -223,17 +297,7 @@ double SoftmaxRegressionFunction::Evaluate(const arma::mat& parameters,
                                            const size_t start,
                                            const size_t batchSize) const
 {
-  arma::mat probabilities;
-  GetProbabilitiesMatrix(parameters, probabilities, start, batchSize);
-
-  // Calculate the log likelihood and regularization terms.
-  double logLikelihood, weightDecay;
-
-  logLikelihood = arma::accu(groundTruth.cols(start, start + batchSize - 1) %
-      arma::log(probabilities)) / batchSize;
-  weightDecay = 0.5 * lambda * arma::accu(parameters * parameters);
-
-  return -logLikelihood + weightDecay;
+  return Objective(parameters, start, batchSize, NULL);
 }
 
 /**
@@ -242,34 +306,10 @@ double SoftmaxRegressionFunction::Evaluate(const arma::mat& parameters,
 void SoftmaxRegressionFunction::Gradient(const arma::mat& parameters,
                                          arma::mat& gradient) const
 {
-  // Calculate the class probabilities for each training example. The
-  // probabilities for each of the classes are given by:
-  // p_j = exp(theta_j' * x_i) / sum(exp(theta_k' * x_i))
-  // The sum is calculated over all the classes.
-  // x_i is the input vector for a particular training example.
-  // theta_j is the parameter vector associated with a particular class.
-  arma::mat probabilities;
-  GetProbabilitiesMatrix(parameters, probabilities, 0, data.n_cols);
-
-  // Calculate the parameter gradients.
-  gradient.set_size(parameters.n_rows, parameters.n_cols);
-  if (fitIntercept)
-  {
-    // Treating the intercept term parameters.col(0) seperately to avoid
-    // the cost of building matrix [1; data].
-    arma::mat inner = probabilities - groundTruth;
-    gradient.col(0) =
-      inner * arma::ones<arma::mat>(data.n_cols, 1) / data.n_cols +
-      lambda * parameters.col(0);
-    gradient.cols(1, parameters.n_cols - 1) =
-      inner * data.t() / data.n_cols +
-      lambda * parameters.cols(1, parameters.n_cols - 1);
-  }
-  else
-  {
-    gradient = (probabilities - groundTruth) * data.t() / data.n_cols +
-               lambda * parameters;
-  }
+  // The gradient of the log likelihood of a point with respect to theta_j is
+  // (p_j - 1{y_i = j}) * x_i, where
+  // p_j = exp(theta_j' * x_i) / sum(exp(theta_k' * x_i)).
+  Objective(parameters, 0, data.n_cols, &gradient);
 }
 
 void SoftmaxRegressionFunction::Gradient(const arma::mat& parameters,
@@ -277,28 +317,23 @@ void SoftmaxRegressionFunction::Gradient(const arma::mat& parameters,
                                          arma::mat& gradient,
                                          const size_t batchSize) const
 {
-  arma::mat probabilities;
-  GetProbabilitiesMatrix(parameters, probabilities, start, batchSize);
+  Objective(parameters, start, batchSize, &gradient);
+}
 
-  // Calculate the parameter gradients.
-  gradient.set_size(parameters.n_rows, parameters.n_cols);
-  if (fitIntercept)
-  {
-    arma::mat inner = probabilities - groundTruth.cols(start, start +
-        batchSize - 1);
-    gradient.col(0) =
-        inner * arma::ones<arma::mat>(batchSize, 1) / batchSize +
-        lambda * parameters.col(0);
-    gradient.cols(1, parameters.n_cols - 1) =
-        inner * data.cols(start, start + batchSize - 1).t() / batchSize +
-        lambda * parameters.cols(1, parameters.n_cols - 1);
-  }
-  else
-  {
-    gradient = (probabilities - groundTruth.cols(start, start + batchSize - 1))
-        * data.cols(start, start + batchSize - 1).t() / batchSize
-        + lambda * parameters;
-  }
+double SoftmaxRegressionFunction::EvaluateWithGradient(
+    const arma::mat& parameters,
+    arma::mat& gradient) const
+{
+  return Objective(parameters, 0, data.n_cols, &gradient);
+}
+
+double SoftmaxRegressionFunction::EvaluateWithGradient(
+    const arma::mat& parameters,
+    const size_t start,
+    arma::mat& gradient,
+    const size_t batchSize) const
+{
+  return Objective(parameters, start, batchSize, &gradient);
 }
 
 void SoftmaxRegressionFunction::PartialGradient(const arma::mat& parameters,
@@ -307,28 +342,28 @@ void SoftmaxRegressionFunction::PartialGradient(const arma::mat& parameters,
 {
   gradient.zeros(arma::size(parameters));
 
-  arma::mat probabilities;
-  GetProbabilitiesMatrix(parameters, probabilities, 0, data.n_cols);
-
-  // Calculate the required part of the gradient.
-  arma::mat inner = probabilities - groundTruth;
-  if (fitIntercept)
+  // Calculate the required part of the gradient, one block of points at a
+  // time.  With an intercept, column 0 is the intercept and column j is
+  // feature j - 1.
+  const size_t blockSize = 256;
+  arma::vec partial(numClasses, arma::fill::zeros);
+  arma::mat residuals;
+  for (size_t begin = 0; begin < data.n_cols; begin += blockSize)
   {
-    if (j == 0)
+    const size_t count = std::min(blockSize, data.n_cols - begin);
+    BlockResiduals(parameters, begin, count, residuals, true);
+
+    if (fitIntercept && j == 0)
     {
-      gradient.col(j) =
-          inner * arma::ones<arma::mat>(data.n_cols, 1) / data.n_cols +
-          lambda * parameters.col(0);
+      partial += arma::sum(residuals, 1);
     }
     else
     {
-      gradient.col(j) = inner * data.row(j).t() / data.n_cols + lambda *
-          parameters.col(j);
+      const size_t feature = fitIntercept ? j - 1 : j;
+      partial += residuals * data.submat(feature, begin, feature,
+          begin + count - 1).t();
     }
   }
-  else
-  {
-    gradient.col(j) = inner * data.row(j).t() / data.n_cols + lambda *
-        parameters.col(j);
-  }
+
+  gradient.col(j) = partial / data.n_cols + lambda * parameters.col(j);
 }
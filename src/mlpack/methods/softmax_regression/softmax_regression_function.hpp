@@ -151,6 +151,32 @@ class SoftmaxRegressionFunction
                 arma::mat& gradient,
                 const size_t batchSize = 1) const;
 
+  /**
+   * Evaluate the objective function and its gradient given the current set of
+   * parameters, computing the class probabilities only once.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param gradient Matrix where gradient values will be stored.
+   * @return The objective function at the given parameters.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              arma::mat& gradient) const;
+
+  /**
+   * Evaluate the objective function and its gradient given the current set of
+   * parameters, on a subset of the data.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param start First index of the data points to use.
+   * @param gradient Matrix to store gradient into.
+   * @param batchSize Number of data points to evaluate for.
+   * @return The objective function on the given points.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              const size_t start,
+                              arma::mat& gradient,
+                              const size_t batchSize = 1) const;
+
   /**
    * Evaluates the gradient values of the objective function given the current
    * set of parameters for a single feature indexed by j.
@@ -184,11 +210,50 @@ class SoftmaxRegressionFunction
   //! Gets the intercept flag.
   bool FitIntercept() const { return fitIntercept; }
 
+  //! Return the number of separable functions (the number of data points).
+  size_t NumFunctions() const { return data.n_cols; }
+
  private:
+  /**
+   * Compute the class scores of a block of points and the negative log
+   * likelihood of their labels, with a stable log-sum-exp over the classes.
+   * If residuals is true, the scores are then replaced with the residuals
+   * (probabilities minus the one-hot labels) that the gradient is built from.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param begin Index of the first point of the block.
+   * @param count Number of points in the block.
+   * @param scores Matrix to store the scores (or residuals) in.
+   * @param residuals Whether to compute the residuals.
+   * @return The negative log likelihood of the block (not normalized).
+   */
+  double BlockResiduals(const arma::mat& parameters,
+                        const size_t begin,
+                        const size_t count,
+                        arma::mat& scores,
+                        const bool residuals) const;
+
+  /**
+   * Compute the objective on a batch of points, and its gradient if gradient
+   * is not NULL.  The batch is processed in fixed-size blocks, so the memory
+   * used does not grow with the number of points in the batch, and no
+   * one-hot label matrix is needed.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param start First index of the data points to use.
+   * @param batchSize Number of data points to use.
+   * @param gradient Matrix to store the gradient into, or NULL.
+   * @return The objective on the given points.
+   */
+  double Objective(const arma::mat& parameters,
+                   const size_t start,
+                   const size_t batchSize,
+                   arma::mat* gradient) const;
+
   //! Training data matrix.  This is an alias until the data is shuffled.
   arma::mat data;
-  //! Label matrix for the provided data.
-  arma::sp_mat groundTruth;
+  //! Labels of the training points.
+  arma::Row<size_t> labels;
   //! Initial parameter point.
   arma::mat initialPoint;
   //! Number of classes.
@@ -21,7 +21,7 @@ SparseAutoencoderFunction::SparseAutoencoderFunction(const arma::mat& data,
                                                      const double lambda,
                                                      const double beta,
                                                      const double rho) :
-    data(data),
+    data(math::MakeAlias(const_cast<arma::mat&>(data), false)),
     visibleSize(visibleSize),
     hiddenSize(hiddenSize),
     lambda(lambda),
@@ -71,9 +71,72 @@ const arma::mat SparseAutoencoderFunction::InitializeWeights()
   return parameters;
 }
 
+/**
+ * Shuffle the data.
+ */
+void SparseAutoencoderFunction::Shuffle()
+{
+  arma::mat newData = data.cols(arma::shuffle(arma::linspace<arma::uvec>(0,
+      data.n_cols - 1, data.n_cols)));
+  math::ClearAlias(data);
+  data = std::move(newData);
+}
+
 /** Evaluates the objective function given the parameters.
   */
 double SparseAutoencoderFunction::Evaluate(const arma::mat& parameters) const
+{
+  return EvaluateColumns(parameters, 0, data.n_cols, NULL);
+}
+
+/** Calculates and stores the gradient values given a set of parameters.
+  */
+void SparseAutoencoderFunction::Gradient(const arma::mat& parameters,
+                                         arma::mat& gradient) const
+{
+  EvaluateColumns(parameters, 0, data.n_cols, &gradient);
+}
+
+double SparseAutoencoderFunction::EvaluateWithGradient(
+    const arma::mat& parameters,
+    arma::mat& gradient) const
+{
+  return EvaluateColumns(parameters, 0, data.n_cols, &gradient);
+}
+
+double SparseAutoencoderFunction::Evaluate(const arma::mat& parameters,
+                                           const size_t begin,
+                                           const size_t batchSize) const
+{
+  return EvaluateColumns(parameters, begin, batchSize, NULL) * batchSize /
+      data.n_cols;
+}
+
+void SparseAutoencoderFunction::Gradient(const arma::mat& parameters,
+                                         const size_t begin,
+                                         arma::mat& gradient,
+                                         const size_t batchSize) const
+{
+  EvaluateColumns(parameters, begin, batchSize, &gradient);
+  gradient *= (double) batchSize / data.n_cols;
+}
+
+double SparseAutoencoderFunction::EvaluateWithGradient(
+    const arma::mat& parameters,
+    const size_t begin,
+    arma::mat& gradient,
+    const size_t batchSize) const
+{
+  const double cost = EvaluateColumns(parameters, begin, batchSize,
+      &gradient);
+  gradient *= (double) batchSize / data.n_cols;
+  return cost * batchSize / data.n_cols;
+}
+
+double SparseAutoencoderFunction::EvaluateColumns(const arma::mat& parameters,
+                                                  const size_t begin,
+                                                  const size_t batchSize,
+                                                  arma::mat* gradient) const
 {
   // The objective function is the average squared reconstruction error of the
   // network. w1 and b1 are the weights and biases associated with the hidden
@@ -82,45 +145,113 @@ double SparseAutoencoderFunction::Evaluate(const arma::mat& parameters) const
   // 'm' is the number of training examples.
   // The cost also takes into account the regularization and KL divergence terms
   // to control the parameter weights and sparsity of the model respectively.
+  //
+  // For the gradient, the Backpropagation algorithm is used to calculate the
+  // delta values at each layer, except for the input layer. The delta values
+  // are then used with input layer and hidden layer activations to get the
+  // parameter gradients.
 
   // Compute the limits for the parameters w1, w2, b1 and b2.
   const size_t l1 = hiddenSize;
   const size_t l2 = visibleSize;
   const size_t l3 = 2 * hiddenSize;
 
-  // w1, w2, b1 and b2 are not extracted separately, 'parameters' is directly
-  // used in their place to avoid copying data. The following representations
-  // are used:
+  // The following representations are used:
   // w1 <- parameters.submat(0, 0, l1-1, l2-1)
   // w2 <- parameters.submat(l1, 0, l3-1, l2-1).t()
   // b1 <- parameters.submat(0, l2, l1-1, l2)
   // b2 <- parameters.submat(l3, 0, l3, l2-1).t()
-
-  arma::mat hiddenLayer, outputLayer;
-
-  // Compute activations of the hidden and output layers.
-  Sigmoid(parameters.submat(0, 0, l1 - 1, l2 - 1) * data +
-      arma::repmat(parameters.submat(0, l2, l1 - 1, l2), 1, data.n_cols),
-      hiddenLayer);
-
-  Sigmoid(parameters.submat(l1, 0, l3 - 1, l2 - 1).t() * hiddenLayer +
-      arma::repmat(parameters.submat(l3, 0, l3, l2 - 1).t(), 1, data.n_cols),
-      outputLayer);
-
-  arma::mat rhoCap, diff;
+  // They are extracted once, since every block uses them.
+  const arma::mat w1 = parameters.submat(0, 0, l1 - 1, l2 - 1);
+  const arma::mat w2t = parameters.submat(l1, 0, l3 - 1, l2 - 1);
+  const arma::vec b1 = parameters.submat(0, l2, l1 - 1, l2);
+  const arma::vec b2 = parameters.submat(l3, 0, l3, l2 - 1).t();
+
+  // Split the columns into one contiguous block per thread.
+  #ifdef HAS_OPENMP
+  const size_t numBlocks = std::max((size_t) 1, std::min(
+      (size_t) omp_get_max_threads(), batchSize));
+  #else
+  const size_t numBlocks = 1;
+  #endif
+
+  std::vector<arma::mat> hiddenLayers(numBlocks);
+  arma::mat hiddenSums(hiddenSize, numBlocks);
+
+  // Compute the activations of the hidden layer.
+  #pragma omp parallel for
+  for (omp_size_t k = 0; k < (omp_size_t) numBlocks; ++k)
+  {
+    const size_t first = begin + k * batchSize / numBlocks;
+    const size_t last = begin + (k + 1) * batchSize / numBlocks - 1;
+
+    arma::mat& hiddenLayer = hiddenLayers[k];
+    hiddenLayer = w1 * data.cols(first, last);
+    hiddenLayer.each_col() += b1;
+    Sigmoid(hiddenLayer, hiddenLayer);
+    hiddenSums.col(k) = arma::sum(hiddenLayer, 1);
+  }
 
   // Average activations of the hidden layer.
-  rhoCap = arma::sum(hiddenLayer, 1) / data.n_cols;
-  // Difference between the reconstructed data and the original data.
-  diff = outputLayer - data;
+  const arma::vec rhoCap = arma::sum(hiddenSums, 1) / batchSize;
 
-  double wL2SquaredNorm;
-
-  // Calculate squared L2-norms of w1 and w2.
-  wL2SquaredNorm = arma::accu(parameters.submat(0, 0, l3 - 1, l2 - 1) %
-      parameters.submat(0, 0, l3 - 1, l2 - 1));
-
-  double sumOfSquaresError, weightDecay, klDivergence, cost;
+  // The delta vector for the output layer is given by diff * f'(z), where z is
+  // the preactivation and f is the activation function. The derivative of the
+  // sigmoid function turns out to be f(z) * (1 - f(z)). For every other layer
+  // in the neural network which comes before the output layer, the delta values
+  // are given del_n = w_n' * del_(n+1) * f'(z_n). Since our cost function also
+  // includes the KL divergence term, we adjust for that in the formula below.
+  const arma::vec klDivGrad = beta * (-(rho / rhoCap) + (1 - rho) /
+      (1 - rhoCap));
+
+  arma::vec squaredErrors(numBlocks);
+  std::vector<arma::mat> blockGradients(gradient ? numBlocks : 0);
+
+  // Compute the reconstruction error and accumulate the gradient of every
+  // block locally.
+  #pragma omp parallel for
+  for (omp_size_t k = 0; k < (omp_size_t) numBlocks; ++k)
+  {
+    const size_t first = begin + k * batchSize / numBlocks;
+    const size_t last = begin + (k + 1) * batchSize / numBlocks - 1;
+    const arma::mat& hiddenLayer = hiddenLayers[k];
+
+    arma::mat outputLayer = w2t.t() * hiddenLayer;
+    outputLayer.each_col() += b2;
+    Sigmoid(outputLayer, outputLayer);
+
+    // Difference between the reconstructed data and the original data.
+    const arma::mat diff = outputLayer - data.cols(first, last);
+    squaredErrors[k] = arma::accu(diff % diff);
+
+    if (!gradient)
+      continue;
+
+    const arma::mat delOut = diff % outputLayer % (1 - outputLayer);
+    arma::mat delHid = w2t * delOut;
+    delHid.each_col() += klDivGrad;
+    delHid %= hiddenLayer % (1 - hiddenLayer);
+
+    arma::mat& g = blockGradients[k];
+    g.zeros(2 * hiddenSize + 1, visibleSize + 1);
+    g.submat(0, 0, l1 - 1, l2 - 1) = delHid * data.cols(first, last).t();
+    g.submat(l1, 0, l3 - 1, l2 - 1) = hiddenLayer * delOut.t();
+    g.submat(0, l2, l1 - 1, l2) = arma::sum(delHid, 1);
+    g.submat(l3, 0, l3, l2 - 1) = arma::sum(delOut, 1).t();
+  }
+
+  if (gradient)
+  {
+    // Average the gradients of the blocks. The formula also accounts for the
+    // regularization terms in the objective function.
+    *gradient = blockGradients[0];
+    for (size_t k = 1; k < numBlocks; ++k)
+      *gradient += blockGradients[k];
+    *gradient /= batchSize;
+
+    gradient->submat(0, 0, l1 - 1, l2 - 1) += lambda * w1;
+    gradient->submat(l1, 0, l3 - 1, l2 - 1) += lambda * w2t;
+  }
 
   // Calculate the reconstruction error, the regularization cost and the KL
   // divergence cost terms. 'sumOfSquaresError' is the average squared l2-norm
@@ -128,83 +259,13 @@ double SparseAutoencoderFunction::Evaluate(const arma::mat& parameters) const
   // of the weights w1 and w2. 'klDivergence' is the cost of the hidden layer
   // activations not being low. It is given by the following formula:
   // KL = sum_over_hSize(rho*log(rho/rhoCaq) + (1-rho)*log((1-rho)/(1-rhoCap)))
-  sumOfSquaresError = 0.5 * arma::accu(diff % diff) / data.n_cols;
-  weightDecay = 0.5 * lambda * wL2SquaredNorm;
-  klDivergence = beta * arma::accu(rho * arma::log(rho / rhoCap) + (1 - rho) *
-      arma::log((1 - rho) / (1 - rhoCap)));
+  const double sumOfSquaresError = 0.5 * arma::accu(squaredErrors) /
+      batchSize;
+  const double weightDecay = 0.5 * lambda * (arma::accu(w1 % w1) +
+      arma::accu(w2t % w2t));
+  const double klDivergence = beta * arma::accu(rho * arma::log(rho / rhoCap) +
+      (1 - rho) * arma::log((1 - rho) / (1 - rhoCap)));
 
   // The cost is the sum of the terms calculated above.
-  cost = sumOfSquaresError + weightDecay + klDivergence;
-
-  return cost;
-}
-
-/** Calculates and stores the gradient values given a set of parameters.
-  */
-void SparseAutoencoderFunction::Gradient(const arma::mat& parameters,
-                                         arma::mat& gradient) const
-{
-  // Performs a feedforward pass of the neural network, and computes the
-  // activations of the output layer as in the Evaluate() method. It uses the
-  // Backpropagation algorithm to calculate the delta values at each layer,
-  // except for the input layer. The delta values are then used with input layer
-  // and hidden layer activations to get the parameter gradients.
-
-  // Compute the limits for the parameters w1, w2, b1 and b2.
-  const size_t l1 = hiddenSize;
-  const size_t l2 = visibleSize;
-  const size_t l3 = 2 * hiddenSize;
-
-  // w1, w2, b1 and b2 are not extracted separately, 'parameters' is directly
-  // used in their place to avoid copying data. The following representations
-  // are used:
-  // w1 <- parameters.submat(0, 0, l1-1, l2-1)
-  // w2 <- parameters.submat(l1, 0, l3-1, l2-1).t()
-  // b1 <- parameters.submat(0, l2, l1-1, l2)
-  // b2 <- parameters.submat(l3, 0, l3, l2-1).t()
-
-  arma::mat hiddenLayer, outputLayer;
-
-  // Compute activations of the hidden and output layers.
-  Sigmoid(parameters.submat(0, 0, l1 - 1, l2 - 1) * data +
-      arma::repmat(parameters.submat(0, l2, l1 - 1, l2), 1, data.n_cols),
-      hiddenLayer);
-
-  Sigmoid(parameters.submat(l1, 0, l3 - 1, l2 - 1).t() * hiddenLayer +
-      arma::repmat(parameters.submat(l3, 0, l3, l2 - 1).t(), 1, data.n_cols),
-      outputLayer);
-
-  arma::mat rhoCap, diff;
-
-  // Average activations of the hidden layer.
-  rhoCap = arma::sum(hiddenLayer, 1) / data.n_cols;
-  // Difference between the reconstructed data and the original data.
-  diff = outputLayer - data;
-
-  arma::mat klDivGrad, delOut, delHid;
-
-  // The delta vector for the output layer is given by diff * f'(z), where z is
-  // the preactivation and f is the activation function. The derivative of the
-  // sigmoid function turns out to be f(z) * (1 - f(z)). For every other layer
-  // in the neural network which comes before the output layer, the delta values
-  // are given del_n = w_n' * del_(n+1) * f'(z_n). Since our cost function also
-  // includes the KL divergence term, we adjust for that in the formula below.
-  klDivGrad = beta * (-(rho / rhoCap) + (1 - rho) / (1 - rhoCap));
-  delOut = diff % outputLayer % (1 - outputLayer);
-  delHid = (parameters.submat(l1, 0, l3 - 1, l2 - 1) * delOut +
-      arma::repmat(klDivGrad, 1, data.n_cols)) % hiddenLayer %
-      (1 - hiddenLayer);
-
-  gradient.zeros(2 * hiddenSize + 1, visibleSize + 1);
-
-  // Compute the gradient values using the activations and the delta values. The
-  // formula also accounts for the regularization terms in the objective.
-  // function.
-  gradient.submat(0, 0, l1 - 1, l2 - 1) = delHid * data.t() / data.n_cols +
-      lambda * parameters.submat(0, 0, l1 - 1, l2 - 1);
-  gradient.submat(l1, 0, l3 - 1, l2 - 1) =
-      (delOut * hiddenLayer.t() / data.n_cols +
-      lambda * parameters.submat(l1, 0, l3 - 1, l2 - 1).t()).t();
-  gradient.submat(0, l2, l1 - 1, l2) = arma::sum(delHid, 1) / data.n_cols;
-  gradient.submat(l3, 0, l3, l2 - 1) = (arma::sum(delOut, 1) / data.n_cols).t();
+  return sumOfSquaresError + weightDecay + klDivergence;
 }
@@ -47,6 +47,12 @@ class SparseAutoencoderFunction
   //! Initializes the parameters of the model to suitable values.
   const arma::mat InitializeWeights();
 
+  /**
+   * Shuffle the order of the data points. This may be called by the
+   * optimizer.
+   */
+  void Shuffle();
+
   /**
    * Evaluates the objective function of the sparse autoencoder model using the
    * given parameters. The cost function has terms for the reconstruction
@@ -70,6 +76,61 @@ class SparseAutoencoderFunction
    */
   void Gradient(const arma::mat& parameters, arma::mat& gradient) const;
 
+  /**
+   * Evaluate the objective function and its gradient together, sharing the
+   * feedforward pass.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param gradient Matrix where gradient values will be stored.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              arma::mat& gradient) const;
+
+  /**
+   * Evaluate the objective function on the batch of points starting at the
+   * given index. The sparsity term uses the average hidden activations of the
+   * batch, and the result is scaled by batchSize / NumFunctions(), so that
+   * the objectives of all the batches sum to the full objective.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param begin Index of the first point of the batch.
+   * @param batchSize Number of points in the batch.
+   */
+  double Evaluate(const arma::mat& parameters,
+                  const size_t begin,
+                  const size_t batchSize = 1) const;
+
+  /**
+   * Evaluate the gradient of the objective function on the batch of points
+   * starting at the given index, scaled like Evaluate().
+   *
+   * @param parameters Current values of the model parameters.
+   * @param begin Index of the first point of the batch.
+   * @param gradient Matrix where gradient values will be stored.
+   * @param batchSize Number of points in the batch.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t begin,
+                arma::mat& gradient,
+                const size_t batchSize = 1) const;
+
+  /**
+   * Evaluate the objective function and its gradient on the batch of points
+   * starting at the given index, scaled like Evaluate().
+   *
+   * @param parameters Current values of the model parameters.
+   * @param begin Index of the first point of the batch.
+   * @param gradient Matrix where gradient values will be stored.
+   * @param batchSize Number of points in the batch.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              const size_t begin,
+                              arma::mat& gradient,
+                              const size_t batchSize = 1) const;
+
+  //! Return the number of separable functions (the number of data points).
+  size_t NumFunctions() const { return data.n_cols; }
+
   /**
    * Returns the elementwise sigmoid of the passed matrix, where the sigmoid
    * function of a real number 'x' is [1 / (1 + exp(-x))].
@@ -145,8 +206,25 @@ class SparseAutoencoderFunction
   }
 
  private:
+  /**
+   * Compute the objective of the given columns as if they were the whole
+   * dataset, and optionally its gradient. The columns are split into one
+   * block per thread; the hidden activations of all the blocks are computed
+   * first, since the sparsity term needs their average, and then every
+   * thread accumulates the error and the gradient of its block locally.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param begin Index of the first column.
+   * @param batchSize Number of columns.
+   * @param gradient If not NULL, the gradient is stored here.
+   */
+  double EvaluateColumns(const arma::mat& parameters,
+                         const size_t begin,
+                         const size_t batchSize,
+                         arma::mat* gradient) const;
+
   //! The matrix of data points.
-  const arma::mat& data;
+  arma::mat data;
   //! Initial parameter vector.
   arma::mat initialPoint;
   //! Size of the visible layer.
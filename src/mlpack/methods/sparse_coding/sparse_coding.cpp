@@ -39,23 +39,12 @@ void SparseCoding::Encode(const arma::mat& data, arma::mat& codes)
   // lambda2 > 0.
   arma::mat matGram = trans(dictionary) * dictionary;
 
-  codes.set_size(atoms, data.n_cols);
-  for (size_t i = 0; i < data.n_cols; ++i)
-  {
-    // Report progress.
-    if ((i % 100) == 0)
-      Log::Debug << "Optimization at point " << i << "." << std::endl;
-
-    bool useCholesky = true;
-    regression::LARS lars(useCholesky, matGram, lambda1, lambda2);
-
-    // Create an alias of the code (using the same memory), and then LARS will
-    // place the result directly into that; then we will not need to have an
-    // extra copy.
-    arma::vec code = codes.unsafe_col(i);
-    arma::rowvec responses = data.unsafe_col(i).t();
-    lars.Train(dictionary, responses, code, false);
-  }
+  // Every point is solved with the same dictionary, so LARS can share the Gram
+  // matrix and solve the points in parallel.  Each column of data is the
+  // response vector of one point.
+  const bool useCholesky = true;
+  regression::LARS lars(useCholesky, matGram, lambda1, lambda2);
+  lars.Train(dictionary, data, codes, false);
 }
 
 // Dictionary step for optimization.
@@ -103,6 +103,35 @@ class SVDPlusPlusFunction
                 GradType& gradient,
                 const size_t batchSize = 1) const;
 
+  /**
+   * Take one SGD step for each of (at most maxRatings of) the ratings of the
+   * given user.  The sum of the user's implicit item vectors is only computed
+   * once, before the first step, and the gradients with respect to the
+   * implicit item vectors are accumulated over the user's ratings and applied
+   * after the last step, so the work for a user is linear in the number of
+   * ratings plus the number of implicit items, instead of their product.
+   *
+   * @param parameters Parameters(user/item matrices, user/item bias,
+   *     item implicit matrix) of the decomposition.
+   * @param user User whose ratings are used.
+   * @param stepSize Step size of SGD.
+   * @param maxRatings Maximum number of ratings of the user to use.
+   * @param atomic If true, the parameters of the items (which other threads
+   *     may be updating) are updated atomically.
+   * @return Objective of the ratings that were used, after their steps.
+   */
+  double UserGradientStep(arma::mat& parameters,
+                          const size_t user,
+                          const double stepSize,
+                          const size_t maxRatings,
+                          const bool atomic) const;
+
+  //! Return the number of ratings of the given user.
+  size_t NumUserRatings(const size_t user) const
+  {
+    return userOffsets[user + 1] - userOffsets[user];
+  }
+
   //! Return the initial point for the optimization.
   const arma::mat& GetInitialPoint() const { return initialPoint; }
 
@@ -128,6 +157,21 @@ class SVDPlusPlusFunction
   size_t Rank() const { return rank; }
 
  private:
+  /**
+   * Group the ratings by user (stably, with a counting sort), filling
+   * userOffsets and ratingsByUser.
+   */
+  void GroupRatings();
+
+  /**
+   * Subtract the given update from the first rows of the given column of the
+   * parameters, atomically if requested.
+   */
+  static void Subtract(arma::mat& parameters,
+                       const size_t col,
+                       const arma::vec& update,
+                       const bool atomic);
+
   //! Rating data.  This will be an alias until Shuffle() is called.
   MatType data;
   //! Implicit feedback data.
@@ -142,6 +186,11 @@ class SVDPlusPlusFunction
   size_t numUsers;
   //! Number of items in the given dataset.
   size_t numItems;
+  //! The ratings of user u are ratingsByUser[userOffsets[u]] to
+  //! ratingsByUser[userOffsets[u + 1] - 1].
+  arma::Col<size_t> userOffsets;
+  //! The indices of the ratings, grouped by user.
+  arma::Col<size_t> ratingsByUser;
 };
 
 } // namespace svd
@@ -44,6 +44,8 @@ SVDPlusPlusFunction<MatType>::SVDPlusPlusFunction(
   // Unused:
   //     row(rank).subvec(numUsers + numItems, numUsers + 2 * numItems - 1)
   initialPoint.randu(rank + 1, numUsers + 2 * numItems);
+
+  GroupRatings();
 }
 
 template<typename MatType>
@@ -51,12 +53,58 @@ void SVDPlusPlusFunction<MatType>::Shuffle()
 {
   data = data.cols(arma::shuffle(arma::linspace<arma::uvec>(0, data.n_cols - 1,
       data.n_cols)));
+  GroupRatings();
 }
 
 template <typename MatType>
 double SVDPlusPlusFunction<MatType>::Evaluate(const arma::mat& parameters) const
 {
-  return Evaluate(parameters, 0, data.n_cols);
+  // This is the same objective as Evaluate(parameters, 0, data.n_cols), but
+  // the ratings are visited user by user, so that the sum of the implicit item
+  // vectors of each user is only computed once.
+  const size_t implicitStart = numUsers + numItems;
+  double objective = 0.0;
+
+  #pragma omp parallel for reduction(+:objective) schedule(dynamic, 64)
+  for (omp_size_t user = 0; user < (omp_size_t) numUsers; ++user)
+  {
+    arma::vec userVec(rank, arma::fill::zeros);
+    arma::sp_mat::const_iterator it = implicitData.begin_col(user);
+    arma::sp_mat::const_iterator it_end = implicitData.end_col(user);
+    size_t implicitCount = 0;
+    double implicitError = 0;
+    for (; it != it_end; ++it)
+    {
+      const arma::vec implicitVec =
+          parameters.col(implicitStart + it.row()).subvec(0, rank - 1);
+      userVec += implicitVec;
+      implicitError += lambda * arma::dot(implicitVec, implicitVec);
+      implicitCount += 1;
+    }
+    if (implicitCount != 0)
+    {
+      userVec /= std::sqrt(implicitCount);
+      implicitError /= implicitCount;
+    }
+    userVec += parameters.col(user).subvec(0, rank - 1);
+
+    const double userVecNorm = arma::norm(parameters.col(user), 2);
+    for (size_t k = userOffsets[user]; k < userOffsets[user + 1]; ++k)
+    {
+      const size_t i = ratingsByUser[k];
+      const size_t item = data(1, i) + numUsers;
+
+      const double ratingError = data(2, i) - parameters(rank, user) -
+          parameters(rank, item) -
+          arma::dot(userVec, parameters.col(item).subvec(0, rank - 1));
+
+      const double itemVecNorm = arma::norm(parameters.col(item), 2);
+      objective += ratingError * ratingError + implicitError +
+          lambda * (userVecNorm * userVecNorm + itemVecNorm * itemVecNorm);
+    }
+  }
+
+  return objective;
 }
 
 template <typename MatType>
@@ -82,6 +130,12 @@ double SVDPlusPlusFunction<MatType>::Evaluate(const arma::mat& parameters,
   arma::vec implicitVecsNormSquare(numItems);
   implicitVecsNormSquare.fill(-1);
 
+  // The implicit part of the user vector and its regularization error are
+  // reused while consecutive examples belong to the same user.
+  size_t lastUser = numUsers;
+  arma::vec implicitUserVec(rank);
+  double implicitError = 0;
+
   for (size_t i = start; i < start + batchSize; ++i)
   {
     // Indices for accessing the the correct parameter columns.
@@ -96,29 +150,36 @@ double SVDPlusPlusFunction<MatType>::Evaluate(const arma::mat& parameters,
 
     // Iterate through each item which the user interacted with to calculate
     // user vector.
-    arma::vec userVec(rank, arma::fill::zeros);
-    arma::sp_mat::const_iterator it = implicitData.begin_col(user);
-    arma::sp_mat::const_iterator it_end = implicitData.end_col(user);
-    size_t implicitCount = 0;
-    double regularizationError = 0;
-    for (; it != it_end; ++it)
+    if (user != lastUser)
     {
-      userVec += parameters.col(implicitStart + it.row()).subvec(0, rank - 1);
-      if (implicitVecsNormSquare(it.row()) < 0)
+      implicitUserVec.zeros();
+      implicitError = 0;
+      arma::sp_mat::const_iterator it = implicitData.begin_col(user);
+      arma::sp_mat::const_iterator it_end = implicitData.end_col(user);
+      size_t implicitCount = 0;
+      for (; it != it_end; ++it)
       {
-        implicitVecsNormSquare(it.row()) = arma::dot(
-            parameters.col(implicitStart + it.row()).subvec(0, rank - 1),
-            parameters.col(implicitStart + it.row()).subvec(0, rank - 1));
+        implicitUserVec +=
+            parameters.col(implicitStart + it.row()).subvec(0, rank - 1);
+        if (implicitVecsNormSquare(it.row()) < 0)
+        {
+          implicitVecsNormSquare(it.row()) = arma::dot(
+              parameters.col(implicitStart + it.row()).subvec(0, rank - 1),
+              parameters.col(implicitStart + it.row()).subvec(0, rank - 1));
+        }
+        implicitError += lambda * implicitVecsNormSquare(it.row());
+        implicitCount += 1;
       }
-      regularizationError += lambda * implicitVecsNormSquare(it.row());
-      implicitCount += 1;
-    }
-    if (implicitCount != 0)
-    {
-      userVec /= std::sqrt(implicitCount);
-      regularizationError /= implicitCount;
+      if (implicitCount != 0)
+      {
+        implicitUserVec /= std::sqrt(implicitCount);
+        implicitError /= implicitCount;
+      }
+      lastUser = user;
     }
-    userVec += parameters.col(user).subvec(0, rank - 1);
+    double regularizationError = implicitError;
+    const arma::vec userVec = implicitUserVec +
+        parameters.col(user).subvec(0, rank - 1);
 
     double ratingError = rating - userBias - itemBias -
         arma::dot(userVec, parameters.col(item).subvec(0, rank - 1));
@@ -285,6 +346,148 @@ void SVDPlusPlusFunction<MatType>::Gradient(const arma::mat& parameters,
   }
 }
 
+template <typename MatType>
+double SVDPlusPlusFunction<MatType>::UserGradientStep(
+    arma::mat& parameters,
+    const size_t user,
+    const double stepSize,
+    const size_t maxRatings,
+    const bool atomic) const
+{
+  const size_t implicitStart = numUsers + numItems;
+
+  // Sum the implicit item vectors of the user once; they are not updated
+  // until all of the user's ratings have been used.
+  arma::vec implicitUserVec(rank, arma::fill::zeros);
+  arma::sp_mat::const_iterator it = implicitData.begin_col(user);
+  arma::sp_mat::const_iterator it_end = implicitData.end_col(user);
+  size_t implicitCount = 0;
+  double implicitError = 0;
+  for (; it != it_end; ++it)
+  {
+    const arma::vec implicitVec =
+        parameters.col(implicitStart + it.row()).subvec(0, rank - 1);
+    implicitUserVec += implicitVec;
+    implicitError += lambda * arma::dot(implicitVec, implicitVec);
+    implicitCount += 1;
+  }
+  if (implicitCount != 0)
+  {
+    implicitUserVec /= std::sqrt(implicitCount);
+    implicitError /= implicitCount;
+  }
+
+  // The gradients with respect to the implicit item vectors only differ in
+  // their regularization terms, so the rest is accumulated once.
+  arma::vec implicitGradient(rank, arma::fill::zeros);
+
+  double objective = 0;
+  const size_t begin = userOffsets[user];
+  const size_t end = std::min(begin + maxRatings,
+      (size_t) userOffsets[user + 1]);
+  for (size_t k = begin; k < end; ++k)
+  {
+    const size_t i = ratingsByUser[k];
+    const size_t item = data(1, i) + numUsers;
+    const double rating = data(2, i);
+
+    const arma::vec itemVec = parameters.col(item).subvec(0, rank - 1);
+    const arma::vec userVec = implicitUserVec +
+        parameters.col(user).subvec(0, rank - 1);
+    const double ratingError = rating - parameters(rank, user) -
+        parameters(rank, item) - arma::dot(userVec, itemVec);
+
+    implicitGradient += ratingError * itemVec;
+
+    // Only this thread handles this user, so the user's parameters can be
+    // updated directly.
+    parameters.col(user).subvec(0, rank - 1) -= stepSize * 2 * (
+        lambda * parameters.col(user).subvec(0, rank - 1) -
+        ratingError * itemVec);
+    parameters(rank, user) -= stepSize * 2 * (
+        lambda * parameters(rank, user) - ratingError);
+
+    const arma::vec itemVecUpdate = stepSize * 2 * (lambda * itemVec -
+        ratingError * userVec);
+    const double itemBiasUpdate = stepSize * 2 * (
+        lambda * parameters(rank, item) - ratingError);
+    Subtract(parameters, item, itemVecUpdate, atomic);
+    if (atomic)
+    {
+      #pragma omp atomic
+      parameters(rank, item) -= itemBiasUpdate;
+    }
+    else
+    {
+      parameters(rank, item) -= itemBiasUpdate;
+    }
+
+    // Now add the objective of the example, with the updated parameters.
+    const double newError = rating - parameters(rank, user) -
+        parameters(rank, item) - arma::dot(implicitUserVec +
+        parameters.col(user).subvec(0, rank - 1),
+        parameters.col(item).subvec(0, rank - 1));
+    const double userVecNorm = arma::norm(parameters.col(user), 2);
+    const double itemVecNorm = arma::norm(parameters.col(item), 2);
+    objective += newError * newError + implicitError +
+        lambda * (userVecNorm * userVecNorm + itemVecNorm * itemVecNorm);
+  }
+
+  // Update the implicit item vectors, with the regularization of each of the
+  // steps.
+  if (implicitCount != 0 && end > begin)
+  {
+    const double numSteps = (double) (end - begin);
+    implicitGradient /= std::sqrt(implicitCount);
+    for (it = implicitData.begin_col(user); it != it_end; ++it)
+    {
+      const arma::vec implicitUpdate = stepSize * 2.0 * (
+          numSteps * lambda / implicitCount *
+          parameters.col(implicitStart + it.row()).subvec(0, rank - 1) -
+          implicitGradient);
+      Subtract(parameters, implicitStart + it.row(), implicitUpdate, atomic);
+    }
+  }
+
+  return objective;
+}
+
+template <typename MatType>
+void SVDPlusPlusFunction<MatType>::GroupRatings()
+{
+  // Count the ratings of each user, then place them.
+  userOffsets.zeros(numUsers + 1);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    ++userOffsets[(size_t) data(0, i) + 1];
+  for (size_t u = 0; u < numUsers; ++u)
+    userOffsets[u + 1] += userOffsets[u];
+
+  arma::Col<size_t> next = userOffsets.subvec(0, numUsers - 1);
+  ratingsByUser.set_size(data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    ratingsByUser[next[(size_t) data(0, i)]++] = i;
+}
+
+template <typename MatType>
+void SVDPlusPlusFunction<MatType>::Subtract(arma::mat& parameters,
+                                            const size_t col,
+                                            const arma::vec& update,
+                                            const bool atomic)
+{
+  if (atomic)
+  {
+    for (size_t i = 0; i < update.n_elem; ++i)
+    {
+      #pragma omp atomic
+      parameters(i, col) -= update[i];
+    }
+  }
+  else
+  {
+    parameters.col(col).subvec(0, update.n_elem - 1) -= update;
+  }
+}
+
 } // namespace svd
 } // namespace mlpack
 
@@ -297,96 +500,44 @@ double StandardSGD::Optimize(
     mlpack::svd::SVDPlusPlusFunction<arma::mat>& function,
     arma::mat& parameters)
 {
-  // Find the number of functions to use.
-  const size_t numFunctions = function.NumFunctions();
-
-  // To keep track of where we are and how things are going.
-  size_t currentFunction = 0;
-  double overallObjective = 0;
+  // The examples are visited user by user (see
+  // SVDPlusPlusFunction::UserGradientStep()), in a random order of the users
+  // if shuffle is set.  Each example is still one iteration.
+  arma::Col<size_t> visitationOrder = arma::linspace<arma::Col<size_t>>(0,
+      (function.NumUsers() - 1), function.NumUsers());
 
   // Calculate the first objective function.
-  for (size_t i = 0; i < numFunctions; i++)
-    overallObjective += function.Evaluate(parameters, i);
+  double overallObjective = function.Evaluate(parameters);
 
-  const arma::mat data = function.Dataset();
-  const arma::sp_mat implicitData = function.ImplicitDataset();
-  const size_t numUsers = function.NumUsers();
-  const size_t numItems = function.NumItems();
-  const double lambda = function.Lambda();
-
-  // Rank of decomposition.
-  const size_t rank = function.Rank();
-
-  // Now iterate!
-  for (size_t i = 1; i != maxIterations; i++, currentFunction++)
+  // If maxIterations is 0, there is no limit; otherwise maxIterations - 1
+  // steps are taken.
+  size_t remaining = (maxIterations == 0) ? 0 : maxIterations - 1;
+  for (size_t epoch = 1; maxIterations == 0 || remaining > 0; ++epoch)
   {
-    // Is this iteration the start of a sequence?
-    if ((currentFunction % numFunctions) == 0)
-    {
-      const size_t epoch = i / numFunctions + 1;
-      mlpack::Log::Info << "Epoch " << epoch << "; " << "objective "
-          << overallObjective << "." << std::endl;
-
-      // Reset the counter variables.
-      overallObjective = 0;
-      currentFunction = 0;
-    }
-
-    // Indices for accessing the the correct parameter columns.
-    const size_t user = data(0, currentFunction);
-    const size_t item = data(1, currentFunction) + numUsers;
-    const size_t implicitStart = numUsers + numItems;
+    mlpack::Log::Info << "Epoch " << epoch << "; " << "objective "
+        << overallObjective << "." << std::endl;
+    overallObjective = 0;
 
-    // Calculate the squared error in the prediction.
-    const double rating = data(2, currentFunction);
-    const double userBias = parameters(rank, user);
-    const double itemBias = parameters(rank, item);
+    if (shuffle)
+      std::shuffle(visitationOrder.begin(), visitationOrder.end(),
+          mlpack::math::randGen);
 
-    // Iterate through each item which the user interacted with to calculate
-    // user vector.
-    arma::vec userVec(rank, arma::fill::zeros);
-    arma::sp_mat::const_iterator it = implicitData.begin_col(user);
-    arma::sp_mat::const_iterator it_end = implicitData.end_col(user);
-    size_t implicitCount = 0;
-    for (; it != it_end; ++it)
+    for (size_t j = 0; j < visitationOrder.n_elem; ++j)
     {
-      userVec += parameters.col(implicitStart + it.row()).subvec(0, rank - 1);
-      implicitCount += 1;
-    }
-    if (implicitCount != 0)
-      userVec /= std::sqrt(implicitCount);
-    userVec += parameters.col(user).subvec(0, rank - 1);
+      const size_t user = visitationOrder[j];
+      size_t numRatings = function.NumUserRatings(user);
+      if (maxIterations != 0)
+      {
+        numRatings = std::min(numRatings, remaining);
+        remaining -= numRatings;
+      }
 
-    double ratingError = rating - userBias - itemBias -
-        arma::dot(userVec, parameters.col(item).subvec(0, rank - 1));
+      overallObjective += function.UserGradientStep(parameters, user,
+          stepSize, numRatings, false);
 
-    // Gradient is non-zero only for the parameter columns corresponding to the
-    // example.
-    parameters.col(user).subvec(0, rank - 1) -= stepSize * 2 * (
-        lambda * parameters.col(user).subvec(0, rank - 1) -
-        ratingError * parameters.col(item).subvec(0, rank - 1));
-    parameters.col(item).subvec(0, rank - 1) -= stepSize * 2 * (
-        lambda * parameters.col(item).subvec(0, rank - 1) -
-        ratingError * userVec);
-    parameters(rank, user) -= stepSize * 2 * (
-        lambda * parameters(rank, user) - ratingError);
-    parameters(rank, item) -= stepSize * 2 * (
-        lambda * parameters(rank, item) - ratingError);
-    // Update item implicit vectors.
-    it = implicitData.begin_col(user);
-    it_end = implicitData.end_col(user);
-    for (; it != it_end; ++it)
-    {
-      // Note that implicitCount != 0 if this loop is acutally executed.
-      parameters.col(implicitStart + it.row()).subvec(0, rank - 1) -=
-          stepSize * 2.0 * (lambda / implicitCount *
-          parameters.col(implicitStart + it.row()).subvec(0, rank - 1) -
-          ratingError / std::sqrt(implicitCount) *
-          parameters.col(item).subvec(0, rank - 1));
+      if (maxIterations != 0 && remaining == 0)
+        break;
     }
-
-    // Now add that to the overall objective function.
-    overallObjective += function.Evaluate(parameters, currentFunction);
   }
 
   return overallObjective;
@@ -402,18 +553,17 @@ inline double ParallelSGD<ExponentialBackoff>::Optimize(
   double overallObjective = DBL_MAX;
   double lastObjective;
 
-  // The order in which the functions will be visited.
+  // The order in which the users will be visited.  The examples are visited
+  // user by user (see SVDPlusPlusFunction::UserGradientStep()), and each user
+  // is handled by a single thread, so only the item parameters are shared
+  // between threads.
   arma::Col<size_t> visitationOrder = arma::linspace<arma::Col<size_t>>(0,
-      (function.NumFunctions() - 1), function.NumFunctions());
+      (function.NumUsers() - 1), function.NumUsers());
 
-  const arma::mat data = function.Dataset();
-  const arma::sp_mat implicitData = function.ImplicitDataset();
-  const size_t numUsers = function.NumUsers();
-  const size_t numItems = function.NumItems();
-  const double lambda = function.Lambda();
-
-  // Rank of decomposition.
-  const size_t rank = function.Rank();
+  // Each thread gets the number of users that have threadShareSize examples
+  // on average.
+  const size_t userShareSize = (size_t) std::ceil((double) threadShareSize *
+      function.NumUsers() / function.NumFunctions());
 
   // Iterate till the objective is within tolerance or the maximum number of
   // allowed iterations is reached. If maxIterations is 0, this will iterate
@@ -422,13 +572,7 @@ inline double ParallelSGD<ExponentialBackoff>::Optimize(
   {
     // Calculate the overall objective.
     lastObjective = overallObjective;
-    overallObjective = 0;
-
-    #pragma omp parallel for reduction(+:overallObjective)
-    for (omp_size_t j = 0; j < (omp_size_t) function.NumFunctions(); ++j)
-    {
-      overallObjective += function.Evaluate(iterate, j);
-    }
+    overallObjective = function.Evaluate(iterate);
 
     // Output current objective function.
     mlpack::Log::Info << "Parallel SGD: iteration " << i << ", objective "
@@ -458,93 +602,20 @@ inline double ParallelSGD<ExponentialBackoff>::Optimize(
 
     #pragma omp parallel
     {
-      // Each processor gets a subset of the instances.
-      // Each subset is of size threadShareSize.
+      // Each processor gets a subset of the users.
+      // Each subset is of size userShareSize.
       size_t threadId = 0;
       #ifdef HAS_OPENMP
         threadId = omp_get_thread_num();
       #endif
 
-      for (size_t j = threadId * threadShareSize;
-          j < (threadId + 1) * threadShareSize && j < visitationOrder.n_elem;
+      for (size_t j = threadId * userShareSize;
+          j < (threadId + 1) * userShareSize && j < visitationOrder.n_elem;
           ++j)
       {
-        // Indices for accessing the the correct parameter columns.
-        const size_t user = data(0, visitationOrder[j]);
-        const size_t item = data(1, visitationOrder[j]) + numUsers;
-        const size_t implicitStart = numUsers + numItems;
-
-        // Prediction error for the example.
-        const double rating = data(2, visitationOrder[j]);
-        const double userBias = iterate(rank, user);
-        const double itemBias = iterate(rank, item);
-        // Iterate through each item which the user interacted with to calculate
-        // user vector.
-        arma::vec userVec(rank, arma::fill::zeros);
-        arma::sp_mat::const_iterator it = implicitData.begin_col(user);
-        arma::sp_mat::const_iterator it_end = implicitData.end_col(user);
-        size_t implicitCount = 0;
-        for (; it != it_end; ++it)
-        {
-          userVec += iterate.col(implicitStart + it.row()).subvec(0, rank - 1);
-          implicitCount += 1;
-        }
-        if (implicitCount != 0)
-          userVec /= std::sqrt(implicitCount);
-        userVec += iterate.col(user).subvec(0, rank - 1);
-
-        double ratingError = rating - userBias - itemBias -
-        arma::dot(userVec, iterate.col(item).subvec(0, rank - 1));
-
-        arma::mat userVecUpdate = stepSize * 2 * (
-            lambda * iterate.col(user).subvec(0, rank - 1) -
-            ratingError * iterate.col(item).subvec(0, rank - 1));
-        arma::mat itemVecUpdate = stepSize * 2 * (
-            lambda * iterate.col(item).subvec(0, rank - 1) -
-            ratingError * userVec);
-        double userBiasUpdate = stepSize * 2 * (
-            lambda * iterate(rank, user) - ratingError);
-        double itemBiasUpdate = stepSize * 2 * (
-            lambda * iterate(rank, item) - ratingError);
-
-        // Update of item implicit vectors.
-        arma::mat itemImplicitUpdate(rank, implicitCount);
-        arma::Col<size_t> implicitItems(implicitCount);
-        it = implicitData.begin_col(user);
-        it_end = implicitData.end_col(user);
-        size_t implicitIndex = 0;
-        for (; it != it_end; ++it, ++implicitIndex)
-        {
-          itemImplicitUpdate.col(implicitIndex) =
-              stepSize * 2.0 * (lambda / implicitCount *
-              iterate.col(implicitStart + it.row()).subvec(0, rank - 1) -
-              ratingError / std::sqrt(implicitCount) *
-              iterate.col(item).subvec(0, rank - 1));
-          implicitItems(implicitIndex) = it.row();
-        }
-
-        // Gradient is non-zero only for the parameter columns corresponding to
-        // the example.
-        for (size_t i = 0; i < rank; ++i)
-        {
-          #pragma omp atomic
-          iterate(i, user) -= userVecUpdate(i);
-          #pragma omp atomic
-          iterate(i, item) -= itemVecUpdate(i);
-        }
-        #pragma omp atomic
-        iterate(rank, user) -= userBiasUpdate;
-        #pragma omp atomic
-        iterate(rank, item) -= itemBiasUpdate;
-        for (size_t k = 0; k < implicitCount; ++k)
-        {
-          for (size_t i = 0; i < rank; ++i)
-          {
-            #pragma omp atomic
-            iterate(i, implicitStart + implicitItems(k)) -=
-                itemImplicitUpdate(i, k);
-          }
-        }
+        const size_t user = visitationOrder[j];
+        function.UserGradientStep(iterate, user, stepSize,
+            function.NumUserRatings(user), true);
       }
     }
   }
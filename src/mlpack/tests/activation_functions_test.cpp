@@ -21,6 +21,7 @@
 #include <mlpack/methods/ann/activation_functions/softplus_function.hpp>
 #include <mlpack/methods/ann/activation_functions/swish_function.hpp>
 #include <mlpack/methods/ann/activation_functions/hard_sigmoid_function.hpp>
+#include <mlpack/methods/ann/activation_functions/fast_functions.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -634,4 +635,80 @@ BOOST_AUTO_TEST_CASE(HardSigmoidFunctionTest)
       desiredDerivatives);
 }
 
+/**
+ * Check the accuracy of the fast exp, logistic and tanh approximations over a
+ * wide range of inputs.
+ */
+BOOST_AUTO_TEST_CASE(FastFunctionsTest)
+{
+  arma::vec input = arma::randu(10000) * 1400.0 - 700.0;
+  arma::vec exps;
+  exps.set_size(input.n_elem);
+  FastExp(input.memptr(), exps.memptr(), input.n_elem);
+  for (size_t i = 0; i < input.n_elem; ++i)
+    REQUIRE_RELATIVE_ERR(exps[i], std::exp(input[i]), 1e-13);
+
+  input = arma::randn(10000) * 10.0;
+  arma::vec logistic(input.n_elem), logisticDerivs(input.n_elem);
+  arma::vec tanh(input.n_elem), tanhDerivs(input.n_elem);
+  FastLogistic(input.memptr(), logistic.memptr(), logisticDerivs.memptr(),
+      input.n_elem);
+  FastTanh(input.memptr(), tanh.memptr(), tanhDerivs.memptr(), input.n_elem);
+  for (size_t i = 0; i < input.n_elem; ++i)
+  {
+    const double s = 1.0 / (1.0 + std::exp(-input[i]));
+    const double t = std::tanh(input[i]);
+    BOOST_REQUIRE_SMALL(logistic[i] - s, 1e-14);
+    BOOST_REQUIRE_SMALL(logisticDerivs[i] - s * (1.0 - s), 1e-14);
+    BOOST_REQUIRE_SMALL(tanh[i] - t, 1e-14);
+    BOOST_REQUIRE_SMALL(tanhDerivs[i] - (1.0 - t * t), 1e-14);
+  }
+
+  // The clamped input range must still give the right limits.
+  BOOST_REQUIRE_EQUAL(FastLogistic(1e5), 1.0);
+  BOOST_REQUIRE_SMALL(FastLogistic(-1e5), 1e-300);
+  BOOST_REQUIRE_EQUAL(FastTanh(1e5), 1.0);
+  BOOST_REQUIRE_EQUAL(FastTanh(-1e5), -1.0);
+  BOOST_REQUIRE_EQUAL(FastTanh(0.0), 0.0);
+}
+
+/**
+ * Check that FnDeriv() gives the same activations and derivatives as Fn() and
+ * Deriv(), for dense double matrices and for other types.
+ */
+BOOST_AUTO_TEST_CASE(FnDerivTest)
+{
+  const arma::mat input = arma::randn(7, 5) * 3.0;
+
+  arma::mat y, d, expectedY, expectedD;
+  LogisticFunction::FnDeriv(input, y, d);
+  expectedY = 1.0 / (1.0 + arma::exp(-input));
+  expectedD = expectedY % (1.0 - expectedY);
+  CheckMatrices(y, expectedY, 1e-8);
+  CheckMatrices(d, expectedD, 1e-8);
+
+  TanhFunction::FnDeriv(input, y, d);
+  expectedY = arma::tanh(input);
+  expectedD = 1.0 - arma::square(expectedY);
+  CheckMatrices(y, expectedY, 1e-8);
+  CheckMatrices(d, expectedD, 1e-8);
+
+  // The derivative of swish is computed with respect to the input.
+  SwishFunction::FnDeriv(input, y, d);
+  const arma::mat sigmoid = 1.0 / (1.0 + arma::exp(-input));
+  expectedY = input % sigmoid;
+  expectedD = expectedY + sigmoid % (1.0 - expectedY);
+  CheckMatrices(y, expectedY, 1e-8);
+  CheckMatrices(d, expectedD, 1e-8);
+
+  // Single precision goes through Armadillo.
+  const arma::fmat floatInput = arma::conv_to<arma::fmat>::from(input);
+  arma::fmat floatY, floatD;
+  TanhFunction::FnDeriv(floatInput, floatY, floatD);
+  CheckMatrices(arma::conv_to<arma::mat>::from(floatY), arma::tanh(input),
+      1e-3);
+  CheckMatrices(arma::conv_to<arma::mat>::from(floatD),
+      1.0 - arma::square(arma::tanh(input)), 1e-3);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
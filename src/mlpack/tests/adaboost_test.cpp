@@ -731,6 +731,51 @@ BOOST_AUTO_TEST_CASE(ClassifyTest_IRIS)
   BOOST_REQUIRE_LE(lError, 0.30);
 }
 
+/**
+ * Classify a dataset that spans several blocks, and make sure that the
+ * predictions are the weighted votes of the weak learners.
+ */
+BOOST_AUTO_TEST_CASE(BlockClassifyTest)
+{
+  arma::mat inputData;
+  if (!data::Load("iris.csv", inputData))
+    BOOST_FAIL("Cannot load test dataset iris.csv!");
+
+  arma::Mat<size_t> labels;
+  if (!data::Load("iris_labels.txt", labels))
+    BOOST_FAIL("Cannot load labels for iris_labels.txt");
+
+  const size_t numClasses = 3;
+  DecisionStump<> ds(inputData, labels.row(0), numClasses, 6);
+  AdaBoost<DecisionStump<>> a(inputData, labels.row(0), numClasses, ds, 50,
+      1e-10);
+
+  // Repeat the dataset so that the last block is only partly filled.
+  arma::mat testData = arma::repmat(inputData, 1, 10);
+
+  arma::Row<size_t> predictedLabels;
+  a.Classify(testData, predictedLabels);
+  BOOST_REQUIRE_EQUAL(predictedLabels.n_elem, testData.n_cols);
+
+  // Compute the votes of the weak learners by hand.
+  arma::mat votes(numClasses, testData.n_cols, arma::fill::zeros);
+  for (size_t i = 0; i < a.WeakLearners(); ++i)
+  {
+    DecisionStump<> stump(a.WeakLearner(i));
+    arma::Row<size_t> stumpLabels;
+    stump.Classify(testData, stumpLabels);
+    for (size_t j = 0; j < testData.n_cols; ++j)
+      votes(stumpLabels[j], j) += a.Alpha(i);
+  }
+
+  for (size_t j = 0; j < testData.n_cols; ++j)
+  {
+    arma::uword maxIndex;
+    votes.col(j).max(maxIndex);
+    BOOST_REQUIRE_EQUAL(predictedLabels[j], (size_t) maxIndex);
+  }
+}
+
 /**
  * Ensure that the Train() function works like it is supposed to, by building
  * AdaBoost on one dataset and then re-training on another dataset.
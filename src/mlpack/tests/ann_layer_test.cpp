@@ -233,6 +233,56 @@ BOOST_AUTO_TEST_CASE(DropoutProbabilityTest)
   }
 }
 
+/**
+ * Check that the packed dropout mask keeps the right fraction of elements,
+ * that applying it agrees with the unpacked mask, and that it is
+ * reproducible with the random seed.
+ */
+BOOST_AUTO_TEST_CASE(DropoutMaskTest)
+{
+  const double ratio = 0.3;
+  math::RandomSeed(17);
+  DropoutMask mask;
+  mask.Generate(101, 97, ratio);
+
+  const arma::mat unpacked = mask.Unpack();
+  BOOST_REQUIRE_EQUAL(unpacked.n_rows, 101);
+  BOOST_REQUIRE_EQUAL(unpacked.n_cols, 97);
+  BOOST_REQUIRE_LE(std::abs(arma::accu(unpacked) / unpacked.n_elem -
+      (1 - ratio)), 0.02);
+
+  arma::mat input = arma::randu<arma::mat>(101, 97);
+  arma::mat output;
+  mask.Apply(input, output, 2.0, 1.0, -1.0);
+  for (size_t i = 0; i < output.n_elem; ++i)
+  {
+    const double expected = unpacked[i] ? 2.0 * input[i] + 1.0 : -1.0;
+    BOOST_REQUIRE_CLOSE(output[i], expected, 1e-10);
+  }
+
+  // The same seed gives the same mask; another draw gives another mask.
+  math::RandomSeed(17);
+  DropoutMask other;
+  other.Generate(101, 97, ratio);
+  CheckMatrices(other.Unpack(), unpacked);
+  other.Generate(101, 97, ratio);
+  BOOST_REQUIRE_GT(arma::accu(arma::abs(other.Unpack() - unpacked)), 0);
+
+  // The extreme ratios keep everything or nothing.
+  mask.Generate(10, 10, 0.0);
+  BOOST_REQUIRE_EQUAL(arma::accu(mask.Unpack()), 100);
+  mask.Generate(10, 10, 1.0);
+  BOOST_REQUIRE_EQUAL(arma::accu(mask.Unpack()), 0);
+
+  // The Dropout layer must use the same mask in the backward pass.
+  Dropout<> module(ratio);
+  module.Deterministic() = false;
+  arma::mat ones = arma::ones(500, 3), forward, backward;
+  module.Forward(std::move(ones), std::move(forward));
+  module.Backward(std::move(ones), std::move(ones), std::move(backward));
+  CheckMatrices(forward, backward);
+}
+
 /*
  * Perform dropout with probability 1 - p where p = 0, means no dropout.
  */
@@ -705,6 +755,37 @@ BOOST_AUTO_TEST_CASE(SimpleJoinLayerTest)
   BOOST_REQUIRE_EQUAL(b, true);
 }
 
+/**
+ * Make sure that the Join and Select layers return views of their input and
+ * of the error instead of copies, and that the values are still right.
+ */
+BOOST_AUTO_TEST_CASE(JoinSelectViewTest)
+{
+  arma::mat input = arma::randu(10, 5);
+  arma::mat output, delta;
+
+  Join<> join;
+  join.Forward(std::move(input), std::move(output));
+  BOOST_REQUIRE_EQUAL(output.memptr(), input.memptr());
+  BOOST_REQUIRE_EQUAL(output.n_rows, 50);
+  join.Backward(std::move(input), std::move(output), std::move(delta));
+  BOOST_REQUIRE_EQUAL(delta.memptr(), output.memptr());
+  CheckMatrices(delta, input);
+
+  arma::mat selectOutput, selectDelta;
+  Select<> select(3, 4);
+  select.Forward(std::move(input), std::move(selectOutput));
+  BOOST_REQUIRE_EQUAL(selectOutput.memptr(), input.colptr(3));
+  CheckMatrices(selectOutput, input.submat(0, 3, 3, 3));
+
+  // Assigning to a layer output that is a view must not overwrite the memory
+  // it views.
+  const arma::mat original = input;
+  DetachView(selectOutput);
+  selectOutput = arma::zeros(4, 1);
+  CheckMatrices(input, original);
+}
+
 /**
  * Simple add merge module test.
  */
@@ -901,6 +982,40 @@ BOOST_AUTO_TEST_CASE(GradientFastLSTMLayerTest)
   BOOST_REQUIRE_LE(CheckGradient(function), 0.2);
 }
 
+/**
+ * Make sure that the FastLSTM layer gives the same objective and gradient for
+ * a batch of points as for each of the points on its own.
+ */
+BOOST_AUTO_TEST_CASE(FastLSTMBatchGradientTest)
+{
+  const size_t rho = 5;
+  RNN<NegativeLogLikelihood<> > model(rho);
+  model.Predictors() = arma::randu(2, 4, rho);
+  model.Responses() = arma::randi<arma::cube>(1, 4, rho,
+      arma::distr_param(1, 3));
+  model.Add<IdentityLayer<> >();
+  model.Add<Linear<> >(2, 6);
+  model.Add<FastLSTM<> >(6, 3, rho);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  arma::mat batchGradient, gradient, pointGradient;
+  const double batchObjective = model.Evaluate(model.Parameters(), 0, 4);
+  model.Gradient(model.Parameters(), 0, batchGradient, 4);
+
+  double objective = 0;
+  gradient.zeros(batchGradient.n_rows, batchGradient.n_cols);
+  for (size_t i = 0; i < 4; ++i)
+  {
+    objective += model.Evaluate(model.Parameters(), i, 1);
+    model.Gradient(model.Parameters(), i, pointGradient, 1);
+    gradient += pointGradient;
+  }
+
+  BOOST_REQUIRE_CLOSE(batchObjective, objective, 1e-5);
+  CheckMatrices(batchGradient, gradient, 1e-5);
+}
+
 /**
  * Testing the overloaded Forward() of the LSTM layer, for retrieving the cell
  * state. Besides output, the overloaded function provides read access to cell
@@ -1449,6 +1564,68 @@ BOOST_AUTO_TEST_CASE(SimpleLookupLayerTest)
   BOOST_REQUIRE_CLOSE(arma::accu(gradient), arma::accu(error), 1e-3);
 }
 
+/**
+ * Make sure that the Lookup layer sums the gradient of repeated tokens and
+ * records the columns it wrote.
+ */
+BOOST_AUTO_TEST_CASE(LookupRepeatedTokenGradientTest)
+{
+  arma::mat input, output, gradient;
+  Lookup<> module(10, 5);
+  module.Parameters().randu();
+
+  input << 3 << 7 << 3;
+  module.Forward(std::move(input), std::move(output));
+
+  arma::mat error = arma::randu(5, 3);
+  module.Gradient(std::move(input), std::move(error), std::move(gradient));
+
+  CheckMatrices(gradient.col(2), error.col(0) + error.col(2));
+  CheckMatrices(gradient.col(6), error.col(1));
+  BOOST_REQUIRE_CLOSE(arma::accu(gradient), arma::accu(error), 1e-3);
+
+  BOOST_REQUIRE_EQUAL(module.TouchedColumns().n_elem, 2);
+  BOOST_REQUIRE_EQUAL(module.TouchedColumns()(0), 2);
+  BOOST_REQUIRE_EQUAL(module.TouchedColumns()(1), 6);
+}
+
+/**
+ * Make sure that with a sparse gradient, the Lookup layer leaves the dense
+ * gradient alone and sums the columns of all calls.
+ */
+BOOST_AUTO_TEST_CASE(LookupSparseGradientTest)
+{
+  arma::mat input, output;
+  Lookup<> module(10, 5);
+  module.Parameters().randu();
+  module.SparseGradient() = true;
+
+  arma::mat gradient(5, 10);
+  gradient.fill(7.0);
+
+  input << 3 << 7 << 3;
+  module.Forward(std::move(input), std::move(output));
+  arma::mat error = arma::randu(5, 3);
+  module.Gradient(std::move(input), std::move(error), std::move(gradient));
+
+  arma::mat input2, error2 = arma::randu(5, 2);
+  input2 << 1 << 7;
+  module.Gradient(std::move(input2), std::move(error2), std::move(gradient));
+
+  BOOST_REQUIRE(arma::all(arma::vectorise(gradient) == 7.0));
+  BOOST_REQUIRE_EQUAL(module.TouchedColumns().n_elem, 3);
+  BOOST_REQUIRE_EQUAL(module.TouchedColumns()(0), 0);
+  BOOST_REQUIRE_EQUAL(module.TouchedColumns()(1), 2);
+  BOOST_REQUIRE_EQUAL(module.TouchedColumns()(2), 6);
+  CheckMatrices(module.TouchedGradient().col(0), error2.col(0));
+  CheckMatrices(module.TouchedGradient().col(1), error.col(0) + error.col(2));
+  CheckMatrices(module.TouchedGradient().col(2), error.col(1) + error2.col(1));
+
+  module.ClearTouched();
+  BOOST_REQUIRE_EQUAL(module.TouchedColumns().n_elem, 0);
+  BOOST_REQUIRE_EQUAL(module.TouchedGradient().n_elem, 0);
+}
+
 /**
  * Simple LogSoftMax module test.
  */
@@ -1560,6 +1737,28 @@ BOOST_AUTO_TEST_CASE(BatchNormTest)
   CheckMatrices(output, result, 1e-1);
 }
 
+/**
+ * Jacobian BatchNorm module test; the backward pass uses the normalized input
+ * and inverse standard deviation cached by the forward pass.
+ */
+BOOST_AUTO_TEST_CASE(JacobianBatchNormLayerTest)
+{
+  for (size_t i = 0; i < 5; i++)
+  {
+    // The batch variance shrinks with the batch size, and the finite
+    // differences get less accurate.
+    const size_t inputElements = math::RandInt(2, 100);
+    const size_t batchSize = math::RandInt(8, 17);
+    arma::mat input;
+    input.set_size(inputElements, batchSize);
+
+    BatchNorm<> module(inputElements);
+
+    double error = JacobianTest(module, input);
+    BOOST_REQUIRE_LE(error, 1e-4);
+  }
+}
+
 /**
  * BatchNorm layer numerical gradient test.
  */
@@ -1895,6 +2094,115 @@ BOOST_AUTO_TEST_CASE(GradientAtrousConvolutionLayerTest)
   BOOST_REQUIRE_LE(CheckGradient(function), 0.2);
 }
 
+/**
+ * Make sure that the im2col convolution rule gives the same results as the
+ * naive convolution rule for the Convolution and AtrousConvolution layers.
+ */
+BOOST_AUTO_TEST_CASE(Im2ColConvolutionLayerTest)
+{
+  typedef Im2ColConvolution<ValidConvolution> ValidRule;
+  typedef Im2ColConvolution<FullConvolution> FullRule;
+
+  arma::mat input = arma::randu(6 * 6 * 2, 4);
+  arma::mat output, im2colOutput, delta, im2colDelta, gradient, im2colGradient;
+
+  // Padded convolution.
+  Convolution<> module1(2, 3, 3, 3, 1, 1, 1, 1, 6, 6);
+  Convolution<ValidRule, FullRule, ValidRule> im2colModule1(2, 3, 3, 3, 1, 1,
+      1, 1, 6, 6);
+  module1.Parameters() = arma::randu(3 * 3 * 2 * 3 + 3, 1);
+  im2colModule1.Parameters() = module1.Parameters();
+  module1.Reset();
+  im2colModule1.Reset();
+
+  module1.Forward(std::move(input), std::move(output));
+  im2colModule1.Forward(std::move(input), std::move(im2colOutput));
+  CheckMatrices(output, im2colOutput, 1e-5);
+
+  arma::mat error = arma::randu(output.n_rows, output.n_cols);
+  module1.Backward(std::move(input), std::move(error), std::move(delta));
+  im2colModule1.Backward(std::move(input), std::move(error),
+      std::move(im2colDelta));
+  CheckMatrices(delta, im2colDelta, 1e-5);
+
+  // The naive rule only keeps the bias gradient of the last point, so compare
+  // the gradients on a single point.
+  arma::mat point = input.col(0);
+  module1.Forward(std::move(point), std::move(output));
+  im2colModule1.Forward(std::move(point), std::move(im2colOutput));
+  error = arma::randu(output.n_rows, 1);
+  module1.Gradient(std::move(point), std::move(error), std::move(gradient));
+  im2colModule1.Gradient(std::move(point), std::move(error),
+      std::move(im2colGradient));
+  CheckMatrices(gradient, im2colGradient, 1e-5);
+
+  // Dilated convolution.
+  AtrousConvolution<> module2(2, 3, 3, 3, 1, 1, 0, 0, 6, 6, 2, 2);
+  AtrousConvolution<ValidRule, FullRule, ValidRule> im2colModule2(2, 3, 3, 3,
+      1, 1, 0, 0, 6, 6, 2, 2);
+  module2.Parameters() = arma::randu(3 * 3 * 2 * 3 + 3, 1);
+  im2colModule2.Parameters() = module2.Parameters();
+  module2.Reset();
+  im2colModule2.Reset();
+
+  module2.Forward(std::move(input), std::move(output));
+  im2colModule2.Forward(std::move(input), std::move(im2colOutput));
+  CheckMatrices(output, im2colOutput, 1e-5);
+
+  error = arma::randu(output.n_rows, output.n_cols);
+  module2.Backward(std::move(input), std::move(error), std::move(delta));
+  im2colModule2.Backward(std::move(input), std::move(error),
+      std::move(im2colDelta));
+  CheckMatrices(delta, im2colDelta, 1e-5);
+
+  module2.Forward(std::move(point), std::move(output));
+  im2colModule2.Forward(std::move(point), std::move(im2colOutput));
+  error = arma::randu(output.n_rows, 1);
+  module2.Gradient(std::move(point), std::move(error), std::move(gradient));
+  im2colModule2.Gradient(std::move(point), std::move(error),
+      std::move(im2colGradient));
+  CheckMatrices(gradient, im2colGradient, 1e-5);
+}
+
+/**
+ * Make sure that the fft forward rule gives the same results as the naive
+ * convolution rule for the Convolution layer, also after the weights changed.
+ */
+BOOST_AUTO_TEST_CASE(FFTConvolutionLayerTest)
+{
+  typedef FFTConvolution<ValidConvolution> FFTRule;
+
+  arma::mat input = arma::randu(8 * 8 * 2, 4);
+  arma::mat output, fftOutput, delta, fftDelta;
+
+  for (size_t stride = 1; stride <= 2; ++stride)
+  {
+    Convolution<> module(2, 3, 5, 5, stride, stride, 1, 1, 8, 8);
+    Convolution<FFTRule> fftModule(2, 3, 5, 5, stride, stride, 1, 1, 8, 8);
+    module.Parameters() = arma::randu(5 * 5 * 2 * 3 + 3, 1);
+    fftModule.Parameters() = module.Parameters();
+    module.Reset();
+    fftModule.Reset();
+
+    module.Forward(std::move(input), std::move(output));
+    fftModule.Forward(std::move(input), std::move(fftOutput));
+    CheckMatrices(output, fftOutput, 1e-5);
+
+    arma::mat error = arma::randu(output.n_rows, output.n_cols);
+    module.Backward(std::move(input), std::move(error), std::move(delta));
+    fftModule.Backward(std::move(input), std::move(error),
+        std::move(fftDelta));
+    CheckMatrices(delta, fftDelta, 1e-5);
+
+    // The cached filter spectra have to follow the new weights.
+    module.Parameters() = arma::randu(5 * 5 * 2 * 3 + 3, 1);
+    fftModule.Parameters() = module.Parameters();
+    module.Forward(std::move(input), std::move(output));
+    fftModule.Forward(std::move(input), std::move(fftOutput));
+    CheckMatrices(output, fftOutput, 1e-5);
+  }
+}
+
 /**
  * Tests the LayerNorm layer.
  */
@@ -1929,6 +2237,25 @@ BOOST_AUTO_TEST_CASE(LayerNormTest)
   CheckMatrices(output, result, 1e-1);
 }
 
+/**
+ * Jacobian LayerNorm module test.
+ */
+BOOST_AUTO_TEST_CASE(JacobianLayerNormLayerTest)
+{
+  for (size_t i = 0; i < 5; i++)
+  {
+    const size_t inputElements = math::RandInt(10, 100);
+    const size_t batchSize = math::RandInt(1, 10);
+    arma::mat input;
+    input.set_size(inputElements, batchSize);
+
+    LayerNorm<> module(inputElements);
+
+    double error = JacobianTest(module, input);
+    BOOST_REQUIRE_LE(error, 1e-4);
+  }
+}
+
 /**
  * LayerNorm layer numerical gradient test.
  */
@@ -2428,6 +2755,106 @@ void ANNLayerSerializationTest(LayerType& layer)
   CheckMatrices(originalOutput, binaryOutput, 1e-5);
 }
 
+/**
+ * Pool the maps of the given input with a brute-force loop over square windows
+ * with a stride of 2, and pass the given error back to the input.
+ */
+void StridedPoolingReference(const arma::mat& input,
+                             const arma::mat& error,
+                             const size_t width,
+                             const size_t height,
+                             const size_t k,
+                             const bool max,
+                             arma::mat& output,
+                             arma::mat& delta)
+{
+  const size_t maps = input.n_rows / (width * height);
+  const size_t outWidth = (width - k) / 2 + 1;
+  const size_t outHeight = (height - k) / 2 + 1;
+
+  output.zeros(outWidth * outHeight * maps, input.n_cols);
+  delta.zeros(input.n_rows, input.n_cols);
+  for (size_t p = 0; p < input.n_cols; ++p)
+  {
+    for (size_t m = 0; m < maps; ++m)
+    {
+      for (size_t j = 0; j < outHeight; ++j)
+      {
+        for (size_t i = 0; i < outWidth; ++i)
+        {
+          const size_t o = (m * outHeight + j) * outWidth + i;
+          size_t best = (m * height + 2 * j) * width + 2 * i;
+          for (size_t c = 0; c < k; ++c)
+          {
+            for (size_t r = 0; r < k; ++r)
+            {
+              const size_t e = (m * height + 2 * j + c) * width + 2 * i + r;
+              if (input(e, p) > input(best, p))
+                best = e;
+
+              if (!max)
+              {
+                output(o, p) += input(e, p) / (k * k);
+                delta(e, p) += error(o, p) / (k * k);
+              }
+            }
+          }
+
+          if (max)
+          {
+            output(o, p) = input(best, p);
+            delta(best, p) += error(o, p);
+          }
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Make sure the strided 2x2 and 3x3 pooling kernels of the max and mean
+ * pooling layers match a brute-force reference.
+ */
+BOOST_AUTO_TEST_CASE(StridedPoolingLayerTest)
+{
+  const size_t width = 7, height = 6, maps = 3;
+  for (size_t k = 2; k <= 3; ++k)
+  {
+    // Round the input so that some windows have ties.
+    arma::mat input = arma::round(arma::randu(width * height * maps, 4) * 5);
+    arma::mat output, delta, expectedOutput, expectedDelta;
+
+    MaxPooling<> maxPooling(k, k, 2, 2);
+    maxPooling.InputWidth() = width;
+    maxPooling.InputHeight() = height;
+    maxPooling.Forward(std::move(input), std::move(output));
+
+    arma::mat error = arma::randn(output.n_rows, output.n_cols);
+    maxPooling.Backward(std::move(input), std::move(error), std::move(delta));
+    StridedPoolingReference(input, error, width, height, k, true,
+        expectedOutput, expectedDelta);
+
+    CheckMatrices(output, expectedOutput);
+    CheckMatrices(delta, expectedDelta);
+
+    // The deterministic pass must give the same output.
+    maxPooling.Deterministic() = true;
+    maxPooling.Forward(std::move(input), std::move(output));
+    CheckMatrices(output, expectedOutput);
+
+    MeanPooling<> meanPooling(k, k, 2, 2);
+    meanPooling.InputWidth() = width;
+    meanPooling.InputHeight() = height;
+    meanPooling.Forward(std::move(input), std::move(output));
+    meanPooling.Backward(std::move(input), std::move(error), std::move(delta));
+    StridedPoolingReference(input, error, width, height, k, false,
+        expectedOutput, expectedDelta);
+
+    CheckMatrices(output, expectedOutput);
+    CheckMatrices(delta, expectedDelta);
+  }
+}
+
 /**
  * Simple serialization test for batch normalization layer.
  */
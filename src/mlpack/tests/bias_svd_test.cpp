@@ -302,6 +302,84 @@ BOOST_AUTO_TEST_CASE(BiasSVDFunctionOptimize)
   BOOST_REQUIRE_SMALL(relativeError, 1e-2);
 }
 
+// Test Bias SVD with stratified SGD, with a number of strata that does not
+// depend on the number of threads.
+BOOST_AUTO_TEST_CASE(BiasSVDFunctionStratifiedOptimize)
+{
+  // Define useful constants.
+  const size_t numUsers = 50;
+  const size_t numItems = 50;
+  const size_t numRatings = 100;
+  const size_t rank = 10;
+  const double alpha = 0.01;
+  const double lambda = 0.01;
+
+  // Initiate random parameters.
+  arma::mat parameters = arma::randu(rank + 1, numUsers + numItems);
+
+  // Make a random rating dataset.
+  arma::mat data = arma::randu(3, numRatings);
+  data.row(0) = floor(data.row(0) * numUsers);
+  data.row(1) = floor(data.row(1) * numItems);
+
+  // Manually set last row to maximum user and maximum item.
+  data(0, numRatings - 1) = numUsers - 1;
+  data(1, numRatings - 1) = numItems - 1;
+
+  // Make rating entries based on the parameters.
+  for (size_t i = 0; i < numRatings; i++)
+  {
+    const size_t user = data(0, i);
+    const size_t item = data(1, i) + numUsers;
+    const double userBias = parameters(rank, user);
+    const double itemBias = parameters(rank, item);
+    data(2, i) = userBias + itemBias +
+        arma::dot(parameters.col(user).subvec(0, rank - 1),
+                  parameters.col(item).subvec(0, rank - 1));
+  }
+
+  // Make the Bias SVD function and the optimizer, and iterate till
+  // convergence.
+  BiasSVDFunction<arma::mat> biasSVDFunc(data, rank, lambda);
+  StratifiedSGD optimizer(alpha, 0, 7);
+
+  // Obtain optimized parameters after training.
+  arma::mat optParameters = arma::randu(rank + 1, numUsers + numItems);
+  optimizer.Optimize(biasSVDFunc, optParameters);
+
+  // Get predicted ratings from optimized parameters.
+  arma::mat predictedData(1, numRatings);
+  for (size_t i = 0; i < numRatings; i++)
+  {
+    const size_t user = data(0, i);
+    const size_t item = data(1, i) + numUsers;
+    const double userBias = optParameters(rank, user);
+    const double itemBias = optParameters(rank, item);
+    predictedData(0, i) = userBias + itemBias +
+        arma::dot(optParameters.col(user).subvec(0, rank - 1),
+                  optParameters.col(item).subvec(0, rank - 1));
+  }
+
+  // Calculate relative error.
+  const double relativeError = arma::norm(data.row(2) - predictedData, "frob") /
+                               arma::norm(data, "frob");
+
+  // Relative error should be small.
+  BOOST_REQUIRE_SMALL(relativeError, 1e-2);
+
+  // BiasSVD<StratifiedSGD> should give the same output sizes as BiasSVD<>.
+  arma::mat u, v;
+  arma::vec p, q;
+  BiasSVD<StratifiedSGD> biasSVD(10, alpha, lambda);
+  biasSVD.Apply(data, rank, u, v, p, q);
+  BOOST_REQUIRE_EQUAL(u.n_rows, numItems);
+  BOOST_REQUIRE_EQUAL(u.n_cols, rank);
+  BOOST_REQUIRE_EQUAL(v.n_rows, rank);
+  BOOST_REQUIRE_EQUAL(v.n_cols, numUsers);
+  BOOST_REQUIRE_EQUAL(p.n_elem, numItems);
+  BOOST_REQUIRE_EQUAL(q.n_elem, numUsers);
+}
+
 // The test is only compiled if the user has specified OpenMP to be
 // used.
 #ifdef HAS_OPENMP
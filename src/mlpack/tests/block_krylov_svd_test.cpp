@@ -109,4 +109,40 @@ BOOST_AUTO_TEST_CASE(RandomizedBlockKrylovSVDNoisyLowRankTest)
   BOOST_REQUIRE_SMALL(error, 1e-2);
 }
 
+/*
+ * The sparse overload with a mean should give the same factorization as the
+ * dense one on the explicitly centered data.
+ */
+BOOST_AUTO_TEST_CASE(RandomizedBlockKrylovSVDSparseTest)
+{
+  arma::sp_mat data;
+  data.sprandu(100, 300, 0.1);
+  const arma::vec mean = arma::vec(arma::mat(arma::sum(data, 1))) /
+      data.n_cols;
+  arma::mat centeredData(data);
+  centeredData.each_col() -= mean;
+
+  arma::mat U1, U2, V1, V2;
+  arma::vec s1, s2;
+
+  svd::RandomizedBlockKrylovSVD rSVD(5, 15);
+  math::RandomSeed(10);
+  rSVD.Apply(data, U1, s1, V1, 5, mean);
+  math::RandomSeed(10);
+  rSVD.Apply(centeredData, U2, s2, V2, 5);
+
+  BOOST_REQUIRE_EQUAL(s1.n_elem, s2.n_elem);
+  for (size_t i = 0; i < 5; ++i)
+    BOOST_REQUIRE_CLOSE(s1[i], s2[i], 1e-3);
+
+  // Without a mean, the sparse data itself is decomposed.
+  arma::vec s3;
+  math::RandomSeed(10);
+  rSVD.Apply(data, U1, s3, V1, 5);
+  math::RandomSeed(10);
+  rSVD.Apply(arma::mat(data), U2, s2, V2, 5);
+  for (size_t i = 0; i < 5; ++i)
+    BOOST_REQUIRE_CLOSE(s3[i], s2[i], 1e-3);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
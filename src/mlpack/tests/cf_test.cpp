@@ -13,6 +13,8 @@
 
 #include <mlpack/core.hpp>
 #include <mlpack/methods/cf/cf.hpp>
+#include <mlpack/methods/cf/load_ratings.hpp>
+#include <mlpack/methods/cf/decomposition_policies/als_method.hpp>
 #include <mlpack/methods/cf/decomposition_policies/batch_svd_method.hpp>
 #include <mlpack/methods/cf/decomposition_policies/bias_svd_method.hpp>
 #include <mlpack/methods/cf/decomposition_policies/randomized_svd_method.hpp>
@@ -34,6 +36,7 @@
 #include <mlpack/methods/cf/interpolation_policies/regression_interpolation.hpp>
 
 #include <iostream>
+#include <fstream>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -546,6 +549,15 @@ BOOST_AUTO_TEST_CASE(CFGetRecommendationsAllUsersNMFTest)
   GetRecommendationsAllUsers<NMFPolicy>();
 }
 
+/**
+ * Make sure that correct number of recommendations are generated when query
+ * set for ALS.
+ */
+BOOST_AUTO_TEST_CASE(CFGetRecommendationsAllUsersALSTest)
+{
+  GetRecommendationsAllUsers<ALSPolicy>();
+}
+
 /**
  * Make sure that correct number of recommendations are generated when query
  * set for SVD Complete Incremental method.
@@ -998,6 +1010,14 @@ BOOST_AUTO_TEST_CASE(SerializationNMFTest)
   Serialization<NMFPolicy>();
 }
 
+/**
+ * Ensure we can load and save the CF model using ALS policy.
+ */
+BOOST_AUTO_TEST_CASE(SerializationALSTest)
+{
+  Serialization<ALSPolicy>();
+}
+
 /**
  * Ensure we can load and save the CF model using SVD Complete Incremental.
  */
@@ -1228,4 +1248,382 @@ BOOST_AUTO_TEST_CASE(CFPredictRegressionInterpolation)
             RegressionInterpolation>(2.0);
 }
 
+/**
+ * Make sure that the blocked GetWeightedRatings() of a decomposition policy
+ * gives the same ratings as combining the ratings of each user.
+ */
+template<typename DecompositionPolicy>
+void WeightedRatings()
+{
+  DecompositionPolicy decomposition;
+
+  arma::mat dataset;
+  data::Load("GroupLensSmall.csv", dataset);
+
+  CFType<DecompositionPolicy> c(dataset, decomposition, 5, 5, 30);
+
+  // Random groups of users, with random weights.
+  arma::Mat<size_t> neighborhood = arma::randi<arma::Mat<size_t>>(5, 20,
+      arma::distr_param(0, c.CleanedData().n_cols - 1));
+  arma::mat weights = arma::randu<arma::mat>(5, 20);
+
+  arma::mat ratings;
+  c.Decomposition().GetWeightedRatings(neighborhood, weights, ratings);
+
+  BOOST_REQUIRE_EQUAL(ratings.n_rows, c.CleanedData().n_rows);
+  BOOST_REQUIRE_EQUAL(ratings.n_cols, neighborhood.n_cols);
+  for (size_t i = 0; i < neighborhood.n_cols; ++i)
+  {
+    arma::vec expected(c.CleanedData().n_rows, arma::fill::zeros);
+    for (size_t j = 0; j < neighborhood.n_rows; ++j)
+    {
+      arma::vec userRatings;
+      c.Decomposition().GetRatingOfUser(neighborhood(j, i), userRatings);
+      expected += weights(j, i) * userRatings;
+    }
+
+    for (size_t k = 0; k < expected.n_elem; ++k)
+    {
+      if (std::abs(expected[k]) < 1e-5)
+        BOOST_REQUIRE_SMALL(ratings(k, i), 1e-5);
+      else
+        BOOST_REQUIRE_CLOSE(ratings(k, i), expected[k], 1e-5);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(WeightedRatingsRegSVDTest)
+{
+  WeightedRatings<RegSVDPolicy>();
+}
+
+BOOST_AUTO_TEST_CASE(WeightedRatingsBiasSVDTest)
+{
+  WeightedRatings<BiasSVDPolicy>();
+}
+
+/**
+ * Make sure that GetRecommendations() gives the same recommendations with an
+ * item index as without it.  Items with equal ratings may be returned in a
+ * different order, so we compare the predicted ratings of the
+ * recommendations.
+ */
+template<typename DecompositionPolicy>
+void ItemIndexRecommendations()
+{
+  DecompositionPolicy decomposition;
+
+  arma::mat dataset;
+  data::Load("GroupLensSmall.csv", dataset);
+
+  CFType<DecompositionPolicy> c(dataset, decomposition, 5, 5, 30);
+
+  arma::Mat<size_t> recommendations;
+  c.GetRecommendations(10, recommendations);
+
+  BOOST_REQUIRE(!c.HasItemIndex());
+  c.BuildItemIndex();
+  BOOST_REQUIRE(c.HasItemIndex());
+
+  arma::Mat<size_t> indexRecommendations;
+  c.GetRecommendations(10, indexRecommendations);
+
+  BOOST_REQUIRE_EQUAL(indexRecommendations.n_rows, recommendations.n_rows);
+  BOOST_REQUIRE_EQUAL(indexRecommendations.n_cols, recommendations.n_cols);
+
+  arma::Mat<size_t> combinations(2, recommendations.n_elem);
+  arma::Mat<size_t> indexCombinations(2, recommendations.n_elem);
+  for (size_t i = 0; i < recommendations.n_elem; ++i)
+  {
+    combinations(0, i) = i / recommendations.n_rows;
+    combinations(1, i) = recommendations[i];
+    indexCombinations(0, i) = i / recommendations.n_rows;
+    indexCombinations(1, i) = indexRecommendations[i];
+  }
+
+  arma::vec predictions, indexPredictions;
+  c.Predict(combinations, predictions);
+  c.Predict(indexCombinations, indexPredictions);
+  for (size_t i = 0; i < predictions.n_elem; ++i)
+  {
+    if (std::abs(predictions[i]) < 1e-5)
+      BOOST_REQUIRE_SMALL(indexPredictions[i], 1e-5);
+    else
+      BOOST_REQUIRE_CLOSE(indexPredictions[i], predictions[i], 1e-5);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ItemIndexRecommendationsRegSVDTest)
+{
+  ItemIndexRecommendations<RegSVDPolicy>();
+}
+
+BOOST_AUTO_TEST_CASE(ItemIndexRecommendationsBiasSVDTest)
+{
+  ItemIndexRecommendations<BiasSVDPolicy>();
+}
+
+/**
+ * Make sure that an item index can't be built for a decomposition without
+ * item vectors.
+ */
+BOOST_AUTO_TEST_CASE(ItemIndexSVDPlusPlusTest)
+{
+  SVDPlusPlusPolicy decomposition;
+
+  arma::mat dataset;
+  data::Load("GroupLensSmall.csv", dataset);
+
+  CFType<SVDPlusPlusPolicy> c(dataset, decomposition, 5, 5, 10);
+
+  BOOST_REQUIRE_THROW(c.BuildItemIndex(), std::invalid_argument);
+  BOOST_REQUIRE(!c.HasItemIndex());
+}
+
+/**
+ * Fold in a new user whose ratings are the predicted ratings of an existing
+ * user; the new user's predicted ratings should then be the same.
+ */
+template<typename DecompositionPolicy>
+void FoldInNewUser()
+{
+  DecompositionPolicy decomposition;
+
+  arma::mat dataset;
+  data::Load("GroupLensSmall.csv", dataset);
+
+  CFType<DecompositionPolicy> c(dataset, decomposition, 5, 5, 30);
+  const size_t numUsers = c.CleanedData().n_cols;
+  const size_t numItems = c.CleanedData().n_rows;
+
+  arma::vec userRatings;
+  c.Decomposition().GetRatingOfUser(3, userRatings);
+  arma::sp_vec ratings(userRatings);
+
+  c.FoldIn(numUsers, ratings, 1e-10);
+
+  BOOST_REQUIRE_EQUAL(c.CleanedData().n_cols, numUsers + 1);
+  BOOST_REQUIRE_EQUAL(c.CleanedData().n_rows, numItems);
+
+  arma::vec newRatings;
+  c.Decomposition().GetRatingOfUser(numUsers, newRatings);
+  for (size_t i = 0; i < numItems; ++i)
+  {
+    if (std::abs(userRatings[i]) < 1e-5)
+      BOOST_REQUIRE_SMALL(newRatings[i], 1e-5);
+    else
+      BOOST_REQUIRE_CLOSE(newRatings[i], userRatings[i], 1e-3);
+  }
+
+  // Folding in the same ratings for an existing user shouldn't add a user.
+  c.FoldIn(3, ratings);
+  BOOST_REQUIRE_EQUAL(c.CleanedData().n_cols, numUsers + 1);
+
+  // The new user can get recommendations; it has rated every item, though.
+  arma::Mat<size_t> recommendations;
+  arma::Col<size_t> users(1);
+  users[0] = numUsers;
+  c.GetRecommendations(5, recommendations, users);
+  BOOST_REQUIRE_EQUAL(recommendations.n_cols, 1);
+
+  // User IDs past the next new user are not allowed.
+  BOOST_REQUIRE_THROW(c.FoldIn(numUsers + 5, ratings), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(FoldInNewUserRegSVDTest)
+{
+  FoldInNewUser<RegSVDPolicy>();
+}
+
+BOOST_AUTO_TEST_CASE(FoldInNewUserBiasSVDTest)
+{
+  FoldInNewUser<BiasSVDPolicy>();
+}
+
+/**
+ * Make sure that folding in a new user with UserMeanNormalization gives the
+ * user a mean.
+ */
+BOOST_AUTO_TEST_CASE(FoldInUserMeanNormalizationTest)
+{
+  arma::mat dataset;
+  data::Load("GroupLensSmall.csv", dataset);
+
+  CFType<RegSVDPolicy, UserMeanNormalization> c(dataset, RegSVDPolicy(), 5,
+      5, 30);
+  const size_t numUsers = c.CleanedData().n_cols;
+
+  arma::sp_vec ratings(c.CleanedData().n_rows);
+  ratings[0] = 4.0;
+  ratings[1] = 2.0;
+  c.FoldIn(numUsers, ratings);
+
+  BOOST_REQUIRE_EQUAL(c.Normalization().Mean().n_elem, numUsers + 1);
+  BOOST_REQUIRE_CLOSE(c.Normalization().Mean()[numUsers], 3.0, 1e-5);
+  BOOST_REQUIRE_CLOSE(c.CleanedData()(0, numUsers), 1.0, 1e-5);
+  BOOST_REQUIRE_CLOSE(c.CleanedData()(1, numUsers), -1.0, 1e-5);
+}
+
+/**
+ * Make sure that a serving model gives the same predictions as the model it
+ * was saved from (up to single precision), and recommends only unrated items,
+ * in descending order of predicted rating.
+ */
+template<typename NormalizationType>
+void ServingModel()
+{
+  arma::mat dataset;
+  data::Load("GroupLensSmall.csv", dataset);
+
+  CFType<RegSVDPolicy, NormalizationType> c(dataset, RegSVDPolicy(), 5, 5,
+      30);
+  c.SaveServingModel("cf_serving_model_test.cf");
+
+  {
+    CFServingModel model("cf_serving_model_test.cf");
+    BOOST_REQUIRE_EQUAL(model.NumUsers(), c.CleanedData().n_cols);
+    BOOST_REQUIRE_EQUAL(model.NumItems(), c.CleanedData().n_rows);
+    BOOST_REQUIRE_EQUAL(model.Rank(), 5);
+
+    arma::Mat<size_t> combinations(2, 300);
+    for (size_t i = 0; i < combinations.n_cols; ++i)
+    {
+      combinations(0, i) = math::RandInt(model.NumUsers());
+      combinations(1, i) = math::RandInt(model.NumItems());
+    }
+
+    arma::vec predictions, servingPredictions;
+    c.Predict(combinations, predictions);
+    model.Predict(combinations, servingPredictions);
+    BOOST_REQUIRE_EQUAL(servingPredictions.n_elem, predictions.n_elem);
+    for (size_t i = 0; i < predictions.n_elem; ++i)
+      BOOST_REQUIRE_SMALL(servingPredictions[i] - predictions[i], 1e-3);
+
+    arma::Mat<size_t> recommendations;
+    model.GetRecommendations(10, recommendations);
+    BOOST_REQUIRE_EQUAL(recommendations.n_rows, 10);
+    BOOST_REQUIRE_EQUAL(recommendations.n_cols, model.NumUsers());
+    for (size_t u = 0; u < recommendations.n_cols; ++u)
+    {
+      for (size_t i = 0; i < recommendations.n_rows; ++i)
+      {
+        const size_t item = recommendations(i, u);
+        BOOST_REQUIRE_LT(item, model.NumItems());
+        BOOST_REQUIRE_EQUAL(c.CleanedData()(item, u), 0.0);
+        if (i > 0)
+        {
+          BOOST_REQUIRE_LE(model.Predict(u, item),
+              model.Predict(u, recommendations(i - 1, u)) + 1e-10);
+        }
+      }
+    }
+
+    BOOST_REQUIRE_THROW(model.Predict(model.NumUsers(), 0),
+        std::invalid_argument);
+  }
+
+  remove("cf_serving_model_test.cf");
+}
+
+BOOST_AUTO_TEST_CASE(ServingModelNoNormalizationTest)
+{
+  ServingModel<NoNormalization>();
+}
+
+BOOST_AUTO_TEST_CASE(ServingModelCombinedNormalizationTest)
+{
+  ServingModel<CombinedNormalization<OverallMeanNormalization,
+      UserMeanNormalization, ItemMeanNormalization>>();
+}
+
+/**
+ * Make sure that a serving model can't be saved for a decomposition without
+ * item vectors, and that other files can't be loaded as serving models.
+ */
+BOOST_AUTO_TEST_CASE(ServingModelInvalidTest)
+{
+  arma::mat dataset;
+  data::Load("GroupLensSmall.csv", dataset);
+
+  CFType<SVDPlusPlusPolicy> c(dataset, SVDPlusPlusPolicy(), 5, 5, 10);
+  BOOST_REQUIRE_THROW(c.SaveServingModel("cf_serving_model_test.cf"),
+      std::invalid_argument);
+
+  BOOST_REQUIRE_THROW(CFServingModel model("GroupLensSmall.csv"),
+      std::runtime_error);
+}
+
+/**
+ * Make sure that LoadRatings() builds the same matrix as CleanData() does from
+ * the loaded coordinate list, even when lines span several chunks.
+ */
+BOOST_AUTO_TEST_CASE(LoadRatingsTest)
+{
+  arma::mat dataset;
+  data::Load("GroupLensSmall.csv", dataset);
+
+  arma::sp_mat cleanedData;
+  CFType<>::CleanData(dataset, cleanedData);
+
+  arma::sp_mat ratings;
+  LoadRatings("GroupLensSmall.csv", ratings, 7);
+
+  BOOST_REQUIRE_EQUAL(ratings.n_rows, cleanedData.n_rows);
+  BOOST_REQUIRE_EQUAL(ratings.n_cols, cleanedData.n_cols);
+  BOOST_REQUIRE_EQUAL(ratings.n_nonzero, cleanedData.n_nonzero);
+  BOOST_REQUIRE_SMALL(arma::accu(arma::abs(ratings - cleanedData)), 1e-10);
+}
+
+/**
+ * Make sure that LoadRatings() handles different separators, skips empty
+ * lines and ratings of zero, and maps sparse IDs to contiguous indices.
+ */
+BOOST_AUTO_TEST_CASE(LoadRatingsMappedIDsTest)
+{
+  std::ofstream stream("cf_load_ratings_test.txt");
+  stream << "10,200,4.5\n"
+         << "30\t100\t1\n"
+         << "\n"
+         << "10 100 0\n"
+         << "  20, 300 ,2.0\r\n"
+         << "10,300,3";
+  stream.close();
+
+  arma::sp_mat ratings;
+  arma::Col<size_t> userIDs, itemIDs;
+  LoadRatings("cf_load_ratings_test.txt", ratings, userIDs, itemIDs, 5);
+
+  BOOST_REQUIRE_EQUAL(userIDs.n_elem, 3);
+  BOOST_REQUIRE_EQUAL(userIDs[0], 10);
+  BOOST_REQUIRE_EQUAL(userIDs[1], 30);
+  BOOST_REQUIRE_EQUAL(userIDs[2], 20);
+  BOOST_REQUIRE_EQUAL(itemIDs.n_elem, 3);
+  BOOST_REQUIRE_EQUAL(itemIDs[0], 200);
+  BOOST_REQUIRE_EQUAL(itemIDs[1], 100);
+  BOOST_REQUIRE_EQUAL(itemIDs[2], 300);
+
+  BOOST_REQUIRE_EQUAL(ratings.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(ratings.n_cols, 3);
+  BOOST_REQUIRE_EQUAL(ratings.n_nonzero, 4);
+  BOOST_REQUIRE_CLOSE((double) ratings(0, 0), 4.5, 1e-5);
+  BOOST_REQUIRE_CLOSE((double) ratings(1, 1), 1.0, 1e-5);
+  BOOST_REQUIRE_CLOSE((double) ratings(2, 2), 2.0, 1e-5);
+  BOOST_REQUIRE_CLOSE((double) ratings(2, 0), 3.0, 1e-5);
+
+  // Without mapping, the IDs are the indices.
+  LoadRatings("cf_load_ratings_test.txt", ratings);
+  BOOST_REQUIRE_EQUAL(ratings.n_rows, 301);
+  BOOST_REQUIRE_EQUAL(ratings.n_cols, 31);
+  BOOST_REQUIRE_CLOSE((double) ratings(300, 20), 2.0, 1e-5);
+
+  // A line without a rating can't be parsed.
+  stream.open("cf_load_ratings_test.txt");
+  stream << "1,2,3\n4,5\n6,7,8\n";
+  stream.close();
+  BOOST_REQUIRE_THROW(LoadRatings("cf_load_ratings_test.txt", ratings),
+      std::runtime_error);
+
+  remove("cf_load_ratings_test.txt");
+}
+
 BOOST_AUTO_TEST_SUITE_END();
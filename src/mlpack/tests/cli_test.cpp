@@ -10,6 +10,8 @@
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
 #include <mlpack/core.hpp>
+#include <atomic>
+#include <thread>
 // We'll use CLIOptions.
 #include <mlpack/bindings/cli/cli_option.hpp>
 
@@ -27,6 +29,7 @@ static const std::string testName = "";
 #include <mlpack/core/util/param.hpp>
 #include <mlpack/bindings/cli/parse_command_line.hpp>
 #include <mlpack/bindings/cli/end_program.hpp>
+#include <mlpack/bindings/cli/serve.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -1125,4 +1128,287 @@ BOOST_AUTO_TEST_CASE(CppNameTest)
   BOOST_REQUIRE_EQUAL(CLI::Parameters().at("double").cppType, "double");
 }
 
+/**
+ * Make sure that a CLI::Context gets its own parameters, and that they don't
+ * leak into the global singleton or into the contexts of other threads.
+ */
+BOOST_AUTO_TEST_CASE(ContextTest)
+{
+  AddRequiredCLIOptions();
+
+  PARAM_INT_IN("int", "Test int", "i", 0);
+  CLI::GetParam<int>("int") = 7;
+  CLI::StoreSettings("context_test");
+  CLI::RestoreSettings("context_test");
+
+  {
+    CLI::Context context;
+    CLI::RestoreSettings("context_test");
+
+    BOOST_REQUIRE_EQUAL(CLI::GetParam<int>("int"), 7);
+    CLI::GetParam<int>("int") = 3;
+    CLI::SetPassed("int");
+    BOOST_REQUIRE(CLI::HasParam("int"));
+  }
+
+  // The global parameters must not have changed.
+  BOOST_REQUIRE(!CLI::HasParam("int"));
+  BOOST_REQUIRE_EQUAL(CLI::GetParam<int>("int"), 7);
+
+  // Now set a different value in a context in each of several threads.
+  std::vector<int> results(4, -1);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    threads.push_back(std::thread([&results, i]()
+    {
+      CLI::Context context;
+      CLI::RestoreSettings("context_test");
+      CLI::GetParam<int>("int") = (int) i;
+      for (size_t j = 0; j < 1000; ++j)
+        std::this_thread::yield();
+      results[i] = CLI::GetParam<int>("int");
+    }));
+  }
+
+  for (size_t i = 0; i < threads.size(); ++i)
+    threads[i].join();
+
+  for (size_t i = 0; i < results.size(); ++i)
+    BOOST_REQUIRE_EQUAL(results[i], (int) i);
+  BOOST_REQUIRE_EQUAL(CLI::GetParam<int>("int"), 7);
+}
+
+/**
+ * Make sure that programs with a "seed" option don't run in several threads at
+ * once inside a CLI::RandomScope, and that other programs don't wait.
+ */
+BOOST_AUTO_TEST_CASE(RandomScopeTest)
+{
+  AddRequiredCLIOptions();
+
+  PARAM_INT_IN("seed", "Random seed", "s", 0);
+  CLI::StoreSettings("random_scope_test");
+
+  std::atomic<int> running(0), maxRunning(0);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 4; ++i)
+  {
+    threads.push_back(std::thread([&running, &maxRunning]()
+    {
+      CLI::Context context;
+      CLI::RestoreSettings("random_scope_test");
+      CLI::RandomScope randomScope;
+
+      const int current = ++running;
+      int max = maxRunning.load();
+      while (current > max && !maxRunning.compare_exchange_weak(max, current))
+      { /* max now holds the current value; try again. */ }
+      for (size_t j = 0; j < 1000; ++j)
+        std::this_thread::yield();
+      --running;
+    }));
+  }
+
+  for (size_t i = 0; i < threads.size(); ++i)
+    threads[i].join();
+
+  BOOST_REQUIRE_EQUAL(maxRunning.load(), 1);
+
+  // A program without a seed doesn't wait for one that seeds.
+  {
+    CLI::Context context;
+    CLI::RestoreSettings("random_scope_test");
+    CLI::RandomScope randomScope;
+
+    bool ran = false;
+    std::thread thread([&ran]()
+    {
+      CLI::Context otherContext;
+      CLI::RestoreSettings("random_scope_test");
+      CLI::Parameters().erase("seed");
+      CLI::RandomScope otherScope;
+      ran = true;
+    });
+    thread.join();
+    BOOST_REQUIRE(ran);
+  }
+}
+
+/**
+ * Make sure that a Threads::Scope changes the number of threads of its own
+ * thread only, and restores it when destroyed.
+ */
+BOOST_AUTO_TEST_CASE(ThreadsScopeTest)
+{
+  Threads::Set(0);
+  BOOST_REQUIRE_EQUAL(Threads::Get(), Threads::Available());
+
+  Threads::Set(3);
+  BOOST_REQUIRE_EQUAL(Threads::Get(), 3);
+  {
+    Threads::Scope scope(2);
+    BOOST_REQUIRE_EQUAL(Threads::Get(), 2);
+    {
+      Threads::Scope inner(0);
+      BOOST_REQUIRE_EQUAL(Threads::Get(), 3);
+    }
+    BOOST_REQUIRE_EQUAL(Threads::Get(), 2);
+
+    // Other threads keep the process-wide setting.
+    size_t other = 0;
+    std::thread thread([&other]() { other = Threads::Get(); });
+    thread.join();
+    BOOST_REQUIRE_EQUAL(other, 3);
+  }
+  BOOST_REQUIRE_EQUAL(Threads::Get(), 3);
+
+  Threads::Set(0);
+  BOOST_REQUIRE_EQUAL(Threads::Get(), Threads::Available());
+}
+
+/**
+ * Make sure that requests to a server are split into options correctly.
+ */
+BOOST_AUTO_TEST_CASE(SplitRequestTest)
+{
+  vector<string> args = SplitRequest("  --a 1\t-b \"c d\\\"\" \"\"");
+  BOOST_REQUIRE_EQUAL(args.size(), 5);
+  BOOST_REQUIRE_EQUAL(args[0], "--a");
+  BOOST_REQUIRE_EQUAL(args[1], "1");
+  BOOST_REQUIRE_EQUAL(args[2], "-b");
+  BOOST_REQUIRE_EQUAL(args[3], "c d\"");
+  BOOST_REQUIRE_EQUAL(args[4], "");
+
+  BOOST_REQUIRE_EQUAL(SplitRequest("").size(), 0);
+  BOOST_REQUIRE_THROW(SplitRequest("--a \"b"), std::invalid_argument);
+}
+
+//! A program for ServerWorkerTest, which doubles --int.
+static void DoubleMain()
+{
+  if (CLI::GetParam<int>("int") < 0)
+    throw std::invalid_argument("negative");
+  CLI::GetParam<int>("out") = 2 * CLI::GetParam<int>("int");
+}
+
+/**
+ * Make sure that a server worker answers requests, keeps the options given on
+ * the command line, and reports errors.
+ */
+BOOST_AUTO_TEST_CASE(ServerWorkerTest)
+{
+  AddRequiredCLIOptions();
+
+  PARAM_INT_IN("int", "Test int", "i", 0);
+  PARAM_INT_OUT("out", "Test output int");
+  PARAM_INT_IN("other", "Test other int", "o", 0);
+
+  const char* argv[3] = { "./test", "--int", "7" };
+  ParseCommandLine(3, const_cast<char**>(argv));
+  CLI::StoreSettings("mlpack_server");
+
+  // The responses, and the output when each was sent.
+  vector<string> responses;
+  vector<int> outputs;
+  std::function<void(const string&)> respond = [&](const string& status)
+  {
+    responses.push_back(status);
+    outputs.push_back(CLI::GetParam<int>("out"));
+  };
+
+  // The options of a request only last for that request.
+  int intAfter = 0;
+  bool otherAfter = true;
+  std::thread thread([&]()
+  {
+    std::mutex outputMutex;
+    ServerWorker worker(DoubleMain, outputMutex);
+
+    worker.Run("", respond);
+    worker.Run("--int 3 --other 1", respond);
+    intAfter = CLI::GetParam<int>("int");
+    otherAfter = CLI::HasParam("other");
+    worker.Run("--int -1", respond);
+    worker.Run("--unknown", respond);
+  });
+  thread.join();
+
+  BOOST_REQUIRE_EQUAL(intAfter, 7);
+  BOOST_REQUIRE(!otherAfter);
+
+  BOOST_REQUIRE_EQUAL(responses.size(), 4);
+  BOOST_REQUIRE_EQUAL(responses[0], "OK");
+  BOOST_REQUIRE_EQUAL(outputs[0], 14);
+  BOOST_REQUIRE_EQUAL(responses[1], "OK");
+  BOOST_REQUIRE_EQUAL(outputs[1], 6);
+  BOOST_REQUIRE_EQUAL(responses[2], "ERROR negative");
+  BOOST_REQUIRE_EQUAL(responses[3].substr(0, 6), "ERROR ");
+}
+
+//! A program for ServeTest, which warns and doubles --int.
+static void WarnDoubleMain()
+{
+  Log::Warn << "doubling " << CLI::GetParam<int>("int") << std::endl;
+  CLI::GetParam<int>("out") = 2 * CLI::GetParam<int>("int");
+}
+
+/**
+ * Make sure that a server reading requests from standard input only writes the
+ * responses to standard output, and that the warnings and printed outputs of
+ * its workers go to standard error.
+ */
+BOOST_AUTO_TEST_CASE(ServeTest)
+{
+  AddRequiredCLIOptions();
+
+  PARAM_INT_IN("int", "Test int", "i", 0);
+  PARAM_INT_OUT("out", "Test output int");
+  PARAM_STRING_IN("server_socket", "Test socket", "", "");
+  PARAM_INT_IN("server_workers", "Test workers", "", 1);
+
+  const char* argv[3] = { "./test", "--server_workers", "3" };
+  ParseCommandLine(3, const_cast<char**>(argv));
+
+  std::istringstream input("--int 1\n--int 2\n--int 3\n--int 4\n");
+  std::ostringstream output, error;
+  std::streambuf* cinBuffer = std::cin.rdbuf(input.rdbuf());
+  std::streambuf* coutBuffer = std::cout.rdbuf(output.rdbuf());
+  std::streambuf* cerrBuffer = std::cerr.rdbuf(error.rdbuf());
+  const bool ignoreWarn = Log::Warn.ignoreInput;
+  Log::Warn.ignoreInput = false;
+  const int result = Serve(WarnDoubleMain);
+  Log::Warn.ignoreInput = ignoreWarn;
+  std::cin.rdbuf(cinBuffer);
+  std::cout.rdbuf(coutBuffer);
+  std::cerr.rdbuf(cerrBuffer);
+
+  BOOST_REQUIRE_EQUAL(result, 0);
+
+  // Each response is on its own line, in any order.
+  std::istringstream responses(output.str());
+  std::vector<int> numbers;
+  string line;
+  while (std::getline(responses, line))
+  {
+    std::istringstream fields(line);
+    int number;
+    string status, rest;
+    fields >> number >> status;
+    BOOST_REQUIRE_EQUAL(status, "OK");
+    BOOST_REQUIRE(!(fields >> rest));
+    numbers.push_back(number);
+  }
+  std::sort(numbers.begin(), numbers.end());
+  BOOST_REQUIRE_EQUAL(numbers.size(), 4);
+  for (size_t i = 0; i < numbers.size(); ++i)
+    BOOST_REQUIRE_EQUAL(numbers[i], (int) i + 1);
+
+  BOOST_REQUIRE_NE(error.str().find("doubling 3"), string::npos);
+  BOOST_REQUIRE_NE(error.str().find("out: 8"), string::npos);
+
+  // Standard output is restored afterwards.
+  BOOST_REQUIRE_EQUAL(std::cout.rdbuf(), coutBuffer);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -222,4 +222,34 @@ BOOST_AUTO_TEST_CASE(CosineTreeModifiedGramSchmidt)
   }
 }
 
+/**
+ * Build a cosine tree that has to split and check that the basis it returns is
+ * orthonormal.
+ */
+BOOST_AUTO_TEST_CASE(CosineTreeOrthonormalBasis)
+{
+  // Make a random low-rank dataset.
+  arma::mat data = arma::randu(50, 8) * arma::randu(8, 300);
+
+  CosineTree ctree(data, 0.01, 0.1);
+  arma::mat basis;
+  ctree.GetFinalBasis(basis);
+
+  BOOST_REQUIRE_GT(basis.n_cols, 1);
+  BOOST_REQUIRE_EQUAL(basis.n_rows, data.n_rows);
+
+  // Every basis vector should have unit norm and be orthogonal to the others.
+  const arma::mat gram = basis.t() * basis;
+  for (size_t i = 0; i < gram.n_rows; i++)
+  {
+    for (size_t j = 0; j < gram.n_cols; j++)
+    {
+      if (i == j)
+        BOOST_REQUIRE_CLOSE(gram(i, j), 1.0, 1e-5);
+      else
+        BOOST_REQUIRE_SMALL(gram(i, j), 1e-5);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
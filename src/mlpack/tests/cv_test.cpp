@@ -462,6 +462,74 @@ BOOST_AUTO_TEST_CASE(KFoldCVAccuracyTest)
   cv.Model();
 }
 
+/**
+ * Evaluating the folds in parallel gives the same result as evaluating them
+ * one after the other.
+ */
+BOOST_AUTO_TEST_CASE(KFoldCVParallelFoldsTest)
+{
+  arma::mat data;
+  arma::Row<size_t> labels;
+  data::DatasetInfo datasetInfo;
+  MockCategoricalData(data, labels, datasetInfo);
+
+  const size_t numClasses = 5;
+  const size_t minimumLeafSize = 5;
+
+  KFoldCV<DecisionTree<InformationGain>, Accuracy> cv(7, data, datasetInfo,
+      labels, numClasses, false);
+  BOOST_REQUIRE_EQUAL(cv.MaxParallelFolds(), 1);
+  const double sequentialAccuracy = cv.Evaluate(minimumLeafSize);
+
+  cv.MaxParallelFolds() = 0;
+  const double parallelAccuracy = cv.Evaluate(minimumLeafSize);
+  BOOST_REQUIRE_CLOSE(sequentialAccuracy, parallelAccuracy, 1e-5);
+
+  cv.MaxParallelFolds() = 3;
+  BOOST_REQUIRE_CLOSE(cv.Evaluate(minimumLeafSize), sequentialAccuracy, 1e-5);
+
+  // The model of the last fold is kept either way.
+  cv.Model();
+}
+
+/**
+ * Test that warm-starting k-fold cross-validation gives the same results as
+ * training every fold from scratch, for a model that supports it.
+ */
+BOOST_AUTO_TEST_CASE(KFoldCVWarmStartTest)
+{
+  static_assert(WarmStart<SoftmaxRegression>::IsSupported,
+      "SoftmaxRegression should support warm starts");
+  static_assert(!WarmStart<DecisionTree<>>::IsSupported,
+      "DecisionTree should not support warm starts");
+
+  // Three well-separated classes.
+  arma::mat data(2, 300);
+  arma::Row<size_t> labels(300);
+  for (size_t i = 0; i < 300; ++i)
+  {
+    labels[i] = i % 3;
+    data.col(i) = 5.0 * labels[i] + arma::randn<arma::vec>(2);
+  }
+
+  const size_t numClasses = 3;
+  KFoldCV<SoftmaxRegression, Accuracy> cv(5, data, labels, numClasses);
+  BOOST_REQUIRE_EQUAL(cv.WarmStart(), false);
+  const double coldAccuracy = cv.Evaluate(0.001);
+
+  // Sweep over lambda as a tuner would; every fold after the first starts from
+  // the model of the previous one.
+  cv.WarmStart() = true;
+  BOOST_REQUIRE_CLOSE(cv.Evaluate(0.001), coldAccuracy, 1.0);
+  BOOST_REQUIRE_GT(cv.Evaluate(0.01), 0.9);
+  BOOST_REQUIRE_EQUAL(cv.Model().NumClasses(), numClasses);
+
+  // A model of another dimensionality can't be warm-started, so it is trained
+  // from scratch.
+  cv.Model().Parameters().set_size(numClasses, 7);
+  BOOST_REQUIRE_CLOSE(cv.Evaluate(0.001), coldAccuracy, 1.0);
+}
+
 /**
  * Test k-fold cross-validation with weighted linear regression.
  */
@@ -309,4 +309,142 @@ BOOST_AUTO_TEST_CASE(RandomPointSelectionTest)
   BOOST_REQUIRE_EQUAL(assignments.n_elem, points.n_cols);
 }
 
+/**
+ * Make sure that batch mode, which searches with all threads, finds the same
+ * clusters as pointwise mode, for both dual-tree and single-tree search.
+ */
+BOOST_AUTO_TEST_CASE(BatchModeMatchesPointwiseTest)
+{
+  arma::mat points(3, 2000, arma::fill::randu);
+
+  DBSCAN<> pointwise(0.05, 5, false);
+  arma::Row<size_t> pointwiseAssignments;
+  const size_t pointwiseClusters = pointwise.Cluster(points,
+      pointwiseAssignments);
+
+  DBSCAN<> dualTree(0.05, 5, true);
+  arma::Row<size_t> dualTreeAssignments;
+  const size_t dualTreeClusters = dualTree.Cluster(points,
+      dualTreeAssignments);
+
+  DBSCAN<> singleTree(0.05, 5, true, RangeSearch<>(false, true));
+  arma::Row<size_t> singleTreeAssignments;
+  const size_t singleTreeClusters = singleTree.Cluster(points,
+      singleTreeAssignments);
+
+  BOOST_REQUIRE_EQUAL(pointwiseClusters, dualTreeClusters);
+  BOOST_REQUIRE_EQUAL(pointwiseClusters, singleTreeClusters);
+
+  // The clusters may be numbered differently, but noise must be the same and
+  // the clusters must map one-to-one.
+  arma::Col<size_t> dualTreeMap(pointwiseClusters);
+  arma::Col<size_t> singleTreeMap(pointwiseClusters);
+  dualTreeMap.fill(SIZE_MAX);
+  singleTreeMap.fill(SIZE_MAX);
+  for (size_t i = 0; i < points.n_cols; ++i)
+  {
+    const size_t c = pointwiseAssignments[i];
+    if (c == SIZE_MAX)
+    {
+      BOOST_REQUIRE_EQUAL(dualTreeAssignments[i], SIZE_MAX);
+      BOOST_REQUIRE_EQUAL(singleTreeAssignments[i], SIZE_MAX);
+      continue;
+    }
+
+    if (dualTreeMap[c] == SIZE_MAX)
+      dualTreeMap[c] = dualTreeAssignments[i];
+    if (singleTreeMap[c] == SIZE_MAX)
+      singleTreeMap[c] = singleTreeAssignments[i];
+
+    BOOST_REQUIRE_EQUAL(dualTreeAssignments[i], dualTreeMap[c]);
+    BOOST_REQUIRE_EQUAL(singleTreeAssignments[i], singleTreeMap[c]);
+  }
+}
+
+/**
+ * Make sure that GridRangeSearch finds the same neighbors as RangeSearch.
+ */
+BOOST_AUTO_TEST_CASE(GridRangeSearchTest)
+{
+  arma::mat points(2, 1000, arma::fill::randu);
+  arma::mat queries(2, 100, arma::fill::randu);
+  queries *= 1.2; // Some queries are outside the reference set.
+
+  RangeSearch<> rs(points);
+  GridRangeSearch<> grid;
+  grid.Train(points);
+
+  std::vector<std::vector<size_t>> neighbors;
+  std::vector<std::vector<double>> distances;
+  rs.Search(queries, math::Range(0.02, 0.1), neighbors, distances);
+
+  std::vector<std::vector<size_t>> gridNeighbors(queries.n_cols);
+  auto store = [&gridNeighbors](const size_t query,
+                                const size_t reference,
+                                const double /* distance */)
+  {
+    gridNeighbors[query].push_back(reference);
+  };
+  grid.Search(queries, math::Range(0.02, 0.1), store);
+
+  for (size_t i = 0; i < queries.n_cols; ++i)
+  {
+    std::sort(neighbors[i].begin(), neighbors[i].end());
+    std::sort(gridNeighbors[i].begin(), gridNeighbors[i].end());
+    BOOST_REQUIRE_EQUAL(neighbors[i].size(), gridNeighbors[i].size());
+    for (size_t j = 0; j < neighbors[i].size(); ++j)
+      BOOST_REQUIRE_EQUAL(neighbors[i][j], gridNeighbors[i][j]);
+  }
+}
+
+/**
+ * Make sure that DBSCAN with GridRangeSearch finds the same clusters as with
+ * the default range search, in batch and pointwise mode.
+ */
+BOOST_AUTO_TEST_CASE(GridDBSCANTest)
+{
+  arma::mat points(2, 3000, arma::fill::randu);
+
+  DBSCAN<> tree(0.02, 5);
+  arma::Row<size_t> treeAssignments;
+  const size_t treeClusters = tree.Cluster(points, treeAssignments);
+
+  DBSCAN<GridRangeSearch<>> grid(0.02, 5);
+  arma::Row<size_t> gridAssignments;
+  const size_t gridClusters = grid.Cluster(points, gridAssignments);
+
+  DBSCAN<GridRangeSearch<>> pointwise(0.02, 5, false);
+  arma::Row<size_t> pointwiseAssignments;
+  const size_t pointwiseClusters = pointwise.Cluster(points,
+      pointwiseAssignments);
+
+  BOOST_REQUIRE_EQUAL(treeClusters, gridClusters);
+  BOOST_REQUIRE_EQUAL(treeClusters, pointwiseClusters);
+
+  // The clusters may be numbered differently, but noise must be the same and
+  // the clusters must map one-to-one.
+  arma::Col<size_t> gridMap(treeClusters);
+  arma::Col<size_t> pointwiseMap(treeClusters);
+  gridMap.fill(SIZE_MAX);
+  pointwiseMap.fill(SIZE_MAX);
+  for (size_t i = 0; i < points.n_cols; ++i)
+  {
+    const size_t c = treeAssignments[i];
+    if (c == SIZE_MAX)
+    {
+      BOOST_REQUIRE_EQUAL(gridAssignments[i], SIZE_MAX);
+      BOOST_REQUIRE_EQUAL(pointwiseAssignments[i], SIZE_MAX);
+      continue;
+    }
+
+    if (gridMap[c] == SIZE_MAX)
+      gridMap[c] = gridAssignments[i];
+    if (pointwiseMap[c] == SIZE_MAX)
+      pointwiseMap[c] = pointwiseAssignments[i];
+
+    BOOST_REQUIRE_EQUAL(gridAssignments[i], gridMap[c]);
+    BOOST_REQUIRE_EQUAL(pointwiseAssignments[i], pointwiseMap[c]);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
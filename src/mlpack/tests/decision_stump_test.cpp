@@ -423,4 +423,42 @@ BOOST_AUTO_TEST_CASE(DecisionStumpTrainReturnEntropy)
   BOOST_REQUIRE_EQUAL(std::isfinite(gain), true);
 }
 
+/**
+ * Make sure that a stump trained with presorted dimensions is the same as one
+ * that sorts the dimensions itself, with the same weights.
+ */
+BOOST_AUTO_TEST_CASE(PresortedDimensionsTest)
+{
+  const size_t numClasses = 3;
+
+  arma::mat dataset(5, 1000, arma::fill::randu);
+  arma::Row<size_t> labels(1000);
+  for (size_t i = 0; i < 1000; ++i)
+    labels[i] = (dataset(3, i) < 0.3) ? 0 : ((dataset(3, i) < 0.6) ? 1 : 2);
+  arma::rowvec weights(1000, arma::fill::randu);
+
+  arma::umat sortedIndices;
+  DecisionStump<>::SortDimensions(dataset, sortedIndices);
+  BOOST_REQUIRE_EQUAL(sortedIndices.n_rows, 1000);
+  BOOST_REQUIRE_EQUAL(sortedIndices.n_cols, 5);
+  for (size_t d = 0; d < 5; ++d)
+    for (size_t i = 1; i < 1000; ++i)
+      BOOST_REQUIRE_LE(dataset(d, sortedIndices(i - 1, d)),
+          dataset(d, sortedIndices(i, d)));
+
+  DecisionStump<> other(dataset, labels, numClasses, 20);
+  DecisionStump<> ds(other, dataset, labels, numClasses, weights);
+  DecisionStump<> presorted(other, dataset, labels, numClasses, weights,
+      sortedIndices);
+
+  BOOST_REQUIRE_EQUAL(presorted.SplitDimension(), 3);
+  BOOST_REQUIRE_EQUAL(presorted.SplitDimension(), ds.SplitDimension());
+  BOOST_REQUIRE_EQUAL(presorted.Split().n_elem, ds.Split().n_elem);
+  for (size_t i = 0; i < ds.Split().n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(presorted.Split()[i], ds.Split()[i]);
+    BOOST_REQUIRE_EQUAL(presorted.BinLabels()[i], ds.BinLabels()[i]);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -367,6 +367,125 @@ BOOST_AUTO_TEST_CASE(BestBinaryNumericSplitNoGainTest)
   BOOST_REQUIRE_EQUAL(classProbabilities.n_elem, 0);
 }
 
+/**
+ * Check that the HistogramNumericSplit finds the same split as the
+ * BestBinaryNumericSplit when every value falls into its own bin.
+ */
+BOOST_AUTO_TEST_CASE(HistogramNumericSplitSimpleSplitTest)
+{
+  arma::vec values("0.0 0.1 0.2 0.3 0.4 0.5 0.6 0.7 0.8 0.9 1.0");
+  arma::Row<size_t> labels("0 0 0 0 0 1 1 1 1 1 1");
+  arma::rowvec weights(labels.n_elem);
+  weights.ones();
+
+  arma::vec classProbabilities;
+  HistogramNumericSplit<GiniGain>::template AuxiliarySplitInfo<double> aux;
+
+  // Call the method to do the splitting.
+  const double bestGain = GiniGain::Evaluate<false>(labels, 2, weights);
+  const double gain = HistogramNumericSplit<GiniGain>::SplitIfBetter<false>(
+      bestGain, values, labels, 2, weights, 3, 1e-7, classProbabilities, aux);
+  const double weightedGain =
+      HistogramNumericSplit<GiniGain>::SplitIfBetter<true>(bestGain, values,
+      labels, 2, weights, 3, 1e-7, classProbabilities, aux);
+
+  // Make sure that a split was made.
+  BOOST_REQUIRE_GT(gain, bestGain);
+
+  // Make sure weight works and is not different than the unweighted one.
+  BOOST_REQUIRE_EQUAL(gain, weightedGain);
+
+  // The split is perfect, so we should be able to accomplish a gain of 0.
+  BOOST_REQUIRE_SMALL(gain, 1e-5);
+
+  // The class probabilities, for this split, hold the splitting point, which
+  // should be between 4 and 5.
+  BOOST_REQUIRE_EQUAL(classProbabilities.n_elem, 1);
+  BOOST_REQUIRE_GT(classProbabilities[0], 0.4);
+  BOOST_REQUIRE_LT(classProbabilities[0], 0.5);
+}
+
+/**
+ * Check that the BinnedNumericSplit only splits on bin boundaries, and that
+ * the split value separates the values of the neighboring bins.
+ */
+BOOST_AUTO_TEST_CASE(BinnedNumericSplitBoundaryTest)
+{
+  // The best split is between 36 and 37, but with four quantile bins the only
+  // candidates are between 24 and 25, 49 and 50, and 74 and 75.
+  arma::vec values(100);
+  arma::Row<size_t> labels(100);
+  arma::rowvec weights(100, arma::fill::ones);
+  for (size_t i = 0; i < 100; ++i)
+  {
+    values[i] = i;
+    labels[i] = (i < 37) ? 0 : 1;
+  }
+
+  arma::vec classProbabilities;
+  BinnedNumericSplit<GiniGain, 4>::template AuxiliarySplitInfo<double> aux;
+
+  const double bestGain = GiniGain::Evaluate<false>(labels, 2, weights);
+  const double gain = BinnedNumericSplit<GiniGain, 4>::SplitIfBetter<false>(
+      bestGain, values, labels, 2, weights, 1, 1e-7, classProbabilities, aux);
+  const double weightedGain =
+      BinnedNumericSplit<GiniGain, 4>::SplitIfBetter<true>(bestGain, values,
+      labels, 2, weights, 1, 1e-7, classProbabilities, aux);
+
+  // The left child holds 37 points of class 0 and 13 of class 1; the right
+  // child only holds points of class 1.
+  BOOST_REQUIRE_EQUAL(classProbabilities.n_elem, 1);
+  BOOST_REQUIRE_CLOSE(classProbabilities[0], 49.5, 1e-5);
+  BOOST_REQUIRE_CLOSE(gain, -2.0 * 37.0 * 13.0 / (50.0 * 100.0), 1e-5);
+  BOOST_REQUIRE_CLOSE(gain, weightedGain, 1e-5);
+}
+
+/**
+ * Check that on heavy-tailed values, where bins of equal width would put
+ * nearly every point into the first bin, the HistogramNumericSplit finds a
+ * split nearly as good as the BestBinaryNumericSplit.
+ */
+BOOST_AUTO_TEST_CASE(HistogramNumericSplitHeavyTailTest)
+{
+  // With 4000 points every value is in the sample; with 20000 points the
+  // quantiles are estimated from a sample.
+  for (const size_t n : { 4000, 20000 })
+  {
+    // Log-normal values; the class only depends on whether the value is above
+    // the median, which is 1.
+    arma::vec values = arma::exp(3.0 * arma::randn<arma::vec>(n));
+    arma::Row<size_t> labels(n);
+    for (size_t i = 0; i < n; ++i)
+      labels[i] = (values[i] > 1.0) ? 1 : 0;
+    arma::rowvec weights(n, arma::fill::ones);
+
+    arma::vec classProbabilities, binaryClassProbabilities;
+    HistogramNumericSplit<GiniGain>::template AuxiliarySplitInfo<double> aux;
+    BestBinaryNumericSplit<GiniGain>::template AuxiliarySplitInfo<double>
+        binaryAux;
+
+    const double bestGain = GiniGain::Evaluate<false>(labels, 2, weights);
+    const double gain = HistogramNumericSplit<GiniGain>::SplitIfBetter<false>(
+        bestGain, values, labels, 2, weights, 1, 1e-7, classProbabilities,
+        aux);
+    const double binaryGain =
+        BestBinaryNumericSplit<GiniGain>::SplitIfBetter<false>(bestGain,
+        values, labels, 2, weights, 1, 1e-7, binaryClassProbabilities,
+        binaryAux);
+
+    // The best binary split is perfect.  The bin holding the median holds
+    // about n / 256 points, so at most that many are on the wrong side.
+    BOOST_REQUIRE_SMALL(binaryGain, 1e-5);
+    BOOST_REQUIRE_GT(gain, bestGain);
+    BOOST_REQUIRE_GE(gain, binaryGain - 0.01);
+    BOOST_REQUIRE_EQUAL(classProbabilities.n_elem, 1);
+
+    const double errors = arma::accu((values <= classProbabilities[0]) !=
+        (values <= 1.0));
+    BOOST_REQUIRE_LE(errors, 2.0 * n / 256);
+  }
+}
+
 /**
  * Check that the AllCategoricalSplit will split when the split is obviously
  * better.
@@ -692,6 +811,146 @@ BOOST_AUTO_TEST_CASE(SimpleGeneralizationTest)
   BOOST_REQUIRE_GT(wdcorrect, 0.75);
 }
 
+/**
+ * Test that a decision tree built with the HistogramNumericSplit generalizes
+ * reasonably.
+ */
+BOOST_AUTO_TEST_CASE(HistogramGeneralizationTest)
+{
+  arma::mat inputData;
+  if (!data::Load("vc2.csv", inputData))
+    BOOST_FAIL("Cannot load test dataset vc2.csv!");
+
+  arma::Row<size_t> labels;
+  if (!data::Load("vc2_labels.txt", labels))
+    BOOST_FAIL("Cannot load labels for vc2_labels.txt");
+
+  arma::rowvec weights(labels.n_cols, arma::fill::ones);
+
+  // Build decision trees with a leaf size of 10.
+  DecisionTree<GiniGain, HistogramNumericSplit> d(inputData, labels, 3, 10);
+  DecisionTree<GiniGain, HistogramNumericSplit> wd(inputData, labels, 3,
+      weights, 10);
+
+  arma::mat testData;
+  if (!data::Load("vc2_test.csv", testData))
+    BOOST_FAIL("Cannot load test dataset vc2_test.csv!");
+
+  arma::Mat<size_t> trueTestLabels;
+  if (!data::Load("vc2_test_labels.txt", trueTestLabels))
+    BOOST_FAIL("Cannot load labels for vc2_test_labels.txt");
+
+  arma::Row<size_t> predictions, weightedPredictions;
+  d.Classify(testData, predictions);
+  wd.Classify(testData, weightedPredictions);
+
+  BOOST_REQUIRE_EQUAL(predictions.n_elem, testData.n_cols);
+  BOOST_REQUIRE_EQUAL(weightedPredictions.n_elem, testData.n_cols);
+
+  double correct = 0.0;
+  double weightedCorrect = 0.0;
+  for (size_t i = 0; i < predictions.n_elem; ++i)
+  {
+    if (predictions[i] == trueTestLabels[i])
+      ++correct;
+    if (weightedPredictions[i] == trueTestLabels[i])
+      ++weightedCorrect;
+  }
+  correct /= predictions.n_elem;
+  weightedCorrect /= predictions.n_elem;
+
+  BOOST_REQUIRE_GT(correct, 0.75);
+  BOOST_REQUIRE_GT(weightedCorrect, 0.75);
+}
+
+/**
+ * Make sure that the root of a tree on a wide dataset, whose dimensions are
+ * searched in parallel, splits on the first of the informative dimensions,
+ * just as a search over the dimensions in order would.
+ */
+BOOST_AUTO_TEST_CASE(WideDatasetSplitDimensionTest)
+{
+  arma::mat dataset(200, 500, arma::fill::randu);
+  dataset.row(150) = dataset.row(137);
+  arma::Row<size_t> labels(dataset.n_cols);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    labels[i] = (dataset(137, i) > 0.5) ? 1 : 0;
+
+  DecisionTree<> d(dataset, labels, 2, 10);
+  BOOST_REQUIRE_EQUAL(d.NumChildren(), 2);
+  BOOST_REQUIRE_EQUAL(d.SplitDimension(), 137);
+
+  arma::rowvec weights(dataset.n_cols, arma::fill::ones);
+  data::DatasetInfo info(dataset.n_rows);
+  DecisionTree<> wd(dataset, info, labels, 2, weights, 10);
+  BOOST_REQUIRE_EQUAL(wd.NumChildren(), 2);
+  BOOST_REQUIRE_EQUAL(wd.SplitDimension(), 137);
+
+  // The split is perfect, so the training set is classified exactly.
+  arma::Row<size_t> predictions;
+  d.Classify(dataset, predictions);
+  for (size_t i = 0; i < labels.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(predictions[i], labels[i]);
+}
+
+#ifdef HAS_OPENMP
+//! Make sure that two decision trees have the same structure.
+template<typename TreeType>
+void CheckSameDecisionTree(const TreeType& a, const TreeType& b)
+{
+  BOOST_REQUIRE_EQUAL(a.NumChildren(), b.NumChildren());
+  if (a.NumChildren() == 0)
+  {
+    CheckMatrices(a.ClassProbabilities(), b.ClassProbabilities());
+    return;
+  }
+
+  BOOST_REQUIRE_EQUAL(a.SplitDimension(), b.SplitDimension());
+  CheckMatrices(a.ClassProbabilities(), b.ClassProbabilities());
+  for (size_t i = 0; i < a.NumChildren(); ++i)
+    CheckSameDecisionTree(a.Child(i), b.Child(i));
+}
+
+/**
+ * Make sure that a tree whose children are grown as tasks is the same as a tree
+ * grown with one thread, and has the same training gain.
+ */
+BOOST_AUTO_TEST_CASE(DecisionTreeParallelGrowTest)
+{
+  arma::mat dataset(5, 20000, arma::fill::randu);
+  arma::Row<size_t> labels(dataset.n_cols);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    labels[i] = (dataset(0, i) + dataset(1, i) > 1.0) ? 1 : 0;
+    // Add some noise, so that the tree is deep.
+    if (math::Random() < 0.1)
+      labels[i] = 2;
+  }
+  arma::rowvec weights(dataset.n_cols, arma::fill::randu);
+  data::DatasetInfo info(dataset.n_rows);
+
+  const size_t prevNumThreads = omp_get_max_threads();
+  omp_set_num_threads(std::max(prevNumThreads, (size_t) 4));
+  DecisionTree<> tree, weightedTree;
+  const double gain = tree.Train(dataset, labels, 3, 5);
+  const double weightedGain = weightedTree.Train(dataset, info, labels, 3,
+      weights, 5);
+
+  omp_set_num_threads(1);
+  DecisionTree<> serialTree, serialWeightedTree;
+  const double serialGain = serialTree.Train(dataset, labels, 3, 5);
+  const double serialWeightedGain = serialWeightedTree.Train(dataset, info,
+      labels, 3, weights, 5);
+  omp_set_num_threads(prevNumThreads);
+
+  BOOST_REQUIRE_GT(serialTree.NumChildren(), 0);
+  CheckSameDecisionTree(serialTree, tree);
+  CheckSameDecisionTree(serialWeightedTree, weightedTree);
+  BOOST_REQUIRE_CLOSE(gain, serialGain, 1e-10);
+  BOOST_REQUIRE_CLOSE(weightedGain, serialWeightedGain, 1e-10);
+}
+#endif
+
 /**
  * Test that we can build a decision tree on a simple categorical dataset.
  */
@@ -216,6 +216,77 @@ BOOST_AUTO_TEST_CASE(TestSparseSplitData)
   BOOST_REQUIRE_EQUAL(oTest[6], 7);
 }
 
+// Make sure that SplitData() keeps the presorted orders of both children
+// sorted.
+BOOST_AUTO_TEST_CASE(TestPresortedSplitData)
+{
+  arma::mat testData(3, 5);
+
+  testData << 4 << 5 << 7 << 3 << 5 << arma::endr
+           << 5 << 0 << 1 << 7 << 1 << arma::endr
+           << 5 << 6 << 7 << 1 << 8 << arma::endr;
+
+  DTree<arma::mat> testDTree(testData);
+
+  arma::Col<size_t> oTest(5);
+  oTest << 1 << 2 << 3 << 4 << 5;
+
+  arma::Mat<size_t> sortedIndices;
+  details::SortDimensions(testData, sortedIndices);
+
+  size_t splitInd = testDTree.SplitData(
+      testData, 2, 5.5, oTest, sortedIndices);
+
+  // The points should be split just as without the sorted orders.
+  BOOST_REQUIRE_EQUAL(splitInd, 2);
+  BOOST_REQUIRE_EQUAL(oTest[0], 1);
+  BOOST_REQUIRE_EQUAL(oTest[1], 4);
+  BOOST_REQUIRE_EQUAL(oTest[2], 3);
+  BOOST_REQUIRE_EQUAL(oTest[3], 2);
+  BOOST_REQUIRE_EQUAL(oTest[4], 5);
+
+  // Each child's part of each order should hold the child's points, sorted.
+  for (size_t d = 0; d < testData.n_rows; ++d)
+  {
+    for (size_t i = 0; i < testData.n_cols; ++i)
+    {
+      BOOST_REQUIRE_EQUAL((i < splitInd), (sortedIndices(i, d) < splitInd));
+      if (i > 0 && i != splitInd)
+      {
+        BOOST_REQUIRE_LE(testData(d, sortedIndices(i - 1, d)),
+            testData(d, sortedIndices(i, d)));
+      }
+    }
+  }
+}
+
+// Growing the tree with presorted orders should give the same tree as sorting
+// in every node.
+BOOST_AUTO_TEST_CASE(TestPresortedGrow)
+{
+  arma::mat data = arma::randu<arma::mat>(4, 3000);
+  arma::mat unsortedData(data);
+
+  arma::Col<size_t> oldFromNew = arma::linspace<arma::Col<size_t>>(0,
+      data.n_cols - 1, data.n_cols);
+  arma::Col<size_t> unsortedOldFromNew(oldFromNew);
+
+  DTree<arma::mat> tree(data);
+  const double alpha = tree.Grow(data, oldFromNew, false, 10, 5);
+
+  DTree<arma::mat> unsortedTree(unsortedData);
+  arma::Mat<size_t> noIndices;
+  const double unsortedAlpha = unsortedTree.Grow(unsortedData,
+      unsortedOldFromNew, noIndices, false, 10, 5);
+
+  BOOST_REQUIRE_CLOSE(alpha, unsortedAlpha, 1e-10);
+  BOOST_REQUIRE_EQUAL(tree.SubtreeLeaves(), unsortedTree.SubtreeLeaves());
+  BOOST_REQUIRE_CLOSE(tree.SubtreeLeavesLogNegError(),
+      unsortedTree.SubtreeLeavesLogNegError(), 1e-10);
+  for (size_t i = 0; i < oldFromNew.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(oldFromNew[i], unsortedOldFromNew[i]);
+}
+
 #endif
 
 // Tests for the public functions.
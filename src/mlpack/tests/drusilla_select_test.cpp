@@ -148,6 +148,36 @@ BOOST_AUTO_TEST_CASE(SerializationTest)
   }
 }
 
+// Storing only the candidate indices should give the same results as storing
+// copies of the candidates, and should survive serialization.
+BOOST_AUTO_TEST_CASE(CandidateIndicesTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 500);
+
+  DrusillaSelect<> ds(dataset, 5, 10);
+  DrusillaSelect<> dsIndices(dataset, 5, 10, false);
+
+  BOOST_REQUIRE_EQUAL(dsIndices.CandidateSet().n_elem, 0);
+  BOOST_REQUIRE_EQUAL(dsIndices.CandidateIndices().n_elem, 50);
+
+  arma::Mat<size_t> neighbors, neighborsIndices;
+  arma::mat distances, distancesIndices;
+  ds.Search(dataset, 5, neighbors, distances);
+  dsIndices.Search(dataset, 5, neighborsIndices, distancesIndices);
+
+  CheckMatrices(neighbors, neighborsIndices);
+  CheckMatrices(distances, distancesIndices);
+
+  // A loaded model holds its own copies of the candidates.
+  DrusillaSelect<> dsXml(2, 2), dsText(2, 2), dsBinary(2, 2);
+  SerializeObjectAll(dsIndices, dsXml, dsText, dsBinary);
+
+  BOOST_REQUIRE_EQUAL(dsXml.CandidateSet().n_cols, 50);
+  dsXml.Search(dataset, 5, neighborsIndices, distancesIndices);
+  CheckMatrices(neighbors, neighborsIndices);
+  CheckMatrices(distances, distancesIndices);
+}
+
 // Make sure we can create the object with a sparse matrix.
 BOOST_AUTO_TEST_CASE(SparseTest)
 {
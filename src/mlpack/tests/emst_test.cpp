@@ -14,6 +14,7 @@
 #include "test_tools.hpp"
 
 #include <mlpack/core/tree/cover_tree.hpp>
+#include <mlpack/core/tree/fixed_dimension.hpp>
 
 using namespace mlpack;
 using namespace mlpack::emst;
@@ -278,4 +279,149 @@ BOOST_AUTO_TEST_CASE(BallTreeTest)
   }
 }
 
+/**
+ * Make sure the parallel Boruvka rounds give the same MST as the serial ones,
+ * with the dual-tree, naive, and cover tree computations.
+ */
+BOOST_AUTO_TEST_CASE(ParallelVsSerialTest)
+{
+  arma::mat inputData;
+  if (!data::Load("test_data_3_1000.csv", inputData))
+    BOOST_FAIL("Cannot load test dataset test_data_3_1000.csv!");
+
+  DualTreeBoruvka<> dtb(inputData);
+  DualTreeBoruvka<> parallelDtb(inputData);
+  DualTreeBoruvka<> parallelNaive(inputData, true);
+  DualTreeBoruvka<EuclideanDistance, arma::mat, StandardCoverTree>
+      parallelCt(inputData);
+
+  arma::mat results;
+  dtb.ComputeMST(results);
+
+  arma::mat parallelResults[3];
+  parallelDtb.ComputeMST(parallelResults[0], true);
+  parallelNaive.ComputeMST(parallelResults[1], true);
+  parallelCt.ComputeMST(parallelResults[2], true);
+
+  for (size_t r = 0; r < 3; ++r)
+  {
+    BOOST_REQUIRE_EQUAL(parallelResults[r].n_cols, results.n_cols);
+    BOOST_REQUIRE_EQUAL(parallelResults[r].n_rows, results.n_rows);
+    for (size_t i = 0; i < results.n_cols; i++)
+    {
+      BOOST_REQUIRE_EQUAL(parallelResults[r](0, i), results(0, i));
+      BOOST_REQUIRE_EQUAL(parallelResults[r](1, i), results(1, i));
+      BOOST_REQUIRE_CLOSE(parallelResults[r](2, i), results(2, i), 1e-5);
+    }
+  }
+}
+
+/**
+ * Make sure the kd-tree and metric specialized for three-dimensional data give
+ * the same MST as the regular ones.
+ */
+BOOST_AUTO_TEST_CASE(FixedDimensionTest)
+{
+  arma::mat inputData;
+  if (!data::Load("test_data_3_1000.csv", inputData))
+    BOOST_FAIL("Cannot load test dataset test_data_3_1000.csv!");
+
+  typedef FixedDimension<3> Fixed;
+  DualTreeBoruvka<> dtb(inputData);
+  DualTreeBoruvka<Fixed::EuclideanDistance, arma::mat, Fixed::KDTree>
+      fixedDtb(inputData);
+
+  arma::mat results;
+  arma::mat fixedResults;
+  dtb.ComputeMST(results);
+  fixedDtb.ComputeMST(fixedResults);
+
+  BOOST_REQUIRE_EQUAL(fixedResults.n_cols, results.n_cols);
+  BOOST_REQUIRE_EQUAL(fixedResults.n_rows, results.n_rows);
+  for (size_t i = 0; i < results.n_cols; i++)
+  {
+    BOOST_REQUIRE_EQUAL(fixedResults(0, i), results(0, i));
+    BOOST_REQUIRE_EQUAL(fixedResults(1, i), results(1, i));
+    BOOST_REQUIRE_CLOSE(fixedResults(2, i), results(2, i), 1e-5);
+  }
+}
+
+/**
+ * Make sure that the compact edge list, the streamed edges, and the
+ * single-linkage dendrogram all agree with the MST matrix.
+ */
+BOOST_AUTO_TEST_CASE(EdgeOutputTest)
+{
+  arma::mat inputData;
+  if (!data::Load("test_data_3_1000.csv", inputData))
+    BOOST_FAIL("Cannot load test dataset test_data_3_1000.csv!");
+
+  DualTreeBoruvka<> dtb(inputData);
+  arma::mat results;
+  dtb.ComputeMST(results);
+
+  DualTreeBoruvka<> compactDtb(inputData);
+  std::vector<CompactEdgePair> edges;
+  compactDtb.ComputeMST(edges);
+
+  BOOST_REQUIRE_EQUAL(edges.size(), results.n_cols);
+  for (size_t i = 0; i < edges.size(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(edges[i].Lesser(), results(0, i));
+    BOOST_REQUIRE_EQUAL(edges[i].Greater(), results(1, i));
+    BOOST_REQUIRE_CLOSE(edges[i].Distance(), results(2, i), 1e-4);
+  }
+
+  // Streamed edges come in any order, but must make up the same tree.
+  DualTreeBoruvka<> streamDtb(inputData);
+  arma::mat streamed(3, results.n_cols);
+  size_t count = 0;
+  auto callback = [&](const size_t lesser,
+                      const size_t greater,
+                      const double distance)
+  {
+    streamed(0, count) = lesser;
+    streamed(1, count) = greater;
+    streamed(2, count) = distance;
+    ++count;
+  };
+  streamDtb.StreamMST(callback, true);
+
+  BOOST_REQUIRE_EQUAL(count, results.n_cols);
+  BOOST_REQUIRE_CLOSE(arma::accu(streamed.row(2)), arma::accu(results.row(2)),
+      1e-5);
+  arma::uvec order = arma::sort_index(streamed.row(2));
+  for (size_t i = 0; i < results.n_cols; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(streamed(2, order[i]), results(2, i), 1e-5);
+    BOOST_REQUIRE_LT(streamed(0, i), streamed(1, i));
+  }
+
+  // Each column of the dendrogram merges two existing clusters at the
+  // distance of the corresponding edge, and the last one holds every point.
+  DualTreeBoruvka<> dendrogramDtb(inputData);
+  arma::mat linkage;
+  dendrogramDtb.ComputeDendrogram(linkage);
+
+  const size_t n = inputData.n_cols;
+  BOOST_REQUIRE_EQUAL(linkage.n_rows, 4);
+  BOOST_REQUIRE_EQUAL(linkage.n_cols, n - 1);
+  std::vector<bool> merged(2 * n - 1, false);
+  for (size_t i = 0; i < linkage.n_cols; ++i)
+  {
+    const size_t a = linkage(0, i);
+    const size_t b = linkage(1, i);
+    BOOST_REQUIRE_LT(a, b);
+    BOOST_REQUIRE_LT(b, n + i);
+    BOOST_REQUIRE(!merged[a] && !merged[b]);
+    merged[a] = merged[b] = true;
+
+    const double sizeA = (a < n) ? 1 : linkage(3, a - n);
+    const double sizeB = (b < n) ? 1 : linkage(3, b - n);
+    BOOST_REQUIRE_EQUAL(linkage(3, i), sizeA + sizeB);
+    BOOST_REQUIRE_CLOSE(linkage(2, i), results(2, i), 1e-5);
+  }
+  BOOST_REQUIRE_EQUAL(linkage(3, n - 2), n);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
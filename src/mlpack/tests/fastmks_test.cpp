@@ -127,6 +127,66 @@ BOOST_AUTO_TEST_CASE(DualTreeVsSingleTree)
   }
 }
 
+/**
+ * Make sure that dual-tree search with a query set large enough to be split
+ * into blocks (one per thread) gives the same results as naive search.
+ */
+BOOST_AUTO_TEST_CASE(BlockDualTreeVsNaive)
+{
+  arma::mat referenceData = arma::randn(5, 1000);
+  arma::mat queryData = arma::randn(5, 5000);
+  PolynomialKernel pk(2.0, 1.0);
+
+  FastMKS<PolynomialKernel> naive(referenceData, pk, false, true);
+  FastMKS<PolynomialKernel> tree(referenceData, pk);
+
+  arma::Mat<size_t> naiveIndices, treeIndices;
+  arma::mat naiveProducts, treeProducts;
+  naive.Search(queryData, 5, naiveIndices, naiveProducts);
+  tree.Search(queryData, 5, treeIndices, treeProducts);
+
+  BOOST_REQUIRE_EQUAL(treeIndices.n_cols, queryData.n_cols);
+  for (size_t q = 0; q < treeIndices.n_cols; ++q)
+  {
+    for (size_t r = 0; r < treeIndices.n_rows; ++r)
+    {
+      BOOST_REQUIRE_EQUAL(treeIndices(r, q), naiveIndices(r, q));
+      BOOST_REQUIRE_CLOSE(treeProducts(r, q), naiveProducts(r, q), 1e-5);
+    }
+  }
+}
+
+/**
+ * Make sure that FastMKS works on single-precision data.
+ */
+BOOST_AUTO_TEST_CASE(FloatFastMKSTest)
+{
+  arma::fmat data = arma::randu<arma::fmat>(5, 500);
+  arma::mat doubleData = arma::conv_to<arma::mat>::from(data);
+
+  FastMKS<LinearKernel, arma::fmat> floatmks(data);
+  FastMKS<LinearKernel> doublemks(doubleData, false, true);
+
+  arma::Mat<size_t> floatIndices, doubleIndices;
+  arma::mat floatKernels, doubleKernels;
+  floatmks.Search(3, floatIndices, floatKernels);
+  doublemks.Search(3, doubleIndices, doubleKernels);
+
+  floatmks.SingleMode() = true;
+  arma::Mat<size_t> singleIndices;
+  arma::mat singleKernels;
+  floatmks.Search(3, singleIndices, singleKernels);
+
+  for (size_t i = 0; i < floatIndices.n_cols; ++i)
+  {
+    for (size_t j = 0; j < floatIndices.n_rows; ++j)
+    {
+      BOOST_REQUIRE_CLOSE(floatKernels(j, i), doubleKernels(j, i), 1e-3);
+      BOOST_REQUIRE_CLOSE(singleKernels(j, i), doubleKernels(j, i), 1e-3);
+    }
+  }
+}
+
 /**
  * Test sparse FastMKS (how useful is this, I'm not sure).
  */
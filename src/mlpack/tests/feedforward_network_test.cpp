@@ -15,6 +15,8 @@
 #include <mlpack/methods/ann/layer/layer.hpp>
 #include <mlpack/methods/ann/loss_functions/mean_squared_error.hpp>
 #include <mlpack/methods/ann/ffn.hpp>
+#include <mlpack/methods/ann/static_ffn.hpp>
+#include <mlpack/methods/ann/inference_ffn.hpp>
 
 #include <ensmallen.hpp>
 
@@ -579,6 +581,660 @@ BOOST_AUTO_TEST_CASE(PartialForwardTest)
   CheckMatrices(output, arma::ones(10, 1) * 20);
 }
 
+/**
+ * Make sure that predicting in batches gives the same results as predicting
+ * one point at a time, including when the last batch is smaller.
+ */
+BOOST_AUTO_TEST_CASE(FFNBatchPredictTest)
+{
+  FFN<NegativeLogLikelihood<>, RandomInitialization> model;
+  model.Add<Linear<> >(5, 8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(8, 3);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  arma::mat input = arma::randu<arma::mat>(5, 103);
+
+  arma::mat singleResults, batchResults, defaultResults;
+  model.Predict(input, singleResults, 1);
+  model.Predict(input, batchResults, 10);
+  model.Predict(input, defaultResults);
+
+  BOOST_REQUIRE_EQUAL(batchResults.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(batchResults.n_cols, 103);
+  CheckMatrices(singleResults, batchResults);
+  CheckMatrices(singleResults, defaultResults);
+}
+
+/**
+ * Make sure that computing the gradient of a batch with several threads gives
+ * the same objective and gradient as computing it with one thread.
+ */
+BOOST_AUTO_TEST_CASE(ParallelGradientTest)
+{
+  FFN<NegativeLogLikelihood<>, RandomInitialization> model;
+  model.Add<Linear<> >(5, 8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(8, 3);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  arma::mat input = arma::randu<arma::mat>(5, 40);
+  arma::mat labels = arma::randi<arma::mat>(1, 40, arma::distr_param(1, 3));
+  model.Predictors() = input;
+  model.Responses() = labels;
+
+  FFN<NegativeLogLikelihood<>, RandomInitialization> parallelModel(model);
+  parallelModel.ResetParameters();
+  parallelModel.Parameters() = model.Parameters();
+  parallelModel.NumThreads() = 3;
+
+  // Try a batch that does not split evenly, and a second batch to make sure
+  // the copies of the network are reused.
+  for (size_t begin = 0; begin < 40; begin += 20)
+  {
+    arma::mat gradient, parallelGradient;
+    const double objective = model.EvaluateWithGradient(model.Parameters(),
+        begin, gradient, 19);
+    const double parallelObjective = parallelModel.EvaluateWithGradient(
+        parallelModel.Parameters(), begin, parallelGradient, 19);
+
+    BOOST_REQUIRE_CLOSE(objective, parallelObjective, 1e-5);
+    CheckMatrices(gradient, parallelGradient, 1e-5);
+  }
+
+  // The copies must follow changes of the parameters.
+  model.Parameters() *= 0.5;
+  parallelModel.Parameters() *= 0.5;
+  arma::mat gradient, parallelGradient;
+  const double objective = model.EvaluateWithGradient(model.Parameters(), 0,
+      gradient, 40);
+  const double parallelObjective = parallelModel.EvaluateWithGradient(
+      parallelModel.Parameters(), 0, parallelGradient, 40);
+
+  BOOST_REQUIRE_CLOSE(objective, parallelObjective, 1e-5);
+  CheckMatrices(gradient, parallelGradient, 1e-5);
+}
+
+/**
+ * Make sure that the sparse gradient matches the dense gradient, and that only
+ * the embeddings of the tokens in the batch have a nonzero gradient.
+ */
+BOOST_AUTO_TEST_CASE(SparseGradientTest)
+{
+  FFN<NegativeLogLikelihood<>, RandomInitialization> model;
+  model.Add<Lookup<> >(20, 4);
+  model.Add<Linear<> >(4, 3);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  // Only the first five tokens are used.
+  model.Predictors() = arma::randi<arma::mat>(1, 30, arma::distr_param(1, 5));
+  model.Responses() = arma::randi<arma::mat>(1, 30, arma::distr_param(1, 3));
+
+  arma::mat gradient;
+  arma::sp_mat sparseGradient;
+  const double objective = model.EvaluateWithGradient(model.Parameters(), 0,
+      gradient, 30);
+  const double sparseObjective = model.EvaluateWithGradient(
+      model.Parameters(), 0, sparseGradient, 30);
+
+  BOOST_REQUIRE_CLOSE(objective, sparseObjective, 1e-5);
+  CheckMatrices(gradient, arma::mat(sparseGradient), 1e-5);
+
+  // The embedding table is stored first, one column of four values per token.
+  for (arma::sp_mat::const_iterator it = sparseGradient.begin();
+      it != sparseGradient.end(); ++it)
+  {
+    if (it.row() < 20 * 4)
+      BOOST_REQUIRE_LT(it.row() / 4, 5);
+  }
+
+  // With several threads, the columns of the copies of the Lookup layer are
+  // summed.
+  model.NumThreads() = 3;
+  arma::sp_mat parallelGradient;
+  model.EvaluateWithGradient(model.Parameters(), 0, parallelGradient, 30);
+  CheckMatrices(gradient, arma::mat(parallelGradient), 1e-5);
+
+  // The dense gradient is still complete afterwards.
+  model.NumThreads() = 1;
+  arma::mat denseGradient;
+  model.EvaluateWithGradient(model.Parameters(), 0, denseGradient, 30);
+  CheckMatrices(gradient, denseGradient, 1e-5);
+}
+
+/**
+ * Make sure that training on sparse predictors gives the same model and the
+ * same predictions as training on the same predictors densified, with a first
+ * Linear or LinearNoBias layer.
+ */
+BOOST_AUTO_TEST_CASE(SparsePredictorsTest)
+{
+  arma::sp_mat sparseData;
+  sparseData.sprandu(200, 60, 0.05);
+  const arma::mat data(sparseData);
+  const arma::mat labels = arma::randi<arma::mat>(1, 60,
+      arma::distr_param(1, 3));
+
+  for (size_t bias = 0; bias < 2; ++bias)
+  {
+    FFN<NegativeLogLikelihood<>, RandomInitialization> model, sparseModel;
+    if (bias == 1)
+    {
+      model.Add<Linear<> >(200, 8);
+      sparseModel.Add<Linear<> >(200, 8);
+    }
+    else
+    {
+      model.Add<LinearNoBias<> >(200, 8);
+      sparseModel.Add<LinearNoBias<> >(200, 8);
+    }
+    model.Add<SigmoidLayer<> >();
+    model.Add<Linear<> >(8, 3);
+    model.Add<LogSoftMax<> >();
+    sparseModel.Add<SigmoidLayer<> >();
+    sparseModel.Add<Linear<> >(8, 3);
+    sparseModel.Add<LogSoftMax<> >();
+
+    // Use the same initial parameters, and don't shuffle, so both models see
+    // the same batches.
+    ens::StandardSGD opt(0.1, 16, 120, -1, false);
+    math::RandomSeed(1);
+    const double objective = model.Train(data, labels, opt);
+    math::RandomSeed(1);
+    const double sparseObjective = sparseModel.Train(sparseData, labels, opt);
+
+    BOOST_REQUIRE_CLOSE(objective, sparseObjective, 1e-5);
+    CheckMatrices(model.Parameters(), sparseModel.Parameters(), 1e-5);
+
+    arma::mat predictions, sparsePredictions;
+    model.Predict(data, predictions, 16);
+    sparseModel.Predict(sparseData, sparsePredictions, 16);
+    CheckMatrices(predictions, sparsePredictions, 1e-5);
+  }
+}
+
+/**
+ * Make sure that after Shuffle() the batches are the points of the shuffled
+ * order, as if the data itself had been shuffled.
+ */
+BOOST_AUTO_TEST_CASE(ShuffledBatchTest)
+{
+  FFN<NegativeLogLikelihood<>, RandomInitialization> model;
+  model.Add<Linear<> >(5, 8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(8, 3);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  arma::mat input = arma::randu<arma::mat>(5, 40);
+  arma::mat labels = arma::randi<arma::mat>(1, 40, arma::distr_param(1, 3));
+  model.Predictors() = input;
+  model.Responses() = labels;
+  FFN<NegativeLogLikelihood<>, RandomInitialization> shuffledModel(model);
+
+  // Shuffle() draws the same order as this.
+  math::RandomSeed(3);
+  model.Shuffle();
+  math::RandomSeed(3);
+  const arma::uvec order = arma::shuffle(arma::linspace<arma::uvec>(0, 39,
+      40));
+  shuffledModel.Predictors() = input.cols(order);
+  shuffledModel.Responses() = labels.cols(order);
+
+  for (size_t begin = 0; begin < 40; begin += 16)
+  {
+    const size_t batchSize = std::min(size_t(16), 40 - begin);
+    arma::mat gradient, shuffledGradient;
+    const double objective = model.EvaluateWithGradient(model.Parameters(),
+        begin, gradient, batchSize);
+    const double shuffledObjective = shuffledModel.EvaluateWithGradient(
+        shuffledModel.Parameters(), begin, shuffledGradient, batchSize);
+
+    BOOST_REQUIRE_CLOSE(objective, shuffledObjective, 1e-5);
+    CheckMatrices(gradient, shuffledGradient, 1e-5);
+    BOOST_REQUIRE_CLOSE(model.Evaluate(model.Parameters(), begin, batchSize),
+        shuffledModel.Evaluate(shuffledModel.Parameters(), begin, batchSize),
+        1e-5);
+  }
+
+  // The data itself is not moved.
+  CheckMatrices(model.Predictors(), input);
+}
+
+/**
+ * Make sure that BatchPrefetcher gathers the points of each batch, and uses
+ * the prefetched batch when the next batch is requested.
+ */
+BOOST_AUTO_TEST_CASE(BatchPrefetcherTest)
+{
+  arma::mat data = arma::randu<arma::mat>(4, 50);
+  arma::mat responses = arma::randu<arma::mat>(2, 50);
+  arma::uvec order = arma::shuffle(arma::linspace<arma::uvec>(0, 49, 50));
+
+  BatchPrefetcher<arma::mat, arma::mat> prefetcher;
+  for (size_t begin = 0; begin < 50; begin += 16)
+  {
+    const arma::uvec indices = order.subvec(begin,
+        std::min(begin + 16, size_t(50)) - 1);
+    prefetcher.Next(data, responses, order, begin, indices.n_elem, true);
+    CheckMatrices(prefetcher.Predictors(), data.cols(indices));
+    CheckMatrices(prefetcher.Responses(), responses.cols(indices));
+  }
+
+  // Every batch but the first one was prefetched.
+  BOOST_REQUIRE_EQUAL(prefetcher.Prefetched(), 3);
+
+  // Any other batch is gathered when it is requested.
+  prefetcher.Next(data, responses, order, 5, 10, true);
+  prefetcher.Next(data, responses, order, 5, 10, false);
+  CheckMatrices(prefetcher.Predictors(), data.cols(order.subvec(5, 14)));
+  BOOST_REQUIRE_EQUAL(prefetcher.Prefetched(), 3);
+  prefetcher.Reset();
+
+  arma::sp_mat sparseData;
+  sparseData.sprandu(30, 50, 0.1);
+  BatchPrefetcher<arma::sp_mat, arma::mat> sparsePrefetcher;
+  sparsePrefetcher.Next(sparseData, responses, order, 16, 16, false);
+  CheckMatrices(arma::mat(sparsePrefetcher.Predictors()),
+      arma::mat(sparseData).cols(order.subvec(16, 31)));
+}
+
+/**
+ * Build a network with a Sequential block in the middle, and return the block.
+ */
+Sequential<>* BuildCheckpointNetwork(
+    FFN<NegativeLogLikelihood<>, RandomInitialization>& model)
+{
+  Sequential<>* block = new Sequential<>();
+  block->Add<Linear<> >(8, 8);
+  block->Add<SigmoidLayer<> >();
+  block->Add<Linear<> >(8, 8);
+  block->Add<TanHLayer<> >();
+
+  model.Add<Linear<> >(5, 8);
+  model.Add(block);
+  model.Add<Linear<> >(8, 3);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  return block;
+}
+
+/**
+ * Make sure that a checkpointed Sequential block gives the same objective and
+ * gradient, and discards the outputs of its layers after the forward pass.
+ */
+BOOST_AUTO_TEST_CASE(CheckpointSequentialTest)
+{
+  FFN<NegativeLogLikelihood<>, RandomInitialization> model, checkpointModel;
+  BuildCheckpointNetwork(model);
+  Sequential<>* block = BuildCheckpointNetwork(checkpointModel);
+  block->Checkpoint() = true;
+  checkpointModel.Parameters() = model.Parameters();
+
+  arma::mat input = arma::randu<arma::mat>(5, 20);
+  arma::mat labels = arma::randi<arma::mat>(1, 20, arma::distr_param(1, 3));
+  model.Predictors() = input;
+  model.Responses() = labels;
+  checkpointModel.Predictors() = input;
+  checkpointModel.Responses() = labels;
+
+  for (size_t i = 0; i < 2; ++i)
+  {
+    arma::mat gradient, checkpointGradient;
+    const double objective = model.EvaluateWithGradient(model.Parameters(), 0,
+        gradient, 20);
+    const double checkpointObjective = checkpointModel.EvaluateWithGradient(
+        checkpointModel.Parameters(), 0, checkpointGradient, 20);
+
+    BOOST_REQUIRE_CLOSE(objective, checkpointObjective, 1e-5);
+    CheckMatrices(gradient, checkpointGradient, 1e-5);
+
+    model.Parameters() *= 0.5;
+    checkpointModel.Parameters() *= 0.5;
+  }
+
+  arma::mat output;
+  block->Forward(std::move(input), std::move(output));
+  BOOST_REQUIRE_EQUAL(output.n_rows, 8);
+  for (size_t i = 0; i < block->Model().size(); ++i)
+  {
+    BOOST_REQUIRE(boost::apply_visitor(OutputParameterVisitor(),
+        block->Model()[i]).is_empty());
+  }
+}
+
+/**
+ * Make sure that a StaticFFN computes the same objective, gradient and
+ * predictions as an FFN with the same layers and parameters.
+ */
+BOOST_AUTO_TEST_CASE(StaticFFNTest)
+{
+  FFN<NegativeLogLikelihood<>, RandomInitialization> model;
+  model.Add<Linear<> >(5, 8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(8, 3);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  StaticFFN<NegativeLogLikelihood<>, RandomInitialization, Linear<>,
+      SigmoidLayer<>, Linear<>, LogSoftMax<> > staticModel(Linear<>(5, 8),
+      SigmoidLayer<>(), Linear<>(8, 3), LogSoftMax<>());
+  staticModel.ResetParameters();
+
+  BOOST_REQUIRE_EQUAL(staticModel.Parameters().n_elem,
+      model.Parameters().n_elem);
+  staticModel.Parameters() = model.Parameters();
+
+  arma::mat input = arma::randu<arma::mat>(5, 20);
+  arma::mat labels = arma::randi<arma::mat>(1, 20, arma::distr_param(1, 3));
+  model.Predictors() = input;
+  model.Responses() = labels;
+  staticModel.Predictors() = input;
+  staticModel.Responses() = labels;
+
+  arma::mat gradient, staticGradient;
+  const double objective = model.EvaluateWithGradient(model.Parameters(), 0,
+      gradient, 20);
+  const double staticObjective = staticModel.EvaluateWithGradient(
+      staticModel.Parameters(), 0, staticGradient, 20);
+
+  BOOST_REQUIRE_CLOSE(objective, staticObjective, 1e-5);
+  CheckMatrices(gradient, staticGradient, 1e-5);
+
+  arma::mat predictions, staticPredictions;
+  model.Predict(input, predictions, 7);
+  staticModel.Predict(input, staticPredictions, 7);
+  CheckMatrices(predictions, staticPredictions, 1e-5);
+
+  // A copy has its own parameters.
+  StaticFFN<NegativeLogLikelihood<>, RandomInitialization, Linear<>,
+      SigmoidLayer<>, Linear<>, LogSoftMax<> > copy(staticModel);
+  staticModel.Parameters().zeros();
+  copy.Predict(input, staticPredictions);
+  CheckMatrices(predictions, staticPredictions, 1e-5);
+}
+
+/**
+ * Make sure that a StaticFFN can be loaded into an FFN with the same layers.
+ */
+BOOST_AUTO_TEST_CASE(StaticFFNSerializationTest)
+{
+  StaticFFN<NegativeLogLikelihood<>, RandomInitialization, Linear<>,
+      SigmoidLayer<>, Linear<>, LogSoftMax<> > staticModel(Linear<>(5, 8),
+      SigmoidLayer<>(), Linear<>(8, 3), LogSoftMax<>());
+  staticModel.ResetParameters();
+
+  std::stringstream stream;
+  {
+    boost::archive::xml_oarchive o(stream);
+    o << boost::serialization::make_nvp("model", staticModel);
+  }
+
+  FFN<NegativeLogLikelihood<>, RandomInitialization> model;
+  {
+    boost::archive::xml_iarchive i(stream);
+    i >> boost::serialization::make_nvp("model", model);
+  }
+
+  arma::mat input = arma::randu<arma::mat>(5, 20);
+  arma::mat predictions, staticPredictions;
+  model.Predict(input, predictions);
+  staticModel.Predict(input, staticPredictions);
+  CheckMatrices(predictions, staticPredictions, 1e-5);
+}
+
+/**
+ * Make sure that a StaticFFN with single precision layers computes the same
+ * objective, gradient and predictions as the double precision network, and
+ * that it can be trained.
+ */
+BOOST_AUTO_TEST_CASE(StaticFFNFloatTest)
+{
+  StaticFFN<NegativeLogLikelihood<>, RandomInitialization, Linear<>,
+      SigmoidLayer<>, Linear<>, LogSoftMax<> > model(Linear<>(5, 8),
+      SigmoidLayer<>(), Linear<>(8, 3), LogSoftMax<>());
+  model.ResetParameters();
+
+  StaticFFN<NegativeLogLikelihood<arma::fmat, arma::fmat>,
+      RandomInitialization, Linear<arma::fmat, arma::fmat>,
+      SigmoidLayer<LogisticFunction, arma::fmat, arma::fmat>,
+      Linear<arma::fmat, arma::fmat>, LogSoftMax<arma::fmat, arma::fmat> >
+      floatModel(Linear<arma::fmat, arma::fmat>(5, 8),
+      SigmoidLayer<LogisticFunction, arma::fmat, arma::fmat>(),
+      Linear<arma::fmat, arma::fmat>(8, 3),
+      LogSoftMax<arma::fmat, arma::fmat>());
+  floatModel.ResetParameters();
+
+  BOOST_REQUIRE_EQUAL(floatModel.Parameters().n_elem,
+      model.Parameters().n_elem);
+  floatModel.Parameters() = arma::conv_to<arma::fmat>::from(
+      model.Parameters());
+
+  arma::mat input = arma::randu<arma::mat>(5, 20);
+  arma::mat labels = arma::randi<arma::mat>(1, 20, arma::distr_param(1, 3));
+  model.Predictors() = input;
+  model.Responses() = labels;
+  floatModel.Predictors() = arma::conv_to<arma::fmat>::from(input);
+  floatModel.Responses() = arma::conv_to<arma::fmat>::from(labels);
+
+  arma::mat gradient;
+  arma::fmat floatGradient;
+  const double objective = model.EvaluateWithGradient(model.Parameters(), 0,
+      gradient, 20);
+  const double floatObjective = floatModel.EvaluateWithGradient(
+      floatModel.Parameters(), 0, floatGradient, 20);
+
+  BOOST_REQUIRE_CLOSE(objective, floatObjective, 1e-2);
+  CheckMatrices(gradient, arma::conv_to<arma::mat>::from(floatGradient),
+      0.1);
+
+  arma::mat predictions;
+  arma::fmat floatPredictions;
+  model.Predict(input, predictions, 7);
+  floatModel.Predict(arma::conv_to<arma::fmat>::from(input), floatPredictions,
+      7);
+  CheckMatrices(predictions, arma::conv_to<arma::mat>::from(floatPredictions),
+      0.1);
+
+  // Training should reduce the objective.
+  ens::RMSProp opt(0.01, 10, 0.88, 1e-8, 200, -1);
+  const double trainedObjective = floatModel.Train(
+      arma::conv_to<arma::fmat>::from(input),
+      arma::conv_to<arma::fmat>::from(labels), opt);
+  BOOST_REQUIRE_LT(trainedObjective, floatObjective);
+}
+
+/**
+ * Make sure that the fused InferenceFFN predicts the same as the trained FFN
+ * it was built from.
+ */
+BOOST_AUTO_TEST_CASE(InferenceFFNTest)
+{
+  FFN<NegativeLogLikelihood<>, RandomInitialization> model;
+  model.Add<Linear<> >(5, 8);
+  model.Add<BatchNorm<> >(8);
+  model.Add<ReLULayer<> >();
+  model.Add<Linear<> >(8, 6);
+  model.Add<TanHLayer<> >();
+  model.Add<LinearNoBias<> >(6, 6);
+  model.Add<LeakyReLU<> >(0.1);
+  model.Add<Dropout<> >();
+  model.Add<Linear<> >(6, 3);
+  model.Add<SigmoidLayer<> >();
+  model.Add<LogSoftMax<> >();
+
+  // Train the model for a little while, so that the batch normalization
+  // statistics are not trivial.
+  arma::mat input = arma::randu<arma::mat>(5, 100);
+  arma::mat labels = arma::randi<arma::mat>(1, 100, arma::distr_param(1, 3));
+  ens::RMSProp opt(0.01, 10, 0.88, 1e-8, 200, -1);
+  model.Train(input, labels, opt);
+
+  InferenceFFN<> predictor(model);
+
+  // Each of the four linear layers is fused with its activation function, the
+  // first one also with the BatchNorm layer; the Dropout and LogSoftMax layers
+  // stay.
+  BOOST_REQUIRE_EQUAL(predictor.NumFused(), 4);
+  BOOST_REQUIRE_EQUAL(predictor.NumStages(), 6);
+
+  arma::mat predictions, fusedPredictions;
+  model.Predict(input, predictions);
+  predictor.Predict(input, fusedPredictions, 30);
+  CheckMatrices(predictions, fusedPredictions, 1e-5);
+
+  // A copy predicts the same.
+  InferenceFFN<> copy(predictor);
+  copy.Predict(input, fusedPredictions);
+  CheckMatrices(predictions, fusedPredictions, 1e-5);
+}
+
+/**
+ * Make sure that several threads can predict with the same InferenceFFN at
+ * once, each with its own context.
+ */
+BOOST_AUTO_TEST_CASE(InferenceFFNContextTest)
+{
+  // The LayerNorm layer keeps state in its forward pass, so it is copied into
+  // each context.
+  FFN<NegativeLogLikelihood<>, RandomInitialization> model;
+  model.Add<Linear<> >(5, 8);
+  model.Add<LayerNorm<> >(8);
+  model.Add<TanHLayer<> >();
+  model.Add<Linear<> >(8, 3);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  arma::mat input = arma::randu<arma::mat>(5, 100);
+  arma::mat predictions;
+  model.Predict(input, predictions);
+
+  const InferenceFFN<> predictor(model);
+
+  std::vector<InferenceFFN<>::Context> contexts(4);
+  std::vector<arma::mat> threadPredictions(4);
+  #pragma omp parallel for
+  for (omp_size_t t = 0; t < 4; ++t)
+  {
+    // Predict twice to make sure the context can be reused.
+    const arma::mat threadInput = input.cols(25 * t, 25 * t + 24);
+    predictor.Predict(threadInput, threadPredictions[t], contexts[t], 10);
+    predictor.Predict(threadInput, threadPredictions[t], contexts[t], 10);
+  }
+
+  for (size_t t = 0; t < 4; ++t)
+  {
+    CheckMatrices(predictions.cols(25 * t, 25 * t + 24),
+        threadPredictions[t], 1e-5);
+  }
+}
+
+/**
+ * Make sure that a quantized InferenceFFN predicts close to the FFN it was
+ * built from, with dynamic and with calibrated input scales.
+ */
+BOOST_AUTO_TEST_CASE(InferenceFFNQuantizedTest)
+{
+  FFN<NegativeLogLikelihood<>, RandomInitialization> model(
+      NegativeLogLikelihood<>(), RandomInitialization(-0.3, 0.3));
+  model.Add<Convolution<> >(1, 2, 3, 3, 1, 1, 1, 1, 6, 6);
+  model.Add<ReLULayer<> >();
+  model.Add<Linear<> >(72, 8);
+  model.Add<BatchNorm<> >(8);
+  model.Add<TanHLayer<> >();
+  model.Add<LinearNoBias<> >(8, 3);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  arma::mat input = arma::randu<arma::mat>(36, 50);
+  arma::mat predictions;
+  model.Predict(input, predictions);
+
+  // The convolution and both linear layers are quantized together with the
+  // layers that follow them; only the LogSoftMax layer stays.
+  InferenceFFN<> quantized(model, true);
+  BOOST_REQUIRE_EQUAL(quantized.NumQuantized(), 3);
+  BOOST_REQUIRE_EQUAL(quantized.NumStages(), 4);
+
+  arma::mat quantizedPredictions;
+  quantized.Predict(input, quantizedPredictions, 20);
+  BOOST_REQUIRE_EQUAL(quantizedPredictions.n_rows, predictions.n_rows);
+  BOOST_REQUIRE_EQUAL(quantizedPredictions.n_cols, predictions.n_cols);
+  BOOST_REQUIRE_LT(arma::abs(predictions - quantizedPredictions).max(), 0.05);
+
+  // The calibration data covers the range of the inputs, so the fixed scales
+  // give the same accuracy.
+  InferenceFFN<> calibrated(model, input);
+  BOOST_REQUIRE_EQUAL(calibrated.NumQuantized(), 3);
+
+  calibrated.Predict(input, quantizedPredictions);
+  BOOST_REQUIRE_LT(arma::abs(predictions - quantizedPredictions).max(), 0.05);
+
+  // Without quantization the convolution is run as it is.
+  InferenceFFN<> predictor(model);
+  BOOST_REQUIRE_EQUAL(predictor.NumQuantized(), 0);
+  BOOST_REQUIRE_EQUAL(predictor.NumStages(), 5);
+}
+
+/**
+ * Make sure that the layer profiler records the passes of each layer when it
+ * is enabled, and nothing otherwise.
+ */
+BOOST_AUTO_TEST_CASE(FFNLayerProfilerTest)
+{
+  FFN<NegativeLogLikelihood<>, RandomInitialization> model;
+  model.Add<Linear<> >(5, 8);
+  model.Add<ReLULayer<> >();
+  model.Add<Linear<> >(8, 3);
+  model.Add<LogSoftMax<> >();
+
+  arma::mat input = arma::randu<arma::mat>(5, 100);
+  arma::mat labels = arma::randi<arma::mat>(1, 100, arma::distr_param(1, 3));
+  arma::mat output, gradient;
+  model.Forward(input, output);
+  model.Backward(labels, gradient);
+  BOOST_REQUIRE(model.Profiler().Profiles().empty());
+
+  model.Profiler().Enabled() = true;
+  model.Forward(input, output);
+  model.Backward(labels, gradient);
+  model.Forward(input, output);
+  model.Backward(labels, gradient);
+
+  const std::vector<LayerProfiler::LayerProfile>& profiles =
+      model.Profiler().Profiles();
+  BOOST_REQUIRE_EQUAL(profiles.size(), 4);
+  BOOST_REQUIRE_EQUAL(profiles[0].name, "Linear");
+  BOOST_REQUIRE_EQUAL(profiles[2].name, "Linear");
+  BOOST_REQUIRE_EQUAL(profiles[3].name, "LogSoftMax");
+  for (size_t i = 0; i < profiles.size(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(profiles[i].forward.calls, 2);
+    BOOST_REQUIRE_EQUAL(profiles[i].gradient.calls, 2);
+    BOOST_REQUIRE_GE(profiles[i].forward.time, 0.0);
+    BOOST_REQUIRE_GT(profiles[i].forward.flops, 0.0);
+    BOOST_REQUIRE_EQUAL(profiles[i].forward.cols, 100);
+  }
+
+  // The first layer does not propagate the error back.
+  BOOST_REQUIRE_EQUAL(profiles[0].backward.calls, 0);
+  BOOST_REQUIRE_EQUAL(profiles[1].backward.calls, 2);
+  BOOST_REQUIRE_EQUAL(profiles[2].forward.rows, 3);
+  BOOST_REQUIRE_EQUAL(profiles[2].forward.bytes, 2 * 300 * sizeof(double));
+  BOOST_REQUIRE_CLOSE(profiles[2].forward.flops, 2 * 2.0 * 27 * 100, 1e-5);
+
+  std::ostringstream report;
+  model.Profiler().Report(report);
+  BOOST_REQUIRE_NE(report.str().find("Linear"), std::string::npos);
+
+  model.Profiler().Clear();
+  BOOST_REQUIRE(model.Profiler().Profiles().empty());
+}
+
 /**
  * Test that FFN::Train() returns finite objective value.
  */
@@ -613,4 +1269,51 @@ BOOST_AUTO_TEST_CASE(FFNTrainReturnObjective)
 
   BOOST_REQUIRE_EQUAL(std::isfinite(objVal), true);
 }
+
+/**
+ * Make sure that a network saved as a weight file and mapped back into memory
+ * gives the same predictions, and that its parameters are not copied.
+ */
+BOOST_AUTO_TEST_CASE(FFNSaveLoadFlatTest)
+{
+  arma::mat input = arma::randu<arma::mat>(10, 50);
+
+  FFN<NegativeLogLikelihood<> > model;
+  model.Add<Linear<> >(10, 8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(8, 3);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  arma::mat predictions, flatPredictions;
+  model.Predict(input, predictions);
+  model.SaveFlat("ffn_weights.bin");
+
+  // Load into a network with different layers, which should be replaced.
+  FFN<NegativeLogLikelihood<> > flatModel;
+  flatModel.Add<Linear<> >(10, 2);
+  flatModel.Add<LogSoftMax<> >();
+  flatModel.LoadFlat("ffn_weights.bin");
+
+  BOOST_REQUIRE_EQUAL(flatModel.Model().size(), 4);
+  BOOST_REQUIRE_EQUAL(flatModel.Parameters().n_elem,
+      model.Parameters().n_elem);
+  BOOST_REQUIRE_EQUAL(flatModel.Parameters().mem_state, 1);
+  BOOST_REQUIRE_EQUAL((size_t) flatModel.Parameters().memptr() % 4096, 0);
+  CheckMatrices(model.Parameters(), flatModel.Parameters());
+
+  flatModel.Predict(input, flatPredictions);
+  CheckMatrices(predictions, flatPredictions);
+
+  // Loading something that is not a weight file should fail.
+  data::Save("ffn_not_weights.csv", input);
+  BOOST_REQUIRE_THROW(flatModel.LoadFlat("ffn_not_weights.csv"),
+      std::runtime_error);
+  flatModel.Predict(input, flatPredictions);
+  CheckMatrices(predictions, flatPredictions);
+
+  remove("ffn_weights.bin");
+  remove("ffn_not_weights.csv");
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -305,4 +305,71 @@ BOOST_AUTO_TEST_CASE(GANMemorySharingTest)
       trainData);
 }
 
+/**
+ * A noise function that fills the whole noise matrix at once, and counts how
+ * often it was called.
+ */
+class BulkNoise
+{
+ public:
+  BulkNoise(size_t& calls) : calls(&calls) { }
+
+  void operator()(arma::mat& noise)
+  {
+    noise.randn();
+    ++(*calls);
+  }
+
+ private:
+  size_t* calls;
+};
+
+/**
+ * Make sure that the Discriminator gradient computed on the stacked real and
+ * generated points matches the gradients computed on each of them, and that
+ * a noise function that takes a matrix is used to fill it at once.
+ */
+BOOST_AUTO_TEST_CASE(GANStackedBatchTest)
+{
+  const size_t batchSize = 4;
+  arma::mat trainData = arma::randn(2, 20);
+
+  FFN<SigmoidCrossEntropyError<> > discriminator;
+  discriminator.Add<Linear<> >(2, 6);
+  discriminator.Add<ReLULayer<> >();
+  discriminator.Add<Linear<> >(6, 1);
+
+  FFN<SigmoidCrossEntropyError<> > generator;
+  generator.Add<Linear<> >(3, 6);
+  generator.Add<SoftPlusLayer<> >();
+  generator.Add<Linear<> >(6, 2);
+
+  GaussianInitialization gaussian(0, 0.1);
+  size_t calls = 0;
+  BulkNoise noiseFunction(calls);
+  GAN<FFN<SigmoidCrossEntropyError<> >, GaussianInitialization, BulkNoise>
+      gan(trainData, generator, discriminator, gaussian, noiseFunction, 3,
+      batchSize, 1, 0, 1);
+  gan.Reset();
+
+  arma::mat gradient;
+  const double objective = gan.EvaluateWithGradient(gan.Parameters(), 0,
+      gradient, batchSize);
+  BOOST_REQUIRE_EQUAL(calls, 1);
+
+  // The generated points are stored after the real points.
+  FFN<SigmoidCrossEntropyError<> >& model = gan.Discriminator();
+  gan.Responses().cols(20, 20 + batchSize - 1).zeros();
+  arma::mat realGradient, fakeGradient;
+  double expectedObjective = model.EvaluateWithGradient(model.Parameters(), 0,
+      realGradient, batchSize);
+  expectedObjective += model.EvaluateWithGradient(model.Parameters(), 20,
+      fakeGradient, batchSize);
+
+  BOOST_REQUIRE_CLOSE(objective, expectedObjective, 1e-5);
+  const size_t generatorWeights = gan.Generator().Parameters().n_elem;
+  CheckMatrices(arma::mat(gradient.rows(generatorWeights, gradient.n_rows - 1)),
+      arma::mat(realGradient + fakeGradient), 1e-5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -22,6 +22,7 @@
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
+#include "serialization.hpp"
 
 using namespace mlpack;
 using namespace mlpack::gmm;
@@ -79,6 +80,27 @@ BOOST_AUTO_TEST_CASE(GMMProbabilityComponentTest)
   BOOST_REQUIRE_CLOSE(gmm.Probability("1.4 0", 1), 0.0067568972024, 1e-5);
 }
 
+/**
+ * Make sure the batch GMM::LogProbability() gives the same results as the
+ * single-observation version.
+ */
+BOOST_AUTO_TEST_CASE(GMMBatchLogProbabilityTest)
+{
+  GMM gmm(2, 2);
+  gmm.Component(0) = distribution::GaussianDistribution("0 0", "1 0; 0 1");
+  gmm.Component(1) = distribution::GaussianDistribution("3 3", "2 1; 1 2");
+  gmm.Weights() = "0.3 0.7";
+
+  const arma::mat points = 6.0 * arma::randu<arma::mat>(2, 100) - 1.0;
+
+  arma::vec logProbs;
+  gmm.LogProbability(points, logProbs);
+
+  BOOST_REQUIRE_EQUAL(logProbs.n_elem, points.n_cols);
+  for (size_t i = 0; i < points.n_cols; ++i)
+    BOOST_REQUIRE_CLOSE(logProbs[i], gmm.LogProbability(points.col(i)), 1e-5);
+}
+
 /**
  * Test training a model on only one Gaussian (randomly generated) in two
  * dimensions.  We will vary the dataset size from small to large.  The EM
@@ -121,6 +143,86 @@ BOOST_AUTO_TEST_CASE(GMMTrainEMOneGaussian)
   }
 }
 
+/**
+ * Train on two well-separated Gaussians with more points than fit in a single
+ * block of the E-step, and make sure each component recovers the statistics of
+ * its own points exactly.
+ */
+BOOST_AUTO_TEST_CASE(GMMTrainEMSeparatedGaussiansBlocks)
+{
+  arma::mat data;
+  data.randn(3, 5000);
+  data.cols(2500, 4999) += 100.0;
+
+  GMM gmm(2, 3);
+  gmm.Train(data, 1);
+
+  // Find which component models the points near the origin.
+  const size_t first = (arma::norm(gmm.Component(0).Mean()) <
+      arma::norm(gmm.Component(1).Mean())) ? 0 : 1;
+
+  for (size_t c = 0; c < 2; ++c)
+  {
+    const size_t begin = (c == 0) ? 0 : 2500;
+    const arma::mat points = data.cols(begin, begin + 2499);
+    const size_t component = (c == 0) ? first : 1 - first;
+
+    arma::vec actualMean = arma::mean(points, 1);
+    arma::mat actualCovar = mlpack::math::ColumnCovariance(points,
+        1 /* biased estimator */);
+
+    BOOST_REQUIRE_LT(arma::norm(gmm.Component(component).Mean() - actualMean),
+        1e-5);
+    BOOST_REQUIRE_LT(arma::norm(gmm.Component(component).Covariance() -
+        actualCovar), 1e-4);
+    BOOST_REQUIRE_CLOSE(gmm.Weights()[component], 0.5, 1e-4);
+  }
+}
+
+/**
+ * Train a GMM incrementally with stepwise EM on batches that each contain
+ * points of two well-separated Gaussians, and make sure the result is close to
+ * the true model.
+ */
+BOOST_AUTO_TEST_CASE(GMMStepwiseEMSeparatedGaussians)
+{
+  // Every other point belongs to the second Gaussian, so each batch sees both.
+  arma::mat data;
+  data.randn(3, 10000);
+  for (size_t i = 1; i < data.n_cols; i += 2)
+    data.col(i) += 100.0;
+
+  GMM gmm(2, 3);
+  for (size_t begin = 0; begin < data.n_cols; begin += 500)
+    gmm.Update(data.cols(begin, begin + 499));
+
+  BOOST_REQUIRE_EQUAL(gmm.Batches(), 20);
+
+  const size_t first = (arma::norm(gmm.Component(0).Mean()) <
+      arma::norm(gmm.Component(1).Mean())) ? 0 : 1;
+
+  for (size_t c = 0; c < 2; ++c)
+  {
+    const size_t component = (c == 0) ? first : 1 - first;
+    const arma::vec trueMean = arma::vec(3).fill(100.0 * c);
+
+    BOOST_REQUIRE_LT(arma::norm(gmm.Component(component).Mean() - trueMean),
+        0.2);
+    BOOST_REQUIRE_LT(arma::norm(gmm.Component(component).Covariance() -
+        arma::eye<arma::mat>(3, 3)), 0.3);
+    BOOST_REQUIRE_CLOSE(gmm.Weights()[component], 0.5, 2.0);
+  }
+}
+
+/**
+ * Make sure an invalid decay is rejected by StepwiseEM.
+ */
+BOOST_AUTO_TEST_CASE(StepwiseEMInvalidDecayTest)
+{
+  BOOST_REQUIRE_THROW(StepwiseEM<> em(0.5), std::invalid_argument);
+  BOOST_REQUIRE_THROW(StepwiseEM<> em(1.5), std::invalid_argument);
+}
+
 /**
  * Test a training model on multiple Gaussians in higher dimensionality than
  * two.  We will hold the dataset size constant at 10k points.  The EM algorithm
@@ -798,6 +900,42 @@ BOOST_AUTO_TEST_CASE(UseExistingModelTest)
   }
 }
 
+/**
+ * Make sure the trials of GMM::Train(), which run in parallel, give the same
+ * model as the best of the same trials run one at a time.
+ */
+BOOST_AUTO_TEST_CASE(GMMParallelTrialsTest)
+{
+  arma::mat data;
+  data.randn(4, 1500);
+  data.cols(500, 999) += 5.0;
+  data.cols(1000, 1499) -= 5.0;
+
+  math::RandomSeed(12);
+  GMM gmm(3, 4);
+  const double likelihood = gmm.Train(data, 5);
+
+  math::RandomSeed(12);
+  double bestLikelihood = -DBL_MAX;
+  for (size_t trial = 0; trial < 5; ++trial)
+  {
+    GMM trialGmm(3, 4);
+    bestLikelihood = std::max(bestLikelihood, trialGmm.Train(data, 1));
+  }
+
+  BOOST_REQUIRE_CLOSE(likelihood, bestLikelihood, 1e-5);
+
+  // If trials may be abandoned, the model is still one of the trials, so it
+  // can't be better than the best of them.
+  math::RandomSeed(12);
+  EMFit<> fitter;
+  fitter.AbandonTrials() = true;
+  GMM abandonGmm(3, 4);
+  const double abandonLikelihood = abandonGmm.Train(data, 5, false, fitter);
+  BOOST_REQUIRE_LE(abandonLikelihood,
+      bestLikelihood + 1e-5 * std::abs(bestLikelihood));
+}
+
 /********************************************************/
 /** Diagonal Gaussian Mixture Model(DiagonalGMM) Tests **/
 /********************************************************/
@@ -831,6 +969,38 @@ BOOST_AUTO_TEST_CASE(DiagonalGMMProbabilityComponentTest)
   BOOST_REQUIRE_CLOSE(gmm.Probability("-4.1 2.1", 1), 8.60082772711e-05, 1e-5);
 }
 
+/**
+ * Make sure the batch DiagonalGMM::LogProbability() gives the same results as
+ * the single-observation version, in double and single precision.
+ */
+BOOST_AUTO_TEST_CASE(DiagonalGMMBatchLogProbabilityTest)
+{
+  DiagonalGMM gmm(3, 5);
+  for (size_t i = 0; i < gmm.Gaussians(); ++i)
+  {
+    gmm.Component(i).Mean() = 10.0 * arma::randu<arma::vec>(5);
+    gmm.Component(i).Covariance(arma::randu<arma::vec>(5) + 0.5);
+  }
+  gmm.Weights() = "0.3 0.5 0.2";
+
+  const arma::mat points = 10.0 * arma::randu<arma::mat>(5, 200);
+
+  arma::vec logProbs;
+  gmm.LogProbability(points, logProbs);
+
+  arma::fvec floatLogProbs;
+  gmm.LogProbability(arma::conv_to<arma::fmat>::from(points), floatLogProbs);
+
+  BOOST_REQUIRE_EQUAL(logProbs.n_elem, points.n_cols);
+  BOOST_REQUIRE_EQUAL(floatLogProbs.n_elem, points.n_cols);
+  for (size_t i = 0; i < points.n_cols; ++i)
+  {
+    const double logProb = gmm.LogProbability(points.col(i));
+    BOOST_REQUIRE_CLOSE(logProbs[i], logProb, 1e-5);
+    BOOST_REQUIRE_CLOSE(floatLogProbs[i], logProb, 1e-2);
+  }
+}
+
 /**
  * Make sure we can train a model on only one Gaussian (randomly generated)
  * in two dimensions.  We will vary the dataset size from small to large.
@@ -1127,6 +1297,44 @@ BOOST_AUTO_TEST_CASE(DiagonalGMMRandomTest)
       gmm2.Component(sortedIndices[1]).Covariance()(1), 22.0);
 }
 
+/**
+ * Train a DiagonalGMM incrementally with stepwise EM and make sure the number
+ * of batches is kept when the model is saved and loaded.
+ */
+BOOST_AUTO_TEST_CASE(DiagonalGMMStepwiseEMTest)
+{
+  arma::mat data;
+  data.randn(4, 6000);
+  for (size_t i = 1; i < data.n_cols; i += 2)
+    data.col(i) += 50.0;
+
+  DiagonalGMM gmm(2, 4);
+  for (size_t begin = 0; begin < data.n_cols; begin += 1000)
+    gmm.Update(data.cols(begin, begin + 999));
+
+  const size_t first = (arma::norm(gmm.Component(0).Mean()) <
+      arma::norm(gmm.Component(1).Mean())) ? 0 : 1;
+
+  for (size_t c = 0; c < 2; ++c)
+  {
+    const size_t component = (c == 0) ? first : 1 - first;
+    const arma::vec trueMean = arma::vec(4).fill(50.0 * c);
+
+    BOOST_REQUIRE_LT(arma::norm(gmm.Component(component).Mean() - trueMean),
+        0.2);
+    BOOST_REQUIRE_LT(arma::norm(gmm.Component(component).Covariance() -
+        arma::ones<arma::vec>(4)), 0.3);
+  }
+
+  DiagonalGMM xmlGmm, textGmm, binaryGmm;
+  SerializeObjectAll(gmm, xmlGmm, textGmm, binaryGmm);
+
+  BOOST_REQUIRE_EQUAL(gmm.Batches(), 6);
+  BOOST_REQUIRE_EQUAL(xmlGmm.Batches(), 6);
+  BOOST_REQUIRE_EQUAL(textGmm.Batches(), 6);
+  BOOST_REQUIRE_EQUAL(binaryGmm.Batches(), 6);
+}
+
 //! Make sure load and save DiagonalGMM correctly.
 BOOST_AUTO_TEST_CASE(DiagonalGMMLoadSaveTest)
 {
@@ -1181,4 +1389,40 @@ BOOST_AUTO_TEST_CASE(DiagonalGMMLoadSaveTest)
   }
 }
 
+/**
+ * With the default k-means, every trial of DiagonalGMM::Train() starts from its
+ * own initial clustering, so the model is the best of the single trials that
+ * start from the same initial models.
+ */
+BOOST_AUTO_TEST_CASE(DiagonalGMMTrialsTest)
+{
+  arma::mat data;
+  data.randn(4, 1500);
+  data.cols(500, 999) += 5.0;
+  data.cols(1000, 1499) -= 5.0;
+
+  math::RandomSeed(11);
+  DiagonalGMM gmm(3, 4);
+  const double likelihood = gmm.Train(data, 4);
+
+  // Draw the same initial models, in the same order, and fit each of them.
+  math::RandomSeed(11);
+  typedef distribution::DiagonalGaussianDistribution DistType;
+  EMFit<kmeans::KMeans<>, DiagonalConstraint, DistType> fitter;
+  std::vector<std::vector<DistType>> initialDists(4,
+      std::vector<DistType>(3, DistType(4)));
+  std::vector<arma::vec> initialWeights(4, arma::vec(3));
+  for (size_t trial = 0; trial < 4; ++trial)
+    fitter.InitialClustering(data, initialDists[trial], initialWeights[trial]);
+
+  double bestLikelihood = -DBL_MAX;
+  for (size_t trial = 0; trial < 4; ++trial)
+  {
+    DiagonalGMM singleGmm(initialDists[trial], initialWeights[trial]);
+    bestLikelihood = std::max(bestLikelihood, singleGmm.Train(data, 1, true));
+  }
+
+  BOOST_REQUIRE_CLOSE(likelihood, bestLikelihood, 1e-5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
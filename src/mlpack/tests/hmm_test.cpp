@@ -10,6 +10,7 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/hmm/hmm.hpp>
+#include <mlpack/methods/hmm/hmm_online_filter.hpp>
 #include <mlpack/methods/gmm/gmm.hpp>
 #include <mlpack/methods/gmm/diagonal_gmm.hpp>
 
@@ -1855,4 +1856,130 @@ BOOST_AUTO_TEST_CASE(DiagonalGMMHMMLoadSaveTest)
   }
 }
 
+/**
+ * Make sure that batched Viterbi decoding gives the same results as decoding
+ * each sequence, and that a beam never finds a more probable sequence than the
+ * exact search.
+ */
+BOOST_AUTO_TEST_CASE(BatchBeamViterbiTest)
+{
+  // 12 states, 6 emissions, random probabilities.
+  const size_t states = 12;
+  arma::vec initial = arma::randu<arma::vec>(states);
+  initial /= accu(initial);
+  arma::mat transition = arma::randu<arma::mat>(states, states);
+  for (size_t col = 0; col < states; col++)
+    transition.col(col) /= accu(transition.col(col));
+  std::vector<DiscreteDistribution> emission(states);
+  for (size_t i = 0; i < states; i++)
+  {
+    emission[i].Probabilities() = arma::randu<arma::vec>(6);
+    emission[i].Probabilities() /= accu(emission[i].Probabilities());
+  }
+  HMM<DiscreteDistribution> hmm(initial, transition, emission);
+
+  std::vector<arma::mat> sequences(30);
+  std::vector<arma::Row<size_t>> trueStates(30);
+  for (size_t i = 0; i < sequences.size(); i++)
+    hmm.Generate(100, sequences[i], trueStates[i], math::RandInt(states));
+
+  std::vector<arma::Row<size_t>> predictions;
+  const arma::vec logLikelihoods = hmm.Predict(sequences, predictions);
+  std::vector<arma::Row<size_t>> beamPredictions;
+  const arma::vec beamLogLikelihoods = hmm.Predict(sequences, beamPredictions,
+      3);
+
+  BOOST_REQUIRE_EQUAL(predictions.size(), sequences.size());
+  BOOST_REQUIRE_EQUAL(beamPredictions.size(), sequences.size());
+  for (size_t i = 0; i < sequences.size(); i++)
+  {
+    arma::Row<size_t> single;
+    const double logLikelihood = hmm.Predict(sequences[i], single);
+    BOOST_REQUIRE_CLOSE(logLikelihoods[i], logLikelihood, 1e-5);
+    BOOST_REQUIRE_EQUAL(predictions[i].n_elem, single.n_elem);
+    for (size_t t = 0; t < single.n_elem; t++)
+      BOOST_REQUIRE_EQUAL(predictions[i][t], single[t]);
+
+    // A beam as wide as the number of states is the exact search.
+    arma::Row<size_t> fullBeam;
+    BOOST_REQUIRE_CLOSE(hmm.Predict(sequences[i], fullBeam, states),
+        logLikelihood, 1e-5);
+
+    BOOST_REQUIRE_EQUAL(beamPredictions[i].n_elem, single.n_elem);
+    BOOST_REQUIRE_LE(beamLogLikelihoods[i], logLikelihood + 1e-10);
+  }
+}
+
+/**
+ * Make sure that the online filter gives the same log-likelihoods and filtered
+ * emissions as the whole-sequence functions.
+ */
+BOOST_AUTO_TEST_CASE(GaussianHMMOnlineFilterTest)
+{
+  GaussianDistribution g1("5.0 5.0", "1.0 0.0; 0.0 1.0");
+  GaussianDistribution g2("-5.0 -5.0", "1.0 0.0; 0.0 1.0");
+  GaussianDistribution g3("5.0 -5.0", "2.0 0.5; 0.5 1.0");
+
+  arma::vec initial("0.5 0.3 0.2");
+  arma::mat transition("0.7 0.2 0.2; 0.2 0.6 0.3; 0.1 0.2 0.5");
+
+  std::vector<GaussianDistribution> emission;
+  emission.push_back(g1);
+  emission.push_back(g2);
+  emission.push_back(g3);
+
+  HMM<GaussianDistribution> hmm(initial, transition, emission);
+
+  arma::mat observations;
+  arma::Row<size_t> states;
+  hmm.Generate(200, observations, states);
+
+  arma::mat filterSeq;
+  hmm.Filter(observations, filterSeq);
+
+  HMMOnlineFilter<HMM<GaussianDistribution>> filter(hmm);
+  for (size_t t = 0; t < observations.n_cols; t++)
+  {
+    filter.Update(observations.col(t));
+    BOOST_REQUIRE_EQUAL(filter.NumObservations(), t + 1);
+
+    arma::vec expected;
+    filter.ExpectedEmission(expected);
+    for (size_t d = 0; d < 2; d++)
+      BOOST_REQUIRE_SMALL(expected[d] - filterSeq(d, t), 1e-5);
+
+    // Looking ahead propagates the state probabilities through the
+    // transition matrix.
+    arma::vec ahead;
+    filter.PredictStates(ahead, 2);
+    const arma::vec expectedAhead = transition * transition *
+        filter.StateProbabilities();
+    for (size_t i = 0; i < 3; i++)
+      BOOST_REQUIRE_SMALL(ahead[i] - expectedAhead[i], 1e-10);
+
+    if (t % 50 == 49)
+    {
+      BOOST_REQUIRE_CLOSE(filter.LogLikelihood(),
+          hmm.LogLikelihood(observations.cols(0, t)), 1e-5);
+    }
+  }
+
+  // Feeding the whole sequence at once must give the same state.
+  HMMOnlineFilter<HMM<GaussianDistribution>> batchFilter(hmm);
+  batchFilter.UpdateBatch(observations);
+  BOOST_REQUIRE_CLOSE(batchFilter.LogLikelihood(), filter.LogLikelihood(),
+      1e-5);
+  for (size_t i = 0; i < 3; i++)
+  {
+    BOOST_REQUIRE_SMALL(batchFilter.StateProbabilities()[i] -
+        filter.StateProbabilities()[i], 1e-8);
+  }
+
+  // After a reset, the filter starts a new sequence.
+  filter.Reset();
+  filter.Update(observations.col(0));
+  BOOST_REQUIRE_CLOSE(filter.LogLikelihood(),
+      hmm.LogLikelihood(observations.cols(0, 0)), 1e-5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -15,6 +15,7 @@
 #include <mlpack/methods/hoeffding_trees/hoeffding_tree.hpp>
 #include <mlpack/methods/hoeffding_trees/hoeffding_categorical_split.hpp>
 #include <mlpack/methods/hoeffding_trees/binary_numeric_split.hpp>
+#include <mlpack/methods/hoeffding_trees/quantile_numeric_split.hpp>
 #include <mlpack/methods/hoeffding_trees/hoeffding_tree_model.hpp>
 
 #include <boost/test/unit_test.hpp>
@@ -798,6 +799,110 @@ BOOST_AUTO_TEST_CASE(BinaryNumericSplitSimpleFourClassSplitTest)
   BOOST_REQUIRE_EQUAL(childMajorities.n_elem, 2);
 }
 
+/**
+ * Create a QuantileNumericSplit object, feed it samples where anything less
+ * than 1.0 is class 0 and anything greater is class 1, and make sure it can
+ * still perform a perfect split after the sketch has been compacted.
+ */
+BOOST_AUTO_TEST_CASE(QuantileNumericSplitSimpleSplitTest)
+{
+  QuantileNumericSplit<GiniImpurity> split(2, 50); // 2 classes.
+
+  // Feed it samples.
+  for (size_t i = 0; i < 500; ++i)
+  {
+    split.Train(mlpack::math::Random(), 0);
+    split.Train(mlpack::math::Random() + 1.0, 1);
+
+    double bestGain, secondBestGain;
+    split.EvaluateFitnessFunction(bestGain, secondBestGain);
+    BOOST_REQUIRE_CLOSE(bestGain, 0.5, 1e-5);
+    BOOST_REQUIRE_GT(bestGain, secondBestGain);
+  }
+
+  // The sketch should not have kept every point.
+  BOOST_REQUIRE_LT(split.NumRetained(), 1000);
+
+  arma::Col<size_t> childMajorities;
+  BinaryNumericSplitInfo<> splitInfo;
+  split.Split(childMajorities, splitInfo);
+
+  BOOST_REQUIRE_EQUAL(childMajorities[0], 0);
+  BOOST_REQUIRE_EQUAL(childMajorities[1], 1);
+  BOOST_REQUIRE_EQUAL(splitInfo.CalculateDirection(0.5), 0);
+  BOOST_REQUIRE_EQUAL(splitInfo.CalculateDirection(1.5), 1);
+  BOOST_REQUIRE_EQUAL(splitInfo.CalculateDirection(-1.0), 0);
+  BOOST_REQUIRE_EQUAL(splitInfo.CalculateDirection(0.9), 0);
+  BOOST_REQUIRE_EQUAL(splitInfo.CalculateDirection(1.1), 1);
+}
+
+/**
+ * Make sure that the memory used by the QuantileNumericSplit stays bounded on a
+ * long stream, and that the split it finds stays close to the true boundary.
+ */
+BOOST_AUTO_TEST_CASE(QuantileNumericSplitBoundedMemoryTest)
+{
+  QuantileNumericSplit<GiniImpurity> split(2); // 2 classes.
+
+  for (size_t i = 0; i < 100000; ++i)
+  {
+    const double value = mlpack::math::Random();
+    split.Train(value, (value < 0.3) ? 0 : 1);
+  }
+
+  // The capacities of the compactors add up to a bit over three times the
+  // sketch size.
+  BOOST_REQUIRE_LT(split.NumRetained(), 4 * split.SketchSize());
+  BOOST_REQUIRE_CLOSE(split.MajorityProbability(), 0.7, 2.0);
+
+  arma::Col<size_t> childMajorities;
+  BinaryNumericSplitInfo<> splitInfo;
+  split.Split(childMajorities, splitInfo);
+
+  BOOST_REQUIRE_EQUAL(childMajorities[0], 0);
+  BOOST_REQUIRE_EQUAL(childMajorities[1], 1);
+  BOOST_REQUIRE_EQUAL(splitInfo.CalculateDirection(0.27), 0);
+  BOOST_REQUIRE_EQUAL(splitInfo.CalculateDirection(0.33), 1);
+}
+
+/**
+ * Train two QuantileNumericSplits on different parts of a stream, merge them,
+ * and make sure the result describes the whole stream.
+ */
+BOOST_AUTO_TEST_CASE(QuantileNumericSplitMergeTest)
+{
+  QuantileNumericSplit<GiniImpurity> first(2, 50);
+  QuantileNumericSplit<GiniImpurity> second(2, first);
+
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    first.Train(mlpack::math::Random(), 0);
+    second.Train(mlpack::math::Random() + 1.0, 1);
+  }
+
+  BOOST_REQUIRE_EQUAL(second.SketchSize(), 50);
+  first.Merge(second);
+
+  double bestGain, secondBestGain;
+  first.EvaluateFitnessFunction(bestGain, secondBestGain);
+  BOOST_REQUIRE_CLOSE(bestGain, 0.5, 1e-5);
+  BOOST_REQUIRE_CLOSE(first.MajorityProbability(), 0.5, 1e-5);
+  BOOST_REQUIRE_LT(first.NumRetained(), 4 * first.SketchSize());
+
+  arma::Col<size_t> childMajorities;
+  BinaryNumericSplitInfo<> splitInfo;
+  first.Split(childMajorities, splitInfo);
+
+  BOOST_REQUIRE_EQUAL(childMajorities[0], 0);
+  BOOST_REQUIRE_EQUAL(childMajorities[1], 1);
+  BOOST_REQUIRE_EQUAL(splitInfo.CalculateDirection(0.9), 0);
+  BOOST_REQUIRE_EQUAL(splitInfo.CalculateDirection(1.1), 1);
+
+  // Splits with different numbers of classes can't be merged.
+  QuantileNumericSplit<GiniImpurity> other(3);
+  BOOST_REQUIRE_THROW(first.Merge(other), std::invalid_argument);
+}
+
 /**
  * Create a HoeffdingTree that uses the HoeffdingNumericSplit and make sure it
  * can split meaningfully on the correct dimension.
@@ -932,6 +1037,152 @@ BOOST_AUTO_TEST_CASE(BinaryNumericHoeffdingTreeTest)
   BOOST_REQUIRE_GT(batchCorrect, 8550);
 }
 
+/**
+ * Make sure that flattened trees, with numeric, binary numeric and categorical
+ * splits, classify exactly like the trees they were made from.
+ */
+BOOST_AUTO_TEST_CASE(FlatHoeffdingTreeTest)
+{
+  // The label depends on both the categorical and the numeric features.
+  arma::mat dataset(3, 6000);
+  arma::Row<size_t> labels(6000);
+  data::DatasetInfo info(3); // The first feature is categorical.
+  info.MapString<size_t>("0", 0);
+  info.MapString<size_t>("1", 0);
+  info.MapString<size_t>("2", 0);
+  for (size_t i = 0; i < 6000; ++i)
+  {
+    dataset(0, i) = math::RandInt(3);
+    dataset(1, i) = math::Random();
+    dataset(2, i) = math::Random();
+    labels[i] = (dataset(0, i) == 2) ? 2 : ((dataset(1, i) < 0.5) ? 0 : 1);
+  }
+
+  HoeffdingTree<> tree(dataset, info, labels, 3, false);
+  HoeffdingTree<GiniImpurity, BinaryDoubleNumericSplit> binaryTree(dataset,
+      info, labels, 3, false);
+  BOOST_REQUIRE_GT(tree.NumChildren(), 0);
+  BOOST_REQUIRE_GT(binaryTree.NumChildren(), 0);
+
+  FlatHoeffdingTree flatTree = tree.Flatten();
+  FlatHoeffdingTree flatBinaryTree = binaryTree.Flatten();
+  BOOST_REQUIRE_EQUAL(flatTree.NumNodes(), tree.NumDescendants() + 1);
+  BOOST_REQUIRE_EQUAL(flatBinaryTree.NumNodes(),
+      binaryTree.NumDescendants() + 1);
+
+  arma::Row<size_t> predictions, flatPredictions;
+  arma::rowvec probabilities, flatProbabilities;
+  tree.Classify(dataset, predictions, probabilities);
+  flatTree.Classify(dataset, flatPredictions, flatProbabilities);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(predictions[i], flatPredictions[i]);
+    BOOST_REQUIRE_EQUAL(probabilities[i], flatProbabilities[i]);
+  }
+
+  binaryTree.Classify(dataset, predictions);
+  flatBinaryTree.Classify(dataset, flatPredictions);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(predictions[i], flatPredictions[i]);
+}
+
+/**
+ * Make sure that a tree trained in parallel on the same data as in the previous
+ * test splits on the same dimension and is just as accurate.
+ */
+BOOST_AUTO_TEST_CASE(ParallelTrainHoeffdingTreeTest)
+{
+  // Generate data.
+  arma::mat dataset(4, 9000);
+  arma::Row<size_t> labels(9000);
+  data::DatasetInfo info(4); // All features are numeric, except the fourth.
+  info.MapString<double>("0", 3);
+  for (size_t i = 0; i < 9000; i += 3)
+  {
+    dataset(0, i) = mlpack::math::Random();
+    dataset(1, i) = mlpack::math::Random();
+    dataset(2, i) = mlpack::math::Random();
+    dataset(3, i) = 0.0;
+    labels[i] = 0;
+
+    dataset(0, i + 1) = mlpack::math::Random();
+    dataset(1, i + 1) = mlpack::math::Random() - 1.0;
+    dataset(2, i + 1) = mlpack::math::Random() + 0.5;
+    dataset(3, i + 1) = 0.0;
+    labels[i + 1] = 2;
+
+    dataset(0, i + 2) = mlpack::math::Random();
+    dataset(1, i + 2) = mlpack::math::Random() + 1.0;
+    dataset(2, i + 2) = mlpack::math::Random() + 0.8;
+    dataset(3, i + 2) = 0.0;
+    labels[i + 2] = 1;
+  }
+
+  typedef HoeffdingTree<GiniImpurity, BinaryDoubleNumericSplit> TreeType;
+  TreeType tree(info, 3);
+  tree.ParallelTrain(dataset, labels);
+
+  BOOST_REQUIRE_GT(tree.NumChildren(), 0);
+  BOOST_REQUIRE_EQUAL(tree.SplitDimension(), 1);
+
+  arma::Row<size_t> predictions;
+  tree.Classify(dataset, predictions);
+
+  size_t correct = 0;
+  for (size_t i = 0; i < 9000; ++i)
+    if (labels[i] == predictions[i])
+      ++correct;
+
+  // Require a pretty high accuracy: 95%.
+  BOOST_REQUIRE_GT(correct, 8550);
+}
+
+/**
+ * Build a streaming HoeffdingTree with the QuantileNumericSplit and make sure
+ * it splits on the right dimension and is accurate.
+ */
+BOOST_AUTO_TEST_CASE(QuantileNumericHoeffdingTreeTest)
+{
+  // Generate data.
+  arma::mat dataset(3, 9000);
+  arma::Row<size_t> labels(9000);
+  data::DatasetInfo info(3); // All features are numeric.
+  for (size_t i = 0; i < 9000; i += 3)
+  {
+    dataset(0, i) = mlpack::math::Random();
+    dataset(1, i) = mlpack::math::Random();
+    dataset(2, i) = mlpack::math::Random();
+    labels[i] = 0;
+
+    dataset(0, i + 1) = mlpack::math::Random();
+    dataset(1, i + 1) = mlpack::math::Random() - 1.0;
+    dataset(2, i + 1) = mlpack::math::Random() + 0.5;
+    labels[i + 1] = 2;
+
+    dataset(0, i + 2) = mlpack::math::Random();
+    dataset(1, i + 2) = mlpack::math::Random() + 1.0;
+    dataset(2, i + 2) = mlpack::math::Random() + 0.8;
+    labels[i + 2] = 1;
+  }
+
+  typedef HoeffdingTree<GiniImpurity, QuantileDoubleNumericSplit> TreeType;
+  TreeType tree(dataset, info, labels, 3, false);
+
+  BOOST_REQUIRE_GT(tree.NumChildren(), 0);
+  BOOST_REQUIRE_EQUAL(tree.SplitDimension(), 1);
+
+  arma::Row<size_t> predictions;
+  tree.Classify(dataset, predictions);
+
+  size_t correct = 0;
+  for (size_t i = 0; i < 9000; ++i)
+    if (labels[i] == predictions[i])
+      ++correct;
+
+  // Require a pretty high accuracy: 95%.
+  BOOST_REQUIRE_GT(correct, 8550);
+}
+
 /**
  * Test majority probabilities.
  */
@@ -326,6 +326,121 @@ BOOST_AUTO_TEST_CASE(HPTTest)
   BOOST_REQUIRE_CLOSE(expectedObjective, objective, 1e-5);
 }
 
+/**
+ * Test HyperParameterTuner cross-validates the grid points in parallel with the
+ * same result.
+ */
+BOOST_AUTO_TEST_CASE(HPTParallelGridSearchTest)
+{
+  arma::mat xs;
+  arma::rowvec ys;
+  double validationSize;
+  InitProneToOverfittingData(xs, ys, validationSize);
+
+  bool transposeData = true;
+  bool useCholesky = false;
+  arma::vec lambda1Set("0 0.001 0.01 0.1 1.0 10.0 100.0");
+  arma::vec lambda2Set("0.0 0.05 0.5 5.0");
+
+  double expectedLambda1, expectedLambda2, expectedObjective;
+  FindLARSBestLambdas(xs, ys, validationSize, transposeData, useCholesky,
+      lambda1Set, lambda2Set, expectedLambda1, expectedLambda2,
+      expectedObjective);
+
+  for (const size_t numThreads : { 0, 2, 3 })
+  {
+    double actualLambda1, actualLambda2;
+    HyperParameterTuner<LARS, MSE, SimpleCV, GridSearch>
+        hpt(validationSize, xs, ys);
+    hpt.NumThreads() = numThreads;
+    std::tie(actualLambda1, actualLambda2) = hpt.Optimize(
+        Fixed(transposeData), Fixed(useCholesky), lambda1Set, lambda2Set);
+
+    BOOST_REQUIRE_CLOSE(expectedObjective, hpt.BestObjective(), 1e-5);
+    BOOST_REQUIRE_CLOSE(expectedLambda1, actualLambda1, 1e-5);
+    BOOST_REQUIRE_CLOSE(expectedLambda2, actualLambda2, 1e-5);
+
+    size_t validationFirstColumn = round(xs.n_cols * (1.0 - validationSize));
+    arma::mat validationXs = xs.cols(validationFirstColumn, xs.n_cols - 1);
+    arma::rowvec validationYs = ys.cols(validationFirstColumn, ys.n_cols - 1);
+    double objective = MSE::Evaluate(hpt.BestModel(), validationXs,
+        validationYs);
+    BOOST_REQUIRE_CLOSE(expectedObjective, objective, 1e-5);
+  }
+}
+
+/**
+ * Test HyperParameterTuner with successive halving: the result must be one of
+ * the grid points, cross-validated on all of the data, and a clearly best
+ * point must be found.
+ */
+BOOST_AUTO_TEST_CASE(HPTSuccessiveHalvingTest)
+{
+  // The same kind of data as InitProneToOverfittingData(), with enough points
+  // for the smallest subsets.
+  arma::rowvec data = arma::linspace<arma::rowvec>(0.0, 10.0, 400);
+  arma::mat xs = data;
+  for (size_t i = 2; i <= 5; ++i)
+    xs = arma::join_cols(xs, arma::pow(data, i));
+  arma::rowvec ys = 2 * data + 0.05 * arma::randn(1, 400);
+  double validationSize = 0.3;
+
+  bool transposeData = true;
+  bool useCholesky = false;
+  arma::vec lambda1Set("0 0.001 0.01 0.1 1.0 10.0 100.0");
+  arma::vec lambda2Set("0.0 0.05 0.5 5.0");
+
+  double expectedLambda1, expectedLambda2, expectedObjective;
+  FindLARSBestLambdas(xs, ys, validationSize, transposeData, useCholesky,
+      lambda1Set, lambda2Set, expectedLambda1, expectedLambda2,
+      expectedObjective);
+
+  SimpleCV<LARS, MSE> cv(validationSize, xs, ys);
+  for (const size_t halvingFactor : { 2, 3 })
+  {
+    for (const size_t numThreads : { 1, 3 })
+    {
+      double actualLambda1, actualLambda2;
+      HyperParameterTuner<LARS, MSE, SimpleCV, GridSearch>
+          hpt(validationSize, xs, ys);
+      hpt.HalvingFactor() = halvingFactor;
+      hpt.NumThreads() = numThreads;
+      std::tie(actualLambda1, actualLambda2) = hpt.Optimize(
+          Fixed(transposeData), Fixed(useCholesky), lambda1Set, lambda2Set);
+
+      BOOST_REQUIRE(arma::any(lambda1Set == actualLambda1));
+      BOOST_REQUIRE(arma::any(lambda2Set == actualLambda2));
+      BOOST_REQUIRE_CLOSE(hpt.BestObjective(), cv.Evaluate(transposeData,
+          useCholesky, actualLambda1, actualLambda2), 1e-5);
+      BOOST_REQUIRE_GE(hpt.BestObjective() * (1 + 1e-7), expectedObjective);
+
+      size_t validationFirstColumn = round(xs.n_cols * (1.0 - validationSize));
+      arma::mat validationXs = xs.cols(validationFirstColumn, xs.n_cols - 1);
+      arma::rowvec validationYs = ys.cols(validationFirstColumn,
+          ys.n_cols - 1);
+      BOOST_REQUIRE_CLOSE(hpt.BestObjective(), MSE::Evaluate(hpt.BestModel(),
+          validationXs, validationYs), 1e-5);
+    }
+  }
+
+  // On linearly separable data, no regularization is best on any subset.  As
+  // in HPTMaximizationTest, the data is doubled so that the model is validated
+  // on the points it was trained on.
+  arma::mat separableXs = arma::linspace<arma::rowvec>(0.0, 10.0, 50);
+  arma::Row<size_t> separableYs = arma::join_rows(
+      arma::zeros<arma::Row<size_t>>(25), arma::ones<arma::Row<size_t>>(25));
+  arma::mat doubledXs = arma::join_rows(separableXs, separableXs);
+  arma::Row<size_t> doubledYs = arma::join_rows(separableYs, separableYs);
+  arma::vec lambdas("1e12 0 1e10 1e11");
+
+  HyperParameterTuner<LogisticRegression<>, Accuracy, SimpleCV>
+      hpt(0.5, doubledXs, doubledYs);
+  hpt.HalvingFactor() = 2;
+  double actualLambda;
+  std::tie(actualLambda) = hpt.Optimize(lambdas);
+  BOOST_REQUIRE_SMALL(actualLambda, 1e-5);
+}
+
 /**
  * Test HyperParamterTuner maximizes Accuracy rather than minimizes it.
  */
@@ -267,6 +267,59 @@ BOOST_AUTO_TEST_CASE(ListwiseDeletionTest)
   BOOST_REQUIRE_CLOSE(rowWiseInput(1, 3), 8.0, 1e-5);
 }
 
+/**
+ * Imputing several dimensions at once gives the same result as imputing them
+ * one by one.
+ */
+BOOST_AUTO_TEST_CASE(MultipleDimensionImputationTest)
+{
+  arma::mat input = arma::randu<arma::mat>(6, 500);
+  input.elem(arma::find(input < 0.2)).zeros();
+  input(5, 3) = arma::datum::nan;
+  const std::vector<size_t> dimensions = { 0, 2, 3, 5 };
+  const std::vector<double> mappedValues(dimensions.size(), 0.0);
+
+  for (const bool columnMajor : { true, false })
+  {
+    arma::mat data = columnMajor ? input : arma::mat(input.t());
+
+    arma::mat meanInput(data), meanBatch(data);
+    MeanImputation<double> mean;
+    for (const size_t d : dimensions)
+      mean.Impute(meanInput, 0.0, d, columnMajor);
+    mean.Impute(meanBatch, mappedValues, dimensions, columnMajor);
+    CheckMatrices(meanInput, meanBatch);
+
+    arma::mat medianInput(data), medianBatch(data);
+    MedianImputation<double> median;
+    for (const size_t d : dimensions)
+      median.Impute(medianInput, 0.0, d, columnMajor);
+    median.Impute(medianBatch, mappedValues, dimensions, columnMajor);
+    CheckMatrices(medianInput, medianBatch);
+
+    arma::mat listwiseInput(data), listwiseBatch(data);
+    ListwiseDeletion<double> listwise;
+    for (const size_t d : dimensions)
+      listwise.Impute(listwiseInput, 0.0, d, columnMajor);
+    listwise.Impute(listwiseBatch, mappedValues, dimensions, columnMajor);
+    CheckMatrices(listwiseInput, listwiseBatch);
+  }
+}
+
+/**
+ * The median of an even number of elements is the mean of the two middle ones.
+ */
+BOOST_AUTO_TEST_CASE(MedianImputationEvenTest)
+{
+  arma::mat input("4.0 1.0 0.0 9.0 3.0 0.0 7.0 2.0");
+  MedianImputation<double> imputer;
+  imputer.Impute(input, 0.0, 0, true);
+
+  BOOST_REQUIRE_CLOSE(input(0, 2), 3.5, 1e-5);
+  BOOST_REQUIRE_CLOSE(input(0, 5), 3.5, 1e-5);
+  BOOST_REQUIRE_CLOSE(input(0, 6), 7.0, 1e-5);
+}
+
 /**
  * Make sure we can map non-strings.
  */
@@ -818,4 +818,92 @@ BOOST_AUTO_TEST_CASE(NotTrained)
   BOOST_REQUIRE_THROW(kde.Evaluate(estimations), std::runtime_error);
 }
 
+/**
+ * Test that multi-bandwidth evaluation gives the brute force result for each
+ * bandwidth, in both modes.
+ */
+BOOST_AUTO_TEST_CASE(MultiBandwidthKDETest)
+{
+  arma::mat reference = arma::randu(2, 300);
+  arma::mat query = arma::randu(2, 80);
+  const arma::vec bandwidths = { 0.05, 0.2, 0.8 };
+  const double relError = 0.01;
+
+  KDE<GaussianKernel, EuclideanDistance, arma::mat, KDTree>
+      kde(relError, 0.0);
+  kde.Train(reference);
+
+  arma::mat dualEstimations, singleEstimations;
+  kde.Evaluate(query, bandwidths, dualEstimations);
+  kde.Mode() = KDEMode::SINGLE_TREE_MODE;
+  kde.Evaluate(query, bandwidths, singleEstimations);
+
+  BOOST_REQUIRE_EQUAL(dualEstimations.n_rows, bandwidths.n_elem);
+  BOOST_REQUIRE_EQUAL(dualEstimations.n_cols, query.n_cols);
+  BOOST_REQUIRE_EQUAL(singleEstimations.n_rows, bandwidths.n_elem);
+  BOOST_REQUIRE_EQUAL(singleEstimations.n_cols, query.n_cols);
+
+  for (size_t b = 0; b < bandwidths.n_elem; ++b)
+  {
+    GaussianKernel kernel(bandwidths[b]);
+    arma::vec bfEstimations(query.n_cols, arma::fill::zeros);
+    BruteForceKDE<GaussianKernel>(reference, query, bfEstimations, kernel);
+
+    for (size_t i = 0; i < query.n_cols; ++i)
+    {
+      BOOST_REQUIRE_CLOSE(bfEstimations[i], dualEstimations(b, i),
+          relError * 100);
+      BOOST_REQUIRE_CLOSE(bfEstimations[i], singleEstimations(b, i),
+          relError * 100);
+    }
+  }
+
+  // The monochromatic evaluation must match the single-bandwidth one.
+  kde.Mode() = KDEMode::DUAL_TREE_MODE;
+  arma::mat looEstimations;
+  kde.Evaluate(bandwidths, looEstimations);
+  for (size_t b = 0; b < bandwidths.n_elem; ++b)
+  {
+    KDE<GaussianKernel, EuclideanDistance, arma::mat, KDTree>
+        singleKDE(relError, 0.0, GaussianKernel(bandwidths[b]));
+    singleKDE.Train(reference);
+    arma::vec estimations;
+    singleKDE.Evaluate(estimations);
+
+    for (size_t i = 0; i < reference.n_cols; ++i)
+      BOOST_REQUIRE_CLOSE(estimations[i], looEstimations(b, i),
+          2 * relError * 100);
+  }
+}
+
+/**
+ * Test that Monte Carlo estimation stays close to the brute force result.
+ */
+BOOST_AUTO_TEST_CASE(MonteCarloKDETest)
+{
+  arma::mat reference = arma::randu(2, 3000);
+  arma::mat query = arma::randu(2, 100);
+  arma::vec bfEstimations(query.n_cols, arma::fill::zeros);
+  const double relError = 0.05;
+
+  GaussianKernel kernel(0.5);
+  BruteForceKDE<GaussianKernel>(reference, query, bfEstimations, kernel);
+
+  KDE<GaussianKernel, EuclideanDistance, arma::mat, KDTree>
+      kde(relError, 0.0, kernel);
+  kde.MonteCarlo() = true;
+  kde.MCProb(0.95);
+  kde.Train(reference);
+
+  arma::vec estimations;
+  kde.Evaluate(query, estimations);
+
+  // The bound only holds with probability 0.95, so use a loose tolerance.
+  for (size_t i = 0; i < query.n_cols; ++i)
+    BOOST_REQUIRE_CLOSE(bfEstimations[i], estimations[i], 3 * relError * 100);
+
+  BOOST_REQUIRE_THROW(kde.MCProb(1.0), std::invalid_argument);
+  BOOST_REQUIRE_THROW(kde.MCBreakCoefficient(0.0), std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
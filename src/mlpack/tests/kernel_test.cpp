@@ -20,6 +20,8 @@
 #include <mlpack/core/kernels/spherical_kernel.hpp>
 #include <mlpack/core/kernels/pspectrum_string_kernel.hpp>
 #include <mlpack/core/kernels/cauchy_kernel.hpp>
+#include <mlpack/core/kernels/triangular_kernel.hpp>
+#include <mlpack/core/kernels/kernel_matrix.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/metrics/mahalanobis_distance.hpp>
 
@@ -209,6 +211,39 @@ BOOST_AUTO_TEST_CASE(MDFullCovarianceTest)
   BOOST_REQUIRE_CLOSE(md.Evaluate(b, a), 15.7, 1e-5);
 }
 
+/**
+ * Make sure that the Euclidean distances between whitened points are the
+ * Mahalanobis distances between the original points, for a positive definite
+ * and for a low-rank covariance matrix.
+ */
+BOOST_AUTO_TEST_CASE(MDWhiteningTest)
+{
+  arma::mat points(6, 20, arma::fill::randu);
+
+  arma::mat l(6, 6, arma::fill::randu);
+  arma::mat lowRank(3, 6, arma::fill::randu);
+  std::vector<arma::mat> covariances = { trans(l) * l + 0.1 *
+      arma::eye<arma::mat>(6, 6), trans(lowRank) * lowRank };
+
+  for (size_t c = 0; c < covariances.size(); ++c)
+  {
+    MahalanobisDistance<false> md(covariances[c]);
+    arma::mat whitened(points);
+    md.Whiten(whitened);
+    BOOST_REQUIRE_LE(whitened.n_rows, points.n_rows);
+
+    for (size_t i = 0; i < points.n_cols; ++i)
+    {
+      for (size_t j = i + 1; j < points.n_cols; ++j)
+      {
+        BOOST_REQUIRE_CLOSE(md.Evaluate(points.col(i), points.col(j)),
+            SquaredEuclideanDistance::Evaluate(whitened.col(i),
+            whitened.col(j)), 1e-5);
+      }
+    }
+  }
+}
+
 /**
  * Simple test case for the cosine distance.
  */
@@ -622,4 +657,142 @@ BOOST_AUTO_TEST_CASE(CauchyKernelTest)
   BOOST_REQUIRE_CLOSE(ck.Evaluate(b, a), 0.92592588, 1e-5);
 }
 
+/**
+ * Check that KernelMatrix() gives the same kernel matrices as evaluating the
+ * kernel on each pair of points, for both the square and rectangular forms.
+ */
+template<typename KernelType>
+void CheckKernelMatrix(KernelType& kernel)
+{
+  // The sizes are not multiples of the block size.
+  arma::mat a(5, 150, arma::fill::randu);
+  arma::mat b(5, 70, arma::fill::randu);
+
+  arma::mat square, rectangular;
+  KernelMatrix(a, square, kernel);
+  KernelMatrix(a, b, rectangular, kernel);
+
+  BOOST_REQUIRE_EQUAL(square.n_rows, 150);
+  BOOST_REQUIRE_EQUAL(square.n_cols, 150);
+  BOOST_REQUIRE_EQUAL(rectangular.n_rows, 150);
+  BOOST_REQUIRE_EQUAL(rectangular.n_cols, 70);
+
+  for (size_t j = 0; j < a.n_cols; ++j)
+  {
+    for (size_t i = 0; i < a.n_cols; ++i)
+    {
+      const double expected = kernel.Evaluate(a.col(i), a.col(j));
+      if (std::abs(expected) < 1e-10)
+        BOOST_REQUIRE_SMALL(square(i, j), 1e-10);
+      else
+        BOOST_REQUIRE_CLOSE(square(i, j), expected, 1e-6);
+    }
+  }
+
+  for (size_t j = 0; j < b.n_cols; ++j)
+  {
+    for (size_t i = 0; i < a.n_cols; ++i)
+    {
+      const double expected = kernel.Evaluate(a.col(i), b.col(j));
+      if (std::abs(expected) < 1e-10)
+        BOOST_REQUIRE_SMALL(rectangular(i, j), 1e-10);
+      else
+        BOOST_REQUIRE_CLOSE(rectangular(i, j), expected, 1e-6);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(KernelMatrixTest)
+{
+  LinearKernel linear;
+  CheckKernelMatrix(linear);
+  PolynomialKernel polynomial(3.0, 0.5);
+  CheckKernelMatrix(polynomial);
+  GaussianKernel gaussian(0.7);
+  CheckKernelMatrix(gaussian);
+  LaplacianKernel laplacian(0.7);
+  CheckKernelMatrix(laplacian);
+
+  // Kernels without a specialization are evaluated with BatchEvaluate(), if
+  // they have it, or pair by pair.
+  CauchyKernel cauchy(0.7);
+  CheckKernelMatrix(cauchy);
+  EpanechnikovKernel epanechnikov(1.2);
+  CheckKernelMatrix(epanechnikov);
+  TriangularKernel triangular(1.5);
+  CheckKernelMatrix(triangular);
+  SphericalKernel spherical(0.8);
+  CheckKernelMatrix(spherical);
+  HyperbolicTangentKernel tangent(0.5, 1.0);
+  CheckKernelMatrix(tangent);
+}
+
+/**
+ * Make sure that BatchEvaluate() gives the same results as evaluating the
+ * kernel on each distance, also when the input and output are the same.
+ */
+template<typename KernelType>
+void CheckBatchEvaluate(const KernelType& kernel)
+{
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<KernelType>::HasBatchEvaluate,
+      true);
+
+  arma::vec distances = 3.0 * arma::randu<arma::vec>(100);
+  distances[0] = 0.0;
+
+  arma::vec values;
+  kernel.BatchEvaluate(distances, values);
+  BOOST_REQUIRE_EQUAL(values.n_elem, distances.n_elem);
+
+  arma::vec inPlace(distances);
+  kernel.BatchEvaluate(inPlace, inPlace);
+
+  for (size_t i = 0; i < distances.n_elem; ++i)
+  {
+    const double expected = kernel.Evaluate(distances[i]);
+    if (std::abs(expected) < 1e-10)
+    {
+      BOOST_REQUIRE_SMALL(values[i], 1e-10);
+      BOOST_REQUIRE_SMALL(inPlace[i], 1e-10);
+    }
+    else
+    {
+      BOOST_REQUIRE_CLOSE(values[i], expected, 1e-8);
+      BOOST_REQUIRE_CLOSE(inPlace[i], expected, 1e-8);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(BatchEvaluateTest)
+{
+  CheckBatchEvaluate(GaussianKernel(0.7));
+  CheckBatchEvaluate(LaplacianKernel(0.7));
+  CheckBatchEvaluate(CauchyKernel(0.7));
+  CheckBatchEvaluate(EpanechnikovKernel(1.2));
+  CheckBatchEvaluate(TriangularKernel(1.5));
+  CheckBatchEvaluate(SphericalKernel(0.8));
+
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<LinearKernel>::HasBatchEvaluate,
+      false);
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<CosineDistance>::HasBatchEvaluate,
+      false);
+}
+
+/**
+ * The triangular kernel should give the same result from the distance as from
+ * the two points.
+ */
+BOOST_AUTO_TEST_CASE(TriangularKernelDistanceTest)
+{
+  TriangularKernel triangular(2.0);
+  arma::vec a("0.0 0.0");
+  arma::vec b("1.0 0.0");
+  arma::vec c("3.0 0.0");
+
+  BOOST_REQUIRE_CLOSE(triangular.Evaluate(a, b), 0.5, 1e-8);
+  BOOST_REQUIRE_CLOSE(triangular.Evaluate(1.0), 0.5, 1e-8);
+  BOOST_REQUIRE_SMALL(triangular.Evaluate(a, c), 1e-10);
+  BOOST_REQUIRE_SMALL(triangular.Evaluate(3.0), 1e-10);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -14,10 +14,16 @@
 #include <mlpack/methods/kmeans/refined_start.hpp>
 #include <mlpack/methods/kmeans/elkan_kmeans.hpp>
 #include <mlpack/methods/kmeans/hamerly_kmeans.hpp>
+#include <mlpack/methods/kmeans/yinyang_kmeans.hpp>
 #include <mlpack/methods/kmeans/pelleg_moore_kmeans.hpp>
 #include <mlpack/methods/kmeans/dual_tree_kmeans.hpp>
+#include <mlpack/methods/kmeans/mini_batch_kmeans.hpp>
+#include <mlpack/methods/kmeans/kmeans_parallel_initialization.hpp>
 #include <mlpack/methods/kmeans/sample_initialization.hpp>
 #include <mlpack/methods/kmeans/random_partition.hpp>
+#ifdef HAS_MPI
+  #include <mlpack/methods/kmeans/distributed_kmeans.hpp>
+#endif
 
 #include <mlpack/core/tree/cover_tree/cover_tree.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
@@ -534,6 +540,60 @@ BOOST_AUTO_TEST_CASE(SparseKMeansTest)
   BOOST_REQUIRE_EQUAL(assignments[11], clusterTwo);
 }
 
+/**
+ * Run the given Lloyd step type on dense and sparse versions of the same data,
+ * and make sure the results are the same.
+ */
+template<template<class, class> class LloydStepType>
+void SparseLloydStepTest()
+{
+  arma::sp_mat sparseData;
+  sparseData.sprandu(200, 1000, 0.05);
+  arma::mat denseData(sparseData);
+
+  const size_t k = 8;
+  arma::mat centroids(200, k);
+  centroids.randu();
+  centroids *= 0.1;
+
+  KMeans<metric::EuclideanDistance, RandomPartition, AllowEmptyClusters,
+      LloydStepType> denseKMeans;
+  arma::Row<size_t> denseAssignments;
+  arma::mat denseCentroids(centroids);
+  denseKMeans.Cluster(denseData, k, denseAssignments, denseCentroids, false,
+      true);
+
+  KMeans<metric::EuclideanDistance, RandomPartition, AllowEmptyClusters,
+      LloydStepType, arma::sp_mat> sparseKMeans;
+  arma::Row<size_t> sparseAssignments;
+  arma::mat sparseCentroids(centroids);
+  sparseKMeans.Cluster(sparseData, k, sparseAssignments, sparseCentroids,
+      false, true);
+
+  for (size_t i = 0; i < denseData.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(denseAssignments[i], sparseAssignments[i]);
+
+  for (size_t i = 0; i < centroids.n_elem; ++i)
+  {
+    if (std::abs(denseCentroids[i]) < 1e-10)
+      BOOST_REQUIRE_SMALL(sparseCentroids[i], 1e-10);
+    else
+      BOOST_REQUIRE_CLOSE(denseCentroids[i], sparseCentroids[i], 1e-5);
+  }
+}
+
+/**
+ * Make sure the naive, Elkan and Hamerly Lloyd steps give the same results on
+ * sparse data (where distances are computed from norms and dot products) as on
+ * dense data.
+ */
+BOOST_AUTO_TEST_CASE(SparseLloydStepTypesTest)
+{
+  SparseLloydStepTest<NaiveKMeans>();
+  SparseLloydStepTest<ElkanKMeans>();
+  SparseLloydStepTest<HamerlyKMeans>();
+}
+
 #endif // ARMA_HAS_SPMAT
 
 BOOST_AUTO_TEST_CASE(ElkanTest)
@@ -605,6 +665,42 @@ BOOST_AUTO_TEST_CASE(HamerlyTest)
   }
 }
 
+BOOST_AUTO_TEST_CASE(YinyangTest)
+{
+  const size_t trials = 5;
+
+  for (size_t t = 0; t < trials; ++t)
+  {
+    arma::mat dataset(10, 1000);
+    dataset.randu();
+
+    // Use enough clusters to get several groups.
+    const size_t k = 20 * (t + 1);
+    arma::mat centroids(10, k);
+    centroids.randu();
+
+    // Make sure Yinyang k-means and the naive method return the same
+    // clusters.
+    arma::mat naiveCentroids(centroids);
+    KMeans<> km;
+    arma::Row<size_t> assignments;
+    km.Cluster(dataset, k, assignments, naiveCentroids, false, true);
+
+    KMeans<metric::EuclideanDistance, RandomPartition, MaxVarianceNewCluster,
+        YinyangKMeans> yinyang;
+    arma::Row<size_t> yinyangAssignments;
+    arma::mat yinyangCentroids(centroids);
+    yinyang.Cluster(dataset, k, yinyangAssignments, yinyangCentroids, false,
+        true);
+
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+      BOOST_REQUIRE_EQUAL(assignments[i], yinyangAssignments[i]);
+
+    for (size_t i = 0; i < centroids.n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(naiveCentroids[i], yinyangCentroids[i], 1e-5);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(PellegMooreTest)
 {
   const size_t trials = 5;
@@ -671,6 +767,55 @@ BOOST_AUTO_TEST_CASE(DTNNTest)
   }
 }
 
+/**
+ * Make sure that the dual-tree algorithm gives the same results as the naive
+ * algorithm when the centroid tree is refit in every iteration instead of
+ * being rebuilt.
+ */
+BOOST_AUTO_TEST_CASE(DTNNRefitTest)
+{
+  arma::mat dataset(5, 1000);
+  dataset.randu();
+
+  const size_t k = 50;
+  arma::mat centroids(5, k);
+  centroids.randu();
+  arma::mat dtnnCentroids(centroids);
+
+  metric::EuclideanDistance metric;
+  NaiveKMeans<metric::EuclideanDistance, arma::mat> naive(dataset, metric);
+  DefaultDualTreeKMeans<metric::EuclideanDistance, arma::mat> dtnn(dataset,
+      metric, DBL_MAX);
+
+  for (size_t iteration = 0; iteration < 10; ++iteration)
+  {
+    arma::mat newCentroids, dtnnNewCentroids;
+    arma::Col<size_t> counts, dtnnCounts;
+    naive.Iterate(centroids, newCentroids, counts);
+    dtnn.Iterate(dtnnCentroids, dtnnNewCentroids, dtnnCounts);
+
+    for (size_t c = 0; c < k; ++c)
+    {
+      BOOST_REQUIRE_EQUAL(counts[c], dtnnCounts[c]);
+      // Keep empty clusters where they are.
+      if (counts[c] == 0)
+      {
+        newCentroids.col(c) = centroids.col(c);
+        dtnnNewCentroids.col(c) = dtnnCentroids.col(c);
+      }
+    }
+
+    for (size_t i = 0; i < newCentroids.n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(newCentroids[i], dtnnNewCentroids[i], 1e-5);
+
+    centroids = newCentroids;
+    dtnnCentroids = dtnnNewCentroids;
+  }
+
+  // The tree should only have been built once.
+  BOOST_REQUIRE_EQUAL(dtnn.TreeBuilds(), 1);
+}
+
 BOOST_AUTO_TEST_CASE(DTNNCoverTreeTest)
 {
   const size_t trials = 5;
@@ -737,4 +882,136 @@ BOOST_AUTO_TEST_CASE(SampleInitializationTest)
   }
 }
 
+/**
+ * Make sure that mini-batch k-means finds well-separated clusters, even though
+ * each iteration only looks at a small part of the dataset.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchKMeansTest)
+{
+  // Three Gaussian clusters around known centers.
+  arma::mat centers("0 10 0; 0 0 10; 0 10 10");
+  arma::mat dataset(3, 30000);
+  arma::Row<size_t> trueAssignments(30000);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    trueAssignments[i] = i % 3;
+    dataset.col(i) = centers.col(i % 3) + 0.5 * arma::randn<arma::vec>(3);
+  }
+
+  // Start from perturbed centers, so that the clusters can be matched.
+  arma::mat centroids = centers + arma::randu<arma::mat>(3, 3);
+
+  KMeans<metric::EuclideanDistance, SampleInitialization, MaxVarianceNewCluster,
+      MiniBatchKMeans> kmeans(200);
+  arma::Row<size_t> assignments;
+  kmeans.Cluster(dataset, 3, assignments, centroids, false, true);
+
+  for (size_t i = 0; i < centers.n_elem; ++i)
+    BOOST_REQUIRE_SMALL(centroids[i] - centers[i], 0.1);
+
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], trueAssignments[i]);
+}
+
+/**
+ * Make sure that mini-batch k-means does not accept a batch size of zero.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchKMeansZeroBatchSizeTest)
+{
+  arma::mat dataset(3, 100, arma::fill::randu);
+  metric::EuclideanDistance metric;
+
+  BOOST_REQUIRE_THROW((MiniBatchKMeans<metric::EuclideanDistance, arma::mat>(
+      dataset, metric, 0)), std::invalid_argument);
+}
+
+/**
+ * Make sure that k-means|| initialization puts one centroid in each of a set of
+ * well-separated clusters.
+ */
+BOOST_AUTO_TEST_CASE(KMeansParallelInitializationTest)
+{
+  // Eight Gaussian clusters at the corners of a cube.
+  const size_t clusters = 8;
+  arma::mat centers(3, clusters);
+  for (size_t c = 0; c < clusters; ++c)
+    for (size_t d = 0; d < 3; ++d)
+      centers(d, c) = ((c >> d) & 1) ? 20.0 : 0.0;
+
+  arma::mat dataset(3, 4000);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    dataset.col(i) = centers.col(i % clusters) + arma::randn<arma::vec>(3);
+
+  KMeansParallelInitialization init;
+  arma::mat centroids;
+  init.Cluster(dataset, clusters, centroids);
+
+  BOOST_REQUIRE_EQUAL(centroids.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(centroids.n_cols, clusters);
+
+  // Each center must have exactly one centroid close to it.
+  for (size_t c = 0; c < clusters; ++c)
+  {
+    size_t close = 0;
+    for (size_t i = 0; i < clusters; ++i)
+      if (arma::norm(centroids.col(i) - centers.col(c)) < 5.0)
+        ++close;
+
+    BOOST_REQUIRE_EQUAL(close, 1);
+  }
+
+  // Now use it with KMeans.
+  KMeans<metric::EuclideanDistance, KMeansParallelInitialization> kmeans;
+  arma::Row<size_t> assignments;
+  kmeans.Cluster(dataset, clusters, assignments, centroids);
+
+  for (size_t i = clusters; i < dataset.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], assignments[i % clusters]);
+}
+
+#ifdef HAS_MPI
+/**
+ * Make sure that distributed k-means on one rank returns the same clusters as
+ * k-means.
+ */
+BOOST_AUTO_TEST_CASE(DistributedKMeansTest)
+{
+  int initialized;
+  MPI_Initialized(&initialized);
+  if (!initialized)
+    MPI_Init(NULL, NULL);
+
+  arma::mat dataset(10, 1000);
+  dataset.randu();
+
+  const size_t k = 10;
+  arma::mat centroids(10, k);
+  centroids.randu();
+
+  arma::mat naiveCentroids(centroids);
+  KMeans<> km;
+  arma::Row<size_t> assignments;
+  km.Cluster(dataset, k, assignments, naiveCentroids, false, true);
+
+  DistributedKMeans<> distributed(MPI_COMM_SELF);
+  arma::Row<size_t> distributedAssignments;
+  arma::mat distributedCentroids(centroids);
+  distributed.Cluster(dataset, k, distributedAssignments, distributedCentroids,
+      true);
+
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], distributedAssignments[i]);
+
+  for (size_t i = 0; i < centroids.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(naiveCentroids[i], distributedCentroids[i], 1e-5);
+
+  // Without an initial guess, the initial centroids are sampled.
+  arma::mat sampledCentroids;
+  distributed.Cluster(dataset, k, sampledCentroids);
+  BOOST_REQUIRE_EQUAL(sampledCentroids.n_rows, 10);
+  BOOST_REQUIRE_EQUAL(sampledCentroids.n_cols, k);
+  BOOST_REQUIRE(sampledCentroids.is_finite());
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -10,10 +10,16 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+#include <mlpack/methods/neighbor_search/intrinsic_dimension.hpp>
 #include <mlpack/methods/neighbor_search/unmap.hpp>
 #include <mlpack/methods/neighbor_search/ns_model.hpp>
+#include <mlpack/methods/neighbor_search/spill_tuning.hpp>
+#ifdef HAS_MPI
+  #include <mlpack/methods/neighbor_search/distributed_neighbor_search.hpp>
+#endif
 #include <mlpack/core/tree/cover_tree.hpp>
 #include <mlpack/core/tree/example_tree.hpp>
+#include <mlpack/core/tree/parallel_dual_tree_traverser.hpp>
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 
@@ -754,6 +760,75 @@ BOOST_AUTO_TEST_CASE(SingleTreeVsNaive)
   }
 }
 
+/**
+ * Test blocked naive search against naive search, with more points than fit
+ * in one block, both with and without a query set, for nearest and furthest
+ * neighbors.
+ */
+BOOST_AUTO_TEST_CASE(BlockedNaiveVsNaive)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(40, 2500);
+  arma::mat queryData = arma::randu<arma::mat>(40, 300);
+
+  KNN blocked(referenceData, BLOCKED_NAIVE_MODE);
+  KNN naive(referenceData, NAIVE_MODE);
+  KFN blockedFurthest(referenceData, BLOCKED_NAIVE_MODE);
+  KFN naiveFurthest(referenceData, NAIVE_MODE);
+
+  for (size_t run = 0; run < 4; ++run)
+  {
+    arma::Mat<size_t> neighborsBlocked, neighborsNaive;
+    arma::mat distancesBlocked, distancesNaive;
+    if (run == 0)
+    {
+      blocked.Search(queryData, 10, neighborsBlocked, distancesBlocked);
+      naive.Search(queryData, 10, neighborsNaive, distancesNaive);
+    }
+    else if (run == 1)
+    {
+      blocked.Search(10, neighborsBlocked, distancesBlocked);
+      naive.Search(10, neighborsNaive, distancesNaive);
+    }
+    else if (run == 2)
+    {
+      blockedFurthest.Search(queryData, 10, neighborsBlocked,
+          distancesBlocked);
+      naiveFurthest.Search(queryData, 10, neighborsNaive, distancesNaive);
+    }
+    else
+    {
+      blockedFurthest.Search(10, neighborsBlocked, distancesBlocked);
+      naiveFurthest.Search(10, neighborsNaive, distancesNaive);
+    }
+
+    BOOST_REQUIRE_EQUAL(neighborsBlocked.n_rows, neighborsNaive.n_rows);
+    BOOST_REQUIRE_EQUAL(neighborsBlocked.n_cols, neighborsNaive.n_cols);
+    for (size_t i = 0; i < neighborsBlocked.n_elem; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(neighborsBlocked[i], neighborsNaive[i]);
+      BOOST_REQUIRE_CLOSE(distancesBlocked[i], distancesNaive[i], 1e-5);
+    }
+  }
+}
+
+/**
+ * Make sure that the intrinsic dimension estimate is close to the dimension of
+ * a linear subspace that the data lies in.
+ */
+BOOST_AUTO_TEST_CASE(IntrinsicDimensionTest)
+{
+  // 3-dimensional data embedded in 50 dimensions.
+  arma::mat basis = arma::randn<arma::mat>(50, 3);
+  arma::mat lowDimData = basis * arma::randu<arma::mat>(3, 2000);
+  const double lowDimension = EstimateIntrinsicDimension(lowDimData);
+  BOOST_REQUIRE_GT(lowDimension, 2.0);
+  BOOST_REQUIRE_LT(lowDimension, 4.5);
+
+  // Full-dimensional data.
+  arma::mat highDimData = arma::randu<arma::mat>(50, 2000);
+  BOOST_REQUIRE_GT(EstimateIntrinsicDimension(highDimData), 15.0);
+}
+
 /**
  * Test the cover tree single-tree nearest-neighbors method against the naive
  * method.  This uses only a random reference dataset.
@@ -820,6 +895,54 @@ BOOST_AUTO_TEST_CASE(DualCoverTreeTest)
   }
 }
 
+/**
+ * Make sure that searching a cover tree that points were inserted into and
+ * removed from gives the same results as a naive search of the points that are
+ * left.
+ */
+BOOST_AUTO_TEST_CASE(CoverTreeInsertRemoveSearchTest)
+{
+  arma::mat data;
+  data.randu(10, 1000);
+  arma::mat queries;
+  queries.randu(10, 200);
+
+  NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat,
+      StandardCoverTree> coverTreeSearch(arma::mat(data.cols(0, 499)));
+  coverTreeSearch.ReferenceTree().Insert(data.cols(500, 999));
+
+  // Remove every fourth point.
+  std::vector<size_t> kept;
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    if (i % 4 == 1)
+      BOOST_REQUIRE_EQUAL(coverTreeSearch.ReferenceTree().Remove(i), true);
+    else
+      kept.push_back(i);
+  }
+
+  KNN naive(data.cols(arma::conv_to<arma::uvec>::from(kept)), NAIVE_MODE);
+  arma::Mat<size_t> naiveNeighbors;
+  arma::mat naiveDistances;
+  naive.Search(queries, 10, naiveNeighbors, naiveDistances);
+
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    coverTreeSearch.SearchMode() = (mode == 0) ? DUAL_TREE_MODE :
+        SINGLE_TREE_MODE;
+
+    arma::Mat<size_t> coverNeighbors;
+    arma::mat coverDistances;
+    coverTreeSearch.Search(queries, 10, coverNeighbors, coverDistances);
+
+    for (size_t i = 0; i < coverNeighbors.n_elem; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(coverNeighbors[i], kept[naiveNeighbors[i]]);
+      BOOST_REQUIRE_CLOSE(coverDistances[i], naiveDistances[i], 1e-5);
+    }
+  }
+}
+
 /**
  * Test the ball tree single-tree nearest-neighbors method against the naive
  * method.  This uses only a random reference dataset.
@@ -980,6 +1103,273 @@ BOOST_AUTO_TEST_CASE(DuplicatedSpillSearchTest)
   }
 }
 
+/**
+ * Make sure that the tuned spill tree parameters reach the target recall.
+ */
+BOOST_AUTO_TEST_CASE(SpillTreeTuningTest)
+{
+  arma::mat referenceSet = arma::randu<arma::mat>(5, 1000);
+  arma::mat validationSet = arma::randu<arma::mat>(5, 100);
+
+  const size_t k = 5;
+  double tau = -1.0;
+  double rho = -1.0;
+  const double recall = TuneSpillTree(referenceSet, validationSet, k, 0.9, tau,
+      rho);
+
+  BOOST_REQUIRE_GE(recall, 0.9);
+  BOOST_REQUIRE_GE(tau, 0.0);
+  BOOST_REQUIRE_GT(rho, 0.0);
+  BOOST_REQUIRE_LE(rho, 1.0);
+
+  // Searching again with the tuned parameters must give the same recall.
+  KNN exact(referenceSet);
+  arma::Mat<size_t> trueNeighbors, neighbors;
+  arma::mat trueDistances, distances;
+  exact.Search(validationSet, k, trueNeighbors, trueDistances);
+
+  SpillKNN::Tree tree(referenceSet, tau, 20, rho);
+  SpillKNN spill(std::move(tree), SINGLE_TREE_MODE);
+  spill.Search(validationSet, k, neighbors, distances);
+  BOOST_REQUIRE_CLOSE(SpillKNN::Recall(neighbors, trueNeighbors), recall,
+      1e-5);
+
+  BOOST_REQUIRE_THROW(TuneSpillTree(referenceSet, validationSet, k, 1.5, tau,
+      rho), std::invalid_argument);
+}
+
+/**
+ * Best-first search without a budget should give the same results as exact
+ * search, for several tree types.
+ */
+BOOST_AUTO_TEST_CASE(BestFirstSearchTest)
+{
+  arma::mat referenceSet = arma::randu<arma::mat>(3, 1000);
+  arma::mat querySet = arma::randu<arma::mat>(3, 200);
+
+  KNN naive(referenceSet, NAIVE_MODE);
+  arma::Mat<size_t> naiveNeighbors, naiveMonoNeighbors;
+  arma::mat naiveDistances, naiveMonoDistances;
+  naive.Search(querySet, 5, naiveNeighbors, naiveDistances);
+  naive.Search(5, naiveMonoNeighbors, naiveMonoDistances);
+
+  KNN kdTree(referenceSet, BEST_FIRST_SINGLE_TREE_MODE);
+  NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat,
+      StandardCoverTree> coverTree(referenceSet, BEST_FIRST_SINGLE_TREE_MODE);
+  NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat, RTree>
+      rTree(referenceSet, BEST_FIRST_SINGLE_TREE_MODE);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  kdTree.Search(querySet, 5, neighbors, distances);
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances);
+  BOOST_REQUIRE_EQUAL(kdTree.StoppedQueries(), 0);
+  kdTree.Search(5, neighbors, distances);
+  CheckMatrices(neighbors, naiveMonoNeighbors);
+  CheckMatrices(distances, naiveMonoDistances);
+
+  coverTree.Search(querySet, 5, neighbors, distances);
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances);
+  coverTree.Search(5, neighbors, distances);
+  CheckMatrices(neighbors, naiveMonoNeighbors);
+  CheckMatrices(distances, naiveMonoDistances);
+
+  rTree.Search(querySet, 5, neighbors, distances);
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances);
+}
+
+/**
+ * Best-first search with a budget of base cases should stop early, and still
+ * return k valid neighbors for each query point.
+ */
+BOOST_AUTO_TEST_CASE(BestFirstBudgetTest)
+{
+  arma::mat referenceSet = arma::randu<arma::mat>(5, 5000);
+  arma::mat querySet = arma::randu<arma::mat>(5, 100);
+
+  KNN knn(referenceSet, BEST_FIRST_SINGLE_TREE_MODE);
+  knn.MaxBaseCases() = 30;
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  knn.Search(querySet, 5, neighbors, distances);
+
+  BOOST_REQUIRE_GT(knn.StoppedQueries(), 0);
+  BOOST_REQUIRE_LE(knn.BaseCases(), 30 * querySet.n_cols);
+  for (size_t i = 0; i < querySet.n_cols; ++i)
+  {
+    for (size_t j = 0; j < 5; ++j)
+    {
+      BOOST_REQUIRE_LT(neighbors(j, i), referenceSet.n_cols);
+      BOOST_REQUIRE_CLOSE(distances(j, i), arma::norm(querySet.col(i) -
+          referenceSet.col(neighbors(j, i))), 1e-5);
+    }
+  }
+
+  // A budget smaller than k still finds k neighbors.
+  knn.MaxBaseCases() = 1;
+  knn.Search(querySet, 5, neighbors, distances);
+  BOOST_REQUIRE_LT(arma::max(arma::vectorise(neighbors)), referenceSet.n_cols);
+
+  // A very short time limit stops the searches too, after k base cases.
+  knn.MaxBaseCases() = 0;
+  knn.MaxQueryTime() = 1e-9;
+  knn.Search(querySet, 5, neighbors, distances);
+  BOOST_REQUIRE_GT(knn.StoppedQueries(), 0);
+  BOOST_REQUIRE_LT(arma::max(arma::vectorise(neighbors)), referenceSet.n_cols);
+}
+
+#ifdef HAS_OPENMP
+
+/**
+ * Make sure that greedy single-tree search gives the same results with one
+ * thread and with several threads.
+ */
+BOOST_AUTO_TEST_CASE(ParallelGreedySearchTest)
+{
+  arma::mat referenceSet = arma::randu<arma::mat>(4, 2000);
+  arma::mat querySet = arma::randu<arma::mat>(4, 500);
+
+  KNN knn(referenceSet, GREEDY_SINGLE_TREE_MODE);
+
+  const int threads = omp_get_max_threads();
+  arma::Mat<size_t> neighbors1, neighbors2, neighbors3, neighbors4;
+  arma::mat distances1, distances2, distances3, distances4;
+
+  omp_set_num_threads(1);
+  knn.Search(querySet, 3, neighbors1, distances1);
+  knn.Search(3, neighbors3, distances3);
+
+  omp_set_num_threads(4);
+  knn.Search(querySet, 3, neighbors2, distances2);
+  knn.Search(3, neighbors4, distances4);
+  omp_set_num_threads(threads);
+
+  CheckMatrices(neighbors1, neighbors2);
+  CheckMatrices(distances1, distances2);
+  CheckMatrices(neighbors3, neighbors4);
+  CheckMatrices(distances3, distances4);
+}
+
+#endif
+
+/**
+ * Make sure that single-precision models give the same results as
+ * double-precision search.
+ */
+BOOST_AUTO_TEST_CASE(KNNModelSinglePrecisionTest)
+{
+  typedef NSModel<NearestNeighborSort> KNNModel;
+
+  arma::mat queryData = arma::randu<arma::mat>(10, 50);
+  arma::mat referenceData = arma::randu<arma::mat>(10, 200);
+
+  KNN knn(referenceData);
+  arma::Mat<size_t> baselineNeighbors;
+  arma::mat baselineDistances;
+  knn.Search(queryData, 3, baselineNeighbors, baselineDistances);
+
+  const KNNModel::TreeTypes treeTypes[] = { KNNModel::TreeTypes::KD_TREE,
+      KNNModel::TreeTypes::BALL_TREE };
+  const NeighborSearchMode modes[] = { DUAL_TREE_MODE, SINGLE_TREE_MODE,
+      NAIVE_MODE };
+  for (size_t t = 0; t < 2; ++t)
+  {
+    for (size_t m = 0; m < 3; ++m)
+    {
+      KNNModel model(treeTypes[t], false, true);
+      model.BuildModel(arma::mat(referenceData), 20, modes[m]);
+      BOOST_REQUIRE_EQUAL(model.DatasetSize().n_rows, 10);
+      BOOST_REQUIRE_EQUAL(model.DatasetSize().n_cols, 200);
+      BOOST_REQUIRE_THROW(model.Dataset(), std::invalid_argument);
+
+      arma::Mat<size_t> neighbors;
+      arma::mat distances;
+      model.Search(arma::mat(queryData), 3, neighbors, distances);
+
+      BOOST_REQUIRE_EQUAL(neighbors.n_rows, baselineNeighbors.n_rows);
+      BOOST_REQUIRE_EQUAL(neighbors.n_cols, baselineNeighbors.n_cols);
+      for (size_t k = 0; k < distances.n_elem; ++k)
+      {
+        BOOST_REQUIRE_EQUAL(neighbors[k], baselineNeighbors[k]);
+        BOOST_REQUIRE_CLOSE(distances[k], baselineDistances[k], 1e-3);
+      }
+    }
+  }
+
+  // Single precision is not available for other tree types.
+  KNNModel coverModel(KNNModel::TreeTypes::COVER_TREE, false, true);
+  BOOST_REQUIRE_THROW(coverModel.BuildModel(arma::mat(referenceData), 20,
+      DUAL_TREE_MODE), std::invalid_argument);
+}
+
+/**
+ * Make sure that a query tree built by NSModel::BuildQueryTree() can be used
+ * for many searches with different k, and gives the same results as searching
+ * with the query set.
+ */
+BOOST_AUTO_TEST_CASE(KNNModelQueryTreeTest)
+{
+  typedef NSModel<NearestNeighborSort> KNNModel;
+
+  arma::mat queryData = arma::randu<arma::mat>(5, 100);
+  arma::mat referenceData = arma::randu<arma::mat>(5, 300);
+
+  const KNNModel::TreeTypes treeTypes[] = { KNNModel::TreeTypes::KD_TREE,
+      KNNModel::TreeTypes::COVER_TREE, KNNModel::TreeTypes::R_TREE,
+      KNNModel::TreeTypes::BALL_TREE, KNNModel::TreeTypes::VP_TREE,
+      KNNModel::TreeTypes::SPILL_TREE, KNNModel::TreeTypes::OCTREE };
+  for (size_t t = 0; t < 8; ++t)
+  {
+    // The last model is a single-precision kd-tree.
+    KNNModel model(treeTypes[t % 7], false, (t == 7));
+    model.BuildModel(arma::mat(referenceData), 10, DUAL_TREE_MODE);
+
+    QueryTreeHandle queryTree =
+        model.BuildQueryTree(arma::mat(queryData));
+    BOOST_REQUIRE_EQUAL(queryTree.NumPoints(), 100);
+
+    // Search with a large k after a small one, so that bounds left over from
+    // the last search would give wrong results.
+    const size_t ks[] = { 1, 7, 3, 7 };
+    for (size_t i = 0; i < 4; ++i)
+    {
+      arma::Mat<size_t> neighbors, baselineNeighbors;
+      arma::mat distances, baselineDistances;
+      model.Search(queryTree, ks[i], neighbors, distances);
+      model.Search(arma::mat(queryData), ks[i], baselineNeighbors,
+          baselineDistances);
+
+      BOOST_REQUIRE_EQUAL(neighbors.n_rows, ks[i]);
+      BOOST_REQUIRE_EQUAL(neighbors.n_cols, 100);
+      for (size_t j = 0; j < neighbors.n_elem; ++j)
+      {
+        BOOST_REQUIRE_EQUAL(neighbors[j], baselineNeighbors[j]);
+        BOOST_REQUIRE_CLOSE(distances[j], baselineDistances[j], 1e-5);
+      }
+    }
+  }
+
+  // A query tree can't be used with another type of tree, or without dual-tree
+  // search.
+  KNNModel kdModel(KNNModel::TreeTypes::KD_TREE);
+  kdModel.BuildModel(arma::mat(referenceData), 10, DUAL_TREE_MODE);
+  KNNModel ballModel(KNNModel::TreeTypes::BALL_TREE);
+  ballModel.BuildModel(arma::mat(referenceData), 10, SINGLE_TREE_MODE);
+
+  QueryTreeHandle queryTree = kdModel.BuildQueryTree(
+      arma::mat(queryData));
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  BOOST_REQUIRE_THROW(ballModel.Search(queryTree, 3, neighbors, distances),
+      std::invalid_argument);
+  BOOST_REQUIRE_THROW(ballModel.BuildQueryTree(arma::mat(queryData)),
+      std::invalid_argument);
+}
+
 /**
  * Make sure sparse nearest neighbors works with kd trees.
  */
@@ -1466,4 +1856,374 @@ BOOST_AUTO_TEST_CASE(GreedyTreeSearch)
       0);
 }
 
+/**
+ * Make sure that the parallel dual-tree traverser gives the same results as
+ * naive search, even when the query tree is split into many small tasks.
+ */
+BOOST_AUTO_TEST_CASE(ParallelDualTreeTraverserTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 1000);
+  arma::mat queryData = arma::randu<arma::mat>(3, 500);
+
+  typedef KDTree<EuclideanDistance, NeighborSearchStat<NearestNeighborSort>,
+      arma::mat> TreeType;
+  typedef NeighborSearchRules<NearestNeighborSort, EuclideanDistance,
+      TreeType> RuleType;
+
+  std::vector<size_t> oldFromNewReferences, oldFromNewQueries;
+  TreeType referenceTree(referenceData, oldFromNewReferences, 5);
+  TreeType queryTree(queryData, oldFromNewQueries, 5);
+
+  EuclideanDistance metric;
+  RuleType rules(referenceTree.Dataset(), queryTree.Dataset(), 5, metric);
+  ParallelDualTreeTraverser<TreeType, RuleType> traverser(rules, 50);
+  traverser.Traverse(queryTree, referenceTree);
+
+  arma::Mat<size_t> neighborsTree, neighbors;
+  arma::mat distancesTree, distances;
+  rules.GetResults(neighborsTree, distancesTree);
+  Unmap(neighborsTree, distancesTree, oldFromNewReferences, oldFromNewQueries,
+      neighbors, distances);
+
+  KNN naive(referenceData, NAIVE_MODE);
+  arma::Mat<size_t> neighborsNaive;
+  arma::mat distancesNaive;
+  naive.Search(queryData, 5, neighborsNaive, distancesNaive);
+
+  for (size_t i = 0; i < neighbors.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors[i], neighborsNaive[i]);
+    BOOST_REQUIRE_CLOSE(distances[i], distancesNaive[i], 1e-5);
+  }
+}
+
+/**
+ * Make sure that a kd-tree saved in flat format and mapped back into memory
+ * gives the same results as the original tree.
+ */
+BOOST_AUTO_TEST_CASE(FlatTreeSaveLoadTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(4, 1000);
+  arma::mat queryData = arma::randu<arma::mat>(4, 200);
+
+  KNN knn(referenceData);
+  knn.SaveFlat("flat_kd_tree.bin");
+
+  arma::Mat<size_t> neighbors, flatNeighbors;
+  arma::mat distances, flatDistances;
+  knn.Search(queryData, 5, neighbors, distances);
+
+  // Search with the mapped tree, in both dual-tree and single-tree mode.
+  KNN flatKnn;
+  flatKnn.LoadFlat("flat_kd_tree.bin");
+  BOOST_REQUIRE_EQUAL(flatKnn.ReferenceSet().n_cols, referenceData.n_cols);
+
+  flatKnn.Search(queryData, 5, flatNeighbors, flatDistances);
+  CheckMatrices(neighbors, flatNeighbors);
+  CheckMatrices(distances, flatDistances);
+
+  flatKnn.SearchMode() = SINGLE_TREE_MODE;
+  flatKnn.Search(queryData, 5, flatNeighbors, flatDistances);
+  CheckMatrices(neighbors, flatNeighbors);
+  CheckMatrices(distances, flatDistances);
+
+  // The same should work through the NSModel interface.
+  NSModel<NearestNeighborSort> model;
+  model.LoadFlat("flat_kd_tree.bin", DUAL_TREE_MODE);
+  model.Search(arma::mat(queryData), 5, flatNeighbors, flatDistances);
+  CheckMatrices(neighbors, flatNeighbors);
+  CheckMatrices(distances, flatDistances);
+
+  remove("flat_kd_tree.bin");
+}
+
+/**
+ * Make sure that inserting reference points gives the same results as building
+ * the model on all the points, whether the tree is rebuilt or not.
+ */
+BOOST_AUTO_TEST_CASE(InsertReferencePointsTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 1000);
+  arma::mat queryData = arma::randu<arma::mat>(3, 100);
+
+  KNN naive(referenceData, NAIVE_MODE);
+  arma::Mat<size_t> naiveNeighbors, neighbors;
+  arma::mat naiveDistances, distances;
+  naive.Search(queryData, 5, naiveNeighbors, naiveDistances);
+
+  const double ratios[] = { DBL_MAX, 1.0, 0.1 };
+  const NeighborSearchMode modes[] = { DUAL_TREE_MODE, SINGLE_TREE_MODE,
+      NAIVE_MODE };
+  for (size_t r = 0; r < 3; ++r)
+  {
+    for (size_t m = 0; m < 3; ++m)
+    {
+      KNN knn(referenceData.cols(0, 599), modes[m]);
+      knn.Insert(referenceData.cols(600, 799), ratios[r], 10);
+      knn.Insert(referenceData.cols(800, 999), ratios[r], 10);
+      BOOST_REQUIRE_EQUAL(knn.ReferenceSet().n_cols, 1000);
+
+      knn.Search(queryData, 5, neighbors, distances);
+      CheckMatrices(naiveNeighbors, neighbors);
+      CheckMatrices(naiveDistances, distances);
+    }
+  }
+
+  // Inserting into an empty model is just training.
+  KNN knn;
+  knn.Insert(referenceData);
+  knn.Search(queryData, 5, neighbors, distances);
+  CheckMatrices(naiveNeighbors, neighbors);
+  CheckMatrices(naiveDistances, distances);
+
+  BOOST_REQUIRE_THROW(knn.Insert(arma::randu<arma::mat>(4, 10)),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure that refitting the reference tree to moved points gives the same
+ * results as building the model on the moved points.
+ */
+BOOST_AUTO_TEST_CASE(RefitReferencePointsTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 1000);
+  arma::mat queryData = arma::randu<arma::mat>(3, 100);
+
+  // Move the points with a linear transformation.
+  arma::mat transformation = arma::eye<arma::mat>(3, 3) +
+      0.2 * arma::randu<arma::mat>(3, 3);
+  arma::mat movedData = transformation * referenceData;
+
+  KNN naive(movedData, NAIVE_MODE);
+  arma::Mat<size_t> naiveNeighbors, neighbors;
+  arma::mat naiveDistances, distances;
+  naive.Search(queryData, 5, naiveNeighbors, naiveDistances);
+
+  const NeighborSearchMode modes[] = { DUAL_TREE_MODE, SINGLE_TREE_MODE,
+      NAIVE_MODE };
+  for (size_t m = 0; m < 3; ++m)
+  {
+    KNN knn(referenceData, modes[m]);
+    knn.Refit(movedData);
+
+    knn.Search(queryData, 5, neighbors, distances);
+    CheckMatrices(naiveNeighbors, neighbors);
+    CheckMatrices(naiveDistances, distances);
+  }
+
+  KNN knn(referenceData);
+  BOOST_REQUIRE_THROW(knn.Refit(arma::randu<arma::mat>(3, 10)),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure that the traversal statistics are only collected when enabled, and
+ * that they are consistent with the counts of the search when they are.
+ */
+BOOST_AUTO_TEST_CASE(TraversalStatisticsTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 1000);
+  arma::mat queryData = arma::randu<arma::mat>(3, 200);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+
+  KNN knn(dataset);
+  knn.Search(queryData, 5, neighbors, distances);
+  BOOST_REQUIRE_EQUAL(knn.Statistics().VisitsPerLevel().size(), 0);
+  BOOST_REQUIRE_EQUAL(knn.Statistics().LeafSizes().size(), 0);
+
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    knn.SearchMode() = (mode == 0) ? DUAL_TREE_MODE : SINGLE_TREE_MODE;
+    knn.Statistics().Enabled() = true;
+    knn.Search(queryData, 5, neighbors, distances);
+
+    const tree::TraversalStatistics& statistics = knn.Statistics();
+    BOOST_REQUIRE_GT(statistics.VisitsPerLevel().size(), 1);
+    BOOST_REQUIRE_GT(statistics.LeafSizes().size(), 0);
+    BOOST_REQUIRE_EQUAL(statistics.BaseCases(), knn.BaseCases());
+    BOOST_REQUIRE_EQUAL(statistics.Scores(), knn.Scores());
+
+    size_t visits = 0, prunes = 0;
+    for (size_t i = 0; i < statistics.VisitsPerLevel().size(); ++i)
+    {
+      BOOST_REQUIRE_LE(statistics.PrunesPerLevel()[i],
+          statistics.VisitsPerLevel()[i]);
+      visits += statistics.VisitsPerLevel()[i];
+      prunes += statistics.PrunesPerLevel()[i];
+    }
+
+    BOOST_REQUIRE_GT(visits, 0);
+    BOOST_REQUIRE_GT(prunes, 0);
+    BOOST_REQUIRE_EQUAL(prunes,
+        statistics.Prunes(tree::TraversalStatistics::BOUND_PRUNE));
+
+    // No leaf holds more points than the leaf size.
+    BOOST_REQUIRE_LE(statistics.LeafSizes().rbegin()->first, 20);
+  }
+}
+
+/**
+ * Make sure that sorted candidate lists and heaps hold the same candidates,
+ * and that a search with k large enough to use heaps matches naive search.
+ */
+BOOST_AUTO_TEST_CASE(CandidateListsTest)
+{
+  const size_t ks[] = { 1, 5, CandidateLists<NearestNeighborSort>::MaxSortedK,
+      CandidateLists<NearestNeighborSort>::MaxSortedK + 1, 60 };
+  for (size_t i = 0; i < 5; ++i)
+  {
+    const size_t k = ks[i];
+    CandidateLists<NearestNeighborSort> sorted(k, 10, true);
+    CandidateLists<NearestNeighborSort> heap(k, 10, false);
+    BOOST_REQUIRE_EQUAL(CandidateLists<NearestNeighborSort>(k, 10).Sorted(),
+        k <= CandidateLists<NearestNeighborSort>::MaxSortedK);
+
+    arma::vec distances = arma::randu<arma::vec>(1000);
+    for (size_t j = 0; j < distances.n_elem; ++j)
+    {
+      sorted.Insert(j % 10, j, distances[j]);
+      heap.Insert(j % 10, j, distances[j]);
+      BOOST_REQUIRE_EQUAL(sorted.Worst(j % 10), heap.Worst(j % 10));
+    }
+
+    arma::Mat<size_t> sortedNeighbors(k, 10), heapNeighbors(k, 10);
+    arma::mat sortedDistances(k, 10), heapDistances(k, 10);
+    for (size_t p = 0; p < 10; ++p)
+    {
+      sorted.Extract(p, sortedNeighbors, sortedDistances, p);
+      heap.Extract(p, heapNeighbors, heapDistances, p);
+      BOOST_REQUIRE_EQUAL(sorted.Worst(p), DBL_MAX);
+    }
+
+    CheckMatrices(sortedNeighbors, heapNeighbors);
+    CheckMatrices(sortedDistances, heapDistances);
+    for (size_t p = 0; p < 10; ++p)
+      for (size_t j = 1; j < k; ++j)
+        BOOST_REQUIRE_LE(sortedDistances(j - 1, p), sortedDistances(j, p));
+  }
+
+  arma::mat referenceData = arma::randu<arma::mat>(3, 500);
+  KNN knn(referenceData);
+  KNN naive(referenceData, NAIVE_MODE);
+  arma::Mat<size_t> neighbors, naiveNeighbors;
+  arma::mat distances, naiveDistances;
+  knn.Search(60, neighbors, distances);
+  naive.Search(60, naiveNeighbors, naiveDistances);
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances);
+}
+
+/**
+ * Make sure that single-tree search along a space-filling curve gives the same
+ * results as in the order of the query points.
+ */
+BOOST_AUTO_TEST_CASE(QueryCurveTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 1000);
+  arma::mat queryData = arma::randn<arma::mat>(3, 300);
+
+  const NeighborSearchMode modes[] = { SINGLE_TREE_MODE,
+      BEST_FIRST_SINGLE_TREE_MODE };
+  const tree::SpaceFillingCurve curves[] = { tree::MORTON_CURVE,
+      tree::HILBERT_CURVE };
+  for (size_t c = 0; c < 2; ++c)
+  {
+    // The order is a permutation of the points.
+    std::vector<size_t> order;
+    tree::SpaceFillingCurveOrder(queryData, curves[c], order);
+    BOOST_REQUIRE_EQUAL(order.size(), queryData.n_cols);
+    std::vector<size_t> sorted(order);
+    std::sort(sorted.begin(), sorted.end());
+    for (size_t i = 0; i < sorted.size(); ++i)
+      BOOST_REQUIRE_EQUAL(sorted[i], i);
+
+    for (size_t m = 0; m < 2; ++m)
+    {
+      KNN knn(referenceData, modes[m]);
+      arma::Mat<size_t> neighbors, curveNeighbors;
+      arma::mat distances, curveDistances;
+      knn.Search(queryData, 5, neighbors, distances);
+
+      knn.QueryCurve() = curves[c];
+      knn.Search(queryData, 5, curveNeighbors, curveDistances);
+
+      CheckMatrices(neighbors, curveNeighbors);
+      CheckMatrices(distances, curveDistances);
+    }
+  }
+
+  std::vector<size_t> order(1);
+  tree::SpaceFillingCurveOrder(queryData, tree::NO_CURVE, order);
+  BOOST_REQUIRE(order.empty());
+}
+
+/**
+ * Make sure that leaf-leaf base cases are only computed as a block for the
+ * metrics with a fast EvaluateBlock(), and that the other LMetrics still give
+ * the results of the naive search.
+ */
+BOOST_AUTO_TEST_CASE(LeafBlockMetricTest)
+{
+  BOOST_REQUIRE(HasFastEvaluateBlock<EuclideanDistance>::Value);
+  BOOST_REQUIRE(HasFastEvaluateBlock<SquaredEuclideanDistance>::Value);
+  BOOST_REQUIRE(!HasFastEvaluateBlock<ManhattanDistance>::Value);
+  BOOST_REQUIRE(!HasFastEvaluateBlock<ChebyshevDistance>::Value);
+
+  arma::mat referenceData = arma::randu<arma::mat>(4, 800);
+  arma::mat queryData = arma::randu<arma::mat>(4, 200);
+
+  NeighborSearch<NearestNeighborSort, ManhattanDistance> manhattan(
+      referenceData);
+  NeighborSearch<NearestNeighborSort, ManhattanDistance> naiveManhattan(
+      referenceData, NAIVE_MODE);
+  arma::Mat<size_t> neighbors, naiveNeighbors;
+  arma::mat distances, naiveDistances;
+  manhattan.Search(queryData, 5, neighbors, distances);
+  naiveManhattan.Search(queryData, 5, naiveNeighbors, naiveDistances);
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances);
+}
+
+#ifdef HAS_MPI
+/**
+ * Make sure that distributed search on one rank gives the same results as KNN,
+ * for query sets and for all-k-nearest-neighbors.
+ */
+BOOST_AUTO_TEST_CASE(DistributedKNNTest)
+{
+  int initialized;
+  MPI_Initialized(&initialized);
+  if (!initialized)
+    MPI_Init(NULL, NULL);
+
+  arma::mat referenceData = arma::randu<arma::mat>(3, 500);
+  arma::mat queryData = arma::randu<arma::mat>(3, 200);
+
+  KNN knn(referenceData);
+  arma::Mat<size_t> neighbors, distributedNeighbors;
+  arma::mat distances, distributedDistances;
+
+  const NeighborSearchMode modes[] = { NAIVE_MODE, SINGLE_TREE_MODE,
+      DUAL_TREE_MODE };
+  for (size_t m = 0; m < 3; ++m)
+  {
+    DistributedNeighborSearch<> distributed(referenceData, MPI_COMM_SELF,
+        modes[m]);
+    BOOST_REQUIRE_EQUAL(distributed.ReferencePoints(), 500);
+
+    knn.Search(queryData, 5, neighbors, distances);
+    distributed.Search(queryData, 5, distributedNeighbors,
+        distributedDistances);
+    CheckMatrices(neighbors, distributedNeighbors);
+    CheckMatrices(distances, distributedDistances);
+
+    knn.Search(5, neighbors, distances);
+    distributed.Search(5, distributedNeighbors, distributedDistances);
+    CheckMatrices(neighbors, distributedNeighbors);
+    CheckMatrices(distances, distributedDistances);
+  }
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE_END();
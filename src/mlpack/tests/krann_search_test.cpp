@@ -715,4 +715,46 @@ BOOST_AUTO_TEST_CASE(RAModelTest)
   }
 }
 
+/**
+ * Make sure that naive and single-tree search give the same results for the
+ * same random seed, in both bichromatic and monochromatic search.  If OpenMP
+ * is available, the results must also not depend on the number of threads.
+ */
+BOOST_AUTO_TEST_CASE(ReproducibleSearchTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 1000);
+  arma::mat queryData = arma::randu<arma::mat>(3, 200);
+
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    const bool naive = (mode == 0);
+    RASearch<> ra(referenceData, naive, !naive, 5.0, 0.95, false, false, 5);
+
+    arma::Mat<size_t> neighbors1, neighbors2, monoNeighbors1, monoNeighbors2;
+    arma::mat distances1, distances2, monoDistances1, monoDistances2;
+
+    math::RandomSeed(42);
+    ra.Search(queryData, 3, neighbors1, distances1);
+    ra.Search(3, monoNeighbors1, monoDistances1);
+
+#ifdef HAS_OPENMP
+    const int prevNumThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+#endif
+
+    math::RandomSeed(42);
+    ra.Search(queryData, 3, neighbors2, distances2);
+    ra.Search(3, monoNeighbors2, monoDistances2);
+
+#ifdef HAS_OPENMP
+    omp_set_num_threads(prevNumThreads);
+#endif
+
+    CheckMatrices(neighbors1, neighbors2);
+    CheckMatrices(distances1, distances2);
+    CheckMatrices(monoNeighbors1, monoNeighbors2);
+    CheckMatrices(monoDistances1, monoDistances2);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
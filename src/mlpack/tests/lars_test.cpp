@@ -397,4 +397,95 @@ BOOST_AUTO_TEST_CASE(LARSTrainReturnCorrelation)
   BOOST_REQUIRE_EQUAL(std::isfinite(maxCorr), true);
 }
 
+/**
+ * Make sure that training on many responses at once gives the same solutions
+ * as training on each of them separately, with and without a given Gram
+ * matrix.
+ */
+BOOST_AUTO_TEST_CASE(LARSMultipleResponsesTest)
+{
+  arma::mat X = arma::randn(20, 200);
+  arma::mat responses = trans(arma::randn(20, 10)) * X;
+  responses = responses.t(); // One response per column.
+  const arma::mat gram = X * X.t();
+
+  for (size_t i = 0; i < 4; ++i)
+  {
+    const bool useCholesky = (i % 2 == 0);
+    const bool useGram = (i >= 2);
+
+    LARS withGram(useCholesky, gram, 0.5, 0.1);
+    LARS withoutGram(useCholesky, 0.5, 0.1);
+    LARS& lars = useGram ? withGram : withoutGram;
+    arma::mat betas;
+    lars.Train(X, responses, betas);
+
+    BOOST_REQUIRE_EQUAL(betas.n_rows, 20);
+    BOOST_REQUIRE_EQUAL(betas.n_cols, 10);
+
+    for (size_t j = 0; j < responses.n_cols; ++j)
+    {
+      LARS single(useCholesky, 0.5, 0.1);
+      arma::vec beta;
+      single.Train(X, arma::rowvec(responses.col(j).t()), beta);
+
+      for (size_t k = 0; k < beta.n_elem; ++k)
+      {
+        if (std::abs(beta[k]) < 1e-10)
+          BOOST_REQUIRE_SMALL(betas(k, j), 1e-10);
+        else
+          BOOST_REQUIRE_CLOSE(betas(k, j), beta[k], 1e-5);
+      }
+    }
+
+    // The model holds the solution of the last response.
+    for (size_t k = 0; k < lars.Beta().n_elem; ++k)
+      BOOST_REQUIRE_SMALL(lars.Beta()[k] - betas(k, 9), 1e-10);
+  }
+}
+
+/**
+ * Make sure that retraining on new data of the same dimensionality does not
+ * reuse the Gram matrix of the old data.
+ */
+BOOST_AUTO_TEST_CASE(RetrainSameDimensionalityTest)
+{
+  arma::mat origX, newX;
+  arma::rowvec origY, newY;
+  GenerateProblem(origX, origY, 1000, 50);
+  GenerateProblem(newX, newY, 500, 50);
+
+  for (size_t i = 0; i < 2; ++i)
+  {
+    LARS lars((i == 0), 0.1, 0.1);
+    arma::vec betaOpt;
+    lars.Train(origX, origY, betaOpt);
+    lars.Train(newX, newY, betaOpt);
+
+    arma::vec errCorr = (newX * trans(newX) + 0.1 *
+          arma::eye(50, 50)) * betaOpt - newX * newY.t();
+
+    LARSVerifyCorrectness(betaOpt, errCorr, 0.1);
+  }
+}
+
+/**
+ * Make sure that a given Gram matrix gives a correct elastic net solution
+ * without the Cholesky decomposition.
+ */
+BOOST_AUTO_TEST_CASE(ElasticNetGivenGramTest)
+{
+  arma::mat X;
+  arma::rowvec y;
+  GenerateProblem(X, y, 200, 20);
+  const arma::mat gram = X * X.t();
+
+  LARS lars(false, gram, 0.1, 0.1);
+  arma::vec betaOpt;
+  lars.Train(X, y, betaOpt);
+
+  arma::vec errCorr = (gram + 0.1 * arma::eye(20, 20)) * betaOpt - X * y.t();
+  LARSVerifyCorrectness(betaOpt, errCorr, 0.1);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -137,6 +137,59 @@ BOOST_AUTO_TEST_CASE(TestOrthogonalize)
   }
 }
 
+/**
+ * SparseTransposeMultiply() should give the same result as Armadillo.
+ */
+BOOST_AUTO_TEST_CASE(TestSparseTransposeMultiply)
+{
+  sp_mat x;
+  x.sprandu(50, 400, 0.05);
+  mat y(50, 7, fill::randn);
+
+  mat output;
+  SparseTransposeMultiply(x, y, output);
+  const mat expected = mat(x.t()) * y;
+
+  BOOST_REQUIRE_EQUAL(output.n_rows, 400);
+  BOOST_REQUIRE_EQUAL(output.n_cols, 7);
+  for (size_t i = 0; i < output.n_elem; ++i)
+    BOOST_REQUIRE_SMALL(output[i] - expected[i], 1e-10);
+
+  BOOST_REQUIRE_THROW(SparseTransposeMultiply(x, mat(40, 7), output),
+      std::invalid_argument);
+}
+
+/**
+ * OrthonormalizeColumns() should give orthonormal columns with the same span,
+ * also when the columns are badly scaled or dependent.
+ */
+BOOST_AUTO_TEST_CASE(TestOrthonormalizeColumns)
+{
+  mat x(1000, 10, fill::randn);
+  x.col(3) *= 1e5;
+  mat dependent = x;
+  dependent.col(9) = dependent.col(0) + dependent.col(1);
+
+  for (size_t trial = 0; trial < 2; ++trial)
+  {
+    const mat original = (trial == 0) ? x : dependent;
+    mat q = original;
+    OrthonormalizeColumns(q);
+
+    BOOST_REQUIRE_EQUAL(q.n_rows, 1000);
+    BOOST_REQUIRE_EQUAL(q.n_cols, 10);
+    const mat gram = q.t() * q;
+    for (size_t i = 0; i < 10; ++i)
+      for (size_t j = 0; j < 10; ++j)
+        BOOST_REQUIRE_SMALL(gram(i, j) - ((i == j) ? 1.0 : 0.0), 1e-8);
+
+    // Projecting the original columns onto the span should not change them.
+    const mat projected = q * (q.t() * original);
+    BOOST_REQUIRE_SMALL(norm(projected - original, "frob") /
+        norm(original, "frob"), 1e-8);
+  }
+}
+
 // Test RemoveRows().
 BOOST_AUTO_TEST_CASE(TestRemoveRows)
 {
@@ -15,6 +15,8 @@
 #include "test_tools.hpp"
 #include "serialization.hpp"
 
+#include <fstream>
+
 using namespace mlpack;
 using namespace mlpack::regression;
 
@@ -268,4 +270,108 @@ BOOST_AUTO_TEST_CASE(LinearRegressionTrainReturnObjective)
   BOOST_REQUIRE_EQUAL(std::isfinite(error), true);
 }
 
+/**
+ * Make sure that training on NormalEquations accumulated in chunks and merged
+ * gives the same model as training on the whole dataset at once.
+ */
+BOOST_AUTO_TEST_CASE(NormalEquationsChunkedTrainTest)
+{
+  arma::mat predictors(5, 1000, arma::fill::randu);
+  arma::rowvec responses = arma::randu<arma::rowvec>(5) * predictors + 2.0 +
+      0.1 * arma::randn<arma::rowvec>(1000);
+  arma::rowvec weights = arma::randu<arma::rowvec>(1000) + 0.5;
+
+  for (size_t i = 0; i < 2; ++i)
+  {
+    const bool intercept = (i == 0);
+
+    LinearRegression lr;
+    lr.Lambda() = 0.1;
+    const double error = lr.Train(predictors, responses, intercept);
+
+    // Accumulate two chunks in one object, and merge a third in.
+    NormalEquations equations(0, intercept), other(5, intercept);
+    equations.Add(predictors.cols(0, 299), responses.subvec(0, 299));
+    equations.Add(predictors.cols(300, 599), responses.subvec(300, 599));
+    other.Add(predictors.cols(600, 999), responses.subvec(600, 999));
+    equations.Merge(other);
+    BOOST_REQUIRE_EQUAL(equations.NumPoints(), 1000);
+
+    LinearRegression streamed;
+    streamed.Lambda() = 0.1;
+    const double streamedError = streamed.Train(equations);
+
+    BOOST_REQUIRE_EQUAL(streamed.Intercept(), intercept);
+    BOOST_REQUIRE_EQUAL(streamed.Parameters().n_elem,
+        lr.Parameters().n_elem);
+    for (size_t j = 0; j < lr.Parameters().n_elem; ++j)
+      BOOST_REQUIRE_CLOSE(streamed.Parameters()[j], lr.Parameters()[j], 1e-5);
+    BOOST_REQUIRE_CLOSE(streamedError, error, 1e-5);
+
+    // The same should hold with weights.
+    lr.Train(predictors, responses, weights, intercept);
+    NormalEquations weighted(5, intercept);
+    weighted.Add(predictors.cols(0, 499), responses.subvec(0, 499),
+        weights.subvec(0, 499));
+    weighted.Add(predictors.cols(500, 999), responses.subvec(500, 999),
+        weights.subvec(500, 999));
+    streamed.Train(weighted);
+    for (size_t j = 0; j < lr.Parameters().n_elem; ++j)
+      BOOST_REQUIRE_CLOSE(streamed.Parameters()[j], lr.Parameters()[j], 1e-5);
+  }
+
+  // Points of the wrong dimensionality can't be added.
+  NormalEquations equations(5);
+  BOOST_REQUIRE_THROW(equations.Add(arma::mat(4, 10, arma::fill::randu),
+      arma::rowvec(10, arma::fill::randu)), std::invalid_argument);
+}
+
+/**
+ * Make sure that NormalEquations::AddFile() gives the same sums as adding the
+ * data in the file directly, even when the file is read in small chunks.
+ */
+BOOST_AUTO_TEST_CASE(NormalEquationsAddFileTest)
+{
+  arma::mat predictors(3, 500, arma::fill::randu);
+  arma::rowvec responses = arma::randu<arma::rowvec>(3) * predictors - 1.0;
+
+  // Write the data with a mix of separators and some empty lines, and no
+  // newline at the end.
+  std::ofstream stream("normal_equations_test.csv");
+  stream.precision(17);
+  for (size_t i = 0; i < predictors.n_cols; ++i)
+  {
+    if (i > 0)
+      stream << ((i % 50 == 0) ? "\n\n" : "\n");
+    stream << predictors(0, i) << ", " << predictors(1, i) << "\t"
+        << predictors(2, i) << " " << responses[i];
+  }
+  stream.close();
+
+  NormalEquations direct;
+  direct.Add(predictors, responses);
+
+  NormalEquations fromFile;
+  fromFile.AddFile("normal_equations_test.csv", 1000);
+
+  BOOST_REQUIRE_EQUAL(fromFile.Dimensionality(), 3);
+  BOOST_REQUIRE_EQUAL(fromFile.NumPoints(), 500);
+  for (size_t i = 0; i < direct.XtX().n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(fromFile.XtX()[i], direct.XtX()[i], 1e-8);
+  for (size_t i = 0; i < direct.XtY().n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(fromFile.XtY()[i], direct.XtY()[i], 1e-8);
+  BOOST_REQUIRE_CLOSE(fromFile.YtY(), direct.YtY(), 1e-8);
+
+  // A line with the wrong number of values is an error.
+  std::ofstream badStream("normal_equations_test.csv");
+  badStream << "1, 2, 3, 4\n5, 6, 7\n";
+  badStream.close();
+
+  NormalEquations bad;
+  BOOST_REQUIRE_THROW(bad.AddFile("normal_equations_test.csv"),
+      std::runtime_error);
+
+  remove("normal_equations_test.csv");
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -446,6 +446,89 @@ BOOST_AUTO_TEST_CASE(LinearSVMFunctionSeparableGradient)
   }
 }
 
+/**
+ * Test that the batch and minibatch objective and gradient of the
+ * LinearSVMFunction match a hand calculation when an intercept is fitted, for
+ * both dense and sparse data.
+ */
+BOOST_AUTO_TEST_CASE(LinearSVMFunctionInterceptBatchGradient)
+{
+  const size_t points = 1000;
+  const size_t inputSize = 20;
+  const size_t numClasses = 5;
+  const double delta = 1.0;
+  const double lambda = 0.01;
+
+  // Initialize a random sparse dataset, and a dense copy of it.
+  arma::sp_mat sparseData;
+  sparseData.sprandu(inputSize, points, 0.2);
+  arma::mat data(sparseData);
+
+  arma::Row<size_t> labels(points);
+  for (size_t i = 0; i < points; i++)
+    labels(i) = math::RandInt(0, numClasses);
+
+  LinearSVMFunction<arma::mat> svmf(data, labels, numClasses, lambda, delta,
+      true);
+  LinearSVMFunction<arma::sp_mat> sparseSvmf(sparseData, labels, numClasses,
+      lambda, delta, true);
+
+  arma::mat parameters;
+  parameters.randu(inputSize + 1, numClasses);
+
+  // Hand-calculate the objective and gradient over a batch of points that
+  // spans several blocks.
+  const size_t firstId = 100;
+  const size_t batchSize = 700;
+  double loss = 0.0;
+  arma::mat difference(numClasses, batchSize, arma::fill::zeros);
+  for (size_t j = 0; j < batchSize; ++j)
+  {
+    const size_t point = firstId + j;
+    arma::vec score = parameters.rows(0, inputSize - 1).t() * data.col(point)
+        + parameters.row(inputSize).t();
+    const double correct = score[labels(point)];
+    for (size_t k = 0; k < numClasses; ++k)
+    {
+      if (k == labels[point])
+        continue;
+      const double margin = score[k] - correct + delta;
+      if (margin > 0)
+      {
+        loss += margin;
+        difference(k, j) = 1;
+        difference(labels(point), j) -= 1;
+      }
+    }
+  }
+
+  const double objective = loss / batchSize +
+      0.5 * lambda * arma::dot(parameters, parameters);
+  arma::mat gradient(inputSize + 1, numClasses);
+  gradient.rows(0, inputSize - 1) =
+      data.cols(firstId, firstId + batchSize - 1) * difference.t();
+  gradient.row(inputSize) = arma::sum(difference, 1).t();
+  gradient = gradient / batchSize + lambda * parameters;
+
+  BOOST_REQUIRE_CLOSE(svmf.Evaluate(parameters, firstId, batchSize),
+      objective, 1e-5);
+  BOOST_REQUIRE_CLOSE(sparseSvmf.Evaluate(parameters, firstId, batchSize),
+      objective, 1e-5);
+
+  arma::mat denseGradient, sparseGradient;
+  svmf.Gradient(parameters, firstId, denseGradient, batchSize);
+  BOOST_REQUIRE_CLOSE(sparseSvmf.EvaluateWithGradient(parameters, firstId,
+      sparseGradient, batchSize), objective, 1e-5);
+
+  BOOST_REQUIRE_EQUAL(denseGradient.n_rows, inputSize + 1);
+  BOOST_REQUIRE_EQUAL(sparseGradient.n_rows, inputSize + 1);
+  for (size_t i = 0; i < gradient.n_elem; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(denseGradient[i], gradient[i], 1e-5);
+    BOOST_REQUIRE_CLOSE(sparseGradient[i], gradient[i], 1e-5);
+  }
+}
+
 /**
  * Test training of linear svm on a simple dataset using
  * L-BFGS optimizer
@@ -100,6 +100,43 @@ BOOST_AUTO_TEST_CASE(LMNNImpostorsTest)
   BOOST_REQUIRE_EQUAL(impostors(0, 5), 2);
 }
 
+/**
+ * Impostors computed with refit trees should be the same as the impostors
+ * computed with rebuilt trees.
+ */
+BOOST_AUTO_TEST_CASE(LMNNRefitImpostorsTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(4, 300);
+  arma::Row<size_t> labels(300);
+  for (size_t i = 0; i < 300; ++i)
+    labels[i] = i % 3;
+
+  arma::vec norm(dataset.n_cols);
+  for (size_t i = 0; i < dataset.n_cols; i++)
+    norm(i) = arma::norm(dataset.col(i));
+
+  Constraints<> constraint(dataset, labels, 3);
+  arma::Mat<size_t> impostors(3, dataset.n_cols);
+  arma::mat distances(3, dataset.n_cols);
+  constraint.Impostors(impostors, distances, dataset, labels, norm);
+
+  // Now move the points a little.
+  const arma::mat transformed = (arma::eye<arma::mat>(4, 4) +
+      0.05 * arma::randu<arma::mat>(4, 4)) * dataset;
+
+  Constraints<> rebuiltConstraint(transformed, labels, 3);
+  arma::Mat<size_t> rebuiltImpostors(3, dataset.n_cols);
+  arma::mat rebuiltDistances(3, dataset.n_cols);
+  rebuiltConstraint.Impostors(rebuiltImpostors, rebuiltDistances, transformed,
+      labels, norm);
+
+  constraint.RefitTrees() = true;
+  constraint.Impostors(impostors, distances, transformed, labels, norm);
+
+  CheckMatrices(rebuiltImpostors, impostors);
+  CheckMatrices(rebuiltDistances, distances);
+}
+
 //
 // Tests for the LMNNFunction
 //
@@ -10,10 +10,13 @@
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
 #include <sstream>
+#include <iomanip>
 
 #include <mlpack/core.hpp>
 #include <mlpack/core/data/load_arff.hpp>
 #include <mlpack/core/data/map_policies/missing_policy.hpp>
+#include <mlpack/core/data/map_policies/hash_policy.hpp>
+#include <mlpack/core/data/stream_reader.hpp>
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 
@@ -929,6 +932,65 @@ BOOST_AUTO_TEST_CASE(OneHotEncodingTest)
   CheckMatrices(output, matrix);
 }
 
+/**
+ * The sparse one-hot encoding holds the transpose of the dense one.
+ */
+BOOST_AUTO_TEST_CASE(SparseOneHotEncodingTest)
+{
+  arma::irowvec labels("-1 1 -1 -1 3 -1 1 -1");
+  arma::Mat<size_t> dense;
+  data::OneHotEncoding(labels, dense);
+
+  arma::sp_mat sparse;
+  data::OneHotEncoding(labels, sparse);
+
+  BOOST_REQUIRE_EQUAL(sparse.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(sparse.n_cols, labels.n_elem);
+  BOOST_REQUIRE_EQUAL(sparse.n_nonzero, labels.n_elem);
+  CheckMatrices(arma::mat(sparse), arma::conv_to<arma::mat>::from(dense.t()));
+}
+
+/**
+ * Encode the categorical dimensions of a dataset into a sparse matrix.
+ */
+BOOST_AUTO_TEST_CASE(SparseDatasetOneHotEncodingTest)
+{
+  fstream f;
+  f.open("test.csv", fstream::out);
+  f << "1.5, a, 0, x" << endl;
+  f << "0, b, 2, y" << endl;
+  f << "-3, a, 1, z" << endl;
+  f << "2, c, 0, x" << endl;
+  f.close();
+
+  arma::mat dataset;
+  data::DatasetInfo info;
+  BOOST_REQUIRE(data::Load("test.csv", dataset, info));
+  remove("test.csv");
+
+  arma::sp_mat encoded;
+  data::OneHotEncoding(dataset, info, encoded);
+
+  // One row for each numeric dimension, three for each categorical one.
+  arma::mat expected("1.5 0.0 -3.0 2.0;"
+                     "1.0 0.0  1.0 0.0;"
+                     "0.0 1.0  0.0 0.0;"
+                     "0.0 0.0  0.0 1.0;"
+                     "0.0 2.0  1.0 0.0;"
+                     "1.0 0.0  0.0 1.0;"
+                     "0.0 1.0  0.0 0.0;"
+                     "0.0 0.0  1.0 0.0");
+  BOOST_REQUIRE_EQUAL(encoded.n_rows, expected.n_rows);
+  BOOST_REQUIRE_EQUAL(encoded.n_cols, expected.n_cols);
+  BOOST_REQUIRE_EQUAL(encoded.n_nonzero, 13);
+  CheckMatrices(arma::mat(encoded), expected);
+
+  // A value that is not a category of its dimension is an error.
+  dataset(1, 2) = 3;
+  BOOST_REQUIRE_THROW(data::OneHotEncoding(dataset, info, encoded),
+      std::invalid_argument);
+}
+
 /**
  * Test normalization of labels.
  */
@@ -983,6 +1045,39 @@ BOOST_AUTO_TEST_CASE(NormalizeLabelTest)
     BOOST_REQUIRE_EQUAL(randLabels[i], revertedLabels[i]);
 }
 
+/**
+ * Make sure integer labels are numbered in order of appearance whether they
+ * are in a small range (and a lookup table is used) or not.
+ */
+BOOST_AUTO_TEST_CASE(NormalizeLabelDenseTest)
+{
+  arma::Row<size_t> newLabels;
+  arma::Col<size_t> mappings;
+
+  arma::Row<size_t> denseLabels("5 3 5 4 3 5");
+  data::NormalizeLabels(denseLabels, newLabels, mappings);
+  CheckMatrices(mappings, arma::Col<size_t>("5 3 4"));
+  CheckMatrices(newLabels, arma::Row<size_t>("0 1 0 2 1 0"));
+
+  arma::Row<size_t> sparseLabels("5 3 5 4000000 3 5");
+  data::NormalizeLabels(sparseLabels, newLabels, mappings);
+  CheckMatrices(mappings, arma::Col<size_t>("5 3 4000000"));
+  CheckMatrices(newLabels, arma::Row<size_t>("0 1 0 2 1 0"));
+
+  arma::Row<size_t> revertedLabels;
+  data::RevertLabels(newLabels, mappings, revertedLabels);
+  CheckMatrices(revertedLabels, sparseLabels);
+
+  // Many classes in a dense range.
+  arma::Row<size_t> manyLabels(100000);
+  for (size_t i = 0; i < manyLabels.n_elem; ++i)
+    manyLabels[i] = (i * 7919) % 50000;
+  data::NormalizeLabels(manyLabels, newLabels, mappings);
+  BOOST_REQUIRE_EQUAL(mappings.n_elem, 50000);
+  data::RevertLabels(newLabels, mappings, revertedLabels);
+  CheckMatrices(revertedLabels, manyLabels);
+}
+
 // Test structures.
 class TestInner
 {
@@ -1088,6 +1183,97 @@ BOOST_AUTO_TEST_CASE(LoadTextTest)
   BOOST_REQUIRE_EQUAL(y.inb.s, x.inb.s);
 }
 
+/**
+ * Make sure we can load and save with the portable binary format, and that a
+ * corrupted or truncated file is not loaded.
+ */
+BOOST_AUTO_TEST_CASE(LoadPortableBinaryTest)
+{
+  Test x(10, -12);
+  arma::mat m(50, 100, arma::fill::randn);
+  arma::Col<size_t> v = arma::randi<arma::Col<size_t>>(100,
+      arma::distr_param(0, 1000));
+
+  BOOST_REQUIRE_EQUAL(data::Save("test.pbin", "x", x, false), true);
+  BOOST_REQUIRE_EQUAL(data::Save("test_m.pbin", "m", m, false), true);
+  BOOST_REQUIRE_EQUAL(data::Save("test_v.pbin", "v", v, false), true);
+
+  // Now reload.
+  Test y(11, 14);
+  arma::mat m2;
+  arma::Col<size_t> v2;
+
+  BOOST_REQUIRE_EQUAL(data::Load("test.pbin", "x", y, false), true);
+  BOOST_REQUIRE_EQUAL(data::Load("test_m.pbin", "m", m2, false), true);
+  BOOST_REQUIRE_EQUAL(data::Load("test_v.pbin", "v", v2, false), true);
+
+  BOOST_REQUIRE_EQUAL(y.x, x.x);
+  BOOST_REQUIRE_EQUAL(y.y, x.y);
+  BOOST_REQUIRE_EQUAL(y.ina.c, x.ina.c);
+  BOOST_REQUIRE_EQUAL(y.ina.s, x.ina.s);
+  BOOST_REQUIRE_EQUAL(y.inb.c, x.inb.c);
+  BOOST_REQUIRE_EQUAL(y.inb.s, x.inb.s);
+  CheckMatrices(m, m2);
+  CheckMatrices(arma::conv_to<arma::mat>::from(v),
+      arma::conv_to<arma::mat>::from(v2));
+
+  // Flip a bit in the middle of the matrix.
+  std::fstream f("test_m.pbin", std::ios::in | std::ios::out |
+      std::ios::binary);
+  f.seekg(0, std::ios::end);
+  const std::streamoff size = f.tellg();
+  f.seekg(size / 2);
+  char c;
+  f.get(c);
+  f.seekp(size / 2);
+  f.put(c ^ 0x10);
+  f.close();
+  BOOST_REQUIRE_EQUAL(data::Load("test_m.pbin", "m", m2, false), false);
+
+  // Truncate the file.
+  std::ifstream in("test_v.pbin", std::ios::binary);
+  std::string contents((std::istreambuf_iterator<char>(in)),
+      std::istreambuf_iterator<char>());
+  in.close();
+  std::ofstream out("test_v.pbin", std::ios::binary);
+  out.write(contents.data(), contents.size() - 4);
+  out.close();
+  BOOST_REQUIRE_EQUAL(data::Load("test_v.pbin", "v", v2, false), false);
+
+  remove("test.pbin");
+  remove("test_m.pbin");
+  remove("test_v.pbin");
+}
+
+#ifdef HAS_ZLIB
+/**
+ * Make sure we can load and save with the compressed portable binary format.
+ */
+BOOST_AUTO_TEST_CASE(LoadCompressedPortableBinaryTest)
+{
+  arma::mat m(50, 100);
+  m.fill(3.0);
+  m.col(7).randu();
+
+  BOOST_REQUIRE_EQUAL(data::Save("test.pbz", "m", m, false), true);
+  BOOST_REQUIRE_EQUAL(data::Save("test.pbin", "m", m, false), true);
+
+  // The constant matrix compresses well.
+  std::ifstream compressed("test.pbz", std::ios::binary | std::ios::ate);
+  std::ifstream uncompressed("test.pbin", std::ios::binary | std::ios::ate);
+  BOOST_REQUIRE_LT(compressed.tellg(), uncompressed.tellg() / 10);
+  compressed.close();
+  uncompressed.close();
+
+  arma::mat m2;
+  BOOST_REQUIRE_EQUAL(data::Load("test.pbz", "m", m2, false), true);
+  CheckMatrices(m, m2);
+
+  remove("test.pbz");
+  remove("test.pbin");
+}
+#endif
+
 /**
  * Test DatasetInfo by making a map for a dimension.
  */
@@ -1992,6 +2178,90 @@ BOOST_AUTO_TEST_CASE(CaseTest)
   BOOST_CHECK_EQUAL(dataset.n_cols, 3);
 }
 
+/**
+ * Load an ARFF file with sparse rows, both into a dense and a sparse matrix.
+ */
+BOOST_AUTO_TEST_CASE(SparseARFFTest)
+{
+  fstream f;
+  f.open("test.arff", fstream::out);
+  f << "@relation test" << endl;
+  f << "@attribute one numeric" << endl;
+  f << "@attribute two string" << endl;
+  f << "@attribute three numeric" << endl;
+  f << "@attribute four numeric" << endl;
+  f << "@data" << endl;
+  f << "{0 1.5, 3 -2}" << endl;
+  f << "% comment" << endl;
+  f << "{1 red, 2 3}" << endl;
+  f << "{}" << endl;
+  f << "4, 'dark blue', 0, 5 % comment" << endl;
+  f << "{ 1 \"red\" , 3 7 }" << endl;
+  f.close();
+
+  arma::mat dataset;
+  DatasetInfo info;
+  data::LoadARFF("test.arff", dataset, info);
+
+  BOOST_REQUIRE_EQUAL(info.Dimensionality(), 4);
+  BOOST_REQUIRE(info.Type(1) == Datatype::categorical);
+  BOOST_REQUIRE_EQUAL(info.NumMappings(1), 2);
+
+  BOOST_REQUIRE_EQUAL(dataset.n_rows, 4);
+  BOOST_REQUIRE_EQUAL(dataset.n_cols, 5);
+  const double red = info.MapString<double>("red", 1);
+  const double blue = info.MapString<double>("dark blue", 1);
+  arma::mat expected(4, 5, arma::fill::zeros);
+  expected(0, 0) = 1.5;
+  expected(3, 0) = -2.0;
+  expected(1, 1) = red;
+  expected(2, 1) = 3.0;
+  expected(0, 3) = 4.0;
+  expected(1, 3) = blue;
+  expected(3, 3) = 5.0;
+  expected(1, 4) = red;
+  expected(3, 4) = 7.0;
+  CheckMatrices(dataset, expected);
+
+  // The same file loaded into a sparse matrix, with the same mappings.
+  arma::sp_mat sparseDataset;
+  data::LoadARFF("test.arff", sparseDataset, info);
+  BOOST_REQUIRE_EQUAL(info.NumMappings(1), 2);
+  CheckMatrices(arma::mat(sparseDataset), expected);
+
+  remove("test.arff");
+}
+
+/**
+ * Malformed rows of an ARFF file should throw.
+ */
+BOOST_AUTO_TEST_CASE(MalformedARFFTest)
+{
+  const std::vector<std::string> rows = { "1, 2, 3", "1", "1, ?",
+      "1, abc", "{2 1}", "{1 1, 0 1}", "{0 1", "1, 'a" };
+  for (size_t i = 0; i < rows.size(); ++i)
+  {
+    fstream f;
+    f.open("test.arff", fstream::out);
+    f << "@attribute one numeric" << endl;
+    f << "@attribute two numeric" << endl;
+    f << "@data" << endl;
+    f << "1, 2" << endl;
+    f << rows[i] << endl;
+    f.close();
+
+    arma::mat dataset;
+    DatasetInfo info;
+    BOOST_REQUIRE_THROW(data::LoadARFF("test.arff", dataset, info),
+        std::runtime_error);
+    arma::sp_mat sparseDataset;
+    BOOST_REQUIRE_THROW(data::LoadARFF("test.arff", sparseDataset, info),
+        std::runtime_error);
+  }
+
+  remove("test.arff");
+}
+
 /**
  * Test that a CSV with the wrong number of columns fails.
  */
@@ -2167,4 +2437,358 @@ BOOST_AUTO_TEST_CASE(DatasetMapperNonUniqueTest)
   BOOST_REQUIRE_EQUAL(dm.UnmapString(nan, 0, 2), "cheese");
 }
 
+/**
+ * Make sure that ParseNumber() reads exactly what a stream reads.
+ */
+BOOST_AUTO_TEST_CASE(ParseNumberStreamEquivalenceTest)
+{
+  const std::vector<std::string> inputs = { "0", "-0", "+0", "1", "-1", "+12",
+      "007", "3.", ".5", "-.5", ".", "-", "+", "", "1e5", "1E-5", "1e", "1e+",
+      "2.5e+3", "0.1", "0.30000000000000004", "123456789012345678901",
+      "1e400", "1e-400", "4.9e-324", "9007199254740993",
+      "1.7976931348623157e308", "3.4028235e38", "nan", "inf", "-inf", "0x10",
+      "1,5", "1 ", " 1", "1.5.5", "abc", "18446744073709551615",
+      "18446744073709551616", "-9223372036854775808", "2147483648",
+      "-2147483649", "65536" };
+
+  for (size_t i = 0; i < inputs.size(); ++i)
+  {
+    double d1 = 0.0, d2 = 0.0;
+    BOOST_REQUIRE_EQUAL(ParseNumber(inputs[i], d1),
+        ParseNumberStream(inputs[i], d2));
+    if (ParseNumberStream(inputs[i], d2))
+      BOOST_REQUIRE_EQUAL(d1, d2);
+
+    float f1 = 0.0f, f2 = 0.0f;
+    BOOST_REQUIRE_EQUAL(ParseNumber(inputs[i], f1),
+        ParseNumberStream(inputs[i], f2));
+    if (ParseNumberStream(inputs[i], f2))
+      BOOST_REQUIRE_EQUAL(f1, f2);
+
+    size_t s1 = 0, s2 = 0;
+    BOOST_REQUIRE_EQUAL(ParseNumber(inputs[i], s1),
+        ParseNumberStream(inputs[i], s2));
+    if (ParseNumberStream(inputs[i], s2))
+      BOOST_REQUIRE_EQUAL(s1, s2);
+
+    int n1 = 0, n2 = 0;
+    BOOST_REQUIRE_EQUAL(ParseNumber(inputs[i], n1),
+        ParseNumberStream(inputs[i], n2));
+    if (ParseNumberStream(inputs[i], n2))
+      BOOST_REQUIRE_EQUAL(n1, n2);
+  }
+
+  // Random numbers printed with full precision should also match.
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    std::ostringstream oss;
+    oss << std::setprecision(math::RandInt(1, 18)) << math::Random(-1e5, 1e5);
+    double d1 = 0.0, d2 = 0.0;
+    BOOST_REQUIRE(ParseNumber(oss.str(), d1));
+    BOOST_REQUIRE(ParseNumberStream(oss.str(), d2));
+    BOOST_REQUIRE_EQUAL(d1, d2);
+  }
+}
+
+/**
+ * Make sure quoted tokens, spaces around delimiters and blank trailing lines
+ * are handled by the CSV loader.
+ */
+BOOST_AUTO_TEST_CASE(LoadCSVQuotedTokensTest)
+{
+  fstream f;
+  f.open("test.csv", fstream::out);
+  f << "1 , \"a,b\", 3\r\n";
+  f << "4,'c''d' ,6\r\n";
+  f << "  7,\"a,b\",9  \n";
+  f.close();
+
+  arma::mat dataset;
+  DatasetInfo info;
+  BOOST_REQUIRE(data::Load("test.csv", dataset, info, false, true));
+
+  BOOST_REQUIRE_EQUAL(dataset.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(dataset.n_cols, 3);
+  BOOST_REQUIRE(info.Type(0) == Datatype::numeric);
+  BOOST_REQUIRE(info.Type(1) == Datatype::categorical);
+  BOOST_REQUIRE(info.Type(2) == Datatype::numeric);
+  BOOST_REQUIRE_EQUAL(info.NumMappings(1), 2);
+
+  BOOST_REQUIRE_EQUAL(dataset(0, 0), 1);
+  BOOST_REQUIRE_EQUAL(dataset(0, 2), 7);
+  BOOST_REQUIRE_EQUAL(dataset(2, 1), 6);
+  BOOST_REQUIRE_EQUAL(dataset(1, 0), dataset(1, 2));
+  BOOST_REQUIRE_NE(dataset(1, 0), dataset(1, 1));
+  BOOST_REQUIRE_EQUAL(info.UnmapString(dataset(1, 1), 1), "'c''d'");
+
+  remove("test.csv");
+}
+
+/**
+ * Make sure that a large CSV (which is parsed in parallel) is mapped the same
+ * way as a serial load would: categories are numbered in the order in which
+ * they appear in the file, and numeric tokens in the missing set are mapped.
+ */
+BOOST_AUTO_TEST_CASE(LoadCSVLargeMappingOrderTest)
+{
+  const char* categories[] = { "c", "a", "d", "b" };
+  arma::mat expected(3, 20000);
+  fstream f;
+  f.open("test.csv", fstream::out);
+  for (size_t i = 0; i < 20000; ++i)
+  {
+    // The categories first appear in the order c, a, d, b (the last one only
+    // at the end of the file).
+    const size_t category = (i == 19999) ? 3 : (i % 3);
+    f << i << ", " << categories[category] << ", " << int(i % 7) - 1 << "\n";
+    expected(0, i) = i;
+    expected(1, i) = category;
+    expected(2, i) = (i % 7) - 1.0;
+  }
+  f.close();
+
+  arma::mat dataset;
+  DatasetInfo info;
+  BOOST_REQUIRE(data::Load("test.csv", dataset, info, false, true));
+
+  BOOST_REQUIRE(info.Type(0) == Datatype::numeric);
+  BOOST_REQUIRE(info.Type(1) == Datatype::categorical);
+  BOOST_REQUIRE(info.Type(2) == Datatype::numeric);
+  BOOST_REQUIRE_EQUAL(info.NumMappings(1), 4);
+  CheckMatrices(dataset, expected);
+  BOOST_REQUIRE_EQUAL(info.UnmapString(3, 1), "b");
+
+  // With MissingPolicy, "-1" should become NaN.
+  MissingPolicy policy({ "-1" });
+  DatasetMapper<MissingPolicy> missingInfo(policy);
+  BOOST_REQUIRE(data::Load("test.csv", dataset, missingInfo, false, true));
+
+  BOOST_REQUIRE_EQUAL(missingInfo.NumMappings(2), 1);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    if (expected(2, i) == -1.0)
+      BOOST_REQUIRE(std::isnan(dataset(2, i)));
+    else
+      BOOST_REQUIRE_EQUAL(dataset(2, i), expected(2, i));
+  }
+
+  remove("test.csv");
+}
+
+/**
+ * Save and load .npy files in both orientations, and make sure that loading
+ * with a mapping aliases the file when the orientation and type match.
+ */
+BOOST_AUTO_TEST_CASE(NPYSaveLoadTest)
+{
+  arma::mat dataset(5, 100, arma::fill::randu);
+
+  for (size_t t = 0; t < 2; ++t)
+  {
+    const bool transpose = (t == 0);
+    BOOST_REQUIRE(data::Save("test.npy", dataset, false, transpose));
+
+    // A plain load copies.
+    arma::mat loaded;
+    BOOST_REQUIRE(data::Load("test.npy", loaded, false, transpose));
+    CheckMatrices(loaded, dataset);
+
+    // A load with a mapping gives an alias of the file.
+    std::shared_ptr<util::MappedFile> mappedFile;
+    arma::mat mapped;
+    BOOST_REQUIRE(data::Load("test.npy", mapped, mappedFile, false,
+        transpose));
+    BOOST_REQUIRE(mappedFile);
+    BOOST_REQUIRE((const char*) mapped.memptr() >= mappedFile->Data());
+    BOOST_REQUIRE((const char*) mapped.memptr() <
+        mappedFile->Data() + mappedFile->Size());
+    BOOST_REQUIRE_EQUAL((size_t) mapped.memptr() % 4096, 0);
+    CheckMatrices(mapped, dataset);
+
+    // The other orientation and another element type need a copy.
+    std::shared_ptr<util::MappedFile> otherFile;
+    arma::mat other;
+    BOOST_REQUIRE(data::Load("test.npy", other, otherFile, false,
+        !transpose));
+    BOOST_REQUIRE(!otherFile);
+    CheckMatrices(other, dataset.t());
+
+    arma::fmat converted;
+    BOOST_REQUIRE(data::Load("test.npy", converted, otherFile, false,
+        transpose));
+    BOOST_REQUIRE(!otherFile);
+    CheckMatrices(arma::conv_to<arma::mat>::from(converted), dataset);
+  }
+
+  remove("test.npy");
+}
+
+/**
+ * Make sure that a .npy file as written by NumPy (C order, a 64-byte aligned
+ * header) is loaded correctly.
+ */
+BOOST_AUTO_TEST_CASE(NPYNumPyFileTest)
+{
+  // np.save("test.npy", np.array([[1, 2], [3, 4], [5, 6]], dtype=np.int32)).
+  std::string header = "{'descr': '<i4', 'fortran_order': False, "
+      "'shape': (3, 2), }";
+  header.append(64 - 10 - header.size() - 1, ' ');
+  header.push_back('\n');
+
+  fstream f;
+  f.open("test.npy", fstream::out | fstream::binary);
+  f.write("\x93NUMPY\x01\x00", 8);
+  f.put(char(header.size()));
+  f.put(0);
+  f.write(header.data(), header.size());
+  const int32_t values[] = { 1, 2, 3, 4, 5, 6 };
+  f.write((const char*) values, sizeof(values));
+  f.close();
+
+  arma::mat dataset;
+  BOOST_REQUIRE(data::Load("test.npy", dataset));
+  BOOST_REQUIRE_EQUAL(dataset.n_rows, 2);
+  BOOST_REQUIRE_EQUAL(dataset.n_cols, 3);
+  for (size_t i = 0; i < 6; ++i)
+    BOOST_REQUIRE_EQUAL(dataset[i], double(i + 1));
+
+  arma::Mat<int> intDataset;
+  std::shared_ptr<util::MappedFile> mappedFile;
+  BOOST_REQUIRE(data::Load("test.npy", intDataset, mappedFile));
+  BOOST_REQUIRE(mappedFile);
+  for (size_t i = 0; i < 6; ++i)
+    BOOST_REQUIRE_EQUAL(intDataset[i], int(i + 1));
+
+  intDataset.reset();
+  mappedFile.reset();
+  remove("test.npy");
+}
+
+/**
+ * Make sure that StreamReader gives the same points as Load(), in chunks of
+ * the right size, for text and binary files, with and without prefetching.
+ */
+BOOST_AUTO_TEST_CASE(StreamReaderTest)
+{
+  arma::mat dataset(4, 1005, arma::fill::randu);
+  BOOST_REQUIRE(data::Save("test.csv", dataset));
+  BOOST_REQUIRE(data::Save("test.npy", dataset));
+  BOOST_REQUIRE(data::Save("test.bin", dataset));
+
+  // The CSV has fewer digits than the matrix.
+  arma::mat csvDataset;
+  BOOST_REQUIRE(data::Load("test.csv", csvDataset));
+
+  const char* filenames[] = { "test.csv", "test.npy", "test.bin" };
+  for (size_t f = 0; f < 3; ++f)
+  {
+    const arma::mat& expected = (f == 0) ? csvDataset : dataset;
+    for (size_t p = 0; p < 2; ++p)
+    {
+      data::StreamReader reader(filenames[f], 100, (p == 1));
+
+      // Read everything twice, to check Reset().
+      for (size_t pass = 0; pass < 2; ++pass)
+      {
+        arma::mat chunk;
+        size_t column = 0;
+        while (reader.Next(chunk))
+        {
+          BOOST_REQUIRE_EQUAL(chunk.n_cols, std::min((size_t) 100,
+              dataset.n_cols - column));
+          CheckMatrices(chunk, expected.cols(column, column + chunk.n_cols -
+              1));
+          column += chunk.n_cols;
+        }
+
+        BOOST_REQUIRE_EQUAL(column, dataset.n_cols);
+        BOOST_REQUIRE_EQUAL(reader.PointsRead(), dataset.n_cols);
+        BOOST_REQUIRE_EQUAL(reader.Dimensionality(), dataset.n_rows);
+        BOOST_REQUIRE(!reader.Next(chunk));
+        reader.Reset();
+      }
+    }
+  }
+
+  remove("test.csv");
+  remove("test.npy");
+  remove("test.bin");
+}
+
+/**
+ * Make sure that StreamReader reports lines that cannot be parsed.
+ */
+BOOST_AUTO_TEST_CASE(StreamReaderMalformedTest)
+{
+  fstream f;
+  f.open("test.csv", fstream::out);
+  f << "1, 2, 3" << endl;
+  f << endl;
+  f << "4, 5, 6" << endl;
+  f << "7, 8" << endl;
+  f.close();
+
+  data::StreamReader reader("test.csv", 10);
+  arma::mat chunk;
+  BOOST_REQUIRE_THROW(reader.Next(chunk), std::runtime_error);
+
+  // With chunks of one point, the first two points are fine.
+  data::StreamReader smallReader("test.csv", 1, false);
+  BOOST_REQUIRE(smallReader.Next(chunk));
+  BOOST_REQUIRE(smallReader.Next(chunk));
+  BOOST_REQUIRE_EQUAL(chunk[0], 4.0);
+  BOOST_REQUIRE_THROW(smallReader.Next(chunk), std::runtime_error);
+
+  remove("test.csv");
+}
+
+/**
+ * Make sure that HashPolicy maps categorical inputs to their hashes, without
+ * storing any mappings, in both orientations.
+ */
+BOOST_AUTO_TEST_CASE(HashPolicyTest)
+{
+  fstream f;
+  f.open("test.csv", fstream::out);
+  for (size_t i = 0; i < 2000; ++i)
+    f << i << ", user" << (i * 7919) % 1500 << ", " << i % 3 << "\n";
+  f.close();
+
+  HashPolicy policy(1000);
+  DatasetMapper<HashPolicy> info(policy);
+  arma::mat dataset;
+  BOOST_REQUIRE(data::Load("test.csv", dataset, info, true, true));
+
+  BOOST_REQUIRE_EQUAL(dataset.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(dataset.n_cols, 2000);
+  BOOST_REQUIRE(info.Type(0) == Datatype::numeric);
+  BOOST_REQUIRE(info.Type(1) == Datatype::categorical);
+  BOOST_REQUIRE(info.Type(2) == Datatype::numeric);
+  BOOST_REQUIRE_EQUAL(info.NumMappings(0), 0);
+  BOOST_REQUIRE_EQUAL(info.NumMappings(1), 1000);
+
+  for (size_t i = 0; i < 2000; ++i)
+  {
+    std::ostringstream token;
+    token << "user" << (i * 7919) % 1500;
+    BOOST_REQUIRE_EQUAL(dataset(0, i), double(i));
+    BOOST_REQUIRE_EQUAL(dataset(1, i), double(info.Policy().Hash(
+        token.str())));
+    BOOST_REQUIRE_LT(dataset(1, i), 1000.0);
+    BOOST_REQUIRE_EQUAL(dataset(2, i), double(i % 3));
+  }
+
+  // Without transposing, each line is a dimension, and the number of buckets
+  // must be kept.
+  arma::mat notTransposed;
+  DatasetMapper<HashPolicy> info2(policy);
+  BOOST_REQUIRE(data::Load("test.csv", notTransposed, info2, true, false));
+  BOOST_REQUIRE_EQUAL(notTransposed.n_rows, 2000);
+  BOOST_REQUIRE(info2.Type(0) == Datatype::categorical);
+  BOOST_REQUIRE_EQUAL(info2.NumMappings(0), 1000);
+  BOOST_REQUIRE_EQUAL(notTransposed(0, 1), info2.Policy().Hash("user0"));
+
+  remove("test.csv");
+}
+
 BOOST_AUTO_TEST_SUITE_END();
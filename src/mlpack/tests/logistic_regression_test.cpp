@@ -812,6 +812,81 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionSparseSGDTest)
     BOOST_REQUIRE_CLOSE(lr.Parameters()[i], lrSparse.Parameters()[i], 1e-5);
 }
 
+/**
+ * Make sure that a sparse separable gradient holds exactly the intercept and
+ * the features that are nonzero in the batch, with the same values as the
+ * dense gradient.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionSparseSeparableGradient)
+{
+  arma::sp_mat dataset;
+  dataset.sprandu(50, 100, 0.05);
+  arma::Row<size_t> labels(100);
+  for (size_t i = 0; i < 100; ++i)
+    labels[i] = math::RandInt(0, 2);
+
+  LogisticRegressionFunction<arma::sp_mat> lrf(dataset, labels, 0.4);
+  const arma::mat parameters = arma::randu<arma::mat>(1, 51);
+
+  const size_t begin = 20, batchSize = 5;
+  arma::mat denseGradient;
+  arma::sp_mat sparseGradient;
+  lrf.Gradient(parameters, begin, denseGradient, batchSize);
+  lrf.Gradient(parameters, begin, sparseGradient, batchSize);
+
+  BOOST_REQUIRE_EQUAL(sparseGradient.n_rows, 1);
+  BOOST_REQUIRE_EQUAL(sparseGradient.n_cols, 51);
+
+  const arma::sp_mat batch = dataset.cols(begin, begin + batchSize - 1);
+  const arma::vec features = arma::sum(arma::mat(arma::abs(batch)), 1);
+  for (size_t j = 0; j < 51; ++j)
+  {
+    if (j > 0 && features[j - 1] == 0.0)
+      BOOST_REQUIRE_EQUAL((double) sparseGradient(0, j), 0.0);
+    else
+      BOOST_REQUIRE_CLOSE((double) sparseGradient(0, j), denseGradient(0, j),
+          1e-5);
+  }
+
+  // EvaluateWithGradient() should agree.
+  arma::sp_mat sparseGradient2;
+  const double objective = lrf.EvaluateWithGradient(parameters, begin,
+      sparseGradient2, batchSize);
+  BOOST_REQUIRE_CLOSE(objective, lrf.Evaluate(parameters, begin, batchSize),
+      1e-5);
+  BOOST_REQUIRE_EQUAL(sparseGradient2.n_nonzero, sparseGradient.n_nonzero);
+  BOOST_REQUIRE_SMALL(arma::accu(arma::abs(sparseGradient2 - sparseGradient)),
+      1e-10);
+}
+
+/**
+ * Make sure that the accuracy and error of a sparse model are the same as for
+ * the same dense model.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionSparseAccuracyErrorTest)
+{
+  arma::sp_mat dataset;
+  dataset.sprandu(10, 500, 0.3);
+  arma::mat denseDataset(dataset);
+  arma::Row<size_t> labels(500);
+  for (size_t i = 0; i < 500; ++i)
+    labels[i] = (denseDataset(0, i) + denseDataset(1, i) > 0.3) ? 1 : 0;
+
+  LogisticRegression<arma::sp_mat> lrSparse(dataset, labels, 0.1);
+  LogisticRegression<> lr(10, 0.1);
+  lr.Parameters() = lrSparse.Parameters();
+
+  BOOST_REQUIRE_CLOSE(lrSparse.ComputeAccuracy(dataset, labels),
+      lr.ComputeAccuracy(denseDataset, labels), 1e-5);
+  BOOST_REQUIRE_CLOSE(lrSparse.ComputeError(dataset, labels),
+      lr.ComputeError(denseDataset, labels), 1e-5);
+
+  arma::Row<size_t> predictions, densePredictions;
+  lrSparse.Classify(dataset, predictions);
+  lr.Classify(denseDataset, densePredictions);
+  BOOST_REQUIRE_EQUAL(arma::accu(predictions != densePredictions), 0);
+}
+
 /**
  * Test multi-point classification (Classify()).
  */
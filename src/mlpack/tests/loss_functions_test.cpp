@@ -21,6 +21,7 @@
 #include <mlpack/methods/ann/loss_functions/cross_entropy_error.hpp>
 #include <mlpack/methods/ann/loss_functions/reconstruction_loss.hpp>
 #include <mlpack/methods/ann/loss_functions/dice_loss.hpp>
+#include <mlpack/methods/ann/loss_functions/softmax_cross_entropy.hpp>
 #include <mlpack/methods/ann/init_rules/nguyen_widrow_init.hpp>
 #include <mlpack/methods/ann/ffn.hpp>
 
@@ -396,4 +397,81 @@ BOOST_AUTO_TEST_CASE(DiceLossTest)
   BOOST_REQUIRE_EQUAL(output.n_cols, input2.n_cols);
 }
 
+/**
+ * Check that the softmax cross entropy gives the same loss and error as a
+ * log-softmax followed by the negative log likelihood, also for large scores.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxCrossEntropyTest)
+{
+  arma::mat input = arma::randn(10, 8) * 5;
+  input.col(0) += 1000;
+  arma::mat target(1, 8);
+  for (size_t i = 0; i < target.n_cols; ++i)
+    target(i) = math::RandInt(1, 11);
+
+  double expectedLoss = 0;
+  arma::mat expectedError(input.n_rows, input.n_cols);
+  for (size_t i = 0; i < input.n_cols; ++i)
+  {
+    const double maxScore = input.col(i).max();
+    const arma::vec logProbabilities = input.col(i) - maxScore -
+        std::log(arma::accu(arma::exp(input.col(i) - maxScore)));
+    expectedLoss -= logProbabilities((size_t) target(i) - 1);
+    expectedError.col(i) = arma::exp(logProbabilities);
+    expectedError((size_t) target(i) - 1, i) -= 1;
+  }
+
+  SoftmaxCrossEntropy<> module;
+  arma::mat error;
+  const double loss = module.Forward(std::move(input), std::move(target));
+  module.Backward(std::move(input), std::move(target), std::move(error));
+
+  BOOST_REQUIRE(std::isfinite(loss));
+  BOOST_REQUIRE_CLOSE(loss, expectedLoss, 1e-5);
+  CheckMatrices(error, expectedError, 1e-5);
+}
+
+/**
+ * Check that the sampled softmax cross entropy only computes the error for the
+ * sampled and target classes, and that it matches the full softmax over those
+ * classes.
+ */
+BOOST_AUTO_TEST_CASE(SampledSoftmaxCrossEntropyTest)
+{
+  arma::mat input = arma::randn(50, 6);
+  arma::mat target(1, 6);
+  for (size_t i = 0; i < target.n_cols; ++i)
+    target(i) = math::RandInt(1, 51);
+
+  SoftmaxCrossEntropy<> module(10);
+  arma::mat error;
+  const double loss = module.Forward(std::move(input), std::move(target));
+  module.Backward(std::move(input), std::move(target), std::move(error));
+
+  const arma::Col<size_t>& sampled = module.SampledClasses();
+  BOOST_REQUIRE_EQUAL(sampled.n_elem, 10);
+  BOOST_REQUIRE_EQUAL(arma::unique(sampled).eval().n_elem, 10);
+
+  double expectedLoss = 0;
+  for (size_t i = 0; i < input.n_cols; ++i)
+  {
+    const size_t t = target(i) - 1;
+    arma::uvec classes = arma::unique(arma::join_cols(
+        arma::conv_to<arma::uvec>::from(sampled), arma::uvec({ t })));
+    arma::vec scores = input.col(i);
+    scores = scores.elem(classes);
+
+    arma::vec probabilities = arma::exp(scores - scores.max());
+    probabilities /= arma::accu(probabilities);
+    arma::vec expectedError(input.n_rows, arma::fill::zeros);
+    expectedError.elem(classes) = probabilities;
+    expectedError(t) -= 1;
+    expectedLoss -= std::log(probabilities(arma::as_scalar(
+        arma::find(classes == t))));
+
+    CheckMatrices(arma::mat(error.col(i)), expectedError, 1e-5);
+  }
+  BOOST_REQUIRE_CLOSE(loss, expectedLoss, 1e-5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -14,6 +14,7 @@
 #include "test_tools.hpp"
 
 #include <mlpack/methods/lsh/lsh_search.hpp>
+#include <mlpack/methods/lsh/simhash_search.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
 
 using namespace std;
@@ -758,6 +759,130 @@ BOOST_AUTO_TEST_CASE(EmptyConstructorTest)
   BOOST_REQUIRE_EQUAL(distances.n_rows, 3);
 }
 
+/**
+ * Test: with no bucket size limit, the second hash table must hold every point
+ * exactly once for each table, and the bucket offsets must be consistent.
+ */
+BOOST_AUTO_TEST_CASE(UnlimitedBucketSizeTest)
+{
+  const size_t numTables = 8;
+  arma::mat rdata = arma::randu<arma::mat>(4, 300);
+
+  LSHSearch<> lsh(rdata, 3, numTables, 0.0, 99901, 0);
+
+  const arma::Col<size_t>& offsets = lsh.BucketOffsets();
+  const arma::Col<size_t>& contents = lsh.BucketContents();
+  BOOST_REQUIRE_EQUAL(contents.n_elem, numTables * rdata.n_cols);
+  BOOST_REQUIRE_EQUAL(offsets[0], 0);
+  BOOST_REQUIRE_EQUAL(offsets[offsets.n_elem - 1], contents.n_elem);
+  for (size_t i = 1; i < offsets.n_elem; ++i)
+    BOOST_REQUIRE_LE(offsets[i - 1], offsets[i]);
+
+  // Each point appears once per table.
+  arma::Col<size_t> counts(rdata.n_cols, arma::fill::zeros);
+  for (size_t i = 0; i < contents.n_elem; ++i)
+    ++counts[contents[i]];
+  for (size_t i = 0; i < counts.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(counts[i], numTables);
+}
+
+/**
+ * Test: queries are hashed in batches, so the results for a query must not
+ * depend on the batch it is in.  Search with a query set larger than one batch
+ * and compare against a search with a part of that query set that starts in
+ * the middle of a batch.
+ */
+BOOST_AUTO_TEST_CASE(BatchedHashingTest)
+{
+  arma::mat rdata = arma::randu<arma::mat>(3, 1000);
+  arma::mat qdata = arma::randu<arma::mat>(3, 2500);
+
+  LSHSearch<> lsh(rdata, 4, 6);
+
+  for (size_t T = 0; T < 3; ++T)
+  {
+    arma::Mat<size_t> neighbors, subsetNeighbors;
+    arma::mat distances, subsetDistances;
+    lsh.Search(qdata, 3, neighbors, distances, 0, T);
+    lsh.Search(qdata.cols(700, 2199), 3, subsetNeighbors, subsetDistances, 0,
+        T);
+
+    CheckMatrices(neighbors.cols(700, 2199), subsetNeighbors);
+    CheckMatrices(distances.cols(700, 2199), subsetDistances);
+  }
+}
+
+/**
+ * Test: inserting points into a model must give the same results as training
+ * the model on all of the points with the same random projections.
+ */
+BOOST_AUTO_TEST_CASE(InsertTest)
+{
+  arma::mat rdata = arma::randu<arma::mat>(4, 600);
+  arma::mat qdata = arma::randu<arma::mat>(4, 100);
+
+  math::RandomSeed(1234);
+  LSHSearch<> full(rdata, 4, 8, 0.5, 99901, 0);
+
+  math::RandomSeed(1234);
+  LSHSearch<> incremental(rdata.cols(0, 399), 4, 8, 0.5, 99901, 0);
+  incremental.Insert(rdata.cols(400, 499));
+  incremental.Insert(rdata.cols(500, 599));
+
+  BOOST_REQUIRE_EQUAL(incremental.ReferenceSet().n_cols, 600);
+  BOOST_REQUIRE_EQUAL(incremental.BucketContents().n_elem,
+      full.BucketContents().n_elem);
+
+  arma::Mat<size_t> neighbors, incrementalNeighbors;
+  arma::mat distances, incrementalDistances;
+  full.Search(qdata, 3, neighbors, distances);
+  incremental.Search(qdata, 3, incrementalNeighbors, incrementalDistances);
+
+  CheckMatrices(neighbors, incrementalNeighbors);
+  CheckMatrices(distances, incrementalDistances);
+
+  // Points with the wrong dimensionality can't be inserted.
+  BOOST_REQUIRE_THROW(incremental.Insert(arma::randu<arma::mat>(3, 10)),
+      std::invalid_argument);
+}
+
+/**
+ * Test: removed points must not be returned as neighbors, and the indices of
+ * the other points must not change.
+ */
+BOOST_AUTO_TEST_CASE(RemoveTest)
+{
+  arma::mat rdata = arma::randu<arma::mat>(4, 600);
+  arma::mat qdata = arma::randu<arma::mat>(4, 100);
+
+  LSHSearch<> lsh(rdata, 4, 8, 0.5, 99901, 0);
+
+  arma::uvec removed = arma::regspace<arma::uvec>(0, 2, 598);
+  lsh.Remove(removed);
+
+  BOOST_REQUIRE_EQUAL(lsh.ReferenceSet().n_cols, 600);
+  BOOST_REQUIRE_EQUAL(lsh.BucketContents().n_elem, 8 * 300);
+  for (size_t i = 0; i < lsh.BucketContents().n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(lsh.BucketContents()[i] % 2, 1);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  lsh.Search(qdata, 3, neighbors, distances);
+  for (size_t i = 0; i < neighbors.n_elem; ++i)
+  {
+    // Unfilled results are marked with the number of reference points.
+    if (neighbors[i] < rdata.n_cols)
+    {
+      BOOST_REQUIRE_EQUAL(neighbors[i] % 2, 1);
+      const size_t q = i / neighbors.n_rows;
+      BOOST_REQUIRE_CLOSE(distances[i], arma::norm(qdata.col(q) -
+          rdata.col(neighbors[i])), 1e-5);
+    }
+  }
+
+  BOOST_REQUIRE_THROW(lsh.Remove(arma::uvec("600")), std::invalid_argument);
+}
+
 // These two tests are only compiled if the user has specified OpenMP to be
 // used.
 #ifdef HAS_OPENMP
@@ -912,4 +1037,109 @@ BOOST_AUTO_TEST_CASE(MoveOperatorTest)
   CheckMatrices(distances, distances2);
 }
 
+/**
+ * Make sure that SimHashSearch finds the exact results when every bucket is
+ * probed, and compare with brute-force cosine similarity.
+ */
+BOOST_AUTO_TEST_CASE(SimHashExactTest)
+{
+  arma::mat dataset = arma::randn<arma::mat>(10, 500);
+  arma::mat queries = arma::randn<arma::mat>(10, 50);
+
+  // With one table of 4 bits, probing 15 more buckets visits every point.
+  SimHashSearch<> simhash(dataset, 4, 1);
+  BOOST_REQUIRE_EQUAL(simhash.Codes().size(), 500);
+
+  arma::mat normalized = arma::normalise(dataset);
+  for (size_t run = 0; run < 2; ++run)
+  {
+    arma::Mat<size_t> indices;
+    arma::mat kernels;
+    arma::mat similarities;
+    if (run == 0)
+    {
+      simhash.Search(queries, 5, indices, kernels, 15);
+      similarities = arma::normalise(queries).t() * normalized;
+    }
+    else
+    {
+      simhash.Search(5, indices, kernels, 15);
+      similarities = normalized.t() * normalized;
+      // A point is never its own result.
+      similarities.diag().fill(-DBL_MAX);
+    }
+
+    BOOST_REQUIRE_EQUAL(indices.n_rows, 5);
+    BOOST_REQUIRE_EQUAL(indices.n_cols, similarities.n_rows);
+    for (size_t q = 0; q < similarities.n_rows; ++q)
+    {
+      arma::uvec order = arma::sort_index(similarities.row(q).t(),
+          "descend");
+      for (size_t i = 0; i < 5; ++i)
+      {
+        BOOST_REQUIRE_EQUAL(indices(i, q), order[i]);
+        BOOST_REQUIRE_CLOSE(kernels(i, q), similarities(q, order[i]), 1e-5);
+      }
+    }
+  }
+}
+
+/**
+ * Probing more buckets can only give better results, and reranking fewer
+ * candidates can only give worse results.
+ */
+BOOST_AUTO_TEST_CASE(SimHashMultiprobeAndCandidatesTest)
+{
+  arma::mat dataset = arma::randn<arma::mat>(20, 2000);
+  arma::mat queries = arma::randn<arma::mat>(20, 100);
+
+  SimHashSearch<> simhash(dataset, 12, 4);
+
+  arma::Mat<size_t> indices, probedIndices, filteredIndices;
+  arma::mat kernels, probedKernels, filteredKernels;
+  simhash.Search(queries, 10, indices, kernels);
+  simhash.Search(queries, 10, probedIndices, probedKernels, 20);
+  simhash.Search(queries, 10, filteredIndices, filteredKernels, 20, 30);
+
+  for (size_t i = 0; i < kernels.n_elem; ++i)
+  {
+    BOOST_REQUIRE_GE(probedKernels[i], kernels[i]);
+    BOOST_REQUIRE_LE(filteredKernels[i], probedKernels[i]);
+  }
+
+  // At least one candidate should have been found for most queries with
+  // multiprobe.
+  BOOST_REQUIRE_GT(arma::accu(probedIndices.row(0) != SIZE_MAX), 90);
+}
+
+/**
+ * Check the Hamming distance of packed codes, and that invalid parameters are
+ * rejected.
+ */
+BOOST_AUTO_TEST_CASE(SimHashParametersTest)
+{
+  const uint64_t a[2] = { 0xFFULL, 0x1ULL };
+  const uint64_t b[2] = { 0x0FULL, 0x8000000000000001ULL };
+  BOOST_REQUIRE_EQUAL(HammingDistance(a, b, 2), 5);
+  BOOST_REQUIRE_EQUAL(HammingDistance(a, a, 2), 0);
+
+  arma::mat dataset = arma::randn<arma::mat>(5, 100);
+  SimHashSearch<> simhash;
+  BOOST_REQUIRE_THROW(simhash.Train(dataset, 0, 4), std::invalid_argument);
+  BOOST_REQUIRE_THROW(simhash.Train(dataset, 65, 4), std::invalid_argument);
+  BOOST_REQUIRE_THROW(simhash.Train(dataset, 16, 4, arma::cube(5, 16, 3)),
+      std::invalid_argument);
+
+  // 64-bit codes use the whole word.
+  simhash.Train(dataset, 64, 2);
+  arma::Mat<size_t> indices;
+  arma::mat kernels;
+  simhash.Search(arma::mat(dataset.cols(0, 9)), 1, indices, kernels);
+  for (size_t i = 0; i < 10; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(indices(0, i), i);
+    BOOST_REQUIRE_CLOSE(kernels(0, i), 1.0, 1e-5);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -616,4 +616,41 @@ BOOST_AUTO_TEST_CASE(CFNeighborSearchTest)
   BOOST_REQUIRE(arma::any(arma::vectorise(output1 != output3)));
 }
 
+/**
+ * Ensure that a model can be trained on a streamed training file with every
+ * algorithm, including those that train on the coordinate list.
+ */
+BOOST_AUTO_TEST_CASE(CFTrainingFileTest)
+{
+  std::string algorithms[] = { "NMF", "RegSVD", "BiasSVD", "SVDPP" };
+
+  mat dataset;
+  data::Load("GroupLensSmall.csv", dataset);
+  const size_t userNum = max(dataset.row(0)) + 1;
+
+  for (std::string& algorithm : algorithms)
+  {
+    ResetSettings();
+    SetInputParam("training_file", std::string("GroupLensSmall.csv"));
+    SetInputParam("max_iterations", int(10));
+    SetInputParam("algorithm", algorithm);
+    SetInputParam("all_user_recommendations", true);
+
+    mlpackMain();
+
+    const Mat<size_t>& output = CLI::GetParam<Mat<size_t>>("output");
+    BOOST_REQUIRE_EQUAL(output.n_rows, 5);
+    BOOST_REQUIRE_EQUAL(output.n_cols, userNum);
+  }
+
+  // The training file can't be given with a training matrix.
+  ResetSettings();
+  SetInputParam("training", std::move(dataset));
+  SetInputParam("training_file", std::string("GroupLensSmall.csv"));
+
+  Log::Fatal.ignoreInput = true;
+  BOOST_REQUIRE_THROW(mlpackMain(), std::runtime_error);
+  Log::Fatal.ignoreInput = false;
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -394,4 +394,40 @@ BOOST_AUTO_TEST_CASE(AlgorithmsSimilarTest)
   CheckMatrices(naiveCentroid, dualCoverTreeCentroid);
 }
 
+/**
+ * Make sure that mini-batch k-means runs and checks its batch size.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchTest)
+{
+  arma::mat inputData(5, 1000, arma::fill::randu);
+
+  SetInputParam("input", inputData);
+  SetInputParam("clusters", 4);
+  SetInputParam("algorithm", std::string("mini-batch"));
+  SetInputParam("batch_size", 100);
+  SetInputParam("labels_only", true);
+
+  mlpackMain();
+
+  arma::mat output = std::move(CLI::GetParam<arma::mat>("output"));
+  arma::mat centroid = std::move(CLI::GetParam<arma::mat>("centroid"));
+  BOOST_REQUIRE_EQUAL(output.n_cols, 1000);
+  BOOST_REQUIRE_EQUAL(output.n_rows, 1);
+  BOOST_REQUIRE_EQUAL(centroid.n_cols, 4);
+  BOOST_REQUIRE_EQUAL(centroid.n_rows, 5);
+  BOOST_REQUIRE_LT(arma::max(output.row(0)), 4);
+
+  ResetKmSettings();
+
+  SetInputParam("input", std::move(inputData));
+  SetInputParam("clusters", 4);
+  SetInputParam("algorithm", std::string("mini-batch"));
+  SetInputParam("batch_size", 0);
+  SetInputParam("labels_only", true);
+
+  Log::Fatal.ignoreInput = true;
+  BOOST_REQUIRE_THROW(mlpackMain(), std::runtime_error);
+  Log::Fatal.ignoreInput = false;
+}
+
 BOOST_AUTO_TEST_SUITE_END();
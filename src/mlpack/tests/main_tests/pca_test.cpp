@@ -10,6 +10,7 @@
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
 #include <string>
+#include <fstream>
 
 #define BINDING_TYPE BINDING_TYPE_TEST
 static const std::string testName = "PrincipalComponentAnalysis";
@@ -115,4 +116,59 @@ BOOST_AUTO_TEST_CASE(PCATooHighNewDimensionalityTest)
   Log::Fatal.ignoreInput = false;
 }
 
+/**
+ * Make sure that a dataset streamed from a file with the incremental method
+ * gives the same projection as PCA on the loaded dataset.
+ */
+BOOST_AUTO_TEST_CASE(PCAInputFileTest)
+{
+  // The data has rank 2, so nothing is lost by keeping 2 components.
+  arma::mat x = arma::randn<arma::mat>(4, 2) * arma::randn<arma::mat>(2, 100);
+  x.each_col() += arma::vec("1.0 2.0 3.0 4.0");
+
+  std::ofstream stream("pca_input_file_test.csv");
+  stream.precision(17);
+  for (size_t i = 0; i < x.n_cols; ++i)
+    stream << x(0, i) << "," << x(1, i) << "," << x(2, i) << "," << x(3, i)
+        << "\n";
+  stream.close();
+
+  SetInputParam("input_file", std::string("pca_input_file_test.csv"));
+  SetInputParam("decomposition_method", std::string("incremental"));
+  SetInputParam("new_dimensionality", (int) 2);
+  SetInputParam("batch_size", (int) 16);
+
+  mlpackMain();
+
+  const arma::mat& output = CLI::GetParam<arma::mat>("output");
+  BOOST_REQUIRE_EQUAL(output.n_rows, 2);
+  BOOST_REQUIRE_EQUAL(output.n_cols, 100);
+
+  // The components may point in opposite directions.
+  pca::PCA<> p;
+  p.Apply(x, 2);
+  for (size_t i = 0; i < x.n_elem; ++i)
+  {
+    if (std::abs(x[i]) < 1e-5)
+      continue;
+
+    BOOST_REQUIRE_CLOSE(std::abs(output[i]), std::abs(x[i]), 1e-3);
+  }
+
+  remove("pca_input_file_test.csv");
+}
+
+/**
+ * Check that a file can only be streamed with the incremental method.
+ */
+BOOST_AUTO_TEST_CASE(PCAInputFileWrongMethodTest)
+{
+  SetInputParam("input_file", std::string("pca_input_file_test.csv"));
+  SetInputParam("decomposition_method", std::string("exact"));
+
+  Log::Fatal.ignoreInput = true;
+  BOOST_REQUIRE_THROW(mlpackMain(), std::runtime_error);
+  Log::Fatal.ignoreInput = false;
+}
+
 BOOST_AUTO_TEST_SUITE_END();
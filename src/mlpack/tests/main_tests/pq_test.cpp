@@ -0,0 +1,148 @@
+/**
+ * @file pq_test.cpp
+ *
+ * Test mlpackMain() of pq_main.cpp.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <string>
+
+#define BINDING_TYPE BINDING_TYPE_TEST
+static const std::string testName = "PQ";
+
+#include <mlpack/core.hpp>
+#include <mlpack/core/util/mlpack_main.hpp>
+#include "test_helper.hpp"
+#include <mlpack/methods/pq/pq_main.cpp>
+
+#include <boost/test/unit_test.hpp>
+#include "../test_tools.hpp"
+
+using namespace mlpack;
+
+struct PQTestFixture
+{
+ public:
+  PQTestFixture()
+  {
+    // Cache in the options for this program.
+    CLI::RestoreSettings(testName);
+  }
+
+  ~PQTestFixture()
+  {
+    // Clear the settings.
+    bindings::tests::CleanMemory();
+    CLI::ClearSettings();
+  }
+};
+
+BOOST_FIXTURE_TEST_SUITE(PQMainTest, PQTestFixture);
+
+/**
+ * Check that output neighbors and distances have valid dimensions, and that
+ * no point is its own neighbor when there is no query set.
+ */
+BOOST_AUTO_TEST_CASE(PQOutputDimensionTest)
+{
+  arma::mat reference = arma::randu<arma::mat>(8, 300);
+
+  SetInputParam("reference", std::move(reference));
+  SetInputParam("k", (int) 6);
+  SetInputParam("subspaces", (int) 4);
+  SetInputParam("centroids", (int) 16);
+  SetInputParam("lists", (int) 5);
+
+  mlpackMain();
+
+  const arma::Mat<size_t>& neighbors =
+      CLI::GetParam<arma::Mat<size_t>>("neighbors");
+  BOOST_REQUIRE_EQUAL(neighbors.n_rows, 6);
+  BOOST_REQUIRE_EQUAL(neighbors.n_cols, 300);
+  BOOST_REQUIRE_EQUAL(CLI::GetParam<arma::mat>("distances").n_rows, 6);
+  BOOST_REQUIRE_EQUAL(CLI::GetParam<arma::mat>("distances").n_cols, 300);
+
+  for (size_t i = 0; i < neighbors.n_cols; ++i)
+    for (size_t j = 0; j < neighbors.n_rows; ++j)
+      BOOST_REQUIRE_NE(neighbors(j, i), i);
+}
+
+/**
+ * Check that a saved model gives the same results on a query set, and that a
+ * model without a query set is rejected.
+ */
+BOOST_AUTO_TEST_CASE(PQModelReuseTest)
+{
+  arma::mat reference = arma::randu<arma::mat>(8, 300);
+  arma::mat query = arma::randu<arma::mat>(8, 40);
+
+  SetInputParam("reference", std::move(reference));
+  SetInputParam("query", query);
+  SetInputParam("k", (int) 4);
+  SetInputParam("subspaces", (int) 4);
+  SetInputParam("centroids", (int) 16);
+  SetInputParam("lists", (int) 5);
+  SetInputParam("num_probes", (int) 2);
+
+  mlpackMain();
+
+  arma::Mat<size_t> neighbors = CLI::GetParam<arma::Mat<size_t>>("neighbors");
+  arma::mat distances = CLI::GetParam<arma::mat>("distances");
+
+  CLI::GetSingleton().Parameters()["reference"].wasPassed = false;
+  SetInputParam("input_model", CLI::GetParam<PQSearch*>("output_model"));
+  SetInputParam("query", query);
+
+  mlpackMain();
+
+  CheckMatrices(neighbors, CLI::GetParam<arma::Mat<size_t>>("neighbors"));
+  CheckMatrices(distances, CLI::GetParam<arma::mat>("distances"));
+
+  // The reference points are not in the model, so a query set is needed.
+  CLI::GetSingleton().Parameters()["query"].wasPassed = false;
+
+  Log::Fatal.ignoreInput = true;
+  BOOST_REQUIRE_THROW(mlpackMain(), std::runtime_error);
+  Log::Fatal.ignoreInput = false;
+}
+
+/**
+ * Ensure that invalid parameters are rejected.
+ */
+BOOST_AUTO_TEST_CASE(PQParamValidityTest)
+{
+  arma::mat reference = arma::randu<arma::mat>(4, 100);
+
+  SetInputParam("reference", reference);
+  SetInputParam("k", (int) 6);
+
+  // The default 8 subspaces are more than the dimensionality.
+  Log::Fatal.ignoreInput = true;
+  BOOST_REQUIRE_THROW(mlpackMain(), std::runtime_error);
+
+  SetInputParam("reference", reference);
+  SetInputParam("subspaces", (int) 2);
+  SetInputParam("centroids", (int) 300);
+  BOOST_REQUIRE_THROW(mlpackMain(), std::runtime_error);
+
+  // More centroids than points.
+  SetInputParam("reference", reference);
+  SetInputParam("centroids", (int) 101);
+  BOOST_REQUIRE_THROW(mlpackMain(), std::runtime_error);
+
+  SetInputParam("reference", reference);
+  SetInputParam("centroids", (int) 16);
+  SetInputParam("num_probes", (int) 0);
+  BOOST_REQUIRE_THROW(mlpackMain(), std::runtime_error);
+
+  SetInputParam("reference", std::move(reference));
+  SetInputParam("num_probes", (int) 1);
+  SetInputParam("k", (int) 100);
+  BOOST_REQUIRE_THROW(mlpackMain(), std::runtime_error);
+  Log::Fatal.ignoreInput = false;
+}
+
+BOOST_AUTO_TEST_SUITE_END();
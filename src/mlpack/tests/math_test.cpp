@@ -12,6 +12,7 @@
 #include <mlpack/core/math/clamp.hpp>
 #include <mlpack/core/math/random.hpp>
 #include <mlpack/core/math/range.hpp>
+#include <mlpack/core/math/running_moments.hpp>
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 
@@ -1009,4 +1010,128 @@ BOOST_AUTO_TEST_CASE(InplaceSparseShuffleWeightsTest)
   }
 }
 
+/**
+ * Make sure the Philox generator gives the same numbers for the same seed and
+ * stream, different numbers for different streams, and skips correctly.
+ */
+BOOST_AUTO_TEST_CASE(PhiloxEngineTest)
+{
+  PhiloxEngine a(42, 3), b(42, 3), c(42, 4);
+  std::vector<uint32_t> numbers(103);
+  size_t same = 0;
+  for (size_t i = 0; i < numbers.size(); ++i)
+  {
+    numbers[i] = a();
+    BOOST_REQUIRE_EQUAL(numbers[i], b());
+    if (numbers[i] == c())
+      ++same;
+  }
+  BOOST_REQUIRE_LT(same, 3);
+
+  // Skipping to any position gives the same numbers as drawing up to it.
+  for (size_t skip = 0; skip < 10; ++skip)
+  {
+    PhiloxEngine d(42, 3);
+    d();
+    d.discard(skip);
+    BOOST_REQUIRE_EQUAL(d(), numbers[skip + 1]);
+  }
+
+  // The numbers should be uniform.
+  PhiloxEngine e(7);
+  std::uniform_real_distribution<> uniform;
+  double sum = 0.0;
+  for (size_t i = 0; i < 100000; ++i)
+    sum += uniform(e);
+  BOOST_REQUIRE_CLOSE(sum / 100000, 0.5, 1.0);
+}
+
+/**
+ * Make sure that random numbers drawn in a parallel region are the same for
+ * the same seed (and number of threads).
+ */
+BOOST_AUTO_TEST_CASE(ThreadRandomStreamTest)
+{
+  arma::mat results[2];
+  for (size_t r = 0; r < 2; ++r)
+  {
+    RandomSeed(12);
+    results[r].set_size(3, 1000);
+    #pragma omp parallel for schedule(static) num_threads(4)
+    for (omp_size_t i = 0; i < 1000; ++i)
+    {
+      results[r](0, i) = Random();
+      results[r](1, i) = RandInt(1000);
+      results[r](2, i) = RandNormal();
+    }
+  }
+
+  CheckMatrices(results[0], results[1]);
+  BOOST_REQUIRE_GT(arma::accu(results[0].row(0)), 450);
+  BOOST_REQUIRE_LT(arma::accu(results[0].row(0)), 550);
+
+  // The threads must not draw the same numbers.
+  const arma::rowvec unique = arma::unique(results[0].row(0));
+  BOOST_REQUIRE_EQUAL(unique.n_elem, 1000);
+}
+
+/**
+ * Make sure that the moments accumulated from chunks of points are the moments
+ * of all of the points.
+ */
+BOOST_AUTO_TEST_CASE(RunningMomentsTest)
+{
+  arma::mat points(4, 10000);
+  points.randn();
+  points.row(1) = arma::exp(points.row(1)); // Skewed.
+  points.row(2) += 1e6; // Large mean.
+
+  // Chunks smaller and larger than a block.
+  RunningMoments moments;
+  moments.Add(points.cols(0, 99));
+  moments.Add(points.cols(100, 5099));
+  moments.Add(points.cols(5100, 5100));
+  moments.Add(points.cols(5101, 9999));
+  BOOST_REQUIRE_EQUAL(moments.Count(), 10000);
+
+  const arma::vec mean = arma::mean(points, 1);
+  const arma::mat deviations = points.each_col() - mean;
+  for (size_t d = 0; d < 4; ++d)
+  {
+    BOOST_REQUIRE_CLOSE(moments.Mean()[d], mean[d], 1e-8);
+    BOOST_REQUIRE_EQUAL(moments.Min()[d], points.row(d).min());
+    BOOST_REQUIRE_EQUAL(moments.Max()[d], points.row(d).max());
+    BOOST_REQUIRE_CLOSE(moments.M2()[d],
+        arma::accu(arma::pow(deviations.row(d), 2)), 1e-6);
+    // The third moment may be close to zero, so compare it on the scale of
+    // the second moment.
+    BOOST_REQUIRE_SMALL(moments.M3()[d] -
+        arma::accu(arma::pow(deviations.row(d), 3)),
+        1e-8 * std::pow(moments.M2()[d], 1.5));
+    BOOST_REQUIRE_CLOSE(moments.M4()[d],
+        arma::accu(arma::pow(deviations.row(d), 4)), 1e-6);
+    BOOST_REQUIRE_CLOSE(moments.Variance()[d], arma::var(points.row(d)),
+        1e-6);
+    BOOST_REQUIRE_CLOSE(moments.Variance(true)[d],
+        arma::var(points.row(d), 1), 1e-6);
+  }
+
+  // Merging the moments of two halves gives the same moments.
+  RunningMoments first, second;
+  first.Add(points.cols(0, 4999));
+  second.Add(points.cols(5000, 9999));
+  first.Merge(second);
+  BOOST_REQUIRE_EQUAL(first.Count(), 10000);
+  for (size_t d = 0; d < 4; ++d)
+  {
+    BOOST_REQUIRE_CLOSE(first.Mean()[d], moments.Mean()[d], 1e-8);
+    BOOST_REQUIRE_CLOSE(first.M2()[d], moments.M2()[d], 1e-6);
+    BOOST_REQUIRE_CLOSE(first.M4()[d], moments.M4()[d], 1e-6);
+  }
+
+  // Points of another dimensionality can't be added.
+  BOOST_REQUIRE_THROW(moments.Add(arma::mat(3, 10, arma::fill::randu)),
+      std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
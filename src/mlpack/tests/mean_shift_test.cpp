@@ -165,4 +165,42 @@ BOOST_AUTO_TEST_CASE(GaussianClustering)
   BOOST_REQUIRE_EQUAL(success, true);
 }
 
+// Make sure that batch mode finds the same clusters as shifting each seed on
+// its own, with and without a kernel.
+BOOST_AUTO_TEST_CASE(MeanShiftBatchModeTest)
+{
+  GaussianDistribution g1("0.0 0.0 0.0", arma::eye<arma::mat>(3, 3));
+  GaussianDistribution g2("6.0 6.0 6.0", arma::eye<arma::mat>(3, 3));
+
+  arma::mat dataset(3, 1000);
+  for (size_t i = 0; i < 500; ++i)
+    dataset.col(i) = g1.Random();
+  for (size_t i = 500; i < 1000; ++i)
+    dataset.col(i) = g2.Random();
+
+  MeanShift<> meanShift(2.5);
+  arma::Row<size_t> assignments, batchAssignments;
+  arma::mat centroids, batchCentroids;
+  meanShift.Cluster(dataset, assignments, centroids);
+  meanShift.Cluster(dataset, batchAssignments, batchCentroids, true, true,
+      true);
+
+  BOOST_REQUIRE_EQUAL(centroids.n_cols, batchCentroids.n_cols);
+  for (size_t i = 0; i < centroids.n_elem; ++i)
+    BOOST_REQUIRE_SMALL(centroids[i] - batchCentroids[i], 0.01);
+  for (size_t i = 0; i < assignments.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], batchAssignments[i]);
+
+  MeanShift<true> kernelMeanShift(2.5);
+  centroids.clear();
+  batchCentroids.clear();
+  kernelMeanShift.Cluster(dataset, assignments, centroids, false, false);
+  kernelMeanShift.Cluster(dataset, batchAssignments, batchCentroids, false,
+      false, true);
+
+  BOOST_REQUIRE_EQUAL(centroids.n_cols, batchCentroids.n_cols);
+  for (size_t i = 0; i < centroids.n_elem; ++i)
+    BOOST_REQUIRE_SMALL(centroids[i] - batchCentroids[i], 0.01);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -87,4 +87,48 @@ BOOST_AUTO_TEST_CASE(LINFMetricTest)
                       lMetric.Evaluate(a2, b2), 1e-5);
 }
 
+/**
+ * Make sure that the block evaluation of the L2 metrics is within the returned
+ * error bound of the pairwise evaluation, and that other metrics give exactly
+ * the same results.
+ */
+BOOST_AUTO_TEST_CASE(LMetricEvaluateBlockTest)
+{
+  arma::mat a(10, 30, arma::fill::randn);
+  arma::mat b(10, 20, arma::fill::randn);
+  // Include a duplicate point, whose distance should not become negative.
+  b.col(5) = a.col(3);
+
+  arma::mat distances;
+  double error = EuclideanDistance::EvaluateBlock(a, b, distances);
+  BOOST_REQUIRE_EQUAL(distances.n_rows, a.n_cols);
+  BOOST_REQUIRE_EQUAL(distances.n_cols, b.n_cols);
+  for (size_t j = 0; j < b.n_cols; ++j)
+  {
+    for (size_t i = 0; i < a.n_cols; ++i)
+    {
+      BOOST_REQUIRE_SMALL(distances(i, j) -
+          EuclideanDistance::Evaluate(a.col(i), b.col(j)), error);
+    }
+  }
+  BOOST_REQUIRE_GE(distances(3, 5), 0.0);
+
+  error = SquaredEuclideanDistance::EvaluateBlock(a, b, distances);
+  for (size_t j = 0; j < b.n_cols; ++j)
+  {
+    for (size_t i = 0; i < a.n_cols; ++i)
+    {
+      BOOST_REQUIRE_SMALL(distances(i, j) -
+          SquaredEuclideanDistance::Evaluate(a.col(i), b.col(j)), error);
+    }
+  }
+
+  error = ManhattanDistance::EvaluateBlock(a, b, distances);
+  BOOST_REQUIRE_EQUAL(error, 0.0);
+  for (size_t j = 0; j < b.n_cols; ++j)
+    for (size_t i = 0; i < a.n_cols; ++i)
+      BOOST_REQUIRE_EQUAL(distances(i, j),
+          ManhattanDistance::Evaluate(a.col(i), b.col(j)));
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -314,4 +314,148 @@ BOOST_AUTO_TEST_CASE(SeparateTrainIndividualIncrementalTest)
   }
 }
 
+/**
+ * Make sure that training incrementally on several batches gives the same
+ * model as training on all of the data at once.
+ */
+BOOST_AUTO_TEST_CASE(SeparateTrainBatchIncrementalTest)
+{
+  const char* trainFilename = "trainSet.csv";
+  size_t classes = 2;
+
+  arma::mat trainData;
+  data::Load(trainFilename, trainData, true);
+
+  // Get the labels out.
+  arma::Row<size_t> labels(trainData.n_cols);
+  for (size_t i = 0; i < trainData.n_cols; ++i)
+    labels[i] = trainData(trainData.n_rows - 1, i);
+  trainData.shed_row(trainData.n_rows - 1);
+
+  NaiveBayesClassifier<> nbc(trainData, labels, classes, false);
+
+  // Train on uneven batches, with the first point alone.
+  NaiveBayesClassifier<> nbcTrain(trainData.n_rows, classes);
+  const size_t splits[] = { 0, 1, trainData.n_cols / 3, trainData.n_cols };
+  for (size_t i = 0; i < 3; ++i)
+  {
+    nbcTrain.Train(trainData.cols(splits[i], splits[i + 1] - 1),
+        labels.subvec(splits[i], splits[i + 1] - 1), classes, true);
+  }
+
+  BOOST_REQUIRE_EQUAL(nbc.Means().n_elem, nbcTrain.Means().n_elem);
+  BOOST_REQUIRE_EQUAL(nbc.Variances().n_elem, nbcTrain.Variances().n_elem);
+  BOOST_REQUIRE_EQUAL(nbc.Probabilities().n_elem,
+                      nbcTrain.Probabilities().n_elem);
+
+  for (size_t i = 0; i < nbc.Means().n_elem; ++i)
+  {
+    if (std::abs(nbc.Means()[i]) < 1e-5)
+      BOOST_REQUIRE_SMALL(nbcTrain.Means()[i], 1e-5);
+    else
+      BOOST_REQUIRE_CLOSE(nbc.Means()[i], nbcTrain.Means()[i], 1e-5);
+  }
+
+  for (size_t i = 0; i < nbc.Variances().n_elem; ++i)
+  {
+    if (std::abs(nbc.Variances()[i]) < 1e-5)
+      BOOST_REQUIRE_SMALL(nbcTrain.Variances()[i], 1e-5);
+    else
+      BOOST_REQUIRE_CLOSE(nbc.Variances()[i], nbcTrain.Variances()[i], 1e-5);
+  }
+
+  for (size_t i = 0; i < nbc.Probabilities().n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(nbc.Probabilities()[i], nbcTrain.Probabilities()[i],
+        1e-5);
+}
+
+/**
+ * Make sure that the class probabilities computed for many points at once
+ * match a direct computation, also when a feature has zero variance.
+ */
+BOOST_AUTO_TEST_CASE(NaiveBayesClassifierBatchProbabilitiesTest)
+{
+  arma::mat data(4, 300, arma::fill::randn);
+  arma::Row<size_t> labels(300);
+  for (size_t i = 0; i < 300; ++i)
+  {
+    labels[i] = i % 3;
+    data.col(i) += 2.0 * labels[i];
+    // The last feature is constant for the first class.
+    if (labels[i] == 0)
+      data(3, i) = 0.5;
+  }
+
+  NaiveBayesClassifier<> nbc(data, labels, 3);
+
+  arma::mat testData(4, 50, arma::fill::randn);
+  testData.submat(3, 0, 3, 24).fill(0.5);
+
+  arma::Row<size_t> predictions;
+  arma::mat probabilities;
+  nbc.Classify(testData, predictions, probabilities);
+
+  BOOST_REQUIRE_EQUAL(probabilities.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(probabilities.n_cols, 50);
+
+  for (size_t j = 0; j < testData.n_cols; ++j)
+  {
+    arma::vec logLikelihoods(3);
+    for (size_t k = 0; k < 3; ++k)
+    {
+      logLikelihoods[k] = std::log(nbc.Probabilities()[k]);
+      for (size_t i = 0; i < testData.n_rows; ++i)
+      {
+        const double var = nbc.Variances()(i, k);
+        const double diff = testData(i, j) - nbc.Means()(i, k);
+        logLikelihoods[k] -= 0.5 * (std::log(2 * M_PI * var) +
+            diff * diff / var);
+      }
+    }
+
+    const arma::vec expected = arma::exp(logLikelihoods -
+        logLikelihoods.max()) / arma::accu(arma::exp(logLikelihoods -
+        logLikelihoods.max()));
+    BOOST_REQUIRE_EQUAL(predictions[j], logLikelihoods.index_max());
+    for (size_t k = 0; k < 3; ++k)
+    {
+      if (expected[k] < 1e-5)
+        BOOST_REQUIRE_SMALL(probabilities(k, j), 1e-5);
+      else
+        BOOST_REQUIRE_CLOSE(probabilities(k, j), expected[k], 1e-5);
+    }
+  }
+}
+
+/**
+ * Training on a stream should give the same model as training on the whole
+ * dataset.
+ */
+BOOST_AUTO_TEST_CASE(StreamTrainTest)
+{
+  arma::mat data(3, 500, arma::fill::randn);
+  arma::Row<size_t> labels(500);
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    labels[i] = i % 3;
+    data.col(i) += 2.0 * labels[i];
+  }
+
+  // The labels go in the last dimension.
+  arma::mat dataset = arma::join_cols(data,
+      arma::conv_to<arma::rowvec>::from(labels));
+  data::Save("nbc_stream.npy", dataset);
+
+  NaiveBayesClassifier<> nbc(data, labels, 3);
+  NaiveBayesClassifier<> streamNbc;
+  data::StreamReader reader("nbc_stream.npy", 64);
+  streamNbc.Train(reader, 3);
+
+  CheckMatrices(streamNbc.Means(), nbc.Means());
+  CheckMatrices(streamNbc.Variances(), nbc.Variances());
+  CheckMatrices(streamNbc.Probabilities(), nbc.Probabilities());
+
+  remove("nbc_stream.npy");
+}
+
 BOOST_AUTO_TEST_SUITE_END();
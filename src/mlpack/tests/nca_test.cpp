@@ -249,6 +249,69 @@ BOOST_AUTO_TEST_CASE(SoftmaxSeparableGradient)
   BOOST_REQUIRE_CLOSE(gradient(1, 1), -2.0 * -0.1435886, 0.01);
 }
 
+/**
+ * Ignoring the terms of the softmax below a tiny tolerance should give the same
+ * objective and gradient as using every term, both for the whole dataset and
+ * for batches.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxToleranceTest)
+{
+  arma::mat data = 4.0 * arma::randu<arma::mat>(3, 300);
+  arma::Row<size_t> labels(300);
+  for (size_t i = 0; i < 300; ++i)
+    labels[i] = (data(0, i) > 2.0) ? 1 : 0;
+
+  const arma::mat coordinates = arma::eye<arma::mat>(3, 3) +
+      0.1 * arma::randu<arma::mat>(3, 3);
+
+  SoftmaxErrorFunction<SquaredEuclideanDistance> sef(data, labels);
+  SoftmaxErrorFunction<SquaredEuclideanDistance> treeSef(data, labels,
+      SquaredEuclideanDistance(), 1e-12);
+
+  const double objective = sef.Evaluate(coordinates);
+  BOOST_REQUIRE_CLOSE(treeSef.Evaluate(coordinates), objective, 1e-5);
+
+  arma::mat gradient, treeGradient;
+  sef.Gradient(coordinates, gradient);
+  treeSef.Gradient(coordinates, treeGradient);
+  for (size_t i = 0; i < gradient.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(treeGradient[i], gradient[i], 1e-5);
+
+  // The batches should add up to the whole objective and gradient.
+  double batchObjective = 0.0, treeBatchObjective = 0.0;
+  arma::mat batchGradient(3, 3, arma::fill::zeros);
+  arma::mat treeBatchGradient(3, 3, arma::fill::zeros);
+  for (size_t begin = 0; begin < 300; begin += 100)
+  {
+    batchObjective += sef.Evaluate(coordinates, begin, 100);
+    treeBatchObjective += treeSef.Evaluate(coordinates, begin, 100);
+
+    sef.Gradient(coordinates, begin, gradient, 100);
+    batchGradient += gradient;
+    treeSef.Gradient(coordinates, begin, treeGradient, 100);
+    treeBatchGradient += treeGradient;
+  }
+
+  BOOST_REQUIRE_CLOSE(batchObjective, objective, 1e-5);
+  BOOST_REQUIRE_CLOSE(treeBatchObjective, objective, 1e-5);
+  sef.Gradient(coordinates, gradient);
+  for (size_t i = 0; i < gradient.n_elem; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(batchGradient[i], gradient[i], 1e-5);
+    BOOST_REQUIRE_CLOSE(treeBatchGradient[i], gradient[i], 1e-5);
+  }
+
+  // The tree can also be used with the Euclidean distance.
+  SoftmaxErrorFunction<EuclideanDistance> euclideanSef(data, labels);
+  SoftmaxErrorFunction<EuclideanDistance> euclideanTreeSef(data, labels,
+      EuclideanDistance(), 1e-12);
+  BOOST_REQUIRE_CLOSE(euclideanTreeSef.Evaluate(coordinates, 0, 300),
+      euclideanSef.Evaluate(coordinates, 0, 300), 1e-5);
+
+  BOOST_REQUIRE_THROW(SoftmaxErrorFunction<>(data, labels,
+      SquaredEuclideanDistance(), 1.0), std::invalid_argument);
+}
+
 //
 // Tests for the NCA algorithm.
 //
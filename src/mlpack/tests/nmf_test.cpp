@@ -16,6 +16,8 @@
 #include <mlpack/methods/amf/update_rules/nmf_mult_div.hpp>
 #include <mlpack/methods/amf/update_rules/nmf_als.hpp>
 #include <mlpack/methods/amf/update_rules/nmf_mult_dist.hpp>
+#include <mlpack/methods/amf/update_rules/sparse_als.hpp>
+#include <mlpack/methods/amf/termination_policies/max_iteration_termination.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -233,6 +235,31 @@ BOOST_AUTO_TEST_CASE(SparseNMFALSTest)
       1e-5);
 }
 
+/**
+ * Make sure that the sparse divergence update, which only computes the ratios
+ * at the nonzero elements, gives the same result as the dense update.
+ */
+BOOST_AUTO_TEST_CASE(SparseNMFDivUpdateTest)
+{
+  sp_mat v;
+  v.sprandu(30, 25, 0.2);
+  const mat dv(v);
+
+  // W and H are positive, so W * H has no zeros.
+  const mat w = randu<mat>(30, 4) + 0.1;
+  const mat h = randu<mat>(4, 25) + 0.1;
+
+  mat sw(w), dw(w);
+  NMFMultiplicativeDivergenceUpdate::WUpdate(v, sw, h);
+  NMFMultiplicativeDivergenceUpdate::WUpdate(dv, dw, h);
+  CheckMatrices(sw, dw, 1e-5);
+
+  mat sh(h), dh(h);
+  NMFMultiplicativeDivergenceUpdate::HUpdate(v, sw, sh);
+  NMFMultiplicativeDivergenceUpdate::HUpdate(dv, dw, dh);
+  CheckMatrices(sh, dh, 1e-5);
+}
+
 /**
  * Check if all elements in W and H are non-negative.
  * Default Case.
@@ -295,4 +322,84 @@ BOOST_AUTO_TEST_CASE(NonNegNMFALSTest)
       && arma::all(arma::vectorise(h) >= 0));
 }
 
+/**
+ * Make sure that the sparse ALS update rule recovers a low-rank matrix from
+ * some of its elements: the observed elements should be fit closely, and the
+ * others should be predicted reasonably well.
+ */
+BOOST_AUTO_TEST_CASE(SparseALSUpdateTest)
+{
+  mat w = randu<mat>(40, 3);
+  mat h = randu<mat>(3, 40);
+  const mat v = w * h;
+  const size_t r = 3;
+
+  // Observe about half of the elements, and at least one in every row and
+  // column.
+  sp_mat observed(40, 40);
+  for (size_t i = 0; i < 40; ++i)
+  {
+    for (size_t j = 0; j < 40; ++j)
+    {
+      if (i == j || math::Random() < 0.5)
+        observed(i, j) = v(i, j);
+    }
+  }
+
+  MaxIterationTermination mit(50);
+  AMF<MaxIterationTermination, RandomInitialization, SparseALSUpdate> als(mit,
+      RandomInitialization(), SparseALSUpdate(1e-6));
+  als.Apply(observed, r, w, h);
+
+  const mat wh = w * h;
+  double observedError = 0.0;
+  for (sp_mat::const_iterator it = observed.begin(); it != observed.end();
+      ++it)
+  {
+    observedError += std::pow(*it - wh(it.row(), it.col()), 2.0);
+  }
+
+  BOOST_REQUIRE_SMALL(std::sqrt(observedError) / arma::norm(observed, "fro"),
+      1e-3);
+  BOOST_REQUIRE_SMALL(arma::norm(v - wh, "fro") / arma::norm(v, "fro"), 0.05);
+}
+
+/**
+ * With implicit feedback, the elements that were observed should be predicted
+ * to be preferred over the elements that were not.
+ */
+BOOST_AUTO_TEST_CASE(SparseALSUpdateImplicitTest)
+{
+  // Two groups of rows, each of which only interacts with its own group of
+  // columns.
+  sp_mat v(20, 20);
+  for (size_t i = 0; i < 20; ++i)
+  {
+    for (size_t j = 0; j < 20; ++j)
+    {
+      if ((i < 10) == (j < 10) && math::Random() < 0.7)
+        v(i, j) = 1.0 + math::RandInt(5);
+    }
+    v(i, i) = 1.0;
+  }
+
+  mat w, h;
+  MaxIterationTermination mit(20);
+  AMF<MaxIterationTermination, RandomInitialization, SparseALSUpdate> als(mit,
+      RandomInitialization(), SparseALSUpdate(0.1, true, 10.0));
+  als.Apply(v, 2, w, h);
+
+  const mat wh = w * h;
+  for (size_t i = 0; i < 20; ++i)
+  {
+    for (size_t j = 0; j < 20; ++j)
+    {
+      if ((i < 10) == (j < 10))
+        BOOST_REQUIRE_GT(wh(i, j), 0.5);
+      else
+        BOOST_REQUIRE_LT(wh(i, j), 0.5);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
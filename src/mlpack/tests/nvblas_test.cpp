@@ -0,0 +1,131 @@
+/**
+ * @file nvblas_test.cpp
+ *
+ * Make sure that the large matrix products of mlpack run on the GPU when NVBLAS
+ * is linked.  This test is only built with USE_NVBLAS, and is run with an
+ * nvblas.conf (given by NVBLAS_CONFIG_FILE) that logs every call NVBLAS
+ * intercepts; the test reads back the log to see where the calls ran.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+#include <mlpack/methods/ann/layer/layer.hpp>
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include <boost/test/unit_test.hpp>
+#include "test_tools.hpp"
+
+using namespace mlpack;
+using namespace mlpack::neighbor;
+using namespace mlpack::ann;
+
+/**
+ * Get the name of the log file from the nvblas.conf given by
+ * NVBLAS_CONFIG_FILE, or an empty string if there is none.
+ */
+std::string NVBLASLogFile()
+{
+  const char* configFile = std::getenv("NVBLAS_CONFIG_FILE");
+  if (!configFile)
+    return "";
+
+  std::ifstream config(configFile);
+  std::string line;
+  while (std::getline(config, line))
+  {
+    std::istringstream tokens(line);
+    std::string key, value;
+    tokens >> key >> value;
+    if (key == "NVBLAS_LOGFILE")
+      return value;
+  }
+
+  return "";
+}
+
+//! Get the size of the given file, or 0 if it does not exist.
+std::streamoff FileSize(const std::string& filename)
+{
+  std::ifstream f(filename, std::ios::binary | std::ios::ate);
+  return f ? (std::streamoff) f.tellg() : 0;
+}
+
+//! Count the lines of the given file after the given offset that contain the
+//! given string.
+size_t CountLogLines(const std::string& filename,
+                     const std::streamoff offset,
+                     const std::string& pattern)
+{
+  std::ifstream f(filename);
+  f.seekg(offset);
+  size_t count = 0;
+  std::string line;
+  while (std::getline(f, line))
+    if (line.find(pattern) != std::string::npos)
+      ++count;
+
+  return count;
+}
+
+BOOST_AUTO_TEST_SUITE(NVBLASTest);
+
+/**
+ * The distance products of BLOCKED_NAIVE_MODE must run on the GPU, and give
+ * the same results as the naive search.
+ */
+BOOST_AUTO_TEST_CASE(NVBLASBlockedNaiveSearchTest)
+{
+  const std::string logFile = NVBLASLogFile();
+  BOOST_REQUIRE(!logFile.empty());
+
+  arma::mat referenceSet(32, 20000, arma::fill::randu);
+  arma::mat querySet(32, 4096, arma::fill::randu);
+
+  const std::streamoff offset = FileSize(logFile);
+  KNN blocked(referenceSet, BLOCKED_NAIVE_MODE);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  blocked.Search(querySet, 5, neighbors, distances);
+
+  BOOST_REQUIRE_GT(CountLogLines(logFile, offset, "dgemm[gpu]"), 0);
+
+  KNN naive(referenceSet, NAIVE_MODE);
+  arma::Mat<size_t> naiveNeighbors;
+  arma::mat naiveDistances;
+  naive.Search(querySet, 5, naiveNeighbors, naiveDistances);
+
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances, 1e-5);
+}
+
+/**
+ * The forward and backward products of a large Linear layer must run on the
+ * GPU.
+ */
+BOOST_AUTO_TEST_CASE(NVBLASLinearLayerTest)
+{
+  const std::string logFile = NVBLASLogFile();
+  BOOST_REQUIRE(!logFile.empty());
+
+  Linear<> module(2048, 2048);
+  module.Parameters().randu();
+  module.Reset();
+
+  arma::mat input(2048, 2048, arma::fill::randu), output, delta;
+  const std::streamoff offset = FileSize(logFile);
+  module.Forward(std::move(input), std::move(output));
+  BOOST_REQUIRE_GT(CountLogLines(logFile, offset, "dgemm[gpu]"), 0);
+
+  const std::streamoff backwardOffset = FileSize(logFile);
+  module.Backward(std::move(input), std::move(output), std::move(delta));
+  BOOST_REQUIRE_GT(CountLogLines(logFile, backwardOffset, "dgemm[gpu]"), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
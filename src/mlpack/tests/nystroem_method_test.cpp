@@ -202,4 +202,51 @@ BOOST_AUTO_TEST_CASE(GermanTest)
   }
 }
 
+/**
+ * Make sure that the points selected by mini-batch k-means give a good
+ * approximation, and that building the kernel matrix in blocks gives the same
+ * result as building it whole.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchKMeansSelectionTest)
+{
+  // More points than a block, so that Apply() uses several blocks.
+  arma::mat dataset(5, 5000, arma::fill::randu);
+  GaussianKernel gk(1.0);
+
+  const size_t rank = 50;
+  NystroemMethod<GaussianKernel, MiniBatchKMeansSelection<> > nm(dataset, gk,
+      rank);
+  arma::mat g;
+  nm.Apply(g);
+  BOOST_REQUIRE_EQUAL(g.n_rows, dataset.n_cols);
+  BOOST_REQUIRE_EQUAL(g.n_cols, rank);
+
+  // Compare a sample of the approximated kernel matrix with the true one.
+  for (size_t i = 0; i < 50; ++i)
+  {
+    const size_t a = math::RandInt(dataset.n_cols);
+    const size_t b = math::RandInt(dataset.n_cols);
+    const double approximation = arma::dot(g.row(a), g.row(b));
+    BOOST_REQUIRE_SMALL(approximation - gk.Evaluate(dataset.col(a),
+        dataset.col(b)), 0.05);
+  }
+
+  // The blocked output must match the whole semi-kernel matrix times the
+  // transformation.
+  NystroemMethod<GaussianKernel, OrderedSelection> ordered(dataset, gk, rank);
+  arma::mat orderedG;
+  ordered.Apply(orderedG);
+
+  arma::mat miniKernel, semiKernel;
+  ordered.GetKernelMatrix(OrderedSelection::Select(dataset, rank), miniKernel,
+      semiKernel);
+  arma::mat U, V;
+  arma::vec s;
+  arma::svd(U, s, V, miniKernel);
+  const arma::mat expected = semiKernel * U * arma::diagmat(1.0 / sqrt(s)) * V;
+
+  for (size_t i = 0; i < expected.n_elem; ++i)
+    BOOST_REQUIRE_SMALL(orderedG[i] - expected[i], 1e-8);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
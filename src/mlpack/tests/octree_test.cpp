@@ -11,6 +11,8 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/core/tree/octree.hpp>
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+#include <mlpack/methods/range_search/range_search.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -21,6 +23,8 @@ using namespace mlpack::math;
 using namespace mlpack::tree;
 using namespace mlpack::metric;
 using namespace mlpack::bound;
+using namespace mlpack::neighbor;
+using namespace mlpack::range;
 
 BOOST_AUTO_TEST_SUITE(OctreeTest);
 
@@ -346,4 +350,79 @@ BOOST_AUTO_TEST_CASE(SerializationTest)
   delete textTree;
 }
 
+/**
+ * Make sure the Octree3D gives the same search results as the Octree on 3-D
+ * data.
+ */
+BOOST_AUTO_TEST_CASE(Octree3DSearchTest)
+{
+  arma::mat dataset(3, 1000, arma::fill::randu);
+  arma::mat queries(3, 100, arma::fill::randu);
+
+  NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat, Octree>
+      knn(dataset);
+  NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat, Octree3D>
+      knn3d(dataset);
+
+  arma::Mat<size_t> neighbors, neighbors3d;
+  arma::mat distances, distances3d;
+  knn.Search(queries, 5, neighbors, distances);
+  knn3d.Search(queries, 5, neighbors3d, distances3d);
+
+  CheckMatrices(neighbors, neighbors3d);
+  CheckMatrices(distances, distances3d);
+
+  RangeSearch<EuclideanDistance, arma::mat, Octree> rs(dataset);
+  RangeSearch<EuclideanDistance, arma::mat, Octree3D> rs3d(dataset);
+
+  std::vector<std::vector<size_t>> rsNeighbors, rsNeighbors3d;
+  std::vector<std::vector<double>> rsDistances, rsDistances3d;
+  rs.Search(queries, Range(0.05, 0.15), rsNeighbors, rsDistances);
+  rs3d.Search(queries, Range(0.05, 0.15), rsNeighbors3d, rsDistances3d);
+
+  BOOST_REQUIRE_EQUAL(rsNeighbors.size(), rsNeighbors3d.size());
+  for (size_t i = 0; i < rsNeighbors.size(); ++i)
+  {
+    std::vector<size_t> n1(rsNeighbors[i]), n2(rsNeighbors3d[i]);
+    std::sort(n1.begin(), n1.end());
+    std::sort(n2.begin(), n2.end());
+    BOOST_REQUIRE_EQUAL(n1.size(), n2.size());
+    for (size_t j = 0; j < n1.size(); ++j)
+      BOOST_REQUIRE_EQUAL(n1[j], n2[j]);
+  }
+}
+
+/**
+ * Make sure the Octree3D can't be built on data that isn't 3-D.
+ */
+BOOST_AUTO_TEST_CASE(Octree3DDimensionalityTest)
+{
+  arma::mat dataset(2, 100, arma::fill::randu);
+
+  BOOST_REQUIRE_THROW(Octree3D<> t(dataset), std::invalid_argument);
+}
+
+/**
+ * Test serialization of the Octree3D.
+ */
+BOOST_AUTO_TEST_CASE(Octree3DSerializationTest)
+{
+  arma::mat dataset(3, 500, arma::fill::randu);
+  Octree3D<> t(std::move(dataset));
+
+  Octree3D<>* xmlTree;
+  Octree3D<>* binaryTree;
+  Octree3D<>* textTree;
+
+  SerializePointerObjectAll(&t, xmlTree, binaryTree, textTree);
+
+  CheckSameNode(t, *xmlTree);
+  CheckSameNode(t, *binaryTree);
+  CheckSameNode(t, *textTree);
+
+  delete xmlTree;
+  delete binaryTree;
+  delete textTree;
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -13,6 +13,7 @@
 #include <mlpack/core.hpp>
 #include <mlpack/methods/pca/pca.hpp>
 #include <mlpack/methods/pca/decomposition_policies/exact_svd_method.hpp>
+#include <mlpack/methods/pca/decomposition_policies/incremental_svd_method.hpp>
 #include <mlpack/methods/pca/decomposition_policies/quic_svd_method.hpp>
 #include <mlpack/methods/pca/decomposition_policies/randomized_svd_method.hpp>
 #include <mlpack/methods/pca/decomposition_policies/randomized_block_krylov_method.hpp>
@@ -20,6 +21,8 @@
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 
+#include <fstream>
+
 BOOST_AUTO_TEST_SUITE(PCATest);
 
 using namespace arma;
@@ -207,6 +210,14 @@ BOOST_AUTO_TEST_CASE(ArmaComparisonRandomizedPCATest)
   ArmaComparisonPCA<RandomizedSVDPolicy>();
 }
 
+/**
+ * Compare the output of our incremental PCA implementation with Armadillo's.
+ */
+BOOST_AUTO_TEST_CASE(ArmaComparisonIncrementalPCATest)
+{
+  ArmaComparisonPCA<IncrementalSVDPolicy>(false, IncrementalSVDPolicy(0, 64));
+}
+
 /**
  * Test that dimensionality reduction with exact-svd PCA works the same way
  * MATLAB does (which should be correct!).
@@ -236,6 +247,17 @@ BOOST_AUTO_TEST_CASE(RandomizedPCADimensionalityReductionTest)
   PCADimensionalityReduction<RandomizedSVDPolicy>();
 }
 
+/**
+ * Test that dimensionality reduction with incremental PCA works the same way
+ * MATLAB does (which should be correct!), when the points are added two at a
+ * time.
+ */
+BOOST_AUTO_TEST_CASE(IncrementalPCADimensionalityReductionTest)
+{
+  PCADimensionalityReduction<IncrementalSVDPolicy>(false,
+      IncrementalSVDPolicy(0, 2));
+}
+
 /**
  * Test that dimensionality reduction with QUIC-SVD PCA works the same way
  * as the Exact-SVD PCA method.
@@ -337,5 +359,158 @@ BOOST_AUTO_TEST_CASE(PCAScalingTest)
   BOOST_REQUIRE_CLOSE(accu(eigval), 3.0, 0.1); // 10% tolerance.
 }
 
+/**
+ * Make sure that merging incremental decompositions of the parts of a dataset,
+ * and updating one with the whole dataset in one call, give the same
+ * components as exact PCA.  The data has rank 3, so nothing is lost by keeping
+ * 3 components.
+ */
+BOOST_AUTO_TEST_CASE(IncrementalSVDMergeTest)
+{
+  arma::mat data = arma::randn<arma::mat>(10, 3) *
+      arma::randn<arma::mat>(3, 2000);
+  data.each_col() += arma::linspace<arma::vec>(1, 10, 10);
+
+  IncrementalSVDPolicy whole(3, 100);
+  whole.Update(data);
+
+  IncrementalSVDPolicy first(3, 64), second(3, 64);
+  first.Update(data.cols(0, 499));
+  second.Update(data.cols(500, 1999));
+  first.Merge(second);
+
+  PCA<> p;
+  arma::mat transformed, eigvec;
+  arma::vec eigVal;
+  p.Apply(data, transformed, eigVal, eigvec);
+
+  BOOST_REQUIRE_EQUAL(whole.NumPoints(), 2000);
+  BOOST_REQUIRE_EQUAL(first.NumPoints(), 2000);
+  BOOST_REQUIRE_EQUAL(whole.Components().n_cols, 3);
+  BOOST_REQUIRE_EQUAL(first.Components().n_cols, 3);
+
+  const arma::vec wholeEigVal = whole.EigenValues();
+  const arma::vec mergedEigVal = first.EigenValues();
+  for (size_t i = 0; i < 3; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(wholeEigVal[i], eigVal[i], 1e-5);
+    BOOST_REQUIRE_CLOSE(mergedEigVal[i], eigVal[i], 1e-5);
+  }
+  BOOST_REQUIRE_CLOSE(whole.TotalVariance(), arma::accu(eigVal), 1e-5);
+  BOOST_REQUIRE_CLOSE(first.TotalVariance(), arma::accu(eigVal), 1e-5);
+
+  // The projections should match, up to the sign of each component.
+  arma::mat wholeTransformed, mergedTransformed;
+  whole.Transform(data, wholeTransformed);
+  first.Transform(data, mergedTransformed);
+  for (size_t i = 0; i < 3; ++i)
+  {
+    for (size_t j = 0; j < data.n_cols; ++j)
+    {
+      if (std::abs(transformed(i, j)) < 1e-5)
+        continue;
+
+      BOOST_REQUIRE_CLOSE(std::abs(wholeTransformed(i, j)),
+          std::abs(transformed(i, j)), 1e-3);
+      BOOST_REQUIRE_CLOSE(std::abs(mergedTransformed(i, j)),
+          std::abs(transformed(i, j)), 1e-3);
+    }
+  }
+
+  // Points of the wrong dimensionality can't be added.
+  BOOST_REQUIRE_THROW(whole.Update(arma::mat(5, 10, arma::fill::randu)),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure that IncrementalSVDPolicy::UpdateFile() and TransformFile() give
+ * the same results as the in-memory methods, even when the file is read in
+ * small chunks.
+ */
+BOOST_AUTO_TEST_CASE(IncrementalSVDFileTest)
+{
+  arma::mat data(3, 300, arma::fill::randu);
+
+  // Write the data with a mix of separators and some empty lines, and no
+  // newline at the end.
+  std::ofstream stream("incremental_svd_test.csv");
+  stream.precision(17);
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    if (i > 0)
+      stream << ((i % 50 == 0) ? "\n\n" : "\n");
+    stream << data(0, i) << ", " << data(1, i) << "\t" << data(2, i);
+  }
+  stream.close();
+
+  IncrementalSVDPolicy direct(0, 32), fromFile(0, 32);
+  direct.Update(data);
+  fromFile.UpdateFile("incremental_svd_test.csv", 500);
+
+  BOOST_REQUIRE_EQUAL(fromFile.Dimensionality(), 3);
+  BOOST_REQUIRE_EQUAL(fromFile.NumPoints(), 300);
+  for (size_t i = 0; i < 3; ++i)
+    BOOST_REQUIRE_CLOSE(fromFile.Mean()[i], direct.Mean()[i], 1e-8);
+  for (size_t i = 0; i < 3; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(fromFile.SingularValues()[i],
+        direct.SingularValues()[i], 1e-5);
+  }
+
+  arma::mat transformed, transformedFile;
+  fromFile.Transform(data, transformed);
+  fromFile.TransformFile("incremental_svd_test.csv", transformedFile, 500);
+
+  BOOST_REQUIRE_EQUAL(transformedFile.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(transformedFile.n_cols, 300);
+  for (size_t i = 0; i < transformed.n_elem; ++i)
+    BOOST_REQUIRE_SMALL(transformedFile[i] - transformed[i], 1e-8);
+
+  // A line with the wrong number of values is an error.
+  std::ofstream badStream("incremental_svd_test.csv");
+  badStream << "1, 2, 3\n4, 5\n";
+  badStream.close();
+
+  IncrementalSVDPolicy bad;
+  BOOST_REQUIRE_THROW(bad.UpdateFile("incremental_svd_test.csv"),
+      std::runtime_error);
+
+  remove("incremental_svd_test.csv");
+}
+
+/**
+ * Make sure that PCA::Transform() projects new points the same way Apply()
+ * projected the data, with and without scaling.
+ */
+BOOST_AUTO_TEST_CASE(PCATransformTest)
+{
+  arma::mat data(4, 200, arma::fill::randu);
+  data.row(2) *= 10.0;
+
+  for (size_t scale = 0; scale < 2; ++scale)
+  {
+    PCA<> p(scale == 1);
+    arma::mat transformed, eigvec;
+    arma::vec eigVal;
+    p.Apply(data, transformed, eigVal, eigvec);
+
+    arma::mat newTransformed;
+    p.Transform(data, newTransformed);
+    BOOST_REQUIRE_EQUAL(newTransformed.n_rows, transformed.n_rows);
+    BOOST_REQUIRE_EQUAL(newTransformed.n_cols, transformed.n_cols);
+    for (size_t i = 0; i < transformed.n_elem; ++i)
+      BOOST_REQUIRE_SMALL(newTransformed[i] - transformed[i], 1e-8);
+
+    // After dimensionality reduction, the points are projected onto the
+    // components that were kept.
+    arma::mat reduced = data;
+    p.Apply(reduced, (size_t) 2);
+
+    p.Transform(data, newTransformed);
+    BOOST_REQUIRE_EQUAL(newTransformed.n_rows, 2);
+    for (size_t i = 0; i < reduced.n_elem; ++i)
+      BOOST_REQUIRE_SMALL(newTransformed[i] - reduced[i], 1e-8);
+  }
+}
 
 BOOST_AUTO_TEST_SUITE_END();
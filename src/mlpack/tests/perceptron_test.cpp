@@ -255,4 +255,37 @@ BOOST_AUTO_TEST_CASE(SecondaryConstructor)
   Perceptron<> p2(p1);
 }
 
+/**
+ * Parallel training should converge on linearly separable data with several
+ * classes, and the batched classification should match the scores of each
+ * point.
+ */
+BOOST_AUTO_TEST_CASE(ParallelTrainingAndClassification)
+{
+  // Three well-separated Gaussians.
+  mat trainData(2, 3000);
+  Row<size_t> labels(3000);
+  const mat centers("0 10 0; 0 0 10");
+  for (size_t i = 0; i < trainData.n_cols; ++i)
+  {
+    labels[i] = i % 3;
+    trainData.col(i) = centers.col(labels[i]) + randu<vec>(2);
+  }
+
+  Perceptron<> p(3, 2, 1000);
+  p.Parallel() = true;
+  p.Train(trainData, labels, 3);
+
+  Row<size_t> predictedLabels;
+  p.Classify(trainData, predictedLabels);
+  BOOST_REQUIRE_EQUAL(predictedLabels.n_elem, trainData.n_cols);
+  for (size_t i = 0; i < trainData.n_cols; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(predictedLabels[i], labels[i]);
+
+    const vec scores = p.Weights().t() * trainData.col(i) + p.Biases();
+    BOOST_REQUIRE_EQUAL(predictedLabels[i], scores.index_max());
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,226 @@
+/**
+ * @file pq_search_test.cpp
+ *
+ * Tests for PQSearch (product quantization for approximate nearest neighbor
+ * search).
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/methods/pq/pq_search.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include "test_tools.hpp"
+#include "serialization.hpp"
+
+using namespace mlpack;
+using namespace mlpack::neighbor;
+
+BOOST_AUTO_TEST_SUITE(PQSearchTest);
+
+/**
+ * Reconstruct every reference point from the model: the centroid of its list
+ * plus its centroid in every subspace.
+ */
+arma::mat DecodeAll(const PQSearch& pq)
+{
+  const size_t numSubspaces = pq.NumSubspaces();
+  arma::mat decoded(pq.Dimensionality(), pq.NumPoints());
+  for (size_t l = 0; l + 1 < pq.ListOffsets().size(); ++l)
+  {
+    for (size_t p = pq.ListOffsets()[l]; p < pq.ListOffsets()[l + 1]; ++p)
+    {
+      const size_t index = pq.ListPoints()[p];
+      if (pq.NumLists() > 0)
+        decoded.col(index) = pq.CoarseCentroids().col(l);
+      else
+        decoded.col(index).zeros();
+
+      for (size_t m = 0; m < numSubspaces; ++m)
+      {
+        const size_t begin = pq.SubspaceBegin()[m];
+        const size_t end = pq.SubspaceBegin()[m + 1] - 1;
+        decoded.col(index).subvec(begin, end) += pq.Codebooks().submat(begin,
+            pq.Codes()[p * numSubspaces + m], end,
+            pq.Codes()[p * numSubspaces + m]);
+      }
+    }
+  }
+
+  return decoded;
+}
+
+/**
+ * When every list is scanned, the approximate distances are the exact
+ * distances to the reconstructed reference points, so the results must be
+ * the exact nearest neighbors among the reconstructed points.
+ */
+BOOST_AUTO_TEST_CASE(PQSearchDecodedExactTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(10, 500);
+  arma::mat queries = arma::randu<arma::mat>(10, 40);
+
+  for (size_t numLists = 0; numLists <= 6; numLists += 6)
+  {
+    PQSearch pq(dataset, 3, 16, numLists);
+    BOOST_REQUIRE_EQUAL(pq.NumPoints(), 500);
+    BOOST_REQUIRE_EQUAL(pq.NumSubspaces(), 3);
+    BOOST_REQUIRE_EQUAL(pq.NumCentroids(), 16);
+    BOOST_REQUIRE_EQUAL(pq.NumLists(), numLists);
+    BOOST_REQUIRE_EQUAL(pq.Codes().size(), 3 * 500);
+
+    const arma::mat decoded = DecodeAll(pq);
+    for (size_t run = 0; run < 2; ++run)
+    {
+      const arma::mat& querySet = (run == 0) ? queries : dataset;
+      arma::Mat<size_t> neighbors;
+      arma::mat distances;
+      pq.Search(querySet, 5, neighbors, distances, 6, run == 1);
+
+      BOOST_REQUIRE_EQUAL(neighbors.n_rows, 5);
+      BOOST_REQUIRE_EQUAL(neighbors.n_cols, querySet.n_cols);
+      for (size_t q = 0; q < querySet.n_cols; ++q)
+      {
+        arma::vec trueDistances(decoded.n_cols);
+        for (size_t i = 0; i < decoded.n_cols; ++i)
+          trueDistances[i] = arma::norm(querySet.col(q) - decoded.col(i));
+        // A point is never its own neighbor.
+        if (run == 1)
+          trueDistances[q] = DBL_MAX;
+        trueDistances = arma::sort(trueDistances);
+
+        for (size_t i = 0; i < 5; ++i)
+        {
+          BOOST_REQUIRE(run == 0 || neighbors(i, q) != q);
+          BOOST_REQUIRE_CLOSE(distances(i, q), trueDistances[i], 1e-5);
+          BOOST_REQUIRE_CLOSE(distances(i, q), arma::norm(querySet.col(q) -
+              decoded.col(neighbors(i, q))), 1e-5);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Scanning more lists can only find closer points.
+ */
+BOOST_AUTO_TEST_CASE(PQSearchProbesTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(8, 2000);
+  arma::mat queries = arma::randu<arma::mat>(8, 100);
+
+  PQSearch pq(dataset, 4, 32, 20);
+
+  arma::Mat<size_t> neighbors, probedNeighbors;
+  arma::mat distances, probedDistances;
+  pq.Search(queries, 10, neighbors, distances, 1);
+  pq.Search(queries, 10, probedNeighbors, probedDistances, 5);
+
+  for (size_t i = 0; i < distances.n_elem; ++i)
+    BOOST_REQUIRE_LE(probedDistances[i], distances[i]);
+
+  // If there are fewer points in the scanned lists than k, the remaining
+  // results are empty.
+  pq.Search(queries, 2000, neighbors, distances, 1);
+  BOOST_REQUIRE_GT(arma::accu(neighbors == SIZE_MAX), 0);
+  pq.Search(queries, 2000, neighbors, distances, 20);
+  BOOST_REQUIRE_EQUAL(arma::accu(neighbors == SIZE_MAX), 0);
+}
+
+/**
+ * If the points of each subspace only take as many values as there are
+ * centroids, the points are encoded exactly, and the results are the true
+ * nearest neighbors.
+ */
+BOOST_AUTO_TEST_CASE(PQSearchLosslessTest)
+{
+  // Each half of each point is one of 4 well-separated prototypes.
+  arma::mat prototypes = 10 * arma::randu<arma::mat>(3, 4);
+  arma::mat dataset(6, 400);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    dataset.col(i).subvec(0, 2) = prototypes.col(i % 4);
+    dataset.col(i).subvec(3, 5) = prototypes.col((i / 4) % 4);
+  }
+  arma::mat queries = 10 * arma::randu<arma::mat>(6, 20);
+
+  PQSearch pq(dataset, 2, 4);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  pq.Search(queries, 3, neighbors, distances);
+
+  for (size_t q = 0; q < queries.n_cols; ++q)
+  {
+    arma::vec trueDistances(dataset.n_cols);
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+      trueDistances[i] = arma::norm(queries.col(q) - dataset.col(i));
+    trueDistances = arma::sort(trueDistances);
+
+    for (size_t i = 0; i < 3; ++i)
+    {
+      BOOST_REQUIRE_CLOSE(distances(i, q), trueDistances[i], 1e-5);
+      BOOST_REQUIRE_CLOSE(distances(i, q), arma::norm(queries.col(q) -
+          dataset.col(neighbors(i, q))), 1e-5);
+    }
+  }
+}
+
+/**
+ * Make sure that invalid parameters are rejected.
+ */
+BOOST_AUTO_TEST_CASE(PQSearchParametersTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(4, 100);
+
+  BOOST_REQUIRE_THROW(PQSearch(dataset, 0, 16), std::invalid_argument);
+  BOOST_REQUIRE_THROW(PQSearch(dataset, 5, 16), std::invalid_argument);
+  BOOST_REQUIRE_THROW(PQSearch(dataset, 2, 0), std::invalid_argument);
+  BOOST_REQUIRE_THROW(PQSearch(dataset, 2, 257), std::invalid_argument);
+  BOOST_REQUIRE_THROW(PQSearch(dataset, 2, 101), std::invalid_argument);
+  BOOST_REQUIRE_THROW(PQSearch(dataset, 2, 16, 0, 25, 10),
+      std::invalid_argument);
+
+  PQSearch pq(dataset, 2, 16, 4, 25, 50);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  arma::mat queries = arma::randu<arma::mat>(3, 10);
+  BOOST_REQUIRE_THROW(pq.Search(queries, 1, neighbors, distances),
+      std::invalid_argument);
+  queries = arma::randu<arma::mat>(4, 10);
+  BOOST_REQUIRE_THROW(pq.Search(queries, 1, neighbors, distances, 1, true),
+      std::invalid_argument);
+
+  // An untrained model can't search.
+  PQSearch empty;
+  BOOST_REQUIRE_EQUAL(empty.NumPoints(), 0);
+  BOOST_REQUIRE_THROW(empty.Search(queries, 1, neighbors, distances),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure that a serialized model gives the same results.
+ */
+BOOST_AUTO_TEST_CASE(PQSearchSerializationTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(6, 300);
+  arma::mat queries = arma::randu<arma::mat>(6, 20);
+
+  PQSearch pq(dataset, 3, 8, 4);
+  PQSearch xmlPQ, textPQ, binaryPQ;
+  SerializeObjectAll(pq, xmlPQ, textPQ, binaryPQ);
+
+  arma::Mat<size_t> neighbors, xmlNeighbors, textNeighbors, binaryNeighbors;
+  arma::mat distances, xmlDistances, textDistances, binaryDistances;
+  pq.Search(queries, 5, neighbors, distances, 2);
+  xmlPQ.Search(queries, 5, xmlNeighbors, xmlDistances, 2);
+  textPQ.Search(queries, 5, textNeighbors, textDistances, 2);
+  binaryPQ.Search(queries, 5, binaryNeighbors, binaryDistances, 2);
+
+  CheckMatrices(neighbors, xmlNeighbors, textNeighbors, binaryNeighbors);
+  CheckMatrices(distances, xmlDistances, textDistances, binaryDistances);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -102,6 +102,120 @@ BOOST_AUTO_TEST_CASE(CartPoleWithDQN)
   BOOST_REQUIRE(converged);
 }
 
+//! Test DQN with prioritized experience replay in Cart Pole task.
+BOOST_AUTO_TEST_CASE(CartPoleWithDQNPrioritizedReplay)
+{
+  // Set up the network.
+  FFN<MeanSquaredError<>, GaussianInitialization> model(MeanSquaredError<>(),
+      GaussianInitialization(0, 0.001));
+  model.Add<Linear<>>(4, 128);
+  model.Add<ReLULayer<>>();
+  model.Add<Linear<>>(128, 128);
+  model.Add<ReLULayer<>>();
+  model.Add<Linear<>>(128, 2);
+
+  // Set up the policy and replay method.
+  GreedyPolicy<CartPole> policy(1.0, 1000, 0.1, 0.99);
+  PrioritizedReplay<CartPole> replayMethod(10, 10000, 0.6);
+
+  TrainingConfig config;
+  config.StepSize() = 0.01;
+  config.Discount() = 0.9;
+  config.TargetNetworkSyncInterval() = 100;
+  config.ExplorationSteps() = 100;
+  config.DoubleQLearning() = false;
+  config.StepLimit() = 200;
+
+  // Set up DQN agent.
+  QLearning<CartPole, decltype(model), AdamUpdate, decltype(policy),
+      decltype(replayMethod)> agent(std::move(config), std::move(model),
+      std::move(policy), std::move(replayMethod));
+
+  arma::running_stat<double> averageReturn;
+  size_t episodes = 0;
+  bool converged = true;
+  while (true)
+  {
+    double episodeReturn = agent.Episode();
+    averageReturn(episodeReturn);
+    episodes += 1;
+
+    if (episodes > 1000)
+    {
+      Log::Debug << "Cart Pole with prioritized DQN failed." << std::endl;
+      converged = false;
+      break;
+    }
+
+    Log::Debug << "Average return: " << averageReturn.mean()
+        << " Episode return: " << episodeReturn << std::endl;
+    if (averageReturn.mean() > 35)
+      break;
+  }
+  BOOST_REQUIRE(converged);
+}
+
+//! Test DQN in Cart Pole task with several environments stepped in lockstep.
+BOOST_AUTO_TEST_CASE(CartPoleWithVectorDQN)
+{
+  // Set up the network.
+  FFN<MeanSquaredError<>, GaussianInitialization> model(MeanSquaredError<>(),
+      GaussianInitialization(0, 0.001));
+  model.Add<Linear<>>(4, 128);
+  model.Add<ReLULayer<>>();
+  model.Add<Linear<>>(128, 128);
+  model.Add<ReLULayer<>>();
+  model.Add<Linear<>>(128, 2);
+
+  // Set up the policy and replay method.
+  GreedyPolicy<CartPole> policy(1.0, 1000, 0.1, 0.99);
+  RandomReplay<CartPole> replayMethod(10, 10000);
+
+  TrainingConfig config;
+  config.StepSize() = 0.01;
+  config.Discount() = 0.9;
+  config.TargetNetworkSyncInterval() = 100;
+  config.ExplorationSteps() = 100;
+  config.DoubleQLearning() = false;
+  config.StepLimit() = 200;
+
+  // Set up DQN agent.
+  QLearning<CartPole, decltype(model), AdamUpdate, decltype(policy)>
+      agent(std::move(config), std::move(model), std::move(policy),
+      std::move(replayMethod));
+
+  VectorEnvironment<CartPole> environments(4);
+
+  arma::running_stat<double> averageReturn;
+  size_t episodes = 0;
+  bool converged = true;
+  while (true)
+  {
+    const size_t previousSteps = agent.TotalSteps();
+    const arma::colvec episodeReturns = agent.VectorEpisode(environments);
+    BOOST_REQUIRE_EQUAL(episodeReturns.n_elem, 4);
+
+    // Every environment takes at least one step per episode.
+    BOOST_REQUIRE_GE(agent.TotalSteps() - previousSteps, 4);
+
+    for (size_t i = 0; i < episodeReturns.n_elem; ++i)
+      averageReturn(episodeReturns[i]);
+    episodes += episodeReturns.n_elem;
+
+    if (episodes > 1000)
+    {
+      Log::Debug << "Cart Pole with vector DQN failed." << std::endl;
+      converged = false;
+      break;
+    }
+
+    Log::Debug << "Average return: " << averageReturn.mean() << std::endl;
+    if (averageReturn.mean() > 35)
+      break;
+  }
+  BOOST_REQUIRE(converged);
+}
+
 //! Test Double DQN in Cart Pole task.
 BOOST_AUTO_TEST_CASE(CartPoleWithDoubleDQN)
 {
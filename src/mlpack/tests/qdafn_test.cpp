@@ -127,6 +127,43 @@ BOOST_AUTO_TEST_CASE(RetrainTest)
   }
 }
 
+/**
+ * Storing only the candidate indices should give the same results as storing
+ * copies of the candidates, and should survive serialization.
+ */
+BOOST_AUTO_TEST_CASE(CandidateIndicesTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(10, 500);
+
+  // Use the same random lines for both models.
+  const size_t seed = math::RandInt(1000000);
+  math::RandomSeed(seed);
+  QDAFN<> qdafn(dataset, 10, 30);
+  math::RandomSeed(seed);
+  QDAFN<> qdafnIndices(dataset, 10, 30, false);
+
+  BOOST_REQUIRE_EQUAL(qdafnIndices.NumProjections(), 10);
+  BOOST_REQUIRE_EQUAL(qdafnIndices.CandidateIndices().n_rows, 30);
+  BOOST_REQUIRE_EQUAL(qdafnIndices.CandidateIndices().n_cols, 10);
+
+  arma::Mat<size_t> neighbors, neighborsIndices;
+  arma::mat distances, distancesIndices;
+  qdafn.Search(dataset, 3, neighbors, distances);
+  qdafnIndices.Search(dataset, 3, neighborsIndices, distancesIndices);
+
+  CheckMatrices(neighbors, neighborsIndices);
+  CheckMatrices(distances, distancesIndices);
+
+  // A loaded model holds its own copies of the candidates.
+  QDAFN<> qdafnXml(1, 1), qdafnText(1, 1), qdafnBinary(1, 1);
+  SerializeObjectAll(qdafnIndices, qdafnXml, qdafnText, qdafnBinary);
+
+  BOOST_REQUIRE_EQUAL(qdafnBinary.CandidateSet(0).n_cols, 30);
+  qdafnBinary.Search(dataset, 3, neighborsIndices, distancesIndices);
+  CheckMatrices(neighbors, neighborsIndices);
+  CheckMatrices(distances, distancesIndices);
+}
+
 /**
  * Test serialization of QDAFN.
  */
@@ -96,6 +96,65 @@ BOOST_AUTO_TEST_CASE(BootstrapWeightsTest)
   }
 }
 
+/**
+ * Make sure a bootstrap view gathers the right points, and that reordering its
+ * points does not modify the dataset.
+ */
+BOOST_AUTO_TEST_CASE(BootstrapViewTest)
+{
+  arma::mat dataset(3, 10, arma::fill::randu);
+  const arma::mat original(dataset);
+  arma::uvec indices("4 4 0 9 2 2 2 7");
+
+  BootstrapView<arma::mat> view(dataset, indices);
+  BOOST_REQUIRE_EQUAL(view.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(view.n_cols, 8);
+  for (size_t i = 0; i < indices.n_elem; ++i)
+    for (size_t d = 0; d < 3; ++d)
+      BOOST_REQUIRE_EQUAL(view(d, i), dataset(d, indices[i]));
+
+  arma::rowvec row = view.cols(2, 5).row(1);
+  BOOST_REQUIRE_EQUAL(row.n_elem, 4);
+  for (size_t i = 0; i < 4; ++i)
+    BOOST_REQUIRE_EQUAL(row[i], dataset(1, indices[i + 2]));
+
+  view.swap_cols(0, 3);
+  BOOST_REQUIRE_EQUAL(view(0, 0), dataset(0, 9));
+  BOOST_REQUIRE_EQUAL(view(0, 3), dataset(0, 4));
+  CheckMatrices(dataset, original);
+}
+
+/**
+ * Make sure that a decision tree trained on a bootstrap view is the same as a
+ * decision tree trained on a copy of the same bootstrap sample.
+ */
+BOOST_AUTO_TEST_CASE(BootstrapViewTrainTest)
+{
+  arma::mat dataset;
+  arma::Row<size_t> labels;
+  data::Load("vc2.csv", dataset);
+  data::Load("vc2_labels.txt", labels);
+
+  arma::uvec indices = arma::randi<arma::uvec>(dataset.n_cols,
+      arma::distr_param(0, dataset.n_cols - 1));
+  arma::mat bootstrapDataset = dataset.cols(indices);
+  arma::Row<size_t> bootstrapLabels = labels.cols(indices);
+
+  DecisionTree<> tree(bootstrapDataset, bootstrapLabels, 3, 5);
+  DecisionTree<> viewTree;
+  viewTree.Train(BootstrapView<arma::mat>(dataset, indices), bootstrapLabels,
+      3, 5);
+
+  arma::Row<size_t> predictions, viewPredictions;
+  arma::mat probabilities, viewProbabilities;
+  tree.Classify(dataset, predictions, probabilities);
+  viewTree.Classify(dataset, viewPredictions, viewProbabilities);
+
+  for (size_t i = 0; i < predictions.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(predictions[i], viewPredictions[i]);
+  CheckMatrices(probabilities, viewProbabilities);
+}
+
 /**
  * Make sure an empty forest cannot predict.
  */
@@ -487,4 +546,86 @@ BOOST_AUTO_TEST_CASE(DifferentTreesTest)
   BOOST_REQUIRE_EQUAL(success, true);
 }
 
+/**
+ * Make sure that a flattened forest classifies numeric data exactly like the
+ * forest it was built from.
+ */
+BOOST_AUTO_TEST_CASE(FlatForestNumericTest)
+{
+  arma::mat dataset;
+  arma::Row<size_t> labels;
+  data::Load("vc2.csv", dataset);
+  data::Load("vc2_labels.txt", labels);
+
+  arma::mat testDataset;
+  data::Load("vc2_test.csv", testDataset);
+
+  RandomForest<> rf(dataset, labels, 3, 10 /* 10 trees */, 5);
+  FlatForest flat(rf);
+  BOOST_REQUIRE_EQUAL(flat.NumTrees(), 10);
+  BOOST_REQUIRE_EQUAL(flat.NumClasses(), 3);
+
+  arma::Row<size_t> predictions, flatPredictions;
+  arma::mat probabilities, flatProbabilities;
+  rf.Classify(testDataset, predictions, probabilities);
+  flat.Classify(testDataset, flatPredictions, flatProbabilities);
+
+  BOOST_REQUIRE_EQUAL(flatPredictions.n_elem, testDataset.n_cols);
+  for (size_t i = 0; i < predictions.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(predictions[i], flatPredictions[i]);
+  CheckMatrices(probabilities, flatProbabilities);
+
+  // Single points should give the same results as batches.
+  for (size_t i = 0; i < testDataset.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(flat.Classify(testDataset.col(i)), predictions[i]);
+
+  flat.Classify(testDataset, flatPredictions);
+  for (size_t i = 0; i < predictions.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(predictions[i], flatPredictions[i]);
+}
+
+/**
+ * Make sure that a flattened forest classifies categorical data exactly like
+ * the forest it was built from.
+ */
+BOOST_AUTO_TEST_CASE(FlatForestCategoricalTest)
+{
+  arma::mat d;
+  arma::Row<size_t> l;
+  data::DatasetInfo di;
+  MockCategoricalData(d, l, di);
+
+  arma::mat trainingData = d.cols(0, 1999);
+  arma::mat testData = d.cols(2000, 3999);
+  arma::Row<size_t> trainingLabels = l.subvec(0, 1999);
+
+  RandomForest<> rf(trainingData, di, trainingLabels, 5, 10 /* 10 trees */, 1,
+      1e-7, MultipleRandomDimensionSelect(4));
+  FlatForest flat(rf);
+
+  arma::Row<size_t> predictions, flatPredictions;
+  arma::mat probabilities, flatProbabilities;
+  rf.Classify(testData, predictions, probabilities);
+  flat.Classify(testData, flatPredictions, flatProbabilities);
+
+  for (size_t i = 0; i < predictions.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(predictions[i], flatPredictions[i]);
+  CheckMatrices(probabilities, flatProbabilities);
+}
+
+/**
+ * Make sure that an empty flat forest can't be used.
+ */
+BOOST_AUTO_TEST_CASE(EmptyFlatForestTest)
+{
+  RandomForest<> rf;
+  BOOST_REQUIRE_THROW(FlatForest f(rf), std::invalid_argument);
+
+  FlatForest flat;
+  arma::mat dataset(3, 10, arma::fill::randu);
+  arma::Row<size_t> predictions;
+  BOOST_REQUIRE_THROW(flat.Classify(dataset, predictions),
+      std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -64,4 +64,38 @@ BOOST_AUTO_TEST_CASE(RandomizedSVDReconstructionError)
   BOOST_REQUIRE_SMALL(error, 1e-5);
 }
 
+/**
+ * The sparse overload, which centers the data implicitly and multiplies in
+ * parallel, should give the same singular values as the dense one.
+ */
+BOOST_AUTO_TEST_CASE(RandomizedSVDSparseTest)
+{
+  arma::sp_mat data;
+  data.sprandu(100, 300, 0.1);
+  const arma::mat denseData(data);
+
+  arma::mat U1, U2, V1, V2;
+  arma::vec s1, s2;
+
+  svd::RandomizedSVD rSVD(0, 3);
+  math::RandomSeed(10);
+  rSVD.Apply(data, U1, s1, V1, 10);
+  math::RandomSeed(10);
+  rSVD.Apply(denseData, U2, s2, V2, 10);
+
+  BOOST_REQUIRE_EQUAL(s1.n_elem, s2.n_elem);
+  for (size_t i = 0; i < s1.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(s1[i], s2[i], 1e-2);
+
+  // The factorization should reconstruct the centered data as well as the
+  // dense one does.
+  arma::mat centeredData;
+  math::Center(denseData, centeredData);
+  const double error1 = arma::norm(centeredData - U1 * arma::diagmat(s1) *
+      V1.t(), "frob");
+  const double error2 = arma::norm(centeredData - U2 * arma::diagmat(s2) *
+      V2.t(), "frob");
+  BOOST_REQUIRE_CLOSE(error1, error2, 1e-2);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -1334,6 +1334,143 @@ BOOST_AUTO_TEST_CASE(RSModelTest)
   }
 }
 
+/**
+ * Make sure that single-precision models give the same results as
+ * double-precision search.
+ */
+BOOST_AUTO_TEST_CASE(RSModelSinglePrecisionTest)
+{
+  arma::mat queryData = arma::randu<arma::mat>(10, 50);
+  arma::mat referenceData = arma::randu<arma::mat>(10, 200);
+
+  RangeSearch<> rs(referenceData);
+  vector<vector<size_t>> baselineNeighbors;
+  vector<vector<double>> baselineDistances;
+  rs.Search(queryData, math::Range(0.25, 0.75), baselineNeighbors,
+      baselineDistances);
+
+  vector<vector<pair<double, size_t>>> baselineSorted;
+  SortResults(baselineNeighbors, baselineDistances, baselineSorted);
+
+  const RSModel::TreeTypes treeTypes[] = { RSModel::TreeTypes::KD_TREE,
+      RSModel::TreeTypes::BALL_TREE };
+  for (size_t t = 0; t < 2; ++t)
+  {
+    for (size_t j = 0; j < 3; ++j)
+    {
+      RSModel model(treeTypes[t], false, true);
+      model.BuildModel(arma::mat(referenceData), 5, (j == 2), (j == 1));
+      BOOST_REQUIRE_EQUAL(model.DatasetSize().n_rows, 10);
+      BOOST_REQUIRE_EQUAL(model.DatasetSize().n_cols, 200);
+
+      vector<vector<size_t>> neighbors;
+      vector<vector<double>> distances;
+      model.Search(arma::mat(queryData), math::Range(0.25, 0.75), neighbors,
+          distances);
+
+      vector<vector<pair<double, size_t>>> sorted;
+      SortResults(neighbors, distances, sorted);
+
+      // Points very close to the edges of the range may be found or missed
+      // depending on the precision, so only compare the points that are
+      // clearly inside the range.
+      BOOST_REQUIRE_EQUAL(sorted.size(), baselineSorted.size());
+      for (size_t k = 0; k < sorted.size(); ++k)
+      {
+        for (size_t l = 0; l < baselineSorted[k].size(); ++l)
+        {
+          const double d = baselineSorted[k][l].first;
+          if (d < 0.2501 || d > 0.7499)
+            continue;
+
+          bool found = false;
+          for (size_t m = 0; m < sorted[k].size(); ++m)
+          {
+            if (sorted[k][m].second == baselineSorted[k][l].second)
+            {
+              BOOST_REQUIRE_CLOSE(sorted[k][m].first, d, 1e-3);
+              found = true;
+              break;
+            }
+          }
+          BOOST_REQUIRE_EQUAL(found, true);
+        }
+      }
+    }
+  }
+
+  // Single precision is not available for other tree types.
+  RSModel coverModel(RSModel::TreeTypes::COVER_TREE, false, true);
+  BOOST_REQUIRE_THROW(coverModel.BuildModel(arma::mat(referenceData), 5,
+      false, false), std::invalid_argument);
+}
+
+/**
+ * Make sure that a query tree built by RSModel::BuildQueryTree() can be used
+ * for many searches with different ranges, and gives the same results as
+ * searching with the query set.
+ */
+BOOST_AUTO_TEST_CASE(RSModelQueryTreeTest)
+{
+  arma::mat queryData = arma::randu<arma::mat>(5, 100);
+  arma::mat referenceData = arma::randu<arma::mat>(5, 300);
+
+  const RSModel::TreeTypes treeTypes[] = { RSModel::TreeTypes::KD_TREE,
+      RSModel::TreeTypes::COVER_TREE, RSModel::TreeTypes::R_TREE,
+      RSModel::TreeTypes::BALL_TREE, RSModel::TreeTypes::VP_TREE,
+      RSModel::TreeTypes::OCTREE };
+  const math::Range ranges[] = { math::Range(0.0, 0.3),
+      math::Range(0.25, 0.75), math::Range(0.5, 1.0) };
+  for (size_t t = 0; t < 6; ++t)
+  {
+    RSModel model(treeTypes[t]);
+    model.BuildModel(arma::mat(referenceData), 10, false, false);
+
+    QueryTreeHandle queryTree = model.BuildQueryTree(arma::mat(queryData));
+    BOOST_REQUIRE_EQUAL(queryTree.NumPoints(), 100);
+
+    for (size_t r = 0; r < 3; ++r)
+    {
+      vector<vector<size_t>> neighbors, baselineNeighbors;
+      vector<vector<double>> distances, baselineDistances;
+      model.Search(queryTree, ranges[r], neighbors, distances);
+      model.Search(arma::mat(queryData), ranges[r], baselineNeighbors,
+          baselineDistances);
+
+      vector<vector<pair<double, size_t>>> sorted, baselineSorted;
+      SortResults(neighbors, distances, sorted);
+      SortResults(baselineNeighbors, baselineDistances, baselineSorted);
+
+      BOOST_REQUIRE_EQUAL(sorted.size(), baselineSorted.size());
+      for (size_t k = 0; k < sorted.size(); ++k)
+      {
+        BOOST_REQUIRE_EQUAL(sorted[k].size(), baselineSorted[k].size());
+        for (size_t l = 0; l < sorted[k].size(); ++l)
+        {
+          BOOST_REQUIRE_EQUAL(sorted[k][l].second, baselineSorted[k][l].second);
+          BOOST_REQUIRE_CLOSE(sorted[k][l].first, baselineSorted[k][l].first,
+              1e-5);
+        }
+      }
+    }
+  }
+
+  // A query tree can't be used with another type of tree, or without dual-tree
+  // search.
+  RSModel kdModel(RSModel::TreeTypes::KD_TREE);
+  kdModel.BuildModel(arma::mat(referenceData), 10, false, false);
+  RSModel ballModel(RSModel::TreeTypes::BALL_TREE);
+  ballModel.BuildModel(arma::mat(referenceData), 10, false, true);
+
+  QueryTreeHandle queryTree = kdModel.BuildQueryTree(arma::mat(queryData));
+  vector<vector<size_t>> neighbors;
+  vector<vector<double>> distances;
+  BOOST_REQUIRE_THROW(ballModel.Search(queryTree, math::Range(0.0, 0.5),
+      neighbors, distances), std::invalid_argument);
+  BOOST_REQUIRE_THROW(ballModel.BuildQueryTree(arma::mat(queryData)),
+      std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_CASE(RSModelMonochromaticTest)
 {
   // Ensure that we can build an RSModel and get correct results.
@@ -1696,4 +1833,206 @@ BOOST_AUTO_TEST_CASE(MoveOperatorNaiveTest)
   }
 }
 
+/**
+ * Make sure that the callback and compact overloads of Search(), and
+ * ParallelSearch(), give the same results as the vector overloads, with and
+ * without a query set, in every search mode.
+ */
+BOOST_AUTO_TEST_CASE(CallbackAndCompactSearchTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 800);
+  arma::mat queryData = arma::randu<arma::mat>(3, 300);
+  const math::Range range(0.1, 0.3);
+
+  for (size_t mode = 0; mode < 3; ++mode)
+  {
+    RangeSearch<> rs(dataset, mode == 0, mode == 1);
+
+    for (size_t run = 0; run < 2; ++run)
+    {
+      const size_t numQueries = (run == 0) ? queryData.n_cols : dataset.n_cols;
+
+      vector<vector<size_t>> neighbors;
+      vector<vector<double>> distances;
+      arma::Col<size_t> offsets, compactNeighbors;
+      arma::vec compactDistances;
+      vector<vector<size_t>> callbackNeighbors(numQueries);
+      vector<vector<double>> callbackDistances(numQueries);
+      VectorResults results(callbackNeighbors, callbackDistances);
+      vector<vector<size_t>> parallelNeighbors(numQueries);
+      vector<vector<double>> parallelDistances(numQueries);
+      VectorResults parallelResults(parallelNeighbors, parallelDistances);
+
+      if (run == 0)
+      {
+        rs.Search(queryData, range, neighbors, distances);
+        rs.Search(queryData, range, offsets, compactNeighbors,
+            compactDistances);
+        rs.Search(queryData, range, results);
+        rs.ParallelSearch(queryData, range, parallelResults);
+      }
+      else
+      {
+        rs.Search(range, neighbors, distances);
+        rs.Search(range, offsets, compactNeighbors, compactDistances);
+        rs.Search(range, results);
+        rs.ParallelSearch(range, parallelResults);
+      }
+
+      // Unpack the compact results.
+      BOOST_REQUIRE_EQUAL(offsets.n_elem, numQueries + 1);
+      BOOST_REQUIRE_EQUAL(offsets[numQueries], compactNeighbors.n_elem);
+      vector<vector<size_t>> unpackedNeighbors(numQueries);
+      vector<vector<double>> unpackedDistances(numQueries);
+      for (size_t i = 0; i < numQueries; ++i)
+      {
+        for (size_t j = offsets[i]; j < offsets[i + 1]; ++j)
+        {
+          unpackedNeighbors[i].push_back(compactNeighbors[j]);
+          unpackedDistances[i].push_back(compactDistances[j]);
+        }
+      }
+
+      vector<vector<pair<double, size_t>>> sorted, sortedCompact,
+          sortedCallback, sortedParallel;
+      SortResults(neighbors, distances, sorted);
+      SortResults(unpackedNeighbors, unpackedDistances, sortedCompact);
+      SortResults(callbackNeighbors, callbackDistances, sortedCallback);
+      SortResults(parallelNeighbors, parallelDistances, sortedParallel);
+
+      BOOST_REQUIRE_EQUAL(sorted.size(), numQueries);
+      for (size_t i = 0; i < numQueries; ++i)
+      {
+        BOOST_REQUIRE_EQUAL(sorted[i].size(), sortedCompact[i].size());
+        BOOST_REQUIRE_EQUAL(sorted[i].size(), sortedCallback[i].size());
+        BOOST_REQUIRE_EQUAL(sorted[i].size(), sortedParallel[i].size());
+        for (size_t j = 0; j < sorted[i].size(); ++j)
+        {
+          BOOST_REQUIRE_EQUAL(sorted[i][j].second,
+              sortedCompact[i][j].second);
+          BOOST_REQUIRE_EQUAL(sorted[i][j].second,
+              sortedCallback[i][j].second);
+          BOOST_REQUIRE_EQUAL(sorted[i][j].second,
+              sortedParallel[i][j].second);
+          BOOST_REQUIRE_CLOSE(sorted[i][j].first, sortedCompact[i][j].first,
+              1e-5);
+          BOOST_REQUIRE_CLOSE(sorted[i][j].first, sortedCallback[i][j].first,
+              1e-5);
+          BOOST_REQUIRE_CLOSE(sorted[i][j].first, sortedParallel[i][j].first,
+              1e-5);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Make sure that single-tree search along a space-filling curve gives the same
+ * results as in the order of the query points.
+ */
+BOOST_AUTO_TEST_CASE(QueryCurveTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 800);
+  arma::mat queryData = arma::randu<arma::mat>(3, 300);
+  const math::Range range(0.1, 0.3);
+
+  RangeSearch<> rs(dataset, false, true);
+  vector<vector<size_t>> neighbors;
+  vector<vector<double>> distances;
+  rs.Search(queryData, range, neighbors, distances);
+  vector<vector<pair<double, size_t>>> sorted;
+  SortResults(neighbors, distances, sorted);
+
+  const tree::SpaceFillingCurve curves[] = { tree::MORTON_CURVE,
+      tree::HILBERT_CURVE };
+  for (size_t c = 0; c < 2; ++c)
+  {
+    rs.QueryCurve() = curves[c];
+    vector<vector<size_t>> curveNeighbors;
+    vector<vector<double>> curveDistances;
+    rs.Search(queryData, range, curveNeighbors, curveDistances);
+
+    vector<vector<pair<double, size_t>>> curveSorted;
+    SortResults(curveNeighbors, curveDistances, curveSorted);
+
+    BOOST_REQUIRE_EQUAL(curveSorted.size(), sorted.size());
+    for (size_t i = 0; i < sorted.size(); ++i)
+    {
+      BOOST_REQUIRE_EQUAL(curveSorted[i].size(), sorted[i].size());
+      for (size_t j = 0; j < sorted[i].size(); ++j)
+      {
+        BOOST_REQUIRE_EQUAL(curveSorted[i][j].second, sorted[i][j].second);
+        BOOST_REQUIRE_CLOSE(curveSorted[i][j].first, sorted[i][j].first,
+            1e-5);
+      }
+    }
+  }
+}
+
+/**
+ * Make sure that a search with several radii puts each result in the bucket of
+ * the smallest radius containing it, by comparing with one search for each
+ * bucket.
+ */
+BOOST_AUTO_TEST_CASE(MultiRadiusSearchTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 600);
+  arma::mat queryData = arma::randu<arma::mat>(3, 200);
+  const vector<double> radii = { 0.05, 0.1, 0.2, 0.3 };
+
+  for (size_t mode = 0; mode < 3; ++mode)
+  {
+    RangeSearch<> rs(dataset, mode == 0, mode == 1);
+
+    for (size_t run = 0; run < 2; ++run)
+    {
+      vector<vector<vector<size_t>>> neighbors;
+      vector<vector<vector<double>>> distances;
+      if (run == 0)
+        rs.Search(queryData, radii, neighbors, distances);
+      else
+        rs.Search(radii, neighbors, distances);
+
+      BOOST_REQUIRE_EQUAL(neighbors.size(), radii.size());
+      BOOST_REQUIRE_EQUAL(distances.size(), radii.size());
+      for (size_t r = 0; r < radii.size(); ++r)
+      {
+        const math::Range range((r == 0) ? 0.0 : radii[r - 1], radii[r]);
+        vector<vector<size_t>> baselineNeighbors;
+        vector<vector<double>> baselineDistances;
+        if (run == 0)
+          rs.Search(queryData, range, baselineNeighbors, baselineDistances);
+        else
+          rs.Search(range, baselineNeighbors, baselineDistances);
+
+        vector<vector<pair<double, size_t>>> sorted, baselineSorted;
+        SortResults(neighbors[r], distances[r], sorted);
+        SortResults(baselineNeighbors, baselineDistances, baselineSorted);
+
+        BOOST_REQUIRE_EQUAL(sorted.size(), baselineSorted.size());
+        for (size_t i = 0; i < sorted.size(); ++i)
+        {
+          BOOST_REQUIRE_EQUAL(sorted[i].size(), baselineSorted[i].size());
+          for (size_t j = 0; j < sorted[i].size(); ++j)
+          {
+            BOOST_REQUIRE_EQUAL(sorted[i][j].second,
+                baselineSorted[i][j].second);
+            BOOST_REQUIRE_CLOSE(sorted[i][j].first, baselineSorted[i][j].first,
+                1e-5);
+          }
+        }
+      }
+    }
+  }
+
+  // The radii must be given in increasing order.
+  RangeSearch<> rs(dataset);
+  vector<vector<vector<size_t>>> neighbors;
+  vector<vector<vector<double>>> distances;
+  BOOST_REQUIRE_THROW(rs.Search(queryData, vector<double>({ 0.2, 0.1 }),
+      neighbors, distances), std::invalid_argument);
+  BOOST_REQUIRE_THROW(rs.Search(vector<double>(), neighbors, distances),
+      std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -258,4 +258,42 @@ BOOST_AUTO_TEST_CASE(MiscTest)
   BuildVanillaNetwork<arma::Mat<float>>(X, 2);
 }
 
+/*
+ * Check that the persistent chains of the BinaryRBM are kept independently of
+ * the batch size and that they produce a finite gradient.
+ */
+BOOST_AUTO_TEST_CASE(BinaryRBMPersistentChainsTest)
+{
+  arma::mat trainData = arma::randu<arma::mat>(8, 40);
+  trainData.transform([](double x) { return x > 0.5 ? 1.0 : 0.0; });
+
+  const size_t batchSize = 5;
+  const size_t numChains = 12;
+  GaussianInitialization gaussian(0, 0.1);
+  RBM<GaussianInitialization> model(trainData, gaussian, trainData.n_rows, 4,
+      batchSize, 2, 1, 2, 8, 1, true);
+  model.NumChains() = numChains;
+  model.Reset();
+
+  arma::mat gradient(model.Parameters().n_elem, 1);
+  for (size_t i = 0; i < trainData.n_cols; i += batchSize)
+  {
+    model.Gradient(model.Parameters(), i, gradient, batchSize);
+    BOOST_REQUIRE(gradient.is_finite());
+  }
+
+  // Every Gibbs step advances all the chains together and yields binary
+  // samples.
+  arma::mat input = trainData.cols(0, batchSize - 1);
+  arma::mat samples;
+  model.Gibbs(std::move(input), std::move(samples));
+  BOOST_REQUIRE_EQUAL(samples.n_rows, trainData.n_rows);
+  BOOST_REQUIRE_EQUAL(samples.n_cols, numChains);
+  for (size_t i = 0; i < samples.n_elem; ++i)
+    BOOST_REQUIRE(samples[i] == 0.0 || samples[i] == 1.0);
+
+  BOOST_REQUIRE(std::isfinite(model.Evaluate(model.Parameters(), 0,
+      batchSize)));
+}
+
 BOOST_AUTO_TEST_SUITE_END();
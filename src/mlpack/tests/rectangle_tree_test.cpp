@@ -1384,4 +1384,148 @@ BOOST_AUTO_TEST_CASE(RectangleTreeMoveDatasetTest)
   BOOST_REQUIRE_EQUAL(tree.Dataset().n_cols, 1000);
 }
 
+/**
+ * Bulk load a tree with the given ordering, check its structure, and check
+ * that nearest neighbor search with it gives the same results as naive search.
+ */
+template<template<typename, typename, typename> class TreeType>
+void CheckBulkLoad(const BulkLoadOrdering ordering)
+{
+  arma::mat dataset;
+  dataset.randu(5, 1000); // 1000 points in 5 dimensions.
+
+  typedef TreeType<EuclideanDistance, NeighborSearchStat<NearestNeighborSort>,
+      arma::mat> Tree;
+  Tree tree(dataset, ordering, 20, 6, 5, 2);
+
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), 1000);
+
+  CheckContainment(tree);
+  CheckExactContainment(tree);
+  CheckHierarchy(tree);
+  CheckNumDescendants(tree);
+  CheckFills(tree);
+  BOOST_REQUIRE_EQUAL(GetMinLevel(tree), GetMaxLevel(tree));
+
+  // Each point must be in the tree exactly once.
+  std::vector<size_t> counts(dataset.n_cols, 0);
+  for (size_t i = 0; i < tree.NumDescendants(); ++i)
+    ++counts[tree.Descendant(i)];
+  for (size_t i = 0; i < counts.size(); ++i)
+    BOOST_REQUIRE_EQUAL(counts[i], 1);
+
+  // The tree must still allow growth.
+  Tree grown(dataset, ordering, 20, 6, 5, 2);
+  grown.Dataset().reshape(5, 1100);
+  grown.Dataset().cols(1000, 1099).randu();
+  for (size_t i = 1000; i < 1100; ++i)
+    grown.InsertPoint(i);
+  BOOST_REQUIRE_EQUAL(grown.NumDescendants(), 1100);
+  CheckContainment(grown);
+  CheckHierarchy(grown);
+  CheckNumDescendants(grown);
+
+  arma::Mat<size_t> neighbors1, neighbors2;
+  arma::mat distances1, distances2;
+
+  NeighborSearch<NearestNeighborSort, metric::LMetric<2, true>, arma::mat,
+      TreeType> knn1(std::move(tree));
+  knn1.Search(5, neighbors1, distances1);
+
+  KNN knn2(dataset, NAIVE_MODE);
+  knn2.Search(5, neighbors2, distances2);
+
+  for (size_t i = 0; i < neighbors1.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors1[i], neighbors2[i]);
+    BOOST_REQUIRE_CLOSE(distances1[i], distances2[i], 1e-5);
+  }
+}
+
+// Make sure that bulk loading builds valid packed trees that give correct
+// search results for both of the orderings.
+BOOST_AUTO_TEST_CASE(RectangleTreeBulkLoadTest)
+{
+  CheckBulkLoad<RTree>(STR_BULK_LOAD);
+  CheckBulkLoad<RTree>(HILBERT_BULK_LOAD);
+  CheckBulkLoad<RStarTree>(STR_BULK_LOAD);
+  CheckBulkLoad<RStarTree>(HILBERT_BULK_LOAD);
+  CheckBulkLoad<XTree>(STR_BULK_LOAD);
+}
+
+// Trees that can't be packed fall back to insertion in the bulk load
+// ordering; make sure that the result is still a valid tree.
+BOOST_AUTO_TEST_CASE(HilbertRTreeBulkLoadTest)
+{
+  arma::mat dataset;
+  dataset.randu(8, 1000); // 1000 points in 8 dimensions.
+
+  typedef HilbertRTree<EuclideanDistance,
+      NeighborSearchStat<NearestNeighborSort>, arma::mat> TreeType;
+  TreeType hilbertRTree(dataset, HILBERT_BULK_LOAD, 20, 6, 5, 2);
+
+  BOOST_REQUIRE_EQUAL(hilbertRTree.NumDescendants(), 1000);
+  CheckHilbertOrdering(hilbertRTree);
+  CheckContainment(hilbertRTree);
+  CheckNumDescendants(hilbertRTree);
+
+  typedef RPlusTree<EuclideanDistance,
+      NeighborSearchStat<NearestNeighborSort>, arma::mat> RPlusTreeType;
+  RPlusTreeType rPlusTree(dataset, STR_BULK_LOAD, 20, 6, 5, 2);
+
+  BOOST_REQUIRE_EQUAL(rPlusTree.NumDescendants(), 1000);
+  CheckOverlap(rPlusTree);
+  CheckContainment(rPlusTree);
+  CheckNumDescendants(rPlusTree);
+}
+
+// Make sure that snapshots of a ConcurrentRectangleTree don't change while
+// points are inserted and deleted, and that published snapshots hold the
+// updates.
+BOOST_AUTO_TEST_CASE(ConcurrentRectangleTreeSnapshotTest)
+{
+  arma::mat dataset;
+  dataset.randu(3, 500);
+
+  typedef RStarTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+  ConcurrentRectangleTree<TreeType> index(TreeType(dataset), 0);
+
+  std::shared_ptr<const TreeType> first = index.Snapshot();
+  BOOST_REQUIRE_EQUAL(first->NumDescendants(), 500);
+
+  const size_t firstNew = index.Insert(arma::randu<arma::mat>(3, 100));
+  BOOST_REQUIRE_EQUAL(firstNew, 500);
+  BOOST_REQUIRE(index.DeletePoint(3));
+  BOOST_REQUIRE_EQUAL(index.PendingUpdates(), 101);
+
+  // Nothing was published, so the snapshot is unchanged.
+  BOOST_REQUIRE_EQUAL(index.Snapshot().get(), first.get());
+  BOOST_REQUIRE_EQUAL(first->NumDescendants(), 500);
+  BOOST_REQUIRE_EQUAL(first->Dataset().n_cols, 500);
+
+  index.Publish();
+  BOOST_REQUIRE_EQUAL(index.PendingUpdates(), 0);
+
+  std::shared_ptr<const TreeType> second = index.Snapshot();
+  BOOST_REQUIRE_EQUAL(second->NumDescendants(), 599);
+  BOOST_REQUIRE_EQUAL(second->Dataset().n_cols, 600);
+  CheckContainment(*second);
+  CheckHierarchy(*second);
+  CheckNumDescendants(*second);
+
+  // The old snapshot is still valid.
+  BOOST_REQUIRE_EQUAL(first->NumDescendants(), 500);
+  CheckContainment(*first);
+
+  // With a publish interval, snapshots are published automatically.
+  index.PublishInterval() = 10;
+  index.Insert(arma::randu<arma::mat>(3, 9));
+  BOOST_REQUIRE_EQUAL(index.Snapshot()->NumDescendants(), 599);
+  index.Insert(arma::randu<arma::mat>(3, 1));
+  BOOST_REQUIRE_EQUAL(index.Snapshot()->NumDescendants(), 609);
+
+  BOOST_REQUIRE_THROW(index.Insert(arma::randu<arma::mat>(2, 1)),
+      std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -977,6 +977,268 @@ BOOST_AUTO_TEST_CASE(GRUBatchSizeTest)
   BatchSizeTest<GRU<>>();
 }
 
+/**
+ * Make sure that with truncated BPTT the state of an LSTM is carried from one
+ * window to the next, so the predictions are the ones of a network that
+ * processes the whole sequence at once, and that training on long sequences
+ * works.
+ */
+BOOST_AUTO_TEST_CASE(TruncatedBPTTTest)
+{
+  const size_t rho = 5;
+  arma::cube input = arma::randu<arma::cube>(3, 8, 4 * rho);
+  arma::cube labels = arma::randu<arma::cube>(2, 8, 4 * rho);
+
+  RNN<MeanSquaredError<> > model(rho), fullModel(4 * rho);
+  model.TruncatedBPTT() = true;
+  model.Add<IdentityLayer<> >();
+  model.Add<Linear<> >(3, 6);
+  model.Add<LSTM<> >(6, 6, 4 * rho);
+  model.Add<Linear<> >(6, 2);
+  fullModel.Add<IdentityLayer<> >();
+  fullModel.Add<Linear<> >(3, 6);
+  fullModel.Add<LSTM<> >(6, 6, 4 * rho);
+  fullModel.Add<Linear<> >(6, 2);
+
+  model.ResetParameters();
+  fullModel.ResetParameters();
+  fullModel.Parameters() = model.Parameters();
+
+  arma::cube predictions, fullPredictions;
+  model.Predict(input, predictions);
+  fullModel.Predict(input, fullPredictions);
+  BOOST_REQUIRE_EQUAL(predictions.n_slices, 4 * rho);
+  CheckMatrices(predictions, fullPredictions, 1e-5);
+
+  StandardSGD opt(0.01, 4, 16, -100);
+  const double objective = model.Train(input, labels, opt);
+  BOOST_REQUIRE_EQUAL(std::isfinite(objective), true);
+
+  // The number of time steps has to be a multiple of rho.
+  arma::cube shortInput = input.slices(0, 2 * rho + 1);
+  arma::cube shortLabels = labels.slices(0, 2 * rho + 1);
+  BOOST_REQUIRE_THROW(model.Train(shortInput, shortLabels, opt),
+      std::invalid_argument);
+}
+
+/**
+ * Build the network used by the sequence length tests.
+ */
+template<typename NetworkType, typename RecurrentLayerType>
+void BuildPackedNetwork(NetworkType& model, const size_t rho)
+{
+  model.template Add<IdentityLayer<> >();
+  model.template Add<Linear<> >(3, 4);
+  model.template Add<RecurrentLayerType>(4, 4, rho);
+  model.template Add<Linear<> >(4, 2);
+}
+
+/**
+ * Make sure that an RNN trained on sequences of different lengths computes
+ * the objective and gradient of each sequence as if it was given alone.
+ */
+BOOST_AUTO_TEST_CASE(RNNSequenceLengthsTest)
+{
+  const size_t rho = 6;
+  arma::cube input = arma::randu<arma::cube>(3, 5, rho);
+  arma::cube labels = arma::floor(2 * arma::randu<arma::cube>(1, 5, rho)) + 1;
+  arma::urowvec lengths("6 4 4 2 1");
+
+  RNN<NegativeLogLikelihood<> > model(rho);
+  BuildPackedNetwork<decltype(model), LSTM<> >(model, rho);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+  model.Predictors() = input;
+  model.Responses() = labels;
+  model.SequenceLengths() = lengths;
+
+  arma::mat gradient;
+  const double objective = model.EvaluateWithGradient(model.Parameters(), 0,
+      gradient, 5);
+
+  double expectedObjective = 0;
+  arma::mat expectedGradient = arma::zeros(arma::size(gradient));
+  for (size_t i = 0; i < lengths.n_elem; ++i)
+  {
+    RNN<NegativeLogLikelihood<> > shortModel(lengths[i]);
+    BuildPackedNetwork<decltype(shortModel), LSTM<> >(shortModel, rho);
+    shortModel.Add<LogSoftMax<> >();
+    shortModel.ResetParameters();
+    shortModel.Parameters() = model.Parameters();
+    shortModel.Predictors() = input.subcube(0, i, 0, input.n_rows - 1, i,
+        lengths[i] - 1);
+    shortModel.Responses() = labels.subcube(0, i, 0, 0, i, lengths[i] - 1);
+
+    arma::mat shortGradient;
+    expectedObjective += shortModel.EvaluateWithGradient(
+        shortModel.Parameters(), 0, shortGradient, 1);
+    expectedGradient += shortGradient;
+  }
+
+  BOOST_REQUIRE_CLOSE(objective, expectedObjective, 1e-5);
+  CheckMatrices(gradient, expectedGradient, 1e-5);
+
+  // Train() sorts the points by decreasing length.
+  model.SequenceLengths() = arma::urowvec("1 4 6 2 4");
+  StandardSGD opt(0.01, 2, 10, -100);
+  const double trainObjective = model.Train(input, labels, opt);
+  BOOST_REQUIRE_EQUAL(std::isfinite(trainObjective), true);
+  for (size_t i = 1; i < lengths.n_elem; ++i)
+    BOOST_REQUIRE_GE(model.SequenceLengths()[i - 1],
+        model.SequenceLengths()[i]);
+
+  // Every length has to be between 1 and the number of time steps.
+  model.SequenceLengths() = arma::urowvec("1 4 7 2 4");
+  BOOST_REQUIRE_THROW(model.Train(input, labels, opt), std::invalid_argument);
+}
+
+/**
+ * Make sure that after Shuffle() the batches of an RNN with sequence lengths
+ * are the points of the shuffled order, sorted by length again.
+ */
+BOOST_AUTO_TEST_CASE(RNNShuffledBatchTest)
+{
+  const size_t rho = 6;
+  arma::cube input = arma::randu<arma::cube>(3, 6, rho);
+  arma::cube labels = arma::floor(2 * arma::randu<arma::cube>(1, 6, rho)) + 1;
+  arma::urowvec lengths("6 4 4 4 2 1");
+
+  RNN<NegativeLogLikelihood<> > model(rho);
+  BuildPackedNetwork<decltype(model), LSTM<> >(model, rho);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+  model.Predictors() = input;
+  model.Responses() = labels;
+  model.SequenceLengths() = lengths;
+
+  // Shuffle() draws the same order as this, and sorts it by length.
+  math::RandomSeed(5);
+  model.Shuffle();
+  math::RandomSeed(5);
+  arma::uvec order = arma::shuffle(arma::linspace<arma::uvec>(0, 5, 6));
+  const arma::urowvec shuffledLengths = lengths.cols(order);
+  order = arma::uvec(order.elem(arma::stable_sort_index(shuffledLengths,
+      "descend")));
+
+  RNN<NegativeLogLikelihood<> > shuffledModel(rho);
+  BuildPackedNetwork<decltype(shuffledModel), LSTM<> >(shuffledModel, rho);
+  shuffledModel.Add<LogSoftMax<> >();
+  shuffledModel.ResetParameters();
+  shuffledModel.Parameters() = model.Parameters();
+  shuffledModel.Predictors().set_size(3, 6, rho);
+  shuffledModel.Responses().set_size(1, 6, rho);
+  for (size_t i = 0; i < rho; ++i)
+  {
+    shuffledModel.Predictors().slice(i) = input.slice(i).cols(order);
+    shuffledModel.Responses().slice(i) = labels.slice(i).cols(order);
+  }
+  shuffledModel.SequenceLengths() = lengths.cols(order);
+
+  for (size_t begin = 0; begin < 6; begin += 3)
+  {
+    arma::mat gradient, shuffledGradient;
+    const double objective = model.EvaluateWithGradient(model.Parameters(),
+        begin, gradient, 3);
+    const double shuffledObjective = shuffledModel.EvaluateWithGradient(
+        shuffledModel.Parameters(), begin, shuffledGradient, 3);
+
+    BOOST_REQUIRE_CLOSE(objective, shuffledObjective, 1e-5);
+    CheckMatrices(gradient, shuffledGradient, 1e-5);
+  }
+
+  // The data itself is not moved.
+  CheckMatrices(model.Predictors(), input);
+}
+
+/**
+ * Make sure that a BRNN given sequences of different lengths starts the
+ * backward RNN at the end of each sequence, so that each sequence is
+ * predicted and trained as if it was given alone.
+ */
+BOOST_AUTO_TEST_CASE(BRNNSequenceLengthsTest)
+{
+  const size_t rho = 6;
+  arma::cube input = arma::randu<arma::cube>(3, 4, rho);
+  arma::cube labels = arma::floor(4 * arma::randu<arma::cube>(1, 4, rho)) + 1;
+  arma::urowvec lengths("6 5 3 3");
+
+  BRNN<> model(rho);
+  BuildPackedNetwork<decltype(model), GRU<> >(model, rho);
+  model.ResetParameters();
+  model.Predictors() = input;
+  model.Responses() = labels;
+  model.SequenceLengths() = lengths;
+
+  arma::mat gradient;
+  const double objective = model.EvaluateWithGradient(model.Parameters(), 0,
+      gradient, 4);
+
+  arma::cube predictions;
+  model.Predict(input, lengths, predictions);
+
+  double expectedObjective = 0;
+  arma::mat expectedGradient = arma::zeros(arma::size(gradient));
+  for (size_t i = 0; i < lengths.n_elem; ++i)
+  {
+    BRNN<> shortModel(lengths[i]);
+    BuildPackedNetwork<decltype(shortModel), GRU<> >(shortModel, rho);
+    shortModel.ResetParameters();
+    shortModel.Parameters() = model.Parameters();
+
+    arma::cube shortInput = input.subcube(0, i, 0, input.n_rows - 1, i,
+        lengths[i] - 1);
+    shortModel.Predictors() = shortInput;
+    shortModel.Responses() = labels.subcube(0, i, 0, 0, i, lengths[i] - 1);
+    arma::mat shortGradient;
+    expectedObjective += shortModel.EvaluateWithGradient(
+        shortModel.Parameters(), 0, shortGradient, 1);
+    expectedGradient += shortGradient;
+
+    arma::cube shortPredictions;
+    shortModel.Predict(shortInput, shortPredictions);
+    CheckMatrices(arma::cube(predictions.subcube(0, i, 0,
+        predictions.n_rows - 1, i, lengths[i] - 1)), shortPredictions, 1e-5);
+    for (size_t t = lengths[i]; t < rho; ++t)
+      BOOST_REQUIRE_SMALL(arma::norm(predictions.slice(t).col(i)), 1e-10);
+  }
+
+  BOOST_REQUIRE_CLOSE(objective, expectedObjective, 1e-5);
+  CheckMatrices(gradient, expectedGradient, 1e-5);
+}
+
+/**
+ * Make sure that running the two directions of a BRNN on two threads gives
+ * the same objective, gradient and predictions as running them one after
+ * the other.
+ */
+BOOST_AUTO_TEST_CASE(BRNNConcurrentTest)
+{
+  const size_t rho = 5;
+  arma::cube input = arma::randu<arma::cube>(3, 6, rho);
+  arma::cube labels = arma::floor(4 * arma::randu<arma::cube>(1, 6, rho)) + 1;
+
+  BRNN<> model(rho);
+  BuildPackedNetwork<decltype(model), LSTM<> >(model, rho);
+  model.ResetParameters();
+  model.Predictors() = input;
+  model.Responses() = labels;
+
+  arma::mat gradient, sequentialGradient;
+  arma::cube predictions, sequentialPredictions;
+  const double objective = model.EvaluateWithGradient(model.Parameters(), 0,
+      gradient, 6);
+  model.Predict(input, predictions);
+
+  model.Concurrent() = false;
+  const double sequentialObjective = model.EvaluateWithGradient(
+      model.Parameters(), 0, sequentialGradient, 6);
+  model.Predict(input, sequentialPredictions);
+
+  BOOST_REQUIRE_CLOSE(objective, sequentialObjective, 1e-10);
+  CheckMatrices(gradient, sequentialGradient, 1e-10);
+  CheckMatrices(predictions, sequentialPredictions, 1e-10);
+}
+
 /**
  * Make sure the RNN can be properly serialized.
  */
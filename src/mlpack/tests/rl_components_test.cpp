@@ -20,7 +20,9 @@
 #include <mlpack/methods/reinforcement_learning/environment/continuous_multiple_pole_cart.hpp>
 #include <mlpack/methods/reinforcement_learning/environment/acrobot.hpp>
 #include <mlpack/methods/reinforcement_learning/environment/pendulum.hpp>
+#include <mlpack/methods/reinforcement_learning/replay/compact_replay.hpp>
 #include <mlpack/methods/reinforcement_learning/replay/random_replay.hpp>
+#include <mlpack/methods/reinforcement_learning/replay/prioritized_replay.hpp>
 #include <mlpack/methods/reinforcement_learning/policy/greedy_policy.hpp>
 
 #include <boost/test/unit_test.hpp>
@@ -208,6 +210,159 @@ BOOST_AUTO_TEST_CASE(RandomReplayTest)
   }
 }
 
+/**
+ * Construct a compact replay instance and check that it stores each state of
+ * an episode once and rebuilds the transitions from consecutive slots.
+ */
+BOOST_AUTO_TEST_CASE(CompactReplayTest)
+{
+  CompactReplay<MountainCar> replay(4, 5);
+  MountainCar env;
+  MountainCar::Action action = MountainCar::Action::forward;
+
+  // Store an episode of three transitions.
+  std::vector<MountainCar::State> episode(1, env.InitialSample());
+  for (size_t i = 0; i < 3; ++i)
+  {
+    MountainCar::State nextState;
+    const double reward = env.Sample(episode.back(), action, nextState);
+    replay.Store(episode.back(), action, reward, nextState, i == 2);
+    episode.push_back(nextState);
+  }
+
+  // One slot for the initial state and one for each next state.
+  BOOST_REQUIRE_EQUAL(4, replay.Size());
+
+  arma::mat sampledState;
+  arma::icolvec sampledAction;
+  arma::colvec sampledReward;
+  arma::mat sampledNextState;
+  arma::icolvec sampledTerminal;
+  for (size_t trial = 0; trial < 10; ++trial)
+  {
+    replay.Sample(sampledState, sampledAction, sampledReward,
+        sampledNextState, sampledTerminal);
+    BOOST_REQUIRE_EQUAL(sampledState.n_cols, 4);
+
+    for (size_t i = 0; i < sampledState.n_cols; ++i)
+    {
+      // Find the transition the sample corresponds to.
+      size_t step = 0;
+      while (step < 3 && std::abs(sampledState(0, i) -
+          (float) episode[step].Encode()[0]) > 1e-6)
+        ++step;
+
+      BOOST_REQUIRE_LT(step, 3);
+      BOOST_REQUIRE_CLOSE(sampledNextState(0, i),
+          (float) episode[step + 1].Encode()[0], 1e-3);
+      BOOST_REQUIRE_EQUAL(sampledTerminal[i], step == 2);
+    }
+  }
+
+  // A new episode overwrites the oldest slots; the transition whose start
+  // was overwritten must not be sampled any more.
+  MountainCar::State state = env.InitialSample();
+  MountainCar::State nextState;
+  const double reward = env.Sample(state, action, nextState);
+  replay.Store(state, action, reward, nextState, false);
+  BOOST_REQUIRE_EQUAL(5, replay.Size());
+
+  for (size_t trial = 0; trial < 30; ++trial)
+  {
+    replay.Sample(sampledState, sampledAction, sampledReward,
+        sampledNextState, sampledTerminal);
+    for (size_t i = 0; i < sampledNextState.n_cols; ++i)
+    {
+      BOOST_REQUIRE_GT(std::abs(sampledNextState(0, i) -
+          (float) episode[1].Encode()[0]), 1e-6);
+    }
+  }
+}
+
+/**
+ * Check that the sum tree keeps its sums up to date and finds the right leaf
+ * for a given prefix sum.
+ */
+BOOST_AUTO_TEST_CASE(SumTreeTest)
+{
+  SumTree<double> tree(5);
+  const arma::vec values("1.0 0.0 2.0 3.0 4.0");
+  for (size_t i = 0; i < values.n_elem; ++i)
+    tree.Set(i, values[i]);
+
+  BOOST_REQUIRE_CLOSE(tree.Sum(), 10.0, 1e-5);
+  BOOST_REQUIRE_EQUAL(tree.FindPrefixSum(0.5), 0);
+  BOOST_REQUIRE_EQUAL(tree.FindPrefixSum(1.0), 2);
+  BOOST_REQUIRE_EQUAL(tree.FindPrefixSum(2.9), 2);
+  BOOST_REQUIRE_EQUAL(tree.FindPrefixSum(3.0), 3);
+  BOOST_REQUIRE_EQUAL(tree.FindPrefixSum(9.9), 4);
+
+  // Masses beyond the total must never select an empty leaf.
+  BOOST_REQUIRE_EQUAL(tree.FindPrefixSum(20.0), 4);
+
+  tree.Set(4, 0.0);
+  BOOST_REQUIRE_CLOSE(tree.Sum(), 6.0, 1e-5);
+  BOOST_REQUIRE_EQUAL(tree.FindPrefixSum(5.9), 3);
+  BOOST_REQUIRE_EQUAL(tree.FindPrefixSum(7.0), 3);
+}
+
+/**
+ * Construct a prioritized replay instance and check that transitions with
+ * a large temporal difference error are sampled more often.
+ */
+BOOST_AUTO_TEST_CASE(PrioritizedReplayTest)
+{
+  PrioritizedReplay<MountainCar> replay(2, 4);
+  MountainCar env;
+  MountainCar::State state = env.InitialSample();
+  MountainCar::Action action = MountainCar::Action::forward;
+  MountainCar::State nextState;
+  double reward = env.Sample(state, action, nextState);
+  replay.Store(state, action, reward, nextState, env.IsTerminal(nextState));
+
+  arma::mat sampledState;
+  arma::icolvec sampledAction;
+  arma::colvec sampledReward;
+  arma::mat sampledNextState;
+  arma::icolvec sampledTerminal;
+
+  //! So far there should be only one record in the memory.
+  replay.Sample(sampledState, sampledAction, sampledReward, sampledNextState,
+      sampledTerminal);
+  CheckMatrices(state.Encode(), sampledState.col(0));
+  CheckMatrices(state.Encode(), sampledState.col(1));
+  BOOST_REQUIRE_EQUAL(1, replay.Size());
+
+  for (size_t i = 0; i < 3; ++i)
+    replay.Store(nextState, action, reward, state, true);
+  BOOST_REQUIRE_EQUAL(4, replay.Size());
+
+  // Give the first transition a large error and the others a tiny one.
+  arma::uvec counts(4, arma::fill::zeros);
+  for (size_t trial = 0; trial < 200; ++trial)
+  {
+    replay.Sample(sampledState, sampledAction, sampledReward,
+        sampledNextState, sampledTerminal);
+
+    const arma::uvec& indices = replay.SampledIndices();
+    arma::mat actionValues(3, indices.n_elem, arma::fill::zeros);
+    arma::mat target = actionValues;
+    for (size_t i = 0; i < indices.n_elem; ++i)
+    {
+      target(sampledAction[i], i) = (indices[i] == 0) ? 10.0 : 0.0;
+      counts[indices[i]]++;
+    }
+
+    replay.Update(target, sampledAction, actionValues);
+
+    // The importance sampling weights never enlarge the errors.
+    BOOST_REQUIRE_LE(arma::max(replay.Weights()), 1.0 + 1e-10);
+    BOOST_REQUIRE_LE(arma::abs(target).max(), 10.0 + 1e-10);
+  }
+
+  BOOST_REQUIRE_GT(counts[0], counts[1] + counts[2] + counts[3]);
+}
+
 /**
  * Construct a greedy policy instance and check if it works as
  * it should be.
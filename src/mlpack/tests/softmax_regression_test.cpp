@@ -171,6 +171,71 @@ BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionGradient)
   }
 }
 
+/**
+ * Make sure that the minibatch objective and gradient (with an intercept) add
+ * up to the full objective and gradient, that they match the gradient of
+ * single features, and that large scores don't overflow.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionSeparableTest)
+{
+  const size_t points = 1000;
+  const size_t inputSize = 10;
+  const size_t numClasses = 20;
+
+  arma::mat data;
+  data.randu(inputSize, points);
+
+  arma::Row<size_t> labels(points);
+  for (size_t i = 0; i < points; i++)
+    labels(i) = math::RandInt(0, numClasses);
+
+  // Without regularization, the full objective and gradient are the averages
+  // of those of the minibatches.
+  SoftmaxRegressionFunction srf(data, labels, numClasses, 0, true);
+  BOOST_REQUIRE_EQUAL(srf.NumFunctions(), points);
+
+  arma::mat parameters;
+  parameters.randu(numClasses, inputSize + 1);
+
+  arma::mat gradient;
+  const double objective = srf.EvaluateWithGradient(parameters, gradient);
+  BOOST_REQUIRE_CLOSE(objective, srf.Evaluate(parameters), 1e-5);
+
+  double batchObjective = 0.0;
+  arma::mat batchGradient(arma::size(parameters), arma::fill::zeros);
+  for (size_t start = 0; start < points; start += 400)
+  {
+    const size_t batchSize = std::min((size_t) 400, points - start);
+    arma::mat g;
+    const double f = srf.EvaluateWithGradient(parameters, start, g,
+        batchSize);
+    BOOST_REQUIRE_CLOSE(f, srf.Evaluate(parameters, start, batchSize), 1e-5);
+
+    batchObjective += f * batchSize / points;
+    batchGradient += g * batchSize / points;
+  }
+
+  BOOST_REQUIRE_CLOSE(batchObjective, objective, 1e-5);
+  for (size_t i = 0; i < gradient.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(batchGradient[i], gradient[i], 1e-5);
+
+  // The partial gradient of each feature (and the intercept) should match.
+  for (size_t j = 0; j < parameters.n_cols; ++j)
+  {
+    arma::sp_mat partial;
+    srf.PartialGradient(parameters, j, partial);
+    for (size_t i = 0; i < numClasses; ++i)
+      BOOST_REQUIRE_CLOSE((double) partial(i, j), gradient(i, j), 1e-5);
+  }
+
+  // Scores that would overflow exp() should still give a finite objective.
+  arma::mat largeParameters = 1000 * parameters;
+  const double largeObjective = srf.EvaluateWithGradient(largeParameters,
+      gradient);
+  BOOST_REQUIRE(std::isfinite(largeObjective));
+  BOOST_REQUIRE(gradient.is_finite());
+}
+
 BOOST_AUTO_TEST_CASE(SoftmaxRegressionTwoClasses)
 {
   const size_t points = 1000;
@@ -268,4 +268,78 @@ BOOST_AUTO_TEST_CASE(SparseAutoencoderFunctionGradient)
   }
 }
 
+/**
+ * Check the separable interface: the whole dataset as one batch gives the
+ * full objective, and the batch gradient matches the numerical gradient of
+ * the batch objective.
+ */
+BOOST_AUTO_TEST_CASE(SparseAutoencoderFunctionBatchGradient)
+{
+  const size_t points = 300;
+  const size_t vSize = 12;
+  const size_t hSize = 6;
+  const size_t l2 = vSize;
+  const size_t l3 = 2 * hSize;
+
+  arma::mat data;
+  data.randu(vSize, points);
+
+  SparseAutoencoderFunction saf(data, vSize, hSize, 20, 20);
+  BOOST_REQUIRE_EQUAL(saf.NumFunctions(), points);
+
+  arma::mat parameters;
+  parameters.randu(l3 + 1, l2 + 1);
+
+  arma::mat fullGradient, batchGradient;
+  saf.Gradient(parameters, fullGradient);
+  const double fullCost = saf.Evaluate(parameters);
+  BOOST_REQUIRE_CLOSE(saf.Evaluate(parameters, 0, points), fullCost, 1e-8);
+  BOOST_REQUIRE_CLOSE(saf.EvaluateWithGradient(parameters, 0, batchGradient,
+      points), fullCost, 1e-8);
+  CheckMatrices(batchGradient, fullGradient, 1e-8);
+
+  // Check the gradient of a batch against the numerical one.
+  const size_t begin = 100;
+  const size_t batchSize = 50;
+  saf.Gradient(parameters, begin, batchGradient, batchSize);
+
+  const double epsilon = 0.0001;
+  for (size_t i = 0; i <= l3; i++)
+  {
+    for (size_t j = 0; j <= l2; j++)
+    {
+      parameters(i, j) += epsilon;
+      const double costPlus = saf.Evaluate(parameters, begin, batchSize);
+      parameters(i, j) -= 2 * epsilon;
+      const double costMinus = saf.Evaluate(parameters, begin, batchSize);
+      parameters(i, j) += epsilon;
+
+      const double numGradient = (costPlus - costMinus) / (2 * epsilon);
+      BOOST_REQUIRE_CLOSE(numGradient, batchGradient(i, j), 1e-2);
+    }
+  }
+}
+
+/**
+ * Train the sparse autoencoder with a minibatch optimizer and make sure the
+ * objective decreases.
+ */
+BOOST_AUTO_TEST_CASE(SparseAutoencoderFunctionSGDTest)
+{
+  const size_t vSize = 10;
+  const size_t hSize = 5;
+
+  arma::mat data;
+  data.randu(vSize, 500);
+
+  SparseAutoencoderFunction saf(data, vSize, hSize);
+  arma::mat parameters = saf.GetInitialPoint();
+  const double initialCost = saf.Evaluate(parameters);
+
+  ens::StandardSGD sgd(10.0, 50, 50 * 500, 1e-10, true);
+  sgd.Optimize(saf, parameters);
+
+  BOOST_REQUIRE_LT(saf.Evaluate(parameters), initialCost);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -170,4 +170,64 @@ BOOST_AUTO_TEST_CASE(SplitLabeledDataLargerTest)
   CheckDuplication(std::get<2>(value), std::get<3>(value));
 }
 
+/**
+ * SplitIndices() gives the same split as Split() with the same seed.
+ */
+BOOST_AUTO_TEST_CASE(SplitIndicesTest)
+{
+  mat input(10, 497);
+  input.randu();
+
+  math::RandomSeed(42);
+  arma::uvec trainIndices, testIndices;
+  SplitIndices(input.n_cols, 0.3, trainIndices, testIndices);
+  BOOST_REQUIRE_EQUAL(trainIndices.n_elem, 497 - size_t(0.3 * 497));
+  BOOST_REQUIRE_EQUAL(testIndices.n_elem, size_t(0.3 * 497));
+  CheckDuplication(arma::conv_to<Row<size_t>>::from(trainIndices),
+      arma::conv_to<Row<size_t>>::from(testIndices));
+
+  math::RandomSeed(42);
+  mat trainData, testData;
+  Split(input, trainData, testData, 0.3);
+  CheckMatrices(trainData, mat(input.cols(trainIndices)));
+  CheckMatrices(testData, mat(input.cols(testIndices)));
+
+  mat gathered;
+  GatherColumns(input, testIndices, gathered);
+  CheckMatrices(gathered, testData);
+}
+
+/**
+ * SplitInPlace() rearranges the dataset so that the outputs alias it.
+ */
+BOOST_AUTO_TEST_CASE(SplitInPlaceTest)
+{
+  mat input(10, 497);
+  input.randu();
+  const mat original(input);
+
+  // Set the labels to the column ID.
+  Row<size_t> labels = arma::linspace<Row<size_t>>(0, input.n_cols - 1,
+      input.n_cols);
+
+  mat trainData, testData;
+  Row<size_t> trainLabels, testLabels;
+  SplitInPlace(input, labels, trainData, testData, trainLabels, testLabels,
+      0.3);
+
+  BOOST_REQUIRE_EQUAL(trainData.n_cols, 497 - size_t(0.3 * 497));
+  BOOST_REQUIRE_EQUAL(testData.n_cols, size_t(0.3 * 497));
+  BOOST_REQUIRE_EQUAL(trainLabels.n_elem, 497 - size_t(0.3 * 497));
+  BOOST_REQUIRE_EQUAL(testLabels.n_elem, size_t(0.3 * 497));
+
+  // Nothing was copied.
+  BOOST_REQUIRE_EQUAL(trainData.memptr(), input.memptr());
+  BOOST_REQUIRE_EQUAL(testData.memptr(), input.colptr(trainData.n_cols));
+  BOOST_REQUIRE_EQUAL(trainLabels.memptr(), labels.memptr());
+
+  CompareData(original, trainData, trainLabels);
+  CompareData(original, testData, testLabels);
+  CheckDuplication(trainLabels, testLabels);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -254,6 +254,46 @@ BOOST_AUTO_TEST_CASE(SVDPlusPlusFunctionGradient)
   }
 }
 
+/**
+ * For a user with a single rating, the user-grouped SGD step should be the
+ * same as a step along the gradient of that rating.
+ */
+BOOST_AUTO_TEST_CASE(SVDPlusPlusFunctionUserGradientStep)
+{
+  const size_t numUsers = 50;
+  const size_t numItems = 40;
+  const size_t rank = 4;
+  const double stepSize = 0.01;
+
+  // Give each user one rating.
+  arma::mat data(3, numUsers);
+  for (size_t i = 0; i < numUsers; ++i)
+  {
+    data(0, i) = i;
+    data(1, i) = math::RandInt(numItems);
+    data(2, i) = math::RandInt(1, 6);
+  }
+  data(1, numUsers - 1) = numItems - 1;
+
+  arma::sp_mat implicitData = arma::sprandu(numItems, numUsers, 0.2);
+
+  SVDPlusPlusFunction<arma::mat> svdPPFunc(data, implicitData, rank, 0.1);
+
+  for (size_t i = 0; i < numUsers; ++i)
+  {
+    const size_t user = data(0, i);
+    BOOST_REQUIRE_EQUAL(svdPPFunc.NumUserRatings(user), 1);
+
+    arma::mat parameters = arma::randu(rank + 1, numUsers + 2 * numItems);
+    arma::mat gradient;
+    svdPPFunc.Gradient(parameters, i, gradient, 1);
+    const arma::mat expected = parameters - stepSize * gradient;
+
+    svdPPFunc.UserGradientStep(parameters, user, stepSize, 1, false);
+    CheckMatrices(parameters, expected, 1e-5);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(SVDplusPlusOutputSizeTest)
 {
   // Load small GroupLens dataset.
@@ -147,4 +147,147 @@ BOOST_AUTO_TEST_CASE(DisabledTimingTest)
   BOOST_REQUIRE(Timer::Get("test_timer") == std::chrono::microseconds(0));
 }
 
+/**
+ * Hardware performance events should be counted for timers if performance
+ * counters are available.
+ */
+BOOST_AUTO_TEST_CASE(PerfCountersTimerTest)
+{
+  Timer::ResetAll();
+  Timer::EnableTiming();
+  Timer::EnablePerfCounters();
+
+  Timer::Start("perf_timer");
+  arma::mat x(100, 100, arma::fill::randu);
+  const double sum = arma::accu(x * x);
+  Timer::Stop("perf_timer");
+  BOOST_REQUIRE_GT(sum, 0.0);
+
+  const PerfCounterValues values = Timer::GetPerfCounters("perf_timer");
+  if (PerfCounters::Available())
+  {
+    BOOST_REQUIRE_GT(values.cycles, 0);
+    BOOST_REQUIRE_GT(values.instructions, 0);
+  }
+  else
+  {
+    BOOST_REQUIRE_EQUAL(values.cycles, 0);
+    BOOST_REQUIRE_EQUAL(values.instructions, 0);
+  }
+
+  Timer::DisablePerfCounters();
+  Timer::DisableTiming();
+  Timer::ResetAll();
+}
+
+/**
+ * The peak memory of each timer should include the memory allocated by nested
+ * timers, but not the memory released before it was started.
+ */
+BOOST_AUTO_TEST_CASE(PeakMemoryTimerTest)
+{
+  Timer::ResetAll();
+  Timer::EnableTiming();
+  Timer::EnableMemoryTracking();
+
+  const size_t start = MemoryTracker::Current();
+  Timer::Start("outer_memory_timer");
+  MemoryTracker::Add(1000000);
+  Timer::Start("inner_memory_timer");
+  MemoryTracker::Add(500000);
+  MemoryTracker::Remove(500000);
+  Timer::Stop("inner_memory_timer");
+  MemoryTracker::Remove(1000000);
+  Timer::Stop("outer_memory_timer");
+
+  Timer::Start("later_memory_timer");
+  Timer::Stop("later_memory_timer");
+
+  BOOST_REQUIRE_GE(Timer::GetPeakMemory("inner_memory_timer"),
+      start + 1500000);
+  BOOST_REQUIRE_GE(Timer::GetPeakMemory("outer_memory_timer"),
+      start + 1500000);
+  BOOST_REQUIRE_LT(Timer::GetPeakMemory("later_memory_timer"),
+      start + 1000000);
+  BOOST_REQUIRE_GE(MemoryTracker::Peak(), start + 1500000);
+
+  Timer::DisableMemoryTracking();
+  Timer::DisableTiming();
+  Timer::ResetAll();
+}
+
+/**
+ * Nested scoped timers should be recorded as a call tree, and their results
+ * should be merged over threads.
+ */
+BOOST_AUTO_TEST_CASE(ScopedTimerTest)
+{
+  Timer::ResetAll();
+  Timer::EnableTiming();
+
+  static const TimerSection outerSection("scoped_outer");
+  static const TimerSection innerSection("scoped_inner");
+  BOOST_REQUIRE_EQUAL(outerSection.Name(), "scoped_outer");
+  BOOST_REQUIRE_EQUAL(TimerSection("scoped_inner").ID(), innerSection.ID());
+
+  std::thread threads[2];
+  for (size_t i = 0; i < 2; ++i)
+  {
+    threads[i] = std::thread([]()
+        {
+          ScopedTimer outer(outerSection);
+          for (size_t j = 0; j < 10; ++j)
+          {
+            ScopedTimer inner(innerSection);
+            #ifdef _WIN32
+            Sleep(1);
+            #else
+            usleep(1000);
+            #endif
+          }
+        });
+  }
+
+  for (size_t i = 0; i < 2; ++i)
+    threads[i].join();
+
+  BOOST_REQUIRE_EQUAL(ScopedTimers::Count("scoped_outer"), 2);
+  BOOST_REQUIRE_EQUAL(ScopedTimers::Count("scoped_inner"), 20);
+  BOOST_REQUIRE_GE(ScopedTimers::Get("scoped_inner").count(), 20000);
+  BOOST_REQUIRE_GE(ScopedTimers::Get("scoped_outer").count(),
+      ScopedTimers::Get("scoped_inner").count());
+
+  // The inner section should be a child of the outer section.
+  std::ostringstream oss;
+  ScopedTimers::WriteJSON(oss);
+  const std::string json = oss.str();
+  const size_t outerPos = json.find("\"scoped_outer\"");
+  const size_t innerPos = json.find("\"scoped_inner\"");
+  BOOST_REQUIRE(outerPos != std::string::npos);
+  BOOST_REQUIRE(innerPos != std::string::npos);
+  BOOST_REQUIRE_GT(innerPos, json.find("\"children\"", outerPos));
+  BOOST_REQUIRE(json.find("\"p99_us\"") != std::string::npos);
+
+  // Stopping a section while a section started after it is running is an
+  // error.
+  {
+    ScopedTimer outer(outerSection);
+    ScopedTimer inner(innerSection);
+    BOOST_REQUIRE_THROW(outer.Stop(), std::runtime_error);
+    inner.Stop();
+    outer.Stop();
+  }
+  BOOST_REQUIRE_EQUAL(ScopedTimers::Count("scoped_outer"), 3);
+
+  // Nothing is recorded when timing is disabled.
+  Timer::DisableTiming();
+  {
+    ScopedTimer outer(outerSection);
+  }
+  BOOST_REQUIRE_EQUAL(ScopedTimers::Count("scoped_outer"), 3);
+
+  Timer::ResetAll();
+  BOOST_REQUIRE_EQUAL(ScopedTimers::Count("scoped_outer"), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -2161,6 +2161,294 @@ BOOST_AUTO_TEST_CASE(BinarySpaceTreeCopyConstructor)
   BOOST_REQUIRE_EQUAL(b.Right()->Right(), c.Right()->Right());
 }
 
+//! Check that two binary space trees have the same structure and bounds.
+template<typename TreeType>
+void CheckSameBinarySpaceTree(const TreeType& a, const TreeType& b)
+{
+  BOOST_REQUIRE_EQUAL(a.Begin(), b.Begin());
+  BOOST_REQUIRE_EQUAL(a.Count(), b.Count());
+  BOOST_REQUIRE_EQUAL(a.NumChildren(), b.NumChildren());
+  BOOST_REQUIRE_CLOSE(a.FurthestDescendantDistance(),
+      b.FurthestDescendantDistance(), 1e-5);
+  BOOST_REQUIRE_CLOSE(a.Bound().Diameter(), b.Bound().Diameter(), 1e-5);
+  BOOST_REQUIRE_EQUAL(&a.Dataset() == &b.Dataset(), false);
+
+  for (size_t i = 0; i < a.NumChildren(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(b.Child(i).Parent(), &b);
+    BOOST_REQUIRE_EQUAL(&b.Child(i).Dataset(), &b.Dataset());
+    CheckSameBinarySpaceTree(a.Child(i), b.Child(i));
+  }
+}
+
+/**
+ * Make sure that packing the nodes of a tree does not change it.
+ */
+BOOST_AUTO_TEST_CASE(BinarySpaceTreePackNodesTest)
+{
+  arma::mat dataset(5, 1000);
+  dataset.randu();
+
+  KDTree<EuclideanDistance, EmptyStatistic, arma::mat> kdTree(dataset, 5);
+  KDTree<EuclideanDistance, EmptyStatistic, arma::mat> packedKdTree(kdTree);
+  BOOST_REQUIRE_EQUAL(packedKdTree.IsPacked(), false);
+
+  packedKdTree.PackNodes();
+  BOOST_REQUIRE_EQUAL(packedKdTree.IsPacked(), true);
+  CheckSameBinarySpaceTree(kdTree, packedKdTree);
+  for (size_t d = 0; d < dataset.n_rows; ++d)
+  {
+    BOOST_REQUIRE_EQUAL(kdTree.Bound()[d].Lo(), packedKdTree.Bound()[d].Lo());
+    BOOST_REQUIRE_EQUAL(kdTree.Bound()[d].Hi(), packedKdTree.Bound()[d].Hi());
+  }
+
+  // Packing again should do nothing.
+  packedKdTree.PackNodes();
+  CheckSameBinarySpaceTree(kdTree, packedKdTree);
+
+  // A copy of a packed tree is a regular tree.
+  KDTree<EuclideanDistance, EmptyStatistic, arma::mat> copiedKdTree(
+      packedKdTree);
+  BOOST_REQUIRE_EQUAL(copiedKdTree.IsPacked(), false);
+  CheckSameBinarySpaceTree(kdTree, copiedKdTree);
+
+  // Moving a packed tree keeps it packed.
+  KDTree<EuclideanDistance, EmptyStatistic, arma::mat> movedKdTree(
+      std::move(packedKdTree));
+  BOOST_REQUIRE_EQUAL(movedKdTree.IsPacked(), true);
+  BOOST_REQUIRE_EQUAL(packedKdTree.IsPacked(), false);
+  CheckSameBinarySpaceTree(kdTree, movedKdTree);
+
+  // Bounds other than HRectBound are not stored inline, but the nodes can
+  // still be packed.
+  BallTree<EuclideanDistance, EmptyStatistic, arma::mat> ballTree(dataset, 5);
+  BallTree<EuclideanDistance, EmptyStatistic, arma::mat> packedBallTree(
+      ballTree);
+  packedBallTree.PackNodes();
+  CheckSameBinarySpaceTree(ballTree, packedBallTree);
+
+  // Packing a child is not allowed.
+  BOOST_REQUIRE_THROW(kdTree.Left()->PackNodes(), std::invalid_argument);
+}
+
+//! Check that each node of an updated binary space tree is consistent.
+template<typename TreeType>
+void CheckInsertedBinarySpaceTree(const TreeType& node,
+                                  const size_t maxLeafSize)
+{
+  for (size_t i = node.Begin(); i < node.Begin() + node.Count(); ++i)
+    BOOST_REQUIRE_EQUAL(node.Bound().Contains(node.Dataset().col(i)), true);
+
+  if (node.IsLeaf())
+  {
+    BOOST_REQUIRE_LE(node.Count(), maxLeafSize);
+    return;
+  }
+
+  BOOST_REQUIRE_EQUAL(node.Left()->Begin(), node.Begin());
+  BOOST_REQUIRE_EQUAL(node.Right()->Begin(), node.Left()->Begin() +
+      node.Left()->Count());
+  BOOST_REQUIRE_EQUAL(node.Left()->Count() + node.Right()->Count(),
+      node.Count());
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(node.Child(i).Parent(), &node);
+    BOOST_REQUIRE_EQUAL(&node.Child(i).Dataset(), &node.Dataset());
+    CheckInsertedBinarySpaceTree(node.Child(i), maxLeafSize);
+  }
+}
+
+/**
+ * Make sure that inserting points into a tree keeps it valid, for both a
+ * regular tree and a packed tree.
+ */
+BOOST_AUTO_TEST_CASE(BinarySpaceTreeInsertTest)
+{
+  arma::mat dataset(3, 1500);
+  dataset.randu();
+  // Put some new points outside of the original bound.
+  dataset.cols(1000, 1499) *= 2.0;
+
+  for (size_t packed = 0; packed < 2; ++packed)
+  {
+    std::vector<size_t> oldFromNew;
+    KDTree<EuclideanDistance, EmptyStatistic, arma::mat> tree(
+        dataset.cols(0, 999), oldFromNew, 10);
+    if (packed == 1)
+      tree.PackNodes();
+
+    tree.Insert(dataset.cols(1000, 1199), oldFromNew, 10);
+    tree.Insert(dataset.cols(1200, 1499), oldFromNew, 10);
+
+    BOOST_REQUIRE_EQUAL(tree.NumDescendants(), 1500);
+    BOOST_REQUIRE_EQUAL(oldFromNew.size(), 1500);
+    CheckInsertedBinarySpaceTree(tree, 10);
+
+    // The mapping must lead back to the original points.
+    std::vector<bool> seen(1500, false);
+    for (size_t i = 0; i < oldFromNew.size(); ++i)
+    {
+      BOOST_REQUIRE_LT(oldFromNew[i], 1500);
+      BOOST_REQUIRE_EQUAL(seen[oldFromNew[i]], false);
+      seen[oldFromNew[i]] = true;
+      for (size_t d = 0; d < dataset.n_rows; ++d)
+        BOOST_REQUIRE_EQUAL(tree.Dataset()(d, i), dataset(d, oldFromNew[i]));
+    }
+  }
+
+  // Inserting into a child is not allowed.
+  std::vector<size_t> oldFromNew;
+  KDTree<EuclideanDistance, EmptyStatistic, arma::mat> tree(dataset,
+      oldFromNew);
+  BOOST_REQUIRE_THROW(tree.Left()->Insert(dataset.cols(0, 9), oldFromNew),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure that the nodes of a built tree are allocated from the arena of the
+ * root, and that copied, moved and packed trees handle the arena correctly.
+ */
+BOOST_AUTO_TEST_CASE(TreeNodeArenaTest)
+{
+  arma::mat dataset(3, 5000);
+  dataset.randu();
+
+  KDTree<EuclideanDistance, EmptyStatistic, arma::mat> kdTree(dataset, 5);
+  BOOST_REQUIRE(kdTree.Arena() != NULL);
+  BOOST_REQUIRE_LT(kdTree.Arena()->Slabs(), 20);
+  BOOST_REQUIRE_GE(kdTree.Arena()->Bytes(), (2 * dataset.n_cols / 5 - 2) *
+      sizeof(kdTree));
+
+  // A leaf root has no arena.
+  KDTree<EuclideanDistance, EmptyStatistic, arma::mat> leafTree(
+      dataset.cols(0, 4), 5);
+  BOOST_REQUIRE(leafTree.Arena() == NULL);
+
+  // A copy allocates its nodes with new.
+  KDTree<EuclideanDistance, EmptyStatistic, arma::mat> copiedKdTree(kdTree);
+  BOOST_REQUIRE(copiedKdTree.Arena() == NULL);
+  CheckSameBinarySpaceTree(kdTree, copiedKdTree);
+
+  // A moved tree takes the arena.
+  const NodeArena* arena = kdTree.Arena();
+  KDTree<EuclideanDistance, EmptyStatistic, arma::mat> movedKdTree(
+      std::move(kdTree));
+  BOOST_REQUIRE_EQUAL(movedKdTree.Arena(), arena);
+  BOOST_REQUIRE(kdTree.Arena() == NULL);
+  CheckSameBinarySpaceTree(copiedKdTree, movedKdTree);
+
+  // Packing the nodes moves them all out of the arena.
+  movedKdTree.PackNodes();
+  BOOST_REQUIRE(movedKdTree.Arena() == NULL);
+  CheckSameBinarySpaceTree(copiedKdTree, movedKdTree);
+
+  // The implicit nodes removed while a cover tree is built are in the arena
+  // too.
+  StandardCoverTree<EuclideanDistance, EmptyStatistic, arma::mat> coverTree(
+      dataset);
+  BOOST_REQUIRE(coverTree.Arena() != NULL);
+  StandardCoverTree<EuclideanDistance, EmptyStatistic, arma::mat>
+      copiedCoverTree(coverTree);
+  BOOST_REQUIRE(copiedCoverTree.Arena() == NULL);
+  BOOST_REQUIRE_EQUAL(copiedCoverTree.NumDescendants(),
+      coverTree.NumDescendants());
+}
+
+#ifdef HAS_OPENMP
+/**
+ * Make sure that building a tree with several threads gives the same tree as
+ * building it with one thread, both for splits that build children in parallel
+ * and for randomized splits, which only partition in parallel.
+ */
+BOOST_AUTO_TEST_CASE(BinarySpaceTreeParallelBuildTest)
+{
+  arma::mat dataset(4, 40000);
+  dataset.randu();
+
+  const size_t prevNumThreads = omp_get_max_threads();
+  omp_set_num_threads(std::max(prevNumThreads, (size_t) 4));
+
+  std::vector<size_t> oldFromNew, serialOldFromNew;
+  KDTree<EuclideanDistance, EmptyStatistic, arma::mat> kdTree(dataset,
+      oldFromNew, 5);
+  math::RandomSeed(4);
+  RPTree<EuclideanDistance, EmptyStatistic, arma::mat> rpTree(dataset, 5);
+
+  omp_set_num_threads(1);
+  KDTree<EuclideanDistance, EmptyStatistic, arma::mat> serialKdTree(dataset,
+      serialOldFromNew, 5);
+  math::RandomSeed(4);
+  RPTree<EuclideanDistance, EmptyStatistic, arma::mat> serialRpTree(dataset,
+      5);
+  omp_set_num_threads(prevNumThreads);
+
+  CheckSameBinarySpaceTree(serialKdTree, kdTree);
+  CheckMatrices(serialKdTree.Dataset(), kdTree.Dataset());
+  BOOST_REQUIRE(serialOldFromNew == oldFromNew);
+
+  CheckSameBinarySpaceTree(serialRpTree, rpTree);
+  CheckMatrices(serialRpTree.Dataset(), rpTree.Dataset());
+}
+#endif
+
+//! Check that the bound of every node is the bound of the points it holds.
+template<typename TreeType>
+void CheckRefitBounds(TreeType& node)
+{
+  HRectBound<EuclideanDistance> pointBound(node.Dataset().n_rows);
+  pointBound |= node.Dataset().cols(node.Begin(),
+      node.Begin() + node.Count() - 1);
+
+  for (size_t d = 0; d < node.Dataset().n_rows; ++d)
+  {
+    BOOST_REQUIRE_CLOSE(node.Bound()[d].Lo(), pointBound[d].Lo(), 1e-5);
+    BOOST_REQUIRE_CLOSE(node.Bound()[d].Hi(), pointBound[d].Hi(), 1e-5);
+  }
+  BOOST_REQUIRE_CLOSE(node.Bound().MinWidth(), pointBound.MinWidth(), 1e-5);
+
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+    CheckRefitBounds(node.Child(i));
+}
+
+//! Check that the bound of every node contains the points it holds.
+template<typename TreeType>
+void CheckRefitContains(TreeType& node)
+{
+  for (size_t i = 0; i < node.NumDescendants(); ++i)
+    BOOST_REQUIRE(node.Bound().Contains(
+        node.Dataset().col(node.Descendant(i))));
+
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+    CheckRefitContains(node.Child(i));
+}
+
+/**
+ * Make sure that Refit() gives every node the bound of its points after the
+ * points move, both for bounds built from the bounds of the children and for
+ * bounds that are refit to the points of each node.
+ */
+BOOST_AUTO_TEST_CASE(BinarySpaceTreeRefitTest)
+{
+  arma::mat dataset(4, 2000);
+  dataset.randu();
+
+  arma::mat transformation = arma::eye<arma::mat>(4, 4) +
+      0.3 * arma::randu<arma::mat>(4, 4);
+
+  KDTree<EuclideanDistance, EmptyStatistic, arma::mat> kdTree(dataset, 10);
+  kdTree.Dataset() = transformation * kdTree.Dataset();
+  kdTree.Refit();
+  CheckRefitBounds(kdTree);
+
+  BallTree<EuclideanDistance, EmptyStatistic, arma::mat> ballTree(dataset, 10);
+  ballTree.Dataset() = transformation * ballTree.Dataset();
+  ballTree.Refit();
+  CheckRefitContains(ballTree);
+
+  // Only the root can be refit.
+  BOOST_REQUIRE_THROW(kdTree.Left()->Refit(), std::invalid_argument);
+}
+
 //! Count the number of leaves under this node.
 template<typename TreeType>
 size_t NumLeaves(TreeType* node)
@@ -2277,4 +2565,112 @@ BOOST_AUTO_TEST_CASE(CoverTreeDescendantTest)
   CheckDescendants(&tree);
 }
 
+/**
+ * Make sure that a cover tree is still valid after points are inserted into it
+ * and removed from it.
+ */
+BOOST_AUTO_TEST_CASE(CoverTreeInsertRemoveTest)
+{
+  arma::mat dataset;
+  dataset.randu(5, 600);
+  // Add a few duplicate points.
+  dataset.cols(590, 599) = dataset.cols(0, 9);
+
+  typedef StandardCoverTree<EuclideanDistance, EmptyStatistic, arma::mat>
+      TreeType;
+  TreeType tree(arma::mat(dataset.cols(0, 199)));
+
+  // Insert points in a batch, and then one by one.
+  tree.Insert(dataset.cols(200, 399));
+  BOOST_REQUIRE_EQUAL(tree.Dataset().n_cols, 400);
+  tree.Insert(dataset.cols(400, 599));
+  BOOST_REQUIRE_EQUAL(tree.Dataset().n_cols, 600);
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), 600);
+
+  arma::vec counts;
+  counts.zeros(600);
+  RecurseTreeCountLeaves(tree, counts);
+  for (size_t i = 0; i < 600; ++i)
+    BOOST_REQUIRE_EQUAL(counts[i], 1);
+
+  CheckSelfChild<TreeType>(tree);
+  CheckCovering<TreeType, LMetric<2, true>>(tree);
+  CheckDescendants(&tree);
+
+  // Remove every third point, including the root.
+  const size_t rootPoint = tree.Point();
+  BOOST_REQUIRE_EQUAL(tree.Remove(rootPoint), true);
+  for (size_t i = 0; i < 600; i += 3)
+    if (i != rootPoint)
+      BOOST_REQUIRE_EQUAL(tree.Remove(i), true);
+  BOOST_REQUIRE_EQUAL(tree.Remove(0), false);
+
+  counts.zeros();
+  RecurseTreeCountLeaves(tree, counts);
+  size_t numPoints = 0;
+  for (size_t i = 0; i < 600; ++i)
+  {
+    const bool removed = (i % 3 == 0 || i == rootPoint);
+    BOOST_REQUIRE_EQUAL(counts[i], removed ? 0 : 1);
+    if (!removed)
+      ++numPoints;
+  }
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), numPoints);
+
+  CheckSelfChild<TreeType>(tree);
+  CheckCovering<TreeType, LMetric<2, true>>(tree);
+  CheckDescendants(&tree);
+
+  // Put the removed points back.
+  for (size_t i = 0; i < 600; i += 3)
+    tree.Insert(i);
+  if (rootPoint % 3 != 0)
+    tree.Insert(rootPoint);
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), 600);
+
+  CheckSelfChild<TreeType>(tree);
+  CheckCovering<TreeType, LMetric<2, true>>(tree);
+  CheckDescendants(&tree);
+}
+
+#ifdef HAS_OPENMP
+//! Make sure the two given cover trees have exactly the same structure.
+template<typename TreeType>
+void CheckSameCoverTree(const TreeType& a, const TreeType& b)
+{
+  BOOST_REQUIRE_EQUAL(a.Point(), b.Point());
+  BOOST_REQUIRE_EQUAL(a.Scale(), b.Scale());
+  BOOST_REQUIRE_EQUAL(a.NumDescendants(), b.NumDescendants());
+  BOOST_REQUIRE_EQUAL(a.ParentDistance(), b.ParentDistance());
+  BOOST_REQUIRE_EQUAL(a.FurthestDescendantDistance(),
+      b.FurthestDescendantDistance());
+  BOOST_REQUIRE_EQUAL(a.NumChildren(), b.NumChildren());
+
+  for (size_t i = 0; i < a.NumChildren(); ++i)
+    CheckSameCoverTree(a.Child(i), b.Child(i));
+}
+
+/**
+ * Make sure that building a cover tree with several threads gives the same
+ * tree as building it with one thread.
+ */
+BOOST_AUTO_TEST_CASE(CoverTreeParallelBuildTest)
+{
+  arma::mat dataset(5, 20000);
+  dataset.randu();
+
+  const size_t prevNumThreads = omp_get_max_threads();
+  omp_set_num_threads(std::max(prevNumThreads, (size_t) 4));
+  StandardCoverTree<EuclideanDistance, EmptyStatistic, arma::mat> tree(dataset);
+
+  omp_set_num_threads(1);
+  StandardCoverTree<EuclideanDistance, EmptyStatistic, arma::mat>
+      serialTree(dataset);
+  omp_set_num_threads(prevNumThreads);
+
+  BOOST_REQUIRE_EQUAL(tree.DistanceComps(), serialTree.DistanceComps());
+  CheckSameCoverTree(serialTree, tree);
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -10,6 +10,7 @@
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
 #include <mlpack/methods/emst/union_find.hpp>
+#include <mlpack/methods/emst/concurrent_union_find.hpp>
 
 #include <mlpack/core.hpp>
 #include <boost/test/unit_test.hpp>
@@ -51,4 +52,46 @@ BOOST_AUTO_TEST_CASE(TestUnion)
   BOOST_REQUIRE(testUnionFind.Find(6) == testUnionFind.Find(3));
 }
 
+/**
+ * Make sure that ConcurrentUnionFind finds the same components as UnionFind
+ * when the unions are done from several threads.
+ */
+BOOST_AUTO_TEST_CASE(TestConcurrentUnion)
+{
+  static const size_t testSize = 10000;
+  arma::Mat<size_t> edges(2, 5000);
+  for (size_t i = 0; i < edges.n_cols; ++i)
+  {
+    edges(0, i) = math::RandInt(testSize);
+    edges(1, i) = math::RandInt(testSize);
+  }
+
+  UnionFind serialUnionFind(testSize);
+  for (size_t i = 0; i < edges.n_cols; ++i)
+    serialUnionFind.Union(edges(0, i), edges(1, i));
+
+  ConcurrentUnionFind concurrentUnionFind(testSize);
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) edges.n_cols; ++i)
+    concurrentUnionFind.Union(edges(0, i), edges(1, i));
+
+  // Two points must be in the same component in one structure exactly when
+  // they are in the same component in the other.
+  std::map<size_t, size_t> serialToConcurrent;
+  std::map<size_t, size_t> concurrentToSerial;
+  for (size_t i = 0; i < testSize; ++i)
+  {
+    const size_t serialRoot = serialUnionFind.Find(i);
+    const size_t concurrentRoot = concurrentUnionFind.Find(i);
+
+    if (serialToConcurrent.count(serialRoot) == 0)
+      serialToConcurrent[serialRoot] = concurrentRoot;
+    if (concurrentToSerial.count(concurrentRoot) == 0)
+      concurrentToSerial[concurrentRoot] = serialRoot;
+
+    BOOST_REQUIRE_EQUAL(serialToConcurrent[serialRoot], concurrentRoot);
+    BOOST_REQUIRE_EQUAL(concurrentToSerial[concurrentRoot], serialRoot);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();